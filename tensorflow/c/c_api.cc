@@ -787,6 +787,37 @@ static bool TF_Run_Inputs(TF_Tensor* const* c_inputs,
   return true;
 }
 
+// Writes 'src' into the buffer of the caller-allocated tensor 'dst' and sets
+// the shape of 'dst' to that of 'src'.
+static Status CopyTensorToPreallocated(const Tensor& src, TF_Tensor* dst) {
+  const DataType dst_dtype = static_cast<DataType>(dst->dtype);
+  if (src.dtype() != dst_dtype) {
+    return InvalidArgument("Preallocated output has type ",
+                           tensorflow::DataTypeString(dst_dtype),
+                           " but the fetched tensor has type ",
+                           tensorflow::DataTypeString(src.dtype()));
+  }
+  if (!tensorflow::DataTypeCanUseMemcpy(dst_dtype)) {
+    return InvalidArgument("Preallocated outputs of type ",
+                           tensorflow::DataTypeString(dst_dtype),
+                           " are not supported");
+  }
+  const tensorflow::StringPiece src_data = src.tensor_data();
+  if (src_data.size() > TF_TensorByteSize(dst)) {
+    return InvalidArgument("Preallocated output of ", TF_TensorByteSize(dst),
+                           " bytes can't hold the fetched tensor of shape ",
+                           src.shape().DebugString(), " (", src_data.size(),
+                           " bytes)");
+  }
+  // There is nothing to copy if the output is a view of the same buffer,
+  // e.g. when a fed tensor is fetched.
+  if (!src_data.empty() && src_data.data() != TF_TensorData(dst)) {
+    std::memcpy(TF_TensorData(dst), src_data.data(), src_data.size());
+  }
+  dst->shape = src.shape();
+  return Status::OK();
+}
+
 static void TF_Run_Helper(
     Session* session, const char* handle, const TF_Buffer* run_options,
     // Input tensors
@@ -795,7 +826,7 @@ static void TF_Run_Helper(
     const std::vector<string>& output_tensor_names, TF_Tensor** c_outputs,
     // Target nodes
     const std::vector<string>& target_oper_names, TF_Buffer* run_metadata,
-    TF_Status* status) {
+    TF_Status* status, bool use_preallocated_outputs = false) {
   const int noutputs = output_tensor_names.size();
   std::vector<Tensor> outputs(noutputs);
   Status result;
@@ -834,6 +865,11 @@ static void TF_Run_Helper(
   // Store results in c_outputs[]
   for (int i = 0; i < noutputs; ++i) {
     const Tensor& src = outputs[i];
+    if (use_preallocated_outputs && c_outputs[i] != nullptr) {
+      status->status = CopyTensorToPreallocated(src, c_outputs[i]);
+      if (!status->status.ok()) return;
+      continue;
+    }
     if (!src.IsInitialized() || src.NumElements() == 0) {
       c_outputs[i] =
           EmptyTensor(static_cast<TF_DataType>(src.dtype()), src.shape());
@@ -2607,6 +2643,40 @@ void TF_SessionRun(TF_Session* session, const TF_Buffer* run_options,
                 status);
 }
 
+void TF_SessionRunWithPreallocatedOutputs(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    TF_Tensor* const* input_values, int ninputs, const TF_Output* outputs,
+    TF_Tensor** output_values, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets,
+    TF_Buffer* run_metadata, TF_Status* status) {
+  if (session->extend_before_run &&
+      !ExtendSessionGraphHelper(session, status)) {
+    return;
+  }
+
+  // Unlike TF_SessionRun(), output_values[] is not cleared, since it holds
+  // the preallocated outputs.
+  status->status = Status::OK();
+
+  std::vector<std::pair<string, Tensor>> input_pairs(ninputs);
+  if (!TF_Run_Inputs(input_values, &input_pairs, status)) return;
+  for (int i = 0; i < ninputs; ++i) {
+    input_pairs[i].first = OutputName(inputs[i]);
+  }
+  std::vector<string> output_names(noutputs);
+  for (int i = 0; i < noutputs; ++i) {
+    output_names[i] = OutputName(outputs[i]);
+  }
+  std::vector<string> target_names(ntargets);
+  for (int i = 0; i < ntargets; ++i) {
+    target_names[i] = target_opers[i]->node.name();
+  }
+
+  TF_Run_Helper(session->session, nullptr, run_options, input_pairs,
+                output_names, output_values, target_names, run_metadata,
+                status, /*use_preallocated_outputs=*/true);
+}
+
 void TF_SessionPRunSetup(TF_Session* session, const TF_Output* inputs,
                          int ninputs, const TF_Output* outputs, int noutputs,
                          const TF_Operation* const* target_opers, int ntargets,
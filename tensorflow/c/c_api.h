@@ -1378,6 +1378,37 @@ TF_CAPI_EXPORT extern void TF_SessionRun(
     // Output status
     TF_Status*);
 
+// Like TF_SessionRun, but fetched values may be written into buffers owned by
+// the caller.
+//
+// If output_values[i] is non-NULL on entry, it must be a tensor of the
+// fetched type whose buffer is large enough for the fetched value, for
+// example one created with TF_NewTensor over memory managed by the caller.
+// The value is copied into that buffer, the shape of output_values[i] is set
+// to the fetched shape, and the caller keeps ownership of it. TF_STRING and
+// TF_RESOURCE outputs can't be preallocated. If output_values[i] is NULL, a
+// new tensor is returned in it as by TF_SessionRun.
+//
+// Feeds and fetches of other tensors are not copied: a tensor created with
+// TF_NewTensor over a buffer aligned to 64 bytes is fed to the session in
+// place, and a fetched value is returned without copying its buffer.
+//
+// On failure, the preallocated outputs may hold partial results.
+TF_CAPI_EXPORT extern void TF_SessionRunWithPreallocatedOutputs(
+    TF_Session* session,
+    // RunOptions
+    const TF_Buffer* run_options,
+    // Input tensors
+    const TF_Output* inputs, TF_Tensor* const* input_values, int ninputs,
+    // Output tensors
+    const TF_Output* outputs, TF_Tensor** output_values, int noutputs,
+    // Target operations
+    const TF_Operation* const* target_opers, int ntargets,
+    // RunMetadata
+    TF_Buffer* run_metadata,
+    // Output status
+    TF_Status*);
+
 // Set up the graph with the intended feeds (inputs) and fetches (outputs) for a
 // sequence of partial run calls.
 //
@@ -973,6 +973,80 @@ TEST(CAPI, Session) {
   TF_DeleteStatus(s);
 }
 
+TEST(CAPI, SessionRunWithPreallocatedOutputs) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+
+  TF_Operation* feed = Placeholder(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add = Add(feed, two, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* neg = Neg(add, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  CSession csession(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  // The caller's buffer has room for more elements than are fetched. It is
+  // aligned, so the tensor uses it in place.
+  alignas(64) int32 buffer[4] = {0, 0, 0, -1};
+  const int64_t buffer_dims[] = {4};
+  TF_Tensor* preallocated =
+      TF_NewTensor(TF_INT32, buffer_dims, 1, buffer, sizeof(buffer),
+                   [](void*, size_t, void*) {}, nullptr);
+  ASSERT_TRUE(preallocated != nullptr);
+
+  TF_Tensor* input = Int32Tensor({3, 2, 5});
+  TF_Output inputs[] = {{feed, 0}};
+  TF_Output outputs[] = {{add, 0}, {neg, 0}};
+  TF_Tensor* output_values[] = {preallocated, nullptr};
+  TF_SessionRunWithPreallocatedOutputs(
+      csession.mutable_session(), nullptr, inputs, &input, 1, outputs,
+      output_values, 2, nullptr, 0, nullptr, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  // The first output was written into the caller's buffer.
+  EXPECT_EQ(preallocated, output_values[0]);
+  ASSERT_EQ(1, TF_NumDims(preallocated));
+  EXPECT_EQ(3, TF_Dim(preallocated, 0));
+  EXPECT_EQ(buffer, TF_TensorData(preallocated));
+  EXPECT_EQ(5, buffer[0]);
+  EXPECT_EQ(4, buffer[1]);
+  EXPECT_EQ(7, buffer[2]);
+  EXPECT_EQ(-1, buffer[3]);
+
+  // The second output was allocated as by TF_SessionRun.
+  ASSERT_TRUE(output_values[1] != nullptr);
+  EXPECT_EQ(TF_INT32, TF_TensorType(output_values[1]));
+  const int32* neg_contents =
+      static_cast<const int32*>(TF_TensorData(output_values[1]));
+  EXPECT_EQ(-5, neg_contents[0]);
+  EXPECT_EQ(-7, neg_contents[2]);
+  TF_DeleteTensor(output_values[1]);
+
+  // A preallocated output of the wrong type is rejected.
+  float float_buffer[3];
+  const int64_t float_dims[] = {3};
+  TF_Tensor* float_output =
+      TF_NewTensor(TF_FLOAT, float_dims, 1, float_buffer, sizeof(float_buffer),
+                   [](void*, size_t, void*) {}, nullptr);
+  TF_Tensor* float_output_values[] = {float_output};
+  TF_SessionRunWithPreallocatedOutputs(
+      csession.mutable_session(), nullptr, inputs, &input, 1, outputs,
+      float_output_values, 1, nullptr, 0, nullptr, s);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(s)) << TF_Message(s);
+
+  TF_DeleteTensor(float_output);
+  TF_DeleteTensor(preallocated);
+  TF_DeleteTensor(input);
+  csession.CloseAndDelete(s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 // If `device` is non-empty, run Min op on that device.
 // Otherwise run it on the default device (CPU).
 void RunMinTest(const string& device, bool use_XLA) {
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/compiler/jit/build_xla_launch_ops_pass.h"
+
+#include <algorithm>
+
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/tf2xla/dump_graph.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/public/version.h"
@@ -56,7 +60,9 @@ static Status BuildLaunchNode(
   return status;
 }
 
-static Status ReplaceNodeWithXlaLaunch(Graph* graph, Node* node) {
+static Status ReplaceNodeWithXlaLaunch(
+    const std::vector<int64>& batch_buckets, bool compile_in_background,
+    Graph* graph, Node* node) {
   VLOG(2) << "Replacing " << node->name() << " with XlaLaunch";
 
   int num_constant_args, num_resource_args;
@@ -86,6 +92,12 @@ static Status ReplaceNodeWithXlaLaunch(Graph* graph, Node* node) {
       node->requested_device(), const_dtypes, num_resource_args, arg_dtypes,
       node->output_types(), graph, &launch_node));
   launch_node->set_assigned_device_name(node->assigned_device_name());
+  if (!batch_buckets.empty()) {
+    launch_node->AddAttr(kXlaBatchBucketsAttr, batch_buckets);
+  }
+  if (compile_in_background) {
+    launch_node->AddAttr(kXlaCompileInBackgroundAttr, true);
+  }
 
   // Copy incoming edges to the launch node.
   for (const Edge* edge : node->in_edges()) {
@@ -120,6 +132,22 @@ static Status ReplaceNodeWithXlaLaunch(Graph* graph, Node* node) {
 Status BuildXlaLaunchOpsPass::Run(const GraphOptimizationPassOptions& options) {
   Graph* graph = options.graph->get();
 
+  std::vector<int64> batch_buckets;
+  bool compile_in_background = false;
+  if (options.session_options != nullptr) {
+    const OptimizerOptions& optimizer_options =
+        options.session_options->config.graph_options().optimizer_options();
+    const auto& buckets = optimizer_options.global_jit_batch_buckets();
+    batch_buckets.assign(buckets.begin(), buckets.end());
+    compile_in_background =
+        optimizer_options.global_jit_compile_in_background();
+    if (!std::is_sorted(batch_buckets.begin(), batch_buckets.end()) ||
+        (!batch_buckets.empty() && batch_buckets.front() <= 0)) {
+      return errors::InvalidArgument(
+          "global_jit_batch_buckets must be positive and increasing");
+    }
+  }
+
   for (Node* n : graph->op_nodes()) {
     // In all cases, only try to compile computational nodes.
     if (n->IsSend() || n->IsRecv() || n->IsControlFlow()) {
@@ -129,7 +157,8 @@ Status BuildXlaLaunchOpsPass::Run(const GraphOptimizationPassOptions& options) {
     // Only compile nodes that are marked for compilation by the
     // compilation-marking pass (via 'attr_name').
     if (IsXlaCompiledKernel(*n)) {
-      TF_RETURN_IF_ERROR(ReplaceNodeWithXlaLaunch(graph, n));
+      TF_RETURN_IF_ERROR(ReplaceNodeWithXlaLaunch(
+          batch_buckets, compile_in_background, graph, n));
     }
   }
 
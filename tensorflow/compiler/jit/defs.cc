@@ -19,5 +19,7 @@ namespace tensorflow {
 
 const char* const kXlaCompileAttr = "_XlaCompile";
 const char* const kXlaScopeAttr = "_XlaScope";
+const char* const kXlaBatchBucketsAttr = "_XlaBatchBuckets";
+const char* const kXlaCompileInBackgroundAttr = "_XlaCompileInBackground";
 
 }  // namespace tensorflow
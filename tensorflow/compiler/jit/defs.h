@@ -24,6 +24,11 @@ namespace tensorflow {
 // Name of attribute used to tag operators for compilation with XLA
 extern const char* const kXlaCompileAttr;  // "_XlaCompile"
 extern const char* const kXlaScopeAttr;    // "_XlaScope"
+// Name of attribute listing the batch size buckets of an XlaLaunch node
+extern const char* const kXlaBatchBucketsAttr;  // "_XlaBatchBuckets"
+// Name of attribute asking an XlaLaunch node to compile in the background,
+// "_XlaCompileInBackground"
+extern const char* const kXlaCompileInBackgroundAttr;
 
 }  // namespace tensorflow
 
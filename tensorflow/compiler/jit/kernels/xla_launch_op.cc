@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_launch_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "tensorflow/compiler/jit/xla_launch_util.h"
@@ -33,12 +35,63 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Copies `input` into `padded`, a new tensor whose dimension 0 has `bucket`
+// elements, and zero-fills the remaining rows.
+Status PadToBucket(OpKernelContext* ctx, const Tensor& input, int64 bucket,
+                   Tensor* padded) {
+  TensorShape shape = input.shape();
+  shape.set_dim(0, bucket);
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(input.dtype(), shape, padded));
+  const uint64 input_bytes = input.tensor_data().size();
+  const uint64 padding_bytes = padded->tensor_data().size() - input_bytes;
+
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream == nullptr) {
+    char* dst = const_cast<char*>(padded->tensor_data().data());
+    memcpy(dst, input.tensor_data().data(), input_bytes);
+    memset(dst + input_bytes, 0, padding_bytes);
+    return Status::OK();
+  }
+  se::DeviceMemoryBase src = XlaTensor::DeviceMemoryFromTensor(input);
+  se::DeviceMemoryBase dst = XlaTensor::DeviceMemoryFromTensor(*padded);
+  se::DeviceMemoryBase dst_padding(
+      static_cast<char*>(dst.opaque()) + input_bytes, padding_bytes);
+  stream->ThenMemcpy(&dst, src, input_bytes);
+  stream->ThenMemZero(&dst_padding, padding_bytes);
+  if (!stream->ok()) {
+    return errors::Internal("Failed to pad XLA input to batch size ", bucket);
+  }
+  return Status::OK();
+}
+
+// Returns true if all outputs of `kernel` are computed at run time and have
+// `bucket` elements in dimension 0, and the computation does not update
+// resource variables. Otherwise, padding the inputs could change the
+// observable results.
+bool OutputsAreBatched(const XlaCompiler::CompilationResult& kernel,
+                       int64 bucket) {
+  if (!kernel.resource_updates.empty()) return false;
+  for (const XlaCompiler::OutputDescription& output : kernel.outputs) {
+    if (output.is_constant || output.shape.dims() == 0 ||
+        output.shape.dim_size(0) != bucket) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
                                        const std::vector<int>& constants,
                                        const std::vector<int>& resources,
@@ -57,6 +110,103 @@ XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
   }
 }
 
+Status XlaLocalLaunchBase::PadInputsToBatchBucket(
+    OpKernelContext* ctx, int64* batch_size, int64* bucket,
+    std::map<int, Tensor>* padded_args) {
+  if (batch_buckets_.empty()) return Status::OK();
+
+  // All arguments that are neither compile-time constants nor resources must
+  // share the size of dimension 0.
+  std::vector<int> args;
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    if (std::find(constants_.begin(), constants_.end(), i) !=
+            constants_.end() ||
+        std::find(resources_.begin(), resources_.end(), i) !=
+            resources_.end()) {
+      continue;
+    }
+    const Tensor& input = ctx->input(i);
+    if (input.dims() == 0 || input.NumElements() == 0 ||
+        !DataTypeCanUseMemcpy(input.dtype()) ||
+        (!args.empty() && input.dim_size(0) != *batch_size)) {
+      return Status::OK();
+    }
+    *batch_size = input.dim_size(0);
+    args.push_back(i);
+  }
+  if (args.empty()) return Status::OK();
+
+  auto it = std::lower_bound(batch_buckets_.begin(), batch_buckets_.end(),
+                             *batch_size);
+  if (it == batch_buckets_.end() || *it == *batch_size) return Status::OK();
+  *bucket = *it;
+  VLOG(2) << "Padding batch size " << *batch_size << " to " << *bucket;
+  for (int i : args) {
+    TF_RETURN_IF_ERROR(
+        PadToBucket(ctx, ctx->input(i), *bucket, &(*padded_args)[i]));
+  }
+  return Status::OK();
+}
+
+bool XlaLocalLaunchBase::CanRunFunction(OpKernelContext* ctx) const {
+  if (ctx->function_library() == nullptr) return false;
+  if (device_type_ != DeviceType(DEVICE_GPU)) return true;
+  // Compile-time constants are in host memory, which function arguments on GPU
+  // only are for int32. Conversely, int32 function results are in host memory
+  // but XlaLaunch outputs are not.
+  for (int i : constants_) {
+    if (ctx->input_dtype(i) != DT_INT32) return false;
+  }
+  for (int i = 0; i < ctx->num_outputs(); ++i) {
+    if (ctx->expected_output_dtype(i) == DT_INT32) return false;
+  }
+  return true;
+}
+
+Status XlaLocalLaunchBase::RunFunction(OpKernelContext* ctx) {
+  FunctionLibraryRuntime* lib = ctx->function_library();
+  FunctionLibraryRuntime::Handle handle;
+  TF_RETURN_IF_ERROR(lib->Instantiate(
+      function_.name(), AttrSlice(&function_.attr()), &handle));
+
+  FunctionLibraryRuntime::Options opts;
+  opts.step_id = ctx->step_id();
+  opts.rendezvous = ctx->rendezvous();
+  opts.cancellation_manager = ctx->cancellation_manager();
+  opts.step_container = ctx->step_container();
+  opts.stats_collector = ctx->stats_collector();
+  // This kernel blocks until the function is done, so run the function's
+  // kernels inline instead of competing for the inter-op threads.
+  std::function<void(std::function<void()>)> inline_runner =
+      [](std::function<void()> fn) { fn(); };
+  opts.runner = &inline_runner;
+
+  std::vector<Tensor> args;
+  args.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    args.push_back(ctx->input(i));
+  }
+  std::vector<Tensor> rets;
+  Notification done;
+  Status status;
+  lib->Run(opts, handle, args, &rets, [&done, &status](const Status& s) {
+    status = s;
+    done.Notify();
+  });
+  done.WaitForNotification();
+  TF_RETURN_IF_ERROR(status);
+
+  if (rets.size() != ctx->num_outputs()) {
+    return errors::Internal("Function ", function_.name(), " returned ",
+                            rets.size(), " values, expected ",
+                            ctx->num_outputs());
+  }
+  for (int i = 0; i < rets.size(); ++i) {
+    ctx->set_output(i, rets[i]);
+  }
+  return Status::OK();
+}
+
 Status XlaLocalLaunchBase::BuildCompilationCache(OpKernelContext* ctx,
                                                  XlaCompilationCache** cache) {
   const XlaDevice::Metadata* metadata;
@@ -128,8 +278,6 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
 
   xla::LocalClient* client = static_cast<xla::LocalClient*>(cache->client());
 
-  XlaAllocator local_xla_allocator(client->backend().platform(),
-                                   ctx->device()->GetAllocator({}));
   xla::DeviceMemoryAllocator* xla_allocator;
   // If we are on an XlaDevice, use the underlying XLA platform's allocator
   // directly. We could use the StreamExecutor's allocator which may
@@ -143,7 +291,14 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   if (allocate_xla_tensors) {
     xla_allocator = client->backend().memory_allocator();
   } else {
-    xla_allocator = &local_xla_allocator;
+    // The allocator lives as long as this kernel, so temp_buffer_cache_ can
+    // hold on to buffers from it.
+    mutex_lock lock(allocator_mu_);
+    if (local_xla_allocator_ == nullptr) {
+      local_xla_allocator_.reset(new XlaAllocator(
+          client->backend().platform(), ctx->device()->GetAllocator({})));
+    }
+    xla_allocator = local_xla_allocator_.get();
   }
 
   XlaCompiler::Options options;
@@ -166,15 +321,47 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   }
   XlaCompiler::CompileOptions compile_options;
   compile_options.is_entry_computation = true;
-  OP_REQUIRES_OK(
-      ctx, cache->Compile(options, function_, constant_args, variables, ctx,
-                          &kernel, &executable, &compile_options));
+
+  // With batch size buckets, inputs are padded so that only one executable per
+  // bucket is compiled.
+  std::map<int, Tensor> padded_args;
+  int64 batch_size = 0;
+  int64 bucket = 0;
+  if (!allocate_xla_tensors) {
+    OP_REQUIRES_OK(
+        ctx, PadInputsToBatchBucket(ctx, &batch_size, &bucket, &padded_args));
+  }
+  const bool compile_in_background =
+      compile_in_background_ && !allocate_xla_tensors && CanRunFunction(ctx);
+  auto compile = [&]() -> Status {
+    if (compile_in_background) {
+      return cache->CompileInBackground(options, function_, constant_args,
+                                        variables, ctx, &kernel, &executable,
+                                        &compile_options, padded_args);
+    }
+    return cache->Compile(options, function_, constant_args, variables, ctx,
+                          &kernel, &executable, &compile_options, padded_args);
+  };
+  OP_REQUIRES_OK(ctx, compile());
+  if (kernel != nullptr && !padded_args.empty() &&
+      !OutputsAreBatched(*kernel, bucket)) {
+    VLOG(1) << "Not bucketing the batch size of " << function_.name()
+            << ", its outputs are not batched along dimension 0.";
+    padded_args.clear();
+    OP_REQUIRES_OK(ctx, compile());
+  }
+  if (kernel == nullptr) {
+    VLOG(1) << "Running " << function_.name()
+            << " uncompiled while it is compiled in the background";
+    OP_REQUIRES_OK(ctx, RunFunction(ctx));
+    return;
+  }
 
   VLOG(1) << "Executing XLA Computation...";
 
   XlaComputationLaunchContext launch_context(client, xla_allocator,
                                              allocate_xla_tensors);
-  launch_context.PopulateInputs(ctx, kernel, variables);
+  launch_context.PopulateInputs(ctx, kernel, variables, padded_args);
 
   // Execute the computation.
   VLOG(2) << "Executing computation.";
@@ -183,6 +370,7 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   run_options.set_allocator(xla_allocator);
   run_options.set_intra_op_thread_pool(&ctx->eigen_cpu_device());
   run_options.set_rng_seed(ctx->step_id());
+  run_options.set_temp_buffer_cache(&temp_buffer_cache_);
   Env* env = Env::Default();
   auto start_time = env->NowMicros();
 
@@ -193,6 +381,12 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   VLOG(2) << "Elapsed time: " << elapsed << "us";
 
   launch_context.PopulateOutputs(ctx, kernel, run_result.ConsumeValueOrDie());
+  if (!padded_args.empty()) {
+    // Drop the rows computed from padding.
+    for (int i = 0; i < ctx->num_outputs(); ++i) {
+      ctx->set_output(i, ctx->mutable_output(i)->Slice(0, batch_size));
+    }
+  }
   VLOG(1) << "Done";
 }
 
@@ -250,7 +444,15 @@ NameAttrList FunctionAttr(OpKernelConstruction* ctx) {
 
 XlaLocalLaunchOp::XlaLocalLaunchOp(OpKernelConstruction* ctx)
     : XlaLocalLaunchBase(ctx, ConstantsVector(ctx), ResourcesVector(ctx),
-                         FunctionAttr(ctx)) {}
+                         FunctionAttr(ctx)) {
+  if (HasNodeAttr(ctx->def(), kXlaBatchBucketsAttr)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kXlaBatchBucketsAttr, &batch_buckets_));
+  }
+  if (HasNodeAttr(ctx->def(), kXlaCompileInBackgroundAttr)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kXlaCompileInBackgroundAttr,
+                                     &compile_in_background_));
+  }
+}
 
 XlaLocalLaunchOp::~XlaLocalLaunchOp() {
   VLOG(1) << "XlaLocalLaunchOp destroyed";
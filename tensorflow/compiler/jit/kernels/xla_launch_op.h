@@ -17,11 +17,15 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_JIT_KERNELS_XLA_LOCAL_LAUNCH_OP_H_
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
+#include "tensorflow/compiler/jit/xla_launch_util.h"
+#include "tensorflow/compiler/xla/service/temp_buffer_cache.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 
 namespace tensorflow {
@@ -51,6 +55,24 @@ class XlaLocalLaunchBase : public OpKernel {
   Status BuildCompilationCache(OpKernelContext* ctx,
                                XlaCompilationCache** cache);
 
+  // If the regular (non-constant, non-resource) inputs share a batch size
+  // along dimension 0 that is smaller than some entry of batch_buckets_, pads
+  // them to the smallest such bucket. On return,
+  // `padded_args` maps input numbers to the padded tensors, and is empty if
+  // no padding is needed.
+  Status PadInputsToBatchBucket(OpKernelContext* ctx, int64* batch_size,
+                                int64* bucket,
+                                std::map<int, Tensor>* padded_args);
+
+  // Returns true if `function_` can be run by RunFunction on this device. On
+  // GPU, the memory types of the XlaLaunch inputs and outputs must match those
+  // the function's arguments and results use.
+  bool CanRunFunction(OpKernelContext* ctx) const;
+
+  // Runs `function_` as a regular TensorFlow function, on the calling thread.
+  // Used while the computation is being compiled in the background.
+  Status RunFunction(OpKernelContext* ctx);
+
   // Indexes of compile-time constant inputs
   std::vector<int> constants_;
   // Indexes of resource inputs
@@ -59,6 +81,21 @@ class XlaLocalLaunchBase : public OpKernel {
   DeviceType device_type_;
   NameAttrList function_;
   se::Platform::Id platform_id_;
+  // Increasing batch sizes that inputs are padded to. Empty if inputs are
+  // never padded.
+  std::vector<int64> batch_buckets_;
+  // If true, new signatures are compiled in the background and `function_` is
+  // run uncompiled in the meantime.
+  bool compile_in_background_ = false;
+
+  mutex allocator_mu_;
+  // Allocator for device memory on devices other than XLA devices, created on
+  // first use.
+  std::unique_ptr<XlaAllocator> local_xla_allocator_ GUARDED_BY(allocator_mu_);
+  // Temporary buffers of the executables run by this kernel, kept between
+  // runs. All of them are run on the stream of this kernel's device.
+  // Declared after local_xla_allocator_, which it frees buffers with.
+  xla::TempBufferCache temp_buffer_cache_;
 };
 
 // XlaLocalLaunchOp is used to replace a region of the TensorFlow graph
@@ -30,13 +30,28 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Thread pool for XlaCompilationCache::CompileInBackground, shared by all
+// caches in the process.
+thread::ThreadPool* BackgroundCompilationPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "xla_background_compilation",
+      std::max(1, port::NumSchedulableCPUs() / 2));
+  return pool;
+}
+
+}  // namespace
+
 XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
                                          DeviceType device_type)
     : client_(client), device_type_(std::move(device_type)) {}
@@ -93,7 +108,8 @@ uint64 XlaCompilationCache::Signature::Hash::operator()(
 
 Status XlaCompilationCache::BuildSignature(
     const NameAttrList& function, const std::map<int, Tensor>& constant_args,
-    const std::map<int, OptionalTensor>& variable_args, OpKernelContext* ctx,
+    const std::map<int, OptionalTensor>& variable_args,
+    const std::map<int, Tensor>& padded_args, OpKernelContext* ctx,
     Signature* signature) {
   signature->name = Canonicalize(function.name(), AttrSlice(&function.attr()));
   signature->arg_values.reserve(constant_args.size());
@@ -113,8 +129,10 @@ Status XlaCompilationCache::BuildSignature(
         signature->arg_types.emplace_back(DT_INVALID, TensorShape());
       }
     } else {
-      signature->arg_types.emplace_back(ctx->input_dtype(i),
-                                        ctx->input(i).shape());
+      auto it = padded_args.find(i);
+      const Tensor& input =
+          it != padded_args.end() ? it->second : ctx->input(i);
+      signature->arg_types.emplace_back(ctx->input_dtype(i), input.shape());
     }
   }
   return Status::OK();
@@ -125,6 +143,7 @@ namespace {
 // Builds a XlaCompiler::Argument vector from the arguments to the XlaLaunch op.
 Status BuildArguments(const std::map<int, Tensor>& constant_args,
                       const std::map<int, OptionalTensor>& variable_args,
+                      const std::map<int, Tensor>& padded_args,
                       OpKernelContext* ctx,
                       std::vector<XlaCompiler::Argument>* args) {
   args->resize(ctx->num_inputs());
@@ -141,7 +160,9 @@ Status BuildArguments(const std::map<int, Tensor>& constant_args,
       arg.constant_value = input;
     } else if (variable_args.count(input_num) == 0) {
       // Handles the non-constant arguments.
-      const Tensor& input = ctx->input(input_num);
+      auto it = padded_args.find(input_num);
+      const Tensor& input =
+          it != padded_args.end() ? it->second : ctx->input(input_num);
       TF_RET_CHECK(input.dtype() != DT_RESOURCE);
       if (input.NumElements() > 0) {
         arg.kind = XlaCompiler::Argument::kParameter;
@@ -206,15 +227,66 @@ Status XlaCompilationCache::BuildExecutable(
   return Status::OK();
 }
 
+void XlaCompilationCache::CompileEntryInBackground(
+    XlaCompiler::Options options, const NameAttrList& function,
+    const std::vector<XlaCompiler::Argument>& args,
+    const XlaCompiler::CompileOptions& compile_options, Entry* entry) {
+  // The caller's function library and allocator may be gone by the time the
+  // compilation runs, so use a copy of the former and the backend's allocator.
+  FunctionLibraryDefinition flib_def(*options.flib_def);
+  options.flib_def = &flib_def;
+  options.device_allocator = client_->backend().memory_allocator();
+
+  XlaCompiler::CompilationResult compilation_result;
+  std::unique_ptr<xla::LocalExecutable> executable;
+  Status status;
+  {
+    XlaCompiler compiler(options);
+    status = compiler.CompileFunction(compile_options, function, args,
+                                      &compilation_result);
+  }
+  if (status.ok()) {
+    status = BuildExecutable(options, compilation_result, &executable);
+  }
+
+  mutex_lock entry_lock(entry->mu);
+  if (entry->compiled) {
+    // A synchronous compilation won; callers may hold pointers to its result.
+    return;
+  }
+  VLOG(1) << "Finished compiling " << function.name() << " in the background";
+  entry->compiled = true;
+  entry->compilation_status = status;
+  entry->compilation_result = std::move(compilation_result);
+  entry->executable = std::move(executable);
+}
+
 Status XlaCompilationCache::Compile(
     const XlaCompiler::Options& options, const NameAttrList& function,
     const std::map<int, Tensor>& constant_args,
     const std::map<int, OptionalTensor>& variable_args, OpKernelContext* ctx,
     const XlaCompiler::CompilationResult** compilation_result,
     xla::LocalExecutable** executable,
-    const XlaCompiler::CompileOptions* compile_options) {
+    const XlaCompiler::CompileOptions* compile_options,
+    const std::map<int, Tensor>& padded_args) {
   return CompileImpl(options, function, constant_args, variable_args, ctx,
-                     compilation_result, executable, compile_options, false);
+                     compilation_result, executable, compile_options,
+                     /*compile_single_op=*/false,
+                     /*compile_in_background=*/false, padded_args);
+}
+
+Status XlaCompilationCache::CompileInBackground(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const std::map<int, Tensor>& constant_args,
+    const std::map<int, OptionalTensor>& variable_args, OpKernelContext* ctx,
+    const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable,
+    const XlaCompiler::CompileOptions* compile_options,
+    const std::map<int, Tensor>& padded_args) {
+  return CompileImpl(options, function, constant_args, variable_args, ctx,
+                     compilation_result, executable, compile_options,
+                     /*compile_single_op=*/false,
+                     /*compile_in_background=*/true, padded_args);
 }
 
 Status XlaCompilationCache::CompileSingleOp(
@@ -229,7 +301,9 @@ Status XlaCompilationCache::CompileSingleOp(
   name.set_name(def.op());
   *name.mutable_attr() = def.attr();
   return CompileImpl(options, name, constant_args, variable_args, ctx,
-                     compilation_result, executable, compile_options, true);
+                     compilation_result, executable, compile_options,
+                     /*compile_single_op=*/true,
+                     /*compile_in_background=*/false, /*padded_args=*/{});
 }
 
 Status XlaCompilationCache::CompileImpl(
@@ -238,8 +312,8 @@ Status XlaCompilationCache::CompileImpl(
     const std::map<int, OptionalTensor>& variable_args, OpKernelContext* ctx,
     const XlaCompiler::CompilationResult** compilation_result,
     xla::LocalExecutable** executable,
-    const XlaCompiler::CompileOptions* compile_options,
-    bool compile_single_op) {
+    const XlaCompiler::CompileOptions* compile_options, bool compile_single_op,
+    bool compile_in_background, const std::map<int, Tensor>& padded_args) {
   VLOG(1) << "XlaCompilationCache::Compile " << DebugString();
 
   if (VLOG_IS_ON(2)) {
@@ -269,8 +343,8 @@ Status XlaCompilationCache::CompileImpl(
                ctx->num_inputs());
 
   Signature signature;
-  TF_RETURN_IF_ERROR(
-      BuildSignature(function, constant_args, variable_args, ctx, &signature));
+  TF_RETURN_IF_ERROR(BuildSignature(function, constant_args, variable_args,
+                                    padded_args, ctx, &signature));
 
   VLOG(2) << "Signature: " << SignatureDebugString(signature);
   // The outer lock protects the existence of the cache entry. It does not
@@ -290,6 +364,28 @@ Status XlaCompilationCache::CompileImpl(
   // TODO(phawkins): this locking will need to be restructured when we implement
   // cache eviction.
   mutex_lock entry_lock(entry->mu);
+  if (!entry->compiled && compile_in_background) {
+    if (!entry->compiling_in_background) {
+      VLOG(1) << "Compiling in the background for signature: "
+              << SignatureDebugString(signature);
+      std::vector<XlaCompiler::Argument> args;
+      TF_RETURN_IF_ERROR(BuildArguments(constant_args, variable_args,
+                                        padded_args, ctx, &args));
+      const XlaCompiler::CompileOptions background_options =
+          compile_options ? *compile_options : XlaCompiler::CompileOptions();
+      entry->compiling_in_background = true;
+      Ref();
+      BackgroundCompilationPool()->Schedule(
+          [this, options, function, args, background_options, entry]() {
+            CompileEntryInBackground(options, function, args,
+                                     background_options, entry);
+            Unref();
+          });
+    }
+    *compilation_result = nullptr;
+    if (executable) *executable = nullptr;
+    return Status::OK();
+  }
   if (!entry->compiled) {
     VLOG(1) << "Compilation cache miss for signature: "
             << SignatureDebugString(signature);
@@ -297,7 +393,7 @@ Status XlaCompilationCache::CompileImpl(
     // a long time.)
     std::vector<XlaCompiler::Argument> args;
     TF_RETURN_IF_ERROR(
-        BuildArguments(constant_args, variable_args, ctx, &args));
+        BuildArguments(constant_args, variable_args, padded_args, ctx, &args));
 
     XlaCompiler compiler(options);
     entry->compiled = true;
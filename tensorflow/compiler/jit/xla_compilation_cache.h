@@ -62,6 +62,9 @@ class XlaCompilationCache : public ResourceBase {
   // xla::LocalExecutable and sets `executable` to point to it. The resulting
   // executable pointer may be null if the computation has no non-constant
   // outputs.
+  // `padded_args` optionally maps tensorflow argument numbers of non-constant,
+  // non-resource arguments to tensors that replace the corresponding inputs of
+  // `ctx`, e.g. inputs padded to a batch size bucket.
   Status Compile(const XlaCompiler::Options& options,
                  const NameAttrList& function,
                  const std::map<int, Tensor>& constant_args,
@@ -69,7 +72,24 @@ class XlaCompilationCache : public ResourceBase {
                  OpKernelContext* ctx,
                  const XlaCompiler::CompilationResult** compilation_result,
                  xla::LocalExecutable** executable,
-                 const XlaCompiler::CompileOptions* compile_options);
+                 const XlaCompiler::CompileOptions* compile_options,
+                 const std::map<int, Tensor>& padded_args = {});
+
+  // As Compile, but if `function` has not been compiled for this signature
+  // yet, schedules the compilation (including building the executable) on a
+  // background thread pool and returns immediately with `*compilation_result`
+  // and `*executable` set to null. Once the compilation has finished, calls
+  // behave like Compile. The background compilation allocates any scratch
+  // memory it needs from the XLA backend's allocator rather than from
+  // `options.device_allocator`.
+  Status CompileInBackground(
+      const XlaCompiler::Options& options, const NameAttrList& function,
+      const std::map<int, Tensor>& constant_args,
+      const std::map<int, OptionalTensor>& variable_args, OpKernelContext* ctx,
+      const XlaCompiler::CompilationResult** compilation_result,
+      xla::LocalExecutable** executable,
+      const XlaCompiler::CompileOptions* compile_options,
+      const std::map<int, Tensor>& padded_args = {});
 
   // As above, but calls XlaCompiler::CompileSingleOp instead of
   // XlaCompiler::CompileFunction.
@@ -96,7 +116,8 @@ class XlaCompilationCache : public ResourceBase {
                      const XlaCompiler::CompilationResult** compilation_result,
                      xla::LocalExecutable** executable,
                      const XlaCompiler::CompileOptions* compile_options,
-                     bool compile_single_op);
+                     bool compile_single_op, bool compile_in_background,
+                     const std::map<int, Tensor>& padded_args);
 
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
@@ -130,6 +151,7 @@ class XlaCompilationCache : public ResourceBase {
   Status BuildSignature(const NameAttrList& function,
                         const std::map<int, Tensor>& constant_args,
                         const std::map<int, OptionalTensor>& variable_args,
+                        const std::map<int, Tensor>& padded_args,
                         OpKernelContext* ctx, Signature* signature);
 
   // The value associated with a cache entry.
@@ -139,6 +161,9 @@ class XlaCompilationCache : public ResourceBase {
     // Have we tried compiling this entry?
     bool compiled = false;
 
+    // Has a background compilation of this entry been scheduled?
+    bool compiling_in_background GUARDED_BY(mu) = false;
+
     // Did compilation succeed?
     Status compilation_status GUARDED_BY(mu);
 
@@ -150,6 +175,14 @@ class XlaCompilationCache : public ResourceBase {
     std::unique_ptr<xla::LocalExecutable> executable GUARDED_BY(mu);
   };
 
+  // Compiles `function` for `args` and stores the result in `entry`, unless
+  // the entry has been compiled synchronously in the meantime. Runs on the
+  // background compilation thread pool.
+  void CompileEntryInBackground(
+      XlaCompiler::Options options, const NameAttrList& function,
+      const std::vector<XlaCompiler::Argument>& args,
+      const XlaCompiler::CompileOptions& compile_options, Entry* entry);
+
   mutex mu_;
   std::unordered_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
       GUARDED_BY(mu_);
@@ -75,6 +75,7 @@ void XlaAssignVariableOp::ComputeAsync(OpKernelContext* context,
       1, /*output_index=*/OpKernelContext::Params::kNoReservation, dtype_,
       value.shape(), DEVICE_MEMORY, attr);
   mutex_lock ml(*variable->mu());
+  ScopedPublishSnapshot publish(variable);
   variable->is_initialized = true;
   if (input_alias) {
     *variable->tensor() = *input_alias;
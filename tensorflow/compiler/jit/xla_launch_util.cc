@@ -122,7 +122,8 @@ XlaComputationLaunchContext::XlaComputationLaunchContext(
 
 void XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx, const XlaCompiler::CompilationResult* kernel,
-    const std::map<int, OptionalTensor>& variables) {
+    const std::map<int, OptionalTensor>& variables,
+    const std::map<int, Tensor>& padded_args) {
   // Build ShapedBuffers that point directly to the Tensor buffers.
   arg_buffers_.reserve(kernel->xla_input_shapes.size() + 1);
   arg_buffers_.resize(kernel->xla_input_shapes.size());
@@ -136,6 +137,8 @@ void XlaComputationLaunchContext::PopulateInputs(
     if (variables.count(arg_num)) {
       t = &(variables.at(arg_num).value);
       CHECK(t);
+    } else if (padded_args.count(arg_num)) {
+      t = &(padded_args.at(arg_num));
     } else {
       t = &(ctx->input(arg_num));
     }
@@ -271,6 +274,7 @@ void XlaComputationLaunchContext::PopulateOutputs(
     core::ScopedUnref s(variable);
 
     mutex_lock ml(*variable->mu());
+    ScopedPublishSnapshot publish(variable);
     OP_REQUIRES(ctx, variable->tensor()->dtype() == write.type,
                 errors::Internal("Mismatched type in variable write"));
 
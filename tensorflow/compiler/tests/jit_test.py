@@ -502,5 +502,62 @@ class ElementWiseFusionTest(test.TestCase):
     self.assertAllClose(tf_op, tfef_op, rtol=1e-1)
 
 
+class BatchBucketingTest(test.TestCase):
+
+  def testPaddedBatchesMatchUnpadded(self):
+    os.environ["TF_XLA_FLAGS"] = ("--tf_xla_fusion_only=true "
+                                  "--tf_xla_cpu_global_jit")
+    config = config_pb2.ConfigProto()
+    config.graph_options.optimizer_options.global_jit_level = (
+        config_pb2.OptimizerOptions.ON_1)
+    config.graph_options.optimizer_options.global_jit_batch_buckets.extend(
+        [4, 8])
+
+    with session_lib.Session(config=config) as sess:
+      x = array_ops.placeholder(dtypes.float32, [None, 3], name="x")
+      y = x * x + x
+
+      # Batch sizes below, at and above the largest bucket.
+      for batch_size in [1, 3, 4, 5, 8, 10]:
+        arg = np.random.rand(batch_size, 3).astype(np.float32)
+        run_metadata = config_pb2.RunMetadata()
+        output = sess.run(
+            y, {x: arg},
+            run_metadata=run_metadata,
+            options=config_pb2.RunOptions(
+                trace_level=config_pb2.RunOptions.FULL_TRACE))
+        self.assertTrue(MetadataHasXlaLaunch(run_metadata))
+        self.assertAllClose(arg * arg + arg, output)
+
+
+class BackgroundCompilationTest(test.TestCase):
+
+  def testResultsMatchWhileCompiling(self):
+    os.environ["TF_XLA_FLAGS"] = ("--tf_xla_fusion_only=true "
+                                  "--tf_xla_cpu_global_jit")
+    config = config_pb2.ConfigProto()
+    config.graph_options.optimizer_options.global_jit_level = (
+        config_pb2.OptimizerOptions.ON_1)
+    config.graph_options.optimizer_options.global_jit_compile_in_background = (
+        True)
+
+    with session_lib.Session(config=config) as sess:
+      x = array_ops.placeholder(dtypes.float32, [None, 3], name="x")
+      y = x * x + x
+
+      # The first run of each shape executes the uncompiled function, later
+      # ones may use the compiled executable.
+      for batch_size in [2, 2, 5, 5, 2]:
+        arg = np.random.rand(batch_size, 3).astype(np.float32)
+        run_metadata = config_pb2.RunMetadata()
+        output = sess.run(
+            y, {x: arg},
+            run_metadata=run_metadata,
+            options=config_pb2.RunOptions(
+                trace_level=config_pb2.RunOptions.FULL_TRACE))
+        self.assertTrue(MetadataHasXlaLaunch(run_metadata))
+        self.assertAllClose(arg * arg + arg, output)
+
+
 if __name__ == "__main__":
   test.main()
@@ -83,4 +83,14 @@ ExecutableRunOptions& ExecutableRunOptions::set_rng_seed(int rng_seed) {
 
 int ExecutableRunOptions::rng_seed() const { return rng_seed_; }
 
+ExecutableRunOptions& ExecutableRunOptions::set_temp_buffer_cache(
+    TempBufferCache* temp_buffer_cache) {
+  temp_buffer_cache_ = temp_buffer_cache;
+  return *this;
+}
+
+TempBufferCache* ExecutableRunOptions::temp_buffer_cache() const {
+  return temp_buffer_cache_;
+}
+
 }  // namespace xla
@@ -43,6 +43,7 @@ namespace xla {
 class DeviceMemoryAllocator;
 class DeviceAssignment;
 class ExecutionProfile;
+class TempBufferCache;
 
 // Class containing options for running a LocalExecutable.
 class ExecutableRunOptions {
@@ -82,6 +83,14 @@ class ExecutableRunOptions {
   ExecutableRunOptions& set_rng_seed(int rng_seed);
   int rng_seed() const;
 
+  // If set, executables take their temporary buffers from `temp_buffer_cache`
+  // and give them back to it when done, instead of allocating and freeing
+  // them on every run. All runs using a cache must use the same allocator and
+  // stream. Does not take ownership.
+  ExecutableRunOptions& set_temp_buffer_cache(
+      TempBufferCache* temp_buffer_cache);
+  TempBufferCache* temp_buffer_cache() const;
+
  private:
   DeviceMemoryAllocator* allocator_ = nullptr;
   int device_ordinal_ = -1;
@@ -90,6 +99,7 @@ class ExecutableRunOptions {
   const Eigen::ThreadPoolDevice* intra_op_thread_pool_ = nullptr;
   ExecutionProfile* execution_profile_ = nullptr;
   int rng_seed_ = 0;
+  TempBufferCache* temp_buffer_cache_ = nullptr;
 };
 
 }  // namespace xla
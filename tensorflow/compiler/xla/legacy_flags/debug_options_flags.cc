@@ -234,6 +234,52 @@ void AllocateFlags() {
           int32_setter_for(&DebugOptions::set_xla_gpu_max_kernel_unroll_factor),
           flag_values->xla_gpu_max_kernel_unroll_factor(),
           "Specify the maximum kernel unroll factor for the GPU backend."),
+      tensorflow::Flag("xla_gpu_cubin_cache_dir",
+                       flag_values->mutable_xla_gpu_cubin_cache_dir(),
+                       "Directory in which the GPU backend caches the cubins "
+                       "compiled by ptxas, so they are reused across "
+                       "processes."),
+      tensorflow::Flag(
+          "xla_cpu_parallel_codegen_split_count",
+          int32_setter_for(
+              &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+          flag_values->xla_cpu_parallel_codegen_split_count(),
+          "If greater than one, split the LLVM module of a computation into "
+          "up to this many pieces that the CPU backend compiles in parallel."),
+      tensorflow::Flag(
+          "xla_gpu_parallel_codegen_split_count",
+          int32_setter_for(
+              &DebugOptions::set_xla_gpu_parallel_codegen_split_count),
+          flag_values->xla_gpu_parallel_codegen_split_count(),
+          "If greater than one, split the kernels of a computation into up to "
+          "this many modules that the GPU backend compiles in parallel."),
+      tensorflow::Flag(
+          "xla_gpu_latency_hiding_stream_count",
+          int32_setter_for(
+              &DebugOptions::set_xla_gpu_latency_hiding_stream_count),
+          flag_values->xla_gpu_latency_hiding_stream_count(),
+          "If greater than one, schedule the entry computation onto up to "
+          "this many GPU streams using estimated kernel run times."),
+      tensorflow::Flag(
+          "xla_memory_scheduler_local_search_steps",
+          int32_setter_for(
+              &DebugOptions::set_xla_memory_scheduler_local_search_steps),
+          flag_values->xla_memory_scheduler_local_search_steps(),
+          "If positive, refine memory-minimizing instruction sequences by "
+          "local search, simulating at most this many instruction steps per "
+          "computation."),
+      tensorflow::Flag(
+          "xla_cpu_hlo_profile_path",
+          flag_values->mutable_xla_cpu_hlo_profile_path(),
+          "Path of a binary HloExecutionProfileData measured by running the "
+          "module; the CPU backend uses the measured instruction cycles to "
+          "assign parallel tasks."),
+      tensorflow::Flag(
+          "xla_cpu_inter_op_parallelism",
+          bool_setter_for(&DebugOptions::set_xla_cpu_inter_op_parallelism),
+          flag_values->xla_cpu_inter_op_parallelism(),
+          "Run independent chains of instructions in the entry computation "
+          "concurrently on the intra-op thread pool (CPU JIT only)."),
       tensorflow::Flag(
           "xla_dump_optimized_hlo_proto_to",
           flag_values->mutable_xla_dump_optimized_hlo_proto_to(),
@@ -831,6 +831,15 @@ StatusOr<std::unique_ptr<Literal>> LiteralBase::Broadcast(
   const int64 primitive_size =
       ShapeUtil::ByteSizeOfPrimitiveType(shape().element_type());
 
+  // Broadcasting a scalar fills the result, regardless of its layout.
+  if (ShapeUtil::IsScalar(shape())) {
+    const int64 num_elements = ShapeUtil::ElementsIn(result_shape);
+    for (int64 i = 0; i < num_elements; ++i) {
+      memcpy(dest_data + primitive_size * i, source_data, primitive_size);
+    }
+    return std::move(result);
+  }
+
   ShapeUtil::ForEachIndex(
       result_shape, [&](tensorflow::gtl::ArraySlice<int64> output_index) {
         for (int64 i = 0; i < dimensions.size(); ++i) {
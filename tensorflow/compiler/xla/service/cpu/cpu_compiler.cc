@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <stddef.h>
 #include <string.h>
+#include <algorithm>
 #include <map>
 #include <mutex>  // NOLINT(build/c++11): only using std::call_once, not mutex.
 #include <string>
@@ -60,6 +61,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/disassembler.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/cpu/inter_op_task_outliner.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
@@ -78,6 +80,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_ordering.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
+#include "tensorflow/compiler/xla/service/hlo_profile_printer_data.pb.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
 #include "tensorflow/compiler/xla/service/hlo_scheduling.h"
 #include "tensorflow/compiler/xla/service/hlo_subcomputation_unification.h"
@@ -100,6 +103,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace xla {
 namespace cpu {
@@ -314,19 +318,40 @@ Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile,
       /*enable_dot_strength_reduction=*/false);
   pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/true);
   pipeline.AddPass<HloElementTypeConverter>(BF16, F32);
+  if (!is_aot_compile &&
+      module->config().debug_options().xla_cpu_inter_op_parallelism()) {
+    // Outline independent chains of instructions into tasks the IR emitter
+    // runs concurrently.  This comes before ParallelTaskAssigner, which then
+    // partitions the instructions inside the tasks.
+    pipeline.AddPass<InterOpTaskOutliner>(ShapeSizeBytesFunction());
+  }
   // Outline ops in the entry computation into calls to subcomputations.
   const int max_parallelism =
       module->config().intra_op_parallelism_threads() > 0
           ? module->config().intra_op_parallelism_threads()
           : tensorflow::port::NumSchedulableCPUs();
-  if (!is_aot_compile) {
+  // A profile measured by running the module takes the place of the cost
+  // model wherever it has data.
+  std::unique_ptr<HloExecutionProfileData> profile;
+  const string& profile_path =
+      module->config().debug_options().xla_cpu_hlo_profile_path();
+  if (!profile_path.empty()) {
+    profile = MakeUnique<HloExecutionProfileData>();
+    TF_RETURN_IF_ERROR(tensorflow::ReadBinaryProto(
+        tensorflow::Env::Default(), profile_path, profile.get()));
+  }
+  if (!is_aot_compile || profile != nullptr) {
     // Run ParallelTaskAssigner to assign parallel tasks to HLOs in module.
-    // Note this is not run for AOT because it would bring in thread pool
-    // and thread synchronization dependencies which would likely increase
-    // binary size (and most AOT applications are single-threaded).
+    // Note this is not run for AOT without a profile because it would bring
+    // in thread pool and thread synchronization dependencies which would
+    // likely increase binary size (and most AOT applications are
+    // single-threaded).  AOT code built with a profile runs its parallel tasks
+    // on the thread pool set with XlaCompiledCpuFunction::set_thread_pool, or
+    // one after the other without one.
     // TODO(b/29630486) Support multi-threaded AOT.
     pipeline.AddPass<ParallelTaskAssigner>(
-        max_parallelism, ShapeSizeBytesFunction(), &target_machine_features);
+        max_parallelism, ShapeSizeBytesFunction(), &target_machine_features,
+        profile.get());
   }
   // Copy insertion should be performed immediately before IR emission to avoid
   // inserting unnecessary copies (later pass adds an instruction which
@@ -548,19 +573,39 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   // Select an order for emitting the HLO instructions for each
   // computation. Using this sequence enables tighter buffer liveness analysis
   // and reduced memory usage (as compared to using DependencyHloOrdering).
+  const int32 local_search_steps =
+      module->config()
+          .debug_options()
+          .xla_memory_scheduler_local_search_steps();
   TF_ASSIGN_OR_RETURN(
       SequentialHloOrdering::HloModuleSequence module_sequence,
-      CreateMemoryMinimizingSequence(*module, BufferSizeBytesFunction(),
-                                     DFSMemoryScheduler));
+      CreateMemoryMinimizingSequence(
+          *module, BufferSizeBytesFunction(),
+          local_search_steps > 0
+              ? LocalSearchMemoryScheduler(local_search_steps)
+              : MemorySchedulerAlgorithm(DFSMemoryScheduler)));
+
+  // Inter-op tasks run in whatever order their dependencies allow, so their
+  // buffers may only be shared as far as the dependencies order them.
+  std::unique_ptr<HloOrdering> hlo_ordering;
+  const auto& entry_instructions = entry_computation->instructions();
+  if (module->config().debug_options().xla_cpu_inter_op_parallelism() &&
+      std::any_of(entry_instructions.begin(), entry_instructions.end(),
+                  [](const HloInstruction* instruction) {
+                    return IsInterOpTask(*instruction);
+                  })) {
+    hlo_ordering = xla::MakeUnique<DependencyHloOrdering>(module.get());
+  } else {
+    hlo_ordering =
+        xla::MakeUnique<SequentialHloOrdering>(module.get(), module_sequence);
+  }
 
   // Run buffer analysis on the HLO graph. This analysis figures out which
   // temporary buffers are required to run the computation.
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<BufferAssignment> assignment,
-      BufferAssigner::Run(
-          module.get(),
-          xla::MakeUnique<SequentialHloOrdering>(module.get(), module_sequence),
-          BufferSizeBytesFunction(), memory_alignment));
+      BufferAssigner::Run(module.get(), std::move(hlo_ordering),
+                          BufferSizeBytesFunction(), memory_alignment));
   // BufferAssignment::ToString() includes a header, so no need for us to
   // print one ourselves.
   XLA_VLOG_LINES(2, assignment->ToString());
@@ -612,8 +657,16 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
 
   XLA_VLOG_LINES(2, "LLVM IR:\n" + llvm_ir::DumpModuleToString(*llvm_module));
 
-  // JIT compile the LLVM IR module to in-memory machine code.
-  jit->AddModule(std::move(llvm_module));
+  // JIT compile the LLVM IR module to in-memory machine code. The IR hooks
+  // expect to see the whole module, so only split it when there are none.
+  const int split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
+  if (split_count > 1 && !pre_optimization_ir_hook &&
+      !post_optimization_ir_hook) {
+    jit->AddModuleInParallel(std::move(llvm_module), split_count);
+  } else {
+    jit->AddModule(std::move(llvm_module));
+  }
   cpu_executable.reset(new CpuExecutable(
       std::move(jit), std::move(assignment), std::move(module), function_name,
       std::move(hlo_profile_printer_data), std::move(hlo_profile_index_map)));
@@ -728,9 +781,17 @@ CpuCompiler::CompileAheadOfTime(std::vector<std::unique_ptr<HloModule>> modules,
     VLOG(2) << "After optimization:";
     XLA_VLOG_LINES(2, module->ToString());
 
+    const int32 local_search_steps =
+        module->config()
+            .debug_options()
+            .xla_memory_scheduler_local_search_steps();
     TF_ASSIGN_OR_RETURN(
         SequentialHloOrdering::HloModuleSequence module_sequence,
-        CreateMemoryMinimizingSequence(*module, BufferSizeBytesFunction()));
+        CreateMemoryMinimizingSequence(
+            *module, BufferSizeBytesFunction(),
+            local_search_steps > 0
+                ? LocalSearchMemoryScheduler(local_search_steps)
+                : MemorySchedulerAlgorithm()));
 
     // Run buffer analysis on the HLO graph. This analysis figures out which
     // temporary buffers are required to run the computation.
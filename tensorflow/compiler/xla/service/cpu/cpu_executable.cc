@@ -73,6 +73,7 @@ CpuExecutable::CpuExecutable(
 
 Status CpuExecutable::AllocateBuffers(
     DeviceMemoryAllocator* memory_allocator, int device_ordinal,
+    TempBufferCache* temp_buffer_cache,
     std::vector<OwningDeviceMemory>* buffers) {
   CHECK_EQ(buffers->size(), assignment_->Allocations().size());
   VLOG(3) << "Allocating " << assignment_->Allocations().size()
@@ -98,11 +99,20 @@ Status CpuExecutable::AllocateBuffers(
       VLOG(3) << "buffer #" << i
               << " is in the preallocated result ShapedBuffer";
     } else {
-      TF_ASSIGN_OR_RETURN((*buffers)[i], memory_allocator->Allocate(
-                                             device_ordinal, buffer_size));
-
-      VLOG(3) << "buffer #" << i << " allocated " << buffer_size << " bytes ["
-              << (*buffers)[i].opaque() << "]";
+      if (temp_buffer_cache != nullptr && !allocation.maybe_live_out()) {
+        (*buffers)[i] = temp_buffer_cache->Take(this, i, memory_allocator,
+                                                device_ordinal, buffer_size);
+      }
+      if (!(*buffers)[i].is_null()) {
+        VLOG(3) << "buffer #" << i << " reused from the temp buffer cache ["
+                << (*buffers)[i].opaque() << "]";
+      } else {
+        TF_ASSIGN_OR_RETURN((*buffers)[i], memory_allocator->Allocate(
+                                               device_ordinal, buffer_size));
+
+        VLOG(3) << "buffer #" << i << " allocated " << buffer_size
+                << " bytes [" << (*buffers)[i].opaque() << "]";
+      }
     }
 
     // Since the output buffer and all the temporary buffers were written into
@@ -119,6 +129,21 @@ Status CpuExecutable::AllocateBuffers(
   return Status::OK();
 }
 
+void CpuExecutable::ReturnTempBuffers(
+    TempBufferCache* temp_buffer_cache,
+    std::vector<OwningDeviceMemory>* buffers) const {
+  if (temp_buffer_cache == nullptr) {
+    return;
+  }
+  for (BufferAllocation::Index i = 0; i < buffers->size(); ++i) {
+    const BufferAllocation& allocation = assignment_->GetAllocation(i);
+    if (!allocation.is_entry_computation_parameter() &&
+        !allocation.is_thread_local() && !allocation.maybe_live_out()) {
+      temp_buffer_cache->GiveBack(this, i, std::move((*buffers)[i]));
+    }
+  }
+}
+
 Status CpuExecutable::ExecuteComputeFunction(
     const ExecutableRunOptions* run_options,
     tensorflow::gtl::ArraySlice<const ShapedBuffer*> arguments,
@@ -251,8 +276,11 @@ StatusOr<ScopedShapedBuffer> CpuExecutable::ExecuteOnStream(
   DeviceMemoryAllocator* memory_allocator = run_options->allocator();
   std::vector<OwningDeviceMemory> buffers(assignment_->Allocations().size());
 
-  TF_RETURN_IF_ERROR(AllocateBuffers(
-      memory_allocator, stream->parent()->device_ordinal(), &buffers));
+  TempBufferCache* temp_buffer_cache =
+      run_options->run_options().temp_buffer_cache();
+  TF_RETURN_IF_ERROR(AllocateBuffers(memory_allocator,
+                                     stream->parent()->device_ordinal(),
+                                     temp_buffer_cache, &buffers));
 
   std::vector<se::DeviceMemoryBase> unowning_buffers;
   unowning_buffers.reserve(buffers.size());
@@ -262,6 +290,7 @@ StatusOr<ScopedShapedBuffer> CpuExecutable::ExecuteOnStream(
   TF_RETURN_IF_ERROR(ExecuteComputeFunction(&run_options->run_options(),
                                             arguments, unowning_buffers,
                                             hlo_execution_profile));
+  ReturnTempBuffers(temp_buffer_cache, &buffers);
 
   return CreateResultShapedBuffer(run_options, &buffers);
 }
@@ -280,8 +309,11 @@ StatusOr<ScopedShapedBuffer> CpuExecutable::ExecuteAsyncOnStream(
   se::Stream* stream = run_options->stream();
   DeviceMemoryAllocator* memory_allocator = run_options->allocator();
   std::vector<OwningDeviceMemory> buffers(assignment_->Allocations().size());
-  TF_RETURN_IF_ERROR(AllocateBuffers(
-      memory_allocator, stream->parent()->device_ordinal(), &buffers));
+  TempBufferCache* temp_buffer_cache =
+      run_options->run_options().temp_buffer_cache();
+  TF_RETURN_IF_ERROR(AllocateBuffers(memory_allocator,
+                                     stream->parent()->device_ordinal(),
+                                     temp_buffer_cache, &buffers));
 
   std::vector<se::DeviceMemoryBase> unowning_buffers;
   unowning_buffers.reserve(buffers.size());
@@ -317,6 +349,8 @@ StatusOr<ScopedShapedBuffer> CpuExecutable::ExecuteAsyncOnStream(
       TF_CHECK_OK(executable->ExecuteComputeFunction(
           &run_options.run_options(), arguments, unowning_buffers,
           /*hlo_execution_profile=*/nullptr));
+      executable->ReturnTempBuffers(
+          run_options.run_options().temp_buffer_cache(), buffers.get());
     }
   };
   host_stream->EnqueueTask(AsyncRunTask{
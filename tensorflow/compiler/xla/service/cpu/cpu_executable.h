@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/shaped_buffer.h"
+#include "tensorflow/compiler/xla/service/temp_buffer_cache.h"
 #include "tensorflow/compiler/xla/service/tuple_points_to_analysis.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
@@ -89,11 +90,18 @@ class CpuExecutable : public Executable {
   // "buffers". "buffers" should be sized to the number of buffers in buffer
   // assignment. Each vector element corresponds to a particular Index. If
   // a vector element already contains a non-null DeviceMemoryBase, then no
-  // buffer is assigned for this element.
+  // buffer is assigned for this element. Temporary buffers are taken from
+  // "temp_buffer_cache" where possible, if it is not null.
   Status AllocateBuffers(DeviceMemoryAllocator* memory_allocator,
                          int device_ordinal,
+                         TempBufferCache* temp_buffer_cache,
                          std::vector<OwningDeviceMemory>* buffers);
 
+  // Gives the temporary buffers in "buffers" back to "temp_buffer_cache", if
+  // it is not null.
+  void ReturnTempBuffers(TempBufferCache* temp_buffer_cache,
+                         std::vector<OwningDeviceMemory>* buffers) const;
+
   // Calls the generated function performing the computation with the given
   // arguments using the supplied buffers.
   Status ExecuteComputeFunction(
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 
 namespace xla {
@@ -59,6 +60,47 @@ bool CanBeOutputFusedIntoSomeOperand(const HloInstruction* consumer) {
          (CanBeOutputFused(consumer->operand(0), consumer) ||
           CanBeOutputFused(consumer->operand(1), consumer));
 }
+
+// Returns true if operand `operand_index` of `consumer` is read directly by a
+// dot accumulating in S32, where `consumer` is either that dot or a loop
+// fusion rooted at it.
+bool IsOperandOfIntegerDot(const HloInstruction* consumer,
+                           int64 operand_index) {
+  const HloInstruction* dot = consumer;
+  const HloInstruction* operand = consumer->operand(operand_index);
+  if (consumer->opcode() == HloOpcode::kFusion &&
+      consumer->fusion_kind() == HloInstruction::FusionKind::kLoop) {
+    dot = consumer->fused_expression_root();
+    operand = consumer->fused_parameter(operand_index);
+    for (const HloInstruction* user : operand->users()) {
+      if (user != dot) {
+        return false;
+      }
+    }
+  }
+  return dot->opcode() == HloOpcode::kDot &&
+         dot->shape().element_type() == S32 &&
+         (dot->operand(0) == operand || dot->operand(1) == operand);
+}
+
+// Returns true if `consumer` is a loop fusion rooted at a dot that already
+// reads one of its operands through a fused widening convert.  Nothing else is
+// fused into these, so that IsWideningIntegerDotFusion holds once both
+// operands are in.
+bool HasFusedWideningConvert(const HloInstruction* consumer) {
+  if (consumer->opcode() != HloOpcode::kFusion ||
+      consumer->fusion_kind() != HloInstruction::FusionKind::kLoop ||
+      consumer->fused_expression_root()->opcode() != HloOpcode::kDot) {
+    return false;
+  }
+  for (const HloInstruction* operand :
+       consumer->fused_expression_root()->operands()) {
+    if (IsWideningIntegerConvert(*operand)) {
+      return true;
+    }
+  }
+  return false;
+}
 }  // namespace
 
 bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
@@ -106,6 +148,19 @@ bool CpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
     return false;
   }
 
+  // Fusing the conversions of 8-bit dot operands lets DotOpEmitter read the
+  // 8-bit arrays directly and widen them in registers.
+  if (IsWideningIntegerConvert(*producer) &&
+      IsOperandOfIntegerDot(consumer, operand_index)) {
+    VLOG(2) << "Fusing widening convert into integer dot.";
+    return true;
+  }
+
+  if (HasFusedWideningConvert(consumer)) {
+    VLOG(2) << "Not fusing: consumer is a widening integer dot.";
+    return false;
+  }
+
   if (consumer->opcode() == HloOpcode::kDot) {
     // In the general case we call out to optimized "black box" GEMM routines
     // for Dot, which precludes fusion.  However, in very specific cases, we try
@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <set>
 
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_matchers.h"
 #include "tensorflow/compiler/xla/service/transpose_folding.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
@@ -756,6 +757,51 @@ TEST_F(OpcodeFusionTest, DotAddOutputFusion_19x50x1_multi_use) {
               Not(op::Fusion()));
 }
 
+TEST_F(OpcodeFusionTest, WideningConvertsFuseIntoIntegerDot) {
+  const char* module_string = R"(
+HloModule WideningIntegerDot
+
+ENTRY main {
+  lhs = s8[16,64] parameter(0)
+  rhs = u8[64,32] parameter(1)
+  lhs_wide = s32[16,64] convert(lhs)
+  rhs_wide = s32[64,32] convert(rhs)
+  ROOT dot = s32[16,32] dot(lhs_wide, rhs_wide), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          tools::Parse(module_string));
+  RunFusionAndCheckOpcodesWereFused(
+      module.get(), {HloOpcode::kDot, HloOpcode::kConvert, HloOpcode::kConvert,
+                     HloOpcode::kParameter, HloOpcode::kParameter});
+  EXPECT_TRUE(IsWideningIntegerDotFusion(
+      *module->entry_computation()->root_instruction()));
+}
+
+TEST_F(OpcodeFusionTest, WideningIntegerDotKeepsOperandProducersUnfused) {
+  const char* module_string = R"(
+HloModule WideningIntegerDot
+
+ENTRY main {
+  lhs = s8[16,64] parameter(0)
+  rhs = s8[64,32] parameter(1)
+  lhs_negated = s8[16,64] negate(lhs)
+  lhs_wide = s32[16,64] convert(lhs_negated)
+  rhs_wide = s32[64,32] convert(rhs)
+  ROOT dot = s32[16,32] dot(lhs_wide, rhs_wide), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          tools::Parse(module_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool fused_something,
+                          CpuInstructionFusion().Run(module.get()));
+  EXPECT_TRUE(fused_something);
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_TRUE(IsWideningIntegerDotFusion(*root));
+  EXPECT_THAT(root->operands(),
+              ::testing::UnorderedElementsAre(op::Negate(), op::Parameter()));
+}
+
 struct GatherLoopFusionTestSpec {
   string test_name;
   string hlo_computation_text;
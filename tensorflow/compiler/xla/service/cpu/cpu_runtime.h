@@ -63,6 +63,7 @@ extern const char* const kReleaseInfeedBufferAfterDequeueSymbolName;
 extern const char* const kAcquireOutfeedBufferForPopulationSymbolName;
 extern const char* const kReleaseOutfeedBufferAfterPopulationSymbolName;
 extern const char* const kParallelForkJoinSymbolName;
+extern const char* const kExecuteTaskGraphSymbolName;
 
 // All symbol names for XLA CPU runtime functions need to start with this
 // prefix.
@@ -970,11 +970,12 @@ DotOpEmitter::DotOpEmitter(const HloInstruction& dot,
     const HloModuleConfig& hlo_module_config,
     const TargetMachineFeatures& target_machine_features) {
   PrimitiveType type = target_array.GetShape().element_type();
-  TF_RET_CHECK(F16 == type || F32 == type || F64 == type || C64 == type);
   DotOpEmitter dot_emitter(dot, target_array, lhs_array, rhs_array,
                            addend_array, executable_run_options_value,
                            ir_builder, hlo_module_config,
                            target_machine_features);
+  TF_RET_CHECK(F16 == type || F32 == type || F64 == type || C64 == type ||
+               dot_emitter.IsWideningIntegerDot());
   return dot_emitter.Emit();
 }
 
@@ -1219,6 +1220,11 @@ Status DotOpEmitter::Emit() {
     return EmitScalarDot();
   }
 
+  if (IsWideningIntegerDot()) {
+    TF_RET_CHECK(addend_array_ == nullptr);
+    return EmitWideningIntegerDot();
+  }
+
   if (EmitLlvmIrDotIfProfitable()) {
     return Status::OK();
   }
@@ -1362,6 +1368,178 @@ Status DotOpEmitter::Emit() {
   return Status::OK();
 }
 
+bool DotOpEmitter::IsWideningIntegerDot() const {
+  auto is_8_bit = [](const llvm_ir::IrArray& array) {
+    PrimitiveType type = array.GetShape().element_type();
+    return type == S8 || type == U8;
+  };
+  return target_array_.GetShape().element_type() == S32 &&
+         is_8_bit(lhs_array_) && is_8_bit(rhs_array_);
+}
+
+Status DotOpEmitter::EmitWideningIntegerDot() {
+  const Shape& lhs_shape = lhs_array_.GetShape();
+  const Shape& rhs_shape = rhs_array_.GetShape();
+  const DotDimensionNumbers& dim_numbers = dot_.dot_dimension_numbers();
+  TF_RET_CHECK(dim_numbers.lhs_batch_dimensions_size() == 0 &&
+               dim_numbers.rhs_batch_dimensions_size() == 0 &&
+               dim_numbers.lhs_contracting_dimensions_size() == 1);
+  int64 lhs_reduction_dimension = dim_numbers.lhs_contracting_dimensions(0);
+  int64 rhs_reduction_dimension = dim_numbers.rhs_contracting_dimensions(0);
+  int64 k = lhs_shape.dimensions(lhs_reduction_dimension);
+  TF_RET_CHECK(k == rhs_shape.dimensions(rhs_reduction_dimension));
+
+  llvm_ir::ForLoopNest loop_nest(llvm_ir::IrName(&dot_), ir_builder_);
+  llvm_ir::IrArray::Index lhs_index = EmitOperandArrayLoopNest(
+      &loop_nest, lhs_array_, lhs_reduction_dimension, "lhs");
+  llvm_ir::IrArray::Index rhs_index = EmitOperandArrayLoopNest(
+      &loop_nest, rhs_array_, rhs_reduction_dimension, "rhs");
+  if (loop_nest.GetInnerLoopBodyBasicBlock() != nullptr) {
+    SetToFirstInsertPoint(loop_nest.GetInnerLoopBodyBasicBlock(), ir_builder_);
+  }
+
+  const llvm::Function& function = *ir_builder_->GetInsertBlock()->getParent();
+  llvm::Type* accum_type = target_array_.GetElementLlvmType();
+
+  // Widens `value`, which holds one or more elements of `array`, to 32 bits.
+  auto widen = [&](const llvm_ir::IrArray& array, llvm::Value* value) {
+    llvm::Type* wide_type = accum_type;
+    if (value->getType()->isVectorTy()) {
+      wide_type = llvm::VectorType::get(
+          accum_type, value->getType()->getVectorNumElements());
+    }
+    return array.GetShape().element_type() == S8
+               ? ir_builder_->CreateSExt(value, wide_type)
+               : ir_builder_->CreateZExt(value, wide_type);
+  };
+
+  // Loads `width` consecutive elements of `array` starting at `index` and
+  // widens them to 32 bits.
+  auto load_widened_vector = [&](const llvm_ir::IrArray& array,
+                                 const llvm_ir::IrArray::Index& index,
+                                 int64 width) {
+    llvm::Type* vector_type =
+        llvm::VectorType::get(array.GetElementLlvmType(), width);
+    llvm::LoadInst* load = ir_builder_->CreateAlignedLoad(
+        ir_builder_->CreateBitCast(
+            array.EmitArrayElementAddress(index, ir_builder_),
+            vector_type->getPointerTo()),
+        /*Align=*/1);
+    array.AnnotateLoadStoreInstructionWithMetadata(load);
+    return widen(array, load);
+  };
+
+  // The vector loop needs consecutive reduction elements to be adjacent in
+  // memory.  Each iteration accumulates `lanes` 32-bit partial sums.  If the
+  // target has VNNI every lane sums a group of four adjacent products, which is
+  // the shape of the VPDPBUSD/VPDPWSSD family of instructions; otherwise every
+  // lane sums a single product.
+  const bool reduce_along_minor_dimensions =
+      lhs_reduction_dimension == LayoutUtil::Minor(lhs_shape.layout(), 0) &&
+      rhs_reduction_dimension == LayoutUtil::Minor(rhs_shape.layout(), 0);
+  const int64 lanes =
+      target_machine_features_.vector_register_num_elements(function, S32);
+  const int64 group_size =
+      target_machine_features_.has_avx512_vnni(function) ? 4 : 1;
+  const int64 vector_step = lanes * group_size;
+  const int64 vector_k = reduce_along_minor_dimensions && lanes > 1
+                             ? k - k % vector_step
+                             : 0;
+
+  KernelSupportLibrary ksl(ir_builder_);
+  llvm::Value* accum_address = llvm_ir::EmitAllocaAtFunctionEntry(
+      accum_type, "accum_address", ir_builder_);
+  if (vector_k > 0) {
+    VLOG(2) << "Emitting widening integer dot with k = " << k << " in steps of "
+            << vector_step << " elements";
+    llvm::Type* vector_accum_type = llvm::VectorType::get(accum_type, lanes);
+    llvm::Value* vector_accum_address = llvm_ir::EmitAllocaAtFunctionEntry(
+        vector_accum_type, "vector_accum_address", ir_builder_);
+    ir_builder_->CreateStore(llvm::Constant::getNullValue(vector_accum_type),
+                             vector_accum_address);
+    ksl.For("dot.vector_reduction", /*start=*/0, /*end=*/vector_k,
+            /*step=*/vector_step, [&](llvm::Value* reduction_index) {
+              lhs_index[lhs_reduction_dimension] = reduction_index;
+              rhs_index[rhs_reduction_dimension] = reduction_index;
+              llvm::Value* products = ir_builder_->CreateMul(
+                  load_widened_vector(lhs_array_, lhs_index, vector_step),
+                  load_widened_vector(rhs_array_, rhs_index, vector_step));
+              llvm::Value* sums = products;
+              if (group_size > 1) {
+                sums = nullptr;
+                for (int64 i = 0; i < group_size; ++i) {
+                  std::vector<llvm::Constant*> mask;
+                  for (int64 lane = 0; lane < lanes; ++lane) {
+                    mask.push_back(
+                        ir_builder_->getInt32(lane * group_size + i));
+                  }
+                  llvm::Value* group = ir_builder_->CreateShuffleVector(
+                      products, llvm::UndefValue::get(products->getType()),
+                      llvm::ConstantVector::get(mask));
+                  sums = sums ? ir_builder_->CreateAdd(sums, group) : group;
+                }
+              }
+              ir_builder_->CreateStore(
+                  ir_builder_->CreateAdd(
+                      ir_builder_->CreateLoad(vector_accum_address), sums),
+                  vector_accum_address);
+            });
+
+    llvm::Value* vector_accum = ir_builder_->CreateLoad(vector_accum_address);
+    llvm::Value* accum = ir_builder_->CreateExtractElement(
+        vector_accum, ir_builder_->getInt32(0));
+    for (int64 lane = 1; lane < lanes; ++lane) {
+      accum = ir_builder_->CreateAdd(
+          accum, ir_builder_->CreateExtractElement(
+                     vector_accum, ir_builder_->getInt32(lane)));
+    }
+    ir_builder_->CreateStore(accum, accum_address);
+  } else {
+    ir_builder_->CreateStore(llvm::Constant::getNullValue(accum_type),
+                             accum_address);
+  }
+
+  if (vector_k < k) {
+    ksl.For("dot.reduction", /*start=*/vector_k, /*end=*/k, /*step=*/1,
+            [&](llvm::Value* reduction_index) {
+              lhs_index[lhs_reduction_dimension] = reduction_index;
+              rhs_index[rhs_reduction_dimension] = reduction_index;
+              llvm::Value* lhs_element =
+                  lhs_array_.EmitReadArrayElement(lhs_index, ir_builder_);
+              llvm::Value* rhs_element =
+                  rhs_array_.EmitReadArrayElement(rhs_index, ir_builder_);
+              llvm::Value* product =
+                  ir_builder_->CreateMul(widen(lhs_array_, lhs_element),
+                                         widen(rhs_array_, rhs_element));
+              ir_builder_->CreateStore(
+                  ir_builder_->CreateAdd(ir_builder_->CreateLoad(accum_address),
+                                         product),
+                  accum_address);
+            });
+  }
+
+  // The target index is the concatenation of the lhs and rhs indexes with the
+  // reduction dimensions removed.
+  llvm_ir::IrArray::Index target_index;
+  for (int dimension = 0; dimension < lhs_index.size(); ++dimension) {
+    if (dimension != lhs_reduction_dimension) {
+      target_index.push_back(lhs_index[dimension]);
+    }
+  }
+  for (int dimension = 0; dimension < rhs_index.size(); ++dimension) {
+    if (dimension != rhs_reduction_dimension) {
+      target_index.push_back(rhs_index[dimension]);
+    }
+  }
+  target_array_.EmitWriteArrayElement(
+      target_index, ir_builder_->CreateLoad(accum_address), ir_builder_);
+
+  if (loop_nest.GetOuterLoopExitBasicBlock() != nullptr) {
+    ir_builder_->SetInsertPoint(loop_nest.GetOuterLoopExitBasicBlock());
+  }
+  return Status::OK();
+}
+
 Status DotOpEmitter::EmitScalarDot() {
   // A scalar dot is just a scalar multiply.
   llvm::Value* result;
@@ -1626,6 +1804,19 @@ tensorflow::gtl::optional<int64> ProfitableToMakeDotOperandColumnMajor(
     return {};
   }
 
+  // Widening integer dots are emitted with explicit vector loads along the
+  // reduction dimension, which needs it to be minor in both operands.
+  if (IsWideningIntegerDotFusion(hlo)) {
+    const HloInstruction* dot = hlo.fused_expression_root();
+    const HloInstruction* rhs_parameter = dot->operand(1)->operand(0);
+    if (dot->shape().dimensions_size() == 2 &&
+        dot->dot_dimension_numbers().rhs_contracting_dimensions(0) == 0 &&
+        rhs_parameter->user_count() == 1) {
+      return rhs_parameter->parameter_number();
+    }
+    return {};
+  }
+
   if (hlo.opcode() == HloOpcode::kFusion &&
       hlo.fusion_kind() == HloInstruction::FusionKind::kOutput) {
     auto* fusion_root =
@@ -82,6 +82,16 @@ class DotOpEmitter {
   // LHS and RHS) and store the results in the target.
   Status EmitScalarDot();
 
+  // Returns true if the operands are S8 or U8 arrays that the dot widens to its
+  // S32 result type.
+  bool IsWideningIntegerDot() const;
+
+  // Emits a dot of S8 or U8 operands accumulating in S32.  When both operands
+  // are reduced along their minor dimension the reduction loads them a vector
+  // register at a time, shaped by the register width and VNNI support that
+  // target_machine_features_ reports.
+  Status EmitWideningIntegerDot();
+
   // Emit an LLVM IR implementation of the dot operation if we can.  Returns
   // true if an LLVM IR implementation was emitted.
   bool EmitLlvmIrDotIfProfitable();
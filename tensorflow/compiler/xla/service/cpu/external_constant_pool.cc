@@ -18,14 +18,57 @@ limitations under the License.
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/ptr_util.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace xla {
 namespace cpu {
+namespace {
+
+// A constant buffer held by some ExternalConstantPool in the process.
+struct SharedConstant {
+  int64 size;
+  std::weak_ptr<const uint8> buffer;
+};
+
+tensorflow::mutex shared_constants_mutex(tensorflow::LINKER_INITIALIZED);
+
+// The shared constants, keyed by a fingerprint of their contents.
+std::unordered_multimap<uint64, SharedConstant>* SharedConstants() {
+  static auto* shared_constants =
+      new std::unordered_multimap<uint64, SharedConstant>();
+  return shared_constants;
+}
+
+// Unregisters and frees a shared constant once the last pool holding it is
+// gone.  This takes `shared_constants_mutex`, so a reference to a shared
+// constant must not be dropped while holding it.
+struct SharedConstantDeleter {
+  uint64 fingerprint;
+
+  void operator()(const uint8* ptr) const {
+    {
+      tensorflow::mutex_lock lock(shared_constants_mutex);
+      auto range = SharedConstants()->equal_range(fingerprint);
+      for (auto it = range.first; it != range.second;) {
+        it = it->second.buffer.expired() ? SharedConstants()->erase(it)
+                                         : std::next(it);
+      }
+    }
+    tensorflow::port::AlignedFree(const_cast<uint8*>(ptr));
+  }
+};
+}  // namespace
+
 void ExternalConstantPool::Insert(string name, const LiteralSlice& literal,
                                   int64 alignment) {
   CHECK(!ShapeUtil::IsTuple(literal.shape()));
@@ -33,13 +76,41 @@ void ExternalConstantPool::Insert(string name, const LiteralSlice& literal,
   CHECK(entries_.find(name) == entries_.end());
 
   const int64 literal_size = ShapeUtil::ByteSizeOf(literal.shape());
-  void* raw_pointer = tensorflow::port::AlignedMalloc(
-      literal_size, std::max<size_t>(alignment, sizeof(void*)));
-  CHECK(raw_pointer != nullptr) << "failed to allocate " << literal_size
-                                << " bytes with alignment of " << alignment;
+  const char* literal_data = static_cast<const char*>(literal.untyped_data());
+  const uint64 fingerprint = tensorflow::Hash64(literal_data, literal_size);
+
+  std::shared_ptr<const uint8> buffer;
+  // The shared constants looked at below are released only after
+  // `shared_constants_mutex`, since releasing the last reference to one takes
+  // it.
+  std::vector<std::shared_ptr<const uint8>> candidates;
+  {
+    tensorflow::mutex_lock lock(shared_constants_mutex);
+    auto range = SharedConstants()->equal_range(fingerprint);
+    for (auto it = range.first; it != range.second && buffer == nullptr;
+         ++it) {
+      candidates.push_back(it->second.buffer.lock());
+      const uint8* candidate = candidates.back().get();
+      if (candidate != nullptr && it->second.size == literal_size &&
+          reinterpret_cast<uintptr_t>(candidate) % alignment == 0 &&
+          std::memcmp(candidate, literal_data, literal_size) == 0) {
+        buffer = candidates.back();
+      }
+    }
 
-  std::memcpy(raw_pointer, literal.untyped_data(), literal_size);
-  entries_.emplace(std::move(name), static_cast<uint8*>(raw_pointer));
+    if (buffer == nullptr) {
+      void* raw_pointer = tensorflow::port::AlignedMalloc(
+          literal_size, std::max<size_t>(alignment, sizeof(void*)));
+      CHECK(raw_pointer != nullptr) << "failed to allocate " << literal_size
+                                    << " bytes with alignment of " << alignment;
+      std::memcpy(raw_pointer, literal_data, literal_size);
+      buffer.reset(static_cast<const uint8*>(raw_pointer),
+                   SharedConstantDeleter{fingerprint});
+      SharedConstants()->emplace(fingerprint,
+                                 SharedConstant{literal_size, buffer});
+    }
+  }
+  entries_.emplace(std::move(name), std::move(buffer));
 }
 
 const uint8* ExternalConstantPool::Find(const string& name) {
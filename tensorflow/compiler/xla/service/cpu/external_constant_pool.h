@@ -20,7 +20,6 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
-#include "tensorflow/core/platform/mem.h"
 
 namespace xla {
 namespace cpu {
@@ -29,10 +28,13 @@ namespace cpu {
 // extern linkage.  This current incarnation of ExternalConstantPool only
 // supports the JIT CPU backend; the AOT backend is not supported.
 //
-// Implementation-wise, this is a simple wrapper around a map of strings to byte
-// buffers.  This simply implementation works in a JIT scenario.  This class
-// will have to become smarter if we decide to support external constant pools
-// on AOT compiles in the future.
+// Implementation-wise, this is a map of strings to byte buffers that are shared
+// by all the constant pools in the process: inserting a constant with the same
+// contents as one any live pool holds reuses its buffer, so that executables
+// compiled from modules with the same large constants (e.g. variants of one
+// model) keep a single copy of them.  This class will have to become smarter
+// if we decide to support external constant pools on AOT compiles in the
+// future.
 class ExternalConstantPool {
  public:
   // Inserts a buffer with the contents of `literal` into the constant pool with
@@ -41,8 +43,8 @@ class ExternalConstantPool {
   // to `aligment` bytes, and `alignment` must be a power of 2.
   //
   // The constant pool copies out the contents of `literal` into a buffer it
-  // owns -- it does not keep pointers to `literal`, or to memory owned by
-  // `literal`.
+  // shares ownership of -- it does not keep pointers to `literal`, or to memory
+  // owned by `literal`.
   void Insert(string name, const LiteralSlice& literal, int64 alignment);
 
   // Find the constant with name `name` in this constant pool.  If there isn't
@@ -50,14 +52,7 @@ class ExternalConstantPool {
   const uint8* Find(const string& name);
 
  private:
-  // We need to `AlignedFree` pointers allocated into `entries_` since we
-  // allocate them with `AlignedMalloc`.
-  struct FreeDeleter {
-    void operator()(void* ptr) { tensorflow::port::AlignedFree(ptr); }
-  };
-
-  tensorflow::gtl::FlatMap<string, std::unique_ptr<uint8, FreeDeleter>>
-      entries_;
+  tensorflow::gtl::FlatMap<string, std::shared_ptr<const uint8>> entries_;
 };
 }  // namespace cpu
 }  // namespace xla
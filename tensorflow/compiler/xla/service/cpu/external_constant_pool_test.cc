@@ -77,6 +77,32 @@ TEST(ExternalConstantPoolTest, Alignment) {
   }
 }
 
+TEST(ExternalConstantPoolTest, SharesConstantsAcrossPools) {
+  const auto literal = Literal::CreateR2({{5, 6}, {7, 8}});
+  ExternalConstantPool second_pool;
+  {
+    ExternalConstantPool first_pool;
+    first_pool.Insert("first", *literal, 4);
+    second_pool.Insert("second", *literal, 4);
+    EXPECT_EQ(first_pool.Find("first"), second_pool.Find("second"));
+  }
+
+  // The constant outlives the pool it was first inserted into.
+  const uint8* constant = second_pool.Find("second");
+  ASSERT_NE(constant, nullptr);
+  EXPECT_EQ(GetFromBuffer<int32>(constant, 0), 5);
+  EXPECT_EQ(GetFromBuffer<int32>(constant, 3), 8);
+}
+
+TEST(ExternalConstantPoolTest, DoesNotShareDifferentConstants) {
+  ExternalConstantPool first_pool;
+  ExternalConstantPool second_pool;
+  first_pool.Insert("name-0", *Literal::CreateR2({{1, 2}, {3, 4}}), 4);
+  second_pool.Insert("name-0", *Literal::CreateR2({{1, 2}, {3, 5}}), 4);
+  EXPECT_NE(first_pool.Find("name-0"), second_pool.Find("name-0"));
+  EXPECT_EQ(GetFromBuffer<int32>(second_pool.Find("name-0"), 3), 5);
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
@@ -0,0 +1,137 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/inter_op_task_outliner.h"
+
+#include <unordered_map>
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace xla {
+namespace cpu {
+
+namespace {
+
+// Chains that write less than this are not worth the cost of scheduling them
+// as tasks.
+constexpr int64 kMinTaskBytes = 64LL << 10;
+
+bool CanBeInTask(const HloInstruction& instruction) {
+  switch (instruction.opcode()) {
+    // These are free, or alias the buffers of other instructions.
+    case HloOpcode::kBitcast:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+    case HloOpcode::kTuple:
+      return false;
+    default:
+      break;
+  }
+  return !ShapeUtil::IsTuple(instruction.shape()) &&
+         !instruction.HasSideEffect() &&
+         instruction.control_predecessors().empty() &&
+         instruction.control_successors().empty();
+}
+
+}  // namespace
+
+StatusOr<bool> InterOpTaskOutliner::Run(HloModule* module) {
+  XLA_VLOG_LINES(2, "InterOpTaskOutliner ENTRY");
+  XLA_VLOG_LINES(3, module->ToString());
+  HloComputation* computation = module->entry_computation();
+  const HloInstruction* root = computation->root_instruction();
+
+  // An instruction extends the chain of an operand it is the only user of, so
+  // that only the last instruction of a chain is used outside of it.
+  std::vector<std::vector<HloInstruction*>> chains;
+  std::unordered_map<const HloInstruction*, int64> chain_of;
+  for (HloInstruction* instruction : computation->MakeInstructionPostOrder()) {
+    if (!CanBeInTask(*instruction)) {
+      continue;
+    }
+    int64 chain = -1;
+    for (const HloInstruction* operand : instruction->operands()) {
+      auto it = chain_of.find(operand);
+      if (it != chain_of.end() && operand->user_count() == 1 &&
+          operand != root) {
+        chain = it->second;
+        break;
+      }
+    }
+    if (chain < 0) {
+      chain = chains.size();
+      chains.emplace_back();
+    }
+    chains[chain].push_back(instruction);
+    chain_of[instruction] = chain;
+  }
+
+  std::vector<const std::vector<HloInstruction*>*> tasks;
+  for (const std::vector<HloInstruction*>& chain : chains) {
+    int64 bytes = 0;
+    for (const HloInstruction* instruction : chain) {
+      bytes += shape_size_function_(instruction->shape());
+    }
+    if (bytes >= kMinTaskBytes) {
+      tasks.push_back(&chain);
+    }
+  }
+
+  // Tasks that all depend on each other would run one after the other anyway.
+  std::unique_ptr<HloReachabilityMap> reachability =
+      computation->ComputeReachability();
+  bool has_independent_tasks = false;
+  for (size_t i = 0; i < tasks.size() && !has_independent_tasks; ++i) {
+    for (size_t j = i + 1; j < tasks.size(); ++j) {
+      if (!reachability->IsConnected(tasks[i]->back(), tasks[j]->back())) {
+        has_independent_tasks = true;
+        break;
+      }
+    }
+  }
+  if (!has_independent_tasks) {
+    return false;
+  }
+
+  for (const std::vector<HloInstruction*>* task : tasks) {
+    HloInstruction* call = module->OutlineExpressionFromComputation(
+        *task, tensorflow::strings::StrCat("task_", task->back()->name()),
+        computation);
+    VLOG(2) << "Outlined " << task->size()
+            << " instructions into task: " << call->name();
+  }
+
+  XLA_VLOG_LINES(2, "InterOpTaskOutliner EXIT");
+  XLA_VLOG_LINES(3, module->ToString());
+  return true;
+}
+
+bool IsInterOpTask(const HloInstruction& hlo) {
+  return hlo.opcode() == HloOpcode::kCall &&
+         hlo.parent() == hlo.parent()->parent()->entry_computation() &&
+         hlo.to_apply()
+             ->root_instruction()
+             ->outer_dimension_partitions()
+             .empty();
+}
+
+}  // namespace cpu
+}  // namespace xla
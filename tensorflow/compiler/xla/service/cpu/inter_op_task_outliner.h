@@ -0,0 +1,67 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_INTER_OP_TASK_OUTLINER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_INTER_OP_TASK_OUTLINER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// InterOpTaskOutliner splits the entry computation into chains of
+// instructions, where every instruction of a chain but the last is used only
+// by the next one, and outlines each chain that is large enough into its own
+// embedded computation invoked by a kCall instruction.  The IR emitter hands
+// these calls to a runtime task scheduler, which runs the ones that do not
+// depend on each other concurrently on the intra-op thread pool.
+//
+// The module is left unchanged unless at least two of the tasks are
+// independent.  Buffer assignment must use an ordering that does not assume
+// the tasks to run in sequence (e.g. DependencyHloOrdering) for modules this
+// pass changed.
+class InterOpTaskOutliner : public HloPassInterface {
+ public:
+  // 'shape_size': shape size function used to estimate the work of a chain.
+  explicit InterOpTaskOutliner(
+      const HloCostAnalysis::ShapeSizeFunction& shape_size)
+      : shape_size_function_(shape_size) {}
+  ~InterOpTaskOutliner() override {}
+
+  tensorflow::StringPiece name() const override {
+    return "cpu-inter-op-task-outliner";
+  }
+
+  // Run inter-op task outliner on 'module'.
+  // Returns true if the computation was changed, false otherwise.
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+};
+
+// Returns true if 'hlo' is a call to a task outlined by InterOpTaskOutliner.
+// Only meaningful for modules the pass ran on: CallInliner leaves no other
+// calls in the entry computation, and the calls ParallelTaskAssigner outlines
+// are told apart by their partitioned root.
+bool IsInterOpTask(const HloInstruction& hlo);
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_INTER_OP_TASK_OUTLINER_H_
@@ -0,0 +1,107 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/inter_op_task_outliner.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_verified_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace op = xla::testing::opcode_matchers;
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class InterOpTaskOutlinerTest : public HloVerifiedTestBase {
+ protected:
+  StatusOr<bool> RunInterOpTaskOutliner(HloModule* module) {
+    return InterOpTaskOutliner([](const Shape& shape) {
+             return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+           })
+        .Run(module);
+  }
+};
+
+TEST_F(InterOpTaskOutlinerTest, OutlinesIndependentChains) {
+  const string hlo_string = R"(
+    HloModule IndependentChains
+    ENTRY Entry {
+      p0 = f32[128,128]{1,0} parameter(0)
+      exp = f32[128,128]{1,0} exponential(p0)
+      negate = f32[128,128]{1,0} negate(exp)
+      log = f32[128,128]{1,0} log(p0)
+      tanh = f32[128,128]{1,0} tanh(log)
+      ROOT tuple = (f32[128,128]{1,0}, f32[128,128]{1,0}) tuple(negate, tanh)
+    }
+  )";
+
+  ParseAndVerifyModule(hlo_string);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunInterOpTaskOutliner(&module()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* root = module().entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::Call(op::Parameter(0)),
+                              op::Call(op::Parameter(0))));
+  EXPECT_TRUE(IsInterOpTask(*root->operand(0)));
+  EXPECT_TRUE(IsInterOpTask(*root->operand(1)));
+  EXPECT_THAT(root->operand(0)->to_apply()->root_instruction(),
+              op::Negate(op::Exp(op::Parameter(0))));
+  EXPECT_THAT(root->operand(1)->to_apply()->root_instruction(),
+              op::Tanh(op::Log(op::Parameter(0))));
+}
+
+TEST_F(InterOpTaskOutlinerTest, DoesNotOutlineDependentChains) {
+  // The add joins the chain of the negate, which then depends on the other
+  // chain.
+  const string hlo_string = R"(
+    HloModule DependentChains
+    ENTRY Entry {
+      p0 = f32[128,128]{1,0} parameter(0)
+      exp = f32[128,128]{1,0} exponential(p0)
+      negate = f32[128,128]{1,0} negate(exp)
+      log = f32[128,128]{1,0} log(p0)
+      tanh = f32[128,128]{1,0} tanh(log)
+      ROOT add = f32[128,128]{1,0} add(negate, tanh)
+    }
+  )";
+
+  ParseAndVerifyModule(hlo_string);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunInterOpTaskOutliner(&module()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(InterOpTaskOutlinerTest, DoesNotOutlineSmallChains) {
+  const string hlo_string = R"(
+    HloModule SmallChains
+    ENTRY Entry {
+      p0 = f32[16,16]{1,0} parameter(0)
+      exp = f32[16,16]{1,0} exponential(p0)
+      negate = f32[16,16]{1,0} negate(exp)
+      log = f32[16,16]{1,0} log(p0)
+      tanh = f32[16,16]{1,0} tanh(log)
+      ROOT tuple = (f32[16,16]{1,0}, f32[16,16]{1,0}) tuple(negate, tanh)
+    }
+  )";
+
+  ParseAndVerifyModule(hlo_string);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunInterOpTaskOutliner(&module()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
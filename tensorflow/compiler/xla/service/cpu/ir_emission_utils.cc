@@ -111,5 +111,39 @@ bool PotentiallyImplementedAsEigenConvolution(
              kernel_shape.dimensions_size() - 1;
 }
 
+bool IsWideningIntegerConvert(const HloInstruction& hlo) {
+  if (hlo.opcode() != HloOpcode::kConvert ||
+      hlo.shape().element_type() != S32) {
+    return false;
+  }
+  PrimitiveType operand_type = hlo.operand(0)->shape().element_type();
+  return operand_type == S8 || operand_type == U8;
+}
+
+bool IsWideningIntegerDotFusion(const HloInstruction& hlo) {
+  if (hlo.opcode() != HloOpcode::kFusion ||
+      hlo.fusion_kind() != HloInstruction::FusionKind::kLoop) {
+    return false;
+  }
+  const HloInstruction* dot = hlo.fused_expression_root();
+  if (dot->opcode() != HloOpcode::kDot ||
+      dot->shape().element_type() != S32) {
+    return false;
+  }
+  const DotDimensionNumbers& dim_numbers = dot->dot_dimension_numbers();
+  if (dim_numbers.lhs_batch_dimensions_size() > 0 ||
+      dim_numbers.rhs_batch_dimensions_size() > 0 ||
+      dim_numbers.lhs_contracting_dimensions_size() != 1) {
+    return false;
+  }
+  for (const HloInstruction* operand : dot->operands()) {
+    if (!IsWideningIntegerConvert(*operand) ||
+        operand->operand(0)->opcode() != HloOpcode::kParameter) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -32,6 +32,14 @@ bool PotentiallyImplementedAsEigenConvolution(
 int64 GetMinimumAlignmentForArray(
     const Shape& shape, const TargetMachineFeatures& target_machine_features);
 
+// Returns true if `hlo` converts an S8 or U8 array to S32.
+bool IsWideningIntegerConvert(const HloInstruction& hlo);
+
+// Returns true if `hlo` is a loop fusion computing a dot with S32 accumulation
+// whose operands are fusion parameters widened by IsWideningIntegerConvert
+// conversions.  DotOpEmitter emits these directly from the 8-bit parameters.
+bool IsWideningIntegerDotFusion(const HloInstruction& hlo);
+
 // Dynamic loop bounds are specified as an array of dimension index
 // [start, limit) pairs of ir values (one for each partitioned outer dimension).
 //
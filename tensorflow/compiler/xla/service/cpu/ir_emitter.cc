@@ -21,6 +21,7 @@ limitations under the License.
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -30,6 +31,7 @@ limitations under the License.
 #include "llvm/CodeGen/TargetRegisterInfo.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/BasicBlock.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/Instructions.h"
@@ -42,14 +44,17 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/elemental_ir_emitter.h"
+#include "tensorflow/compiler/xla/service/cpu/inter_op_task_outliner.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_function.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_loop_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/shape_partition.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
+#include "tensorflow/compiler/xla/service/cpu/vector_support_library.h"
 #include "tensorflow/compiler/xla/service/elemental_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/kernel_support_library.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_loop.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/ops.h"
@@ -64,6 +69,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 
@@ -182,21 +188,65 @@ llvm::GlobalVariable* IrEmitter::EmitGlobalForLiteral(const Literal& literal) {
     result->setAlignment(MinimumAlignmentForShape(literal.shape()));
     external_constant_pool_->Insert(global_name, literal,
                                     MinimumAlignmentForShape(literal.shape()));
-  } else {
+  } else if (ByteSizeOf(literal.shape()) >= kMaxInternalConstantSizeInBytes) {
+    // Without an external constant pool, i.e. when compiling ahead of time,
+    // name large constants after their contents and alignment and let the
+    // linker keep one copy of each, so that functions compiled from modules
+    // with the same constants and linked into one binary share them.
+    const char* data = static_cast<const char*>(literal.untyped_data());
+    const int64 size = ByteSizeOf(literal.shape());
+    const int alignment = MinimumAlignmentForShape(literal.shape());
+    string global_name = tensorflow::strings::StrCat(
+        "__xla_constant_",
+        tensorflow::strings::Hex(tensorflow::Hash64(data, size),
+                                 tensorflow::strings::ZERO_PAD_16),
+        tensorflow::strings::Hex(
+            tensorflow::Hash64(data, size, /*seed=*/0x9E3779B97F4A7C15ULL),
+            tensorflow::strings::ZERO_PAD_16),
+        "_", size, "_", alignment);
     llvm::Constant* initializer =
         llvm_ir::ConvertLiteralToIrConstant(literal, module_);
+    result = module_->getNamedGlobal(AsStringRef(global_name));
+    if (result != nullptr) {
+      // A constant with the same bytes was emitted already, possibly with
+      // another shape.
+      return result->getValueType() == initializer->getType()
+                 ? result
+                 : EmitPrivateGlobalForConstant(initializer, literal.shape());
+    }
     result = new llvm::GlobalVariable(
         /*Module=*/*module_,
         /*Type=*/initializer->getType(),
         /*isConstant=*/true,
-        /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
+        /*Linkage=*/llvm::GlobalValue::LinkOnceODRLinkage,
         /*Initializer=*/initializer,
-        /*Name=*/"");
-    result->setAlignment(MinimumAlignmentForShape(literal.shape()));
+        /*Name=*/AsStringRef(global_name));
+    result->setAlignment(alignment);
+    result->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    if (llvm::Triple(module_->getTargetTriple()).supportsCOMDAT()) {
+      result->setComdat(module_->getOrInsertComdat(result->getName()));
+    }
+  } else {
+    llvm::Constant* initializer =
+        llvm_ir::ConvertLiteralToIrConstant(literal, module_);
+    result = EmitPrivateGlobalForConstant(initializer, literal.shape());
   }
   return result;
 }
 
+llvm::GlobalVariable* IrEmitter::EmitPrivateGlobalForConstant(
+    llvm::Constant* initializer, const Shape& shape) {
+  llvm::GlobalVariable* result = new llvm::GlobalVariable(
+      /*Module=*/*module_,
+      /*Type=*/initializer->getType(),
+      /*isConstant=*/true,
+      /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
+      /*Initializer=*/initializer,
+      /*Name=*/"");
+  result->setAlignment(MinimumAlignmentForShape(shape));
+  return result;
+}
+
 Status IrEmitter::HandleConstant(HloInstruction* constant) {
   VLOG(2) << "HandleConstant: " << constant->ToString();
   const Literal& literal = constant->literal();
@@ -1616,6 +1666,151 @@ void IrEmitter::EmitShardedVectorStore(
   }
 }
 
+llvm::Value* IrEmitter::EmitHorizontalReduction(
+    const ReductionGenerator& reduction_generator, llvm::Value* vector) {
+  // Repeatedly combine the upper half of the remaining lanes with the lower
+  // half, leaving the result in lane 0.
+  const uint32 vector_size = vector->getType()->getVectorNumElements();
+  llvm::Value* undef = llvm::UndefValue::get(vector->getType());
+  for (uint32 width = vector_size / 2; width >= 1; width /= 2) {
+    std::vector<uint32> mask(vector_size);
+    for (uint32 i = 0; i < vector_size; ++i) {
+      mask[i] = i < width ? i + width : i;
+    }
+    vector = reduction_generator(
+        &ir_builder_, vector,
+        ir_builder_.CreateShuffleVector(vector, undef, mask));
+  }
+  return ir_builder_.CreateExtractElement(vector, ir_builder_.getInt32(0));
+}
+
+Status IrEmitter::EmitVectorizedReduceOverMinorDimension(
+    HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+    gtl::ArraySlice<int64> dimensions,
+    const ReductionGenerator& reduction_generator, int vector_size,
+    int num_accumulators) {
+  // With M the minor dimension of the argument, R0, R1 the other reduced
+  // dimensions, VS the vector size and K the number of accumulators, we lower
+  // the reduction as:
+  //
+  //  for (output index o) {
+  //    vector_acc[0..K) = init
+  //    scalar_acc = init
+  //    for (r1 in R1) {
+  //      for (r0 in R0) {
+  //        for (m in M with stride K * VS) {
+  //          for (k in [0, K)) {
+  //            vector_acc[k] = elementwise_reduce(
+  //                vector_acc[k], input[o, r1, r0, m + k * VS : +VS])
+  //          }
+  //        }
+  //        reduce the remaining whole vectors into vector_acc[0], and the
+  //        remaining elements into scalar_acc
+  //      }
+  //    }
+  //    output[o] = reduce(scalar_acc, horizontal_reduce(vector_acc[0..K)))
+  //  }
+  //
+  // The independent accumulators hide the latency of the reduction operation.
+  const int64 minor_dimension = LayoutUtil::Minor(arg->shape().layout(), 0);
+  const int64 minor_dimension_size = arg->shape().dimensions(minor_dimension);
+  std::vector<int64> outer_reduced_dimensions;
+  for (int64 dimension : dimensions) {
+    if (dimension != minor_dimension) {
+      outer_reduced_dimensions.push_back(dimension);
+    }
+  }
+
+  return EmitTargetElementLoop(
+      reduce, [&](const llvm_ir::IrArray::Index& index) {
+        VectorSupportLibrary vsl(reduce->shape().element_type(), vector_size,
+                                 &ir_builder_, IrName(reduce, "vector"));
+        llvm::Value* init_value_ssa =
+            ir_builder_.CreateLoad(GetEmittedValueFor(init_value));
+        std::vector<VectorVariable> vector_accumulators;
+        for (int k = 0; k < num_accumulators; ++k) {
+          vector_accumulators.emplace_back(&vsl,
+                                           vsl.BroadcastScalar(init_value_ssa));
+        }
+        ScalarVariable scalar_accumulator(&vsl, init_value_ssa);
+
+        llvm_ir::ForLoopNest loops(IrName(reduce, "inner"), &ir_builder_);
+        llvm_ir::IrArray::Index input_index =
+            loops.AddLoopsForShapeOnDimensions(
+                arg->shape(), outer_reduced_dimensions, "reduction_dim");
+        if (llvm::BasicBlock* inner_loop_body =
+                loops.GetInnerLoopBodyBasicBlock()) {
+          SetToFirstInsertPoint(inner_loop_body, &ir_builder_);
+        }
+
+        // Fill in the dimensions of the target array from "index", and start
+        // at the beginning of the minor dimension.
+        input_index[minor_dimension] = ir_builder_.getInt64(0);
+        llvm_ir::IrArray::Index::const_iterator it = index.begin();
+        for (size_t i = 0; i < input_index.size(); ++i) {
+          if (input_index[i] == nullptr) {
+            input_index[i] = *it++;
+          }
+        }
+        CHECK(index.end() == it);
+
+        llvm_ir::IrArray arg_array(GetIrArrayFor(arg));
+        llvm::Value* row_address =
+            arg_array.EmitArrayElementAddress(input_index, &ir_builder_);
+        auto reduce_vector = [&](VectorVariable* accumulator,
+                                 llvm::Value* offset) {
+          llvm::Value* input = vsl.LoadVector(row_address, offset);
+          arg_array.AnnotateLoadStoreInstructionWithMetadata(
+              llvm::cast<llvm::Instruction>(input));
+          accumulator->Set(
+              reduction_generator(&ir_builder_, accumulator->Get(), input));
+        };
+
+        const int64 stride = int64{num_accumulators} * vector_size;
+        const int64 strided_end =
+            RoundDownToNearest<int64>(minor_dimension_size, stride);
+        if (strided_end > 0) {
+          KernelSupportLibrary ksl(&ir_builder_);
+          ksl.For(IrName(reduce, "minor"), /*start=*/0, /*end=*/strided_end,
+                  /*step=*/stride, [&](llvm::Value* m) {
+                    for (int k = 0; k < num_accumulators; ++k) {
+                      reduce_vector(
+                          &vector_accumulators[k],
+                          ir_builder_.CreateAdd(
+                              m, ir_builder_.getInt64(k * vector_size)));
+                    }
+                  });
+        }
+
+        const int64 vector_end =
+            RoundDownToNearest<int64>(minor_dimension_size, vector_size);
+        for (int64 m = strided_end; m < vector_end; m += vector_size) {
+          reduce_vector(&vector_accumulators[0], ir_builder_.getInt64(m));
+        }
+        for (int64 m = vector_end; m < minor_dimension_size; ++m) {
+          llvm::Value* input = vsl.LoadScalar(row_address, m);
+          arg_array.AnnotateLoadStoreInstructionWithMetadata(
+              llvm::cast<llvm::Instruction>(input));
+          scalar_accumulator.Set(reduction_generator(
+              &ir_builder_, scalar_accumulator.Get(), input));
+        }
+
+        if (llvm::BasicBlock* outer_loop_exit =
+                loops.GetOuterLoopExitBasicBlock()) {
+          SetToFirstInsertPoint(outer_loop_exit, &ir_builder_);
+        }
+
+        llvm::Value* vector_result = vector_accumulators[0].Get();
+        for (int k = 1; k < num_accumulators; ++k) {
+          vector_result = reduction_generator(&ir_builder_, vector_result,
+                                              vector_accumulators[k].Get());
+        }
+        return reduction_generator(
+            &ir_builder_, scalar_accumulator.Get(),
+            EmitHorizontalReduction(reduction_generator, vector_result));
+      });
+}
+
 StatusOr<bool> IrEmitter::EmitVectorizedReduce(
     HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
     gtl::ArraySlice<int64> dimensions, HloComputation* function,
@@ -1648,9 +1843,20 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
       MinimumAlignmentForPrimitiveType(reduce->shape().element_type()));
 
   if (is_reduction_over_minor_dimension) {
-    // TODO(sanjoy): Implement vectorized reduction over the minor dimension.
-    *failure_reason = "reduction over minor dimension not implemented";
-    return false;
+    const int vector_register_size_in_elements =
+        target_machine_features_.vector_register_byte_size(
+            *compute_function_->function()) /
+        ShapeUtil::ByteSizeOfPrimitiveType(reduce->shape().element_type());
+    if (vector_register_size_in_elements < 2 ||
+        !IsPowerOfTwo(static_cast<uint64>(vector_register_size_in_elements))) {
+      *failure_reason = "no suitable vector type for the minor dimension";
+      return false;
+    }
+    TF_RETURN_IF_ERROR(EmitVectorizedReduceOverMinorDimension(
+        reduce, arg, init_value, dimensions, reduction_generator,
+        vector_register_size_in_elements,
+        std::max(1, vectorization_factor / vector_register_size_in_elements)));
+    return true;
   }
 
   CHECK(!ShapeUtil::IsTuple(reduce->shape()));
@@ -2101,6 +2307,24 @@ Status IrEmitter::HandleFusion(HloInstruction* fusion) {
     return llvm_ir::EmitFusedDynamicUpdateSliceInPlace(
         fusion, operands, GetIrArrayFor(fusion), &elemental_emitter,
         &ir_builder_);
+  } else if (IsWideningIntegerDotFusion(*fusion)) {
+    VLOG(3) << "HandleFusion widening integer dot";
+    int64 dot_lhs_param_number =
+        root->operand(0)->operand(0)->parameter_number();
+    int64 dot_rhs_param_number =
+        root->operand(1)->operand(0)->parameter_number();
+
+    TF_RETURN_IF_ERROR(EmitTargetAddressForOp(fusion));
+    llvm_ir::IrArray target_array = GetIrArrayFor(fusion);
+    llvm_ir::IrArray lhs_array(
+        GetIrArrayFor(fusion->operand(dot_lhs_param_number)));
+    llvm_ir::IrArray rhs_array(
+        GetIrArrayFor(fusion->operand(dot_rhs_param_number)));
+
+    return DotOpEmitter::EmitDotOperation(
+        *root, target_array, lhs_array, rhs_array, /*addend_array=*/nullptr,
+        GetExecutableRunOptionsArgument(), &ir_builder_, hlo_module_config_,
+        target_machine_features_);
   } else if (fusion->fusion_kind() == HloInstruction::FusionKind::kLoop) {
     VLOG(3) << "HandleFusion kLoop";
     CpuElementalIrEmitter elemental_emitter(hlo_module_config_, this, module_);
@@ -2154,7 +2378,17 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
 
   TF_RETURN_IF_ERROR(EmitTargetAddressForOp(call));
 
-  if (!computation->root_instruction()->outer_dimension_partitions().empty()) {
+  if (IsDeferredTask(*call)) {
+    pending_tasks_.emplace_back(
+        call, GetArrayFunctionCallArguments(
+                  parameter_addresses, &ir_builder_, computation->name(),
+                  /*return_value_buffer=*/emitted_value_[call],
+                  /*exec_run_options_arg=*/GetExecutableRunOptionsArgument(),
+                  /*temp_buffers_arg=*/GetTempBuffersArgument(),
+                  /*profile_counters_arg=*/GetProfileCountersArgument()));
+  } else if (!computation->root_instruction()
+                  ->outer_dimension_partitions()
+                  .empty()) {
     // ParallelTaskAssignment assigned partitions, emit call to
     // ParallelForkJoin.
     std::vector<llvm::Value*> call_args = GetArrayFunctionCallArguments(
@@ -2176,6 +2410,47 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
   return Status::OK();
 }
 
+bool IrEmitter::IsDeferredTask(const HloInstruction& hlo) const {
+  return is_top_level_computation_ &&
+         hlo_module_config_.debug_options().xla_cpu_inter_op_parallelism() &&
+         IsInterOpTask(hlo);
+}
+
+Status IrEmitter::EmitPendingTasks() {
+  if (pending_tasks_.empty()) {
+    return Status::OK();
+  }
+  std::vector<PendingTask> tasks;
+  tasks.swap(pending_tasks_);
+  if (tasks.size() == 1) {
+    ir_builder_.CreateCall(
+        FindOrDie(emitted_functions_, tasks[0].first->to_apply()),
+        tasks[0].second);
+    return Status::OK();
+  }
+
+  std::unordered_map<const HloInstruction*, int32> task_index;
+  std::vector<std::vector<llvm::Value*>> task_arguments;
+  std::vector<llvm::Function*> task_functions;
+  std::vector<std::vector<int32>> task_successors(tasks.size());
+  for (int32 i = 0; i < static_cast<int32>(tasks.size()); ++i) {
+    const HloInstruction* call = tasks[i].first;
+    for (const HloInstruction* operand : call->unique_operands()) {
+      auto it = task_index.find(operand);
+      if (it != task_index.end()) {
+        task_successors[it->second].push_back(i);
+      }
+    }
+    task_index[call] = i;
+    task_arguments.push_back(std::move(tasks[i].second));
+    task_functions.push_back(FindOrDie(emitted_functions_, call->to_apply()));
+  }
+  VLOG(2) << "Emitting a task graph of " << tasks.size() << " tasks";
+  return EmitCallToExecuteTaskGraph(task_arguments, task_functions,
+                                    task_successors, &ir_builder_,
+                                    tasks[0].first->name());
+}
+
 Status IrEmitter::HandleCustomCall(HloInstruction* custom_call) {
   gtl::ArraySlice<HloInstruction*> operands(custom_call->operands());
   tensorflow::StringPiece custom_call_target(custom_call->custom_call_target());
@@ -2531,6 +2806,7 @@ Status IrEmitter::FinishVisit(HloInstruction* root) {
   // nothing to do since the result was already written directly into the output
   // buffer.
   VLOG(2) << "FinishVisit root: " << root->ToString();
+  TF_RETURN_IF_ERROR(EmitPendingTasks());
   if (root->opcode() == HloOpcode::kOutfeed) {
     VLOG(2) << "  outfeed with value: "
             << llvm_ir::DumpToString(*GetEmittedValueFor(root->operand(0)));
@@ -2637,6 +2913,15 @@ void IrEmitter::ProfilingState::RecordCompleteComputation(
 
 Status IrEmitter::Preprocess(HloInstruction* hlo) {
   VLOG(3) << "Visiting: " << hlo->ToString();
+  // Run the deferred tasks before the first instruction that needs one of
+  // them, other than another task.
+  if (!IsDeferredTask(*hlo) &&
+      std::any_of(pending_tasks_.begin(), pending_tasks_.end(),
+                  [hlo](const PendingTask& task) {
+                    return hlo->IsUserOf(task.first);
+                  })) {
+    TF_RETURN_IF_ERROR(EmitPendingTasks());
+  }
   if (instruction_to_profile_idx_.count(hlo)) {
     profiling_state_.RecordCycleStart(&ir_builder_, hlo);
   }
@@ -376,6 +376,21 @@ class IrEmitter : public DfsHloVisitorWithDefault {
       HloInstruction* arg, tensorflow::gtl::ArraySlice<int64> dimensions,
       unsigned element_alignment);
 
+  // Emits a reduction over dimensions that include the minor dimension of
+  // "arg", loading "vector_size" wide vectors along that dimension into
+  // "num_accumulators" independent accumulators.  Helper function for
+  // EmitVectorizedReduce.
+  Status EmitVectorizedReduceOverMinorDimension(
+      HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+      tensorflow::gtl::ArraySlice<int64> dimensions,
+      const ReductionGenerator& reduction_generator, int vector_size,
+      int num_accumulators);
+
+  // Reduces the lanes of "vector", whose size must be a power of two, to a
+  // scalar using "reduction_generator".
+  llvm::Value* EmitHorizontalReduction(
+      const ReductionGenerator& reduction_generator, llvm::Value* vector);
+
   // Tries to emit a fast concatenate operation using memcpy.  Returns true if
   // successful, and false on failure.  On failure, sets "failure_reason" to a
   // string describing why it could not emit a fast concatenate.
@@ -528,11 +543,28 @@ class IrEmitter : public DfsHloVisitorWithDefault {
                            llvm::Value* program_buffer_address);
 
   llvm::GlobalVariable* EmitGlobalForLiteral(const Literal& literal);
+  llvm::GlobalVariable* EmitPrivateGlobalForConstant(
+      llvm::Constant* initializer, const Shape& shape);
+
+  // Returns true if 'hlo' is a call to an inter-op task, which is deferred
+  // until an instruction uses its result so that it can run concurrently with
+  // other tasks.
+  bool IsDeferredTask(const HloInstruction& hlo) const;
+
+  // Emits a call to the runtime task graph function running the deferred
+  // tasks, or a plain call if there is just one.
+  Status EmitPendingTasks();
 
   const HloModuleConfig& hlo_module_config_;
 
   bool is_top_level_computation_;
 
+  // The deferred inter-op task calls, in the order they were visited, and the
+  // compute function arguments of each.
+  using PendingTask =
+      std::pair<const HloInstruction*, std::vector<llvm::Value*>>;
+  std::vector<PendingTask> pending_tasks_;
+
   const TargetMachineFeatures& target_machine_features_;
 
   int64 external_global_constant_counter_ = 0;
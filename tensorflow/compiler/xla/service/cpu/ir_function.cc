@@ -329,5 +329,116 @@ Status EmitCallToParallelForkJoin(
   return Status::OK();
 }
 
+// Emits a call to a runtime task graph function which calls each compute
+// function in 'task_functions' with its 'task_arguments' once all the tasks
+// that list it in 'task_successors' have returned.
+Status EmitCallToExecuteTaskGraph(
+    const std::vector<std::vector<llvm::Value*>>& task_arguments,
+    const std::vector<llvm::Function*>& task_functions,
+    const std::vector<std::vector<int32>>& task_successors,
+    llvm::IRBuilder<>* ir_builder, const string& name) {
+  TF_RET_CHECK(!task_arguments.empty());
+  TF_RET_CHECK(task_arguments.size() == task_functions.size());
+  TF_RET_CHECK(task_arguments.size() == task_successors.size());
+  llvm::Module* module = ir_builder->GetInsertBlock()->getModule();
+  llvm::Type* i8_ptr_type = ir_builder->getInt8PtrTy();
+  llvm::Type* i8_ptr_ptr_type = i8_ptr_type->getPointerTo();
+  llvm::Type* i32_ptr_type = ir_builder->getInt32Ty()->getPointerTo();
+  const int32 num_tasks = task_arguments.size();
+
+  // Build ExecuteTaskGraph function type.
+  llvm::FunctionType* task_graph_type = llvm::FunctionType::get(
+      /*Result=*/ir_builder->getVoidTy(),
+      /*Params=*/
+      {// Executable run options, temp buffers and profile counters, which
+       // are shared by all tasks.
+       i8_ptr_type, i8_ptr_ptr_type,
+       llvm::Type::getInt64PtrTy(module->getContext()),
+       // Number of tasks.
+       ir_builder->getInt32Ty(),
+       // Compute function, result buffer and parameter address buffer of
+       // each task.
+       i8_ptr_ptr_type, i8_ptr_ptr_type, i8_ptr_ptr_type->getPointerTo(),
+       // Number of predecessors, successor offsets and successors.
+       i32_ptr_type, i32_ptr_type, i32_ptr_type},
+      /*isVarArg=*/false);
+
+  llvm::Function* task_graph_func =
+      llvm::cast<llvm::Function>(module->getOrInsertFunction(
+          runtime::kExecuteTaskGraphSymbolName, task_graph_type));
+  task_graph_func->setCallingConv(llvm::CallingConv::C);
+  task_graph_func->setDoesNotThrow();
+
+  // Creates a private constant global out of 'elements' and returns a pointer
+  // to its first element.
+  auto emit_constant_array = [&](llvm::Type* element_type,
+                                 const std::vector<llvm::Constant*>& elements,
+                                 tensorflow::StringPiece suffix) {
+    llvm::ArrayType* array_type =
+        llvm::ArrayType::get(element_type, elements.size());
+    llvm::GlobalVariable* global = new llvm::GlobalVariable(
+        /*M=*/*module,
+        /*Ty=*/array_type,
+        /*isConstant=*/true,
+        /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
+        /*Initializer=*/llvm::ConstantArray::get(array_type, elements),
+        /*Name=*/AsStringRef(tensorflow::strings::StrCat(name, suffix)));
+    return ir_builder->CreateBitCast(global, element_type->getPointerTo());
+  };
+
+  std::vector<llvm::Constant*> functions;
+  std::vector<int32> num_predecessors(num_tasks, 0);
+  std::vector<llvm::Constant*> successor_offsets;
+  std::vector<llvm::Constant*> successors;
+  for (int32 i = 0; i < num_tasks; ++i) {
+    functions.push_back(
+        llvm::ConstantExpr::getBitCast(task_functions[i], i8_ptr_type));
+    successor_offsets.push_back(ir_builder->getInt32(successors.size()));
+    for (int32 successor : task_successors[i]) {
+      TF_RET_CHECK(successor > i && successor < num_tasks);
+      ++num_predecessors[successor];
+      successors.push_back(ir_builder->getInt32(successor));
+    }
+  }
+  successor_offsets.push_back(ir_builder->getInt32(successors.size()));
+  std::vector<llvm::Constant*> num_predecessors_constants;
+  for (int32 count : num_predecessors) {
+    num_predecessors_constants.push_back(ir_builder->getInt32(count));
+  }
+
+  // The result and parameter address buffers are only known at run time.
+  llvm::Value* results = llvm_ir::EmitAllocaAtFunctionEntryWithCount(
+      i8_ptr_type, ir_builder->getInt32(num_tasks),
+      tensorflow::strings::StrCat(name, "_task_results"), ir_builder);
+  llvm::Value* params = llvm_ir::EmitAllocaAtFunctionEntryWithCount(
+      i8_ptr_ptr_type, ir_builder->getInt32(num_tasks),
+      tensorflow::strings::StrCat(name, "_task_params"), ir_builder);
+  for (int32 i = 0; i < num_tasks; ++i) {
+    ir_builder->CreateStore(
+        task_arguments[i][0],
+        ir_builder->CreateInBoundsGEP(results, {ir_builder->getInt64(i)}));
+    ir_builder->CreateStore(
+        task_arguments[i][2],
+        ir_builder->CreateInBoundsGEP(params, {ir_builder->getInt64(i)}));
+  }
+
+  const std::vector<llvm::Value*>& shared_arguments = task_arguments[0];
+  ir_builder->CreateCall(
+      task_graph_func,
+      {shared_arguments[1], shared_arguments[3], shared_arguments[4],
+       ir_builder->getInt32(num_tasks),
+       emit_constant_array(i8_ptr_type, functions, "_task_functions"), results,
+       params,
+       emit_constant_array(ir_builder->getInt32Ty(),
+                           num_predecessors_constants,
+                           "_task_num_predecessors"),
+       emit_constant_array(ir_builder->getInt32Ty(), successor_offsets,
+                           "_task_successor_offsets"),
+       emit_constant_array(ir_builder->getInt32Ty(), successors,
+                           "_task_successors")});
+
+  return Status::OK();
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -128,6 +128,16 @@ Status EmitCallToParallelForkJoin(
     llvm::IRBuilder<>* ir_builder, llvm::Function* parallel_function,
     const string& name);
 
+// Emits a call to a runtime task graph function which calls each compute
+// function in 'task_functions' with its 'task_arguments' once all the tasks
+// that list it in 'task_successors' have returned.  Tasks must be given in a
+// topological order.
+Status EmitCallToExecuteTaskGraph(
+    const std::vector<std::vector<llvm::Value*>>& task_arguments,
+    const std::vector<llvm::Function*>& task_functions,
+    const std::vector<std::vector<int32>>& task_successors,
+    llvm::IRBuilder<>* ir_builder, const string& name);
+
 }  // namespace cpu
 }  // namespace xla
 
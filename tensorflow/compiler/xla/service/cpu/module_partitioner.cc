@@ -0,0 +1,225 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/module_partitioner.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "tensorflow/compiler/xla/ptr_util.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+using ReferenceMap = std::unordered_map<const llvm::Function*,
+                                        std::vector<const llvm::GlobalObject*>>;
+
+// Appends the global definitions that `value` refers to, looking through
+// constant expressions, to `references`.
+void CollectReferences(const llvm::Value* value,
+                       std::vector<const llvm::GlobalObject*>* references) {
+  if (const auto* object = llvm::dyn_cast<llvm::GlobalObject>(value)) {
+    if (!object->isDeclaration()) {
+      references->push_back(object);
+    }
+  } else if (const auto* constant = llvm::dyn_cast<llvm::Constant>(value)) {
+    for (const llvm::Use& operand : constant->operands()) {
+      CollectReferences(operand.get(), references);
+    }
+  }
+}
+
+// Sets (*depth)[function] to one more than the largest depth of the functions
+// it refers to. Returns false if the references are cyclic.
+bool ComputeDepth(const llvm::Function* function,
+                  const ReferenceMap& references,
+                  std::unordered_map<const llvm::Function*, int>* depth) {
+  auto it = depth->find(function);
+  if (it != depth->end()) {
+    // A negative depth marks a function whose depth is being computed.
+    return it->second >= 0;
+  }
+  (*depth)[function] = -1;
+  int result = 0;
+  for (const llvm::GlobalObject* object : references.at(function)) {
+    const auto* callee = llvm::dyn_cast<llvm::Function>(object);
+    if (callee == nullptr) {
+      continue;
+    }
+    if (!ComputeDepth(callee, references, depth)) {
+      return false;
+    }
+    result = std::max(result, depth->at(callee) + 1);
+  }
+  (*depth)[function] = result;
+  return true;
+}
+
+}  // namespace
+
+std::vector<ModulePartition> PartitionModule(llvm::Module* module,
+                                             int max_partitions) {
+  std::vector<ModulePartition> partitions;
+  if (max_partitions < 2 || !module->alias_empty() ||
+      !module->ifunc_empty()) {
+    return partitions;
+  }
+
+  // All global variables go into the first partition, so their initializers
+  // must not refer to functions that may end up in a later one.
+  for (const llvm::GlobalVariable& global : module->globals()) {
+    std::vector<const llvm::GlobalObject*> references;
+    if (global.hasInitializer()) {
+      CollectReferences(global.getInitializer(), &references);
+    }
+    for (const llvm::GlobalObject* object : references) {
+      if (llvm::isa<llvm::Function>(object)) {
+        return partitions;
+      }
+    }
+  }
+
+  std::vector<const llvm::Function*> functions;
+  ReferenceMap references;
+  std::unordered_map<const llvm::Function*, int64> sizes;
+  for (const llvm::Function& function : *module) {
+    if (function.isDeclaration()) {
+      continue;
+    }
+    functions.push_back(&function);
+    std::vector<const llvm::GlobalObject*>& function_references =
+        references[&function];
+    int64& size = sizes[&function];
+    for (const llvm::BasicBlock& block : function) {
+      size += block.size();
+      for (const llvm::Instruction& instruction : block) {
+        for (const llvm::Use& operand : instruction.operands()) {
+          CollectReferences(operand.get(), &function_references);
+        }
+      }
+    }
+  }
+  if (functions.size() < 2) {
+    return partitions;
+  }
+
+  std::unordered_map<const llvm::Function*, int> depth;
+  for (const llvm::Function* function : functions) {
+    if (!ComputeDepth(function, references, &depth)) {
+      return partitions;
+    }
+  }
+
+  // Ordering the functions by depth makes every function refer only to
+  // functions before it, so cutting the order into contiguous pieces of about
+  // equal size yields partitions that only refer to earlier ones.
+  std::stable_sort(functions.begin(), functions.end(),
+                   [&](const llvm::Function* a, const llvm::Function* b) {
+                     return depth.at(a) < depth.at(b);
+                   });
+  int64 total_size = 0;
+  for (const llvm::Function* function : functions) {
+    total_size += sizes.at(function);
+  }
+  const int64 target_size = CeilOfRatio<int64>(total_size, max_partitions);
+
+  std::unordered_map<const llvm::GlobalObject*, int> partition_of;
+  int num_partitions = 1;
+  int64 partition_size = 0;
+  for (const llvm::Function* function : functions) {
+    if (partition_size >= target_size && num_partitions < max_partitions) {
+      ++num_partitions;
+      partition_size = 0;
+    }
+    partition_of[function] = num_partitions - 1;
+    partition_size += sizes.at(function);
+  }
+  if (num_partitions < 2) {
+    return partitions;
+  }
+  auto partition_index = [&](const llvm::GlobalObject* object) {
+    auto it = partition_of.find(object);
+    return it == partition_of.end() ? 0 : it->second;
+  };
+
+  std::unordered_set<const llvm::GlobalObject*> referenced_across_partitions;
+  for (const llvm::Function* function : functions) {
+    for (const llvm::GlobalObject* object : references.at(function)) {
+      if (partition_index(object) != partition_index(function)) {
+        referenced_across_partitions.insert(object);
+      }
+    }
+  }
+  for (llvm::GlobalObject& object : module->global_objects()) {
+    // Every partition gets declarations of the definitions it doesn't own,
+    // and declarations must be named.
+    if (!object.hasName()) {
+      object.setName("__xla_cpu_partitioned_global");
+    }
+    if (referenced_across_partitions.count(&object) > 0 &&
+        !object.hasExternalLinkage()) {
+      object.setLinkage(llvm::GlobalValue::ExternalLinkage);
+      object.setVisibility(llvm::GlobalValue::DefaultVisibility);
+    }
+  }
+
+  for (int i = 0; i < num_partitions; ++i) {
+    llvm::ValueToValueMapTy value_map;
+    std::unique_ptr<llvm::Module> cloned_module = llvm::CloneModule(
+        *module, value_map, [&](const llvm::GlobalValue* value) {
+          return partition_index(llvm::cast<llvm::GlobalObject>(value)) == i;
+        });
+    cloned_module->setModuleIdentifier(
+        tensorflow::strings::StrCat(module->getModuleIdentifier(), ".", i));
+
+    // Cloned modules share the LLVMContext of `module`, which can't be used
+    // from several threads at once. Round-trip them through bitcode to give
+    // each one a context of its own.
+    llvm::SmallVector<char, 0> bitcode;
+    llvm::raw_svector_ostream bitcode_stream(bitcode);
+    llvm::WriteBitcodeToFile(*cloned_module, bitcode_stream);
+
+    ModulePartition partition;
+    partition.context = MakeUnique<llvm::LLVMContext>();
+    partition.module = llvm::cantFail(llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(
+            llvm::StringRef(bitcode.data(), bitcode.size()),
+            cloned_module->getModuleIdentifier()),
+        *partition.context));
+    partitions.push_back(std::move(partition));
+  }
+  VLOG(1) << "Split " << module->getModuleIdentifier() << " into "
+          << num_partitions << " partitions";
+  return partitions;
+}
+
+}  // namespace cpu
+}  // namespace xla
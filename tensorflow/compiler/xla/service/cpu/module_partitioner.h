@@ -0,0 +1,51 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MODULE_PARTITIONER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MODULE_PARTITIONER_H_
+
+#include <memory>
+#include <vector>
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+
+namespace xla {
+namespace cpu {
+
+// An LLVM module together with the context that owns it.
+struct ModulePartition {
+  std::unique_ptr<llvm::LLVMContext> context;
+  std::unique_ptr<llvm::Module> module;
+};
+
+// Splits `module` along function boundaries into at most `max_partitions`
+// modules that can be optimized and compiled concurrently, each in its own
+// LLVMContext.
+//
+// Partitions are ordered so that a partition only refers to definitions in
+// itself or in earlier partitions; in particular all global variables live in
+// the first partition. Definitions that are referred to from another partition
+// are given external linkage in `module` before it is split.
+//
+// Returns an empty vector, leaving `module` untouched, if the module has too
+// few functions to split or its references between functions are cyclic.
+std::vector<ModulePartition> PartitionModule(llvm::Module* module,
+                                             int max_partitions);
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_MODULE_PARTITIONER_H_
@@ -0,0 +1,126 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/module_partitioner.h"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/Support/SourceMgr.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+std::unique_ptr<llvm::Module> ParseModule(const char* ir,
+                                          llvm::LLVMContext* context) {
+  llvm::SMDiagnostic diagnostic;
+  std::unique_ptr<llvm::Module> module =
+      llvm::parseAssemblyString(ir, diagnostic, *context);
+  CHECK(module != nullptr) << diagnostic.getMessage().str();
+  return module;
+}
+
+TEST(ModulePartitionerTest, PartitionsReferToEarlierPartitions) {
+  const char* ir = R"(
+@table = private constant [2 x i32] [i32 1, i32 2]
+
+define internal i32 @leaf(i32 %x) {
+  %p = getelementptr [2 x i32], [2 x i32]* @table, i32 0, i32 %x
+  %v = load i32, i32* %p
+  ret i32 %v
+}
+
+define internal i32 @middle(i32 %x) {
+  %a = call i32 @leaf(i32 %x)
+  %b = add i32 %a, %a
+  ret i32 %b
+}
+
+define i32 @entry(i32 %x) {
+  %a = call i32 @middle(i32 %x)
+  %b = add i32 %a, %x
+  ret i32 %b
+}
+)";
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module = ParseModule(ir, &context);
+
+  std::vector<ModulePartition> partitions =
+      PartitionModule(module.get(), /*max_partitions=*/3);
+  ASSERT_EQ(partitions.size(), 3);
+
+  const llvm::Module& first = *partitions[0].module;
+  EXPECT_FALSE(first.getFunction("leaf")->isDeclaration());
+  EXPECT_TRUE(first.getFunction("middle")->isDeclaration());
+  EXPECT_TRUE(first.getFunction("entry")->isDeclaration());
+  // The table is only used by @leaf, so it can stay private.
+  EXPECT_TRUE(first.getNamedGlobal("table")->hasPrivateLinkage());
+
+  const llvm::Module& second = *partitions[1].module;
+  EXPECT_TRUE(second.getFunction("leaf")->isDeclaration());
+  EXPECT_FALSE(second.getFunction("middle")->isDeclaration());
+  EXPECT_TRUE(second.getFunction("entry")->isDeclaration());
+
+  const llvm::Module& third = *partitions[2].module;
+  EXPECT_TRUE(third.getFunction("middle")->isDeclaration());
+  EXPECT_FALSE(third.getFunction("entry")->isDeclaration());
+
+  // Functions called from another partition must be visible to it.
+  EXPECT_TRUE(first.getFunction("leaf")->hasExternalLinkage());
+  EXPECT_TRUE(second.getFunction("middle")->hasExternalLinkage());
+
+  // Every partition has a context of its own.
+  EXPECT_NE(&first.getContext(), &second.getContext());
+  EXPECT_NE(&first.getContext(), &context);
+}
+
+TEST(ModulePartitionerTest, DoesNotSplitCyclicReferences) {
+  const char* ir = R"(
+define internal i32 @ping(i32 %x) {
+  %a = call i32 @pong(i32 %x)
+  ret i32 %a
+}
+
+define internal i32 @pong(i32 %x) {
+  %a = call i32 @ping(i32 %x)
+  ret i32 %a
+}
+)";
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module = ParseModule(ir, &context);
+
+  EXPECT_TRUE(PartitionModule(module.get(), /*max_partitions=*/2).empty());
+  EXPECT_TRUE(module->getFunction("ping")->hasInternalLinkage());
+  EXPECT_TRUE(module->getFunction("pong")->hasInternalLinkage());
+}
+
+TEST(ModulePartitionerTest, DoesNotSplitSingleFunction) {
+  const char* ir = R"(
+define i32 @entry(i32 %x) {
+  ret i32 %x
+}
+)";
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module = ParseModule(ir, &context);
+
+  EXPECT_TRUE(PartitionModule(module.get(), /*max_partitions=*/4).empty());
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
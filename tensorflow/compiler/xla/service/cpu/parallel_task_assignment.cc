@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 
+#include <unordered_map>
+
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/cpu/shape_partition.h"
@@ -102,10 +104,43 @@ class DefaultCostModel : public ParallelCostModel {
   const std::unique_ptr<HloCostAnalysis> cost_analysis_;
 };
 
+// Derives parallel task counts from measured cycle counts, and defers to
+// another cost model for instructions that were not profiled.
+class ProfileGuidedCostModel : public ParallelCostModel {
+ public:
+  ProfileGuidedCostModel(const int64 max_parallelism,
+                         const HloExecutionProfileData& profile,
+                         std::unique_ptr<ParallelCostModel> fallback)
+      : max_parallelism_(max_parallelism), fallback_(std::move(fallback)) {
+    for (const auto& instruction_profile : profile.instruction_profiles()) {
+      cycles_[instruction_profile.name()] = instruction_profile.cycles();
+    }
+  }
+  ~ProfileGuidedCostModel() override {}
+
+  int64 GetParallelTaskCount(HloInstruction* instruction) override {
+    auto it = cycles_.find(instruction->name());
+    if (it == cycles_.end()) {
+      return fallback_->GetParallelTaskCount(instruction);
+    }
+    // Minimum per-thread cost is 100us of work on a 2GHz core.
+    const int64 min_cycles_per_thread = 200000;
+    // Return target parallel task count in [1, max_parallelism_].
+    return std::min(max_parallelism_,
+                    std::max(int64{1}, it->second / min_cycles_per_thread));
+  }
+
+ private:
+  const int64 max_parallelism_;
+  const std::unique_ptr<ParallelCostModel> fallback_;
+  std::unordered_map<string, int64> cycles_;
+};
+
 ParallelTaskAssignment::ParallelTaskAssignment(
     const int64 max_parallelism,
     const HloCostAnalysis::ShapeSizeFunction& shape_size, HloModule* module,
-    const TargetMachineFeatures* target_machine_features)
+    const TargetMachineFeatures* target_machine_features,
+    const HloExecutionProfileData* profile)
     : target_machine_features_(*target_machine_features) {
   VLOG(1) << "ParallelTaskAssignment max_parallelism: " << max_parallelism;
   // Run cost analysis on 'module'.
@@ -122,6 +157,10 @@ ParallelTaskAssignment::ParallelTaskAssignment(
     // HLOs like CustomCall are not yet implemented in the HloCostAnalysis).
     cost_model_.reset(new SimpleCostModel(max_parallelism, shape_size));
   }
+  if (profile != nullptr) {
+    cost_model_.reset(new ProfileGuidedCostModel(max_parallelism, *profile,
+                                                 std::move(cost_model_)));
+  }
 }
 
 int64 ParallelTaskAssignment::GetTargetParallelTaskCount(
@@ -129,7 +168,7 @@ int64 ParallelTaskAssignment::GetTargetParallelTaskCount(
   // Currently, we do not assign parallel tasks to instructions with at least
   // one of the following properties:
   // *) Internal threading (library calls to kConv, kDot, kFft, kCustomCall).
-  // *) Emit custom loops (kSelectAndScatter).
+  // *) Emit custom loops (kSelectAndScatter, widening integer dots).
   // *) Operations that are not thread safe (like infeed and rng).
   // *) Tuple-shaped.
   // TODO(b/27458679) Parallelize instructions which are skipped here.
@@ -147,6 +186,7 @@ int64 ParallelTaskAssignment::GetTargetParallelTaskCount(
                                        target_machine_features_) ||
       (opcode == HloOpcode::kFusion &&
        instruction->fusion_kind() != HloInstruction::FusionKind::kLoop) ||
+      IsWideningIntegerDotFusion(*instruction) ||
       ShapeUtil::IsTuple(instruction->shape())) {
     return 1;
   }
@@ -234,9 +274,9 @@ bool ParallelTaskAssigner::AssignParallelTasksHelper(
 
 void ParallelTaskAssigner::ComputeTargetParallelTasks(
     HloModule* module, HloToParallelTasks* hlo_to_parallel_tasks) {
-  ParallelTaskAssignment parallel_task_assignment(max_parallelism_,
-                                                  shape_size_function_, module,
-                                                  &target_machine_features_);
+  ParallelTaskAssignment parallel_task_assignment(
+      max_parallelism_, shape_size_function_, module, &target_machine_features_,
+      profile_);
 
   // Compute parallel task counts for all instructions in 'module'.
   for (auto* computation : module->computations()) {
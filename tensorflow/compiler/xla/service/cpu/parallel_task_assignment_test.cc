@@ -45,6 +45,19 @@ class ParallelTaskAssignmentTest : public HloVerifiedTestBase {
                                      &target_machine_features_)
         .Run(module);
   }
+
+  StatusOr<bool> RunParallelTaskAssignerWithProfile(HloModule* module,
+                                                    const string& name,
+                                                    int64 cycles) {
+    HloExecutionProfileData profile;
+    HloExecutionProfileData::InstructionProfile* instruction_profile =
+        profile.add_instruction_profiles();
+    instruction_profile->set_name(name);
+    instruction_profile->set_cycles(cycles);
+    return cpu::ParallelTaskAssigner(max_parallelism_, shape_size_func_,
+                                     &target_machine_features_, &profile)
+        .Run(module);
+  }
 };
 
 TEST_F(ParallelTaskAssignmentTest, DotOperationNotParallelized) {
@@ -120,5 +133,40 @@ TEST_F(ParallelTaskAssignmentTest, InfeedOutfeedOperationNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, SlowProfiledInstructionParallelized) {
+  // The cost model leaves an add this small on one thread.
+  const string hlo_string = R"(
+    HloModule TestTaskParallel_profiled_add
+    ENTRY Add {
+      lhs = f32[1024,8]{1,0} parameter(0)
+      rhs = f32[1024,8]{1,0} parameter(1)
+      ROOT add = f32[1024,8]{1,0} add(lhs, rhs)
+    }
+  )";
+
+  ParseAndVerifyModule(hlo_string);
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed, RunParallelTaskAssignerWithProfile(&module(), "add",
+                                                       /*cycles=*/10000000));
+  EXPECT_TRUE(changed);
+}
+
+TEST_F(ParallelTaskAssignmentTest, FastProfiledInstructionNotParallelized) {
+  const string hlo_string = R"(
+    HloModule TestTaskParallel_profiled_add
+    ENTRY Add {
+      lhs = f32[4096,4096]{1,0} parameter(0)
+      rhs = f32[4096,4096]{1,0} parameter(1)
+      ROOT add = f32[4096,4096]{1,0} add(lhs, rhs)
+    }
+  )";
+
+  ParseAndVerifyModule(hlo_string);
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      RunParallelTaskAssignerWithProfile(&module(), "add", /*cycles=*/1000));
+  EXPECT_FALSE(changed);
+}
+
 }  // namespace
 }  // namespace xla
@@ -74,6 +74,19 @@ void __xla_cpu_runtime_ParallelForkJoin(
   // Compute partition stride in 'partitions' array.
   const int64 stride = 2 * num_partitioned_dims;
 
+  // Without a thread pool, which ahead-of-time compiled code need not have,
+  // run the partitions one after the other.  Do the same on a thread of the
+  // pool, e.g. in an inter-op task, rather than block it waiting for others.
+  if (run_options->intra_op_thread_pool() == nullptr ||
+      run_options->intra_op_thread_pool()->currentThreadId() >= 0) {
+    for (int32 i = 0; i < num_partitions; ++i) {
+      function(result_ptr, run_options_ptr, params, temps,
+               &partitions[i * stride], prof_counters);
+    }
+    VLOG(2) << "ParallelForkJoin EXIT";
+    return;
+  }
+
   // Dispatch 'num_partitions - 1' compute functions to run in parallel.
   tensorflow::BlockingCounter bc(num_partitions - 1);
   for (int32 i = 1; i < num_partitions; ++i) {
@@ -0,0 +1,155 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/runtime_task_graph.h"
+
+#define EIGEN_USE_THREADS
+
+#include <atomic>
+#include <memory>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/types.h"
+
+using tensorflow::int32;
+using tensorflow::uint64;
+
+namespace {
+
+using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
+                                     uint64*);
+
+struct TaskGraph {
+  const xla::ExecutableRunOptions* run_options;
+  void** temps;
+  uint64* prof_counters;
+  void** functions;
+  void** results;
+  const void*** params;
+  int32* successor_offsets;
+  int32* successors;
+  // The number of predecessors of each task that have not returned yet.
+  std::unique_ptr<std::atomic<int32>[]> pending_predecessors;
+  tensorflow::BlockingCounter* done;
+};
+
+void RunTask(TaskGraph* graph, int32 task);
+
+void ScheduleTask(TaskGraph* graph, int32 task) {
+  graph->run_options->intra_op_thread_pool()->enqueueNoNotification(
+      [graph, task]() { RunTask(graph, task); });
+}
+
+// Runs 'task', then keeps the first successor it made ready on this thread and
+// hands the others to the thread pool.
+void RunTask(TaskGraph* graph, int32 task) {
+  while (task >= 0) {
+    ComputeFunctionType function =
+        reinterpret_cast<ComputeFunctionType>(graph->functions[task]);
+    function(graph->results[task], graph->run_options, graph->params[task],
+             graph->temps, graph->prof_counters);
+    VLOG(3) << "ExecuteTaskGraph task " << task << " done.";
+
+    int32 next_task = -1;
+    for (int32 i = graph->successor_offsets[task];
+         i < graph->successor_offsets[task + 1]; ++i) {
+      const int32 successor = graph->successors[i];
+      if (graph->pending_predecessors[successor].fetch_sub(1) == 1) {
+        if (next_task < 0) {
+          next_task = successor;
+        } else {
+          ScheduleTask(graph, successor);
+        }
+      }
+    }
+    // 'graph' may be gone once the last task is counted down.
+    graph->done->DecrementCount();
+    task = next_task;
+  }
+}
+
+}  // namespace
+
+// Task 'i' is run by calling 'functions[i]' with 'results[i]' and 'params[i]'
+// as its result and parameter address buffers, once the 'num_predecessors[i]'
+// tasks that list it as a successor have returned.
+//
+// The successors of task 'i' are the elements of 'successors' in
+// [successor_offsets[i], successor_offsets[i + 1]), so 'successor_offsets' has
+// 'num_tasks + 1' elements.  Tasks are numbered in a topological order, which
+// is the order they are run in when there is no thread pool.
+//
+// EX: Arrays for 'num_tasks = 3', where tasks 0 and 1 are independent and
+//     task 2 depends on both of them
+//
+//   num_predecessors:  [0, 0, 2]
+//   successor_offsets: [0, 1, 2, 2]
+//   successors:        [2, 2]
+//
+void __xla_cpu_runtime_ExecuteTaskGraph(
+    const void* run_options_ptr, void** temps, uint64* prof_counters,
+    int32 num_tasks, void** functions, void** results, const void*** params,
+    int32* num_predecessors, int32* successor_offsets, int32* successors) {
+  VLOG(2) << "ExecuteTaskGraph ENTRY"
+          << " num_tasks: " << num_tasks;
+  CHECK_GT(num_tasks, 0);
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+
+  if (run_options->intra_op_thread_pool() == nullptr) {
+    for (int32 i = 0; i < num_tasks; ++i) {
+      reinterpret_cast<ComputeFunctionType>(functions[i])(
+          results[i], run_options_ptr, params[i], temps, prof_counters);
+    }
+    VLOG(2) << "ExecuteTaskGraph EXIT";
+    return;
+  }
+
+  tensorflow::BlockingCounter done(num_tasks);
+  TaskGraph graph;
+  graph.run_options = run_options;
+  graph.temps = temps;
+  graph.prof_counters = prof_counters;
+  graph.functions = functions;
+  graph.results = results;
+  graph.params = params;
+  graph.successor_offsets = successor_offsets;
+  graph.successors = successors;
+  graph.pending_predecessors.reset(new std::atomic<int32>[num_tasks]);
+  for (int32 i = 0; i < num_tasks; ++i) {
+    graph.pending_predecessors[i].store(num_predecessors[i]);
+  }
+  graph.done = &done;
+
+  // Run the first task without predecessors inline, and dispatch the others.
+  int32 first_task = -1;
+  for (int32 i = 0; i < num_tasks; ++i) {
+    if (num_predecessors[i] != 0) {
+      continue;
+    }
+    if (first_task < 0) {
+      first_task = i;
+    } else {
+      ScheduleTask(&graph, i);
+    }
+  }
+  CHECK_GE(first_task, 0);
+  RunTask(&graph, first_task);
+  done.Wait();
+  VLOG(2) << "ExecuteTaskGraph EXIT";
+}
@@ -0,0 +1,35 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_TASK_GRAPH_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_TASK_GRAPH_H_
+
+#include "tensorflow/core/platform/types.h"
+
+extern "C" {
+
+// Calls the 'num_tasks' compute functions in 'functions', each one once all of
+// its predecessors have returned, and returns when all of them have. See
+// comments in runtime_task_graph.cc for details.
+extern void __xla_cpu_runtime_ExecuteTaskGraph(
+    const void* run_options_ptr, void** temps,
+    tensorflow::uint64* prof_counters, tensorflow::int32 num_tasks,
+    void** functions, void** results, const void*** params,
+    tensorflow::int32* num_predecessors, tensorflow::int32* successor_offsets,
+    tensorflow::int32* successors);
+
+}  // extern "C"
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_TASK_GRAPH_H_
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/ptr_util.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/custom_call_target_registry.h"
+#include "tensorflow/compiler/xla/service/cpu/module_partitioner.h"
 #include "tensorflow/compiler/xla/service/cpu/orc_jit_memory_mapper.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d_mkl.h"
@@ -40,8 +41,11 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_conv2d.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_fft.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_task_graph.h"
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -96,13 +100,24 @@ SimpleOrcJIT::SimpleOrcJIT(const llvm::TargetOptions& target_options,
                            bool disable_expensive_passes,
                            LLVMCompiler::ModuleHook pre_optimization_hook,
                            LLVMCompiler::ModuleHook post_optimization_hook)
-    : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      optimize_for_size_(optimize_for_size),
+      enable_fast_math_(enable_fast_math),
+      disable_expensive_passes_(disable_expensive_passes),
+      target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       disassembler_(*target_machine_),
       data_layout_(target_machine_->createDataLayout()),
       symbol_resolver_(llvm::orc::createLegacyLookupResolver(
           execution_session_,
           [this](const std::string& name) -> llvm::JITSymbol {
-            return this->ResolveRuntimeSymbol(name);
+            if (auto symbol = this->ResolveRuntimeSymbol(name)) {
+              return symbol;
+            }
+            // Definitions in other pieces of a module added with
+            // AddModuleInParallel.
+            return this->object_layer_.findSymbol(
+                name, /*ExportedSymbolsOnly=*/true);
           },
           [](llvm::Error Err) {
             cantFail(std::move(Err), "lookupFlags failed");
@@ -151,6 +166,46 @@ SimpleOrcJIT::VModuleKeyT SimpleOrcJIT::AddModule(
   return key;
 }
 
+void SimpleOrcJIT::AddModuleInParallel(std::unique_ptr<llvm::Module> module,
+                                       int max_partitions) {
+  std::vector<ModulePartition> partitions =
+      PartitionModule(module.get(), max_partitions);
+  if (partitions.empty()) {
+    AddModule(std::move(module));
+    return;
+  }
+
+  // TargetMachines can't be shared between threads, so every partition gets
+  // one of its own.
+  std::vector<std::unique_ptr<llvm::TargetMachine>> target_machines;
+  for (size_t i = 0; i < partitions.size(); ++i) {
+    target_machines.push_back(
+        InferTargetMachineForJIT(target_options_, opt_level_));
+  }
+  std::vector<ObjLayerT::ObjectPtr> object_files(partitions.size());
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "xla_cpu_codegen", partitions.size());
+    for (size_t i = 0; i < partitions.size(); ++i) {
+      pool.Schedule([this, i, &partitions, &target_machines, &object_files]() {
+        const Disassembler disassembler(*target_machines[i]);
+        CompilerFunctor compiler(target_machines[i].get(), &disassembler,
+                                 opt_level_, optimize_for_size_,
+                                 enable_fast_math_, disable_expensive_passes_);
+        object_files[i] = compiler(*partitions[i].module);
+      });
+    }
+  }
+
+  // Partitions only refer to earlier ones, so finalizing an object file while
+  // resolving a symbol of a later one never comes back to the later one.
+  for (ObjLayerT::ObjectPtr& object_file : object_files) {
+    auto key = execution_session_.allocateVModule();
+    cantFail(object_layer_.addObject(key, std::move(object_file)));
+    module_keys_.push_back(key);
+  }
+}
+
 void SimpleOrcJIT::RemoveModule(SimpleOrcJIT::VModuleKeyT key) {
   module_keys_.erase(std::remove(module_keys_.begin(), module_keys_.end(), key),
                      module_keys_.end());
@@ -208,6 +263,7 @@ bool RegisterKnownJITSymbols() {
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulF32);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulF64);
   REGISTER_CPU_RUNTIME_SYMBOL(ParallelForkJoin);
+  REGISTER_CPU_RUNTIME_SYMBOL(ExecuteTaskGraph);
   REGISTER_CPU_RUNTIME_SYMBOL(ReleaseInfeedBufferAfterDequeue);
   REGISTER_CPU_RUNTIME_SYMBOL(ReleaseOutfeedBufferAfterPopulation);
 
@@ -40,7 +40,9 @@ namespace cpu {
 // This class wraps Orc's functionality into a single interface that only
 // exposes what we need for XLA.
 //
-// Supports JIT-ing multiple modules but without cross-module linking.
+// Supports JIT-ing multiple modules. Modules added with AddModule are not
+// linked with each other; the pieces of a module added with
+// AddModuleInParallel are.
 // Implements eager compilation - the module is lowered to binary as soon as
 // it's added to the JIT.
 class SimpleOrcJIT {
@@ -82,6 +84,14 @@ class SimpleOrcJIT {
   // remove this module.
   VModuleKeyT AddModule(std::unique_ptr<llvm::Module> module);
 
+  // Like AddModule, but splits the module into up to |max_partitions| pieces
+  // (see PartitionModule) that are optimized and compiled concurrently and
+  // then linked with each other. The pieces are compiled without the
+  // optimization hooks, and calls between them can't be inlined. Falls back
+  // to AddModule if the module can't be split.
+  void AddModuleInParallel(std::unique_ptr<llvm::Module> module,
+                           int max_partitions);
+
   // Remove a module from the JIT and free the memory associated with it.
   void RemoveModule(VModuleKeyT key);
 
@@ -104,6 +114,14 @@ class SimpleOrcJIT {
  private:
   llvm::JITSymbol ResolveRuntimeSymbol(const std::string& name);
 
+  // Parameters for the compilers of the pieces of a module added with
+  // AddModuleInParallel.
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const bool optimize_for_size_;
+  const bool enable_fast_math_;
+  const bool disable_expensive_passes_;
+
   std::vector<VModuleKeyT> module_keys_;
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   const Disassembler disassembler_;
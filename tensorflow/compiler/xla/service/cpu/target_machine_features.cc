@@ -15,6 +15,13 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
 
+#include <algorithm>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Attributes.h"
+#include "llvm/IR/Function.h"
+
 namespace xla {
 namespace cpu {
 
@@ -56,5 +63,20 @@ int64 LLVMTargetMachineFeatures::minimum_alignment_for_allocation(
   return buffer_alignment;
 }
 
+bool LLVMTargetMachineFeatures::has_avx512_vnni(
+    const llvm::Function& function) const {
+  // A "target-features" attribute on the function overrides the features the
+  // target machine was created with.
+  llvm::StringRef features = target_machine_->getTargetFeatureString();
+  llvm::Attribute attribute = function.getFnAttribute("target-features");
+  if (attribute.isStringAttribute()) {
+    features = attribute.getValueAsString();
+  }
+  llvm::SmallVector<llvm::StringRef, 32> feature_list;
+  features.split(feature_list, ',');
+  return std::find(feature_list.begin(), feature_list.end(), "+avx512vnni") !=
+         feature_list.end();
+}
+
 }  // namespace cpu
 }  // namespace xla
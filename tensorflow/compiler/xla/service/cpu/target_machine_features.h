@@ -55,6 +55,11 @@ class TargetMachineFeatures {
   // Returns the minimum alignment for a buffer of size size_bytes.
   virtual int64 minimum_alignment_for_allocation(int64 size_bytes) const = 0;
 
+  // Returns true if code emitted into "function" may use the AVX-512 VNNI
+  // instructions, which accumulate dot products of groups of four 8-bit
+  // integers into 32-bit lanes.
+  virtual bool has_avx512_vnni(const llvm::Function& function) const = 0;
+
   virtual ~TargetMachineFeatures() = default;
 };
 
@@ -86,6 +91,8 @@ class LLVMTargetMachineFeatures : public TargetMachineFeatures {
 
   int64 minimum_alignment_for_allocation(int64 size_bytes) const override;
 
+  bool has_avx512_vnni(const llvm::Function& function) const override;
+
  private:
   llvm::TargetTransformInfo* GetTargetTransformInfoFor(
       const llvm::Function& function) const;
@@ -17,6 +17,7 @@ limitations under the License.
 #include <utility>
 
 #include "tensorflow/compiler/xla/array2d.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
 #include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -30,7 +31,7 @@ namespace cpu {
 namespace {
 class CpuExternalConstantsTest : public CpuCodegenTest {
  public:
-  void TestWithArray(int64 rows, int64 cols, const char* filecheck_pattern) {
+  std::unique_ptr<HloModule> CreateModuleWithArray(int64 rows, int64 cols) {
     HloComputation::Builder builder(TestName());
 
     Array2D<float> backing_array(rows, cols);
@@ -48,8 +49,11 @@ class CpuExternalConstantsTest : public CpuCodegenTest {
 
     std::unique_ptr<HloModule> module = CreateNewModule();
     module->AddEntryComputation(builder.Build());
+    return module;
+  }
 
-    CompileAndVerifyIr(std::move(module), filecheck_pattern,
+  void TestWithArray(int64 rows, int64 cols, const char* filecheck_pattern) {
+    CompileAndVerifyIr(CreateModuleWithArray(rows, cols), filecheck_pattern,
                        /*match_optimized_ir=*/false);
   }
 };
@@ -68,6 +72,20 @@ CHECK-NOT: @constant_global_0 = external constant [4 x [4 x float]], align 8
 CHECK: @0 = private constant [4 x [4 x float]] {{.*}}, align 8
 )");
 }
+
+TEST_F(CpuExternalConstantsTest, AheadOfTime) {
+  // Without an external constant pool, large constants are named after their
+  // contents so that the linker can fold copies from different modules.
+  CpuAotCompilationOptions options{
+      /*triple=*/"x86_64-pc-linux", /*cpu_name=*/"", /*features=*/"",
+      /*entry_point_name=*/"entry",
+      /*relocation_model=*/CpuAotCompilationOptions::RelocationModel::Static};
+  CompileAheadOfTimeAndVerifyIr(CreateModuleWithArray(/*rows=*/64, /*cols=*/64),
+                                options, R"(
+CHECK: @__xla_constant_{{[0-9a-f]+}}_16384_{{[0-9]+}} = linkonce_odr unnamed_addr constant [64 x [64 x float]] {{.*}}, comdat
+)",
+                                /*match_optimized_ir=*/false);
+}
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
@@ -0,0 +1,78 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tools/parser/hlo_parser.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+class CpuWideningIntegerDotTest : public CpuCodegenTest {
+ protected:
+  void CompileAndCheck(const string& features,
+                       const string& filecheck_pattern) {
+    // Both operands reduce along their minor dimension, so the dot is emitted
+    // with vector loads of the 8-bit operands.
+    const string hlo_text = R"(
+HloModule WideningIntegerDot
+
+ENTRY main {
+  lhs = s8[4,128] parameter(0)
+  rhs = u8[3,128] parameter(1)
+  lhs_wide = s32[4,128] convert(lhs)
+  rhs_wide = s32[3,128] convert(rhs)
+  ROOT dot = s32[4,3] dot(lhs_wide, rhs_wide), lhs_contracting_dims={1}, rhs_contracting_dims={1}
+}
+)";
+
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                            tools::Parse(hlo_text));
+
+    CpuAotCompilationOptions options{
+        /*triple=*/"x86_64-pc-linux", /*cpu_name=*/"", /*features=*/features,
+        /*entry_point_name=*/"entry",
+        /*relocation_model=*/CpuAotCompilationOptions::RelocationModel::Static};
+
+    CompileAheadOfTimeAndVerifyIr(std::move(module), options, filecheck_pattern,
+                                  /*match_optimized_ir=*/false);
+  }
+};
+
+TEST_F(CpuWideningIntegerDotTest, Avx2) {
+  CompileAndCheck("+avx2", R"(
+CHECK: load <8 x i8>
+CHECK: sext <8 x i8> {{.*}} to <8 x i32>
+CHECK: load <8 x i8>
+CHECK: zext <8 x i8> {{.*}} to <8 x i32>
+CHECK: mul <8 x i32>
+CHECK: add <8 x i32>
+)");
+}
+
+TEST_F(CpuWideningIntegerDotTest, Avx512Vnni) {
+  // With VNNI every 32-bit lane sums four adjacent products per iteration.
+  CompileAndCheck("+avx512f,+avx512bw,+avx512vnni", R"(
+CHECK: load <64 x i8>
+CHECK: sext <64 x i8> {{.*}} to <64 x i32>
+CHECK: mul <64 x i32>
+CHECK: shufflevector <64 x i32>
+CHECK: add <16 x i32>
+)");
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
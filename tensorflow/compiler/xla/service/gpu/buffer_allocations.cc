@@ -42,6 +42,8 @@ StatusOr<std::unique_ptr<BufferAllocations>> BufferAllocations::Builder::Build(
   const int64 num_buffers = buffer_assignment->Allocations().size();
   auto buffer_allocations = WrapUnique(new BufferAllocations(
       num_buffers, device_ordinal, memory_allocator, buffer_assignment));
+  buffer_allocations->temp_buffer_cache_ = temp_buffer_cache_;
+  buffer_allocations->executable_ = executable_;
 
   for (BufferAllocation::Index i = 0; i < num_buffers; ++i) {
     // If buffer #i's address is already registered (e.g. external arguments or
@@ -68,8 +70,15 @@ StatusOr<std::unique_ptr<BufferAllocations>> BufferAllocations::Builder::Build(
       se::DeviceMemoryBase buffer_address;
       if (buffer_size > 0) {
         OwningDeviceMemory buffer;
-        TF_ASSIGN_OR_RETURN(
-            buffer, memory_allocator->Allocate(device_ordinal, buffer_size));
+        if (temp_buffer_cache_ != nullptr &&
+            allocation.IsPreallocatedTempBuffer()) {
+          buffer = temp_buffer_cache_->Take(executable_, i, memory_allocator,
+                                            device_ordinal, buffer_size);
+        }
+        if (buffer.is_null()) {
+          TF_ASSIGN_OR_RETURN(
+              buffer, memory_allocator->Allocate(device_ordinal, buffer_size));
+        }
         if (reinterpret_cast<uintptr_t>(buffer.opaque()) %
                 kCudaMallocAlignBytes !=
             0) {
@@ -127,6 +136,14 @@ Status BufferAllocations::TearDown(
     se::DeviceMemoryBase buffer_address = GetDeviceAddress(allocation.index());
     // Deallocate buffers marked "maybe_live_out" but aren't actually live out,
     // and temp buffers.
+    if (temp_buffer_cache_ != nullptr &&
+        allocation.IsPreallocatedTempBuffer() && !buffer_address.is_null()) {
+      temp_buffer_cache_->GiveBack(
+          executable_, i,
+          OwningDeviceMemory(buffer_address, device_ordinal_,
+                             memory_allocator_));
+      continue;
+    }
     if ((allocation.maybe_live_out() &&
          !live_addresses.count(buffer_address)) ||
         allocation.IsPreallocatedTempBuffer()) {
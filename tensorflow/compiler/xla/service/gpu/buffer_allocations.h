@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/device_memory_allocator.h"
+#include "tensorflow/compiler/xla/service/temp_buffer_cache.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
@@ -43,6 +44,15 @@ class BufferAllocations {
     void RegisterBuffer(BufferAllocation::Index index,
                         se::DeviceMemoryBase address);
 
+    // Makes the built object take the temp buffer of `executable` from
+    // `temp_buffer_cache` if it holds one, and give it back there instead of
+    // deallocating it on TearDown.
+    void SetTempBufferCache(TempBufferCache* temp_buffer_cache,
+                            const Executable* executable) {
+      temp_buffer_cache_ = temp_buffer_cache;
+      executable_ = executable;
+    }
+
     // Builds a BufferAllocations object from the given buffer assignment.
     // `memory_allocator` is what this function uses to allocate device memory.
     // `device_ordinal` is the number of the device this function allocates
@@ -53,6 +63,8 @@ class BufferAllocations {
 
    private:
     std::map<BufferAllocation::Index, se::DeviceMemoryBase> registered_buffers_;
+    TempBufferCache* temp_buffer_cache_ = nullptr;
+    const Executable* executable_ = nullptr;
   };
 
   ~BufferAllocations();
@@ -104,6 +116,8 @@ class BufferAllocations {
   int device_ordinal_;
   DeviceMemoryAllocator* memory_allocator_;
   const BufferAssignment* buffer_assignment_;
+  TempBufferCache* temp_buffer_cache_ = nullptr;
+  const Executable* executable_ = nullptr;
   bool torn_down_ = false;
 };
 
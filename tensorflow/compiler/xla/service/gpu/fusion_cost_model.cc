@@ -0,0 +1,169 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fusion_cost_model.h"
+
+#include <algorithm>
+
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Time it takes to launch a kernel, in seconds.
+constexpr double kKernelLaunchSeconds = 5e-6;
+
+// Transcendental functions are computed by libdevice routines that take on
+// the order of this many instructions.
+constexpr double kFlopsPerTranscendental = 16;
+
+// Size of a device pointer, for the tuple buffers of multi-output fusions.
+constexpr int64 kPointerSize = 8;
+
+// Returns the number of single-precision fused multiply-adds a streaming
+// multiprocessor of the given compute capability issues per clock.
+int FmasPerCore(int cc_major, int cc_minor) {
+  switch (cc_major) {
+    case 3:
+      return 192;
+    case 5:
+      return 128;
+    case 6:
+      return cc_minor == 0 ? 64 : 128;
+    default:
+      return 64;
+  }
+}
+
+int64 ShapeSize(const Shape& shape) {
+  return ShapeUtil::ByteSizeOf(shape, kPointerSize);
+}
+
+// Returns the number of elements of the largest array in `shape`.
+int64 MaxArrayElements(const Shape& shape) {
+  int64 elements = 0;
+  ShapeUtil::ForEachSubshape(
+      shape, [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+        if (ShapeUtil::IsArray(subshape)) {
+          elements = std::max(elements, ShapeUtil::ElementsIn(subshape));
+        }
+      });
+  return elements;
+}
+
+}  // namespace
+
+FusionCostModel::FusionCostModel(
+    const se::DeviceDescription& device_description) {
+  int cc_major = 0;
+  int cc_minor = 0;
+  device_description.cuda_compute_capability(&cc_major, &cc_minor);
+  // Every fused multiply-add counts as two flops.
+  flops_per_second_ = 2.0 * FmasPerCore(cc_major, cc_minor) *
+                      device_description.core_count() *
+                      device_description.clock_rate_ghz() * 1e9;
+  transcendentals_per_second_ = flops_per_second_ / kFlopsPerTranscendental;
+  bytes_per_second_ = device_description.memory_bandwidth();
+}
+
+FusionCostModel::Cost FusionCostModel::GetCost(
+    HloInstruction* instruction) const {
+  HloCostAnalysis analysis(ShapeSize);
+  TF_CHECK_OK(analysis.Preprocess(instruction));
+  TF_CHECK_OK(instruction->Visit(&analysis));
+  TF_CHECK_OK(analysis.Postprocess(instruction));
+  Cost cost;
+  cost.flops = analysis.flop_count(*instruction);
+  cost.transcendentals = analysis.transcendental_count(*instruction);
+  cost.bytes_accessed = analysis.bytes_accessed(*instruction);
+  // HloCostAnalysis reports negative costs for custom calls, e.g. to cuDNN,
+  // whose costs it doesn't know. Such calls at least read their operands and
+  // write their output.
+  if (cost.bytes_accessed < 0) {
+    cost.bytes_accessed = ShapeSize(instruction->shape());
+    for (const HloInstruction* operand : instruction->operands()) {
+      cost.bytes_accessed += ShapeSize(operand->shape());
+    }
+  }
+  cost.flops = std::max(0.0, cost.flops);
+  cost.transcendentals = std::max(0.0, cost.transcendentals);
+  return cost;
+}
+
+double FusionCostModel::EstimateRunTime(const Cost& cost) const {
+  // Devices that don't report a property aren't bound by it.
+  auto seconds = [](double amount, double per_second) {
+    return per_second > 0 ? amount / per_second : 0.0;
+  };
+  return kKernelLaunchSeconds +
+         std::max({seconds(cost.flops, flops_per_second_),
+                   seconds(cost.transcendentals, transcendentals_per_second_),
+                   seconds(cost.bytes_accessed, bytes_per_second_)});
+}
+
+double FusionCostModel::EstimateRunTime(HloInstruction* instruction) const {
+  return EstimateRunTime(GetCost(instruction));
+}
+
+double FusionCostModel::EstimateRunTimeSavedByFusingIntoUsers(
+    HloInstruction* producer) const {
+  const Cost producer_cost = GetCost(producer);
+  const double producer_output_bytes = ShapeSize(producer->shape());
+  // Fusion replaces the read of the producer's output by reads of its
+  // operands.
+  const double producer_operand_bytes =
+      producer_cost.bytes_accessed - producer_output_bytes;
+
+  const int64 producer_elements = MaxArrayElements(producer->shape());
+
+  double saved_seconds = EstimateRunTime(producer_cost);
+  for (HloInstruction* user : producer->users()) {
+    const Cost user_cost = GetCost(user);
+    // A fused producer is computed once per element of the user's output, so
+    // users that broadcast it compute each element many times over.
+    const double recompute_factor =
+        producer_elements > 0
+            ? std::max(1.0, static_cast<double>(MaxArrayElements(
+                                user->shape())) /
+                                producer_elements)
+            : 1.0;
+    Cost fused_cost;
+    fused_cost.flops = user_cost.flops + recompute_factor * producer_cost.flops;
+    fused_cost.transcendentals =
+        user_cost.transcendentals +
+        recompute_factor * producer_cost.transcendentals;
+    fused_cost.bytes_accessed = user_cost.bytes_accessed -
+                                producer_output_bytes + producer_operand_bytes;
+    // Operands the user already reads aren't read twice.
+    for (const HloInstruction* operand : producer->unique_operands()) {
+      if (user->IsUserOf(operand)) {
+        fused_cost.bytes_accessed -= ShapeSize(operand->shape());
+      }
+    }
+    saved_seconds += EstimateRunTime(user_cost) - EstimateRunTime(fused_cost);
+  }
+  VLOG(3) << "Fusing " << producer->name() << " into its "
+          << producer->user_count() << " users is estimated to save "
+          << saved_seconds << "s";
+  return saved_seconds;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,66 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_COST_MODEL_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_COST_MODEL_H_
+
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+
+namespace xla {
+namespace gpu {
+
+// Estimates how long instructions run as GPU kernels on a particular device,
+// so that fusion passes can reject fusions that would make a program slower.
+//
+// A kernel is modeled as bound by whichever of memory bandwidth, arithmetic
+// throughput and transcendental throughput takes longest for the flops,
+// transcendentals and bytes HloCostAnalysis reports for it, plus a fixed
+// launch overhead. Fusing a producer into its users saves the producer's
+// launch and the round trip of its output through memory, but every user
+// recomputes the producer, which is what makes fusing expensive producers
+// into many users slower.
+class FusionCostModel {
+ public:
+  explicit FusionCostModel(const se::DeviceDescription& device_description);
+
+  // Returns the estimated run time, in seconds, of `instruction` as a kernel
+  // of its own.
+  double EstimateRunTime(HloInstruction* instruction) const;
+
+  // Returns the estimated run time, in seconds, saved by fusing `producer`
+  // into each of its users. The result is negative if the fused kernels are
+  // expected to be slower than the unfused ones.
+  double EstimateRunTimeSavedByFusingIntoUsers(HloInstruction* producer) const;
+
+ private:
+  struct Cost {
+    double flops = 0;
+    double transcendentals = 0;
+    double bytes_accessed = 0;
+  };
+
+  Cost GetCost(HloInstruction* instruction) const;
+  double EstimateRunTime(const Cost& cost) const;
+
+  double flops_per_second_;
+  double transcendentals_per_second_;
+  double bytes_per_second_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FUSION_COST_MODEL_H_
@@ -0,0 +1,94 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/fusion_cost_model.h"
+
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/tools/parser/hlo_parser.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class FusionCostModelTest : public HloTestBase {
+ protected:
+  FusionCostModelTest() {
+    se::DeviceDescriptionBuilder builder;
+    builder.set_cuda_compute_capability(6, 0);
+    builder.set_core_count(56);
+    builder.set_clock_rate_ghz(1.4);
+    builder.set_memory_bandwidth(700e9);
+    device_description_ = builder.Build();
+  }
+
+  std::unique_ptr<se::DeviceDescription> device_description_;
+};
+
+TEST_F(FusionCostModelTest, CheapProducerIsWorthFusing) {
+  auto module = tools::Parse(R"(
+HloModule CheapProducer
+
+ENTRY entry {
+  p = f32[1024,1024]{1,0} parameter(0)
+  negate = f32[1024,1024]{1,0} negate(p)
+  exp = f32[1024,1024]{1,0} exponential(negate)
+  log = f32[1024,1024]{1,0} log(negate)
+  ROOT tuple = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0}) tuple(exp, log)
+})")
+                    .ValueOrDie();
+  HloInstruction* negate =
+      module->entry_computation()->root_instruction()->mutable_operand(0)
+          ->mutable_operand(0);
+  FusionCostModel cost_model(*device_description_);
+  EXPECT_GT(cost_model.EstimateRunTimeSavedByFusingIntoUsers(negate), 0);
+}
+
+TEST_F(FusionCostModelTest, ExpensiveProducerIsNotWorthRecomputing) {
+  // Each user reads every element of `producer` 64 times, so fusing it
+  // recomputes its eight transcendentals per element 64 times over.
+  auto module = tools::Parse(R"(
+HloModule ExpensiveProducer
+
+fused_computation {
+  p0 = f32[512,512]{1,0} parameter(0)
+  e0 = f32[512,512]{1,0} exponential(p0)
+  t0 = f32[512,512]{1,0} tanh(e0)
+  e1 = f32[512,512]{1,0} exponential(t0)
+  t1 = f32[512,512]{1,0} tanh(e1)
+  e2 = f32[512,512]{1,0} exponential(t1)
+  t2 = f32[512,512]{1,0} tanh(e2)
+  e3 = f32[512,512]{1,0} exponential(t2)
+  ROOT t3 = f32[512,512]{1,0} tanh(e3)
+}
+
+ENTRY entry {
+  p = f32[512,512]{1,0} parameter(0)
+  producer = f32[512,512]{1,0} fusion(p), kind=kLoop, calls=fused_computation
+  b0 = f32[512,512,64]{2,1,0} broadcast(producer), dimensions={0,1}
+  b1 = f32[512,512,64]{2,1,0} broadcast(producer), dimensions={0,1}
+  ROOT tuple = (f32[512,512,64]{2,1,0}, f32[512,512,64]{2,1,0}) tuple(b0, b1)
+})")
+                    .ValueOrDie();
+  HloInstruction* producer =
+      module->entry_computation()->root_instruction()->mutable_operand(0)
+          ->mutable_operand(0);
+  FusionCostModel cost_model(*device_description_);
+  EXPECT_LT(cost_model.EstimateRunTimeSavedByFusingIntoUsers(producer), 0);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
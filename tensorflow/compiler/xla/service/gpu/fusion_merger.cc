@@ -16,8 +16,11 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/fusion_merger.h"
 
 #include <algorithm>
+#include <memory>
 #include <vector>
 
+#include "tensorflow/compiler/xla/ptr_util.h"
+#include "tensorflow/compiler/xla/service/gpu/fusion_cost_model.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/shape_util.h"
@@ -146,8 +149,9 @@ double GetMergedBytesTransferred(HloInstruction* fusion) {
 // Accumulates and reports stats on successful/failed merge attempts.
 class FusionInstructionMerger {
  public:
-  explicit FusionInstructionMerger(HloComputation* computation)
-      : computation_(computation) {}
+  FusionInstructionMerger(HloComputation* computation,
+                          const FusionCostModel* cost_model)
+      : computation_(computation), cost_model_(cost_model) {}
 
   Status Run();
 
@@ -157,6 +161,7 @@ class FusionInstructionMerger {
   Status HandleFusion(HloInstruction* fusion);
 
   HloComputation* computation_;
+  const FusionCostModel* cost_model_;  // May be null.
   bool changed_ = false;
 
   // Fusion instruction merge stats.
@@ -168,6 +173,7 @@ class FusionInstructionMerger {
   int num_fail_expensive_fused_instruction_ = 0;
   int num_fail_flops_to_byte_ratio_ = 0;
   int num_fail_net_bytes_transferred_ratio_ = 0;
+  int num_fail_estimated_slower_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FusionInstructionMerger);
 };
@@ -189,7 +195,7 @@ Status FusionInstructionMerger::Run() {
           << " expensive_instruction: " << num_fail_expensive_fused_instruction_
           << " flops_to_byte_ratio: " << num_fail_flops_to_byte_ratio_
           << " net_bytes_transferred: " << num_fail_net_bytes_transferred_ratio_
-          << " }";
+          << " estimated_slower: " << num_fail_estimated_slower_ << " }";
   return Status::OK();
 }
 
@@ -276,6 +282,15 @@ Status FusionInstructionMerger::HandleFusion(HloInstruction* fusion) {
     ++num_fail_net_bytes_transferred_ratio_;
     return Status::OK();
   }
+  // Skip 'fusion' instruction if the users it would be merged into are
+  // estimated to run slower than they and 'fusion' do now.
+  if (cost_model_ != nullptr &&
+      cost_model_->EstimateRunTimeSavedByFusingIntoUsers(fusion) < 0) {
+    VLOG(3) << "Not merging " << fusion->name()
+            << ": merged fusions are estimated to be slower.";
+    ++num_fail_estimated_slower_;
+    return Status::OK();
+  }
   // Merge fused instructions from 'fusion' into each user.
   std::vector<HloInstruction*> users = fusion->users();
   for (HloInstruction* user : users) {
@@ -301,12 +316,16 @@ Status FusionInstructionMerger::HandleFusion(HloInstruction* fusion) {
 StatusOr<bool> FusionMerger::Run(HloModule* module) {
   bool changed = false;
   VLOG(2) << "FusionMerger for module: " << module->name();
+  std::unique_ptr<FusionCostModel> cost_model;
+  if (device_description_ != nullptr) {
+    cost_model = MakeUnique<FusionCostModel>(*device_description_);
+  }
   for (auto* computation : module->MakeNonfusionComputations()) {
     VLOG(1) << "Before running FusionInstructionMerger for computation: "
             << computation->name();
     XLA_VLOG_LINES(3, computation->ToString());
 
-    FusionInstructionMerger fusion_merger(computation);
+    FusionInstructionMerger fusion_merger(computation, cost_model.get());
     TF_RETURN_IF_ERROR(fusion_merger.Run());
     changed |= fusion_merger.changed();
 
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
 
 namespace xla {
 namespace gpu {
@@ -31,14 +32,23 @@ namespace gpu {
 //    value of 1.0.
 // 2) The result of merging the fusion instruction into its users would not
 //    increase bytes transferred.
+// 3) If a device description is given, a FusionCostModel of the device
+//    estimates that the merged fusions run faster.
 //
 class FusionMerger : public HloPassInterface {
  public:
+  explicit FusionMerger(
+      const se::DeviceDescription* device_description = nullptr)
+      : device_description_(device_description) {}
+
   tensorflow::StringPiece name() const override { return "fusion merger"; }
 
   StatusOr<bool> Run(HloModule* module) override;
 
   static double GetThresholdFlopsToBytesRatio() { return 1.0; }
+
+ private:
+  const se::DeviceDescription* device_description_;
 };
 
 }  // namespace gpu
@@ -19,7 +19,9 @@ limitations under the License.
 #include <atomic>
 #include <functional>
 #include <mutex>  // NOLINT(build/c++11): only using std::call_once, not mutex.
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/DiagnosticPrinter.h"
@@ -40,6 +42,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/cudnn_batchnorm_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_convolution_algorithm_picker.h"
 #include "tensorflow/compiler/xla/service/gpu/cudnn_convolution_rewriter.h"
+#include "tensorflow/compiler/xla/service/gpu/fusion_cost_model.h"
 #include "tensorflow/compiler/xla/service/gpu/fusion_merger.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_copy_insertion.h"
@@ -51,6 +54,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_unnested.h"
+#include "tensorflow/compiler/xla/service/gpu/kernel_partitioner.h"
+#include "tensorflow/compiler/xla/service/gpu/latency_hiding_scheduler.h"
+#include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/llvm_gpu_backend/gpu_backend_lib.h"
 #include "tensorflow/compiler/xla/service/gpu/pad_insertion.h"
 #include "tensorflow/compiler/xla/service/gpu/partition_assignment.h"
@@ -81,11 +87,14 @@ limitations under the License.
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/cuda_libdevice_path.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
@@ -258,9 +267,14 @@ Status OptimizeHloModule(HloModule* hlo_module, se::StreamExecutor* stream_exec,
   {
     HloPassFix<HloPassPipeline> fusion("fusion");
     fusion.AddInvariantChecker<HloVerifier>();
-    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false);
-    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true);
-    fusion.AddPass<FusionMerger>();
+    const se::DeviceDescription* device_description =
+        stream_exec != nullptr ? &stream_exec->GetDeviceDescription()
+                               : nullptr;
+    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false,
+                                         device_description);
+    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true,
+                                         device_description);
+    fusion.AddPass<FusionMerger>(device_description);
     TF_RETURN_IF_ERROR(fusion.Run(hlo_module).status());
 
     HloPassPipeline reduce_pipeline("reduce-precision");
@@ -276,6 +290,13 @@ Status OptimizeHloModule(HloModule* hlo_module, se::StreamExecutor* stream_exec,
       // fuse the new ReducePrecision operations.
       TF_RETURN_IF_ERROR(fusion.Run(hlo_module).status());
     }
+
+    // Merge the sibling fusions left by producer-consumer fusion, so that
+    // operands they share are read once.
+    HloPassPipeline multi_output_fusion("multi-output-fusion");
+    multi_output_fusion.AddInvariantChecker<HloVerifier>();
+    multi_output_fusion.AddPass<GpuMultiOutputFusion>();
+    TF_RETURN_IF_ERROR(multi_output_fusion.Run(hlo_module).status());
   }
 
   {
@@ -474,6 +495,60 @@ StatusOr<std::vector<uint8>> CompilePtx(const string& ptx, int cc_major,
   return cubin_vector;
 }
 
+// Returns the path of the cubin for the given PTX in cache_dir. ptxas is
+// deterministic, so its output only depends on the PTX, the target and the
+// CUDA installation.
+string CubinCachePath(const string& cache_dir, const string& ptx, int cc_major,
+                      int cc_minor) {
+  const tensorflow::Fprint128 fingerprint = tensorflow::Fingerprint128(
+      tensorflow::strings::StrCat(tensorflow::CudaRoot(), ";", ptx));
+  return tensorflow::io::JoinPath(
+      cache_dir,
+      tensorflow::strings::Printf(
+          "%016llx%016llx_sm_%d%d.cubin",
+          static_cast<unsigned long long>(fingerprint.high64),
+          static_cast<unsigned long long>(fingerprint.low64), cc_major,
+          cc_minor));
+}
+
+// Reads a cubin previously written by WriteCachedCubin. Returns false if there
+// is none.
+bool ReadCachedCubin(const string& path, std::vector<uint8>* cubin) {
+  auto* env = tensorflow::Env::Default();
+  if (!env->FileExists(path).ok()) return false;
+  string contents;
+  Status status = tensorflow::ReadFileToString(env, path, &contents);
+  if (!status.ok() || contents.empty()) {
+    LOG(WARNING) << "Ignoring unreadable cached cubin " << path << ": "
+                 << status;
+    return false;
+  }
+  cubin->assign(contents.begin(), contents.end());
+  return true;
+}
+
+// Saves a cubin for ReadCachedCubin. The cubin is written to a temporary file
+// first, so that other processes sharing the directory never read a partial
+// file.
+void WriteCachedCubin(const string& cache_dir, const string& path,
+                      const std::vector<uint8>& cubin) {
+  auto* env = tensorflow::Env::Default();
+  const string tmp_path =
+      tensorflow::strings::StrCat(path, ".tmp", env->NowMicros());
+  Status status = env->RecursivelyCreateDir(cache_dir);
+  if (status.ok()) {
+    status = tensorflow::WriteStringToFile(
+        env, tmp_path,
+        tensorflow::StringPiece(reinterpret_cast<const char*>(cubin.data()),
+                                cubin.size()));
+  }
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Couldn't cache cubin in " << path << ": " << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
 }  // namespace
 
 GpuCompiler::GpuCompiler()
@@ -519,10 +594,26 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
   // Determine the HLO schedule, which is an ordering of HLO instructions.  This
   // is used by buffer assignment to enable buffer reuse, and the same ordering
   // must also be used to determine the thunk launch schedule.
-  std::unique_ptr<StreamAssignment> stream_assignment = AssignStreams(*module);
-  TF_ASSIGN_OR_RETURN(
-      std::unique_ptr<HloSchedule> hlo_schedule,
-      HloSchedule::Build(*module, *stream_assignment, pointer_size_));
+  std::unique_ptr<StreamAssignment> stream_assignment;
+  std::unique_ptr<HloSchedule> hlo_schedule;
+  const DebugOptions& debug_options = module->config().debug_options();
+  if (debug_options.xla_gpu_latency_hiding_stream_count() > 1 &&
+      !debug_options.xla_gpu_disable_multi_streaming()) {
+    FusionCostModel cost_model(stream_exec->GetDeviceDescription());
+    StreamSchedule stream_schedule = ScheduleOnStreams(
+        module.get(), cost_model,
+        debug_options.xla_gpu_latency_hiding_stream_count());
+    stream_assignment = std::move(stream_schedule.stream_assignment);
+    TF_ASSIGN_OR_RETURN(
+        hlo_schedule,
+        HloSchedule::Build(*module, *stream_assignment,
+                           std::move(stream_schedule.thunk_launch_order)));
+  } else {
+    stream_assignment = AssignStreams(*module);
+    TF_ASSIGN_OR_RETURN(
+        hlo_schedule,
+        HloSchedule::Build(*module, *stream_assignment, pointer_size_));
+  }
 
   // Run buffer analysis on the HLO graph. This analysis figures out which
   // temporary buffers are required to run the computation.
@@ -620,25 +711,76 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
     cc_minor = 0;
   }
 
-  string ptx;
-  {
-    XLA_SCOPED_LOGGING_TIMER("GpuCompiler::RunBackend - CompileToPtx");
-    TF_ASSIGN_OR_RETURN(ptx, CompileToPtx(&llvm_module, {cc_major, cc_minor},
-                                          module->config(), libdevice_dir));
-  }
+  const string& cubin_cache_dir =
+      module->config().debug_options().xla_gpu_cubin_cache_dir();
 
-  if (!ir_dump_directory.empty()) {
-    TF_RETURN_IF_ERROR(llvm_ir::DumpIRToDirectory(
-        /*directory_name=*/ir_dump_directory,
-        /*hlo_module_name=*/module->name(), llvm_module,
-        /*optimized=*/true));
+  // The optimized IR hooks and dumps expect to see the whole module, so only
+  // split it when there are none.
+  std::vector<KernelModule> kernel_modules;
+  const int split_count =
+      module->config().debug_options().xla_gpu_parallel_codegen_split_count();
+  if (split_count > 1 && ir_dump_directory.empty() &&
+      !user_post_optimization_hook_) {
+    kernel_modules = PartitionKernels(llvm_module, split_count);
   }
 
-  if (user_post_optimization_hook_) {
-    TF_CHECK_OK(user_post_optimization_hook_(llvm_module));
+  string ptx;
+  std::vector<GpuExecutable::CompiledModule> compiled_kernel_modules;
+  std::unordered_map<string, int> module_of_kernel;
+  if (kernel_modules.empty()) {
+    {
+      XLA_SCOPED_LOGGING_TIMER("GpuCompiler::RunBackend - CompileToPtx");
+      TF_ASSIGN_OR_RETURN(ptx, CompileToPtx(&llvm_module, {cc_major, cc_minor},
+                                            module->config(), libdevice_dir));
+    }
+
+    if (!ir_dump_directory.empty()) {
+      TF_RETURN_IF_ERROR(llvm_ir::DumpIRToDirectory(
+          /*directory_name=*/ir_dump_directory,
+          /*hlo_module_name=*/module->name(), llvm_module,
+          /*optimized=*/true));
+    }
+
+    if (user_post_optimization_hook_) {
+      TF_CHECK_OK(user_post_optimization_hook_(llvm_module));
+    }
+    VLOG(2) << "LLVM module after optimizations:";
+    XLA_VLOG_LINES(2, llvm_ir::DumpModuleToString(llvm_module));
+  } else {
+    XLA_SCOPED_LOGGING_TIMER(
+        "GpuCompiler::RunBackend - CompileToPtx and ptxas in parallel");
+    compiled_kernel_modules.resize(kernel_modules.size());
+    std::vector<Status> statuses(kernel_modules.size());
+    {
+      tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                          "xla_gpu_codegen",
+                                          kernel_modules.size());
+      for (size_t i = 0; i < kernel_modules.size(); ++i) {
+        pool.Schedule([&, i]() {
+          StatusOr<string> module_ptx =
+              CompileToPtx(kernel_modules[i].module.get(), {cc_major, cc_minor},
+                           module->config(), libdevice_dir);
+          if (!module_ptx.ok()) {
+            statuses[i] = module_ptx.status();
+            return;
+          }
+          GpuExecutable::CompiledModule& compiled = compiled_kernel_modules[i];
+          compiled.ptx = std::move(module_ptx.ValueOrDie());
+          compiled.cubin = CompilePtxOrGetCachedResult(
+              compiled.ptx, cc_major, cc_minor, cubin_cache_dir);
+        });
+      }
+    }
+    for (size_t i = 0; i < kernel_modules.size(); ++i) {
+      TF_RETURN_IF_ERROR(statuses[i]);
+      for (const string& kernel_name : kernel_modules[i].kernel_names) {
+        module_of_kernel[kernel_name] = i;
+      }
+      // The concatenation is only for dumping; it isn't a valid PTX module.
+      tensorflow::strings::StrAppend(&ptx, compiled_kernel_modules[i].ptx,
+                                     "\n");
+    }
   }
-  VLOG(2) << "LLVM module after optimizations:";
-  XLA_VLOG_LINES(2, llvm_ir::DumpModuleToString(llvm_module));
   VLOG(2) << "PTX:";
   XLA_VLOG_LINES(2, ptx);
 
@@ -658,8 +800,11 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
     }
   }
 
-  const std::vector<uint8> cubin =
-      CompilePtxOrGetCachedResult(ptx, cc_major, cc_minor);
+  std::vector<uint8> cubin;
+  if (compiled_kernel_modules.empty()) {
+    cubin =
+        CompilePtxOrGetCachedResult(ptx, cc_major, cc_minor, cubin_cache_dir);
+  }
 
   auto thunk_schedule = MakeUnique<ThunkSchedule>(
       ir_emitter.ConsumeThunkSequence(), std::move(stream_assignment),
@@ -684,6 +829,10 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
       ptx, cubin, {cc_major, cc_minor}, std::move(thunk_schedule),
       std::move(module), std::move(buffer_assignment),
       std::move(profile_printer), std::move(profile_index_map));
+  if (!compiled_kernel_modules.empty()) {
+    gpu_executable->set_kernel_modules(std::move(compiled_kernel_modules),
+                                       std::move(module_of_kernel));
+  }
   if (embed_ir_in_executable) {
     DCHECK_NE("", ir_module_string_before_opt);
     gpu_executable->set_ir_module_string(ir_module_string_before_opt);
@@ -691,9 +840,9 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
   return std::unique_ptr<Executable>(gpu_executable);
 }
 
-std::vector<uint8> GpuCompiler::CompilePtxOrGetCachedResult(const string& ptx,
-                                                            int cc_major,
-                                                            int cc_minor) {
+std::vector<uint8> GpuCompiler::CompilePtxOrGetCachedResult(
+    const string& ptx, int cc_major, int cc_minor,
+    const string& cubin_cache_dir) {
   XLA_SCOPED_LOGGING_TIMER("GpuCompiler::CompilePtxOrGetCachedResult");
   tracing::ScopedActivity activity("PTX->CUBIN", /*is_expensive=*/true);
   bool inserted;
@@ -720,13 +869,25 @@ std::vector<uint8> GpuCompiler::CompilePtxOrGetCachedResult(const string& ptx,
     tensorflow::mutex_lock lock(cache_value->mutex_);
     if (inserted) {
       CHECK(!cache_value->compilation_done);
-      if (!ptx.empty()) {
+      string cubin_path;
+      if (!ptx.empty() && !cubin_cache_dir.empty()) {
+        cubin_path =
+            CubinCachePath(cubin_cache_dir, *cache_ptx, cc_major, cc_minor);
+      }
+      if (!cubin_path.empty() &&
+          ReadCachedCubin(cubin_path, &cache_value->cubin_data)) {
+        VLOG(2) << "Loaded CUBIN from " << cubin_path;
+      } else if (!ptx.empty()) {
         StatusOr<std::vector<uint8>> maybe_cubin =
             CompilePtx(*cache_ptx, cc_major, cc_minor);
         if (maybe_cubin.ok()) {
           cache_value->cubin_data = std::move(maybe_cubin).ValueOrDie();
           VLOG(2) << "Compiled PTX size:" << ptx.size()
                   << " CUBIN size: " << cache_value->cubin_data.size();
+          if (!cubin_path.empty()) {
+            WriteCachedCubin(cubin_cache_dir, cubin_path,
+                             cache_value->cubin_data);
+          }
         } else {
           bool log_warning = true;
           if (maybe_cubin.status().code() ==
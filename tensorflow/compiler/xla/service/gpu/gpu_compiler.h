@@ -96,8 +96,11 @@ class GpuCompiler : public LLVMCompiler {
 
   // Tries to compile the given ptx string to cubin.  Returns a vector with the
   // compiled cubin.  If compilation was unsuccessful, returns an empty vector.
+  // If cubin_cache_dir is non-empty, cubins are also looked up in and saved to
+  // that directory.
   std::vector<uint8> CompilePtxOrGetCachedResult(const string& ptx,
-                                                 int cc_major, int cc_minor);
+                                                 int cc_major, int cc_minor,
+                                                 const string& cubin_cache_dir);
 
   // The compilation_cache_ map is a cache from {ptx string, cc_major, cc_minor}
   // -> cubin so we don't recompile the same ptx twice.  This is important for
@@ -132,6 +132,20 @@ GpuExecutable::GpuExecutable(
       thunk_schedule_(std::move(thunk_schedule)),
       assignment_(std::move(assignment)) {}
 
+tensorflow::StringPiece GpuExecutable::KernelPtx(
+    const string& kernel_name) const {
+  auto it = module_of_kernel_.find(kernel_name);
+  return it == module_of_kernel_.end() ? ptx()
+                                       : kernel_modules_[it->second].ptx;
+}
+
+const std::vector<uint8>& GpuExecutable::KernelCubin(
+    const string& kernel_name) const {
+  auto it = module_of_kernel_.find(kernel_name);
+  return it == module_of_kernel_.end() ? cubin()
+                                       : kernel_modules_[it->second].cubin;
+}
+
 Status GpuExecutable::ExecuteThunks(
     const ServiceExecutableRunOptions* run_options,
     const BufferAllocations& buffer_allocations, bool block_host_until_done,
@@ -286,6 +300,8 @@ StatusOr<ScopedShapedBuffer> GpuExecutable::ExecuteOnStream(
       buffer_allocations_builder.RegisterBuffer(i, buffer);
     }
   }
+  buffer_allocations_builder.SetTempBufferCache(
+      run_options->run_options().temp_buffer_cache(), this);
   se::StreamExecutor* executor = run_options->stream()->parent();
   TF_ASSIGN_OR_RETURN(
       auto buffer_allocations,
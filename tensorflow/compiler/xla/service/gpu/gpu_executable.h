@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/device_memory_allocator.h"
@@ -47,6 +49,13 @@ namespace gpu {
 // This is an immutable data type after initialization, and thus thread safe.
 class GpuExecutable : public Executable {
  public:
+  // The PTX and (possibly empty) cubin of one of several modules that the
+  // kernels of a computation were compiled into.
+  struct CompiledModule {
+    string ptx;
+    std::vector<uint8> cubin;
+  };
+
   // cubin (i.e. the compiled ptx) may be empty, in which case we leave
   // compilation up to the GPU driver.
   GpuExecutable(const string& ptx, const std::vector<uint8>& cubin,
@@ -65,6 +74,23 @@ class GpuExecutable : public Executable {
     ir_module_string_ = ir_module_string;
   }
 
+  // Records that the kernels were compiled into several modules rather than
+  // the single one given by ptx() and cubin(). `module_of_kernel` maps kernel
+  // names to indices into `modules`.
+  //
+  // This should be called before ExecuteOnStream.
+  void set_kernel_modules(
+      std::vector<CompiledModule> modules,
+      std::unordered_map<string, int> module_of_kernel) {
+    kernel_modules_ = std::move(modules);
+    module_of_kernel_ = std::move(module_of_kernel);
+  }
+
+  // Returns the PTX and cubin that the kernel named `kernel_name` is to be
+  // loaded from.
+  tensorflow::StringPiece KernelPtx(const string& kernel_name) const;
+  const std::vector<uint8>& KernelCubin(const string& kernel_name) const;
+
   // Returns the compiled PTX for the computation.
   tensorflow::StringPiece ptx() const { return ptx_; }
 
@@ -115,6 +141,11 @@ class GpuExecutable : public Executable {
   // May be empty, in which case we leave compilation up to the GPU driver.
   const std::vector<uint8> cubin_;
 
+  // The modules the kernels were compiled into, if there is more than one; see
+  // set_kernel_modules.
+  std::vector<CompiledModule> kernel_modules_;
+  std::unordered_map<string, int> module_of_kernel_;
+
   // The compute capability of the GPU we're targeting with this GpuExecutable.
   std::pair<int, int> compute_capability_;
 
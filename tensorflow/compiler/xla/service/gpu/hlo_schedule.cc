@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/buffer_value.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
 #include "tensorflow/compiler/xla/service/hlo_scheduling.h"
+#include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 
 namespace xla {
@@ -197,12 +198,20 @@ StatusOr<std::unique_ptr<HloSchedule>> HloSchedule::Build(
   if (stream_assignment.StreamCount() == 1) {
     // All kernels are launched on a single stream, so there's no loss of
     // concurrency by optimizing for minimal memory usage.
+    const int32 local_search_steps =
+        module.config()
+            .debug_options()
+            .xla_memory_scheduler_local_search_steps();
     TF_ASSIGN_OR_RETURN(
         schedule->thunk_launch_order_,
         CreateMemoryMinimizingSequence(
-            *entry_computation, [pointer_size](const BufferValue& buffer) {
+            *entry_computation,
+            [pointer_size](const BufferValue& buffer) {
               return ShapeUtil::ByteSizeOf(buffer.shape(), pointer_size);
-            }));
+            },
+            local_search_steps > 0
+                ? LocalSearchMemoryScheduler(local_search_steps)
+                : MemorySchedulerAlgorithm()));
   } else {
     // BFS tends to increase concurrency, but also increases memory usage.
     BFSLaunchOrder(entry_computation, &schedule->thunk_launch_order_);
@@ -214,5 +223,18 @@ StatusOr<std::unique_ptr<HloSchedule>> HloSchedule::Build(
   return std::move(schedule);
 }
 
+/* static */
+StatusOr<std::unique_ptr<HloSchedule>> HloSchedule::Build(
+    const HloModule& module, const StreamAssignment& stream_assignment,
+    std::vector<const HloInstruction*> thunk_launch_order) {
+  TF_RET_CHECK(thunk_launch_order.size() ==
+               module.entry_computation()->instruction_count());
+  std::unique_ptr<HloSchedule> schedule(new HloSchedule);
+  schedule->thunk_launch_order_ = std::move(thunk_launch_order);
+  schedule->hlo_ordering_ = MakeUnique<GpuHloOrdering>(
+      &module, stream_assignment, schedule->thunk_launch_order_);
+  return std::move(schedule);
+}
+
 }  // namespace gpu
 }  // namespace xla
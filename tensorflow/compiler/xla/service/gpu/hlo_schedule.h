@@ -42,6 +42,13 @@ class HloSchedule {
       const HloModule& module, const StreamAssignment& stream_assignment,
       int64 pointer_size);
 
+  // Constructs an HloSchedule for the given module that launches thunks in
+  // `thunk_launch_order`, a topological order of all instructions of the entry
+  // computation, e.g. one computed by ScheduleOnStreams.
+  static StatusOr<std::unique_ptr<HloSchedule>> Build(
+      const HloModule& module, const StreamAssignment& stream_assignment,
+      std::vector<const HloInstruction*> thunk_launch_order);
+
   // Returns the total order of thunk launches, represented in terms of HLO
   // instructions.
   const std::vector<const HloInstruction*>& ThunkLaunchOrder() const {
@@ -173,8 +173,21 @@ bool GpuInstructionFusion::ShouldFuse(HloInstruction* consumer,
     return false;
   }
 
-  return IsFusile(*producer) && IsFusile(*consumer) &&
-         InstructionFusion::ShouldFuse(consumer, operand_index);
+  if (!IsFusile(*producer) || !IsFusile(*consumer) ||
+      !InstructionFusion::ShouldFuse(consumer, operand_index)) {
+    return false;
+  }
+
+  // Duplicating the producer trades reading its output for recomputing it in
+  // every user, which only pays off if the users don't do so much more work
+  // than the memory traffic they save.
+  if (cost_model_ != nullptr && FusionWouldDuplicate(*producer, *consumer) &&
+      cost_model_->EstimateRunTimeSavedByFusingIntoUsers(producer) < 0) {
+    VLOG(3) << "Not fusing " << producer->name() << " into "
+            << consumer->name() << ": recomputing it is estimated to be slower";
+    return false;
+  }
+  return true;
 }
 
 bool GpuInstructionFusion::ShouldFuseIntoMultiOutput(HloInstruction* consumer,
@@ -16,16 +16,30 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_INSTRUCTION_FUSION_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_INSTRUCTION_FUSION_H_
 
+#include <memory>
+
+#include "tensorflow/compiler/xla/ptr_util.h"
+#include "tensorflow/compiler/xla/service/gpu/fusion_cost_model.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/instruction_fusion.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
 
 namespace xla {
 namespace gpu {
 
 class GpuInstructionFusion : public InstructionFusion {
  public:
-  explicit GpuInstructionFusion(bool may_duplicate)
-      : InstructionFusion(GpuInstructionFusion::IsExpensive, may_duplicate) {}
+  // If `device_description` is not null, fusions that duplicate a producer
+  // are only made if a FusionCostModel of the device estimates that they
+  // make the program faster.
+  explicit GpuInstructionFusion(
+      bool may_duplicate,
+      const se::DeviceDescription* device_description = nullptr)
+      : InstructionFusion(GpuInstructionFusion::IsExpensive, may_duplicate) {
+    if (device_description != nullptr) {
+      cost_model_ = MakeUnique<FusionCostModel>(*device_description);
+    }
+  }
 
   static bool IsExpensive(const HloInstruction& instruction);
 
@@ -36,6 +50,9 @@ class GpuInstructionFusion : public InstructionFusion {
 
   HloInstruction::FusionKind ChooseKind(
       const HloInstruction* producer, const HloInstruction* consumer) override;
+
+ private:
+  std::unique_ptr<FusionCostModel> cost_model_;
 };
 
 }  // namespace gpu
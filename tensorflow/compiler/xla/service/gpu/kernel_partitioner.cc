@@ -0,0 +1,174 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/kernel_partitioner.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "tensorflow/compiler/xla/ptr_util.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+constexpr char kNvvmAnnotations[] = "nvvm.annotations";
+
+// Returns the function an nvvm.annotations entry applies to, or nullptr.
+const llvm::Function* AnnotatedFunction(const llvm::MDNode& annotation) {
+  if (annotation.getNumOperands() == 0) {
+    return nullptr;
+  }
+  return llvm::mdconst::dyn_extract_or_null<llvm::Function>(
+      annotation.getOperand(0));
+}
+
+// Removes the nvvm.annotations entries of, and then the declarations of, the
+// kernels that `module` got declarations instead of definitions for.
+void DropDeclaredKernels(llvm::Module* module) {
+  llvm::NamedMDNode* annotations = module->getNamedMetadata(kNvvmAnnotations);
+  std::vector<llvm::MDNode*> kept;
+  std::unordered_set<llvm::Function*> dropped;
+  for (llvm::MDNode* annotation : annotations->operands()) {
+    const llvm::Function* function = AnnotatedFunction(*annotation);
+    if (function != nullptr && function->isDeclaration()) {
+      dropped.insert(module->getFunction(function->getName()));
+    } else {
+      kept.push_back(annotation);
+    }
+  }
+  annotations->clearOperands();
+  for (llvm::MDNode* annotation : kept) {
+    annotations->addOperand(annotation);
+  }
+  for (llvm::Function* function : dropped) {
+    if (function->use_empty()) {
+      function->eraseFromParent();
+    }
+  }
+}
+
+int64 InstructionCount(const llvm::Function& function) {
+  int64 count = 0;
+  for (const llvm::BasicBlock& block : function) {
+    count += block.size();
+  }
+  return count;
+}
+
+}  // namespace
+
+std::vector<KernelModule> PartitionKernels(const llvm::Module& module,
+                                           int max_partitions) {
+  std::vector<KernelModule> partitions;
+  const llvm::NamedMDNode* annotations =
+      module.getNamedMetadata(kNvvmAnnotations);
+  if (max_partitions < 2 || annotations == nullptr) {
+    return partitions;
+  }
+
+  std::vector<const llvm::Function*> kernels;
+  for (const llvm::MDNode* annotation : annotations->operands()) {
+    const llvm::Function* function = AnnotatedFunction(*annotation);
+    if (function == nullptr || function->isDeclaration() ||
+        annotation->getNumOperands() < 2) {
+      continue;
+    }
+    const auto* kind =
+        llvm::dyn_cast<llvm::MDString>(annotation->getOperand(1));
+    if (kind != nullptr && kind->getString() == "kernel") {
+      kernels.push_back(function);
+    }
+  }
+  if (kernels.size() < 2) {
+    return partitions;
+  }
+
+  int64 total_size = 0;
+  for (const llvm::Function* kernel : kernels) {
+    total_size += InstructionCount(*kernel);
+  }
+  const int64 target_size = CeilOfRatio<int64>(total_size, max_partitions);
+
+  std::unordered_map<const llvm::Function*, int> partition_of;
+  int num_partitions = 1;
+  int64 partition_size = 0;
+  for (const llvm::Function* kernel : kernels) {
+    if (partition_size >= target_size && num_partitions < max_partitions) {
+      ++num_partitions;
+      partition_size = 0;
+    }
+    partition_of[kernel] = num_partitions - 1;
+    partition_size += InstructionCount(*kernel);
+  }
+  if (num_partitions < 2) {
+    return partitions;
+  }
+
+  for (int i = 0; i < num_partitions; ++i) {
+    llvm::ValueToValueMapTy value_map;
+    std::unique_ptr<llvm::Module> cloned_module = llvm::CloneModule(
+        module, value_map, [&](const llvm::GlobalValue* value) {
+          const auto* function = llvm::dyn_cast<llvm::Function>(value);
+          auto it = partition_of.find(function);
+          return it == partition_of.end() || it->second == i;
+        });
+    cloned_module->setModuleIdentifier(
+        tensorflow::strings::StrCat(module.getModuleIdentifier(), ".", i));
+    DropDeclaredKernels(cloned_module.get());
+
+    // Cloned modules share the LLVMContext of `module`, which can't be used
+    // from several threads at once. Round-trip them through bitcode to give
+    // each one a context of its own.
+    llvm::SmallVector<char, 0> bitcode;
+    llvm::raw_svector_ostream bitcode_stream(bitcode);
+    llvm::WriteBitcodeToFile(*cloned_module, bitcode_stream);
+
+    KernelModule partition;
+    partition.context = MakeUnique<llvm::LLVMContext>();
+    partition.module = llvm::cantFail(llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(
+            llvm::StringRef(bitcode.data(), bitcode.size()),
+            cloned_module->getModuleIdentifier()),
+        *partition.context));
+    for (const llvm::Function* kernel : kernels) {
+      if (partition_of.at(kernel) == i) {
+        partition.kernel_names.push_back(llvm_ir::AsString(kernel->getName()));
+      }
+    }
+    partitions.push_back(std::move(partition));
+  }
+  VLOG(1) << "Split the " << kernels.size() << " kernels of "
+          << module.getModuleIdentifier() << " into " << num_partitions
+          << " modules";
+  return partitions;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,54 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_KERNEL_PARTITIONER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_KERNEL_PARTITIONER_H_
+
+#include <memory>
+#include <vector>
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "tensorflow/compiler/xla/types.h"
+
+namespace xla {
+namespace gpu {
+
+// A module holding some of the kernels of a larger module, together with the
+// context that owns it.
+struct KernelModule {
+  std::unique_ptr<llvm::LLVMContext> context;
+  std::unique_ptr<llvm::Module> module;
+  // Names of the kernels defined in `module`.
+  std::vector<string> kernel_names;
+};
+
+// Splits the kernels of `module` -- the functions annotated as kernels in
+// nvvm.annotations -- into at most `max_partitions` modules of about equal
+// size that can be compiled to PTX independently and concurrently, each in
+// its own LLVMContext.
+//
+// Kernels can't call each other, and PTX modules can't refer to each other, so
+// every partition gets its own copy of the device functions and global
+// variables in `module`.
+//
+// Returns an empty vector if `module` has fewer than two kernels.
+std::vector<KernelModule> PartitionKernels(const llvm::Module& module,
+                                           int max_partitions);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_KERNEL_PARTITIONER_H_
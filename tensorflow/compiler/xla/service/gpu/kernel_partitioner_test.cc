@@ -0,0 +1,108 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/kernel_partitioner.h"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/SourceMgr.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::unique_ptr<llvm::Module> ParseModule(const char* ir,
+                                          llvm::LLVMContext* context) {
+  llvm::SMDiagnostic diagnostic;
+  std::unique_ptr<llvm::Module> module =
+      llvm::parseAssemblyString(ir, diagnostic, *context);
+  CHECK(module != nullptr) << diagnostic.getMessage().str();
+  return module;
+}
+
+TEST(KernelPartitionerTest, EveryPartitionGetsDeviceFunctions) {
+  const char* ir = R"(
+define internal float @reducer(float %a, float %b) {
+  %sum = fadd float %a, %b
+  ret float %sum
+}
+
+define void @kernel_a(float* %out) {
+  %v = call float @reducer(float 1.0, float 2.0)
+  store float %v, float* %out
+  ret void
+}
+
+define void @kernel_b(float* %out) {
+  %v = call float @reducer(float 3.0, float 4.0)
+  store float %v, float* %out
+  ret void
+}
+
+!nvvm.annotations = !{!0, !1, !2}
+!0 = !{void (float*)* @kernel_a, !"kernel", i32 1}
+!1 = !{void (float*)* @kernel_b, !"kernel", i32 1}
+!2 = !{void (float*)* @kernel_b, !"reqntidx", i32 128}
+)";
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module = ParseModule(ir, &context);
+
+  std::vector<KernelModule> partitions =
+      PartitionKernels(*module, /*max_partitions=*/4);
+  ASSERT_EQ(partitions.size(), 2);
+
+  const llvm::Module& first = *partitions[0].module;
+  EXPECT_THAT(partitions[0].kernel_names, ElementsAre("kernel_a"));
+  EXPECT_FALSE(first.getFunction("kernel_a")->isDeclaration());
+  EXPECT_FALSE(first.getFunction("reducer")->isDeclaration());
+  EXPECT_EQ(first.getFunction("kernel_b"), nullptr);
+  EXPECT_EQ(first.getNamedMetadata("nvvm.annotations")->getNumOperands(), 1);
+
+  const llvm::Module& second = *partitions[1].module;
+  EXPECT_THAT(partitions[1].kernel_names, ElementsAre("kernel_b"));
+  EXPECT_EQ(second.getFunction("kernel_a"), nullptr);
+  EXPECT_FALSE(second.getFunction("kernel_b")->isDeclaration());
+  EXPECT_FALSE(second.getFunction("reducer")->isDeclaration());
+  EXPECT_EQ(second.getNamedMetadata("nvvm.annotations")->getNumOperands(), 2);
+
+  // Every partition has a context of its own.
+  EXPECT_NE(&first.getContext(), &second.getContext());
+  EXPECT_NE(&first.getContext(), &context);
+}
+
+TEST(KernelPartitionerTest, DoesNotSplitSingleKernel) {
+  const char* ir = R"(
+define void @kernel(float* %out) {
+  store float 1.0, float* %out
+  ret void
+}
+
+!nvvm.annotations = !{!0}
+!0 = !{void (float*)* @kernel, !"kernel", i32 1}
+)";
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> module = ParseModule(ir, &context);
+
+  EXPECT_TRUE(PartitionKernels(*module, /*max_partitions=*/4).empty());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -40,16 +40,16 @@ Status KernelThunk::Initialize(const GpuExecutable& executable,
   tensorflow::mutex_lock lock(mutex_);
   if (!loader_spec_) {
     loader_spec_.reset(new se::MultiKernelLoaderSpec(args_.size()));
-    tensorflow::StringPiece ptx = executable.ptx();
+    tensorflow::StringPiece ptx = executable.KernelPtx(kernel_name_);
     // Convert tensorflow::StringPiece to se::port::StringPiece because
     // StreamExecutor uses the latter.
     loader_spec_->AddCudaPtxInMemory(
         se::port::StringPiece(ptx.data(), ptx.size()), kernel_name_);
 
-    if (!executable.cubin().empty()) {
+    const std::vector<uint8>& cubin = executable.KernelCubin(kernel_name_);
+    if (!cubin.empty()) {
       loader_spec_->AddCudaCubinInMemory(
-          reinterpret_cast<const char*>(executable.cubin().data()),
-          kernel_name_);
+          reinterpret_cast<const char*>(cubin.data()), kernel_name_);
     }
   }
 
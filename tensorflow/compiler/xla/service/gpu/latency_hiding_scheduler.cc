@@ -0,0 +1,240 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/latency_hiding_scheduler.h"
+
+#include <algorithm>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "tensorflow/compiler/xla/ptr_util.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Time it takes a stream to wait for an event recorded on another stream, in
+// seconds.
+constexpr double kCrossStreamWaitSeconds = 2e-6;
+
+// Returns whether `hlo` is launched as a thunk; kParameter and kConstant are
+// not.
+bool NeedsThunk(const HloInstruction& hlo) {
+  return hlo.opcode() != HloOpcode::kParameter &&
+         hlo.opcode() != HloOpcode::kConstant;
+}
+
+double EstimateThunkRunTime(HloInstruction* hlo,
+                            const FusionCostModel& cost_model) {
+  switch (hlo->opcode()) {
+    case HloOpcode::kParameter:
+    case HloOpcode::kConstant:
+    case HloOpcode::kBitcast:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kTuple:
+      // These don't launch kernels, or only write a few pointers.
+      return 0;
+    default:
+      return cost_model.EstimateRunTime(hlo);
+  }
+}
+
+// Appends the instructions in `more` that aren't in `instructions` yet.
+template <typename Container>
+void AppendNew(const Container& more,
+               std::vector<const HloInstruction*>* instructions) {
+  for (const HloInstruction* hlo : more) {
+    if (std::find(instructions->begin(), instructions->end(), hlo) ==
+        instructions->end()) {
+      instructions->push_back(hlo);
+    }
+  }
+}
+
+// Returns the instructions that must finish before `hlo` starts.
+std::vector<const HloInstruction*> Predecessors(const HloInstruction& hlo) {
+  std::vector<const HloInstruction*> predecessors;
+  AppendNew(hlo.operands(), &predecessors);
+  AppendNew(hlo.control_predecessors(), &predecessors);
+  return predecessors;
+}
+
+// Returns the instructions that can't start before `hlo` finishes.
+std::vector<const HloInstruction*> Successors(const HloInstruction& hlo) {
+  std::vector<const HloInstruction*> successors;
+  AppendNew(hlo.users(), &successors);
+  AppendNew(hlo.control_successors(), &successors);
+  return successors;
+}
+
+}  // namespace
+
+StreamSchedule ScheduleOnStreams(HloModule* module,
+                                 const FusionCostModel& cost_model,
+                                 int max_stream_count) {
+  CHECK_GE(max_stream_count, 1);
+  StreamSchedule schedule;
+  schedule.stream_assignment = MakeUnique<StreamAssignment>();
+
+  const std::list<HloInstruction*> post_order_list =
+      module->entry_computation()->MakeInstructionPostOrder();
+  const std::vector<HloInstruction*> post_order(post_order_list.begin(),
+                                                post_order_list.end());
+  std::unordered_map<const HloInstruction*, int64> position;
+  std::unordered_map<const HloInstruction*, double> run_time;
+  for (int64 i = 0; i < post_order.size(); ++i) {
+    position[post_order[i]] = i;
+    run_time[post_order[i]] = EstimateThunkRunTime(post_order[i], cost_model);
+  }
+
+  // The estimated run time of the longest chain of dependent instructions
+  // starting at each instruction, which is the priority it is scheduled with.
+  std::unordered_map<const HloInstruction*, double> bottom_level;
+  for (auto it = post_order.rbegin(); it != post_order.rend(); ++it) {
+    double successor_level = 0;
+    for (const HloInstruction* successor : Successors(**it)) {
+      successor_level = std::max(successor_level, bottom_level.at(successor));
+    }
+    bottom_level[*it] = run_time.at(*it) + successor_level;
+  }
+
+  const HloInstruction* critical = nullptr;
+  for (const HloInstruction* hlo : post_order) {
+    if (critical == nullptr ||
+        bottom_level.at(hlo) > bottom_level.at(critical)) {
+      critical = hlo;
+    }
+  }
+  schedule.critical_path_run_time = bottom_level.at(critical);
+  while (critical != nullptr) {
+    schedule.critical_path.push_back(critical);
+    const HloInstruction* next = nullptr;
+    for (const HloInstruction* successor : Successors(*critical)) {
+      if (next == nullptr ||
+          bottom_level.at(successor) > bottom_level.at(next)) {
+        next = successor;
+      }
+    }
+    critical = next;
+  }
+
+  // Instructions whose predecessors have all been scheduled, highest priority
+  // first, and in post order among equal priorities.
+  std::set<std::pair<double, int64>> ready;
+  std::unordered_map<const HloInstruction*, int64> unscheduled_predecessors;
+  for (const HloInstruction* hlo : post_order) {
+    const int64 count = Predecessors(*hlo).size();
+    unscheduled_predecessors[hlo] = count;
+    if (count == 0) {
+      ready.emplace(-bottom_level.at(hlo), position.at(hlo));
+    }
+  }
+
+  std::vector<double> stream_free_time;
+  std::unordered_map<const HloInstruction*, int> stream_of;
+  std::unordered_map<const HloInstruction*, double> start_time;
+  std::unordered_map<const HloInstruction*, double> finish_time;
+  std::vector<const HloInstruction*> scheduled;
+  while (!ready.empty()) {
+    const HloInstruction* hlo = post_order[ready.begin()->second];
+    ready.erase(ready.begin());
+
+    // Returns when `hlo` can start on `stream_no` as far as its predecessors
+    // are concerned.
+    auto data_ready_time = [&](int stream_no) {
+      double time = 0;
+      for (const HloInstruction* predecessor : Predecessors(*hlo)) {
+        auto it = stream_of.find(predecessor);
+        const bool waits_on_other_stream =
+            it != stream_of.end() && it->second != stream_no;
+        time = std::max(time, finish_time.at(predecessor) +
+                                  (waits_on_other_stream
+                                       ? kCrossStreamWaitSeconds
+                                       : 0));
+      }
+      return time;
+    };
+
+    double start = data_ready_time(-1);
+    if (NeedsThunk(*hlo)) {
+      // Try every stream in use and, if there are streams left, a new one.
+      // Ties go to the lower stream number, so new streams are only opened
+      // when they let `hlo` start earlier.
+      const int candidate_count =
+          std::min<int>(stream_free_time.size() + 1, max_stream_count);
+      int best_stream = -1;
+      for (int stream_no = 0; stream_no < candidate_count; ++stream_no) {
+        const double free_time = stream_no < stream_free_time.size()
+                                     ? stream_free_time[stream_no]
+                                     : 0;
+        const double stream_start =
+            std::max(free_time, data_ready_time(stream_no));
+        if (best_stream == -1 || stream_start < start) {
+          best_stream = stream_no;
+          start = stream_start;
+        }
+      }
+      if (best_stream == stream_free_time.size()) {
+        stream_free_time.push_back(0);
+      }
+      stream_free_time[best_stream] = start + run_time.at(hlo);
+      stream_of[hlo] = best_stream;
+      schedule.stream_assignment->AssignStreamToHlo(hlo, best_stream);
+    }
+    start_time[hlo] = start;
+    finish_time[hlo] = start + run_time.at(hlo);
+    schedule.estimated_run_time =
+        std::max(schedule.estimated_run_time, finish_time.at(hlo));
+    scheduled.push_back(hlo);
+
+    for (const HloInstruction* successor : Successors(*hlo)) {
+      if (--unscheduled_predecessors.at(successor) == 0) {
+        ready.emplace(-bottom_level.at(successor), position.at(successor));
+      }
+    }
+  }
+  CHECK_EQ(scheduled.size(), post_order.size());
+
+  // Instructions start no earlier than their predecessors, and no earlier
+  // than the instructions scheduled before them on the same stream, so this
+  // is a topological order that launches the thunks of every stream in the
+  // order they were scheduled.
+  std::stable_sort(scheduled.begin(), scheduled.end(),
+                   [&](const HloInstruction* a, const HloInstruction* b) {
+                     return start_time.at(a) < start_time.at(b);
+                   });
+  schedule.thunk_launch_order = std::move(scheduled);
+
+  VLOG(1) << "Scheduled " << module->name() << " onto "
+          << schedule.stream_assignment->StreamCount()
+          << " streams; estimated run time " << schedule.estimated_run_time
+          << "s, critical path " << schedule.critical_path_run_time << "s";
+  if (VLOG_IS_ON(2)) {
+    for (const HloInstruction* hlo : schedule.critical_path) {
+      VLOG(2) << "  critical path: " << hlo->name() << " ("
+              << run_time.at(hlo) << "s)";
+    }
+  }
+  return schedule;
+}
+
+}  // namespace gpu
+}  // namespace xla
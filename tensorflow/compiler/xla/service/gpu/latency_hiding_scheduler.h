@@ -0,0 +1,65 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_LATENCY_HIDING_SCHEDULER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_LATENCY_HIDING_SCHEDULER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/gpu/fusion_cost_model.h"
+#include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+
+namespace xla {
+namespace gpu {
+
+// A stream assignment and thunk launch order for the entry computation of a
+// module, together with the estimated run times they were computed from.
+struct StreamSchedule {
+  std::unique_ptr<StreamAssignment> stream_assignment;
+
+  // All instructions of the entry computation, in the order of their
+  // estimated start times.
+  std::vector<const HloInstruction*> thunk_launch_order;
+
+  // Estimated run time, in seconds, of the entry computation with this
+  // schedule.
+  double estimated_run_time = 0;
+
+  // The chain of dependent instructions with the longest estimated run time,
+  // and that run time in seconds. No schedule runs faster than it.
+  std::vector<const HloInstruction*> critical_path;
+  double critical_path_run_time = 0;
+};
+
+// Assigns the instructions of the entry computation of `module` to at most
+// `max_stream_count` streams, and orders their thunks, by list scheduling
+// them with the run times `cost_model` estimates.
+//
+// Instructions are scheduled in order of the longest chain of dependent work
+// that starts at them, each on the stream where it can start earliest. Waiting
+// for an operand on another stream costs a cross-stream synchronization. This
+// lets copies, host transfers and independent kernels overlap with the kernels
+// on the critical path, instead of queuing up behind them.
+StreamSchedule ScheduleOnStreams(HloModule* module,
+                                 const FusionCostModel& cost_model,
+                                 int max_stream_count);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_LATENCY_HIDING_SCHEDULER_H_
@@ -0,0 +1,112 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/latency_hiding_scheduler.h"
+
+#include "tensorflow/compiler/xla/service/gpu/hlo_schedule.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/tools/parser/hlo_parser.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using ::testing::ElementsAre;
+
+class LatencyHidingSchedulerTest : public HloTestBase {
+ protected:
+  LatencyHidingSchedulerTest() {
+    se::DeviceDescriptionBuilder builder;
+    builder.set_cuda_compute_capability(6, 0);
+    builder.set_core_count(56);
+    builder.set_clock_rate_ghz(1.4);
+    builder.set_memory_bandwidth(700e9);
+    device_description_ = builder.Build();
+  }
+
+  // A chain of three exponentials next to a single, independent tanh.
+  std::unique_ptr<HloModule> ParseChainAndSideBranch() {
+    return tools::Parse(R"(
+HloModule ChainAndSideBranch
+
+ENTRY entry {
+  p0 = f32[1024,1024]{1,0} parameter(0)
+  p1 = f32[1024,1024]{1,0} parameter(1)
+  e0 = f32[1024,1024]{1,0} exponential(p0)
+  e1 = f32[1024,1024]{1,0} exponential(e0)
+  e2 = f32[1024,1024]{1,0} exponential(e1)
+  t = f32[1024,1024]{1,0} tanh(p1)
+  ROOT tuple = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0}) tuple(e2, t)
+})")
+        .ValueOrDie();
+  }
+
+  std::unique_ptr<se::DeviceDescription> device_description_;
+};
+
+TEST_F(LatencyHidingSchedulerTest, OverlapsSideBranchWithCriticalPath) {
+  auto module = ParseChainAndSideBranch();
+  HloComputation* entry = module->entry_computation();
+  const HloInstruction* tuple = entry->root_instruction();
+  const HloInstruction* e2 = tuple->operand(0);
+  const HloInstruction* t = tuple->operand(1);
+  const HloInstruction* e1 = e2->operand(0);
+  const HloInstruction* e0 = e1->operand(0);
+  const HloInstruction* p0 = e0->operand(0);
+
+  FusionCostModel cost_model(*device_description_);
+  StreamSchedule schedule =
+      ScheduleOnStreams(module.get(), cost_model, /*max_stream_count=*/4);
+
+  const StreamAssignment& streams = *schedule.stream_assignment;
+  EXPECT_EQ(streams.StreamCount(), 2);
+  EXPECT_EQ(streams.StreamNumberForHlo(*e0), streams.StreamNumberForHlo(*e1));
+  EXPECT_EQ(streams.StreamNumberForHlo(*e1), streams.StreamNumberForHlo(*e2));
+  EXPECT_NE(streams.StreamNumberForHlo(*e0), streams.StreamNumberForHlo(*t));
+
+  EXPECT_THAT(schedule.critical_path, ElementsAre(p0, e0, e1, e2, tuple));
+  EXPECT_GT(schedule.critical_path_run_time, 0);
+  // The tanh runs entirely in the shadow of the exponentials.
+  EXPECT_DOUBLE_EQ(schedule.estimated_run_time,
+                   schedule.critical_path_run_time);
+
+  auto hlo_schedule = HloSchedule::Build(*module, streams,
+                                         schedule.thunk_launch_order)
+                          .ConsumeValueOrDie();
+  auto order = hlo_schedule->ConsumeHloOrdering();
+  EXPECT_TRUE(order->ExecutesBefore(e0, e1));
+  EXPECT_TRUE(order->ExecutesBefore(t, tuple));
+  EXPECT_FALSE(order->ExecutesBefore(t, e1));
+  EXPECT_FALSE(order->ExecutesBefore(e1, t));
+}
+
+TEST_F(LatencyHidingSchedulerTest, RespectsMaxStreamCount) {
+  auto module = ParseChainAndSideBranch();
+  FusionCostModel cost_model(*device_description_);
+  StreamSchedule schedule =
+      ScheduleOnStreams(module.get(), cost_model, /*max_stream_count=*/1);
+
+  EXPECT_EQ(schedule.stream_assignment->StreamCount(), 1);
+  EXPECT_EQ(schedule.thunk_launch_order.size(),
+            module->entry_computation()->instruction_count());
+  // With a single stream the side branch adds to the run time.
+  EXPECT_GT(schedule.estimated_run_time, schedule.critical_path_run_time);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,180 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Returns the reduce that determines how a reduction-to-vector candidate is
+// emitted, or nullptr if `instr` isn't one.
+const HloInstruction* GetHeroReduce(const HloInstruction& instr) {
+  if (instr.opcode() == HloOpcode::kReduce) {
+    return IsReductionToVector(instr) ? &instr : nullptr;
+  }
+  if (instr.opcode() != HloOpcode::kFusion ||
+      instr.fusion_kind() != HloInstruction::FusionKind::kInput) {
+    return nullptr;
+  }
+  const HloInstruction* root = instr.fused_expression_root();
+  if (root->opcode() == HloOpcode::kTuple) {
+    // Multi-output reduction fusions only ever have reduces of identical
+    // shapes in their root tuple.
+    root = root->operand(0);
+  }
+  return root->opcode() == HloOpcode::kReduce && IsReductionToVector(*root)
+             ? root
+             : nullptr;
+}
+
+// Returns true if `instr` is a loop fusion that the IR emitter can turn into
+// a multi-output fusion.
+bool IsMergeableLoopFusion(const HloInstruction& instr) {
+  if (instr.opcode() != HloOpcode::kFusion ||
+      instr.fusion_kind() != HloInstruction::FusionKind::kLoop) {
+    return false;
+  }
+  // Dynamic-update-slice roots may be emitted in place, which only works for
+  // a single output.
+  const HloInstruction* root = instr.fused_expression_root();
+  if (root->opcode() == HloOpcode::kDynamicUpdateSlice) {
+    return false;
+  }
+  if (root->opcode() == HloOpcode::kTuple) {
+    return !c_any_of(root->operands(), [](const HloInstruction* operand) {
+      return operand->opcode() == HloOpcode::kDynamicUpdateSlice;
+    });
+  }
+  return true;
+}
+
+// Returns the shape every element of the output of loop fusion `fusion` has,
+// or nullptr if they differ.
+const Shape* GetLoopOutputShape(const HloInstruction& fusion) {
+  if (!fusion.IsMultiOutputFusion()) {
+    return &fusion.shape();
+  }
+  const Shape* shape = &ShapeUtil::GetTupleElementShape(fusion.shape(), 0);
+  for (const Shape& element : fusion.shape().tuple_shapes()) {
+    if (!ShapeUtil::Equal(*shape, element)) {
+      return nullptr;
+    }
+  }
+  return shape;
+}
+
+// Returns true if siblings `a` and `b` can be emitted as one multi-output
+// fusion.
+bool AreMergeable(const HloInstruction& a, const HloInstruction& b) {
+  const HloInstruction* hero_a = GetHeroReduce(a);
+  const HloInstruction* hero_b = GetHeroReduce(b);
+  if (hero_a != nullptr && hero_b != nullptr) {
+    return ShapeUtil::Equal(hero_a->shape(), hero_b->shape()) &&
+           ShapeUtil::Equal(hero_a->operand(0)->shape(),
+                            hero_b->operand(0)->shape()) &&
+           hero_a->dimensions() == hero_b->dimensions();
+  }
+  if (IsMergeableLoopFusion(a) && IsMergeableLoopFusion(b)) {
+    const Shape* shape_a = GetLoopOutputShape(a);
+    const Shape* shape_b = GetLoopOutputShape(b);
+    return shape_a != nullptr && shape_b != nullptr &&
+           ShapeUtil::Equal(*shape_a, *shape_b);
+  }
+  return false;
+}
+
+bool IsCandidate(const HloInstruction& instr) {
+  return instr.user_count() > 0 &&
+         (GetHeroReduce(instr) != nullptr || IsMergeableLoopFusion(instr));
+}
+
+// Wraps an unfused reduce into a kInput fusion, which is how the IR emitter
+// expects multi-output reductions.
+HloInstruction* MakeFusion(HloInstruction* instr) {
+  if (instr->opcode() == HloOpcode::kFusion) {
+    return instr;
+  }
+  HloComputation* computation = instr->parent();
+  HloInstruction* fusion =
+      computation->AddInstruction(HloInstruction::CreateFusion(
+          instr->shape(), HloInstruction::FusionKind::kInput, instr));
+  TF_CHECK_OK(computation->ReplaceInstruction(instr, fusion));
+  return fusion;
+}
+
+// Merges one pair of siblings in `computation`. Returns false if there are no
+// siblings left to merge.
+bool MergeOneSiblingPair(HloComputation* computation) {
+  std::unique_ptr<HloReachabilityMap> reachability =
+      computation->ComputeReachability();
+  for (HloInstruction* parent : computation->MakeInstructionPostOrder()) {
+    if (ShapeUtil::IsTuple(parent->shape()) ||
+        ShapeUtil::IsEffectiveScalar(parent->shape())) {
+      continue;
+    }
+    std::vector<HloInstruction*> siblings;
+    for (HloInstruction* user : parent->users()) {
+      if (IsCandidate(*user)) {
+        siblings.push_back(user);
+      }
+    }
+    for (size_t i = 0; i < siblings.size(); ++i) {
+      for (size_t j = i + 1; j < siblings.size(); ++j) {
+        if (!AreMergeable(*siblings[i], *siblings[j]) ||
+            reachability->IsConnected(siblings[i], siblings[j])) {
+          continue;
+        }
+        VLOG(2) << "Merging sibling " << siblings[j]->name() << " into "
+                << siblings[i]->name() << " (shared operand "
+                << parent->name() << ")";
+        HloInstruction* fusion = MakeFusion(siblings[i]);
+        fusion->MergeFusionInstructionIntoMultiOutput(MakeFusion(siblings[j]));
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+StatusOr<bool> GpuMultiOutputFusion::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    while (MergeOneSiblingPair(computation)) {
+      changed = true;
+    }
+  }
+  VLOG(2) << "After multi-output fusion:";
+  XLA_VLOG_LINES(2, module->ToString());
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
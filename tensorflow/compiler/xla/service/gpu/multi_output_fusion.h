@@ -0,0 +1,53 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_MULTI_OUTPUT_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_MULTI_OUTPUT_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// An HLO pass that merges sibling fusions -- fusions that read the same
+// operand -- into a single multi-output fusion, so that the shared operand is
+// read from memory once instead of once per sibling.
+//
+// Two siblings are merged if
+//
+// 1) both are loop fusions whose outputs all have the same shape, or both are
+//    reductions to a vector (kInput fusions or unfused reduces) that reduce
+//    the same shape over the same dimensions to the same shape, which are the
+//    multi-output fusions the IR emitter can generate a single kernel for;
+// 2) neither one reaches the other, so that merging them doesn't create a
+//    cycle; and
+// 3) the operand they share is not a scalar.
+//
+// This runs after instruction fusion and the fusion merger, which only fuse
+// producers into their consumers.
+class GpuMultiOutputFusion : public HloPassInterface {
+ public:
+  tensorflow::StringPiece name() const override {
+    return "multi-output fusion";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_MULTI_OUTPUT_FUSION_H_
@@ -0,0 +1,155 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/compiler/xla/tools/parser/hlo_parser.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class GpuMultiOutputFusionTest : public HloTestBase {};
+
+// Tests that the sum and the sum of squares of the same input, as computed
+// for batch norm statistics, become a single kernel.
+TEST_F(GpuMultiOutputFusionTest, MergeSiblingReductions) {
+  auto module = tools::Parse(R"(
+HloModule MergeSiblingReductions
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT sum = f32[] add(lhs, rhs)
+}
+
+square_sum {
+  input = f32[32,64]{1,0} parameter(0)
+  zero = f32[] parameter(1)
+  square = f32[32,64]{1,0} multiply(input, input)
+  ROOT reduce = f32[32]{0} reduce(square, zero), dimensions={1}, to_apply=add
+}
+
+ENTRY entry {
+  p = f32[32,64]{1,0} parameter(0)
+  zero = f32[] constant(0)
+  sum = f32[32]{0} reduce(p, zero), dimensions={1}, to_apply=add
+  squares = f32[32]{0} fusion(p, zero), kind=kInput, calls=square_sum
+  ROOT tuple = (f32[32]{0}, f32[32]{0}) tuple(sum, squares)
+})")
+                    .ValueOrDie();
+  EXPECT_TRUE(GpuMultiOutputFusion().Run(module.get()).ValueOrDie());
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_EQ(HloInstruction::FusionKind::kInput, fusion->fusion_kind());
+  EXPECT_THAT(fusion->fused_expression_root(),
+              op::Tuple(op::Reduce(), op::Reduce()));
+}
+
+TEST_F(GpuMultiOutputFusionTest, MergeSiblingLoopFusions) {
+  auto module = tools::Parse(R"(
+HloModule MergeSiblingLoopFusions
+
+negate_computation {
+  input = f32[128]{0} parameter(0)
+  ROOT negate = f32[128]{0} negate(input)
+}
+
+exp_computation {
+  input = f32[128]{0} parameter(0)
+  ROOT exp = f32[128]{0} exponential(input)
+}
+
+ENTRY entry {
+  p = f32[128]{0} parameter(0)
+  negate = f32[128]{0} fusion(p), kind=kLoop, calls=negate_computation
+  exp = f32[128]{0} fusion(p), kind=kLoop, calls=exp_computation
+  ROOT tuple = (f32[128]{0}, f32[128]{0}) tuple(negate, exp)
+})")
+                    .ValueOrDie();
+  EXPECT_TRUE(GpuMultiOutputFusion().Run(module.get()).ValueOrDie());
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_THAT(fusion->fused_expression_root(),
+              op::Tuple(op::Negate(), op::Exp()));
+}
+
+TEST_F(GpuMultiOutputFusionTest, DoNotMergeDifferentOutputShapes) {
+  auto module = tools::Parse(R"(
+HloModule DoNotMergeDifferentOutputShapes
+
+negate_computation {
+  input = f32[128]{0} parameter(0)
+  ROOT negate = f32[128]{0} negate(input)
+}
+
+reshape_computation {
+  input = f32[128]{0} parameter(0)
+  exp = f32[128]{0} exponential(input)
+  ROOT reshape = f32[8,16]{1,0} reshape(exp)
+}
+
+ENTRY entry {
+  p = f32[128]{0} parameter(0)
+  negate = f32[128]{0} fusion(p), kind=kLoop, calls=negate_computation
+  reshape = f32[8,16]{1,0} fusion(p), kind=kLoop, calls=reshape_computation
+  ROOT tuple = (f32[128]{0}, f32[8,16]{1,0}) tuple(negate, reshape)
+})")
+                    .ValueOrDie();
+  EXPECT_FALSE(GpuMultiOutputFusion().Run(module.get()).ValueOrDie());
+}
+
+// Tests that a sibling that reads the other sibling is left alone, since the
+// merged fusion would have to consume its own output.
+TEST_F(GpuMultiOutputFusionTest, DoNotMergeConnectedSiblings) {
+  auto module = tools::Parse(R"(
+HloModule DoNotMergeConnectedSiblings
+
+negate_computation {
+  input = f32[128]{0} parameter(0)
+  ROOT negate = f32[128]{0} negate(input)
+}
+
+add_computation {
+  lhs = f32[128]{0} parameter(0)
+  rhs = f32[128]{0} parameter(1)
+  ROOT add = f32[128]{0} add(lhs, rhs)
+}
+
+ENTRY entry {
+  p = f32[128]{0} parameter(0)
+  negate = f32[128]{0} fusion(p), kind=kLoop, calls=negate_computation
+  ROOT add = f32[128]{0} fusion(p, negate), kind=kLoop, calls=add_computation
+})")
+                    .ValueOrDie();
+  EXPECT_FALSE(GpuMultiOutputFusion().Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
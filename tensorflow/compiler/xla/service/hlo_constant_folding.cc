@@ -34,6 +34,14 @@ limitations under the License.
 
 namespace xla {
 
+namespace {
+
+// Results with more elements than this are not folded: the evaluator would
+// take long to compute them and the module would carry them as constants.
+constexpr int64 kMaxFoldedElements = 1 << 24;
+
+}  // namespace
+
 StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
   // Limit the constant folding to 0 iterations to skip folding loops. This
   // retains the behavior from before while loop support in HloEvaluator and may
@@ -73,6 +81,12 @@ StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
         continue;
       }
 
+      if (ShapeUtil::IsArray(instruction->shape()) &&
+          ShapeUtil::ElementsIn(instruction->shape()) > kMaxFoldedElements) {
+        VLOG(2) << "Not folding large instruction: " << instruction->ToString();
+        continue;
+      }
+
       std::unique_ptr<Literal> result = evaluator->TryEvaluate(instruction);
       // Currently we skip unimplemented operations.
       // TODO(b/35975797): Fold constant computations for more operations.
@@ -325,6 +325,14 @@ StatusOr<std::unique_ptr<Literal>> HloEvaluator::EvaluateElementwiseBinaryOp(
   return result;
 }
 
+/* static */ bool HloEvaluator::HasSameDenseLayout(const Literal& literal,
+                                                  const Shape& shape) {
+  return LayoutUtil::IsDenseArray(literal.shape()) &&
+         LayoutUtil::IsDenseArray(shape) &&
+         ShapeUtil::SameDimensions(literal.shape(), shape) &&
+         LayoutUtil::Equal(literal.shape().layout(), shape.layout());
+}
+
 StatusOr<std::unique_ptr<Literal>> HloEvaluator::EvaluateElementwiseUnaryOp(
     HloOpcode opcode, const Literal& operand) {
   std::unique_ptr<HloInstruction> operand_instr =
@@ -127,6 +127,12 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   template <typename ReturnT, typename ElementwiseT>
   friend class HloEvaluatorTypedVisitor;
 
+  // Returns whether 'literal' is a dense array with the dimensions and layout
+  // of 'shape'. Elementwise ops then walk the buffers linearly instead of
+  // visiting every element by its multi-dimensional index, which dominates
+  // the time spent folding large constants.
+  static bool HasSameDenseLayout(const Literal& literal, const Shape& shape);
+
   // Wraps around instruction handling to infer types before dispatching to
   // the corresponding typed Visitor.
   Status DefaultAction(HloInstruction* hlo) override {
@@ -216,6 +222,14 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     }
 
     auto result = MakeUnique<Literal>(shape);
+    if (HasSameDenseLayout(operand_literal, result->shape())) {
+      auto operand_data = operand_literal.data<NativeT>();
+      auto result_data = result->data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = unary_op(operand_data[i]);
+      }
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(result->Populate<ReturnT>(
         [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
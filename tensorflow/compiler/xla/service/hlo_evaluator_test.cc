@@ -187,6 +187,18 @@ TEST_P(HloEvaluatorTest, DoesAdd) {
   TestBinaryOp(HloOpcode::kAdd, std::move(expected), std::move(lhs),
                std::move(rhs));
 }
+// Operands laid out differently from the result can not be walked linearly.
+TEST_P(HloEvaluatorTest, DoesAddWithDifferentLayouts) {
+  auto lhs = Literal::CreateR2WithLayout<int64>(
+      {{1, 0}, {-100, 4}}, LayoutUtil::MakeLayout({0, 1}));
+  auto rhs = Literal::CreateR2WithLayout<int64>(
+      {{2, 4}, {4, 4}}, LayoutUtil::MakeLayout({1, 0}));
+  auto expected = Literal::CreateR2WithLayout<int64>(
+      {{3, 4}, {-96, 8}}, LayoutUtil::MakeLayout({1, 0}));
+  TestBinaryOp(HloOpcode::kAdd, std::move(expected), std::move(lhs),
+               std::move(rhs));
+}
+
 // Verifies that HloEvaluator evaluates a HLO instruction that performs
 // element-wise and with 2 operands.
 TEST_P(HloEvaluatorTest, DoesAnd) {
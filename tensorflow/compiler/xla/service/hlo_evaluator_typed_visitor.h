@@ -1420,6 +1420,13 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
       }
     }
 
+    // Additions that are not accumulated in a double below are still applied
+    // directly instead of running an embedded evaluator for every element.
+    const bool is_scalar_add = IsScalarAdd(function);
+    const std::function<ElementwiseT(ElementwiseT, ElementwiseT)> add_op =
+        [](ElementwiseT lhs, ElementwiseT rhs) { return lhs + rhs; };
+    const auto scalar_add = ConvertBinaryFunction(add_op);
+
     HloEvaluator embedded_evaluator(parent_->max_loop_iterations_);
     auto result = MakeUnique<Literal>(reduce->shape());
     // For each resulting dimension, calculate and assign computed value.
@@ -1446,6 +1453,16 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
                                     arg_dim_steps, func);
             return static_cast<ReturnT>(computed_result);
           }
+          if (is_scalar_add) {
+            auto func = [&](tensorflow::gtl::ArraySlice<int64> input_index) {
+              result_val =
+                  scalar_add(result_val, arg_literal.Get<ReturnT>(input_index));
+              return true;
+            };
+            ShapeUtil::ForEachIndex(arg_literal.shape(), base, arg_dim_counts,
+                                    arg_dim_steps, func);
+            return result_val;
+          }
           auto func = [&](tensorflow::gtl::ArraySlice<int64> input_index) {
             auto curr_val = arg_literal.Get<ReturnT>(input_index);
 
@@ -2061,12 +2078,23 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     const Literal& rhs_literal = parent_->GetEvaluatedLiteralFor(rhs);
 
     auto result = MakeUnique<Literal>(shape);
+    const auto converted_op = ConvertBinaryFunction(binary_op);
+
+    if (HloEvaluator::HasSameDenseLayout(lhs_literal, result->shape()) &&
+        HloEvaluator::HasSameDenseLayout(rhs_literal, result->shape())) {
+      auto lhs_data = lhs_literal.data<ReturnT>();
+      auto rhs_data = rhs_literal.data<ReturnT>();
+      auto result_data = result->data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = converted_op(lhs_data[i], rhs_data[i]);
+      }
+      return std::move(result);
+    }
 
     TF_RETURN_IF_ERROR(result->Populate<ReturnT>(
         [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
-          return ConvertBinaryFunction(binary_op)(
-              lhs_literal.Get<ReturnT>(multi_index),
-              rhs_literal.Get<ReturnT>(multi_index));
+          return converted_op(lhs_literal.Get<ReturnT>(multi_index),
+                              rhs_literal.Get<ReturnT>(multi_index));
         }));
     return std::move(result);
   }
@@ -2100,6 +2128,19 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     auto result = MakeUnique<Literal>(shape);
 
+    if (HloEvaluator::HasSameDenseLayout(lhs_literal, result->shape()) &&
+        HloEvaluator::HasSameDenseLayout(rhs_literal, result->shape()) &&
+        HloEvaluator::HasSameDenseLayout(ehs_literal, result->shape())) {
+      auto lhs_data = lhs_literal.data<LhsType>();
+      auto rhs_data = rhs_literal.data<RhsType>();
+      auto ehs_data = ehs_literal.data<EhsType>();
+      auto result_data = result->data<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+      }
+      return std::move(result);
+    }
+
     TF_RETURN_IF_ERROR(result->Populate<ReturnT>(
         [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
           return ternary_op(lhs_literal.Get<LhsType>(multi_index),
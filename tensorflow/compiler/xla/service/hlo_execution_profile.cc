@@ -99,6 +99,7 @@ std::unique_ptr<HloProfilePrinterData> CreateHloProfilePrinterData(
           cost_analysis.optimal_seconds(*hlo));
       instruction_info->set_profile_index(
           hlo_profile_index_map.GetProfileIndexFor(*hlo));
+      instruction_info->set_name(hlo->name());
     }
   }
 
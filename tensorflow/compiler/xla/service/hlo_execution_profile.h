@@ -123,6 +123,13 @@ class HloExecutionProfile {
                            device_description.clock_rate_ghz());
   }
 
+  // Returns the measured cycle counts in a form that can be stored and handed
+  // back to the compiler when the module is compiled again.
+  HloExecutionProfileData ToProto() const {
+    return CreateHloExecutionProfileData(hlo_profile_printer_data_,
+                                         profile_counters_.data());
+  }
+
   std::vector<int64>* mutable_profile_counters() { return &profile_counters_; }
   const std::vector<int64>& profile_counters() const {
     return profile_counters_;
@@ -71,5 +71,32 @@ TEST_F(HloExecutionProfileTest, Basic) {
                     ContainsRegex(StrCat(add_cycles, R"(\b.*%)",
                                          add_instruction->name()))));
 }
+
+TEST_F(HloExecutionProfileTest, ToProto) {
+  auto hlo_module = tools::Parse(R"(
+  HloModule test_module
+  ENTRY entry_computation {
+    lhs = f32[30,30]{1,0} parameter(0)
+    rhs = f32[30,30]{1,0} parameter(1)
+    ROOT add = f32[30,30]{1,0} add(lhs, rhs)
+  })")
+                        .ValueOrDie();
+  const HloInstruction* add_instruction =
+      hlo_module->entry_computation()->root_instruction();
+
+  HloCostAnalysis cost_analysis(ShapeUtil::ByteSizeOfElements);
+  HloProfileIndexMap profile_index_map(*hlo_module);
+  std::unique_ptr<HloProfilePrinterData> profile_printer =
+      CreateHloProfilePrinterData(profile_index_map, cost_analysis);
+  HloExecutionProfile execution_profile(profile_printer.get(),
+                                        &profile_index_map);
+  execution_profile.SetCyclesTakenBy(add_instruction, 1000);
+
+  // Instructions without cycles, like the parameters, are left out.
+  HloExecutionProfileData profile_data = execution_profile.ToProto();
+  ASSERT_EQ(profile_data.instruction_profiles_size(), 1);
+  EXPECT_EQ(profile_data.instruction_profiles(0).name(), "add");
+  EXPECT_EQ(profile_data.instruction_profiles(0).cycles(), 1000);
+}
 }  // namespace
 }  // namespace xla
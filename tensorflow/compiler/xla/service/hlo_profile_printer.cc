@@ -61,4 +61,24 @@ string PrintHloProfile(const HloProfilePrinterData& hlo_profile_printer_data,
 
   return result;
 }
+
+HloExecutionProfileData CreateHloExecutionProfileData(
+    const HloProfilePrinterData& hlo_profile_printer_data,
+    const int64* counters) {
+  HloExecutionProfileData profile_data;
+  for (const auto& computation_info :
+       hlo_profile_printer_data.computation_infos()) {
+    for (const auto& instruction_info : computation_info.instruction_infos()) {
+      int64 cycles = counters[instruction_info.profile_index()];
+      if (cycles == 0) {
+        continue;
+      }
+      HloExecutionProfileData::InstructionProfile* instruction_profile =
+          profile_data.add_instruction_profiles();
+      instruction_profile->set_name(instruction_info.name());
+      instruction_profile->set_cycles(cycles);
+    }
+  }
+  return profile_data;
+}
 }  // namespace xla
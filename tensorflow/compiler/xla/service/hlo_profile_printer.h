@@ -27,6 +27,12 @@ namespace xla {
 // Pretty-print an array of profile counters using hlo_profile_printer_data.
 string PrintHloProfile(const HloProfilePrinterData& hlo_profile_printer_data,
                        const int64* counters, double clock_rate_ghz);
+
+// Returns the cycle counts in `counters` of the instructions described by
+// `hlo_profile_printer_data`, leaving out instructions that were not profiled.
+HloExecutionProfileData CreateHloExecutionProfileData(
+    const HloProfilePrinterData& hlo_profile_printer_data,
+    const int64* counters);
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PROFILE_PRINTER_H_
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_scheduling.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <map>
 #include <utility>
 #include <vector>
@@ -388,6 +390,400 @@ class ListScheduler {
   tensorflow::gtl::FlatSet<const HloInstruction*> scheduled_instructions_;
 };
 
+// Improves a sequence of the instructions of a computation by local search:
+// it repeatedly moves single instructions to other positions their
+// dependencies allow, keeping moves that lower the peak memory of the
+// sequence, or keep the peak and lower the total memory over all steps.
+//
+// Memory is modeled like in ListScheduler: a buffer is live from the step its
+// instruction runs until the last step that uses it, or to the end if it is
+// live out, and instructions calling subcomputations additionally need the
+// memory of the largest one while they run. Moving an instruction only changes
+// the memory of the steps it moves across, so every candidate move is
+// evaluated by simulating just those steps.
+class LocalSearchScheduler {
+ public:
+  LocalSearchScheduler(
+      const HloComputation& computation,
+      const TuplePointsToAnalysis& points_to_analysis,
+      const LogicalBuffer::SizeFunction& size_function,
+      const tensorflow::gtl::FlatMap<const HloComputation*, int64>&
+          memory_by_computation,
+      const std::vector<const HloInstruction*>& sequence);
+
+  // Searches until no single move improves the sequence, or until
+  // `max_simulated_steps` steps have been simulated, and returns the resulting
+  // sequence.
+  std::vector<const HloInstruction*> Run(int64 max_simulated_steps);
+
+ private:
+  // Moves are limited to this many positions, which bounds the cost of the
+  // moves tried per instruction.
+  static constexpr int64 kMaxMoveDistance = 64;
+
+  struct Buffer {
+    int64 size;
+    // The instructions using the buffer.
+    std::vector<int64> users;
+    bool live_out;
+  };
+
+  // The modeled memory of a sequence: the peak over all steps, and the sum of
+  // all steps. Moves are compared by peak first.
+  using Cost = std::pair<int64, int64>;
+
+  // Returns the position of instruction `id` after moving the instruction at
+  // position `from` to position `to`.
+  int64 PositionAfterMove(int64 id, int64 from, int64 to) const;
+
+  // Returns the last user of `buffer`, or -1 if there is none, after moving
+  // the instruction at `from` to `to`.
+  int64 LastUserAfterMove(int64 buffer, int64 from, int64 to) const;
+
+  // Returns the cost of the sequence after moving the instruction at `from`
+  // to `to`, simulating only the steps between the two.
+  Cost EvaluateMove(int64 from, int64 to) const;
+
+  // Moves the instruction at `from` to `to`.
+  void ApplyMove(int64 from, int64 to);
+
+  // Recomputes step_bytes_, the running maxima over them, and cost_.
+  void UpdateProfile();
+
+  std::vector<const HloInstruction*> instructions_;
+  std::vector<std::vector<int64>> predecessors_;
+  std::vector<std::vector<int64>> successors_;
+  // The buffers defined and used by each instruction.
+  std::vector<std::vector<int64>> defined_buffers_;
+  std::vector<std::vector<int64>> used_buffers_;
+  // The bytes each instruction defines, and needs for subcomputations.
+  std::vector<int64> defined_bytes_;
+  std::vector<int64> subcomputation_bytes_;
+  std::vector<Buffer> buffers_;
+
+  // The state of the search: the current sequence, the position of every
+  // instruction in it, the last user of every buffer, and the bytes freed
+  // after every instruction runs.
+  std::vector<int64> sequence_;
+  std::vector<int64> position_;
+  std::vector<int64> last_user_;
+  std::vector<int64> freed_bytes_;
+
+  // The memory while each step of sequence_ runs, the maxima over the steps
+  // up to and from each step, and the memory live after each step.
+  std::vector<int64> step_bytes_;
+  std::vector<int64> prefix_max_;
+  std::vector<int64> suffix_max_;
+  std::vector<int64> live_after_;
+  Cost cost_;
+};
+
+LocalSearchScheduler::LocalSearchScheduler(
+    const HloComputation& computation,
+    const TuplePointsToAnalysis& points_to_analysis,
+    const LogicalBuffer::SizeFunction& size_function,
+    const tensorflow::gtl::FlatMap<const HloComputation*, int64>&
+        memory_by_computation,
+    const std::vector<const HloInstruction*>& sequence)
+    : instructions_(sequence) {
+  const int64 n = instructions_.size();
+  tensorflow::gtl::FlatMap<const HloInstruction*, int64> id;
+  for (int64 i = 0; i < n; ++i) {
+    id[instructions_[i]] = i;
+  }
+  predecessors_.resize(n);
+  successors_.resize(n);
+  defined_buffers_.resize(n);
+  used_buffers_.resize(n);
+  defined_bytes_.resize(n, 0);
+  subcomputation_bytes_.resize(n, 0);
+
+  tensorflow::gtl::FlatMap<const LogicalBuffer*, int64> buffer_id;
+  for (int64 i = 0; i < n; ++i) {
+    const HloInstruction* instruction = instructions_[i];
+    tensorflow::gtl::FlatSet<int64> predecessors;
+    for (const HloInstruction* operand : instruction->operands()) {
+      predecessors.insert(id.at(operand));
+    }
+    for (const HloInstruction* predecessor :
+         instruction->control_predecessors()) {
+      predecessors.insert(id.at(predecessor));
+    }
+    for (int64 predecessor : predecessors) {
+      predecessors_[i].push_back(predecessor);
+      successors_[predecessor].push_back(i);
+    }
+
+    if (!ListScheduler::IgnoreInstruction(*instruction)) {
+      for (const LogicalBuffer* buffer :
+           points_to_analysis.GetBuffersDefinedByInstruction(instruction)) {
+        buffer_id[buffer] = buffers_.size();
+        defined_buffers_[i].push_back(buffers_.size());
+        buffers_.push_back({size_function(*buffer), {}, false});
+        defined_bytes_[i] += buffers_.back().size;
+      }
+    }
+    for (const HloComputation* called : instruction->called_computations()) {
+      auto it = memory_by_computation.find(called);
+      if (it != memory_by_computation.end()) {
+        subcomputation_bytes_[i] =
+            std::max(subcomputation_bytes_[i], it->second);
+      }
+    }
+  }
+
+  for (int64 i = 0; i < n; ++i) {
+    tensorflow::gtl::FlatSet<int64> used;
+    for (const HloInstruction* operand : instructions_[i]->operands()) {
+      points_to_analysis.GetPointsToSet(operand).ForEachElement(
+          [&](const ShapeIndex& /*index*/,
+              const PointsToSet::BufferList& buffers) {
+            for (const LogicalBuffer* buffer : buffers) {
+              auto it = buffer_id.find(buffer);
+              if (it != buffer_id.end()) {
+                used.insert(it->second);
+              }
+            }
+          });
+    }
+    for (int64 buffer : used) {
+      used_buffers_[i].push_back(buffer);
+      buffers_[buffer].users.push_back(i);
+    }
+  }
+  for (const LogicalBuffer* buffer :
+       points_to_analysis.GetPointsToSet(computation.root_instruction())
+           .CreateFlattenedSet()) {
+    auto it = buffer_id.find(buffer);
+    if (it != buffer_id.end()) {
+      buffers_[it->second].live_out = true;
+    }
+  }
+
+  sequence_.resize(n);
+  position_.resize(n);
+  for (int64 i = 0; i < n; ++i) {
+    sequence_[i] = i;
+    position_[i] = i;
+  }
+  last_user_.resize(buffers_.size());
+  freed_bytes_.resize(n, 0);
+  for (int64 buffer = 0; buffer < buffers_.size(); ++buffer) {
+    last_user_[buffer] = LastUserAfterMove(buffer, 0, 0);
+  }
+  for (int64 i = 0; i < n; ++i) {
+    for (int64 buffer : defined_buffers_[i]) {
+      // Buffers without users are freed right after they are defined.
+      if (!buffers_[buffer].live_out && last_user_[buffer] == -1) {
+        freed_bytes_[i] += buffers_[buffer].size;
+      }
+    }
+  }
+  for (int64 buffer = 0; buffer < buffers_.size(); ++buffer) {
+    if (!buffers_[buffer].live_out && last_user_[buffer] != -1) {
+      freed_bytes_[last_user_[buffer]] += buffers_[buffer].size;
+    }
+  }
+  UpdateProfile();
+}
+
+int64 LocalSearchScheduler::PositionAfterMove(int64 id, int64 from,
+                                              int64 to) const {
+  const int64 position = position_[id];
+  if (position == from) {
+    return to;
+  }
+  if (to < from && position >= to && position < from) {
+    return position + 1;
+  }
+  if (to > from && position > from && position <= to) {
+    return position - 1;
+  }
+  return position;
+}
+
+int64 LocalSearchScheduler::LastUserAfterMove(int64 buffer, int64 from,
+                                              int64 to) const {
+  int64 last_user = -1;
+  int64 last_position = -1;
+  for (int64 user : buffers_[buffer].users) {
+    const int64 position = PositionAfterMove(user, from, to);
+    if (position > last_position) {
+      last_user = user;
+      last_position = position;
+    }
+  }
+  return last_user;
+}
+
+LocalSearchScheduler::Cost LocalSearchScheduler::EvaluateMove(
+    int64 from, int64 to) const {
+  const int64 moved = sequence_[from];
+  // Only the buffers the moved instruction uses can get another last user.
+  std::vector<std::pair<int64, int64>> freed_bytes_changes;
+  for (int64 buffer : used_buffers_[moved]) {
+    if (buffers_[buffer].live_out) {
+      continue;
+    }
+    const int64 last_user = LastUserAfterMove(buffer, from, to);
+    if (last_user != last_user_[buffer]) {
+      freed_bytes_changes.emplace_back(last_user_[buffer],
+                                       -buffers_[buffer].size);
+      freed_bytes_changes.emplace_back(last_user, buffers_[buffer].size);
+    }
+  }
+
+  const int64 begin = std::min(from, to);
+  const int64 end = std::max(from, to) + 1;
+  int64 live = begin > 0 ? live_after_[begin - 1] : 0;
+  int64 peak = std::max(begin > 0 ? prefix_max_[begin - 1] : 0,
+                        end < sequence_.size() ? suffix_max_[end] : 0);
+  int64 total = cost_.second;
+  for (int64 position = begin; position < end; ++position) {
+    int64 instruction;
+    if (position == to) {
+      instruction = moved;
+    } else if (to < from) {
+      instruction = sequence_[position - 1];
+    } else {
+      instruction = sequence_[position + 1];
+    }
+    const int64 bytes = live + defined_bytes_[instruction] +
+                        subcomputation_bytes_[instruction];
+    peak = std::max(peak, bytes);
+    total += bytes - step_bytes_[position];
+    int64 freed = freed_bytes_[instruction];
+    for (const auto& change : freed_bytes_changes) {
+      if (change.first == instruction) {
+        freed += change.second;
+      }
+    }
+    live += defined_bytes_[instruction] - freed;
+  }
+  // The instructions up to `end` are the same as before, so the memory live
+  // after them is too.
+  DCHECK_EQ(live, live_after_[end - 1]);
+  return {peak, total};
+}
+
+void LocalSearchScheduler::ApplyMove(int64 from, int64 to) {
+  const int64 moved = sequence_[from];
+  for (int64 buffer : used_buffers_[moved]) {
+    if (buffers_[buffer].live_out) {
+      continue;
+    }
+    const int64 last_user = LastUserAfterMove(buffer, from, to);
+    if (last_user != last_user_[buffer]) {
+      freed_bytes_[last_user_[buffer]] -= buffers_[buffer].size;
+      freed_bytes_[last_user] += buffers_[buffer].size;
+      last_user_[buffer] = last_user;
+    }
+  }
+  if (to < from) {
+    std::rotate(sequence_.begin() + to, sequence_.begin() + from,
+                sequence_.begin() + from + 1);
+  } else {
+    std::rotate(sequence_.begin() + from, sequence_.begin() + from + 1,
+                sequence_.begin() + to + 1);
+  }
+  for (int64 position = std::min(from, to); position <= std::max(from, to);
+       ++position) {
+    position_[sequence_[position]] = position;
+  }
+  UpdateProfile();
+}
+
+void LocalSearchScheduler::UpdateProfile() {
+  const int64 n = sequence_.size();
+  step_bytes_.resize(n);
+  live_after_.resize(n);
+  prefix_max_.resize(n);
+  suffix_max_.resize(n);
+  int64 live = 0;
+  cost_ = {0, 0};
+  for (int64 position = 0; position < n; ++position) {
+    const int64 instruction = sequence_[position];
+    step_bytes_[position] = live + defined_bytes_[instruction] +
+                            subcomputation_bytes_[instruction];
+    live += defined_bytes_[instruction] - freed_bytes_[instruction];
+    live_after_[position] = live;
+    prefix_max_[position] =
+        std::max(position > 0 ? prefix_max_[position - 1] : 0,
+                 step_bytes_[position]);
+    cost_.second += step_bytes_[position];
+  }
+  for (int64 position = n - 1; position >= 0; --position) {
+    suffix_max_[position] =
+        std::max(position + 1 < n ? suffix_max_[position + 1] : 0,
+                 step_bytes_[position]);
+  }
+  cost_.first = n > 0 ? prefix_max_[n - 1] : 0;
+}
+
+std::vector<const HloInstruction*> LocalSearchScheduler::Run(
+    int64 max_simulated_steps) {
+  const Cost initial_cost = cost_;
+  int64 simulated_steps = 0;
+  int64 moves = 0;
+  bool improved = true;
+  while (improved && simulated_steps < max_simulated_steps) {
+    improved = false;
+    const std::vector<int64> pass_order = sequence_;
+    for (int64 instruction : pass_order) {
+      if (simulated_steps >= max_simulated_steps) {
+        break;
+      }
+      if (defined_bytes_[instruction] == 0 &&
+          used_buffers_[instruction].empty() &&
+          subcomputation_bytes_[instruction] == 0) {
+        // Moving the instruction doesn't change any step's memory.
+        continue;
+      }
+      const int64 from = position_[instruction];
+      int64 earliest = std::max<int64>(0, from - kMaxMoveDistance);
+      for (int64 predecessor : predecessors_[instruction]) {
+        earliest = std::max(earliest, position_[predecessor] + 1);
+      }
+      int64 latest =
+          std::min<int64>(sequence_.size() - 1, from + kMaxMoveDistance);
+      for (int64 successor : successors_[instruction]) {
+        latest = std::min(latest, position_[successor] - 1);
+      }
+
+      Cost best_cost = cost_;
+      int64 best_to = from;
+      for (int64 to = earliest; to <= latest; ++to) {
+        if (to == from) {
+          continue;
+        }
+        const Cost cost = EvaluateMove(from, to);
+        simulated_steps += std::abs(to - from) + 1;
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_to = to;
+        }
+      }
+      if (best_to != from) {
+        ApplyMove(from, best_to);
+        DCHECK(cost_ == best_cost);
+        ++moves;
+        improved = true;
+      }
+    }
+  }
+  VLOG(2) << "Local search made " << moves << " moves in " << simulated_steps
+          << " simulated steps, changing the modeled peak memory from "
+          << HumanReadableNumBytes(initial_cost.first) << " to "
+          << HumanReadableNumBytes(cost_.first);
+
+  std::vector<const HloInstruction*> sequence;
+  sequence.reserve(sequence_.size());
+  for (int64 instruction : sequence_) {
+    sequence.push_back(instructions_[instruction]);
+  }
+  return sequence;
+}
+
 int64 SumLogicalBufferSizes(
     const TuplePointsToAnalysis::BufferDefinitionVector& buffers,
     const LogicalBuffer::SizeFunction& size_function) {
@@ -576,6 +972,43 @@ StatusOr<std::vector<const HloInstruction*>> DefaultMemoryScheduler(
   }
 }
 
+MemorySchedulerAlgorithm LocalSearchMemoryScheduler(int64 max_simulated_steps) {
+  return [max_simulated_steps](
+             const HloComputation& computation,
+             const TuplePointsToAnalysis& points_to_analysis,
+             const LogicalBuffer::SizeFunction& size_function,
+             const tensorflow::gtl::FlatMap<const HloComputation*, int64>&
+                 memory_by_computation)
+             -> StatusOr<std::vector<const HloInstruction*>> {
+    TF_ASSIGN_OR_RETURN(
+        std::vector<const HloInstruction*> initial_sequence,
+        DefaultMemoryScheduler(computation, points_to_analysis, size_function,
+                               memory_by_computation));
+    TF_ASSIGN_OR_RETURN(
+        const int64 initial_memory,
+        MinimumMemoryForComputation(computation, initial_sequence,
+                                    points_to_analysis, size_function));
+
+    std::vector<const HloInstruction*> sequence =
+        LocalSearchScheduler(computation, points_to_analysis, size_function,
+                             memory_by_computation, initial_sequence)
+            .Run(max_simulated_steps);
+    TF_ASSIGN_OR_RETURN(
+        const int64 memory,
+        MinimumMemoryForComputation(computation, sequence, points_to_analysis,
+                                    size_function));
+    VLOG(2) << "Min-memory local search sequence: "
+            << HumanReadableNumBytes(memory) << ", starting from "
+            << HumanReadableNumBytes(initial_memory);
+    // The model the search optimizes ignores buffers the heap simulator lets
+    // instructions share with their operands, so it can be wrong.
+    if (memory < initial_memory) {
+      return sequence;
+    }
+    return initial_sequence;
+  };
+}
+
 StatusOr<SequentialHloOrdering::HloModuleSequence>
 CreateMemoryMinimizingSequence(const HloModule& module,
                                const LogicalBuffer::SizeFunction& size_function,
@@ -602,13 +1035,14 @@ CreateMemoryMinimizingSequence(const HloModule& module,
 
 StatusOr<std::vector<const HloInstruction*>> CreateMemoryMinimizingSequence(
     const HloComputation& computation,
-    const LogicalBuffer::SizeFunction& size_function) {
+    const LogicalBuffer::SizeFunction& size_function,
+    const MemorySchedulerAlgorithm& algorithm) {
   CHECK(!computation.IsFusionComputation());
   TF_ASSIGN_OR_RETURN(std::unique_ptr<TuplePointsToAnalysis> points_to_analysis,
                       TuplePointsToAnalysis::Run(computation.parent()));
   tensorflow::gtl::FlatMap<const HloComputation*, int64> empty_map;
   return CreateMemoryMinimizingSequence(computation, *points_to_analysis,
-                                        size_function, nullptr, empty_map);
+                                        size_function, algorithm, empty_map);
 }
 
 }  // namespace xla
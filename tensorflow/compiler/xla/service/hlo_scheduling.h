@@ -86,6 +86,15 @@ StatusOr<std::vector<const HloInstruction*>> DefaultMemoryScheduler(
     const tensorflow::gtl::FlatMap<const HloComputation*, int64>&
         memory_by_computation);
 
+// Returns a scheduling algorithm that starts from the sequence
+// DefaultMemoryScheduler chooses and improves it by local search, moving single
+// instructions as long as that lowers peak memory. Candidate moves are
+// evaluated by an incremental simulation of the steps they affect, and the
+// search stops after simulating `max_simulated_steps` steps. The result is
+// verified by a heap simulation of the whole sequence, so it never needs more
+// memory than the sequence it starts from.
+MemorySchedulerAlgorithm LocalSearchMemoryScheduler(int64 max_simulated_steps);
+
 // Returns an HloModuleSequence which seeks to minimize the memory required for
 // the computation. size_function is the function returning the number of bytes
 // required for a LogicalBuffer.
@@ -98,7 +107,8 @@ CreateMemoryMinimizingSequence(const HloModule& module,
 // Currently only used by the GPU backend.
 StatusOr<std::vector<const HloInstruction*>> CreateMemoryMinimizingSequence(
     const HloComputation& computation,
-    const LogicalBuffer::SizeFunction& size_function);
+    const LogicalBuffer::SizeFunction& size_function,
+    const MemorySchedulerAlgorithm& algorithm = {});
 
 }  // namespace xla
 
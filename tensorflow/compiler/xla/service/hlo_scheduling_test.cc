@@ -384,5 +384,95 @@ TEST_F(HloSchedulingTest, MultiOutputFusionAccountedCorrectly) {
   EXPECT_TRUE(ordering.ExecutesBefore(exp, fusion));
 }
 
+TEST_F(HloSchedulingTest, LocalSearchNeverNeedsMoreMemory) {
+  // Several chains of growing and shrinking buffers that the local search can
+  // interleave.
+  const char* module_str = R"(
+HloModule test_local_search
+
+ENTRY entry {
+  p = f32[64]{0} parameter(0)
+  a0 = f32[64]{0} negate(p)
+  a1 = f32[4,64]{1,0} broadcast(a0), dimensions={1}
+  a2 = f32[4,64]{1,0} exponential(a1)
+  a3_slice = f32[1,64]{1,0} slice(a2), slice={[0:1], [0:64]}
+  a3 = f32[64]{0} reshape(a3_slice)
+  b0 = f32[64]{0} exponential(p)
+  b1 = f32[8,64]{1,0} broadcast(b0), dimensions={1}
+  b2 = f32[8,64]{1,0} negate(b1)
+  b3_slice = f32[1,64]{1,0} slice(b2), slice={[0:1], [0:64]}
+  b3 = f32[64]{0} reshape(b3_slice)
+  c0 = f32[64]{0} tanh(p)
+  c1 = f32[16,64]{1,0} broadcast(c0), dimensions={1}
+  c2 = f32[16,64]{1,0} tanh(c1)
+  c3_slice = f32[1,64]{1,0} slice(c2), slice={[0:1], [0:64]}
+  c3 = f32[64]{0} reshape(c3_slice)
+  ab = f32[64]{0} add(a3, b3)
+  ROOT abc = f32[64]{0} add(ab, c3)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          tools::Parse(module_str));
+  auto size_fn = [](const BufferValue& buffer) {
+    return ShapeUtil::ByteSizeOf(buffer.shape(), /*pointer_size=*/8);
+  };
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      SequentialHloOrdering::HloModuleSequence default_sequence,
+      CreateMemoryMinimizingSequence(*module, size_fn,
+                                     DefaultMemoryScheduler));
+  TF_ASSERT_OK_AND_ASSIGN(
+      SequentialHloOrdering::HloModuleSequence local_search_sequence,
+      CreateMemoryMinimizingSequence(
+          *module, size_fn,
+          LocalSearchMemoryScheduler(/*max_simulated_steps=*/1 << 20)));
+
+  const HloComputation* entry = module->entry_computation();
+  ASSERT_EQ(entry->instruction_count(),
+            local_search_sequence.at(entry).size());
+  SequentialHloOrdering ordering(module.get(), local_search_sequence);
+  for (const HloInstruction* instruction : entry->instructions()) {
+    for (const HloInstruction* operand : instruction->operands()) {
+      EXPECT_TRUE(ordering.ExecutesBefore(operand, instruction));
+    }
+  }
+  EXPECT_LE(
+      MinimumMemoryForSequence(local_search_sequence, size_fn).ValueOrDie(),
+      MinimumMemoryForSequence(default_sequence, size_fn).ValueOrDie());
+}
+
+TEST_F(HloSchedulingTest, LocalSearchWithoutBudgetKeepsDefaultSequence) {
+  const char* module_str = R"(
+HloModule test_local_search_budget
+
+ENTRY entry {
+  p = f32[64]{0} parameter(0)
+  a = f32[4,64]{1,0} broadcast(p), dimensions={1}
+  b = f32[4,64]{1,0} negate(a)
+  c = f32[64]{0} exponential(p)
+  d_slice = f32[1,64]{1,0} slice(b), slice={[0:1], [0:64]}
+  d = f32[64]{0} reshape(d_slice)
+  ROOT e = f32[64]{0} add(c, d)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          tools::Parse(module_str));
+  auto size_fn = [](const BufferValue& buffer) {
+    return ShapeUtil::ByteSizeOf(buffer.shape());
+  };
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      SequentialHloOrdering::HloModuleSequence default_sequence,
+      CreateMemoryMinimizingSequence(*module, size_fn,
+                                     DefaultMemoryScheduler));
+  TF_ASSERT_OK_AND_ASSIGN(
+      SequentialHloOrdering::HloModuleSequence local_search_sequence,
+      CreateMemoryMinimizingSequence(
+          *module, size_fn,
+          LocalSearchMemoryScheduler(/*max_simulated_steps=*/0)));
+  EXPECT_EQ(default_sequence.at(module->entry_computation()),
+            local_search_sequence.at(module->entry_computation()));
+}
+
 }  // namespace
 }  // namespace xla
@@ -0,0 +1,65 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/temp_buffer_cache.h"
+
+namespace xla {
+
+OwningDeviceMemory TempBufferCache::Take(const Executable* executable,
+                                         int64 index,
+                                         DeviceMemoryAllocator* allocator,
+                                         int device_ordinal, uint64 size) {
+  OwningDeviceMemory buffer;
+  {
+    tensorflow::mutex_lock lock(mu_);
+    auto it = buffers_.find({executable, index});
+    if (it == buffers_.end()) {
+      return buffer;
+    }
+    buffer = std::move(it->second);
+    buffers_.erase(it);
+  }
+  if (buffer.allocator() != allocator ||
+      buffer.device_ordinal() != device_ordinal || buffer.size() != size) {
+    // The key was reused, e.g. by another executable at the same address.
+    // Free the stale buffer outside of the lock.
+    buffer = nullptr;
+  }
+  return buffer;
+}
+
+void TempBufferCache::GiveBack(const Executable* executable, int64 index,
+                               OwningDeviceMemory buffer) {
+  if (buffer.is_null()) {
+    return;
+  }
+  OwningDeviceMemory replaced;
+  tensorflow::mutex_lock lock(mu_);
+  OwningDeviceMemory& cached = buffers_[{executable, index}];
+  // Concurrent runs may give back buffers for the same allocation; keep one
+  // and free the other once the lock is released.
+  replaced = std::move(cached);
+  cached = std::move(buffer);
+}
+
+void TempBufferCache::Clear() {
+  std::map<std::pair<const Executable*, int64>, OwningDeviceMemory> buffers;
+  {
+    tensorflow::mutex_lock lock(mu_);
+    buffers.swap(buffers_);
+  }
+}
+
+}  // namespace xla
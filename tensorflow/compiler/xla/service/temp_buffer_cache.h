@@ -0,0 +1,72 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_TEMP_BUFFER_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_TEMP_BUFFER_CACHE_H_
+
+#include <map>
+#include <utility>
+
+#include "tensorflow/compiler/xla/service/device_memory_allocator.h"
+#include "tensorflow/compiler/xla/service/owning_device_memory.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace xla {
+
+class Executable;
+
+// Holds on to the temporary buffers of executables between runs, so that
+// consecutive runs of an executable don't allocate and deallocate the same
+// buffers every time. Executables use a cache given to them through
+// ExecutableRunOptions::set_temp_buffer_cache. This class is thread-safe.
+//
+// A buffer that has been given back may still be in use by work enqueued on
+// the stream of the run that gave it back, so a cache may only be shared by
+// runs on the same stream. The cache frees the buffers it holds with the
+// allocator they came from when it is destroyed, so that allocator must
+// outlive it.
+class TempBufferCache {
+ public:
+  TempBufferCache() = default;
+
+  // Returns the buffer given back for allocation `index` of `executable` if it
+  // came from `allocator`, is on `device_ordinal` and has `size` bytes, and a
+  // null buffer otherwise.
+  OwningDeviceMemory Take(const Executable* executable, int64 index,
+                          DeviceMemoryAllocator* allocator, int device_ordinal,
+                          uint64 size);
+
+  // Keeps `buffer`, the temporary buffer for allocation `index` of
+  // `executable`, for the next run of `executable`.
+  void GiveBack(const Executable* executable, int64 index,
+                OwningDeviceMemory buffer);
+
+  // Frees all buffers held, e.g. after `executable` has been destroyed.
+  void Clear();
+
+ private:
+  tensorflow::mutex mu_;
+  std::map<std::pair<const Executable*, int64>, OwningDeviceMemory> buffers_
+      GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TempBufferCache);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_TEMP_BUFFER_CACHE_H_
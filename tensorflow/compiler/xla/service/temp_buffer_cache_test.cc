@@ -0,0 +1,116 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/temp_buffer_cache.h"
+
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/executable.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace {
+
+// Hands out host memory and counts the buffers that are live.
+class CountingAllocator : public DeviceMemoryAllocator {
+ public:
+  CountingAllocator() : DeviceMemoryAllocator(/*platform=*/nullptr) {}
+
+  using DeviceMemoryAllocator::Allocate;
+
+  StatusOr<OwningDeviceMemory> Allocate(int device_ordinal, uint64 size,
+                                        bool retry_on_failure) override {
+    if (size == 0) {
+      return OwningDeviceMemory();
+    }
+    ++live_buffers_;
+    return OwningDeviceMemory(
+        se::DeviceMemoryBase(new char[size], size), device_ordinal, this);
+  }
+
+  Status Deallocate(int device_ordinal, se::DeviceMemoryBase mem) override {
+    if (!mem.is_null()) {
+      --live_buffers_;
+      delete[] static_cast<char*>(mem.opaque());
+    }
+    return Status::OK();
+  }
+
+  bool AllowsAsynchronousDeallocation() const override { return false; }
+
+  int live_buffers() const { return live_buffers_; }
+
+ private:
+  int live_buffers_ = 0;
+};
+
+// Only the addresses of executables are used as keys.
+const Executable* FakeExecutable(int i) {
+  static char executables[2];
+  return reinterpret_cast<const Executable*>(&executables[i]);
+}
+
+TEST(TempBufferCacheTest, ReturnsBufferGivenBack) {
+  CountingAllocator allocator;
+  TempBufferCache cache;
+  OwningDeviceMemory buffer = allocator.Allocate(0, 64).ValueOrDie();
+  void* address = buffer.opaque();
+  cache.GiveBack(FakeExecutable(0), 3, std::move(buffer));
+  EXPECT_EQ(allocator.live_buffers(), 1);
+
+  EXPECT_TRUE(cache.Take(FakeExecutable(0), 2, &allocator, 0, 64).is_null());
+  EXPECT_TRUE(cache.Take(FakeExecutable(1), 3, &allocator, 0, 64).is_null());
+  OwningDeviceMemory taken =
+      cache.Take(FakeExecutable(0), 3, &allocator, 0, 64);
+  EXPECT_EQ(taken.opaque(), address);
+  EXPECT_TRUE(cache.Take(FakeExecutable(0), 3, &allocator, 0, 64).is_null());
+  EXPECT_EQ(allocator.live_buffers(), 1);
+}
+
+TEST(TempBufferCacheTest, FreesMismatchedBuffer) {
+  CountingAllocator allocator;
+  CountingAllocator other_allocator;
+  TempBufferCache cache;
+  cache.GiveBack(FakeExecutable(0), 0, allocator.Allocate(0, 64).ValueOrDie());
+  EXPECT_TRUE(cache.Take(FakeExecutable(0), 0, &allocator, 0, 32).is_null());
+  EXPECT_EQ(allocator.live_buffers(), 0);
+
+  cache.GiveBack(FakeExecutable(0), 0, allocator.Allocate(0, 64).ValueOrDie());
+  EXPECT_TRUE(
+      cache.Take(FakeExecutable(0), 0, &other_allocator, 0, 64).is_null());
+  EXPECT_EQ(allocator.live_buffers(), 0);
+}
+
+TEST(TempBufferCacheTest, FreesReplacedAndClearedBuffers) {
+  CountingAllocator allocator;
+  {
+    TempBufferCache cache;
+    cache.GiveBack(FakeExecutable(0), 0,
+                   allocator.Allocate(0, 64).ValueOrDie());
+    cache.GiveBack(FakeExecutable(0), 0,
+                   allocator.Allocate(0, 64).ValueOrDie());
+    cache.GiveBack(FakeExecutable(1), 0,
+                   allocator.Allocate(0, 64).ValueOrDie());
+    EXPECT_EQ(allocator.live_buffers(), 2);
+    cache.Clear();
+    EXPECT_EQ(allocator.live_buffers(), 0);
+    cache.GiveBack(FakeExecutable(0), 1,
+                   allocator.Allocate(0, 64).ValueOrDie());
+  }
+  EXPECT_EQ(allocator.live_buffers(), 0);
+}
+
+}  // namespace
+}  // namespace xla
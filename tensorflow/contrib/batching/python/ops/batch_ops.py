@@ -59,7 +59,8 @@ def batch_function(num_batch_threads,
                    allowed_batch_sizes=None,
                    grad_timeout_micros=60 * 1000 * 1000,
                    unbatch_timeout_micros=60 * 1000 * 1000,
-                   max_enqueued_batches=10):
+                   max_enqueued_batches=10,
+                   bucket_boundaries=None):
   """Batches the computation done by the decorated function.
 
   So, for example, in the following code
@@ -98,6 +99,10 @@ def batch_function(num_batch_threads,
     unbatch_timeout_micros: The timeout to use for unbatching. See the
      documentation of the unbatch op for more details. Defaults to 60s.
     max_enqueued_batches: The maximum depth of the batch queue. Defaults to 10.
+    bucket_boundaries: Optional list of sequence length bucket boundaries. If
+     set, the second dimension of the arguments is a sequence length, and calls
+     are only batched with others in the same length bucket, zero-padded to the
+     bucket boundary. See the documentation of the `Batch` op for details.
 
   Returns:
     The decorated function will return the unbatched computation output Tensors.
@@ -117,6 +122,7 @@ def batch_function(num_batch_threads,
             batch_timeout_micros=batch_timeout_micros,
             max_enqueued_batches=max_enqueued_batches,
             allowed_batch_sizes=allowed_batch_sizes,
+            bucket_boundaries=bucket_boundaries,
             grad_timeout_micros=grad_timeout_micros,
             shared_name=name)
         outputs = f(*batched_tensors)
@@ -108,6 +108,38 @@ class BatchOpsTest(test.TestCase):
       # Check that the batch tensor incorporates the padding.
       self.assertEqual(len(batch_t), 5)
 
+  def testBucketedBatch(self):
+    """Tests that inputs are batched per length bucket and padded to its edge."""
+    with self.test_session() as sess:
+      inp = array_ops.placeholder(dtype=dtypes.int32, shape=[1, None])
+      batched, index, _ = batch_ops.batch(
+          [inp], num_batch_threads=1, max_batch_size=10,
+          batch_timeout_micros=100000,  # 100ms
+          bucket_boundaries=[4, 8],
+          grad_timeout_micros=0, batching_queue="")
+      feeds = [[[1, 2]], [[3, 4, 5]], [[6, 7, 8, 9, 10, 11]]]
+      results = [None] * len(feeds)
+
+      def worker(i):
+        results[i] = sess.run([batched, index], feed_dict={inp: feeds[i]})
+
+      worker_threads = [
+          threading.Thread(target=worker, args=(i,)) for i in range(3)]
+      for t in worker_threads:
+        t.start()
+      for t in worker_threads:
+        t.join()
+
+      non_empty = sorted(
+          [r[0][0].tolist() for r in results if len(r[1])],
+          key=lambda b: len(b[0]))
+      # The two short sequences go to the first bucket and are padded to 4;
+      # the longer one is batched alone and padded to 8.
+      self.assertEqual(len(non_empty), 2)
+      self.assertAllEqual(sorted(non_empty[0]),
+                          [[1, 2, 0, 0], [3, 4, 5, 0]])
+      self.assertAllEqual(non_empty[1], [[6, 7, 8, 9, 10, 11, 0, 0]])
+
   def testMultipleBatch(self):
     """Tests that multiple batched tensors execute together."""
     with self.test_session() as sess:
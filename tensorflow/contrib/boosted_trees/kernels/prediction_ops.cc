@@ -271,29 +271,27 @@ class GradientTreesPredictionOp : public OpKernel {
     thread::ThreadPool* const worker_threads =
         context->device()->tensorflow_cpu_worker_threads()->workers;
 
+    std::vector<float> tree_weights = ensemble_resource->GetTreeWeights();
     if (apply_averaging_) {
-      DecisionTreeEnsembleConfig adjusted =
-          ensemble_resource->decision_tree_ensemble();
+      const int num_trees = tree_weights.size();
       const int start_averaging = std::max(
           0.0,
           averaging_config_.config_case() ==
                   AveragingConfig::kAverageLastNTreesFieldNumber
-              ? adjusted.trees_size() - averaging_config_.average_last_n_trees()
-              : adjusted.trees_size() *
+              ? num_trees - averaging_config_.average_last_n_trees()
+              : num_trees *
                     (1.0 - averaging_config_.average_last_percent_trees()));
-      const int num_ensembles = adjusted.trees_size() - start_averaging;
-      for (int i = start_averaging; i < adjusted.trees_size(); ++i) {
-        float weight = adjusted.tree_weights(i);
-        adjusted.mutable_tree_weights()->Set(
-            i, weight * (num_ensembles - i + start_averaging) / num_ensembles);
+      const int num_ensembles = num_trees - start_averaging;
+      for (int i = start_averaging; i < num_trees; ++i) {
+        tree_weights[i] = tree_weights[i] *
+                          (num_ensembles - i + start_averaging) /
+                          num_ensembles;
       }
-      MultipleAdditiveTrees::Predict(adjusted, trees_to_include, batch_features,
-                                     worker_threads, output_predictions);
-    } else {
-      MultipleAdditiveTrees::Predict(
-          ensemble_resource->decision_tree_ensemble(), trees_to_include,
-          batch_features, worker_threads, output_predictions);
     }
+    MultipleAdditiveTrees::Predict(*ensemble_resource->GetCompiledEnsemble(),
+                                   tree_weights, trees_to_include,
+                                   batch_features, worker_threads,
+                                   output_predictions);
 
     // Output dropped trees and original weights.
     Tensor* output_dropout_info_t = nullptr;
@@ -16,7 +16,9 @@
 #include <string>
 #include <vector>
 
+#include "tensorflow/contrib/boosted_trees/lib/learner/common/stats/feature-histograms.h"
 #include "tensorflow/contrib/boosted_trees/lib/learner/common/stats/node-stats.h"
+#include "tensorflow/contrib/boosted_trees/lib/utils/parallel_for.h"
 #include "tensorflow/contrib/boosted_trees/proto/split_info.pb.h"
 #include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"
 #include "tensorflow/core/framework/device_base.h"
@@ -27,6 +29,7 @@
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -36,7 +39,10 @@ namespace tensorflow {
 
 using boosted_trees::learner::LearnerConfig_MultiClassStrategy;
 using boosted_trees::learner::SplitInfo;
+using boosted_trees::learner::stochastic::BinFeatureValue;
+using boosted_trees::learner::stochastic::BuildFeatureHistograms;
 using boosted_trees::learner::stochastic::GradientStats;
+using boosted_trees::learner::stochastic::kMaxFeatureBins;
 using boosted_trees::learner::stochastic::NodeStats;
 
 namespace {
@@ -670,4 +676,269 @@ REGISTER_KERNEL_BUILDER(
     Name("BuildCategoricalEqualitySplits").Device(DEVICE_CPU),
     BuildCategoricalEqualitySplitsOp);
 
+class BinDenseFeaturesOp : public OpKernel {
+ public:
+  explicit BinDenseFeaturesOp(OpKernelConstruction* const context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("num_features", &num_features_));
+  }
+
+  void Compute(OpKernelContext* const context) override {
+    OpInputList dense_values_list;
+    OP_REQUIRES_OK(context,
+                   context->input_list("dense_values", &dense_values_list));
+    OpInputList bucket_boundaries_list;
+    OP_REQUIRES_OK(context, context->input_list("bucket_boundaries",
+                                                &bucket_boundaries_list));
+    const int64 num_examples = dense_values_list[0].dim_size(0);
+    for (int i = 0; i < num_features_; ++i) {
+      OP_REQUIRES(context, dense_values_list[i].dim_size(0) == num_examples,
+                  errors::InvalidArgument(
+                      "All dense values must have the same number of "
+                      "examples, got ",
+                      dense_values_list[i].dim_size(0), " and ",
+                      num_examples));
+      const int64 num_boundaries = bucket_boundaries_list[i].NumElements();
+      OP_REQUIRES(context,
+                  num_boundaries > 0 && num_boundaries <= kMaxFeatureBins,
+                  errors::InvalidArgument(
+                      "Feature ", i, " must have between 1 and ",
+                      kMaxFeatureBins, " bucket boundaries, got ",
+                      num_boundaries));
+    }
+
+    Tensor* binned_features_t = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       "binned_features",
+                       TensorShape({num_features_, num_examples}),
+                       &binned_features_t));
+    auto binned_features = binned_features_t->matrix<uint8>();
+
+    auto do_work = [&](int64 start, int64 end) {
+      for (int64 feature = start; feature < end; ++feature) {
+        const auto& values = dense_values_list[feature].vec<float>();
+        const auto& boundaries = bucket_boundaries_list[feature].vec<float>();
+        for (int64 example = 0; example < num_examples; ++example) {
+          binned_features(feature, example) = BinFeatureValue(
+              boundaries.data(), boundaries.size(), values(example));
+        }
+      }
+    };
+    thread::ThreadPool* const worker_threads =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
+    boosted_trees::utils::ParallelFor(num_features_,
+                                      worker_threads->NumThreads(),
+                                      worker_threads, do_work);
+  }
+
+ private:
+  int num_features_;
+};
+REGISTER_KERNEL_BUILDER(Name("BinDenseFeatures").Device(DEVICE_CPU),
+                        BinDenseFeaturesOp);
+
+class BuildFeatureHistogramsOp : public OpKernel {
+ public:
+  explicit BuildFeatureHistogramsOp(OpKernelConstruction* const context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("num_bins", &num_bins_));
+    OP_REQUIRES(context, num_bins_ <= kMaxFeatureBins,
+                errors::InvalidArgument("num_bins must be at most ",
+                                        kMaxFeatureBins, ", got ", num_bins_));
+  }
+
+  void Compute(OpKernelContext* const context) override {
+    const Tensor* binned_features_t;
+    OP_REQUIRES_OK(context,
+                   context->input("binned_features", &binned_features_t));
+    const Tensor* node_ids_t;
+    OP_REQUIRES_OK(context, context->input("node_ids", &node_ids_t));
+    const Tensor* gradients_t;
+    OP_REQUIRES_OK(context, context->input("gradients", &gradients_t));
+    const Tensor* hessians_t;
+    OP_REQUIRES_OK(context, context->input("hessians", &hessians_t));
+    const Tensor* num_nodes_t;
+    OP_REQUIRES_OK(context, context->input("num_nodes", &num_nodes_t));
+    const int32 num_nodes = num_nodes_t->scalar<int32>()();
+    OP_REQUIRES(context, num_nodes >= 0,
+                errors::InvalidArgument("num_nodes must be non-negative, got ",
+                                        num_nodes));
+
+    const int64 num_features = binned_features_t->dim_size(0);
+    const int64 num_examples = binned_features_t->dim_size(1);
+    OP_REQUIRES(context,
+                node_ids_t->NumElements() == num_examples &&
+                    gradients_t->NumElements() == num_examples &&
+                    hessians_t->NumElements() == num_examples,
+                errors::InvalidArgument(
+                    "node_ids, gradients and hessians must have one entry "
+                    "per example."));
+    const auto& binned_features = binned_features_t->flat<uint8>();
+    if (num_bins_ < kMaxFeatureBins) {
+      for (int64 i = 0; i < binned_features.size(); ++i) {
+        const int bin = binned_features(i);
+        OP_REQUIRES(context, bin < num_bins_,
+                    errors::InvalidArgument("Bin ", bin,
+                                            " is out of range for ", num_bins_,
+                                            " bins."));
+      }
+    }
+
+    Tensor* histograms_t = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                "histograms",
+                                TensorShape({num_nodes, num_features,
+                                             num_bins_, 2}),
+                                &histograms_t));
+    auto histograms = histograms_t->flat<float>();
+    histograms.setZero();
+
+    thread::ThreadPool* const worker_threads =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
+    BuildFeatureHistograms(binned_features.data(),
+                           node_ids_t->flat<int32>().data(),
+                           gradients_t->flat<float>().data(),
+                           hessians_t->flat<float>().data(), num_examples,
+                           num_nodes, num_features, num_bins_,
+                           worker_threads->NumThreads(), worker_threads,
+                           histograms.data());
+  }
+
+ private:
+  int num_bins_;
+};
+REGISTER_KERNEL_BUILDER(Name("BuildFeatureHistograms").Device(DEVICE_CPU),
+                        BuildFeatureHistogramsOp);
+
+class BuildHistogramSplitsOp : public OpKernel {
+ public:
+  explicit BuildHistogramSplitsOp(OpKernelConstruction* const context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("num_features", &num_features_));
+  }
+
+  void Compute(OpKernelContext* const context) override {
+    const Tensor* histograms_t;
+    OP_REQUIRES_OK(context, context->input("histograms", &histograms_t));
+    OP_REQUIRES(context, histograms_t->dims() == 4,
+                errors::InvalidArgument("histograms must be rank 4, got ",
+                                        histograms_t->shape().DebugString()));
+    const auto& histograms = histograms_t->tensor<float, 4>();
+    const Tensor* partition_ids_t;
+    OP_REQUIRES_OK(context, context->input("partition_ids", &partition_ids_t));
+    const auto& partition_ids = partition_ids_t->vec<int32>();
+    OpInputList bucket_boundaries_list;
+    OP_REQUIRES_OK(context, context->input_list("bucket_boundaries",
+                                                &bucket_boundaries_list));
+
+    const int64 num_nodes = histograms_t->dim_size(0);
+    const int64 num_bins = histograms_t->dim_size(2);
+    OP_REQUIRES(context,
+                histograms_t->dim_size(1) == num_features_ &&
+                    histograms_t->dim_size(3) == 2,
+                errors::InvalidArgument(
+                    "histograms must have shape [num_nodes, ", num_features_,
+                    ", num_bins, 2], got ",
+                    histograms_t->shape().DebugString()));
+    OP_REQUIRES(context, partition_ids.size() == num_nodes,
+                errors::InvalidArgument(
+                    "partition_ids must have one entry per node."));
+
+    // Every feature sees all the examples of a node, so the node totals can be
+    // read off the histograms of the first feature. Nodes without examples are
+    // not split.
+    std::vector<int64> active_nodes;
+    std::vector<GradientStats> root_gradient_stats;
+    for (int64 node = 0; node < num_nodes; ++node) {
+      float gradient = 0;
+      float hessian = 0;
+      for (int64 bin = 0; bin < num_bins; ++bin) {
+        gradient += histograms(node, 0, bin, 0);
+        hessian += histograms(node, 0, bin, 1);
+      }
+      if (hessian > 0) {
+        active_nodes.push_back(node);
+        root_gradient_stats.emplace_back(gradient, hessian);
+      }
+    }
+    const int64 num_elements = active_nodes.size();
+
+    Tensor* output_partition_ids_t = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output("output_partition_ids",
+                                            TensorShape({num_elements}),
+                                            &output_partition_ids_t));
+    tensorflow::TTypes<int32>::Vec output_partition_ids =
+        output_partition_ids_t->vec<int32>();
+
+    Tensor* gains_t = nullptr;
+    OP_REQUIRES_OK(
+        context, context->allocate_output("gains", TensorShape({num_elements}),
+                                          &gains_t));
+    tensorflow::TTypes<float>::Vec gains = gains_t->vec<float>();
+
+    Tensor* output_splits_t = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                "split_infos", TensorShape({num_elements}),
+                                &output_splits_t));
+    tensorflow::TTypes<string>::Vec output_splits =
+        output_splits_t->vec<string>();
+    SplitBuilderState state(context);
+    for (int64 root_idx = 0; root_idx < num_elements; ++root_idx) {
+      const int64 node = active_nodes[root_idx];
+      NodeStats root_stats =
+          state.ComputeNodeStats(root_gradient_stats[root_idx]);
+      float best_gain = std::numeric_limits<float>::lowest();
+      int32 best_feature = 0;
+      int64 best_bin = 0;
+      NodeStats best_right_node_stats(0);
+      NodeStats best_left_node_stats(0);
+      for (int32 feature = 0; feature < num_features_; ++feature) {
+        const int64 feature_bins = std::min(
+            num_bins, bucket_boundaries_list[feature].NumElements());
+        GradientStats left_gradient_stats;
+        for (int64 bin = 0; bin < feature_bins; ++bin) {
+          left_gradient_stats +=
+              GradientStats(histograms(node, feature, bin, 0),
+                            histograms(node, feature, bin, 1));
+          NodeStats left_stats = state.ComputeNodeStats(left_gradient_stats);
+          GradientStats right_gradient_stats =
+              root_gradient_stats[root_idx] - left_gradient_stats;
+          NodeStats right_stats = state.ComputeNodeStats(right_gradient_stats);
+          if (left_stats.gain + right_stats.gain > best_gain) {
+            best_gain = left_stats.gain + right_stats.gain;
+            best_left_node_stats = left_stats;
+            best_right_node_stats = right_stats;
+            best_feature = feature;
+            best_bin = bin;
+          }
+        }
+      }
+      SplitInfo split_info;
+      auto* dense_split =
+          split_info.mutable_split_node()->mutable_dense_float_binary_split();
+      dense_split->set_feature_column(state.feature_column_group_id() +
+                                      best_feature);
+      dense_split->set_threshold(
+          bucket_boundaries_list[best_feature].vec<float>()(best_bin));
+
+      auto* left_child = split_info.mutable_left_child();
+      auto* right_child = split_info.mutable_right_child();
+
+      state.FillLeaf(best_left_node_stats, left_child);
+      state.FillLeaf(best_right_node_stats, right_child);
+      split_info.SerializeToString(&output_splits(root_idx));
+      gains(root_idx) =
+          best_gain - root_stats.gain - state.tree_complexity_regularization();
+      output_partition_ids(root_idx) = partition_ids(node);
+    }
+  }
+
+ private:
+  int num_features_;
+};
+REGISTER_KERNEL_BUILDER(Name("BuildHistogramSplits").Device(DEVICE_CPU),
+                        BuildHistogramSplitsOp);
+
 }  // namespace tensorflow
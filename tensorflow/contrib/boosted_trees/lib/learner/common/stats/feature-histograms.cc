@@ -0,0 +1,55 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/learner/common/stats/feature-histograms.h"
+
+#include "tensorflow/contrib/boosted_trees/lib/utils/parallel_for.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace learner {
+namespace stochastic {
+
+void BuildFeatureHistograms(const uint8* binned_features, const int32* node_ids,
+                            const float* gradients, const float* hessians,
+                            int64 num_examples, int32 num_nodes,
+                            int32 num_features, int32 num_bins,
+                            int64 desired_parallelism,
+                            thread::ThreadPool* thread_pool,
+                            float* histograms) {
+  const int64 node_stride = static_cast<int64>(num_features) * num_bins * 2;
+  auto do_work = [&](int64 start, int64 end) {
+    for (int64 feature = start; feature < end; ++feature) {
+      const uint8* bins = binned_features + feature * num_examples;
+      float* feature_histograms = histograms + feature * num_bins * 2;
+      for (int64 example = 0; example < num_examples; ++example) {
+        const int32 node_id = node_ids[example];
+        if (node_id < 0 || node_id >= num_nodes) {
+          continue;
+        }
+        float* bin =
+            feature_histograms + node_id * node_stride + bins[example] * 2;
+        bin[0] += gradients[example];
+        bin[1] += hessians[example];
+      }
+    }
+  };
+  boosted_trees::utils::ParallelFor(num_features, desired_parallelism,
+                                    thread_pool, do_work);
+}
+
+}  // namespace stochastic
+}  // namespace learner
+}  // namespace boosted_trees
+}  // namespace tensorflow
@@ -0,0 +1,68 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_LEARNER_COMMON_STATS_FEATURE_HISTOGRAMS_H_
+#define TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_LEARNER_COMMON_STATS_FEATURE_HISTOGRAMS_H_
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace learner {
+namespace stochastic {
+
+// Largest number of bins a feature can be quantized into.
+const int kMaxFeatureBins = 256;
+
+// Returns the bin of value for the given sorted bucket boundaries, i.e. the
+// index of the first boundary that is not less than value, clamped to the last
+// bucket. This matches the bucketization of the Quantiles op so that a split on
+// bin b has threshold boundaries[b].
+inline uint8 BinFeatureValue(const float* boundaries, int num_boundaries,
+                             float value) {
+  const int bin = std::lower_bound(boundaries, boundaries + num_boundaries,
+                                   value) -
+                  boundaries;
+  return static_cast<uint8>(std::min(bin, num_boundaries - 1));
+}
+
+// Accumulates the gradient and hessian of each example into the histograms of
+// its node. The histograms are laid out as
+// [num_nodes, num_features, num_bins, 2], holding the gradient and hessian sums
+// of every bin. binned_features is feature major: the bin of example i for
+// feature f is binned_features[f * num_examples + i], so each feature is read
+// sequentially. Examples whose node id is not in [0, num_nodes) are skipped,
+// which lets callers build only some of the nodes of a layer: histograms are
+// additive, so only the smaller child of a split needs to be built from the
+// examples and its sibling is the parent's histograms minus its own.
+//
+// Work is sharded across features; shards write to disjoint parts of the
+// histograms and need no synchronization. histograms must be zero initialized.
+void BuildFeatureHistograms(const uint8* binned_features, const int32* node_ids,
+                            const float* gradients, const float* hessians,
+                            int64 num_examples, int32 num_nodes,
+                            int32 num_features, int32 num_bins,
+                            int64 desired_parallelism,
+                            thread::ThreadPool* thread_pool,
+                            float* histograms);
+
+}  // namespace stochastic
+}  // namespace learner
+}  // namespace boosted_trees
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_LEARNER_COMMON_STATS_FEATURE_HISTOGRAMS_H_
@@ -0,0 +1,79 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/learner/common/stats/feature-histograms.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace learner {
+namespace stochastic {
+namespace {
+
+TEST(FeatureHistogramsTest, BinFeatureValue) {
+  const float boundaries[] = {1.0f, 2.0f, 3.0f};
+  EXPECT_EQ(0, BinFeatureValue(boundaries, 3, -5.0f));
+  EXPECT_EQ(0, BinFeatureValue(boundaries, 3, 1.0f));
+  EXPECT_EQ(1, BinFeatureValue(boundaries, 3, 1.5f));
+  EXPECT_EQ(2, BinFeatureValue(boundaries, 3, 3.0f));
+  // Values past the last boundary fall into the last bucket.
+  EXPECT_EQ(2, BinFeatureValue(boundaries, 3, 7.0f));
+}
+
+TEST(FeatureHistogramsTest, BuildFeatureHistograms) {
+  // Two features over four examples, feature major.
+  const std::vector<uint8> binned_features = {0, 1, 1, 2,  // Feature 0.
+                                              2, 2, 0, 1};  // Feature 1.
+  // The third example is outside of the nodes being built.
+  const std::vector<int32> node_ids = {0, 1, -1, 1};
+  const std::vector<float> gradients = {0.1f, 0.2f, 0.3f, 0.4f};
+  const std::vector<float> hessians = {1.0f, 2.0f, 3.0f, 4.0f};
+  const int num_nodes = 2;
+  const int num_features = 2;
+  const int num_bins = 3;
+  const std::vector<float> expected = {
+      // Node 0, feature 0.
+      0.1f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+      // Node 0, feature 1.
+      0.0f, 0.0f, 0.0f, 0.0f, 0.1f, 1.0f,
+      // Node 1, feature 0.
+      0.0f, 0.0f, 0.2f, 2.0f, 0.4f, 4.0f,
+      // Node 1, feature 1.
+      0.0f, 0.0f, 0.4f, 4.0f, 0.2f, 2.0f};
+
+  // The result must not depend on how features are sharded.
+  thread::ThreadPool thread_pool(Env::Default(), "histograms", 2);
+  for (int parallelism : {0, 1, 2}) {
+    std::vector<float> histograms(num_nodes * num_features * num_bins * 2);
+    BuildFeatureHistograms(binned_features.data(), node_ids.data(),
+                           gradients.data(), hessians.data(), 4, num_nodes,
+                           num_features, num_bins, parallelism, &thread_pool,
+                           histograms.data());
+    ASSERT_EQ(expected.size(), histograms.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_FLOAT_EQ(expected[i], histograms[i])
+          << "parallelism " << parallelism << " index " << i;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace stochastic
+}  // namespace learner
+}  // namespace boosted_trees
+}  // namespace tensorflow
@@ -13,9 +13,12 @@
 // limitations under the License.
 // =============================================================================
 #include "tensorflow/contrib/boosted_trees/lib/models/multiple_additive_trees.h"
-#include "tensorflow/contrib/boosted_trees/lib/trees/decision_tree.h"
+
+#include <map>
+
 #include "tensorflow/contrib/boosted_trees/lib/utils/batch_features.h"
 #include "tensorflow/contrib/boosted_trees/lib/utils/parallel_for.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace boosted_trees {
@@ -27,6 +30,19 @@ void MultipleAdditiveTrees::Predict(
     const boosted_trees::utils::BatchFeatures& features,
     tensorflow::thread::ThreadPool* const worker_threads,
     tensorflow::TTypes<float>::Matrix output_predictions) {
+  const std::vector<float> tree_weights(config.tree_weights().begin(),
+                                        config.tree_weights().end());
+  Predict(trees::CompiledEnsemble(config), tree_weights, trees_to_include,
+          features, worker_threads, output_predictions);
+}
+
+void MultipleAdditiveTrees::Predict(
+    const boosted_trees::trees::CompiledEnsemble& ensemble,
+    const std::vector<float>& tree_weights,
+    const std::vector<int32>& trees_to_include,
+    const boosted_trees::utils::BatchFeatures& features,
+    tensorflow::thread::ThreadPool* const worker_threads,
+    tensorflow::TTypes<float>::Matrix output_predictions) {
   // Zero out predictions as the model is additive.
   output_predictions.setZero();
 
@@ -36,45 +52,62 @@ void MultipleAdditiveTrees::Predict(
     return;
   }
 
-  // Lambda for doing a block of work.
-  auto update_predictions = [&config, &features, &trees_to_include,
-                             &output_predictions](int64 start, int64 end) {
-    auto examples_iterable = features.examples_iterable(start, end);
+  // Adds the predictions of trees_to_include[tree_start, tree_end) for the
+  // examples in [example_start, example_end).
+  auto add_predictions = [&ensemble, &tree_weights, &trees_to_include,
+                          &features](
+                             int64 example_start, int64 example_end,
+                             int64 tree_start, int64 tree_end,
+                             tensorflow::TTypes<float>::Matrix predictions) {
+    auto examples_iterable =
+        features.examples_iterable(example_start, example_end);
     for (const auto& example : examples_iterable) {
-      for (const int32 tree_idx : trees_to_include) {
-        const boosted_trees::trees::DecisionTreeConfig& tree =
-            config.trees(tree_idx);
-        const float tree_weight = config.tree_weights(tree_idx);
-        const int leaf_idx = trees::DecisionTree::Traverse(tree, 0, example);
-        QCHECK(leaf_idx >= 0) << "Invalid tree: " << tree.DebugString();
-        const auto& leaf_node = tree.nodes(leaf_idx);
-        QCHECK(leaf_node.has_leaf())
-            << "Invalid leaf node: " << leaf_node.DebugString();
-        if (leaf_node.leaf().has_sparse_vector()) {
-          const auto& leaf = leaf_node.leaf().sparse_vector();
-          QCHECK_EQ(leaf.index_size(), leaf.value_size());
-          for (size_t logit_dim = 0; logit_dim < leaf.index_size();
-               ++logit_dim) {
-            const float value = tree_weight * leaf.value(logit_dim);
-            output_predictions(example.example_idx, leaf.index(logit_dim)) +=
-                value;
-          }
-        } else {
-          QCHECK(leaf_node.leaf().has_vector()) << "Unknown leaf type";
-          const auto& leaf = leaf_node.leaf().vector();
-          for (size_t i = 0; i < leaf.value_size(); ++i) {
-            const float value = tree_weight * leaf.value(i);
-            output_predictions(example.example_idx, i) += value;
-          }
+      for (int64 i = tree_start; i < tree_end; ++i) {
+        const int32 tree_idx = trees_to_include[i];
+        const float tree_weight = tree_weights[tree_idx];
+        const int32 leaf_idx = ensemble.Traverse(tree_idx, example);
+        QCHECK(leaf_idx >= 0) << "Invalid tree: " << tree_idx;
+        for (auto* leaf = ensemble.leaf_begin(leaf_idx);
+             leaf != ensemble.leaf_end(leaf_idx); ++leaf) {
+          predictions(example.example_idx, leaf->logit) +=
+              tree_weight * leaf->value;
         }
       }
     }
   };
 
-  // TODO(salehay): parallelize this for low latency in serving path where
-  // batch size tends to be small but ensemble size tends to be large.
-  boosted_trees::utils::ParallelFor(batch_size, worker_threads->NumThreads(),
-                                    worker_threads, update_predictions);
+  const int64 num_threads = worker_threads->NumThreads();
+  const int64 num_trees = trees_to_include.size();
+  if (batch_size >= num_threads || num_trees <= 1) {
+    boosted_trees::utils::ParallelFor(
+        batch_size, num_threads, worker_threads,
+        [&add_predictions, &output_predictions, num_trees](int64 start,
+                                                           int64 end) {
+          add_predictions(start, end, 0, num_trees, output_predictions);
+        });
+    return;
+  }
+
+  // Small batches, as in the serving path, would leave most threads idle, so
+  // shard over trees instead. Each shard accumulates into its own buffer and
+  // the buffers are summed in shard order to keep the result deterministic.
+  mutex mu;
+  std::map<int64, std::vector<float>> shard_predictions;
+  boosted_trees::utils::ParallelFor(
+      num_trees, num_threads, worker_threads, [&](int64 start, int64 end) {
+        std::vector<float> buffer(output_predictions.size());
+        add_predictions(0, batch_size, start, end,
+                        tensorflow::TTypes<float>::Matrix(
+                            buffer.data(), output_predictions.dimension(0),
+                            output_predictions.dimension(1)));
+        mutex_lock l(mu);
+        shard_predictions[start] = std::move(buffer);
+      });
+  for (const auto& shard : shard_predictions) {
+    for (size_t i = 0; i < shard.second.size(); ++i) {
+      output_predictions.data()[i] += shard.second[i];
+    }
+  }
 }
 
 }  // namespace models
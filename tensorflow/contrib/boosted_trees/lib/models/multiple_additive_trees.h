@@ -17,6 +17,7 @@
 
 #include <vector>
 
+#include "tensorflow/contrib/boosted_trees/lib/trees/compiled_ensemble.h"
 #include "tensorflow/contrib/boosted_trees/lib/utils/batch_features.h"
 #include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"  // NOLINT
 #include "tensorflow/core/framework/tensor_types.h"
@@ -39,6 +40,16 @@ class MultipleAdditiveTrees {
       const boosted_trees::utils::BatchFeatures& features,
       tensorflow::thread::ThreadPool* const worker_threads,
       tensorflow::TTypes<float>::Matrix output_predictions);
+
+  // Same as above for an already compiled ensemble, using the given tree
+  // weights. Batches smaller than the number of worker threads are sharded
+  // over trees rather than examples.
+  static void Predict(const boosted_trees::trees::CompiledEnsemble& ensemble,
+                      const std::vector<float>& tree_weights,
+                      const std::vector<int32>& trees_to_include,
+                      const boosted_trees::utils::BatchFeatures& features,
+                      tensorflow::thread::ThreadPool* const worker_threads,
+                      tensorflow::TTypes<float>::Matrix output_predictions);
 };
 
 }  // namespace models
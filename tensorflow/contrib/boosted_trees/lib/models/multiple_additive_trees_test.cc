@@ -268,6 +268,47 @@ TEST_F(MultipleAdditiveTreesTest, DenseLeaves) {
   }
 }
 
+TEST_F(MultipleAdditiveTreesTest, ShardsSmallBatchesOverTrees) {
+  // With more threads than examples, predictions are sharded over trees and
+  // must match the single threaded result up to summation order.
+  DecisionTreeEnsembleConfig tree_ensemble_config;
+  for (int i = 0; i < 20; ++i) {
+    auto* tree = tree_ensemble_config.add_trees();
+    auto* dense_split = tree->add_nodes()->mutable_dense_float_binary_split();
+    dense_split->set_feature_column(0);
+    dense_split->set_threshold(static_cast<float>(i - 10));
+    dense_split->set_left_id(1);
+    dense_split->set_right_id(2);
+    auto* leaf1 = tree->add_nodes()->mutable_leaf()->mutable_vector();
+    leaf1->add_value(0.1f * i);
+    auto* leaf2 = tree->add_nodes()->mutable_leaf()->mutable_vector();
+    leaf2->add_value(-0.05f * i);
+    tree_ensemble_config.add_tree_weights(0.5f + i);
+  }
+  std::vector<int32> trees_to_include;
+  for (int i = 0; i < 20; i += 2) {
+    trees_to_include.push_back(i);
+  }
+
+  auto expected_tensor = AsTensor<float>({0.0f, 0.0f}, {2, 1});
+  auto expected_matrix = expected_tensor.matrix<float>();
+  tensorflow::thread::ThreadPool single_thread(
+      tensorflow::Env::Default(), "test", kNumThreadsSingleThreaded);
+  MultipleAdditiveTrees::Predict(tree_ensemble_config, trees_to_include,
+                                 batch_features_, &single_thread,
+                                 expected_matrix);
+
+  auto output_tensor = AsTensor<float>({0.0f, 0.0f}, {2, 1});
+  auto output_matrix = output_tensor.matrix<float>();
+  tensorflow::thread::ThreadPool threads(tensorflow::Env::Default(), "test",
+                                         kNumThreadsMultiThreaded);
+  MultipleAdditiveTrees::Predict(tree_ensemble_config, trees_to_include,
+                                 batch_features_, &threads, output_matrix);
+  EXPECT_NEAR(expected_matrix(0, 0), output_matrix(0, 0), 1e-5);
+  EXPECT_NEAR(expected_matrix(1, 0), output_matrix(1, 0), 1e-5);
+  EXPECT_NE(0.0f, output_matrix(0, 0));
+}
+
 }  // namespace
 }  // namespace models
 }  // namespace boosted_trees
@@ -0,0 +1,126 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/trees/compiled_ensemble.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+
+CompiledEnsemble::CompiledEnsemble(const DecisionTreeEnsembleConfig& config) {
+  int64 num_nodes = 0;
+  for (const auto& tree : config.trees()) {
+    num_nodes += tree.nodes_size();
+  }
+  nodes_.reserve(num_nodes);
+  roots_.reserve(config.trees_size());
+  for (const auto& tree : config.trees()) {
+    const int32 offset = nodes_.size();
+    roots_.push_back(tree.nodes_size() > 0 ? offset : -1);
+    AddTree(tree, offset);
+  }
+}
+
+void CompiledEnsemble::AddTree(const DecisionTreeConfig& tree,
+                               const int32 offset) {
+  const int32 tree_size = tree.nodes_size();
+  auto set_children = [&](int32 left_id, int32 right_id, Node* node) {
+    QCHECK(left_id > 0 && left_id < tree_size && right_id > 0 &&
+           right_id < tree_size)
+        << "Malformed tree, child ids out of range: " << tree.DebugString();
+    node->left_id = offset + left_id;
+    node->right_id = offset + right_id;
+  };
+  for (const auto& tree_node : tree.nodes()) {
+    Node node = {};
+    switch (tree_node.node_case()) {
+      case TreeNode::kLeaf: {
+        const auto& leaf = tree_node.leaf();
+        node.type = Node::kLeaf;
+        node.begin = leaf_values_.size();
+        if (leaf.has_sparse_vector()) {
+          const auto& sparse = leaf.sparse_vector();
+          QCHECK_EQ(sparse.index_size(), sparse.value_size());
+          for (int i = 0; i < sparse.index_size(); ++i) {
+            leaf_values_.push_back({sparse.index(i), sparse.value(i)});
+          }
+        } else if (leaf.has_vector()) {
+          const auto& dense = leaf.vector();
+          for (int i = 0; i < dense.value_size(); ++i) {
+            leaf_values_.push_back({i, dense.value(i)});
+          }
+        } else {
+          // Reaching such a leaf is an error, as it is when traversing the
+          // proto directly.
+          node.type = Node::kUnknownLeaf;
+        }
+        node.end = leaf_values_.size();
+        break;
+      }
+      case TreeNode::kDenseFloatBinarySplit: {
+        const auto& split = tree_node.dense_float_binary_split();
+        node.type = Node::kDenseFloat;
+        node.feature_column = split.feature_column();
+        node.threshold = split.threshold();
+        set_children(split.left_id(), split.right_id(), &node);
+        break;
+      }
+      case TreeNode::kSparseFloatBinarySplitDefaultLeft:
+      case TreeNode::kSparseFloatBinarySplitDefaultRight: {
+        const bool default_left = tree_node.node_case() ==
+                                  TreeNode::kSparseFloatBinarySplitDefaultLeft;
+        const auto& split =
+            default_left
+                ? tree_node.sparse_float_binary_split_default_left().split()
+                : tree_node.sparse_float_binary_split_default_right().split();
+        node.type = default_left ? Node::kSparseFloatDefaultLeft
+                                 : Node::kSparseFloatDefaultRight;
+        node.feature_column = split.feature_column();
+        node.dimension_id = split.dimension_id();
+        node.threshold = split.threshold();
+        set_children(split.left_id(), split.right_id(), &node);
+        break;
+      }
+      case TreeNode::kCategoricalIdBinarySplit: {
+        const auto& split = tree_node.categorical_id_binary_split();
+        node.type = Node::kCategoricalId;
+        node.feature_column = split.feature_column();
+        node.feature_id = split.feature_id();
+        set_children(split.left_id(), split.right_id(), &node);
+        break;
+      }
+      case TreeNode::kCategoricalIdSetMembershipBinarySplit: {
+        const auto& split =
+            tree_node.categorical_id_set_membership_binary_split();
+        node.type = Node::kCategoricalIdSet;
+        node.feature_column = split.feature_column();
+        node.begin = feature_ids_.size();
+        feature_ids_.insert(feature_ids_.end(), split.feature_ids().begin(),
+                            split.feature_ids().end());
+        node.end = feature_ids_.size();
+        set_children(split.left_id(), split.right_id(), &node);
+        break;
+      }
+      case TreeNode::NODE_NOT_SET: {
+        LOG(QFATAL) << "Invalid node in tree: " << tree_node.DebugString();
+        break;
+      }
+    }
+    nodes_.push_back(node);
+  }
+}
+
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
@@ -0,0 +1,157 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_COMPILED_ENSEMBLE_H_
+#define TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_COMPILED_ENSEMBLE_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/contrib/boosted_trees/lib/utils/example.h"
+#include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"  // NOLINT
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+
+// Flattened form of a tree ensemble for inference. The nodes of all trees are
+// stored in one contiguous array of small fixed size structs with absolute
+// child indices, and leaf values are precomputed as (logit, value) pairs, so
+// that traversal does not go through the proto oneofs and repeated fields.
+// Building it is linear in the size of the ensemble; once built, it is
+// immutable and thread safe.
+class CompiledEnsemble {
+ public:
+  // A (logit dimension, value) pair of a leaf.
+  struct LeafValue {
+    int32 logit;
+    float value;
+  };
+
+  explicit CompiledEnsemble(const DecisionTreeEnsembleConfig& config);
+
+  // Returns the number of trees in the ensemble.
+  int32 num_trees() const { return roots_.size(); }
+
+  // Traverses the given tree and returns the index of the reached leaf node,
+  // or -1 if the tree is empty.
+  int32 Traverse(int32 tree_idx, const utils::Example& example) const {
+    int32 node_id = roots_[tree_idx];
+    if (TF_PREDICT_FALSE(node_id < 0)) {
+      return node_id;
+    }
+    while (true) {
+      const Node& node = nodes_[node_id];
+      switch (node.type) {
+        case Node::kLeaf:
+        case Node::kUnknownLeaf:
+          return node_id;
+        case Node::kDenseFloat:
+          node_id = example.dense_float_features[node.feature_column] <=
+                            node.threshold
+                        ? node.left_id
+                        : node.right_id;
+          break;
+        case Node::kSparseFloatDefaultLeft: {
+          const auto value = example.sparse_float_features[node.feature_column]
+                                                          [node.dimension_id];
+          node_id = !value.has_value() || value.get_value() <= node.threshold
+                        ? node.left_id
+                        : node.right_id;
+          break;
+        }
+        case Node::kSparseFloatDefaultRight: {
+          const auto value = example.sparse_float_features[node.feature_column]
+                                                          [node.dimension_id];
+          node_id = value.has_value() && value.get_value() <= node.threshold
+                        ? node.left_id
+                        : node.right_id;
+          break;
+        }
+        case Node::kCategoricalId: {
+          const auto& features =
+              example.sparse_int_features[node.feature_column];
+          node_id = features.find(node.feature_id) != features.end()
+                        ? node.left_id
+                        : node.right_id;
+          break;
+        }
+        case Node::kCategoricalIdSet: {
+          const int64* ids_begin = feature_ids_.data() + node.begin;
+          const int64* ids_end = feature_ids_.data() + node.end;
+          node_id = node.right_id;
+          for (const int64 feature_id :
+               example.sparse_int_features[node.feature_column]) {
+            if (std::binary_search(ids_begin, ids_end, feature_id)) {
+              node_id = node.left_id;
+              break;
+            }
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  // Returns the values of the given leaf node. Fails if the leaf has neither
+  // dense nor sparse values.
+  const LeafValue* leaf_begin(int32 node_id) const {
+    QCHECK(nodes_[node_id].type == Node::kLeaf) << "Unknown leaf type";
+    return leaf_values_.data() + nodes_[node_id].begin;
+  }
+  const LeafValue* leaf_end(int32 node_id) const {
+    return leaf_values_.data() + nodes_[node_id].end;
+  }
+
+ private:
+  struct Node {
+    enum Type : int32 {
+      kLeaf,
+      kUnknownLeaf,
+      kDenseFloat,
+      kSparseFloatDefaultLeft,
+      kSparseFloatDefaultRight,
+      kCategoricalId,
+      kCategoricalIdSet,
+    };
+    Type type;
+    int32 feature_column;
+    int32 dimension_id;
+    float threshold;
+    int32 left_id;
+    int32 right_id;
+    // Leaves: the range of their values in leaf_values_. Set membership
+    // splits: the range of their sorted ids in feature_ids_.
+    int32 begin;
+    int32 end;
+    int64 feature_id;
+  };
+
+  // Flattens one tree whose nodes start at offset in nodes_.
+  void AddTree(const DecisionTreeConfig& tree, int32 offset);
+
+  std::vector<Node> nodes_;
+  std::vector<int32> roots_;
+  std::vector<LeafValue> leaf_values_;
+  std::vector<int64> feature_ids_;
+};
+
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_TREES_COMPILED_ENSEMBLE_H_
@@ -0,0 +1,187 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/trees/compiled_ensemble.h"
+#include "tensorflow/contrib/boosted_trees/lib/trees/decision_tree.h"
+#include "tensorflow/contrib/boosted_trees/lib/utils/batch_features.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace trees {
+namespace {
+
+class CompiledEnsembleTest : public ::testing::Test {
+ protected:
+  CompiledEnsembleTest() : batch_features_(2) {
+    // Same batch as in decision_tree_test:
+    // Instance | DenseF1 | SparseF1 | SparseF2 | SparseI1 | SparseFM (3 cols)
+    // 0        |   7     |   -3     |          |    3     | 3.0 |   | 1.0
+    // 1        |  -2     |          |   4      |          | 1.5 |3.5|
+    auto dense_float_matrix = test::AsTensor<float>({7.0f, -2.0f}, {2, 1});
+    auto sparse_float_indices1 = test::AsTensor<int64>({0, 0}, {1, 2});
+    auto sparse_float_values1 = test::AsTensor<float>({-3.0f});
+    auto sparse_float_shape1 = test::AsTensor<int64>({2, 1});
+    auto sparse_float_indices2 = test::AsTensor<int64>({1, 0}, {1, 2});
+    auto sparse_float_values2 = test::AsTensor<float>({4.0f});
+    auto sparse_float_shape2 = test::AsTensor<int64>({2, 1});
+    auto sparse_int_indices1 = test::AsTensor<int64>({0, 0}, {1, 2});
+    auto sparse_int_values1 = test::AsTensor<int64>({3});
+    auto sparse_int_shape1 = test::AsTensor<int64>({2, 1});
+    auto multi_sparse_float_indices =
+        test::AsTensor<int64>({0, 0, 0, 2, 1, 0, 1, 1}, {4, 2});
+    auto multi_sparse_float_values =
+        test::AsTensor<float>({3.0f, 1.0f, 1.5f, 3.5f});
+    auto multi_sparse_float_shape = test::AsTensor<int64>({2, 3});
+
+    TF_EXPECT_OK(batch_features_.Initialize(
+        {dense_float_matrix},
+        {sparse_float_indices1, sparse_float_indices2,
+         multi_sparse_float_indices},
+        {sparse_float_values1, sparse_float_values2, multi_sparse_float_values},
+        {sparse_float_shape1, sparse_float_shape2, multi_sparse_float_shape},
+        {sparse_int_indices1}, {sparse_int_values1}, {sparse_int_shape1}));
+  }
+
+  // Expects every tree of the compiled ensemble to reach the same leaves as
+  // traversing its proto.
+  void ExpectSameLeaves(const DecisionTreeEnsembleConfig& config) {
+    CompiledEnsemble compiled(config);
+    ASSERT_EQ(config.trees_size(), compiled.num_trees());
+    int32 offset = 0;
+    for (int tree_idx = 0; tree_idx < config.trees_size(); ++tree_idx) {
+      const DecisionTreeConfig& tree = config.trees(tree_idx);
+      for (const auto& example : batch_features_.examples_iterable(0, 2)) {
+        const int expected = DecisionTree::Traverse(tree, 0, example);
+        const int actual = compiled.Traverse(tree_idx, example);
+        if (expected < 0) {
+          EXPECT_EQ(-1, actual);
+        } else {
+          EXPECT_EQ(offset + expected, actual)
+              << "tree " << tree_idx << " example " << example.example_idx;
+        }
+      }
+      offset += tree.nodes_size();
+    }
+  }
+
+  utils::BatchFeatures batch_features_;
+};
+
+TEST_F(CompiledEnsembleTest, Empty) {
+  DecisionTreeEnsembleConfig config;
+  config.add_trees();
+  ExpectSameLeaves(config);
+}
+
+TEST_F(CompiledEnsembleTest, AllSplitTypes) {
+  DecisionTreeEnsembleConfig config;
+
+  // Dense split.
+  auto* tree = config.add_trees();
+  auto* dense_split = tree->add_nodes()->mutable_dense_float_binary_split();
+  dense_split->set_feature_column(0);
+  dense_split->set_threshold(0.0f);
+  dense_split->set_left_id(1);
+  dense_split->set_right_id(2);
+  tree->add_nodes()->mutable_leaf();
+  tree->add_nodes()->mutable_leaf();
+
+  // Sparse splits with both default directions, on a multivalent column.
+  for (bool default_left : {true, false}) {
+    tree = config.add_trees();
+    auto* sparse_split =
+        default_left ? tree->add_nodes()
+                           ->mutable_sparse_float_binary_split_default_left()
+                           ->mutable_split()
+                     : tree->add_nodes()
+                           ->mutable_sparse_float_binary_split_default_right()
+                           ->mutable_split();
+    sparse_split->set_feature_column(2);
+    sparse_split->set_dimension_id(2);
+    sparse_split->set_threshold(2.0f);
+    sparse_split->set_left_id(1);
+    sparse_split->set_right_id(2);
+    tree->add_nodes()->mutable_leaf();
+    tree->add_nodes()->mutable_leaf();
+  }
+
+  // Categorical splits.
+  tree = config.add_trees();
+  auto* categorical_split =
+      tree->add_nodes()->mutable_categorical_id_binary_split();
+  categorical_split->set_feature_column(0);
+  categorical_split->set_feature_id(3);
+  categorical_split->set_left_id(1);
+  categorical_split->set_right_id(2);
+  tree->add_nodes()->mutable_leaf();
+  tree->add_nodes()->mutable_leaf();
+  tree = config.add_trees();
+  auto* set_split =
+      tree->add_nodes()->mutable_categorical_id_set_membership_binary_split();
+  set_split->set_feature_column(0);
+  set_split->add_feature_ids(1);
+  set_split->add_feature_ids(3);
+  set_split->add_feature_ids(5);
+  set_split->set_left_id(1);
+  set_split->set_right_id(2);
+  tree->add_nodes()->mutable_leaf();
+  tree->add_nodes()->mutable_leaf();
+
+  ExpectSameLeaves(config);
+}
+
+TEST_F(CompiledEnsembleTest, LeafValues) {
+  DecisionTreeEnsembleConfig config;
+  auto* tree = config.add_trees();
+  auto* dense_split = tree->add_nodes()->mutable_dense_float_binary_split();
+  dense_split->set_feature_column(0);
+  dense_split->set_threshold(0.0f);
+  dense_split->set_left_id(1);
+  dense_split->set_right_id(2);
+  auto* sparse_leaf =
+      tree->add_nodes()->mutable_leaf()->mutable_sparse_vector();
+  sparse_leaf->add_index(2);
+  sparse_leaf->add_value(0.5f);
+  auto* dense_leaf = tree->add_nodes()->mutable_leaf()->mutable_vector();
+  dense_leaf->add_value(0.1f);
+  dense_leaf->add_value(0.2f);
+
+  CompiledEnsemble compiled(config);
+  auto example_iterable = batch_features_.examples_iterable(0, 2);
+  auto example_it = example_iterable.begin();
+
+  // 7 > 0 goes to the dense leaf.
+  int32 leaf_idx = compiled.Traverse(0, *example_it);
+  ASSERT_EQ(2, leaf_idx);
+  ASSERT_EQ(2, compiled.leaf_end(leaf_idx) - compiled.leaf_begin(leaf_idx));
+  EXPECT_EQ(0, compiled.leaf_begin(leaf_idx)[0].logit);
+  EXPECT_FLOAT_EQ(0.1f, compiled.leaf_begin(leaf_idx)[0].value);
+  EXPECT_EQ(1, compiled.leaf_begin(leaf_idx)[1].logit);
+  EXPECT_FLOAT_EQ(0.2f, compiled.leaf_begin(leaf_idx)[1].value);
+
+  // -2 <= 0 goes to the sparse leaf.
+  leaf_idx = compiled.Traverse(0, *++example_it);
+  ASSERT_EQ(1, leaf_idx);
+  ASSERT_EQ(1, compiled.leaf_end(leaf_idx) - compiled.leaf_begin(leaf_idx));
+  EXPECT_EQ(2, compiled.leaf_begin(leaf_idx)->logit);
+  EXPECT_FLOAT_EQ(0.5f, compiled.leaf_begin(leaf_idx)->value);
+}
+
+}  // namespace
+}  // namespace trees
+}  // namespace boosted_trees
+}  // namespace tensorflow
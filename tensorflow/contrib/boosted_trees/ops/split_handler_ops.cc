@@ -228,4 +228,159 @@ split_infos: A rank 1 tensor of serialized protos which contains the
     `SplitInfo`s.
 )doc");
 
+REGISTER_OP("BinDenseFeatures")
+    .Attr("num_features: int >= 1")
+    .Input("dense_values: num_features * float")
+    .Input("bucket_boundaries: num_features * float")
+    .Output("binned_features: uint8")
+    .SetShapeFn([](InferenceContext* c) {
+      int num_features;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_features", &num_features));
+      DimensionHandle num_examples = c->UnknownDim();
+      for (int i = 0; i < num_features; ++i) {
+        ShapeHandle values_shape;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 1, &values_shape));
+        TF_RETURN_IF_ERROR(
+            c->Merge(num_examples, c->Dim(values_shape, 0), &num_examples));
+        ShapeHandle boundaries_shape;
+        TF_RETURN_IF_ERROR(
+            c->WithRank(c->input(num_features + i), 1, &boundaries_shape));
+      }
+      c->set_output(0, c->Matrix(num_features, num_examples));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Quantizes dense float features into uint8 bins for histogram split finding.
+
+Bins are computed the same way as by the Quantiles op, so the features only
+need to be binned once per training run rather than on every iteration.
+
+num_features: Number of dense float features to bin.
+dense_values: List of rank 1 tensors containing the dense values.
+bucket_boundaries: List of rank 1 tensors with the sorted bucket boundaries of
+    each feature, with at most 256 boundaries each.
+binned_features: A [num_features, num_examples] tensor with the bin of every
+    example, feature major.
+)doc");
+
+REGISTER_OP("BuildFeatureHistograms")
+    .Attr("num_bins: int >= 1 = 256")
+    .Input("binned_features: uint8")
+    .Input("node_ids: int32")
+    .Input("gradients: float32")
+    .Input("hessians: float32")
+    .Input("num_nodes: int32")
+    .Output("histograms: float32")
+    .SetShapeFn([](InferenceContext* c) {
+      DimensionHandle unused_dim;
+      ShapeHandle binned_features_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &binned_features_shape));
+      DimensionHandle num_examples = c->Dim(binned_features_shape, 1);
+      ShapeHandle node_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &node_ids_shape));
+      TF_RETURN_IF_ERROR(
+          c->Merge(num_examples, c->Dim(node_ids_shape, 0), &unused_dim));
+      ShapeHandle gradients_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &gradients_shape));
+      TF_RETURN_IF_ERROR(
+          c->Merge(num_examples, c->Dim(gradients_shape, 0), &unused_dim));
+      ShapeHandle hessians_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &hessians_shape));
+      TF_RETURN_IF_ERROR(
+          c->Merge(num_examples, c->Dim(hessians_shape, 0), &unused_dim));
+      ShapeHandle unused_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused_shape));
+      DimensionHandle num_nodes;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(4, &num_nodes));
+      int num_bins;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_bins", &num_bins));
+      c->set_output(
+          0, c->MakeShape({num_nodes, c->Dim(binned_features_shape, 0),
+                           c->MakeDim(num_bins), c->MakeDim(2)}));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Builds per node gradient and hessian histograms over binned features.
+
+Histograms are additive: the histograms of a node are the sum of those of its
+children. Callers should build only the smaller child of each split, by giving
+the examples of the other child a node id outside of [0, num_nodes), and obtain
+its sibling by subtracting its histograms from the parent's.
+
+num_bins: Number of bins per feature; every bin must be smaller than this.
+binned_features: A [num_features, num_examples] tensor of bins, as produced by
+    BinDenseFeatures.
+node_ids: A rank 1 tensor with the node of each example. Examples with a node
+    id outside of [0, num_nodes) are ignored.
+gradients: A rank 1 tensor of gradients.
+hessians: A rank 1 tensor of hessians.
+num_nodes: A scalar, the number of nodes to build histograms for.
+histograms: A [num_nodes, num_features, num_bins, 2] tensor with the gradient
+    and hessian sums of every bin.
+)doc");
+
+REGISTER_OP("BuildHistogramSplits")
+    .Attr("num_features: int >= 1")
+    .Input("histograms: float32")
+    .Input("partition_ids: int32")
+    .Input("bucket_boundaries: num_features * float")
+    .Input("class_id: int32")
+    .Input("feature_column_group_id: int32")
+    .Input("l1_regularization: float")
+    .Input("l2_regularization: float")
+    .Input("tree_complexity_regularization: float")
+    .Input("min_node_weight: float")
+    .Input("multiclass_strategy: int32")
+    .Output("output_partition_ids: int32")
+    .Output("gains: float32")
+    .Output("split_infos: string")
+    .SetShapeFn([](InferenceContext* c) {
+      int num_features;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_features", &num_features));
+      DimensionHandle unused_dim;
+      ShapeHandle histograms_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 4, &histograms_shape));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(histograms_shape, 1),
+                                      num_features, &unused_dim));
+      ShapeHandle partition_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &partition_ids_shape));
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(histograms_shape, 0),
+                                  c->Dim(partition_ids_shape, 0), &unused_dim));
+      for (int i = 0; i < num_features; ++i) {
+        ShapeHandle boundaries_shape;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(2 + i), 1, &boundaries_shape));
+      }
+      c->set_output(0, c->Vector(c->UnknownDim()));
+      c->set_output(1, c->Vector(c->UnknownDim()));
+      c->set_output(2, c->Vector(c->UnknownDim()));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Find the split that has the best gain across the histograms of every feature.
+
+num_features: Number of dense float features the histograms were built for.
+histograms: A [num_nodes, num_features, num_bins, 2] tensor, as produced by
+    BuildFeatureHistograms.
+partition_ids: A rank 1 tensor with the partition ID of each node.
+bucket_boundaries: List of rank 1 tensors, thresholds that were used for
+    binning each feature.
+class_id: A scalar, the class id for which we're building the splits.
+feature_column_group_id: A scalar, the index of the first feature; feature i
+    is split on as feature column feature_column_group_id + i.
+l1_regularization: A scalar, which specifies the l1 regularization term.
+l2_regularization: A scalar, which specifies the l2 regularization term.
+tree_complexity_regularization: A scalar, which specifies the tree complexity
+    regularization term.
+min_node_weight: A scalar, minimum sum of example hessian needed in a child.
+    If a split results in a leaf node with a smaller value, the split will not
+    be considered.
+multiclass_strategy: A scalar, specifying the multiclass handling strategy.
+    See LearnerConfig.MultiClassStrategy for valid values.
+output_partition_ids: A rank 1 tensor, the partition IDs that we created splits
+    for. Nodes without examples are skipped.
+gains: A rank 1 tensor, for the computed gain for the created splits.
+split_infos: A rank 1 tensor of serialized protos which contains the
+    `SplitInfo`s.
+)doc");
+
 }  // namespace tensorflow
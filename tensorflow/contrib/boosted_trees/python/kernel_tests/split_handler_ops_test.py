@@ -677,6 +677,58 @@ class SplitHandlerOpsTest(test_util.TensorFlowTestCase):
     self.assertEqual(0, len(gains))
     self.assertEqual(0, len(splits))
 
+  def testMakeHistogramSplit(self):
+    """Tests histogram split finding over binned features."""
+    with self.test_session() as sess:
+      # Gradients    | Partition | Feature 0 | Feature 1 |
+      # (1.2, 0.2)   | 0         | 0.1       | 5.0       |
+      # (-0.3, 0.19) | 0         | 0.4       | 5.0       |
+      # (4.0, 0.13)  | 1         | 0.5       | 5.0       |
+      binned_features = split_handler_ops.bin_dense_features(
+          dense_values=[[0.1, 0.4, 0.5], [5.0, 5.0, 5.0]],
+          bucket_boundaries=[[0.3, 0.52], [1.0]])
+      histograms = split_handler_ops.build_feature_histograms(
+          binned_features=binned_features,
+          node_ids=[0, 0, 1],
+          gradients=[1.2, -0.3, 4.0],
+          hessians=[0.2, 0.19, 0.13],
+          num_nodes=2,
+          num_bins=2)
+      partitions, gains, splits = (
+          split_handler_ops.build_histogram_splits(
+              histograms=histograms,
+              partition_ids=[3, 7],
+              bucket_boundaries=[[0.3, 0.52], [1.0]],
+              l1_regularization=0.1,
+              l2_regularization=1,
+              tree_complexity_regularization=0,
+              min_node_weight=0,
+              class_id=-1,
+              feature_column_group_id=2,
+              multiclass_strategy=learner_pb2.LearnerConfig.TREE_PER_CLASS))
+      binned_features, histograms, partitions, gains, splits = sess.run(
+          [binned_features, histograms, partitions, gains, splits])
+    self.assertAllEqual([[0, 1, 1], [0, 0, 0]], binned_features)
+    self.assertAllClose([[[[1.2, 0.2], [-0.3, 0.19]], [[0.9, 0.39], [0, 0]]],
+                         [[[0, 0], [4.0, 0.13]], [[4.0, 0.13], [0, 0]]]],
+                        histograms)
+    self.assertAllEqual([3, 7], partitions)
+
+    # Partition 3 is split on feature 0, as feature 1 is constant. The
+    # expected values are the same as in testMakeDenseSplit.
+    split_info = split_info_pb2.SplitInfo()
+    split_info.ParseFromString(splits[0])
+    split_node = split_info.split_node.dense_float_binary_split
+    self.assertAllClose(1.0083333 + 0.0336134 - 0.4604317, gains[0], 0.00001)
+    self.assertAllClose([-0.91666], split_info.left_child.vector.value,
+                        0.00001)
+    self.assertAllClose([0.1680672], split_info.right_child.vector.value,
+                        0.00001)
+    self.assertEqual(2, split_node.feature_column)
+    self.assertAllClose(0.3, split_node.threshold, 0.00001)
+
+    # Partition 7 has a single example, so no split has any gain.
+    self.assertAllClose(0.0, gains[1], 0.00001)
 
 if __name__ == "__main__":
   googletest.main()
@@ -15,6 +15,9 @@
 #ifndef TENSORFLOW_CONTRIB_BOOSTED_TREES_RESOURCES_DECISION_TREE_ENSEMBLE_RESOURCE_H_
 #define TENSORFLOW_CONTRIB_BOOSTED_TREES_RESOURCES_DECISION_TREE_ENSEMBLE_RESOURCE_H_
 
+#include <memory>
+
+#include "tensorflow/contrib/boosted_trees/lib/trees/compiled_ensemble.h"
 #include "tensorflow/contrib/boosted_trees/lib/trees/decision_tree.h"
 #include "tensorflow/contrib/boosted_trees/resources/stamped_resource.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -48,6 +51,7 @@ class DecisionTreeEnsembleResource : public StampedResource {
 
   bool InitFromSerialized(const string& serialized, const int64 stamp_token) {
     CHECK_EQ(stamp(), -1) << "Must Reset before Init.";
+    InvalidateCompiledEnsemble();
     if (ParseProtoUnlimited(decision_tree_ensemble_, serialized)) {
       set_stamp(stamp_token);
       return true;
@@ -73,7 +77,22 @@ class DecisionTreeEnsembleResource : public StampedResource {
     }
   }
 
+  // Returns the ensemble flattened for inference. It is built on first use
+  // and cached until the trees are next modified; tree weights are not part
+  // of it. Callers need to hold at least a shared lock on the mutex.
+  std::shared_ptr<const boosted_trees::trees::CompiledEnsemble>
+  GetCompiledEnsemble() {
+    mutex_lock l(compiled_ensemble_mu_);
+    if (compiled_ensemble_ == nullptr) {
+      compiled_ensemble_ =
+          std::make_shared<const boosted_trees::trees::CompiledEnsemble>(
+              *decision_tree_ensemble_);
+    }
+    return compiled_ensemble_;
+  }
+
   boosted_trees::trees::DecisionTreeConfig* AddNewTree(const float weight) {
+    InvalidateCompiledEnsemble();
     // Adding a tree as well as a weight and a tree_metadata.
     decision_tree_ensemble_->add_tree_weights(weight);
     boosted_trees::trees::DecisionTreeMetadata* const metadata =
@@ -83,6 +102,7 @@ class DecisionTreeEnsembleResource : public StampedResource {
   }
 
   void RemoveLastTree() {
+    InvalidateCompiledEnsemble();
     QCHECK_GT(decision_tree_ensemble_->trees_size(), 0);
     decision_tree_ensemble_->mutable_trees()->RemoveLast();
     decision_tree_ensemble_->mutable_tree_weights()->RemoveLast();
@@ -90,6 +110,7 @@ class DecisionTreeEnsembleResource : public StampedResource {
   }
 
   boosted_trees::trees::DecisionTreeConfig* LastTree() {
+    InvalidateCompiledEnsemble();
     const int32 tree_size = decision_tree_ensemble_->trees_size();
     QCHECK_GT(tree_size, 0);
     return decision_tree_ensemble_->mutable_trees(tree_size - 1);
@@ -160,6 +181,7 @@ class DecisionTreeEnsembleResource : public StampedResource {
   virtual void Reset() {
     // Reset stamp.
     set_stamp(-1);
+    InvalidateCompiledEnsemble();
 
     // Clear tree ensemle.
     arena_.Reset();
@@ -171,9 +193,20 @@ class DecisionTreeEnsembleResource : public StampedResource {
   mutex* get_mutex() { return &mu_; }
 
  protected:
+  // Drops the cached compiled ensemble; called by every method that hands out
+  // mutable trees.
+  void InvalidateCompiledEnsemble() {
+    mutex_lock l(compiled_ensemble_mu_);
+    compiled_ensemble_.reset();
+  }
+
   protobuf::Arena arena_;
   mutex mu_;
   boosted_trees::trees::DecisionTreeEnsembleConfig* decision_tree_ensemble_;
+
+  mutex compiled_ensemble_mu_;
+  std::shared_ptr<const boosted_trees::trees::CompiledEnsemble>
+      compiled_ensemble_ GUARDED_BY(compiled_ensemble_mu_);
 };
 
 }  // namespace models
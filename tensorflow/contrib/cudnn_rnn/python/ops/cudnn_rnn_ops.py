@@ -867,7 +867,8 @@ def _cudnn_rnn(inputs,
                direction=CUDNN_RNN_UNIDIRECTION,
                dropout=0.,
                seed=0,
-               name=None):
+               name=None,
+               sequence_lengths=None):
   """Cudnn RNN.
 
   Args:
@@ -894,6 +895,9 @@ def _cudnn_rnn(inputs,
     seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
         for behavior.
     name: name of the operation.
+    sequence_lengths: an optional int32 Tensor of shape [batch_size], the
+        length of each sequence in inputs. The steps past the end of a
+        sequence are skipped, and the outputs at those steps are zero.
   Returns:
     outputs, output_h, output_c
   """
@@ -918,7 +922,10 @@ def _cudnn_rnn(inputs,
       "seed2": seed2,
       "name": name
   }
-  if use_cudnn_v2 is not "1":
+  if sequence_lengths is not None:
+    args["sequence_lengths"] = sequence_lengths
+    outputs, output_h, output_c, _, _ = gen_cudnn_rnn_ops.cudnn_rnnv3(**args)
+  elif use_cudnn_v2 is not "1":
     outputs, output_h, output_c, _ = gen_cudnn_rnn_ops.cudnn_rnn(**args)
   else:
     outputs, output_h, output_c, _, _ = gen_cudnn_rnn_ops.cudnn_rnnv2(**args)
@@ -934,7 +941,8 @@ def cudnn_lstm(inputs,
                direction=CUDNN_RNN_UNIDIRECTION,
                dropout=0.,
                seed=0,
-               name=None):
+               name=None,
+               sequence_lengths=None):
   """Cudnn LSTM.
 
   Args:
@@ -960,11 +968,14 @@ def cudnn_lstm(inputs,
     seed: the op seed used for initializing dropout. See @{tf.set_random_seed}
         for behavior.
     name: name of the operation.
+    sequence_lengths: an optional int32 Tensor of shape [batch_size], the
+        length of each sequence in inputs.
   Returns:
     outputs, output_h, output_c
   """
   return _cudnn_rnn(inputs, input_h, input_c, params, is_training, CUDNN_LSTM,
-                    input_mode, direction, dropout, seed, name)
+                    input_mode, direction, dropout, seed, name,
+                    sequence_lengths)
 
 
 def _cudnn_rnn_no_input_c(inputs,
@@ -49,6 +49,7 @@ See the @{$datasets$Importing Data} Programmer's Guide for an overview.
 @@shuffle_and_repeat
 @@sliding_window_batch
 @@sloppy_interleave
+@@timed_padded_batch
 @@unbatch
 
 @@get_single_element
@@ -65,6 +66,7 @@ from tensorflow.contrib.data.python.ops.batching import batch_and_drop_remainder
 from tensorflow.contrib.data.python.ops.batching import dense_to_sparse_batch
 from tensorflow.contrib.data.python.ops.batching import map_and_batch
 from tensorflow.contrib.data.python.ops.batching import padded_batch_and_drop_remainder
+from tensorflow.contrib.data.python.ops.batching import timed_padded_batch
 from tensorflow.contrib.data.python.ops.batching import unbatch
 from tensorflow.contrib.data.python.ops.counter import Counter
 from tensorflow.contrib.data.python.ops.enumerate_ops import enumerate_dataset
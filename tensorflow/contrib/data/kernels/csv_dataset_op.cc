@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/util/csv_parsing.h"
 
 namespace tensorflow {
 namespace {
@@ -103,12 +104,16 @@ class CSVDatasetOp : public DatasetOpKernel {
     OP_REQUIRES(
         ctx, select_cols.empty() || select_cols.front() >= 0,
         errors::InvalidArgument("select_cols should be non-negative indices"));
-    bool select_all_cols = select_cols.empty();
 
-    *output = new Dataset(
-        ctx, std::move(filenames), header, buffer_size, output_types_,
-        output_shapes_, std::move(record_defaults), std::move(select_cols),
-        select_all_cols, use_quote_delim, delim[0], std::move(na_value));
+    csv::ParseOptions options;
+    options.field_delim = delim[0];
+    options.use_quote_delim = use_quote_delim;
+    options.select_cols = std::move(select_cols);
+    options.na_value = std::move(na_value);
+
+    *output = new Dataset(ctx, std::move(filenames), header, buffer_size,
+                          output_types_, output_shapes_,
+                          std::move(record_defaults), std::move(options));
   }
 
  private:
@@ -117,9 +122,7 @@ class CSVDatasetOp : public DatasetOpKernel {
     Dataset(OpKernelContext* ctx, std::vector<string> filenames, bool header,
             int64 buffer_size, const DataTypeVector& output_types,
             const std::vector<PartialTensorShape>& output_shapes,
-            std::vector<Tensor> record_defaults, std::vector<int64> select_cols,
-            bool select_all_cols, bool use_quote_delim, char delim,
-            string na_value)
+            std::vector<Tensor> record_defaults, csv::ParseOptions options)
         : GraphDatasetBase(ctx),
           filenames_(std::move(filenames)),
           header_(header),
@@ -127,11 +130,7 @@ class CSVDatasetOp : public DatasetOpKernel {
           out_type_(output_types),
           output_shapes_(output_shapes),
           record_defaults_(std::move(record_defaults)),
-          select_cols_(std::move(select_cols)),
-          select_all_cols_(select_all_cols),
-          use_quote_delim_(use_quote_delim),
-          delim_(delim),
-          na_value_(std::move(na_value)) {}
+          options_(std::move(options)) {}
 
     std::unique_ptr<IteratorBase> MakeIterator(
         const string& prefix) const override {
@@ -160,7 +159,7 @@ class CSVDatasetOp : public DatasetOpKernel {
     class Iterator : public DatasetIterator<Dataset> {
      public:
       explicit Iterator(const Params& params)
-          : DatasetIterator<Dataset>(params) {}
+          : DatasetIterator<Dataset>(params), parser_(dataset()->options_) {}
 
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
@@ -204,238 +203,51 @@ class CSVDatasetOp : public DatasetOpKernel {
 
      private:
       // Reads a record by parsing the input buffer, and converting extracted
-      // fields to output tensors as we go.
+      // fields to output tensors.
       Status ReadRecord(IteratorContext* ctx, std::vector<Tensor>* out_tensors)
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         // Extracts fields from line(s) from the buffered input stream.
-        out_tensors->reserve(dataset()->record_defaults_.size());
-
-        string input;
-        TF_RETURN_IF_ERROR(buffered_input_stream_->ReadLine(&input));
-
-        size_t current_idx = 0;
-        size_t num_fields_parsed = 0;
-        size_t selector_idx = 0;  // Keep track of index into select_cols
-
-        while (current_idx < input.size()) {
-          // In each iteration, parse one field
-          if (input[current_idx] == '\n' || input[current_idx] == '\r') {
-            // This should never happen, because buffered input reader splits
-            // input on newlines.
-            return errors::InvalidArgument("Parsing error.");
+        TF_RETURN_IF_ERROR(buffered_input_stream_->ReadLine(&record_));
+        while (true) {
+          Status s = parser_.Parse(record_);
+          if (s.ok()) break;
+          if (!parser_.ended_inside_quotes()) return s;
+          // Our buffered record line reader split a record up because of a
+          // newline encased in quotes. The next line is also part of the
+          // record, so we read it and parse the record again.
+          string line;
+          if (!buffered_input_stream_->ReadLine(&line).ok()) {
+            return errors::InvalidArgument(
+                "Quoted field has to end with quote followed by delim, "
+                "CRLF, or EOF");
           }
-
-          bool quoted = false;
-          bool include =
-              (dataset()->select_all_cols_ ||
-               dataset()->select_cols_[selector_idx] == num_fields_parsed);
-
-          if (dataset()->use_quote_delim_ && input[current_idx] == '"') {
-            quoted = true;
-            current_idx++;
-          }
-
-          // Parse the body of the field
-          string field;
-          if (!quoted) {
-            while (current_idx < input.size() &&
-                   input[current_idx] != dataset()->delim_) {
-              if ((dataset()->use_quote_delim_ && input[current_idx] == '"') ||
-                  input[current_idx] == '\n' || input[current_idx] == '\r') {
-                return errors::InvalidArgument(
-                    "Unquoted fields cannot have quotes/CRLFs inside");
-              }
-              if (include) field += input[current_idx];
-              current_idx++;
-            }  // Exit condition: end of input, or current index at delim
-
-            // Go to next field or the end
-            current_idx++;
-          } else {
-            // Quoted field needs to be ended with '"' and delim or end
-            while (true) {
-              if (current_idx >= input.size() - 1 || input.empty()) {
-                if (current_idx == input.size() - 1 &&
-                    input[current_idx] == '"') {
-                  // We're at the end of the input, and the quote terminates the
-                  // record. Go to end.
-                  current_idx++;
-                  break;
-                }
-                // If there's no terminating quote, it means our buffered record
-                // line reader split a record up. This can happen if there is a
-                // newline encased in quotes. The next line is also part of the
-                // record, so we read it and reset the index.
-                if (include && current_idx == input.size() - 1) {
-                  // TODO(rachelim): Instead of building up a string, keep track
-                  //  of terminal indices (or starting char* and length)
-                  // Also look into using /lib/strings/Scanner
-                  field += input[current_idx];
-                }
-                if (include) {
-                  field += '\n';
-                }
-                current_idx = 0;
-                Status s = buffered_input_stream_->ReadLine(&input);
-                if (!s.ok()) {
-                  return errors::InvalidArgument(
-                      "Quoted field has to end with quote followed by delim, "
-                      "CRLF, or EOF");
-                }
-              } else if (input[current_idx] == '"' &&
-                         input[current_idx + 1] == dataset()->delim_) {
-                // End of field, go to next field or end
-                current_idx += 2;
-                break;
-              } else if (input[current_idx] == '"') {
-                // Current char is a quote. Since we're not at end of field,
-                // the next character must also be a quote.
-                if (input[current_idx + 1] != '"') {
-                  return errors::InvalidArgument(
-                      "Quote inside a string has to be escaped by another "
-                      "quote");
-                }
-                if (include) field += '"';
-                current_idx += 2;
-              } else {
-                if (include) field += input[current_idx];
-                current_idx++;
-              }
-            }
-          }
-
-          num_fields_parsed++;
-
-          if (include) {
-            // Add the tensor to the result
-            TF_RETURN_IF_ERROR(FieldToOutput(ctx, std::move(field),
-                                             selector_idx, out_tensors));
-            selector_idx++;
-            // Terminate early if we have all the fields we want
-            if (selector_idx == dataset()->select_cols_.size())
-              return Status::OK();
-          }
-        }  // Exit condition: current_idx has reached the end of record
-
-        // Check if the last field is empty, and include it if necessary
-        bool include =
-            (dataset()->select_all_cols_ ||
-             dataset()->select_cols_[selector_idx] == num_fields_parsed);
-        if (include && !input.empty() &&
-            input[input.size() - 1] == dataset()->delim_) {
-          TF_RETURN_IF_ERROR(
-              FieldToOutput(ctx, string(), selector_idx, out_tensors));
+          record_ += '\n';
+          record_ += line;
         }
 
-        // Check that number of fields matches
-        if (out_tensors->size() != dataset()->out_type_.size()) {
-          return errors::InvalidArgument("Expect ", dataset()->out_type_.size(),
-                                         " fields but have ",
-                                         out_tensors->size(), " in record");
-        }
-        return Status::OK();
-      }
-
-      // Given a string field, and its index in the output,
-      // converts it to a Tensor of the right type and adds it to the
-      // out_tensors vector.
-      Status FieldToOutput(IteratorContext* ctx, string field,
-                           size_t output_idx,
-                           std::vector<Tensor>* out_tensors) {
-        if (output_idx >= dataset()->out_type_.size()) {
-          // We can get here if we're selecting all columns, but the number of
-          // fields exceeds the number of defaults provided
-          return errors::InvalidArgument("Expect ", dataset()->out_type_.size(),
+        // Check that number of fields matches. We can have more fields if
+        // we're selecting all columns, but the number of fields exceeds the
+        // number of defaults provided.
+        const int num_outputs = dataset()->out_type_.size();
+        if (parser_.num_fields() > num_outputs) {
+          return errors::InvalidArgument("Expect ", num_outputs,
                                          " fields but have more in record");
         }
-        const DataType& dtype = dataset()->out_type_[output_idx];
-        Tensor component(ctx->allocator({}), dtype, {});
-        if ((field.empty() || field == dataset()->na_value_) &&
-            dataset()->record_defaults_[output_idx].NumElements() != 1) {
-          // If the field is empty or NA value, and default is not given,
-          // report error.
-          return errors::InvalidArgument("Field ", output_idx,
-                                         " is required but missing in record!");
+        if (parser_.num_fields() != num_outputs) {
+          return errors::InvalidArgument("Expect ", num_outputs,
+                                         " fields but have ",
+                                         parser_.num_fields(), " in record");
         }
 
-        switch (dtype) {
-          // For each case, if the field is empty, we use the default.
-          // Otherwise, we convert it to the right type.
-          case DT_INT32: {
-            if (field.empty() || field == dataset()->na_value_) {
-              component.scalar<int32>()() =
-                  dataset()->record_defaults_[output_idx].flat<int32>()(0);
-            } else {
-              int32 value;
-              if (!strings::safe_strto32(field, &value)) {
-                return errors::InvalidArgument(
-                    "Field ", output_idx,
-                    " in record is not a valid int32: ", field);
-              }
-              component.scalar<int32>()() = value;
-            }
-            break;
-          }
-          case DT_INT64: {
-            if (field.empty() || field == dataset()->na_value_) {
-              component.scalar<int64>()() =
-                  dataset()->record_defaults_[output_idx].flat<int64>()(0);
-            } else {
-              int64 value;
-              if (!strings::safe_strto64(field, &value)) {
-                return errors::InvalidArgument(
-                    "Field ", output_idx,
-                    " in record is not a valid int64: ", field);
-              }
-              component.scalar<int64>()() = value;
-            }
-            break;
-          }
-          case DT_FLOAT: {
-            if (field.empty() || field == dataset()->na_value_) {
-              component.scalar<float>()() =
-                  dataset()->record_defaults_[output_idx].flat<float>()(0);
-            } else {
-              float value;
-              if (!strings::safe_strtof(field.c_str(), &value)) {
-                return errors::InvalidArgument(
-                    "Field ", output_idx,
-                    " in record is not a valid float: ", field);
-              }
-              component.scalar<float>()() = value;
-            }
-            break;
-          }
-          case DT_DOUBLE: {
-            if (field.empty() || field == dataset()->na_value_) {
-              component.scalar<double>()() =
-                  dataset()->record_defaults_[output_idx].flat<double>()(0);
-            } else {
-              double value;
-              if (!strings::safe_strtod(field.c_str(), &value)) {
-                return errors::InvalidArgument(
-                    "Field ", output_idx,
-                    " in record is not a valid double: ", field);
-              }
-              component.scalar<double>()() = value;
-            }
-            break;
-          }
-          case DT_STRING: {
-            if (field.empty() || field == dataset()->na_value_) {
-              component.scalar<string>()() =
-                  dataset()->record_defaults_[output_idx].flat<string>()(0);
-            } else {
-              component.scalar<string>()() = std::move(field);
-            }
-            break;
-          }
-          default:
-            return errors::InvalidArgument("csv: data type ", dtype,
-                                           " not supported in field ",
-                                           output_idx);
+        out_tensors->reserve(num_outputs);
+        for (int i = 0; i < num_outputs; ++i) {
+          Tensor component(ctx->allocator({}), dataset()->out_type_[i], {});
+          TF_RETURN_IF_ERROR(csv::ConvertField(
+              parser_.field(i), dataset()->options_.na_value,
+              dataset()->record_defaults_[i], i, /*record_index=*/-1,
+              /*index=*/0, &component));
+          out_tensors->push_back(std::move(component));
         }
-        out_tensors->push_back(std::move(component));
         return Status::OK();
       }
 
@@ -482,7 +294,9 @@ class CSVDatasetOp : public DatasetOpKernel {
       size_t current_file_index_ GUARDED_BY(mu_) = 0;
       std::unique_ptr<RandomAccessFile> file_
           GUARDED_BY(mu_);  // must outlive input_stream_
-    };                      // class Iterator
+      string record_ GUARDED_BY(mu_);
+      csv::RecordParser parser_ GUARDED_BY(mu_);
+    };  // class Iterator
 
     const std::vector<string> filenames_;
     const bool header_;
@@ -490,11 +304,7 @@ class CSVDatasetOp : public DatasetOpKernel {
     const DataTypeVector out_type_;
     const std::vector<PartialTensorShape> output_shapes_;
     const std::vector<Tensor> record_defaults_;
-    const std::vector<int64> select_cols_;
-    const bool select_all_cols_;
-    const bool use_quote_delim_;
-    const char delim_;
-    const string na_value_;
+    const csv::ParseOptions options_;
   };  // class Dataset
 
   DataTypeVector output_types_;
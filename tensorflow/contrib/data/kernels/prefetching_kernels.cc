@@ -12,8 +12,12 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
 #include <deque>
+#include <memory>
 
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -33,6 +37,12 @@ struct BufferElement {
 
 using FunctionBufferCallback = std::function<void(const BufferElement&)>;
 
+// Buffers the elements returned by calls of a function, such as the
+// elements of an iterator on another device. If `device_context` is not null,
+// the elements are returned in host memory by the function, and then copied
+// to `device` through pinned memory on the host-to-device stream of the device,
+// so that the copy of an element overlaps with the call that produces the next
+// one. Up to `buffer_size` elements are kept ready on the device.
 class FunctionBufferingResource : public ResourceBase {
  public:
   FunctionBufferingResource(FunctionLibraryRuntime* lib,
@@ -40,7 +50,8 @@ class FunctionBufferingResource : public ResourceBase {
                             const NameAttrList& func, int64 buffer_size,
                             const string& source_device,
                             const string& target_device,
-                            const std::vector<Tensor>& func_args)
+                            const std::vector<Tensor>& func_args,
+                            Device* device, DeviceContext* device_context)
       : lib_(lib),
         pflr_(std::move(pflr)),
         func_(func),
@@ -48,13 +59,18 @@ class FunctionBufferingResource : public ResourceBase {
         source_device_(source_device),
         target_device_(target_device),
         func_args_(func_args),
+        device_(device),
+        device_context_(device_context),
         handle_(kInvalidHandle),
         is_buffering_(false),
         end_of_sequence_(false),
-        cancelled_(false) {}
+        cancelled_(false) {
+    if (device_context_ != nullptr) device_context_->Ref();
+  }
 
   ~FunctionBufferingResource() override {
     Cancel();
+    if (device_context_ != nullptr) device_context_->Unref();
   }
 
   string DebugString() override {
@@ -73,8 +89,17 @@ class FunctionBufferingResource : public ResourceBase {
     AttrValueMap attr_values = func_.attr();
     FunctionLibraryRuntime::InstantiateOptions opts;
     opts.target = target_device_;
-    return lib_->Instantiate(func_.name(), AttrSlice(&attr_values), opts,
-                             &handle_);
+    TF_RETURN_IF_ERROR(lib_->Instantiate(func_.name(), AttrSlice(&attr_values),
+                                         opts, &handle_));
+    if (device_context_ != nullptr) {
+      // The function returns its results in host memory, and the resource
+      // copies them to the device.
+      AllocatorAttributes on_host;
+      on_host.set_on_host(true);
+      rets_alloc_attrs_.assign(lib_->GetFunctionBody(handle_)->ret_types.size(),
+                               on_host);
+    }
+    return Status::OK();
   }
 
   // Returns true if we've got to the end of the sequence and exhausted the
@@ -88,7 +113,7 @@ class FunctionBufferingResource : public ResourceBase {
   void Cancel() LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
     cancelled_ = true;
-    while (is_buffering_) {
+    while (is_buffering_ || num_pending_copies_ > 0) {
       cond_var_.wait(l);
     }
   }
@@ -104,29 +129,23 @@ class FunctionBufferingResource : public ResourceBase {
     cancelled_ = false;
   }
 
-  // If the buffer has anything, runs `callback` on the first element in the
-  // buffer, else schedules the `callback` to be called. Requires `args` and
+  // If the buffer has a ready element, runs `callback` on the first element in
+  // the buffer, else schedules the `callback` to be called. Requires `args` and
   // `lib` in case more function calls need to be scheduled.
   void MaybeGet(FunctionBufferCallback callback) LOCKS_EXCLUDED(mu_) {
     bool start_buffering = false;
-    bool produced_output = false;
-    BufferElement buffer_element;
+    std::vector<FunctionBufferCallback> callbacks;
+    std::vector<BufferElement> buffer_elements;
     {
       mutex_lock l(mu_);
       if (!is_buffering_ && !end_of_sequence_) {
         start_buffering = true;
       }
-      if (!buffer_.empty()) {
-        produced_output = true;
-        std::swap(buffer_element, buffer_.front());
-        buffer_.pop_front();
-      } else {
-        produced_output = false;
-        requests_.push_back(std::move(callback));
-      }
+      requests_.push_back(std::move(callback));
+      TakeReadyElementsLocked(&callbacks, &buffer_elements);
     }
-    if (produced_output) {
-      callback(buffer_element);
+    for (int i = 0; i < callbacks.size(); ++i) {
+      callbacks[i](buffer_elements[i]);
     }
     if (start_buffering) {
       FillBuffer();
@@ -134,6 +153,26 @@ class FunctionBufferingResource : public ResourceBase {
   }
 
  private:
+  // An element of the buffer, which is ready once its tensors are on the
+  // device.
+  struct BufferSlot {
+    BufferElement element;
+    bool ready = false;
+  };
+
+  // Pops the pending requests that can be fulfilled by the ready elements at
+  // the front of the buffer, in order.
+  void TakeReadyElementsLocked(std::vector<FunctionBufferCallback>* callbacks,
+                               std::vector<BufferElement>* buffer_elements)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (!requests_.empty() && !buffer_.empty() && buffer_.front().ready) {
+      buffer_elements->push_back(std::move(buffer_.front().element));
+      buffer_.pop_front();
+      callbacks->push_back(std::move(requests_.front()));
+      requests_.pop_front();
+    }
+  }
+
   void FillBuffer() LOCKS_EXCLUDED(mu_) {
     FunctionLibraryRuntime::Handle handle;
     std::vector<FunctionBufferCallback> cancellation_callbacks;
@@ -145,17 +184,11 @@ class FunctionBufferingResource : public ResourceBase {
       if (cancelled_) {
         cancelled = true;
         // Run through and fulfill all pending requests, if possible.
-        while (!requests_.empty()) {
-          if (!buffer_.empty()) {
-            cancellation_buffer_elements.push_back(std::move(buffer_.front()));
-            buffer_.pop_front();
-            cancellation_callbacks.push_back(std::move(requests_.front()));
-            requests_.pop_front();
-          } else {
-            LOG(ERROR) << "Buffer ran out of elements and we couldn't satisfy: "
-                       << requests_.size() << " requests";
-            break;
-          }
+        TakeReadyElementsLocked(&cancellation_callbacks,
+                                &cancellation_buffer_elements);
+        if (!requests_.empty()) {
+          LOG(ERROR) << "Buffer ran out of elements and we couldn't satisfy: "
+                     << requests_.size() << " requests";
         }
         is_buffering_ = false;
       } else {
@@ -176,6 +209,7 @@ class FunctionBufferingResource : public ResourceBase {
     AllocatorAttributes arg_alloc_attr;
     arg_alloc_attr.set_on_host(true);
     opts.args_alloc_attrs.push_back(arg_alloc_attr);
+    opts.rets_alloc_attrs = rets_alloc_attrs_;
     if (opts.source_device != target_device_) {
       opts.remote_execution = true;
     }
@@ -183,26 +217,29 @@ class FunctionBufferingResource : public ResourceBase {
     auto* rets = new std::vector<Tensor>;
     lib_->Run(opts, handle, func_args_, rets,
               [this, rets](const Status& status) {
-                FunctionBufferCallback callback = nullptr;
-                BufferElement buffer_front;
+                std::vector<FunctionBufferCallback> callbacks;
+                std::vector<BufferElement> buffer_elements;
+                BufferSlot* copy_slot = nullptr;
                 bool restart_buffering = false;
                 {
                   mutex_lock l(mu_);
-                  BufferElement buffer_element;
-                  buffer_element.status = status;
+                  buffer_.emplace_back();
+                  BufferSlot* slot = &buffer_.back();
+                  slot->element.status = status;
                   if (status.ok()) {
-                    buffer_element.value.swap(*rets);
+                    slot->element.value.swap(*rets);
+                    if (device_context_ != nullptr) {
+                      copy_slot = slot;
+                      ++num_pending_copies_;
+                    }
                   } else {
                     end_of_sequence_ = true;
                     is_buffering_ = false;
                   }
-                  buffer_.push_back(std::move(buffer_element));
-                  if (!requests_.empty()) {
-                    buffer_front = std::move(buffer_.front());
-                    buffer_.pop_front();
-                    callback = std::move(requests_.front());
-                    requests_.pop_front();
-                  }
+                  slot->ready = copy_slot == nullptr;
+                  TakeReadyElementsLocked(&callbacks, &buffer_elements);
+                  // The elements that are being copied count towards the
+                  // buffer size.
                   if (buffer_.size() < buffer_size_ && !end_of_sequence_) {
                     restart_buffering = true;
                   } else {
@@ -216,8 +253,12 @@ class FunctionBufferingResource : public ResourceBase {
                     is_buffering_ = false;
                   }
                 }
-                if (callback != nullptr) {
-                  callback(buffer_front);
+                delete rets;
+                if (copy_slot != nullptr) {
+                  CopyToDevice(copy_slot);
+                }
+                for (int i = 0; i < callbacks.size(); ++i) {
+                  callbacks[i](buffer_elements[i]);
                 }
                 if (restart_buffering) {
                   FillBuffer();
@@ -225,6 +266,73 @@ class FunctionBufferingResource : public ResourceBase {
               });
   }
 
+  // Replaces the host tensors of `slot` by device tensors. Each tensor is
+  // first copied to a pinned staging buffer, so that the DMA to the device is
+  // asynchronous. `slot` stays valid until it is ready, since the buffer is
+  // only cleared once there are no pending copies.
+  void CopyToDevice(BufferSlot* slot) LOCKS_EXCLUDED(mu_) {
+    struct CopyState {
+      mutex mu;
+      int num_pending GUARDED_BY(mu) = 1;
+      Status status GUARDED_BY(mu);
+    };
+    auto state = std::make_shared<CopyState>();
+    auto copy_done = [this, slot, state](const Status& s) {
+      {
+        mutex_lock l(state->mu);
+        state->status.Update(s);
+        if (--state->num_pending > 0) return;
+      }
+      CopyDone(slot, state->status);
+    };
+    AllocatorAttributes pinned;
+    pinned.set_on_host(true);
+    pinned.set_gpu_compatible(true);
+    Allocator* pinned_allocator = device_->GetAllocator(pinned);
+    Allocator* device_allocator = device_->GetAllocator(AllocatorAttributes());
+    for (Tensor& tensor : slot->element.value) {
+      if (!DataTypeCanUseMemcpy(tensor.dtype())) continue;
+      Tensor* staging =
+          new Tensor(pinned_allocator, tensor.dtype(), tensor.shape());
+      if (tensor.TotalBytes() > 0) {
+        std::memcpy(const_cast<char*>(staging->tensor_data().data()),
+                    tensor.tensor_data().data(), tensor.TotalBytes());
+      }
+      tensor = Tensor(device_allocator, tensor.dtype(), tensor.shape());
+      {
+        mutex_lock l(state->mu);
+        ++state->num_pending;
+      }
+      device_context_->CopyCPUTensorToDevice(
+          staging, device_, &tensor, [staging, copy_done](const Status& s) {
+            delete staging;
+            copy_done(s);
+          });
+    }
+    copy_done(Status::OK());
+  }
+
+  void CopyDone(BufferSlot* slot, const Status& status) LOCKS_EXCLUDED(mu_) {
+    std::vector<FunctionBufferCallback> callbacks;
+    std::vector<BufferElement> buffer_elements;
+    {
+      mutex_lock l(mu_);
+      if (!status.ok()) {
+        slot->element.status = status;
+        slot->element.value.clear();
+      }
+      slot->ready = true;
+      --num_pending_copies_;
+      TakeReadyElementsLocked(&callbacks, &buffer_elements);
+      // Notified under the lock, since Cancel() may destroy the resource as
+      // soon as it returns.
+      cond_var_.notify_all();
+    }
+    for (int i = 0; i < callbacks.size(); ++i) {
+      callbacks[i](buffer_elements[i]);
+    }
+  }
+
   mutex mu_;
   FunctionLibraryRuntime* lib_;
   std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
@@ -233,12 +341,18 @@ class FunctionBufferingResource : public ResourceBase {
   const string source_device_;
   const string target_device_;
   const std::vector<Tensor> func_args_;
+  Device* const device_;                  // Not owned.
+  DeviceContext* const device_context_;  // Null if the device has none.
+  std::vector<AllocatorAttributes> rets_alloc_attrs_;
   FunctionLibraryRuntime::Handle handle_ GUARDED_BY(mu_);
-  std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
+  // Stable references are kept to the slots that are being copied, so this
+  // must be a deque.
+  std::deque<BufferSlot> buffer_ GUARDED_BY(mu_);
   std::deque<FunctionBufferCallback> requests_ GUARDED_BY(mu_);
   bool is_buffering_ GUARDED_BY(mu_);
   bool end_of_sequence_ GUARDED_BY(mu_);
   bool cancelled_ GUARDED_BY(mu_);
+  int64 num_pending_copies_ GUARDED_BY(mu_) = 0;
   condition_variable cond_var_;
 };
 
@@ -294,10 +408,12 @@ class FunctionBufferResourceHandleOp : public OpKernel {
           ctx->resource_manager()->LookupOrCreate<FunctionBufferingResource>(
               cinfo_.container(), cinfo_.name(), &buffer,
               [clone_lib, &pflr, &source_device, &target_device, func_args,
-               this](FunctionBufferingResource** ptr) {
+               ctx, this](FunctionBufferingResource** ptr) {
                 *ptr = new FunctionBufferingResource(
                     clone_lib, std::move(pflr), func_, buffer_size_,
-                    source_device, target_device, func_args);
+                    source_device, target_device, func_args,
+                    static_cast<Device*>(ctx->device()),
+                    ctx->op_device_context());
                 return Status::OK();
               }));
       core::ScopedUnref s(buffer);
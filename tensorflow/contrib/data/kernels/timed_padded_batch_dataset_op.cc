@@ -0,0 +1,445 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <deque>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/stats_aggregator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class TimedPaddedBatchDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit TimedPaddedBatchDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {}
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64 batch_size;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "batch_size", &batch_size));
+    OP_REQUIRES(
+        ctx, batch_size > 0,
+        errors::InvalidArgument("Batch size must be greater than zero."));
+    int64 timeout_micros;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "timeout_micros",
+                                                   &timeout_micros));
+    OP_REQUIRES(
+        ctx, timeout_micros >= 0,
+        errors::InvalidArgument("Timeout must be non-negative, got ",
+                                timeout_micros));
+
+    OpInputList padded_shape_tensors;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("padded_shapes", &padded_shape_tensors));
+    OP_REQUIRES(ctx,
+                padded_shape_tensors.size() == input->output_shapes().size(),
+                errors::InvalidArgument("Number of padded shapes (",
+                                        padded_shape_tensors.size(),
+                                        ") must match the number of components "
+                                        "in the input dataset's elements (",
+                                        input->output_shapes().size(), ")"));
+    std::vector<PartialTensorShape> padded_shapes;
+    padded_shapes.reserve(padded_shape_tensors.size());
+    for (const Tensor& padded_shape_t : padded_shape_tensors) {
+      OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                  errors::InvalidArgument("All padded shapes must be vectors"));
+      PartialTensorShape padded_shape;
+      OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                              padded_shape_t.vec<int64>().data(),
+                              padded_shape_t.NumElements(), &padded_shape));
+      padded_shapes.push_back(std::move(padded_shape));
+    }
+
+    OpInputList padding_values_list;
+    OP_REQUIRES_OK(ctx,
+                   ctx->input_list("padding_values", &padding_values_list));
+    OP_REQUIRES(ctx,
+                padding_values_list.size() == input->output_shapes().size(),
+                errors::InvalidArgument(
+                    "Number of padding values (", padding_values_list.size(),
+                    ") must match the number of components in the input "
+                    "dataset's elements (",
+                    input->output_shapes().size(), ")"));
+    std::vector<Tensor> padding_values;
+    padding_values.reserve(padding_values_list.size());
+    for (int i = 0; i < padding_values_list.size(); ++i) {
+      const Tensor& padding_value_t = padding_values_list[i];
+      OP_REQUIRES(
+          ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+          errors::InvalidArgument("All padding values must be scalars"));
+      OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                  errors::InvalidArgument(
+                      "Mismatched type between padding value ", i,
+                      " and input dataset's component ", i, ": ",
+                      DataTypeString(padding_value_t.dtype()), " vs. ",
+                      DataTypeString(input->output_dtypes()[i])));
+      padding_values.push_back(tensor::DeepCopy(padding_value_t));
+    }
+
+    *output = new Dataset(ctx, batch_size, timeout_micros,
+                          std::move(padded_shapes), std::move(padding_values),
+                          input);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, int64 batch_size, int64 timeout_micros,
+            std::vector<PartialTensorShape> padded_shapes,
+            std::vector<Tensor> padding_values, const DatasetBase* input)
+        : GraphDatasetBase(ctx),
+          batch_size_(batch_size),
+          timeout_micros_(timeout_micros),
+          padded_shapes_(std::move(padded_shapes)),
+          padding_values_(std::move(padding_values)),
+          input_(input) {
+      input_->Ref();
+      output_shapes_.reserve(padded_shapes_.size());
+      for (const PartialTensorShape& padded_shape : padded_shapes_) {
+        output_shapes_.push_back(
+            PartialTensorShape({-1}).Concatenate(padded_shape));
+      }
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::TimedPaddedBatch")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override {
+      return strings::StrCat("TimedPaddedBatchDatasetOp(", batch_size_, ", ",
+                             timeout_micros_, ")::Dataset");
+    }
+
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_graph_node));
+      Node* batch_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+      Node* timeout_micros = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(timeout_micros_, &timeout_micros));
+
+      std::vector<Node*> padded_shapes;
+      padded_shapes.reserve(padded_shapes_.size());
+      for (const PartialTensorShape& padded_shape : padded_shapes_) {
+        Tensor t(DT_INT64, TensorShape({padded_shape.dims()}));
+        for (int j = 0; j < padded_shape.dims(); ++j) {
+          t.vec<int64>()(j) = padded_shape.dim_size(j);
+        }
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        padded_shapes.emplace_back(node);
+      }
+
+      std::vector<Node*> padding_values;
+      padding_values.reserve(padding_values_.size());
+      for (const Tensor& t : padding_values_) {
+        Node* node;
+        TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+        padding_values.emplace_back(node);
+      }
+
+      AttrValue output_types;
+      b->BuildAttrValue(output_dtypes(), &output_types);
+
+      AttrValue N;
+      b->BuildAttrValue<int64>(padded_shapes_.size(), &N);
+
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {{0, input_graph_node}, {1, batch_size}, {2, timeout_micros}},
+          {{3, padded_shapes}, {4, padding_values}},
+          {{"Toutput_types", output_types}, {"N", N}}, output));
+      return Status::OK();
+    }
+
+   private:
+    // Reads input elements on a background thread, so that a batch can be
+    // closed when its timeout expires even if the input is blocked. As in
+    // `serving::BatchScheduler`, the timeout of a batch starts when its first
+    // element arrives.
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            input_impl_(params.dataset->input_->MakeIterator(params.prefix)) {}
+
+      ~Iterator() override {
+        // Signal the reader thread to terminate it. We will then join that
+        // thread when we delete `this->reader_thread_`.
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        cond_var_.notify_all();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        std::vector<std::vector<Tensor>> batch_elements;
+        uint64 batch_start_micros;
+        {
+          mutex_lock l(mu_);
+          EnsureReaderThreadStarted(ctx);
+          while (!cancelled_ && !reader_finished_ && buffer_.empty()) {
+            cond_var_.wait(l);
+          }
+          if (cancelled_) {
+            return errors::Cancelled(
+                "TimedPaddedBatchDatasetOp::Dataset::Iterator::GetNext");
+          }
+          if (buffer_.empty()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          // An error from the input is returned on its own, once the
+          // elements that precede it have been batched.
+          if (!buffer_.front().status.ok()) {
+            Status s = buffer_.front().status;
+            buffer_.pop_front();
+            cond_var_.notify_all();
+            return s;
+          }
+
+          // Wait for the batch to fill up, or for its timeout to expire.
+          const size_t batch_size = dataset()->batch_size_;
+          batch_start_micros = buffer_.front().arrival_micros;
+          const uint64 deadline_micros =
+              batch_start_micros + dataset()->timeout_micros_;
+          while (!cancelled_ && !reader_finished_ &&
+                 buffer_.size() < batch_size) {
+            const uint64 now_micros = ctx->env()->NowMicros();
+            if (now_micros >= deadline_micros) break;
+            cond_var_.wait_for(
+                l, std::chrono::microseconds(deadline_micros - now_micros));
+          }
+          if (cancelled_) {
+            return errors::Cancelled(
+                "TimedPaddedBatchDatasetOp::Dataset::Iterator::GetNext");
+          }
+
+          while (!buffer_.empty() && buffer_.front().status.ok() &&
+                 batch_elements.size() < batch_size) {
+            batch_elements.push_back(std::move(buffer_.front().value));
+            buffer_.pop_front();
+          }
+          // Wake the reader thread, which may be waiting for space.
+          cond_var_.notify_all();
+        }
+
+        TF_RETURN_IF_ERROR(PadAndBatch(ctx, batch_elements, out_tensors));
+        *end_of_sequence = false;
+
+        auto stats_aggregator = ctx->stats_aggregator();
+        if (stats_aggregator) {
+          const uint64 end_micros = ctx->env()->NowMicros();
+          stats_aggregator->AddToHistogram(
+              full_name("batch_latency_micros"),
+              {static_cast<double>(end_micros - batch_start_micros)});
+          stats_aggregator->AddToHistogram(
+              full_name("batch_size"),
+              {static_cast<double>(batch_elements.size())});
+        }
+        return Status::OK();
+      }
+
+     protected:
+      // Which elements end up in a batch depends on timing, so the iterator
+      // state cannot be saved deterministically.
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        return errors::Unimplemented("TimedPaddedBatchDataset: SaveInternal");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(
+            "TimedPaddedBatchDataset: RestoreInternal");
+      }
+
+     private:
+      struct BufferElement {
+        // The reader sets `status` if getting the input element fails.
+        Status status;
+        // The buffered data element.
+        std::vector<Tensor> value;
+        // When the element was read from the input.
+        uint64 arrival_micros;
+      };
+
+      void EnsureReaderThreadStarted(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!reader_thread_) {
+          reader_thread_.reset(ctx->env()->StartThread(
+              {}, "timed_padded_batch_reader",
+              std::bind(&Iterator::ReaderThread, this,
+                        new IteratorContext(*ctx))));
+        }
+      }
+
+      // Reads elements of the input into `buffer_`, keeping at most one
+      // batch ahead of the consumer.
+      //
+      // It owns the iterator context passed to it.
+      void ReaderThread(IteratorContext* ctx) {
+        std::unique_ptr<IteratorContext> cleanup(ctx);
+        while (true) {
+          {
+            mutex_lock l(mu_);
+            while (!cancelled_ && buffer_.size() >=
+                                      static_cast<size_t>(
+                                          dataset()->batch_size_)) {
+              cond_var_.wait(l);
+            }
+            if (cancelled_) return;
+          }
+
+          BufferElement buffer_element;
+          bool end_of_sequence = false;
+          buffer_element.status = input_impl_->GetNext(
+              ctx, &buffer_element.value, &end_of_sequence);
+          buffer_element.arrival_micros = ctx->env()->NowMicros();
+
+          mutex_lock l(mu_);
+          if (buffer_element.status.ok() && end_of_sequence) {
+            reader_finished_ = true;
+            cond_var_.notify_all();
+            return;
+          }
+          buffer_.push_back(std::move(buffer_element));
+          cond_var_.notify_all();
+        }
+      }
+
+      // Copies `batch_elements` into one output tensor per tuple component,
+      // padding each component to the padded shape of the dataset.
+      Status PadAndBatch(IteratorContext* ctx,
+                         const std::vector<std::vector<Tensor>>& batch_elements,
+                         std::vector<Tensor>* out_tensors) {
+        const size_t num_tuple_components = batch_elements[0].size();
+        const int64 num_batch_elements = batch_elements.size();
+        for (size_t component_index = 0; component_index < num_tuple_components;
+             ++component_index) {
+          const PartialTensorShape& padded_shape =
+              dataset()->padded_shapes_[component_index];
+          TensorShape batch_component_shape({num_batch_elements});
+          for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+            // Unknown dimensions grow to the largest element below.
+            batch_component_shape.AddDim(
+                std::max<int64>(padded_shape.dim_size(dim), 0));
+          }
+          for (int64 i = 0; i < num_batch_elements; ++i) {
+            const TensorShape& element_shape =
+                batch_elements[i][component_index].shape();
+            if (element_shape.dims() != padded_shape.dims()) {
+              return errors::InvalidArgument(
+                  "All elements in a batch must have the same rank as the "
+                  "padded shape for component",
+                  component_index, ": expected rank ", padded_shape.dims(),
+                  " but got element with rank ", element_shape.dims());
+            }
+            for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+              const int64 size = element_shape.dim_size(dim);
+              if (size <= batch_component_shape.dim_size(dim + 1)) continue;
+              if (padded_shape.dim_size(dim) != -1) {
+                return errors::DataLoss(
+                    "Attempted to pad to a smaller size than the input "
+                    "element.");
+              }
+              batch_component_shape.set_dim(dim + 1, size);
+            }
+          }
+
+          Tensor batch_component(ctx->allocator({}),
+                                 output_dtypes()[component_index],
+                                 batch_component_shape);
+          TensorShape component_shape(batch_component_shape);
+          component_shape.RemoveDim(0);
+          bool needs_padding = false;
+          for (int64 i = 0; i < num_batch_elements; ++i) {
+            if (batch_elements[i][component_index].shape() !=
+                component_shape) {
+              needs_padding = true;
+              break;
+            }
+          }
+          if (needs_padding) {
+            TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+                &batch_component,
+                dataset()->padding_values_[component_index]));
+          }
+          for (int64 i = 0; i < num_batch_elements; ++i) {
+            const Tensor& element = batch_elements[i][component_index];
+            // Take the fast path if possible.
+            if (element.shape() == component_shape) {
+              TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+                  element, &batch_component, i));
+            } else {
+              TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+                  element, &batch_component, i));
+            }
+          }
+          out_tensors->push_back(std::move(batch_component));
+        }
+        return Status::OK();
+      }
+
+      mutex mu_;
+      condition_variable cond_var_;
+      // Only used by the reader thread after it has started.
+      const std::unique_ptr<IteratorBase> input_impl_;
+      std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
+      std::unique_ptr<Thread> reader_thread_ GUARDED_BY(mu_);
+      bool cancelled_ GUARDED_BY(mu_) = false;
+      bool reader_finished_ GUARDED_BY(mu_) = false;
+    };
+
+    const int64 batch_size_;
+    const int64 timeout_micros_;
+    const std::vector<PartialTensorShape> padded_shapes_;
+    const std::vector<Tensor> padding_values_;
+    const DatasetBase* const input_;
+    std::vector<PartialTensorShape> output_shapes_;
+  };
+};
+
+REGISTER_KERNEL_BUILDER(Name("TimedPaddedBatchDataset").Device(DEVICE_CPU),
+                        TimedPaddedBatchDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -78,6 +78,36 @@ REGISTER_OP("IgnoreErrorsDataset")
 Creates a dataset that contains the elements of `input_dataset` ignoring errors.
 )doc");
 
+REGISTER_OP("TimedPaddedBatchDataset")
+    .Input("input_dataset: variant")
+    .Input("batch_size: int64")
+    .Input("timeout_micros: int64")
+    .Input("padded_shapes: N * int64")
+    .Input("padding_values: Toutput_types")
+    .Output("handle: variant")
+    .Attr("Toutput_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .Attr("N: int >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that batches and pads elements of `input_dataset` as they
+arrive.
+
+A batch is emitted when it holds `batch_size` elements, or `timeout_micros`
+after its first element was read from the input, whichever comes first.
+
+batch_size: A scalar representing the maximum number of elements to
+  accumulate in a batch.
+timeout_micros: A scalar representing the maximum number of microseconds to
+  wait for a batch to fill up after its first element arrives.
+padded_shapes: A list of int64 tensors representing the desired padded shapes
+  of the corresponding output components. These shapes may be partially
+  specified, using `-1` to indicate that a particular dimension should be
+  padded to the maximum size of all batch elements.
+padding_values: A list of scalars containing the padding value to use for
+  each of the outputs.
+)doc");
+
 REGISTER_OP("UniqueDataset")
     .Input("input_dataset: variant")
     .Output("handle: variant")
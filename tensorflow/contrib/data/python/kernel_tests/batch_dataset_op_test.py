@@ -18,6 +18,7 @@ from __future__ import division
 from __future__ import print_function
 
 import math
+import threading
 import time
 
 import numpy as np
@@ -402,6 +403,53 @@ class BatchDatasetTest(test.TestCase):
       _ = dataset_ops.Dataset.range(10).map(_map_fn).apply(
           batching.padded_batch_and_drop_remainder(5))
 
+  def testTimedPaddedBatch(self):
+    # With a long timeout, batches are only cut by size.
+    iterator = (
+        dataset_ops.Dataset.range(10)
+        .map(lambda x: array_ops.fill([x], x))
+        .apply(batching.timed_padded_batch(4, timeout_micros=60 * 1000000))
+        .make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+    self.assertEqual([None, None], get_next.shape.as_list())
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      for start, size in [(0, 4), (4, 4), (8, 2)]:
+        result = sess.run(get_next)
+        expected_width = start + size - 1
+        self.assertEqual((size, expected_width), result.shape)
+        for i in range(size):
+          value = start + i
+          self.assertAllEqual([value] * value + [0] * (expected_width - value),
+                              result[i])
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testTimedPaddedBatchTimeout(self):
+    # With a zero timeout, each batch holds whatever has already been read,
+    # but no element is lost or reordered.
+    iterator = (
+        dataset_ops.Dataset.range(100)
+        .apply(batching.timed_padded_batch(8, timeout_micros=0))
+        .make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      values = []
+      while True:
+        try:
+          result = sess.run(get_next)
+        except errors.OutOfRangeError:
+          break
+        self.assertLessEqual(1, len(result))
+        self.assertGreaterEqual(8, len(result))
+        values.extend(result)
+      self.assertAllEqual(list(range(100)), values)
+
   def testBatchAndDropRemainderShapeInference(self):
     components = (array_ops.placeholder(dtypes.int32),
                   (array_ops.placeholder(dtypes.int32, shape=[None]),
@@ -651,6 +699,108 @@ class BatchDatasetTest(test.TestCase):
                                    "number of elements does not match"):
         sess.run(get_next)
 
+  def _getAllBatches(self, sess, get_next):
+    """Gets the remaining batches, and checks that the iterator stays ended."""
+    batches = []
+    while True:
+      try:
+        batches.append(sess.run(get_next))
+      except errors.OutOfRangeError:
+        break
+    with self.assertRaises(errors.OutOfRangeError):
+      sess.run(get_next)
+    return batches
+
+  def testMapAndBatchSloppyBatchesElementsAsTheyAreReady(self):
+    ready = threading.Event()
+
+    def _wait_for_first(i):
+      if i == 0:
+        ready.wait()
+      return i
+
+    iterator = (
+        dataset_ops.Dataset.range(8).apply(
+            batching.map_and_batch(
+                lambda x: script_ops.py_func(_wait_for_first, [x],
+                                             dtypes.int64),
+                batch_size=2,
+                num_parallel_calls=4,
+                sloppy=True)).make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      try:
+        # The first element is not ready, so the first batch is filled with
+        # later elements instead of waiting for it.
+        first_batch = sess.run(get_next)
+        self.assertEqual(2, len(first_batch))
+        self.assertNotIn(0, first_batch)
+      finally:
+        ready.set()
+      batches = [first_batch] + self._getAllBatches(sess, get_next)
+      self.assertEqual([2, 2, 2, 2], [len(batch) for batch in batches])
+      self.assertEqual(list(range(8)), sorted(np.concatenate(batches)))
+
+  def testMapAndBatchSloppyError(self):
+    components = np.array([1., 2., 3., np.nan, 5., 6.]).astype(np.float32)
+
+    iterator = (
+        dataset_ops.Dataset.from_tensor_slices(components).apply(
+            batching.map_and_batch(
+                lambda x: array_ops.check_numerics(x, "message"),
+                batch_size=2,
+                num_parallel_calls=2,
+                sloppy=True)).make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      batches = []
+      num_errors = 0
+      while True:
+        try:
+          batches.append(sess.run(get_next))
+        except errors.InvalidArgumentError:
+          num_errors += 1
+        except errors.OutOfRangeError:
+          break
+      # The batch that receives the NaN fails, and the others are unaffected.
+      self.assertEqual(1, num_errors)
+      self.assertEqual([2, 2], [len(batch) for batch in batches])
+      elements = np.concatenate(batches)
+      self.assertEqual(4, len(set(elements)))
+      self.assertTrue(set(elements).issubset({1., 2., 3., 5., 6.}))
+
+  def testMapAndBatchSloppyEndOfInput(self):
+    for drop_remainder, expected_sizes in [(False, [3, 3, 1]),
+                                           (True, [3, 3])]:
+      iterator = (
+          dataset_ops.Dataset.range(7).apply(
+              batching.map_and_batch(
+                  lambda x: x * 2,
+                  batch_size=3,
+                  num_parallel_calls=4,
+                  drop_remainder=drop_remainder,
+                  sloppy=True)).make_initializable_iterator())
+      init_op = iterator.initializer
+      get_next = iterator.get_next()
+
+      with self.test_session() as sess:
+        sess.run(init_op)
+        batches = self._getAllBatches(sess, get_next)
+        # The batches have the sizes they have in order.
+        self.assertEqual(expected_sizes, [len(batch) for batch in batches])
+        elements = sorted(np.concatenate(batches))
+        if drop_remainder:
+          self.assertEqual(6, len(set(elements)))
+          self.assertTrue(set(elements).issubset(range(0, 14, 2)))
+        else:
+          self.assertEqual(list(range(0, 14, 2)), elements)
+
 
 class BatchDatasetSerializationTest(
     dataset_serialization_test_base.DatasetSerializationTestBase):
@@ -783,6 +933,28 @@ class MapAndBatchDatasetSerializationTest(
     self.run_core_tests(lambda: build_ds(10, True), lambda: build_ds(15, True),
                         num_outputs_drop_remainder)
 
+  def testSloppy(self):
+    range_size = 22
+    batch_size = 5
+
+    def build_ds():
+      return dataset_ops.Dataset.range(range_size).apply(
+          batching.map_and_batch(
+              map_func=math_ops.square,
+              batch_size=batch_size,
+              num_parallel_calls=7,
+              sloppy=True))
+
+    # The order of the elements is not deterministic, so instead of the
+    # outputs of an uninterrupted iterator, the test expects every element
+    # to be produced once across the checkpoints.
+    num_outputs = int(math.ceil(range_size / batch_size))
+    for break_points in [[], [0], [1], [2, 4], [5]]:
+      outputs = self.gen_outputs(build_ds, break_points, num_outputs)
+      self.assertEqual([5, 5, 5, 5, 2], [len(batch) for batch in outputs])
+      self.assertEqual([x * x for x in range(range_size)],
+                       sorted(np.concatenate(outputs)))
+
 
 class PaddedBatchDatasetSerializationTest(
     dataset_serialization_test_base.DatasetSerializationTestBase):
@@ -17,6 +17,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+from tensorflow.contrib.data.python.ops import contrib_op_loader  # pylint: disable=unused-import
+from tensorflow.contrib.data.python.ops import gen_dataset_ops as contrib_gen_dataset_ops
 from tensorflow.contrib.framework import with_shape
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.util import nest
@@ -291,6 +293,59 @@ def padded_batch_and_drop_remainder(batch_size,
   return _apply_fn
 
 
+def timed_padded_batch(batch_size,
+                       timeout_micros,
+                       padded_shapes=None,
+                       padding_values=None):
+  """A batching transformation that bounds how long a batch can wait.
+
+  Like @{tf.data.Dataset.padded_batch}, this transformation combines
+  consecutive elements of this dataset into padded batches. However, a batch
+  is emitted as soon as it holds `batch_size` elements or `timeout_micros`
+  microseconds after its first element was produced, whichever comes first.
+  This suits streaming inputs, where waiting for a full batch would add
+  unbounded latency:
+
+  ```python
+  # Emit whatever has arrived within 10ms, up to 128 elements.
+  dataset = dataset.apply(
+      tf.contrib.data.timed_padded_batch(128, timeout_micros=10000))
+  ```
+
+  Input elements are read on a background thread. When a `StatsAggregator` is
+  attached to the iterator, the latency and size of each batch are recorded as
+  histograms. Iterators over this dataset cannot be
+  saved, because the batch boundaries depend on timing.
+
+  Args:
+    batch_size: A `tf.int64` scalar `tf.Tensor`, representing the maximum
+      number of consecutive elements of this dataset to combine in a single
+      batch.
+    timeout_micros: A `tf.int64` scalar `tf.Tensor`, representing the maximum
+      number of microseconds to wait for a batch to fill up.
+    padded_shapes: (Optional.) A nested structure of `tf.TensorShape` or
+      `tf.int64` vector tensor-like objects. See
+      @{tf.data.Dataset.padded_batch} for details. Defaults to the shapes of
+      the input elements, padding unknown dimensions to the largest element in
+      each batch.
+    padding_values: (Optional.) A nested structure of scalar-shaped
+      `tf.Tensor`. See @{tf.data.Dataset.padded_batch} for details.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    @{tf.data.Dataset.apply}
+  """
+
+  def _apply_fn(dataset):
+    """Function from `Dataset` to `Dataset` that applies the transformation."""
+    shapes = (
+        padded_shapes if padded_shapes is not None else dataset.output_shapes)
+    return _TimedPaddedBatchDataset(dataset, batch_size, timeout_micros,
+                                    shapes, padding_values)
+
+  return _apply_fn
+
+
 class DenseToSparseBatchDataset(dataset_ops.Dataset):
   """A `Dataset` that batches ragged dense elements into `tf.SparseTensor`s."""
 
@@ -467,7 +522,7 @@ class _MapAndBatchDataset(dataset_ops.MapDataset):
   """A `Dataset` that maps a function over a batch of elements."""
 
   def __init__(self, input_dataset, map_func, batch_size, num_parallel_calls,
-               drop_remainder):
+               drop_remainder, sloppy=False):
     """See `Dataset.map()` for details."""
     super(_MapAndBatchDataset, self).__init__(input_dataset, map_func)
     self._batch_size_t = ops.convert_to_tensor(
@@ -476,6 +531,7 @@ class _MapAndBatchDataset(dataset_ops.MapDataset):
         num_parallel_calls, dtype=dtypes.int64, name="num_parallel_calls")
     self._drop_remainder_t = ops.convert_to_tensor(
         drop_remainder, dtype=dtypes.bool, name="drop_remainder")
+    self._sloppy = bool(sloppy)
 
     self._batch_size = batch_size
     self._drop_remainder = drop_remainder
@@ -490,6 +546,7 @@ class _MapAndBatchDataset(dataset_ops.MapDataset):
         batch_size=self._batch_size_t,
         num_parallel_calls=self._num_parallel_calls_t,
         drop_remainder=self._drop_remainder_t,
+        sloppy=self._sloppy,
         output_types=nest.flatten(
             sparse.as_dense_types(self.output_types, self.output_classes)),
         output_shapes=nest.flatten(
@@ -513,7 +570,8 @@ def map_and_batch(map_func,
                   batch_size,
                   num_parallel_batches=None,
                   drop_remainder=False,
-                  num_parallel_calls=None):
+                  num_parallel_calls=None,
+                  sloppy=False):
   """Fused implementation of `map` and `batch`.
 
   Maps `map_func` across `batch_size` consecutive elements of this dataset
@@ -524,6 +582,9 @@ def map_and_batch(map_func,
   the fusing of `map` and `batch` will happen automatically and this API will be
   deprecated.
 
+  WARNING: If `sloppy` is `True`, the order of produced elements is not
+  deterministic.
+
   Args:
     map_func: A function mapping a nested structure of tensors to another
       nested structure of tensors.
@@ -540,6 +601,10 @@ def map_and_batch(map_func,
         representing the number of elements to process in parallel. If not
         specified, `batch_size * num_parallel_batches` elements will be
         processed in parallel.
+    sloppy: (Optional.) If false, each batch holds consecutive input elements.
+      Otherwise, the elements are batched in the order in which `map_func`
+      completes, so that a slow element lands in a later batch instead of
+      holding back its own. The batch sizes are the same in both cases.
 
   Returns:
     A `Dataset` transformation function, which can be passed to
@@ -560,6 +625,31 @@ def map_and_batch(map_func,
 
   def _apply_fn(dataset):
     return _MapAndBatchDataset(dataset, map_func, batch_size,
-                               num_parallel_calls, drop_remainder)
+                               num_parallel_calls, drop_remainder, sloppy)
 
   return _apply_fn
+
+
+class _TimedPaddedBatchDataset(dataset_ops.PaddedBatchDataset):
+  """A `Dataset` that batches elements as they arrive, with a timeout."""
+
+  def __init__(self, input_dataset, batch_size, timeout_micros, padded_shapes,
+               padding_values):
+    """See `timed_padded_batch()` for details."""
+    super(_TimedPaddedBatchDataset, self).__init__(
+        input_dataset, batch_size, padded_shapes, padding_values)
+    self._timeout_micros = ops.convert_to_tensor(
+        timeout_micros, dtype=dtypes.int64, name="timeout_micros")
+
+  def _as_variant_tensor(self):
+    return contrib_gen_dataset_ops.timed_padded_batch_dataset(
+        self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
+        batch_size=self._batch_size,
+        timeout_micros=self._timeout_micros,
+        padded_shapes=[
+            ops.convert_to_tensor(s, dtype=dtypes.int64)
+            for s in nest.flatten(self._padded_shapes)
+        ],
+        padding_values=nest.flatten(self._padding_values),
+        output_shapes=nest.flatten(
+            sparse.as_dense_shapes(self.output_shapes, self.output_classes)))
@@ -20,18 +20,14 @@
 #include <numeric>
 #include <vector>
 
-// This is only used for std::this_thread::get_id()
-#include <thread>  // NOLINT
-
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
-#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
-#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 using tensorflow::DEVICE_CPU;
 using tensorflow::DT_BOOL;
@@ -141,8 +137,8 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
     std::vector<int64> perm(num_nonzero_elements);
     std::iota(perm.begin(), perm.end(), 0);
 
-    typedef std::pair<int64, int64> Shard;
-    std::vector<Shard> shards;
+    typedef std::pair<int64, int64> RowRange;
+    std::vector<RowRange> shards;
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     int64 shard_total = 0;
     // Compute a permutation such that get_input_index(perm[i]) is sorted, use
@@ -173,90 +169,63 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
     // Batch the rank-one updates into a rank-k update to lower memory traffic
     const int kMaxBatchSize = 128;
 
-    // Since we do not have an easy way of generating thread id's within the
-    // range [0,num_threads), we can instead call out to an std::unordered_map
-    // of matrices and initialize the matrix on the first call.
-    // However, this might have a performance penalty, as memory allocation can
-    // cause the OS kernel to enter a critical section and temporarily disable
-    // parallelism, and the unordered_map must be protected with a read/write
-    // mutex.
-    //
-    // TODO(jpoulson): Simplify after the thread rank can be queried
-    std::unordered_map<size_t, Eigen::MatrixXf> factor_batch_map;
-    mutex map_mutex;
-
-    BlockingCounter counter(shards.size());
-    // Lambda encapsulating the per-shard computation.
-    auto work = [&](const Shard& shard) {
-      const std::thread::id thread_id = std::this_thread::get_id();
-      const size_t id_hash = std::hash<std::thread::id>()(thread_id);
-      // If this thread's unique factors_mat.rows() x kMaxBatchSize
-      // batching matrix has not yet been created, then emplace it into the
-      // map using the hash of the thread id as the key.
-      //
-      // TODO(jpoulson): Switch to try_emplace once C++17 is supported
-      map_mutex.lock();
-      const auto key_count = factor_batch_map.count(id_hash);
-      map_mutex.unlock();
-      if (!key_count) {
-        map_mutex.lock();
-        factor_batch_map.emplace(
-            std::piecewise_construct, std::forward_as_tuple(id_hash),
-            std::forward_as_tuple(factors_mat.rows(), kMaxBatchSize));
-        map_mutex.unlock();
-      }
-      map_mutex.lock();
-      auto& factor_batch = factor_batch_map[id_hash];
-      map_mutex.unlock();
-
-      CHECK_GE(shard.first, 0);
-      CHECK_LE(shard.second, perm.size());
-      CHECK_LE(shard.first, shard.second);
-      const int64 input_index = get_input_index(perm[shard.first]);
-      // Accumulate the rhs and lhs terms in the normal equations
-      // for the non-zero elements in the row or column of the sparse matrix
-      // corresponding to input_index.
-      int num_batched = 0;
-      EigenMatrixFloatMap lhs_mat(output_lhs_tensor->flat<float>().data() +
-                                      input_index * factor_dim * factor_dim,
-                                  factor_dim, factor_dim);
-      auto lhs_symm = lhs_mat.selfadjointView<Eigen::Lower>();
-      for (int64 p = shard.first; p < shard.second; ++p) {
-        const int64 i = perm[p];
-        // Check that all entries in the shard have the same input index.
-        CHECK_EQ(input_index, get_input_index(i));
-        const int64 factor_index = get_factor_index(i);
-        const float input_value = input_values_vec(i);
-        const float weight =
-            input_weights_vec(input_index) * factor_weights_vec(factor_index);
-        CHECK_GE(weight, 0);
-        factor_batch.col(num_batched) =
-            factors_mat.col(factor_index) * std::sqrt(weight);
-        ++num_batched;
-        if (num_batched == kMaxBatchSize) {
-          lhs_symm.rankUpdate(factor_batch);
-          num_batched = 0;
+    // Lambda encapsulating the computation for a contiguous range of shards.
+    // Each range gets its own batching matrix, so that no state is shared
+    // between threads.
+    auto work = [&](int64 shard_start, int64 shard_limit) {
+      Eigen::MatrixXf factor_batch(factors_mat.rows(), kMaxBatchSize);
+      for (int64 s = shard_start; s < shard_limit; ++s) {
+        const RowRange& shard = shards[s];
+        CHECK_GE(shard.first, 0);
+        CHECK_LE(shard.second, perm.size());
+        CHECK_LE(shard.first, shard.second);
+        const int64 input_index = get_input_index(perm[shard.first]);
+        // Accumulate the rhs and lhs terms in the normal equations
+        // for the non-zero elements in the row or column of the sparse matrix
+        // corresponding to input_index.
+        int num_batched = 0;
+        EigenMatrixFloatMap lhs_mat(output_lhs_tensor->flat<float>().data() +
+                                        input_index * factor_dim * factor_dim,
+                                    factor_dim, factor_dim);
+        auto lhs_symm = lhs_mat.selfadjointView<Eigen::Lower>();
+        for (int64 p = shard.first; p < shard.second; ++p) {
+          const int64 i = perm[p];
+          // Check that all entries in the shard have the same input index.
+          CHECK_EQ(input_index, get_input_index(i));
+          const int64 factor_index = get_factor_index(i);
+          const float input_value = input_values_vec(i);
+          const float weight =
+              input_weights_vec(input_index) * factor_weights_vec(factor_index);
+          CHECK_GE(weight, 0);
+          factor_batch.col(num_batched) =
+              factors_mat.col(factor_index) * std::sqrt(weight);
+          ++num_batched;
+          if (num_batched == kMaxBatchSize) {
+            lhs_symm.rankUpdate(factor_batch);
+            num_batched = 0;
+          }
+
+          rhs_mat.col(input_index) +=
+              input_value * (w_0 + weight) * factors_mat.col(factor_index);
         }
-
-        rhs_mat.col(input_index) +=
-            input_value * (w_0 + weight) * factors_mat.col(factor_index);
-      }
-      if (num_batched != 0) {
-        auto factor_block =
-            factor_batch.block(0, 0, factors_mat.rows(), num_batched);
-        lhs_symm.rankUpdate(factor_block);
+        if (num_batched != 0) {
+          auto factor_block =
+              factor_batch.block(0, 0, factors_mat.rows(), num_batched);
+          lhs_symm.rankUpdate(factor_block);
+        }
+        // Copy lower triangular to upper triangular part of normal equation
+        // matrix.
+        lhs_mat = lhs_symm;
       }
-      // Copy lower triangular to upper triangular part of normal equation
-      // matrix.
-      lhs_mat = lhs_symm;
-      counter.DecrementCount();
     };
-    for (size_t i = 1; i < shards.size(); ++i) {
-      worker_threads.workers->Schedule(std::bind(work, shards[i]));
-    }
-    // Inline execute the 1st shard.
-    work(shards[0]);
-    counter.Wait();
+
+    // Rows are grouped into contiguous ranges rather than scheduled one at a
+    // time, which matters when a block has many rows with few entries each.
+    // The cost is that of the rank updates of an average row.
+    const int64 cost_per_shard =
+        (num_nonzero_elements / shards.size() + 1) * factor_dim * factor_dim;
+    Shard(worker_threads.num_threads, worker_threads.workers, shards.size(),
+          cost_per_shard, work);
   }
 };
 
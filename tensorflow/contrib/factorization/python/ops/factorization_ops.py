@@ -893,11 +893,13 @@ class WALSModel(object):
       total_rhs = (
           self._unobserved_weight * sparse_ops.sparse_tensor_dense_matmul(
               new_sp_input, right, adjoint_a=transpose_input))
-      # TODO(rmlarsen): handle transposing in tf.matrix_solve instead of
+      # The normal equations are symmetric positive definite, so a single
+      # Cholesky factorization is shared by all right hand sides.
+      # TODO(rmlarsen): handle transposing in tf.cholesky_solve instead of
       # transposing explicitly.
-      # TODO(rmlarsen): multi-thread tf.matrix_solve.
       new_left_values = array_ops.transpose(
-          linalg_ops.matrix_solve(total_lhs, array_ops.transpose(total_rhs)))
+          linalg_ops.cholesky_solve(
+              linalg_ops.cholesky(total_lhs), array_ops.transpose(total_rhs)))
     else:
       if row_weights is None:
         # TODO(yifanchen): Add special handling for single shard without using
@@ -929,8 +931,11 @@ class WALSModel(object):
               name="wals_compute_partial_lhs_rhs"))
       total_lhs = array_ops.expand_dims(total_lhs, 0) + partial_lhs
       total_rhs = array_ops.expand_dims(total_rhs, -1)
+      # Each row has its own positive definite system; the batched Cholesky
+      # factorization and solve are sharded over rows.
       new_left_values = array_ops.squeeze(
-          linalg_ops.matrix_solve(total_lhs, total_rhs), [2])
+          linalg_ops.cholesky_solve(linalg_ops.cholesky(total_lhs), total_rhs),
+          [2])
 
     update_op_name = "row_update" if update_row_factors else "col_update"
     update_op = self.scatter_update(
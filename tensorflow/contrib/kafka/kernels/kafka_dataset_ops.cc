@@ -13,12 +13,19 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <deque>
+
 #include "tensorflow/core/framework/dataset.h"
 
 #include "src-cpp/rdkafkacpp.h"
 
 namespace tensorflow {
 
+// Maximum number of messages taken from the consumer in one go. Only the
+// first message of a batch waits for the timeout; the rest are messages
+// librdkafka has already fetched.
+constexpr size_t kMaxConsumeBatchSize = 1024;
+
 class KafkaDatasetOp : public DatasetOpKernel {
  public:
   using DatasetOpKernel::DatasetOpKernel;
@@ -120,32 +127,32 @@ class KafkaDatasetOp : public DatasetOpKernel {
                 // EOF current topic
                 break;
               }
-              std::unique_ptr<RdKafka::Message> message(
-                  consumer_->consume(dataset()->timeout_));
-              if (message->err() == RdKafka::ERR_NO_ERROR) {
-                // Produce the line as output.
-                Tensor line_tensor(cpu_allocator(), DT_STRING, {});
-                line_tensor.scalar<string>()() =
-                    std::string(static_cast<const char*>(message->payload()),
-                                message->len());
-                out_tensors->emplace_back(std::move(line_tensor));
-                *end_of_sequence = false;
-                // Sync offset
-                offset_ = message->offset();
-                return Status::OK();
+              if (messages_.empty() && !partition_eof_) {
+                TF_RETURN_IF_ERROR(ConsumeBatchLocked());
               }
-
-              if (message->err() == RdKafka::ERR__PARTITION_EOF &&
-                  dataset()->eof_) {
-                // EOF current topic
-                break;
-              }
-              if (message->err() != RdKafka::ERR__TIMED_OUT) {
-                return errors::Internal("Failed to consume:",
-                                        message->errstr());
+              if (messages_.empty()) {
+                if (partition_eof_) {
+                  // EOF current topic
+                  break;
+                }
+                consumer_->poll(0);
+                continue;
               }
-              message.reset(nullptr);
-              consumer_->poll(0);
+
+              std::unique_ptr<RdKafka::Message> message =
+                  std::move(messages_.front());
+              messages_.pop_front();
+              // Produce the line as output, copying the payload straight
+              // into the tensor.
+              Tensor line_tensor(DT_STRING, {});
+              line_tensor.scalar<string>()().assign(
+                  static_cast<const char*>(message->payload()),
+                  message->len());
+              out_tensors->emplace_back(std::move(line_tensor));
+              *end_of_sequence = false;
+              // Sync offset
+              offset_ = message->offset();
+              return Status::OK();
             }
 
             // We have reached the end of the current topic, so maybe
@@ -207,6 +214,34 @@ class KafkaDatasetOp : public DatasetOpKernel {
       }
 
      private:
+      // Refills `messages_` from the consumer. Waits up to the timeout for
+      // the first message, then drains the messages that are already
+      // available without blocking, stopping at the end of the range.
+      Status ConsumeBatchLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        int timeout = dataset()->timeout_;
+        while (messages_.size() < kMaxConsumeBatchSize) {
+          std::unique_ptr<RdKafka::Message> message(
+              consumer_->consume(timeout));
+          timeout = 0;
+          if (message->err() == RdKafka::ERR_NO_ERROR) {
+            const bool at_limit = limit_ >= 0 && message->offset() >= limit_;
+            messages_.push_back(std::move(message));
+            if (at_limit) break;
+            continue;
+          }
+          if (message->err() == RdKafka::ERR__PARTITION_EOF &&
+              dataset()->eof_) {
+            partition_eof_ = true;
+            break;
+          }
+          if (message->err() != RdKafka::ERR__TIMED_OUT) {
+            return errors::Internal("Failed to consume:", message->errstr());
+          }
+          break;
+        }
+        return Status::OK();
+      }
+
       // Sets up Kafka streams to read from the topic at
       // `current_topic_index_`.
       Status SetupStreamsLocked(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -292,6 +327,8 @@ class KafkaDatasetOp : public DatasetOpKernel {
 
       // Resets all Kafka streams.
       void ResetStreamsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        messages_.clear();
+        partition_eof_ = false;
         consumer_->unassign();
         consumer_->close();
         consumer_.reset(nullptr);
@@ -303,6 +340,11 @@ class KafkaDatasetOp : public DatasetOpKernel {
       int64 limit_ GUARDED_BY(mu_) = -1;
       std::unique_ptr<RdKafka::TopicPartition> topic_partition_ GUARDED_BY(mu_);
       std::unique_ptr<RdKafka::KafkaConsumer> consumer_ GUARDED_BY(mu_);
+      // Messages consumed but not yet returned. `offset_` only advances
+      // when a message is returned, so these are not part of the saved
+      // state and are consumed again after a restore.
+      std::deque<std::unique_ptr<RdKafka::Message>> messages_ GUARDED_BY(mu_);
+      bool partition_eof_ GUARDED_BY(mu_) = false;
     };
 
     const std::vector<string> topics_;
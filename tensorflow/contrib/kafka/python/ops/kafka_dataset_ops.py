@@ -27,6 +27,18 @@ from tensorflow.python.framework import tensor_shape
 
 class KafkaDataset(Dataset):
   """A Kafka Dataset that consumes the message.
+
+  Each subscription in `topics` is read in turn. To consume several
+  partitions concurrently, create one dataset per subscription and combine
+  them with `tf.contrib.data.parallel_interleave`:
+
+  ```python
+  topics = ["test:0:0:-1", "test:1:0:-1", "test:2:0:-1"]
+  dataset = tf.data.Dataset.from_tensor_slices(topics).apply(
+      tf.contrib.data.parallel_interleave(
+          lambda topic: KafkaDataset(topic, eof=True),
+          cycle_length=len(topics), sloppy=True))
+  ```
   """
 
   def __init__(self,
@@ -58,6 +58,7 @@ See the @{$python/contrib.layers} guide.
 @@unit_norm
 @@bow_encoder
 @@embed_sequence
+@@EmbeddingRowCache
 @@maxout
 
 @@apply_regularization
@@ -0,0 +1,340 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string.h>
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+// A bounded cache of embedding rows, keyed by id. Rows are stored in a single
+// preallocated [capacity, row elements] tensor and evicted in least recently
+// used order. Each row remembers the global step at which it was fetched, so
+// that rows older than `max_staleness` steps can be fetched again.
+class EmbeddingCache : public ResourceBase {
+ public:
+  EmbeddingCache(DataType dtype, const TensorShape& row_shape, int64 capacity,
+                 int64 max_staleness)
+      : dtype_(dtype),
+        row_shape_(row_shape),
+        capacity_(capacity),
+        max_staleness_(max_staleness),
+        row_bytes_(row_shape.num_elements() * DataTypeSize(dtype)),
+        storage_(dtype, TensorShape({capacity, row_shape.num_elements()})) {
+    free_slots_.reserve(capacity);
+    for (int64 slot = capacity - 1; slot >= 0; --slot) {
+      free_slots_.push_back(slot);
+    }
+  }
+
+  DataType dtype() const { return dtype_; }
+  const TensorShape& row_shape() const { return row_shape_; }
+  int64 capacity() const { return capacity_; }
+  int64 max_staleness() const { return max_staleness_; }
+  int64 row_bytes() const { return row_bytes_; }
+
+  // Copies the rows for `ids` that are cached and fresh at `global_step` into
+  // `rows`, and zero-fills the others. For every id, sets `missing_index` to
+  // -1 on a hit, or to the position of the id in `missing_ids` on a miss.
+  template <typename Index>
+  void Lookup(typename TTypes<Index>::ConstFlat ids, int64 global_step,
+              char* rows, std::vector<Index>* missing_ids,
+              int32* missing_index) {
+    std::unordered_map<Index, int32> missing_positions;
+    mutex_lock l(mu_);
+    for (int64 i = 0; i < ids.size(); ++i) {
+      char* row = rows + i * row_bytes_;
+      auto it = entries_.find(ids(i));
+      if (it != entries_.end() && IsFresh(it->second, global_step)) {
+        memcpy(row, SlotData(it->second.slot), row_bytes_);
+        lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+        missing_index[i] = -1;
+        ++hits_;
+        continue;
+      }
+      memset(row, 0, row_bytes_);
+      auto inserted = missing_positions.emplace(
+          ids(i), static_cast<int32>(missing_ids->size()));
+      if (inserted.second) missing_ids->push_back(ids(i));
+      missing_index[i] = inserted.first->second;
+      ++misses_;
+    }
+  }
+
+  // Stores `rows` for `ids`, as fetched at `global_step`.
+  template <typename Index>
+  void Insert(typename TTypes<Index>::ConstFlat ids, int64 global_step,
+              const char* rows) {
+    mutex_lock l(mu_);
+    for (int64 i = 0; i < ids.size(); ++i) {
+      const int64 id = ids(i);
+      auto it = entries_.find(id);
+      if (it == entries_.end()) {
+        if (free_slots_.empty()) EvictLocked();
+        Entry entry;
+        entry.slot = free_slots_.back();
+        free_slots_.pop_back();
+        lru_.push_front(id);
+        entry.lru_position = lru_.begin();
+        it = entries_.emplace(id, entry).first;
+      } else {
+        lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+      }
+      it->second.global_step = global_step;
+      memcpy(SlotData(it->second.slot), rows + i * row_bytes_, row_bytes_);
+    }
+  }
+
+  // Drops the rows for `ids`.
+  template <typename Index>
+  void Invalidate(typename TTypes<Index>::ConstFlat ids) {
+    mutex_lock l(mu_);
+    for (int64 i = 0; i < ids.size(); ++i) {
+      auto it = entries_.find(ids(i));
+      if (it == entries_.end()) continue;
+      free_slots_.push_back(it->second.slot);
+      lru_.erase(it->second.lru_position);
+      entries_.erase(it);
+    }
+  }
+
+  string DebugString() override {
+    mutex_lock l(mu_);
+    return strings::StrCat("EmbeddingCache(", entries_.size(), "/", capacity_,
+                           " rows, ", hits_, " hits, ", misses_, " misses)");
+  }
+
+  int64 MemoryUsed() const override { return storage_.TotalBytes(); }
+
+ private:
+  struct Entry {
+    int64 slot;
+    // The global step at which the row was fetched.
+    int64 global_step;
+    std::list<int64>::iterator lru_position;
+  };
+
+  bool IsFresh(const Entry& entry, int64 global_step) const {
+    return max_staleness_ < 0 ||
+           global_step - entry.global_step <= max_staleness_;
+  }
+
+  char* SlotData(int64 slot) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return const_cast<char*>(storage_.tensor_data().data()) +
+           slot * row_bytes_;
+  }
+
+  // Evicts the least recently used row.
+  void EvictLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto it = entries_.find(lru_.back());
+    free_slots_.push_back(it->second.slot);
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+
+  const DataType dtype_;
+  const TensorShape row_shape_;
+  const int64 capacity_;
+  const int64 max_staleness_;
+  const int64 row_bytes_;
+
+  // The buffer of `storage_` never changes; its contents are guarded by `mu_`.
+  const Tensor storage_;
+
+  mutex mu_;
+  std::unordered_map<int64, Entry> entries_ GUARDED_BY(mu_);
+  // Ids of the cached rows, most recently used first.
+  std::list<int64> lru_ GUARDED_BY(mu_);
+  std::vector<int64> free_slots_ GUARDED_BY(mu_);
+  int64 hits_ GUARDED_BY(mu_) = 0;
+  int64 misses_ GUARDED_BY(mu_) = 0;
+};
+
+class EmbeddingCacheHandleOp : public ResourceOpKernel<EmbeddingCache> {
+ public:
+  explicit EmbeddingCacheHandleOp(OpKernelConstruction* ctx)
+      : ResourceOpKernel<EmbeddingCache>(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("capacity", &capacity_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dtype", &dtype_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("max_staleness", &max_staleness_));
+    PartialTensorShape row_shape;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("row_shape", &row_shape));
+    OP_REQUIRES(ctx, row_shape.AsTensorShape(&row_shape_),
+                errors::InvalidArgument("row_shape must be fully defined, got ",
+                                        row_shape.DebugString()));
+  }
+
+ private:
+  Status CreateResource(EmbeddingCache** ret) override
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    *ret = new EmbeddingCache(dtype_, row_shape_, capacity_, max_staleness_);
+    return Status::OK();
+  }
+
+  Status VerifyResource(EmbeddingCache* cache) override {
+    if (cache->dtype() != dtype_ || cache->row_shape() != row_shape_ ||
+        cache->capacity() != capacity_ ||
+        cache->max_staleness() != max_staleness_) {
+      return errors::InvalidArgument("Shared EmbeddingCache ", cinfo_.name(),
+                                     " was created with a different "
+                                     "configuration: ",
+                                     cache->DebugString());
+    }
+    return Status::OK();
+  }
+
+  int64 capacity_;
+  DataType dtype_;
+  TensorShape row_shape_;
+  int64 max_staleness_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("EmbeddingCacheHandle").Device(DEVICE_CPU),
+                        EmbeddingCacheHandleOp);
+
+template <typename Index>
+class EmbeddingCacheLookupOp : public OpKernel {
+ public:
+  explicit EmbeddingCacheLookupOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    EmbeddingCache* cache;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &cache));
+    core::ScopedUnref unref(cache);
+    const Tensor& ids = ctx->input(1);
+    const Tensor& global_step = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector, got ",
+                                        ids.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(global_step.shape()),
+                errors::InvalidArgument("global_step must be a scalar, got ",
+                                        global_step.shape().DebugString()));
+    OP_REQUIRES(ctx, cache->dtype() == output_type(0),
+                errors::InvalidArgument(
+                    "EmbeddingCache holds ", DataTypeString(cache->dtype()),
+                    " rows, but ", DataTypeString(output_type(0)),
+                    " was requested"));
+
+    TensorShape rows_shape = ids.shape();
+    rows_shape.AppendShape(cache->row_shape());
+    Tensor* rows = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, rows_shape, &rows));
+    Tensor* missing_index = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(2, ids.shape(), &missing_index));
+
+    std::vector<Index> missing;
+    cache->Lookup<Index>(ids.flat<Index>(), global_step.scalar<int64>()(),
+                         const_cast<char*>(rows->tensor_data().data()),
+                         &missing, missing_index->flat<int32>().data());
+
+    Tensor* missing_ids = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(
+                       1, TensorShape({static_cast<int64>(missing.size())}),
+                       &missing_ids));
+    std::copy(missing.begin(), missing.end(),
+              missing_ids->flat<Index>().data());
+  }
+};
+
+template <typename Index>
+class EmbeddingCacheInsertOp : public OpKernel {
+ public:
+  explicit EmbeddingCacheInsertOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    EmbeddingCache* cache;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &cache));
+    core::ScopedUnref unref(cache);
+    const Tensor& ids = ctx->input(1);
+    const Tensor& rows = ctx->input(2);
+    const Tensor& global_step = ctx->input(3);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector, got ",
+                                        ids.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(global_step.shape()),
+                errors::InvalidArgument("global_step must be a scalar, got ",
+                                        global_step.shape().DebugString()));
+    OP_REQUIRES(ctx, cache->dtype() == rows.dtype(),
+                errors::InvalidArgument(
+                    "EmbeddingCache holds ", DataTypeString(cache->dtype()),
+                    " rows, got ", DataTypeString(rows.dtype())));
+    TensorShape expected_shape = ids.shape();
+    expected_shape.AppendShape(cache->row_shape());
+    OP_REQUIRES(ctx, rows.shape() == expected_shape,
+                errors::InvalidArgument("rows must have shape ",
+                                        expected_shape.DebugString(), ", got ",
+                                        rows.shape().DebugString()));
+
+    cache->Insert<Index>(ids.flat<Index>(), global_step.scalar<int64>()(),
+                         rows.tensor_data().data());
+  }
+};
+
+template <typename Index>
+class EmbeddingCacheInvalidateOp : public OpKernel {
+ public:
+  explicit EmbeddingCacheInvalidateOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    EmbeddingCache* cache;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &cache));
+    core::ScopedUnref unref(cache);
+    const Tensor& ids = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector, got ",
+                                        ids.shape().DebugString()));
+    cache->Invalidate<Index>(ids.flat<Index>());
+  }
+};
+
+#define REGISTER_KERNELS(type)                                          \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingCacheLookup")                  \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<type>("Tindices"),        \
+                          EmbeddingCacheLookupOp<type>);                \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingCacheInsert")                  \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<type>("Tindices"),        \
+                          EmbeddingCacheInsertOp<type>);                \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingCacheInvalidate")              \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<type>("Tindices"),        \
+                          EmbeddingCacheInvalidateOp<type>);
+
+REGISTER_KERNELS(int32);
+REGISTER_KERNELS(int64);
+#undef REGISTER_KERNELS
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,122 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/shape_inference.h"
+
+namespace tensorflow {
+
+using shape_inference::DimensionHandle;
+using shape_inference::InferenceContext;
+using shape_inference::ShapeHandle;
+
+REGISTER_OP("EmbeddingCacheHandle")
+    .Output("handle: resource")
+    .Attr("capacity: int >= 1")
+    .Attr("row_shape: shape")
+    .Attr("dtype: {half, float, double}")
+    .Attr("max_staleness: int = -1")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a bounded, least-recently-used cache of embedding rows.
+
+The cache holds copies of rows of an embedding that lives elsewhere, typically
+on a parameter server, so that rows looked up again on later steps are served
+from local memory.
+
+handle: A resource usable by the EmbeddingCache* ops.
+capacity: The maximum number of rows held by the cache.
+row_shape: The shape of a single row, i.e. the embedding shape without its
+  first dimension.
+dtype: The type of the embedding.
+max_staleness: If non-negative, rows fetched more than `max_staleness` global
+  steps ago are treated as missing and fetched again.
+)doc");
+
+REGISTER_OP("EmbeddingCacheLookup")
+    .Input("cache: resource")
+    .Input("ids: Tindices")
+    .Input("global_step: int64")
+    .Output("rows: dtype")
+    .Output("missing_ids: Tindices")
+    .Output("missing_index: int32")
+    .Attr("dtype: {half, float, double}")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      ShapeHandle rows;
+      TF_RETURN_IF_ERROR(c->Concatenate(ids, c->UnknownShape(), &rows));
+      c->set_output(0, rows);
+      c->set_output(1, c->Vector(InferenceContext::kUnknownDim));
+      c->set_output(2, ids);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Looks up embedding rows in an EmbeddingCache.
+
+rows: The cached rows for `ids`, with zeros in place of rows that are missing
+  from the cache or too stale.
+missing_ids: The unique ids whose rows must be fetched.
+missing_index: For each element of `ids`, -1 if its row was found in the cache,
+  or its position in `missing_ids` otherwise.
+)doc");
+
+REGISTER_OP("EmbeddingCacheInsert")
+    .Input("cache: resource")
+    .Input("ids: Tindices")
+    .Input("rows: dtype")
+    .Input("global_step: int64")
+    .Attr("dtype: {half, float, double}")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids));
+      ShapeHandle rows;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 1, &rows));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(ids, 0), c->Dim(rows, 0), &unused_dim));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Adds embedding rows fetched at `global_step` to an EmbeddingCache.
+
+Rows already in the cache are replaced. When the cache is full, the least
+recently used rows are evicted.
+)doc");
+
+REGISTER_OP("EmbeddingCacheInvalidate")
+    .Input("cache: resource")
+    .Input("ids: Tindices")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Removes the rows for `ids` from an EmbeddingCache, if present.
+)doc");
+
+}  // namespace tensorflow
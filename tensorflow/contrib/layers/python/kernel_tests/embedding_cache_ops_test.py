@@ -0,0 +1,127 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for tf.contrib.layers.EmbeddingRowCache."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.contrib.layers.ops import gen_embedding_cache_ops
+from tensorflow.contrib.layers.python.ops import embedding_cache_ops
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import resource_variable_ops
+from tensorflow.python.ops import variables
+from tensorflow.python.platform import test
+
+
+class EmbeddingRowCacheTest(test.TestCase):
+
+  def _embedding(self, vocab_size=10, dim=3):
+    values = np.arange(vocab_size * dim, dtype=np.float32).reshape(
+        [vocab_size, dim])
+    return values, resource_variable_ops.ResourceVariable(values)
+
+  def testLookup(self):
+    values, params = self._embedding()
+    cache = embedding_cache_ops.EmbeddingRowCache(capacity=4, row_shape=[3])
+    ids = array_ops.placeholder(dtypes.int64)
+    rows = cache.lookup(params, ids)
+    with self.test_session() as sess:
+      sess.run(variables.global_variables_initializer())
+      for batch in [[1, 2, 1], [2, 5], [[0, 1], [7, 7]]]:
+        self.assertAllEqual(values[batch], sess.run(rows, {ids: batch}))
+
+  def testMissesAndEviction(self):
+    values, _ = self._embedding()
+    cache = embedding_cache_ops.EmbeddingRowCache(capacity=2, row_shape=[3])
+    ids = array_ops.placeholder(dtypes.int64, [None])
+    new_rows = array_ops.placeholder(dtypes.float32, [None, 3])
+    step = array_ops.placeholder(dtypes.int64, [])
+    lookup = gen_embedding_cache_ops.embedding_cache_lookup(
+        cache.handle, ids, step, dtype=dtypes.float32)
+    insert = gen_embedding_cache_ops.embedding_cache_insert(
+        cache.handle, ids, new_rows, step)
+    with self.test_session() as sess:
+      _, missing_ids, missing_index = sess.run(lookup, {ids: [3, 4, 3],
+                                                        step: 0})
+      self.assertAllEqual([3, 4], missing_ids)
+      self.assertAllEqual([0, 1, 0], missing_index)
+
+      sess.run(insert, {ids: [3, 4], new_rows: values[[3, 4]], step: 0})
+      rows, missing_ids, missing_index = sess.run(lookup, {ids: [4, 3],
+                                                           step: 0})
+      self.assertAllEqual(values[[4, 3]], rows)
+      self.assertAllEqual([], missing_ids)
+      self.assertAllEqual([-1, -1], missing_index)
+
+      # 3 was used last, so inserting 5 evicts 4.
+      sess.run(insert, {ids: [5], new_rows: values[[5]], step: 0})
+      _, missing_ids, _ = sess.run(lookup, {ids: [3, 4, 5], step: 0})
+      self.assertAllEqual([4], missing_ids)
+
+  def testStaleness(self):
+    values, _ = self._embedding()
+    cache = embedding_cache_ops.EmbeddingRowCache(
+        capacity=4, row_shape=[3], max_staleness=2)
+    step = array_ops.placeholder(dtypes.int64, [])
+    lookup = gen_embedding_cache_ops.embedding_cache_lookup(
+        cache.handle, [1], step, dtype=dtypes.float32)
+    insert = gen_embedding_cache_ops.embedding_cache_insert(
+        cache.handle, [1], values[[1]], step)
+    with self.test_session() as sess:
+      sess.run(insert, {step: 10})
+      self.assertAllEqual([], sess.run(lookup[1], {step: 12}))
+      self.assertAllEqual([1], sess.run(lookup[1], {step: 13}))
+
+  def testInvalidate(self):
+    values, params = self._embedding()
+    cache = embedding_cache_ops.EmbeddingRowCache(capacity=4, row_shape=[3])
+    rows = cache.lookup(params, [2])
+    update = params.scatter_sub(
+        cache.sparse_gradient(params, [2], constant_op.constant([[1.] * 3])))
+    invalidate = cache.invalidate([2])
+    with self.test_session() as sess:
+      sess.run(variables.global_variables_initializer())
+      self.assertAllEqual(values[[2]], sess.run(rows))
+      sess.run(update)
+      # The cached row is served until it is invalidated.
+      self.assertAllEqual(values[[2]], sess.run(rows))
+      sess.run(invalidate)
+      self.assertAllEqual(values[[2]] - 1., sess.run(rows))
+
+  def testWrongRowShape(self):
+    cache = embedding_cache_ops.EmbeddingRowCache(capacity=4, row_shape=[3])
+    insert = gen_embedding_cache_ops.embedding_cache_insert(
+        cache.handle, [1], np.zeros([1, 2], dtype=np.float32), 0)
+    with self.test_session() as sess:
+      with self.assertRaisesOpError("rows must have shape"):
+        sess.run(insert)
+
+  def testWrongDtype(self):
+    cache = embedding_cache_ops.EmbeddingRowCache(capacity=4, row_shape=[3])
+    lookup = gen_embedding_cache_ops.embedding_cache_lookup(
+        cache.handle, [1], 0, dtype=dtypes.float64)
+    with self.test_session() as sess:
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(lookup)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -32,5 +32,6 @@ from tensorflow.contrib.layers.python.layers.rev_block_lib import *
 from tensorflow.contrib.layers.python.layers.summaries import *
 from tensorflow.contrib.layers.python.layers.target_column import *
 from tensorflow.contrib.layers.python.ops.bucketization_op import *
+from tensorflow.contrib.layers.python.ops.embedding_cache_ops import *
 from tensorflow.contrib.layers.python.ops.sparse_feature_cross_op import *
 # pylint: enable=wildcard-import
@@ -0,0 +1,187 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""A worker-side cache for embedding rows held on parameter servers."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.layers.ops import gen_embedding_cache_ops
+from tensorflow.contrib.util import loader
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import tensor_shape
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import resource_loader
+from tensorflow.python.training import training_util
+
+_embedding_cache_ops = loader.load_op_library(
+    resource_loader.get_path_to_datafile("_embedding_cache_ops.so"))
+
+ops.NotDifferentiable("EmbeddingCacheLookup")
+ops.NotDifferentiable("EmbeddingCacheInsert")
+ops.NotDifferentiable("EmbeddingCacheInvalidate")
+
+
+class EmbeddingRowCache(object):
+  """A bounded, least-recently-used cache of embedding rows.
+
+  Looking up rows of an embedding that lives on a parameter server transfers
+  every row on every step, even for ids that were looked up on the previous
+  step. An `EmbeddingRowCache` created on a worker keeps up to `capacity` of
+  those rows in the worker's memory, so that only the rows it misses are
+  gathered from the parameter server:
+
+  ```python
+  with tf.device("/job:ps/task:0"):
+    embedding = tf.get_variable("embedding", [10000000, 64], use_resource=True)
+  with tf.device("/job:worker/task:0"):
+    cache = tf.contrib.layers.EmbeddingRowCache(
+        capacity=100000, row_shape=[64], max_staleness=10)
+    rows = cache.lookup(embedding, ids)
+  ```
+
+  Cached rows lag behind updates made by other workers. `max_staleness`
+  bounds that lag in global steps. Rows returned by `lookup()` do not
+  backpropagate into the embedding; train it with a sparse update built by
+  `sparse_gradient()`, and call `invalidate()` for the updated ids so that
+  this worker reads its own writes:
+
+  ```python
+  rows_grad, = tf.gradients(loss, rows)
+  train_op = optimizer.apply_gradients(
+      [(cache.sparse_gradient(embedding, ids, rows_grad), embedding)])
+  with tf.control_dependencies([train_op]):
+    train_op = cache.invalidate(ids)
+  ```
+  """
+
+  def __init__(self,
+               capacity,
+               row_shape,
+               dtype=dtypes.float32,
+               max_staleness=None,
+               shared_name=None,
+               name=None):
+    """Creates a cache on the current device.
+
+    Args:
+      capacity: The maximum number of rows held by the cache.
+      row_shape: The shape of one embedding row, i.e. the embedding shape
+        without its first dimension. Must be fully defined.
+      dtype: The type of the embedding.
+      max_staleness: (Optional.) If set, rows fetched more than
+        `max_staleness` global steps ago are fetched again.
+      shared_name: (Optional.) If non-empty, the cache is shared under this
+        name by all sessions on the same device.
+      name: (Optional.) A name for the operation.
+    """
+    self._row_shape = tensor_shape.as_shape(row_shape)
+    self._dtype = dtypes.as_dtype(dtype)
+    with ops.name_scope(name, "EmbeddingRowCache") as scope:
+      self._handle = gen_embedding_cache_ops.embedding_cache_handle(
+          capacity=capacity,
+          row_shape=self._row_shape,
+          dtype=self._dtype,
+          max_staleness=-1 if max_staleness is None else max_staleness,
+          shared_name=shared_name or "",
+          name=scope)
+
+  @property
+  def handle(self):
+    return self._handle
+
+  def lookup(self, params, ids, global_step=None, name=None):
+    """Looks up `ids` in `params`, gathering only the rows not cached.
+
+    Args:
+      params: A `Variable` or `Tensor` of shape `[N] + row_shape`, typically
+        placed on a parameter server.
+      ids: An integer `Tensor` of ids to look up.
+      global_step: (Optional.) A scalar `int64` `Tensor` used to measure the
+        staleness of cached rows. Defaults to the graph's global step, or 0 if
+        there is none.
+      name: (Optional.) A name for the operation.
+
+    Returns:
+      A `Tensor` of shape `shape(ids) + row_shape` holding the rows for `ids`.
+    """
+    with ops.name_scope(name, "EmbeddingRowCacheLookup", [ids]):
+      ids = ops.convert_to_tensor(ids, name="ids")
+      global_step = self._global_step(global_step)
+      flat_ids = array_ops.reshape(ids, [-1])
+      cached_rows, missing_ids, missing_index = (
+          gen_embedding_cache_ops.embedding_cache_lookup(
+              self._handle, flat_ids, global_step, dtype=self._dtype))
+      # Only the missing rows cross the network.
+      missing_rows = array_ops.gather(params, missing_ids)
+      insert = gen_embedding_cache_ops.embedding_cache_insert(
+          self._handle, missing_ids, missing_rows, global_step)
+      with ops.control_dependencies([insert]):
+        fetched_rows = array_ops.gather(missing_rows,
+                                        math_ops.maximum(missing_index, 0))
+      rows = array_ops.where(missing_index >= 0, fetched_rows, cached_rows)
+      rows = array_ops.stop_gradient(rows)
+      return array_ops.reshape(
+          rows, array_ops.concat([array_ops.shape(ids), self._row_dims()], 0))
+
+  def sparse_gradient(self, params, ids, rows_grad):
+    """Returns the gradient of `params` for a lookup of `ids`.
+
+    Args:
+      params: The `params` passed to `lookup()`.
+      ids: The `ids` passed to `lookup()`.
+      rows_grad: The gradient with respect to the rows returned by
+        `lookup()`.
+
+    Returns:
+      An `IndexedSlices` that can be applied to `params` with a sparse update,
+      e.g. by `Optimizer.apply_gradients()`.
+    """
+    flat_ids = array_ops.reshape(ids, [-1])
+    values = array_ops.reshape(
+        rows_grad, array_ops.concat([[-1], self._row_dims()], 0))
+    if params.shape.is_fully_defined():
+      dense_shape = ops.convert_to_tensor(
+          params.shape.as_list(), dtype=dtypes.int32)
+    else:
+      dense_shape = array_ops.shape(params)
+    return ops.IndexedSlices(values, flat_ids, dense_shape)
+
+  def invalidate(self, ids, name=None):
+    """Removes the rows for `ids` from the cache.
+
+    Args:
+      ids: An integer `Tensor` of ids, e.g. those just updated by this worker.
+      name: (Optional.) A name for the operation.
+
+    Returns:
+      The created `Operation`.
+    """
+    with ops.name_scope(name, "EmbeddingRowCacheInvalidate", [ids]):
+      flat_ids = array_ops.reshape(ids, [-1])
+      return gen_embedding_cache_ops.embedding_cache_invalidate(
+          self._handle, flat_ids)
+
+  def _global_step(self, global_step):
+    if global_step is None:
+      global_step = training_util.get_global_step()
+    if global_step is None:
+      return ops.convert_to_tensor(0, dtype=dtypes.int64)
+    return math_ops.cast(global_step, dtypes.int64)
+
+  def _row_dims(self):
+    return constant_op.constant(self._row_shape.as_list(), dtype=dtypes.int32)
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/arena_planner.h"
+#include <algorithm>
+#include <limits>
 #include <utility>
 
 namespace tflite {
@@ -43,6 +45,32 @@ ArenaPlanner::ArenaPlanner(TfLiteContext* context,
 
 ArenaPlanner::~ArenaPlanner() {}
 
+void ArenaPlanner::SetConcurrentGroups(const std::vector<int>& group_sizes) {
+  group_starts_.clear();
+  group_ends_.clear();
+  for (int group_size : group_sizes) {
+    int group_start = group_starts_.size();
+    for (int i = 0; i < group_size; ++i) {
+      group_starts_.push_back(group_start);
+      group_ends_.push_back(group_start + group_size - 1);
+    }
+  }
+  if (group_starts_.size() != graph_info_->num_nodes()) {
+    group_starts_.clear();
+    group_ends_.clear();
+  }
+}
+
+int ArenaPlanner::GroupStart(int node_index) const {
+  if (node_index >= group_starts_.size()) return node_index;
+  return group_starts_[node_index];
+}
+
+int ArenaPlanner::GroupEnd(int node_index) const {
+  if (node_index >= group_ends_.size()) return node_index;
+  return group_ends_[node_index];
+}
+
 int64_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
   if (type == kTfLiteArenaRwPersistent) {
     return persistent_arena_.BasePointer();
@@ -98,6 +126,11 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
     }
   }
 
+  // Inputs are only deallocated once all the nodes of a concurrent group are
+  // done, since the memory could otherwise be reused by a node of the group
+  // that is still reading them.
+  std::vector<int> group_deallocations;
+
   // Go through the graph in execution order.
   for (int i = 0; i < graph_info_->num_nodes(); ++i) {
     const TfLiteNode& node = graph_info_->node(i);
@@ -117,10 +150,17 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       if (tensor_index != kOptionalTensor) {
         refcounts[tensor_index]--;
         if (refcounts[tensor_index] == 0) {
-          alloc_queue_.push_back({i, tensor_index, AllocationInfo::DEALLOC});
+          group_deallocations.push_back(tensor_index);
         }
       }
     }
+
+    if (i == GroupEnd(i)) {
+      for (int tensor_index : group_deallocations) {
+        alloc_queue_.push_back({i, tensor_index, AllocationInfo::DEALLOC});
+      }
+      group_deallocations.clear();
+    }
   }
 
   // Note that graph outputs will never be scheduled for deallocation. We
@@ -134,7 +174,12 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   TF_LITE_ENSURE(context_, graph_info_->num_tensors() >= allocs_.size());
   allocs_.resize(graph_info_->num_tensors());
 
-  TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  const int num_nodes = graph_info_->num_nodes();
+  if (greedy_by_size_ && first_node == 0 && last_node >= num_nodes - 1) {
+    TF_LITE_ENSURE_STATUS(CalculateAllocationsBySize());
+  } else {
+    TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  }
   TF_LITE_ENSURE_STATUS(Commit());
 
   for (int i = 0; i < graph_info_->num_tensors(); ++i) {
@@ -149,6 +194,21 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
 }
 
 TfLiteStatus ArenaPlanner::Commit() {
+  if (external_buffer_ != nullptr) {
+    // The persistent tensors keep their place at the start of the buffer, and
+    // the other tensors move up when there are more persistent ones. Moving
+    // them first never overwrites persistent data.
+    size_t persistent_size = persistent_arena_.RequiredBufferSize();
+    if (persistent_size > external_buffer_size_) {
+      context_->ReportError(
+          context_, "Persistent tensors need %zu bytes but the buffer has %zu.",
+          persistent_size, external_buffer_size_);
+      return kTfLiteError;
+    }
+    persistent_arena_.SetExternalBuffer(external_buffer_, persistent_size);
+    arena_.SetExternalBuffer(external_buffer_ + persistent_size,
+                             external_buffer_size_ - persistent_size);
+  }
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
   TF_LITE_ENSURE_STATUS(persistent_arena_.Commit(context_));
   return kTfLiteOk;
@@ -156,6 +216,9 @@ TfLiteStatus ArenaPlanner::Commit() {
 
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   int active_node = first_node;
+  // The first node whose temporaries are currently allocated. Temporaries are
+  // kept until the concurrent group of their node is done.
+  int first_node_with_temporaries = first_node;
   // When dynamic tensors are present this method is called multiple times.
   // The items in the alloc_queue_ referring to nodes before first_node were
   // processed previously and should be skipped. Entries after last_node are
@@ -164,11 +227,14 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     if (alloc_info.node < first_node) continue;
     if (alloc_info.node > last_node) break;
     if (alloc_info.node == active_node) {
-      // This is the first allocation/deallocation for a given node.  It is
-      // time to deallocate the previous temporaries and allocate new ones.
-      if (active_node != first_node) {
-        TF_LITE_ENSURE_STATUS(
-            CalculateDeallocationOfInternalTensors(active_node - 1));
+      // This is the first allocation/deallocation for a given node.  If it
+      // starts a new group, it is time to deallocate the previous temporaries.
+      // In any case the node's own temporaries are allocated now.
+      if (active_node != first_node && GroupStart(active_node) == active_node) {
+        for (int i = first_node_with_temporaries; i < active_node; ++i) {
+          TF_LITE_ENSURE_STATUS(CalculateDeallocationOfInternalTensors(i));
+        }
+        first_node_with_temporaries = active_node;
       }
       TF_LITE_ENSURE_STATUS(CalculateAllocationOfInternalTensors(active_node));
       ++active_node;
@@ -181,13 +247,108 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
   }
 
-  // Don't forget to deallocate temporaries of last node.
-  TF_LITE_ENSURE_STATUS(
-      CalculateDeallocationOfInternalTensors(active_node - 1));
+  // Don't forget to deallocate temporaries of last group.
+  for (int i = first_node_with_temporaries; i < active_node; ++i) {
+    TF_LITE_ENSURE_STATUS(CalculateDeallocationOfInternalTensors(i));
+  }
 
   return kTfLiteOk;
 }
 
+TfLiteStatus ArenaPlanner::CalculateAllocationsBySize() {
+  const int num_nodes = graph_info_->num_nodes();
+  const int num_tensors = graph_info_->num_tensors();
+
+  // The first and last nodes during which each tensor is allocated, as
+  // given by the allocation queue. Temporaries are kept until the
+  // concurrent group of their node is done. Tensors that are never
+  // deallocated are used until the end.
+  std::vector<int> first_use(num_tensors, -1);
+  std::vector<int> last_use(num_tensors, num_nodes);
+  for (const auto& alloc_info : alloc_queue_) {
+    if (alloc_info.type == AllocationInfo::ALLOC) {
+      if (first_use[alloc_info.tensor] == -1) {
+        first_use[alloc_info.tensor] = alloc_info.node;
+      }
+    } else {
+      last_use[alloc_info.tensor] = alloc_info.node;
+    }
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    TfLiteIntArray* node_temporaries = graph_info_->node(i).temporaries;
+    for (int j = 0; j < node_temporaries->size; ++j) {
+      int tensor_index = node_temporaries->data[j];
+      first_use[tensor_index] = i;
+      last_use[tensor_index] = GroupEnd(i);
+    }
+  }
+
+  // Persistent tensors are never deallocated, so their order doesn't matter.
+  std::vector<int> tensors_by_size;
+  for (int i = 0; i < num_tensors; ++i) {
+    if (first_use[i] == -1) continue;
+    TfLiteTensor& tensor = *graph_info_->tensor(i);
+    if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
+      TF_LITE_ENSURE_STATUS(CalculateTensorAllocation(i));
+    } else if (tensor.allocation_type == kTfLiteArenaRw) {
+      tensors_by_size.push_back(i);
+    }
+  }
+  std::stable_sort(tensors_by_size.begin(), tensors_by_size.end(),
+                   [this](int a, int b) {
+                     return graph_info_->tensor(a)->bytes >
+                            graph_info_->tensor(b)->bytes;
+                   });
+
+  // The tensors placed so far, by increasing offset.
+  std::vector<int> placed;
+  placed.reserve(tensors_by_size.size());
+  for (int tensor_index : tensors_by_size) {
+    const size_t size = graph_info_->tensor(tensor_index)->bytes;
+    if (size == 0) {
+      allocs_[tensor_index] = ArenaAlloc();
+      continue;
+    }
+    auto aligned = [](size_t offset) {
+      return (offset + kDefaultTensorAlignment - 1) / kDefaultTensorAlignment *
+             kDefaultTensorAlignment;
+    };
+    // As in SimpleMemoryArena::Allocate(), take the smallest gap that fits,
+    // or go after all the tensors in use at the same time.
+    size_t current_offset = 0;
+    size_t best_offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    bool found_gap = false;
+    for (int other : placed) {
+      if (last_use[other] < first_use[tensor_index] ||
+          last_use[tensor_index] < first_use[other]) {
+        continue;
+      }
+      const ArenaAlloc& other_alloc = allocs_[other];
+      if (other_alloc.offset >= current_offset) {
+        const size_t gap = other_alloc.offset - current_offset;
+        if (aligned(current_offset) + size <= other_alloc.offset &&
+            gap < best_gap) {
+          best_offset = aligned(current_offset);
+          best_gap = gap;
+          found_gap = true;
+        }
+      }
+      current_offset =
+          std::max(current_offset, other_alloc.offset + other_alloc.size);
+    }
+    if (!found_gap) best_offset = aligned(current_offset);
+    TF_LITE_ENSURE_STATUS(arena_.AllocateAt(context_, best_offset, size,
+                                            &allocs_[tensor_index]));
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), best_offset,
+                                   [this](size_t offset, int other) {
+                                     return offset < allocs_[other].offset;
+                                   }),
+                  tensor_index);
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
@@ -56,6 +56,30 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   int64_t BasePointer(TfLiteAllocationType type);
 
+  // Declares that the nodes are split into groups of consecutive nodes that
+  // may run concurrently, of the given sizes. The tensors used by a group,
+  // including the temporaries of its nodes, are then all kept allocated until
+  // the whole group is done. Must be called before PlanAllocations(), and is
+  // ignored if the sizes don't add up to the number of nodes.
+  void SetConcurrentGroups(const std::vector<int>& group_sizes);
+
+  // If enabled, when all the nodes are handled by a single call to
+  // ExecuteAllocations(), the offsets of the tensors in the arena are chosen
+  // knowing when all of them are used: the largest tensors are placed first,
+  // each in the smallest gap left by the tensors already placed whose
+  // lifetimes overlap with its own. This usually lowers the size of the arena
+  // compared with allocating the tensors in execution order, which is still
+  // done when the nodes must be handled in steps, i.e. with dynamic tensors.
+  void SetGreedyBySizeAllocation(bool enable) { greedy_by_size_ = enable; }
+
+  // Places both arenas in the given buffer, persistent tensors first, instead
+  // of allocating them on the heap. The buffer is owned by the caller and must
+  // outlive the planner. ExecuteAllocations() fails if it is too small.
+  void SetExternalBuffer(char* buffer, size_t size) {
+    external_buffer_ = buffer;
+    external_buffer_size_ = size;
+  }
+
  private:
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
@@ -65,6 +89,10 @@ class ArenaPlanner : public MemoryPlanner {
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Reserve space for the tensors of all nodes at once, placing them by
+  // decreasing size. See SetGreedyBySizeAllocation().
+  TfLiteStatus CalculateAllocationsBySize();
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
@@ -83,6 +111,10 @@ class ArenaPlanner : public MemoryPlanner {
   // 'node_index'.
   TfLiteStatus CalculateDeallocationOfInternalTensors(int node_index);
 
+  // Returns the first and last nodes of the concurrent group of 'node_index'.
+  int GroupStart(int node_index) const;
+  int GroupEnd(int node_index) const;
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -93,6 +125,18 @@ class ArenaPlanner : public MemoryPlanner {
   // reflecting the way they are used in the graph.
   std::vector<AllocationInfo> alloc_queue_;
 
+  // The first and last nodes of the concurrent group of each node. Empty if
+  // every node runs on its own.
+  std::vector<int> group_starts_;
+  std::vector<int> group_ends_;
+
+  // Whether offsets are assigned by decreasing tensor size when possible.
+  bool greedy_by_size_ = false;
+
+  // The buffer holding the arenas, if not allocated by them.
+  char* external_buffer_ = nullptr;
+  size_t external_buffer_size_ = 0;
+
   // Raw memory buffer that is allocated for all temporary and graph outputs.
   // that are declared kTfLiteArenaRw.
   SimpleMemoryArena arena_;
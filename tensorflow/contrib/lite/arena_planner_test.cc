@@ -142,11 +142,15 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph) {
+  void SetGraph(TestGraph* graph,
+                const std::vector<int>& concurrent_group_sizes = {},
+                bool greedy_by_size = false) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_.reset(new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph))));
+    planner_->SetConcurrentGroups(concurrent_group_sizes);
+    planner_->SetGreedyBySizeAllocation(greedy_by_size);
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -258,6 +262,28 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithTemporary) {
   EXPECT_EQ(GetOffset(3), 0);
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithConcurrentOps) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {3}},    // First op, with temporary
+                      {{0}, {2}, {4}},    // Second op, with temporary
+                      {{1, 2}, {5}, {}}   // Third op
+                  },
+                  {5});
+  SetGraph(&graph, {2, 1});
+  Execute(0, 10);
+
+  // The first two ops run concurrently, so nothing they use is deallocated
+  // before both are done.
+  // Alloc(+) and dealloc(-) order: +3 +0 +1 +4 +2 -0 -3 -4 +5 -1 -2
+  EXPECT_EQ(GetOffset(3), 0);
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(3));
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(1));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(4));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithOptionals) {
   TestGraph graph({0, -1, 1},
                   {
@@ -304,6 +330,81 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithLargeTensor) {
   EXPECT_EQ(GetOffset(3), 0);
 }
 
+TEST_F(ArenaPlannerTest, GreedyBySize) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {2}, {}},     // First op
+                      {{2}, {3}, {}},     // Second op
+                      {{3, 1}, {4}, {}},  // Third op
+                  },
+                  {4});
+  (*graph.tensors())[3].bytes = 100;
+
+  // In execution order (+0 +1 +2 -0 +3 -2 +4 -3 -1), #3 and #4 don't fit in
+  // the small gaps left by #0 and #2, and the arena ends after #4 at 139:
+  SetGraph(&graph);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(3));
+  EXPECT_EQ(GetOffsetAfter(4), 140);
+
+  // By size, #2 and #0 reuse the memory of #4, which is only needed after
+  // them, and the arena ends after #1 at 122.
+  SetGraph(&graph, {}, /*greedy_by_size=*/true);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(3), 0);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(3));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(3));
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffsetAfter(1), 124);
+}
+
+TEST_F(ArenaPlannerTest, GreedyBySizeWithTemporaryAndPersistentTensors) {
+  TestGraph graph({0, -1, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},   // First op
+                      {{2, 0}, {4}, {5}},  // Second op, with temporary
+                      {{4, -1}, {3}, {}}   // Third op, with optional
+                  },
+                  {3});
+  (*graph.tensors())[1].allocation_type = kTfLiteArenaRwPersistent;
+
+  SetGraph(&graph, {}, /*greedy_by_size=*/true);
+  Execute(0, 10);
+
+  // Lifetimes: #0 [0, 1], #2 [0, 1], #4 [1, 2], #5 [1, 1] and #3 [2, 3], with
+  // #1 in its own arena. #5 (18 bytes) is placed before #4 (15 bytes), and
+  // #3 (12 bytes) can reuse the memory of #5.
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(5), 0);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(3), 0);
+}
+
+TEST_F(ArenaPlannerTest, GreedyBySizeNeedsAllNodes) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {2}, {}},     // First op
+                      {{2}, {3}, {}},     // Second op
+                      {{3, 1}, {4}, {}},  // Third op
+                  },
+                  {4});
+  (*graph.tensors())[3].bytes = 100;
+
+  // With stepwise allocation tensors are placed in execution order.
+  SetGraph(&graph, {}, /*greedy_by_size=*/true);
+  Execute(0, 0);
+  Execute(1, 2);
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(3));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithPersistentTensor) {
   TestGraph graph({0, -1, 1},
                   {
@@ -333,6 +434,40 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithPersistentTensor) {
   EXPECT_EQ(GetOffset(3), 0);
 }
 
+TEST_F(ArenaPlannerTest, ExternalBuffer) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},   // First op
+                      {{2, 0}, {4}, {5}},  // Second op, with temporary
+                      {{4}, {3}, {}}       // Third op
+                  },
+                  {3});
+  (*graph.tensors())[1].allocation_type = kTfLiteArenaRwPersistent;
+
+  SetGraph(&graph);
+  char buffer[1024];
+  planner_->SetExternalBuffer(buffer, sizeof(buffer));
+  Execute(0, 10);
+
+  // The persistent arena comes first.
+  EXPECT_LT(planner_->BasePointer(kTfLiteArenaRwPersistent),
+            planner_->BasePointer(kTfLiteArenaRw));
+  for (int i = 0; i < 6; ++i) {
+    const TfLiteTensor& tensor = (*graph.tensors())[i];
+    EXPECT_GE(tensor.data.raw, buffer);
+    EXPECT_LE(tensor.data.raw + tensor.bytes, buffer + sizeof(buffer));
+  }
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(0));
+
+  // Too small a buffer is an error.
+  SetGraph(&graph);
+  planner_->SetExternalBuffer(buffer, 16);
+  EXPECT_EQ(planner_->ExecuteAllocations(0, 10), kTfLiteError);
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithDynamicTensor) {
   TestGraph graph({0, -1, 1},
                   {
@@ -60,6 +60,30 @@ TfLiteIntArray* TfLiteIntArrayCopy(TfLiteIntArray* src) {
 
 void TfLiteIntArrayFree(TfLiteIntArray* a) { free(a); }
 
+TfLiteFloatArray* TfLiteFloatArrayCreate(int size) {
+  static TfLiteFloatArray dummy;
+  TfLiteFloatArray* ret = (TfLiteFloatArray*)malloc(
+      sizeof(dummy) + sizeof(dummy.data[0]) * size);
+  ret->size = size;
+  return ret;
+}
+
+void TfLiteFloatArrayFree(TfLiteFloatArray* a) { free(a); }
+
+void TfLiteChannelQuantizationFree(TfLiteChannelQuantization* q) {
+  if (!q) return;
+  if (q->scale) TfLiteFloatArrayFree(q->scale);
+  if (q->zero_point) TfLiteIntArrayFree(q->zero_point);
+  free(q);
+}
+
+void TfLiteSparsityFree(TfLiteSparsity* s) {
+  if (!s) return;
+  if (s->block_row_offsets) TfLiteIntArrayFree(s->block_row_offsets);
+  if (s->block_col_indices) TfLiteIntArrayFree(s->block_col_indices);
+  free(s);
+}
+
 void TfLiteTensorDataFree(TfLiteTensor* t) {
   if (t->allocation_type == kTfLiteDynamic && t->data.raw) {
     free(t->data.raw);
@@ -71,6 +95,10 @@ void TfLiteTensorFree(TfLiteTensor* t) {
   TfLiteTensorDataFree(t);
   if (t->dims) TfLiteIntArrayFree(t->dims);
   t->dims = NULL;
+  TfLiteChannelQuantizationFree(t->channel_params);
+  t->channel_params = NULL;
+  TfLiteSparsityFree(t->sparsity);
+  t->sparsity = NULL;
 }
 
 void TfLiteTensorReset(TfLiteType type, const char* name, TfLiteIntArray* dims,
@@ -77,6 +77,24 @@ TfLiteIntArray* TfLiteIntArrayCopy(TfLiteIntArray* src);
 // Free memory of array `v`.
 void TfLiteIntArrayFree(TfLiteIntArray* v);
 
+// Fixed size list of floats. Used for per-channel quantization scales.
+typedef struct {
+  int size;
+#if !defined(__clang__) && defined(__GNUC__) && __GNUC__ == 6 && \
+    __GNUC_MINOR__ >= 1
+  float data[0];
+#else
+  float data[];
+#endif
+} TfLiteFloatArray;
+
+// Create a array of a given `size` (uninitialized entries).
+// This returns a pointer, that you must free using TfLiteFloatArrayFree().
+TfLiteFloatArray* TfLiteFloatArrayCreate(int size);
+
+// Free memory of array `a`.
+void TfLiteFloatArrayFree(TfLiteFloatArray* a);
+
 // Since we must not depend on any libraries, define a minimal subset of
 // error macros while avoiding names that have pre-conceived meanings like
 // assert and check.
@@ -138,6 +156,7 @@ typedef enum {
   kTfLiteInt64 = 4,
   kTfLiteString = 5,
   kTfLiteBool = 6,
+  kTfLiteInt8 = 7,
 } TfLiteType;
 
 // Parameters for asymmetric quantization. Quantized values can be converted
@@ -148,6 +167,35 @@ typedef struct {
   int32_t zero_point;
 } TfLiteQuantizationParams;
 
+// Parameters for quantization with one scale and zero point per slice of a
+// tensor along `quantized_dimension`, e.g. per output channel of a filter:
+//    real_value = scale[c] * (quantized_value - zero_point[c]);
+// where `c` is the index of the value along `quantized_dimension`.
+typedef struct {
+  TfLiteFloatArray* scale;
+  TfLiteIntArray* zero_point;
+  int32_t quantized_dimension;
+} TfLiteChannelQuantization;
+
+// Free memory of `q`, including its arrays.
+void TfLiteChannelQuantizationFree(TfLiteChannelQuantization* q);
+
+// Block-sparse layout of a 2D tensor of shape [rows, cols]. The tensor is
+// split into blocks of `block_rows` x `block_cols` values, and only the blocks
+// with non-zero values are stored, one after the other and each in row-major
+// order, going through the rows of blocks in order. The stored blocks of row
+// of blocks `r` are `block_row_offsets[r]` to `block_row_offsets[r + 1] - 1`,
+// and `block_col_indices` holds the column of blocks of each of them.
+typedef struct {
+  int block_rows;
+  int block_cols;
+  TfLiteIntArray* block_row_offsets;
+  TfLiteIntArray* block_col_indices;
+} TfLiteSparsity;
+
+// Free memory of `s`, including its arrays.
+void TfLiteSparsityFree(TfLiteSparsity* s);
+
 // A union of points that points to memory for a given tensor.
 typedef union {
   int* i32;
@@ -157,6 +205,7 @@ typedef union {
   const char* raw_const;
   uint8_t* uint8;
   bool* b;
+  int8_t* int8;
 } TfLitePtrUnion;
 
 // Memory allocation strategies. kTfLiteMmapRo is for read-only memory-mapped
@@ -223,6 +272,15 @@ typedef struct {
   // delegate buffer.
   // WARNING: This is an // experimental interface that is subject to change.
   bool data_is_stale;
+
+  // Per-channel quantization information, or null if the tensor is quantized
+  // as a whole through `params`. Owned by the tensor.
+  TfLiteChannelQuantization* channel_params;
+
+  // Block-sparse layout of the data of a constant tensor, or null if the data
+  // is dense. Owned by the tensor.
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteSparsity* sparsity;
 } TfLiteTensor;
 
 // Free data memory of tensor `t`;
@@ -273,6 +331,25 @@ typedef struct {
   TfLiteDelegate* delegate;
 } TfLiteNode;
 
+// The types of external contexts: library-global objects, like thread pools,
+// that TF Lite knows nothing about but that several ops use.
+typedef enum {
+  kTfLiteEigenContext = 0,     // include eigen_support.h to use.
+  kTfLiteGemmLowpContext = 1,  // include gemm_support.h to use.
+  kTfLiteMaxExternalContexts = 2
+} TfLiteExternalContextType;
+
+struct TfLiteContext;
+
+// An external context. The library owning a type of external context extends
+// this with its own data. Some can be shared by several interpreters.
+typedef struct {
+  TfLiteExternalContextType type;
+  // Called, if not null, when configuration like the number of recommended
+  // threads of 'context' changes.
+  TfLiteStatus (*Refresh)(struct TfLiteContext* context);
+} TfLiteExternalContext;
+
 typedef struct TfLiteContext {
   // Number of tensors in the context.
   size_t tensors_size;
@@ -330,10 +407,13 @@ typedef struct TfLiteContext {
   // eigen.
   int recommended_num_threads;
 
-  // TODO(ahentz): we should create a more general mechanism for this sort of
-  // library-global objects.
-  void* gemm_context;
-  void* eigen_context;
+  // Access external contexts by type. Returns null if the context of the
+  // given type was not set.
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteExternalContext* (*GetExternalContext)(struct TfLiteContext*,
+                                               TfLiteExternalContextType);
+  void (*SetExternalContext)(struct TfLiteContext*, TfLiteExternalContextType,
+                             TfLiteExternalContext*);
 } TfLiteContext;
 
 typedef struct _TfLiteRegistration {
@@ -0,0 +1,409 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/delegates/gpu/gl_delegate.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl31.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/builtin_ops.h"
+#include "tensorflow/contrib/lite/delegates/gpu/gl_ops.h"
+
+namespace tflite {
+namespace gpu {
+
+// The EGL context the delegate runs in, and the shader programs compiled in
+// it, which are shared by all the delegate kernels.
+class GlEnvironment {
+ public:
+  ~GlEnvironment() {
+    if (display_ == EGL_NO_DISPLAY) return;
+    if (Activate()) {
+      for (const auto& program : programs_) {
+        glDeleteProgram(program.second);
+      }
+    }
+    if (owns_context_) {
+      eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+      if (draw_surface_ != EGL_NO_SURFACE) {
+        eglDestroySurface(display_, draw_surface_);
+      }
+      eglDestroyContext(display_, context_);
+      eglTerminate(display_);
+    }
+  }
+
+  // Adopts the EGL context current on this thread, or creates one. Does
+  // nothing if that was already done.
+  TfLiteStatus Init(TfLiteContext* context) {
+    if (initialized_) return kTfLiteOk;
+    if (eglGetCurrentContext() != EGL_NO_CONTEXT) {
+      display_ = eglGetCurrentDisplay();
+      context_ = eglGetCurrentContext();
+      draw_surface_ = eglGetCurrentSurface(EGL_DRAW);
+      read_surface_ = eglGetCurrentSurface(EGL_READ);
+    } else {
+      TF_LITE_ENSURE_STATUS(CreateContext(context));
+    }
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major < 3 || (major == 3 && minor < 1)) {
+      context->ReportError(context,
+                           "OpenGL ES 3.1 is required, but found %d.%d.", major,
+                           minor);
+      return kTfLiteError;
+    }
+    initialized_ = true;
+    return kTfLiteOk;
+  }
+
+  // Makes the context current on this thread, returning false on failure.
+  bool Activate() {
+    return eglGetCurrentContext() == context_ ||
+           eglMakeCurrent(display_, draw_surface_, read_surface_, context_);
+  }
+
+  TfLiteStatus MakeCurrent(TfLiteContext* context) {
+    if (!Activate()) {
+      context->ReportError(context, "eglMakeCurrent failed: 0x%x.",
+                           eglGetError());
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  // Returns the program running the given compute shader, compiling it the
+  // first time it is asked for.
+  TfLiteStatus GetProgram(TfLiteContext* context, const std::string& source,
+                          GLuint* program) {
+    auto it = programs_.find(source);
+    if (it != programs_.end()) {
+      *program = it->second;
+      return kTfLiteOk;
+    }
+    TF_LITE_ENSURE_STATUS(CompileProgram(context, source, program));
+    programs_[source] = *program;
+    return kTfLiteOk;
+  }
+
+ private:
+  TfLiteStatus CreateContext(TfLiteContext* context) {
+    display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display_ == EGL_NO_DISPLAY || !eglInitialize(display_, nullptr,
+                                                     nullptr)) {
+      display_ = EGL_NO_DISPLAY;
+      context->ReportError(context, "Failed to initialize EGL: 0x%x.",
+                           eglGetError());
+      return kTfLiteError;
+    }
+    owns_context_ = true;
+    const EGLint config_attributes[] = {EGL_RENDERABLE_TYPE,
+                                        EGL_OPENGL_ES3_BIT_KHR,
+                                        EGL_SURFACE_TYPE,
+                                        EGL_PBUFFER_BIT,
+                                        EGL_NONE};
+    EGLConfig config;
+    EGLint num_configs = 0;
+    if (!eglBindAPI(EGL_OPENGL_ES_API) ||
+        !eglChooseConfig(display_, config_attributes, &config, 1,
+                         &num_configs) ||
+        num_configs == 0) {
+      context->ReportError(context, "No EGL config supports OpenGL ES 3.");
+      return kTfLiteError;
+    }
+    const EGLint context_attributes[] = {EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+                                         EGL_CONTEXT_MINOR_VERSION_KHR, 1,
+                                         EGL_NONE};
+    context_ = eglCreateContext(display_, config, EGL_NO_CONTEXT,
+                                context_attributes);
+    if (context_ == EGL_NO_CONTEXT) {
+      context->ReportError(context, "eglCreateContext failed: 0x%x.",
+                           eglGetError());
+      return kTfLiteError;
+    }
+    // Compute shaders don't need a surface, but drivers without
+    // EGL_KHR_surfaceless_context require one to make the context current.
+    const char* extensions = eglQueryString(display_, EGL_EXTENSIONS);
+    if (extensions == nullptr ||
+        !strstr(extensions, "EGL_KHR_surfaceless_context")) {
+      const EGLint surface_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1,
+                                           EGL_NONE};
+      draw_surface_ =
+          eglCreatePbufferSurface(display_, config, surface_attributes);
+      if (draw_surface_ == EGL_NO_SURFACE) {
+        context->ReportError(context, "eglCreatePbufferSurface failed: 0x%x.",
+                             eglGetError());
+        return kTfLiteError;
+      }
+      read_surface_ = draw_surface_;
+    }
+    return MakeCurrent(context);
+  }
+
+  TfLiteStatus CompileProgram(TfLiteContext* context,
+                              const std::string& source, GLuint* program) {
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    const char* source_data = source.c_str();
+    glShaderSource(shader, 1, &source_data, nullptr);
+    glCompileShader(shader);
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+      char log[1024];
+      glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+      context->ReportError(context, "Failed to compile shader: %s\n%s", log,
+                           source_data);
+      glDeleteShader(shader);
+      return kTfLiteError;
+    }
+    *program = glCreateProgram();
+    glAttachShader(*program, shader);
+    glLinkProgram(*program);
+    // The program keeps the shader alive for as long as it needs it.
+    glDeleteShader(shader);
+    glGetProgramiv(*program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+      char log[1024];
+      glGetProgramInfoLog(*program, sizeof(log), nullptr, log);
+      context->ReportError(context, "Failed to link program: %s", log);
+      glDeleteProgram(*program);
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
+  EGLDisplay display_ = EGL_NO_DISPLAY;
+  EGLContext context_ = EGL_NO_CONTEXT;
+  EGLSurface draw_surface_ = EGL_NO_SURFACE;
+  EGLSurface read_surface_ = EGL_NO_SURFACE;
+  bool owns_context_ = false;
+  bool initialized_ = false;
+  std::map<std::string, GLuint> programs_;
+};
+
+namespace {
+
+TfLiteStatus CheckGlError(TfLiteContext* context, const char* operation) {
+  GLenum error = glGetError();
+  if (error != GL_NO_ERROR) {
+    context->ReportError(context, "%s failed with GL error 0x%x.", operation,
+                         error);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+std::vector<int> ToVector(const TfLiteIntArray* array) {
+  return std::vector<int>(array->data, array->data + array->size);
+}
+
+// The state of one delegate kernel: the nodes it replaces, their shaders and
+// one shader storage buffer per tensor they use.
+class GlSubgraph {
+ public:
+  GlSubgraph(TfLiteContext* context, const TfLiteDelegateParams& params)
+      : environment_(static_cast<GlEnvironment*>(params.delegate->data_)),
+        inputs_(ToVector(params.input_tensors)),
+        outputs_(ToVector(params.output_tensors)) {
+    // The nodes are only accessible until the delegate's Prepare returns, but
+    // their builtin data lives as long as the interpreter.
+    for (int node_index : ToVector(params.nodes_to_replace)) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      context->GetNodeAndRegistration(context, node_index, &node,
+                                      &registration);
+      nodes_.push_back({registration->builtin_code, node->builtin_data,
+                        ToVector(node->inputs), ToVector(node->outputs)});
+    }
+  }
+
+  ~GlSubgraph() {
+    // Buffers can only be deleted in the context they were created in.
+    if (buffers_.empty() || !environment_->Activate()) return;
+    for (const auto& buffer : buffers_) {
+      glDeleteBuffers(1, &buffer.second.id);
+    }
+  }
+
+  TfLiteStatus Prepare(TfLiteContext* context) {
+    TF_LITE_ENSURE_STATUS(environment_->MakeCurrent(context));
+    ops_.resize(nodes_.size());
+    programs_.resize(nodes_.size());
+    for (int i = 0; i < nodes_.size(); ++i) {
+      TF_LITE_ENSURE_STATUS(PrepareGlOp(context, nodes_[i], &ops_[i]));
+      TF_LITE_ENSURE_STATUS(environment_->GetProgram(
+          context, ops_[i].shader_source, &programs_[i]));
+      for (int tensor_index : ops_[i].inputs) {
+        TF_LITE_ENSURE_STATUS(PrepareBuffer(context, tensor_index));
+      }
+      for (int tensor_index : ops_[i].outputs) {
+        TF_LITE_ENSURE_STATUS(PrepareBuffer(context, tensor_index));
+      }
+    }
+    return CheckGlError(context, "Preparing GPU buffers");
+  }
+
+  TfLiteStatus Invoke(TfLiteContext* context) {
+    TF_LITE_ENSURE_STATUS(environment_->MakeCurrent(context));
+    for (int tensor_index : inputs_) {
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      auto it = buffers_.find(tensor_index);
+      if (it == buffers_.end() || tensor.allocation_type == kTfLiteMmapRo) {
+        continue;
+      }
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, it->second.id);
+      glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, tensor.bytes,
+                      tensor.data.raw);
+    }
+
+    for (int i = 0; i < ops_.size(); ++i) {
+      const GlOp& op = ops_[i];
+      glUseProgram(programs_[i]);
+      int binding = 0;
+      for (int tensor_index : op.inputs) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding++,
+                         buffers_[tensor_index].id);
+      }
+      for (int tensor_index : op.outputs) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding++,
+                         buffers_[tensor_index].id);
+      }
+      glDispatchCompute(op.work_groups[0], op.work_groups[1],
+                        op.work_groups[2]);
+      // The next op reads what this one wrote.
+      glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    TF_LITE_ENSURE_STATUS(CheckGlError(context, "Running GPU shaders"));
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    for (int tensor_index : outputs_) {
+      TfLiteTensor& tensor = context->tensors[tensor_index];
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers_[tensor_index].id);
+      const void* data = glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0,
+                                          tensor.bytes, GL_MAP_READ_BIT);
+      if (data == nullptr) {
+        return CheckGlError(context, "Reading GPU outputs");
+      }
+      memcpy(tensor.data.raw, data, tensor.bytes);
+      glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    }
+    return CheckGlError(context, "Reading GPU outputs");
+  }
+
+ private:
+  struct Buffer {
+    GLuint id = 0;
+    size_t bytes = 0;
+  };
+
+  // Makes sure the tensor has a buffer of the right size. Constant tensors
+  // are uploaded once, when their buffer is created.
+  TfLiteStatus PrepareBuffer(TfLiteContext* context, int tensor_index) {
+    const TfLiteTensor& tensor = context->tensors[tensor_index];
+    Buffer& buffer = buffers_[tensor_index];
+    if (buffer.id != 0 && buffer.bytes == tensor.bytes) return kTfLiteOk;
+    if (buffer.id == 0) glGenBuffers(1, &buffer.id);
+    const bool is_constant = tensor.allocation_type == kTfLiteMmapRo;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.id);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, tensor.bytes,
+                 is_constant ? tensor.data.raw_const : nullptr,
+                 is_constant ? GL_STATIC_DRAW : GL_DYNAMIC_COPY);
+    buffer.bytes = tensor.bytes;
+    return kTfLiteOk;
+  }
+
+  GlEnvironment* environment_;
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+  std::vector<GlNode> nodes_;
+  std::vector<GlOp> ops_;
+  std::vector<GLuint> programs_;
+  std::map<int, Buffer> buffers_;
+};
+
+TfLiteRegistration GetKernelRegistration() {
+  TfLiteRegistration registration = {nullptr};
+  registration.init = [](TfLiteContext* context, const char* buffer,
+                         size_t) -> void* {
+    const auto* params = reinterpret_cast<const TfLiteDelegateParams*>(buffer);
+    return new GlSubgraph(context, *params);
+  };
+  registration.free = [](TfLiteContext* context, void* buffer) {
+    delete reinterpret_cast<GlSubgraph*>(buffer);
+  };
+  registration.prepare = [](TfLiteContext* context,
+                            TfLiteNode* node) -> TfLiteStatus {
+    return reinterpret_cast<GlSubgraph*>(node->user_data)->Prepare(context);
+  };
+  registration.invoke = [](TfLiteContext* context,
+                           TfLiteNode* node) -> TfLiteStatus {
+    return reinterpret_cast<GlSubgraph*>(node->user_data)->Invoke(context);
+  };
+  registration.builtin_code = kTfLiteBuiltinDelegate;
+  registration.custom_name = "GlDelegate";
+  return registration;
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteDelegate* delegate) {
+  TF_LITE_ENSURE_STATUS(
+      static_cast<GlEnvironment*>(delegate->data_)->Init(context));
+
+  TfLiteIntArray* plan;
+  TF_LITE_ENSURE_STATUS(context->GetExecutionPlan(context, &plan));
+  std::vector<int> supported_nodes;
+  for (int i = 0; i < plan->size; ++i) {
+    const int node_index = plan->data[i];
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+        context, node_index, &node, &registration));
+    if (IsNodeSupported(context, *node, *registration)) {
+      supported_nodes.push_back(node_index);
+    }
+  }
+  if (supported_nodes.empty()) return kTfLiteOk;
+
+  TfLiteIntArray* nodes_to_replace =
+      TfLiteIntArrayCreate(supported_nodes.size());
+  std::copy(supported_nodes.begin(), supported_nodes.end(),
+            nodes_to_replace->data);
+  TfLiteStatus status = context->ReplaceSubgraphsWithDelegateKernels(
+      context, GetKernelRegistration(), nodes_to_replace, delegate);
+  TfLiteIntArrayFree(nodes_to_replace);
+  return status;
+}
+
+}  // namespace
+
+GlDelegate::GlDelegate() : environment_(new GlEnvironment) {
+  delegate_.data_ = environment_.get();
+  delegate_.Prepare = Prepare;
+  // Tensors are copied in and out of GPU buffers by the kernels themselves.
+  delegate_.CopyFromBufferHandle = nullptr;
+  delegate_.CopyToBufferHandle = nullptr;
+  delegate_.FreeBufferHandle = nullptr;
+}
+
+GlDelegate::~GlDelegate() {}
+
+}  // namespace gpu
+}  // namespace tflite
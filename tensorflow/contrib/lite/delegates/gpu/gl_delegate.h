@@ -0,0 +1,55 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_DELEGATES_GPU_GL_DELEGATE_H_
+#define TENSORFLOW_CONTRIB_LITE_DELEGATES_GPU_GL_DELEGATE_H_
+
+#include <memory>
+
+#include "tensorflow/contrib/lite/context.h"
+
+namespace tflite {
+namespace gpu {
+
+class GlEnvironment;
+
+// A delegate running the supported float ops of a graph (see gl_ops.h) as
+// OpenGL ES 3.1 compute shaders. Consecutive supported nodes become a single
+// delegate kernel, whose intermediate tensors stay in GPU buffers; only the
+// inputs and outputs of the kernel are copied between the CPU and the GPU.
+//
+// Usage:
+//   GlDelegate delegate;
+//   interpreter->ModifyGraphWithDelegate(delegate.get(), false);
+//
+// The delegate uses the EGL context current on the calling thread, or creates
+// its own if there is none. Prepare and Invoke must then be called on that
+// thread, and the delegate must outlive the interpreter.
+// WARNING: This is an experimental interface that is subject to change.
+class GlDelegate {
+ public:
+  GlDelegate();
+  ~GlDelegate();
+
+  TfLiteDelegate* get() { return &delegate_; }
+
+ private:
+  TfLiteDelegate delegate_;
+  std::unique_ptr<GlEnvironment> environment_;
+};
+
+}  // namespace gpu
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_DELEGATES_GPU_GL_DELEGATE_H_
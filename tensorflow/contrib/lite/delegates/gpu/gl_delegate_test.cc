@@ -0,0 +1,269 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/delegates/gpu/gl_delegate.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/builtin_op_data.h"
+#include "tensorflow/contrib/lite/builtin_ops.h"
+#include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace gpu {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+// Builds graphs of builtin nodes without CPU kernels, so that they can only
+// run if they are delegated.
+class GlDelegateTest : public ::testing::Test {
+ protected:
+  void AddTensor(int index, const std::vector<int>& dims) {
+    AddTensorsUpTo(index);
+    ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(
+                  index, kTfLiteFloat32, "", dims, TfLiteQuantizationParams()),
+              kTfLiteOk);
+  }
+
+  void AddConstantTensor(int index, const std::vector<int>& dims,
+                         const std::vector<float>& data) {
+    AddTensorsUpTo(index);
+    constants_.push_back(data);
+    const std::vector<float>& buffer = constants_.back();
+    ASSERT_EQ(interpreter_.SetTensorParametersReadOnly(
+                  index, kTfLiteFloat32, "", dims, TfLiteQuantizationParams(),
+                  reinterpret_cast<const char*>(buffer.data()),
+                  buffer.size() * sizeof(float)),
+              kTfLiteOk);
+  }
+
+  // Adds a node; 'params' must be allocated with malloc(), as the interpreter
+  // frees it.
+  void AddNode(int builtin_code, void* params, const std::vector<int>& inputs,
+               const std::vector<int>& outputs) {
+    registrations_.push_back({nullptr});
+    registrations_.back().builtin_code = builtin_code;
+    ASSERT_EQ(
+        interpreter_.AddNodeWithParameters(inputs, outputs, nullptr, 0, params,
+                                           &registrations_.back()),
+        kTfLiteOk);
+  }
+
+  void Build(const std::vector<int>& inputs, const std::vector<int>& outputs,
+             bool allow_dynamic_tensors = false) {
+    ASSERT_EQ(interpreter_.SetInputs(inputs), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs(outputs), kTfLiteOk);
+    ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+    ASSERT_EQ(interpreter_.ModifyGraphWithDelegate(delegate_.get(),
+                                                   allow_dynamic_tensors),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  }
+
+  void SetInput(int index, const std::vector<float>& data) {
+    std::copy(data.begin(), data.end(),
+              interpreter_.typed_tensor<float>(index));
+  }
+
+  std::vector<float> GetOutput(int index) {
+    const TfLiteTensor* tensor = interpreter_.tensor(index);
+    return std::vector<float>(tensor->data.f,
+                              tensor->data.f + tensor->bytes / sizeof(float));
+  }
+
+  std::vector<int> GetShape(int index) {
+    const TfLiteIntArray* dims = interpreter_.tensor(index)->dims;
+    return std::vector<int>(dims->data, dims->data + dims->size);
+  }
+
+  template <typename T>
+  static T* NewParams() {
+    return static_cast<T*>(calloc(1, sizeof(T)));
+  }
+
+  // The delegate must outlive the interpreter.
+  GlDelegate delegate_;
+  Interpreter interpreter_;
+
+ private:
+  void AddTensorsUpTo(int index) {
+    if (interpreter_.tensors_size() <= index) {
+      interpreter_.AddTensors(index + 1 - interpreter_.tensors_size());
+    }
+  }
+
+  std::list<std::vector<float>> constants_;
+  std::list<TfLiteRegistration> registrations_;
+};
+
+TEST_F(GlDelegateTest, AddWithRelu) {
+  AddTensor(0, {1, 2, 2, 1});
+  AddTensor(1, {1, 2, 2, 1});
+  AddTensor(2, {1, 2, 2, 1});
+  auto* params = NewParams<TfLiteAddParams>();
+  params->activation = kTfLiteActRelu;
+  AddNode(kTfLiteBuiltinAdd, params, {0, 1}, {2});
+  Build({0, 1}, {2});
+  ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+
+  SetInput(0, {1, -2, 3, -4});
+  SetInput(1, {0.5, 0.5, -5, 5});
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  EXPECT_THAT(GetOutput(2), ElementsAreArray({1.5f, 0.f, 0.f, 1.f}));
+}
+
+TEST_F(GlDelegateTest, ChainedNodesRunAsOneKernel) {
+  AddTensor(0, {1, 1, 2, 2});
+  AddTensor(1, {1, 1, 2, 2});
+  AddTensor(2, {1, 1, 2, 2});
+  AddTensor(3, {1, 1, 2, 2});
+  AddNode(kTfLiteBuiltinAdd, NewParams<TfLiteAddParams>(), {0, 1}, {2});
+  AddNode(kTfLiteBuiltinAdd, NewParams<TfLiteAddParams>(), {2, 1}, {3});
+  Build({0, 1}, {3});
+  ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+
+  SetInput(0, {1, 2, 3, 4});
+  SetInput(1, {10, 20, 30, 40});
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  EXPECT_THAT(GetOutput(3), ElementsAreArray({21, 42, 63, 84}));
+}
+
+TEST_F(GlDelegateTest, LeavesUnsupportedNodesToTheCpu) {
+  AddTensor(0, {1, 1, 2, 2});
+  AddTensor(1, {1, 1, 1, 2});
+  AddTensor(2, {1, 1, 2, 2});
+  AddNode(kTfLiteBuiltinAdd, NewParams<TfLiteAddParams>(), {0, 1}, {2});
+  Build({0, 1}, {2});
+  // Broadcasting isn't supported, so the original node is still there.
+  ASSERT_EQ(interpreter_.execution_plan().size(), 1);
+  EXPECT_EQ(interpreter_.execution_plan()[0], 0);
+}
+
+TEST_F(GlDelegateTest, Conv) {
+  AddTensor(0, {1, 3, 3, 1});
+  AddConstantTensor(1, {2, 2, 2, 1}, {1, 1, 1, 1, 1, 0, 0, -1});
+  AddConstantTensor(2, {2}, {1, 0});
+  AddTensor(3, {1, 2, 2, 2});
+  auto* params = NewParams<TfLiteConvParams>();
+  params->padding = kTfLitePaddingValid;
+  params->stride_width = 1;
+  params->stride_height = 1;
+  params->dilation_width_factor = 1;
+  params->dilation_height_factor = 1;
+  AddNode(kTfLiteBuiltinConv2d, params, {0, 1, 2}, {3});
+  Build({0}, {3});
+
+  SetInput(0, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  EXPECT_THAT(GetShape(3), ElementsAreArray({1, 2, 2, 2}));
+  EXPECT_THAT(GetOutput(3), ElementsAreArray({13, -4, 17, -4, 25, -4, 29, -4}));
+}
+
+TEST_F(GlDelegateTest, ConvWithSamePaddingAndStride) {
+  AddTensor(0, {1, 3, 3, 1});
+  AddConstantTensor(1, {1, 2, 2, 1}, {1, 1, 1, 1});
+  AddConstantTensor(2, {1}, {0});
+  AddTensor(3, {1, 2, 2, 1});
+  auto* params = NewParams<TfLiteConvParams>();
+  params->padding = kTfLitePaddingSame;
+  params->stride_width = 2;
+  params->stride_height = 2;
+  params->dilation_width_factor = 1;
+  params->dilation_height_factor = 1;
+  AddNode(kTfLiteBuiltinConv2d, params, {0, 1, 2}, {3});
+  Build({0}, {3});
+
+  SetInput(0, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  EXPECT_THAT(GetOutput(3), ElementsAreArray({12, 9, 15, 9}));
+}
+
+TEST_F(GlDelegateTest, DepthwiseConv) {
+  AddTensor(0, {1, 2, 2, 2});
+  AddConstantTensor(1, {1, 2, 2, 4},
+                    {1, 2, -1, 0.5, 1, 2, -1, 0.5, 1, 2, -1, 0.5, 1, 2, -1,
+                     0.5});
+  AddConstantTensor(2, {4}, {0, 1, 2, 3});
+  AddTensor(3, {1, 1, 1, 4});
+  auto* params = NewParams<TfLiteDepthwiseConvParams>();
+  params->padding = kTfLitePaddingValid;
+  params->stride_width = 1;
+  params->stride_height = 1;
+  params->depth_multiplier = 2;
+  AddNode(kTfLiteBuiltinDepthwiseConv2d, params, {0, 1, 2}, {3});
+  Build({0}, {3});
+
+  SetInput(0, {1, 2, 3, 4, 5, 6, 7, 8});
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  EXPECT_THAT(GetOutput(3), ElementsAreArray({16, 33, -18, 13}));
+}
+
+TEST_F(GlDelegateTest, Pools) {
+  AddTensor(0, {1, 2, 3, 1});
+  AddTensor(1, {1, 1, 2, 1});
+  AddTensor(2, {1, 1, 2, 1});
+  for (int builtin_code :
+       {kTfLiteBuiltinAveragePool2d, kTfLiteBuiltinMaxPool2d}) {
+    auto* params = NewParams<TfLitePoolParams>();
+    params->padding = kTfLitePaddingSame;
+    params->stride_width = 2;
+    params->stride_height = 2;
+    params->filter_width = 2;
+    params->filter_height = 2;
+    AddNode(builtin_code, params, {0},
+            {builtin_code == kTfLiteBuiltinMaxPool2d ? 2 : 1});
+  }
+  Build({0}, {1, 2});
+
+  SetInput(0, {1, 2, 3, 4, 5, 6});
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  // Averages only count the values inside the image.
+  EXPECT_THAT(GetOutput(1), ElementsAreArray({3.f, 4.5f}));
+  EXPECT_THAT(GetOutput(2), ElementsAreArray({5, 6}));
+}
+
+TEST_F(GlDelegateTest, ResizedInput) {
+  AddTensor(0, {1, 1, 1, 2});
+  AddTensor(1, {1, 1, 1, 2});
+  AddTensor(2, {1, 1, 1, 2});
+  AddNode(kTfLiteBuiltinAdd, NewParams<TfLiteAddParams>(), {0, 1}, {2});
+  // Inputs can only be resized if the graph isn't made immutable.
+  Build({0, 1}, {2}, /*allow_dynamic_tensors=*/true);
+  ASSERT_EQ(interpreter_.ResizeInputTensor(0, {1, 1, 3, 1}), kTfLiteOk);
+  ASSERT_EQ(interpreter_.ResizeInputTensor(1, {1, 1, 3, 1}), kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+
+  SetInput(0, {1, 2, 3});
+  SetInput(1, {4, 5, 6});
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  EXPECT_THAT(GetShape(2), ElementsAreArray({1, 1, 3, 1}));
+  EXPECT_THAT(GetOutput(2), ElementsAreArray({5, 7, 9}));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
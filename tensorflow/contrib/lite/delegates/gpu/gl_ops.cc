@@ -0,0 +1,464 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/delegates/gpu/gl_ops.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "tensorflow/contrib/lite/builtin_op_data.h"
+#include "tensorflow/contrib/lite/builtin_ops.h"
+
+namespace tflite {
+namespace gpu {
+namespace {
+
+// Work group sizes of the shaders computing one output pixel per invocation,
+// and of the element-wise shaders.
+constexpr int kPixelGroupSize = 8;
+constexpr int kElementGroupSize = 64;
+
+const TfLiteTensor& GetTensor(TfLiteContext* context, int tensor_index) {
+  return context->tensors[tensor_index];
+}
+
+bool IsFloat32(TfLiteContext* context, const TfLiteIntArray* tensors) {
+  for (int i = 0; i < tensors->size; ++i) {
+    if (tensors->data[i] == kOptionalTensor) return false;
+    const TfLiteTensor& tensor = GetTensor(context, tensors->data[i]);
+    if (tensor.type != kTfLiteFloat32 || tensor.dims == nullptr ||
+        tensor.allocation_type == kTfLiteDynamic) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsConstant(const TfLiteTensor& tensor) {
+  return tensor.allocation_type == kTfLiteMmapRo;
+}
+
+bool HasRank(const TfLiteTensor& tensor, int rank) {
+  return tensor.dims->size == rank;
+}
+
+bool IsActivationSupported(TfLiteFusedActivation activation) {
+  switch (activation) {
+    case kTfLiteActNone:
+    case kTfLiteActRelu:
+    case kTfLiteActRelu1:
+    case kTfLiteActRelu6:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the GLSL expression applying 'activation' to 'value'.
+std::string ActivationExpression(TfLiteFusedActivation activation,
+                                 const std::string& value) {
+  switch (activation) {
+    case kTfLiteActRelu:
+      return "max(" + value + ", 0.0)";
+    case kTfLiteActRelu1:
+      return "clamp(" + value + ", -1.0, 1.0)";
+    case kTfLiteActRelu6:
+      return "clamp(" + value + ", 0.0, 6.0)";
+    default:
+      return value;
+  }
+}
+
+int NumElements(const TfLiteTensor& tensor) {
+  int count = 1;
+  for (int i = 0; i < tensor.dims->size; ++i) {
+    count *= tensor.dims->data[i];
+  }
+  return count;
+}
+
+int DivideRoundUp(int n, int divisor) { return (n + divisor - 1) / divisor; }
+
+// Same as ComputeOutSize() and ComputePadding() in kernels/padding.h.
+int ComputeOutSize(TfLitePadding padding, int image_size, int filter_size,
+                   int stride, int dilation) {
+  int effective_filter_size = (filter_size - 1) * dilation + 1;
+  switch (padding) {
+    case kTfLitePaddingSame:
+      return (image_size + stride - 1) / stride;
+    case kTfLitePaddingValid:
+      return (image_size + stride - effective_filter_size) / stride;
+    default:
+      return 0;
+  }
+}
+
+int ComputePadding(int stride, int dilation, int in_size, int filter_size,
+                   int out_size) {
+  int effective_filter_size = (filter_size - 1) * dilation + 1;
+  int padding = ((out_size - 1) * stride + effective_filter_size - in_size) / 2;
+  return std::max(padding, 0);
+}
+
+TfLiteStatus ResizeOutput(TfLiteContext* context, int tensor_index,
+                          std::initializer_list<int> dims) {
+  TfLiteIntArray* shape = TfLiteIntArrayCreate(dims.size());
+  std::copy(dims.begin(), dims.end(), shape->data);
+  return context->ResizeTensor(context, &context->tensors[tensor_index],
+                               shape);
+}
+
+// The source shared by all shaders: version, work group size and one buffer
+// per tensor of the op, named input0, input1... and output0.
+std::string ShaderHeader(const GlOp& op, int group_size_x, int group_size_y) {
+  std::ostringstream source;
+  source << "#version 310 es\n"
+         << "layout(local_size_x = " << group_size_x
+         << ", local_size_y = " << group_size_y
+         << ", local_size_z = 1) in;\n";
+  int binding = 0;
+  for (int i = 0; i < op.inputs.size(); ++i) {
+    source << "layout(std430, binding = " << binding++
+           << ") readonly buffer Input" << i << " { float data[]; } input" << i
+           << ";\n";
+  }
+  for (int i = 0; i < op.outputs.size(); ++i) {
+    source << "layout(std430, binding = " << binding++
+           << ") writeonly buffer Output" << i << " { float data[]; } output"
+           << i << ";\n";
+  }
+  return source.str();
+}
+
+// Declares the given integer constants.
+std::string Constants(
+    std::initializer_list<std::pair<const char*, int>> constants) {
+  std::ostringstream source;
+  for (const auto& constant : constants) {
+    source << "const int " << constant.first << " = " << constant.second
+           << ";\n";
+  }
+  return source.str();
+}
+
+TfLiteStatus PrepareAdd(TfLiteContext* context, const GlNode& node, GlOp* op) {
+  const auto* params = static_cast<const TfLiteAddParams*>(node.builtin_data);
+  const TfLiteTensor& input = GetTensor(context, node.inputs[0]);
+  const TfLiteTensor& input2 = GetTensor(context, node.inputs[1]);
+  TF_LITE_ENSURE(context, TfLiteIntArrayEqual(input.dims, input2.dims));
+  TF_LITE_ENSURE_STATUS(context->ResizeTensor(
+      context, &context->tensors[node.outputs[0]],
+      TfLiteIntArrayCopy(input.dims)));
+
+  // Each invocation handles every n-th element, so that large tensors don't
+  // need more work groups than a dispatch allows.
+  const int size = NumElements(input);
+  const int work_groups =
+      std::min(DivideRoundUp(size, kElementGroupSize), kMaxWorkGroupCount);
+  op->shader_source =
+      ShaderHeader(*op, kElementGroupSize, 1) +
+      Constants({{"kSize", size},
+                 {"kStride", work_groups * kElementGroupSize}}) +
+      "void main() {\n"
+      "  for (int i = int(gl_GlobalInvocationID.x); i < kSize; i += kStride) "
+      "{\n"
+      "    float value = input0.data[i] + input1.data[i];\n"
+      "    output0.data[i] = " +
+      ActivationExpression(params->activation, "value") +
+      ";\n"
+      "  }\n"
+      "}\n";
+  op->work_groups[0] = work_groups;
+  op->work_groups[1] = 1;
+  op->work_groups[2] = 1;
+  return kTfLiteOk;
+}
+
+// Conv and depthwise conv share the same structure: one invocation computes
+// one output value, looping over the filter window.
+TfLiteStatus PrepareConv(TfLiteContext* context, const GlNode& node,
+                         bool depthwise, GlOp* op) {
+  TfLitePadding padding;
+  TfLiteFusedActivation activation;
+  int stride_width, stride_height;
+  int dilation_width = 1, dilation_height = 1;
+  if (depthwise) {
+    const auto* params =
+        static_cast<const TfLiteDepthwiseConvParams*>(node.builtin_data);
+    padding = params->padding;
+    activation = params->activation;
+    stride_width = params->stride_width;
+    stride_height = params->stride_height;
+  } else {
+    const auto* params =
+        static_cast<const TfLiteConvParams*>(node.builtin_data);
+    padding = params->padding;
+    activation = params->activation;
+    stride_width = params->stride_width;
+    stride_height = params->stride_height;
+    dilation_width = params->dilation_width_factor;
+    dilation_height = params->dilation_height_factor;
+  }
+
+  const TfLiteTensor& input = GetTensor(context, node.inputs[0]);
+  const TfLiteTensor& filter = GetTensor(context, node.inputs[1]);
+  const int batches = input.dims->data[0];
+  const int input_height = input.dims->data[1];
+  const int input_width = input.dims->data[2];
+  const int input_depth = input.dims->data[3];
+  const int filter_height = filter.dims->data[1];
+  const int filter_width = filter.dims->data[2];
+  // Conv filters are [output_depth, height, width, input_depth], depthwise
+  // ones [1, height, width, output_depth].
+  const int output_depth =
+      depthwise ? filter.dims->data[3] : filter.dims->data[0];
+  const int output_height = ComputeOutSize(padding, input_height, filter_height,
+                                           stride_height, dilation_height);
+  const int output_width = ComputeOutSize(padding, input_width, filter_width,
+                                          stride_width, dilation_width);
+  const int pad_height = ComputePadding(stride_height, dilation_height,
+                                        input_height, filter_height,
+                                        output_height);
+  const int pad_width = ComputePadding(stride_width, dilation_width,
+                                       input_width, filter_width, output_width);
+  TF_LITE_ENSURE_STATUS(
+      ResizeOutput(context, node.outputs[0],
+                   {batches, output_height, output_width, output_depth}));
+
+  std::string accumulate;
+  if (depthwise) {
+    accumulate =
+        "      acc += input0.data[in_base + oc / kDepthMultiplier] *\n"
+        "             input1.data[(fy * kFilterWidth + fx) * kOutputDepth + "
+        "oc];\n";
+  } else {
+    accumulate =
+        "      int f_base = ((oc * kFilterHeight + fy) * kFilterWidth + fx) *\n"
+        "                   kInputDepth;\n"
+        "      for (int ic = 0; ic < kInputDepth; ++ic) {\n"
+        "        acc += input0.data[in_base + ic] * input1.data[f_base + ic];\n"
+        "      }\n";
+  }
+  op->shader_source =
+      ShaderHeader(*op, kPixelGroupSize, kPixelGroupSize) +
+      Constants({{"kInputHeight", input_height},
+                 {"kInputWidth", input_width},
+                 {"kInputDepth", input_depth},
+                 {"kFilterHeight", filter_height},
+                 {"kFilterWidth", filter_width},
+                 {"kOutputHeight", output_height},
+                 {"kOutputWidth", output_width},
+                 {"kOutputDepth", output_depth},
+                 {"kDepthMultiplier", output_depth / input_depth},
+                 {"kStrideHeight", stride_height},
+                 {"kStrideWidth", stride_width},
+                 {"kDilationHeight", dilation_height},
+                 {"kDilationWidth", dilation_width},
+                 {"kPadHeight", pad_height},
+                 {"kPadWidth", pad_width}}) +
+      "void main() {\n"
+      "  int out_x = int(gl_GlobalInvocationID.x);\n"
+      "  int out_y = int(gl_GlobalInvocationID.y);\n"
+      "  if (out_x >= kOutputWidth || out_y >= kOutputHeight) return;\n"
+      "  int b = int(gl_GlobalInvocationID.z) / kOutputDepth;\n"
+      "  int oc = int(gl_GlobalInvocationID.z) % kOutputDepth;\n"
+      "  float acc = input2.data[oc];\n"
+      "  for (int fy = 0; fy < kFilterHeight; ++fy) {\n"
+      "    int in_y = out_y * kStrideHeight - kPadHeight + fy * "
+      "kDilationHeight;\n"
+      "    if (in_y < 0 || in_y >= kInputHeight) continue;\n"
+      "    for (int fx = 0; fx < kFilterWidth; ++fx) {\n"
+      "      int in_x = out_x * kStrideWidth - kPadWidth + fx * "
+      "kDilationWidth;\n"
+      "      if (in_x < 0 || in_x >= kInputWidth) continue;\n"
+      "      int in_base = ((b * kInputHeight + in_y) * kInputWidth + in_x) *\n"
+      "                    kInputDepth;\n" +
+      accumulate +
+      "    }\n"
+      "  }\n"
+      "  output0.data[((b * kOutputHeight + out_y) * kOutputWidth + out_x) *\n"
+      "               kOutputDepth + oc] = " +
+      ActivationExpression(activation, "acc") +
+      ";\n"
+      "}\n";
+  op->work_groups[0] = DivideRoundUp(output_width, kPixelGroupSize);
+  op->work_groups[1] = DivideRoundUp(output_height, kPixelGroupSize);
+  op->work_groups[2] = batches * output_depth;
+  return kTfLiteOk;
+}
+
+TfLiteStatus PreparePool(TfLiteContext* context, const GlNode& node,
+                         bool average, GlOp* op) {
+  const auto* params = static_cast<const TfLitePoolParams*>(node.builtin_data);
+  const TfLiteTensor& input = GetTensor(context, node.inputs[0]);
+  const int batches = input.dims->data[0];
+  const int input_height = input.dims->data[1];
+  const int input_width = input.dims->data[2];
+  const int depth = input.dims->data[3];
+  const int output_height =
+      ComputeOutSize(params->padding, input_height, params->filter_height,
+                     params->stride_height, 1);
+  const int output_width =
+      ComputeOutSize(params->padding, input_width, params->filter_width,
+                     params->stride_width, 1);
+  const int pad_height = ComputePadding(params->stride_height, 1, input_height,
+                                        params->filter_height, output_height);
+  const int pad_width = ComputePadding(params->stride_width, 1, input_width,
+                                       params->filter_width, output_width);
+  TF_LITE_ENSURE_STATUS(ResizeOutput(
+      context, node.outputs[0], {batches, output_height, output_width, depth}));
+
+  // As on the CPU, averages only count the values inside the image.
+  const std::string init = average ? "0.0" : "-3.402823466e+38";
+  const std::string update =
+      average ? "result += value; ++count;" : "result = max(result, value);";
+  const std::string result = average ? "result / float(count)" : "result";
+  op->shader_source =
+      ShaderHeader(*op, kPixelGroupSize, kPixelGroupSize) +
+      Constants({{"kInputHeight", input_height},
+                 {"kInputWidth", input_width},
+                 {"kDepth", depth},
+                 {"kFilterHeight", params->filter_height},
+                 {"kFilterWidth", params->filter_width},
+                 {"kOutputHeight", output_height},
+                 {"kOutputWidth", output_width},
+                 {"kStrideHeight", params->stride_height},
+                 {"kStrideWidth", params->stride_width},
+                 {"kPadHeight", pad_height},
+                 {"kPadWidth", pad_width}}) +
+      "void main() {\n"
+      "  int out_x = int(gl_GlobalInvocationID.x);\n"
+      "  int out_y = int(gl_GlobalInvocationID.y);\n"
+      "  if (out_x >= kOutputWidth || out_y >= kOutputHeight) return;\n"
+      "  int b = int(gl_GlobalInvocationID.z) / kDepth;\n"
+      "  int c = int(gl_GlobalInvocationID.z) % kDepth;\n"
+      "  float result = " +
+      init +
+      ";\n"
+      "  int count = 0;\n"
+      "  for (int fy = 0; fy < kFilterHeight; ++fy) {\n"
+      "    int in_y = out_y * kStrideHeight - kPadHeight + fy;\n"
+      "    if (in_y < 0 || in_y >= kInputHeight) continue;\n"
+      "    for (int fx = 0; fx < kFilterWidth; ++fx) {\n"
+      "      int in_x = out_x * kStrideWidth - kPadWidth + fx;\n"
+      "      if (in_x < 0 || in_x >= kInputWidth) continue;\n"
+      "      float value = input0.data[((b * kInputHeight + in_y) *\n"
+      "                                 kInputWidth + in_x) * kDepth + c];\n"
+      "      " +
+      update +
+      "\n"
+      "    }\n"
+      "  }\n"
+      "  float value = " +
+      result +
+      ";\n"
+      "  output0.data[((b * kOutputHeight + out_y) * kOutputWidth + out_x) *\n"
+      "               kDepth + c] = " +
+      ActivationExpression(params->activation, "value") +
+      ";\n"
+      "}\n";
+  op->work_groups[0] = DivideRoundUp(output_width, kPixelGroupSize);
+  op->work_groups[1] = DivideRoundUp(output_height, kPixelGroupSize);
+  op->work_groups[2] = batches * depth;
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+bool IsNodeSupported(TfLiteContext* context, const TfLiteNode& node,
+                     const TfLiteRegistration& registration) {
+  if (node.outputs->size != 1 || !IsFloat32(context, node.inputs) ||
+      !IsFloat32(context, node.outputs)) {
+    return false;
+  }
+  const TfLiteTensor& input = GetTensor(context, node.inputs->data[0]);
+  const TfLiteTensor& output = GetTensor(context, node.outputs->data[0]);
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinAdd: {
+      // Broadcasting is left to the CPU.
+      if (node.inputs->size != 2) return false;
+      const auto* params =
+          static_cast<const TfLiteAddParams*>(node.builtin_data);
+      const TfLiteTensor& input2 = GetTensor(context, node.inputs->data[1]);
+      return TfLiteIntArrayEqual(input.dims, input2.dims) &&
+             IsActivationSupported(params->activation);
+    }
+    case kTfLiteBuiltinConv2d:
+    case kTfLiteBuiltinDepthwiseConv2d: {
+      if (node.inputs->size != 3 || !HasRank(input, 4) ||
+          !HasRank(output, 4)) {
+        return false;
+      }
+      const TfLiteTensor& filter = GetTensor(context, node.inputs->data[1]);
+      const TfLiteTensor& bias = GetTensor(context, node.inputs->data[2]);
+      if (!IsConstant(filter) || !IsConstant(bias) || !HasRank(filter, 4)) {
+        return false;
+      }
+      // One work group is dispatched per output channel in the z dimension.
+      const int output_depth = output.dims->data[3];
+      if (output.dims->data[0] * output_depth > kMaxWorkGroupCount) {
+        return false;
+      }
+      if (registration.builtin_code == kTfLiteBuiltinConv2d) {
+        const auto* params =
+            static_cast<const TfLiteConvParams*>(node.builtin_data);
+        return filter.dims->data[3] == input.dims->data[3] &&
+               IsActivationSupported(params->activation);
+      }
+      const auto* params =
+          static_cast<const TfLiteDepthwiseConvParams*>(node.builtin_data);
+      return filter.dims->data[0] == 1 &&
+             filter.dims->data[3] == output_depth &&
+             output_depth == input.dims->data[3] * params->depth_multiplier &&
+             IsActivationSupported(params->activation);
+    }
+    case kTfLiteBuiltinAveragePool2d:
+    case kTfLiteBuiltinMaxPool2d: {
+      const auto* params =
+          static_cast<const TfLitePoolParams*>(node.builtin_data);
+      return node.inputs->size == 1 && HasRank(input, 4) &&
+             HasRank(output, 4) &&
+             output.dims->data[0] * output.dims->data[3] <=
+                 kMaxWorkGroupCount &&
+             IsActivationSupported(params->activation);
+    }
+    default:
+      return false;
+  }
+}
+
+TfLiteStatus PrepareGlOp(TfLiteContext* context, const GlNode& node,
+                         GlOp* op) {
+  op->inputs = node.inputs;
+  op->outputs = node.outputs;
+  switch (node.builtin_code) {
+    case kTfLiteBuiltinAdd:
+      return PrepareAdd(context, node, op);
+    case kTfLiteBuiltinConv2d:
+      return PrepareConv(context, node, /*depthwise=*/false, op);
+    case kTfLiteBuiltinDepthwiseConv2d:
+      return PrepareConv(context, node, /*depthwise=*/true, op);
+    case kTfLiteBuiltinAveragePool2d:
+      return PreparePool(context, node, /*average=*/true, op);
+    case kTfLiteBuiltinMaxPool2d:
+      return PreparePool(context, node, /*average=*/false, op);
+    default:
+      context->ReportError(context, "Op %d is not supported by the GPU.",
+                           node.builtin_code);
+      return kTfLiteError;
+  }
+}
+
+}  // namespace gpu
+}  // namespace tflite
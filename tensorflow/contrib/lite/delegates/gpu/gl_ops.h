@@ -0,0 +1,64 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_DELEGATES_GPU_GL_OPS_H_
+#define TENSORFLOW_CONTRIB_LITE_DELEGATES_GPU_GL_OPS_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/context.h"
+
+namespace tflite {
+namespace gpu {
+
+// The largest number of work groups that OpenGL ES 3.1 guarantees in each
+// dimension of a dispatch.
+constexpr int kMaxWorkGroupCount = 65535;
+
+// A node of the graph, as seen by the GPU delegate.
+struct GlNode {
+  int builtin_code;
+  const void* builtin_data;
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+};
+
+// A compute shader running one node. It reads one shader storage buffer per
+// tensor in 'inputs' and writes one per tensor in 'outputs', bound in that
+// order starting at binding 0. All tensors are float32 in the same layout as
+// on the CPU (NHWC for 4D tensors).
+struct GlOp {
+  std::string shader_source;
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+  // Number of work groups to dispatch in the x, y and z dimensions.
+  int work_groups[3];
+};
+
+// Returns true if the node can run on the GPU, given the current shapes of its
+// tensors. All tensors must be float32, and the weights of convolutions
+// constant.
+bool IsNodeSupported(TfLiteContext* context, const TfLiteNode& node,
+                     const TfLiteRegistration& registration);
+
+// Resizes the outputs of a supported node to match its inputs, and creates
+// the compute shader running it.
+TfLiteStatus PrepareGlOp(TfLiteContext* context, const GlNode& node,
+                         GlOp* op);
+
+}  // namespace gpu
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_DELEGATES_GPU_GL_OPS_H_
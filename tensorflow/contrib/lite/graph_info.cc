@@ -221,4 +221,43 @@ TfLiteStatus PartitionGraphIntoIndependentSubgraphs(
   return kTfLiteOk;
 }
 
+void OrderGraphIntoConcurrentGroups(const GraphInfo* info, int max_group_size,
+                                    std::vector<int>* order,
+                                    std::vector<int>* group_sizes) {
+  // A node goes one level after the deepest of the nodes producing its inputs,
+  // so nodes on the same level never depend on each other.
+  std::vector<int> tensor_levels(info->num_tensors(), -1);
+  std::vector<int> node_levels(info->num_nodes());
+  for (int node_index = 0; node_index < info->num_nodes(); node_index++) {
+    const TfLiteNode& node = info->node(node_index);
+    int level = 0;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index != kOptionalTensor) {
+        level = std::max(level, tensor_levels[tensor_index] + 1);
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      tensor_levels[tensor_index] = level;
+    }
+    node_levels[node_index] = level;
+  }
+
+  order->resize(info->num_nodes());
+  for (int node_index = 0; node_index < info->num_nodes(); node_index++) {
+    (*order)[node_index] = node_index;
+  }
+  std::stable_sort(order->begin(), order->end(), [&node_levels](int a, int b) {
+    return node_levels[a] < node_levels[b];
+  });
+
+  group_sizes->clear();
+  for (int i = 0; i < order->size(); i++) {
+    if (i == 0 || group_sizes->back() >= max_group_size ||
+        node_levels[(*order)[i]] != node_levels[(*order)[i - 1]]) {
+      group_sizes->push_back(0);
+    }
+    group_sizes->back()++;
+  }
+}
+
 }  // namespace tflite
@@ -74,6 +74,16 @@ TfLiteStatus PartitionGraphIntoIndependentSubgraphs(
     const GraphInfo* info, const TfLiteIntArray* nodes_to_partition,
     std::vector<Subgraph>* subgraphs);
 
+// Reorders the nodes of `info`, which are expected to be in dependency order,
+// so that nodes that do not depend on each other come next to each other.
+// `order` is filled with the new order of the node indices, which is still a
+// dependency order, and `group_sizes` with the sizes of the groups of
+// consecutive nodes in `order` that can run concurrently. A group never has
+// more than `max_group_size` nodes.
+void OrderGraphIntoConcurrentGroups(const GraphInfo* info, int max_group_size,
+                                    std::vector<int>* order,
+                                    std::vector<int>* group_sizes);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_CONTRIB_LITE_GRAPH_INFO_H_
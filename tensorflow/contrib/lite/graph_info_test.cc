@@ -260,6 +260,39 @@ TEST(PartitionTest, Nodes3PartitionNodes2) {
       {expected_subgraph0, expected_subgraph1, expected_subgraph2});
 }
 
+// Test ordering two chains, node(0) -> node(1) and node(2) -> node(3), that
+// are listed one after the other.
+TEST(OrderTest, IndependentChainsAreInterleaved) {
+  SimpleTestGraph graph;
+  graph.AddTensors(6);
+  graph.AddNode({0}, {1});
+  graph.AddNode({1}, {2});
+  graph.AddNode({0}, {3});
+  graph.AddNode({3}, {4});
+  graph.AddNode({2, 4}, {5});
+  graph.SetInputsAndOutputs({0}, {5});
+  std::vector<int> order;
+  std::vector<int> group_sizes;
+  OrderGraphIntoConcurrentGroups(&graph, 4, &order, &group_sizes);
+  EXPECT_EQ(order, std::vector<int>({0, 2, 1, 3, 4}));
+  EXPECT_EQ(group_sizes, std::vector<int>({2, 2, 1}));
+}
+
+// Test that groups don't grow beyond the requested size.
+TEST(OrderTest, GroupsAreCapped) {
+  SimpleTestGraph graph;
+  graph.AddTensors(4);
+  graph.AddNode({0}, {1});
+  graph.AddNode({0}, {2});
+  graph.AddNode({0}, {3});
+  graph.SetInputsAndOutputs({0}, {1, 2, 3});
+  std::vector<int> order;
+  std::vector<int> group_sizes;
+  OrderGraphIntoConcurrentGroups(&graph, 2, &order, &group_sizes);
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2}));
+  EXPECT_EQ(group_sizes, std::vector<int>({2, 1}));
+}
+
 }  // namespace
 }  // namespace tflite
 
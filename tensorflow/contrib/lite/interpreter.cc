@@ -19,13 +19,12 @@ limitations under the License.
 #include <cstdarg>
 #include <cstdint>
 #include <cstring>
+#include <thread>  // NOLINT(build/c++11)
 
 #include "tensorflow/contrib/lite/arena_planner.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/error_reporter.h"
 #include "tensorflow/contrib/lite/graph_info.h"
-#include "tensorflow/contrib/lite/kernels/eigen_support.h"
-#include "tensorflow/contrib/lite/kernels/gemm_support.h"
 #include "tensorflow/contrib/lite/memory_planner.h"
 #include "tensorflow/contrib/lite/nnapi_delegate.h"
 #include "tensorflow/contrib/lite/profiling/profiler.h"
@@ -96,9 +95,12 @@ Interpreter::Interpreter(ErrorReporter* error_reporter)
   context_.AddTensors = AddTensors;
   context_.tensors = nullptr;
   context_.tensors_size = 0;
-  context_.eigen_context = nullptr;
-  context_.gemm_context = nullptr;
   context_.recommended_num_threads = -1;
+  context_.GetExternalContext = GetExternalContext;
+  context_.SetExternalContext = SetExternalContext;
+  for (int i = 0; i < kTfLiteMaxExternalContexts; ++i) {
+    external_contexts_[i] = nullptr;
+  }
 
   // Invalid to call these these except from TfLiteDelegate
   SetForbiddenContextFunction(&context_.GetNodeAndRegistration);
@@ -228,6 +230,7 @@ TfLiteStatus Interpreter::ReplaceSubgraphsWithDelegateKernels(
   PartitionGraphIntoIndependentSubgraphs(&info, nodes_to_replace, &subgraphs);
 
   execution_plan_.clear();
+  concurrent_group_ends_.clear();
   for (auto& subgraph : subgraphs) {
     // Subgraphs calimed by the delegate should have a "macro" op created, the
     // other subgraphs (kTfNonPartition) just have their nodes added back to
@@ -263,6 +266,9 @@ TfLiteStatus Interpreter::ReplaceSubgraphsWithDelegateKernels(
         break;
     }
   }
+  // A memory plan made by an earlier AllocateTensors() refers to the nodes
+  // that were just replaced, so it is made again for the new execution plan.
+  memory_planner_.reset();
   return kTfLiteOk;
 }
 
@@ -346,10 +352,13 @@ TfLiteStatus Interpreter::BytesRequired(TfLiteType type, const int* dims,
     case kTfLiteBool:
       *bytes = sizeof(bool) * count;
       break;
+    case kTfLiteInt8:
+      *bytes = sizeof(int8_t) * count;
+      break;
     default:
       ReportError(
           &context_,
-          "Only float32, int32, int64, uint8, bool supported currently.");
+          "Only float32, int32, int64, uint8, int8, bool supported currently.");
       return kTfLiteError;
   }
   return kTfLiteOk;
@@ -385,6 +394,7 @@ TfLiteStatus Interpreter::AddNodeWithParameters(
     return kTfLiteError;
   }
   state_ = kStateUninvokable;
+  InvalidatePreparedNodes();
 
   std::unique_ptr<void, decltype(free)*> builtin_data_deleter(builtin_data,
                                                               free);
@@ -445,16 +455,36 @@ TfLiteStatus Interpreter::ResizeInputTensor(int tensor_index,
                 "ResizeInputTensor is disallowed when graph is immutable.");
     return kTfLiteError;
   }
-  state_ = kStateUninvokable;
 
   // TODO(aselle): All bounds checks can be implemented as one-sided bounds
   // checks by casting to unsigned for efficiency. Profile before doing this.
   TF_LITE_ENSURE(&context_,
                  tensor_index < context_.tensors_size && tensor_index >= 0);
+  const TfLiteTensor& tensor = context_.tensors[tensor_index];
+  if (tensor.allocation_type == kTfLiteArenaRw &&
+      EqualArrayAndTfLiteIntArray(tensor.dims, dims.size(), dims.data())) {
+    // Nothing to re-plan, e.g. for models fed inputs of a fixed size.
+    return kTfLiteOk;
+  }
+  state_ = kStateUninvokable;
   TfLiteIntArray* dims_lite = ConvertVectorToTfLiteIntArray(dims);
   return ResizeTensorImpl(&context_.tensors[tensor_index], dims_lite);
 }
 
+TfLiteStatus Interpreter::ResizeInputBatch(int batch_size) {
+  TF_LITE_ENSURE(&context_, batch_size > 0);
+  for (int tensor_index : inputs_) {
+    if (tensor_index == kOptionalTensor) continue;
+    const TfLiteTensor& tensor = context_.tensors[tensor_index];
+    if (!tensor.dims || tensor.dims->size == 0) continue;
+    std::vector<int> dims(tensor.dims->data,
+                          tensor.dims->data + tensor.dims->size);
+    dims[0] = batch_size;
+    TF_LITE_ENSURE_OK(&context_, ResizeInputTensor(tensor_index, dims));
+  }
+  return kTfLiteOk;
+}
+
 // Returns true if at least one tensor in the given list is kTfLiteDynamic.
 bool HasDynamicTensor(const TfLiteContext& context,
                       const TfLiteIntArray* tensors) {
@@ -476,8 +506,13 @@ TfLiteStatus Interpreter::PrepareOpsStartingAt(
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
     EnsureTensorsVectorCapacity();
-    if (OpPrepare(registration, &node) == kTfLiteError) {
-      return kTfLiteError;
+    if (NodeNeedsPrepare(node_index)) {
+      node_prepared_at_.resize(nodes_size(), -1);
+      node_prepared_at_[node_index] = -1;
+      if (OpPrepare(registration, &node) == kTfLiteError) {
+        return kTfLiteError;
+      }
+      node_prepared_at_[node_index] = shape_change_count_;
     }
 
     *last_execution_plan_index_prepared = execution_plan_index;
@@ -492,10 +527,49 @@ TfLiteStatus Interpreter::PrepareOpsStartingAt(
   return kTfLiteOk;
 }
 
+bool Interpreter::NodeNeedsPrepare(int node_index) const {
+  if (node_index >= node_prepared_at_.size() ||
+      node_prepared_at_[node_index] < 0) {
+    return true;
+  }
+  const int64_t prepared_at = node_prepared_at_[node_index];
+  auto shape_changed = [&](const TfLiteIntArray* tensors) {
+    for (int i = 0; i < tensors->size; ++i) {
+      int tensor_index = tensors->data[i];
+      if (tensor_index != kOptionalTensor &&
+          tensor_index < tensor_shape_changes_.size() &&
+          tensor_shape_changes_[tensor_index] > prepared_at) {
+        return true;
+      }
+    }
+    return false;
+  };
+  const TfLiteNode& node = nodes_and_registration_[node_index].first;
+  return shape_changed(node.inputs) || shape_changed(node.outputs);
+}
+
+void Interpreter::TensorShapeChanged(int tensor_index) {
+  if (tensor_index >= tensor_shape_changes_.size()) {
+    tensor_shape_changes_.resize(tensors_size(), 0);
+  }
+  tensor_shape_changes_[tensor_index] = ++shape_change_count_;
+}
+
 TfLiteStatus Interpreter::PrepareOpsAndTensors() {
   if (!memory_planner_) {
-    memory_planner_.reset(new ArenaPlanner(
-        &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this))));
+    ArenaPlanner* planner = new ArenaPlanner(
+        &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)));
+    memory_planner_.reset(planner);
+    if (parallel_node_execution_ &&
+        next_execution_plan_index_to_prepare_ == 0) {
+      std::vector<int> group_sizes;
+      PlanConcurrentExecution(&group_sizes);
+      planner->SetConcurrentGroups(group_sizes);
+    }
+    planner->SetGreedyBySizeAllocation(greedy_by_size_arena_planning_);
+    if (arena_buffer_ != nullptr) {
+      planner->SetExternalBuffer(arena_buffer_, arena_buffer_size_);
+    }
     memory_planner_->PlanAllocations();
   }
 
@@ -549,28 +623,27 @@ TfLiteStatus Interpreter::Invoke() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+    if (execution_plan_index < concurrent_group_ends_.size()) {
+      int last_execution_plan_index =
+          concurrent_group_ends_[execution_plan_index];
+      if (CanInvokeConcurrently(execution_plan_index,
+                                last_execution_plan_index)) {
+        if (InvokeConcurrently(execution_plan_index,
+                               last_execution_plan_index) == kTfLiteError) {
+          status = kTfLiteError;
+        }
+        execution_plan_index = last_execution_plan_index;
+        continue;
+      }
+    }
+
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
     SCOPED_OPERATOR_PROFILE(profiler_, node_index);
 
-    // TODO(ycling): This is an extra loop through inputs to check if the data
-    // need to be copied from Delegate buffer to raw memory, which is often not
-    // needed. We may want to cache this in prepare to know if this needs to be
-    // done for a node or not.
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        EnsureTensorDataIsReadable(tensor_index);
-      }
-    }
-
+    EnsureInputDataIsReadable(node);
     EnsureTensorsVectorCapacity();
     if (OpInvoke(registration, &node) == kTfLiteError) {
       status = kTfLiteError;
@@ -586,6 +659,103 @@ TfLiteStatus Interpreter::Invoke() {
   return status;
 }
 
+void Interpreter::EnsureInputDataIsReadable(const TfLiteNode& node) {
+  // TODO(ycling): This is an extra loop through inputs to check if the data
+  // need to be copied from Delegate buffer to raw memory, which is often not
+  // needed. We may want to cache this in prepare to know if this needs to be
+  // done for a node or not.
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      EnsureTensorDataIsReadable(tensor_index);
+    }
+  }
+}
+
+void Interpreter::PlanConcurrentExecution(std::vector<int>* group_sizes) {
+  int num_threads = context_.recommended_num_threads;
+  if (num_threads == -1) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  concurrent_group_ends_.clear();
+  group_sizes->clear();
+  if (num_threads <= 1) {
+    thread_pool_.reset();
+    return;
+  }
+
+  // Groups are capped at the number of threads, since larger ones would not
+  // run faster but would keep more tensors alive at once.
+  InterpreterInfo info(this);
+  std::vector<int> order;
+  OrderGraphIntoConcurrentGroups(&info, num_threads, &order, group_sizes);
+  std::vector<int> execution_plan;
+  execution_plan.reserve(order.size());
+  for (int execution_plan_index : order) {
+    execution_plan.push_back(execution_plan_[execution_plan_index]);
+  }
+  execution_plan_.swap(execution_plan);
+
+  for (int group_size : *group_sizes) {
+    int last_execution_plan_index =
+        concurrent_group_ends_.size() + group_size - 1;
+    concurrent_group_ends_.insert(concurrent_group_ends_.end(), group_size,
+                                  last_execution_plan_index);
+  }
+  thread_pool_.reset(new ThreadPool(num_threads - 1));
+}
+
+bool Interpreter::CanInvokeConcurrently(int first_execution_plan_index,
+                                        int last_execution_plan_index) {
+  // The profiler records events from a single thread, and nodes that are not
+  // prepared yet may still resize tensors of the other nodes.
+  if (first_execution_plan_index == last_execution_plan_index ||
+      !thread_pool_ || profiler_ != nullptr ||
+      last_execution_plan_index >= next_execution_plan_index_to_prepare_) {
+    return false;
+  }
+  for (int execution_plan_index = first_execution_plan_index;
+       execution_plan_index <= last_execution_plan_index;
+       execution_plan_index++) {
+    const TfLiteNode& node =
+        nodes_and_registration_[execution_plan_[execution_plan_index]].first;
+    if (node.delegate != nullptr || HasDynamicTensor(context_, node.outputs) ||
+        HasDynamicTensor(context_, node.temporaries)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TfLiteStatus Interpreter::InvokeConcurrently(int first_execution_plan_index,
+                                             int last_execution_plan_index) {
+  for (int execution_plan_index = first_execution_plan_index;
+       execution_plan_index <= last_execution_plan_index;
+       execution_plan_index++) {
+    int node_index = execution_plan_[execution_plan_index];
+    EnsureInputDataIsReadable(nodes_and_registration_[node_index].first);
+  }
+  EnsureTensorsVectorCapacity();
+
+  int num_nodes = last_execution_plan_index - first_execution_plan_index + 1;
+  std::vector<TfLiteStatus> statuses(num_nodes, kTfLiteOk);
+  thread_pool_->ParallelFor(num_nodes, [&](int i) {
+    int node_index = execution_plan_[first_execution_plan_index + i];
+    statuses[i] = OpInvoke(nodes_and_registration_[node_index].second,
+                           &nodes_and_registration_[node_index].first);
+  });
+
+  for (TfLiteStatus status : statuses) {
+    if (status == kTfLiteError) return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::ResizeTensor(TfLiteContext* context,
                                        TfLiteTensor* tensor,
                                        TfLiteIntArray* new_size) {
@@ -672,15 +842,89 @@ TfLiteStatus Interpreter::SetTensorParametersReadOnly(
                       BytesRequired(type, dims, rank, &required_bytes));
     TF_LITE_ENSURE_EQ(&context_, required_bytes, bytes);
   }
+  SetReadOnlyBuffer(tensor_index, type, name, rank, dims, quantization, buffer,
+                    bytes, allocation);
+  return kTfLiteOk;
+}
 
+TfLiteStatus Interpreter::SetTensorParametersReadOnlySparse(
+    int tensor_index, TfLiteType type, const char* name,
+    const std::vector<int>& dims, TfLiteQuantizationParams quantization,
+    int block_rows, int block_cols, const std::vector<int>& block_row_offsets,
+    const std::vector<int>& block_col_indices, const char* buffer,
+    size_t bytes, const Allocation* allocation) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(&context_,
+                "SetTensorParametersReadOnlySparse is disallowed when graph is "
+                "immutable.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE(&context_,
+                 tensor_index < context_.tensors_size && tensor_index >= 0);
+  TF_LITE_ENSURE(&context_, type != kTfLiteString);
+  TF_LITE_ENSURE_EQ(&context_, dims.size(), 2);
+  TF_LITE_ENSURE(&context_, block_rows > 0 && block_cols > 0);
+  TF_LITE_ENSURE_EQ(&context_, dims[0] % block_rows, 0);
+  TF_LITE_ENSURE_EQ(&context_, dims[1] % block_cols, 0);
+
+  // The blocks of each row of blocks must be a contiguous range of the stored
+  // blocks, each in a valid column of blocks.
+  const int num_block_rows = dims[0] / block_rows;
+  const int num_block_cols = dims[1] / block_cols;
+  TF_LITE_ENSURE_EQ(&context_, block_row_offsets.size(), num_block_rows + 1);
+  TF_LITE_ENSURE_EQ(&context_, block_row_offsets[0], 0);
+  for (int r = 0; r < num_block_rows; ++r) {
+    TF_LITE_ENSURE(&context_, block_row_offsets[r] <= block_row_offsets[r + 1]);
+  }
+  const int num_blocks = block_row_offsets[num_block_rows];
+  TF_LITE_ENSURE_EQ(&context_, block_col_indices.size(), num_blocks);
+  for (int col : block_col_indices) {
+    TF_LITE_ENSURE(&context_, col >= 0 && col < num_block_cols);
+  }
+
+  const int block_dims[] = {num_blocks, block_rows * block_cols};
+  size_t required_bytes;
+  TF_LITE_ENSURE_OK(&context_,
+                    BytesRequired(type, block_dims, 2, &required_bytes));
+  TF_LITE_ENSURE_EQ(&context_, required_bytes, bytes);
+
+  SetReadOnlyBuffer(tensor_index, type, name, dims.size(), dims.data(),
+                    quantization, buffer, bytes, allocation);
+  auto* sparsity = static_cast<TfLiteSparsity*>(malloc(sizeof(TfLiteSparsity)));
+  sparsity->block_rows = block_rows;
+  sparsity->block_cols = block_cols;
+  sparsity->block_row_offsets =
+      ConvertVectorToTfLiteIntArray(block_row_offsets);
+  sparsity->block_col_indices =
+      ConvertVectorToTfLiteIntArray(block_col_indices);
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  tensor.sparsity = sparsity;
+  // Kernels pick their implementation from the layout when they are prepared.
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+void Interpreter::SetReadOnlyBuffer(int tensor_index, TfLiteType type,
+                                    const char* name, const size_t rank,
+                                    const int* dims,
+                                    TfLiteQuantizationParams quantization,
+                                    const char* buffer, size_t bytes,
+                                    const Allocation* allocation) {
+  // Kernels may read constant tensors when they are prepared.
+  InvalidatePreparedNodes();
   TfLiteTensor& tensor = context_.tensors[tensor_index];
   if (type == tensor.type &&
       EqualArrayAndTfLiteIntArray(tensor.dims, rank, dims)) {
     // Fast path which does not invalidate the invokable property.
     TfLiteTensorDataFree(&tensor);
     tensor.data.raw = const_cast<char*>(buffer);
+    tensor.bytes = bytes;
     if (!tensor.dims) tensor.dims = ConvertArrayToTfLiteIntArray(rank, dims);
     tensor.params = quantization;
+    TfLiteChannelQuantizationFree(tensor.channel_params);
+    tensor.channel_params = nullptr;
+    TfLiteSparsityFree(tensor.sparsity);
+    tensor.sparsity = nullptr;
     tensor.allocation_type = kTfLiteMmapRo;
     tensor.allocation = allocation;
   } else {
@@ -689,7 +933,6 @@ TfLiteStatus Interpreter::SetTensorParametersReadOnly(
                       quantization, const_cast<char*>(buffer), bytes,
                       kTfLiteMmapRo, allocation, &tensor);
   }
-  return kTfLiteOk;
 }
 
 // Set description of inputs/outputs/data/fptrs for node `node_index`.
@@ -716,6 +959,7 @@ TfLiteStatus Interpreter::SetTensorParametersReadWrite(
     TF_LITE_ENSURE_OK(&context_,
                       BytesRequired(type, dims, rank, &required_bytes));
   }
+  InvalidatePreparedNodes();
   TfLiteTensorReset(type, name, ConvertArrayToTfLiteIntArray(rank, dims),
                     quantization,
                     /*buffer=*/nullptr, required_bytes,
@@ -724,11 +968,48 @@ TfLiteStatus Interpreter::SetTensorParametersReadWrite(
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::SetTensorChannelQuantization(
+    int tensor_index, const std::vector<float>& scales,
+    const std::vector<int32_t>& zero_points, int quantized_dimension) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(
+        &context_,
+        "SetTensorChannelQuantization is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE(&context_,
+                 tensor_index < context_.tensors_size && tensor_index >= 0);
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  TF_LITE_ENSURE(&context_, tensor.dims != nullptr);
+  TF_LITE_ENSURE(&context_, quantized_dimension >= 0 &&
+                                quantized_dimension < tensor.dims->size);
+  TF_LITE_ENSURE_EQ(&context_, scales.size(),
+                    tensor.dims->data[quantized_dimension]);
+  TF_LITE_ENSURE_EQ(&context_, zero_points.size(), scales.size());
+
+  auto* channel_params = static_cast<TfLiteChannelQuantization*>(
+      malloc(sizeof(TfLiteChannelQuantization)));
+  channel_params->scale = TfLiteFloatArrayCreate(scales.size());
+  channel_params->zero_point = TfLiteIntArrayCreate(zero_points.size());
+  for (int i = 0; i < scales.size(); ++i) {
+    channel_params->scale->data[i] = scales[i];
+    channel_params->zero_point->data[i] = zero_points[i];
+  }
+  channel_params->quantized_dimension = quantized_dimension;
+  TfLiteChannelQuantizationFree(tensor.channel_params);
+  tensor.channel_params = channel_params;
+  // Kernels read the quantization parameters when they are prepared.
+  state_ = kStateUninvokable;
+  InvalidatePreparedNodes();
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::SetExecutionPlan(const std::vector<int>& new_plan) {
   for (int node_index : new_plan) {
     TF_LITE_ENSURE(&context_, node_index >= 0 && node_index < nodes_size());
   }
   execution_plan_ = new_plan;
+  InvalidatePreparedNodes();
   return kTfLiteOk;
 }
 
@@ -737,6 +1018,10 @@ TfLiteStatus Interpreter::ResizeTensorImpl(TfLiteTensor* tensor,
   // Note that in theory we could resize kTfLiteArenaRwPersistent tensors too.
   if (tensor->allocation_type == kTfLiteArenaRw ||
       tensor->allocation_type == kTfLiteDynamic) {
+    if (!EqualArrayAndTfLiteIntArray(tensor->dims, new_size->size,
+                                     new_size->data)) {
+      TensorShapeChanged(tensor - context_.tensors);
+    }
     if (tensor->type != kTfLiteString) {
       size_t bytesRequired;
       TfLiteStatus status = BytesRequired(tensor->type, new_size->data,
@@ -780,11 +1065,85 @@ void Interpreter::UseNNAPI(bool enable) {
 
 void Interpreter::SetNumThreads(int num_threads) {
   context_.recommended_num_threads = num_threads;
+  InvalidatePreparedNodes();
+
+  for (int i = 0; i < kTfLiteMaxExternalContexts; ++i) {
+    TfLiteExternalContext* ctx = external_contexts_[i];
+    if (ctx && ctx->Refresh) {
+      ctx->Refresh(&context_);
+    }
+  }
+}
+
+void Interpreter::SetExternalContext(TfLiteExternalContextType type,
+                                     TfLiteExternalContext* ctx) {
+  if (type >= 0 && type < kTfLiteMaxExternalContexts) {
+    external_contexts_[type] = ctx;
+    InvalidatePreparedNodes();
+  }
+}
+
+TfLiteExternalContext* Interpreter::GetExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  if (type < 0 || type >= kTfLiteMaxExternalContexts) return nullptr;
+  return static_cast<Interpreter*>(context->impl_)->external_contexts_[type];
+}
+
+void Interpreter::SetExternalContext(struct TfLiteContext* context,
+                                     TfLiteExternalContextType type,
+                                     TfLiteExternalContext* ctx) {
+  static_cast<Interpreter*>(context->impl_)->SetExternalContext(type, ctx);
+}
+
+TfLiteStatus Interpreter::UseParallelNodeExecution(bool enable) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(&context_,
+                "UseParallelNodeExecution is disallowed when graph is "
+                "immutable.");
+    return kTfLiteError;
+  }
+  if (enable == parallel_node_execution_) return kTfLiteOk;
+  parallel_node_execution_ = enable;
+
+  // The memory plan depends on which nodes may run concurrently, so it is
+  // redone by the next AllocateTensors().
+  memory_planner_.reset();
+  concurrent_group_ends_.clear();
+  thread_pool_.reset();
+  state_ = kStateUninvokable;
+  InvalidatePreparedNodes();
+  return kTfLiteOk;
+}
 
-  // TODO(ahentz): find a way to avoid this. It causes gemmlowp and eigen to
-  // be required in order to compile the framework.
-  gemm_support::SetNumThreads(&context_, num_threads);
-  eigen_support::SetNumThreads(&context_, num_threads);
+TfLiteStatus Interpreter::UseGreedyBySizeArenaPlanning(bool enable) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(&context_,
+                "UseGreedyBySizeArenaPlanning is disallowed when graph is "
+                "immutable.");
+    return kTfLiteError;
+  }
+  if (enable == greedy_by_size_arena_planning_) return kTfLiteOk;
+  greedy_by_size_arena_planning_ = enable;
+
+  // The planner is created again by the next AllocateTensors().
+  memory_planner_.reset();
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::SetArenaBuffer(char* buffer, size_t size) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(&context_,
+                "SetArenaBuffer is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  arena_buffer_ = buffer;
+  arena_buffer_size_ = size;
+
+  // The planner is created again by the next AllocateTensors().
+  memory_planner_.reset();
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
 }
 
 TfLiteStatus Interpreter::ModifyGraphWithDelegate(TfLiteDelegate* delegate,
@@ -826,6 +1185,7 @@ TfLiteStatus Interpreter::ModifyGraphWithDelegate(TfLiteDelegate* delegate,
   SetForbiddenContextFunction(&context_.GetExecutionPlan);
 
   TF_LITE_ENSURE_OK(&context_, status);
+  InvalidatePreparedNodes();
 
   if (!allow_dynamic_tensors) {
     TF_LITE_ENSURE_OK(&context_, AllocateTensors());
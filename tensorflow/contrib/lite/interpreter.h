@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/error_reporter.h"
 #include "tensorflow/contrib/lite/memory_planner.h"
 #include "tensorflow/contrib/lite/profiling/profiler.h"
+#include "tensorflow/contrib/lite/thread_pool.h"
 
 namespace tflite {
 
@@ -54,6 +55,10 @@ template <>
 constexpr TfLiteType typeToTfLiteType<bool>() {
   return kTfLiteBool;
 }
+template <>
+constexpr TfLiteType typeToTfLiteType<int8_t>() {
+  return kTfLiteInt8;
+}
 
 // Forward declare since NNAPIDelegate uses Interpreter.
 class NNAPIDelegate;
@@ -154,6 +159,17 @@ class Interpreter {
       const int* dims, TfLiteQuantizationParams quantization,
       const char* buffer, size_t bytes, const Allocation* allocation = nullptr);
 
+  // Like SetTensorParametersReadOnly, for a 2D tensor whose `buffer` only
+  // holds the stored blocks of a block-sparse layout (see TfLiteSparsity).
+  // `dims` are those of the dense tensor.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetTensorParametersReadOnlySparse(
+      int tensor_index, TfLiteType type, const char* name,
+      const std::vector<int>& dims, TfLiteQuantizationParams quantization,
+      int block_rows, int block_cols, const std::vector<int>& block_row_offsets,
+      const std::vector<int>& block_col_indices, const char* buffer,
+      size_t bytes, const Allocation* allocation = nullptr);
+
   // Set description of inputs/outputs/data/fptrs for node `node_index`.
   // This variant assumes an external buffer has been allocated of size
   // bytes. The lifetime of buffer must be ensured to be greater or equal
@@ -168,6 +184,14 @@ class Interpreter {
       int tensor_index, TfLiteType type, const char* name, const size_t rank,
       const int* dims, TfLiteQuantizationParams quantization);
 
+  // Gives tensor `tensor_index` one scale and zero point per index along
+  // `quantized_dimension`, in place of its per-tensor quantization. Must be
+  // called after the tensor's parameters have been set, since those reset it.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetTensorChannelQuantization(
+      int tensor_index, const std::vector<float>& scales,
+      const std::vector<int32_t>& zero_points, int quantized_dimension);
+
   // Functions to access tensor data
 
   // Read only access to list of inputs.
@@ -278,7 +302,8 @@ class Interpreter {
   }
 
   // Change the dimensionality of a given tensor. Note, this is only acceptable
-  // for tensor indices that are inputs.
+  // for tensor indices that are inputs. Resizing an arena tensor to its
+  // current dimensions is a no-op, and doesn't require AllocateTensors().
   // Returns status of failure or success.
   // TODO(aselle): Consider implementing ArraySlice equivalent to make this
   //   more adept at accepting data without an extra copy. Use absl::ArraySlice
@@ -286,9 +311,21 @@ class Interpreter {
   TfLiteStatus ResizeInputTensor(int tensor_index,
                                  const std::vector<int>& dims);
 
+  // Resizes the first dimension of every input to `batch_size`, so that a
+  // single Invoke() runs `batch_size` independent requests, stored one after
+  // the other in each input. Kernels then process all of them together, e.g.
+  // with one matrix multiplication instead of one per request. Scalar inputs
+  // are left alone. As with ResizeInputTensor(), AllocateTensors() must be
+  // called before the next Invoke().
+  TfLiteStatus ResizeInputBatch(int batch_size);
+
   // Update allocations for all tensors. This will redim dependent tensors using
   // the input tensor dimensionality as given. This is relatively expensive.
   // If you know that your sizes are not changing, you need not call this.
+  // After the first call, only the nodes for which the shape of an input or
+  // output changed since they were last prepared are prepared again, unless
+  // the graph or its parameters were modified in the meantime. The arenas
+  // only reallocate their memory when they need more of it.
 
   // Returns status of success or failure.
   TfLiteStatus AllocateTensors();
@@ -307,6 +344,42 @@ class Interpreter {
   // Set the number of threads available to the interpreter.
   void SetNumThreads(int num_threads);
 
+  // Set the external context of the given type, e.g. a gemmlowp context
+  // shared with other interpreters (see gemm_support.h). The interpreter
+  // doesn't take ownership of 'ctx', which must outlive it.
+  // WARNING: This is an experimental API and subject to change.
+  void SetExternalContext(TfLiteExternalContextType type,
+                          TfLiteExternalContext* ctx);
+
+  // Enable or disable running nodes that do not depend on each other
+  // concurrently (true to enable), on as many threads as given to
+  // SetNumThreads(), or one per core by default. The execution plan is then
+  // reordered into groups of independent nodes, and the tensors used by a
+  // group don't share memory, which may take a larger arena. Nodes handled by
+  // delegates, and nodes with dynamic tensors, still run one at a time.
+  // Changing this requires calling AllocateTensors() again before Invoke().
+  // Returns status of failure or success.
+  TfLiteStatus UseParallelNodeExecution(bool enable);
+
+  // Enable or disable planning the arena knowing the lifetimes of all the
+  // tensors (true to enable): they are then placed by decreasing size rather
+  // than in execution order, which usually makes the arena smaller. This only
+  // applies when the graph has no dynamic tensors. Changing this requires
+  // calling AllocateTensors() again before Invoke().
+  // Returns status of failure or success.
+  TfLiteStatus UseGreedyBySizeArenaPlanning(bool enable);
+
+  // Place all the tensors allocated by the interpreter in the given buffer,
+  // instead of in memory taken from the heap, e.g. a static array on systems
+  // without a heap. The buffer is owned by the caller and must outlive the
+  // interpreter; nullptr reverts to heap memory. AllocateTensors() then fails,
+  // reporting the size needed, if the buffer is too small. Once tensors are
+  // allocated, Invoke() doesn't allocate memory unless the graph has dynamic
+  // tensors. Changing this requires calling AllocateTensors() again before
+  // Invoke().
+  // Returns status of failure or success.
+  TfLiteStatus SetArenaBuffer(char* buffer, size_t size);
+
   // Allow a delegate to look at the graph and modify the graph to handle
   // parts of the graph themselves. After this is called, the graph may
   // contain new nodes that replace 1 more nodes.
@@ -408,6 +481,23 @@ class Interpreter {
     return op_reg.invoke(&context_, node);
   }
 
+  // Copy the data of the inputs of 'node' that are stale in a delegate buffer
+  // back to raw memory.
+  void EnsureInputDataIsReadable(const TfLiteNode& node);
+
+  // Reorder execution_plan_ into groups of nodes that can run concurrently,
+  // filling concurrent_group_ends_ and 'group_sizes' accordingly.
+  void PlanConcurrentExecution(std::vector<int>* group_sizes);
+
+  // Whether the nodes at execution plan indices [first, last] can be invoked
+  // concurrently.
+  bool CanInvokeConcurrently(int first_execution_plan_index,
+                             int last_execution_plan_index);
+
+  // Invoke the nodes at execution plan indices [first, last] concurrently.
+  TfLiteStatus InvokeConcurrently(int first_execution_plan_index,
+                                  int last_execution_plan_index);
+
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
   // postponed until this function is called again. This allows the interpreter
@@ -421,6 +511,19 @@ class Interpreter {
   TfLiteStatus PrepareOpsStartingAt(int first_execution_plan_index,
                                     int* last_execution_plan_index_prepared);
 
+  // Returns true unless the node was prepared since the last change of the
+  // shapes of its inputs and outputs.
+  bool NodeNeedsPrepare(int node_index) const;
+
+  // Records that the shape of the given tensor changed, so that the nodes
+  // using it are prepared again.
+  void TensorShapeChanged(int tensor_index);
+
+  // Makes the next AllocateTensors() prepare all the nodes again. This is
+  // needed after any change other than a tensor shape, since kernels may
+  // depend on it in Prepare().
+  void InvalidatePreparedNodes() { node_prepared_at_.clear(); }
+
   // Tensors needed by the interpreter. Use `AddTensors` to add more blank
   // tensor entries. Note, `tensors_.data()` needs to be synchronized to the
   // `context_` whenever this std::vector is reallocated. Currently this
@@ -439,6 +542,14 @@ class Interpreter {
   TfLiteStatus BytesRequired(TfLiteType type, const int* dims, size_t dims_size,
                              size_t* bytes);
 
+  // Points tensor `tensor_index` at the read-only `buffer`, once the callers
+  // have checked that it holds the expected number of bytes.
+  void SetReadOnlyBuffer(int tensor_index, TfLiteType type, const char* name,
+                         const size_t rank, const int* dims,
+                         TfLiteQuantizationParams quantization,
+                         const char* buffer, size_t bytes,
+                         const Allocation* allocation);
+
   // Request an tensor be resized implementation. If the given tensor is of
   // type kTfLiteDynamic it will also be allocated new memory.
   TfLiteStatus ResizeTensorImpl(TfLiteTensor* tensor, TfLiteIntArray* new_size);
@@ -492,6 +603,14 @@ class Interpreter {
   static TfLiteStatus GetExecutionPlan(struct TfLiteContext* context,
                                        TfLiteIntArray** execution_plan);
 
+  // WARNING: This is an experimental interface that is subject to change.
+  // Entry points for C node plugin API to get and set external contexts.
+  static TfLiteExternalContext* GetExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
+  static void SetExternalContext(struct TfLiteContext* context,
+                                 TfLiteExternalContextType type,
+                                 TfLiteExternalContext* ctx);
+
   // Ensures that `tensors_` has at least `kTensorsCapacityHeadroom` extra
   // capacity. Calling this function may invalidate existing pointers to
   // tensors. After calling this function, adding `kTensorsCapacityHeadroom`
@@ -554,6 +673,17 @@ class Interpreter {
   // NOTE: this relies on the order of nodes that is in topological order.
   int next_execution_plan_index_to_prepare_;
 
+  // Incremented every time the shape of a tensor changes.
+  int64_t shape_change_count_ = 0;
+
+  // The value of `shape_change_count_` after the last shape change of each
+  // tensor, or 0 if it never changed.
+  std::vector<int64_t> tensor_shape_changes_;
+
+  // The value of `shape_change_count_` after the last successful Prepare() of
+  // each node, or -1 if it needs to be prepared.
+  std::vector<int64_t> node_prepared_at_;
+
   // WARNING: This is an experimental interface that is subject to change.
   // This is a list of node indices (to index into nodes_and_registration).
   // This represents a valid topological sort (dependency ordered) execution
@@ -570,6 +700,27 @@ class Interpreter {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // External contexts set by the application, indexed by type.
+  TfLiteExternalContext* external_contexts_[kTfLiteMaxExternalContexts];
+
+  // Whether to run nodes that do not depend on each other concurrently.
+  bool parallel_node_execution_ = false;
+
+  // Whether the arena planner places tensors by decreasing size.
+  bool greedy_by_size_arena_planning_ = false;
+
+  // The buffer set by SetArenaBuffer(), if any.
+  char* arena_buffer_ = nullptr;
+  size_t arena_buffer_size_ = 0;
+
+  // For each entry of execution_plan_, the index of the last entry of its
+  // group of consecutive entries that can run concurrently. Empty if all the
+  // nodes run one at a time.
+  std::vector<int> concurrent_group_ends_;
+
+  // Runs the groups of concurrent nodes along with the invoking thread.
+  std::unique_ptr<ThreadPool> thread_pool_;
+
   bool allow_buffer_handle_output_ = false;
 
   // Profiler for this interpreter instance.
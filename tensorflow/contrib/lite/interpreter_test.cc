@@ -110,6 +110,7 @@ TEST(BasicInterpreter, CheckAllocate) {
       {kTfLiteInt32, sizeof(int32_t)},
       {kTfLiteUInt8, sizeof(uint8_t)},
       {kTfLiteInt64, sizeof(int64_t)},
+      {kTfLiteInt8, sizeof(int8_t)},
   };
 
   for (auto test : cases) {
@@ -129,6 +130,98 @@ TEST(BasicInterpreter, CheckAllocate) {
   }
 }
 
+TEST(BasicInterpreter, ChannelQuantization) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
+  TfLiteQuantizationParams quant = {0.0, 0};
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(0, kTfLiteInt8, "",
+                                                     {3, 2}, quant),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->channel_params, nullptr);
+
+  // The number of scales must match the quantized dimension.
+  ASSERT_NE(interpreter.SetTensorChannelQuantization(0, {0.5, 0.25}, {0, 0},
+                                                     /*quantized_dimension=*/0),
+            kTfLiteOk);
+  ASSERT_NE(interpreter.SetTensorChannelQuantization(0, {0.5, 0.25}, {0}, 1),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorChannelQuantization(0, {0.5, 0.25}, {0, 1}, 1),
+            kTfLiteOk);
+  const TfLiteChannelQuantization* params =
+      interpreter.tensor(0)->channel_params;
+  ASSERT_NE(params, nullptr);
+  EXPECT_EQ(params->quantized_dimension, 1);
+  ASSERT_EQ(params->scale->size, 2);
+  EXPECT_EQ(params->scale->data[0], 0.5);
+  EXPECT_EQ(params->scale->data[1], 0.25);
+  ASSERT_EQ(params->zero_point->size, 2);
+  EXPECT_EQ(params->zero_point->data[1], 1);
+
+  // Setting the tensor's parameters again drops its per-channel ones.
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(0, kTfLiteInt8, "",
+                                                     {3, 2}, quant),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->channel_params, nullptr);
+}
+
+TEST(BasicInterpreter, SparseTensor) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
+  TfLiteQuantizationParams quant = {0.0, 0};
+  // A 4x6 tensor made of 2x3 blocks, of which only the top left and the
+  // bottom right ones are stored.
+  const float blocks[12] = {0};
+  const char* buffer = reinterpret_cast<const char*>(blocks);
+
+  // The blocks must tile the tensor.
+  ASSERT_NE(interpreter.SetTensorParametersReadOnlySparse(
+                0, kTfLiteFloat32, "", {4, 6}, quant, 2, 4, {0, 1, 2}, {0, 1},
+                buffer, sizeof(blocks)),
+            kTfLiteOk);
+  // Every row of blocks needs an offset.
+  ASSERT_NE(interpreter.SetTensorParametersReadOnlySparse(
+                0, kTfLiteFloat32, "", {4, 6}, quant, 2, 3, {0, 2}, {0, 1},
+                buffer, sizeof(blocks)),
+            kTfLiteOk);
+  // Column indices must be in range.
+  ASSERT_NE(interpreter.SetTensorParametersReadOnlySparse(
+                0, kTfLiteFloat32, "", {4, 6}, quant, 2, 3, {0, 1, 2}, {0, 2},
+                buffer, sizeof(blocks)),
+            kTfLiteOk);
+  // The buffer only holds the stored blocks.
+  ASSERT_NE(interpreter.SetTensorParametersReadOnlySparse(
+                0, kTfLiteFloat32, "", {4, 6}, quant, 2, 3, {0, 1, 2}, {0, 1},
+                buffer, 24 * sizeof(float)),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadOnlySparse(
+                0, kTfLiteFloat32, "", {4, 6}, quant, 2, 3, {0, 1, 2}, {0, 1},
+                buffer, sizeof(blocks)),
+            kTfLiteOk);
+
+  const TfLiteTensor* tensor = interpreter.tensor(0);
+  ASSERT_EQ(tensor->dims->size, 2);
+  EXPECT_EQ(tensor->dims->data[0], 4);
+  EXPECT_EQ(tensor->dims->data[1], 6);
+  EXPECT_EQ(tensor->bytes, sizeof(blocks));
+  const TfLiteSparsity* sparsity = tensor->sparsity;
+  ASSERT_NE(sparsity, nullptr);
+  EXPECT_EQ(sparsity->block_rows, 2);
+  EXPECT_EQ(sparsity->block_cols, 3);
+  ASSERT_EQ(sparsity->block_row_offsets->size, 3);
+  EXPECT_EQ(sparsity->block_row_offsets->data[2], 2);
+  ASSERT_EQ(sparsity->block_col_indices->size, 2);
+  EXPECT_EQ(sparsity->block_col_indices->data[1], 1);
+
+  // Setting dense data again drops the sparse layout.
+  const float dense[24] = {0};
+  ASSERT_EQ(interpreter.SetTensorParametersReadOnly(
+                0, kTfLiteFloat32, "", {4, 6}, quant,
+                reinterpret_cast<const char*>(dense), sizeof(dense)),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter.tensor(0)->sparsity, nullptr);
+  EXPECT_EQ(interpreter.tensor(0)->bytes, sizeof(dense));
+}
+
 TEST(BasicInterpreter, CheckResize) {
   const float floats[] = {-3., -4.};
   const int32_t int32s[] = {-3, -4};
@@ -331,6 +424,209 @@ TEST(BasicInterpreter, ResizingTensors) {
   tensor->data.f[15] = 0.123f;
 }
 
+TEST(BasicInterpreter, ResizeInputBatch) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0, 1}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  TfLiteQuantizationParams quant = {0.0, 0};
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(0, kTfLiteFloat32, "",
+                                                     {1, 2, 3}, quant),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(1, kTfLiteFloat32, "",
+                                                     {}, quant),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(2, kTfLiteFloat32, "",
+                                                     {1, 4}, quant),
+            kTfLiteOk);
+
+  ASSERT_NE(interpreter.ResizeInputBatch(0), kTfLiteOk);
+  ASSERT_EQ(interpreter.ResizeInputBatch(8), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  const TfLiteTensor* input = interpreter.tensor(0);
+  ASSERT_EQ(input->dims->size, 3);
+  EXPECT_EQ(input->dims->data[0], 8);
+  EXPECT_EQ(input->dims->data[1], 2);
+  EXPECT_EQ(input->dims->data[2], 3);
+  EXPECT_EQ(input->bytes, 8 * 6 * sizeof(float));
+  // Scalars have no batch dimension, and outputs are resized by the kernels.
+  EXPECT_EQ(interpreter.tensor(1)->dims->size, 0);
+  EXPECT_EQ(interpreter.tensor(2)->dims->data[0], 1);
+}
+
+TEST(BasicInterpreter, OnlyPreparesNodesWithNewShapes) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(4), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0, 2}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({1, 3}), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {3}, TfLiteQuantizationParams()),
+              kTfLiteOk);
+  }
+
+  // Counts the calls to Prepare() of the nodes reading tensors 0 and 2.
+  static int prepare_count[2];
+  prepare_count[0] = prepare_count[1] = 0;
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    ++prepare_count[node->inputs->data[0] / 2];
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    memcpy(output->data.raw, input->data.raw, input->bytes);
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({2}, {3}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count[0], 1);
+  EXPECT_EQ(prepare_count[1], 1);
+
+  // Nothing changed.
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count[0], 1);
+  EXPECT_EQ(prepare_count[1], 1);
+
+  // Resizing to the same shape doesn't require AllocateTensors().
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {3}), kTfLiteOk);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+
+  // Only the first node sees a new shape.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {5}), kTfLiteOk);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteError);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count[0], 2);
+  EXPECT_EQ(prepare_count[1], 1);
+  ASSERT_EQ(interpreter.tensor(1)->dims->size, 1);
+  EXPECT_EQ(interpreter.tensor(1)->dims->data[0], 5);
+  for (int i = 0; i < 5; ++i) {
+    interpreter.typed_tensor<float>(0)[i] = i;
+  }
+  for (int i = 0; i < 3; ++i) {
+    interpreter.typed_tensor<float>(2)[i] = -i;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(1)[i], i);
+  }
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(3)[i], -i);
+  }
+
+  // Shrinking keeps the arena where it is. The first input is at its start.
+  const float* arena = interpreter.typed_tensor<float>(0);
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {2}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count[0], 3);
+  EXPECT_EQ(prepare_count[1], 1);
+  EXPECT_EQ(interpreter.typed_tensor<float>(0), arena);
+
+  // Other changes may affect any node.
+  interpreter.SetNumThreads(2);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count[0], 4);
+  EXPECT_EQ(prepare_count[1], 2);
+}
+
+TEST(BasicInterpreter, GreedyBySizeArenaPlanning) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {3}, TfLiteQuantizationParams()),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < 3; ++i) {
+      output->data.f[i] = input->data.f[i] + 1;
+    }
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  ASSERT_EQ(interpreter.UseGreedyBySizeArenaPlanning(true), kTfLiteOk);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteError);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    interpreter.typed_tensor<float>(0)[i] = i;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(2)[i], i + 2);
+  }
+}
+
+TEST(BasicInterpreter, ArenaBuffer) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {256}, TfLiteQuantizationParams()),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < 256; ++i) {
+      output->data.f[i] = input->data.f[i] + 1;
+    }
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+
+  // The three tensors are all alive after the first node runs.
+  static char small_buffer[2 * 1024];
+  ASSERT_EQ(interpreter.SetArenaBuffer(small_buffer, sizeof(small_buffer)),
+            kTfLiteOk);
+  ASSERT_NE(interpreter.AllocateTensors(), kTfLiteOk);
+
+  static char buffer[4 * 1024];
+  ASSERT_EQ(interpreter.SetArenaBuffer(buffer, sizeof(buffer)), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    const char* data = interpreter.tensor(i)->data.raw;
+    EXPECT_GE(data, buffer);
+    EXPECT_LE(data + 256 * sizeof(float), buffer + sizeof(buffer));
+  }
+  for (int i = 0; i < 256; ++i) {
+    interpreter.typed_tensor<float>(0)[i] = i;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 256; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(2)[i], i + 2);
+  }
+}
+
 TEST(BasicInterpreter, OneOpInterpreter) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
@@ -538,6 +834,103 @@ TEST(BasicInterpreter, AllocateTwice) {
   ASSERT_EQ(old_tensor1_ptr, interpreter.tensor(1)->data.raw);
 }
 
+// Runs two independent chains of two ops each, f(x) = x + 1, listed one chain
+// after the other, and a final op adding their results.
+TEST(BasicInterpreter, ParallelNodeExecution) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(6), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({5}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int tensor_index = 0; tensor_index < 6; tensor_index++) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(
+                  tensor_index, kTfLiteFloat32, "", {3}, quantized),
+              kTfLiteOk);
+  }
+
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    int num = output->dims->data[0];
+    for (int i = 0; i < num; i++) {
+      output->data.f[i] = 0;
+      for (int j = 0; j < node->inputs->size; j++) {
+        output->data.f[i] += context->tensors[node->inputs->data[j]].data.f[i];
+      }
+      if (node->inputs->size == 1) output->data.f[i] += 1;
+    }
+    return kTfLiteOk;
+  };
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({3}, {4}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({2, 4}, {5}, nullptr, 0, nullptr,
+                                              &reg),
+            kTfLiteOk);
+
+  interpreter.SetNumThreads(2);
+  ASSERT_EQ(interpreter.UseParallelNodeExecution(true), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // The first ops of both chains, and then the second ones, are grouped.
+  ASSERT_EQ(interpreter.execution_plan(), std::vector<int>({0, 2, 1, 3, 4}));
+
+  for (int i = 0; i < 3; i++) {
+    interpreter.typed_tensor<float>(0)[i] = i;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(5)[i], 2 * i + 4);
+  }
+}
+
+// An external context that counts how often it is refreshed.
+struct TestExternalContext : public TfLiteExternalContext {
+  static TfLiteStatus CountRefresh(TfLiteContext* context) {
+    auto* ctx = reinterpret_cast<TestExternalContext*>(
+        context->GetExternalContext(context, kTfLiteGemmLowpContext));
+    ctx->num_refreshes++;
+    ctx->num_threads = context->recommended_num_threads;
+    return kTfLiteOk;
+  }
+
+  int num_refreshes = 0;
+  int num_threads = 0;
+};
+
+TEST(BasicInterpreter, ExternalContext) {
+  Interpreter interpreter;
+  TestExternalContext external_context;
+  external_context.type = kTfLiteGemmLowpContext;
+  external_context.Refresh = TestExternalContext::CountRefresh;
+
+  interpreter.SetNumThreads(2);
+  EXPECT_EQ(external_context.num_refreshes, 0);
+
+  interpreter.SetExternalContext(kTfLiteGemmLowpContext, &external_context);
+  interpreter.SetNumThreads(4);
+  EXPECT_EQ(external_context.num_refreshes, 1);
+  EXPECT_EQ(external_context.num_threads, 4);
+
+  interpreter.SetExternalContext(kTfLiteGemmLowpContext, nullptr);
+  interpreter.SetNumThreads(3);
+  EXPECT_EQ(external_context.num_refreshes, 1);
+}
+
 struct TestErrorReporter : public ErrorReporter {
   int Report(const char* format, va_list args) override {
     char buffer[1024];
@@ -950,6 +1343,42 @@ TEST_F(TestDelegate, BasicDelegate) {
   EXPECT_EQ(params->output_tensors->data[1], 4);
 }
 
+TEST_F(TestDelegate, DelegateAfterAllocateTensors) {
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+
+  TfLiteDelegate delegate = {nullptr};
+  delegate.Prepare = [](TfLiteContext* context,
+                        TfLiteDelegate* delegate) -> TfLiteStatus {
+    TfLiteRegistration reg = {nullptr};
+    reg.custom_name = "resizing_fused_op";
+    // Like most kernels, resizes its outputs, which then need to be allocated
+    // again.
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      for (int i = 0; i < node->outputs->size; ++i) {
+        TF_LITE_ENSURE_STATUS(context->ResizeTensor(
+            context, &context->tensors[node->outputs->data[i]],
+            TfLiteIntArrayCopy(input->dims)));
+      }
+      return kTfLiteOk;
+    };
+    TfLiteIntArray* nodes_to_replace = TfLiteIntArrayCreate(3);
+    for (int i = 0; i < 3; ++i) nodes_to_replace->data[i] = i;
+    TfLiteStatus status = context->ReplaceSubgraphsWithDelegateKernels(
+        context, reg, nodes_to_replace, delegate);
+    TfLiteIntArrayFree(nodes_to_replace);
+    return status;
+  };
+  ASSERT_EQ(interpreter_->ModifyGraphWithDelegate(&delegate), kTfLiteOk);
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+
+  // The memory planned for the replaced nodes isn't reused for the outputs of
+  // the delegate kernel.
+  EXPECT_NE(interpreter_->tensor(3)->data.raw, nullptr);
+  EXPECT_NE(interpreter_->tensor(4)->data.raw, nullptr);
+  interpreter_.reset();
+}
+
 TEST_F(TestDelegate, ComplexDeligate) {
   delegate_ = std::unique_ptr<SimpleDelegate>(new SimpleDelegate({1, 2}));
   interpreter_->ModifyGraphWithDelegate(delegate_->get_tf_lite_delegate());
@@ -20,20 +20,26 @@ limitations under the License.
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/kernels/eigen_support.h"
 #include "tensorflow/contrib/lite/kernels/gemm_support.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/cblas_conv.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/integer_ops/conv.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/multithreaded_conv.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/winograd_conv.h"
 #include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/contrib/lite/kernels/internal/reference/integer_ops/conv.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 #include "tensorflow/contrib/lite/kernels/padding.h"
+#include "tensorflow/contrib/lite/kernels/shared_weights.h"
 
 namespace tflite {
 namespace ops {
@@ -61,12 +67,18 @@ struct OpData {
   // memory buffers.
   int im2col_id = kTensorNotAllocated;
   int hwcn_weights_id = kTensorNotAllocated;
+  int winograd_scratch_id = kTensorNotAllocated;
+  int winograd_filter_id = kTensorNotAllocated;
 
   TfLitePaddingValues padding;
   // The scaling factor from input to output (aka the 'real multiplier') can
   // be represented as a fixed point multiplier plus a left shift.
   int32_t output_multiplier;
   int output_shift;
+  // For int8 tensors, whose filters have a scale per output channel, there is
+  // one multiplier and shift (positive for a left shift) per output channel.
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int32_t> per_channel_output_shift;
   // The range of the fused activation layer. For example for kNone and
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
@@ -77,8 +89,24 @@ struct OpData {
   int32_t hwcn_weights_index;
   bool need_hwcn_weights;
   bool have_weights_been_transposed;
+  // If the filter is memory-mapped, its transposed weights are shared with
+  // the other interpreters using the same model instead of being kept in the
+  // 'hwcn_weights' temporary. Both the multithreaded and the generic float
+  // kernels use them.
+  bool share_hwcn_weights;
+  std::shared_ptr<const float> shared_hwcn_weights;
   bool need_im2col;
 
+  // For 3x3 filters, the generic optimized float kernel uses the Winograd
+  // algorithm, which needs the filter transformed. Like the transposed
+  // weights above, memory-mapped filters are transformed into a shared
+  // buffer and others into the 'winograd_filter' temporary.
+  bool use_winograd;
+  int32_t winograd_scratch_index;
+  int32_t winograd_filter_index;
+  bool has_filter_been_transformed;
+  std::shared_ptr<const float> shared_winograd_filter;
+
   bool run_multithreaded_kernel;
 };
 
@@ -87,25 +115,22 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // Instead, we allocate a new object to use as scratch space for im2col, and
   // to carry information from Prepare() to Eval().
   auto* data = new OpData;
-  gemm_support::IncrementUsageCounter(context);
   eigen_support::IncrementUsageCounter(context);
   return data;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
   eigen_support::DecrementUsageCounter(context);
-  gemm_support::DecrementUsageCounter(context);
   delete reinterpret_cast<OpData*>(buffer);
 }
 
 // Naive implementation of transpose for floats. Could be optimized to be more
 // cache friendly, but for now it's a one-time cost on first run, and we would
-// prefer to remove the need to do this at all eventually.
-void TransposeFloatTensor(TfLiteTensor* input, TfLiteTensor* output) {
-  const int rows = output->dims->data[1];
-  const int cols = output->dims->data[0];
+// prefer to remove the need to do this at all eventually. The filter is
+// treated as a [rows, cols] matrix, with 'rows' the number of filters.
+void TransposeFloatTensor(const TfLiteTensor* input, int rows, int cols,
+                          float* output_data) {
   const float* input_data = GetTensorData<float>(input);
-  float* output_data = GetTensorData<float>(output);
   for (int i = 0; i < rows; ++i) {
     for (int j = 0; j < cols; ++j) {
       const float in_value = input_data[i * cols + j];
@@ -114,9 +139,11 @@ void TransposeFloatTensor(TfLiteTensor* input, TfLiteTensor* output) {
   }
 }
 
-// Allocate temporary tensors (`im2col`, `hwcn_weights` if necessary).
+// Allocate temporary tensors (`im2col`, `hwcn_weights`, `winograd_scratch`,
+// `winograd_filter` if necessary).
 // Note: `context->AddTensors` might invalidate pointers to existing tensors.
 // Therefore the logic to add tensors are isolated into this function.
+template <KernelType kernel_type>
 static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
                                                        TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
@@ -129,12 +156,26 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
   int filter_width = filter->dims->data[2];
   int filter_height = filter->dims->data[1];
 
+  // kMultithreadOptimized runs the generic optimized kernel when it must use
+  // a single thread, so both get the Winograd algorithm when it pays off.
+  const bool runs_generic_optimized_kernel =
+      kernel_type == kGenericOptimized ||
+      (kernel_type == kMultithreadOptimized && !data->run_multithreaded_kernel);
+  data->use_winograd =
+      input->type == kTfLiteFloat32 && runs_generic_optimized_kernel &&
+      filter->dims->size == 4 &&
+      winograd_ops::IsSupported(
+          GetTensorDims(filter), params->stride_width, params->stride_height,
+          params->dilation_width_factor, params->dilation_height_factor);
+
   // We don't always need to allocate im2col. It is only used in some versions
   // of the optimized Conv. This test just mimics something that happens inside
   // optimized_ops.h, in order to avoid a DCHECK(!im2col_data).
+  // The int8 kernels read the input directly.
   data->need_im2col =
       (params->stride_width != 1 || params->stride_height != 1 ||
-       filter_width != 1 || filter_height != 1);
+       filter_width != 1 || filter_height != 1) &&
+      !data->use_winograd && input->type != kTfLiteInt8;
   // If we're using the optimized multithreaded EigenTensor implementation of
   // convolution, it expects the filter weights to be transposed compared to
   // the normal TF Lite buffer format. Typical TF Lite weights are
@@ -146,6 +187,9 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
   // we're running with that data type.
   data->need_hwcn_weights =
       (input->type == kTfLiteFloat32 && data->run_multithreaded_kernel);
+  data->share_hwcn_weights = input->type == kTfLiteFloat32 &&
+                             shared_weights::CanShare(filter) &&
+                             !data->use_winograd;
 
   int temporaries_count = 0;
   if (data->need_im2col) {
@@ -155,13 +199,27 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
     }
     ++temporaries_count;
   }
-  if (data->need_hwcn_weights) {
+  if (data->need_hwcn_weights && !data->share_hwcn_weights) {
     data->hwcn_weights_index = temporaries_count;
     if (data->hwcn_weights_id == kTensorNotAllocated) {
       context->AddTensors(context, 1, &data->hwcn_weights_id);
     }
     ++temporaries_count;
   }
+  if (data->use_winograd) {
+    data->winograd_scratch_index = temporaries_count;
+    if (data->winograd_scratch_id == kTensorNotAllocated) {
+      context->AddTensors(context, 1, &data->winograd_scratch_id);
+    }
+    ++temporaries_count;
+    if (!shared_weights::CanShare(filter)) {
+      data->winograd_filter_index = temporaries_count;
+      if (data->winograd_filter_id == kTensorNotAllocated) {
+        context->AddTensors(context, 1, &data->winograd_filter_id);
+      }
+      ++temporaries_count;
+    }
+  }
 
   TfLiteIntArrayFree(node->temporaries);
   node->temporaries = TfLiteIntArrayCreate(temporaries_count);
@@ -169,13 +227,15 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+template <KernelType kernel_type>
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteConvParams*>(node->builtin_data);
   OpData* data = reinterpret_cast<OpData*>(node->user_data);
 
   data->run_multithreaded_kernel = context->recommended_num_threads != 1;
 
-  TF_LITE_ENSURE_STATUS(AllocateTemporaryTensorsIfRequired(context, node));
+  TF_LITE_ENSURE_STATUS(
+      AllocateTemporaryTensorsIfRequired<kernel_type>(context, node));
 
   bool hasBias = node->inputs->size == 3;
   // Check number of inputs/outputs
@@ -191,10 +251,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Check input channels matching filter
   TF_LITE_ENSURE_EQ(context, input->dims->data[3], filter->dims->data[3]);
 
-  // Check types. (We assume that UINT8 refers to quantized tensors)
+  // Check types. (We assume that UINT8 and INT8 refer to quantized tensors)
   TfLiteType data_type = input->type;
-  TF_LITE_ENSURE(context,
-                 data_type == kTfLiteFloat32 || data_type == kTfLiteUInt8);
+  TF_LITE_ENSURE(context, data_type == kTfLiteFloat32 ||
+                              data_type == kTfLiteUInt8 ||
+                              data_type == kTfLiteInt8);
   TF_LITE_ENSURE_EQ(context, output->type, data_type);
   TF_LITE_ENSURE_EQ(context, filter->type, data_type);
 
@@ -206,7 +267,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   if (hasBias) {
     bias = &context->tensors[node->inputs->data[2]];
-    if (data_type == kTfLiteUInt8) {
+    if (data_type == kTfLiteUInt8 || data_type == kTfLiteInt8) {
       TF_LITE_ENSURE_EQ(context, bias->type, kTfLiteInt32);
       TF_LITE_ENSURE_EQ(context, bias->params.zero_point, 0);
     } else {
@@ -250,7 +311,18 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
-  if (data_type != kTfLiteFloat32) {
+  if (data_type == kTfLiteInt8) {
+    // The int8 kernels don't support dilation.
+    TF_LITE_ENSURE_EQ(context, params->dilation_width_factor, 1);
+    TF_LITE_ENSURE_EQ(context, params->dilation_height_factor, 1);
+    TF_LITE_ENSURE_STATUS(PopulateChannelQuantizationMultipliers(
+        context, input, filter, bias, output, /*channel_dimension=*/0,
+        &data->per_channel_output_multiplier,
+        &data->per_channel_output_shift));
+    CalculateActivationRangeInt8(params->activation, output,
+                                 &data->output_activation_min,
+                                 &data->output_activation_max);
+  } else if (data_type != kTfLiteFloat32) {
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
         context, input, filter, bias, output, &real_multiplier));
@@ -290,7 +362,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     if (im2col_status != kTfLiteOk) return im2col_status;
   }
 
-  if (data->need_hwcn_weights) {
+  data->shared_hwcn_weights.reset();
+  if (data->share_hwcn_weights) {
+    const int rows = channels_out;
+    const int cols = filter_height * filter_width * input->dims->data[3];
+    data->shared_hwcn_weights =
+        shared_weights::GetOrTranspose(filter, rows, cols);
+  } else if (data->need_hwcn_weights) {
     node->temporaries->data[data->hwcn_weights_index] = data->hwcn_weights_id;
     TfLiteIntArray* hwcn_weights_size = TfLiteIntArrayCreate(2);
 
@@ -326,6 +404,46 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     data->have_weights_been_transposed = false;
   }
 
+  data->shared_winograd_filter.reset();
+  if (data->use_winograd) {
+    node->temporaries->data[data->winograd_scratch_index] =
+        data->winograd_scratch_id;
+    TfLiteIntArray* scratch_size = TfLiteIntArrayCreate(1);
+    scratch_size->data[0] = winograd_ops::ScratchSize(GetTensorDims(filter),
+                                                      GetTensorDims(output));
+    TfLiteTensor* scratch = &context->tensors[data->winograd_scratch_id];
+    scratch->type = kTfLiteFloat32;
+    scratch->allocation_type = kTfLiteArenaRw;
+    TF_LITE_ENSURE_STATUS(
+        context->ResizeTensor(context, scratch, scratch_size));
+
+    const int transformed_filter_size =
+        winograd_ops::TransformedFilterSize(GetTensorDims(filter));
+    if (shared_weights::CanShare(filter)) {
+      data->shared_winograd_filter = shared_weights::GetOrPack(
+          filter, "winograd_f4x4_3x3", transformed_filter_size,
+          [](const TfLiteTensor* source, float* transformed_filter) {
+            winograd_ops::TransformFilter(GetTensorData<float>(source),
+                                          GetTensorDims(source),
+                                          transformed_filter);
+          });
+    } else {
+      node->temporaries->data[data->winograd_filter_index] =
+          data->winograd_filter_id;
+      TfLiteIntArray* winograd_filter_size = TfLiteIntArrayCreate(1);
+      winograd_filter_size->data[0] = transformed_filter_size;
+      TfLiteTensor* winograd_filter =
+          &context->tensors[data->winograd_filter_id];
+      winograd_filter->type = kTfLiteFloat32;
+      // Like 'hwcn_weights', this is transformed on the first Eval() and kept
+      // until the next Prepare().
+      winograd_filter->allocation_type = kTfLiteDynamic;
+      TF_LITE_ENSURE_STATUS(context->ResizeTensor(context, winograd_filter,
+                                                  winograd_filter_size));
+      data->has_filter_been_transformed = false;
+    }
+  }
+
   return kTfLiteOk;
 }
 
@@ -335,7 +453,8 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                    TfLiteTensor* filter, TfLiteTensor* bias,
                    TfLiteTensor* im2col, TfLiteTensor* hwcn_weights,
                    TfLiteTensor* output) {
-  gemmlowp::GemmContext* gemm_context = gemm_support::GetFromContext(context);
+  gemm_support::ScopedGemmContext scoped_gemm_context(context);
+  gemmlowp::GemmContext* gemm_context = scoped_gemm_context.get();
 
   auto input_offset = -input->params.zero_point;
   auto filter_offset = -filter->params.zero_point;
@@ -372,6 +491,69 @@ void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   }
 }
 
+template <KernelType kernel_type>
+void EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
+                             TfLiteConvParams* params, OpData* data,
+                             TfLiteTensor* input, TfLiteTensor* filter,
+                             TfLiteTensor* bias, TfLiteTensor* output) {
+  const int32_t input_offset = -input->params.zero_point;
+  const int32_t output_offset = output->params.zero_point;
+
+  switch (kernel_type) {
+    case kReference:
+      reference_integer_ops::ConvPerChannel(
+          GetTensorData<int8_t>(input), GetTensorDims(input), input_offset,
+          GetTensorData<int8_t>(filter), GetTensorDims(filter),
+          GetTensorData<int32_t>(bias), GetTensorDims(bias),
+          params->stride_width, params->stride_height, data->padding.width,
+          data->padding.height, data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(), output_offset,
+          data->output_activation_min, data->output_activation_max,
+          GetTensorData<int8_t>(output), GetTensorDims(output));
+      break;
+    case kGenericOptimized:
+    case kMultithreadOptimized:
+    case kCblasOptimized:
+      optimized_integer_ops::ConvPerChannel(
+          GetTensorData<int8_t>(input), GetTensorDims(input), input_offset,
+          GetTensorData<int8_t>(filter), GetTensorDims(filter),
+          GetTensorData<int32_t>(bias), GetTensorDims(bias),
+          params->stride_width, params->stride_height, data->padding.width,
+          data->padding.height, data->per_channel_output_multiplier.data(),
+          data->per_channel_output_shift.data(), output_offset,
+          data->output_activation_min, data->output_activation_max,
+          GetTensorData<int8_t>(output), GetTensorDims(output));
+      break;
+  }
+}
+
+void EvalWinograd(TfLiteContext* context, TfLiteNode* node, OpData* data,
+                  TfLiteTensor* input, TfLiteTensor* filter, TfLiteTensor* bias,
+                  float output_activation_min, float output_activation_max,
+                  TfLiteTensor* output) {
+  const float* transformed_filter_data = data->shared_winograd_filter.get();
+  if (!transformed_filter_data) {
+    TfLiteTensor* winograd_filter =
+        &context->tensors[node->temporaries->data[data->winograd_filter_index]];
+    if (!data->has_filter_been_transformed) {
+      winograd_ops::TransformFilter(GetTensorData<float>(filter),
+                                    GetTensorDims(filter),
+                                    GetTensorData<float>(winograd_filter));
+      data->has_filter_been_transformed = true;
+    }
+    transformed_filter_data = GetTensorData<float>(winograd_filter);
+  }
+  TfLiteTensor* scratch =
+      &context->tensors[node->temporaries->data[data->winograd_scratch_index]];
+  winograd_ops::Conv(GetTensorData<float>(input), GetTensorDims(input),
+                     transformed_filter_data, GetTensorDims(filter),
+                     GetTensorData<float>(bias), GetTensorDims(bias),
+                     data->padding.width, data->padding.height,
+                     output_activation_min, output_activation_max,
+                     GetTensorData<float>(output), GetTensorDims(output),
+                     GetTensorData<float>(scratch));
+}
+
 template <KernelType kernel_type>
 void EvalFloat(TfLiteContext* context, TfLiteNode* node,
                TfLiteConvParams* params, OpData* data, TfLiteTensor* input,
@@ -405,6 +587,11 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
       break;
     }
     case kGenericOptimized: {
+      if (data->use_winograd) {
+        EvalWinograd(context, node, data, input, filter, bias,
+                     output_activation_min, output_activation_max, output);
+        break;
+      }
       optimized_ops::Conv(
           GetTensorData<float>(input), GetTensorDims(input),
           GetTensorData<float>(filter), GetTensorDims(filter),
@@ -413,12 +600,15 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
           params->dilation_height_factor, data->padding.width,
           data->padding.height, output_activation_min, output_activation_max,
           GetTensorData<float>(output), GetTensorDims(output),
-          GetTensorData<float>(im2col), GetTensorDims(im2col));
+          GetTensorData<float>(im2col), GetTensorDims(im2col),
+          data->shared_hwcn_weights.get());
       break;
     }
     case kMultithreadOptimized: {
       const float* filter_data;
-      if (data->need_hwcn_weights) {
+      if (data->share_hwcn_weights) {
+        filter_data = data->shared_hwcn_weights.get();
+      } else if (data->need_hwcn_weights) {
         filter_data = GetTensorData<float>(hwcn_weights);
       } else {
         filter_data = GetTensorData<float>(filter);
@@ -430,7 +620,8 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
           data->padding.width, data->padding.height, params->padding,
           output_activation_min, output_activation_max,
           GetTensorData<float>(output), GetTensorDims(output),
-          GetTensorData<float>(im2col), GetTensorDims(im2col));
+          GetTensorData<float>(im2col), GetTensorDims(im2col),
+          context->recommended_num_threads);
       break;
     }
     case kCblasOptimized: {
@@ -463,12 +654,14 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           ? &context->tensors[node->temporaries->data[data->im2col_index]]
           : nullptr;
   TfLiteTensor* hwcn_weights =
-      data->need_hwcn_weights
+      data->need_hwcn_weights && !data->share_hwcn_weights
           ? &context->tensors[node->temporaries->data[data->hwcn_weights_index]]
           : nullptr;
 
-  if (data->need_hwcn_weights && !data->have_weights_been_transposed) {
-    TransposeFloatTensor(filter, hwcn_weights);
+  if (hwcn_weights && !data->have_weights_been_transposed) {
+    TransposeFloatTensor(filter, hwcn_weights->dims->data[1],
+                         hwcn_weights->dims->data[0],
+                         GetTensorData<float>(hwcn_weights));
     data->have_weights_been_transposed = true;
   }
 
@@ -488,6 +681,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       EvalQuantized<kernel_type>(context, node, params, data, input, filter,
                                  bias, im2col, hwcn_weights, output);
       break;
+    case kTfLiteInt8:
+      EvalQuantizedPerChannel<kernel_type>(context, node, params, data, input,
+                                           filter, bias, output);
+      break;
     default:
       context->ReportError(context, "Type %d not currently supported.",
                            input->type);
@@ -499,25 +696,29 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace conv
 
 TfLiteRegistration* Register_CONVOLUTION_REF() {
-  static TfLiteRegistration r = {conv::Init, conv::Free, conv::Prepare,
+  static TfLiteRegistration r = {conv::Init, conv::Free,
+                                 conv::Prepare<conv::kReference>,
                                  conv::Eval<conv::kReference>};
   return &r;
 }
 
 TfLiteRegistration* Register_CONVOLUTION_GENERIC_OPT() {
-  static TfLiteRegistration r = {conv::Init, conv::Free, conv::Prepare,
+  static TfLiteRegistration r = {conv::Init, conv::Free,
+                                 conv::Prepare<conv::kGenericOptimized>,
                                  conv::Eval<conv::kGenericOptimized>};
   return &r;
 }
 
 TfLiteRegistration* Register_CONVOLUTION_MULTITHREADED_OPT() {
-  static TfLiteRegistration r = {conv::Init, conv::Free, conv::Prepare,
+  static TfLiteRegistration r = {conv::Init, conv::Free,
+                                 conv::Prepare<conv::kMultithreadOptimized>,
                                  conv::Eval<conv::kMultithreadOptimized>};
   return &r;
 }
 
 TfLiteRegistration* Register_CONVOLUTION_CBLAS_OPT() {
-  static TfLiteRegistration r = {conv::Init, conv::Free, conv::Prepare,
+  static TfLiteRegistration r = {conv::Init, conv::Free,
+                                 conv::Prepare<conv::kCblasOptimized>,
                                  conv::Eval<conv::kCblasOptimized>};
   return &r;
 }
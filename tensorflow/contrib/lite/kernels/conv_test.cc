@@ -54,6 +54,15 @@ class BaseConvolutionOpModel : public SingleOpModel {
     int bias_size = GetShape(filter_)[0];
     if (input.type == TensorType_FLOAT32) {
       bias_ = AddInput({TensorType_FLOAT32, {bias_size}});
+    } else if (!filter.per_channel_scales.empty()) {
+      // With per-channel filters, each output channel has its own bias scale.
+      std::vector<float> bias_scales;
+      for (float filter_scale : filter.per_channel_scales) {
+        bias_scales.push_back(GetScale(input_) * filter_scale);
+      }
+      TensorData bias{TensorType_INT32, {bias_size}, 0, 0, 0, 0, bias_scales,
+                      /*quantized_dimension=*/0};
+      bias_ = AddInput(bias);
     } else {
       // This is a quantized version. The scale of 'bias' depends on the scales
       // of input and filter. Supposedly this is correctly set during quantized
@@ -94,12 +103,18 @@ class ConvolutionOpModel : public BaseConvolutionOpModel {
   using BaseConvolutionOpModel::BaseConvolutionOpModel;
 
   void SetFilter(std::initializer_list<float> f) { PopulateTensor(filter_, f); }
+  void SetFilter(std::vector<float> f) {
+    PopulateTensor(filter_, 0, f.data(), f.data() + f.size());
+  }
 
   void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
 
   void SetInput(std::initializer_list<float> data) {
     PopulateTensor(input_, data);
   }
+  void SetInput(std::vector<float> data) {
+    PopulateTensor(input_, 0, data.data(), data.data() + data.size());
+  }
   std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
 };
 
@@ -224,6 +239,59 @@ TEST_P(ConvolutionOpTest, HandCalculatedFloat32) {
                                                178, 187, 234, 261, 121}));
 }
 
+TEST_P(ConvolutionOpTest, HandCalculatedDeepFloat32) {
+  // Deep enough for the optimized kernels to use the Winograd algorithm.
+  const int depth = 8;
+  const int image_width = 4;
+  const int image_height = 3;
+  const int image_batch_count = 1;
+  const int filter_size = 3;
+  const int filter_count = depth;
+  const int stride_width = 1;
+  const int stride_height = 1;
+  const Padding padding = Padding_SAME;
+  ConvolutionOpModel m(
+      GetRegistration(),
+      {TensorType_FLOAT32,
+       {image_batch_count, image_height, image_width, depth}},
+      {TensorType_FLOAT32, {filter_count, filter_size, filter_size, depth}},
+      {TensorType_FLOAT32, {}}, stride_width, stride_height, padding);
+
+  // Channel 'c' of the image is the image of HandCalculatedFloat32 times c+1,
+  // and filter 'f' applies the filter of HandCalculatedFloat32 to channel f.
+  const std::vector<float> image = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  const std::vector<float> filter = {1, 4, 7, 2, 5, 8, 3, 6, 9};
+  std::vector<float> input_data;
+  for (float value : image) {
+    for (int c = 0; c < depth; ++c) {
+      input_data.push_back(value * (c + 1));
+    }
+  }
+  std::vector<float> filter_data;
+  for (int f = 0; f < filter_count; ++f) {
+    for (float value : filter) {
+      for (int c = 0; c < depth; ++c) {
+        filter_data.push_back(c == f ? value : 0);
+      }
+    }
+  }
+  m.SetInput(input_data);
+  m.SetFilter(filter_data);
+  m.SetBias({0, 0, 0, 0, 0, 0, 0, 0});
+
+  m.Invoke();
+  const std::vector<float> output = {105, 150, 183, 95,  235, 312,
+                                     357, 178, 187, 234, 261, 121};
+  std::vector<float> expected_output;
+  for (float value : output) {
+    for (int f = 0; f < filter_count; ++f) {
+      expected_output.push_back(value * (f + 1));
+    }
+  }
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(expected_output, 1e-2)));
+}
+
 TEST_P(ConvolutionOpTest, HandCalculatedWithBiasFloat32) {
   const int depth = 1;
   const int image_width = 4;
@@ -441,6 +509,70 @@ TEST_P(ConvolutionOpTest, SimpleTestQuantized) {
                              }));
 }
 
+class PerChannelQuantizedConvolutionOpModel : public BaseConvolutionOpModel {
+ public:
+  using BaseConvolutionOpModel::BaseConvolutionOpModel;
+
+  void SetInput(std::initializer_list<float> data) {
+    QuantizeAndPopulate<int8_t>(input_, data);
+  }
+
+  void SetFilter(const std::vector<float>& data) {
+    PerChannelQuantizeAndPopulate<int8_t>(filter_, data);
+  }
+
+  void SetBias(const std::vector<float>& data) {
+    PerChannelQuantizeAndPopulate<int32_t>(bias_, data);
+  }
+
+  std::vector<int8_t> GetOutput() { return ExtractVector<int8_t>(output_); }
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<int8_t>(ExtractVector<int8_t>(output_),
+                              GetScale(output_), GetZeroPoint(output_));
+  }
+};
+
+// Same as SimpleTestQuantized, with a different scale for each filter.
+TEST_P(ConvolutionOpTest, SimpleTestPerChannelQuantized) {
+  PerChannelQuantizedConvolutionOpModel m(
+      GetRegistration(), {TensorType_INT8, {2, 2, 4, 1}, -63.5, 64},
+      {TensorType_INT8, {3, 2, 2, 1}, 0, 0, 0, 0, {0.25, 0.0625, 0.125},
+       /*quantized_dimension=*/0},
+      {TensorType_INT8, {}, -127, 128});
+  m.SetInput({
+      // First batch
+      1, 1, 1, 1,  // row = 1
+      2, 2, 2, 2,  // row = 2
+      // Second batch
+      1, 2, 3, 4,  // row = 1
+      1, 2, 3, 4,  // row = 2
+  });
+  m.SetFilter({
+      1, 2, 3, 4,    // first 2x2 filter
+      -1, 1, -1, 1,  // second 2x2 filter
+      -1, -1, 1, 1,  // third 2x2 filter
+  });
+  m.SetBias({1, 2, 3});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {
+                      18, 2, 5,  // first batch, left
+                      18, 2, 5,  // first batch, right
+                      17, 4, 3,  // second batch, left
+                      37, 4, 3,  // second batch, right
+                  },
+                  1e-5)));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 17, 1, 4,  //
+                                 17, 1, 4,  //
+                                 16, 3, 2,  //
+                                 36, 3, 2,  //
+                             }));
+}
+
 TEST_P(ConvolutionOpTest, SimpleTestQuantizedWithAnisotropicStrides) {
   QuantizedConvolutionOpModel m(GetRegistration(),
                                 {TensorType_UINT8, {1, 3, 6, 1}, -63.5, 64},
@@ -37,6 +37,15 @@ class BaseDepthwiseConvolutionOpModel : public SingleOpModel {
     int bias_size = GetShape(filter_)[3];
     if (input.type == TensorType_FLOAT32) {
       bias_ = AddInput({TensorType_FLOAT32, {bias_size}});
+    } else if (!filter.per_channel_scales.empty()) {
+      // With per-channel filters, each output channel has its own bias scale.
+      std::vector<float> bias_scales;
+      for (float filter_scale : filter.per_channel_scales) {
+        bias_scales.push_back(GetScale(input_) * filter_scale);
+      }
+      TensorData bias{TensorType_INT32, {bias_size}, 0, 0, 0, 0, bias_scales,
+                      /*quantized_dimension=*/0};
+      bias_ = AddInput(bias);
     } else {
       // This is a quantized version. The scale of 'bias' depends on the scales
       // of input and filter. Supposedly this is correctly set during quantized
@@ -207,6 +216,65 @@ TEST(QuantizedDepthwiseConvolutionOpTest,
               ElementsAreArray(ArrayFloatNear(float_op.GetOutput(), 1)));
 }
 
+class PerChannelQuantizedDepthwiseConvolutionOpModel
+    : public BaseDepthwiseConvolutionOpModel {
+ public:
+  using BaseDepthwiseConvolutionOpModel::BaseDepthwiseConvolutionOpModel;
+
+  void SetInput(std::initializer_list<float> data) {
+    QuantizeAndPopulate<int8_t>(input_, data);
+  }
+
+  void SetFilter(const std::vector<float>& data) {
+    PerChannelQuantizeAndPopulate<int8_t>(filter_, data);
+  }
+
+  void SetBias(const std::vector<float>& data) {
+    PerChannelQuantizeAndPopulate<int32_t>(bias_, data);
+  }
+
+  std::vector<int8_t> GetOutput() { return ExtractVector<int8_t>(output_); }
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<int8_t>(ExtractVector<int8_t>(output_),
+                              GetScale(output_), GetZeroPoint(output_));
+  }
+};
+
+// Same as SimpleTestQuantized, with a different scale for each filter channel.
+TEST(PerChannelQuantizedDepthwiseConvolutionOpTest, SimpleTest) {
+  PerChannelQuantizedDepthwiseConvolutionOpModel m(
+      {TensorType_INT8, {1, 3, 2, 2}, -63.5, 64},
+      {TensorType_INT8, {1, 2, 2, 4}, 0, 0, 0, 0, {0.125, 0.125, 0.25, 0.25},
+       /*quantized_dimension=*/3},
+      {TensorType_INT8, {}, -127, 128});
+
+  m.SetInput({
+      1, 2, 7, 8,    // column 1
+      3, 4, 9, 10,   // column 2
+      5, 6, 11, 12,  // column 3
+  });
+  m.SetFilter({
+      1, 2, 3, 4,        //
+      -9, 10, -11, 12,   //
+      5, 6, 7, 8,        //
+      13, -14, 15, -16,  //
+  });
+  m.SetBias({1, 2, 3, 4});
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(), ElementsAreArray(ArrayFloatNear(
+                                            {
+                                                71, -34, 99, -20,  //
+                                                91, -26, 127, -4,  //
+                                            },
+                                            1e-5)));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 70, -35, 98, -21,  //
+                                 90, -27, 126, -5,  //
+                             }));
+}
+
 }  // namespace
 }  // namespace tflite
 
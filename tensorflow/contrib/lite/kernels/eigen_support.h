@@ -21,16 +21,14 @@ namespace tflite {
 namespace eigen_support {
 
 // Let the framework know that the op will be using Eigen. If necessary a set of
-// temporary Eigen objects might be created and placed in 'context'.
+// temporary Eigen objects might be created and placed in 'context', as its
+// kTfLiteEigenContext external context.
 void IncrementUsageCounter(TfLiteContext* context);
 
 // Let the framework know that the op stopped using Eigen. If there are no more
 // usages all temporary Eigen objects will be deleted.
 void DecrementUsageCounter(TfLiteContext* context);
 
-// Set the number of threads that can be used by Eigen.
-void SetNumThreads(TfLiteContext* context, int num_threads);
-
 }  // namespace eigen_support
 }  // namespace tflite
 
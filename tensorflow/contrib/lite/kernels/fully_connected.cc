@@ -20,18 +20,23 @@ limitations under the License.
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
 #include "tensorflow/contrib/lite/kernels/gemm_support.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/integer_ops/fully_connected.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/contrib/lite/kernels/internal/reference/integer_ops/fully_connected.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
+#include "tensorflow/contrib/lite/kernels/shared_weights.h"
 
 namespace tflite {
 namespace ops {
@@ -51,12 +56,21 @@ struct OpData {
   // be represented as a fixed point multiplier plus a left shift.
   int32_t output_multiplier;
   int output_shift;
+  // For int8 tensors, whose weights have a scale per output channel, there is
+  // one multiplier and shift (positive for a left shift) per output channel.
+  std::vector<int32_t> per_channel_output_multiplier;
+  std::vector<int32_t> per_channel_output_shift;
   // The range of the fused activation layer. For example for kNone and
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
   int32_t output_activation_max;
   // The index of the temporary tensor where the quantized inputs are cached.
   int input_quantized_index;
+  // Memory-mapped float weights, transposed for the optimized kernels and
+  // shared with the other interpreters using the same model. Only set when
+  // the batch size is more than one, as the GEMV used for a single batch
+  // reads the weights in their original layout just as fast.
+  std::shared_ptr<const float> transposed_weights;
 };
 
 constexpr int kInputTensor = 0;
@@ -69,14 +83,12 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // This is a builtin op, so we don't use the contents in 'buffer', if any.
   // Instead, we allocate a new object to carry information from Prepare() to
   // Eval().
-  gemm_support::IncrementUsageCounter(context);
   auto* op_data = new OpData;
   context->AddTensors(context, 1, &op_data->input_quantized_index);
   return op_data;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
-  gemm_support::DecrementUsageCounter(context);
   delete reinterpret_cast<OpData*>(buffer);
 }
 
@@ -113,7 +125,24 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
   TfLiteType data_type = input->type;
-  if (data_type != kTfLiteFloat32) {
+  if (filter->sparsity) {
+    // Sparse weights are only supported by the float kernel.
+    TF_LITE_ENSURE_EQ(context, filter->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, data_type, kTfLiteFloat32);
+  } else if (filter->type == kTfLiteInt8) {
+    TF_LITE_ENSURE_EQ(context, data_type, kTfLiteInt8);
+    TF_LITE_ENSURE_EQ(context, output->type, kTfLiteInt8);
+    if (bias) {
+      TF_LITE_ENSURE_EQ(context, bias->type, kTfLiteInt32);
+    }
+    TF_LITE_ENSURE_STATUS(PopulateChannelQuantizationMultipliers(
+        context, input, filter, bias, output, /*channel_dimension=*/0,
+        &data->per_channel_output_multiplier,
+        &data->per_channel_output_shift));
+    CalculateActivationRangeInt8(params->activation, output,
+                                 &data->output_activation_min,
+                                 &data->output_activation_max);
+  } else if (data_type != kTfLiteFloat32) {
     double real_multiplier = 0.0;
     TF_LITE_ENSURE_STATUS(GetQuantizedConvolutionMultipler(
         context, input, filter, bias, output, &real_multiplier));
@@ -125,6 +154,14 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                   &data->output_activation_max);
   }
 
+  data->transposed_weights.reset();
+  if (input->type == kTfLiteFloat32 && filter->type == kTfLiteFloat32 &&
+      !filter->sparsity && batch_size > 1 &&
+      shared_weights::CanShare(filter)) {
+    data->transposed_weights = shared_weights::GetOrTranspose(
+        filter, num_units, filter->dims->data[1]);
+  }
+
   // If we have to perform on-the-fly quantization (with quantized weights and
   // float inputs) first we need to quantize the inputs. Allocate a temporary
   // buffer to store the intermediate quantized values.
@@ -188,6 +225,37 @@ TfLiteStatus EvalPie(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Same as EvalPie(), for weights that only hold the stored blocks of a
+// block-sparse matrix.
+TfLiteStatus EvalSparseFloat(TfLiteContext* context, TfLiteNode* node,
+                             TfLiteFullyConnectedParams* params,
+                             const TfLiteTensor* input,
+                             const TfLiteTensor* filter,
+                             const TfLiteTensor* bias, TfLiteTensor* output) {
+  const TfLiteSparsity* sparsity = filter->sparsity;
+  const int input_size = filter->dims->data[1];
+  const int batch_size = NumElements(input) / input_size;
+  const int num_units = filter->dims->data[0];
+
+  if (bias) {
+    tensor_utils::VectorBatchVectorAssign(bias->data.f, num_units, batch_size,
+                                          output->data.f);
+  } else {
+    tensor_utils::ZeroVector(output->data.f, batch_size * num_units);
+  }
+
+  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate(
+      filter->data.f, num_units, input_size, sparsity->block_rows,
+      sparsity->block_cols, sparsity->block_row_offsets->data,
+      sparsity->block_col_indices->data, input->data.f, batch_size,
+      output->data.f, /*result_stride=*/1);
+
+  tensor_utils::ApplyActivationToVector(output->data.f, batch_size * num_units,
+                                        params->activation, output->data.f);
+
+  return kTfLiteOk;
+}
+
 TfLiteStatus EvalPieQuantized(TfLiteContext* context, TfLiteNode* node,
                               TfLiteFullyConnectedParams* params, OpData* data,
                               const TfLiteTensor* input,
@@ -272,7 +340,8 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                            const TfLiteTensor* input,
                            const TfLiteTensor* filter, const TfLiteTensor* bias,
                            TfLiteTensor* output) {
-  gemmlowp::GemmContext* gemm_context = gemm_support::GetFromContext(context);
+  gemm_support::ScopedGemmContext scoped_gemm_context(context);
+  gemmlowp::GemmContext* gemm_context = scoped_gemm_context.get();
 
   int32_t input_offset = -input->params.zero_point;
   int32_t filter_offset = -filter->params.zero_point;
@@ -307,6 +376,34 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+template <KernelType kernel_type>
+TfLiteStatus EvalQuantizedPerChannel(TfLiteContext* context, TfLiteNode* node,
+                                     TfLiteFullyConnectedParams* params,
+                                     OpData* data, const TfLiteTensor* input,
+                                     const TfLiteTensor* filter,
+                                     const TfLiteTensor* bias,
+                                     TfLiteTensor* output) {
+  const int32_t input_offset = -input->params.zero_point;
+  const int32_t output_offset = output->params.zero_point;
+#define TF_LITE_FULLY_CONNECTED(type)                                    \
+  type::FullyConnectedPerChannel(                                        \
+      GetTensorData<int8_t>(input), GetTensorDims(input), input_offset,  \
+      GetTensorData<int8_t>(filter), GetTensorDims(filter),              \
+      GetTensorData<int32_t>(bias), GetTensorDims(bias),                 \
+      data->per_channel_output_multiplier.data(),                        \
+      data->per_channel_output_shift.data(), output_offset,              \
+      data->output_activation_min, data->output_activation_max,          \
+      GetTensorData<int8_t>(output), GetTensorDims(output))
+  if (kernel_type == kReference) {
+    TF_LITE_FULLY_CONNECTED(reference_integer_ops);
+  } else {
+    TF_LITE_FULLY_CONNECTED(optimized_integer_ops);
+  }
+#undef TF_LITE_FULLY_CONNECTED
+
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
                        TfLiteFullyConnectedParams* params, OpData* data,
@@ -325,6 +422,13 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
     TF_LITE_FULLY_CONNECTED(reference_ops);
   } else if (kernel_type == kPie) {
     return EvalPie(context, node, params, data, input, filter, bias, output);
+  } else if (data->transposed_weights) {
+    optimized_ops::FullyConnectedWithTransposedWeights(
+        GetTensorData<float>(input), GetTensorDims(input),
+        data->transposed_weights.get(), GetTensorDims(filter),
+        GetTensorData<float>(bias), GetTensorDims(bias), output_activation_min,
+        output_activation_max, GetTensorData<float>(output),
+        GetTensorDims(output));
   } else {
     TF_LITE_FULLY_CONNECTED(optimized_ops);
   }
@@ -346,6 +450,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* bias = GetOptionalInputTensor(context, node, kBiasTensor);
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
 
+  // All the kernel types share the same sparse implementation.
+  if (filter->sparsity) {
+    return EvalSparseFloat(context, node, params, input, filter, bias, output);
+  }
+
   switch (filter->type) {  // Already know in/out types are same.
     case kTfLiteFloat32:
       return EvalFloat<kernel_type>(context, node, params, data, input, filter,
@@ -353,6 +462,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     case kTfLiteUInt8:
       return EvalQuantized<kernel_type>(context, node, params, data, input,
                                         filter, bias, output);
+    case kTfLiteInt8:
+      return EvalQuantizedPerChannel<kernel_type>(context, node, params, data,
+                                                  input, filter, bias, output);
     default:
       context->ReportError(context, "Type %d not currently supported.",
                            filter->type);
@@ -204,6 +204,76 @@ class FloatFullyConnectedOpModel : public BaseFullyConnectedOpModel {
   std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
 };
 
+// A float model whose weights are a constant, memory-mapped tensor.
+class ConstWeightsFullyConnectedOpModel : public SingleOpModel {
+ public:
+  ConstWeightsFullyConnectedOpModel(TfLiteRegistration* registration,
+                                    int units, int batches, int input_size,
+                                    std::initializer_list<float> weights) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    AddConstInput(TensorType_FLOAT32, weights, {units, input_size});
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput(TensorType_FLOAT32);
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({{batches, input_size}, {units, input_size}, {units}});
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int bias_;
+  int output_;
+};
+
+// A float model whose constant weights are stored in a block-sparse layout.
+class SparseWeightsFullyConnectedOpModel : public SingleOpModel {
+ public:
+  SparseWeightsFullyConnectedOpModel(
+      TfLiteRegistration* registration, int units, int batches, int input_size,
+      int block_rows, int block_cols, std::initializer_list<float> blocks,
+      const std::vector<int>& block_row_offsets,
+      const std::vector<int>& block_col_indices) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    AddSparseConstInput(TensorType_FLOAT32, blocks, {units, input_size},
+                        block_rows, block_cols, block_row_offsets,
+                        block_col_indices);
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput(TensorType_FLOAT32);
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({{batches, input_size}, {units, input_size}, {units}});
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int bias_;
+  int output_;
+};
+
 class QuantizedFullyConnectedOpModel : public BaseFullyConnectedOpModel {
  public:
   using BaseFullyConnectedOpModel::BaseFullyConnectedOpModel;
@@ -225,6 +295,63 @@ class QuantizedFullyConnectedOpModel : public BaseFullyConnectedOpModel {
   }
 };
 
+// Int8 input and output, with weights and bias quantized per output unit.
+class PerChannelQuantizedFullyConnectedOpModel : public SingleOpModel {
+ public:
+  PerChannelQuantizedFullyConnectedOpModel(
+      TfLiteRegistration* registration, int units, int batches,
+      const TensorData& input, const std::vector<float>& weight_scales,
+      const TensorData& output) {
+    const int input_size = GetShapeSize(input.shape) / batches;
+    input_ = AddInput(input);
+    weights_ = AddInput({TensorType_INT8, {units, input_size}, 0, 0, 0, 0,
+                         weight_scales, /*quantized_dimension=*/0});
+    std::vector<float> bias_scales;
+    for (float weight_scale : weight_scales) {
+      bias_scales.push_back(GetScale(input_) * weight_scale);
+    }
+    bias_ = AddInput({TensorType_INT32, {units}, 0, 0, 0, 0, bias_scales,
+                      /*quantized_dimension=*/0});
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+
+  void SetBias(const std::vector<float>& data) {
+    PerChannelQuantizeAndPopulate<int32_t>(bias_, data);
+  }
+  void SetWeights(const std::vector<float>& data) {
+    PerChannelQuantizeAndPopulate<int8_t>(weights_, data);
+  }
+  void SetInput(std::initializer_list<float> data) {
+    QuantizeAndPopulate<int8_t>(input_, data);
+  }
+
+  std::vector<int8_t> GetOutput() { return ExtractVector<int8_t>(output_); }
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<int8_t>(ExtractVector<int8_t>(output_),
+                              GetScale(output_), GetZeroPoint(output_));
+  }
+
+ private:
+  static int GetShapeSize(const std::vector<int>& shape) {
+    int size = 1;
+    for (int dim : shape) size *= dim;
+    return size;
+  }
+
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
 // In the hybrid model the weights are quantized (to uint8). But the bias,
 // input (and output) are expected to be in float precision.
 class HybridFullyConnectedOpModel : public SingleOpModel {
@@ -340,6 +467,54 @@ TEST_P(FloatFullyConnectedOpTest, SimpleTest) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(24, 25, 26, 58, 59, 60));
 }
 
+TEST_P(FloatFullyConnectedOpTest, ConstWeightsTest) {
+  // The optimized kernels transpose constant weights once in Prepare.
+  ConstWeightsFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches=*/2, /*input_size=*/10,
+      {
+          1, 2, 3, 4, 5, 6, 7, 8, 9, 10,      // u = 0
+          10, 9, 8, 7, 6, 5, 4, 3, 2, 1,      // u = 1
+          1, -1, 1, -1, 1, -1, 1, -1, 1, -1,  // u = 2
+      });
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAre(24, 166, 0, 58, 154, 34));
+}
+
+TEST_P(FloatFullyConnectedOpTest, SimpleTestSparseWeights) {
+  // The weights are made of 2x4 blocks, of which the top left one is zero:
+  //    0  0  0  0   1    2    3    4
+  //    0  0  0  0  -1   -2   -3   -4
+  //    1  2  1  2   1   -2    3   -4
+  //    3  0  0  1   0.5  0.5  0.5  0.5
+  SparseWeightsFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/4, /*batches=*/2, /*input_size=*/8,
+      /*block_rows=*/2, /*block_cols=*/4,
+      {
+          1, 2, 3, 4, -1, -2, -3, -4,        // Top right block.
+          1, 2, 1, 2, 3, 0, 0, 1,            // Bottom left block.
+          1, -2, 3, -4, 0.5, 0.5, 0.5, 0.5,  // Bottom right block.
+      },
+      /*block_row_offsets=*/{0, 1, 3}, /*block_col_indices=*/{1, 0, 1});
+  m.SetBias({1, 2, 3, 4});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,    // b = 0
+      1, -1, 1, -1, 2, 2, 2, 2,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAre(71, 0, 1, 24, 21, 0, 0, 10));
+}
+
 TEST_P(QuantizedFullyConnectedOpTest, SimpleTestQuantized) {
   QuantizedFullyConnectedOpModel m(
       GetRegistration(), /*units=*/3, /*batches*/ 2,
@@ -368,6 +543,35 @@ TEST_P(QuantizedFullyConnectedOpTest, SimpleTestQuantized) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(151, 152, 153, 185, 186, 187));
 }
 
+// Same as SimpleTestQuantized, with a different scale for each unit.
+TEST_P(QuantizedFullyConnectedOpTest, SimpleTestPerChannelQuantized) {
+  PerChannelQuantizedFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches*/ 2,
+      /*input=*/{TensorType_INT8, {2, 10}, -63.5, 64},
+      /*weight_scales=*/{0.25, 0.125, 0.1},
+      /*output=*/{TensorType_INT8, {}, -127, 128});
+
+  m.SetWeights({
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  // u = 0
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  // u = 1
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10,  // u = 2
+  });
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput(), ElementsAreArray(ArrayFloatNear({
+                                            24, 25, 26,  //
+                                            58, 59, 60,  //
+                                        })));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(23, 24, 25, 57, 58, 59));
+}
+
 TEST(HybridFullyConnectedOpTest, SimpleTestQuantized) {
   HybridFullyConnectedOpModel m(
       /*units=*/3, /*batches=*/2,
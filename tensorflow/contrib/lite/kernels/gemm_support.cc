@@ -14,57 +14,96 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/kernels/gemm_support.h"
 
-#include "tensorflow/contrib/lite/kernels/op_macros.h"
+#include <algorithm>
+#include <limits>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
 
 namespace tflite {
 namespace gemm_support {
 
-struct RefCountedGemmContext {
-  gemmlowp::GemmContext* gemm_context_ = nullptr;
-  int num_references_ = 0;
+struct GemmContextPool : public TfLiteExternalContext {
+  // The number of threads of the multi-threaded GemmContext when the
+  // interpreter doesn't recommend any, and the most it ever gets.
+  int default_num_threads = 1;
+  int max_num_threads = 1;
+
+  std::mutex mutex;
+  // The multi-threaded GemmContext, or null while an op is using it.
+  std::unique_ptr<gemmlowp::GemmContext> multi_threaded;
+  // The single-threaded GemmContexts no op is using.
+  std::vector<std::unique_ptr<gemmlowp::GemmContext>> single_threaded;
 };
 
-void IncrementUsageCounter(TfLiteContext* context) {
-  auto* ptr = reinterpret_cast<RefCountedGemmContext*>(context->gemm_context);
-  if (ptr == nullptr) {
-    ptr = new RefCountedGemmContext;
-    ptr->gemm_context_ = new gemmlowp::GemmContext();
-    if (context->recommended_num_threads != -1) {
-      ptr->gemm_context_->set_max_num_threads(context->recommended_num_threads);
-    }
-    ptr->num_references_ = 0;
-    context->gemm_context = ptr;
+namespace {
+
+GemmContextPool* NewGemmContextPool(int default_num_threads,
+                                    int max_num_threads) {
+  auto* pool = new GemmContextPool;
+  pool->type = kTfLiteGemmLowpContext;
+  pool->Refresh = nullptr;
+  pool->default_num_threads = default_num_threads;
+  pool->max_num_threads = max_num_threads;
+  pool->multi_threaded.reset(new gemmlowp::GemmContext());
+  return pool;
+}
+
+GemmContextPool* GetGemmContextPool(TfLiteContext* context) {
+  TfLiteExternalContext* external_context =
+      context->GetExternalContext(context, kTfLiteGemmLowpContext);
+  if (external_context != nullptr) {
+    return static_cast<GemmContextPool*>(external_context);
   }
-  ptr->num_references_++;
+  // Like gemmlowp itself, the default is single-threaded unless the
+  // interpreter recommends more threads.
+  static GemmContextPool* default_pool =
+      NewGemmContextPool(1, std::numeric_limits<int>::max());
+  return default_pool;
 }
 
-void DecrementUsageCounter(TfLiteContext* context) {
-  auto* ptr = reinterpret_cast<RefCountedGemmContext*>(context->gemm_context);
-  if (ptr == nullptr) {
-    TF_LITE_FATAL(
-        "Call to DecrementUsageCounter() not preceded by "
-        "IncrementUsageCounter()");
+}  // namespace
+
+ScopedGemmContext::ScopedGemmContext(TfLiteContext* context)
+    : pool_(GetGemmContextPool(context)), multi_threaded_(false) {
+  {
+    std::lock_guard<std::mutex> lock(pool_->mutex);
+    if (pool_->multi_threaded) {
+      gemm_context_ = std::move(pool_->multi_threaded);
+      multi_threaded_ = true;
+    } else if (!pool_->single_threaded.empty()) {
+      gemm_context_ = std::move(pool_->single_threaded.back());
+      pool_->single_threaded.pop_back();
+    }
+  }
+  if (!gemm_context_) {
+    gemm_context_.reset(new gemmlowp::GemmContext());
   }
-  if (--ptr->num_references_ == 0) {
-    delete ptr->gemm_context_;
-    delete ptr;
-    context->gemm_context = nullptr;
+
+  int num_threads = 1;
+  if (multi_threaded_) {
+    num_threads = context->recommended_num_threads == -1
+                      ? pool_->default_num_threads
+                      : std::min(context->recommended_num_threads,
+                                 pool_->max_num_threads);
   }
+  gemm_context_->set_max_num_threads(num_threads);
 }
 
-gemmlowp::GemmContext* GetFromContext(TfLiteContext* context) {
-  auto* ptr = reinterpret_cast<RefCountedGemmContext*>(context->gemm_context);
-  if (ptr == nullptr) {
-    TF_LITE_FATAL(
-        "Call to GetFromContext() not preceded by IncrementUsageCounter()");
+ScopedGemmContext::~ScopedGemmContext() {
+  std::lock_guard<std::mutex> lock(pool_->mutex);
+  if (multi_threaded_) {
+    pool_->multi_threaded = std::move(gemm_context_);
+  } else {
+    pool_->single_threaded.push_back(std::move(gemm_context_));
   }
-  return ptr->gemm_context_;
 }
 
-void SetNumThreads(TfLiteContext* context, int num_threads) {
-  IncrementUsageCounter(context);
-  GetFromContext(context)->set_max_num_threads(num_threads);
-  DecrementUsageCounter(context);
+TfLiteExternalContext* CreateSharedContext(int num_threads) {
+  return NewGemmContextPool(num_threads, num_threads);
+}
+
+void DestroySharedContext(TfLiteExternalContext* shared_context) {
+  delete static_cast<GemmContextPool*>(shared_context);
 }
 
 }  // namespace gemm_support
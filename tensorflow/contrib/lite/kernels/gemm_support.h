@@ -15,38 +15,52 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_GEMM_SUPPORT_H_
 #define TENSORFLOW_CONTRIB_LITE_KERNELS_GEMM_SUPPORT_H_
 
+#include <memory>
+
 #include "public/gemmlowp.h"
 #include "tensorflow/contrib/lite/context.h"
 
 namespace tflite {
 namespace gemm_support {
 
-// Returns the GemmContext stored in 'context', allowing multiple ops to
-// share a single object, as long as they share a TfLiteContext. The caller
-// must ensure that this is called between IncrementUsageCounter() and
-// DecrementUsageCounter(). For example, in the implementation of an op:
-//   void* Init(TfLiteContext* context, const char*, size_t) {
-//     gemm_support::IncrementUsageCounter(context);
-//     return nullptr;
-//   }
-//   void Free(TfLiteContext* context, void*) {
-//     gemm_support::DecrementUsageCounter(context);
-//   }
+struct GemmContextPool;
+
+// Gives an op exclusive use of a GemmContext for as long as it lives. For
+// example, in the implementation of an op:
 //   TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
-//     auto* gemm_context = gemm_support::GetFromContext(context);
+//     gemm_support::ScopedGemmContext gemm_context(context);
+//     optimized_ops::Conv(..., gemm_context.get());
 //   }
-gemmlowp::GemmContext* GetFromContext(TfLiteContext* context);
+//
+// The GemmContexts come from the kTfLiteGemmLowpContext external context of
+// 'context', or from a process-wide default if the application set none.
+// Only one op at a time gets the multi-threaded GemmContext, which uses up
+// to context->recommended_num_threads of its worker threads. Ops running at
+// the same time on other threads, e.g. for other interpreters sharing the
+// external context, get single-threaded GemmContexts instead, so that they
+// don't start more gemmlowp threads than there are cores to run them.
+class ScopedGemmContext {
+ public:
+  explicit ScopedGemmContext(TfLiteContext* context);
+  ~ScopedGemmContext();
+  ScopedGemmContext(const ScopedGemmContext&) = delete;
+  ScopedGemmContext& operator=(const ScopedGemmContext&) = delete;
 
-// Let the framework know that the GemmContext stored in 'context' will be used
-// by an op. If necessary a new GemmContext is created and placed in 'context'.
-void IncrementUsageCounter(TfLiteContext* context);
+  gemmlowp::GemmContext* get() const { return gemm_context_.get(); }
 
-// Let the framework know that the op stopped using the GemmContext stored in
-// 'context'. If there are no more usages the GemmContext will be deleted.
-void DecrementUsageCounter(TfLiteContext* context);
+ private:
+  GemmContextPool* pool_;
+  std::unique_ptr<gemmlowp::GemmContext> gemm_context_;
+  bool multi_threaded_;
+};
 
-// Set the number of threads that can be used by gemmlowp.
-void SetNumThreads(TfLiteContext* context, int num_threads);
+// Creates an external context that several interpreters can share through
+// Interpreter::SetExternalContext(kTfLiteGemmLowpContext, ...), so that their
+// ops run on the same, at most 'num_threads', gemmlowp worker threads. Ops use
+// all of them unless their interpreter recommends fewer threads. The context
+// must outlive the interpreters, and be freed with DestroySharedContext().
+TfLiteExternalContext* CreateSharedContext(int num_threads);
+void DestroySharedContext(TfLiteExternalContext* shared_context);
 
 }  // namespace gemm_support
 }  // namespace tflite
@@ -0,0 +1,106 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/kernels/gemm_support.h"
+
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace gemm_support {
+namespace {
+
+// A TfLiteContext holding its external contexts the way the interpreter does.
+class TestContext : public TfLiteContext {
+ public:
+  TestContext() {
+    recommended_num_threads = -1;
+    GetExternalContext = [](TfLiteContext* context,
+                            TfLiteExternalContextType type) {
+      return static_cast<TestContext*>(context)->external_contexts_[type];
+    };
+    SetExternalContext = [](TfLiteContext* context,
+                            TfLiteExternalContextType type,
+                            TfLiteExternalContext* ctx) {
+      static_cast<TestContext*>(context)->external_contexts_[type] = ctx;
+    };
+  }
+
+ private:
+  TfLiteExternalContext* external_contexts_[kTfLiteMaxExternalContexts] = {};
+};
+
+TEST(GemmSupportTest, DefaultContextIsSingleThreaded) {
+  TestContext context;
+  ScopedGemmContext gemm_context(&context);
+  EXPECT_EQ(gemm_context.get()->max_num_threads(), 1);
+}
+
+TEST(GemmSupportTest, RecommendedThreadsAreCappedBySharedContext) {
+  TfLiteExternalContext* shared_context = CreateSharedContext(4);
+  TestContext context;
+  context.SetExternalContext(&context, kTfLiteGemmLowpContext, shared_context);
+  {
+    ScopedGemmContext gemm_context(&context);
+    EXPECT_EQ(gemm_context.get()->max_num_threads(), 4);
+  }
+  context.recommended_num_threads = 2;
+  {
+    ScopedGemmContext gemm_context(&context);
+    EXPECT_EQ(gemm_context.get()->max_num_threads(), 2);
+  }
+  context.recommended_num_threads = 8;
+  {
+    ScopedGemmContext gemm_context(&context);
+    EXPECT_EQ(gemm_context.get()->max_num_threads(), 4);
+  }
+  DestroySharedContext(shared_context);
+}
+
+TEST(GemmSupportTest, ConcurrentUsersGetSingleThreadedContexts) {
+  TfLiteExternalContext* shared_context = CreateSharedContext(4);
+  TestContext context1;
+  TestContext context2;
+  context1.SetExternalContext(&context1, kTfLiteGemmLowpContext,
+                              shared_context);
+  context2.SetExternalContext(&context2, kTfLiteGemmLowpContext,
+                              shared_context);
+  gemmlowp::GemmContext* multi_threaded;
+  {
+    ScopedGemmContext gemm_context1(&context1);
+    ScopedGemmContext gemm_context2(&context2);
+    multi_threaded = gemm_context1.get();
+    EXPECT_NE(gemm_context1.get(), gemm_context2.get());
+    EXPECT_EQ(gemm_context1.get()->max_num_threads(), 4);
+    EXPECT_EQ(gemm_context2.get()->max_num_threads(), 1);
+  }
+  // Once the first user is done, the multi-threaded context is handed out
+  // again.
+  {
+    ScopedGemmContext gemm_context2(&context2);
+    EXPECT_EQ(gemm_context2.get(), multi_threaded);
+    EXPECT_EQ(gemm_context2.get()->max_num_threads(), 4);
+  }
+  DestroySharedContext(shared_context);
+}
+
+}  // namespace
+}  // namespace gemm_support
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
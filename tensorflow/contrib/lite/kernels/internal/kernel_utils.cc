@@ -20,6 +20,38 @@ limitations under the License.
 
 namespace tflite {
 namespace kernel_utils {
+namespace {
+
+// Quantizes each of the n_batch vectors of size v_size in batch_vector, and
+// stores their scaling factors.
+void SymmetricQuantizeBatchVector(const float* batch_vector, int v_size,
+                                  int n_batch, int8_t* quantized_batch_vector,
+                                  float* scaling_factors) {
+  float unused_min, unused_max;
+  for (int b = 0; b < n_batch; ++b) {
+    const int offset = b * v_size;
+    tensor_utils::SymmetricQuantizeFloats(
+        batch_vector + offset, v_size, quantized_batch_vector + offset,
+        &unused_min, &unused_max, &scaling_factors[b]);
+  }
+}
+
+// Accumulates the product of a quantized matrix by a quantized batch vector
+// into result, combining the matrix scale with the per-batch scaling factors
+// of the vectors into product_scaling_factors first.
+void QuantizedMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, float matrix_scale, int m_rows, int m_cols,
+    const int8_t* vectors, const float* scaling_factors, int n_batch,
+    float* product_scaling_factors, float* result) {
+  for (int b = 0; b < n_batch; ++b) {
+    product_scaling_factors[b] = scaling_factors[b] * matrix_scale;
+  }
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      matrix, m_rows, m_cols, vectors, product_scaling_factors, n_batch,
+      result, /*result_stride=*/1);
+}
+
+}  // namespace
 
 void RnnBatchStep(const float* input_ptr_batch, const float* input_weights_ptr,
                   const float* recurrent_weights_ptr, const float* bias_ptr,
@@ -256,5 +288,199 @@ void LstmStep(
                            output_state_ptr);
 }
 
+void LstmStep(
+    const float* input_ptr_batch, const int8_t* input_to_input_weights_ptr,
+    float input_to_input_weights_scale,
+    const int8_t* input_to_forget_weights_ptr,
+    float input_to_forget_weights_scale,
+    const int8_t* input_to_cell_weights_ptr, float input_to_cell_weights_scale,
+    const int8_t* input_to_output_weights_ptr,
+    float input_to_output_weights_scale,
+    const int8_t* recurrent_to_input_weights_ptr,
+    float recurrent_to_input_weights_scale,
+    const int8_t* recurrent_to_forget_weights_ptr,
+    float recurrent_to_forget_weights_scale,
+    const int8_t* recurrent_to_cell_weights_ptr,
+    float recurrent_to_cell_weights_scale,
+    const int8_t* recurrent_to_output_weights_ptr,
+    float recurrent_to_output_weights_scale,
+    const int8_t* cell_to_input_weights_ptr, float cell_to_input_weights_scale,
+    const int8_t* cell_to_forget_weights_ptr,
+    float cell_to_forget_weights_scale,
+    const int8_t* cell_to_output_weights_ptr,
+    float cell_to_output_weights_scale, const float* input_gate_bias_ptr,
+    const float* forget_gate_bias_ptr, const float* cell_bias_ptr,
+    const float* output_gate_bias_ptr, const int8_t* projection_weights_ptr,
+    float projection_weights_scale, const float* projection_bias_ptr,
+    const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
+    int n_output, float* output_state_ptr, float* cell_state_ptr,
+    float* input_gate_scratch, float* forget_gate_scratch, float* cell_scratch,
+    float* output_gate_scratch, float* scaling_factors,
+    float* product_scaling_factors, float* recovered_cell_weights,
+    int8_t* quantized_input_ptr_batch, int8_t* quantized_output_state_ptr,
+    int8_t* quantized_cell_state_ptr, float* output_ptr_batch) {
+  // Since we have already checked that weights are all there or none, we can
+  // check the existense of only one to the get the condition.
+  const bool use_cifg = (input_to_input_weights_ptr == nullptr);
+  const bool use_peephole = (cell_to_output_weights_ptr != nullptr);
+  // Initialize scratch buffers with bias.
+  if (!use_cifg) {
+    tensor_utils::VectorBatchVectorAssign(input_gate_bias_ptr, n_cell, n_batch,
+                                          input_gate_scratch);
+  }
+  tensor_utils::VectorBatchVectorAssign(forget_gate_bias_ptr, n_cell, n_batch,
+                                        forget_gate_scratch);
+  tensor_utils::VectorBatchVectorAssign(cell_bias_ptr, n_cell, n_batch,
+                                        cell_scratch);
+  tensor_utils::VectorBatchVectorAssign(output_gate_bias_ptr, n_cell, n_batch,
+                                        output_gate_scratch);
+
+  // Save quantization and matmul computation for all zero input.
+  if (!tensor_utils::IsZeroVector(input_ptr_batch, n_batch * n_input)) {
+    SymmetricQuantizeBatchVector(input_ptr_batch, n_input, n_batch,
+                                 quantized_input_ptr_batch, scaling_factors);
+
+    // For each batch and cell: compute input_weight * input.
+    if (!use_cifg) {
+      QuantizedMatrixBatchVectorMultiplyAccumulate(
+          input_to_input_weights_ptr, input_to_input_weights_scale, n_cell,
+          n_input, quantized_input_ptr_batch, scaling_factors, n_batch,
+          product_scaling_factors, input_gate_scratch);
+    }
+    QuantizedMatrixBatchVectorMultiplyAccumulate(
+        input_to_forget_weights_ptr, input_to_forget_weights_scale, n_cell,
+        n_input, quantized_input_ptr_batch, scaling_factors, n_batch,
+        product_scaling_factors, forget_gate_scratch);
+    QuantizedMatrixBatchVectorMultiplyAccumulate(
+        input_to_cell_weights_ptr, input_to_cell_weights_scale, n_cell,
+        n_input, quantized_input_ptr_batch, scaling_factors, n_batch,
+        product_scaling_factors, cell_scratch);
+    QuantizedMatrixBatchVectorMultiplyAccumulate(
+        input_to_output_weights_ptr, input_to_output_weights_scale, n_cell,
+        n_input, quantized_input_ptr_batch, scaling_factors, n_batch,
+        product_scaling_factors, output_gate_scratch);
+  }
+
+  // Save quantization and matmul computation for all zero output state, e.g.
+  // at the first step.
+  if (!tensor_utils::IsZeroVector(output_state_ptr, n_batch * n_output)) {
+    SymmetricQuantizeBatchVector(output_state_ptr, n_output, n_batch,
+                                 quantized_output_state_ptr, scaling_factors);
+
+    // For each batch and cell: compute recurrent_weight * output_state.
+    if (!use_cifg) {
+      QuantizedMatrixBatchVectorMultiplyAccumulate(
+          recurrent_to_input_weights_ptr, recurrent_to_input_weights_scale,
+          n_cell, n_output, quantized_output_state_ptr, scaling_factors,
+          n_batch, product_scaling_factors, input_gate_scratch);
+    }
+    QuantizedMatrixBatchVectorMultiplyAccumulate(
+        recurrent_to_forget_weights_ptr, recurrent_to_forget_weights_scale,
+        n_cell, n_output, quantized_output_state_ptr, scaling_factors, n_batch,
+        product_scaling_factors, forget_gate_scratch);
+    QuantizedMatrixBatchVectorMultiplyAccumulate(
+        recurrent_to_cell_weights_ptr, recurrent_to_cell_weights_scale, n_cell,
+        n_output, quantized_output_state_ptr, scaling_factors, n_batch,
+        product_scaling_factors, cell_scratch);
+    QuantizedMatrixBatchVectorMultiplyAccumulate(
+        recurrent_to_output_weights_ptr, recurrent_to_output_weights_scale,
+        n_cell, n_output, quantized_output_state_ptr, scaling_factors, n_batch,
+        product_scaling_factors, output_gate_scratch);
+  }
+
+  // The peephole weights are diagonal matrices, so they are recovered to
+  // float once per step instead of going through the quantized matmul.
+  // Weight scales are quantization scaling factors, hence the inversions.
+  // For each batch and cell: update input gate.
+  if (!use_cifg) {
+    if (use_peephole) {
+      tensor_utils::VectorScalarMultiply(cell_to_input_weights_ptr, n_cell,
+                                         1.0f / cell_to_input_weights_scale,
+                                         recovered_cell_weights);
+      tensor_utils::VectorBatchVectorCwiseProductAccumulate(
+          recovered_cell_weights, n_cell, cell_state_ptr, n_batch,
+          input_gate_scratch);
+    }
+    tensor_utils::ApplySigmoidToVector(input_gate_scratch, n_cell * n_batch,
+                                       input_gate_scratch);
+  }
+
+  // For each batch and cell: update forget gate.
+  if (use_peephole) {
+    tensor_utils::VectorScalarMultiply(cell_to_forget_weights_ptr, n_cell,
+                                       1.0f / cell_to_forget_weights_scale,
+                                       recovered_cell_weights);
+    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
+        recovered_cell_weights, n_cell, cell_state_ptr, n_batch,
+        forget_gate_scratch);
+  }
+  tensor_utils::ApplySigmoidToVector(forget_gate_scratch, n_cell * n_batch,
+                                     forget_gate_scratch);
+
+  // For each batch and cell: update the cell.
+  tensor_utils::VectorVectorCwiseProduct(forget_gate_scratch, cell_state_ptr,
+                                         n_batch * n_cell, cell_state_ptr);
+  tensor_utils::ApplyActivationToVector(cell_scratch, n_batch * n_cell,
+                                        params->activation, cell_scratch);
+  if (use_cifg) {
+    tensor_utils::Sub1Vector(forget_gate_scratch, n_batch * n_cell,
+                             forget_gate_scratch);
+    tensor_utils::VectorVectorCwiseProductAccumulate(
+        cell_scratch, forget_gate_scratch, n_batch * n_cell, cell_state_ptr);
+  } else {
+    tensor_utils::VectorVectorCwiseProductAccumulate(
+        cell_scratch, input_gate_scratch, n_batch * n_cell, cell_state_ptr);
+  }
+  if (params->cell_clip > 0.0) {
+    tensor_utils::ClipVector(cell_state_ptr, n_batch * n_cell,
+                             params->cell_clip, cell_state_ptr);
+  }
+
+  // For each batch and cell: update the output gate.
+  if (use_peephole) {
+    tensor_utils::VectorScalarMultiply(cell_to_output_weights_ptr, n_cell,
+                                       1.0f / cell_to_output_weights_scale,
+                                       recovered_cell_weights);
+    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
+        recovered_cell_weights, n_cell, cell_state_ptr, n_batch,
+        output_gate_scratch);
+  }
+  tensor_utils::ApplySigmoidToVector(output_gate_scratch, n_batch * n_cell,
+                                     output_gate_scratch);
+  tensor_utils::ApplyActivationToVector(cell_state_ptr, n_batch * n_cell,
+                                        params->activation, cell_scratch);
+  tensor_utils::VectorVectorCwiseProduct(output_gate_scratch, cell_scratch,
+                                         n_batch * n_cell, output_gate_scratch);
+
+  // For each batch: update the projection and output_state.
+  const bool use_projection_weight = (projection_weights_ptr != nullptr);
+  const bool use_projection_bias = (projection_bias_ptr != nullptr);
+  if (use_projection_weight) {
+    if (use_projection_bias) {
+      tensor_utils::VectorBatchVectorAssign(projection_bias_ptr, n_output,
+                                            n_batch, output_ptr_batch);
+    } else {
+      tensor_utils::ZeroVector(output_ptr_batch, n_batch * n_output);
+    }
+    if (!tensor_utils::IsZeroVector(output_gate_scratch, n_batch * n_cell)) {
+      SymmetricQuantizeBatchVector(output_gate_scratch, n_cell, n_batch,
+                                   quantized_cell_state_ptr, scaling_factors);
+      QuantizedMatrixBatchVectorMultiplyAccumulate(
+          projection_weights_ptr, projection_weights_scale, n_output, n_cell,
+          quantized_cell_state_ptr, scaling_factors, n_batch,
+          product_scaling_factors, output_ptr_batch);
+    }
+    if (params->proj_clip > 0.0) {
+      tensor_utils::ClipVector(output_ptr_batch, n_batch * n_output,
+                               params->proj_clip, output_ptr_batch);
+    }
+  } else {
+    tensor_utils::CopyVector(output_gate_scratch, n_batch * n_output,
+                             output_ptr_batch);
+  }
+  tensor_utils::CopyVector(output_ptr_batch, n_batch * n_output,
+                           output_state_ptr);
+}
+
 }  // namespace kernel_utils
 }  // namespace tflite
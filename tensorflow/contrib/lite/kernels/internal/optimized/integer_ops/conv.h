@@ -0,0 +1,99 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_CONV_H_
+#define TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_CONV_H_
+
+#include <algorithm>
+
+#include "public/gemmlowp.h"
+#include "tensorflow/contrib/lite/kernels/internal/common.h"
+#include "tensorflow/contrib/lite/kernels/internal/compatibility.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/integer_ops/int8_utils.h"
+#include "tensorflow/contrib/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// Same as reference_integer_ops::ConvPerChannel(). For each output pixel, the
+// part of every filter row that falls inside the input image is contiguous
+// with the matching part of the input row, which makes one dot product per
+// filter row instead of one per filter tap.
+inline void ConvPerChannel(
+    const int8* input_data, const Dims<4>& input_dims, int32 input_offset,
+    const int8* filter_data, const Dims<4>& filter_dims,
+    const int32* bias_data, const Dims<4>& bias_dims, int stride_width,
+    int stride_height, int pad_width, int pad_height,
+    const int32* output_multiplier, const int32* output_shift,
+    int32 output_offset, int32 output_activation_min,
+    int32 output_activation_max, int8* output_data,
+    const Dims<4>& output_dims) {
+  gemmlowp::ScopedProfilingLabel label("ConvPerChannel/8bit");
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  TFLITE_DCHECK(IsPackedWithoutStrides(input_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(filter_dims));
+  const int batches = MatchingArraySize(input_dims, 3, output_dims, 3);
+  const int input_depth = MatchingArraySize(input_dims, 0, filter_dims, 0);
+  const int output_depth = MatchingArraySize(filter_dims, 3, output_dims, 0);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(ArraySize(bias_dims, 0), output_depth);
+  }
+  const int input_height = ArraySize(input_dims, 2);
+  const int input_width = ArraySize(input_dims, 1);
+  const int filter_height = ArraySize(filter_dims, 2);
+  const int filter_width = ArraySize(filter_dims, 1);
+  const int output_height = ArraySize(output_dims, 2);
+  const int output_width = ArraySize(output_dims, 1);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = (out_y * stride_height) - pad_height;
+      const int filter_y_start = std::max(0, -in_y_origin);
+      const int filter_y_end =
+          std::min(filter_height, input_height - in_y_origin);
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = (out_x * stride_width) - pad_width;
+        const int filter_x_start = std::max(0, -in_x_origin);
+        const int filter_x_end =
+            std::min(filter_width, input_width - in_x_origin);
+        // Zero when the whole filter falls in the padding.
+        const int row_size =
+            std::max(0, filter_x_end - filter_x_start) * input_depth;
+        int8* output_ptr =
+            output_data + Offset(output_dims, 0, out_x, out_y, batch);
+        for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+          int32 acc = bias_data ? bias_data[out_channel] : 0;
+          for (int filter_y = filter_y_start;
+               row_size > 0 && filter_y < filter_y_end; ++filter_y) {
+            const int8* input_row =
+                input_data + Offset(input_dims, 0, in_x_origin + filter_x_start,
+                                    in_y_origin + filter_y, batch);
+            const int8* filter_row =
+                filter_data + Offset(filter_dims, 0, filter_x_start, filter_y,
+                                     out_channel);
+            acc += DotProductWithOffset(input_row, filter_row, row_size,
+                                        input_offset);
+          }
+          output_ptr[out_channel] = RequantizeToInt8(
+              acc, output_multiplier[out_channel], output_shift[out_channel],
+              output_offset, output_activation_min, output_activation_max);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_CONV_H_
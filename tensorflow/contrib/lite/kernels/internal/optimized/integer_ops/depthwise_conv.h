@@ -0,0 +1,124 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DEPTHWISE_CONV_H_
+#define TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DEPTHWISE_CONV_H_
+
+#include <algorithm>
+
+#include "public/gemmlowp.h"
+#include "tensorflow/contrib/lite/kernels/internal/common.h"
+#include "tensorflow/contrib/lite/kernels/internal/compatibility.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/integer_ops/int8_utils.h"
+#include "tensorflow/contrib/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
+#include "tensorflow/contrib/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// Same as reference_integer_ops::DepthwiseConvPerChannel(). With a depth
+// multiplier of 1, input and output channels line up, so the accumulators of
+// a block of channels of an output pixel are updated together, one filter tap
+// at a time. Other depth multipliers use the reference implementation.
+inline void DepthwiseConvPerChannel(
+    const int8* input_data, const Dims<4>& input_dims, int32 input_offset,
+    const int8* filter_data, const Dims<4>& filter_dims,
+    const int32* bias_data, const Dims<4>& bias_dims, int stride_width,
+    int stride_height, int pad_width, int pad_height, int depth_multiplier,
+    const int32* output_multiplier, const int32* output_shift,
+    int32 output_offset, int32 output_activation_min,
+    int32 output_activation_max, int8* output_data,
+    const Dims<4>& output_dims) {
+  gemmlowp::ScopedProfilingLabel label("DepthwiseConvPerChannel/8bit");
+  if (depth_multiplier != 1) {
+    reference_integer_ops::DepthwiseConvPerChannel(
+        input_data, input_dims, input_offset, filter_data, filter_dims,
+        bias_data, bias_dims, stride_width, stride_height, pad_width,
+        pad_height, depth_multiplier, output_multiplier, output_shift,
+        output_offset, output_activation_min, output_activation_max,
+        output_data, output_dims);
+    return;
+  }
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  TFLITE_DCHECK(IsPackedWithoutStrides(input_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(filter_dims));
+  const int batches = MatchingArraySize(input_dims, 3, output_dims, 3);
+  const int depth =
+      MatchingArraySize(input_dims, 0, filter_dims, 0, output_dims, 0);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(ArraySize(bias_dims, 0), depth);
+  }
+  const int input_height = ArraySize(input_dims, 2);
+  const int input_width = ArraySize(input_dims, 1);
+  const int filter_height = ArraySize(filter_dims, 2);
+  const int filter_width = ArraySize(filter_dims, 1);
+  const int output_height = ArraySize(output_dims, 2);
+  const int output_width = ArraySize(output_dims, 1);
+
+  // Enough channels to amortize the loop overhead, while keeping the
+  // accumulators in the L1 cache.
+  static constexpr int kMaxChannelBlock = 256;
+  int32 acc[kMaxChannelBlock];
+
+  for (int b = 0; b < batches; ++b) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = (out_y * stride_height) - pad_height;
+      const int filter_y_start = std::max(0, -in_y_origin);
+      const int filter_y_end =
+          std::min(filter_height, input_height - in_y_origin);
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = (out_x * stride_width) - pad_width;
+        const int filter_x_start = std::max(0, -in_x_origin);
+        const int filter_x_end =
+            std::min(filter_width, input_width - in_x_origin);
+        int8* output_ptr =
+            output_data + Offset(output_dims, 0, out_x, out_y, b);
+        for (int channel_start = 0; channel_start < depth;
+             channel_start += kMaxChannelBlock) {
+          const int block_size =
+              std::min(kMaxChannelBlock, depth - channel_start);
+          for (int c = 0; c < block_size; ++c) {
+            acc[c] = bias_data ? bias_data[channel_start + c] : 0;
+          }
+          for (int filter_y = filter_y_start; filter_y < filter_y_end;
+               ++filter_y) {
+            for (int filter_x = filter_x_start; filter_x < filter_x_end;
+                 ++filter_x) {
+              const int8* input_ptr =
+                  input_data + Offset(input_dims, channel_start,
+                                      in_x_origin + filter_x,
+                                      in_y_origin + filter_y, b);
+              const int8* filter_ptr =
+                  filter_data +
+                  Offset(filter_dims, channel_start, filter_x, filter_y, 0);
+              MultiplyAccumulateWithOffset(input_ptr, filter_ptr, block_size,
+                                           input_offset, acc);
+            }
+          }
+          for (int c = 0; c < block_size; ++c) {
+            const int channel = channel_start + c;
+            output_ptr[channel] = RequantizeToInt8(
+                acc[c], output_multiplier[channel], output_shift[channel],
+                output_offset, output_activation_min, output_activation_max);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_DEPTHWISE_CONV_H_
@@ -0,0 +1,107 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_INT8_UTILS_H_
+#define TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_INT8_UTILS_H_
+
+#include <algorithm>
+
+#include "tensorflow/contrib/lite/kernels/internal/common.h"
+#include "tensorflow/contrib/lite/kernels/internal/compatibility.h"
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// Returns the sum of (input[i] + input_offset) * filter[i] for i in
+// [0, size). 'input_offset' is minus the zero point of an int8 input, so a
+// sum of it and an input value always fits in 16 bits.
+inline int32 DotProductWithOffset(const int8* input, const int8* filter,
+                                  int size, int32 input_offset) {
+  int i = 0;
+  int32 acc = 0;
+#ifdef USE_NEON
+  const int16x8_t offset = vdupq_n_s16(static_cast<int16>(input_offset));
+  int32x4_t acc0 = vdupq_n_s32(0);
+  int32x4_t acc1 = vdupq_n_s32(0);
+  for (; i <= size - 16; i += 16) {
+    const int8x16_t input_8 = vld1q_s8(input + i);
+    const int8x16_t filter_8 = vld1q_s8(filter + i);
+    const int16x8_t input_lo =
+        vaddq_s16(vmovl_s8(vget_low_s8(input_8)), offset);
+    const int16x8_t input_hi =
+        vaddq_s16(vmovl_s8(vget_high_s8(input_8)), offset);
+    const int16x8_t filter_lo = vmovl_s8(vget_low_s8(filter_8));
+    const int16x8_t filter_hi = vmovl_s8(vget_high_s8(filter_8));
+    acc0 = vmlal_s16(acc0, vget_low_s16(input_lo), vget_low_s16(filter_lo));
+    acc1 = vmlal_s16(acc1, vget_high_s16(input_lo), vget_high_s16(filter_lo));
+    acc0 = vmlal_s16(acc0, vget_low_s16(input_hi), vget_low_s16(filter_hi));
+    acc1 = vmlal_s16(acc1, vget_high_s16(input_hi), vget_high_s16(filter_hi));
+  }
+  for (; i <= size - 8; i += 8) {
+    const int16x8_t input_16 = vaddq_s16(vmovl_s8(vld1_s8(input + i)), offset);
+    const int16x8_t filter_16 = vmovl_s8(vld1_s8(filter + i));
+    acc0 = vmlal_s16(acc0, vget_low_s16(input_16), vget_low_s16(filter_16));
+    acc1 = vmlal_s16(acc1, vget_high_s16(input_16), vget_high_s16(filter_16));
+  }
+  const int32x4_t sum = vaddq_s32(acc0, acc1);
+  const int32x2_t pairs = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+  acc = vget_lane_s32(vpadd_s32(pairs, pairs), 0);
+#endif
+  for (; i < size; ++i) {
+    acc += filter[i] * (input[i] + input_offset);
+  }
+  return acc;
+}
+
+// Adds (input[i] + input_offset) * filter[i] to acc[i] for i in [0, size).
+inline void MultiplyAccumulateWithOffset(const int8* input, const int8* filter,
+                                         int size, int32 input_offset,
+                                         int32* acc) {
+  int i = 0;
+#ifdef USE_NEON
+  const int16x8_t offset = vdupq_n_s16(static_cast<int16>(input_offset));
+  for (; i <= size - 8; i += 8) {
+    const int16x8_t input_16 = vaddq_s16(vmovl_s8(vld1_s8(input + i)), offset);
+    const int16x8_t filter_16 = vmovl_s8(vld1_s8(filter + i));
+    int32x4_t acc_lo = vld1q_s32(acc + i);
+    int32x4_t acc_hi = vld1q_s32(acc + i + 4);
+    acc_lo =
+        vmlal_s16(acc_lo, vget_low_s16(input_16), vget_low_s16(filter_16));
+    acc_hi =
+        vmlal_s16(acc_hi, vget_high_s16(input_16), vget_high_s16(filter_16));
+    vst1q_s32(acc + i, acc_lo);
+    vst1q_s32(acc + i + 4, acc_hi);
+  }
+#endif
+  for (; i < size; ++i) {
+    acc[i] += filter[i] * (input[i] + input_offset);
+  }
+}
+
+// Requantizes the int32 accumulator of an output channel into an int8.
+inline int8 RequantizeToInt8(int32 acc, int32 output_multiplier,
+                             int32 output_shift, int32 output_offset,
+                             int32 output_activation_min,
+                             int32 output_activation_max) {
+  acc = MultiplyByQuantizedMultiplier(acc, output_multiplier, output_shift);
+  acc += output_offset;
+  acc = std::max(acc, output_activation_min);
+  acc = std::min(acc, output_activation_max);
+  return static_cast<int8>(acc);
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_INT8_UTILS_H_
@@ -23,6 +23,7 @@ limitations under the License.
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 #include <tuple>
 #include <type_traits>
 
@@ -50,18 +51,27 @@ class EigenThreadPoolWrapper : public Eigen::ThreadPoolInterface {
   Eigen::ThreadPool* pool_ = nullptr;
 };
 
+// The number of threads a convolution splits its work for if the interpreter
+// doesn't recommend any.
+constexpr int kDefaultThreadCount = 4;
+
 // We have a single global threadpool for all convolution operations. This means
 // that inferences started from different threads may block each other, but
 // since the underlying resource of CPU cores should be consumed by the
-// operations anyway, it shouldn't affect overall performance.
-const Eigen::ThreadPoolDevice& GetThreadPoolDevice() {
-  const int thread_count = 4;
-  static Eigen::ThreadPool* tp = new Eigen::ThreadPool(thread_count);
+// operations anyway, it shouldn't affect overall performance. Each operation
+// splits its work for 'thread_count' threads of the pool, so that interpreters
+// sharing it can be given different shares of the cores.
+inline Eigen::ThreadPoolDevice GetThreadPoolDevice(int thread_count) {
+  static const int pool_thread_count = std::max<int>(
+      kDefaultThreadCount, std::thread::hardware_concurrency());
+  static Eigen::ThreadPool* tp = new Eigen::ThreadPool(pool_thread_count);
   static EigenThreadPoolWrapper* thread_pool_wrapper =
       new EigenThreadPoolWrapper(tp);
-  static Eigen::ThreadPoolDevice* device =
-      new Eigen::ThreadPoolDevice(thread_pool_wrapper, thread_count);
-  return *device;
+  if (thread_count == -1) {
+    thread_count = kDefaultThreadCount;
+  }
+  return Eigen::ThreadPoolDevice(thread_pool_wrapper,
+                                 std::min(thread_count, pool_thread_count));
 }
 
 // Shorthands for the types we need when interfacing with the EigenTensor
@@ -118,8 +128,9 @@ class EigenTensorConvFunctor {
                   const T* filter_data, int filter_height, int filter_width,
                   int filter_count, int stride_rows, int stride_cols,
                   int pad_width, int pad_height, TfLitePadding padding,
-                  T* output_data, int output_height, int output_width) {
-    const Eigen::ThreadPoolDevice& device = GetThreadPoolDevice();
+                  T* output_data, int output_height, int output_width,
+                  int thread_count) {
+    const Eigen::ThreadPoolDevice device = GetThreadPoolDevice(thread_count);
 
     const bool is_1x1_kernel = (filter_height == 1 && filter_width == 1 &&
                                 stride_rows == 1 && stride_cols == 1);
@@ -169,7 +180,8 @@ inline void Conv(const float* input_data, const Dims<4>& input_dims,
                  int pad_height, TfLitePadding padding,
                  float output_activation_min, float output_activation_max,
                  float* output_data, const Dims<4>& output_dims,
-                 float* im2col_data, const Dims<4>& im2col_dims) {
+                 float* im2col_data, const Dims<4>& im2col_dims,
+                 int thread_count) {
   const int batches = MatchingArraySize(input_dims, 3, output_dims, 3);
   const int input_depth = MatchingArraySize(input_dims, 0, filter_dims, 0);
   const int output_depth = MatchingArraySize(filter_dims, 3, output_dims, 0);
@@ -183,7 +195,8 @@ inline void Conv(const float* input_data, const Dims<4>& input_dims,
   conv_functor(input_data, im2col_data, batches, input_height, input_width,
                input_depth, filter_data, filter_height, filter_width,
                output_depth, stride_height, stride_width, pad_height, pad_width,
-               padding, output_data, output_height, output_width);
+               padding, output_data, output_height, output_width,
+               thread_count);
 
   optimized_ops::AddBiasAndEvalActivationFunction(
       bias_data, bias_dims, output_data, output_dims, output_activation_min,
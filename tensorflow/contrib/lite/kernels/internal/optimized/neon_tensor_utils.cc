@@ -43,6 +43,71 @@ void* aligned_alloc(size_t alignment, size_t size, void** freeing_buffer) {
              : ((char*)*freeing_buffer + (alignment - offset));  // NOLINT
 }
 
+// Returns the dot product of two int8 vectors of size m_cols, both of which
+// must be 4-byte aligned.
+int32 NeonInt8DotProduct(const int8* row_ptr, const int8* vector_ptr,
+                         int m_cols) {
+  const int kWeightsPerUint32 = 4;
+  const int kWeightsPerNeonLane = 16;
+  // If m_cols is not at least kWeightsPerNeonLane, we cannot use the main
+  // vectorized loop, and we need to process sequentially. postamble_start shows
+  // the start index where this should happen.
+  const int postamble_start = m_cols - (m_cols & (kWeightsPerNeonLane - 1));
+
+  // Initialize the dot product sum for the row to 0.
+  int32x4_t dotprod = vmovq_n_s32(0);
+
+  // For every block of 16 8-bit elements.
+  int col = 0;
+  for (; col < postamble_start; col += kWeightsPerNeonLane) {
+    // Load 16 8-bit values from the row and vector, each, to operate on.
+    // Here the assumption is that each buffer is 4-byte aligned.
+    TFLITE_CHECK_EQ((uintptr_t)(&row_ptr[col]) & (kWeightsPerUint32 - 1), 0);
+    const int8x16_t s1_8x16 = vld1q_s8((const int8_t*)(vector_ptr + col));
+    const int8x16_t s2_8x16 = vld1q_s8((const int8_t*)(row_ptr + col));
+    // Multiply the low bits (i.e. the lower 8 8bit numbers in the
+    // registers).
+    int16x8_t prod_16x8 = vmull_s8(vget_low_s8(s1_8x16), vget_low_s8(s2_8x16));
+    // Multiply the high bits (i.e. the lower 8 8bit numbers in the
+    // registers), and accumulate with the result of the low bits product.
+    // The assumption here is that overflow will not happen as we quantize
+    // our values to be in the range [-127, 127]. As such the sum of the 2
+    // products is always strictly smaller than 15-bits (32767 in absolute
+    // value).
+    prod_16x8 =
+        vmlal_s8(prod_16x8, vget_high_s8(s1_8x16), vget_high_s8(s2_8x16));
+
+    dotprod = vpadalq_s16(dotprod, prod_16x8);
+  }  // for col
+
+  int32 postable_sum = 0;
+  // Postamble loop.
+  // TODO(raziel): if (ABSL_PREDICT_FALSE(postamble_start < m_rows))
+  if (postamble_start < m_cols) {
+    col = postamble_start;
+    if ((m_cols - postamble_start) >= (kWeightsPerNeonLane >> 1)) {
+      // Load 8 8-bit values from the row and column each to operate on.
+      // Here the assumption is that each buffer is 4-bytes aligned.
+      TFLITE_CHECK_EQ((uintptr_t)(&row_ptr[col]) & (kWeightsPerUint32 - 1),
+                      0);
+      const int8x8_t s1_8x8 = vld1_s8((const int8_t*)(vector_ptr + col));
+      const int8x8_t s2_8x8 = vld1_s8((const int8_t*)(row_ptr + col));
+      const int16x8_t prod_16x8 = vmull_s8(s1_8x8, s2_8x8);
+      dotprod = vpadalq_s16(dotprod, prod_16x8);
+      col += (kWeightsPerNeonLane >> 1);
+    }
+    for (; col < m_cols; ++col) {
+      postable_sum += row_ptr[col] * vector_ptr[col];
+    }  // for col
+  }
+  // Add the 4 intermediate sum values to get the final dot-prod value for
+  // this row.
+  int64x2_t pairwiseAdded = vpaddlq_s32(dotprod);
+  int32 neon_sum =
+      vgetq_lane_s64(pairwiseAdded, 0) + vgetq_lane_s64(pairwiseAdded, 1);
+  return neon_sum + postable_sum;
+}
+
 }  // namespace
 
 void NeonMatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
@@ -62,8 +127,55 @@ void NeonMatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
           sizeof(float32x4_t), (postamble_start >> 2) * sizeof(float32x4_t),
           &aligned_vector_cache_free));
 
+  // Batches are first processed four at a time, going through the matrix only
+  // once: each row is loaded once for the four of them, and stays in cache for
+  // the next four.
+  const int kBatchTileSize = 4;
+  const int batch_tiles_end = n_batch & ~(kBatchTileSize - 1);
+  for (int r = 0; r < m_rows; r++) {
+    const float* matrix_ptr = matrix + r * m_cols;
+    for (int b = 0; b < batch_tiles_end; b += kBatchTileSize) {
+      const float* vector0 = vector + b * m_cols;
+      const float* vector1 = vector0 + m_cols;
+      const float* vector2 = vector1 + m_cols;
+      const float* vector3 = vector2 + m_cols;
+      float32x4_t acc0_32x4 = vmovq_n_f32(0.0);
+      float32x4_t acc1_32x4 = vmovq_n_f32(0.0);
+      float32x4_t acc2_32x4 = vmovq_n_f32(0.0);
+      float32x4_t acc3_32x4 = vmovq_n_f32(0.0);
+      for (int c = 0; c < postamble_start; c += kFloatWeightsPerNeonLane) {
+        const float32x4_t m_f32x4 = vld1q_f32(matrix_ptr + c);
+        acc0_32x4 = vmlaq_f32(acc0_32x4, m_f32x4, vld1q_f32(vector0 + c));
+        acc1_32x4 = vmlaq_f32(acc1_32x4, m_f32x4, vld1q_f32(vector1 + c));
+        acc2_32x4 = vmlaq_f32(acc2_32x4, m_f32x4, vld1q_f32(vector2 + c));
+        acc3_32x4 = vmlaq_f32(acc3_32x4, m_f32x4, vld1q_f32(vector3 + c));
+      }
+      float sum0 = vgetq_lane_f32(acc0_32x4, 0) + vgetq_lane_f32(acc0_32x4, 1) +
+                   vgetq_lane_f32(acc0_32x4, 2) + vgetq_lane_f32(acc0_32x4, 3);
+      float sum1 = vgetq_lane_f32(acc1_32x4, 0) + vgetq_lane_f32(acc1_32x4, 1) +
+                   vgetq_lane_f32(acc1_32x4, 2) + vgetq_lane_f32(acc1_32x4, 3);
+      float sum2 = vgetq_lane_f32(acc2_32x4, 0) + vgetq_lane_f32(acc2_32x4, 1) +
+                   vgetq_lane_f32(acc2_32x4, 2) + vgetq_lane_f32(acc2_32x4, 3);
+      float sum3 = vgetq_lane_f32(acc3_32x4, 0) + vgetq_lane_f32(acc3_32x4, 1) +
+                   vgetq_lane_f32(acc3_32x4, 2) + vgetq_lane_f32(acc3_32x4, 3);
+      for (int c = postamble_start; c < m_cols; c++) {
+        sum0 += matrix_ptr[c] * vector0[c];
+        sum1 += matrix_ptr[c] * vector1[c];
+        sum2 += matrix_ptr[c] * vector2[c];
+        sum3 += matrix_ptr[c] * vector3[c];
+      }
+      float* result_ptr = result + (b * m_rows + r) * result_stride;
+      const int batch_stride = m_rows * result_stride;
+      result_ptr[0] += sum0;
+      result_ptr[batch_stride] += sum1;
+      result_ptr[2 * batch_stride] += sum2;
+      result_ptr[3 * batch_stride] += sum3;
+    }
+  }
+
+  // The remaining batches are processed one at a time.
   const int kUnrollSize = 2;
-  for (int b = 0; b < n_batch; b++) {
+  for (int b = batch_tiles_end; b < n_batch; b++) {
     float* result_in_batch = result + b * m_rows * result_stride;
     const float* vector_in_batch = vector + b * m_cols;
 
@@ -134,12 +246,52 @@ void NeonMatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
   free(aligned_vector_cache_free);
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* matrix, int m_rows, int m_cols, int block_rows,
+    int block_cols, const int* block_row_offsets, const int* block_col_indices,
+    const float* vectors, int n_batch, float* result, int result_stride) {
+  // Rows of blocks are only vectorized when they split evenly into lanes.
+  if (block_cols & (kFloatWeightsPerNeonLane - 1)) {
+    PortableSparseMatrixBatchVectorMultiplyAccumulate(
+        matrix, m_rows, m_cols, block_rows, block_cols, block_row_offsets,
+        block_col_indices, vectors, n_batch, result, result_stride);
+    return;
+  }
+  const int block_size = block_rows * block_cols;
+  const int num_block_rows = m_rows / block_rows;
+  for (int b = 0; b < n_batch; b++) {
+    const float* vector_in_batch = vectors + b * m_cols;
+    float* result_in_batch = result + b * m_rows * result_stride;
+    for (int block_row = 0; block_row < num_block_rows; ++block_row) {
+      const int first_block = block_row_offsets[block_row];
+      const int last_block = block_row_offsets[block_row + 1];
+      for (int r = 0; r < block_rows; r++) {
+        // Accumulate the row across all the stored blocks before reducing the
+        // lanes, so that there is a single horizontal add per output.
+        float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+        for (int k = first_block; k < last_block; ++k) {
+          const float* row_ptr = matrix + k * block_size + r * block_cols;
+          const float* vector_block =
+              vector_in_batch + block_col_indices[k] * block_cols;
+          for (int c = 0; c < block_cols; c += kFloatWeightsPerNeonLane) {
+            float32x4_t m_f32x4 = vld1q_f32(row_ptr + c);
+            float32x4_t v_f32x4 = vld1q_f32(vector_block + c);
+            acc_32x4 = vmlaq_f32(acc_32x4, m_f32x4, v_f32x4);
+          }
+        }
+        result_in_batch[(block_row * block_rows + r) * result_stride] +=
+            (vgetq_lane_f32(acc_32x4, 0) + vgetq_lane_f32(acc_32x4, 1) +
+             vgetq_lane_f32(acc_32x4, 2) + vgetq_lane_f32(acc_32x4, 3));
+      }
+    }
+  }
+}
+
 void NeonMatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
     const int8_t* __restrict__ vectors, const float* scaling_factors,
     int n_batch, float* __restrict__ result, int result_stride) {
   const int kWeightsPerUint32 = 4;
-  const int kWeightsPerNeonLane = 16;
   // If the number of rows is not divisible by kWeightsPerUint32, we set a
   // flag and allocate an aligned memory block. The flag is used to use the
   // aligned memory block later in the kernel loop.
@@ -151,90 +303,40 @@ void NeonMatrixBatchVectorMultiplyAccumulate(
     aligned_row = (int8*)aligned_alloc(kWeightsPerUint32, m_cols,  // NOLINT
                                        &aligned_row_free);
   }
+  // Copy all the batches to aligned vectors, so that the matrix can be gone
+  // through only once, multiplying each row by all the batches while it is in
+  // cache.
+  const int aligned_cols =
+      (m_cols + kWeightsPerUint32 - 1) & ~(kWeightsPerUint32 - 1);
   void* aligned_vec_free = nullptr;
-  int8* aligned_vec = (int8*)aligned_alloc(kWeightsPerUint32, m_cols,  // NOLINT
-                                           &aligned_vec_free);
+  int8* aligned_vec =
+      (int8*)aligned_alloc(kWeightsPerUint32,  // NOLINT
+                           n_batch * aligned_cols, &aligned_vec_free);
+  for (int batch = 0; batch < n_batch; ++batch) {
+    memcpy(aligned_vec + batch * aligned_cols, vectors + batch * m_cols,
+           sizeof(int8) * m_cols);
+  }
 
-  // If m_cols is not at least kWeightsPerNeonLane, we cannot use the main
-  // vectorized loop, and we need to process sequentially. postamble_start shows
-  // the start index where this should happen.
-  const int postamble_start = m_cols - (m_cols & (kWeightsPerNeonLane - 1));
+  for (int row = 0; row < m_rows; ++row) {
+    // Get the address of the first element of the row.
+    int8* row_ptr = (int8*)matrix + row * m_cols;  // NOLINT
+    if (unaligned) {
+      memcpy(aligned_row, row_ptr, sizeof(int8) * m_cols);
+      row_ptr = aligned_row;
+    }
 
-  int batch, row, col;
-  for (batch = 0; batch < n_batch; ++batch) {
-    const float batch_scaling_factor_inv = 1.0 / scaling_factors[batch];
-    // Copy the vector data to an aligned vector.
-    memcpy(aligned_vec, vectors + batch * m_cols, sizeof(int8) * m_cols);
-    // Compute dot-product for every column.
-    for (row = 0; row < m_rows; ++row, result += result_stride) {
-      // Get the address of the first element of the row.
-      int8* row_ptr = (int8*)matrix + row * m_cols;  // NOLINT
-      if (unaligned) {
-        memcpy(aligned_row, row_ptr, sizeof(int8) * m_cols);
-        row_ptr = aligned_row;
-      }
+    // Prefetch the row to cache.
+    __builtin_prefetch(row_ptr, 0 /* prefetch for read */,
+                       3 /* temporal locality */);
 
-      // Initialize the dot product sum for the row to 0.
-      int32x4_t dotprod = vmovq_n_s32(0);
-
-      // Prefetch the row to cache.
-      __builtin_prefetch(row_ptr, 0 /* prefetch for read */,
-                         3 /* temporal locality */);
-
-      // For every block of 16 8-bit elements.
-      col = 0;
-      for (; col < postamble_start; col += kWeightsPerNeonLane) {
-        // Load 16 8-bit values from the row and vector, each, to operate on.
-        // Here the assumption is that each buffer is 4-byte aligned.
-        TFLITE_CHECK_EQ((uintptr_t)(&row_ptr[col]) & (kWeightsPerUint32 - 1),
-                        0);
-        const int8x16_t s1_8x16 = vld1q_s8((const int8_t*)(aligned_vec + col));
-        const int8x16_t s2_8x16 = vld1q_s8((const int8_t*)(row_ptr + col));
-        // Multiply the low bits (i.e. the lower 8 8bit numbers in the
-        // registers).
-        int16x8_t prod_16x8 =
-            vmull_s8(vget_low_s8(s1_8x16), vget_low_s8(s2_8x16));
-        // Multiply the high bits (i.e. the lower 8 8bit numbers in the
-        // registers), and accumulate with the result of the low bits product.
-        // The assumption here is that overflow will not happen as we quantize
-        // our values to be in the range [-127, 127]. As such the sum of the 2
-        // products is always strictly smaller than 15-bits (32767 in absolute
-        // value).
-        prod_16x8 =
-            vmlal_s8(prod_16x8, vget_high_s8(s1_8x16), vget_high_s8(s2_8x16));
-
-        dotprod = vpadalq_s16(dotprod, prod_16x8);
-      }  // for col
-
-      int32 postable_sum = 0;
-      // Postamble loop.
-      // TODO(raziel): if (ABSL_PREDICT_FALSE(postamble_start < m_rows))
-      if (postamble_start < m_cols) {
-        col = postamble_start;
-        if ((m_cols - postamble_start) >= (kWeightsPerNeonLane >> 1)) {
-          // Load 8 8-bit values from the row and column each to operate on.
-          // Here the assumption is that each buffer is 4-bytes aligned.
-          TFLITE_CHECK_EQ((uintptr_t)(&row_ptr[col]) & (kWeightsPerUint32 - 1),
-                          0);
-          const int8x8_t s1_8x8 = vld1_s8((const int8_t*)(aligned_vec + col));
-          const int8x8_t s2_8x8 = vld1_s8((const int8_t*)(row_ptr + col));
-          const int16x8_t prod_16x8 = vmull_s8(s1_8x8, s2_8x8);
-          dotprod = vpadalq_s16(dotprod, prod_16x8);
-          col += (kWeightsPerNeonLane >> 1);
-        }
-        for (; col < m_cols; ++col) {
-          postable_sum += row_ptr[col] * aligned_vec[col];
-        }  // for col
-      }
-      // Add the 4 intermediate sum values to get the final dot-prod value for
-      // this row.
-      int64x2_t pairwiseAdded = vpaddlq_s32(dotprod);
-      int32 neon_sum =
-          vgetq_lane_s64(pairwiseAdded, 0) + vgetq_lane_s64(pairwiseAdded, 1);
-
-      *result += ((neon_sum + postable_sum) * batch_scaling_factor_inv);
-    }  // for row
-  }    // for batch
+    for (int batch = 0; batch < n_batch; ++batch) {
+      const float batch_scaling_factor_inv = 1.0 / scaling_factors[batch];
+      const int32 dotprod = NeonInt8DotProduct(
+          row_ptr, aligned_vec + batch * aligned_cols, m_cols);
+      result[(batch * m_rows + row) * result_stride] +=
+          dotprod * batch_scaling_factor_inv;
+    }  // for batch
+  }    // for row
 
   if (unaligned) {
     free(aligned_row_free);
@@ -331,6 +433,47 @@ void NeonVectorBatchVectorCwiseProductAccumulate(const float* vector,
   free(aligned_vector_cache_free);
 }
 
+void NeonVectorScalarMultiply(const int8_t* vector, const int v_size,
+                              const float scale, float* result) {
+  // If v_size is not divisible by kWeightsPerNeonLane, we cannot use the main
+  // vectorized loop, and we need to process sequentially. postamble_start shows
+  // the start index where this should happen.
+  const int kWeightsPerNeonLane = 16;
+  const int postamble_start = v_size - (v_size & (kWeightsPerNeonLane - 1));
+
+  // Create a vector of 4 floats with the scale value.
+  const float32x4_t scale_f32x4 = vdupq_n_f32(scale);
+  int v = 0;
+  for (; v < postamble_start; v += kWeightsPerNeonLane) {
+    // Load int8 values, sixteen at a time, and widen them to int16 and then
+    // to int32 before converting them to float.
+    const int8x16_t inputs = vld1q_s8(vector + v);
+    const int16x8_t first_half = vmovl_s8(vget_low_s8(inputs));
+    const int16x8_t second_half = vmovl_s8(vget_high_s8(inputs));
+    const int32x4_t first_quarter = vmovl_s16(vget_low_s16(first_half));
+    const int32x4_t second_quarter = vmovl_s16(vget_high_s16(first_half));
+    const int32x4_t third_quarter = vmovl_s16(vget_low_s16(second_half));
+    const int32x4_t fourth_quarter = vmovl_s16(vget_high_s16(second_half));
+    const float32x4_t result0 =
+        vmulq_f32(vcvtq_f32_s32(first_quarter), scale_f32x4);
+    const float32x4_t result1 =
+        vmulq_f32(vcvtq_f32_s32(second_quarter), scale_f32x4);
+    const float32x4_t result2 =
+        vmulq_f32(vcvtq_f32_s32(third_quarter), scale_f32x4);
+    const float32x4_t result3 =
+        vmulq_f32(vcvtq_f32_s32(fourth_quarter), scale_f32x4);
+    vst1q_f32(result + v, result0);
+    vst1q_f32(result + v + 4, result1);
+    vst1q_f32(result + v + 8, result2);
+    vst1q_f32(result + v + 12, result3);
+  }
+
+  // Postamble loop.
+  for (; v < v_size; v++) {
+    result[v] = scale * vector[v];
+  }
+}
+
 void NeonSub1Vector(const float* vector, int v_size, float* result) {
   // If v_size is not divisible by kWeightsPerNeonLane, we cannot use the main
   // vectorized loop, and we need to process sequentially. postamble_start shows
@@ -40,6 +40,15 @@ void MatrixBatchVectorMultiplyAccumulate(
                    vectors, scaling_factors, n_batch, result, result_stride);
 }
 
+void SparseMatrixBatchVectorMultiplyAccumulate(
+    const float* matrix, int m_rows, int m_cols, int block_rows,
+    int block_cols, const int* block_row_offsets, const int* block_col_indices,
+    const float* vectors, int n_batch, float* result, int result_stride) {
+  NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate, matrix, m_rows,
+                   m_cols, block_rows, block_cols, block_row_offsets,
+                   block_col_indices, vectors, n_batch, result, result_stride);
+}
+
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result) {
   NEON_OR_PORTABLE(VectorVectorCwiseProduct, vector1, vector2, v_size, result);
@@ -59,6 +68,11 @@ void VectorBatchVectorCwiseProductAccumulate(const float* vector, int v_size,
                    batch_vector, n_batch, result);
 }
 
+void VectorScalarMultiply(const int8_t* vector, int v_size, float scale,
+                          float* result) {
+  NEON_OR_PORTABLE(VectorScalarMultiply, vector, v_size, scale, result);
+}
+
 float VectorVectorDotProduct(const float* vector1, const float* vector2,
                              int v_size) {
   return NEON_OR_PORTABLE(VectorVectorDotProduct, vector1, vector2, v_size);
@@ -903,6 +903,34 @@ inline void FullyConnected(const float* input_data, const Dims<4>& input_dims,
                                    output_activation_max);
 }
 
+// Same as FullyConnected() above, but with the weights transposed, i.e. with
+// the output depth as their innermost dimension. That is the column-major
+// layout in which Eigen packs the left-hand side of a GEMM most cheaply, so
+// ops with constant weights can transpose them once rather than have them
+// gathered row by row on every call. 'weights_dims' are the dimensions of
+// the weights before they were transposed.
+inline void FullyConnectedWithTransposedWeights(
+    const float* input_data, const Dims<4>& input_dims,
+    const float* transposed_weights_data, const Dims<4>& weights_dims,
+    const float* bias_data, const Dims<4>& bias_dims,
+    float output_activation_min, float output_activation_max,
+    float* output_data, const Dims<4>& output_dims) {
+  gemmlowp::ScopedProfilingLabel label("FullyConnectedWithTransposedWeights");
+  const int input_rows = ArraySize(weights_dims, 0);
+  const int output_depth = FlatSizeSkipDim(weights_dims, 0);
+  const auto input_matrix_map =
+      MapAsMatrixWithGivenNumberOfRows(input_data, input_dims, input_rows);
+  const MatrixMap<const float> filter_matrix_map(transposed_weights_data,
+                                                 output_depth, input_rows);
+  auto output_matrix_map =
+      MapAsMatrixWithFirstDimAsRows(output_data, output_dims);
+
+  Gemm(filter_matrix_map, input_matrix_map, &output_matrix_map);
+  AddBiasAndEvalActivationFunction(bias_data, bias_dims, output_data,
+                                   output_dims, output_activation_min,
+                                   output_activation_max);
+}
+
 // legacy, for compatibility with old checked-in code
 template <FusedActivationFunctionType Ac>
 void FullyConnected(const float* input_data, const Dims<4>& input_dims,
@@ -1877,6 +1905,12 @@ inline void DilatedConv(const float* input_data, const Dims<4>& input_dims,
   }
 }
 
+// If 'transposed_filter_data' is not null, it holds the filter transposed,
+// i.e. with the output depth as its innermost dimension, and the GEMM reads
+// the filter from it instead of from 'filter_data'. That is the column-major
+// layout in which Eigen packs the left-hand side of a GEMM most cheaply, so
+// ops with constant filters can transpose them once rather than have them
+// gathered row by row on every call. Dilated convolutions don't use it.
 inline void Conv(const float* input_data, const Dims<4>& input_dims,
                  const float* filter_data, const Dims<4>& filter_dims,
                  const float* bias_data, const Dims<4>& bias_dims,
@@ -1884,7 +1918,8 @@ inline void Conv(const float* input_data, const Dims<4>& input_dims,
                  int dilation_height_factor, int pad_width, int pad_height,
                  float output_activation_min, float output_activation_max,
                  float* output_data, const Dims<4>& output_dims,
-                 float* im2col_data, const Dims<4>& im2col_dims) {
+                 float* im2col_data, const Dims<4>& im2col_dims,
+                 const float* transposed_filter_data) {
   if ((dilation_width_factor != 1) || (dilation_height_factor != 1)) {
     return DilatedConv(input_data, input_dims, filter_data, filter_dims,
                        bias_data, bias_dims, stride_width, stride_height,
@@ -1920,18 +1955,40 @@ inline void Conv(const float* input_data, const Dims<4>& input_dims,
 
   const auto im2col_matrix_map =
       MapAsMatrixWithFirstDimAsRows(gemm_input_data, *gemm_input_dims);
-  const auto filter_matrix_map =
-      MapAsMatrixWithLastDimAsCols(filter_data, filter_dims);
   auto output_matrix_map =
       MapAsMatrixWithFirstDimAsRows(output_data, output_dims);
 
-  Gemm(filter_matrix_map.transpose(), im2col_matrix_map, &output_matrix_map);
+  if (transposed_filter_data) {
+    const MatrixMap<const float> filter_matrix_map(
+        transposed_filter_data, ArraySize(filter_dims, 3),
+        FlatSizeSkipDim(filter_dims, 3));
+    Gemm(filter_matrix_map, im2col_matrix_map, &output_matrix_map);
+  } else {
+    const auto filter_matrix_map =
+        MapAsMatrixWithLastDimAsCols(filter_data, filter_dims);
+    Gemm(filter_matrix_map.transpose(), im2col_matrix_map, &output_matrix_map);
+  }
 
   AddBiasAndEvalActivationFunction(bias_data, bias_dims, output_data,
                                    output_dims, output_activation_min,
                                    output_activation_max);
 }
 
+inline void Conv(const float* input_data, const Dims<4>& input_dims,
+                 const float* filter_data, const Dims<4>& filter_dims,
+                 const float* bias_data, const Dims<4>& bias_dims,
+                 int stride_width, int stride_height, int dilation_width_factor,
+                 int dilation_height_factor, int pad_width, int pad_height,
+                 float output_activation_min, float output_activation_max,
+                 float* output_data, const Dims<4>& output_dims,
+                 float* im2col_data, const Dims<4>& im2col_dims) {
+  Conv(input_data, input_dims, filter_data, filter_dims, bias_data, bias_dims,
+       stride_width, stride_height, dilation_width_factor,
+       dilation_height_factor, pad_width, pad_height, output_activation_min,
+       output_activation_max, output_data, output_dims, im2col_data,
+       im2col_dims, /*transposed_filter_data=*/nullptr);
+}
+
 template <FusedActivationFunctionType Ac>
 void Conv(const float* input_data, const Dims<4>& input_dims,
           const float* filter_data, const Dims<4>& filter_dims,
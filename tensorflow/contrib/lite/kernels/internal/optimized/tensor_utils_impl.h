@@ -50,6 +50,16 @@ void NeonMatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ vectors, const float* scaling_factors,
     int n_batch, float* __restrict__ result, int result_stride);
 
+// Matrix multiplication for block-sparse matrices.
+void PortableSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* matrix, int m_rows, int m_cols, int block_rows,
+    int block_cols, const int* block_row_offsets, const int* block_col_indices,
+    const float* vectors, int n_batch, float* result, int result_stride);
+void NeonSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* matrix, int m_rows, int m_cols, int block_rows,
+    int block_cols, const int* block_row_offsets, const int* block_col_indices,
+    const float* vectors, int n_batch, float* result, int result_stride);
+
 // Cwise product of two vectors.
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
@@ -95,6 +105,12 @@ void NeonVectorBatchVectorCwiseProductAccumulate(const float* vector,
                                                  const float* batch_vector,
                                                  int n_batch, float* result);
 
+// Multiply all elements of an int8 vector by a scale.
+void PortableVectorScalarMultiply(const int8_t* vector, int v_size,
+                                  float scale, float* result);
+void NeonVectorScalarMultiply(const int8_t* vector, int v_size, float scale,
+                              float* result);
+
 // Compute "1.0f - elements of vector" (used in CIFG).
 void PortableSub1Vector(const float* vector, int v_size, float* result);
 void NeonSub1Vector(const float* vector, int v_size, float* result);
@@ -0,0 +1,328 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_WINOGRAD_CONV_H_
+#define TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_WINOGRAD_CONV_H_
+
+// A float Conv for 3x3 filters with unit strides and dilations, based on the
+// Winograd F(4x4, 3x3) minimal filtering algorithm (Lavin & Gray, "Fast
+// Algorithms for Convolutional Neural Networks"). Each 4x4 output tile is
+// computed from a 6x6 input tile with 36 multiplications per input and output
+// channel pair, instead of 144 for the direct convolution.
+//
+// The input, filter and output tiles are transformed one channel vector at a
+// time, so that the innermost loops run over contiguous channels and get
+// vectorized by the compiler. The products in the transformed domain are 36
+// independent GEMMs, which go through Eigen like the other optimized kernels.
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/contrib/lite/kernels/internal/common.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace winograd_ops {
+
+// The size of the output tiles, and of the input tiles they are computed from.
+constexpr int kOutputTileSize = 4;
+constexpr int kInputTileSize = 6;
+constexpr int kNumTileElements = kInputTileSize * kInputTileSize;
+
+// Below this many input or output channels the transforms cost more than the
+// multiplications they save.
+constexpr int kMinDepth = 8;
+
+// The number of floats of scratch space Conv() aims to stay within.
+constexpr int kScratchBudget = 1 << 20;
+
+// Returns true if Conv() handles, and is expected to speed up, a convolution
+// with the given filter, strides and dilations.
+inline bool IsSupported(const Dims<4>& filter_dims, int stride_width,
+                        int stride_height, int dilation_width_factor,
+                        int dilation_height_factor) {
+  return ArraySize(filter_dims, 1) == 3 && ArraySize(filter_dims, 2) == 3 &&
+         stride_width == 1 && stride_height == 1 &&
+         dilation_width_factor == 1 && dilation_height_factor == 1 &&
+         ArraySize(filter_dims, 0) >= kMinDepth &&
+         ArraySize(filter_dims, 3) >= kMinDepth;
+}
+
+// Returns the number of floats of the filter, once transformed by
+// TransformFilter().
+inline int TransformedFilterSize(const Dims<4>& filter_dims) {
+  return kNumTileElements * ArraySize(filter_dims, 0) *
+         ArraySize(filter_dims, 3);
+}
+
+// Computes U = G g G^T for every pair of input and output channels of the
+// 3x3 filter 'g'. The result is stored as 36 column-major matrices of
+// [output_depth, input_depth], one for each element of U.
+inline void TransformFilter(const float* filter_data,
+                            const Dims<4>& filter_dims,
+                            float* transformed_filter_data) {
+  static constexpr float G[kInputTileSize][3] = {
+      {1.0f / 4, 0, 0},
+      {-1.0f / 6, -1.0f / 6, -1.0f / 6},
+      {-1.0f / 6, 1.0f / 6, -1.0f / 6},
+      {1.0f / 24, 1.0f / 12, 1.0f / 6},
+      {1.0f / 24, -1.0f / 12, 1.0f / 6},
+      {0, 0, 1},
+  };
+  const int input_depth = ArraySize(filter_dims, 0);
+  const int output_depth = ArraySize(filter_dims, 3);
+  const int matrix_size = input_depth * output_depth;
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    for (int in_c = 0; in_c < input_depth; ++in_c) {
+      // Gg, a 6x3 matrix.
+      float gg[kInputTileSize][3];
+      for (int i = 0; i < kInputTileSize; ++i) {
+        for (int x = 0; x < 3; ++x) {
+          gg[i][x] = 0;
+          for (int y = 0; y < 3; ++y) {
+            gg[i][x] += G[i][y] *
+                        filter_data[Offset(filter_dims, in_c, x, y, out_c)];
+          }
+        }
+      }
+      float* u = transformed_filter_data + in_c * output_depth + out_c;
+      for (int i = 0; i < kInputTileSize; ++i) {
+        for (int j = 0; j < kInputTileSize; ++j) {
+          float value = 0;
+          for (int x = 0; x < 3; ++x) {
+            value += gg[i][x] * G[j][x];
+          }
+          u[(i * kInputTileSize + j) * matrix_size] = value;
+        }
+      }
+    }
+  }
+}
+
+// Applies B^T to the 6 vectors of 'depth' floats at 'in', 'in_stride' floats
+// apart, and writes the 6 resulting vectors 'out_stride' floats apart.
+inline void TransformInputVectors(const float* in, int in_stride, float* out,
+                                  int out_stride, int depth) {
+  const float* d0 = in;
+  const float* d1 = d0 + in_stride;
+  const float* d2 = d1 + in_stride;
+  const float* d3 = d2 + in_stride;
+  const float* d4 = d3 + in_stride;
+  const float* d5 = d4 + in_stride;
+  float* r0 = out;
+  float* r1 = r0 + out_stride;
+  float* r2 = r1 + out_stride;
+  float* r3 = r2 + out_stride;
+  float* r4 = r3 + out_stride;
+  float* r5 = r4 + out_stride;
+  for (int c = 0; c < depth; ++c) {
+    r0[c] = 4 * d0[c] - 5 * d2[c] + d4[c];
+    r1[c] = -4 * (d1[c] + d2[c]) + d3[c] + d4[c];
+    r2[c] = 4 * (d1[c] - d2[c]) - d3[c] + d4[c];
+    r3[c] = 2 * (d3[c] - d1[c]) - d2[c] + d4[c];
+    r4[c] = 2 * (d1[c] - d3[c]) - d2[c] + d4[c];
+    r5[c] = 4 * d1[c] - 5 * d3[c] + d5[c];
+  }
+}
+
+// Applies A^T to the 6 vectors of 'depth' floats at 'in', 'in_stride' floats
+// apart, and writes the 4 resulting vectors 'out_stride' floats apart.
+inline void TransformOutputVectors(const float* in, int in_stride, float* out,
+                                   int out_stride, int depth) {
+  const float* m0 = in;
+  const float* m1 = m0 + in_stride;
+  const float* m2 = m1 + in_stride;
+  const float* m3 = m2 + in_stride;
+  const float* m4 = m3 + in_stride;
+  const float* m5 = m4 + in_stride;
+  float* o0 = out;
+  float* o1 = o0 + out_stride;
+  float* o2 = o1 + out_stride;
+  float* o3 = o2 + out_stride;
+  for (int c = 0; c < depth; ++c) {
+    const float sum12 = m1[c] + m2[c];
+    const float diff12 = m1[c] - m2[c];
+    const float sum34 = m3[c] + m4[c];
+    const float diff34 = m3[c] - m4[c];
+    o0[c] = m0[c] + sum12 + sum34;
+    o1[c] = diff12 + 2 * diff34;
+    o2[c] = sum12 + 4 * sum34;
+    o3[c] = diff12 + 8 * diff34 + m5[c];
+  }
+}
+
+// Returns the number of tiles Conv() transforms at a time.
+inline int TilesPerBlock(const Dims<4>& filter_dims, int num_tiles) {
+  const int depths = ArraySize(filter_dims, 0) + ArraySize(filter_dims, 3);
+  const int budgeted = kScratchBudget / (kNumTileElements * depths);
+  return std::max(1, std::min(num_tiles, std::max(16, budgeted)));
+}
+
+// Returns the number of floats of scratch space Conv() needs.
+inline int ScratchSize(const Dims<4>& filter_dims, const Dims<4>& output_dims) {
+  const int tiles_y =
+      (ArraySize(output_dims, 2) + kOutputTileSize - 1) / kOutputTileSize;
+  const int tiles_x =
+      (ArraySize(output_dims, 1) + kOutputTileSize - 1) / kOutputTileSize;
+  const int num_tiles = ArraySize(output_dims, 3) * tiles_y * tiles_x;
+  const int input_depth = ArraySize(filter_dims, 0);
+  const int output_depth = ArraySize(filter_dims, 3);
+  // The transformed input and output of a block of tiles, and two tiles to
+  // transform one tile at a time.
+  return kNumTileElements *
+         (TilesPerBlock(filter_dims, num_tiles) * (input_depth + output_depth) +
+          2 * std::max(input_depth, output_depth));
+}
+
+// 'transformed_filter_data' must hold the result of TransformFilter(), and
+// 'scratch_data' ScratchSize() floats.
+inline void Conv(const float* input_data, const Dims<4>& input_dims,
+                 const float* transformed_filter_data,
+                 const Dims<4>& filter_dims, const float* bias_data,
+                 const Dims<4>& bias_dims, int pad_width, int pad_height,
+                 float output_activation_min, float output_activation_max,
+                 float* output_data, const Dims<4>& output_dims,
+                 float* scratch_data) {
+  gemmlowp::ScopedProfilingLabel label("Conv/Winograd");
+  const int batches = MatchingArraySize(input_dims, 3, output_dims, 3);
+  const int input_depth = MatchingArraySize(input_dims, 0, filter_dims, 0);
+  const int output_depth = MatchingArraySize(filter_dims, 3, output_dims, 0);
+  const int input_height = ArraySize(input_dims, 2);
+  const int input_width = ArraySize(input_dims, 1);
+  const int output_height = ArraySize(output_dims, 2);
+  const int output_width = ArraySize(output_dims, 1);
+  TFLITE_DCHECK_EQ(ArraySize(filter_dims, 1), 3);
+  TFLITE_DCHECK_EQ(ArraySize(filter_dims, 2), 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(ArraySize(bias_dims, 0), output_depth);
+  }
+
+  const int tiles_y = (output_height + kOutputTileSize - 1) / kOutputTileSize;
+  const int tiles_x = (output_width + kOutputTileSize - 1) / kOutputTileSize;
+  const int num_tiles = batches * tiles_y * tiles_x;
+  const int tiles_per_block = TilesPerBlock(filter_dims, num_tiles);
+
+  // For each of the 36 elements of a tile, the transformed input holds an
+  // [input_depth, tiles] and the transformed output an [output_depth, tiles]
+  // column-major matrix.
+  float* transformed_input = scratch_data;
+  float* transformed_output =
+      transformed_input + kNumTileElements * tiles_per_block * input_depth;
+  float* tile =
+      transformed_output + kNumTileElements * tiles_per_block * output_depth;
+  float* half_transformed_tile =
+      tile + kNumTileElements * std::max(input_depth, output_depth);
+
+  const int filter_matrix_size = input_depth * output_depth;
+  for (int block_start = 0; block_start < num_tiles;
+       block_start += tiles_per_block) {
+    const int block_size = std::min(tiles_per_block, num_tiles - block_start);
+    const int input_matrix_size = block_size * input_depth;
+    const int output_matrix_size = block_size * output_depth;
+
+    // V = B^T d B, for every 6x6 tile d of the (zero-padded) input.
+    for (int t = 0; t < block_size; ++t) {
+      const int tile_index = block_start + t;
+      const int b = tile_index / (tiles_y * tiles_x);
+      const int in_y_origin =
+          (tile_index / tiles_x) % tiles_y * kOutputTileSize - pad_height;
+      const int in_x_origin =
+          tile_index % tiles_x * kOutputTileSize - pad_width;
+      for (int i = 0; i < kInputTileSize; ++i) {
+        const int in_y = in_y_origin + i;
+        for (int j = 0; j < kInputTileSize; ++j) {
+          const int in_x = in_x_origin + j;
+          float* dst = tile + (i * kInputTileSize + j) * input_depth;
+          if (in_y >= 0 && in_y < input_height && in_x >= 0 &&
+              in_x < input_width) {
+            memcpy(dst, input_data + Offset(input_dims, 0, in_x, in_y, b),
+                   input_depth * sizeof(float));
+          } else {
+            memset(dst, 0, input_depth * sizeof(float));
+          }
+        }
+      }
+      for (int j = 0; j < kInputTileSize; ++j) {
+        TransformInputVectors(tile + j * input_depth,
+                              kInputTileSize * input_depth,
+                              half_transformed_tile + j * input_depth,
+                              kInputTileSize * input_depth, input_depth);
+      }
+      for (int i = 0; i < kInputTileSize; ++i) {
+        TransformInputVectors(
+            half_transformed_tile + i * kInputTileSize * input_depth,
+            input_depth,
+            transformed_input + i * kInputTileSize * input_matrix_size +
+                t * input_depth,
+            input_matrix_size, input_depth);
+      }
+    }
+
+    // M = U V, element by element of the tiles.
+    for (int k = 0; k < kNumTileElements; ++k) {
+      const optimized_ops::MatrixMap<const float> filter_matrix(
+          transformed_filter_data + k * filter_matrix_size, output_depth,
+          input_depth);
+      const optimized_ops::MatrixMap<const float> input_matrix(
+          transformed_input + k * input_matrix_size, input_depth, block_size);
+      optimized_ops::MatrixMap<float> output_matrix(
+          transformed_output + k * output_matrix_size, output_depth,
+          block_size);
+      optimized_ops::Gemm(filter_matrix, input_matrix, &output_matrix);
+    }
+
+    // Y = A^T M A, for every tile, plus the bias and activation.
+    for (int t = 0; t < block_size; ++t) {
+      const int tile_index = block_start + t;
+      const int b = tile_index / (tiles_y * tiles_x);
+      const int out_y_origin =
+          (tile_index / tiles_x) % tiles_y * kOutputTileSize;
+      const int out_x_origin = tile_index % tiles_x * kOutputTileSize;
+      for (int j = 0; j < kInputTileSize; ++j) {
+        TransformOutputVectors(
+            transformed_output + j * output_matrix_size + t * output_depth,
+            kInputTileSize * output_matrix_size,
+            half_transformed_tile + j * output_depth,
+            kInputTileSize * output_depth, output_depth);
+      }
+      for (int i = 0; i < kOutputTileSize; ++i) {
+        TransformOutputVectors(
+            half_transformed_tile + i * kInputTileSize * output_depth,
+            output_depth, tile + i * kOutputTileSize * output_depth,
+            output_depth, output_depth);
+      }
+      const int rows = std::min(kOutputTileSize, output_height - out_y_origin);
+      const int cols = std::min(kOutputTileSize, output_width - out_x_origin);
+      for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+          const float* src = tile + (i * kOutputTileSize + j) * output_depth;
+          float* dst = output_data + Offset(output_dims, 0, out_x_origin + j,
+                                            out_y_origin + i, b);
+          for (int c = 0; c < output_depth; ++c) {
+            const float bias = bias_data ? bias_data[c] : 0.0f;
+            dst[c] = ActivationFunctionWithMinMax(src[c] + bias,
+                                                  output_activation_min,
+                                                  output_activation_max);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace winograd_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_WINOGRAD_CONV_H_
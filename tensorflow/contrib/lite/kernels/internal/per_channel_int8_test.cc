@@ -0,0 +1,202 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/kernels/internal/optimized/integer_ops/conv.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/integer_ops/depthwise_conv.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/integer_ops/fully_connected.h"
+#include "tensorflow/contrib/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "tensorflow/contrib/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
+#include "tensorflow/contrib/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+#include "tensorflow/contrib/lite/kernels/internal/test_util.h"
+#include "tensorflow/contrib/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace {
+
+// Random quantization parameters for the output channels of a layer.
+struct PerChannelParams {
+  explicit PerChannelParams(int output_depth)
+      : output_multiplier(output_depth), output_shift(output_depth) {
+    for (int c = 0; c < output_depth; ++c) {
+      output_multiplier[c] =
+          UniformRandomInt(1 << 30, std::numeric_limits<std::int32_t>::max());
+      output_shift[c] = UniformRandomInt(-12, -7);
+    }
+    input_offset = UniformRandomInt(-127, 128);
+    output_offset = UniformRandomInt(-128, 127);
+    output_activation_min = -128;
+    output_activation_max = 127;
+    if (UniformRandomInt(0, 1)) {
+      output_activation_min = UniformRandomInt(-128, -50);
+      output_activation_max = UniformRandomInt(50, 127);
+    }
+  }
+
+  std::int32_t input_offset;
+  std::vector<std::int32_t> output_multiplier;
+  std::vector<std::int32_t> output_shift;
+  std::int32_t output_offset;
+  std::int32_t output_activation_min;
+  std::int32_t output_activation_max;
+};
+
+std::vector<std::int8_t> RandomInt8s(int size) {
+  std::vector<std::int32_t> values(size);
+  FillRandom(&values, -127, 127);
+  return std::vector<std::int8_t>(values.begin(), values.end());
+}
+
+bool TryTestConv(bool depthwise) {
+  const int batch = ExponentialRandomPositiveInt(0.9f, 2, 4);
+  const int input_depth = ExponentialRandomPositiveInt(0.9f, 20, 100);
+  const int input_width = ExponentialRandomPositiveInt(0.9f, 10, 40);
+  const int input_height = ExponentialRandomPositiveInt(0.9f, 10, 40);
+  const int filter_width = ExponentialRandomPositiveInt(0.9f, 4, 7);
+  const int filter_height = ExponentialRandomPositiveInt(0.9f, 4, 7);
+  const int stride = ExponentialRandomPositiveInt(0.9f, 2, 4);
+  const int depth_multiplier =
+      depthwise && UniformRandomInt(0, 1) ? UniformRandomInt(2, 3) : 1;
+  const int output_depth = depthwise
+                               ? input_depth * depth_multiplier
+                               : ExponentialRandomPositiveInt(0.9f, 20, 100);
+  const auto padding_type =
+      UniformRandomInt(0, 1) ? PaddingType::kSame : PaddingType::kValid;
+
+  Dims<4> input_dims =
+      MakeDimsForInference(input_depth, input_width, input_height, batch);
+  Dims<4> output_dims;
+  int pad_width, pad_height;
+  if (!ComputeConvSizes(input_dims, output_depth, filter_width, filter_height,
+                        stride, padding_type, &output_dims, &pad_width,
+                        &pad_height)) {
+    return false;
+  }
+  Dims<4> filter_dims =
+      depthwise ? MakeDimsForInference(output_depth, filter_width,
+                                       filter_height, 1)
+                : MakeDimsForInference(input_depth, filter_width,
+                                       filter_height, output_depth);
+  Dims<4> bias_dims = MakeDimsForInference(output_depth, 1, 1, 1);
+
+  const std::vector<std::int8_t> input_data =
+      RandomInt8s(RequiredBufferSizeForDims(input_dims));
+  const std::vector<std::int8_t> filter_data =
+      RandomInt8s(RequiredBufferSizeForDims(filter_dims));
+  std::vector<std::int32_t> bias_data(output_depth);
+  FillRandom(&bias_data, -10000, 10000);
+  const PerChannelParams params(output_depth);
+
+  const int output_size = RequiredBufferSizeForDims(output_dims);
+  std::vector<std::int8_t> output_data(output_size);
+  std::vector<std::int8_t> reference_output_data(output_size);
+  if (depthwise) {
+    reference_integer_ops::DepthwiseConvPerChannel(
+        input_data.data(), input_dims, params.input_offset, filter_data.data(),
+        filter_dims, bias_data.data(), bias_dims, stride, stride, pad_width,
+        pad_height, depth_multiplier, params.output_multiplier.data(),
+        params.output_shift.data(), params.output_offset,
+        params.output_activation_min, params.output_activation_max,
+        reference_output_data.data(), output_dims);
+    optimized_integer_ops::DepthwiseConvPerChannel(
+        input_data.data(), input_dims, params.input_offset, filter_data.data(),
+        filter_dims, bias_data.data(), bias_dims, stride, stride, pad_width,
+        pad_height, depth_multiplier, params.output_multiplier.data(),
+        params.output_shift.data(), params.output_offset,
+        params.output_activation_min, params.output_activation_max,
+        output_data.data(), output_dims);
+  } else {
+    reference_integer_ops::ConvPerChannel(
+        input_data.data(), input_dims, params.input_offset, filter_data.data(),
+        filter_dims, bias_data.data(), bias_dims, stride, stride, pad_width,
+        pad_height, params.output_multiplier.data(),
+        params.output_shift.data(), params.output_offset,
+        params.output_activation_min, params.output_activation_max,
+        reference_output_data.data(), output_dims);
+    optimized_integer_ops::ConvPerChannel(
+        input_data.data(), input_dims, params.input_offset, filter_data.data(),
+        filter_dims, bias_data.data(), bias_dims, stride, stride, pad_width,
+        pad_height, params.output_multiplier.data(),
+        params.output_shift.data(), params.output_offset,
+        params.output_activation_min, params.output_activation_max,
+        output_data.data(), output_dims);
+  }
+  EXPECT_EQ(output_data, reference_output_data);
+  return true;
+}
+
+void TestOneFullyConnected() {
+  const int batch = ExponentialRandomPositiveInt(0.9f, 3, 20);
+  const int accum_depth = ExponentialRandomPositiveInt(0.9f, 100, 1000);
+  const int output_depth = ExponentialRandomPositiveInt(0.9f, 20, 200);
+  Dims<4> input_dims = MakeDimsForInference(accum_depth, batch, 1, 1);
+  Dims<4> filter_dims = MakeDimsForInference(accum_depth, output_depth, 1, 1);
+  Dims<4> bias_dims = MakeDimsForInference(output_depth, 1, 1, 1);
+  Dims<4> output_dims = MakeDimsForInference(output_depth, batch, 1, 1);
+
+  const std::vector<std::int8_t> input_data =
+      RandomInt8s(RequiredBufferSizeForDims(input_dims));
+  const std::vector<std::int8_t> filter_data =
+      RandomInt8s(RequiredBufferSizeForDims(filter_dims));
+  std::vector<std::int32_t> bias_data(output_depth);
+  FillRandom(&bias_data, -10000, 10000);
+  const PerChannelParams params(output_depth);
+
+  const int output_size = RequiredBufferSizeForDims(output_dims);
+  std::vector<std::int8_t> output_data(output_size);
+  std::vector<std::int8_t> reference_output_data(output_size);
+  reference_integer_ops::FullyConnectedPerChannel(
+      input_data.data(), input_dims, params.input_offset, filter_data.data(),
+      filter_dims, bias_data.data(), bias_dims,
+      params.output_multiplier.data(), params.output_shift.data(),
+      params.output_offset, params.output_activation_min,
+      params.output_activation_max, reference_output_data.data(), output_dims);
+  optimized_integer_ops::FullyConnectedPerChannel(
+      input_data.data(), input_dims, params.input_offset, filter_data.data(),
+      filter_dims, bias_data.data(), bias_dims,
+      params.output_multiplier.data(), params.output_shift.data(),
+      params.output_offset, params.output_activation_min,
+      params.output_activation_max, output_data.data(), output_dims);
+  EXPECT_EQ(output_data, reference_output_data);
+}
+
+TEST(PerChannelInt8Test, Conv) {
+  const int kTestsToRun = 100;
+  for (int i = 0; i < kTestsToRun; i++) {
+    while (!TryTestConv(/*depthwise=*/false)) {
+    }
+  }
+}
+
+TEST(PerChannelInt8Test, DepthwiseConv) {
+  const int kTestsToRun = 300;
+  for (int i = 0; i < kTestsToRun; i++) {
+    while (!TryTestConv(/*depthwise=*/true)) {
+    }
+  }
+}
+
+TEST(PerChannelInt8Test, FullyConnected) {
+  const int kTestsToRun = 300;
+  for (int i = 0; i < kTestsToRun; i++) {
+    TestOneFullyConnected();
+  }
+}
+
+}  // namespace
+}  // namespace tflite
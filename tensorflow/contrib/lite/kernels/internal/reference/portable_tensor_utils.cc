@@ -65,15 +65,46 @@ void PortableMatrixBatchVectorMultiplyAccumulate(const float* matrix,
                                                  const float* vector,
                                                  int n_batch, float* result,
                                                  int result_stride) {
-  float* result_in_batch = result;
-  for (int b = 0; b < n_batch; b++) {
-    const float* matrix_ptr = matrix;
-    for (int r = 0; r < m_rows; r++) {
-      const float* vector_in_batch = vector + b * m_cols;
+  // Go through the matrix once, multiplying each row by all the batches while
+  // it is in cache.
+  const float* matrix_ptr = matrix;
+  for (int r = 0; r < m_rows; r++, matrix_ptr += m_cols) {
+    const float* vector_in_batch = vector;
+    for (int b = 0; b < n_batch; b++, vector_in_batch += m_cols) {
+      float dot_prod = 0.0f;
       for (int c = 0; c < m_cols; c++) {
-        *result_in_batch += *matrix_ptr++ * *vector_in_batch++;
+        dot_prod += matrix_ptr[c] * vector_in_batch[c];
+      }
+      result[(b * m_rows + r) * result_stride] += dot_prod;
+    }
+  }
+}
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* matrix, int m_rows, int m_cols, int block_rows,
+    int block_cols, const int* block_row_offsets, const int* block_col_indices,
+    const float* vectors, int n_batch, float* result, int result_stride) {
+  const int block_size = block_rows * block_cols;
+  const int num_block_rows = m_rows / block_rows;
+  for (int b = 0; b < n_batch; b++) {
+    const float* vector_in_batch = vectors + b * m_cols;
+    float* result_in_batch = result + b * m_rows * result_stride;
+    for (int block_row = 0; block_row < num_block_rows; ++block_row) {
+      for (int k = block_row_offsets[block_row];
+           k < block_row_offsets[block_row + 1]; ++k) {
+        const float* block_ptr = matrix + k * block_size;
+        const float* vector_block =
+            vector_in_batch + block_col_indices[k] * block_cols;
+        float* result_block =
+            result_in_batch + block_row * block_rows * result_stride;
+        for (int r = 0; r < block_rows; r++) {
+          float dot_prod = 0.0f;
+          for (int c = 0; c < block_cols; c++) {
+            dot_prod += *block_ptr++ * vector_block[c];
+          }
+          result_block[r * result_stride] += dot_prod;
+        }
       }
-      result_in_batch += result_stride;
     }
   }
 }
@@ -84,23 +115,25 @@ void PortableMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ scaling_factors, int n_batch,
     float* __restrict__ result, int result_stride) {
   int batch, row, col;
-  for (batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
-    const float batch_scaling_factor_inv = 1.0 / scaling_factors[batch];
-    // Get the address of the first row.
-    const int8_t* row_ptr = matrix;
-    for (row = 0; row < m_rows; ++row, result += result_stride) {
+  // Go through the matrix once, multiplying each row by all the batches while
+  // it is in cache.
+  const int8_t* row_ptr = matrix;
+  for (row = 0; row < m_rows; ++row, row_ptr += m_cols) {
+    // Prefetch the row to cache.
+    __builtin_prefetch(row_ptr, 0 /* prefetch for read */,
+                       3 /* temporal locality */);
+    const int8_t* vector_in_batch = vectors;
+    for (batch = 0; batch < n_batch; ++batch, vector_in_batch += m_cols) {
+      const float batch_scaling_factor_inv = 1.0 / scaling_factors[batch];
       // Initialize the dot product sum for the row to 0.
       int32_t dotprod = 0;
-      // Prefetch the row to cache.
-      __builtin_prefetch(row_ptr, 0 /* prefetch for read */,
-                         3 /* temporal locality */);
-      // For every block of 16 8-bit elements (128-bit register) from each row.
-      for (col = 0; col < m_cols; ++col, ++row_ptr) {
-        dotprod += (*row_ptr) * (vectors[col]);
+      for (col = 0; col < m_cols; ++col) {
+        dotprod += row_ptr[col] * vector_in_batch[col];
       }  // for col
-      *result += (dotprod * batch_scaling_factor_inv);
-    }  // for row
-  }    // for batch
+      result[(batch * m_rows + row) * result_stride] +=
+          dotprod * batch_scaling_factor_inv;
+    }  // for batch
+  }    // for row
 }
 
 void PortableVectorVectorCwiseProduct(const float* vector1,
@@ -184,6 +217,13 @@ void PortableCopyVector(const float* vector, int v_size, float* result) {
   memcpy(result, vector, v_size * sizeof(float));
 }
 
+void PortableVectorScalarMultiply(const int8_t* vector, const int v_size,
+                                  const float scale, float* result) {
+  for (int v = 0; v < v_size; ++v) {
+    *result++ = scale * *vector++;
+  }
+}
+
 void PortableSub1Vector(const float* vector, int v_size, float* result) {
   for (int v = 0; v < v_size; v++) {
     *result++ = 1.0f - *vector++;
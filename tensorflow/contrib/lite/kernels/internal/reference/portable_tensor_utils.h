@@ -44,6 +44,11 @@ void PortableMatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ vectors, const float* scaling_factors,
     int n_batch, float* __restrict__ result, int result_stride);
 
+void PortableSparseMatrixBatchVectorMultiplyAccumulate(
+    const float* matrix, int m_rows, int m_cols, int block_rows,
+    int block_cols, const int* block_row_offsets, const int* block_col_indices,
+    const float* vectors, int n_batch, float* result, int result_stride);
+
 // Cwise product of two vectors.
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
@@ -74,6 +79,10 @@ void PortableVectorBatchVectorCwiseProductAccumulate(const float* vector,
                                                      int n_batch,
                                                      float* result);
 
+// Multiply all elements of an int8 vector by a scale.
+void PortableVectorScalarMultiply(const int8_t* vector, int v_size,
+                                  float scale, float* result);
+
 // Batch vector initialization with another vector.
 void PortableVectorBatchVectorAssign(const float* vector, int v_size,
                                      int n_batch, float* batch_vector);
@@ -142,6 +151,15 @@ void MatrixBatchVectorMultiplyAccumulate(
                                               result_stride);
 }
 
+void SparseMatrixBatchVectorMultiplyAccumulate(
+    const float* matrix, int m_rows, int m_cols, int block_rows,
+    int block_cols, const int* block_row_offsets, const int* block_col_indices,
+    const float* vectors, int n_batch, float* result, int result_stride) {
+  PortableSparseMatrixBatchVectorMultiplyAccumulate(
+      matrix, m_rows, m_cols, block_rows, block_cols, block_row_offsets,
+      block_col_indices, vectors, n_batch, result, result_stride);
+}
+
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result) {
   PortableVectorVectorCwiseProduct(vector1, vector2, v_size, result);
@@ -160,6 +178,11 @@ void VectorBatchVectorCwiseProductAccumulate(const float* vector, int v_size,
                                                   n_batch, result);
 }
 
+void VectorScalarMultiply(const int8_t* vector, int v_size, float scale,
+                          float* result) {
+  PortableVectorScalarMultiply(vector, v_size, scale, result);
+}
+
 float VectorVectorDotProduct(const float* vector1, const float* vector2,
                              int v_size) {
   return PortableVectorVectorDotProduct(vector1, vector2, v_size);
@@ -126,6 +126,64 @@ TEST(uKernels, MatrixBatchVectorMultiplyAccumulateTest) {
                                                -1., 3., 7., 3., 23., 3.})));
 }
 
+TEST(uKernels, MatrixBatchVectorMultiplyAccumulateManyBatchesTest) {
+  // Enough batches for both the batched and the single batch code paths.
+  constexpr int kRow = 3;
+  constexpr int kCol = 4;
+  constexpr int kBatch = 5;
+  static float matrix[kRow * kCol] = {1.0,  2.0,  3.0,  4.0,   //
+                                      -1.0, -2.0, -3.0, -4.0,  //
+                                      1.0,  -2.0, 3.0,  -4.0};
+  static float vector[kCol * kBatch] = {1.0, -1.0, 1.0, -1.0,  //
+                                        2.0, -2.0, 2.0, -2.0,  //
+                                        3.0, -3.0, 3.0, -3.0,  //
+                                        4.0, -4.0, 4.0, -4.0,  //
+                                        5.0, -5.0, 5.0, -5.0};
+  std::vector<float> output(kRow * kBatch);
+  std::fill(output.begin(), output.end(), 3.0);
+  MatrixBatchVectorMultiplyAccumulate(matrix, kRow, kCol, vector, kBatch,
+                                      output.data(), /*result_stride=*/1);
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear({1., 5., 13.,    //
+                                                       -1., 7., 23.,   //
+                                                       -3., 9., 33.,   //
+                                                       -5., 11., 43.,  //
+                                                       -7., 13., 53.})));
+}
+
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulateTest) {
+  // A 4x8 matrix of 2x4 blocks, whose top left block is zero and not stored.
+  constexpr int kRow = 4;
+  constexpr int kCol = 8;
+  constexpr int kBatch = 2;
+  static float dense_matrix[kRow * kCol] = {
+      0.0, 0.0, 0.0, 0.0, 1.0,  2.0,  3.0,  4.0,   //
+      0.0, 0.0, 0.0, 0.0, -1.0, -2.0, -3.0, -4.0,  //
+      1.0, 2.0, 1.0, 2.0, 1.0,  -2.0, 3.0,  -4.0,  //
+      3.0, 0.0, 0.0, 1.0, 0.5,  0.5,  0.5,  0.5};
+  static float blocks[3 * 2 * 4] = {
+      1.0, 2.0,  3.0, 4.0,  -1.0, -2.0, -3.0, -4.0,  //
+      1.0, 2.0,  1.0, 2.0,  3.0,  0.0,  0.0,  1.0,   //
+      1.0, -2.0, 3.0, -4.0, 0.5,  0.5,  0.5,  0.5};
+  static int block_row_offsets[] = {0, 1, 3};
+  static int block_col_indices[] = {1, 0, 1};
+  static float vector[kCol * kBatch] = {
+      1.0, -1.0, 1.0, -1.0, 2.0, -2.0, 2.0, -2.0,  //
+      2.0, -2.0, 2.0, -2.0, 1.0, 1.0,  1.0, 1.0};
+
+  std::vector<float> expected(kRow * kBatch * 2);
+  std::fill(expected.begin(), expected.end(), 3.0);
+  MatrixBatchVectorMultiplyAccumulate(dense_matrix, kRow, kCol, vector, kBatch,
+                                      expected.data(), /*result_stride=*/2);
+
+  std::vector<float> output(kRow * kBatch * 2);
+  std::fill(output.begin(), output.end(), 3.0);
+  SparseMatrixBatchVectorMultiplyAccumulate(
+      blocks, kRow, kCol, /*block_rows=*/2, /*block_cols=*/4,
+      block_row_offsets, block_col_indices, vector, kBatch, output.data(),
+      /*result_stride=*/2);
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(expected)));
+}
+
 TEST(uKernels, MatrixBatchVectorMultiplyAccumulateSymmetricQuantizedTest) {
   // Note we use 29 columns as this exercises all the neon kernel: the
   // 16-block SIMD code, the 8-block postamble, and the leftover postamble.
@@ -519,6 +577,22 @@ TEST(uKernels, CopyVectorTest) {
               ElementsAreArray(ArrayFloatNear({0.0, -0.5, 1.0, -1.5, 2.0})));
 }
 
+TEST(uKernels, VectorScalarMultiplyTest) {
+  constexpr int kVectorSize = 29;
+  static int8_t input[kVectorSize];
+  for (int i = 0; i < kVectorSize; ++i) {
+    input[i] = static_cast<int8_t>(i - 14);
+  }
+  const float scale = 0.1f;
+  std::vector<float> output(kVectorSize, 0.0f);
+  VectorScalarMultiply(input, kVectorSize, scale, output.data());
+  std::vector<float> expected;
+  for (int i = 0; i < kVectorSize; ++i) {
+    expected.push_back(scale * (i - 14));
+  }
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(expected)));
+}
+
 TEST(uKernels, Sub1VectorTest) {
   constexpr int kVectorSize = 5;
   static float input[kVectorSize] = {0.0, -0.5, 1.0, -1.5, 2.0};
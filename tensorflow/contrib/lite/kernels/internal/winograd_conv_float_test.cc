@@ -0,0 +1,141 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/kernels/internal/optimized/winograd_conv.h"
+#include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/test_util.h"
+#include "tensorflow/contrib/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace {
+
+// Runs the Winograd Conv and compares against the reference implementation.
+void TestOneWinogradConv(const float* input_data, const Dims<4>& input_dims,
+                         const float* filter_data, const Dims<4>& filter_dims,
+                         const float* bias_data, const Dims<4>& bias_dims,
+                         int pad_width, int pad_height,
+                         float output_activation_min,
+                         float output_activation_max,
+                         const Dims<4>& output_dims) {
+  const int output_buffer_size = RequiredBufferSizeForDims(output_dims);
+  std::vector<float> output_data(output_buffer_size);
+  std::vector<float> reference_output_data(output_buffer_size);
+  reference_ops::Conv(input_data, input_dims, filter_data, filter_dims,
+                      bias_data, bias_dims, 1, 1, 1, 1, pad_width, pad_height,
+                      output_activation_min, output_activation_max,
+                      reference_output_data.data(), output_dims, nullptr,
+                      output_dims);
+
+  std::vector<float> transformed_filter_data(
+      winograd_ops::TransformedFilterSize(filter_dims));
+  std::vector<float> scratch_data(
+      winograd_ops::ScratchSize(filter_dims, output_dims));
+  winograd_ops::TransformFilter(filter_data, filter_dims,
+                                transformed_filter_data.data());
+  winograd_ops::Conv(input_data, input_dims, transformed_filter_data.data(),
+                     filter_dims, bias_data, bias_dims, pad_width, pad_height,
+                     output_activation_min, output_activation_max,
+                     output_data.data(), output_dims, scratch_data.data());
+
+  double sum_abs_diff = 0;
+  float max_abs_val = 0;
+  for (int i = 0; i < output_buffer_size; i++) {
+    sum_abs_diff += std::abs(output_data[i] - reference_output_data[i]);
+    max_abs_val = std::max(max_abs_val, std::abs(reference_output_data[i]));
+  }
+  if (sum_abs_diff != 0.f) {
+    const float mean_diff =
+        static_cast<float>(sum_abs_diff / output_buffer_size);
+    const float relative_error = std::abs(mean_diff) / max_abs_val;
+    ASSERT_LT(relative_error, 1e-5f);
+  }
+}
+
+// This function picks some random Conv params that the Winograd Conv
+// supports. If the resulting output would be empty, it returns false.
+// Otherwise it runs the test and returns true.
+bool TryTestOneWinogradConv() {
+  const int batch = ExponentialRandomPositiveInt(0.9f, 3, 10);
+  const int input_depth =
+      winograd_ops::kMinDepth + ExponentialRandomPositiveInt(0.9f, 20, 100);
+  const int output_depth =
+      winograd_ops::kMinDepth + ExponentialRandomPositiveInt(0.9f, 20, 100);
+  const int input_width = ExponentialRandomPositiveInt(0.9f, 20, 100);
+  const int input_height = ExponentialRandomPositiveInt(0.9f, 20, 100);
+  const int filter_size = 3;
+  Dims<4> input_dims_inference =
+      MakeDimsForInference(input_depth, input_width, input_height, batch);
+  Dims<4> output_dims_inference;
+  int pad_width, pad_height;
+  const auto padding_type =
+      UniformRandomInt(0, 1) ? PaddingType::kSame : PaddingType::kValid;
+  if (!ComputeConvSizes(input_dims_inference, output_depth, filter_size,
+                        filter_size, /*stride=*/1, padding_type,
+                        &output_dims_inference, &pad_width, &pad_height)) {
+    return false;
+  }
+  Dims<4> filter_dims_inference = MakeDimsForInference(
+      input_depth, filter_size, filter_size, output_depth);
+  EXPECT_TRUE(winograd_ops::IsSupported(filter_dims_inference, 1, 1, 1, 1));
+  Dims<4> bias_dims_inference = MakeDimsForInference(output_depth, 1, 1, 1);
+  std::vector<float> input_data(
+      RequiredBufferSizeForDims(input_dims_inference));
+  std::vector<float> filter_data(
+      RequiredBufferSizeForDims(filter_dims_inference));
+  std::vector<float> bias_data(output_depth);
+  FillRandom(&input_data, -1.f, 1.f);
+  FillRandom(&filter_data, -1.f, 1.f);
+  FillRandom(&bias_data, -1.f, 1.f);
+  const bool relu = UniformRandomInt(0, 1);
+  TestOneWinogradConv(input_data.data(), input_dims_inference,
+                      filter_data.data(), filter_dims_inference,
+                      bias_data.data(), bias_dims_inference, pad_width,
+                      pad_height, relu ? 0.f : -1e6f, 1e6f,
+                      output_dims_inference);
+  return true;
+}
+
+void TestOneWinogradConv() {
+  while (!TryTestOneWinogradConv()) {
+  }
+}
+
+TEST(TestWinogradConv, TestWinogradConv) {
+  const int kTestsToRun = 100;
+  for (int i = 0; i < kTestsToRun; i++) {
+    TestOneWinogradConv();
+  }
+}
+
+TEST(TestWinogradConv, IsSupported) {
+  EXPECT_TRUE(winograd_ops::IsSupported(MakeDimsForInference(16, 3, 3, 32),
+                                        1, 1, 1, 1));
+  // Strided, dilated, non-3x3 and shallow convolutions go elsewhere.
+  EXPECT_FALSE(winograd_ops::IsSupported(MakeDimsForInference(16, 3, 3, 32),
+                                         2, 2, 1, 1));
+  EXPECT_FALSE(winograd_ops::IsSupported(MakeDimsForInference(16, 3, 3, 32),
+                                         1, 1, 2, 2));
+  EXPECT_FALSE(winograd_ops::IsSupported(MakeDimsForInference(16, 5, 5, 32),
+                                         1, 1, 1, 1));
+  EXPECT_FALSE(winograd_ops::IsSupported(MakeDimsForInference(3, 3, 3, 32),
+                                         1, 1, 1, 1));
+}
+
+}  // namespace
+}  // namespace tflite
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cmath>
 #include <memory>
 
+#include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/internal/round.h"
 
 namespace tflite {
@@ -43,11 +44,63 @@ TfLiteStatus GetQuantizedConvolutionMultipler(TfLiteContext* context,
   return kTfLiteOk;
 }
 
-void CalculateActivationRangeUint8(TfLiteFusedActivation activation,
-                                   TfLiteTensor* output, int32_t* act_min,
-                                   int32_t* act_max) {
-  const int32_t qmin = std::numeric_limits<uint8_t>::min();
-  const int32_t qmax = std::numeric_limits<uint8_t>::max();
+TfLiteStatus PopulateChannelQuantizationMultipliers(
+    TfLiteContext* context, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const TfLiteTensor* bias, TfLiteTensor* output,
+    int channel_dimension, std::vector<int32_t>* multipliers,
+    std::vector<int32_t>* shifts) {
+  TF_LITE_ENSURE(context, channel_dimension < NumDimensions(filter));
+  const int num_channels = SizeOfDimension(filter, channel_dimension);
+  const TfLiteChannelQuantization* filter_params = filter->channel_params;
+  if (filter_params) {
+    TF_LITE_ENSURE_EQ(context, filter_params->quantized_dimension,
+                      channel_dimension);
+    TF_LITE_ENSURE_EQ(context, filter_params->scale->size, num_channels);
+  } else {
+    TF_LITE_ENSURE_EQ(context, filter->params.zero_point, 0);
+  }
+  const TfLiteChannelQuantization* bias_params =
+      bias ? bias->channel_params : nullptr;
+  if (bias_params) {
+    TF_LITE_ENSURE_EQ(context, bias_params->scale->size, num_channels);
+  }
+
+  multipliers->resize(num_channels);
+  shifts->resize(num_channels);
+  for (int c = 0; c < num_channels; ++c) {
+    float filter_scale = filter->params.scale;
+    if (filter_params) {
+      // Symmetric weights let the kernels skip the filter offset.
+      TF_LITE_ENSURE_EQ(context, filter_params->zero_point->data[c], 0);
+      filter_scale = filter_params->scale->data[c];
+    }
+    const double input_product_scale =
+        static_cast<double>(input->params.scale) * filter_scale;
+    TF_LITE_ENSURE(context, input_product_scale >= 0);
+    // A bias quantized as a whole can only match a per-tensor filter.
+    if (bias_params || (bias && !filter_params)) {
+      const double bias_scale =
+          bias_params ? bias_params->scale->data[c] : bias->params.scale;
+      TF_LITE_ENSURE(context,
+                     std::abs(input_product_scale - bias_scale) <=
+                         1e-6 * std::min(input_product_scale, bias_scale));
+    }
+    int shift;
+    QuantizeMultiplier(input_product_scale / output->params.scale,
+                       &(*multipliers)[c], &shift);
+    (*shifts)[c] = shift;
+  }
+  return kTfLiteOk;
+}
+
+namespace {
+template <typename T>
+void CalculateActivationRangeQuantizedImpl(TfLiteFusedActivation activation,
+                                           TfLiteTensor* output,
+                                           int32_t* act_min,
+                                           int32_t* act_max) {
+  const int32_t qmin = std::numeric_limits<T>::min();
+  const int32_t qmax = std::numeric_limits<T>::max();
 
   const auto scale = output->params.scale;
   const auto zero_point = output->params.zero_point;
@@ -70,6 +123,21 @@ void CalculateActivationRangeUint8(TfLiteFusedActivation activation,
     *act_max = qmax;
   }
 }
+}  // namespace
+
+void CalculateActivationRangeUint8(TfLiteFusedActivation activation,
+                                   TfLiteTensor* output, int32_t* act_min,
+                                   int32_t* act_max) {
+  CalculateActivationRangeQuantizedImpl<uint8_t>(activation, output, act_min,
+                                                 act_max);
+}
+
+void CalculateActivationRangeInt8(TfLiteFusedActivation activation,
+                                  TfLiteTensor* output, int32_t* act_min,
+                                  int32_t* act_max) {
+  CalculateActivationRangeQuantizedImpl<int8_t>(activation, output, act_min,
+                                                act_max);
+}
 
 void CalculateActivationRangeFloat(TfLiteFusedActivation activation,
                                    float* activation_min,
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_KERNEL_UTIL_H_
 #define TENSORFLOW_CONTRIB_LITE_KERNELS_KERNEL_UTIL_H_
 
+#include <vector>
+
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
 
@@ -86,11 +88,26 @@ TfLiteStatus GetQuantizedConvolutionMultipler(TfLiteContext* context,
                                               TfLiteTensor* output,
                                               double* multiplier);
 
+// Calculates one fixed-point multiplier and shift per output channel of a
+// quantized convolution (or depthwise convolution, or fully connected layer)
+// whose int8 filter has one symmetric scale per index along
+// 'channel_dimension', or a single one. The shifts are positive for left
+// shifts. Returns an error if the quantization of the tensors is not
+// supported.
+TfLiteStatus PopulateChannelQuantizationMultipliers(
+    TfLiteContext* context, const TfLiteTensor* input,
+    const TfLiteTensor* filter, const TfLiteTensor* bias, TfLiteTensor* output,
+    int channel_dimension, std::vector<int32_t>* multipliers,
+    std::vector<int32_t>* shifts);
+
 // Calculates the useful range of an activation layer given its activation
 // tensor.
 void CalculateActivationRangeUint8(TfLiteFusedActivation activation,
                                    TfLiteTensor* output, int32_t* act_min,
                                    int32_t* act_max);
+void CalculateActivationRangeInt8(TfLiteFusedActivation activation,
+                                  TfLiteTensor* output, int32_t* act_min,
+                                  int32_t* act_max);
 void CalculateActivationRangeFloat(TfLiteFusedActivation activation,
                                    float* activation_min,
                                    float* activation_max);
@@ -0,0 +1,100 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/kernels/shared_weights.h"
+
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <tuple>
+#include <vector>
+
+namespace tflite {
+namespace shared_weights {
+namespace {
+
+// Identifies packed weights by the bytes they were made from and the way
+// they were packed.
+struct Key {
+  const void* data;
+  size_t bytes;
+  std::string packing;
+
+  bool operator<(const Key& other) const {
+    return std::tie(data, bytes, packing) <
+           std::tie(other.data, other.bytes, other.packing);
+  }
+};
+
+struct Cache {
+  std::mutex mutex;
+  // The entries expire along with the last op using them, at which point the
+  // mapped model they were made from may be gone as well.
+  std::map<Key, std::weak_ptr<const std::vector<float>>> entries;
+};
+
+Cache* GetCache() {
+  static Cache* cache = new Cache;
+  return cache;
+}
+
+}  // namespace
+
+bool CanShare(const TfLiteTensor* tensor) {
+  return tensor->allocation_type == kTfLiteMmapRo &&
+         tensor->data.raw != nullptr;
+}
+
+std::shared_ptr<const float> GetOrPack(
+    const TfLiteTensor* source, const std::string& packing, size_t num_floats,
+    const std::function<void(const TfLiteTensor*, float*)>& pack) {
+  Cache* cache = GetCache();
+  Key key{source->data.raw, source->bytes, packing};
+
+  // Packing happens under the lock, so that concurrent Prepare() calls for
+  // the same weights wait for one copy instead of making several.
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  std::shared_ptr<const std::vector<float>> packed =
+      cache->entries[key].lock();
+  if (!packed || packed->size() != num_floats) {
+    auto buffer = std::make_shared<std::vector<float>>(num_floats);
+    pack(source, buffer->data());
+    packed = buffer;
+    // Forget the weights nobody uses anymore before adding new ones.
+    for (auto it = cache->entries.begin(); it != cache->entries.end();) {
+      if (it->second.expired()) {
+        it = cache->entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    cache->entries[key] = packed;
+  }
+  return std::shared_ptr<const float>(packed, packed->data());
+}
+
+std::shared_ptr<const float> GetOrTranspose(const TfLiteTensor* source,
+                                            int rows, int cols) {
+  return GetOrPack(source, "transposed", rows * cols,
+                   [rows, cols](const TfLiteTensor* source, float* packed) {
+                     const float* data = source->data.f;
+                     for (int i = 0; i < rows; ++i) {
+                       for (int j = 0; j < cols; ++j) {
+                         packed[j * rows + i] = data[i * cols + j];
+                       }
+                     }
+                   });
+}
+
+}  // namespace shared_weights
+}  // namespace tflite
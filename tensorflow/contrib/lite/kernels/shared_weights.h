@@ -0,0 +1,65 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_KERNELS_SHARED_WEIGHTS_H_
+#define TENSORFLOW_CONTRIB_LITE_KERNELS_SHARED_WEIGHTS_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "tensorflow/contrib/lite/context.h"
+
+namespace tflite {
+namespace shared_weights {
+
+// Some ops repack constant weights in Prepare(), e.g. the float convolution
+// transposes its filter for Eigen. When the weights are memory-mapped from a
+// model, every interpreter built from that model sees the same bytes, so the
+// repacked copy only needs to exist once. For example, in the implementation
+// of an op:
+//   TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+//     ...
+//     if (shared_weights::CanShare(filter)) {
+//       data->packed = shared_weights::GetOrPack(
+//           filter, "my_op_packing", num_floats,
+//           [](const TfLiteTensor* filter, float* packed) { ... });
+//     }
+//   }
+//
+// The ops hold on to the returned buffer, and it is released when the last of
+// them drops it.
+
+// Returns true if the data of 'tensor' can't change for as long as any
+// interpreter uses it, which is required for GetOrPack().
+bool CanShare(const TfLiteTensor* tensor);
+
+// Returns a read-only buffer of 'num_floats' floats filled by calling
+// 'pack(source, buffer)'. If a buffer made from the same data of 'source' with
+// the same 'packing' is still alive, it is returned instead and 'pack' is not
+// called. 'packing' names the way the data is repacked, and must be distinct
+// for each op and layout. Thread-safe.
+std::shared_ptr<const float> GetOrPack(
+    const TfLiteTensor* source, const std::string& packing, size_t num_floats,
+    const std::function<void(const TfLiteTensor*, float*)>& pack);
+
+// Returns the data of 'source', a row-major [rows, cols] float matrix, as a
+// row-major [cols, rows] one, using GetOrPack().
+std::shared_ptr<const float> GetOrTranspose(const TfLiteTensor* source,
+                                            int rows, int cols);
+
+}  // namespace shared_weights
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_SHARED_WEIGHTS_H_
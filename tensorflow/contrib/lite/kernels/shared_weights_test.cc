@@ -0,0 +1,119 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/kernels/shared_weights.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace shared_weights {
+namespace {
+
+// A float tensor over 'data', as the interpreter sets up memory-mapped
+// weights.
+TfLiteTensor MmappedTensor(std::vector<float>* data) {
+  TfLiteTensor tensor = {};
+  tensor.type = kTfLiteFloat32;
+  tensor.allocation_type = kTfLiteMmapRo;
+  tensor.data.f = data->data();
+  tensor.bytes = data->size() * sizeof(float);
+  return tensor;
+}
+
+// Packs by negating the source, and counts the calls.
+struct NegatePacker {
+  void operator()(const TfLiteTensor* source, float* packed) {
+    ++num_calls;
+    for (size_t i = 0; i < source->bytes / sizeof(float); ++i) {
+      packed[i] = -source->data.f[i];
+    }
+  }
+
+  int num_calls = 0;
+};
+
+TEST(SharedWeightsTest, CanShareOnlyMmappedTensors) {
+  std::vector<float> data = {1, 2};
+  TfLiteTensor tensor = MmappedTensor(&data);
+  EXPECT_TRUE(CanShare(&tensor));
+
+  tensor.allocation_type = kTfLiteArenaRw;
+  EXPECT_FALSE(CanShare(&tensor));
+}
+
+TEST(SharedWeightsTest, PacksOncePerSource) {
+  std::vector<float> data = {1, 2, 3};
+  TfLiteTensor tensor = MmappedTensor(&data);
+  NegatePacker packer;
+  auto pack = [&packer](const TfLiteTensor* source, float* packed) {
+    packer(source, packed);
+  };
+
+  std::shared_ptr<const float> first = GetOrPack(&tensor, "negate", 3, pack);
+  std::shared_ptr<const float> second = GetOrPack(&tensor, "negate", 3, pack);
+  EXPECT_EQ(packer.num_calls, 1);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(first.get()[0], -1);
+  EXPECT_EQ(first.get()[2], -3);
+
+  // Another packing of the same data is kept separately.
+  std::shared_ptr<const float> other = GetOrPack(&tensor, "other", 3, pack);
+  EXPECT_EQ(packer.num_calls, 2);
+  EXPECT_NE(first.get(), other.get());
+
+  // So is the same packing of other data.
+  std::vector<float> other_data = {4, 5, 6};
+  TfLiteTensor other_tensor = MmappedTensor(&other_data);
+  std::shared_ptr<const float> third =
+      GetOrPack(&other_tensor, "negate", 3, pack);
+  EXPECT_EQ(packer.num_calls, 3);
+  EXPECT_EQ(third.get()[0], -4);
+}
+
+TEST(SharedWeightsTest, RepacksOnceReleased) {
+  std::vector<float> data = {1, 2, 3};
+  TfLiteTensor tensor = MmappedTensor(&data);
+  NegatePacker packer;
+  auto pack = [&packer](const TfLiteTensor* source, float* packed) {
+    packer(source, packed);
+  };
+
+  std::shared_ptr<const float> packed = GetOrPack(&tensor, "negate", 3, pack);
+  packed.reset();
+  data[0] = 7;
+  packed = GetOrPack(&tensor, "negate", 3, pack);
+  EXPECT_EQ(packer.num_calls, 2);
+  EXPECT_EQ(packed.get()[0], -7);
+}
+
+TEST(SharedWeightsTest, Transposes) {
+  std::vector<float> data = {1, 2, 3, 4, 5, 6};
+  TfLiteTensor tensor = MmappedTensor(&data);
+  std::shared_ptr<const float> transposed = GetOrTranspose(&tensor, 2, 3);
+  EXPECT_EQ(std::vector<float>(transposed.get(), transposed.get() + 6),
+            std::vector<float>({1, 4, 2, 5, 3, 6}));
+}
+
+}  // namespace
+}  // namespace shared_weights
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -77,6 +77,8 @@ inline std::vector<float> Dequantize(const std::vector<T>& data, float scale,
 // quantized tensor which must have their scale and zero_point defined before
 // the actual data is known. This mimics what happens in practice: quantization
 // parameters are calculate during training.
+// Tensors quantized per channel instead have one symmetric scale for each
+// index along 'quantized_dimension'.
 struct TensorData {
   TensorType type;
   std::vector<int> shape;
@@ -84,6 +86,8 @@ struct TensorData {
   float max;
   float scale;
   int32_t zero_point;
+  std::vector<float> per_channel_scales;
+  int32_t quantized_dimension;
 };
 
 class SingleOpResolver : public OpResolver {
@@ -131,6 +135,23 @@ class SingleOpModel {
     return id;
   }
 
+  // Adds a constant 2D input of dense `shape`, whose `blocks` are the stored
+  // blocks of a block-sparse layout (see TfLiteSparsity).
+  template <typename T>
+  int AddSparseConstInput(TensorType type, std::initializer_list<T> blocks,
+                          std::initializer_list<int> shape, int block_rows,
+                          int block_cols,
+                          const std::vector<int>& block_row_offsets,
+                          const std::vector<int>& block_col_indices) {
+    auto sparsity = CreateSparsityParameters(
+        builder_, block_rows, block_cols,
+        builder_.CreateVector<int>(block_row_offsets),
+        builder_.CreateVector<int>(block_col_indices));
+    int id = AddTensor(TensorData{type, shape}, blocks, sparsity);
+    inputs_.push_back(id);
+    return id;
+  }
+
   // Add a null input tensor (optional input) and return kOptionalTensor.
   int AddNullInput();
 
@@ -161,6 +182,26 @@ class SingleOpModel {
                    reinterpret_cast<uint8_t*>(q.data() + q.size()));
   }
 
+  // Quantizes 'data' using the per-channel scales of the tensor, given in
+  // its TensorData, and populates the tensor with the result.
+  template <typename T>
+  void PerChannelQuantizeAndPopulate(int index,
+                                     const std::vector<float>& data) {
+    const TensorData& t = tensor_data_.at(index);
+    // The number of consecutive values sharing a scale.
+    int inner_size = 1;
+    for (int i = t.quantized_dimension + 1; i < t.shape.size(); ++i) {
+      inner_size *= t.shape[i];
+    }
+    const int num_channels = t.per_channel_scales.size();
+    std::vector<T> q;
+    for (int i = 0; i < data.size(); ++i) {
+      const float scale = t.per_channel_scales[(i / inner_size) % num_channels];
+      q.push_back(Quantize<T>({data[i]}, scale, 0)[0]);
+    }
+    PopulateTensor(index, 0, q.data(), q.data() + q.size());
+  }
+
   const std::vector<int>& GetShape(int id) { return tensor_data_.at(id).shape; }
 
   float GetScale(int id) { return tensor_data_.at(id).scale; }
@@ -253,7 +294,8 @@ class SingleOpModel {
   }
 
   template <typename T>
-  int AddTensor(TensorData t, std::initializer_list<T> data) {
+  int AddTensor(TensorData t, std::initializer_list<T> data,
+                flatbuffers::Offset<SparsityParameters> sparsity = 0) {
     int id = tensors_.size();
 
     // This is slightly different depending on whether we are adding a
@@ -262,11 +304,21 @@ class SingleOpModel {
 
     flatbuffers::Offset<QuantizationParameters> q_params = 0;
 
-    if (is_quantized) {
+    if (!t.per_channel_scales.empty()) {
+      q_params = CreateQuantizationParameters(
+          builder_, /*min=*/0, /*max=*/0,
+          builder_.CreateVector<float>(t.per_channel_scales),
+          builder_.CreateVector<int64_t>(
+              std::vector<int64_t>(t.per_channel_scales.size(), 0)),
+          t.quantized_dimension);
+    } else if (is_quantized) {
       if (t.min != 0 || t.max != 0) {
         if (t.type == TensorType_UINT8) {
           std::tie(t.scale, t.zero_point) =
               QuantizationParams<uint8_t>(t.min, t.max);
+        } else if (t.type == TensorType_INT8) {
+          std::tie(t.scale, t.zero_point) =
+              QuantizationParams<int8_t>(t.min, t.max);
         } else if (t.type == TensorType_INT32) {
           std::tie(t.scale, t.zero_point) =
               QuantizationParams<int32_t>(t.min, t.max);
@@ -302,7 +354,7 @@ class SingleOpModel {
     tensors_.push_back(CreateTensor(builder_,
                                     builder_.CreateVector<int>(t.shape), t.type,
                                     /*buffer=*/buffer_id,
-                                    /*name=*/0, q_params));
+                                    /*name=*/0, q_params, sparsity));
 
     tensor_data_[id] = t;
 
@@ -60,6 +60,9 @@ TfLiteStatus ConvertTensorType(TensorType tensor_type, TfLiteType* type,
     case TensorType_BOOL:
       *type = kTfLiteBool;
       break;
+    case TensorType_INT8:
+      *type = kTfLiteInt8;
+      break;
     default:
       error_reporter->Report("Unimplemented data type %s (%d) in tensor\n",
                              EnumNameTensorType(tensor_type), tensor_type);
@@ -782,13 +785,38 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     TfLiteQuantizationParams quantization;
     quantization.scale = 0;
     quantization.zero_point = 0;
+    // Filled in when the tensor has one scale per index along
+    // 'quantized_dimension' rather than a single one.
+    std::vector<float> channel_scales;
+    std::vector<int32_t> channel_zero_points;
+    int quantized_dimension = 0;
     auto* q_params = tensor->quantization();
-    if (q_params) {
-      // Note that the schema could hold per-channel quantization parameters
-      // but we really only support one value for the whole tensor.
+    if (q_params && q_params->scale() && q_params->scale()->size() > 1) {
+      quantized_dimension = q_params->quantized_dimension();
+      if (quantized_dimension < 0 || quantized_dimension >= dims.size() ||
+          q_params->scale()->size() != dims[quantized_dimension]) {
+        error_reporter_->Report(
+            "Tensor %d has %d scale values, but its quantized dimension %d "
+            "does not have that many entries.\n",
+            i, q_params->scale()->size(), quantized_dimension);
+        return kTfLiteError;
+      }
+      if (q_params->zero_point() &&
+          q_params->zero_point()->size() != q_params->scale()->size()) {
+        error_reporter_->Report(
+            "Tensor %d has %d scale values but %d zero_point values.\n", i,
+            q_params->scale()->size(), q_params->zero_point()->size());
+        return kTfLiteError;
+      }
+      channel_scales.assign(q_params->scale()->begin(),
+                            q_params->scale()->end());
+      channel_zero_points.assign(channel_scales.size(), 0);
+      if (q_params->zero_point()) {
+        channel_zero_points.assign(q_params->zero_point()->begin(),
+                                   q_params->zero_point()->end());
+      }
+    } else if (q_params) {
       // TODO(aselle): This breaks as well if these are nullptr's.
-      // TODO(aselle): This assumes non per-channel quantization.
-
       if (q_params->scale()) {
         if (q_params->scale()->size() != 1) {
           error_reporter_->Report(
@@ -844,7 +872,19 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     const char* buffer_ptr;
     TF_LITE_ENSURE_STATUS(get_readonly_data(&buffer_ptr, &buffer_size));
 
-    if (buffer_ptr) {
+    if (auto* sparsity = tensor->sparsity()) {
+      if (!buffer_ptr ||
+          interpreter->SetTensorParametersReadOnlySparse(
+              i, type, get_name(tensor), dims, quantization,
+              sparsity->block_rows(), sparsity->block_cols(),
+              FlatBufferIntArrayToVector(sparsity->block_row_offsets()),
+              FlatBufferIntArrayToVector(sparsity->block_col_indices()),
+              buffer_ptr, buffer_size, allocation_) != kTfLiteOk) {
+        error_reporter_->Report("Tensor %d has an invalid sparse layout.\n",
+                                i);
+        status = kTfLiteError;
+      }
+    } else if (buffer_ptr) {
       if (interpreter->SetTensorParametersReadOnly(
               i, type, get_name(tensor), dims, quantization, buffer_ptr,
               buffer_size, allocation_) != kTfLiteOk) {
@@ -860,11 +900,50 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
         status = kTfLiteError;
       }
     }
+
+    if (!channel_scales.empty() &&
+        interpreter->SetTensorChannelQuantization(
+            i, channel_scales, channel_zero_points, quantized_dimension) !=
+            kTfLiteOk) {
+      error_reporter_->Report(
+          "Tensor %d has invalid per-channel quantization.\n", i);
+      status = kTfLiteError;
+    }
   }
 
   return status;
 }
 
+TfLiteStatus InterpreterBuilder::CheckSparseTensors(
+    const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
+    const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors) {
+  for (int i = 0; i < operators->Length(); ++i) {
+    const auto* op = operators->Get(i);
+    const int index = op->opcode_index();
+    // Bad opcodes and missing registrations are reported by ParseNodes().
+    if (!op->inputs() || index < 0 ||
+        index >= flatbuffer_op_index_to_registration_.size() ||
+        flatbuffer_op_index_to_registration_[index] == nullptr) {
+      continue;
+    }
+    const BuiltinOperator op_type = static_cast<BuiltinOperator>(
+        flatbuffer_op_index_to_registration_[index]->builtin_code);
+    for (int j = 0; j < op->inputs()->Length(); ++j) {
+      const int tensor_index = op->inputs()->Get(j);
+      if (tensor_index < 0 || tensor_index >= tensors->Length()) continue;
+      if (!tensors->Get(tensor_index)->sparsity()) continue;
+      // Only the fully connected kernel knows how to read sparse weights.
+      if (op_type != BuiltinOperator_FULLY_CONNECTED || j != 1) {
+        error_reporter_->Report(
+            "Tensor %d is sparse, but only FULLY_CONNECTED weights may be.\n",
+            tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus InterpreterBuilder::operator()(
     std::unique_ptr<Interpreter>* interpreter) {
   return operator()(interpreter, /*num_threads=*/-1);
@@ -933,6 +1012,8 @@ TfLiteStatus InterpreterBuilder::operator()(
   (**interpreter).SetOutputs(FlatBufferIntArrayToVector(subgraph->outputs()));
 
   // Finally setup nodes and tensors
+  if (CheckSparseTensors(operators, tensors) != kTfLiteOk)
+    return cleanup_and_error();
   if (ParseNodes(operators, interpreter->get()) != kTfLiteOk)
     return cleanup_and_error();
   if (ParseTensors(buffers, tensors, interpreter->get()) != kTfLiteOk)
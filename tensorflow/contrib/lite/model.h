@@ -171,6 +171,10 @@ class InterpreterBuilder {
       const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
       const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
       Interpreter* interpreter);
+  // Checks that sparse tensors are only used by kernels that support them.
+  TfLiteStatus CheckSparseTensors(
+      const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
+      const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors);
 
   const ::tflite::Model* model_;
   const OpResolver& op_resolver_;
@@ -73,6 +73,16 @@ TfLiteStatus SimpleMemoryArena::Allocate(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAt(TfLiteContext* context,
+                                           size_t offset, size_t size,
+                                           ArenaAlloc* new_alloc) {
+  TF_LITE_ENSURE(context, allocs_.empty());
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+  new_alloc->offset = offset;
+  new_alloc->size = size;
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::Deallocate(TfLiteContext* context,
                                            const ArenaAlloc& alloc) {
   int erased_allocs_count = 0;
@@ -90,8 +100,36 @@ TfLiteStatus SimpleMemoryArena::Deallocate(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::SetExternalBuffer(char* buffer, size_t size) {
+  external_buffer_ = buffer;
+  external_buffer_size_ = size;
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
   size_t required_size = RequiredBufferSize();
+  if (external_buffer_ != nullptr) {
+    if (required_size > external_buffer_size_) {
+      context->ReportError(context,
+                           "Arena needs %zu bytes but the buffer only has %zu.",
+                           required_size, external_buffer_size_);
+      return kTfLiteError;
+    }
+    char* new_underlying_buffer_aligned_ptr = reinterpret_cast<char*>(AlignTo(
+        arena_alignment_, reinterpret_cast<intptr_t>(external_buffer_)));
+    // If the arena was committed somewhere else, move the allocations over.
+    // The old and new memory may overlap.
+    if (underlying_buffer_aligned_ptr_ != nullptr &&
+        underlying_buffer_aligned_ptr_ != new_underlying_buffer_aligned_ptr) {
+      memmove(new_underlying_buffer_aligned_ptr, underlying_buffer_aligned_ptr_,
+              std::min(committed_size_, high_water_mark_));
+    }
+    underlying_buffer_.reset();
+    underlying_buffer_size_ = 0;
+    underlying_buffer_aligned_ptr_ = new_underlying_buffer_aligned_ptr;
+    committed_size_ = high_water_mark_;
+    committed_ = true;
+    return kTfLiteOk;
+  }
   if (required_size > underlying_buffer_size_) {
     char* new_alloc = new char[required_size];
     char* new_underlying_buffer_aligned_ptr = reinterpret_cast<char*>(
@@ -113,6 +151,7 @@ TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
     underlying_buffer_size_ = required_size;
     underlying_buffer_aligned_ptr_ = new_underlying_buffer_aligned_ptr;
   }
+  committed_size_ = high_water_mark_;
   committed_ = true;
   return underlying_buffer_ != nullptr ? kTfLiteOk : kTfLiteError;
 }
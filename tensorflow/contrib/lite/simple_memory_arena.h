@@ -47,6 +47,10 @@ class SimpleMemoryArena {
         arena_alignment_(arena_alignment),
         high_water_mark_(0),
         underlying_buffer_size_(0),
+        underlying_buffer_aligned_ptr_(nullptr),
+        external_buffer_(nullptr),
+        external_buffer_size_(0),
+        committed_size_(0),
         allocs_() {}
 
   TfLiteStatus Allocate(TfLiteContext* context, size_t alignment, size_t size,
@@ -54,6 +58,13 @@ class SimpleMemoryArena {
 
   TfLiteStatus Deallocate(TfLiteContext* context, const ArenaAlloc& alloc);
 
+  // Reserves 'size' bytes at an offset chosen by the caller, who is in charge
+  // of avoiding overlaps with other allocations in use at the same time. Such
+  // allocations can't be deallocated until the arena is cleared, and must not
+  // be mixed with Allocate().
+  TfLiteStatus AllocateAt(TfLiteContext* context, size_t offset, size_t size,
+                          ArenaAlloc* new_alloc);
+
   inline size_t RequiredBufferSize() {
     // Add in a small amount of padding to reduce the chance of resize events
     // for small allocations.
@@ -61,6 +72,12 @@ class SimpleMemoryArena {
     return arena_alignment_ + high_water_mark_ + padding;
   }
 
+  // Makes Commit() place the arena in the given buffer, which the caller owns
+  // and must keep alive as long as the arena is used, instead of allocating
+  // memory itself. Commit() then fails if the buffer is too small. The buffer
+  // may be changed between commits, the allocations being moved along.
+  void SetExternalBuffer(char* buffer, size_t size);
+
   TfLiteStatus Commit(TfLiteContext* context);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context, const ArenaAlloc& alloc,
@@ -79,6 +96,11 @@ class SimpleMemoryArena {
   std::unique_ptr<char[]> underlying_buffer_;
   size_t underlying_buffer_size_;
   char* underlying_buffer_aligned_ptr_;
+  char* external_buffer_;
+  size_t external_buffer_size_;
+  // The high water mark at the last Commit(), i.e. how much of the buffer may
+  // hold live data.
+  size_t committed_size_;
   // TODO(maciekc): add list iterator to the ArenaAlloc to lookup quickly.
   std::list<ArenaAlloc> allocs_;
 };
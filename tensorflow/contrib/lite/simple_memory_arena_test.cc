@@ -82,6 +82,35 @@ TEST(SimpleMemoryArenaTest, TestAfterClear) {
   EXPECT_EQ(allocs[8].offset, 8192);
 }
 
+TEST(SimpleMemoryArenaTest, ExternalBuffer) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAlloc allocs[2];
+  char buffer[2048];
+
+  arena.SetExternalBuffer(buffer, 1024);
+  arena.Allocate(&context, 32, 256, &allocs[0]);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  char* ptr;
+  ASSERT_EQ(arena.ResolveAlloc(&context, allocs[0], &ptr), kTfLiteOk);
+  EXPECT_GE(ptr, buffer);
+  EXPECT_LE(ptr + 256, buffer + 1024);
+  EXPECT_EQ(reinterpret_cast<intptr_t>(ptr) % 64, 0);
+  ptr[0] = 17;
+  ptr[255] = 42;
+
+  // Moving the arena within the same memory keeps the contents.
+  arena.SetExternalBuffer(buffer + 100, 1948);
+  arena.Allocate(&context, 32, 1024, &allocs[1]);
+  ASSERT_EQ(arena.Commit(&context), kTfLiteOk);
+  ASSERT_EQ(arena.ResolveAlloc(&context, allocs[0], &ptr), kTfLiteOk);
+  EXPECT_GE(ptr, buffer + 100);
+  EXPECT_EQ(ptr[0], 17);
+  EXPECT_EQ(ptr[255], 42);
+  ASSERT_EQ(arena.ResolveAlloc(&context, allocs[1], &ptr), kTfLiteOk);
+  EXPECT_LE(ptr + 1024, buffer + 2048);
+}
+
 }  // namespace
 }  // namespace tflite
 
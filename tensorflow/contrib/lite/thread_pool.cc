@@ -0,0 +1,76 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/thread_pool.h"
+
+namespace tflite {
+
+ThreadPool::ThreadPool(int num_workers) {
+  workers_.reserve(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(int num_tasks,
+                             const std::function<void(int)>& fn) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  fn_ = &fn;
+  num_tasks_ = num_tasks;
+  next_task_ = 0;
+  num_tasks_done_ = 0;
+  if (num_tasks > 1) {
+    work_available_.notify_all();
+  }
+  RunTasks(&lock);
+  work_done_.wait(lock, [this] { return num_tasks_done_ == num_tasks_; });
+  fn_ = nullptr;
+}
+
+void ThreadPool::RunTasks(std::unique_lock<std::mutex>* lock) {
+  while (fn_ != nullptr && next_task_ < num_tasks_) {
+    const std::function<void(int)>* fn = fn_;
+    int task = next_task_++;
+    lock->unlock();
+    (*fn)(task);
+    lock->lock();
+    if (++num_tasks_done_ == num_tasks_) {
+      work_done_.notify_one();
+    }
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_available_.wait(lock, [this] {
+      return stopping_ || (fn_ != nullptr && next_task_ < num_tasks_);
+    });
+    if (stopping_) return;
+    RunTasks(&lock);
+  }
+}
+
+}  // namespace tflite
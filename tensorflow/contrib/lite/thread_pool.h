@@ -0,0 +1,63 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_THREAD_POOL_H_
+#define TENSORFLOW_CONTRIB_LITE_THREAD_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A fixed set of worker threads that helps the calling thread run a batch of
+// independent tasks. Only one thread may call ParallelFor() at a time.
+class ThreadPool {
+ public:
+  // Starts 'num_workers' threads, which may be zero.
+  explicit ThreadPool(int num_workers);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Calls 'fn(i)' for every 'i' in [0, num_tasks), on the calling thread and
+  // on the workers, and returns once all the calls returned.
+  void ParallelFor(int num_tasks, const std::function<void(int)>& fn);
+
+ private:
+  // Runs the tasks of the current batch until none is left to start. 'lock'
+  // must hold 'mutex_', and is released while a task runs.
+  void RunTasks(std::unique_lock<std::mutex>* lock);
+
+  void WorkerLoop();
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+
+  // The current batch, if any. 'fn_' is null between batches.
+  const std::function<void(int)>* fn_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int num_tasks_done_ = 0;
+  bool stopping_ = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_THREAD_POOL_H_
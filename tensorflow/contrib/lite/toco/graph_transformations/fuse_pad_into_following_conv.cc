@@ -0,0 +1,124 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace toco {
+
+namespace {
+
+// Returns whether padding an input dimension of size 'input_size' with
+// 'left' and 'right' zeros is exactly what SAME padding does for a
+// convolution of the given (dilated) kernel size and stride.
+bool IsSamePadding(int input_size, int kernel_size, int stride, int left,
+                   int right) {
+  const int output_size = (input_size + stride - 1) / stride;
+  const int total =
+      std::max(0, (output_size - 1) * stride + kernel_size - input_size);
+  return left == total / 2 && right == total - total / 2;
+}
+
+}  // namespace
+
+// Folds an explicit Pad feeding a VALID convolution into the convolution,
+// when the Pad adds exactly the zeros that SAME padding would. This is the
+// pattern TensorFlow graphs exported from other frameworks commonly use
+// instead of SAME padding, and it saves a full copy of the activations.
+bool FusePadIntoFollowingConv::Run(Model* model, std::size_t op_index) {
+  const auto conv_it = model->operators.begin() + op_index;
+  auto* conv_op = conv_it->get();
+  Padding* padding;
+  int stride_width, stride_height;
+  int dilation_width_factor = 1;
+  int dilation_height_factor = 1;
+  if (conv_op->type == OperatorType::kConv) {
+    auto* op = static_cast<ConvOperator*>(conv_op);
+    padding = &op->padding;
+    stride_width = op->stride_width;
+    stride_height = op->stride_height;
+    dilation_width_factor = op->dilation_width_factor;
+    dilation_height_factor = op->dilation_height_factor;
+  } else if (conv_op->type == OperatorType::kDepthwiseConv) {
+    auto* op = static_cast<DepthwiseConvOperator*>(conv_op);
+    padding = &op->padding;
+    stride_width = op->stride_width;
+    stride_height = op->stride_height;
+  } else {
+    return false;
+  }
+  if (padding->type != PaddingType::kValid) {
+    return false;
+  }
+
+  const string padded_name = conv_op->inputs[0];
+  const auto pad_it = FindOpWithOutput(*model, padded_name);
+  if (pad_it == model->operators.end() ||
+      pad_it->get()->type != OperatorType::kPad) {
+    return false;
+  }
+  const auto* pad_op = static_cast<const PadOperator*>(pad_it->get());
+  if (CountOpsWithInput(*model, padded_name) != 1 ||
+      !IsDiscardableArray(*model, padded_name)) {
+    return false;
+  }
+  // Wait for the paddings and the shapes to be resolved.
+  const auto& input_array = model->GetArray(pad_op->inputs[0]);
+  const auto& weights_array = model->GetArray(conv_op->inputs[1]);
+  if (pad_op->left_padding.size() != 4 || pad_op->right_padding.size() != 4 ||
+      !input_array.has_shape() || !weights_array.has_shape()) {
+    return false;
+  }
+  // Convolutions can only pad the spatial dimensions.
+  if (pad_op->left_padding[0] != 0 || pad_op->right_padding[0] != 0 ||
+      pad_op->left_padding[3] != 0 || pad_op->right_padding[3] != 0) {
+    return false;
+  }
+
+  const Shape& input_shape = input_array.shape();
+  const Shape& weights_shape = weights_array.shape();
+  const int kheight = dilation_height_factor * (weights_shape.dims(1) - 1) + 1;
+  const int kwidth = dilation_width_factor * (weights_shape.dims(2) - 1) + 1;
+  if (!IsSamePadding(input_shape.dims(1), kheight, stride_height,
+                     pad_op->left_padding[1], pad_op->right_padding[1]) ||
+      !IsSamePadding(input_shape.dims(2), kwidth, stride_width,
+                     pad_op->left_padding[2], pad_op->right_padding[2])) {
+    AddMessageF("Not fusing %s into %s as it does not pad like SAME would",
+                LogName(*pad_op), LogName(*conv_op));
+    return false;
+  }
+
+  AddMessageF("Fusing %s into %s as SAME padding", LogName(*pad_op),
+              LogName(*conv_op));
+  // The output shape is unchanged, and SAME pads the rows and columns before
+  // the input just like the Pad did.
+  padding->type = PaddingType::kSame;
+  FixedPadding& fixed_padding = padding->GetOrCreateFixedPadding();
+  fixed_padding.height = pad_op->left_padding[1];
+  fixed_padding.width = pad_op->left_padding[2];
+  conv_op->inputs[0] = pad_op->inputs[0];
+  DeleteOpAndArraysIfUnused(model, pad_it->get());
+  model->EraseArray(padded_name);
+  return true;
+}
+
+}  // namespace toco
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -127,8 +128,27 @@ void DiscardUselessConnectedComponentsAndRNNBackEdges(Model* model) {
   }
 }
 
+// Logs how many changes each of the transformations made, so that it is easy to
+// tell which fusions fired on a given model.
+void PrintTransformationStats(const string& label,
+                              const std::map<string, int>& changes) {
+  if (changes.empty()) {
+    LOG(INFO) << label << ": no transformation made a change";
+    return;
+  }
+  string stats;
+  for (const auto& change : changes) {
+    if (!stats.empty()) stats += ", ";
+    stats += toco::port::StringF("%s x%d", change.first, change.second);
+  }
+  LOG(INFO) << label << ": " << stats;
+}
+
+// Runs one pass of the transformations over the model, counting the changes
+// made by each of them in 'changes'.
 bool GraphTransformationsPass(int increment, Model* model,
-                              const GraphTransformationsSet& transformations) {
+                              const GraphTransformationsSet& transformations,
+                              std::map<string, int>* changes) {
   CHECK(increment == 1 || increment == -1);
   bool changed = false;
   if (model->operators.empty()) {
@@ -159,6 +179,7 @@ bool GraphTransformationsPass(int increment, Model* model,
       }
       transformation->ClearMessages();
       if (changed_now) {
+        (*changes)[transformation->Name()]++;
         DumpGraphvizVideoFrame(*model);
         if (model->operators.empty()) return true;
         op_index = std::min<int>(op_index, model->operators.size() - 1);
@@ -190,14 +211,17 @@ void RunGraphTransformations(Model* model, const string& msg,
                              const GraphTransformationsSet& transformations) {
   PrintModelStats(toco::port::StringF("Before %s", msg), *model);
   int pass_index = 0;
+  std::map<string, int> changes;
   while (GraphTransformationsPass((pass_index % 2) ? -1 : 1, model,
-                                  transformations)) {
+                                  transformations, &changes)) {
     pass_index++;
     const auto& label =
         toco::port::StringF("After %s pass %d", msg, pass_index);
     PrintModelStats(label, *model);
     CheckInvariants(*model);
   }
+  PrintTransformationStats(toco::port::StringF("Changes made by %s", msg),
+                           changes);
 }
 
 }  // namespace toco
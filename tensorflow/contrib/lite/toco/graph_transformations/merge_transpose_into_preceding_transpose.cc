@@ -0,0 +1,89 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace toco {
+
+// Two consecutive transposes are a single transpose by the composition of
+// their permutations. If that composition is the identity, the remaining
+// transpose is then removed by ConvertTrivialTransposeToReshape and
+// RemoveTrivialReshape.
+bool MergeTransposeIntoPrecedingTranspose::Run(Model* model,
+                                               std::size_t op_index) {
+  auto it = model->operators.begin() + op_index;
+  auto* transpose_op =
+      ConvertOperator<TransposeOperator*>(it->get(), OperatorType::kTranspose);
+  if (transpose_op == nullptr || transpose_op->perm.empty()) {
+    return false;
+  }
+
+  const string intermediate_name = transpose_op->inputs[0];
+  const auto preceding_it = FindOpWithOutput(*model, intermediate_name);
+  if (preceding_it == model->operators.end()) {
+    return false;
+  }
+  auto* preceding_op = ConvertOperator<TransposeOperator*>(
+      preceding_it->get(), OperatorType::kTranspose);
+  if (preceding_op == nullptr || preceding_op->perm.empty()) {
+    return false;
+  }
+  CHECK_EQ(preceding_op->perm.size(), transpose_op->perm.size());
+
+  // The preceding transpose goes away, so nothing else may need its output.
+  if (CountOpsWithInput(*model, intermediate_name) != 1 ||
+      !IsDiscardableArray(*model, intermediate_name)) {
+    AddMessageF("Not merging %s into %s as its output is used elsewhere",
+                LogName(*transpose_op), LogName(*preceding_op));
+    return false;
+  }
+
+  AddMessageF("Merging %s into %s", LogName(*transpose_op),
+              LogName(*preceding_op));
+
+  // Output dimension i of the merged transpose is dimension perm[i] of the
+  // intermediate array, that is dimension preceding_perm[perm[i]] of the input.
+  std::vector<int> merged_perm(transpose_op->perm.size());
+  for (int i = 0; i < merged_perm.size(); i++) {
+    merged_perm[i] = preceding_op->perm[transpose_op->perm[i]];
+  }
+
+  // The permutation array may be shared with other transposes, so give the
+  // merged transpose one of its own.
+  const string perm_name =
+      AvailableArrayName(*model, transpose_op->outputs[0] + "_perm");
+  auto& perm_array = model->GetOrCreateArray(perm_name);
+  perm_array.data_type = ArrayDataType::kInt32;
+  perm_array.copy_shape(Shape({static_cast<int>(merged_perm.size())}));
+  perm_array.GetMutableBuffer<ArrayDataType::kInt32>().data = merged_perm;
+  const string old_perm_name = transpose_op->inputs[1];
+  transpose_op->inputs[0] = preceding_op->inputs[0];
+  transpose_op->inputs[1] = perm_name;
+  transpose_op->perm = merged_perm;
+  DeleteArrayIfUnused(old_perm_name, model);
+
+  DeleteOpAndArraysIfUnused(model, preceding_op);
+  model->EraseArray(intermediate_name);
+  return true;
+}
+
+}  // namespace toco
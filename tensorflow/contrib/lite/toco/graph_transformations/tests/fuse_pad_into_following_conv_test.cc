@@ -0,0 +1,112 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+
+namespace toco {
+
+namespace {
+
+void AddArray(Model* model, const string& name, const std::vector<int>& dims) {
+  Array& array = model->GetOrCreateArray(name);
+  array.data_type = ArrayDataType::kFloat;
+  *array.mutable_shape()->mutable_dims() = dims;
+}
+
+// Builds input -> Pad -> 3x3 VALID Conv -> output, with the given padding of
+// the rows and columns of a 4x4 input.
+void PrepareModel(Model* model, int stride, int pad_before, int pad_after) {
+  model->flags.add_output_arrays("output");
+  AddArray(model, "input", {1, 4, 4, 3});
+  AddArray(model, "paddings", {4, 2});
+  const int padded_size = 4 + pad_before + pad_after;
+  AddArray(model, "padded", {1, padded_size, padded_size, 3});
+  AddArray(model, "weights", {8, 3, 3, 3});
+  const int output_size = (padded_size - 3 + stride) / stride;
+  AddArray(model, "output", {1, output_size, output_size, 8});
+
+  auto* pad_op = new PadOperator;
+  pad_op->inputs = {"input", "paddings"};
+  pad_op->outputs = {"padded"};
+  pad_op->left_padding = {0, pad_before, pad_before, 0};
+  pad_op->right_padding = {0, pad_after, pad_after, 0};
+  model->operators.push_back(std::unique_ptr<Operator>(pad_op));
+
+  auto* conv_op = new ConvOperator;
+  conv_op->inputs = {"padded", "weights"};
+  conv_op->outputs = {"output"};
+  conv_op->padding.type = PaddingType::kValid;
+  conv_op->stride_width = stride;
+  conv_op->stride_height = stride;
+  model->operators.push_back(std::unique_ptr<Operator>(conv_op));
+}
+
+}  // namespace
+
+TEST(FusePadIntoFollowingConvTest, FusesSymmetricSamePadding) {
+  Model model;
+  PrepareModel(&model, /*stride=*/1, /*pad_before=*/1, /*pad_after=*/1);
+
+  FusePadIntoFollowingConv transformation;
+  ASSERT_TRUE(transformation.Run(&model, /*op_index=*/1));
+  ASSERT_EQ(model.operators.size(), 1);
+  const auto* conv_op =
+      static_cast<const ConvOperator*>(model.operators[0].get());
+  EXPECT_EQ(conv_op->inputs[0], "input");
+  EXPECT_EQ(conv_op->padding.type, PaddingType::kSame);
+  ASSERT_NE(conv_op->padding.fixed, nullptr);
+  EXPECT_EQ(conv_op->padding.fixed->height, 1);
+  EXPECT_EQ(conv_op->padding.fixed->width, 1);
+  EXPECT_FALSE(model.HasArray("padded"));
+  EXPECT_FALSE(model.HasArray("paddings"));
+}
+
+TEST(FusePadIntoFollowingConvTest, FusesAsymmetricSamePadding) {
+  // SAME padding puts the odd row and column after the input.
+  Model model;
+  PrepareModel(&model, /*stride=*/2, /*pad_before=*/0, /*pad_after=*/1);
+
+  FusePadIntoFollowingConv transformation;
+  ASSERT_TRUE(transformation.Run(&model, /*op_index=*/1));
+  ASSERT_EQ(model.operators.size(), 1);
+  const auto* conv_op =
+      static_cast<const ConvOperator*>(model.operators[0].get());
+  EXPECT_EQ(conv_op->padding.type, PaddingType::kSame);
+  EXPECT_EQ(conv_op->padding.fixed->height, 0);
+  EXPECT_EQ(conv_op->padding.fixed->width, 0);
+}
+
+TEST(FusePadIntoFollowingConvTest, KeepsOtherPadding) {
+  Model model;
+  PrepareModel(&model, /*stride=*/2, /*pad_before=*/1, /*pad_after=*/0);
+
+  FusePadIntoFollowingConv transformation;
+  EXPECT_FALSE(transformation.Run(&model, /*op_index=*/1));
+  EXPECT_EQ(model.operators.size(), 2);
+
+  Model larger_padding_model;
+  PrepareModel(&larger_padding_model, /*stride=*/1, /*pad_before=*/2,
+               /*pad_after=*/2);
+  EXPECT_FALSE(transformation.Run(&larger_padding_model, /*op_index=*/1));
+  EXPECT_EQ(larger_padding_model.operators.size(), 2);
+}
+
+}  // namespace toco
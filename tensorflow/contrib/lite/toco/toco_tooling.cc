@@ -76,7 +76,9 @@ void MakeGeneralGraphTransformationsSet(
   transformations->Add(new ResolveTensorFlowMatMul);
   transformations->Add(new FuseBinaryIntoPrecedingAffine);
   transformations->Add(new FuseBinaryIntoFollowingAffine);
+  transformations->Add(new FusePadIntoFollowingConv);
   transformations->Add(new MergeReshapeIntoPrecedingTranspose);
+  transformations->Add(new MergeTransposeIntoPrecedingTranspose);
   transformations->Add(new ReorderElementwiseUnary);
   transformations->Add(new ReorderReshapeTranspose);
   transformations->Add(new ResolveBatchNormalization);
@@ -13,17 +13,27 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cmath>
 #include <cstdarg>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
+#ifndef PLATFORM_WINDOWS
+#include <sys/resource.h>
+#endif
+
 #include "tensorflow/contrib/lite/kernels/register.h"
 #include "tensorflow/contrib/lite/model.h"
 #include "tensorflow/contrib/lite/op_resolver.h"
+#include "tensorflow/contrib/lite/profiling/profiler.h"
+#include "tensorflow/contrib/lite/schema/schema_generated.h"
 #include "tensorflow/contrib/lite/string_util.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/env.h"
@@ -125,6 +135,8 @@ bool CreateInterpreter(const string& graph,
   return true;
 }
 
+bool FillInputTensors(Interpreter* interpreter);
+
 bool PrepareInterpreter(const std::vector<InputLayerInfo> inputs,
                         int num_threads, bool use_nnapi,
                         Interpreter* interpreter) {
@@ -160,8 +172,11 @@ bool PrepareInterpreter(const std::vector<InputLayerInfo> inputs,
     std::cerr << "Failed to allocate tensors!" << std::endl;
     return false;
   }
+  return FillInputTensors(interpreter);
+}
 
-  // Set the values of the input tensors.
+// Sets the input tensors to random values.
+bool FillInputTensors(Interpreter* interpreter) {
   for (int i : interpreter->inputs()) {
     TfLiteTensor* t = interpreter->tensor(i);
     std::vector<int> sizes = ShapeFromTfLiteTensor(t);
@@ -275,8 +290,12 @@ class Latencies {
     ++count_;
     sum_ += time_us;
     squared_sum_ += static_cast<double>(time_us) * time_us;
+    samples_.push_back(time_us);
+    sorted_ = false;
   }
 
+  int64_t count() const { return count_; }
+
   double avg() const {
     if (count_ == 0) return std::numeric_limits<int64_t>::quiet_NaN();
     return static_cast<double>(sum_) / count_;
@@ -287,11 +306,26 @@ class Latencies {
     return sqrt(squared_sum_ / count_ - avg() * avg());
   }
 
-  void OutputToStream(std::ostream* stream) const {
+  // Returns the smallest measurement that is larger than or equal to
+  // 'percent'% of the measurements (the nearest-rank percentile).
+  int64_t percentile(double percent) {
+    if (count_ == 0) return 0;
+    if (!sorted_) {
+      std::sort(samples_.begin(), samples_.end());
+      sorted_ = true;
+    }
+    int64_t rank = static_cast<int64_t>(std::ceil(percent / 100 * count_));
+    rank = std::min(std::max<int64_t>(rank, 1), count_);
+    return samples_[rank - 1];
+  }
+
+  void OutputToStream(std::ostream* stream) {
     *stream << "count=" << count_;
     if (count_ == 0) return;
     *stream << " min=" << min_ << " max=" << max_;
     *stream << " avg=" << avg() << " std=" << std_deviation();
+    *stream << " p50=" << percentile(50) << " p90=" << percentile(90)
+            << " p99=" << percentile(99);
   }
 
  private:
@@ -300,48 +334,155 @@ class Latencies {
   int64_t max_ = std::numeric_limits<int64_t>::min();
   int64_t sum_ = 0;
   double squared_sum_ = 0;
+  std::vector<int64_t> samples_;
+  bool sorted_ = true;
 };
 
-bool TimeMultipleRuns(Interpreter* interpreter, double sleep_seconds,
-                      int num_runs, int64* total_time_us) {
+// Returns the peak resident memory of the process so far, in kilobytes, or
+// -1 if it isn't known.
+int64_t PeakMemoryKb() {
+#ifdef PLATFORM_WINDOWS
+  return -1;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+  // macOS reports bytes rather than kilobytes.
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+void SleepBetweenRuns(double sleep_seconds) {
+  // If requested, sleep between runs for an arbitrary amount of time.
+  // This can be helpful to determine the effect of mobile processor
+  // scaling and thermal throttling.
+  if (sleep_seconds <= 0.0) return;
+#ifdef PLATFORM_WINDOWS
+  Sleep(sleep_seconds * 1000);
+#else
   // Convert the run_delay string into a timespec.
   timespec req;
   req.tv_sec = static_cast<time_t>(sleep_seconds);
   req.tv_nsec = (sleep_seconds - req.tv_sec) * 1000000000;
+  nanosleep(&req, nullptr);
+#endif
+}
 
+// Runs the interpreter 'num_runs' times, adding the latency of each run to
+// 'latencies' if it isn't null.
+bool TimeMultipleRuns(Interpreter* interpreter, double sleep_seconds,
+                      int num_runs, int64* total_time_us,
+                      Latencies* latencies = nullptr) {
   *total_time_us = 0;
 
   std::cout << "Running benchmark for " << num_runs
             << " iterations: " << std::endl;
 
-  Latencies latencies;
+  Latencies run_latencies;
   for (int i = 0; i < num_runs; ++i) {
     int64_t time_us;
     bool run_status = RunBenchmark(interpreter, &time_us);
-    latencies.AddMeasurement(time_us);
+    run_latencies.AddMeasurement(time_us);
     *total_time_us += time_us;
     if (!run_status) {
       std::cout << "Failed on run " << i << std::endl;
       return false;
     }
-
-    // If requested, sleep between runs for an arbitrary amount of time.
-    // This can be helpful to determine the effect of mobile processor
-    // scaling and thermal throttling.
-    if (sleep_seconds > 0.0) {
-#ifdef PLATFORM_WINDOWS
-      Sleep(sleep_seconds * 1000);
-#else
-      nanosleep(&req, nullptr);
-#endif
-    }
+    SleepBetweenRuns(sleep_seconds);
   }
-  latencies.OutputToStream(&std::cout);
+  run_latencies.OutputToStream(&std::cout);
   std::cout << std::endl;
+  if (latencies != nullptr) *latencies = run_latencies;
+
+  return true;
+}
 
+// Runs the interpreter 'num_runs' times with a profiler attached, adding the
+// latency of each operator invocation to 'op_latencies', keyed by node index.
+// Only records anything if TF Lite was built with TFLITE_PROFILING_ENABLED.
+bool ProfileMultipleRuns(Interpreter* interpreter, double sleep_seconds,
+                         int num_runs, std::map<int, Latencies>* op_latencies) {
+  std::cout << "Profiling operators for " << num_runs
+            << " iterations: " << std::endl;
+  profiling::Profiler profiler;
+  interpreter->SetProfiler(&profiler);
+  for (int i = 0; i < num_runs; ++i) {
+    profiler.Reset();
+    profiler.StartProfiling();
+    TfLiteStatus status = interpreter->Invoke();
+    profiler.StopProfiling();
+    if (status != kTfLiteOk) {
+      std::cout << "Failed on run " << i << std::endl;
+      interpreter->SetProfiler(nullptr);
+      return false;
+    }
+    for (const profiling::ProfileEvent* event : profiler.GetProfileEvents()) {
+      if (event->event_type !=
+              profiling::ProfileEvent::EventType::OPERATOR_INVOKE_EVENT ||
+          event->end_timestamp_us < event->begin_timestamp_us) {
+        continue;
+      }
+      (*op_latencies)[event->event_metadata].AddMeasurement(
+          event->end_timestamp_us - event->begin_timestamp_us);
+    }
+    SleepBetweenRuns(sleep_seconds);
+  }
+  interpreter->SetProfiler(nullptr);
+  if (op_latencies->empty()) {
+    std::cout << "No operator timings; build TF Lite with "
+              << "--copt=-DTFLITE_PROFILING_ENABLED to get them." << std::endl;
+  }
   return true;
 }
 
+string GetOperatorType(const Interpreter& interpreter, int node_index) {
+  const auto* node_and_reg = interpreter.node_and_registration(node_index);
+  const TfLiteRegistration& registration = node_and_reg->second;
+  if (registration.builtin_code == BuiltinOperator_CUSTOM ||
+      registration.builtin_code == BuiltinOperator_DELEGATE) {
+    return registration.custom_name ? registration.custom_name
+                                    : "UnknownCustomOp";
+  }
+  return EnumNameBuiltinOperator(
+      static_cast<BuiltinOperator>(registration.builtin_code));
+}
+
+// Names a node after its first output, as the profile summarizer does.
+string GetNodeName(const Interpreter& interpreter, int node_index) {
+  const TfLiteNode& node =
+      interpreter.node_and_registration(node_index)->first;
+  if (node.outputs->size == 0) return "";
+  const TfLiteTensor* tensor = interpreter.tensor(node.outputs->data[0]);
+  return tensor->name ? tensor->name : "";
+}
+
+// Writes the results for one thread count as CSV rows: one for the whole
+// model, with 'ALL' as operator type, then one per operator in execution
+// order. Times are in microseconds.
+void WriteCsvRows(const Interpreter& interpreter, int num_threads,
+                  const string& model_name, Latencies* model_latencies,
+                  std::map<int, Latencies>* op_latencies,
+                  std::ostream* stream) {
+  auto write_row = [&](int node_index, const string& type, const string& name,
+                       Latencies* latencies) {
+    *stream << num_threads << "," << node_index << "," << type << "," << name
+            << "," << latencies->count() << "," << latencies->avg() << ","
+            << latencies->percentile(50) << "," << latencies->percentile(90)
+            << "," << latencies->percentile(99) << "," << PeakMemoryKb()
+            << "\n";
+  };
+  write_row(-1, "ALL", model_name, model_latencies);
+  for (int node_index : interpreter.execution_plan()) {
+    auto it = op_latencies->find(node_index);
+    if (it == op_latencies->end()) continue;
+    write_row(node_index, GetOperatorType(interpreter, node_index),
+              GetNodeName(interpreter, node_index), &it->second);
+  }
+}
+
 int Main(int argc, char** argv) {
   using tensorflow::Flag;
   using tensorflow::Flags;
@@ -359,6 +500,9 @@ int Main(int argc, char** argv) {
   string output_prefix = "";
   int warmup_runs = 1;
   bool use_nnapi = false;
+  string num_threads_sweep = "";
+  bool enable_op_profiling = false;
+  string csv_file = "";
 
   std::vector<Flag> flag_list = {
       Flag("graph", &graph, "graph file name"),
@@ -377,6 +521,15 @@ int Main(int argc, char** argv) {
       Flag("output_prefix", &output_prefix, "benchmark output prefix"),
       Flag("warmup_runs", &warmup_runs, "how many runs to initialize model"),
       Flag("use_nnapi", &use_nnapi, "use nnapi api"),
+      Flag("num_threads_sweep", &num_threads_sweep,
+           "comma-separated thread counts to benchmark one after the other, "
+           "in place of num_threads"),
+      Flag("enable_op_profiling", &enable_op_profiling,
+           "time each operator in additional profiled runs; needs a build "
+           "with --copt=-DTFLITE_PROFILING_ENABLED"),
+      Flag("csv_file", &csv_file,
+           "file to write the model and operator latency percentiles and the "
+           "peak memory to, as CSV"),
   };
   string usage = Flags::Usage(argv[0], flag_list);
   const bool parse_result = Flags::Parse(&argc, argv, flag_list);
@@ -407,6 +560,15 @@ int Main(int argc, char** argv) {
   }
   std::cout << "Warmup runs: [" << warmup_runs << "]" << std::endl;
   std::cout << "Use nnapi : [" << use_nnapi << "]" << std::endl;
+  if (!num_threads_sweep.empty()) {
+    std::cout << "Num threads sweep: [" << num_threads_sweep << "]"
+              << std::endl;
+  }
+  std::cout << "Enable op profiling: [" << enable_op_profiling << "]"
+            << std::endl;
+  if (!csv_file.empty()) {
+    std::cout << "CSV file: [" << csv_file << "]" << std::endl;
+  }
 
   if (graph.empty()) {
     std::cout
@@ -415,6 +577,25 @@ int Main(int argc, char** argv) {
     return -1;
   }
 
+  std::vector<int> thread_counts = {num_threads};
+  if (!num_threads_sweep.empty() &&
+      !SplitAndParseAsInts(num_threads_sweep, ',', &thread_counts)) {
+    std::cerr << "Incorrect thread counts specified: " << num_threads_sweep
+              << std::endl;
+    return -1;
+  }
+
+  std::unique_ptr<std::ofstream> csv_stream;
+  if (!csv_file.empty()) {
+    csv_stream.reset(new std::ofstream(csv_file));
+    if (!*csv_stream) {
+      std::cerr << "Failed to open " << csv_file << std::endl;
+      return -1;
+    }
+    *csv_stream << "num_threads,node_index,op_type,node_name,count,avg_us,"
+                << "p50_us,p90_us,p99_us,peak_memory_kb\n";
+  }
+
   std::vector<InputLayerInfo> inputs;
   if (!PopulateInputLayerInfo(input_layer_string, input_layer_shape_string,
                               input_layer_type_string,
@@ -429,7 +610,8 @@ int Main(int argc, char** argv) {
   if (!CreateInterpreter(graph, &model, &interpreter)) {
     return -1;
   }
-  if (!PrepareInterpreter(inputs, num_threads, use_nnapi, interpreter.get())) {
+  if (!PrepareInterpreter(inputs, thread_counts[0], use_nnapi,
+                          interpreter.get())) {
     return -1;
   }
 
@@ -441,31 +623,66 @@ int Main(int argc, char** argv) {
             << std::endl;
 
   const double sleep_seconds = std::strtod(run_delay.c_str(), nullptr);
+  const string model_name = benchmark_name.empty() ? graph : benchmark_name;
+
+  for (int i = 0; i < thread_counts.size(); ++i) {
+    const int threads = thread_counts[i];
+    if (i > 0) {
+      // Kernels pick up the number of threads when they are prepared.
+      interpreter->SetNumThreads(threads);
+      if (interpreter->AllocateTensors() != kTfLiteOk ||
+          !FillInputTensors(interpreter.get())) {
+        std::cerr << "Failed to prepare for " << threads << " threads"
+                  << std::endl;
+        return -1;
+      }
+    }
+    if (thread_counts.size() > 1) {
+      std::cout << "Benchmarking with " << threads << " threads" << std::endl;
+    }
 
-  // If requested, run through the graph first to preinitialize everything
-  // before the benchmarking runs.
-  int64 warmup_time_us = 0;
-  if (warmup_runs > 0) {
-    if (!TimeMultipleRuns(interpreter.get(), sleep_seconds, warmup_runs,
-                          &warmup_time_us)) {
-      std::cerr << "Warmup failed" << std::endl;
+    // If requested, run through the graph first to preinitialize everything
+    // before the benchmarking runs.
+    int64 warmup_time_us = 0;
+    if (warmup_runs > 0) {
+      if (!TimeMultipleRuns(interpreter.get(), sleep_seconds, warmup_runs,
+                            &warmup_time_us)) {
+        std::cerr << "Warmup failed" << std::endl;
+        return -1;
+      }
+    }
+
+    // Capture overall inference time without stat logging overhead. This is
+    // the timing data that can be compared to other libaries.
+    int64 no_stat_time_us = 0;
+    Latencies latencies;
+    if (!TimeMultipleRuns(interpreter.get(), sleep_seconds, num_runs,
+                          &no_stat_time_us, &latencies)) {
+      std::cerr << "Timing failed." << std::endl;
       return -1;
     }
-  }
 
-  // Capture overall inference time without stat logging overhead. This is the
-  // timing data that can be compared to other libaries.
-  int64 no_stat_time_us = 0;
-  if (!TimeMultipleRuns(interpreter.get(), sleep_seconds, num_runs,
-                        &no_stat_time_us)) {
-    std::cerr << "Timing failed." << std::endl;
-    return -1;
-  }
+    std::cout << "Average inference timings in us: "
+              << no_stat_time_us / num_runs << " , Warmup: "
+              << (warmup_runs > 0 ? warmup_time_us / warmup_runs : 0) << ", "
+              << std::endl;
 
-  std::cout << "Average inference timings in us: " << no_stat_time_us / num_runs
-            << " , Warmup: "
-            << (warmup_runs > 0 ? warmup_time_us / warmup_runs : 0) << ", "
-            << std::endl;
+    // Operator timings come from separate runs, so that profiling doesn't
+    // skew the timings above.
+    std::map<int, Latencies> op_latencies;
+    if (enable_op_profiling &&
+        !ProfileMultipleRuns(interpreter.get(), sleep_seconds, num_runs,
+                             &op_latencies)) {
+      std::cerr << "Profiling failed." << std::endl;
+      return -1;
+    }
+    std::cout << "Peak memory in KB: " << PeakMemoryKb() << std::endl;
+
+    if (csv_stream) {
+      WriteCsvRows(*interpreter, threads, model_name, &latencies,
+                   &op_latencies, csv_stream.get());
+    }
+  }
 
   return 0;
 }
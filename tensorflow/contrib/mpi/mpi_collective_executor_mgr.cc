@@ -0,0 +1,52 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifdef TENSORFLOW_USE_MPI
+
+#include "tensorflow/contrib/mpi/mpi_collective_executor_mgr.h"
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+
+namespace tensorflow {
+
+MPICollectiveExecutorMgr::MPICollectiveExecutorMgr(
+    const ConfigProto& config, const DeviceMgr* dev_mgr,
+    DeviceResolverInterface* dev_resolver,
+    ParamResolverInterface* param_resolver, const MPIUtils* mpiutils,
+    bool cuda_aware)
+    : CollectiveExecutorMgr(config, dev_mgr, dev_resolver, param_resolver),
+      transport_(mpiutils, dev_mgr, this, cuda_aware) {}
+
+CollectiveExecutor* MPICollectiveExecutorMgr::FindOrCreate(int64 step_id) {
+  CollectiveExecutor* ce = nullptr;
+  {
+    mutex_lock l(exec_mu_);
+    auto it = executor_table_.find(step_id);
+    if (it != executor_table_.end()) {
+      ce = it->second;
+    } else {
+      CollectiveRemoteAccessMPI* rma = new CollectiveRemoteAccessMPI(
+          dev_mgr_, dev_resolver_.get(), &transport_, step_id);
+      ce = new BaseCollectiveExecutor(this, rma, step_id, dev_mgr_);
+      executor_table_[step_id] = ce;
+    }
+    ce->Ref();
+  }
+  return ce;
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_MPI
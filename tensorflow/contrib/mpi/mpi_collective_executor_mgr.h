@@ -0,0 +1,51 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_MPI_MPI_COLLECTIVE_EXECUTOR_MGR_H_
+#define TENSORFLOW_CONTRIB_MPI_MPI_COLLECTIVE_EXECUTOR_MGR_H_
+
+#ifdef TENSORFLOW_USE_MPI
+
+#include "tensorflow/contrib/mpi/mpi_collective_rma.h"
+#include "tensorflow/contrib/mpi/mpi_utils.h"
+#include "tensorflow/core/common_runtime/collective_executor_mgr.h"
+
+namespace tensorflow {
+
+// CollectiveExecutorMgr whose collective ops exchange buffers with peers in
+// other tasks over MPI.
+class MPICollectiveExecutorMgr : public CollectiveExecutorMgr {
+ public:
+  MPICollectiveExecutorMgr(const ConfigProto& config, const DeviceMgr* dev_mgr,
+                           DeviceResolverInterface* dev_resolver,
+                           ParamResolverInterface* param_resolver,
+                           const MPIUtils* mpiutils, bool cuda_aware);
+
+  ~MPICollectiveExecutorMgr() override {}
+
+  CollectiveExecutor* FindOrCreate(int64 step_id) override;
+
+  // The transport shared by the executors of all steps. Its Poll() method
+  // must be run on the MPI thread.
+  MPICollectiveTransport* transport() { return &transport_; }
+
+ private:
+  MPICollectiveTransport transport_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_MPI
+#endif  // TENSORFLOW_CONTRIB_MPI_MPI_COLLECTIVE_EXECUTOR_MGR_H_
@@ -0,0 +1,402 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifdef TENSORFLOW_USE_MPI
+
+#include "tensorflow/contrib/mpi/mpi_collective_rma.h"
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/copy_tensor.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Runs `fn` once the work already queued on the stream of `device_ctx` has
+// completed, so that MPI neither reads device memory before it is written
+// nor overwrites memory that queued kernels may still read.
+void WhenStreamDone(Device* device, DeviceContext* device_ctx,
+                    std::function<void()> fn) {
+  const DeviceBase::GpuDeviceInfo* gpu_info =
+      device->tensorflow_gpu_device_info();
+  if (gpu_info == nullptr || device_ctx == nullptr ||
+      device_ctx->stream() == nullptr) {
+    fn();
+    return;
+  }
+  gpu_info->event_mgr->ThenExecute(device_ctx->stream(), std::move(fn));
+}
+
+bool OnHost(Device* device, const AllocatorAttributes& attr) {
+  return device->attributes().device_type() == DEVICE_CPU || attr.on_host();
+}
+
+}  // namespace
+
+struct MPICollectiveTransport::RecvCall {
+  int rank = -1;
+  MPIRecvBufRequest request;
+  string request_buffer;  // Serialized request, kept alive while in flight.
+  Device* to_device = nullptr;
+  DeviceContext* to_device_ctx = nullptr;
+  AllocatorAttributes to_alloc_attr;
+  Tensor* to_tensor = nullptr;
+  StatusCallback done;
+
+  // Host copy of a device destination that MPI can not write to directly.
+  std::unique_ptr<Tensor> staging;
+  Device* staging_device = nullptr;
+  AllocatorAttributes staging_attr;
+
+  MPI_Request request_send;
+  MPI_Request data_recv;
+  MPI_Status data_status;
+  int request_sent = 0;  // Int instead of bool for MPI_Test
+  int data_received = 0;
+};
+
+struct MPICollectiveTransport::SendCall {
+  int rank = -1;
+  int tag = -1;
+  // An empty message tells the receiver that the buffer is not coming.
+  const void* data = nullptr;
+  int64 num_bytes = 0;
+  // Host copy of a device buffer that MPI can not read directly.
+  std::unique_ptr<Tensor> staging;
+  // Released, which lets the producer go on, once the data has been sent.
+  BufRendezvous::Hook* hook = nullptr;
+
+  MPI_Request data_send;
+  int data_sent = 0;
+
+  ~SendCall() {
+    if (hook != nullptr) BufRendezvous::DoneWithHook(hook);
+  }
+};
+
+MPICollectiveTransport::MPICollectiveTransport(
+    const MPIUtils* mpiutils, const DeviceMgr* dev_mgr,
+    CollectiveExecutorMgrInterface* ce_mgr, bool cuda_aware)
+    : mpiutils_(mpiutils),
+      dev_mgr_(dev_mgr),
+      ce_mgr_(ce_mgr),
+      cuda_aware_(cuda_aware),
+      next_tag_(TAG_BUFDATA_BASE),
+      max_tag_(0) {}
+
+MPICollectiveTransport::~MPICollectiveTransport() {
+  mutex_lock l(mu_);
+  while (!pending_recvs_.empty()) {
+    std::unique_ptr<RecvCall> call(pending_recvs_.front());
+    pending_recvs_.pop();
+    call->done(errors::Cancelled("MPI collective transport shut down"));
+  }
+  while (!pending_sends_.empty()) {
+    delete pending_sends_.front();
+    pending_sends_.pop();
+  }
+}
+
+void MPICollectiveTransport::RecvBuf(
+    int64 step_id, const string& peer_device, const string& peer_task,
+    const string& key, Device* to_device, DeviceContext* to_device_ctx,
+    const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
+    const StatusCallback& done) {
+  if (!DMAHelper::CanUseDMA(to_tensor)) {
+    done(errors::Internal("Tensor value for key ", key,
+                          " is not of a type supported by MPI collectives"));
+    return;
+  }
+  const int64 num_bytes = to_tensor->TotalBytes();
+  // Larger buffers would have to be split over several messages.
+  if (num_bytes > std::numeric_limits<int>::max()) {
+    done(errors::Unimplemented("Buffer of ", num_bytes, " bytes for key ", key,
+                               " is too large for a single MPI transfer"));
+    return;
+  }
+  DeviceNameUtils::ParsedName parsed;
+  if (!DeviceNameUtils::ParseFullName(peer_task, &parsed)) {
+    done(errors::InvalidArgument("Could not parse task name ", peer_task));
+    return;
+  }
+
+  std::unique_ptr<RecvCall> call(new RecvCall);
+  call->rank = mpiutils_->GetSourceID(
+      strings::StrCat(parsed.job, ":", parsed.replica, ":", parsed.task));
+  RecvBufRequest* req = call->request.mutable_request();
+  req->set_step_id(step_id);
+  req->set_buf_rendezvous_key(key);
+  req->set_num_bytes(num_bytes);
+  req->set_src_device(peer_device);
+  req->set_dst_device(to_device->name());
+  call->to_device = to_device;
+  call->to_device_ctx = to_device_ctx;
+  call->to_alloc_attr = to_alloc_attr;
+  call->to_tensor = to_tensor;
+  call->done = done;
+
+  if (OnHost(to_device, to_alloc_attr)) {
+    QueueRecv(call.release());
+  } else if (cuda_aware_) {
+    RecvCall* recv_call = call.release();
+    WhenStreamDone(to_device, to_device_ctx,
+                   [this, recv_call]() { QueueRecv(recv_call); });
+  } else {
+    // Receive into GPU-registered host memory and copy it to the device
+    // once it has arrived.
+    Status s = dev_mgr_->LookupDevice("CPU:0", &call->staging_device);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    call->staging_attr.set_gpu_compatible(true);
+    call->staging.reset(
+        new Tensor(call->staging_device->GetAllocator(call->staging_attr),
+                   to_tensor->dtype(), to_tensor->shape()));
+    QueueRecv(call.release());
+  }
+}
+
+void MPICollectiveTransport::QueueRecv(RecvCall* call) {
+  mutex_lock l(mu_);
+  pending_recvs_.push(call);
+}
+
+void MPICollectiveTransport::QueueSend(SendCall* call) {
+  mutex_lock l(mu_);
+  pending_sends_.push(call);
+}
+
+void MPICollectiveTransport::ServeRequest(const MPIRecvBufRequest& request,
+                                          int rank) {
+  const RecvBufRequest& req = request.request();
+  const int tag = request.data_tag();
+  const int64 num_bytes = req.num_bytes();
+  const string key = req.buf_rendezvous_key();
+  CollectiveExecutor::Handle ce_handle(ce_mgr_->FindOrCreate(req.step_id()),
+                                       true /*inherit_ref*/);
+  ce_handle.get()->remote_access()->buf_rendezvous()->ConsumeBuf(
+      key, [this, rank, tag, num_bytes, key](const Status& status,
+                                             BufRendezvous::Hook* hook) {
+        SendCall* call = new SendCall;
+        call->rank = rank;
+        call->tag = tag;
+        call->hook = hook;
+        Status s = status;
+        if (s.ok() && !DMAHelper::CanUseDMA(hook->prod_value)) {
+          s = errors::Internal("Tensor value for key ", key,
+                               " is not of a type supported by MPI "
+                               "collectives");
+        }
+        if (s.ok() && hook->prod_value->TotalBytes() != num_bytes) {
+          s = errors::Internal("Tensor value for key ", key, " has ",
+                               hook->prod_value->TotalBytes(),
+                               " bytes where the peer expected ", num_bytes);
+        }
+        Device* cpu_dev = nullptr;
+        const bool on_host = s.ok() && OnHost(hook->prod_dev, hook->prod_attr);
+        if (s.ok() && !on_host && !cuda_aware_) {
+          s = dev_mgr_->LookupDevice("CPU:0", &cpu_dev);
+        }
+        if (!s.ok()) {
+          LOG(ERROR) << "MPI collective transfer of " << key
+                     << " failed: " << s;
+          QueueSend(call);
+          return;
+        }
+
+        call->num_bytes = num_bytes;
+        if (on_host) {
+          call->data = DMAHelper::base(hook->prod_value);
+          QueueSend(call);
+        } else if (cuda_aware_) {
+          call->data = DMAHelper::base(hook->prod_value);
+          WhenStreamDone(hook->prod_dev, hook->prod_ctx,
+                         [this, call]() { QueueSend(call); });
+        } else {
+          AllocatorAttributes cpu_attr;
+          cpu_attr.set_gpu_compatible(true);
+          call->staging.reset(new Tensor(cpu_dev->GetAllocator(cpu_attr),
+                                         hook->prod_value->dtype(),
+                                         hook->prod_value->shape()));
+          hook->prod_ctx->CopyDeviceTensorToCPU(
+              hook->prod_value, "", hook->prod_dev, call->staging.get(),
+              [this, call, key](const Status& s) {
+                if (s.ok()) {
+                  call->data = DMAHelper::base(call->staging.get());
+                } else {
+                  LOG(ERROR) << "MPI collective transfer of " << key
+                             << " failed: " << s;
+                  call->num_bytes = 0;
+                }
+                QueueSend(call);
+              });
+        }
+      });
+}
+
+void MPICollectiveTransport::StartRecv(std::unique_ptr<RecvCall> call) {
+  // Tags are reused once they wrap around, which is safe as long as fewer
+  // than (max_tag_ - TAG_BUFDATA_BASE) receives from one peer overlap.
+  const int tag = next_tag_;
+  next_tag_ = next_tag_ < max_tag_ ? next_tag_ + 1 : TAG_BUFDATA_BASE;
+  call->request.set_data_tag(tag);
+
+  Tensor* dst = call->staging ? call->staging.get() : call->to_tensor;
+  MPI_CHECK(MPI_Irecv(DMAHelper::base(dst), static_cast<int>(dst->TotalBytes()),
+                      MPI_BYTE, call->rank, tag, MPI_COMM_WORLD,
+                      &call->data_recv));
+  call->request.SerializeToString(&call->request_buffer);
+  MPI_CHECK(MPI_Isend(&call->request_buffer[0],
+                      static_cast<int>(call->request_buffer.size()), MPI_CHAR,
+                      call->rank, TAG_REQBUF, MPI_COMM_WORLD,
+                      &call->request_send));
+  active_recvs_.push_back(std::move(call));
+}
+
+void MPICollectiveTransport::FinishRecv(std::unique_ptr<RecvCall> call) {
+  int count = 0;
+  MPI_CHECK(MPI_Get_count(&call->data_status, MPI_BYTE, &count));
+  const RecvBufRequest& req = call->request.request();
+  // Callbacks must not run on the MPI thread, which they could block.
+  RecvCall* recv_call = call.release();
+  if (count != req.num_bytes()) {
+    Status s = errors::Internal("MPI peer ", req.src_device(), " sent ", count,
+                                " bytes for key ", req.buf_rendezvous_key(),
+                                " where ", req.num_bytes(), " were expected");
+    SchedClosure([recv_call, s]() {
+      recv_call->done(s);
+      delete recv_call;
+    });
+  } else if (recv_call->staging) {
+    CopyTensor::ViaDMA("",  // edge name (non-existent)
+                       nullptr /*send_dev_ctx*/, recv_call->to_device_ctx,
+                       recv_call->staging_device, recv_call->to_device,
+                       recv_call->staging_attr, recv_call->to_alloc_attr,
+                       recv_call->staging.get(), recv_call->to_tensor,
+                       [recv_call](const Status& s) {
+                         SchedClosure([recv_call, s]() {
+                           recv_call->done(s);
+                           delete recv_call;
+                         });
+                       });
+  } else {
+    SchedClosure([recv_call]() {
+      recv_call->done(Status::OK());
+      delete recv_call;
+    });
+  }
+}
+
+void MPICollectiveTransport::Poll() {
+  if (max_tag_ == 0) {
+    int* tag_ub = nullptr;
+    int flag = 0;
+    MPI_CHECK(MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_TAG_UB, &tag_ub, &flag));
+    // 32767 is the smallest upper bound that the MPI standard allows.
+    max_tag_ = flag ? *tag_ub : 32767;
+  }
+
+  // Start the transfers queued by other threads.
+  std::queue<RecvCall*> recvs;
+  std::queue<SendCall*> sends;
+  {
+    mutex_lock l(mu_);
+    recvs.swap(pending_recvs_);
+    sends.swap(pending_sends_);
+  }
+  for (; !recvs.empty(); recvs.pop()) {
+    StartRecv(std::unique_ptr<RecvCall>(recvs.front()));
+  }
+  for (; !sends.empty(); sends.pop()) {
+    std::unique_ptr<SendCall> call(sends.front());
+    MPI_CHECK(MPI_Isend(const_cast<void*>(call->data),
+                        static_cast<int>(call->num_bytes), MPI_BYTE,
+                        call->rank, call->tag, MPI_COMM_WORLD,
+                        &call->data_send));
+    active_sends_.push_back(std::move(call));
+  }
+
+  // Serve the requests of peers for buffers provided in this process.
+  while (true) {
+    int flag = 0;
+    MPI_Message msg;
+    MPI_Status status;
+    MPI_CHECK(MPI_Improbe(MPI_ANY_SOURCE, TAG_REQBUF, MPI_COMM_WORLD, &flag,
+                          &msg, &status));
+    if (!flag) break;
+    int msg_size = 0;
+    MPI_CHECK(MPI_Get_count(&status, MPI_CHAR, &msg_size));
+    std::vector<char> buffer(msg_size);
+    MPI_CHECK(
+        MPI_Mrecv(buffer.data(), msg_size, MPI_CHAR, &msg, MPI_STATUS_IGNORE));
+    MPIRecvBufRequest request;
+    CHECK(request.ParseFromArray(buffer.data(), msg_size))
+        << "Failed to parse incoming buffer request";
+    ServeRequest(request, status.MPI_SOURCE);
+  }
+
+  // Complete the finished transfers.
+  active_sends_.remove_if([](const std::unique_ptr<SendCall>& call) {
+    MPI_CHECK(MPI_Test(&call->data_send, &call->data_sent, MPI_STATUS_IGNORE));
+    return call->data_sent != 0;
+  });
+  for (auto it = active_recvs_.begin(); it != active_recvs_.end();) {
+    RecvCall* call = it->get();
+    if (!call->request_sent) {
+      MPI_CHECK(MPI_Test(&call->request_send, &call->request_sent,
+                         MPI_STATUS_IGNORE));
+    }
+    if (!call->data_received) {
+      MPI_CHECK(
+          MPI_Test(&call->data_recv, &call->data_received, &call->data_status));
+    }
+    if (call->request_sent && call->data_received) {
+      FinishRecv(std::move(*it));
+      it = active_recvs_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void CollectiveRemoteAccessMPI::RecvFromPeer(
+    const string& peer_device, const string& peer_task, bool peer_is_local,
+    const string& key, Device* to_device, DeviceContext* to_device_ctx,
+    const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
+    const DeviceLocality& client_locality, const StatusCallback& done) {
+  if (peer_is_local) {
+    CollectiveRemoteAccessLocal::RecvFromPeer(
+        peer_device, peer_task, peer_is_local, key, to_device, to_device_ctx,
+        to_alloc_attr, to_tensor, client_locality, done);
+    return;
+  }
+  transport_->RecvBuf(step_id_, peer_device, peer_task, key, to_device,
+                      to_device_ctx, to_alloc_attr, to_tensor, done);
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_MPI
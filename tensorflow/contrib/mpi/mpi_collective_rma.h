@@ -0,0 +1,125 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_MPI_MPI_COLLECTIVE_RMA_H_
+#define TENSORFLOW_CONTRIB_MPI_MPI_COLLECTIVE_RMA_H_
+
+#ifdef TENSORFLOW_USE_MPI
+
+#include <list>
+#include <memory>
+#include <queue>
+#include <string>
+
+#include "tensorflow/contrib/mpi/mpi_msg.pb.h"
+#include "tensorflow/contrib/mpi/mpi_utils.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/platform/mutex.h"
+
+#define TAG_REQBUF 4040
+// Tags from here up to MPI_TAG_UB carry the contents of collective buffers.
+#define TAG_BUFDATA_BASE 8192
+
+namespace tensorflow {
+
+// Moves the buffers exchanged by collective ops between processes using MPI.
+//
+// The receiving side posts a receive straight into the destination tensor
+// under a fresh tag and asks the peer, with an MPIRecvBufRequest, for the
+// buffer that the peer's collective provides to its BufRendezvous. The peer
+// answers by sending the raw bytes on that tag.
+//
+// With a CUDA-aware MPI library (`cuda_aware`) device memory is handed to
+// MPI directly, otherwise it is staged through host memory. MPI is
+// initialized without thread support, so all MPI calls are made from Poll(),
+// which MPIRendezvousMgr runs on its MPI thread.
+class MPICollectiveTransport {
+ public:
+  MPICollectiveTransport(const MPIUtils* mpiutils, const DeviceMgr* dev_mgr,
+                         CollectiveExecutorMgrInterface* ce_mgr,
+                         bool cuda_aware);
+  ~MPICollectiveTransport();
+
+  // Receives into `to_tensor` the buffer provided under `key` by
+  // `peer_device` of `peer_task` during step `step_id`.
+  void RecvBuf(int64 step_id, const string& peer_device,
+               const string& peer_task, const string& key, Device* to_device,
+               DeviceContext* to_device_ctx,
+               const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
+               const StatusCallback& done);
+
+  // Starts queued transfers, serves incoming requests and completes
+  // finished transfers. Must be called from the MPI thread.
+  void Poll();
+
+ private:
+  struct RecvCall;
+  struct SendCall;
+
+  void QueueRecv(RecvCall* call) LOCKS_EXCLUDED(mu_);
+  void QueueSend(SendCall* call) LOCKS_EXCLUDED(mu_);
+
+  // Looks up the buffer asked for by `request` and queues its transfer
+  // to `rank`.
+  void ServeRequest(const MPIRecvBufRequest& request, int rank);
+
+  void StartRecv(std::unique_ptr<RecvCall> call);
+  void FinishRecv(std::unique_ptr<RecvCall> call);
+
+  const MPIUtils* mpiutils_;                // Not owned
+  const DeviceMgr* dev_mgr_;                // Not owned
+  CollectiveExecutorMgrInterface* ce_mgr_;  // Not owned
+  const bool cuda_aware_;
+
+  mutex mu_;
+  std::queue<RecvCall*> pending_recvs_ GUARDED_BY(mu_);
+  std::queue<SendCall*> pending_sends_ GUARDED_BY(mu_);
+
+  // Only accessed from the MPI thread.
+  int next_tag_;
+  int max_tag_;
+  std::list<std::unique_ptr<RecvCall>> active_recvs_;
+  std::list<std::unique_ptr<SendCall>> active_sends_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MPICollectiveTransport);
+};
+
+// Extend CollectiveRemoteAccessLocal with MPI transfers from remote peers.
+class CollectiveRemoteAccessMPI : public CollectiveRemoteAccessLocal {
+ public:
+  CollectiveRemoteAccessMPI(const DeviceMgr* dev_mgr,
+                            DeviceResolverInterface* dev_resolver,
+                            MPICollectiveTransport* transport, int64 step_id)
+      : CollectiveRemoteAccessLocal(dev_mgr, dev_resolver, step_id),
+        transport_(transport) {}
+
+  ~CollectiveRemoteAccessMPI() override {}
+
+  void RecvFromPeer(const string& peer_device, const string& peer_task,
+                    bool peer_is_local, const string& key, Device* to_device,
+                    DeviceContext* to_device_ctx,
+                    const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
+                    const DeviceLocality& client_locality,
+                    const StatusCallback& done) override;
+
+ protected:
+  MPICollectiveTransport* transport_;  // Not owned
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_USE_MPI
+#endif  // TENSORFLOW_CONTRIB_MPI_MPI_COLLECTIVE_RMA_H_
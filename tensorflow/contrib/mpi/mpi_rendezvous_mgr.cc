@@ -312,6 +312,12 @@ void MPIRendezvousMgr::MPIBackgroundThread() {
       active_sends.push_back(std::move(p));
     }
 
+    // Make progress on the transfers of other MPI users
+    {
+      mutex_lock l(mpf_);
+      if (poll_fn_) poll_fn_();
+    }
+
     //    std::this_thread::sleep_for(std::chrono::microseconds(1));
   }
 }
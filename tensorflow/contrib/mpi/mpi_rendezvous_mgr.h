@@ -154,6 +154,17 @@ class MPIRendezvousMgr : public BaseRendezvousMgr {
     recv_tensor_map_[key_id] = std::shared_ptr<MPIRequestTensorCall>(rCall);
   }
 
+  // Runs `poll` on the MPI thread on every pass of its loop, in place of any
+  // function set before; nullptr stops polling. MPI is initialized without
+  // thread support, so other users of MPI in this process, such as the
+  // collectives, make their MPI calls from `poll`.
+  void SetPollFunction(std::function<void()> poll) {
+    mutex_lock l(mpf_);
+    poll_fn_ = std::move(poll);
+  }
+
+  const MPIUtils* mpiutils() const { return mpiutils_; }
+
  protected:
   BaseRemoteRendezvous* Create(int64 step_id,
                                const WorkerEnv* worker_env) override;
@@ -175,11 +186,13 @@ class MPIRendezvousMgr : public BaseRendezvousMgr {
 
   mutex msq_;
   mutex mrq_;
+  mutex mpf_;
 
   std::queue<SendQueueEntry> send_queue_ GUARDED_BY(msq_);
   std::queue<RequestQueueEntry> request_queue_ GUARDED_BY(mrq_);
   std::map<std::string, std::shared_ptr<MPIRequestTensorCall>> recv_tensor_map_
       GUARDED_BY(mrq_);
+  std::function<void()> poll_fn_ GUARDED_BY(mpf_);
 
   RecentRequestIds recv_tensor_recent_request_ids_;
 
@@ -22,10 +22,14 @@ limitations under the License.
 
 #include "grpc/support/alloc.h"
 
+#include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
+#include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/server_lib.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -50,14 +54,56 @@ MPIServer::MPIServer(const ServerDef& server_def, Env* env)
 MPIServer::~MPIServer() {
   TF_CHECK_OK(Stop());
   TF_CHECK_OK(Join());
+  if (mpi_rendezvous_mgr_ != nullptr) {
+    mpi_rendezvous_mgr_->SetPollFunction(nullptr);
+  }
+  worker_env()->collective_executor_mgr = nullptr;
 }
 
 Status MPIServer::Init(ServiceInitFunction service_func,
                        RendezvousMgrCreationFunction rendezvous_mgr_func) {
   Status s = GrpcServer::Init(service_func, rendezvous_mgr_func);
+  // Collectives only use MPI when the MPI path is enabled for tensors too.
+  MPIRendezvousMgr* rendezvous_mgr =
+      dynamic_cast<MPIRendezvousMgr*>(worker_env()->rendezvous_mgr);
+  if (s.ok() && rendezvous_mgr != nullptr) {
+    s = InitCollectives(rendezvous_mgr);
+  }
   return s;
 }
 
+Status MPIServer::InitCollectives(MPIRendezvousMgr* rendezvous_mgr) {
+  bool cuda_aware = false;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("MPI_CUDA_AWARE", false, &cuda_aware));
+  if (cuda_aware) {
+    LOG(INFO) << "MPI collectives pass device buffers to MPI directly "
+                 "(Requires CUDA-Aware MPI when using GPUs)";
+  }
+
+  string task_name;
+  string unused;
+  if (!DeviceNameUtils::SplitDeviceName(worker_env()->local_devices[0]->name(),
+                                        &task_name, &unused)) {
+    return errors::Internal("Could not parse worker name.");
+  }
+  WorkerCacheInterface* worker_cache = master_env()->worker_cache;
+  DeviceResolverDistributed* dev_resolver = new DeviceResolverDistributed(
+      worker_env()->device_mgr, worker_cache, task_name);
+  CollectiveParamResolverDistributed* param_resolver =
+      new CollectiveParamResolverDistributed(
+          server_def().default_session_config(), worker_env()->device_mgr,
+          dev_resolver, worker_cache, task_name);
+  collective_executor_mgr_.reset(new MPICollectiveExecutorMgr(
+      server_def().default_session_config(), worker_env()->device_mgr,
+      dev_resolver, param_resolver, rendezvous_mgr->mpiutils(), cuda_aware));
+
+  MPICollectiveTransport* transport = collective_executor_mgr_->transport();
+  rendezvous_mgr->SetPollFunction([transport]() { transport->Poll(); });
+  mpi_rendezvous_mgr_ = rendezvous_mgr;
+  worker_env()->collective_executor_mgr = collective_executor_mgr_.get();
+  return Status::OK();
+}
+
 Status MPIServer::Start() {
   Status s = GrpcServer::Start();
   return s;
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <memory>
 
+#include "tensorflow/contrib/mpi/mpi_collective_executor_mgr.h"
 #include "tensorflow/contrib/mpi/mpi_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
 
@@ -46,6 +47,13 @@ class MPIServer : public GrpcServer {
               RendezvousMgrCreationFunction rendezvous_mgr_func);
   Status ChannelCacheFactory(const ServerDef& server_def,
                              GrpcChannelCache** channel_cache);
+
+ private:
+  // Runs the collective ops of this worker over MPI.
+  Status InitCollectives(MPIRendezvousMgr* rendezvous_mgr);
+
+  MPIRendezvousMgr* mpi_rendezvous_mgr_ = nullptr;  // Not owned
+  std::unique_ptr<MPICollectiveExecutorMgr> collective_executor_mgr_;
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,176 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include <memory>
+
+#include "third_party/nccl/nccl.h"
+#include "tensorflow/contrib/nccl/kernels/nccl_manager.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/ring_reducer.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace {
+
+// Carries out CollectiveReduce ops with implementation 'nccl' as an
+// NcclManager all-reduce over the devices of the group. NcclManager creates
+// its communicators within one process, so all devices of the group must be
+// GPUs of the local task.
+class NcclReducer : public CollectiveReducer {
+ public:
+  NcclReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+              OpKernelContext* ctx, OpKernelContext::Params* op_params,
+              const CollectiveParams& col_params, const string& exec_key,
+              int64 step_id, const Tensor* input, Tensor* output)
+      : col_exec_(col_exec),
+        dev_mgr_(dev_mgr),
+        ctx_(ctx),
+        op_params_(op_params),
+        col_params_(col_params),
+        exec_key_(exec_key),
+        step_id_(step_id),
+        input_(input),
+        output_(output) {}
+
+  // Returns an error if the reduction described by 'col_params' can not be
+  // done with NCCL.
+  static Status CheckApplicable(const CollectiveParams& col_params) {
+    if (col_params.group.device_type != DEVICE_GPU) {
+      return errors::InvalidArgument(
+          "The NCCL implementation of CollectiveReduce only supports GPU "
+          "devices, not ",
+          col_params.group.device_type);
+    }
+    for (bool is_local : col_params.task.is_local) {
+      if (!is_local) {
+        return errors::InvalidArgument(
+            "The NCCL implementation of CollectiveReduce only supports groups "
+            "within one task, but group ",
+            col_params.group.group_key, " spans ",
+            col_params.group.num_tasks, " tasks");
+      }
+    }
+    const string& merge_op = col_params.merge_op->type_string();
+    if (merge_op != "Add" && merge_op != "Mul") {
+      return errors::InvalidArgument(
+          "The NCCL implementation of CollectiveReduce does not support "
+          "merge_op ",
+          merge_op);
+    }
+    return Status::OK();
+  }
+
+  void Run(StatusCallback done) override {
+    Device* device = nullptr;
+    Status status = dev_mgr_->LookupDevice(
+        col_params_.instance.device_names[col_params_.default_rank], &device);
+    if (status.ok()) status = AllReduce();
+    if (status.ok()) status = Finalize(device);
+    if (!status.ok()) col_exec_->StartAbort(status);
+    done(status);
+  }
+
+ private:
+  Status AllReduce() {
+    // All devices of the group meet under the same key in NcclManager.
+    const string key = strings::StrCat("CollectiveReduce;", step_id_, ";",
+                                       exec_key_);
+    const ncclRedOp_t reduction_op =
+        col_params_.merge_op->type_string() == "Mul" ? ncclProd : ncclSum;
+    auto* compute_stream = ctx_->op_device_context()->stream();
+    auto* gpu_info = ctx_->device()->tensorflow_gpu_device_info();
+    Status status;
+    Notification note;
+    NcclManager::instance()->AddToAllReduce(
+        col_params_.group.group_size, key, reduction_op,
+        compute_stream->parent(), gpu_info->gpu_id, gpu_info->event_mgr,
+        compute_stream, input_, output_, [&note, &status](Status s) {
+          status = s;
+          note.Notify();
+        });
+    note.WaitForNotification();
+    return status;
+  }
+
+  // Applies final_op to the reduced value and the group size, as
+  // HierarchicalReducer does.
+  Status Finalize(Device* device) {
+    if (!col_params_.final_op) return Status::OK();
+    // The adapter takes over output_ just long enough to make the scalars.
+    std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+        output_, 1, device->GetAllocator(ctx_->output_alloc_attr(0))));
+    Tensor group_size_val = ca->Scalar(col_params_.group.group_size);
+    Tensor group_size_tensor =
+        ca->Scalar(device->GetAllocator(ctx_->input_alloc_attr(0)));
+    ca->ConsumeFinalValue(output_);
+    Status status;
+    Notification note;
+    ctx_->op_device_context()->CopyCPUTensorToDevice(
+        &group_size_val, device, &group_size_tensor,
+        [&note, &status](const Status& s) {
+          status = s;
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) return status;
+    return RingReducer::ComputeBinOp(ctx_, op_params_, device,
+                                     col_params_.final_op.get(), output_,
+                                     &group_size_tensor);
+  }
+
+  CollectiveExecutor* col_exec_;  // Not owned
+  const DeviceMgr* dev_mgr_;      // Not owned
+  OpKernelContext* ctx_;          // Not owned
+  OpKernelContext::Params* op_params_;
+  const CollectiveParams& col_params_;
+  const string exec_key_;
+  const int64 step_id_;
+  const Tensor* input_;  // Not owned
+  Tensor* output_;       // Not owned
+
+  TF_DISALLOW_COPY_AND_ASSIGN(NcclReducer);
+};
+
+CollectiveReducer* CreateNcclReducer(
+    CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+    OpKernelContext* ctx, OpKernelContext::Params* op_params,
+    const CollectiveParams& col_params, const string& exec_key, int64 step_id,
+    const Tensor* input, Tensor* output, string* error) {
+  Status status = NcclReducer::CheckApplicable(col_params);
+  if (!status.ok()) {
+    *error = status.error_message();
+    return nullptr;
+  }
+  return new NcclReducer(col_exec, dev_mgr, ctx, op_params, col_params,
+                         exec_key, step_id, input, output);
+}
+
+class NcclReducerRegistrar {
+ public:
+  NcclReducerRegistrar() {
+    RegisterCollectiveReducerFactory(NCCL_IMPLEMENTATION, CreateNcclReducer);
+  }
+};
+static NcclReducerRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
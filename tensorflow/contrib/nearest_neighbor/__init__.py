@@ -25,6 +25,17 @@ The following ops generate multiprobe sequences for various hash families.
 
 @@hyperplane_lsh_hash
 
+### Inverted file index ops
+
+The following ops build, store and search an inverted file index for maximum
+inner product search.
+
+@@ivf_index
+@@ivf_index_build
+@@ivf_index_serialize
+@@ivf_index_deserialize
+@@ivf_index_search
+
 """
 
 from __future__ import absolute_import
@@ -0,0 +1,257 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_NEAREST_NEIGHBOR_KERNELS_IVF_INDEX_H_
+#define TENSORFLOW_CONTRIB_NEAREST_NEIGHBOR_KERNELS_IVF_INDEX_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+
+#include "tensorflow/contrib/nearest_neighbor/kernels/heap.h"
+
+namespace tensorflow {
+namespace nearest_neighbor {
+
+// An inverted file (IVF) index for maximum inner product search.
+//
+// The points are partitioned into lists, one per centroid, by their nearest
+// centroid in Euclidean distance. A query scores the centroids the same way,
+// scans the points of the num_probes nearest lists with one matrix-vector
+// product per list and returns the k points with the largest inner product.
+// With num_probes equal to the number of lists the search is exact.
+//
+// The centroids are supplied by the caller, typically the result of running
+// k-means on (a sample of) the points. Searching is thread-safe; building and
+// deserializing are not.
+template <typename CoordinateType, typename IdType>
+class IvfIndex {
+ public:
+  using Matrix = Eigen::Matrix<CoordinateType, Eigen::Dynamic, Eigen::Dynamic,
+                               Eigen::RowMajor>;
+  using ConstMatrixMap = Eigen::Map<const Matrix>;
+  using Vector =
+      Eigen::Matrix<CoordinateType, Eigen::Dynamic, 1, Eigen::ColMajor>;
+  using ConstVectorMap = Eigen::Map<const Vector>;
+
+  // Per-thread buffers for Search, so that repeated searches do not allocate.
+  struct Scratch {
+    std::vector<std::pair<CoordinateType, int_fast32_t>> list_distances;
+    Vector scores;
+    SimpleHeap<CoordinateType, IdType> heap;
+  };
+
+  int dimension() const { return centroids_.cols(); }
+  int num_lists() const { return centroids_.rows(); }
+  int64_t num_points() const { return ids_.size(); }
+
+  // Replaces the centroids and removes all points from the index.
+  void SetCentroids(const ConstMatrixMap& centroids) {
+    centroids_ = centroids;
+    centroid_norms_ = centroids_.rowwise().squaredNorm();
+    list_offsets_.assign(centroids_.rows() + 1, 0);
+    points_.resize(0, centroids_.cols());
+    ids_.clear();
+  }
+
+  // Returns the list point belongs to, i.e., its nearest centroid.
+  int_fast32_t NearestList(const CoordinateType* point) const {
+    const Vector distances =
+        centroid_norms_ -
+        2 * centroids_ * ConstVectorMap(point, centroids_.cols());
+    Eigen::Index nearest;
+    distances.minCoeff(&nearest);
+    return nearest;
+  }
+
+  // Replaces the points of the index. lists[i] is the list of points.row(i),
+  // as computed by NearestList.
+  void SetPoints(const ConstMatrixMap& points, const IdType* ids,
+                 const int_fast32_t* lists) {
+    const int64_t num_points = points.rows();
+    list_offsets_.assign(num_lists() + 1, 0);
+    for (int64_t i = 0; i < num_points; ++i) {
+      ++list_offsets_[lists[i] + 1];
+    }
+    for (int_fast32_t list = 0; list < num_lists(); ++list) {
+      list_offsets_[list + 1] += list_offsets_[list];
+    }
+    // Store the points of each list contiguously so that scanning a list is
+    // a single matrix-vector product.
+    std::vector<int64_t> next(list_offsets_.begin(), list_offsets_.end() - 1);
+    points_.resize(num_points, dimension());
+    ids_.resize(num_points);
+    for (int64_t i = 0; i < num_points; ++i) {
+      const int64_t row = next[lists[i]]++;
+      points_.row(row) = points.row(i);
+      ids_[row] = ids[i];
+    }
+  }
+
+  // Writes the ids and inner products of the (approximately) k best points
+  // for query to ids and scores, best first. If the probed lists hold fewer
+  // than k points, the remaining ids are -1 and the scores the lowest value.
+  void Search(const CoordinateType* query, int k, int num_probes,
+              Scratch* scratch, IdType* ids, CoordinateType* scores) const {
+    const ConstVectorMap query_vector(query, dimension());
+    num_probes = std::min(num_probes, num_lists());
+    auto& list_distances = scratch->list_distances;
+    list_distances.resize(num_lists());
+    const Vector distances =
+        centroid_norms_ - 2 * centroids_ * query_vector;
+    for (int_fast32_t list = 0; list < num_lists(); ++list) {
+      list_distances[list] = std::make_pair(distances(list), list);
+    }
+    std::partial_sort(list_distances.begin(),
+                      list_distances.begin() + num_probes,
+                      list_distances.end());
+
+    auto& heap = scratch->heap;
+    heap.Reset();
+    int num_results = 0;
+    for (int probe = 0; probe < num_probes; ++probe) {
+      const int_fast32_t list = list_distances[probe].second;
+      const int64_t begin = list_offsets_[list];
+      const int64_t size = list_offsets_[list + 1] - begin;
+      if (size == 0) {
+        continue;
+      }
+      scratch->scores.noalias() =
+          points_.middleRows(begin, size) * query_vector;
+      for (int64_t i = 0; i < size; ++i) {
+        const CoordinateType score = scratch->scores(i);
+        if (num_results < k) {
+          heap.Insert(score, ids_[begin + i]);
+          ++num_results;
+        } else if (score > heap.MinKey()) {
+          heap.ReplaceTop(score, ids_[begin + i]);
+        }
+      }
+    }
+
+    for (int i = k - 1; i >= num_results; --i) {
+      ids[i] = -1;
+      scores[i] = std::numeric_limits<CoordinateType>::lowest();
+    }
+    for (int i = num_results - 1; i >= 0; --i) {
+      heap.ExtractMin(&scores[i], &ids[i]);
+    }
+  }
+
+  // Serializes the index into a string of native-endian binary data, which
+  // Deserialize below reads back.
+  std::string Serialize() const {
+    const int64_t header[4] = {kMagic, dimension(), num_lists(),
+                               num_points()};
+    std::string result;
+    Append(header, 4, &result);
+    Append(centroids_.data(), centroids_.size(), &result);
+    Append(list_offsets_.data(), list_offsets_.size(), &result);
+    Append(points_.data(), points_.size(), &result);
+    Append(ids_.data(), ids_.size(), &result);
+    return result;
+  }
+
+  // Replaces the contents of the index with a serialized index. Returns
+  // false, leaving the index unchanged, if data is not a valid index.
+  bool Deserialize(const std::string& data) {
+    const char* pos = data.data();
+    const char* end = pos + data.size();
+    int64_t header[4];
+    if (!Read(&pos, end, 4, header) || header[0] != kMagic || header[1] < 0 ||
+        header[2] < 1 || header[3] < 0) {
+      return false;
+    }
+    const int64_t dimension = header[1];
+    const int64_t num_lists = header[2];
+    const int64_t num_points = header[3];
+    // Bound the header values before computing the expected size from them.
+    const int64_t data_size = data.size();
+    if (num_lists > data_size || num_points > data_size ||
+        (dimension > 0 && num_lists + num_points > data_size / dimension)) {
+      return false;
+    }
+    const int64_t expected_size =
+        sizeof(header) +
+        (num_lists + num_points) * dimension * sizeof(CoordinateType) +
+        (num_lists + 1) * sizeof(int64_t) + num_points * sizeof(IdType);
+    if (data_size != expected_size) {
+      return false;
+    }
+    Matrix centroids(num_lists, dimension);
+    std::vector<int64_t> list_offsets(num_lists + 1);
+    Matrix points(num_points, dimension);
+    std::vector<IdType> ids(num_points);
+    Read(&pos, end, centroids.size(), centroids.data());
+    Read(&pos, end, list_offsets.size(), list_offsets.data());
+    Read(&pos, end, points.size(), points.data());
+    Read(&pos, end, ids.size(), ids.data());
+    if (list_offsets.front() != 0 || list_offsets.back() != num_points ||
+        !std::is_sorted(list_offsets.begin(), list_offsets.end())) {
+      return false;
+    }
+    centroids_.swap(centroids);
+    centroid_norms_ = centroids_.rowwise().squaredNorm();
+    list_offsets_.swap(list_offsets);
+    points_.swap(points);
+    ids_.swap(ids);
+    return true;
+  }
+
+ private:
+  // Identifies the format and the value types of serialized indices.
+  static constexpr int64_t kMagic = 0x31465649 +
+                                    (sizeof(CoordinateType) << 32) +
+                                    (sizeof(IdType) << 40);
+
+  template <typename T>
+  static void Append(const T* values, int64_t count, std::string* output) {
+    output->append(reinterpret_cast<const char*>(values), count * sizeof(T));
+  }
+
+  template <typename T>
+  static bool Read(const char** pos, const char* end, int64_t count,
+                   T* values) {
+    const int64_t size = count * sizeof(T);
+    if (end - *pos < size) {
+      return false;
+    }
+    std::memcpy(values, *pos, size);
+    *pos += size;
+    return true;
+  }
+
+  Matrix centroids_;
+  Vector centroid_norms_;
+  // The points of list i are rows list_offsets_[i] to list_offsets_[i + 1] of
+  // points_, with ids at the same positions of ids_.
+  std::vector<int64_t> list_offsets_ = {0};
+  Matrix points_;
+  std::vector<IdType> ids_;
+};
+
+template <typename CoordinateType, typename IdType>
+constexpr int64_t IvfIndex<CoordinateType, IdType>::kMagic;
+
+}  // namespace nearest_neighbor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_NEAREST_NEIGHBOR_KERNELS_IVF_INDEX_H_
@@ -0,0 +1,253 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+
+#include "tensorflow/contrib/nearest_neighbor/kernels/ivf_index.h"
+
+namespace tensorflow {
+
+using errors::InvalidArgument;
+
+using nearest_neighbor::IvfIndex;
+
+// Holds an IvfIndex in the resource manager, so that it is built once and
+// then shared by all the searches.
+class IvfIndexResource : public ResourceBase {
+ public:
+  using Index = IvfIndex<float, int64>;
+
+  string DebugString() override {
+    tf_shared_lock l(mu_);
+    return strings::StrCat("IvfIndex with ", index_.num_points(),
+                           " points in ", index_.num_lists(), " lists");
+  }
+
+  mutex* get_mutex() { return &mu_; }
+  Index* index() { return &index_; }
+
+ private:
+  mutex mu_;
+  Index index_ GUARDED_BY(mu_);
+};
+
+namespace {
+
+Status LookupOrCreateIndex(OpKernelContext* context,
+                           IvfIndexResource** resource) {
+  return LookupOrCreateResource<IvfIndexResource>(
+      context, HandleFromInput(context, 0), resource,
+      [](IvfIndexResource** resource) {
+        *resource = new IvfIndexResource;
+        return Status::OK();
+      });
+}
+
+}  // namespace
+
+// Builds an index from centroids and points, replacing any previous contents.
+class IvfIndexBuildOp : public OpKernel {
+ public:
+  explicit IvfIndexBuildOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& centroids_tensor = context->input(1);
+    const Tensor& points_tensor = context->input(2);
+    const Tensor& ids_tensor = context->input(3);
+    OP_REQUIRES(context, centroids_tensor.dims() == 2,
+                InvalidArgument("Need a two-dimensional centroids tensor, got ",
+                                centroids_tensor.dims(), " dimensions."));
+    OP_REQUIRES(context, centroids_tensor.dim_size(0) >= 1,
+                InvalidArgument("Need at least one centroid."));
+    OP_REQUIRES(context, points_tensor.dims() == 2,
+                InvalidArgument("Need a two-dimensional points tensor, got ",
+                                points_tensor.dims(), " dimensions."));
+    OP_REQUIRES(context,
+                points_tensor.dim_size(1) == centroids_tensor.dim_size(1),
+                InvalidArgument("Points have dimension ",
+                                points_tensor.dim_size(1),
+                                " but centroids have dimension ",
+                                centroids_tensor.dim_size(1), "."));
+    OP_REQUIRES(context,
+                ids_tensor.dims() == 1 &&
+                    ids_tensor.dim_size(0) == points_tensor.dim_size(0),
+                InvalidArgument("Need one id per point, got ids of shape ",
+                                ids_tensor.shape().DebugString(), " for ",
+                                points_tensor.dim_size(0), " points."));
+
+    IvfIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupOrCreateIndex(context, &resource));
+    core::ScopedUnref unref_me(resource);
+    mutex_lock l(*resource->get_mutex());
+    IvfIndexResource::Index* index = resource->index();
+
+    const int64 num_points = points_tensor.dim_size(0);
+    const int64 dimension = points_tensor.dim_size(1);
+    const float* points = points_tensor.flat<float>().data();
+    index->SetCentroids(IvfIndexResource::Index::ConstMatrixMap(
+        centroids_tensor.flat<float>().data(), centroids_tensor.dim_size(0),
+        dimension));
+
+    // Assigning the points to lists dominates the build time.
+    std::vector<int_fast32_t> lists(num_points);
+    const int64 cost_per_unit = 2 * index->num_lists() * dimension;
+    context->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        num_points, cost_per_unit, [&](int64 start, int64 end) {
+          for (int64 i = start; i < end; ++i) {
+            lists[i] = index->NearestList(points + i * dimension);
+          }
+        });
+    index->SetPoints(
+        IvfIndexResource::Index::ConstMatrixMap(points, num_points, dimension),
+        ids_tensor.flat<int64>().data(), lists.data());
+  }
+};
+
+// Returns the serialized contents of an index.
+class IvfIndexSerializeOp : public OpKernel {
+ public:
+  explicit IvfIndexSerializeOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    IvfIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+    tf_shared_lock l(*resource->get_mutex());
+    Tensor* serialized_tensor = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, TensorShape(),
+                                                     &serialized_tensor));
+    serialized_tensor->scalar<string>()() = resource->index()->Serialize();
+  }
+};
+
+// Replaces the contents of an index with the output of IvfIndexSerialize.
+class IvfIndexDeserializeOp : public OpKernel {
+ public:
+  explicit IvfIndexDeserializeOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& serialized_tensor = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(serialized_tensor.shape()),
+                InvalidArgument("Serialized index must be a scalar."));
+
+    IvfIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupOrCreateIndex(context, &resource));
+    core::ScopedUnref unref_me(resource);
+    mutex_lock l(*resource->get_mutex());
+    OP_REQUIRES(context, resource->index()->Deserialize(
+                             serialized_tensor.scalar<string>()()),
+                InvalidArgument("Unable to parse serialized index."));
+  }
+};
+
+// Searches an index for a batch of queries.
+class IvfIndexSearchOp : public OpKernel {
+ public:
+  explicit IvfIndexSearchOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& queries_tensor = context->input(1);
+    OP_REQUIRES(context, queries_tensor.dims() == 2,
+                InvalidArgument("Need a two-dimensional queries tensor, got ",
+                                queries_tensor.dims(), " dimensions."));
+
+    const Tensor& k_tensor = context->input(2);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(k_tensor.shape()),
+                InvalidArgument("Need a scalar k tensor, got ",
+                                k_tensor.dims(), " dimensions."));
+    const int k = k_tensor.scalar<int32>()();
+    OP_REQUIRES(context, k >= 1,
+                InvalidArgument("k must be at least 1 but got ", k, "."));
+
+    const Tensor& num_probes_tensor = context->input(3);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(num_probes_tensor.shape()),
+                InvalidArgument("Need a scalar num_probes tensor, got ",
+                                num_probes_tensor.dims(), " dimensions."));
+    const int num_probes = num_probes_tensor.scalar<int32>()();
+    OP_REQUIRES(context, num_probes >= 1,
+                InvalidArgument("num_probes must be at least 1 but got ",
+                                num_probes, "."));
+
+    IvfIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+    tf_shared_lock l(*resource->get_mutex());
+    const IvfIndexResource::Index* index = resource->index();
+    OP_REQUIRES(context, index->num_lists() >= 1,
+                errors::FailedPrecondition("The index has not been built."));
+
+    const int64 batch_size = queries_tensor.dim_size(0);
+    const int64 dimension = queries_tensor.dim_size(1);
+    OP_REQUIRES(context, dimension == index->dimension(),
+                InvalidArgument("Queries have dimension ", dimension,
+                                " but the index has dimension ",
+                                index->dimension(), "."));
+
+    Tensor* ids_tensor = nullptr;
+    Tensor* scores_tensor = nullptr;
+    const TensorShape output_shape({batch_size, k});
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &ids_tensor));
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, output_shape, &scores_tensor));
+    const float* queries = queries_tensor.flat<float>().data();
+    int64* ids = ids_tensor->flat<int64>().data();
+    float* scores = scores_tensor->flat<float>().data();
+
+    // Estimate the points scanned per query from the average list size.
+    const int64 probed_points =
+        index->num_points() * std::min(num_probes, index->num_lists()) /
+        index->num_lists();
+    const int64 cost_per_unit =
+        2 * (index->num_lists() + probed_points) * dimension;
+    context->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        batch_size, cost_per_unit, [&](int64 start, int64 end) {
+          IvfIndexResource::Index::Scratch scratch;
+          for (int64 i = start; i < end; ++i) {
+            index->Search(queries + i * dimension, k, num_probes, &scratch,
+                          ids + i * k, scores + i * k);
+          }
+        });
+  }
+};
+
+REGISTER_RESOURCE_HANDLE_KERNEL(IvfIndexResource);
+
+REGISTER_KERNEL_BUILDER(Name("IvfIndexBuild").Device(DEVICE_CPU),
+                        IvfIndexBuildOp);
+
+REGISTER_KERNEL_BUILDER(Name("IvfIndexSerialize").Device(DEVICE_CPU),
+                        IvfIndexSerializeOp);
+
+REGISTER_KERNEL_BUILDER(Name("IvfIndexDeserialize").Device(DEVICE_CPU),
+                        IvfIndexDeserializeOp);
+
+REGISTER_KERNEL_BUILDER(Name("IvfIndexSearch").Device(DEVICE_CPU),
+                        IvfIndexSearchOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,122 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/nearest_neighbor/kernels/ivf_index.h"
+
+#include <vector>
+
+#include "tensorflow/core/kernels/ops_testutil.h"
+
+namespace {
+
+typedef tensorflow::nearest_neighbor::IvfIndex<float, int64_t> Index;
+
+// Builds an index over the given two-dimensional points, with id i for the
+// i-th point.
+void BuildIndex(const std::vector<float>& centroids,
+                const std::vector<float>& points, Index* index) {
+  const int num_points = points.size() / 2;
+  index->SetCentroids(Index::ConstMatrixMap(centroids.data(),
+                                            centroids.size() / 2, 2));
+  std::vector<int64_t> ids(num_points);
+  std::vector<int_fast32_t> lists(num_points);
+  for (int i = 0; i < num_points; ++i) {
+    ids[i] = i;
+    lists[i] = index->NearestList(&points[2 * i]);
+  }
+  index->SetPoints(Index::ConstMatrixMap(points.data(), num_points, 2),
+                   ids.data(), lists.data());
+}
+
+// Two lists, one around (10, 0) and one around (0, 10).
+const std::vector<float> kCentroids = {10.0, 0.0, 0.0, 10.0};
+const std::vector<float> kPoints = {9.0, 1.0, 13.0, 0.0, 10.0, -2.0,
+                                    1.0, 9.0, 0.0, 12.0};
+
+TEST(IvfIndexTest, ExactSearch) {
+  Index index;
+  BuildIndex(kCentroids, kPoints, &index);
+  EXPECT_EQ(2, index.dimension());
+  EXPECT_EQ(2, index.num_lists());
+  EXPECT_EQ(5, index.num_points());
+
+  const std::vector<float> query = {1.0, 0.5};
+  Index::Scratch scratch;
+  std::vector<int64_t> ids(3);
+  std::vector<float> scores(3);
+  index.Search(query.data(), 3, 2, &scratch, ids.data(), scores.data());
+  EXPECT_EQ(std::vector<int64_t>({1, 0, 2}), ids);
+  EXPECT_EQ(std::vector<float>({13.0, 9.5, 9.0}), scores);
+}
+
+TEST(IvfIndexTest, SearchOnlyProbesNearestLists) {
+  Index index;
+  BuildIndex(kCentroids, kPoints, &index);
+
+  // The query is nearest to the centroid (0, 10), so with a single probe the
+  // better point (13, 0) in the other list is not found.
+  const std::vector<float> query = {1.0, 1.25};
+  Index::Scratch scratch;
+  std::vector<int64_t> ids(2);
+  std::vector<float> scores(2);
+  index.Search(query.data(), 2, 1, &scratch, ids.data(), scores.data());
+  EXPECT_EQ(std::vector<int64_t>({4, 3}), ids);
+  EXPECT_EQ(std::vector<float>({15.0, 12.25}), scores);
+
+  index.Search(query.data(), 2, 2, &scratch, ids.data(), scores.data());
+  EXPECT_EQ(std::vector<int64_t>({4, 1}), ids);
+  EXPECT_EQ(std::vector<float>({15.0, 13.0}), scores);
+}
+
+TEST(IvfIndexTest, FewerPointsThanRequested) {
+  Index index;
+  BuildIndex(kCentroids, kPoints, &index);
+
+  const std::vector<float> query = {0.0, 1.0};
+  Index::Scratch scratch;
+  std::vector<int64_t> ids(3);
+  std::vector<float> scores(3);
+  index.Search(query.data(), 3, 1, &scratch, ids.data(), scores.data());
+  EXPECT_EQ(std::vector<int64_t>({4, 3, -1}), ids);
+  EXPECT_EQ(12.0, scores[0]);
+  EXPECT_EQ(9.0, scores[1]);
+  EXPECT_EQ(std::numeric_limits<float>::lowest(), scores[2]);
+}
+
+TEST(IvfIndexTest, SerializeAndDeserialize) {
+  Index index;
+  BuildIndex(kCentroids, kPoints, &index);
+  const std::string serialized = index.Serialize();
+
+  Index restored;
+  ASSERT_TRUE(restored.Deserialize(serialized));
+  EXPECT_EQ(serialized, restored.Serialize());
+
+  const std::vector<float> query = {1.0, 0.5};
+  Index::Scratch scratch;
+  std::vector<int64_t> ids(3);
+  std::vector<float> scores(3);
+  restored.Search(query.data(), 3, 2, &scratch, ids.data(), scores.data());
+  EXPECT_EQ(std::vector<int64_t>({1, 0, 2}), ids);
+
+  EXPECT_FALSE(restored.Deserialize(""));
+  EXPECT_FALSE(restored.Deserialize(serialized.substr(1)));
+  std::string corrupted = serialized;
+  corrupted[0] ^= 1;
+  EXPECT_FALSE(restored.Deserialize(corrupted));
+  EXPECT_EQ(serialized, restored.Serialize());
+}
+
+}  // namespace
@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/shape_inference.h"
 
 namespace tensorflow {
 
@@ -46,4 +49,102 @@ probes: the output matrix of probes. Size `batch_size` times `num_probes`.
 table_ids: the output matrix of tables ids. Size `batch_size` times `num_probes`.
 )doc");
 
+using shape_inference::DimensionHandle;
+using shape_inference::InferenceContext;
+using shape_inference::ShapeHandle;
+
+REGISTER_RESOURCE_HANDLE_OP(IvfIndexResource);
+
+REGISTER_OP("IvfIndexBuild")
+    .Input("index_handle: resource")
+    .Input("centroids: float")
+    .Input("points: float")
+    .Input("ids: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle centroids, points, ids, unused_handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused_handle));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &centroids));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 2, &points));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &ids));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(centroids, 1), c->Dim(points, 1), &unused));
+      return c->Merge(c->Dim(points, 0), c->Dim(ids, 0), &unused);
+    })
+    .Doc(R"doc(
+Builds an inverted file index for maximum inner product search.
+
+Each point is stored in the list of its nearest centroid in Euclidean distance.
+The centroids would typically be computed by k-means on a sample of the points.
+Any previous contents of the index are replaced.
+
+index_handle: the handle to the index.
+centroids: the list centroids, a `num_lists` times `dimension` matrix.
+points: the points to index, a `num_points` times `dimension` matrix.
+ids: the ids that searches return for the points, of size `num_points`.
+)doc");
+
+REGISTER_OP("IvfIndexSerialize")
+    .Input("index_handle: resource")
+    .Output("serialized: string")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Serializes an index, e.g. to write it to a SavedModel asset.
+
+index_handle: the handle to the index.
+serialized: the serialized index.
+)doc");
+
+REGISTER_OP("IvfIndexDeserialize")
+    .Input("index_handle: resource")
+    .Input("serialized: string")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      return c->WithRank(c->input(1), 0, &unused);
+    })
+    .Doc(R"doc(
+Restores an index from the output of IvfIndexSerialize.
+
+index_handle: the handle to the index.
+serialized: the serialized index.
+)doc");
+
+REGISTER_OP("IvfIndexSearch")
+    .Input("index_handle: resource")
+    .Input("queries: float")
+    .Input("k: int32")
+    .Input("num_probes: int32")
+    .Output("ids: int64")
+    .Output("scores: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle queries, unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &queries));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      DimensionHandle k;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(2, &k));
+      ShapeHandle output = c->Matrix(c->Dim(queries, 0), k);
+      c->set_output(0, output);
+      c->set_output(1, output);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Finds the points with the largest inner products with a batch of queries.
+
+Only the points in the `num_probes` lists whose centroids are nearest to a
+query are scored, so the search is exact when `num_probes` is at least the
+number of lists and approximate otherwise. If the probed lists hold fewer than
+`k` points, the remaining ids are -1 and the remaining scores the lowest float.
+
+index_handle: the handle to the index.
+queries: the queries, a `batch_size` times `dimension` matrix.
+k: the number of points to return per query.
+num_probes: the number of lists to scan per query.
+ids: the ids of the best points, best first. Size `batch_size` times `k`.
+scores: the inner products of the queries with the best points. Size
+  `batch_size` times `k`.
+)doc");
+
 }  // namespace tensorflow
@@ -0,0 +1,81 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+"""Tests for the inverted file index ops."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import numpy as np
+
+from tensorflow.contrib.nearest_neighbor.python.ops import nearest_neighbor_ops
+from tensorflow.python.framework import errors
+from tensorflow.python.platform import test
+
+
+class IvfIndexTest(test.TestCase):
+
+  # The search itself is covered by ivf_index_test.cc, so this checks that the
+  # ops agree with a brute-force search and that serialization round-trips.
+  def testExactSearchMatchesBruteForce(self):
+    with self.test_session():
+      rng = np.random.RandomState(0)
+      centroids = rng.randn(4, 8).astype(np.float32)
+      points = rng.randn(100, 8).astype(np.float32)
+      ids = np.arange(100, 200, dtype=np.int64)
+      queries = rng.randn(5, 8).astype(np.float32)
+
+      index = nearest_neighbor_ops.ivf_index(shared_name="index")
+      nearest_neighbor_ops.ivf_index_build(index, centroids, points,
+                                           ids).run()
+      result_ids, scores = nearest_neighbor_ops.ivf_index_search(
+          index, queries, k=3, num_probes=4)
+
+      products = np.dot(queries, points.T)
+      expected = np.argsort(-products, axis=1)[:, :3]
+      self.assertAllEqual(ids[expected], result_ids.eval())
+      self.assertAllClose(np.sort(products, axis=1)[:, ::-1][:, :3],
+                          scores.eval())
+
+  def testSerializeAndDeserialize(self):
+    with self.test_session():
+      centroids = np.array([[10.0, 0.0], [0.0, 10.0]], dtype=np.float32)
+      points = np.array([[9.0, 1.0], [1.0, 9.0]], dtype=np.float32)
+      index = nearest_neighbor_ops.ivf_index(shared_name="original")
+      nearest_neighbor_ops.ivf_index_build(index, centroids, points,
+                                           [7, 8]).run()
+      serialized = nearest_neighbor_ops.ivf_index_serialize(index).eval()
+
+      restored = nearest_neighbor_ops.ivf_index(shared_name="restored")
+      nearest_neighbor_ops.ivf_index_deserialize(restored, serialized).run()
+      result_ids, _ = nearest_neighbor_ops.ivf_index_search(
+          restored, [[0.0, 1.0]], k=2, num_probes=1)
+      self.assertAllEqual([[8, -1]], result_ids.eval())
+
+      with self.assertRaisesOpError("Unable to parse serialized index"):
+        nearest_neighbor_ops.ivf_index_deserialize(restored, "garbage").run()
+
+  def testSearchBeforeBuild(self):
+    with self.test_session():
+      index = nearest_neighbor_ops.ivf_index(shared_name="unbuilt")
+      result_ids, _ = nearest_neighbor_ops.ivf_index_search(
+          index, [[0.0, 1.0]], k=1, num_probes=1)
+      with self.assertRaises(errors.NotFoundError):
+        result_ids.eval()
+
+
+if __name__ == "__main__":
+  test.main()
@@ -62,3 +62,98 @@ def hyperplane_lsh_probes(point_hyperplane_product,
                                                      name=name)
 
 ops.NotDifferentiable("HyperplaneLSHProbes")
+
+
+def ivf_index(container="", shared_name="", name=None):
+  """Creates a handle to an inverted file index.
+
+  Args:
+    container: the resource container of the index (optional).
+    shared_name: the name under which the index is shared (optional).
+    name: A name prefix for the returned tensor (optional).
+
+  Returns:
+    A resource handle to the index, to be filled by `ivf_index_build` or
+    `ivf_index_deserialize`.
+  """
+  return _nearest_neighbor_ops.ivf_index_resource_handle_op(
+      container=container, shared_name=shared_name, name=name)
+
+
+def ivf_index_build(index_handle, centroids, points, ids, name=None):
+  """Builds an inverted file index for maximum inner product search.
+
+  Each point is stored in the list of its nearest centroid in Euclidean
+  distance. The centroids would typically be computed by k-means on a sample of
+  the points. Any previous contents of the index are replaced.
+
+  Args:
+    index_handle: the handle to the index.
+    centroids: the list centroids, a `num_lists` times `dimension` matrix.
+    points: the points to index, a `num_points` times `dimension` matrix.
+    ids: the ids that searches return for the points, of size `num_points`.
+    name: A name prefix for the returned operation (optional).
+
+  Returns:
+    The created operation.
+  """
+  return _nearest_neighbor_ops.ivf_index_build(index_handle, centroids, points,
+                                               ids, name=name)
+
+
+def ivf_index_serialize(index_handle, name=None):
+  """Serializes an index.
+
+  Writing the result to a file with `tf.write_file` stores the index as a
+  SavedModel asset, which `ivf_index_deserialize` restores at serving time.
+
+  Args:
+    index_handle: the handle to the index.
+    name: A name prefix for the returned tensor (optional).
+
+  Returns:
+    The serialized index, a string scalar.
+  """
+  return _nearest_neighbor_ops.ivf_index_serialize(index_handle, name=name)
+
+
+def ivf_index_deserialize(index_handle, serialized, name=None):
+  """Restores an index from the output of `ivf_index_serialize`.
+
+  Args:
+    index_handle: the handle to the index.
+    serialized: the serialized index, a string scalar.
+    name: A name prefix for the returned operation (optional).
+
+  Returns:
+    The created operation.
+  """
+  return _nearest_neighbor_ops.ivf_index_deserialize(index_handle, serialized,
+                                                     name=name)
+
+
+def ivf_index_search(index_handle, queries, k, num_probes, name=None):
+  """Finds the points with the largest inner products with a batch of queries.
+
+  Only the points in the `num_probes` lists whose centroids are nearest to a
+  query are scored, so the search is exact when `num_probes` is at least the
+  number of lists and approximate otherwise. If the probed lists hold fewer
+  than `k` points, the remaining ids are -1 and the remaining scores the lowest
+  float.
+
+  Args:
+    index_handle: the handle to the index.
+    queries: the queries, a `batch_size` times `dimension` matrix.
+    k: the number of points to return per query.
+    num_probes: the number of lists to scan per query.
+    name: A name prefix for the returned tensors (optional).
+
+  Returns:
+    ids: the ids of the best points, best first. Size `batch_size` times `k`.
+    scores: the inner products of the queries with the best points. Size
+      `batch_size` times `k`.
+  """
+  return _nearest_neighbor_ops.ivf_index_search(index_handle, queries, k,
+                                                num_probes, name=name)
+
+ops.NotDifferentiable("IvfIndexSearch")
@@ -0,0 +1,216 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_rendezvous_mgr.h"
+
+#include "tensorflow/contrib/shm/shm.pb.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/request_id.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/worker_cache.h"
+#include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace {
+
+class ShmRecvTensorCall : public BaseRecvTensorCall {
+ public:
+  ShmRecvTensorCall(WorkerInterface* wi, Device* dst_device,
+                    SharedMemoryReader* reader, const string& host_id,
+                    const Rendezvous::Args& recv_args, int64 step_id,
+                    StringPiece key)
+      : wi_(wi),
+        dst_device_(dst_device),
+        reader_(reader),
+        recv_args_(recv_args) {
+    req_.set_step_id(step_id);
+    req_.set_rendezvous_key(key.data(), key.size());
+    req_.set_request_id(GetUniqueRequestId());
+    // Shared memory is only used for tensors received into host memory.
+    // Tensors for GPUs take the usual path, which copies them to the
+    // device as they are parsed.
+    const bool on_host =
+        (dst_device_->tensorflow_gpu_device_info() == nullptr) ||
+        recv_args_.alloc_attrs.on_host();
+    if (on_host) {
+      SharedMemoryClientInfo client_info;
+      client_info.set_host_id(host_id);
+      req_.set_dma_ok(true);
+      req_.mutable_transport_options()->PackFrom(client_info);
+    }
+  }
+
+  ~ShmRecvTensorCall() override {}
+
+  void Start(std::function<void()> recv_done) override {
+    resp_.InitAlloc(dst_device_, recv_args_.alloc_attrs);
+    StatusCallback cb = [this, recv_done](const Status& s) {
+      Status status = s;
+      if (status.ok() && resp_.metadata().has_transport_options()) {
+        status = ReadFromSharedMemory();
+      }
+      if (!status.ok()) {
+        mutex_lock l(mu_);
+        status_.Update(status);
+      }
+      recv_done();
+    };
+    wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  const Tensor& tensor() const { return resp_.tensor(); }
+
+  bool is_dead() const { return resp_.metadata().is_dead(); }
+
+  const Rendezvous::Args& recv_args() const { return recv_args_; }
+
+ private:
+  // Fills the tensor allocated from the response metadata with the content
+  // that the source worker wrote to shared memory.
+  Status ReadFromSharedMemory() {
+    SharedMemoryRegion region;
+    if (!resp_.metadata().transport_options().UnpackTo(&region)) {
+      return errors::Internal("Unexpected transport options in RecvTensor ",
+                              "response for ", req_.rendezvous_key());
+    }
+    const Tensor& t = tensor();
+    if (!DataTypeCanUseMemcpy(t.dtype()) || region.size() != t.TotalBytes()) {
+      return errors::Internal("Shared memory region of ", region.size(),
+                              " bytes does not match tensor ",
+                              t.DebugString(), " for ", req_.rendezvous_key());
+    }
+    return reader_->Read(
+        region, static_cast<char*>(DMAHelper::base(const_cast<Tensor*>(&t))));
+  }
+
+  WorkerInterface* wi_;
+  Device* dst_device_;
+  SharedMemoryReader* reader_;
+  CallOptions opts_;
+  RecvTensorRequest req_;
+  TensorResponse resp_;
+  Rendezvous::Args recv_args_;
+
+  mutable mutex mu_;
+  Status status_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmRecvTensorCall);
+};
+
+class ShmRemoteRendezvous : public BaseRemoteRendezvous {
+ public:
+  ShmRemoteRendezvous(const WorkerEnv* env, int64 step_id,
+                      SharedMemoryReader* reader, const string& host_id)
+      : BaseRemoteRendezvous(env, step_id),
+        reader_(reader),
+        host_id_(host_id) {}
+
+ protected:
+  void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                           const Rendezvous::Args& recv_args,
+                           DoneCallback done) override {
+    CHECK(is_initialized());
+
+    string src_worker;
+    string src_rel_device;
+    if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                          &src_rel_device)) {
+      Status s = errors::Internal(parsed.src_device,
+                                  " is invalid remote source device.");
+      done(s, Args(), recv_args, Tensor{}, false);
+      return;
+    }
+
+    WorkerSession* sess = session();
+    WorkerInterface* rwi = sess->worker_cache->CreateWorker(src_worker);
+    if (rwi == nullptr) {
+      Status s = errors::Internal("No worker known as ", src_worker);
+      done(s, Args(), recv_args, Tensor{}, false);
+      return;
+    }
+
+    Device* dst_device;
+    Status s = sess->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
+    if (!s.ok()) {
+      sess->worker_cache->ReleaseWorker(src_worker, rwi);
+      done(s, Args(), recv_args, Tensor{}, false);
+      return;
+    }
+
+    // Prepare a RecvTensor call that can handle being aborted.
+    ShmRecvTensorCall* call =
+        new ShmRecvTensorCall(rwi, dst_device, reader_, host_id_, recv_args,
+                              step_id_, parsed.FullKey());
+
+    // Record "call" in active_ so that it can be aborted cleanly.
+    RegisterCall(call);
+
+    // Start "call".
+    Ref();
+    call->Start([this, call, src_worker, rwi, done]() {
+      // Removes "call" from active_. Prevent StartAbort().
+      DeregisterCall(call);
+      // If StartAbort was called prior to DeregisterCall, then the
+      // current status should be bad.
+      Status s = call->status();
+      done(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
+      session()->worker_cache->ReleaseWorker(src_worker, rwi);
+      delete call;
+      Unref();
+    });
+  }
+
+ private:
+  ~ShmRemoteRendezvous() override {}
+
+  SharedMemoryReader* reader_;
+  const string host_id_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmRemoteRendezvous);
+};
+
+}  // namespace
+
+ShmRendezvousMgr::ShmRendezvousMgr(const WorkerEnv* env,
+                                   SharedMemoryReader* reader)
+    : BaseRendezvousMgr(env), reader_(reader), host_id_(SharedMemoryHostId()) {}
+
+BaseRemoteRendezvous* ShmRendezvousMgr::Create(int64 step_id,
+                                               const WorkerEnv* worker_env) {
+  return new ShmRemoteRendezvous(worker_env, step_id, reader_, host_id_);
+}
+
+}  // end namespace tensorflow
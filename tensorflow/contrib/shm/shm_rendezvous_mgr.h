@@ -0,0 +1,47 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_SHM_SHM_RENDEZVOUS_MGR_H_
+#define TENSORFLOW_CONTRIB_SHM_SHM_RENDEZVOUS_MGR_H_
+
+#include "tensorflow/contrib/shm/shm_ring.h"
+#include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+
+// A rendezvous manager whose remote recvs into host memory ask the source
+// worker for the tensor content through shared memory (see ShmWorker). The
+// source worker decides which tensors to send that way; the others arrive
+// in the RecvTensor response as usual.
+class ShmRendezvousMgr : public BaseRendezvousMgr {
+ public:
+  ShmRendezvousMgr(const WorkerEnv* env, SharedMemoryReader* reader);
+
+ protected:
+  BaseRemoteRendezvous* Create(int64 step_id,
+                               const WorkerEnv* worker_env) override;
+
+ private:
+  SharedMemoryReader* reader_;  // Not owned
+  const string host_id_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmRendezvousMgr);
+};
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_SHM_SHM_RENDEZVOUS_MGR_H_
@@ -0,0 +1,271 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Header of a record, followed by the record content. Both live in the
+// segment, and are accessed by the writer and by a reader in another
+// process, so the atomics must be lock-free.
+struct RecordHeader {
+  std::atomic<uint64> sequence;  // 0 when the record is reclaimed.
+  std::atomic<uint32> consumed;
+};
+
+// Size of the header, and alignment of the records (and so of the tensor
+// content that follows each header).
+constexpr int64 kRecordAlignment = 64;
+static_assert(sizeof(RecordHeader) <= kRecordAlignment,
+              "RecordHeader does not fit in kRecordAlignment");
+
+int64 RoundUp(int64 bytes) {
+  return (bytes + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+}
+
+RecordHeader* HeaderAt(char* base, int64 offset) {
+  return reinterpret_cast<RecordHeader*>(base + offset);
+}
+
+Status ErrnoError(const string& context) {
+  return errors::Unavailable(context, " failed: ", strerror(errno));
+}
+
+}  // namespace
+
+string SharedMemoryHostId() {
+  static const string* host_id = []() {
+    string boot_id;
+    Status s = ReadFileToString(Env::Default(),
+                                "/proc/sys/kernel/random/boot_id", &boot_id);
+    if (!s.ok()) {
+      VLOG(1) << "No boot id: " << s;
+    }
+    char ipc_namespace[64] = {0};
+    if (readlink("/proc/self/ns/ipc", ipc_namespace,
+                 sizeof(ipc_namespace) - 1) < 0) {
+      VLOG(1) << "No IPC namespace: " << strerror(errno);
+    }
+    str_util::StripTrailingWhitespace(&boot_id);
+    return new string(
+        strings::StrCat(port::Hostname(), "/", boot_id, "/", ipc_namespace));
+  }();
+  return *host_id;
+}
+
+/* static */
+Status SharedMemoryRing::Create(int64 capacity_bytes, int64 timeout_micros,
+                                std::unique_ptr<SharedMemoryRing>* ring) {
+  capacity_bytes = RoundUp(capacity_bytes);
+  if (capacity_bytes <= 0) {
+    return errors::InvalidArgument("Invalid shared memory ring capacity: ",
+                                   capacity_bytes);
+  }
+  const string name = strings::StrCat("/tf_shm_", getpid(), "_",
+                                      strings::Hex(random::New64()));
+  // Only processes of the same user can open the segment.
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return ErrnoError(strings::StrCat("shm_open(", name, ")"));
+  }
+  Status s;
+  void* base = MAP_FAILED;
+  if (ftruncate(fd, capacity_bytes) != 0) {
+    s = ErrnoError(strings::StrCat("ftruncate(", name, ")"));
+  } else {
+    base = mmap(nullptr, capacity_bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                fd, 0);
+    if (base == MAP_FAILED) {
+      s = ErrnoError(strings::StrCat("mmap(", name, ")"));
+    }
+  }
+  if (!s.ok()) {
+    close(fd);
+    shm_unlink(name.c_str());
+    return s;
+  }
+  ring->reset(new SharedMemoryRing(name, fd, static_cast<char*>(base),
+                                   capacity_bytes, timeout_micros));
+  return Status::OK();
+}
+
+SharedMemoryRing::SharedMemoryRing(string segment_name, int fd, char* base,
+                                   int64 capacity_bytes, int64 timeout_micros)
+    : segment_name_(std::move(segment_name)),
+      fd_(fd),
+      base_(base),
+      capacity_bytes_(capacity_bytes),
+      timeout_micros_(timeout_micros) {}
+
+SharedMemoryRing::~SharedMemoryRing() {
+  munmap(base_, capacity_bytes_);
+  close(fd_);
+  shm_unlink(segment_name_.c_str());
+}
+
+bool SharedMemoryRing::Write(StringPiece data, SharedMemoryRegion* region) {
+  const int64 total_bytes = kRecordAlignment + RoundUp(data.size());
+  const int64 now_micros = Env::Default()->NowMicros();
+  int64 offset;
+  uint64 sequence;
+  {
+    mutex_lock l(mu_);
+    ReclaimLocked(now_micros);
+    offset = AllocateLocked(total_bytes);
+    if (offset < 0) return false;
+    sequence = next_sequence_++;
+    records_.push_back({offset, total_bytes, now_micros});
+    RecordHeader* header = HeaderAt(base_, offset);
+    header->consumed.store(0, std::memory_order_relaxed);
+    header->sequence.store(sequence, std::memory_order_relaxed);
+  }
+  // The reader only learns about the record from the response that is sent
+  // after this copy.
+  memcpy(base_ + offset + kRecordAlignment, data.data(), data.size());
+  region->set_segment_name(segment_name_);
+  region->set_offset(offset);
+  region->set_size(data.size());
+  region->set_sequence(sequence);
+  return true;
+}
+
+void SharedMemoryRing::ReclaimLocked(int64 now_micros) {
+  while (!records_.empty()) {
+    const Record& record = records_.front();
+    RecordHeader* header = HeaderAt(base_, record.offset);
+    if (header->consumed.load(std::memory_order_acquire) == 0 &&
+        now_micros - record.write_micros < timeout_micros_) {
+      break;
+    }
+    // Lets a late reader of an expired record notice that it was reused.
+    header->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    records_.pop_front();
+  }
+  if (records_.empty()) {
+    head_ = 0;
+  }
+}
+
+int64 SharedMemoryRing::AllocateLocked(int64 total_bytes) {
+  if (total_bytes > capacity_bytes_) return -1;
+  int64 offset = -1;
+  if (records_.empty()) {
+    offset = 0;
+  } else {
+    // The records in use are [tail, head_) if head_ > tail, and
+    // [tail, capacity_bytes_) + [0, head_) otherwise; head_ == tail means
+    // that the ring is full.
+    const int64 tail = records_.front().offset;
+    if (head_ > tail) {
+      if (head_ + total_bytes <= capacity_bytes_) {
+        offset = head_;
+      } else if (total_bytes <= tail) {
+        offset = 0;
+      }
+    } else if (head_ + total_bytes <= tail) {
+      offset = head_;
+    }
+  }
+  if (offset >= 0) {
+    head_ = offset + total_bytes;
+  }
+  return offset;
+}
+
+SharedMemoryReader::~SharedMemoryReader() {
+  for (const auto& it : mappings_) {
+    munmap(it.second.base, it.second.size);
+  }
+}
+
+Status SharedMemoryReader::GetMapping(const string& segment_name,
+                                      Mapping* mapping) {
+  mutex_lock l(mu_);
+  auto it = mappings_.find(segment_name);
+  if (it != mappings_.end()) {
+    *mapping = it->second;
+    return Status::OK();
+  }
+  const int fd = shm_open(segment_name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return ErrnoError(strings::StrCat("shm_open(", segment_name, ")"));
+  }
+  Status s;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    s = ErrnoError(strings::StrCat("fstat(", segment_name, ")"));
+  } else {
+    void* base =
+        mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      s = ErrnoError(strings::StrCat("mmap(", segment_name, ")"));
+    } else {
+      mapping->base = static_cast<char*>(base);
+      mapping->size = st.st_size;
+      mappings_[segment_name] = *mapping;
+    }
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  return s;
+}
+
+Status SharedMemoryReader::Read(const SharedMemoryRegion& region, char* dst) {
+  Mapping mapping;
+  TF_RETURN_IF_ERROR(GetMapping(region.segment_name(), &mapping));
+  const uint64 segment_size = mapping.size;
+  if (region.offset() % kRecordAlignment != 0 ||
+      region.offset() + kRecordAlignment > segment_size ||
+      region.size() > segment_size - region.offset() - kRecordAlignment) {
+    return errors::InvalidArgument("Shared memory region ",
+                                   region.ShortDebugString(),
+                                   " is out of the bounds of its segment");
+  }
+  RecordHeader* header = HeaderAt(mapping.base, region.offset());
+  if (header->sequence.load(std::memory_order_relaxed) == region.sequence()) {
+    memcpy(dst, mapping.base + region.offset() + kRecordAlignment,
+           region.size());
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->sequence.load(std::memory_order_relaxed) ==
+        region.sequence()) {
+      header->consumed.store(1, std::memory_order_release);
+      return Status::OK();
+    }
+  }
+  return errors::Unavailable("Shared memory region ",
+                             region.ShortDebugString(),
+                             " was reclaimed before it was read");
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,123 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_SHM_SHM_RING_H_
+#define TENSORFLOW_CONTRIB_SHM_SHM_RING_H_
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/contrib/shm/shm.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Returns a string that is equal for two processes if and only if they can
+// share POSIX shared memory segments by name: it combines the host name,
+// the boot id and the IPC namespace of the process.
+string SharedMemoryHostId();
+
+// A ring of records in a POSIX shared memory segment, written by the
+// process that owns it and read by other processes on the same host.
+//
+// Each record starts with a header, in the segment, holding its sequence
+// number and a "consumed" flag set by the reader once it has copied the
+// record. The writer reclaims records in the order in which they were
+// written, once they are consumed or older than the timeout (so that records
+// whose reader went away do not fill the ring forever). The reader checks
+// the sequence number again after copying, to detect a record reclaimed
+// while it was being read.
+class SharedMemoryRing {
+ public:
+  // Creates a ring of "capacity_bytes" in a new shared memory segment, which
+  // is unlinked by the destructor.
+  static Status Create(int64 capacity_bytes, int64 timeout_micros,
+                       std::unique_ptr<SharedMemoryRing>* ring);
+
+  ~SharedMemoryRing();
+
+  // Copies "data" into a new record, and describes it in "*region". Returns
+  // false, leaving "*region" unspecified, if the ring has no room for it.
+  // Thread-safe.
+  bool Write(StringPiece data, SharedMemoryRegion* region);
+
+  const string& segment_name() const { return segment_name_; }
+
+ private:
+  struct Record {
+    int64 offset;
+    int64 total_bytes;
+    int64 write_micros;
+  };
+
+  SharedMemoryRing(string segment_name, int fd, char* base,
+                   int64 capacity_bytes, int64 timeout_micros);
+
+  // Drops the oldest records that are consumed or expired.
+  void ReclaimLocked(int64 now_micros) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the offset of a new record of "total_bytes", or -1 if there is
+  // no room for it.
+  int64 AllocateLocked(int64 total_bytes) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const string segment_name_;
+  const int fd_;
+  char* const base_;
+  const int64 capacity_bytes_;
+  const int64 timeout_micros_;
+
+  mutex mu_;
+  std::deque<Record> records_ GUARDED_BY(mu_);  // Oldest first.
+  int64 head_ GUARDED_BY(mu_) = 0;  // Where the next record goes.
+  uint64 next_sequence_ GUARDED_BY(mu_) = 1;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryRing);
+};
+
+// Reads records from the SharedMemoryRings of other processes, mapping
+// their segments on first use.
+class SharedMemoryReader {
+ public:
+  SharedMemoryReader() {}
+  ~SharedMemoryReader();
+
+  // Copies the content of the record described by "region" to "dst", which
+  // must hold region.size() bytes, and marks the record as consumed.
+  // Thread-safe.
+  Status Read(const SharedMemoryRegion& region, char* dst);
+
+ private:
+  struct Mapping {
+    char* base;
+    int64 size;
+  };
+
+  Status GetMapping(const string& segment_name, Mapping* mapping);
+
+  mutex mu_;
+  std::unordered_map<string, Mapping> mappings_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryReader);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_SHM_SHM_RING_H_
@@ -0,0 +1,131 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_ring.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+string Content(int size, char c) { return string(size, c); }
+
+string ReadRegion(SharedMemoryReader* reader,
+                  const SharedMemoryRegion& region) {
+  string result(region.size(), '\0');
+  TF_EXPECT_OK(reader->Read(region, &result[0]));
+  return result;
+}
+
+TEST(SharedMemoryRingTest, WriteAndRead) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  TF_ASSERT_OK(SharedMemoryRing::Create(1 << 20, 60 * 1000000, &ring));
+  SharedMemoryReader reader;
+  SharedMemoryRegion a, b;
+  ASSERT_TRUE(ring->Write(Content(1000, 'a'), &a));
+  ASSERT_TRUE(ring->Write(Content(10, 'b'), &b));
+  EXPECT_EQ(ring->segment_name(), a.segment_name());
+  EXPECT_NE(a.sequence(), b.sequence());
+  EXPECT_EQ(0, a.offset() % 64);
+  EXPECT_EQ(0, b.offset() % 64);
+  EXPECT_EQ(Content(10, 'b'), ReadRegion(&reader, b));
+  EXPECT_EQ(Content(1000, 'a'), ReadRegion(&reader, a));
+}
+
+TEST(SharedMemoryRingTest, ReclaimsConsumedRecords) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  TF_ASSERT_OK(SharedMemoryRing::Create(4096, 60 * 1000000, &ring));
+  SharedMemoryReader reader;
+  SharedMemoryRegion region;
+  // Far more than the capacity in total, but each record is read before
+  // the next one is written.
+  for (int i = 0; i < 100; ++i) {
+    const string content = Content(1000 + i, 'a' + i % 26);
+    ASSERT_TRUE(ring->Write(content, &region));
+    EXPECT_EQ(content, ReadRegion(&reader, region));
+  }
+}
+
+TEST(SharedMemoryRingTest, FullRingAndWrapAround) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  TF_ASSERT_OK(SharedMemoryRing::Create(4096, 60 * 1000000, &ring));
+  SharedMemoryReader reader;
+  std::vector<SharedMemoryRegion> regions(4);
+  // Records of 64 + 960 bytes: four fill the ring.
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(ring->Write(Content(960, '0' + i), &regions[i]));
+  }
+  SharedMemoryRegion region;
+  EXPECT_FALSE(ring->Write(Content(1, 'x'), &region));
+  EXPECT_FALSE(ring->Write(Content(10000, 'x'), &region));
+
+  // Consuming the oldest record makes room at the start of the ring.
+  EXPECT_EQ(Content(960, '0'), ReadRegion(&reader, regions[0]));
+  ASSERT_TRUE(ring->Write(Content(960, 'x'), &region));
+  EXPECT_EQ(0, region.offset());
+  EXPECT_FALSE(ring->Write(Content(1, 'y'), &region));
+
+  // Consuming a record that is not the oldest does not.
+  EXPECT_EQ(Content(960, '2'), ReadRegion(&reader, regions[2]));
+  EXPECT_FALSE(ring->Write(Content(1, 'y'), &region));
+  EXPECT_EQ(Content(960, '1'), ReadRegion(&reader, regions[1]));
+  EXPECT_TRUE(ring->Write(Content(1, 'y'), &region));
+}
+
+TEST(SharedMemoryRingTest, ExpiredRecordsAreReclaimed) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  TF_ASSERT_OK(SharedMemoryRing::Create(4096, 100 * 1000, &ring));
+  SharedMemoryReader reader;
+  SharedMemoryRegion stale, region;
+  ASSERT_TRUE(ring->Write(Content(4000, 'a'), &stale));
+  EXPECT_FALSE(ring->Write(Content(1000, 'b'), &region));
+  Env::Default()->SleepForMicroseconds(200 * 1000);
+  ASSERT_TRUE(ring->Write(Content(1000, 'b'), &region));
+
+  string dst(stale.size(), '\0');
+  EXPECT_TRUE(errors::IsUnavailable(reader.Read(stale, &dst[0])));
+  EXPECT_EQ(Content(1000, 'b'), ReadRegion(&reader, region));
+}
+
+TEST(SharedMemoryRingTest, InvalidRegions) {
+  std::unique_ptr<SharedMemoryRing> ring;
+  TF_ASSERT_OK(SharedMemoryRing::Create(4096, 60 * 1000000, &ring));
+  SharedMemoryReader reader;
+  SharedMemoryRegion region;
+  ASSERT_TRUE(ring->Write(Content(100, 'a'), &region));
+  char dst[8192];
+
+  SharedMemoryRegion bad = region;
+  bad.set_size(8192);
+  EXPECT_TRUE(errors::IsInvalidArgument(reader.Read(bad, dst)));
+  bad = region;
+  bad.set_sequence(region.sequence() + 1);
+  EXPECT_TRUE(errors::IsUnavailable(reader.Read(bad, dst)));
+  bad = region;
+  bad.set_segment_name("/tf_shm_does_not_exist");
+  EXPECT_TRUE(errors::IsUnavailable(reader.Read(bad, dst)));
+}
+
+TEST(SharedMemoryRingTest, HostId) {
+  EXPECT_FALSE(SharedMemoryHostId().empty());
+  EXPECT_EQ(SharedMemoryHostId(), SharedMemoryHostId());
+}
+
+}  // namespace
+}  // namespace tensorflow
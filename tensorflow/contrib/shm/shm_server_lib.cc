@@ -0,0 +1,125 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_server_lib.h"
+
+#include "grpc/support/alloc.h"
+#include "tensorflow/contrib/shm/shm_rendezvous_mgr.h"
+#include "tensorflow/contrib/shm/shm_worker.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+int64 ReadPositiveInt64FromEnvVar(StringPiece env_var_name,
+                                  int64 default_val) {
+  int64 value;
+  Status status = ReadInt64FromEnvVar(env_var_name, default_val, &value);
+  if (!status.ok() || value <= 0) {
+    LOG(ERROR) << "Invalid " << env_var_name << ", using " << default_val
+               << ": " << status;
+    value = default_val;
+  }
+  return value;
+}
+
+// Size of the shared memory ring of each server.
+int64 RingBytes() {
+  static const int64 ring_bytes =
+      ReadPositiveInt64FromEnvVar("TF_SHM_RING_BYTES", 256 << 20);
+  return ring_bytes;
+}
+
+// Time after which a record that was not read is reclaimed, e.g. because
+// the receiving worker failed.
+int64 RecordTimeoutMicros() {
+  static const int64 timeout_micros =
+      ReadPositiveInt64FromEnvVar("TF_SHM_RECORD_TIMEOUT_MS", 60000) * 1000;
+  return timeout_micros;
+}
+
+// Smaller tensors are sent in-band, where the extra copy is cheaper than
+// the ring bookkeeping.
+int64 MinTensorBytes() {
+  static const int64 min_tensor_bytes =
+      ReadPositiveInt64FromEnvVar("TF_SHM_MIN_TENSOR_BYTES", 64 << 10);
+  return min_tensor_bytes;
+}
+
+}  // namespace
+
+ShmServer::ShmServer(const ServerDef& server_def, Env* env)
+    : GrpcServer(server_def, env) {}
+
+ShmServer::~ShmServer() {}
+
+Status ShmServer::Init() {
+  TF_RETURN_IF_ERROR(
+      SharedMemoryRing::Create(RingBytes(), RecordTimeoutMicros(), &ring_));
+  RendezvousMgrCreationFunction rendezvous_mgr_func =
+      [this](const WorkerEnv* env) {
+        return new ShmRendezvousMgr(env, &reader_);
+      };
+  WorkerCreationFunction worker_func = [this](WorkerEnv* env) {
+    return std::unique_ptr<ShmWorker>(
+        new ShmWorker(env, ring_.get(), MinTensorBytes()));
+  };
+  return GrpcServer::Init(nullptr, rendezvous_mgr_func, worker_func);
+}
+
+/* static */
+Status ShmServer::Create(const ServerDef& server_def, Env* env,
+                         std::unique_ptr<ServerInterface>* out_server) {
+  std::unique_ptr<ShmServer> ret(
+      new ShmServer(server_def, env == nullptr ? Env::Default() : env));
+  TF_RETURN_IF_ERROR(ret->Init());
+  *out_server = std::move(ret);
+  return Status::OK();
+}
+
+namespace {
+
+class ShmServerFactory : public ServerFactory {
+ public:
+  bool AcceptsOptions(const ServerDef& server_def) override {
+    return server_def.protocol() == "grpc+shm";
+  }
+
+  Status NewServer(const ServerDef& server_def,
+                   std::unique_ptr<ServerInterface>* out_server) override {
+    return ShmServer::Create(server_def, Env::Default(), out_server);
+  }
+};
+
+// Registers a `ServerFactory` for `ShmServer` instances.
+class ShmServerRegistrar {
+ public:
+  ShmServerRegistrar() {
+    gpr_allocation_functions alloc_fns;
+    memset(&alloc_fns, 0, sizeof(alloc_fns));
+    alloc_fns.malloc_fn = port::Malloc;
+    alloc_fns.realloc_fn = port::Realloc;
+    alloc_fns.free_fn = port::Free;
+    gpr_set_allocation_functions(alloc_fns);
+    ServerFactory::Register("SHM_SERVER", new ShmServerFactory());
+  }
+};
+static ShmServerRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
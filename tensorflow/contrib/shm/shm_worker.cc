@@ -0,0 +1,76 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/shm/shm_worker.h"
+
+#include "tensorflow/contrib/shm/shm.pb.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+ShmWorker::ShmWorker(WorkerEnv* worker_env, SharedMemoryRing* ring,
+                     int64 min_tensor_bytes)
+    : GrpcWorker(worker_env),
+      ring_(ring),
+      min_tensor_bytes_(min_tensor_bytes),
+      host_id_(SharedMemoryHostId()) {}
+
+bool ShmWorker::RequesterSharesMemory(const RecvTensorRequest& request) const {
+  if (!request.dma_ok() || !request.has_transport_options()) return false;
+  SharedMemoryClientInfo client_info;
+  return request.transport_options().UnpackTo(&client_info) &&
+         client_info.host_id() == host_id_;
+}
+
+void ShmWorker::GrpcRecvTensorAsync(CallOptions* opts,
+                                    const RecvTensorRequest* request,
+                                    ::grpc::ByteBuffer* response,
+                                    StatusCallback done) {
+  const bool shm_ok = RequesterSharesMemory(*request);
+  RecvTensorOnHostAsync(
+      opts, request,
+      [this, response, shm_ok](bool is_dead, const Tensor& val) {
+        // Dead tensors have no content, and the content of string (and
+        // other non-memcpy-able) tensors is not contiguous.
+        if (shm_ok && !is_dead && DataTypeCanUseMemcpy(val.dtype()) &&
+            val.TotalBytes() > 0 &&
+            static_cast<int64>(val.TotalBytes()) >= min_tensor_bytes_) {
+          const StringPiece content(
+              static_cast<const char*>(DMAHelper::base(&val)),
+              val.TotalBytes());
+          SharedMemoryRegion region;
+          if (ring_->Write(content, &region)) {
+            RecvTensorResponse proto;
+            proto.set_send_start_micros(Env::Default()->NowMicros());
+            TensorProto* tensor_proto = proto.mutable_tensor();
+            tensor_proto->set_dtype(val.dtype());
+            val.shape().AsProto(tensor_proto->mutable_tensor_shape());
+            proto.mutable_transport_options()->PackFrom(region);
+            grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+            return;
+          }
+          VLOG(1) << "Shared memory ring is full, sending "
+                  << val.TotalBytes() << " bytes in-band";
+        }
+        grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+      },
+      std::move(done));
+}
+
+}  // namespace tensorflow
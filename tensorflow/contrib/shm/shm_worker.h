@@ -0,0 +1,49 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_SHM_SHM_WORKER_H_
+#define TENSORFLOW_CONTRIB_SHM_SHM_WORKER_H_
+
+#include "tensorflow/contrib/shm/shm_ring.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
+
+namespace tensorflow {
+
+class ShmWorker : public GrpcWorker {
+ public:
+  // Tensors smaller than "min_tensor_bytes" are always sent in-band.
+  ShmWorker(WorkerEnv* env, SharedMemoryRing* ring, int64 min_tensor_bytes);
+
+  // Serve the RecvTensorRequest but, when the requester runs on the same
+  // host, copy the tensor content into the shared memory ring and send only
+  // its location (a SharedMemoryRegion in transport_options).
+  // Falls back to gRPC in-band tensor transport otherwise, or if the ring is
+  // full.
+  void GrpcRecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                           ::grpc::ByteBuffer* response,
+                           StatusCallback done) override;
+
+ private:
+  // Returns true if the requester asked for, and can read, shared memory.
+  bool RequesterSharesMemory(const RecvTensorRequest& request) const;
+
+  SharedMemoryRing* ring_;  // Not owned
+  const int64 min_tensor_bytes_;
+  const string host_id_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_SHM_SHM_WORKER_H_
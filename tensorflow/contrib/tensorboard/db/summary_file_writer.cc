@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/tensorboard/db/summary_file_writer.h"
 
+#include <algorithm>
+
 #include "tensorflow/contrib/tensorboard/db/summary_converter.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -27,12 +29,18 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// The events are serialized, written and flushed by a background thread, so
+// that a slow file system does not stall the steps that write summaries. Up to
+// max_queue events are batched into one flush, and writers block once several
+// times that many are waiting to be written.
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
         max_queue_(max_queue),
+        max_pending_(
+            std::max(kMaxPendingFactor * max_queue, int{kMinMaxPending})),
         flush_millis_(flush_millis),
         env_(env) {}
 
@@ -44,27 +52,45 @@ class SummaryFileWriter : public SummaryWriterInterface {
       }
       TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(logdir));
     }
-    mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(filename_suffix),
-        "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
-    is_initialized_ = true;
+    {
+      mutex_lock wl(writer_mu_);
+      events_writer_ =
+          tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(filename_suffix),
+          "Could not initialize events writer.");
+    }
+    {
+      mutex_lock ml(mu_);
+      last_flush_ = env_->NowMicros();
+      is_initialized_ = true;
+    }
+    flush_thread_.reset(env_->StartThread(
+        ThreadOptions(), "summary_file_writer", [this]() { FlushLoop(); }));
     return Status::OK();
   }
 
   Status Flush() override {
-    mutex_lock ml(mu_);
-    if (!is_initialized_) {
-      return errors::FailedPrecondition("Class was not properly initialized.");
+    {
+      mutex_lock ml(mu_);
+      if (!is_initialized_) {
+        return errors::FailedPrecondition(
+            "Class was not properly initialized.");
+      }
     }
-    return InternalFlush();
+    TF_RETURN_IF_ERROR(InternalFlush());
+    return TakeBackgroundStatus();
   }
 
   ~SummaryFileWriter() override {
-    (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      stop_ = true;
+      flush_needed_.notify_all();
+      space_available_.notify_all();
+    }
+    flush_thread_.reset();  // Joins the thread.
+    (void)Flush();          // Ignore errors.
   }
 
   Status WriteTensor(int64 global_step, Tensor t, const string& tag,
@@ -131,10 +157,19 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    if (!background_status_.ok()) {
+      Status s = background_status_;
+      background_status_ = Status::OK();
+      return s;
+    }
+    while (queue_.size() >= max_pending_ && !stop_) {
+      space_available_.wait(ml);
+    }
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      flush_requested_ = true;
+      flush_needed_.notify_one();
     }
     return Status::OK();
   }
@@ -146,28 +181,79 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Writers block once this many times max_queue events are waiting.
+  static constexpr int kMaxPendingFactor = 4;
+  static constexpr int kMinMaxPending = 16;
+
+  // Writes the queued events and flushes the file, every flush_millis or
+  // sooner when a writer asks for it, until the writer is destroyed.
+  void FlushLoop() {
+    for (;;) {
+      {
+        mutex_lock ml(mu_);
+        if (!stop_ && !flush_requested_) {
+          WaitForMilliseconds(&ml, &flush_needed_,
+                              std::max(flush_millis_, 1));
+        }
+        if (stop_) return;
+        flush_requested_ = false;
+        if (queue_.empty()) continue;
+      }
+      const Status s = InternalFlush();
+      if (!s.ok()) {
+        mutex_lock ml(mu_);
+        background_status_.Update(s);
+      }
+    }
+  }
+
+  Status InternalFlush() LOCKS_EXCLUDED(mu_) {
+    // Holding writer_mu_ while taking the queue keeps the batches in order.
+    mutex_lock wl(writer_mu_);
+    std::vector<std::unique_ptr<Event>> events;
+    {
+      mutex_lock ml(mu_);
+      events.swap(queue_);
+      space_available_.notify_all();
+    }
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
+    mutex_lock ml(mu_);
     last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
-  bool is_initialized_;
+  // Returns, and clears, the first error of the background flushes.
+  Status TakeBackgroundStatus() LOCKS_EXCLUDED(mu_) {
+    mutex_lock ml(mu_);
+    Status s = background_status_;
+    background_status_ = Status::OK();
+    return s;
+  }
+
+  bool is_initialized_ GUARDED_BY(mu_);
   const int max_queue_;
+  const int max_pending_;
   const int flush_millis_;
-  uint64 last_flush_;
+  uint64 last_flush_ GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
+  condition_variable flush_needed_;
+  condition_variable space_available_;
+  bool flush_requested_ GUARDED_BY(mu_) = false;
+  bool stop_ GUARDED_BY(mu_) = false;
+  Status background_status_ GUARDED_BY(mu_);
   std::vector<std::unique_ptr<Event>> queue_ GUARDED_BY(mu_);
+  // Acquired before mu_, and held while events are written to the file.
+  mutex writer_mu_;
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ GUARDED_BY(writer_mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       GUARDED_BY(mu_);
+  std::unique_ptr<Thread> flush_thread_;
 };
 
 }  // namespace
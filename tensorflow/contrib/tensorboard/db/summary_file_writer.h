@@ -28,9 +28,11 @@ namespace tensorflow {
 /// makes this summary writer suitable for file systems like GCS.
 ///
 /// It will enqueue up to max_queue summaries, and flush at least every
-/// flush_millis milliseconds. The summaries will be written to the
-/// directory specified by logdir and with the filename suffixed by
-/// filename_suffix. The caller owns a reference to result if the
+/// flush_millis milliseconds. The summaries are written and flushed by a
+/// background thread; writers only block when it falls far behind, and
+/// errors it runs into are returned by later calls. The summaries will be
+/// written to the directory specified by logdir and with the filename
+/// suffixed by filename_suffix. The caller owns a reference to result if the
 /// returned status is ok. The Env object must not be destroyed until
 /// after the returned writer.
 Status CreateSummaryFileWriter(int max_queue, int flush_millis,
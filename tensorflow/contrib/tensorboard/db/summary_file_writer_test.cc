@@ -213,5 +213,44 @@ TEST_F(SummaryFileWriterTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+TEST_F(SummaryFileWriterTest, ManyEvents) {
+  // Enough events for the writer to block on the background thread.
+  const int kNumEvents = 1000;
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(1, 1, testing::TmpDir(),
+                                      "many_events_test", &env_, &writer));
+  {
+    core::ScopedUnref deleter(writer);
+    Tensor one(DT_FLOAT, TensorShape({}));
+    one.scalar<float>()() = 1.0;
+    for (int i = 0; i < kNumEvents; ++i) {
+      TF_CHECK_OK(writer->WriteScalar(i, one, "name"));
+    }
+  }
+
+  std::vector<string> files;
+  TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+  int found = 0;
+  for (const string& f : files) {
+    if (!str_util::StrContains(f, "many_events_test")) continue;
+    ++found;
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env_.NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    string record;
+    uint64 offset = 0;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));  // The file version.
+    for (int i = 0; i < kNumEvents; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      Event e;
+      e.ParseFromString(record);
+      EXPECT_EQ(i, e.step());
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+  EXPECT_EQ(1, found);
+}
+
 }  // namespace
 }  // namespace tensorflow
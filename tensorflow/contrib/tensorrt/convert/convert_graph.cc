@@ -179,6 +179,8 @@ struct ConvertGraphParams {
 };
 
 static tensorflow::Status FillSubGraphEdgeSets(ConvertGraphParams* p) {
+  p->subgraph_inputs.clear();
+  p->subgraph_outputs.clear();
   GetSubGraphIncomingEdges(p->graph, p->subgraph_node_ids,
                            &p->subgraph_incoming_edges);
   for (const tensorflow::Edge* edge : p->subgraph_incoming_edges) {
@@ -317,13 +319,20 @@ tensorflow::Status ConvertCalibGraphToInferGraph(
       tensorflow::GraphConstructorOptions(), graph_def, &graph));
   //  get calib nodes
   std::vector<tensorflow::Node*> calib_nodes;
+  bool has_engine_nodes = false;
   for (auto node : graph.op_nodes()) {
     if (node->type_string() == "TRTCalibOp") {
       VLOG(1) << "Found Calib Node";
       calib_nodes.push_back(node);
     }
+    has_engine_nodes |= node->type_string() == "TRTEngineOp";
   }
   VLOG(0) << "Num Calib nodes in graph= " << calib_nodes.size();
+  // All the segments may have had their INT8 engines in the engine cache.
+  if (calib_nodes.empty() && has_engine_nodes) {
+    *infer_graph = graph_def;
+    return tensorflow::Status::OK();
+  }
   if (calib_nodes.size() == 0)
     return tensorflow::errors::FailedPrecondition(
         "Graph doesn't contain any calibration nodes!."
@@ -467,7 +476,12 @@ tensorflow::Status ConvertAfterShapes(
                          precision_mode, segment_nodes_and_device.second,
                          allocator, cuda_device_id);
     if (precision_mode == INT8MODE) {
-      tensorflow::Status status = GetCalibNode(&p);
+      // A segment whose INT8 engine is in the engine cache is converted
+      // directly, without being calibrated again.
+      tensorflow::Status status = ConvertSubGraphToTensorRT(&p);
+      if (!status.ok()) {
+        status = GetCalibNode(&p);
+      }
       if (status != tensorflow::Status::OK()) {
         LOG(WARNING) << "subgraph conversion error for subgraph_index:" << count
                      << " due to: \"" << status.ToString()
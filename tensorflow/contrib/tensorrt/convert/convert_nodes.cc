@@ -26,6 +26,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/contrib/tensorrt/log/trt_logger.h"
+#include "tensorflow/contrib/tensorrt/resources/trt_engine_cache.h"
 #include "tensorflow/contrib/tensorrt/resources/trt_resource_manager.h"
 #include "tensorflow/contrib/tensorrt/resources/trt_resources.h"
 #include "tensorflow/core/framework/node_def.pb.h"  // NOLINT
@@ -37,6 +38,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -2244,6 +2247,14 @@ tensorflow::Status ConvertCalibrationNodeToEngineNode(
   const char* engine_plan_data = static_cast<const char*>(engine_plan->data());
   string engine_plan_string(engine_plan_data,
                             engine_plan_data + engine_plan->size());
+  if (!calib_res->engine_cache_key_.empty()) {
+    Status cache_status =
+        WriteCachedEngine(calib_res->engine_cache_key_, engine_plan_string);
+    if (!cache_status.ok()) {
+      LOG(WARNING) << "Couldn't cache the calibrated engine " << engine_name
+                   << ": " << cache_status;
+    }
+  }
   status = op_builder.Attr("serialized_engine", engine_plan_string)
                .Attr("input_nodes", input_names)
                .Attr("output_nodes", output_nodes)
@@ -2325,6 +2336,52 @@ string SubgraphNameScopeGenerator(const std::list<tensorflow::Node*>* order) {
   return subgraph_name_scope;
 }
 
+// Returns the key of the engine of a segment in the engine cache. Engines are
+// only reused for the same nodes, input shapes, build options, TensorRT
+// version and GPU model.
+string EngineCacheKey(const tensorrt::convert::SubGraphParams& s) {
+  cudaDeviceProp prop;
+  string gpu;
+  if (cudaGetDeviceProperties(&prop, s.cuda_gpu_id_) == cudaSuccess) {
+    gpu = StrCat(prop.name, " ", prop.major, ".", prop.minor);
+  }
+  uint64 fingerprint = tensorflow::Hash64(StrCat(
+      NV_TENSORRT_MAJOR, ".", NV_TENSORRT_MINOR, ".", NV_TENSORRT_PATCH, ";",
+      gpu, ";", s.precision_mode, ";", s.max_batch_size, ";",
+      s.max_workspace_size_bytes));
+  std::vector<const tensorflow::Node*> nodes;
+  for (int id : s.subgraph_node_ids) nodes.push_back(s.graph.FindNodeId(id));
+  std::sort(nodes.begin(), nodes.end(),
+            [](const tensorflow::Node* a, const tensorflow::Node* b) {
+              return a->name() < b->name();
+            });
+  for (const tensorflow::Node* node : nodes) {
+    tensorflow::NodeDef def = node->def();
+    def.clear_device();
+    string serialized;
+    tensorflow::SerializeToStringDeterministic(def, &serialized);
+    fingerprint =
+        tensorflow::Hash64Combine(fingerprint, tensorflow::Hash64(serialized));
+  }
+  for (const auto& input : s.input_inds) {
+    const tensorflow::Node* node = s.graph.FindNodeId(input.first);
+    string shape = "?";
+    if (s.graph_properties.HasOutputProperties(node->name())) {
+      const auto& props = s.graph_properties.GetOutputProperties(node->name());
+      if (input.second < static_cast<int>(props.size())) {
+        tensorflow::SerializeToStringDeterministic(props[input.second],
+                                                   &shape);
+      }
+    }
+    const string input_key =
+        StrCat(node->name(), ":", input.second, ";", shape);
+    fingerprint =
+        tensorflow::Hash64Combine(fingerprint, tensorflow::Hash64(input_key));
+  }
+  return StrCat(tensorflow::strings::Hex(fingerprint,
+                                         tensorflow::strings::kZeroPad16));
+}
+
 tensorflow::Status ConvertSubgraph(
     Converter& converter, tensorrt::convert::SubGraphParams& s,
     std::list<tensorflow::Node*>* order, std::vector<string>* input_names,
@@ -2544,6 +2601,11 @@ tensorflow::Status InjectCalibrationNode(tensorrt::convert::SubGraphParams& s) {
   }
   LOG(INFO) << "finished op preparation";
 
+  // The calibrated engine is cached when the inference graph is built.
+  if (!GetEngineCacheDir().empty()) {
+    op_res->engine_cache_key_ = EngineCacheKey(s);
+  }
+
   auto status = op_builder.Attr("segment_nodes", segment_names)
                     .Attr("input_names", input_names)
                     .Attr("segment_output_names", output_names)
@@ -2562,6 +2624,24 @@ tensorflow::Status ConvertSubGraphToTensorRTNodeDef(
   std::list<tensorflow::Node*> order;
   TF_RETURN_IF_ERROR(ReverseTopologicalSort(s, &order));
 
+  // INT8 engines can only be built by calibration, so they must be cached.
+  string cache_key;
+  string engine_plan_string;
+  bool cached = false;
+  if (!GetEngineCacheDir().empty()) {
+    cache_key = EngineCacheKey(s);
+    Status cache_status = ReadCachedEngine(cache_key, &engine_plan_string);
+    cached = cache_status.ok();
+    if (!cached && !tensorflow::errors::IsNotFound(cache_status)) {
+      LOG(WARNING) << "Couldn't read cached engine " << cache_key << ": "
+                   << cache_status;
+    }
+  }
+  if (s.precision_mode == INT8MODE && !cached) {
+    return tensorflow::errors::NotFound(
+        "No cached INT8 engine for the segment, it must be calibrated");
+  }
+
   static int static_id = 0;
   string subgraph_name_scope = SubgraphNameScopeGenerator(&order);
   string engine_name = StrCat(subgraph_name_scope, "my_trt_op", static_id++);
@@ -2609,9 +2689,10 @@ tensorflow::Status ConvertSubGraphToTensorRTNodeDef(
     trt_builder->setHalf2Mode(true);
     VLOG(0) << "Using FP16 precision mode";
   }
-  LOG(INFO) << "starting build engine";
-  string engine_plan_string;
-  {
+  if (cached) {
+    VLOG(0) << "Using cached engine " << cache_key;
+  } else {
+    LOG(INFO) << "starting build engine";
     auto trt_engine =
         infer_object(trt_builder->buildCudaEngine(*converter.network()));
     VLOG(0) << "Built network";
@@ -2624,6 +2705,13 @@ tensorflow::Status ConvertSubGraphToTensorRTNodeDef(
         static_cast<const char*>(engine_plan->data());
     engine_plan_string =
         string(engine_plan_data, engine_plan_data + engine_plan->size());
+    if (!cache_key.empty()) {
+      Status cache_status = WriteCachedEngine(cache_key, engine_plan_string);
+      if (!cache_status.ok()) {
+        LOG(WARNING) << "Couldn't cache engine " << engine_name << ": "
+                     << cache_status;
+      }
+    }
   }
   TF_RETURN_IF_ERROR(weight_rmgr->Delete<tensorflow::tensorrt::TRTWeightStore>(
       engine_name, engine_name));
@@ -0,0 +1,81 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/tensorrt/resources/trt_engine_cache.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace tensorrt {
+
+namespace {
+
+string EnginePath(const string& dir, const string& key) {
+  return io::JoinPath(dir, strings::StrCat(key, ".trt_engine"));
+}
+
+}  // namespace
+
+string GetEngineCacheDir() {
+  string dir;
+  Status s = ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR", "", &dir);
+  if (!s.ok()) {
+    LOG(WARNING) << "Disabling the TensorRT engine cache: " << s;
+    return "";
+  }
+  return dir;
+}
+
+Status ReadCachedEngine(const string& key, string* engine_plan) {
+  const string dir = GetEngineCacheDir();
+  if (dir.empty()) {
+    return errors::NotFound("The TensorRT engine cache is disabled");
+  }
+  const string path = EnginePath(dir, key);
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->FileExists(path));
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, engine_plan));
+  VLOG(1) << "Read TensorRT engine " << key << " from " << dir;
+  return Status::OK();
+}
+
+Status WriteCachedEngine(const string& key, const string& engine_plan) {
+  const string dir = GetEngineCacheDir();
+  if (dir.empty()) return Status::OK();
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  const string path = EnginePath(dir, key);
+  string tmp_path = strings::StrCat(path, ".");
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Couldn't create a temporary file name for ",
+                            path);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, engine_plan));
+  Status s = env->RenameFile(tmp_path, path);
+  if (!s.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+    return s;
+  }
+  VLOG(1) << "Wrote TensorRT engine " << key << " to " << dir;
+  return Status::OK();
+}
+
+}  // namespace tensorrt
+}  // namespace tensorflow
@@ -0,0 +1,47 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CONTRIB_TENSORRT_RESOURCES_TRT_ENGINE_CACHE_H_
+#define TENSORFLOW_CONTRIB_TENSORRT_RESOURCES_TRT_ENGINE_CACHE_H_
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace tensorrt {
+
+// The engine cache keeps serialized TensorRT engines on disk, so that a
+// segment that is converted again with the same nodes, input shapes, build
+// options and GPU reuses its engine instead of building it, and an INT8
+// segment reuses its calibrated engine instead of being calibrated again.
+//
+// The cache is enabled by setting TF_TRT_ENGINE_CACHE_DIR to a directory,
+// which is shared by all the processes that use it.
+
+// Returns the cache directory, or an empty string if the cache is disabled.
+string GetEngineCacheDir();
+
+// Reads the engine cached under key into engine_plan. Returns NotFound if the
+// cache is disabled or doesn't have the engine.
+Status ReadCachedEngine(const string& key, string* engine_plan);
+
+// Caches engine_plan under key. The engine is written to a temporary file and
+// renamed, so that concurrent readers never see a partial engine.
+Status WriteCachedEngine(const string& key, const string& engine_plan);
+
+}  // namespace tensorrt
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_TENSORRT_RESOURCES_TRT_ENGINE_CACHE_H_
@@ -0,0 +1,60 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/tensorrt/resources/trt_engine_cache.h"
+
+#include <stdlib.h>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tensorrt {
+namespace {
+
+TEST(TRTEngineCacheTest, DisabledByDefault) {
+  unsetenv("TF_TRT_ENGINE_CACHE_DIR");
+  EXPECT_EQ("", GetEngineCacheDir());
+  TF_EXPECT_OK(WriteCachedEngine("key", "engine"));
+  string engine_plan;
+  EXPECT_TRUE(errors::IsNotFound(ReadCachedEngine("key", &engine_plan)));
+}
+
+TEST(TRTEngineCacheTest, WriteAndRead) {
+  const string dir = io::JoinPath(testing::TmpDir(), "trt_engine_cache");
+  setenv("TF_TRT_ENGINE_CACHE_DIR", dir.c_str(), 1);
+  EXPECT_EQ(dir, GetEngineCacheDir());
+
+  string engine_plan;
+  EXPECT_TRUE(errors::IsNotFound(ReadCachedEngine("a", &engine_plan)));
+  TF_ASSERT_OK(WriteCachedEngine("a", string("engine\0a", 8)));
+  TF_ASSERT_OK(WriteCachedEngine("b", "engine b"));
+  TF_ASSERT_OK(ReadCachedEngine("a", &engine_plan));
+  EXPECT_EQ(string("engine\0a", 8), engine_plan);
+
+  // A new engine replaces the cached one.
+  TF_ASSERT_OK(WriteCachedEngine("a", "new engine a"));
+  TF_ASSERT_OK(ReadCachedEngine("a", &engine_plan));
+  EXPECT_EQ("new engine a", engine_plan);
+  TF_ASSERT_OK(ReadCachedEngine("b", &engine_plan));
+  EXPECT_EQ("engine b", engine_plan);
+  unsetenv("TF_TRT_ENGINE_CACHE_DIR");
+}
+
+}  // namespace
+}  // namespace tensorrt
+}  // namespace tensorflow
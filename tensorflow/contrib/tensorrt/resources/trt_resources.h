@@ -69,6 +69,8 @@ class TRTCalibrationResource : public tensorflow::ResourceBase {
   tensorflow::tensorrt::Logger* logger_;
   // TODO(sami): Use threadpool threads!
   std::thread* thr_;
+  // Key of the calibrated engine in the engine cache, empty if it is disabled.
+  string engine_cache_key_;
 };
 
 class TRTWeightStore : public tensorflow::ResourceBase {
@@ -970,6 +970,24 @@ static void StreamGPUOp(Device* gpu_device, const DeviceContext* device_context,
 }
 #endif  // GOOGLE_CUDA
 
+// Returns an allocator of host memory that RdmaMgr::InitAllocators()
+// registers with the NIC, so that buffers allocated from it can be RDMA
+// written to and from without registering them on every request.
+static Allocator* RdmaHostAllocator() {
+#if GOOGLE_CUDA
+  return ProcessState::singleton()->GetCUDAHostAllocator(0);
+#else
+  return cpu_allocator();
+#endif  // GOOGLE_CUDA
+}
+
+// Returns a host tensor of "num_bytes" from RdmaHostAllocator(), to hold a
+// serialized TensorProto.
+static Tensor* NewProtoBuffer(size_t num_bytes) {
+  return new Tensor(RdmaHostAllocator(), DT_UINT8,
+                    TensorShape({static_cast<int64>(num_bytes)}));
+}
+
 RdmaTensorResponse* RdmaChannel::AddTensorResponse(const RdmaMessage& rm) {
   mutex_lock lock{mu_};
   auto it =
@@ -1107,6 +1125,15 @@ void RdmaTensorResponse::RecvHandler(Rendezvous::ParsedKey parsed,
     // tensor is in CPU memory.
     if (!can_memcpy) {
       in.AsProtoTensorContent(&proto);
+    } else if ((in.TotalBytes() > 0) && !is_dead &&
+               (RdmaMemoryMgr::Singleton().FindMemoryRegion(
+                    (void*)DMAHelper::base(&in), in.TotalBytes()) == nullptr)) {
+      // The tensor was allocated by an allocator that is not registered with
+      // the NIC. Stage it in registered memory.
+      copy = Tensor(RdmaHostAllocator(), in.dtype(), in.shape());
+      memcpy(DMAHelper::base(&copy), DMAHelper::base(&in), in.TotalBytes());
+      Send(copy, proto, is_dead, Status::OK());
+      return;
     }
     Send(in, proto, is_dead, Status::OK());
   }
@@ -1208,9 +1235,15 @@ void RdmaTensorResponse::SendContent(const Tensor& in, const TensorProto& proto,
     } else {
       RDMA_LOG(2) << "Encoding proto: " << rm_.name_
                   << " (Size: " << tensor_bytes << ") " << in.DebugString();
-      src_addr_ = malloc(tensor_bytes);
-      mr_ = ibv_reg_mr(channel_->adapter_->pd_, src_addr_, tensor_bytes,
-                       IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+      // Serialize into registered memory, which stays alive until the write
+      // is complete like the content of a DMAable tensor.
+      Tensor* proto_buffer = NewProtoBuffer(tensor_bytes);
+      src_buffer_ = const_cast<TensorBuffer*>(DMAHelper::buffer(proto_buffer));
+      src_buffer_->Ref();
+      delete proto_buffer;
+      src_addr_ = src_buffer_->data();
+      mr_ = RdmaMemoryMgr::Singleton().FindMemoryRegion(src_addr_,
+                                                        tensor_bytes);
       proto.SerializeToArray(src_addr_, tensor_bytes);
     }
   } else {
@@ -1258,8 +1291,6 @@ void RdmaTensorResponse::Destroy() {
     delete tensor_;
   }
   if (proto_ != nullptr) {
-    ibv_dereg_mr(mr_);
-    free(src_addr_);
     delete proto_;
   }
   // Remove response from the pending list:
@@ -1408,7 +1439,9 @@ void RdmaMessage::ParseMessage(RdmaMessage& rm, void* buffer) {
 ibv_mr* RdmaMemoryMgr::FindMemoryRegion(void* addr, size_t length) {
   mutex_lock l(mrs_mu_);
   auto iter = std::upper_bound(mrs_.begin(), mrs_.end(), addr, &Comparator);
-  if (iter == std::end(mrs_) || iter->get()->addr > addr) {
+  if (iter == std::end(mrs_) || iter->get()->addr > addr ||
+      reinterpret_cast<char*>(addr) + length >
+          reinterpret_cast<char*>(iter->get()->addr) + iter->get()->length) {
     return nullptr;
   } else {
     return iter->get();
@@ -1484,6 +1517,7 @@ RdmaTensorRequest::RdmaTensorRequest(
       meta_data_(RdmaMemoryMgr::Singleton().GetTensorMetaData(key)),
       result_tensor_(nullptr),
       proxy_tensor_(nullptr),
+      proto_buffer_(nullptr),
       rdma_addr_(nullptr),
       mr_(nullptr),
       done_(done) {}
@@ -1522,6 +1556,10 @@ void RdmaTensorRequest::DeallocateTensors() {
     delete proxy_tensor_;
     proxy_tensor_ = nullptr;
   }
+  if (proto_buffer_ != nullptr) {
+    delete proto_buffer_;
+    proto_buffer_ = nullptr;
+  }
 }
 
 bool RdmaTensorRequest::AllocateTensors() {
@@ -1537,6 +1575,19 @@ bool RdmaTensorRequest::AllocateTensors() {
     }
     rdma_addr_ = DMAHelper::base(result_tensor_);
     mr_ = RdmaMemoryMgr::Singleton().FindMemoryRegion(rdma_addr_, tensor_size);
+    const bool on_host = (dst_dev_->tensorflow_gpu_device_info() == nullptr) ||
+                         recv_args_.alloc_attrs.on_host();
+    if (mr_ == nullptr && on_host) {
+      // The destination allocator is not registered with the NIC. Any host
+      // memory will do for the result, so take it from one that is, rather
+      // than writing to a proxy and copying.
+      delete result_tensor_;
+      result_tensor_ = new Tensor(RdmaHostAllocator(), meta_data_->data_type_,
+                                  meta_data_->tensor_shape_);
+      rdma_addr_ = DMAHelper::base(result_tensor_);
+      mr_ =
+          RdmaMemoryMgr::Singleton().FindMemoryRegion(rdma_addr_, tensor_size);
+    }
 #if GOOGLE_CUDA
     if (mr_ == nullptr) {
       // Can't RDMA directly to result. Use a proxy.
@@ -1550,9 +1601,9 @@ bool RdmaTensorRequest::AllocateTensors() {
 #endif
   } else {
     uint32_t proto_size = meta_data_->proto_size_;
-    rdma_addr_ = malloc(proto_size);
-    mr_ = ibv_reg_mr(RdmaMemoryMgr::Singleton().pd_, rdma_addr_, proto_size,
-                     IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+    proto_buffer_ = NewProtoBuffer(proto_size);
+    rdma_addr_ = DMAHelper::base(proto_buffer_);
+    mr_ = RdmaMemoryMgr::Singleton().FindMemoryRegion(rdma_addr_, proto_size);
   }
   CHECK(mr_ != nullptr) << " No memory region found for address " << rdma_addr_
                         << ": " << key_;
@@ -1645,8 +1696,6 @@ void RdmaTensorRequest::RecvTensorContent() {
     TensorProto proto;
     CHECK(ParseProtoUnlimited(&proto, rdma_addr_, meta_data_->proto_size_))
         << "fail to parse proto from array";
-    ibv_dereg_mr(mr_);
-    free(rdma_addr_);
     Status s = dst_dev_->MakeTensorFromProto(proto, recv_args_.alloc_attrs,
                                              result_tensor_);
     Done(s);
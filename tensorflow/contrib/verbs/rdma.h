@@ -295,6 +295,9 @@ class RdmaTensorRequest {
   const TensorMetaData* meta_data_;
   Tensor* result_tensor_;
   Tensor* proxy_tensor_;
+  // Registered host buffer that receives the serialized TensorProto of
+  // tensors that can't be RDMA written directly.
+  Tensor* proto_buffer_;
   void* rdma_addr_;
   ibv_mr* mr_;
   RecvDoneCallback done_;
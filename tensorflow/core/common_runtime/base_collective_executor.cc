@@ -14,13 +14,18 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
 
+#include <unordered_map>
+
 #include "tensorflow/core/common_runtime/broadcaster.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/ring_reducer.h"
 #include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
 
 #define VALUE_IN_DEBUG_STRING false
 
@@ -217,7 +222,7 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
       // TODO(tucker): support other reduction algorithms,
       // e.g. tree-reduce, hybrid tree/ring, delegate-to-NCCL, etc.
       const Tensor* input = &ctx->input(0);
-      RingReducer* reducer =
+      CollectiveReducer* reducer =
           CreateReducer(ctx, CtxParams(ctx), col_params, exec_key, step_id_,
                         input, output, &error);
       if (!reducer) {
@@ -258,10 +263,65 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
   }
 }
 
-RingReducer* BaseCollectiveExecutor::CreateReducer(
+namespace {
+
+// Whether to reduce hierarchically (see HierarchicalReducer) in groups that
+// span several tasks with more than one device each. Set with
+// TF_COLLECTIVE_HIERARCHICAL_REDUCE.
+bool UseHierarchicalReduce() {
+  static const bool use_hierarchical_reduce = []() {
+    bool value;
+    Status status = ReadBoolFromEnvVar("TF_COLLECTIVE_HIERARCHICAL_REDUCE",
+                                       false, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    return value;
+  }();
+  return use_hierarchical_reduce;
+}
+
+mutex* ReducerFactoriesMu() {
+  static mutex* mu = new mutex;
+  return mu;
+}
+
+std::unordered_map<int, CollectiveReducerFactory>* ReducerFactories() {
+  static auto* factories =
+      new std::unordered_map<int, CollectiveReducerFactory>;
+  return factories;
+}
+
+}  // namespace
+
+void RegisterCollectiveReducerFactory(CollectiveImplementation implementation,
+                                      CollectiveReducerFactory factory) {
+  mutex_lock l(*ReducerFactoriesMu());
+  (*ReducerFactories())[implementation] = std::move(factory);
+}
+
+CollectiveReducer* BaseCollectiveExecutor::CreateReducer(
     OpKernelContext* ctx, OpKernelContext::Params* params,
     const CollectiveParams& col_params, const string& exec_key, int64 step_id,
     const Tensor* input, Tensor* output, string* error) {
+  if (col_params.instance.implementation != RING_IMPLEMENTATION) {
+    CollectiveReducerFactory factory;
+    {
+      mutex_lock l(*ReducerFactoriesMu());
+      auto it = ReducerFactories()->find(col_params.instance.implementation);
+      if (it != ReducerFactories()->end()) factory = it->second;
+    }
+    if (!factory) {
+      *error = strings::StrCat(
+          "No CollectiveReducer is registered for implementation ",
+          col_params.instance.implementation,
+          "; the NCCL implementation needs a CUDA build that links in the "
+          "contrib/nccl kernels");
+      return nullptr;
+    }
+    return factory(this, dev_mgr_, ctx, params, col_params, exec_key, step_id,
+                   input, output, error);
+  }
   switch (col_params.instance.data_type) {
     case DT_INT32:
       if (col_params.group.device_type == DEVICE_GPU) {
@@ -274,6 +334,11 @@ RingReducer* BaseCollectiveExecutor::CreateReducer(
     case DT_FLOAT:
     case DT_DOUBLE:
     case DT_INT64:
+      if (UseHierarchicalReduce() &&
+          HierarchicalReducer::IsApplicable(col_params)) {
+        return new HierarchicalReducer(this, dev_mgr_, ctx, params, col_params,
+                                       exec_key, step_id, input, output);
+      }
       return new RingReducer(this, dev_mgr_, ctx, params, col_params, exec_key,
                              step_id, input, output);
       break;
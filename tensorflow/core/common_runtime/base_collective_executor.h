@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 
+#include <functional>
 #include <string>
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
 #include "tensorflow/core/framework/collective.h"
@@ -23,7 +24,6 @@ limitations under the License.
 namespace tensorflow {
 class Broadcaster;
 class DeviceMgr;
-class RingReducer;
 
 // Helper interface that aliases regular subfields of a Tensor as separate
 // Tensors for in-place update.
@@ -80,6 +80,33 @@ class CollectiveAdapter {
 CollectiveAdapter* MakeCollectiveAdapter(Tensor* output, int num_chunks,
                                          Allocator* allocator);
 
+// Interface of the implementations of collective all-reduce.
+class CollectiveReducer {
+ public:
+  virtual ~CollectiveReducer() {}
+
+  // Runs the reduction on behalf of one device, then calls 'done'. Blocks,
+  // so must run in a thread that can be blocked.
+  virtual void Run(StatusCallback done) = 0;
+};
+
+// Creates the CollectiveReducer for an implementation that lives outside of
+// core, e.g. NCCL_IMPLEMENTATION in contrib/nccl. Takes the arguments of the
+// RingReducer constructor. Returns nullptr and sets '*error' if the
+// implementation can not carry out the reduction described by 'col_params'.
+typedef std::function<CollectiveReducer*(
+    CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+    OpKernelContext* ctx, OpKernelContext::Params* op_params,
+    const CollectiveParams& col_params, const string& exec_key, int64 step_id,
+    const Tensor* input, Tensor* output, string* error)>
+    CollectiveReducerFactory;
+
+// Makes BaseCollectiveExecutor create the reducers of the collectives that
+// select 'implementation' with 'factory'. Usually called at static
+// initialization time by the library that provides the implementation.
+void RegisterCollectiveReducerFactory(CollectiveImplementation implementation,
+                                      CollectiveReducerFactory factory);
+
 // Default implementation of CollectiveExecutor.  Delegates the actual
 // work of moving data to a class specialized for the operation type,
 // arguments and device+interconnect topology.
@@ -133,12 +160,12 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   std::unique_ptr<PerStepCollectiveRemoteAccess> remote_access_;
 
  private:
-  RingReducer* CreateReducer(OpKernelContext* ctx,
-                             OpKernelContext::Params* params,
-                             const CollectiveParams& col_params,
-                             const string& exec_key, int64 step_id,
-                             const Tensor* input, Tensor* output,
-                             string* error);
+  CollectiveReducer* CreateReducer(OpKernelContext* ctx,
+                                   OpKernelContext::Params* params,
+                                   const CollectiveParams& col_params,
+                                   const string& exec_key, int64 step_id,
+                                   const Tensor* input, Tensor* output,
+                                   string* error);
 
   Broadcaster* CreateBroadcaster(OpKernelContext* ctx,
                                  OpKernelContext::Params* params,
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include <atomic>
+#include <functional>
+#include <thread>
+#include <unordered_set>
 
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
@@ -25,10 +28,74 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
+
+#ifndef IS_MOBILE_PLATFORM
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#endif  // IS_MOBILE_PLATFORM
 
 namespace tensorflow {
 
+#ifndef IS_MOBILE_PLATFORM
+namespace {
+
+// Exports the stats of the live BFC allocators of the process as the metric
+// /tensorflow/core/bfc_allocator/bytes. The stats are read when the metrics
+// are collected, so allocations do not pay for the metric.
+class BFCAllocatorMetrics {
+ public:
+  static BFCAllocatorMetrics* Get() {
+    static BFCAllocatorMetrics* metrics = new BFCAllocatorMetrics;
+    return metrics;
+  }
+
+  void Add(BFCAllocator* allocator) {
+    mutex_lock l(mu_);
+    allocators_.insert(allocator);
+  }
+
+  void Remove(BFCAllocator* allocator) {
+    mutex_lock l(mu_);
+    allocators_.erase(allocator);
+  }
+
+ private:
+  BFCAllocatorMetrics()
+      : bytes_def_("/tensorflow/core/bfc_allocator/bytes",
+                   "The bytes that BFC allocators have in use, have had in "
+                   "use at most and may allocate.",
+                   "allocator", "stat"),
+        registration_handle_(
+            monitoring::CollectionRegistry::Default()->Register(
+                &bytes_def_, [this](monitoring::MetricCollectorGetter getter) {
+                  auto collector = getter.Get(&bytes_def_);
+                  mutex_lock l(mu_);
+                  for (BFCAllocator* allocator : allocators_) {
+                    AllocatorStats stats;
+                    allocator->GetStats(&stats);
+                    const string name = allocator->Name();
+                    collector.CollectValue({{name, "in_use"}},
+                                           stats.bytes_in_use);
+                    collector.CollectValue({{name, "max_in_use"}},
+                                           stats.max_bytes_in_use);
+                    collector.CollectValue({{name, "limit"}},
+                                           stats.bytes_limit);
+                  }
+                })) {}
+
+  mutex mu_;
+  std::unordered_set<BFCAllocator*> allocators_ GUARDED_BY(mu_);
+  const monitoring::MetricDef<monitoring::MetricKind::kGauge, int64, 2>
+      bytes_def_;
+  std::unique_ptr<monitoring::CollectionRegistry::RegistrationHandle>
+      registration_handle_;
+};
+
+}  // namespace
+#endif  // IS_MOBILE_PLATFORM
+
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name)
     : suballocator_(sub_allocator),
@@ -65,9 +132,34 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  int64 free_list_max_chunk_bytes = 0;
+  Status status = ReadInt64FromEnvVar("TF_BFC_FREE_LIST_MAX_CHUNK_BYTES", 0,
+                                      &free_list_max_chunk_bytes);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  } else if (free_list_max_chunk_bytes > 0) {
+    // By default each shard may hold 16 chunks of the largest cached size.
+    EnableFreeListCache(free_list_max_chunk_bytes,
+                        16 * free_list_max_chunk_bytes);
+  }
+  int64 memory_timeline_events = 0;
+  status = ReadInt64FromEnvVar("TF_BFC_MEMORY_TIMELINE_EVENTS", 0,
+                               &memory_timeline_events);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  } else if (memory_timeline_events > 0) {
+    EnableMemoryTimeline(memory_timeline_events);
+  }
+#ifndef IS_MOBILE_PLATFORM
+  BFCAllocatorMetrics::Get()->Add(this);
+#endif  // IS_MOBILE_PLATFORM
 }
 
 BFCAllocator::~BFCAllocator() {
+#ifndef IS_MOBILE_PLATFORM
+  BFCAllocatorMetrics::Get()->Remove(this);
+#endif  // IS_MOBILE_PLATFORM
   // Return memory back.
   VLOG(2) << "Number of regions allocated: "
           << region_manager_.regions().size();
@@ -191,16 +283,18 @@ void BFCAllocator::DeallocateChunk(ChunkHandle h) {
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes) {
   // Fast path: Try once to allocate without getting the retry_helper_ involved
   void* r = AllocateRawInternal(unused_alignment, num_bytes, false);
-  if (r != nullptr) {
-    return r;
-  } else {
+  if (r == nullptr) {
     static const int64 kMaxMillisToWait = 10000;  // 10 seconds
-    return retry_helper_.AllocateRaw(
+    r = retry_helper_.AllocateRaw(
         [this](size_t a, size_t nb, bool v) {
           return AllocateRawInternal(a, nb, v);
         },
         kMaxMillisToWait, unused_alignment, num_bytes);
   }
+  if (memory_timeline_ != nullptr && r != nullptr) {
+    memory_timeline_->RecordAllocation(r, RoundedBytes(num_bytes));
+  }
+  return r;
 }
 
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
@@ -211,6 +305,9 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
     bool dump_log_on_failure = VLOG_IS_ON(2);
     void* result =
         AllocateRawInternal(unused_alignment, num_bytes, dump_log_on_failure);
+    if (memory_timeline_ != nullptr && result != nullptr) {
+      memory_timeline_->RecordAllocation(result, RoundedBytes(num_bytes));
+    }
     if (result == nullptr) {
       static std::atomic<int32> log_counter{0};
       int32 counter_value = log_counter.load(std::memory_order_relaxed);
@@ -251,12 +348,22 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  const bool cacheable = free_list_cache_enabled() &&
+                         rounded_bytes <= free_list_max_chunk_bytes_;
+  if (cacheable) {
+    void* ptr = AllocateFromFreeListCache(rounded_bytes, num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
   mutex_lock l(lock_);
   void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
   if (ptr != nullptr) {
+    if (cacheable) RecordLiveChunk(ptr);
     return ptr;
   }
 
@@ -264,6 +371,17 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   if (Extend(unused_alignment, rounded_bytes)) {
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
     if (ptr != nullptr) {
+      if (cacheable) RecordLiveChunk(ptr);
+      return ptr;
+    }
+  }
+
+  // Idle chunks in the free list cache may be enough to satisfy the request
+  // once they are coalesced back into the bins.
+  if (free_list_cache_enabled() && FlushFreeListCache()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
+    if (ptr != nullptr) {
+      if (cacheable) RecordLiveChunk(ptr);
       return ptr;
     }
   }
@@ -372,6 +490,9 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 }
 
 void BFCAllocator::DeallocateRaw(void* ptr) {
+  if (memory_timeline_ != nullptr && ptr != nullptr) {
+    memory_timeline_->RecordDeallocation(ptr);
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -381,6 +502,9 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     LOG(ERROR) << "tried to deallocate nullptr";
     return;
   }
+  if (free_list_cache_enabled() && DeallocateToFreeListCache(ptr)) {
+    return;
+  }
   mutex_lock l(lock_);
 
   // Find the chunk from the ptr.
@@ -522,6 +646,10 @@ void BFCAllocator::AddAllocVisitor(Visitor visitor) {
 bool BFCAllocator::TracksAllocationSizes() { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) {
+  LiveChunk live_chunk;
+  if (free_list_cache_enabled() && FindLiveChunk(ptr, &live_chunk)) {
+    return live_chunk.requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -531,6 +659,10 @@ size_t BFCAllocator::RequestedSize(const void* ptr) {
 }
 
 size_t BFCAllocator::AllocatedSize(const void* ptr) {
+  LiveChunk live_chunk;
+  if (free_list_cache_enabled() && FindLiveChunk(ptr, &live_chunk)) {
+    return live_chunk.size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -540,6 +672,10 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) {
 }
 
 int64 BFCAllocator::AllocationId(const void* ptr) {
+  LiveChunk live_chunk;
+  if (free_list_cache_enabled() && FindLiveChunk(ptr, &live_chunk)) {
+    return live_chunk.allocation_id;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -678,11 +814,39 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
   LOG(INFO) << "Sum Total of in-use chunks: "
             << strings::HumanReadableNumBytes(total_bytes);
   LOG(INFO) << "Stats: \n" << stats_.DebugString();
+  if (free_list_cache_enabled()) {
+    LOG(INFO) << "Free list cache: "
+              << strings::HumanReadableNumBytes(FreeListCachedBytes())
+              << " in idle cached chunks (counted as in use above)";
+  }
+  if (memory_timeline_ != nullptr) {
+    PeakMemoryBreakdown live;
+    memory_timeline_->GetLiveBreakdown(&live);
+    LOG(INFO) << "Live allocations by op: \n" << live.DebugString(20);
+  }
+}
+
+void BFCAllocator::EnableMemoryTimeline(size_t max_events) {
+  CHECK(memory_timeline_ == nullptr) << "Memory timeline already enabled";
+  mutex_lock l(lock_);
+  CHECK_EQ(stats_.num_allocs, 0)
+      << "EnableMemoryTimeline() must be called before the first allocation";
+  memory_timeline_.reset(new MemoryTimeline(max_events));
+}
+
+bool BFCAllocator::GetPeakMemoryBreakdown(int64 step_id,
+                                          PeakMemoryBreakdown* breakdown) {
+  return memory_timeline_ != nullptr &&
+         memory_timeline_->GetPeakBreakdown(step_id, breakdown);
 }
 
 void BFCAllocator::GetStats(AllocatorStats* stats) {
   mutex_lock l(lock_);
   *stats = stats_;
+  // Chunks idle in the free list cache are in use as far as the bins are
+  // concerned, but not from the client's point of view.
+  stats->bytes_in_use -= FreeListCachedBytes();
+  stats->num_allocs += free_list_num_allocs_.load(std::memory_order_relaxed);
 }
 
 void BFCAllocator::ClearStats() {
@@ -690,6 +854,159 @@ void BFCAllocator::ClearStats() {
   stats_.num_allocs = 0;
   stats_.max_bytes_in_use = stats_.bytes_in_use;
   stats_.max_alloc_size = 0;
+  free_list_num_allocs_ = 0;
+}
+
+void BFCAllocator::EnableFreeListCache(size_t max_chunk_bytes,
+                                       size_t max_cached_bytes_per_shard) {
+  CHECK(!free_list_cache_enabled()) << "Free list cache already enabled";
+  mutex_lock l(lock_);
+  CHECK_EQ(stats_.num_allocs, 0)
+      << "EnableFreeListCache() must be called before the first allocation";
+  free_list_max_chunk_bytes_ =
+      (max_chunk_bytes / kMinAllocationSize) * kMinAllocationSize;
+  if (free_list_max_chunk_bytes_ == 0) return;
+  free_list_max_shard_bytes_ = max_cached_bytes_per_shard;
+  const size_t num_size_classes =
+      free_list_max_chunk_bytes_ / kMinAllocationSize;
+  live_chunk_shards_.reset(new LiveChunkShard[kNumFreeListShards]);
+  free_list_shards_.reset(new FreeListShard[kNumFreeListShards]);
+  for (int i = 0; i < kNumFreeListShards; ++i) {
+    mutex_lock shard_lock(free_list_shards_[i].mu);
+    free_list_shards_[i].lists.resize(num_size_classes);
+  }
+  VLOG(1) << "Free list cache for " << Name() << " holds chunks up to "
+          << strings::HumanReadableNumBytes(free_list_max_chunk_bytes_);
+}
+
+BFCAllocator::FreeListShard* BFCAllocator::FreeListShardForCurrentThread() {
+  const size_t h = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return &free_list_shards_[h % kNumFreeListShards];
+}
+
+BFCAllocator::LiveChunkShard* BFCAllocator::LiveChunkShardFor(
+    const void* ptr) {
+  // Chunk addresses are multiples of kMinAllocationSize.
+  const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(ptr);
+  return &live_chunk_shards_[(p >> kMinAllocationBits) % kNumFreeListShards];
+}
+
+void* BFCAllocator::AllocateFromFreeListCache(size_t rounded_bytes,
+                                              size_t num_bytes) {
+  void* ptr = nullptr;
+  {
+    FreeListShard* shard = FreeListShardForCurrentThread();
+    mutex_lock l(shard->mu);
+    std::vector<void*>& list =
+        shard->lists[rounded_bytes / kMinAllocationSize - 1];
+    if (list.empty()) return nullptr;
+    ptr = list.back();
+    list.pop_back();
+    shard->cached_bytes -= rounded_bytes;
+  }
+  free_list_cached_bytes_.fetch_sub(rounded_bytes, std::memory_order_relaxed);
+  free_list_num_allocs_.fetch_add(1, std::memory_order_relaxed);
+
+  LiveChunk live_chunk;
+  live_chunk.size = rounded_bytes;
+  live_chunk.requested_size = num_bytes;
+  live_chunk.allocation_id = next_allocation_id_++;
+  LiveChunkShard* live_shard = LiveChunkShardFor(ptr);
+  mutex_lock l(live_shard->mu);
+  live_shard->chunks[ptr] = live_chunk;
+  return ptr;
+}
+
+void BFCAllocator::RecordLiveChunk(void* ptr) {
+  const Chunk* c = ChunkFromHandle(region_manager_.get_handle(ptr));
+  if (c->size > free_list_max_chunk_bytes_) {
+    // Kept whole to avoid fragmentation; not cacheable.
+    return;
+  }
+  LiveChunk live_chunk;
+  live_chunk.size = c->size;
+  live_chunk.requested_size = c->requested_size;
+  live_chunk.allocation_id = c->allocation_id;
+  LiveChunkShard* live_shard = LiveChunkShardFor(ptr);
+  mutex_lock l(live_shard->mu);
+  live_shard->chunks[ptr] = live_chunk;
+}
+
+bool BFCAllocator::FindLiveChunk(const void* ptr, LiveChunk* chunk) {
+  LiveChunkShard* live_shard = LiveChunkShardFor(ptr);
+  mutex_lock l(live_shard->mu);
+  auto it = live_shard->chunks.find(ptr);
+  if (it == live_shard->chunks.end()) return false;
+  *chunk = it->second;
+  return true;
+}
+
+bool BFCAllocator::DeallocateToFreeListCache(void* ptr) {
+  size_t size;
+  {
+    LiveChunkShard* live_shard = LiveChunkShardFor(ptr);
+    mutex_lock l(live_shard->mu);
+    auto it = live_shard->chunks.find(ptr);
+    if (it == live_shard->chunks.end()) return false;
+    size = it->second.size;
+    live_shard->chunks.erase(it);
+  }
+
+  std::vector<void*> to_release;
+  {
+    FreeListShard* shard = FreeListShardForCurrentThread();
+    mutex_lock l(shard->mu);
+    shard->lists[size / kMinAllocationSize - 1].push_back(ptr);
+    shard->cached_bytes += size;
+    free_list_cached_bytes_.fetch_add(size, std::memory_order_relaxed);
+    if (shard->cached_bytes > free_list_max_shard_bytes_) {
+      // Over budget: hand the oldest half of each size class back to the
+      // bins, so that one lock_ acquisition is amortized over many chunks.
+      for (size_t i = 0; i < shard->lists.size(); ++i) {
+        std::vector<void*>& list = shard->lists[i];
+        const size_t num_release = (list.size() + 1) / 2;
+        if (num_release == 0) continue;
+        to_release.insert(to_release.end(), list.begin(),
+                          list.begin() + num_release);
+        list.erase(list.begin(), list.begin() + num_release);
+        const size_t released_bytes =
+            num_release * (i + 1) * kMinAllocationSize;
+        shard->cached_bytes -= released_bytes;
+        free_list_cached_bytes_.fetch_sub(released_bytes,
+                                          std::memory_order_relaxed);
+      }
+    }
+  }
+  if (!to_release.empty()) {
+    mutex_lock l(lock_);
+    ReleaseCachedChunks(to_release);
+  }
+  return true;
+}
+
+void BFCAllocator::ReleaseCachedChunks(const std::vector<void*>& ptrs) {
+  for (void* ptr : ptrs) {
+    BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
+    CHECK(h != kInvalidChunkHandle);
+    FreeAndMaybeCoalesce(h);
+  }
+}
+
+bool BFCAllocator::FlushFreeListCache() {
+  std::vector<void*> to_release;
+  for (int i = 0; i < kNumFreeListShards; ++i) {
+    FreeListShard* shard = &free_list_shards_[i];
+    mutex_lock l(shard->mu);
+    for (std::vector<void*>& list : shard->lists) {
+      to_release.insert(to_release.end(), list.begin(), list.end());
+      list.clear();
+    }
+    free_list_cached_bytes_.fetch_sub(shard->cached_bytes,
+                                      std::memory_order_relaxed);
+    shard->cached_bytes = 0;
+  }
+  ReleaseCachedChunks(to_release);
+  return !to_release.empty();
 }
 
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/allocator_retry.h"
+#include "tensorflow/core/common_runtime/memory_timeline.h"
 #include "tensorflow/core/common_runtime/visitable_allocator.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -72,6 +74,38 @@ class BFCAllocator : public VisitableAllocator {
 
   void ClearStats() override;
 
+  // Enables a cache of small free chunks in front of the bins. The cache is
+  // sharded by calling thread, so that hot allocation sizes are recycled
+  // without taking the allocator-wide lock. Chunks of at most
+  // 'max_chunk_bytes' are cached, up to 'max_cached_bytes_per_shard' bytes
+  // per shard; beyond that, half of a shard is returned to the bins in a
+  // single batch. Must be called before the first allocation.
+  //
+  // Cached chunks are also enabled for every BFCAllocator with
+  // TF_BFC_FREE_LIST_MAX_CHUNK_BYTES=<bytes>.
+  void EnableFreeListCache(size_t max_chunk_bytes,
+                           size_t max_cached_bytes_per_shard);
+
+  // Returns the number of bytes currently held by the free list cache. These
+  // bytes are not counted as in use by GetStats().
+  int64 FreeListCachedBytes() const {
+    return free_list_cached_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Enables a timeline of the last 'max_events' allocations and
+  // deallocations, attributed to the ops that make them, from which the
+  // memory in use at the peak of a step is broken down by op and
+  // allocation. Must be called before the first allocation.
+  //
+  // The timeline is also enabled for every BFCAllocator with
+  // TF_BFC_MEMORY_TIMELINE_EVENTS=<max_events>.
+  void EnableMemoryTimeline(size_t max_events);
+
+  // Fills in '*breakdown' with the allocations that were live at the peak of
+  // step 'step_id'. Returns false if the timeline is not enabled or has no
+  // events left of the step.
+  bool GetPeakMemoryBreakdown(int64 step_id, PeakMemoryBreakdown* breakdown);
+
  private:
   struct Bin;
 
@@ -348,6 +382,63 @@ class BFCAllocator : public VisitableAllocator {
 
   Chunk* ChunkFromHandle(ChunkHandle h) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Free list cache (see EnableFreeListCache()).
+  static const int kNumFreeListShards = 16;
+
+  // A small chunk handed out to a client while the free list cache is
+  // enabled. Tracked outside of lock_ so that DeallocateRaw() can tell
+  // whether (and into which size class) a pointer may be cached.
+  struct LiveChunk {
+    size_t size = 0;
+    size_t requested_size = 0;
+    int64 allocation_id = -1;
+  };
+
+  struct LiveChunkShard {
+    mutex mu;
+    std::unordered_map<const void*, LiveChunk> chunks GUARDED_BY(mu);
+  };
+
+  // lists[i] holds idle chunks of exactly (i + 1) * kMinAllocationSize
+  // bytes, which the BFC bins still consider in use.
+  struct FreeListShard {
+    mutex mu;
+    std::vector<std::vector<void*>> lists GUARDED_BY(mu);
+    size_t cached_bytes GUARDED_BY(mu) = 0;
+  };
+
+  bool free_list_cache_enabled() const { return free_list_shards_ != nullptr; }
+  FreeListShard* FreeListShardForCurrentThread();
+  LiveChunkShard* LiveChunkShardFor(const void* ptr);
+
+  // Returns a cached chunk of exactly 'rounded_bytes', or nullptr.
+  void* AllocateFromFreeListCache(size_t rounded_bytes, size_t num_bytes);
+
+  // Records 'ptr', just returned by FindChunkPtr(), as a live small chunk.
+  void RecordLiveChunk(void* ptr) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns true and fills in '*chunk' if 'ptr' is a live small chunk.
+  bool FindLiveChunk(const void* ptr, LiveChunk* chunk);
+
+  // Moves 'ptr' into the free list cache if it is a live small chunk.
+  // Returns false if the caller must free it through the bins.
+  bool DeallocateToFreeListCache(void* ptr);
+
+  // Returns cached chunks to the bins.
+  void ReleaseCachedChunks(const std::vector<void*>& ptrs)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns every cached chunk to the bins. Returns true if any was cached.
+  bool FlushFreeListCache() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  size_t free_list_max_chunk_bytes_ = 0;
+  size_t free_list_max_shard_bytes_ = 0;
+  std::unique_ptr<FreeListShard[]> free_list_shards_;
+  std::unique_ptr<LiveChunkShard[]> live_chunk_shards_;
+  std::atomic<int64> free_list_cached_bytes_{0};
+  // Allocations served by the free list cache since the last ClearStats().
+  std::atomic<int64> free_list_num_allocs_{0};
+
   // Information about a Bin that is useful for debugging.
   struct BinDebugInfo {
     size_t total_bytes_in_use = 0;
@@ -430,8 +521,12 @@ class BFCAllocator : public VisitableAllocator {
   std::vector<Visitor> region_visitors_ GUARDED_BY(lock_);
 
   // Counter containing the next unique identifier to assign to a
-  // newly-created chunk.
-  int64 next_allocation_id_ GUARDED_BY(lock_);
+  // newly-created chunk. Atomic because the free list cache assigns ids
+  // without holding lock_.
+  std::atomic<int64> next_allocation_id_;
+
+  // Set by EnableMemoryTimeline(), or nullptr.
+  std::unique_ptr<MemoryTimeline> memory_timeline_;
 
   // Stats.
   AllocatorStats stats_ GUARDED_BY(lock_);
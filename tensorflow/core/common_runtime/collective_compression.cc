@@ -0,0 +1,148 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+ChunkCodec::ChunkCodec(CollectiveCompression compression, float top_k_fraction)
+    : compression_(compression), top_k_fraction_(top_k_fraction) {
+  CHECK_NE(compression_, NO_COMPRESSION);
+}
+
+/*static*/
+bool ChunkCodec::IsApplicable(const CollectiveParams& col_params) {
+  return col_params.instance.compression != NO_COMPRESSION &&
+         col_params.instance.data_type == DT_FLOAT &&
+         col_params.group.device_type == DEVICE_CPU && col_params.merge_op &&
+         col_params.merge_op->type_string() == "Add";
+}
+
+int64 ChunkCodec::TopKCount(int64 num_elements) const {
+  const int64 k = static_cast<int64>(
+      std::ceil(static_cast<double>(top_k_fraction_) * num_elements));
+  return std::min(std::max<int64>(k, 1), num_elements);
+}
+
+Tensor ChunkCodec::AllocateEncoded(Allocator* a, int64 num_elements) const {
+  if (compression_ == FP16_COMPRESSION) {
+    return Tensor(a, DT_HALF, TensorShape({num_elements}));
+  }
+  // One int32 index and one float, stored as an int32, per value.
+  return Tensor(a, DT_INT32, TensorShape({2 * TopKCount(num_elements)}));
+}
+
+void ChunkCodec::Encode(const Tensor& chunk, Tensor* residual,
+                        Tensor* encoded) const {
+  const int64 n = chunk.NumElements();
+  auto src = chunk.flat<float>();
+  if (compression_ == FP16_COMPRESSION) {
+    auto dst = encoded->flat<Eigen::half>();
+    if (residual == nullptr) {
+      dst = src.cast<Eigen::half>();
+      return;
+    }
+    auto res = residual->flat<float>();
+    for (int64 i = 0; i < n; ++i) {
+      const float v = src(i) + res(i);
+      dst(i) = static_cast<Eigen::half>(v);
+      res(i) = v - static_cast<float>(dst(i));
+    }
+    return;
+  }
+  std::vector<float> values(n);
+  for (int64 i = 0; i < n; ++i) {
+    values[i] = src(i) + (residual ? residual->flat<float>()(i) : 0.0f);
+  }
+  const int64 k = TopKCount(n);
+  std::vector<int32> indices(n);
+  std::iota(indices.begin(), indices.end(), 0);
+  std::nth_element(indices.begin(), indices.begin() + (k - 1), indices.end(),
+                   [&values](int32 a, int32 b) {
+                     return std::abs(values[a]) > std::abs(values[b]);
+                   });
+  int32* dst = encoded->flat<int32>().data();
+  float* dst_values = reinterpret_cast<float*>(dst + k);
+  for (int64 j = 0; j < k; ++j) {
+    dst[j] = indices[j];
+    dst_values[j] = values[indices[j]];
+  }
+  if (residual != nullptr) {
+    auto res = residual->flat<float>();
+    for (int64 i = 0; i < n; ++i) res(i) = values[i];
+    for (int64 j = 0; j < k; ++j) res(indices[j]) = 0;
+  }
+}
+
+Status ChunkCodec::Decode(const Tensor& encoded, Tensor* chunk) const {
+  const int64 n = chunk->NumElements();
+  auto dst = chunk->flat<float>();
+  if (compression_ == FP16_COMPRESSION) {
+    if (encoded.dtype() != DT_HALF || encoded.NumElements() != n) {
+      return errors::Internal("Expected ", n, " half values to decode, got ",
+                              encoded.DebugString());
+    }
+    dst = encoded.flat<Eigen::half>().cast<float>();
+    return Status::OK();
+  }
+  const int64 k = TopKCount(n);
+  if (encoded.dtype() != DT_INT32 || encoded.NumElements() != 2 * k) {
+    return errors::Internal("Expected ", k,
+                            " (index, value) pairs to decode, got ",
+                            encoded.DebugString());
+  }
+  // The indices come from a peer, so check them before writing.
+  const int32* src = encoded.flat<int32>().data();
+  for (int64 j = 0; j < k; ++j) {
+    if (src[j] < 0 || src[j] >= n) {
+      return errors::Internal("Decoded index ", src[j],
+                              " is out of range for a chunk of ", n,
+                              " elements");
+    }
+  }
+  const float* src_values = reinterpret_cast<const float*>(src + k);
+  dst.setZero();
+  for (int64 j = 0; j < k; ++j) {
+    dst(src[j]) = src_values[j];
+  }
+  return Status::OK();
+}
+
+/*static*/
+Tensor* ChunkCodec::Residual(const string& key, int64 num_elements) {
+  static mutex mu(LINKER_INITIALIZED);
+  static std::unordered_map<string, Tensor>* residuals =
+      new std::unordered_map<string, Tensor>;
+  mutex_lock l(mu);
+  Tensor* t = &(*residuals)[key];
+  if (t->NumElements() != num_elements || !t->IsInitialized()) {
+    *t = Tensor(DT_FLOAT, TensorShape({num_elements}));
+    t->flat<float>().setZero();
+  }
+  return t;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,75 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Encodes and decodes the chunks of a reduction sent between peers, per a
+// CollectiveCompression.
+//
+// FP16_COMPRESSION sends each value as a float16. TOP_K_COMPRESSION sends
+// the ceil(top_k_fraction * n) values of largest magnitude of an n value
+// chunk, as (index, value) pairs; the others decode as 0.
+//
+// Only DT_FLOAT chunks in host memory are supported, see IsApplicable().
+class ChunkCodec {
+ public:
+  ChunkCodec(CollectiveCompression compression, float top_k_fraction);
+
+  // Returns true if the reduction described by 'col_params' asks for
+  // compression and can use it: the values must be DT_FLOAT on a CPU
+  // device, and the merge_op must be Add, since values left out by
+  // TOP_K_COMPRESSION decode as 0.
+  static bool IsApplicable(const CollectiveParams& col_params);
+
+  CollectiveCompression compression() const { return compression_; }
+
+  // Returns an uninitialized tensor that can hold the encoding of a chunk
+  // of 'num_elements' values.
+  Tensor AllocateEncoded(Allocator* a, int64 num_elements) const;
+
+  // Encodes 'chunk' into 'encoded', which was returned by
+  // AllocateEncoded(). If 'residual' is not null, its values are added to
+  // those of 'chunk' first, and it is then set to whatever the encoding
+  // left out of the sum.
+  void Encode(const Tensor& chunk, Tensor* residual, Tensor* encoded) const;
+
+  // Decodes 'encoded' into 'chunk', which must have the number of elements
+  // it was encoded from. Returns an Internal error if 'encoded', which may
+  // come from a peer, does not fit 'chunk'.
+  Status Decode(const Tensor& encoded, Tensor* chunk) const;
+
+  // Returns the residual tensor of 'num_elements' values stored under
+  // 'key', creating it zero-filled at first use. Residuals live for the
+  // life of the process, so that what an execution of a collective
+  // instance leaves out is sent by the next one. Callers must not use
+  // the same key concurrently.
+  static Tensor* Residual(const string& key, int64 num_elements);
+
+ private:
+  int64 TopKCount(int64 num_elements) const;
+
+  const CollectiveCompression compression_;
+  const float top_k_fraction_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
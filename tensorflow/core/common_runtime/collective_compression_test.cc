@@ -0,0 +1,107 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_compression.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ChunkCodecTest, Fp16RoundTrip) {
+  ChunkCodec codec(FP16_COMPRESSION, 0);
+  Tensor chunk = test::AsTensor<float>({1.0f, -2.5f, 0.125f, 1024.0f});
+  Tensor encoded = codec.AllocateEncoded(cpu_allocator(), 4);
+  EXPECT_EQ(DT_HALF, encoded.dtype());
+  EXPECT_EQ(4, encoded.NumElements());
+  codec.Encode(chunk, nullptr, &encoded);
+  Tensor decoded(DT_FLOAT, TensorShape({4}));
+  TF_ASSERT_OK(codec.Decode(encoded, &decoded));
+  test::ExpectTensorEqual<float>(chunk, decoded);
+}
+
+TEST(ChunkCodecTest, TopKSendsLargestMagnitudes) {
+  ChunkCodec codec(TOP_K_COMPRESSION, 0.5);
+  Tensor chunk = test::AsTensor<float>({1.0f, -5.0f, 3.0f, 0.5f});
+  Tensor encoded = codec.AllocateEncoded(cpu_allocator(), 4);
+  EXPECT_EQ(4, encoded.NumElements());  // 2 (index, value) pairs
+  codec.Encode(chunk, nullptr, &encoded);
+  Tensor decoded(DT_FLOAT, TensorShape({4}));
+  TF_ASSERT_OK(codec.Decode(encoded, &decoded));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0.0f, -5.0f, 3.0f, 0.0f}), decoded);
+}
+
+TEST(ChunkCodecTest, TopKSendsAtLeastOneValue) {
+  ChunkCodec codec(TOP_K_COMPRESSION, 0.001);
+  Tensor encoded = codec.AllocateEncoded(cpu_allocator(), 10);
+  EXPECT_EQ(2, encoded.NumElements());
+}
+
+TEST(ChunkCodecTest, TopKFeedsBackResidual) {
+  ChunkCodec codec(TOP_K_COMPRESSION, 0.5);
+  Tensor* residual = ChunkCodec::Residual("test_residual", 4);
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({0, 0, 0, 0}),
+                                 *residual);
+  Tensor encoded = codec.AllocateEncoded(cpu_allocator(), 4);
+  Tensor decoded(DT_FLOAT, TensorShape({4}));
+  codec.Encode(test::AsTensor<float>({1.0f, -5.0f, 3.0f, 0.5f}), residual,
+               &encoded);
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({1.0f, 0.0f, 0.0f, 0.5f}), *residual);
+
+  // The next chunk on the same key picks up what was left out.
+  EXPECT_EQ(residual, ChunkCodec::Residual("test_residual", 4));
+  codec.Encode(test::AsTensor<float>({0.0f, 0.0f, 0.25f, 0.0f}), residual,
+               &encoded);
+  TF_ASSERT_OK(codec.Decode(encoded, &decoded));
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({1.0f, 0.0f, 0.0f, 0.5f}), decoded);
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0.0f, 0.0f, 0.25f, 0.0f}), *residual);
+}
+
+TEST(ChunkCodecTest, DecodeRejectsMalformedInput) {
+  Tensor decoded(DT_FLOAT, TensorShape({4}));
+  ChunkCodec top_k(TOP_K_COMPRESSION, 0.5);
+  // The indices of the 2 (index, value) pairs are out of range.
+  EXPECT_TRUE(errors::IsInternal(
+      top_k.Decode(test::AsTensor<int32>({1, 4, 0, 0}), &decoded)));
+  EXPECT_TRUE(errors::IsInternal(
+      top_k.Decode(test::AsTensor<int32>({-1, 2, 0, 0}), &decoded)));
+  // Too few pairs.
+  EXPECT_TRUE(errors::IsInternal(
+      top_k.Decode(test::AsTensor<int32>({1, 0}), &decoded)));
+  TF_EXPECT_OK(top_k.Decode(test::AsTensor<int32>({3, 0, 0, 0}), &decoded));
+
+  ChunkCodec fp16(FP16_COMPRESSION, 0);
+  EXPECT_TRUE(errors::IsInternal(
+      fp16.Decode(Tensor(DT_HALF, TensorShape({3})), &decoded)));
+}
+
+TEST(ChunkCodecTest, NotApplicableWithoutCompressionOrMergeOp) {
+  CollectiveParams cp;
+  cp.instance.data_type = DT_FLOAT;
+  cp.group.device_type = DEVICE_CPU;
+  EXPECT_FALSE(ChunkCodec::IsApplicable(cp));
+  cp.instance.compression = FP16_COMPRESSION;
+  // No merge_op.
+  EXPECT_FALSE(ChunkCodec::IsApplicable(cp));
+}
+
+}  // namespace
+}  // namespace tensorflow
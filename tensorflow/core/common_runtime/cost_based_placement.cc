@@ -0,0 +1,354 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/cost_based_placement.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Assumed bandwidth of copies between two devices of a task, in bytes per
+// nanosecond (i.e. GB/s). This is roughly a PCIe 3.0 x16 link.
+constexpr double kInterconnectBytesPerNs = 12.0;
+
+// A device may be loaded up to this fraction above the average load of its
+// group by the cut refinement.
+constexpr double kImbalanceSlack = 0.1;
+
+// Maximum number of cut refinement sweeps over the graph.
+constexpr int kMaxRefinementPasses = 4;
+
+int64 TensorBytes(const OpInfo::TensorProperties& tensor) {
+  const int dtype_size = DataTypeSize(BaseType(tensor.dtype()));
+  if (dtype_size <= 0) return 0;
+  int64 num_elements = 1;
+  if (!tensor.shape().unknown_rank()) {
+    for (const auto& dim : tensor.shape().dim()) {
+      // Unknown dimensions count as 1.
+      num_elements *= std::max<int64>(1, dim.size());
+    }
+  }
+  return num_elements * dtype_size;
+}
+
+int64 TransferNs(int64 bytes) {
+  return static_cast<int64>(bytes / kInterconnectBytesPerNs);
+}
+
+DeviceProperties NominalDeviceProperties() {
+  DeviceProperties properties;
+  properties.set_type("CPU");
+  properties.set_num_cores(1);
+  properties.set_frequency(1000);
+  return properties;
+}
+
+// Returns the properties to give the cost estimator for 'device'. Costs are
+// only compared between devices of the same type, so devices the estimator
+// knows nothing about (including GPUs when not built with CUDA) get a
+// nominal description instead.
+DeviceProperties CostModelDeviceProperties(const Device* device) {
+  DeviceProperties properties = grappler::GetDeviceInfo(device->parsed_name());
+  const bool known =
+      properties.type() == "CPU" ||
+      (properties.type() == "GPU" &&
+       properties.environment().count("architecture") > 0);
+  if (!known || properties.frequency() <= 0 || properties.num_cores() <= 0) {
+    return NominalDeviceProperties();
+  }
+  return properties;
+}
+
+// Returns true if the placement of 'node' is not constrained beyond its
+// device type.
+bool IsMovable(const Node* node,
+               const std::unordered_set<string>& colocation_targets) {
+  if (!node->IsOp() || node->IsControlFlow() || node->op_def().is_stateful()) {
+    return false;
+  }
+  if (node->attrs().Find(kColocationAttrName) != nullptr ||
+      colocation_targets.count(node->name()) > 0) {
+    return false;
+  }
+  DeviceNameUtils::ParsedName requested;
+  if (!node->requested_device().empty() &&
+      (!DeviceNameUtils::ParseFullName(node->requested_device(), &requested) ||
+       requested.has_id)) {
+    return false;
+  }
+  for (DataType dtype : node->input_types()) {
+    if (IsRefType(dtype) || dtype == DT_RESOURCE) return false;
+  }
+  for (DataType dtype : node->output_types()) {
+    if (IsRefType(dtype) || dtype == DT_RESOURCE) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+Status CostBasedPlacement(const DeviceSet& devices, Graph* graph) {
+  // Group the devices by task and type. Only groups with more than one
+  // device leave anything to decide.
+  std::unordered_map<string, int> group_index;
+  std::vector<std::vector<int>> groups;
+  std::vector<Device*> group_devices;
+  std::vector<int> group_of_device;
+  for (Device* device : devices.devices()) {
+    const DeviceNameUtils::ParsedName& name = device->parsed_name();
+    const string key = strings::StrCat(name.job, "/", name.replica, "/",
+                                       name.task, "/", device->device_type());
+    auto it = group_index.emplace(key, groups.size()).first;
+    if (it->second == groups.size()) groups.emplace_back();
+    groups[it->second].push_back(group_devices.size());
+    group_of_device.push_back(it->second);
+    group_devices.push_back(device);
+  }
+  std::unordered_map<string, int> device_index;
+  for (int i = 0; i < group_devices.size(); ++i) {
+    if (groups[group_of_device[i]].size() > 1) {
+      device_index[group_devices[i]->name()] = i;
+    }
+  }
+  if (device_index.empty()) return Status::OK();
+
+  std::unordered_set<string> colocation_targets;
+  for (const Node* node : graph->op_nodes()) {
+    std::vector<string> classes;
+    if (!GetNodeAttr(node->attrs(), kColocationAttrName, &classes).ok()) {
+      continue;
+    }
+    for (const string& c : classes) {
+      StringPiece target(c);
+      if (str_util::ConsumePrefix(&target, kColocationGroupPrefix)) {
+        colocation_targets.insert(target.ToString());
+      }
+    }
+  }
+
+  // -1 for nodes not on a device of a multi-device group.
+  std::vector<int> assignment(graph->num_node_ids(), -1);
+  std::vector<bool> movable(graph->num_node_ids(), false);
+  bool any_movable = false;
+  for (Node* node : graph->op_nodes()) {
+    auto it = device_index.find(node->assigned_device_name());
+    if (it == device_index.end()) continue;
+    assignment[node->id()] = it->second;
+    movable[node->id()] = IsMovable(node, colocation_targets);
+    any_movable |= movable[node->id()];
+  }
+  if (!any_movable) return Status::OK();
+
+  grappler::GrapplerItem item;
+  item.id = "cost_based_placement";
+  graph->ToGraphDef(&item.graph);
+  grappler::GraphProperties properties(item);
+  Status s = properties.InferStatically(false);
+  if (!s.ok()) {
+    VLOG(1) << "Skipping cost based placement: " << s;
+    return Status::OK();
+  }
+
+  std::vector<DeviceProperties> device_properties;
+  for (const Device* device : group_devices) {
+    device_properties.push_back(CostModelDeviceProperties(device));
+  }
+  const DeviceProperties default_properties = NominalDeviceProperties();
+
+  // The predicted execution time of each node, and the bytes of each data
+  // edge.
+  grappler::OpLevelCostEstimator estimator;
+  std::vector<int64> cost_ns(graph->num_node_ids(), 0);
+  std::vector<int64> edge_bytes(graph->num_edge_ids(), 0);
+  for (Node* node : graph->op_nodes()) {
+    if (!properties.HasInputProperties(node->name()) ||
+        !properties.HasOutputProperties(node->name())) {
+      continue;
+    }
+    const auto& outputs = properties.GetOutputProperties(node->name());
+    grappler::OpContext op_context;
+    op_context.name = node->name();
+    op_context.device_name = node->assigned_device_name();
+    op_context.op_info.set_op(node->type_string());
+    *op_context.op_info.mutable_attr() = node->def().attr();
+    for (const auto& input : properties.GetInputProperties(node->name())) {
+      *op_context.op_info.add_inputs() = input;
+    }
+    for (const auto& output : outputs) {
+      *op_context.op_info.add_outputs() = output;
+    }
+    const int device = assignment[node->id()];
+    *op_context.op_info.mutable_device() =
+        device >= 0 ? device_properties[device] : default_properties;
+    cost_ns[node->id()] =
+        std::max<int64>(0, estimator.PredictCosts(op_context)
+                               .execution_time.count());
+    for (const Edge* edge : node->out_edges()) {
+      if (!edge->IsControlEdge() && edge->src_output() < outputs.size()) {
+        edge_bytes[edge->id()] = TensorBytes(outputs[edge->src_output()]);
+      }
+    }
+  }
+
+  // List-schedules the graph: each movable node goes to the device of its
+  // group on which it finishes first, given when the device becomes free
+  // and when its inputs can arrive there.
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  std::vector<int64> device_ready(group_devices.size(), 0);
+  std::vector<int64> finish(graph->num_node_ids(), 0);
+  for (Node* node : order) {
+    auto finish_on = [&](int device) {
+      int64 start = device >= 0 ? device_ready[device] : 0;
+      for (const Edge* edge : node->in_edges()) {
+        int64 ready = finish[edge->src()->id()];
+        if (!edge->IsControlEdge() && assignment[edge->src()->id()] != device) {
+          ready += TransferNs(edge_bytes[edge->id()]);
+        }
+        start = std::max(start, ready);
+      }
+      return start + cost_ns[node->id()];
+    };
+    int best = assignment[node->id()];
+    int64 best_finish = finish_on(best);
+    if (movable[node->id()]) {
+      for (int device : groups[group_of_device[best]]) {
+        const int64 f = finish_on(device);
+        if (f < best_finish) {
+          best = device;
+          best_finish = f;
+        }
+      }
+      assignment[node->id()] = best;
+    }
+    finish[node->id()] = best_finish;
+    if (best >= 0) device_ready[best] = best_finish;
+  }
+
+  // Moves nodes to the device holding most of their neighbours' bytes, as
+  // long as that device's load stays within kImbalanceSlack of the average
+  // load of its group.
+  std::vector<int64> load(group_devices.size(), 0);
+  for (Node* node : graph->op_nodes()) {
+    if (assignment[node->id()] >= 0) {
+      load[assignment[node->id()]] += cost_ns[node->id()];
+    }
+  }
+  std::vector<int64> load_limit(groups.size(), 0);
+  for (int g = 0; g < groups.size(); ++g) {
+    int64 total = 0;
+    for (int device : groups[g]) total += load[device];
+    load_limit[g] = static_cast<int64>((1.0 + kImbalanceSlack) * total /
+                                       groups[g].size());
+  }
+  std::vector<int64> neighbour_bytes(group_devices.size(), 0);
+  for (int pass = 0; pass < kMaxRefinementPasses; ++pass) {
+    bool moved = false;
+    for (Node* node : order) {
+      if (!movable[node->id()]) continue;
+      const int current = assignment[node->id()];
+      const std::vector<int>& group = groups[group_of_device[current]];
+      for (int device : group) neighbour_bytes[device] = 0;
+      auto add_bytes = [&](const Edge* edge, const Node* neighbour) {
+        const int device = assignment[neighbour->id()];
+        if (!edge->IsControlEdge() && device >= 0 &&
+            group_of_device[device] == group_of_device[current]) {
+          neighbour_bytes[device] += edge_bytes[edge->id()];
+        }
+      };
+      for (const Edge* edge : node->in_edges()) add_bytes(edge, edge->src());
+      for (const Edge* edge : node->out_edges()) add_bytes(edge, edge->dst());
+      int best = current;
+      for (int device : group) {
+        if (neighbour_bytes[device] > neighbour_bytes[best] &&
+            load[device] + cost_ns[node->id()] <=
+                load_limit[group_of_device[device]]) {
+          best = device;
+        }
+      }
+      if (best != current) {
+        load[current] -= cost_ns[node->id()];
+        load[best] += cost_ns[node->id()];
+        assignment[node->id()] = best;
+        moved = true;
+      }
+    }
+    if (!moved) break;
+  }
+
+  int num_moved = 0;
+  for (Node* node : graph->op_nodes()) {
+    if (!movable[node->id()]) continue;
+    const string& name = group_devices[assignment[node->id()]]->name();
+    if (name != node->assigned_device_name()) {
+      VLOG(2) << "Moving " << node->name() << " from "
+              << node->assigned_device_name() << " to " << name;
+      node->set_assigned_device_name(name);
+      ++num_moved;
+    }
+  }
+  VLOG(1) << "Cost based placement moved " << num_moved << " nodes";
+  return Status::OK();
+}
+
+namespace {
+
+// Runs CostBasedPlacement() if enabled in the session's
+// ConfigProto.Experimental.
+class CostBasedPlacementPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.session_options == nullptr ||
+        !options.session_options->config.experimental()
+             .cost_based_placement() ||
+        options.graph == nullptr || options.device_set == nullptr) {
+      return Status::OK();
+    }
+    Graph* graph = options.graph->get();
+    if (graph == nullptr) {
+      return errors::Internal(
+          "Cost based placement should happen before partitioning and a "
+          "graph should be available.");
+    }
+    return CostBasedPlacement(*options.device_set, graph);
+  }
+};
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_PLACEMENT, 0,
+                      CostBasedPlacementPass);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,47 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COST_BASED_PLACEMENT_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COST_BASED_PLACEMENT_H_
+
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Refines the device assignment made by the Placer using op costs predicted
+// by the grappler OpLevelCostEstimator.
+//
+// The Placer assigns every unconstrained node of a given device type to the
+// first device of that type, so e.g. independent towers of a model all end up
+// on GPU:0. This function spreads such nodes over the devices of the same
+// type in the same task: it list-schedules the graph in topological order,
+// putting each node on the device where it would finish earliest (accounting
+// for the time to copy its inputs from other devices), and then moves nodes
+// to the device holding most of their neighbours' data as long as that
+// device's predicted load stays within a small slack of the average. This
+// reduces the number of bytes sent between devices without giving up the
+// balance.
+//
+// Only nodes the Placer was free to place are moved: nodes with a fully
+// specified requested device, colocation constraints, reference or resource
+// edges, stateful ops and control flow ops keep their device. If the shapes
+// of the graph cannot be inferred, the placement is left unchanged.
+Status CostBasedPlacement(const DeviceSet& devices, Graph* graph);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COST_BASED_PLACEMENT_H_
@@ -0,0 +1,156 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/cost_based_placement.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FakeDevice : public Device {
+ public:
+  explicit FakeDevice(const DeviceAttributes& device_attributes)
+      : Device(nullptr, device_attributes) {}
+
+  Status Sync() override { return errors::Unimplemented("FakeDevice::Sync()"); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override { return nullptr; }
+
+  static std::unique_ptr<Device> Make(const string& name, const string& type) {
+    DeviceAttributes device_attributes;
+    device_attributes.set_name(name);
+    device_attributes.set_device_type(type);
+    return std::unique_ptr<Device>(new FakeDevice(device_attributes));
+  }
+};
+
+const char* const kCPU = "/job:a/replica:0/task:0/device:CPU:0";
+const char* const kGPU0 = "/job:a/replica:0/task:0/device:GPU:0";
+const char* const kGPU1 = "/job:a/replica:0/task:0/device:GPU:1";
+
+class CostBasedPlacementTest : public ::testing::Test {
+ protected:
+  CostBasedPlacementTest() {
+    devices_.push_back(FakeDevice::Make(kCPU, "CPU"));
+    devices_.push_back(FakeDevice::Make(kGPU0, "GPU"));
+    devices_.push_back(FakeDevice::Make(kGPU1, "GPU"));
+    for (const auto& device : devices_) {
+      device_set_.AddDevice(device.get());
+    }
+  }
+
+  // Builds 'scope' into graph_, placing every node on GPU:0 as the Placer
+  // would.
+  void BuildGraph(const Scope& scope) {
+    graph_.reset(new Graph(OpRegistry::Global()));
+    TF_ASSERT_OK(scope.ToGraph(graph_.get()));
+    for (Node* node : graph_->op_nodes()) {
+      node->set_assigned_device_name(kGPU0);
+    }
+  }
+
+  string DeviceOf(const string& name) {
+    for (Node* node : graph_->op_nodes()) {
+      if (node->name() == name) return node->assigned_device_name();
+    }
+    return "";
+  }
+
+  std::vector<std::unique_ptr<Device>> devices_;
+  DeviceSet device_set_;
+  std::unique_ptr<Graph> graph_;
+};
+
+// Two independent MatMul chains.
+void BuildTowers(const Scope& scope, const string& device) {
+  for (int i = 0; i < 2; ++i) {
+    Scope s = scope.WithDevice(device);
+    auto x = ops::Const(s.WithOpName(strings::StrCat("x", i)),
+                        Input::Initializer(1.0f, TensorShape({256, 256})));
+    auto a = ops::MatMul(s.WithOpName(strings::StrCat("a", i)), x, x);
+    auto b = ops::MatMul(s.WithOpName(strings::StrCat("b", i)), a, a);
+    ops::MatMul(s.WithOpName(strings::StrCat("c", i)), b, b);
+  }
+}
+
+TEST_F(CostBasedPlacementTest, SpreadsIndependentTowers) {
+  Scope scope = Scope::NewRootScope();
+  BuildTowers(scope, "");
+  BuildGraph(scope);
+  TF_ASSERT_OK(CostBasedPlacement(device_set_, graph_.get()));
+
+  // Each tower stays on one device, and the towers are on different devices.
+  for (int i = 0; i < 2; ++i) {
+    const string device = DeviceOf(strings::StrCat("a", i));
+    EXPECT_EQ(device, DeviceOf(strings::StrCat("b", i)));
+    EXPECT_EQ(device, DeviceOf(strings::StrCat("c", i)));
+  }
+  EXPECT_NE(DeviceOf("a0"), DeviceOf("a1"));
+}
+
+TEST_F(CostBasedPlacementTest, DoesNotSplitChain) {
+  Scope scope = Scope::NewRootScope();
+  auto x = ops::Const(scope.WithOpName("x"),
+                      Input::Initializer(1.0f, TensorShape({256, 256})));
+  Output y = x;
+  for (int i = 0; i < 4; ++i) {
+    y = ops::MatMul(scope.WithOpName(strings::StrCat("m", i)), y, y);
+  }
+  BuildGraph(scope);
+  TF_ASSERT_OK(CostBasedPlacement(device_set_, graph_.get()));
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(kGPU0, DeviceOf(strings::StrCat("m", i)));
+  }
+}
+
+TEST_F(CostBasedPlacementTest, KeepsExplicitDevices) {
+  Scope scope = Scope::NewRootScope();
+  BuildTowers(scope, "/device:GPU:0");
+  BuildGraph(scope);
+  TF_ASSERT_OK(CostBasedPlacement(device_set_, graph_.get()));
+
+  for (Node* node : graph_->op_nodes()) {
+    EXPECT_EQ(kGPU0, node->assigned_device_name()) << node->name();
+  }
+}
+
+TEST_F(CostBasedPlacementTest, KeepsStatefulNodes) {
+  Scope scope = Scope::NewRootScope();
+  auto v = ops::Variable(scope.WithOpName("v"), {256, 256}, DT_FLOAT);
+  auto x = ops::Const(scope.WithOpName("x"),
+                      Input::Initializer(1.0f, TensorShape({256, 256})));
+  ops::MatMul(scope.WithOpName("a"), x, x);
+  ops::Identity(scope.WithOpName("read"), v);
+  BuildGraph(scope);
+  TF_ASSERT_OK(CostBasedPlacement(device_set_, graph_.get()));
+
+  EXPECT_EQ(kGPU0, DeviceOf("v"));
+  EXPECT_EQ(kGPU0, DeviceOf("read"));
+}
+
+}  // namespace
+}  // namespace tensorflow
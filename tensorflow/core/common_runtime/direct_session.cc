@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <algorithm>
 #include <atomic>
 #include <string>
 #include <vector>
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
@@ -46,6 +48,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/subgraph.h"
+#include "tensorflow/core/grappler/costs/measured_costs.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -63,6 +67,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/chrome_trace.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -136,6 +141,55 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Deletes the per-step resources of step `step_id`, whose container is
+// `container`, on all `devices`.
+void CleanupStep(const std::vector<Device*>& devices, const string& container,
+                 int64 step_id) {
+  for (auto d : devices) {
+    if (!d->resource_manager()->Cleanup(container).ok()) {
+      // Do nothing...
+    }
+    ScopedAllocatorMgr* sam = d->GetScopedAllocatorMgr();
+    if (sam) sam->Cleanup(step_id);
+  }
+}
+
+// Sets (*sent_to_gpu)[i] if argument 'i' of 'graph' is sent to a GPU device.
+void FindFeedsSentToGPU(const Graph& graph, std::vector<bool>* sent_to_gpu) {
+  for (const Node* n : graph.op_nodes()) {
+    if (n->type_string() != FunctionLibraryDefinition::kArgOp) continue;
+    int index;
+    if (!GetNodeAttr(n->attrs(), "index", &index).ok() || index < 0 ||
+        index >= static_cast<int>(sent_to_gpu->size())) {
+      continue;
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge() || !e->dst()->IsSend()) continue;
+      string recv_device;
+      DeviceNameUtils::ParsedName parsed;
+      if (GetNodeAttr(e->dst()->attrs(), "recv_device", &recv_device).ok() &&
+          DeviceNameUtils::ParseFullName(recv_device, &parsed) &&
+          parsed.type == DEVICE_GPU) {
+        (*sent_to_gpu)[index] = true;
+      }
+    }
+  }
+}
+
+// Copies 'feed' into memory from the pinned host 'allocator', so that its copy
+// to the GPU is asynchronous rather than staged synchronously by the driver.
+// Returns 'feed' itself if it cannot be copied with memcpy, or if the
+// allocation fails.
+Tensor StageFeed(const Tensor& feed, Allocator* allocator) {
+  if (!DataTypeCanUseMemcpy(feed.dtype()) || feed.TotalBytes() == 0) {
+    return feed;
+  }
+  Tensor staged(allocator, feed.dtype(), feed.shape());
+  if (!staged.IsInitialized()) return feed;
+  memcpy(DMAHelper::base(&staged), DMAHelper::base(&feed), feed.TotalBytes());
+  return staged;
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -266,6 +320,12 @@ DirectSession::DirectSession(const SessionOptions& options,
   } else {
     thread_pools_.emplace_back(GlobalThreadPool(options), false /* owned */);
   }
+  for (const auto& pool_and_owned : thread_pools_) {
+    thread::ThreadPool* pool = pool_and_owned.first;
+    inter_op_runners_.push_back([this, pool](Executor::Args::Closure c) {
+      SchedClosure(pool, std::move(c));
+    });
+  }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
   const Status status =
@@ -273,6 +333,13 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  int64 num_stealing_workers = 0;
+  const Status stealing_status = ReadInt64FromEnvVar(
+      "TF_EXECUTOR_NUM_STEALING_WORKERS", 0, &num_stealing_workers);
+  if (!stealing_status.ok()) {
+    LOG(ERROR) << stealing_status.error_message();
+  }
+  num_stealing_workers_ = static_cast<int>(num_stealing_workers);
   // NOTE(mrry): We do not need to use a unique string for the session
   // handle, because DirectSession owns its devices. This may change
   // in future versions.
@@ -430,10 +497,87 @@ Status DirectSession::DecorateAndPublishGraphForDebug(
   return Status::OK();
 }
 
+class DirectSession::RunCallableCallFrame : public CallFrameInterface {
+ public:
+  RunCallableCallFrame(DirectSession* session,
+                       ExecutorsAndKeys* executors_and_keys,
+                       const std::vector<Tensor>* feed_tensors,
+                       std::vector<Tensor>* fetch_tensors)
+      : session_(session),
+        executors_and_keys_(executors_and_keys),
+        feed_tensors_(feed_tensors),
+        fetch_tensors_(fetch_tensors) {}
+
+  // Points the call frame to the feeds and fetches of another step.
+  void SetTensors(const std::vector<Tensor>* feed_tensors,
+                  std::vector<Tensor>* fetch_tensors) {
+    feed_tensors_ = feed_tensors;
+    fetch_tensors_ = fetch_tensors;
+  }
+
+  size_t num_args() const override {
+    return executors_and_keys_->input_types.size();
+  }
+  size_t num_retvals() const override {
+    return executors_and_keys_->output_types.size();
+  }
+
+  Status GetArg(int index, Tensor* val) const override {
+    if (index > feed_tensors_->size()) {
+      return errors::Internal("Args index out of bounds: ", index);
+    } else if (executors_and_keys_->input_types[index] == DT_RESOURCE) {
+      TF_RETURN_IF_ERROR(
+          session_->ResourceHandleToInputTensor((*feed_tensors_)[index], val));
+    } else {
+      *val = (*feed_tensors_)[index];
+    }
+    return Status::OK();
+  }
+
+  Status SetRetval(int index, const Tensor& val) override {
+    if (index > fetch_tensors_->size()) {
+      return errors::Internal("RetVal index out of bounds: ", index);
+    }
+    (*fetch_tensors_)[index] = val;
+    return Status::OK();
+  }
+
+ private:
+  DirectSession* const session_;                   // Not owned.
+  ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
+  const std::vector<Tensor>* feed_tensors_;        // Not owned.
+  std::vector<Tensor>* fetch_tensors_;             // Not owned.
+};
+
+struct DirectSession::CallableStepState {
+  CallableStepState(DirectSession* session,
+                    ExecutorsAndKeys* executors_and_keys,
+                    int64 container_id)
+      : call_frame(session, executors_and_keys, nullptr, nullptr),
+        step_container(container_id, [session](const string& name) {
+          CleanupStep(session->devices_, name, -1);
+        }) {}
+  ~CallableStepState() {
+    if (rendez != nullptr) rendez->Unref();
+  }
+
+  RunCallableCallFrame call_frame;
+  // Owns a reference. Null until the first step, and after a step that
+  // failed, because a failed step may abort the rendezvous or leave tensors
+  // in it.
+  IntraProcessRendezvous* rendez = nullptr;
+  // Its name stays the same across steps. RunCallable() deletes the
+  // resources of each step when it ends.
+  ScopedStepContainer step_container;
+};
+
+DirectSession::CallableStepPool::~CallableStepPool() {}
+
 Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
                                   CallFrameInterface* call_frame,
                                   ExecutorsAndKeys* executors_and_keys,
-                                  RunMetadata* run_metadata) {
+                                  RunMetadata* run_metadata,
+                                  CallableStepState* step_state) {
   const int64 executor_step_count = executors_and_keys->step_count.fetch_add(1);
 
   std::unique_ptr<DebuggerStateInterface> debugger_state;
@@ -445,8 +589,18 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
   }
 
   // Create a run state and start execution.
-  RunState run_state(step_id, &devices_);
-  run_state.rendez = new IntraProcessRendezvous(device_mgr_.get());
+  RunState run_state(step_id, &devices_,
+                     step_state ? &step_state->step_container : nullptr);
+  if (step_state != nullptr && step_state->rendez != nullptr) {
+    run_state.rendez = step_state->rendez;
+    run_state.rendez->Ref();
+  } else {
+    run_state.rendez = new IntraProcessRendezvous(device_mgr_.get());
+    if (step_state != nullptr) {
+      step_state->rendez = run_state.rendez;
+      step_state->rendez->Ref();
+    }
+  }
   // Set up for collectives if the RunOption declares a key.
   if (run_options.experimental().collective_graph_key() > 0) {
     if (!collective_executor_mgr_) {
@@ -482,8 +636,9 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
   args.cancellation_manager = &step_cancellation_manager;
   args.session_state = &session_state_;
   args.tensor_store = &run_state.tensor_store;
-  args.step_container = &run_state.step_container;
+  args.step_container = run_state.step_container;
   args.sync_on_finish = sync_on_finish_;
+  args.num_stealing_workers = num_stealing_workers_;
 
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
 
@@ -545,25 +700,16 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
     return errors::Cancelled("Run call was cancelled");
   }
 
-  thread::ThreadPool* pool =
-      thread_pools_[run_options.inter_op_thread_pool()].first;
-
-  Executor::Args::Runner default_runner = [this,
-                                           pool](Executor::Args::Closure c) {
-    SchedClosure(pool, std::move(c));
-  };
+  const Executor::Args::Runner& default_runner =
+      inter_op_runners_[run_options.inter_op_thread_pool()];
   for (const auto& item : executors_and_keys->items) {
     // TODO(zhengxq): support partial run.
     // TODO(zhengxq): if the device picks its own threadpool, we need to assign
     //     less threads to the main compute pool by default.
-    thread::ThreadPool* device_thread_pool =
-        item.device->tensorflow_device_thread_pool();
-    if (!device_thread_pool) {
+    if (!item.device_runner) {
       args.runner = default_runner;
     } else {
-      args.runner = [this, device_thread_pool](Executor::Args::Closure c) {
-        SchedClosure(device_thread_pool, std::move(c));
-      };
+      args.runner = item.device_runner;
     }
     item.executor->RunAsync(args, barrier->Get());
   }
@@ -601,6 +747,11 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
   if (args.stats_collector) {
     args.stats_collector->Finalize();
   }
+  if (do_trace) {
+    Status s = MaybeWriteChromeTrace(options_.env, run_metadata->step_stats(),
+                                     step_id);
+    if (!s.ok()) LOG(WARNING) << "Failed to write chrome trace: " << s;
+  }
 
   // Build and return the cost model as instructed.
   if (update_cost_model) {
@@ -624,6 +775,19 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
     }
   }
 
+  // Feed the measured costs back to the cost estimates of grappler.
+  if (update_cost_model && grappler::MeasuredCosts::RecordingEnabled()) {
+    OpPerformanceList perfs;
+    for (const auto& item : executors_and_keys->items) {
+      GraphDef graph_def;
+      item.graph->ToGraphDef(&graph_def);
+      perfs.MergeFrom(grappler::CostGraphToOpPerformanceData(
+          run_metadata->cost_graph(), graph_def));
+    }
+    Status s = grappler::MeasuredCosts::Record(perfs);
+    if (!s.ok()) LOG(WARNING) << "Failed to record measured costs: " << s;
+  }
+
   // If requested via RunOptions, output the partition graphs.
   if (run_options.output_partition_graphs()) {
     protobuf::RepeatedPtrField<GraphDef>* partition_graph_defs =
@@ -679,6 +843,14 @@ Status DirectSession::Run(const RunOptions& run_options,
       feed_args[executors_and_keys->input_name_to_index[it.first]] = it.second;
     }
   }
+  if (executors_and_keys->feed_staging_allocator != nullptr) {
+    for (size_t i = 0; i < feed_args.size(); ++i) {
+      if (executors_and_keys->stage_feeds[i]) {
+        feed_args[i] = StageFeed(
+            feed_args[i], executors_and_keys->feed_staging_allocator);
+      }
+    }
+  }
   const Status s = call_frame.SetArgs(feed_args);
   if (errors::IsInternal(s)) {
     return errors::InvalidArgument(s.error_message());
@@ -796,11 +968,12 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
   };
   args.session_state = &session_state_;
   args.tensor_store = &run_state->tensor_store;
-  args.step_container = &run_state->step_container;
+  args.step_container = run_state->step_container;
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(args.step_id, run_state_args.handle);
   }
   args.sync_on_finish = sync_on_finish_;
+  args.num_stealing_workers = num_stealing_workers_;
 
   if (options_.config.graph_options().build_cost_model()) {
     run_state->collector.reset(new StepStatsCollector(nullptr));
@@ -1137,6 +1310,16 @@ Status DirectSession::CreateExecutors(
       device_mgr_.get(), options_.env, graph_def_version,
       func_info->flib_def.get(), optimizer_opts, thread_pools_[0].first));
 
+  // Feeds consumed by a GPU are copied into pinned host memory at every step
+  // when requested. Partial runs feed through the rendezvous instead.
+  const bool stage_feeds = options_.config.gpu_options()
+                               .experimental()
+                               .stage_feeds_in_pinned_memory() &&
+                           !run_state_args->is_partial_run;
+  if (stage_feeds) {
+    ek->stage_feeds.resize(callable_options.feed_size(), false);
+  }
+
   GraphOptimizer optimizer(optimizer_opts);
   for (auto iter = graphs.begin(); iter != graphs.end(); ++iter) {
     const string& partition_name = iter->first;
@@ -1185,6 +1368,12 @@ Status DirectSession::CreateExecutors(
       }
     };
     params.node_outputs_cb = node_outputs_callback_;
+    params.use_static_memory_arena =
+        options_.config.experimental().static_memory_arena();
+    params.lazy_kernel_creation =
+        options_.config.experimental().lazy_kernel_creation();
+    params.critical_path_priorities =
+        options_.config.experimental().critical_path_priorities();
 
     optimizer.Optimize(lib, options_.env, device, &iter->second,
                        /*shape_map=*/nullptr);
@@ -1200,16 +1389,35 @@ Status DirectSession::CreateExecutors(
     TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(device->device_type()),
                                          device->name(),
                                          partition_graph.get()));
+    if (stage_feeds && device == device_set_.client_device()) {
+      FindFeedsSentToGPU(*partition_graph, &ek->stage_feeds);
+    }
     // NewLocalExecutor takes ownership of partition_graph.
     item->graph = partition_graph.get();
     item->executor = nullptr;
     item->device = device;
+    thread::ThreadPool* device_thread_pool =
+        device->tensorflow_device_thread_pool();
+    if (device_thread_pool) {
+      item->device_runner = [this,
+                             device_thread_pool](Executor::Args::Closure c) {
+        SchedClosure(device_thread_pool, std::move(c));
+      };
+    }
     Executor* executor;
     TF_RETURN_IF_ERROR(
         NewLocalExecutor(params, std::move(partition_graph), &executor));
     item->executor.reset(executor);
   }
 
+  if (std::find(ek->stage_feeds.begin(), ek->stage_feeds.end(), true) !=
+      ek->stage_feeds.end()) {
+    AllocatorAttributes attr;
+    attr.set_gpu_compatible(true);
+    ek->feed_staging_allocator =
+        device_set_.client_device()->GetAllocator(attr);
+  }
+
   // Cache the mapping from input/output names to graph elements to
   // avoid recomputing it every time.
   if (!run_state_args->is_partial_run) {
@@ -1541,15 +1749,7 @@ DirectSession::RunState::RunState(
     const std::vector<string>& pending_input_names,
     const std::vector<string>& pending_output_names, int64 step_id,
     const std::vector<Device*>* devices)
-    : step_container(step_id, [devices, step_id](const string& name) {
-        for (auto d : *devices) {
-          if (!d->resource_manager()->Cleanup(name).ok()) {
-            // Do nothing...
-          }
-          ScopedAllocatorMgr* sam = d->GetScopedAllocatorMgr();
-          if (sam) sam->Cleanup(step_id);
-        }
-      }) {
+    : RunState(step_id, devices, nullptr) {
   // Initially all the feeds and fetches are pending.
   for (auto& name : pending_input_names) {
     pending_inputs[name] = false;
@@ -1561,7 +1761,20 @@ DirectSession::RunState::RunState(
 
 DirectSession::RunState::RunState(int64 step_id,
                                   const std::vector<Device*>* devices)
-    : RunState({}, {}, step_id, devices) {}
+    : RunState(step_id, devices, nullptr) {}
+
+DirectSession::RunState::RunState(int64 step_id,
+                                  const std::vector<Device*>* devices,
+                                  ScopedStepContainer* reused_step_container)
+    : step_container(reused_step_container) {
+  if (step_container == nullptr) {
+    own_step_container.emplace(
+        step_id, [devices, step_id](const string& name) {
+          CleanupStep(*devices, name, step_id);
+        });
+    step_container = &*own_step_container;
+  }
+}
 
 DirectSession::RunState::~RunState() {
   if (rendez != nullptr) {
@@ -1639,56 +1852,12 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
   {
     mutex_lock l(callables_lock_);
     *out_handle = next_callable_handle_++;
-    callables_[*out_handle] = {std::move(ek), std::move(func_info)};
+    callables_[*out_handle] = {std::move(ek), std::move(func_info),
+                               std::make_shared<CallableStepPool>()};
   }
   return Status::OK();
 }
 
-class DirectSession::RunCallableCallFrame : public CallFrameInterface {
- public:
-  RunCallableCallFrame(DirectSession* session,
-                       ExecutorsAndKeys* executors_and_keys,
-                       const std::vector<Tensor>* feed_tensors,
-                       std::vector<Tensor>* fetch_tensors)
-      : session_(session),
-        executors_and_keys_(executors_and_keys),
-        feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
-
-  size_t num_args() const override {
-    return executors_and_keys_->input_types.size();
-  }
-  size_t num_retvals() const override {
-    return executors_and_keys_->output_types.size();
-  }
-
-  Status GetArg(int index, Tensor* val) const override {
-    if (index > feed_tensors_->size()) {
-      return errors::Internal("Args index out of bounds: ", index);
-    } else if (executors_and_keys_->input_types[index] == DT_RESOURCE) {
-      TF_RETURN_IF_ERROR(
-          session_->ResourceHandleToInputTensor((*feed_tensors_)[index], val));
-    } else {
-      *val = (*feed_tensors_)[index];
-    }
-    return Status::OK();
-  }
-
-  Status SetRetval(int index, const Tensor& val) override {
-    if (index > fetch_tensors_->size()) {
-      return errors::Internal("RetVal index out of bounds: ", index);
-    }
-    (*fetch_tensors_)[index] = val;
-    return Status::OK();
-  }
-
- private:
-  DirectSession* const session_;                   // Not owned.
-  ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
-  const std::vector<Tensor>* const feed_tensors_;  // Not owned.
-  std::vector<Tensor>* const fetch_tensors_;       // Not owned.
-};
-
 ::tensorflow::Status DirectSession::RunCallable(
     CallableHandle handle, const std::vector<Tensor>& feed_tensors,
     std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata) {
@@ -1698,6 +1867,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
 
   // Check if we already have an executor for these arguments.
   std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
+  std::shared_ptr<CallableStepPool> step_pool;
   const int64 step_id = step_id_counter_.fetch_add(1);
 
   {
@@ -1705,7 +1875,11 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     if (handle >= next_callable_handle_) {
       return errors::InvalidArgument("No such callable handle: ", handle);
     }
-    executors_and_keys = callables_[handle].executors_and_keys;
+    auto it = callables_.find(handle);
+    if (it != callables_.end()) {
+      executors_and_keys = it->second.executors_and_keys;
+      step_pool = it->second.step_pool;
+    }
   }
 
   if (!executors_and_keys) {
@@ -1736,18 +1910,55 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   // A specialized CallFrame implementation that takes advantage of the
   // optimized RunCallable interface.
 
-  RunCallableCallFrame call_frame(this, executors_and_keys.get(), &feed_tensors,
-                                  fetch_tensors);
+  const std::vector<Tensor>* feeds = &feed_tensors;
+  std::vector<Tensor> staged_feeds;
+  if (executors_and_keys->feed_staging_allocator != nullptr) {
+    staged_feeds = feed_tensors;
+    for (size_t i = 0; i < staged_feeds.size(); ++i) {
+      if (executors_and_keys->stage_feeds[i]) {
+        staged_feeds[i] = StageFeed(
+            staged_feeds[i], executors_and_keys->feed_staging_allocator);
+      }
+    }
+    feeds = &staged_feeds;
+  }
+
+  std::unique_ptr<CallableStepState> step_state;
+  {
+    mutex_lock l(step_pool->mu);
+    if (!step_pool->free_states.empty()) {
+      step_state = std::move(step_pool->free_states.back());
+      step_pool->free_states.pop_back();
+    }
+  }
+  if (step_state == nullptr) {
+    step_state.reset(new CallableStepState(this, executors_and_keys.get(),
+                                           step_id_counter_.fetch_add(1)));
+  }
+  step_state->call_frame.SetTensors(feeds, fetch_tensors);
 
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
-  TF_RETURN_IF_ERROR(
+  Status s =
       RunInternal(step_id, executors_and_keys->callable_options.run_options(),
-                  &call_frame, executors_and_keys.get(), run_metadata));
+                  &step_state->call_frame, executors_and_keys.get(),
+                  run_metadata, step_state.get());
 
-  return Status::OK();
+  // All executors of the step are done, so the next step can take its
+  // per-step objects once the resources it created are gone.
+  CleanupStep(devices_, step_state->step_container.name(), step_id);
+  step_state->call_frame.SetTensors(nullptr, nullptr);
+  if (!s.ok() && step_state->rendez != nullptr) {
+    step_state->rendez->Unref();
+    step_state->rendez = nullptr;
+  }
+  {
+    mutex_lock l(step_pool->mu);
+    step_pool->free_states.push_back(std::move(step_state));
+  }
+  return s;
 }
 
 ::tensorflow::Status DirectSession::ReleaseCallable(CallableHandle handle) {
@@ -1764,7 +1975,8 @@ DirectSession::Callable::~Callable() {
   // of `executors_and_keys` will call into an object owned by
   // `function_info` (in particular, when deleting a kernel, it relies
   // on the `FunctionLibraryRuntime` to know if the kernel is stateful
-  // or not).
+  // or not). The call frames in `step_pool` point to `executors_and_keys`.
+  step_pool.reset();
   executors_and_keys.reset();
   function_info.reset();
 }
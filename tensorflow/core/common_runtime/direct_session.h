@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/optional.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -124,6 +125,10 @@ class DirectSession : public Session {
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
     std::unique_ptr<Executor> executor;
+    // Schedules closures on the device's own thread pool, if it has one.
+    // Empty if the session's inter-op pool should be used instead. Built
+    // once in CreateExecutors().
+    Executor::Args::Runner device_runner;
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -149,6 +154,12 @@ class DirectSession : public Session {
     DataTypeVector input_types;
     DataTypeVector output_types;
 
+    // If non-null, the pinned host allocator that input 'i' is copied into
+    // before every step when stage_feeds[i] is true, i.e. when it is sent to
+    // a GPU.
+    Allocator* feed_staging_allocator = nullptr;
+    std::vector<bool> stage_feeds;
+
     CallableOptions callable_options;
   };
 
@@ -182,10 +193,18 @@ class DirectSession : public Session {
     std::unordered_map<string, bool> pending_inputs;   // true if fed
     std::unordered_map<string, bool> pending_outputs;  // true if fetched
     TensorStore tensor_store;
-    ScopedStepContainer step_container;
+    // Points to own_step_container, or to the container of a callable that
+    // the step reuses.
+    ScopedStepContainer* step_container;
+    gtl::optional<ScopedStepContainer> own_step_container;
 
     RunState(int64 step_id, const std::vector<Device*>* devices);
 
+    // Uses `reused_step_container`, which the caller cleans up after the
+    // step, unless it is null.
+    RunState(int64 step_id, const std::vector<Device*>* devices,
+             ScopedStepContainer* reused_step_container);
+
     RunState(const std::vector<string>& pending_input_names,
              const std::vector<string>& pending_output_names, int64 step_id,
              const std::vector<Device*>* devices);
@@ -236,10 +255,15 @@ class DirectSession : public Session {
       RunStateArgs* run_state_args, DataTypeVector* input_types,
       DataTypeVector* output_types);
 
+  struct CallableStepState;
+
+  // If `step_state` is not null, the step uses its rendezvous and step
+  // container instead of creating new ones.
   ::tensorflow::Status RunInternal(int64 step_id, const RunOptions& run_options,
                                    CallFrameInterface* call_frame,
                                    ExecutorsAndKeys* executors_and_keys,
-                                   RunMetadata* run_metadata);
+                                   RunMetadata* run_metadata,
+                                   CallableStepState* step_state = nullptr);
 
   ::tensorflow::Status ExtendLocked(const GraphDef& graph)
       EXCLUSIVE_LOCKS_REQUIRED(graph_def_lock_);
@@ -315,11 +339,17 @@ class DirectSession : public Session {
   // The thread-pools to use for running ops, with a bool indicating if the pool
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
+  // inter_op_runners_[i] schedules closures on thread_pools_[i]. Built once
+  // at construction.
+  std::vector<Executor::Args::Runner> inter_op_runners_;
 
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
+  // If > 0, executors dispatch ready nodes through this many work-stealing
+  // workers (see Executor::Args::num_stealing_workers).
+  int num_stealing_workers_ = 0;
   // Schedules 'c' for execution on pool.
   void SchedClosure(thread::ThreadPool* pool, std::function<void()> c);
 
@@ -336,9 +366,19 @@ class DirectSession : public Session {
       GUARDED_BY(executor_lock_);
 
   class RunCallableCallFrame;
+  // The per-step objects of a callable that no step is using. RunCallable()
+  // takes one, or creates it if there is none, and returns it after the
+  // step, so that steps of the callable reuse their call frame, rendezvous
+  // and step container.
+  struct CallableStepPool {
+    mutex mu;
+    std::vector<std::unique_ptr<CallableStepState>> free_states GUARDED_BY(mu);
+    ~CallableStepPool();
+  };
   struct Callable {
     std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
     std::shared_ptr<FunctionInfo> function_info;
+    std::shared_ptr<CallableStepPool> step_pool;
     ~Callable();
   };
   mutex callables_lock_;
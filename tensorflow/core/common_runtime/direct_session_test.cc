@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -135,6 +136,38 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunExtendedNetwork) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {z_ + ":0"}, {}, &outputs));
+
+  // Extends the graph with a consumer of "z", and with a node colocated
+  // with "a", which may move the nodes it touches but no other node.
+  GraphDef extension;
+  NodeDef* w = extension.add_node();
+  w->set_name("w");
+  w->set_op("Neg");
+  w->add_input(z_);
+  (*w->mutable_attr())["T"].set_type(DT_FLOAT);
+  NodeDef* b = extension.add_node();
+  b->set_name("b");
+  b->set_op("Identity");
+  b->add_input(x_);
+  (*b->mutable_attr())["T"].set_type(DT_FLOAT);
+  (*b->mutable_attr())["_class"].mutable_list()->add_s(
+      strings::StrCat("loc:@", a_));
+  TF_ASSERT_OK(session->Extend(extension));
+
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0", "w:0", "b:0"}, {}, &outputs));
+  ASSERT_EQ(3, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(5.0, outputs[1].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(1.0, outputs[2].matrix<float>()(0, 0));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -657,6 +690,33 @@ TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   EXPECT_EQ(20.0, outputs[0].flat<float>()(0));
 }
 
+// Kernels created on first use still share stateful kernels across the
+// executors of different runs through the OpSegment.
+TEST(DirectSessionTest, LazyKernelCreation) {
+  Graph g(OpRegistry::Global());
+  Node* var = test::graph::Var(&g, DT_FLOAT, TensorShape({10}));
+  Tensor twenty(DT_FLOAT, TensorShape({10}));
+  twenty.flat<float>().setConstant(20.0);
+  Node* init = test::graph::Assign(&g, var, test::graph::Constant(&g, twenty));
+  Node* neg = test::graph::Unary(&g, "Neg", var);
+  GraphDef def;
+  test::graph::ToGraphDef(&g, &def);
+
+  SessionOptions options;
+  options.config.mutable_experimental()->set_lazy_kernel_creation(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {init->name()}, {}, &outputs));
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(session->Run({}, {neg->name() + ":0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(-20.0, outputs[0].flat<float>()(9));
+  }
+}
+
 TEST(DirectSessionTest, MultipleFeedTest) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -813,6 +873,76 @@ TEST(DirectSessionTest, MultipleFeedTest_Callable) {
   EXPECT_TRUE(str_util::StrContains(s.error_message(), "fed more than once"));
 }
 
+class StepObjectsResource : public ResourceBase {
+ public:
+  string DebugString() override { return "StepObjectsResource"; }
+};
+
+// Records the per-step objects that its step runs with, and creates a
+// resource in the step container, which fails if a previous step left its
+// resource there.
+class StepObjectsOp : public OpKernel {
+ public:
+  explicit StepObjectsOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+  void Compute(OpKernelContext* ctx) override {
+    call_frame = ctx->call_frame();
+    rendezvous = ctx->rendezvous();
+    step_container = ctx->step_container();
+    OP_REQUIRES_OK(ctx, ctx->resource_manager()->Create(
+                            ctx->step_container()->name(), "step_objects",
+                            new StepObjectsResource));
+    ctx->set_output(0, ctx->input(0));
+  }
+  static CallFrameInterface* call_frame;
+  static Rendezvous* rendezvous;
+  static ScopedStepContainer* step_container;
+};
+CallFrameInterface* StepObjectsOp::call_frame = nullptr;
+Rendezvous* StepObjectsOp::rendezvous = nullptr;
+ScopedStepContainer* StepObjectsOp::step_container = nullptr;
+
+REGISTER_KERNEL_BUILDER(Name("StepObjects").Device(DEVICE_CPU), StepObjectsOp);
+REGISTER_OP("StepObjects").Input("x: float").Output("y: float").Doc("");
+
+TEST(DirectSessionTest, RunCallableReusesStepObjects) {
+  Graph g(OpRegistry::Global());
+  Tensor vx(DT_FLOAT, TensorShape({}));
+  vx.scalar<float>()() = 1.0;
+  Node* x = test::graph::Constant(&g, vx);
+  Node* y = test::graph::Unary(&g, "StepObjects", x);
+  GraphDef def;
+  test::graph::ToGraphDef(&g, &def);
+  auto session = CreateSession();
+  TF_ASSERT_OK(session->Create(def));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({}, {y->name() + ":0"}, {}), &handle));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  test::ExpectTensorEqual<float>(vx, outputs[0]);
+  CallFrameInterface* const call_frame = StepObjectsOp::call_frame;
+  Rendezvous* const rendezvous = StepObjectsOp::rendezvous;
+  ScopedStepContainer* const step_container = StepObjectsOp::step_container;
+  ASSERT_NE(nullptr, call_frame);
+  ASSERT_NE(nullptr, rendezvous);
+  ASSERT_NE(nullptr, step_container);
+
+  for (int i = 0; i < 3; ++i) {
+    outputs.clear();
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    test::ExpectTensorEqual<float>(vx, outputs[0]);
+    EXPECT_EQ(call_frame, StepObjectsOp::call_frame);
+    EXPECT_EQ(rendezvous, StepObjectsOp::rendezvous);
+    EXPECT_EQ(step_container, StepObjectsOp::step_container);
+  }
+
+  // Steps that do not run a callable still get their own objects.
+  TF_ASSERT_OK(session->Run({}, {y->name() + ":0"}, {}, &outputs));
+  EXPECT_NE(step_container, StepObjectsOp::step_container);
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST(DirectSessionTest, TestTensorConnectionUseTwice) {
   Graph graph(OpRegistry::Global());
 
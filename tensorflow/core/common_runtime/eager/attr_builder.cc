@@ -96,10 +96,59 @@ Status AttrTypeMapForOp(const char* op_name, const AttrTypeMap** out) {
   return Status::OK();
 }
 
+namespace {
+inline tensorflow::Fprint128 FingerprintCat128(const tensorflow::Fprint128& a,
+                                               const tensorflow::Fprint128& b) {
+  return {tensorflow::FingerprintCat64(a.low64, b.low64),
+          tensorflow::FingerprintCat64(a.low64, b.low64)};
+}
+
+void CombineUnordered(const tensorflow::Fprint128& a,
+                      tensorflow::Fprint128* b) {
+  b->low64 += a.low64;
+  b->high64 += a.high64;
+}
+
+inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s,
+                                            const tensorflow::Fprint128& b) {
+  tensorflow::Fprint128 a = tensorflow::Fingerprint128(s);
+  return FingerprintCat128(a, b);
+}
+
+inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s, uint64 b) {
+  return CacheKeyHelper(s, {b, b});
+}
+
+// The parts of the cache key for attrs of the types that Set() keeps aside.
+tensorflow::Fprint128 AttrKey(StringPiece attr_name, StringPiece value) {
+  return CacheKeyHelper(attr_name, tensorflow::Fingerprint128(value));
+}
+
+tensorflow::Fprint128 AttrKey(StringPiece attr_name, int value) {
+  return CacheKeyHelper(attr_name, static_cast<uint64>(value));
+}
+
+tensorflow::Fprint128 AttrKey(StringPiece attr_name, float value) {
+  static std::hash<float> float_hasher;
+  return CacheKeyHelper(attr_name, static_cast<uint64>(float_hasher(value)));
+}
+
+tensorflow::Fprint128 AttrKey(StringPiece attr_name, bool value) {
+  return CacheKeyHelper(attr_name, value ? 1u : 0u);
+}
+
+tensorflow::Fprint128 AttrKey(StringPiece attr_name,
+                              tensorflow::DataType value) {
+  return CacheKeyHelper(attr_name, static_cast<uint64>(value));
+}
+
+}  // namespace
+
 #define DEFINE_SET_ATTR(value_type, value_field)                             \
   template <>                                                                \
   AttrBuilder& AttrBuilder::Set(StringPiece attr_name, value_type&& value) { \
     value_field.push_back(std::make_pair(attr_name, value));                 \
+    CombineUnordered(AttrKey(attr_name, value), &attrs_key_);                \
     return *this;                                                            \
   }
 
@@ -169,31 +218,6 @@ Status AttrTypeByName(const AttrTypeMap& m, const string& attr_name,
   return Status::OK();
 }
 
-namespace {
-inline tensorflow::Fprint128 FingerprintCat128(const tensorflow::Fprint128& a,
-                                               const tensorflow::Fprint128& b) {
-  return {tensorflow::FingerprintCat64(a.low64, b.low64),
-          tensorflow::FingerprintCat64(a.low64, b.low64)};
-}
-
-void CombineUnordered(const tensorflow::Fprint128& a,
-                      tensorflow::Fprint128* b) {
-  b->low64 += a.low64;
-  b->high64 += a.high64;
-}
-
-inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s,
-                                            const tensorflow::Fprint128& b) {
-  tensorflow::Fprint128 a = tensorflow::Fingerprint128(s);
-  return FingerprintCat128(a, b);
-}
-
-inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s, uint64 b) {
-  return CacheKeyHelper(s, {b, b});
-}
-
-}  // namespace
-
 tensorflow::Fprint128 AttrBuilder::CacheKey(const string& device) const {
   tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name_);
   f = tensorflow::FingerprintCat128(f, tensorflow::Fingerprint128(device));
@@ -211,27 +235,7 @@ tensorflow::Fprint128 AttrBuilder::CacheKey(const string& device) const {
     // not been called.
     if (node_def_finalized_) return f;
   }
-  for (const auto& p : string_attrs_) {
-    CombineUnordered(
-        CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
-  }
-  for (const auto& p : int_attrs_) {
-    CombineUnordered(CacheKeyHelper(p.first, static_cast<uint64>(p.second)),
-                     &f);
-  }
-  static std::hash<float> float_hasher;
-  for (const auto& p : float_attrs_) {
-    CombineUnordered(
-        CacheKeyHelper(p.first, static_cast<uint64>(float_hasher(p.second))),
-        &f);
-  }
-  for (const auto& p : bool_attrs_) {
-    CombineUnordered(CacheKeyHelper(p.first, p.second ? 1u : 0u), &f);
-  }
-  for (const auto& p : type_attrs_) {
-    CombineUnordered(CacheKeyHelper(p.first, static_cast<uint64>(p.second)),
-                     &f);
-  }
+  CombineUnordered(attrs_key_, &f);
   return f;
 }
 
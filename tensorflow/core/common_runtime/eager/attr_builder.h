@@ -88,7 +88,8 @@ class AttrBuilder {
       : op_name_(op),
         num_inputs_(0),
         node_def_(nullptr),
-        node_def_finalized_(false) {}
+        node_def_finalized_(false),
+        attrs_key_{0, 0} {}
 
   // Needed to work around call to ValidateNodeDef in CreateOpKernel.
   AttrBuilder& NumInputs(int n);
@@ -140,6 +141,9 @@ class AttrBuilder {
   int num_inputs_;
   std::unique_ptr<NodeDef> node_def_;
   bool node_def_finalized_;
+  // The part of the cache key for the attrs in the vectors above, which is
+  // updated as they are set, so that CacheKey() need not visit them.
+  tensorflow::Fprint128 attrs_key_;
 };  // namespace tensorflow
 
 template <>
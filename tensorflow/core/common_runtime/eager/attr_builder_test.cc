@@ -58,5 +58,22 @@ TEST(AttrTypeMap, Lookup) {
   EXPECT_NE(is_list, 0);
 }
 
+TEST(AttrBuilder, CacheKey) {
+  AttrBuilder a("MatMul");
+  a.Set("transpose_a", true);
+  a.Set("T", DT_FLOAT);
+  AttrBuilder b("MatMul");
+  b.Set("T", DT_FLOAT);
+  b.Set("transpose_a", true);
+  // The key does not depend on the order in which attrs are set.
+  EXPECT_TRUE(a.CacheKey("cpu:0") == b.CacheKey("cpu:0"));
+  EXPECT_FALSE(a.CacheKey("cpu:0") == a.CacheKey("gpu:0"));
+
+  AttrBuilder c("MatMul");
+  c.Set("T", DT_DOUBLE);
+  c.Set("transpose_a", true);
+  EXPECT_FALSE(a.CacheKey("cpu:0") == c.CacheKey("cpu:0"));
+}
+
 }  // namespace
 }  // namespace tensorflow
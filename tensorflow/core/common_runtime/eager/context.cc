@@ -105,8 +105,10 @@ Status EagerContext::SetAsyncForThread(bool async) {
 }
 
 void EagerContext::ClearCaches() {
-  mutex_lock ml(cache_mu_);
-  gtl::STLDeleteValues(&kernel_cache_);
+  for (KernelCacheShard& shard : kernel_cache_) {
+    mutex_lock ml(shard.mu);
+    gtl::STLDeleteValues(&shard.kernels);
+  }
 }
 
 void EagerContext::SetThreadLocalDevicePlacementPolicy(
@@ -195,14 +197,16 @@ Status EagerContext::AddFunctionDef(const FunctionDef& fdef) {
 }
 
 KernelAndDevice* EagerContext::GetCachedKernel(Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  return gtl::FindPtrOrNull(kernel_cache_, cache_key);
+  KernelCacheShard& shard = KernelCacheShardFor(cache_key);
+  tf_shared_lock l(shard.mu);
+  return gtl::FindPtrOrNull(shard.kernels, cache_key);
 }
 
 void EagerContext::AddKernelToCache(Fprint128 cache_key,
                                     KernelAndDevice* kernel) {
-  mutex_lock ml(cache_mu_);
-  gtl::InsertOrUpdate(&kernel_cache_, cache_key, kernel);
+  KernelCacheShard& shard = KernelCacheShardFor(cache_key);
+  mutex_lock ml(shard.mu);
+  gtl::InsertOrUpdate(&shard.kernels, cache_key, kernel);
 }
 
 void EagerContext::SetShouldStoreMetadata(bool value) {
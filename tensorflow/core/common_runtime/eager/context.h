@@ -209,9 +209,18 @@ class EagerContext {
   // session->devices[i].
   const std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
 
-  mutex cache_mu_;
-  std::unordered_map<Fprint128, KernelAndDevice*, Fprint128Hasher> kernel_cache_
-      GUARDED_BY(cache_mu_);
+  // The kernel cache is split into shards by key, so that threads executing
+  // ops concurrently rarely contend on the same lock.
+  static constexpr int kNumKernelCacheShards = 16;
+  struct KernelCacheShard {
+    mutex mu;
+    std::unordered_map<Fprint128, KernelAndDevice*, Fprint128Hasher> kernels
+        GUARDED_BY(mu);
+  };
+  KernelCacheShard& KernelCacheShardFor(const Fprint128& cache_key) {
+    return kernel_cache_[cache_key.low64 % kNumKernelCacheShards];
+  }
+  KernelCacheShard kernel_cache_[kNumKernelCacheShards];
 
   // Whether we should compute RunMetadata.
   std::atomic<bool> should_store_metadata_{false};
@@ -55,6 +55,11 @@ void EagerExecutor::Add(EagerNode* node) {
       delete node;
       return;
     }
+    // The front node may be running, but the others wait to be run.
+    if (qlen > 1 && node_queue_.back()->TryMerge(node)) {
+      delete node;
+      return;
+    }
     node_queue_.push(node);
   } else {
     node_queue_.push(node);
@@ -108,44 +113,64 @@ tensorflow::Status EagerExecutor::status() {
 }
 
 void EagerExecutor::Run() {
+  std::unique_ptr<EagerNode> curr_node;
+  tensorflow::Status status;
   while (true) {
-    std::unique_ptr<EagerNode> curr_node;
+    std::unique_ptr<EagerNode> done_node;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
-      while (node_queue_.empty() || !status_.ok()) {
-        if (thread_done_) return;
-        nodes_pending_.wait(l);
+      // Retiring the node that ran and taking the next one share a critical
+      // section, so that a stream of small ops takes the lock once per op.
+      if (curr_node != nullptr) {
+        NodeDone(status);
+        done_node = std::move(curr_node);
+      } else {
+        while (node_queue_.empty() || !status_.ok()) {
+          if (thread_done_) return;
+          nodes_pending_.wait(l);
+        }
       }
-      curr_node.reset(node_queue_.front());
-    }
-    tensorflow::Status status = curr_node->Run();
-    const bool ok = status.ok();
-    tensorflow::mutex_lock l(node_queue_mutex_);
-    node_queue_.pop();
-    if (!ok) {
-      status_ = status;
-      // TODO(agarwal): mark all affected handles as corrupted before clearing
-      // this queue.
-      // We remove any pending ops so that we don't try to execute them if
-      // ClearError is called.
-      for (int i = 0; i < node_queue_.size(); ++i) {
-        delete node_queue_.front();
-        node_queue_.pop();
+      if (!node_queue_.empty() && status_.ok()) {
+        curr_node.reset(node_queue_.front());
       }
     }
-    if (!node_done_notifications_.empty()) {
-      tensorflow::uint64 node_id = curr_node->id;
-      // Note that we notify all waiting threads in case an error has occurred.
-      // These calling threads are responsible for checking status_ before
-      // proceeding.
-      const auto range = ok ? node_done_notifications_.equal_range(node_id)
-                            : make_pair(node_done_notifications_.begin(),
-                                        node_done_notifications_.end());
-      for (auto it = range.first; it != range.second; ++it) {
-        it->second->notify_all();
-      }
-      node_done_notifications_.erase(range.first, range.second);
+    // Nodes are deleted outside the lock, as that may free their tensors.
+    done_node.reset();
+    if (curr_node != nullptr) {
+      status = curr_node->Run();
+    }
+  }
+}
+
+void EagerExecutor::NodeDone(const tensorflow::Status& status) {
+  const bool ok = status.ok();
+  node_queue_.pop();
+  if (!ok) {
+    status_ = status;
+    // TODO(agarwal): mark all affected handles as corrupted before clearing
+    // this queue.
+    // We remove any pending ops so that we don't try to execute them if
+    // ClearError is called.
+    while (!node_queue_.empty()) {
+      delete node_queue_.front();
+      node_queue_.pop();
+    }
+  }
+  if (!node_done_notifications_.empty()) {
+    // Note that we notify all waiting threads in case an error has occurred.
+    // These calling threads are responsible for checking status_ before
+    // proceeding.
+    // Nodes merged into the one that ran are done as well, that is every
+    // node with an id before the next one in the queue.
+    const auto end = ok && !node_queue_.empty()
+                         ? node_done_notifications_.lower_bound(
+                               node_queue_.front()->id)
+                         : node_done_notifications_.end();
+    const auto range = make_pair(node_done_notifications_.begin(), end);
+    for (auto it = range.first; it != range.second; ++it) {
+      it->second->notify_all();
     }
+    node_done_notifications_.erase(range.first, range.second);
   }
 }
 
@@ -50,6 +50,13 @@ class EagerNode {
   // execution is done.
   virtual Status Run() = 0;
 
+  // Merges `node`, which is being added to the queue right after this node,
+  // into this node, so that running this node also runs `node`. Returns false,
+  // and leaves `node` alone, if they can not run as one.
+  //
+  // Only called while this node waits in the queue, not while it runs.
+  virtual bool TryMerge(EagerNode* node) { return false; }
+
   // An id unique to the TFE_Context under which this node is created. Allocated
   // monotonically.
   const uint64 id;
@@ -77,7 +84,8 @@ class EagerExecutor {
   // object.
   uint64 NextId();
 
-  // Schedules `node` for execution.
+  // Schedules `node` for execution, possibly as part of the node added before
+  // it (see EagerNode::TryMerge).
   // Note that Add must be called in monotonically increasing order of node->id.
   void Add(EagerNode* node);
 
@@ -103,6 +111,11 @@ class EagerExecutor {
 
   Status WaitImpl(bool wait_all, uint64 node_id);
 
+  // Removes the node at the front of the queue, which ran with `status`, and
+  // notifies the threads waiting for it.
+  void NodeDone(const Status& status)
+      EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+
   mutex node_queue_mutex_;
 
   // Used to signal that some EagerNodes are pending execution.
@@ -15,15 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <memory>
+#include <queue>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
+#include "tensorflow/core/common_runtime/memory_timeline.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/static_memory_arena.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -33,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/log_memory.h"
+#include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_segment.h"
@@ -41,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
@@ -51,14 +57,17 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 
 namespace tensorflow {
@@ -194,6 +203,81 @@ void SetReferencedTensors(NodeExecStatsWrapper* stats,
 
 }  // namespace nodestats
 
+// Sampling of op latencies: every TF_EXECUTOR_OP_SAMPLING_INTERVAL steps,
+// the executor times the ops it computes, without the cost of collecting
+// full step stats.
+namespace opsampling {
+
+auto* op_latency_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/executor/op_latency_usecs",
+     "The time ops of each type take to compute in the steps that the "
+     "executor samples, in microseconds.",
+     "op"},
+    monitoring::Buckets::Exponential(1, 2, 24));
+
+// The number of steps between sampled steps, or 0 if sampling is disabled.
+int64 Interval() {
+  static const int64 interval = [] {
+    int64 steps;
+    Status s =
+        ReadInt64FromEnvVar("TF_EXECUTOR_OP_SAMPLING_INTERVAL", 0, &steps);
+    if (!s.ok() || steps < 0) {
+      LOG(ERROR) << "Invalid TF_EXECUTOR_OP_SAMPLING_INTERVAL: " << s;
+      return int64{0};
+    }
+    return steps;
+  }();
+  return interval;
+}
+
+// Returns true if the step that starts now is sampled.
+bool SampleStep() {
+  static std::atomic<int64> num_steps(0);
+  const int64 interval = Interval();
+  return interval > 0 && num_steps.fetch_add(1) % interval == 0;
+}
+
+// The latencies that one thread records, which it adds to their cells in
+// batches so that sampled steps do not contend on the cells.
+class LatencyBuffer {
+ public:
+  ~LatencyBuffer() { Flush(); }
+
+  void Record(monitoring::SamplerCell* cell, int64 start_usecs) {
+    const int64 now_usecs = Env::Default()->NowMicros();
+    if (size_ == 0) first_usecs_ = now_usecs;
+    samples_[size_++] = {cell, static_cast<double>(now_usecs - start_usecs)};
+    if (size_ == kCapacity || now_usecs - first_usecs_ > kMaxDelayUsecs) {
+      Flush();
+    }
+  }
+
+ private:
+  void Flush() {
+    for (int i = 0; i < size_; ++i) {
+      samples_[i].first->Add(samples_[i].second);
+    }
+    size_ = 0;
+  }
+
+  static constexpr int kCapacity = 256;
+  // Buffered samples are exported at most this late, unless the thread
+  // records nothing more.
+  static constexpr int64 kMaxDelayUsecs = 1000000;
+
+  std::pair<monitoring::SamplerCell*, double> samples_[kCapacity];
+  int size_ = 0;
+  int64 first_usecs_ = 0;
+};
+
+// Records the latency of an op that started at "start_usecs" in "cell".
+void Record(monitoring::SamplerCell* cell, int64 start_usecs) {
+  static thread_local LatencyBuffer buffer;
+  buffer.Record(cell, start_usecs);
+}
+
+}  // namespace opsampling
+
 class ExecutorImpl;
 class GraphView;
 
@@ -211,11 +295,17 @@ struct NodeItem {
   // A graph node.
   const Node* node = nullptr;
 
-  // The kernel for this node.
+  // The kernel for this node, or nullptr if it is created on first use. See
+  // ExecutorImpl::GetLazyKernel().
   OpKernel* kernel = nullptr;
 
   bool kernel_is_expensive : 1;  // True iff kernel->IsExpensive()
   bool kernel_is_async : 1;      // True iff kernel->AsAsync() != nullptr
+  // True iff the node may wait for other nodes of the step while it runs:
+  // its kernel is async, its op is stateful (queues, Recv, ...), or its
+  // kernel is created lazily and not known yet. Work-stealing workers never
+  // run such nodes; see ExecutorState::Dispatch().
+  bool may_block : 1;
   bool is_merge : 1;             // True iff IsMerge(node)
   bool is_enter : 1;             // True iff IsEnter(node)
   bool is_exit : 1;              // True iff IsExit(node)
@@ -238,6 +328,10 @@ struct NodeItem {
 
   PendingCounts::Handle pending_id;
 
+  // The number of ops on the longest path from this node to the sink if the
+  // executor schedules by critical-path priority, or 0.
+  int32 priority = 0;
+
   const EdgeInfo* output_edge_list() const { return output_edge_base(); }
 
   // ith output edge.
@@ -354,11 +448,18 @@ class ExecutorImpl : public Executor {
   }
 
   ~ExecutorImpl() override {
+    if (warmup_done_ != nullptr) {
+      stop_warmup_ = true;
+      warmup_done_->WaitForNotification();
+    }
     for (int i = 0; i < graph_->num_node_ids(); i++) {
       NodeItem* item = gview_.node(i);
       if (item != nullptr) {
         params_.delete_kernel(item->kernel);
       }
+      if (lazy_kernels_ != nullptr && lazy_kernels_[i] != nullptr) {
+        params_.delete_kernel(lazy_kernels_[i]);
+      }
     }
     for (auto fiter : frame_info_) {
       delete fiter.second;
@@ -416,6 +517,17 @@ class ExecutorImpl : public Executor {
                                      ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
 
+  // Returns whether the kernel of 'n' may be created on first use, which
+  // requires its memory types to be known without it.
+  bool CanCreateKernelLazily(const Node* n) const;
+
+  // Sets '*kernel' to the kernel of 'item', whose 'kernel' field is nullptr,
+  // creating it if this is its first use.
+  Status GetLazyKernel(const NodeItem& item, OpKernel** kernel) const;
+
+  // Creates the kernels that have not been used yet, in the background.
+  void WarmUpLazyKernels();
+
   FrameInfo* EnsureFrameInfo(const string& fname) {
     auto slot = &frame_info_[fname];
     if (*slot == nullptr) {
@@ -432,6 +544,23 @@ class ExecutorImpl : public Executor {
   // A cached value of params_
   bool device_record_tensor_accesses_ = false;
 
+  // Serves node outputs from a preallocated arena if
+  // params_.use_static_memory_arena is set.
+  std::unique_ptr<StaticMemoryArena> static_memory_arena_;
+
+  // The kernels created on first use if params_.lazy_kernel_creation is
+  // set, indexed by node id.
+  std::unique_ptr<std::atomic<OpKernel*>[]> lazy_kernels_;
+  mutable mutex lazy_kernels_mu_;
+  // Set to stop WarmUpLazyKernels(), which notifies warmup_done_ when it
+  // returns.
+  std::atomic<bool> stop_warmup_{false};
+  std::unique_ptr<Notification> warmup_done_;
+
+  // The cells that sampled steps record op latencies in, indexed by node id.
+  // Empty if op sampling is disabled.
+  std::vector<monitoring::SamplerCell*> op_latency_cells_;
+
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const Node*> root_nodes_;
 
@@ -671,10 +800,18 @@ Status ExecutorImpl::Initialize() {
     EnsureFrameInfo(it)->nodes = new std::vector<const Node*>;
   }
 
+  if (opsampling::Interval() > 0) {
+    op_latency_cells_.resize(graph_->num_node_ids());
+  }
+
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   for (const Node* n : graph_->nodes()) {
     const int id = n->id();
+    if (!op_latency_cells_.empty()) {
+      op_latency_cells_[id] =
+          opsampling::op_latency_usecs->GetCell(n->type_string());
+    }
     const string& frame_name = cf_info.frame_names[id];
     FrameInfo* frame_info = EnsureFrameInfo(frame_name);
 
@@ -689,16 +826,32 @@ Status ExecutorImpl::Initialize() {
     item->input_start = frame_info->total_inputs;
     frame_info->total_inputs += n->num_inputs();
 
-    Status s = params_.create_kernel(n->def(), &item->kernel);
-    if (!s.ok()) {
+    if (params_.lazy_kernel_creation && CanCreateKernelLazily(n)) {
+      if (lazy_kernels_ == nullptr) {
+        lazy_kernels_.reset(new std::atomic<OpKernel*>[graph_->num_node_ids()]);
+        for (int i = 0; i < graph_->num_node_ids(); ++i) {
+          lazy_kernels_[i] = nullptr;
+        }
+      }
+      // Until the kernel exists, assume it is expensive so that its node is
+      // not inlined, and look up whether it is async when it runs.
       item->kernel = nullptr;
-      s = AttachDef(s, *n);
-      LOG(ERROR) << "Executor failed to create kernel. " << s;
-      return s;
+      item->kernel_is_expensive = true;
+      item->kernel_is_async = false;
+      item->may_block = true;
+    } else {
+      Status s = params_.create_kernel(n->def(), &item->kernel);
+      if (!s.ok()) {
+        item->kernel = nullptr;
+        s = AttachDef(s, *n);
+        LOG(ERROR) << "Executor failed to create kernel. " << s;
+        return s;
+      }
+      CHECK(item->kernel);
+      item->kernel_is_expensive = item->kernel->IsExpensive();
+      item->kernel_is_async = (item->kernel->AsAsync() != nullptr);
+      item->may_block = item->kernel_is_async || n->op_def().is_stateful();
     }
-    CHECK(item->kernel);
-    item->kernel_is_expensive = item->kernel->IsExpensive();
-    item->kernel_is_async = (item->kernel->AsAsync() != nullptr);
     item->is_merge = IsMerge(n);
     item->is_enter = IsEnter(n);
     item->is_exit = IsExit(n);
@@ -729,7 +882,92 @@ Status ExecutorImpl::Initialize() {
   // all nodes.
   InitializePending(graph_.get(), cf_info);
 
-  return gview_.SetAllocAttrs(graph_.get(), params_.device);
+  if (params_.critical_path_priorities) {
+    // The post order visits the outputs of a node before the node, except
+    // for the back edges of loops, whose destinations count with the
+    // priority they have so far.
+    std::vector<Node*> order;
+    GetPostOrder(*graph_, &order);
+    for (const Node* n : order) {
+      int32 priority = 0;
+      for (const Edge* e : n->out_edges()) {
+        priority = std::max(priority, gview_.node(e->dst()->id())->priority);
+      }
+      gview_.node(n->id())->priority = priority + (n->IsOp() ? 1 : 0);
+    }
+  }
+
+  if (params_.use_static_memory_arena) {
+    // Nodes in loops run a varying number of times per step, so only the
+    // outputs of nodes in the root frame are planned.
+    std::vector<bool> plannable(graph_->num_node_ids(), false);
+    for (const Node* n : graph_->nodes()) {
+      plannable[n->id()] = n->IsOp() && cf_info.frame_names[n->id()].empty();
+    }
+    static_memory_arena_.reset(new StaticMemoryArena(
+        graph_.get(), params_.device->GetAllocator(AllocatorAttributes()),
+        plannable));
+  }
+
+  TF_RETURN_IF_ERROR(gview_.SetAllocAttrs(graph_.get(), params_.device));
+
+  if (lazy_kernels_ != nullptr) {
+    warmup_done_.reset(new Notification);
+    Env::Default()->SchedClosure([this]() { WarmUpLazyKernels(); });
+  }
+  return Status::OK();
+}
+
+bool ExecutorImpl::CanCreateKernelLazily(const Node* n) const {
+  // Function calls are not registered kernels, and their memory types are
+  // only known once they are instantiated.
+  if (params_.function_library != nullptr &&
+      params_.function_library->GetFunctionLibraryDefinition()->Find(
+          n->type_string()) != nullptr) {
+    return false;
+  }
+  MemoryTypeVector input_memory_types;
+  MemoryTypeVector output_memory_types;
+  return MemoryTypesForNode(OpRegistry::Global(),
+                            DeviceType(params_.device->device_type()),
+                            n->def(), &input_memory_types,
+                            &output_memory_types)
+      .ok();
+}
+
+Status ExecutorImpl::GetLazyKernel(const NodeItem& item,
+                                   OpKernel** kernel) const {
+  std::atomic<OpKernel*>* lazy_kernel = &lazy_kernels_[item.node->id()];
+  *kernel = lazy_kernel->load(std::memory_order_acquire);
+  if (*kernel != nullptr) return Status::OK();
+
+  mutex_lock l(lazy_kernels_mu_);
+  *kernel = lazy_kernel->load(std::memory_order_relaxed);
+  if (*kernel != nullptr) return Status::OK();
+  // Stateful kernels are still shared through the OpSegment by
+  // params_.create_kernel, whichever executor creates them first.
+  Status s = params_.create_kernel(item.node->def(), kernel);
+  if (!s.ok()) {
+    *kernel = nullptr;
+    return AttachDef(s, *item.node);
+  }
+  lazy_kernel->store(*kernel, std::memory_order_release);
+  return Status::OK();
+}
+
+void ExecutorImpl::WarmUpLazyKernels() {
+  for (const Node* n : graph_->nodes()) {
+    if (stop_warmup_) break;
+    const NodeItem* item = gview_.node(n->id());
+    if (item->kernel != nullptr) continue;
+    OpKernel* kernel;
+    Status s = GetLazyKernel(*item, &kernel);
+    if (!s.ok()) {
+      // The error is reported again when the node runs.
+      VLOG(1) << "Failed to create kernel in the background: " << s;
+    }
+  }
+  warmup_done_->Notify();
 }
 
 // If a Node has been marked to use a ScopedAllocator x for output i, then
@@ -817,10 +1055,21 @@ Status GraphView::SetAllocAttrs(const Graph* g, const Device* device) {
       }
     }
 
+    // Kernels created on first use have the memory types computed here.
+    MemoryTypeVector lazy_output_memory_types;
+    if (item->kernel == nullptr) {
+      MemoryTypeVector input_memory_types;
+      s = MemoryTypesForNode(OpRegistry::Global(),
+                             DeviceType(device->device_type()), n->def(),
+                             &input_memory_types, &lazy_output_memory_types);
+      if (!s.ok()) return s;
+    }
+    const MemoryTypeVector& output_memory_types =
+        item->kernel != nullptr ? item->kernel->output_memory_types()
+                                : lazy_output_memory_types;
     for (int out = 0; out < n->num_outputs(); out++) {
-      const OpKernel* op_kernel = item->kernel;
-      DCHECK_LT(out, op_kernel->output_memory_types().size());
-      bool on_host = op_kernel->output_memory_types()[out] == HOST_MEMORY;
+      DCHECK_LT(out, output_memory_types.size());
+      bool on_host = output_memory_types[out] == HOST_MEMORY;
       if (on_host) {
         AllocatorAttributes h;
         h.set_on_host(on_host);
@@ -1311,9 +1560,65 @@ class ExecutorState {
   CancellationManager* cancellation_manager_;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
+  // True if this step records op latencies.
+  const bool sample_ops_;
+
+  // The output allocators of the static memory arena, if this step uses it.
+  Allocator* const* static_output_allocators_ = nullptr;
 
   // Owned.
 
+  // A ready node waiting in one of the work-stealing deques, together with
+  // the time it became ready (for step stats).
+  struct StealableNode {
+    TaggedNode tagged_node{nullptr, nullptr, -1, false};
+    int64 scheduled_usec = 0;
+  };
+
+  // One deque per work-stealing worker. The owning worker pushes and pops
+  // at the back; peers steal from the front.
+  struct WorkerQueue {
+    mutex mu;
+    std::deque<StealableNode> nodes GUARDED_BY(mu);
+  };
+
+  // Number of work-stealing workers; 0 disables work stealing and every
+  // ready node that is not run inline is handed to runner_ directly.
+  const int num_stealing_workers_;
+  std::unique_ptr<WorkerQueue[]> worker_queues_;
+  std::atomic<int> num_active_workers_;
+  std::atomic<uint32> next_worker_queue_;
+
+  // A ready node waiting in prioritized_nodes_.
+  struct PrioritizedNode {
+    TaggedNode tagged_node{nullptr, nullptr, -1, false};
+    int64 scheduled_usec = 0;
+    int32 priority = 0;
+    // Breaks ties in favor of the node that became ready first.
+    uint64 seq = 0;
+
+    bool operator<(const PrioritizedNode& other) const {
+      if (priority != other.priority) return priority < other.priority;
+      return seq > other.seq;
+    }
+  };
+
+  // True if the executor schedules by critical-path priority, and work
+  // stealing is disabled. Ready nodes that are not run inline then wait in
+  // prioritized_nodes_, and each closure handed to runner_ runs the
+  // highest-priority node that is ready when the closure starts.
+  const bool use_priorities_;
+  mutex priority_mu_;
+  std::priority_queue<PrioritizedNode> prioritized_nodes_
+      GUARDED_BY(priority_mu_);
+  uint64 next_priority_seq_ GUARDED_BY(priority_mu_) = 0;
+
+  // One reference is held on behalf of the outstanding ops, and one by each
+  // active work-stealing worker or in-progress ScheduleReady() call that may
+  // touch the worker queues. Finish() runs when the last one is dropped, so
+  // that no worker can observe a deleted ExecutorState.
+  std::atomic<int> finish_refs_;
+
   // A flag that is set on error after the frame state has been
   // dumped for diagnostic purposes.
   bool dumped_on_error_ = false;
@@ -1355,8 +1660,9 @@ class ExecutorState {
   void CleanupFramesIterations(FrameState* frame, int64 iter,
                                TaggedNodeSeq* ready);
 
-  // Process a ready node in current thread.
-  void Process(TaggedNode node, int64 scheduled_usec);
+  // Process a ready node in current thread. "worker_queue" is the index of
+  // the work-stealing deque owned by the current thread, or -1.
+  void Process(TaggedNode node, int64 scheduled_usec, int worker_queue = -1);
 
   // Before invoking item->kernel, fills in its "inputs".
   Status PrepareInputs(const NodeItem& item, Entry* first_input,
@@ -1379,12 +1685,38 @@ class ExecutorState {
   // execution has completed.
   bool NodeDone(const Status& s, const Node* node, const TaggedNodeSeq& ready,
                 NodeExecStatsWrapper* stats,
-                TaggedNodeReadyQueue* inline_ready);
+                TaggedNodeReadyQueue* inline_ready, int worker_queue = -1);
 
   // Schedule all the expensive nodes in 'ready', and put all the inexpensive
   // nodes in 'ready' into 'inline_ready'.
   void ScheduleReady(const TaggedNodeSeq& ready,
-                     TaggedNodeReadyQueue* inline_ready);
+                     TaggedNodeReadyQueue* inline_ready,
+                     int worker_queue = -1);
+
+  // Runs 'tagged_node' on another thread: either through runner_, or by
+  // pushing it onto a work-stealing deque ('worker_queue' if >= 0).
+  void Dispatch(const TaggedNode& tagged_node, int64 scheduled_usec,
+                int worker_queue);
+
+  // Starts another work-stealing worker if fewer than
+  // num_stealing_workers_ are active.
+  void MaybeStartWorker();
+
+  // Pops the highest-priority node from prioritized_nodes_ and processes it.
+  void ProcessHighestPriorityNode();
+
+  // Returns true if any work-stealing deque is non-empty.
+  bool HasStealableNodes();
+
+  // Pops a node from deque 'worker_queue', or steals one from a peer.
+  // Returns false if all deques are empty.
+  bool PopStealableNode(int worker_queue, StealableNode* node);
+
+  // Body of a work-stealing worker that owns deque 'worker_queue'.
+  void RunWorker(int worker_queue);
+
+  // Drops one of finish_refs_ and calls Finish() if it was the last one.
+  void MaybeFinish();
 
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter, int64 id);
@@ -1431,7 +1763,17 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       cancellation_manager_(args.cancellation_manager),
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
+      sample_ops_(opsampling::SampleStep()),
+      num_stealing_workers_(std::max(0, args.num_stealing_workers)),
+      num_active_workers_(0),
+      next_worker_queue_(0),
+      use_priorities_(impl->params_.critical_path_priorities &&
+                      num_stealing_workers_ == 0),
+      finish_refs_(1),
       num_outstanding_ops_(0) {
+  if (num_stealing_workers_ > 0) {
+    worker_queues_.reset(new WorkerQueue[num_stealing_workers_]);
+  }
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
   // We assume root_frame_->frame_name.empty().
@@ -1445,9 +1787,16 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       root_frame_->pending_counts, root_frame_->total_input_tensors);
 
   outstanding_frames_.insert({root_frame_->frame_name, root_frame_});
+
+  if (impl_->static_memory_arena_ != nullptr) {
+    static_output_allocators_ = impl_->static_memory_arena_->BeginStep();
+  }
 }
 
 ExecutorState::~ExecutorState() {
+  if (static_output_allocators_ != nullptr) {
+    impl_->static_memory_arena_->EndStep();
+  }
   for (auto name_frame : outstanding_frames_) {
     delete name_frame.second;
   }
@@ -1603,6 +1952,8 @@ struct ExecutorState::AsyncState {
   Entry* first_input;
   OpKernelContext ctx;
   NodeExecStatsWrapper* stats;
+  // When the kernel started, if the step samples op latencies.
+  int64 start_usecs = 0;
 
  private:
   OpKernelContext::Params* ParamsButClearingEigenGPUDevice(
@@ -1614,7 +1965,8 @@ struct ExecutorState::AsyncState {
   }
 };
 
-void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
+void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec,
+                            int worker_queue) {
   const GraphView& gview = impl_->gview_;
   TaggedNodeSeq ready;
   TaggedNodeReadyQueue inline_ready;
@@ -1702,10 +2054,17 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
     if (tagged_node.is_dead && !IsTransferNode(node)) {
       outputs.resize(item.num_outputs);
     } else {
+      OpKernel* op_kernel = item.kernel;
+      s = Status::OK();
+      if (op_kernel == nullptr) {
+        s = impl_->GetLazyKernel(item, &op_kernel);
+      }
       // Prepares inputs.
       bool is_input_dead = false;
-      s = PrepareInputs(item, first_input, &inputs, &input_device_contexts,
-                        &input_alloc_attrs, &is_input_dead);
+      if (s.ok()) {
+        s = PrepareInputs(item, first_input, &inputs, &input_device_contexts,
+                          &input_alloc_attrs, &is_input_dead);
+      }
       if (!s.ok()) {
         // Clear inputs.
         int num_inputs = item.num_inputs;
@@ -1714,21 +2073,29 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
         }
         MaybeMarkCompleted(input_frame, input_iter, id);
         // Continue to process the nodes in 'inline_ready'.
-        completed = NodeDone(s, item.node, ready, stats, &inline_ready);
+        completed =
+            NodeDone(s, item.node, ready, stats, &inline_ready, worker_queue);
         continue;
       }
 
       // Set up compute params.
-      OpKernel* op_kernel = item.kernel;
       params.op_kernel = op_kernel;
       params.frame_iter = FrameAndIter(input_frame->frame_id, input_iter);
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
       params.forward_from_array = item.forward_from();
+      params.output_allocator_array = nullptr;
+      if (static_output_allocators_ != nullptr) {
+        const int base = impl_->static_memory_arena_->output_base(id);
+        if (base >= 0) {
+          params.output_allocator_array = static_output_allocators_ + base;
+        }
+      }
 
-      if (item.kernel_is_async) {
+      if (item.kernel != nullptr ? item.kernel_is_async
+                                 : op_kernel->AsAsync() != nullptr) {
         // Asynchronous computes.
-        AsyncOpKernel* async = item.kernel->AsAsync();
+        AsyncOpKernel* async = op_kernel->AsAsync();
         DCHECK(async != nullptr);
         launched_asynchronously = true;
         AsyncState* state =
@@ -1740,6 +2107,11 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
           Entry* first_input = state->first_input;     // Shorthand
 
           nodestats::SetOpEnd(stats);
+          if (sample_ops_) {
+            opsampling::Record(
+                impl_->op_latency_cells_[state->tagged_node.node->id()],
+                state->start_usecs);
+          }
           EntryVector outputs;
           Status s = ProcessOutputs(*state->item, &state->ctx, &outputs, stats);
           nodestats::SetMemory(stats, &state->ctx);
@@ -1777,16 +2149,27 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
           const bool completed =
               NodeDone(s, state->item->node, ready, stats, nullptr);
           delete state;
-          if (completed) Finish();
+          if (completed) MaybeFinish();
         };
         nodestats::SetOpStart(stats);
+        if (sample_ops_) state->start_usecs = Env::Default()->NowMicros();
+        ScopedMemoryAnnotation memory_annotation(&op_kernel->name(), step_id_);
         device->ComputeAsync(async, &state->ctx, done);
       } else {
         // Synchronous computes.
         OpKernelContext ctx(&params, item.num_outputs);
         nodestats::SetOpStart(stats);
-        device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+        const int64 start_usecs =
+            sample_ops_ ? Env::Default()->NowMicros() : 0;
+        {
+          ScopedMemoryAnnotation memory_annotation(&op_kernel->name(),
+                                                   step_id_);
+          device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+        }
         nodestats::SetOpEnd(stats);
+        if (sample_ops_) {
+          opsampling::Record(impl_->op_latency_cells_[id], start_usecs);
+        }
         s = ProcessOutputs(item, &ctx, &outputs, stats);
         if (s.ok() && impl_->device_record_tensor_accesses_) {
           // Get the list of all tensors accessed during the execution
@@ -1825,12 +2208,13 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
         scheduled_usec = nodestats::NowInUsec();
       }
       // Postprocess.
-      completed = NodeDone(s, item.node, ready, stats, &inline_ready);
+      completed =
+          NodeDone(s, item.node, ready, stats, &inline_ready, worker_queue);
     }
   }  // while !inline_ready.empty()
 
   // This thread of computation is done if completed = true.
-  if (completed) Finish();
+  if (completed) MaybeFinish();
 }
 
 Status ExecutorState::PrepareInputs(const NodeItem& item, Entry* first_input,
@@ -1876,7 +2260,7 @@ Status ExecutorState::PrepareInputs(const NodeItem& item, Entry* first_input,
       if (expect_ref) {
         return AttachDef(
             errors::InvalidArgument(i, "-th input expects a ref type"),
-            item.kernel->def());
+            item.node->def());
       }
       inp->tensor = entry->val.get();
     } else {
@@ -1885,8 +2269,8 @@ Status ExecutorState::PrepareInputs(const NodeItem& item, Entry* first_input,
         if (!entry->ref->IsInitialized() && !IsInitializationOp(item.node)) {
           return AttachDef(errors::FailedPrecondition(
                                "Attempting to use uninitialized value ",
-                               item.kernel->requested_input(i)),
-                           item.kernel->def());
+                               item.node->requested_inputs().Get(i)),
+                           item.node->def());
         }
       }
       if (expect_ref) {
@@ -1917,7 +2301,7 @@ Status ExecutorState::PrepareInputs(const NodeItem& item, Entry* first_input,
                   DataTypeString(item.input_type(i)),
                   " but automatically dereferenced input tensor has type ",
                   DataTypeString(inp->tensor->dtype())),
-              item.kernel->def());
+              item.node->def());
         }
       }
     }
@@ -1934,7 +2318,7 @@ Status ExecutorState::ProcessOutputs(const NodeItem& item, OpKernelContext* ctx,
 
   Status s = ctx->status();
   if (!s.ok()) {
-    s = AttachDef(s, item.kernel->def());
+    s = AttachDef(s, item.node->def());
     // TODO(misard) Replace with a finer-grain enabling flag once we
     // add better optional debugging support.
     if (vlog_ && VLOG_IS_ON(1)) {
@@ -2167,7 +2551,8 @@ void ExecutorState::PropagateOutputs(const TaggedNode& tagged_node,
 bool ExecutorState::NodeDone(const Status& s, const Node* node,
                              const TaggedNodeSeq& ready,
                              NodeExecStatsWrapper* stats,
-                             TaggedNodeReadyQueue* inline_ready) {
+                             TaggedNodeReadyQueue* inline_ready,
+                             int worker_queue) {
   nodestats::SetAllEnd(stats);
   if (stats_collector_ != nullptr && !SetTimelineLabel(node, stats)) {
     // Only record non-transfer nodes.
@@ -2209,54 +2594,200 @@ bool ExecutorState::NodeDone(const Status& s, const Node* node,
 
   // Schedule the ready nodes in 'ready'.
   if (s.ok()) {
-    ScheduleReady(ready, inline_ready);
+    ScheduleReady(ready, inline_ready, worker_queue);
   }
   return completed;
 }
 
 void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
-                                  TaggedNodeReadyQueue* inline_ready) {
+                                  TaggedNodeReadyQueue* inline_ready,
+                                  int worker_queue) {
   if (ready.empty()) return;
 
   int64 scheduled_usec = 0;
   if (stats_collector_) {
     scheduled_usec = nodestats::NowInUsec();
   }
+  if (worker_queues_ != nullptr) {
+    // The nodes in 'ready' are still outstanding, so this cannot be the last
+    // reference. Holding it keeps 'this' alive while we touch the worker
+    // queues, even if the nodes we push complete the step on other threads.
+    finish_refs_.fetch_add(1, std::memory_order_relaxed);
+  }
   if (inline_ready == nullptr) {
     // Schedule to run all the ready ops in thread pool.
     for (auto& tagged_node : ready) {
-      runner_([=]() { Process(tagged_node, scheduled_usec); });
+      Dispatch(tagged_node, scheduled_usec, worker_queue);
+    }
+  } else {
+    const GraphView& gview = impl_->gview_;
+    const TaggedNode* curr_expensive_node = nullptr;
+    for (auto& tagged_node : ready) {
+      const NodeItem& item = *gview.node(tagged_node.node->id());
+      if (tagged_node.is_dead || !item.kernel_is_expensive) {
+        // Inline this inexpensive node.
+        inline_ready->push_back(tagged_node);
+      } else if (use_priorities_ && curr_expensive_node &&
+                 item.priority <=
+                     gview.node(curr_expensive_node->node->id())->priority) {
+        // Keep the highest-priority expensive node for this thread.
+        Dispatch(tagged_node, scheduled_usec, worker_queue);
+      } else {
+        if (curr_expensive_node) {
+          // Dispatch to another thread since there is plenty of work to
+          // do for this thread.
+          Dispatch(*curr_expensive_node, scheduled_usec, worker_queue);
+        }
+        curr_expensive_node = &tagged_node;
+      }
+    }
+    if (curr_expensive_node) {
+      if (inline_ready->empty()) {
+        // Tail recursion optimization
+        inline_ready->push_back(*curr_expensive_node);
+      } else {
+        // There are inline nodes to run already. We dispatch this expensive
+        // node to other thread.
+        Dispatch(*curr_expensive_node, scheduled_usec, worker_queue);
+      }
     }
+  }
+  if (worker_queues_ != nullptr) {
+    MaybeFinish();
+  }
+}
+
+void ExecutorState::Dispatch(const TaggedNode& tagged_node,
+                             int64 scheduled_usec, int worker_queue) {
+  if (use_priorities_) {
+    {
+      mutex_lock l(priority_mu_);
+      PrioritizedNode node;
+      node.tagged_node = tagged_node;
+      node.scheduled_usec = scheduled_usec;
+      node.priority = impl_->gview_.node(tagged_node.node->id())->priority;
+      node.seq = next_priority_seq_++;
+      prioritized_nodes_.push(node);
+    }
+    runner_([this]() { ProcessHighestPriorityNode(); });
     return;
   }
-  const GraphView& gview = impl_->gview_;
-  const TaggedNode* curr_expensive_node = nullptr;
-  for (auto& tagged_node : ready) {
-    const NodeItem& item = *gview.node(tagged_node.node->id());
-    if (tagged_node.is_dead || !item.kernel_is_expensive) {
-      // Inline this inexpensive node.
-      inline_ready->push_back(tagged_node);
-    } else {
-      if (curr_expensive_node) {
-        // Dispatch to another thread since there is plenty of work to
-        // do for this thread.
-        runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_usec));
-      }
-      curr_expensive_node = &tagged_node;
+  // The work-stealing workers are bounded, so a node that waits for another
+  // node of the step could occupy all of them while the node it waits for
+  // sits in a deque. Such nodes get their own runner_ closure, as without
+  // work stealing. The remaining nodes are synchronous and stateless, so
+  // they only depend on inputs that are already available.
+  if (worker_queues_ == nullptr ||
+      impl_->gview_.node(tagged_node.node->id())->may_block) {
+    runner_(std::bind(&ExecutorState::Process, this, tagged_node,
+                      scheduled_usec, -1));
+    return;
+  }
+  if (worker_queue < 0) {
+    // Not called from a worker (e.g. RunAsync() or an async kernel's done
+    // callback): spread the nodes over the deques round-robin.
+    worker_queue = next_worker_queue_.fetch_add(1, std::memory_order_relaxed) %
+                   num_stealing_workers_;
+  }
+  {
+    WorkerQueue& queue = worker_queues_[worker_queue];
+    mutex_lock l(queue.mu);
+    StealableNode node;
+    node.tagged_node = tagged_node;
+    node.scheduled_usec = scheduled_usec;
+    queue.nodes.push_back(node);
+  }
+  MaybeStartWorker();
+}
+
+void ExecutorState::MaybeStartWorker() {
+  int active = num_active_workers_.load();
+  while (active < num_stealing_workers_) {
+    if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+      finish_refs_.fetch_add(1, std::memory_order_relaxed);
+      const int worker_queue =
+          next_worker_queue_.fetch_add(1, std::memory_order_relaxed) %
+          num_stealing_workers_;
+      runner_([this, worker_queue]() { RunWorker(worker_queue); });
+      return;
     }
   }
-  if (curr_expensive_node) {
-    if (inline_ready->empty()) {
-      // Tail recursion optimization
-      inline_ready->push_back(*curr_expensive_node);
-    } else {
-      // There are inline nodes to run already. We dispatch this expensive
-      // node to other thread.
-      runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                        scheduled_usec));
+}
+
+void ExecutorState::ProcessHighestPriorityNode() {
+  PrioritizedNode node;
+  {
+    mutex_lock l(priority_mu_);
+    // There is one closure per pushed node, so the queue is not empty.
+    DCHECK(!prioritized_nodes_.empty());
+    node = prioritized_nodes_.top();
+    prioritized_nodes_.pop();
+  }
+  Process(node.tagged_node, node.scheduled_usec);
+}
+
+bool ExecutorState::HasStealableNodes() {
+  for (int i = 0; i < num_stealing_workers_; ++i) {
+    WorkerQueue& queue = worker_queues_[i];
+    mutex_lock l(queue.mu);
+    if (!queue.nodes.empty()) return true;
+  }
+  return false;
+}
+
+bool ExecutorState::PopStealableNode(int worker_queue, StealableNode* node) {
+  {
+    // Newest first from our own deque: its inputs are most likely still hot
+    // in this thread's cache.
+    WorkerQueue& queue = worker_queues_[worker_queue];
+    mutex_lock l(queue.mu);
+    if (!queue.nodes.empty()) {
+      *node = queue.nodes.back();
+      queue.nodes.pop_back();
+      return true;
+    }
+  }
+  for (int i = 1; i < num_stealing_workers_; ++i) {
+    // Oldest first from a peer's deque.
+    WorkerQueue& queue =
+        worker_queues_[(worker_queue + i) % num_stealing_workers_];
+    mutex_lock l(queue.mu);
+    if (!queue.nodes.empty()) {
+      *node = queue.nodes.front();
+      queue.nodes.pop_front();
+      return true;
     }
   }
+  return false;
+}
+
+void ExecutorState::RunWorker(int worker_queue) {
+  StealableNode node;
+  while (true) {
+    while (PopStealableNode(worker_queue, &node)) {
+      Process(node.tagged_node, node.scheduled_usec, worker_queue);
+    }
+    num_active_workers_.fetch_sub(1);
+    // A node may have been pushed after our last pop but before the
+    // decrement above, by a thread that saw all workers active and so did
+    // not start a new one. Re-check and resume if a worker slot is free.
+    if (!HasStealableNodes()) break;
+    int active = num_active_workers_.load();
+    bool resumed = false;
+    while (active < num_stealing_workers_) {
+      if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+        resumed = true;
+        break;
+      }
+    }
+    if (!resumed) break;
+  }
+  // Must be the last use of 'this'.
+  MaybeFinish();
+}
+
+void ExecutorState::MaybeFinish() {
+  if (finish_refs_.fetch_sub(1) == 1) Finish();
 }
 
 inline void ExecutorState::MaybeMarkCompleted(FrameState* frame, int64 iter,
@@ -94,6 +94,16 @@ class Executor {
     // If true, calls Sync() on the device.
     bool sync_on_finish = false;
 
+    // If > 0, ready nodes are not handed to "runner" one closure at a
+    // time. Instead, up to this many worker loops are started through
+    // "runner"; each owns a local deque of ready nodes and steals from its
+    // peers when the local deque runs dry. This amortizes the closure and
+    // thread pool overhead over many nodes for graphs with many small ops.
+    // Nodes that may block (async kernels and stateful ops such as queue
+    // ops and Recv) are still handed to "runner" one closure each, so the
+    // bounded workers cannot all wait on nodes stuck in their deques.
+    int num_stealing_workers = 0;
+
     typedef std::function<void()> Closure;
     typedef std::function<void(Closure)> Runner;
     Runner runner = nullptr;
@@ -141,6 +151,23 @@ struct LocalExecutorParams {
   std::function<void(OpKernel*)> delete_kernel;
 
   Executor::Args::NodeOutputsCallback node_outputs_cb;
+
+  // If true, the outputs of the nodes are planned into one arena allocated
+  // from the device after the first step. See StaticMemoryArena.
+  bool use_static_memory_arena = false;
+
+  // If true, the kernels of most nodes are created when the nodes first run
+  // rather than when the executor is created, and a background thread creates
+  // the remaining ones afterwards. Errors in creating a kernel are then
+  // reported by the step that first runs its node.
+  bool lazy_kernel_creation = false;
+
+  // If true, every node gets a static priority, the number of ops on the
+  // longest path from it to the sink, and the ready nodes that are not run
+  // inline are run highest priority first, so that the critical path of the
+  // graph is not held up by other work when the threads are contended. Has
+  // no effect with work stealing (see Executor::Args::num_stealing_workers).
+  bool critical_path_priorities = false;
 };
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       std::unique_ptr<const Graph> graph,
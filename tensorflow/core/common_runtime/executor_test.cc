@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <deque>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
@@ -22,11 +23,15 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -68,6 +73,8 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
+    params.node_outputs_cb = node_outputs_cb_;
+    params.critical_path_priorities = critical_path_priorities_;
     delete exec_;
     TF_CHECK_OK(NewLocalExecutor(params, std::move(graph), &exec_));
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
@@ -79,6 +86,7 @@ class ExecutorTest : public ::testing::Test {
     args.rendezvous = rendez;
     args.stats_collector = &step_stats_collector_;
     args.runner = runner_;
+    args.num_stealing_workers = num_stealing_workers_;
     return exec_->Run(args);
   }
 
@@ -89,6 +97,9 @@ class ExecutorTest : public ::testing::Test {
   StepStats step_stats_;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
+  int num_stealing_workers_ = 0;
+  Executor::Args::NodeOutputsCallback node_outputs_cb_;
+  bool critical_path_priorities_ = false;
 };
 
 // A float val -> Tensor<float>
@@ -243,6 +254,85 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  num_stealing_workers_ = 4;
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+// Adds a chain of "length" Neg nodes to "input", and returns its first node.
+Node* NegChain(Graph* g, Node* input, int length) {
+  Node* first = test::graph::Unary(g, "Neg", input);
+  Node* last = first;
+  for (int i = 1; i < length; ++i) {
+    last = test::graph::Unary(g, "Neg", last);
+  }
+  return first;
+}
+
+TEST_F(ExecutorTest, CriticalPathPriorities) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  Node* in = test::graph::Constant(g.get(), V(1.0));
+  const string short_chain = NegChain(g.get(), in, 1)->name();
+  const string critical_chain = NegChain(g.get(), in, 6)->name();
+  const string medium_chain = NegChain(g.get(), in, 3)->name();
+  mutex mu;
+  std::vector<string> order;
+  node_outputs_cb_ = [&mu, &order](const string& node_name, int output_slot,
+                                   const Tensor* tensor, bool is_ref,
+                                   OpKernelContext* ctx) {
+    mutex_lock l(mu);
+    order.push_back(node_name);
+    return Status::OK();
+  };
+  critical_path_priorities_ = true;
+  Create(std::move(g));
+
+  // Runs the closures one at a time, in the order they are scheduled.
+  std::deque<std::function<void()>> closures;
+  Executor::Args args;
+  args.rendezvous = rendez_;
+  args.runner = [&mu, &closures](std::function<void()> fn) {
+    mutex_lock l(mu);
+    closures.push_back(std::move(fn));
+  };
+  Notification done;
+  Status status;
+  exec_->RunAsync(args, [&done, &status](const Status& s) {
+    status = s;
+    done.Notify();
+  });
+  while (!done.HasBeenNotified()) {
+    std::function<void()> fn;
+    {
+      mutex_lock l(mu);
+      ASSERT_FALSE(closures.empty());
+      fn = std::move(closures.front());
+      closures.pop_front();
+    }
+    fn();
+  }
+  TF_ASSERT_OK(status);
+
+  // The longest chain runs first, whatever the order of the ready nodes.
+  auto position = [&order](const string& name) -> int64 {
+    return std::find(order.begin(), order.end(), name) - order.begin();
+  };
+  EXPECT_LT(position(critical_chain), position(medium_chain));
+  EXPECT_LT(position(medium_chain), position(short_chain));
+  EXPECT_LT(position(short_chain), static_cast<int64>(order.size()));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -280,6 +370,71 @@ TEST_F(ExecutorTest, ConcurrentAddAssign) {
 }
 #endif
 
+#ifndef THREAD_SANITIZER
+TEST_F(ExecutorTest, ConcurrentAddAssignWorkStealing) {
+  num_stealing_workers_ = 4;
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  BuildConcurrentAddAssign(g.get());
+  Create(std::move(g));
+  for (int iters = 0; iters < 16; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez));
+    Rendezvous::Args args;
+    Tensor out;
+    bool is_dead;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, kIncarnation, BOB, "out"), args, &out,
+                              &is_dead));
+    EXPECT_LE(V(out), 1025.0);
+    rendez->Unref();
+  }
+}
+#endif
+
+// TestBlock waits until TestUnblock has run. The two ops are stateful and
+// not connected, so a step with both only finishes if they run on
+// different threads.
+static Notification* test_unblocked = nullptr;
+
+class TestBlockOp : public OpKernel {
+ public:
+  explicit TestBlockOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+  void Compute(OpKernelContext* ctx) override {
+    test_unblocked->WaitForNotification();
+  }
+};
+
+class TestUnblockOp : public OpKernel {
+ public:
+  explicit TestUnblockOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+  void Compute(OpKernelContext* ctx) override { test_unblocked->Notify(); }
+};
+
+REGISTER_OP("TestBlock").SetIsStateful();
+REGISTER_OP("TestUnblock").SetIsStateful();
+REGISTER_KERNEL_BUILDER(Name("TestBlock").Device(DEVICE_CPU), TestBlockOp);
+REGISTER_KERNEL_BUILDER(Name("TestUnblock").Device(DEVICE_CPU),
+                        TestUnblockOp);
+
+TEST_F(ExecutorTest, WorkStealingDoesNotRunBlockingNodes) {
+  // With a single worker, running both nodes on it would deadlock.
+  num_stealing_workers_ = 1;
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK(NodeBuilder(g->NewName("block"), "TestBlock")
+                     .Finalize(g.get(), nullptr));
+  }
+  TF_ASSERT_OK(NodeBuilder(g->NewName("unblock"), "TestUnblock")
+                   .Finalize(g.get(), nullptr));
+  Create(std::move(g));
+  thread::ThreadPool pool(Env::Default(), "test", 8);
+  runner_ = [&pool](std::function<void()> fn) { pool.Schedule(fn); };
+  Notification unblocked;
+  test_unblocked = &unblocked;
+  TF_ASSERT_OK(Run(rendez_));
+  EXPECT_TRUE(unblocked.HasBeenNotified());
+  test_unblocked = nullptr;
+}
+
 TEST_F(ExecutorTest, SimpleSwitchLive) {
   std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
   auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function.h"
 
 #include <deque>
+#include <map>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -213,13 +215,50 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
     uint64 instantiation_counter = 0;
     const Graph* graph = nullptr;                            // Owned by exec.
     const FunctionLibraryDefinition* overlay_lib = nullptr;  // Not owned.
+    std::map<int, Tensor> const_args;
+    std::map<int, PartialTensorShape> arg_shapes;
     FunctionBody* func_graph = nullptr;
     Executor* exec = nullptr;
 
+    // Call frames of finished runs, which later runs reuse.
+    mutex frames_mu;
+    std::vector<FunctionCallFrame*> free_frames GUARDED_BY(frames_mu);
+
     ~Item() {
+      for (FunctionCallFrame* frame : free_frames) delete frame;
       delete this->func_graph;
       delete this->exec;
     }
+
+    // Returns a call frame for a run of the function, which the caller
+    // passes to ReturnFrame() when the run is done.
+    FunctionCallFrame* GetFrame() {
+      {
+        mutex_lock l(frames_mu);
+        if (!free_frames.empty()) {
+          FunctionCallFrame* frame = free_frames.back();
+          free_frames.pop_back();
+          return frame;
+        }
+      }
+      return new FunctionCallFrame(func_graph->arg_types,
+                                   func_graph->ret_types);
+    }
+
+    void ReturnFrame(FunctionCallFrame* frame) {
+      // Drops the tensors of the run, which the frame must not keep alive.
+      frame->Reset();
+      {
+        mutex_lock l(frames_mu);
+        if (free_frames.size() < kMaxFreeFrames) {
+          free_frames.push_back(frame);
+          return;
+        }
+      }
+      delete frame;
+    }
+
+    static constexpr size_t kMaxFreeFrames = 16;
   };
   std::unordered_map<Handle, std::unique_ptr<Item>> items_ GUARDED_BY(mu_);
 
@@ -548,6 +587,8 @@ Status FunctionLibraryRuntimeImpl::Instantiate(
       Item* item = new Item;
       item->func_graph = fbody;
       item->overlay_lib = options.overlay_lib;
+      item->const_args = options.const_args;
+      item->arg_shapes = options.arg_shapes;
       item->instantiation_counter = 1;
       items_.emplace(next_handle_, std::unique_ptr<Item>(item));
       next_handle_++;
@@ -618,15 +659,75 @@ void PruneFunctionBody(Graph* g) {
     FixupSourceAndSinkEdges(g);
   }
 }
+
+// Replaces the arguments of the function body "g" whose values are in
+// "const_args" with constants, and adds the shapes of the arguments in
+// "arg_shapes" to "shape_map", so that the optimizer can fold the
+// computations that depend on them.
+Status SpecializeFunctionBody(
+    const std::map<int, Tensor>& const_args,
+    const std::map<int, PartialTensorShape>& arg_shapes, Graph* g,
+    std::unordered_map<string, std::vector<PartialTensorShape>>* shape_map) {
+  if (const_args.empty() && arg_shapes.empty()) return Status::OK();
+  std::vector<Node*> args;
+  for (Node* n : g->op_nodes()) {
+    if (n->type_string() == kArgOp) args.push_back(n);
+  }
+  for (Node* n : args) {
+    int index;
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+    auto shape = arg_shapes.find(index);
+    if (shape != arg_shapes.end()) {
+      (*shape_map)[n->name()] = {shape->second};
+    }
+    auto value = const_args.find(index);
+    if (value == const_args.end()) continue;
+    if (value->second.dtype() != n->output_type(0)) {
+      return errors::InvalidArgument(
+          "Constant argument ", index, " is of type ",
+          DataTypeString(value->second.dtype()), " but the function expects ",
+          DataTypeString(n->output_type(0)));
+    }
+    NodeDef const_def;
+    TF_RETURN_IF_ERROR(NodeDefBuilder(n->name(), "Const")
+                           .Attr("dtype", value->second.dtype())
+                           .Attr("value", value->second)
+                           .Device(n->requested_device())
+                           .Finalize(&const_def));
+    // The destinations of the out-edges of the argument, which removing it
+    // deletes.
+    std::vector<std::pair<Node*, int>> outputs;
+    for (const Edge* e : n->out_edges()) {
+      outputs.emplace_back(e->dst(), e->dst_input());
+    }
+    g->RemoveNode(n);
+    Status s;
+    Node* c = g->AddNode(const_def, &s);
+    TF_RETURN_IF_ERROR(s);
+    for (const auto& output : outputs) {
+      if (output.second == Graph::kControlSlot) {
+        g->AddControlEdge(c, output.first);
+      } else {
+        g->AddEdge(c, 0, output.first, output.second);
+      }
+    }
+  }
+  FixupSourceAndSinkEdges(g);
+  return Status::OK();
+}
 }  // namespace
 
 Status FunctionLibraryRuntimeImpl::CreateItem(Handle handle, Item** item) {
   const FunctionBody* fbody;
   const FunctionLibraryDefinition* lib_def;
+  const std::map<int, Tensor>* const_args;
+  const std::map<int, PartialTensorShape>* arg_shapes;
   {
     mutex_lock l(mu_);
     fbody = (*item)->func_graph;
     lib_def = (*item)->overlay_lib;
+    const_args = &(*item)->const_args;
+    arg_shapes = &(*item)->arg_shapes;
   }
   if (!lib_def) {
     lib_def = base_lib_def_;
@@ -634,8 +735,12 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Handle handle, Item** item) {
   std::unique_ptr<Graph> g(new Graph(lib_def));
   CopyGraph(*fbody->graph, g.get());
 
+  std::unordered_map<string, std::vector<PartialTensorShape>> shape_map;
+  TF_RETURN_IF_ERROR(
+      SpecializeFunctionBody(*const_args, *arg_shapes, g.get(), &shape_map));
   PruneFunctionBody(g.get());
-  optimizer_.Optimize(this, env(), device(), &g, /*shape_map=*/nullptr);
+  optimizer_.Optimize(this, env(), device(), &g,
+                      shape_map.empty() ? nullptr : &shape_map);
   TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(device()->device_type()),
                                        device()->name(), g.get()));
 
@@ -802,53 +907,59 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   }
   DCHECK(run_opts.runner != nullptr);
 
-  Executor::Args* exec_args = new Executor::Args;
-  // Inherit the step_id from the caller.
-  exec_args->step_id = run_opts.step_id;
-  exec_args->rendezvous = run_opts.rendezvous;
-  exec_args->stats_collector = run_opts.stats_collector;
-  exec_args->cancellation_manager = run_opts.cancellation_manager;
-  exec_args->step_container = run_opts.step_container;
-  exec_args->runner = *run_opts.runner;
-  exec_args->collective_executor = run_opts.collective_executor;
-
   Item* item = nullptr;
   Status s = GetOrCreateItem(handle, &item);
   if (!s.ok()) {
-    delete exec_args;
     done(s);
     return;
   }
 
   if (run_opts.remote_execution) {
+    Executor::Args* exec_args = new Executor::Args;
+    // Inherit the step_id from the caller.
+    exec_args->step_id = run_opts.step_id;
+    exec_args->rendezvous = run_opts.rendezvous;
+    exec_args->stats_collector = run_opts.stats_collector;
+    exec_args->cancellation_manager = run_opts.cancellation_manager;
+    exec_args->step_container = run_opts.step_container;
+    exec_args->runner = *run_opts.runner;
+    exec_args->collective_executor = run_opts.collective_executor;
     // NOTE(mrry): `RunRemote()` will set `exec_args->call_frame` for us.
     RunRemote(run_opts, handle, args, rets, exec_args, item, done);
     return;
   }
 
-  const FunctionBody* fbody = GetFunctionBody(handle);
-  FunctionCallFrame* frame =
-      new FunctionCallFrame(fbody->arg_types, fbody->ret_types);
-  exec_args->call_frame = frame;
+  // The executor copies its arguments, so they need not outlive this call.
+  // Call frames are reused across the runs of the item, since small
+  // functions are often run back to back.
+  FunctionCallFrame* frame = item->GetFrame();
   s = frame->SetArgs(args);
   if (!s.ok()) {
-    delete frame;
-    delete exec_args;
+    item->ReturnFrame(frame);
     done(s);
     return;
   }
+  Executor::Args exec_args;
+  // Inherit the step_id from the caller.
+  exec_args.step_id = run_opts.step_id;
+  exec_args.rendezvous = run_opts.rendezvous;
+  exec_args.stats_collector = run_opts.stats_collector;
+  exec_args.cancellation_manager = run_opts.cancellation_manager;
+  exec_args.step_container = run_opts.step_container;
+  exec_args.runner = *run_opts.runner;
+  exec_args.collective_executor = run_opts.collective_executor;
+  exec_args.call_frame = frame;
 
   item->exec->RunAsync(
       // Executor args
-      *exec_args,
+      exec_args,
       // Done callback.
-      [frame, rets, done, exec_args](const Status& status) {
+      [item, frame, rets, done](const Status& status) {
         Status s = status;
         if (s.ok()) {
           s = frame->ConsumeRetvals(rets);
         }
-        delete frame;
-        delete exec_args;
+        item->ReturnFrame(frame);
         done(s);
       });
 }
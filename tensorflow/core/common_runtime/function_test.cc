@@ -379,6 +379,27 @@ TEST_F(FunctionLibraryRuntimeTest, XTimesTwo) {
   test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
 }
 
+TEST_F(FunctionLibraryRuntimeTest, RunRepeatedly) {
+  Init({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, &handle));
+
+  // Back-to-back runs of a handle reuse call frames, which must not carry
+  // values over from earlier runs.
+  FunctionLibraryRuntime::Options opts;
+  Tensor y;
+  for (int i = 0; i < 20; ++i) {
+    auto x = test::AsTensor<float>({1.0f * i, 2.0f * i});
+    TF_CHECK_OK(Run(flr0_, handle, opts, {x}, {&y}));
+    test::ExpectTensorEqual<float>(y,
+                                   test::AsTensor<float>({2.0f * i, 4.0f * i}));
+  }
+  HasError(Run(flr0_, handle, opts, {}, {&y}), "Expects 1 arguments");
+  auto x = test::AsTensor<float>({1, 2});
+  TF_CHECK_OK(Run(flr0_, handle, opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4}));
+}
+
 TEST_F(FunctionLibraryRuntimeTest, XTimesN) {
   Init({test::function::XTimesTwo(), test::function::XTimesFour(),
         test::function::XTimes16()});
@@ -531,6 +552,60 @@ TEST_F(FunctionLibraryRuntimeTest, StateHandle) {
   }
 }
 
+TEST_F(FunctionLibraryRuntimeTest, SpecializeArgs) {
+  Init({test::function::XTimesTwo()});
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  auto z = test::AsTensor<float>({0, 0, 0, 0});
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, &handle));
+
+  FunctionLibraryRuntime::InstantiateOptions options;
+  options.const_args[0] = x;
+  FunctionLibraryRuntime::Handle const_handle;
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, options,
+                          &const_handle));
+  EXPECT_NE(handle, const_handle);
+
+  // The value passed for the constant argument is ignored.
+  FunctionLibraryRuntime::Options opts;
+  Tensor y;
+  TF_CHECK_OK(Run(flr0_, const_handle, opts, {z}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+
+  // Instantiating with an equal value yields the same specialization, and
+  // with a different one a new specialization.
+  FunctionLibraryRuntime::Handle same_handle;
+  options.const_args[0] = test::AsTensor<float>({1, 2, 3, 4});
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, options,
+                          &same_handle));
+  EXPECT_EQ(const_handle, same_handle);
+  FunctionLibraryRuntime::Handle other_handle;
+  options.const_args[0] = test::AsTensor<float>({1, 2, 3, 5});
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, options,
+                          &other_handle));
+  EXPECT_NE(const_handle, other_handle);
+  TF_CHECK_OK(Run(flr0_, other_handle, opts, {z}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 10}));
+
+  // Known shapes are part of the specialization too.
+  FunctionLibraryRuntime::InstantiateOptions shape_options;
+  shape_options.arg_shapes[0] = PartialTensorShape({4});
+  FunctionLibraryRuntime::Handle shape_handle;
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, shape_options,
+                          &shape_handle));
+  EXPECT_NE(handle, shape_handle);
+  TF_CHECK_OK(Run(flr0_, shape_handle, opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+
+  // The value of a constant argument must be of the argument's type.
+  options.const_args[0] = test::AsTensor<int32>({1, 2, 3, 4});
+  FunctionLibraryRuntime::Handle bad_handle;
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, options,
+                          &bad_handle));
+  HasError(Run(flr0_, bad_handle, opts, {x}, {&y}),
+           "Constant argument 0 is of type int32");
+}
+
 TEST_F(FunctionLibraryRuntimeTest, ExpandInlineFunctions) {
   Init({test::function::XTimesTwo(), test::function::XTimesFour(),
         test::function::XTimes16()});
@@ -186,6 +186,66 @@ TEST(GPUBFCAllocatorTest, AllocatedVsRequested) {
   a.DeallocateRaw(t1);
 }
 
+TEST(GPUBFCAllocatorTest, FreeListCacheReusesChunks) {
+  GPUBFCAllocator a(CudaGpuId(0), 1 << 30, "GPU_0_bfc");
+  a.EnableFreeListCache(4096, 8192);
+
+  void* p1 = a.AllocateRaw(1, 1000);
+  EXPECT_EQ(1000, a.RequestedSize(p1));
+  EXPECT_EQ(1024, a.AllocatedSize(p1));
+  const int64 id1 = a.AllocationId(p1);
+  a.DeallocateRaw(p1);
+  EXPECT_EQ(1024, a.FreeListCachedBytes());
+  CheckStats(&a, 1, 0, 1024, 1024);
+
+  // Same size class: served from the cache, with fresh metadata.
+  void* p2 = a.AllocateRaw(1, 900);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(900, a.RequestedSize(p2));
+  EXPECT_NE(id1, a.AllocationId(p2));
+  EXPECT_EQ(0, a.FreeListCachedBytes());
+  CheckStats(&a, 2, 1024, 1024, 1024);
+  a.DeallocateRaw(p2);
+
+  // Chunks above the limit bypass the cache.
+  void* big = a.AllocateRaw(1, 1 << 20);
+  a.DeallocateRaw(big);
+  EXPECT_EQ(1024, a.FreeListCachedBytes());
+}
+
+TEST(GPUBFCAllocatorTest, FreeListCacheReleasesOverBudget) {
+  GPUBFCAllocator a(CudaGpuId(0), 1 << 30, "GPU_0_bfc");
+  a.EnableFreeListCache(4096, 8192);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 1024));
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  EXPECT_LE(a.FreeListCachedBytes(), 8192);
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+TEST(GPUBFCAllocatorTest, FreeListCacheFlushedOnOOM) {
+  // Configure a 1MiB byte limit and fill it with cached chunks.
+  GPUBFCAllocator a(CudaGpuId(0), 1 << 20, "GPU_0_bfc");
+  a.EnableFreeListCache(4096, 1 << 20);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 200; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 4096));
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  EXPECT_GT(a.FreeListCachedBytes(), 0);
+  void* big = a.AllocateRaw(1, 512 << 10);
+  EXPECT_NE(nullptr, big);
+  a.DeallocateRaw(big);
+}
+
 TEST(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   // Configure a 1MiB byte limit
   GPUBFCAllocator a(CudaGpuId(0), 1 << 20, "GPU_0_bfc");
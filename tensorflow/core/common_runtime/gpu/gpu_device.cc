@@ -280,6 +280,12 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
 
   executor_ = executor_status.ValueOrDie();
   em_.reset(new EventMgr(executor_, options.config.gpu_options()));
+  // Mirrors the condition under which GPUBFCAllocator hands out unified
+  // memory.
+  const GPUOptions& gpu_options = options.config.gpu_options();
+  prefetch_unified_memory_ =
+      gpu_options.per_process_gpu_memory_fraction() > 1.0 ||
+      gpu_options.experimental().use_unified_memory();
 
   if (max_streams_ < 1) {
     return errors::InvalidArgument("Invalid value for max_streams.");
@@ -393,17 +399,43 @@ Status BaseGPUDevice::FillContextMap(const Graph* graph,
 
   // Fill in the context map.  It is OK for this map to contain
   // duplicate DeviceContexts so long as we increment the refcount.
+  //
+  // A node whose outputs are consumed on other streams gets a context of its
+  // own, with an event recorded after its kernel, so that its consumers only
+  // wait for it rather than for all the work enqueued on its stream.
   device_context_map->resize(graph->num_node_ids());
+  int num_output_events = 0;
   for (Node* n : graph->nodes()) {
     auto mapped_stream = node_to_stream_id[n->id()];
     CHECK_LE(mapped_stream, num_streams);
-    auto ctx = device_contexts_[mapped_stream];
+    bool has_cross_stream_consumer = false;
+    for (const Edge* e : n->out_edges()) {
+      if (!e->IsControlEdge() &&
+          node_to_stream_id[e->dst()->id()] != mapped_stream) {
+        has_cross_stream_consumer = true;
+        break;
+      }
+    }
+    GPUDeviceContext* ctx = nullptr;
+    if (has_cross_stream_consumer) {
+      const StreamGroup* group = streams_[mapped_stream];
+      ctx = new GPUDeviceContext(mapped_stream, group->compute,
+                                 group->host_to_device, group->device_to_host,
+                                 group->device_to_device);
+      if (ctx->CreateOutputEvent(executor_)) {
+        ++num_output_events;
+      }
+    } else {
+      ctx = device_contexts_[mapped_stream];
+      ctx->Ref();
+    }
     VLOG(3) << "Assigned stream " << node_to_stream_id[n->id()]
             << " ==> stream[" << ctx->stream_id() << "] for node id " << n->id()
             << " " << n->type_string() << " " << n->name();
-    ctx->Ref();
     (*device_context_map)[n->id()] = ctx;
   }
+  VLOG(2) << "Created " << num_output_events
+          << " output events for cross-stream dependencies";
 
   return Status::OK();
 }
@@ -438,6 +470,12 @@ string BaseGPUDevice::ComputeOpKernelDebugString(const OpKernel& op_kernel,
                          "]");
 }
 
+// Kernels are launched one at a time, each on the stream of its node. Steps
+// of small fixed-shape graphs are then bound by the launch overhead, which
+// capturing a step into a CUDA graph and replaying it would remove. That
+// needs the stream capture API of CUDA 10 (this build supports CUDA 9, and
+// StreamExecutor doesn't expose graphs), and every tensor of the step to be
+// at the same address on each replay (see StaticMemoryArena).
 void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
                                   OpKernelContext* context) {
   GPUDeviceContext* gpu_device_context = device_contexts_[0];
@@ -485,12 +523,14 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
                     << ((idc->stream() == stream) ? " not needed" : "");
         }
       }
-      if (idc->stream() != stream) stream->ThenWaitFor(idc->stream());
+      if (idc->stream() != stream) idc->WaitForOutputs(stream);
     }
   }
   se::cuda::ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  if (prefetch_unified_memory_) PrefetchInputs(context, stream);
   op_kernel->Compute(context);
   if (context->status().ok()) {
+    if (num_streams > 1) gpu_device_context->RecordOutputEvent();
     if (sync_every_op_) {
       // Note: GPUUtil::Sync() only syncs the default stream.
       // We need to either sync the stream used by this op, or
@@ -547,9 +587,35 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   tracing::ScopedActivity activity(op_kernel->name(), op_kernel->type_string(),
                                    op_kernel->IsExpensive());
   se::cuda::ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  if (prefetch_unified_memory_) PrefetchInputs(context, stream);
   op_kernel->ComputeAsync(context, done);
 }
 
+void BaseGPUDevice::PrefetchInputs(OpKernelContext* context,
+                                   se::Stream* stream) {
+  const cudaStream_t cuda_stream = *reinterpret_cast<const cudaStream_t*>(
+      stream->implementation()->CudaStreamMemberHack());
+  const int device = gpu_id();
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (!context->has_input(i) ||
+        context->input_memory_type(i) == HOST_MEMORY) {
+      continue;
+    }
+    const Tensor tensor = IsRefType(context->input_dtype(i))
+                              ? context->mutable_input(i, false)
+                              : context->input(i);
+    if (!DMAHelper::CanUseDMA(&tensor) || tensor.TotalBytes() == 0) {
+      continue;
+    }
+    // This is only a hint: inputs that are not in unified memory, e.g.
+    // tensors from other allocators, are simply left where they are.
+    if (cudaMemPrefetchAsync(DMAHelper::base(&tensor), tensor.TotalBytes(),
+                             device, cuda_stream) != cudaSuccess) {
+      cudaGetLastError();
+    }
+  }
+}
+
 Status BaseGPUDevice::MaybeCopyTensorToGPU(
     const AllocatorAttributes& alloc_attrs, const Tensor& from, Tensor* to,
     StatusCallback done) {
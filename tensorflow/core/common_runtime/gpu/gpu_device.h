@@ -130,6 +130,9 @@ class BaseGPUDevice : public LocalDevice {
   mutex trace_mu_;
   TfGpuId tf_gpu_id_;
   const bool sync_every_op_ = false;
+  // Whether device memory is CUDA unified memory, whose pages are migrated to
+  // the GPU ahead of the kernels that read them.
+  bool prefetch_unified_memory_ = false;
   const int32 max_streams_;
   std::unique_ptr<EventMgr> em_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
@@ -139,6 +142,11 @@ class BaseGPUDevice : public LocalDevice {
 
   void ComputeHelper(OpKernel* op_kernel, OpKernelContext* context);
 
+  // Enqueues on 'stream' the migration to this GPU of the unified memory
+  // backing the inputs of 'context', so that the op's kernels don't fault
+  // the pages in one at a time.
+  void PrefetchInputs(OpKernelContext* context, se::Stream* stream);
+
   string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                     const int& stream_id);
 
@@ -17,9 +17,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/process_state.h"
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -279,6 +284,54 @@ TEST_F(GPUDeviceTest, UnifiedMemoryAllocation) {
   gtl::STLDeleteElements(&devices);
 }
 
+TEST_F(GPUDeviceTest, MultipleComputeStreams) {
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_num_compute_streams(2);
+  std::vector<tensorflow::Device*> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  ASSERT_EQ(1, devices.size());
+
+  // a feeds the independent branches b and c, which are joined by d.
+  Graph graph(OpRegistry::Global());
+  Tensor value(DT_FLOAT, TensorShape({}));
+  value.scalar<float>()() = 1.0f;
+  Node* a = test::graph::Constant(&graph, value);
+  Node* b = test::graph::Unary(&graph, "Neg", a);
+  Node* c = test::graph::Unary(&graph, "Neg", a);
+  test::graph::Add(&graph, b, c);
+  FixupSourceAndSinkEdges(&graph);
+
+  DeviceContextMap context_map;
+  TF_ASSERT_OK(devices[0]->FillContextMap(&graph, &context_map));
+  ASSERT_EQ(graph.num_node_ids(), context_map.size());
+  auto context = [&context_map](const Node* n) {
+    return static_cast<GPUDeviceContext*>(context_map[n->id()]);
+  };
+  EXPECT_NE(context(b)->stream_id(), context(c)->stream_id());
+  // Nodes with consumers on other streams have a context of their own, to
+  // record the event their consumers wait for.
+  for (const Node* n : graph.nodes()) {
+    bool has_cross_stream_consumer = false;
+    for (const Edge* e : n->out_edges()) {
+      has_cross_stream_consumer |=
+          !e->IsControlEdge() &&
+          context(e->dst())->stream_id() != context(n)->stream_id();
+    }
+    if (has_cross_stream_consumer) {
+      EXPECT_EQ(1, std::count(context_map.begin(), context_map.end(),
+                              context_map[n->id()]))
+          << n->name();
+    }
+  }
+  EXPECT_NE(context(a), context(b));
+
+  for (DeviceContext* dc : context_map) dc->Unref();
+  gtl::STLDeleteElements(&devices);
+}
+
 }  // namespace tensorflow
 
 #endif
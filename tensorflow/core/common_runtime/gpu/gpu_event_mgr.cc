@@ -15,11 +15,37 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
+namespace {
+
+auto* pending_events = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/gpu_event_mgr/pending_events",
+     "The number of events pending in a GPU EventMgr, sampled at every pass "
+     "of its polling loop."},
+    monitoring::Buckets::Exponential(1, 2, 12));
+
+auto* poll_interval_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/gpu_event_mgr/poll_interval_usecs",
+     "The time between consecutive passes of the polling loop of a GPU "
+     "EventMgr while events are pending, in microseconds. This bounds how "
+     "late the completion of an event is noticed."},
+    monitoring::Buckets::Exponential(1, 2, 16));
+
+auto* retire_latency_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/gpu_event_mgr/retire_latency_usecs",
+     "The time between queueing an event in a GPU EventMgr and retiring it, "
+     "in microseconds."},
+    monitoring::Buckets::Exponential(1, 2, 24));
+
+}  // namespace
+
 EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
     : exec_(se),
       deferred_bytes_threshold_(gpu_options.deferred_deletion_bytes()
@@ -28,6 +54,8 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      polling_spin_usecs_(
+          std::max(0, gpu_options.experimental().polling_spin_usecs())),
       accumulated_stream_(nullptr),
       accumulated_tensors_(new TensorReferenceVector),
       accumulated_tensor_bytes_(0),
@@ -125,8 +153,15 @@ void EventMgr::FlushAccumulatedTensors() {
 //
 // While one or more events is outstanding, poll for completed events.  When no
 // events are outstanding, we sleep until one is enqueued.
+//
+// Events tend to complete in bursts, so after being woken up or retiring an
+// event we poll again immediately for polling_spin_usecs_, and only then go
+// back to sleeping between polls.
 void EventMgr::PollLoop() {
+  Env* env = Env::Default();
   ToFreeVector to_free;
+  uint64 spin_until_micros = 0;
+  uint64 last_poll_micros = 0;
   while (true) {
     bool events_still_pending;
     {
@@ -136,15 +171,26 @@ void EventMgr::PollLoop() {
       }
       if (used_events_.empty()) {
         events_pending_.wait(l);
+        spin_until_micros = env->NowMicros() + polling_spin_usecs_;
+        last_poll_micros = 0;
       }
+      pending_events->GetCell()->Add(used_events_.size());
       PollEvents(true, &to_free);
       events_still_pending = !used_events_.empty();
     }
+    const uint64 now_micros = env->NowMicros();
+    if (last_poll_micros != 0) {
+      poll_interval_usecs->GetCell()->Add(now_micros - last_poll_micros);
+    }
+    last_poll_micros = now_micros;
+    if (!to_free.empty()) {
+      spin_until_micros = now_micros + polling_spin_usecs_;
+    }
     FreeMemory(to_free);
     to_free.clear();
 
-    if (events_still_pending) {
-      Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+    if (events_still_pending && now_micros >= spin_until_micros) {
+      env->SleepForMicroseconds(polling_active_delay_usecs_);
     }
   }
   polling_stopped_->Notify();
@@ -163,6 +209,7 @@ void EventMgr::QueueInUse(se::Stream* stream, InUse iu) {
   free_events_.pop_back();
   stream->ThenRecordEvent(e);
   iu.event = e;
+  iu.queued_micros = Env::Default()->NowMicros();
   bool was_empty = used_events_.empty();
   used_events_.push_back(iu);
   // Maybe wake up the polling thread
@@ -195,6 +242,7 @@ void EventMgr::PollEvents(bool is_dedicated_poller,
   // Sweep the remaining events in order.  If this is the dedicated
   // polling thread, check the entire set.  Otherwise, just sweep up to
   // the first non-complete record that is still pending.
+  uint64 now_micros = 0;
   for (auto& iu : used_events_) {
     if (iu.event == nullptr) continue;
     se::Event::Status s = iu.event->PollForStatus();
@@ -209,6 +257,8 @@ void EventMgr::PollEvents(bool is_dedicated_poller,
         if (!is_dedicated_poller) return;  // quit processing queue
         break;
       case se::Event::Status::kComplete:
+        if (now_micros == 0) now_micros = Env::Default()->NowMicros();
+        retire_latency_usecs->GetCell()->Add(now_micros - iu.queued_micros);
         // Make a copy of the InUse record so we can free it after releasing
         // the lock
         to_free->push_back(iu);
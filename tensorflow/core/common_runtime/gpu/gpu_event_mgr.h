@@ -89,6 +89,7 @@ class EventMgr {
   se::StreamExecutor* const exec_;
   const int64 deferred_bytes_threshold_;
   const int32 polling_active_delay_usecs_;
+  const int32 polling_spin_usecs_;
   mutex mu_;
   condition_variable events_pending_ GUARDED_BY(mu_);
 
@@ -99,6 +100,8 @@ class EventMgr {
     TensorReferenceVector* mem;
     BufRec bufrec;
     std::function<void()> func;
+    // When the event was queued, in microseconds.
+    uint64 queued_micros;
   };
 
   typedef gtl::InlinedVector<InUse, 4> ToFreeVector;
@@ -132,17 +135,17 @@ class EventMgr {
 
   void QueueTensors(se::Stream* stream, TensorReferenceVector* tensors)
       EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    QueueInUse(stream, {nullptr, tensors, BufRec(), nullptr});
+    QueueInUse(stream, {nullptr, tensors, BufRec(), nullptr, 0});
   }
 
   void QueueBuffer(se::Stream* stream, BufRec bufrec)
       EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    QueueInUse(stream, {nullptr, nullptr, bufrec, nullptr});
+    QueueInUse(stream, {nullptr, nullptr, bufrec, nullptr, 0});
   }
 
   void QueueFunc(se::Stream* stream, std::function<void()> func)
       EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    QueueInUse(stream, {nullptr, nullptr, BufRec(), std::move(func)});
+    QueueInUse(stream, {nullptr, nullptr, BufRec(), std::move(func), 0});
   }
 
   // This function should be called at roughly the same tempo as
@@ -153,8 +156,9 @@ class EventMgr {
   void PollEvents(bool is_dedicated_poller, ToFreeVector* to_free)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
-  // An internal polling loop that runs at a low frequency to clear
-  // straggler Events.
+  // An internal polling loop that clears straggler Events. It spins for
+  // polling_spin_usecs_ after any activity, and then polls every
+  // polling_active_delay_usecs_ until the queue is empty.
   void PollLoop();
 
   // Setup/Teardown functions for the polling loop.
@@ -223,6 +223,26 @@ TEST(EventMgr, ManySmallTensorsSeparateCallsFlushed) {
   }
 }
 
+// With spinning enabled, the polling loop should still retire every event.
+TEST(EventMgr, SpinningPollLoop) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_polling_spin_usecs(100000);
+  EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  th.StartPollingLoop();
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  for (int i = 0; i < 5; ++i) {
+    Notification done;
+    em.ThenExecute(stream.get(), [&done]() { done.Notify(); });
+    done.WaitForNotification();
+  }
+  // Each event is dequeued before its function is scheduled.
+  EXPECT_EQ(0, th.queue_size());
+}
+
 // Deleting the EventMgr when events are still pending should shut
 // down gracefully.
 TEST(EventMgr, NonEmptyShutdown) {
@@ -22,6 +22,32 @@ limitations under the License.
 
 namespace tensorflow {
 
+GPUDeviceContext::~GPUDeviceContext() {}
+
+bool GPUDeviceContext::CreateOutputEvent(se::StreamExecutor* executor) {
+  std::unique_ptr<se::Event> event(new se::Event(executor));
+  if (!event->Init()) {
+    return false;
+  }
+  output_event_ = std::move(event);
+  return true;
+}
+
+void GPUDeviceContext::RecordOutputEvent() {
+  if (output_event_ != nullptr) {
+    stream_->ThenRecordEvent(output_event_.get());
+    output_event_recorded_ = true;
+  }
+}
+
+void GPUDeviceContext::WaitForOutputs(se::Stream* stream) const {
+  if (output_event_recorded_) {
+    stream->ThenWaitFor(output_event_.get());
+  } else {
+    stream->ThenWaitFor(stream_);
+  }
+}
+
 void GPUDeviceContext::CopyCPUTensorToDevice(const Tensor* cpu_tensor,
                                              Device* device,
                                              Tensor* device_tensor,
@@ -16,10 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 #define TENSORFLOW_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 
 namespace stream_executor {
+class Event;
 class Stream;
 }  // namespace stream_executor
 
@@ -38,7 +42,7 @@ class GPUDeviceContext : public DeviceContext {
         device_to_host_stream_(device_to_host_stream),
         device_to_device_stream_(device_to_device_stream) {}
 
-  ~GPUDeviceContext() override {}
+  ~GPUDeviceContext() override;
 
   se::Stream* stream() const override { return stream_; }
   se::Stream* host_to_device_stream() const { return host_to_device_stream_; }
@@ -48,6 +52,18 @@ class GPUDeviceContext : public DeviceContext {
   }
   int stream_id() const { return stream_id_; }
 
+  // Gives this context an event that RecordOutputEvent() records on stream()
+  // after each kernel run with it. Only worth it for contexts of nodes whose
+  // outputs are consumed on other streams; returns false if the event could
+  // not be created.
+  bool CreateOutputEvent(se::StreamExecutor* executor);
+  void RecordOutputEvent();
+
+  // Makes 'stream' wait until the outputs of the kernels run with this
+  // context are ready: for the last recorded output event if there is one,
+  // and for all the work enqueued on stream() otherwise.
+  void WaitForOutputs(se::Stream* stream) const;
+
   void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
                              Tensor* device_tensor,
                              StatusCallback done) const override;
@@ -70,6 +86,11 @@ class GPUDeviceContext : public DeviceContext {
   se::Stream* device_to_host_stream_;
   // The stream to use for copy data between GPU.
   se::Stream* device_to_device_stream_;
+  // Recorded on stream_ after the kernels of this context, if not null. It is
+  // safe to share between concurrent steps: a consumer waits for the latest
+  // recording, which is never earlier than that of its own producer.
+  std::unique_ptr<se::Event> output_event_;
+  std::atomic<bool> output_event_recorded_{false};
 };
 
 }  // namespace tensorflow
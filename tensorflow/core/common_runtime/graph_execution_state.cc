@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb_text.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
@@ -36,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/graph/validate.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -47,13 +50,35 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
 #endif  // IS_MOBILE_PLATFORM
 
 namespace tensorflow {
 
+namespace {
+
+// Adds to "*groups" the name of "node" and the nodes it is colocated with
+// through its "_class" attr.
+void AddColocationGroups(const NodeDef& node,
+                         std::unordered_set<string>* groups) {
+  groups->insert(node.name());
+  auto iter = node.attr().find(kColocationAttrName);
+  if (iter == node.attr().end()) return;
+  const StringPiece prefix(kColocationGroupPrefix);
+  for (const string& group : iter->second.list().s()) {
+    StringPiece name(group);
+    if (str_util::ConsumePrefix(&name, prefix)) {
+      groups->insert(name.ToString());
+    }
+  }
+}
+
+}  // namespace
+
 GraphExecutionState::GraphExecutionState(
     GraphDef* graph_def, const GraphExecutionStateOptions& options)
     : stateful_placements_(options.stateful_placements),
+      reusable_placements_(options.reusable_placements),
       device_set_(options.device_set),
       session_options_(options.session_options),
       flib_def_(new FunctionLibraryDefinition(OpRegistry::Global(),
@@ -128,18 +153,39 @@ Status GraphExecutionState::Extend(
   TF_RETURN_IF_ERROR(flib_def_->AddLibrary(extension_def.library()));
   *gdef.mutable_library() = flib_def_->ToProto();
 
-  // 2. Build an index of the new node names.
+  // 2. Build an index of the new node names, and of the old nodes whose
+  //    placement may change because a new node reads from them or is
+  //    colocated with them.
   std::unordered_set<string> new_names;
+  std::unordered_set<string> new_groups;
+  std::unordered_set<string> new_inputs;
   for (const NodeDef& node : extension_def.node()) {
     new_names.insert(node.name());
+    AddColocationGroups(node, &new_groups);
+    for (const string& input : node.input()) {
+      new_inputs.insert(ParseTensorName(input).first.ToString());
+    }
   }
 
   // 3. Add the non-duplicates from the old graph to the new graph.
   //    Return an error if the same node name appears in both the
   //    old graph and the extension.
+  std::unordered_map<string, string> reusable_placements;
   for (const NodeDef& node : original_graph_def_.node()) {
     if (new_names.count(node.name()) == 0) {
       *gdef.add_node() = node;
+      auto iter = node_placements_.find(node.name());
+      if (iter != node_placements_.end() &&
+          new_inputs.count(node.name()) == 0) {
+        std::unordered_set<string> groups;
+        AddColocationGroups(node, &groups);
+        if (std::none_of(groups.begin(), groups.end(),
+                         [&new_groups](const string& group) {
+                           return new_groups.count(group) > 0;
+                         })) {
+          reusable_placements.insert(*iter);
+        }
+      }
     } else {
       return errors::InvalidArgument(tensorflow::strings::Printf(
           "GraphDef argument to Extend includes node '%s', which was created "
@@ -196,6 +242,7 @@ Status GraphExecutionState::Extend(
   combined_options.device_set = device_set_;
   combined_options.session_options = session_options_;
   combined_options.stateful_placements = stateful_placements_;
+  combined_options.reusable_placements = std::move(reusable_placements);
 
   // NOTE(mrry): `gdef` is no longer valid after the constructor
   // executes.
@@ -227,6 +274,33 @@ void GraphExecutionState::SaveStatefulNodes(Graph* graph) {
   }
 }
 
+void GraphExecutionState::SaveNodePlacements(Graph* graph) {
+  node_placements_.clear();
+  for (Node* n : graph->op_nodes()) {
+    if (!n->assigned_device_name().empty()) {
+      node_placements_[n->name()] = n->assigned_device_name();
+    }
+  }
+}
+
+void GraphExecutionState::RestoreReusablePlacements(Graph* graph) {
+  if (reusable_placements_.empty()) return;
+  int num_restored = 0;
+  for (Node* n : graph->op_nodes()) {
+    if (n->has_assigned_device_name()) continue;
+    auto iter = reusable_placements_.find(n->name());
+    if (iter != reusable_placements_.end()) {
+      n->set_assigned_device_name(iter->second);
+      ++num_restored;
+    }
+  }
+  VLOG(1) << "Reused the placement of " << num_restored << " of "
+          << graph->num_op_nodes() << " nodes";
+  // The placements are only valid for the graph this state was created
+  // with.
+  reusable_placements_.clear();
+}
+
 void GraphExecutionState::RestoreStatefulNodes(Graph* graph) {
   for (Node* n : graph->nodes()) {
     if (n->op_def().is_stateful()) {
@@ -375,6 +449,7 @@ Status GraphExecutionState::InitBaseGraph(const BuildGraphOptions& options) {
 
   // Save stateful placements before placing.
   RestoreStatefulNodes(new_graph.get());
+  RestoreReusablePlacements(new_graph.get());
 
   GraphOptimizationPassOptions optimization_options;
   optimization_options.session_options = session_options_;
@@ -393,6 +468,10 @@ Status GraphExecutionState::InitBaseGraph(const BuildGraphOptions& options) {
       OptimizationPassRegistry::POST_PLACEMENT, optimization_options));
 
   SaveStatefulNodes(new_graph.get());
+  if (!session_options_ ||
+      !session_options_->config.graph_options().place_pruned_graph()) {
+    SaveNodePlacements(new_graph.get());
+  }
   graph_ = new_graph.release();
   return Status::OK();
 }
@@ -492,8 +571,21 @@ Status GraphExecutionState::OptimizeGraph(
     }
     grappler::VirtualCluster cluster(device_map, device_set_);
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
-        item, rewrite_options, cpu_device, &cluster, &new_graph));
+    if (rewrite_options.cache_optimized_graphs()) {
+      grappler::MetaOptimizerCache* cache =
+          grappler::MetaOptimizerCache::Global();
+      const string& cache_dir = rewrite_options.optimized_graph_cache_dir();
+      const string key =
+          grappler::MetaOptimizerCache::Key(item, rewrite_options, device_map);
+      if (!cache->Lookup(key, cache_dir, &new_graph)) {
+        TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+            item, rewrite_options, cpu_device, &cluster, &new_graph));
+        cache->Insert(key, cache_dir, new_graph);
+      }
+    } else {
+      TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+          item, rewrite_options, cpu_device, &cluster, &new_graph));
+    }
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
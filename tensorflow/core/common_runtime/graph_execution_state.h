@@ -44,6 +44,10 @@ struct GraphExecutionStateOptions {
   // A map from node name to device name, representing the unchangeable
   // placement of stateful nodes.
   std::unordered_map<string, string> stateful_placements;
+  // A map from node name to device name for nodes of a previous version
+  // of the graph whose placement can be kept as is, because the nodes
+  // added since then are not connected or colocated with them.
+  std::unordered_map<string, string> reusable_placements;
 };
 
 // A ClientGraph is simply a sub-graph of the full graph as induced by
@@ -125,8 +129,10 @@ class GraphExecutionState {
   // used.
   //
   // NOTE(mrry): This method respects the placement of stateful nodes in
-  // in *this, but currently does not transfer any other placement
-  // or cost model information to the new graph.
+  // in *this. The placement of the other nodes is kept when they are
+  // neither inputs of nor colocated with a node of "extension_def", so
+  // that the placer only has to place the new part of the graph. No cost
+  // model information is transferred to the new graph.
   Status Extend(const GraphDef& extension_def,
                 std::unique_ptr<GraphExecutionState>* out) const;
 
@@ -177,6 +183,14 @@ class GraphExecutionState {
   void SaveStatefulNodes(Graph* graph);
   void RestoreStatefulNodes(Graph* graph);
 
+  // Map of the placement of every op node of the full graph, saved after
+  // the base graph is placed, and of the placements inherited from the
+  // graph that this one extends, applied before placement.
+  std::unordered_map<string, string> node_placements_;
+  std::unordered_map<string, string> reusable_placements_;
+  void SaveNodePlacements(Graph* graph);
+  void RestoreReusablePlacements(Graph* graph);
+
   // Extract the subset of the graph that needs to be run, adding feed/fetch
   // ops as needed.
   Status PruneGraph(const BuildGraphOptions& options, Graph* graph,
@@ -0,0 +1,250 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/ring_reducer.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+/*static*/
+bool HierarchicalReducer::IsApplicable(const CollectiveParams& col_params) {
+  std::unordered_map<string, int> devices_per_task;
+  bool has_multi_device_task = false;
+  for (const string& task_name : col_params.instance.task_names) {
+    if (++devices_per_task[task_name] > 1) has_multi_device_task = true;
+  }
+  return devices_per_task.size() > 1 && has_multi_device_task;
+}
+
+HierarchicalReducer::HierarchicalReducer(
+    CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+    OpKernelContext* ctx, OpKernelContext::Params* op_params,
+    const CollectiveParams& col_params, const string& exec_key, int64 step_id,
+    const Tensor* input, Tensor* output)
+    : col_exec_(col_exec),
+      dev_mgr_(dev_mgr),
+      ctx_(ctx),
+      op_params_(op_params),
+      col_params_(col_params),
+      exec_key_(exec_key),
+      input_(input),
+      output_(output),
+      step_id_(step_id),
+      device_(nullptr) {
+  const std::vector<string>& task_names = col_params_.instance.task_names;
+  const string& my_task = task_names[col_params_.default_rank];
+  std::unordered_map<string, bool> seen_tasks;
+  for (int r = 0; r < static_cast<int>(task_names.size()); ++r) {
+    if (!seen_tasks[task_names[r]]) {
+      seen_tasks[task_names[r]] = true;
+      leader_ranks_.push_back(r);
+    }
+    if (task_names[r] == my_task) task_ranks_.push_back(r);
+  }
+  CHECK(!task_ranks_.empty());
+  InitRingParams(task_ranks_, &task_ring_params_);
+  if (col_params_.default_rank == task_ranks_[0]) {
+    InitRingParams(leader_ranks_, &leader_ring_params_);
+    // Only the ring across tasks is worth compressing.
+    leader_ring_params_.instance.compression = col_params_.instance.compression;
+    leader_ring_params_.instance.top_k_fraction =
+        col_params_.instance.top_k_fraction;
+  }
+}
+
+HierarchicalReducer::~HierarchicalReducer() {
+  // The merge_op is only borrowed from col_params_.
+  task_ring_params_.merge_op.release();
+  leader_ring_params_.merge_op.release();
+}
+
+void HierarchicalReducer::InitRingParams(const std::vector<int>& members,
+                                         CollectiveParams* ring_params) {
+  const int ring_size = static_cast<int>(members.size());
+  ring_params->name = col_params_.name;
+  ring_params->group = col_params_.group;
+  ring_params->group.group_size = ring_size;
+  ring_params->instance.instance_key = col_params_.instance.instance_key;
+  ring_params->instance.type = col_params_.instance.type;
+  ring_params->instance.data_type = col_params_.instance.data_type;
+  ring_params->instance.shape = col_params_.instance.shape;
+  ring_params->instance.impl_details.subdiv_offsets = {0};
+  ring_params->instance.impl_details.subdiv_permutations.resize(1);
+  for (int i = 0; i < ring_size; ++i) {
+    const int r = members[i];
+    ring_params->instance.device_names.push_back(
+        col_params_.instance.device_names[r]);
+    ring_params->instance.task_names.push_back(
+        col_params_.instance.task_names[r]);
+    ring_params->task.is_local.push_back(col_params_.task.is_local[r]);
+    ring_params->instance.impl_details.subdiv_permutations[0].push_back(i);
+    if (r == col_params_.default_rank) {
+      ring_params->default_rank = i;
+      ring_params->subdiv_rank = {i};
+    }
+  }
+  CHECK_GE(ring_params->default_rank, 0);
+  // No final_op: it is applied once, to the sum over the whole group.
+  ring_params->merge_op.reset(col_params_.merge_op.get());
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  CHECK(dev_mgr_);
+  Status status = dev_mgr_->LookupDevice(
+      col_params_.instance.device_names[col_params_.default_rank], &device_);
+  if (!status.ok()) {
+    done(status);
+    return;
+  }
+  device_locality_ = device_->attributes().locality();
+  const bool is_leader = (col_params_.default_rank == task_ranks_[0]);
+
+  VLOG(1) << this << " HierarchicalReducer::Run default_rank "
+          << col_params_.default_rank << " task devices " << task_ranks_.size()
+          << " tasks " << leader_ranks_.size()
+          << (is_leader ? " (leader)" : "");
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((input_ != output_) &&
+      (DMAHelper::base(input_) != DMAHelper::base(output_))) {
+    // We are running in a blockable thread and the callback can't block so
+    // just wait here on the copy.
+    Notification note;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        ctx_->input_device_context(0), ctx_->op_device_context(), device_,
+        device_, ctx_->input_alloc_attr(0), ctx_->output_alloc_attr(0), input_,
+        output_, [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  // Buffer keys of the two rings must not collide with each other, nor
+  // with those of the rings of other tasks.
+  if (task_ranks_.size() > 1) {
+    status = RunRing(task_ring_params_,
+                     strings::StrCat(exec_key_, ":task", task_ranks_[0]));
+  }
+  if (status.ok() && is_leader) {
+    status = RunRing(leader_ring_params_, strings::StrCat(exec_key_, ":lead"));
+    if (status.ok()) status = Finalize();
+  }
+  if (status.ok() && task_ranks_.size() > 1) {
+    status = Broadcast();
+  }
+  done(status);
+}
+
+Status HierarchicalReducer::RunRing(const CollectiveParams& ring_params,
+                                    const string& exec_key) {
+  Status status;
+  Notification note;
+  RingReducer reducer(col_exec_, dev_mgr_, ctx_, op_params_, ring_params,
+                      exec_key, step_id_, output_, output_);
+  reducer.Run([&note, &status](const Status& s) {
+    status = s;
+    note.Notify();
+  });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalReducer::Finalize() {
+  if (!col_params_.final_op) return Status::OK();
+  // The adapter takes over output_ just long enough to make the scalars.
+  std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+      output_, 1, device_->GetAllocator(ctx_->output_alloc_attr(0))));
+  Tensor group_size_val = ca->Scalar(col_params_.group.group_size);
+  Tensor group_size_tensor;
+  Status status;
+  if (col_params_.group.device_type != "CPU") {
+    group_size_tensor =
+        ca->Scalar(device_->GetAllocator(ctx_->input_alloc_attr(0)));
+    Notification note;
+    ctx_->op_device_context()->CopyCPUTensorToDevice(
+        &group_size_val, device_, &group_size_tensor,
+        [&note, &status](const Status& s) {
+          status = s;
+          note.Notify();
+        });
+    note.WaitForNotification();
+  } else {
+    group_size_tensor = group_size_val;
+  }
+  ca->ConsumeFinalValue(output_);
+  if (status.ok()) {
+    status = RingReducer::ComputeBinOp(ctx_, op_params_, device_,
+                                       col_params_.final_op.get(), output_,
+                                       &group_size_tensor);
+  }
+  if (!status.ok()) col_exec_->StartAbort(status);
+  return status;
+}
+
+Status HierarchicalReducer::Broadcast() {
+  const int leader = task_ranks_[0];
+  const std::vector<string>& device_names = col_params_.instance.device_names;
+  const std::vector<string>& task_names = col_params_.instance.task_names;
+  mutex mu;
+  Status status;
+  auto done = [&mu, &status](BlockingCounter* counter, const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    counter->DecrementCount();
+  };
+  if (col_params_.default_rank == leader) {
+    BlockingCounter counter(static_cast<int>(task_ranks_.size()) - 1);
+    for (int i = 1; i < static_cast<int>(task_ranks_.size()); ++i) {
+      const int r = task_ranks_[i];
+      col_exec_->PostToPeer(
+          device_names[r], task_names[r],
+          strings::StrCat(exec_key_, ":bcast", r),
+          device_, ctx_->op_device_context(), ctx_->output_alloc_attr(0),
+          output_, device_locality_,
+          [&done, &counter](const Status& s) { done(&counter, s); });
+    }
+    counter.Wait();
+  } else {
+    BlockingCounter counter(1);
+    col_exec_->RecvFromPeer(
+        device_names[leader], task_names[leader],
+        col_params_.task.is_local[leader],
+        strings::StrCat(exec_key_, ":bcast", col_params_.default_rank),
+        device_, ctx_->op_device_context(), ctx_->output_alloc_attr(0), output_,
+        device_locality_,
+        [&done, &counter](const Status& s) { done(&counter, s); });
+    counter.Wait();
+  }
+  if (!status.ok()) col_exec_->StartAbort(status);
+  return status;
+}
+
+}  // namespace tensorflow
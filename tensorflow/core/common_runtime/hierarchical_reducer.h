@@ -0,0 +1,94 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+
+namespace tensorflow {
+class DeviceMgr;
+
+// Two-level implementation of collective all-reduce, for groups whose
+// devices are spread over several tasks:
+//
+// 1. The devices of each task all-reduce their values with a ring over the
+//    devices of that task only.
+// 2. The first device of each task, in default rank order, all-reduces the
+//    per-task sums with a ring over one device per task, and applies the
+//    final_op.
+// 3. That device sends the result to the other devices of its task.
+//
+// Only step 2 crosses task boundaries, so the network traffic of a task
+// does not grow with its number of devices.
+class HierarchicalReducer : public CollectiveReducer {
+ public:
+  HierarchicalReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
+                      OpKernelContext* ctx, OpKernelContext::Params* op_params,
+                      const CollectiveParams& col_params,
+                      const string& exec_key, int64 step_id,
+                      const Tensor* input, Tensor* output);
+
+  ~HierarchicalReducer() override;
+
+  void Run(StatusCallback done) override;
+
+  // Returns true if the group of 'col_params' spans more than one task, and
+  // at least one task has more than one device, i.e. if the hierarchy is
+  // not trivial.
+  static bool IsApplicable(const CollectiveParams& col_params);
+
+ private:
+  // Sets '*ring_params' to the parameters of a single-subdivision
+  // RingReducer over 'members', default ranks of col_params_ in ring order,
+  // one of which is this device. The merge_op is borrowed from col_params_.
+  void InitRingParams(const std::vector<int>& members,
+                      CollectiveParams* ring_params);
+
+  // Runs a RingReducer with 'ring_params', in place on output_.
+  Status RunRing(const CollectiveParams& ring_params, const string& exec_key);
+
+  // Applies the final_op of col_params_ to output_, the sum over the group.
+  Status Finalize();
+
+  // Sends output_ from the first device of this task to the others.
+  Status Broadcast();
+
+  CollectiveExecutor* col_exec_;        // Not owned
+  const DeviceMgr* dev_mgr_;            // Not owned
+  OpKernelContext* ctx_;                // Not owned
+  OpKernelContext::Params* op_params_;  // Not owned
+  const CollectiveParams& col_params_;
+  const string exec_key_;
+  const Tensor* input_;  // Not owned
+  Tensor* output_;       // Not owned
+  const int64 step_id_;
+  Device* device_;  // The device for which this instance labors
+  DeviceLocality device_locality_;
+
+  // Default ranks of the devices of this task, its leader first.
+  std::vector<int> task_ranks_;
+  // Default ranks of the leaders of all tasks.
+  std::vector<int> leader_ranks_;
+
+  CollectiveParams task_ring_params_;
+  CollectiveParams leader_ring_params_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
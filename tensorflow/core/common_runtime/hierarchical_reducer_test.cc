@@ -0,0 +1,334 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+// Wraps CollectiveRemoteAccessLocal with the ability to return an
+// error status to the N'th action.
+class FailTestRMA : public CollectiveRemoteAccessLocal {
+ public:
+  FailTestRMA(const DeviceMgr* dev_mgr, DeviceResolverInterface* dev_resolver,
+              int64 step_id, int fail_after)
+      : CollectiveRemoteAccessLocal(dev_mgr, dev_resolver, step_id),
+        fail_after_(fail_after) {}
+
+  bool MaybeFail(const StatusCallback& done) {
+    bool fail_now = false;
+    {
+      mutex_lock l(mu_);
+      if (fail_after_ > 0) {
+        fail_now = (--fail_after_ == 0);
+      }
+    }
+    if (fail_now) {
+      done(errors::Internal("Deliberate failure"));
+      return true;
+    }
+    return false;
+  }
+
+  void RecvFromPeer(const string& peer_device, const string& peer_task,
+                    bool peer_is_local, const string& key, Device* to_device,
+                    DeviceContext* to_device_ctx,
+                    const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
+                    const DeviceLocality& client_locality,
+                    const StatusCallback& done) override {
+    if (MaybeFail(done)) return;
+    CollectiveRemoteAccessLocal::RecvFromPeer(
+        peer_device, peer_task, peer_is_local, key, to_device, to_device_ctx,
+        to_alloc_attr, to_tensor, client_locality, done);
+  }
+
+  void PostToPeer(const string& peer_device, const string& peer_task,
+                  const string& key, Device* from_device,
+                  DeviceContext* from_device_ctx,
+                  const AllocatorAttributes& from_alloc_attr,
+                  const Tensor* from_tensor,
+                  const DeviceLocality& client_locality,
+                  const StatusCallback& done) override {
+    if (MaybeFail(done)) return;
+    CollectiveRemoteAccessLocal::PostToPeer(
+        peer_device, peer_task, key, from_device, from_device_ctx,
+        from_alloc_attr, from_tensor, client_locality, done);
+  }
+
+  mutex mu_;
+  int fail_after_ GUARDED_BY(mu_);
+};
+
+std::unique_ptr<OpKernel> GetKernel(const NodeDef& node,
+                                    const DeviceType& device_type,
+                                    DeviceBase* device) {
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()), node,
+      TF_GRAPH_DEF_VERSION, &status);
+  if (!status.ok()) {
+    LOG(FATAL) << status;
+  }
+  return k;
+}
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder(strings::StrCat(op, "_node"), op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  return GetKernel(node_def, DEVICE_CPU, device);
+}
+
+static int64 kStepId = 123;
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  ~HierarchicalReducerTest() override {
+    for (auto i : instances_) {
+      delete i;
+    }
+    if (col_exec_) col_exec_->Unref();
+  }
+
+  // Sets up 'num_workers' tasks with 'num_devices' CPU devices each.
+  void Init(int num_workers, int num_devices, DataType dtype, int fail_after) {
+    std::vector<Device*> local_devices;
+    SessionOptions sess_opts;
+    sess_opts.env = Env::Default();
+    Bytes mem_limit(4 << 20);
+    DeviceLocality dev_locality;
+    col_params_.name = "test_collective";
+    col_params_.group.group_key = 5;
+    col_params_.group.device_type = DEVICE_CPU;
+    col_params_.group.group_size = num_workers * num_devices;
+    col_params_.group.num_tasks = num_workers;
+    col_params_.instance.instance_key = 17;
+    col_params_.instance.type = REDUCTION_COLLECTIVE;
+    col_params_.instance.data_type = dtype;
+    col_params_.instance.impl_details.subdiv_offsets = {0};
+    col_params_.instance.impl_details.subdiv_permutations.resize(1);
+    for (int wi = 0; wi < num_workers; ++wi) {
+      string task_name = strings::StrCat("/job:worker/replica:0/task:", wi);
+      for (int di = 0; di < num_devices; ++di) {
+        string dev_name = strings::StrCat(task_name, "/cpu:", di);
+        local_devices.push_back(new ThreadPoolDevice(
+            sess_opts, dev_name, mem_limit, dev_locality, cpu_allocator()));
+        col_params_.instance.device_names.push_back(dev_name);
+        col_params_.instance.task_names.push_back(task_name);
+        // This test runs in a single process so is_local is always true.
+        col_params_.task.is_local.push_back(true);
+        col_params_.instance.impl_details.subdiv_permutations[0].push_back(
+            wi * num_devices + di);
+      }
+    }
+    dev_mgr_.reset(new DeviceMgr(local_devices));
+    dev_resolver_.reset(new DeviceResolverLocal(dev_mgr_.get()));
+    rma_ = new FailTestRMA(dev_mgr_.get(), dev_resolver_.get(), kStepId,
+                           fail_after);
+    col_exec_ = new BaseCollectiveExecutor(&col_exec_mgr_, rma_, kStepId,
+                                           dev_mgr_.get());
+    for (int rank = 0; rank < num_workers * num_devices; ++rank) {
+      instances_.push_back(new DeviceInstance(rank, this));
+    }
+  }
+
+  template <typename T>
+  void RunTest(DataType dtype, int num_workers, int num_devices,
+               int tensor_len, int fail_after) {
+    Init(num_workers, num_devices, dtype, fail_after);
+    ASSERT_TRUE(HierarchicalReducer::IsApplicable(col_params_));
+    std::vector<T> expected(tensor_len, 0);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      Tensor* t = &instances_[di]->tensor_;
+      *t = Tensor(dtype, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        T value = static_cast<T>(di * 10 + i);
+        t->flat<T>()(i) = value;
+        expected[i] += value;
+      }
+    }
+    BlockingCounter counter(static_cast<int>(instances_.size()));
+    for (auto di : instances_) {
+      SchedClosure([di, &counter] {
+        di->DoReduce();
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    if (fail_after > 0) {
+      for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+        EXPECT_FALSE(instances_[di]->status_.ok()) << "device " << di;
+      }
+      return;
+    }
+    const int group_size = num_workers * num_devices;
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      const Tensor& actual = instances_[di]->tensor_;
+      for (int i = 0; i < tensor_len; ++i) {
+        EXPECT_EQ(expected[i] / group_size, actual.flat<T>()(i))
+            << "Mismatch at device " << di << " index " << i;
+      }
+    }
+  }
+
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, HierarchicalReducerTest* parent)
+        : parent_(parent) {
+      const CollectiveParams& cp = parent_->col_params_;
+      TF_CHECK_OK(parent_->dev_mgr_->LookupDevice(
+          cp.instance.device_names[rank], &device_));
+      col_params_.name = cp.name;
+      col_params_.group = cp.group;
+      col_params_.instance = cp.instance;
+      col_params_.task.is_local = cp.task.is_local;
+      col_params_.default_rank = rank;
+      col_params_.subdiv_rank = {rank};
+    }
+
+    void DoReduce() {
+      col_params_.merge_op =
+          GetBinOp("Add", col_params_.instance.data_type, device_);
+      col_params_.final_op =
+          GetBinOp("Div", col_params_.instance.data_type, device_);
+
+      // Prepare an OpKernelContext.
+      OpKernelContext::Params op_params;
+      op_params.step_id = kStepId;
+      op_params.device = device_;
+      gtl::InlinedVector<TensorValue, 4> inputs;
+      inputs.push_back(TensorValue(&tensor_));
+      op_params.inputs = &inputs;
+      gtl::InlinedVector<AllocatorAttributes, 4> input_aa(
+          {AllocatorAttributes()});
+      op_params.input_alloc_attrs = &input_aa;
+      DeviceContext* dev_ctx = new DeviceContext;
+      gtl::InlinedVector<DeviceContext*, 4> input_dc({dev_ctx});
+      op_params.input_device_contexts = &input_dc;
+      op_params.op_device_context = dev_ctx;
+      int forward_from = 0;
+      op_params.forward_from_array = &forward_from;
+      AllocatorAttributes generic_alloc_attr;
+      op_params.output_attr_array = &generic_alloc_attr;
+      NodeDef node_def;
+      TF_CHECK_OK(
+          NodeDefBuilder("collective_reduce", "CollectiveReduce")
+              .Attr("T", col_params_.instance.data_type)
+              .Attr("merge_op", "Add")
+              .Attr("final_op", "Div")
+              .Attr("group_size", col_params_.group.group_size)
+              .Attr("group_key", col_params_.group.group_key)
+              .Attr("instance_key", col_params_.instance.instance_key)
+              .Attr("subdiv_offsets", {0})
+              .Input(FakeInput(col_params_.instance.data_type))
+              .Finalize(&node_def));
+      std::unique_ptr<OpKernel> op = GetKernel(node_def, DEVICE_CPU, device_);
+      op_params.op_kernel = op.get();
+      OpKernelContext ctx(&op_params, 1);
+
+      // We never actually execute the kernel, so we need to do the
+      // output allocation that it would do, ourselves.
+      Tensor* output_tensor_ptr = nullptr;
+      TF_CHECK_OK(ctx.forward_input_or_allocate_output({0}, 0, tensor_.shape(),
+                                                       &output_tensor_ptr));
+
+      string exec_key =
+          strings::StrCat(col_params_.instance.instance_key, ":0:0");
+      HierarchicalReducer hr(parent_->col_exec_, parent_->dev_mgr_.get(), &ctx,
+                             &op_params, col_params_, exec_key, kStepId,
+                             &tensor_, output_tensor_ptr);
+      Notification note;
+      hr.Run([this, &note](const Status& s) {
+        status_ = s;
+        note.Notify();
+      });
+      note.WaitForNotification();
+      CHECK(tensor_.CopyFrom(*ctx.mutable_output(0), tensor_.shape()));
+      dev_ctx->Unref();
+    }
+
+    HierarchicalReducerTest* parent_;
+    Device* device_;
+    Tensor tensor_;
+    CollectiveParams col_params_;
+    Status status_;
+  };
+
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  CollectiveExecutor* col_exec_ = nullptr;
+  CollectiveRemoteAccessLocal* rma_;
+  std::unique_ptr<DeviceResolverLocal> dev_resolver_;
+  std::unique_ptr<DeviceMgr> dev_mgr_;
+  std::vector<DeviceInstance*> instances_;
+  CollectiveParams col_params_;
+};
+
+TEST(HierarchicalReducerIsApplicableTest, NeedsManyTasksAndDevices) {
+  CollectiveParams cp;
+  cp.instance.task_names = {"/job:worker/task:0", "/job:worker/task:0"};
+  EXPECT_FALSE(HierarchicalReducer::IsApplicable(cp));
+  cp.instance.task_names = {"/job:worker/task:0", "/job:worker/task:1"};
+  EXPECT_FALSE(HierarchicalReducer::IsApplicable(cp));
+  cp.instance.task_names.push_back("/job:worker/task:1");
+  EXPECT_TRUE(HierarchicalReducer::IsApplicable(cp));
+}
+
+TEST_F(HierarchicalReducerTest, Float_2Workers_4Devices) {
+  RunTest<float>(DT_FLOAT, 2, 4, 1001, 0);
+}
+
+TEST_F(HierarchicalReducerTest, Float_4Workers_2Devices) {
+  RunTest<float>(DT_FLOAT, 4, 2, 4096, 0);
+}
+
+TEST_F(HierarchicalReducerTest, Double_3Workers_3Devices_ShortTensor) {
+  RunTest<double>(DT_DOUBLE, 3, 3, 2, 0);
+}
+
+TEST_F(HierarchicalReducerTest, Int64_2Workers_8Devices) {
+  RunTest<int64>(DT_INT64, 2, 8, 9408, 0);
+}
+
+TEST_F(HierarchicalReducerTest, Float_2Workers_4Devices_Abort) {
+  RunTest<float>(DT_FLOAT, 2, 4, 1001, 5);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,13 +16,22 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "tensorflow/core/common_runtime/local_device.h"
+
+#include <algorithm>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/eigen_thread_pool.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_feature_guard.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -32,29 +41,47 @@ namespace tensorflow {
 bool LocalDevice::use_global_threadpool_ = true;
 
 struct LocalDevice::EigenThreadPoolInfo {
-  explicit EigenThreadPoolInfo(const SessionOptions& options) {
+  // If 'numa_node' is not port::kNUMANoAffinity, the threads are restricted
+  // to that node, and an inter-op pool for the node is created as well.
+  EigenThreadPoolInfo(const SessionOptions& options, int numa_node) {
     int32 intra_op_parallelism_threads =
         options.config.intra_op_parallelism_threads();
     if (intra_op_parallelism_threads == 0) {
       intra_op_parallelism_threads = port::NumSchedulableCPUs();
     }
+    if (numa_node != port::kNUMANoAffinity) {
+      intra_op_parallelism_threads =
+          std::max(1, intra_op_parallelism_threads / port::NUMANumNodes());
+    }
     VLOG(1) << "Local device intra op parallelism threads: "
             << intra_op_parallelism_threads;
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node;
     eigen_worker_threads_.num_threads = intra_op_parallelism_threads;
     eigen_worker_threads_.workers = new thread::ThreadPool(
-        options.env, "Eigen", intra_op_parallelism_threads);
+        options.env, thread_options,
+        numa_node == port::kNUMANoAffinity
+            ? "Eigen"
+            : strings::StrCat("numa_", numa_node, "_Eigen"),
+        intra_op_parallelism_threads);
     eigen_threadpool_wrapper_.reset(
         new EigenThreadPoolWrapper(eigen_worker_threads_.workers));
     eigen_device_.reset(new Eigen::ThreadPoolDevice(
         eigen_threadpool_wrapper_.get(), eigen_worker_threads_.num_threads));
+    if (numa_node != port::kNUMANoAffinity) {
+      inter_op_pool_.reset(NewThreadPoolFromSessionOptions(options, numa_node));
+    }
   }
 
   ~EigenThreadPoolInfo() {
+    inter_op_pool_.reset();
     eigen_threadpool_wrapper_.reset();
     eigen_device_.reset();
     delete eigen_worker_threads_.workers;
   }
 
+  // Only set for pools restricted to a NUMA node.
+  std::unique_ptr<thread::ThreadPool> inter_op_pool_;
   DeviceBase::CpuWorkerThreads eigen_worker_threads_;
   std::unique_ptr<Eigen::ThreadPoolInterface> eigen_threadpool_wrapper_;
   std::unique_ptr<Eigen::ThreadPoolDevice> eigen_device_;
@@ -66,21 +93,44 @@ LocalDevice::LocalDevice(const SessionOptions& options,
   // Log info messages if TensorFlow is not compiled with instructions that
   // could speed up performance and are available on the current CPU.
   port::InfoAboutUnusedCPUFeatures();
+  // CPU devices assigned a NUMA node get thread pools restricted to it.
+  int numa_node = port::kNUMANoAffinity;
+  if (options.config.experimental().use_numa_affinity() &&
+      port::NUMAEnabled() && attributes.device_type() == DEVICE_CPU &&
+      attributes.locality().numa_node() >= 0 &&
+      attributes.locality().numa_node() < port::NUMANumNodes()) {
+    numa_node = attributes.locality().numa_node();
+  }
   LocalDevice::EigenThreadPoolInfo* tp_info;
   if (use_global_threadpool_) {
-    // All ThreadPoolDevices in the process will use this single fixed
-    // sized threadpool for numerical computations.
-    static LocalDevice::EigenThreadPoolInfo* global_tp_info =
-        new LocalDevice::EigenThreadPoolInfo(options);
-    tp_info = global_tp_info;
+    // All ThreadPoolDevices in the process (on the same NUMA node) will use
+    // this single fixed sized threadpool for numerical computations.
+    static mutex* global_tp_mu = new mutex;
+    static std::vector<LocalDevice::EigenThreadPoolInfo*>* global_tp_info =
+        new std::vector<LocalDevice::EigenThreadPoolInfo*>;
+    // Index 0 holds the pool without NUMA affinity.
+    const size_t index = numa_node + 1;
+    mutex_lock l(*global_tp_mu);
+    if (global_tp_info->size() <= index) {
+      global_tp_info->resize(index + 1, nullptr);
+    }
+    if ((*global_tp_info)[index] == nullptr) {
+      (*global_tp_info)[index] =
+          new LocalDevice::EigenThreadPoolInfo(options, numa_node);
+    }
+    tp_info = (*global_tp_info)[index];
   } else {
     // Each LocalDevice owns a separate ThreadPoolDevice for numerical
     // computations.
-    owned_tp_info_.reset(new LocalDevice::EigenThreadPoolInfo(options));
+    owned_tp_info_.reset(
+        new LocalDevice::EigenThreadPoolInfo(options, numa_node));
     tp_info = owned_tp_info_.get();
   }
   set_tensorflow_cpu_worker_threads(&tp_info->eigen_worker_threads_);
   set_eigen_cpu_device(tp_info->eigen_device_.get());
+  if (tp_info->inter_op_pool_ != nullptr) {
+    set_tensorflow_device_thread_pool(tp_info->inter_op_pool_.get());
+  }
 }
 
 LocalDevice::~LocalDevice() {}
@@ -0,0 +1,184 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_timeline.h"
+
+#include <algorithm>
+#include <map>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+thread_local const string* current_op_name = nullptr;
+thread_local int64 current_step_id = -1;
+
+const char kUnknownOp[] = "<unknown>";
+
+}  // namespace
+
+ScopedMemoryAnnotation::ScopedMemoryAnnotation(const string* op_name,
+                                               int64 step_id)
+    : saved_op_name_(current_op_name), saved_step_id_(current_step_id) {
+  current_op_name = op_name;
+  current_step_id = step_id;
+}
+
+ScopedMemoryAnnotation::~ScopedMemoryAnnotation() {
+  current_op_name = saved_op_name_;
+  current_step_id = saved_step_id_;
+}
+
+// static
+const string* ScopedMemoryAnnotation::CurrentOpName() {
+  return current_op_name;
+}
+
+// static
+int64 ScopedMemoryAnnotation::CurrentStepId() { return current_step_id; }
+
+string PeakMemoryBreakdown::DebugString(int max_entries) const {
+  string out = strings::StrCat(
+      "Peak of ", strings::HumanReadableNumBytes(peak_bytes), " in step ",
+      step_id, " at ", timestamp_us, "us.\nBytes by op:\n");
+  for (int i = 0; i < bytes_by_op.size() && i < max_entries; ++i) {
+    strings::StrAppend(&out, "  ",
+                       strings::HumanReadableNumBytes(bytes_by_op[i].second),
+                       "\t", bytes_by_op[i].first, "\n");
+  }
+  strings::StrAppend(&out, "Largest allocations:\n");
+  for (int i = 0; i < allocations.size() && i < max_entries; ++i) {
+    strings::StrAppend(&out, "  ",
+                       strings::HumanReadableNumBytes(allocations[i].bytes),
+                       "\t", allocations[i].op_name, " (step ",
+                       allocations[i].step_id, ")\n");
+  }
+  return out;
+}
+
+MemoryTimeline::MemoryTimeline(size_t capacity) : capacity_(capacity) {
+  CHECK_GT(capacity, 0);
+}
+
+void MemoryTimeline::RecordAllocation(const void* ptr, int64 bytes) {
+  const string* op_name = ScopedMemoryAnnotation::CurrentOpName();
+  const int64 step_id = ScopedMemoryAnnotation::CurrentStepId();
+  const int64 now_us = Env::Default()->NowMicros();
+  mutex_lock l(mu_);
+  if (op_name != nullptr) op_name = &*op_names_.insert(*op_name).first;
+  live_[ptr] = {op_name, step_id, bytes};
+  bytes_in_use_ += bytes;
+  AddEvent({ptr, op_name, step_id, now_us, bytes, bytes_in_use_});
+}
+
+void MemoryTimeline::RecordDeallocation(const void* ptr) {
+  const int64 now_us = Env::Default()->NowMicros();
+  mutex_lock l(mu_);
+  auto it = live_.find(ptr);
+  if (it == live_.end()) return;
+  const LiveAllocation allocation = it->second;
+  live_.erase(it);
+  bytes_in_use_ -= allocation.bytes;
+  // The event keeps the op of the allocation, so that it can be brought
+  // back to life when the timeline is replayed backwards.
+  AddEvent({ptr, allocation.op_name, allocation.step_id, now_us,
+            -allocation.bytes, bytes_in_use_});
+}
+
+void MemoryTimeline::AddEvent(const Event& event) {
+  if (events_.size() < capacity_) {
+    events_.push_back(event);
+  } else {
+    events_[next_] = event;
+    next_ = (next_ + 1) % capacity_;
+  }
+}
+
+bool MemoryTimeline::GetPeakBreakdown(int64 step_id,
+                                      PeakMemoryBreakdown* breakdown) const {
+  mutex_lock l(mu_);
+  const size_t n = events_.size();
+  // The i-th oldest event.
+  auto event = [this, n](size_t i) -> const Event& {
+    return events_[(next_ + i) % n];
+  };
+  // Allocation events carry the step that made them, and so do
+  // deallocations, so the peak is looked for among the allocations.
+  size_t peak = n;
+  for (size_t i = 0; i < n; ++i) {
+    const Event& e = event(i);
+    if (e.bytes > 0 && e.step_id == step_id &&
+        (peak == n || e.bytes_in_use > event(peak).bytes_in_use)) {
+      peak = i;
+    }
+  }
+  if (peak == n) return false;
+
+  // Undoes the events after the peak, newest first.
+  LiveMap live = live_;
+  for (size_t i = n; i-- > peak + 1;) {
+    const Event& e = event(i);
+    if (e.bytes > 0) {
+      live.erase(e.ptr);
+    } else {
+      live[e.ptr] = {e.op_name, e.step_id, -e.bytes};
+    }
+  }
+  breakdown->step_id = step_id;
+  breakdown->timestamp_us = event(peak).timestamp_us;
+  breakdown->peak_bytes = event(peak).bytes_in_use;
+  Summarize(live, breakdown);
+  return true;
+}
+
+void MemoryTimeline::GetLiveBreakdown(PeakMemoryBreakdown* breakdown) const {
+  mutex_lock l(mu_);
+  breakdown->step_id = -1;
+  breakdown->timestamp_us = Env::Default()->NowMicros();
+  breakdown->peak_bytes = bytes_in_use_;
+  Summarize(live_, breakdown);
+}
+
+// static
+void MemoryTimeline::Summarize(const LiveMap& live,
+                               PeakMemoryBreakdown* breakdown) {
+  std::map<string, int64> bytes_by_op;
+  breakdown->allocations.clear();
+  for (const auto& it : live) {
+    const LiveAllocation& a = it.second;
+    const string op_name = a.op_name != nullptr ? *a.op_name : kUnknownOp;
+    bytes_by_op[op_name] += a.bytes;
+    breakdown->allocations.push_back({op_name, a.step_id, a.bytes});
+  }
+  std::sort(breakdown->allocations.begin(), breakdown->allocations.end(),
+            [](const PeakMemoryBreakdown::Allocation& a,
+               const PeakMemoryBreakdown::Allocation& b) {
+              return a.bytes > b.bytes;
+            });
+  breakdown->bytes_by_op.assign(bytes_by_op.begin(), bytes_by_op.end());
+  std::stable_sort(breakdown->bytes_by_op.begin(),
+                   breakdown->bytes_by_op.end(),
+                   [](const std::pair<string, int64>& a,
+                      const std::pair<string, int64>& b) {
+                     return a.second > b.second;
+                   });
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,137 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_TIMELINE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_TIMELINE_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Attributes the allocations made by the current thread while it is in
+// scope to the op named "*op_name" in step "step_id". "*op_name" must
+// outlive the annotation. The executor annotates the computation of every
+// kernel; allocations made outside of any annotation belong to no op and
+// to step -1.
+class ScopedMemoryAnnotation {
+ public:
+  ScopedMemoryAnnotation(const string* op_name, int64 step_id);
+  ~ScopedMemoryAnnotation();
+
+  // The op name (or nullptr) and step of the innermost annotation of the
+  // current thread.
+  static const string* CurrentOpName();
+  static int64 CurrentStepId();
+
+ private:
+  const string* const saved_op_name_;
+  const int64 saved_step_id_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedMemoryAnnotation);
+};
+
+// The allocations that were live when an allocator reached a peak.
+struct PeakMemoryBreakdown {
+  struct Allocation {
+    string op_name;
+    int64 step_id;
+    int64 bytes;
+  };
+
+  int64 step_id = -1;
+  int64 timestamp_us = 0;
+  // The bytes in use at the peak.
+  int64 peak_bytes = 0;
+  // The live bytes of each op, largest first.
+  std::vector<std::pair<string, int64>> bytes_by_op;
+  // The live allocations, largest first.
+  std::vector<Allocation> allocations;
+
+  // Returns a report of the breakdown, with at most "max_entries" ops and
+  // allocations.
+  string DebugString(int max_entries) const;
+};
+
+// A fixed-size ring of the most recent allocation and deallocation events
+// of an allocator, from which the breakdown of the memory in use at the
+// peak of a step is reconstructed. Events are recorded in a few dozen bytes
+// each and attributed to ops with ScopedMemoryAnnotation.
+//
+// This class is thread-safe.
+class MemoryTimeline {
+ public:
+  // Keeps the last "capacity" events.
+  explicit MemoryTimeline(size_t capacity);
+
+  // Records the allocation of "bytes" bytes at "ptr", or its deallocation.
+  void RecordAllocation(const void* ptr, int64 bytes);
+  void RecordDeallocation(const void* ptr);
+
+  // Fills in "*breakdown" with the allocations that were live at the
+  // highest point of the memory in use during step "step_id". Returns false
+  // if no event of the step is left in the timeline.
+  bool GetPeakBreakdown(int64 step_id, PeakMemoryBreakdown* breakdown) const;
+
+  // Fills in "*breakdown" with the allocations that are live now.
+  void GetLiveBreakdown(PeakMemoryBreakdown* breakdown) const;
+
+ private:
+  struct Event {
+    const void* ptr;
+    // The name of the op that made the allocation, interned in op_names_,
+    // or nullptr.
+    const string* op_name;
+    int64 step_id;
+    int64 timestamp_us;
+    // Positive for allocations and negative for deallocations.
+    int64 bytes;
+    // The bytes in use after the event.
+    int64 bytes_in_use;
+  };
+  // Allocations made before the timeline was created are not tracked.
+  struct LiveAllocation {
+    const string* op_name;
+    int64 step_id;
+    int64 bytes;
+  };
+  typedef std::unordered_map<const void*, LiveAllocation> LiveMap;
+
+  void AddEvent(const Event& event) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Summarizes "live" into "*breakdown".
+  static void Summarize(const LiveMap& live, PeakMemoryBreakdown* breakdown);
+
+  const size_t capacity_;
+  mutable mutex mu_;
+  std::unordered_set<string> op_names_ GUARDED_BY(mu_);
+  std::vector<Event> events_ GUARDED_BY(mu_);
+  // The index of the oldest event once the ring is full.
+  size_t next_ GUARDED_BY(mu_) = 0;
+  LiveMap live_ GUARDED_BY(mu_);
+  int64 bytes_in_use_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryTimeline);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_TIMELINE_H_
@@ -0,0 +1,110 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/memory_timeline.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Distinct fake addresses.
+const void* Ptr(int i) { return reinterpret_cast<const void*>(256 * i); }
+
+TEST(MemoryTimelineTest, Annotation) {
+  EXPECT_EQ(nullptr, ScopedMemoryAnnotation::CurrentOpName());
+  const string outer = "outer";
+  const string inner = "inner";
+  {
+    ScopedMemoryAnnotation a(&outer, 1);
+    {
+      ScopedMemoryAnnotation b(&inner, 2);
+      EXPECT_EQ(&inner, ScopedMemoryAnnotation::CurrentOpName());
+      EXPECT_EQ(2, ScopedMemoryAnnotation::CurrentStepId());
+    }
+    EXPECT_EQ(&outer, ScopedMemoryAnnotation::CurrentOpName());
+    EXPECT_EQ(1, ScopedMemoryAnnotation::CurrentStepId());
+  }
+  EXPECT_EQ(nullptr, ScopedMemoryAnnotation::CurrentOpName());
+  EXPECT_EQ(-1, ScopedMemoryAnnotation::CurrentStepId());
+}
+
+TEST(MemoryTimelineTest, PeakBreakdown) {
+  MemoryTimeline timeline(100);
+  const string conv = "conv";
+  const string relu = "relu";
+  {
+    ScopedMemoryAnnotation a(&conv, 1);
+    timeline.RecordAllocation(Ptr(1), 1000);
+    timeline.RecordAllocation(Ptr(2), 500);
+  }
+  {
+    ScopedMemoryAnnotation a(&relu, 1);
+    timeline.RecordAllocation(Ptr(3), 300);  // The peak of step 1: 1800.
+  }
+  timeline.RecordDeallocation(Ptr(2));
+  timeline.RecordDeallocation(Ptr(3));
+  {
+    ScopedMemoryAnnotation a(&relu, 2);
+    timeline.RecordAllocation(Ptr(4), 100);
+  }
+
+  PeakMemoryBreakdown breakdown;
+  ASSERT_TRUE(timeline.GetPeakBreakdown(1, &breakdown));
+  EXPECT_EQ(1, breakdown.step_id);
+  EXPECT_EQ(1800, breakdown.peak_bytes);
+  ASSERT_EQ(2, breakdown.bytes_by_op.size());
+  EXPECT_EQ("conv", breakdown.bytes_by_op[0].first);
+  EXPECT_EQ(1500, breakdown.bytes_by_op[0].second);
+  EXPECT_EQ("relu", breakdown.bytes_by_op[1].first);
+  EXPECT_EQ(300, breakdown.bytes_by_op[1].second);
+  ASSERT_EQ(3, breakdown.allocations.size());
+  EXPECT_EQ(1000, breakdown.allocations[0].bytes);
+  EXPECT_EQ(300, breakdown.allocations[2].bytes);
+
+  ASSERT_TRUE(timeline.GetPeakBreakdown(2, &breakdown));
+  EXPECT_EQ(1100, breakdown.peak_bytes);
+  EXPECT_FALSE(timeline.GetPeakBreakdown(3, &breakdown));
+
+  timeline.GetLiveBreakdown(&breakdown);
+  EXPECT_EQ(1100, breakdown.peak_bytes);
+  ASSERT_EQ(2, breakdown.allocations.size());
+  EXPECT_EQ("conv", breakdown.allocations[0].op_name);
+  EXPECT_EQ("relu", breakdown.allocations[1].op_name);
+  EXPECT_EQ(2, breakdown.allocations[1].step_id);
+}
+
+TEST(MemoryTimelineTest, RingKeepsLastEvents) {
+  MemoryTimeline timeline(2);
+  const string op = "op";
+  {
+    ScopedMemoryAnnotation a(&op, 1);
+    timeline.RecordAllocation(Ptr(1), 10);
+  }
+  // The allocation of step 1 falls out of the ring, but is still live.
+  timeline.RecordAllocation(Ptr(2), 20);
+  timeline.RecordAllocation(Ptr(3), 30);
+  PeakMemoryBreakdown breakdown;
+  EXPECT_FALSE(timeline.GetPeakBreakdown(1, &breakdown));
+  ASSERT_TRUE(timeline.GetPeakBreakdown(-1, &breakdown));
+  EXPECT_EQ(60, breakdown.peak_bytes);
+  ASSERT_EQ(2, breakdown.bytes_by_op.size());
+  EXPECT_EQ("<unknown>", breakdown.bytes_by_op[0].first);
+  EXPECT_EQ(50, breakdown.bytes_by_op[0].second);
+  EXPECT_EQ("op", breakdown.bytes_by_op[1].first);
+}
+
+}  // namespace
+}  // namespace tensorflow
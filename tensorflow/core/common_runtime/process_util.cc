@@ -22,7 +22,10 @@ limitations under the License.
 #endif  // INTEL_MKL
 #include <string.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
@@ -77,10 +80,20 @@ int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options) {
 }
 
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
-    const SessionOptions& options) {
-  const int32 num_threads = NumInterOpThreadsFromSessionOptions(options);
-  VLOG(1) << "Direct session inter op parallelism threads: " << num_threads;
-  return new thread::ThreadPool(options.env, "Compute", num_threads);
+    const SessionOptions& options, int numa_node) {
+  int32 num_threads = NumInterOpThreadsFromSessionOptions(options);
+  if (numa_node == port::kNUMANoAffinity) {
+    VLOG(1) << "Direct session inter op parallelism threads: " << num_threads;
+    return new thread::ThreadPool(options.env, "Compute", num_threads);
+  }
+  num_threads = std::max(1, num_threads / port::NUMANumNodes());
+  VLOG(1) << "Inter op parallelism threads for NUMA node " << numa_node << ": "
+          << num_threads;
+  ThreadOptions thread_options;
+  thread_options.numa_node = numa_node;
+  return new thread::ThreadPool(options.env, thread_options,
+                                strings::StrCat("numa_", numa_node, "_Compute"),
+                                num_threads);
 }
 
 void SchedClosure(std::function<void()> closure) {
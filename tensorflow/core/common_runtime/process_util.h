@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/public/session_options.h"
 
 // TODO(vrv, mrry): Remove this library: its interface circumvents the
@@ -33,9 +34,11 @@ thread::ThreadPool* ComputePool(const SessionOptions& options);
 // Returns number of inter op threads.
 int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options);
 
-// Creates a thread pool with number of inter op threads.
+// Creates a thread pool with number of inter op threads. If 'numa_node' is
+// not port::kNUMANoAffinity, the pool gets its node's share of the threads,
+// which are restricted to that node.
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
-    const SessionOptions& options);
+    const SessionOptions& options, int numa_node = port::kNUMANoAffinity);
 
 // Schedule "closure" in the default thread queue.
 void SchedClosure(std::function<void()> closure);
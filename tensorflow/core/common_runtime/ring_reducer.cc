@@ -90,6 +90,18 @@ RingReducer::RingReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
           col_params_.instance.device_names[col_params_.default_rank]) {
   CHECK_GT(group_size_, 0);
   CHECK_GT(num_subdivs_, 0);
+  if (ChunkCodec::IsApplicable(col_params_)) {
+    const CollectiveCompression compression =
+        col_params_.instance.compression;
+    codec_[0].reset(
+        new ChunkCodec(compression, col_params_.instance.top_k_fraction));
+    // The second pass distributes final values, which must not be sparse.
+    codec_[1].reset(new ChunkCodec(FP16_COMPRESSION, 0));
+  } else if (col_params_.instance.compression != NO_COMPRESSION) {
+    VLOG(1) << "RingReducer " << col_params_.name
+            << " sends uncompressed values: compression needs DT_FLOAT on CPU"
+            << " with merge_op Add";
+  }
 }
 
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
@@ -205,6 +217,9 @@ void RingReducer::ContinueAfterInputCopy() {
       group_size_tensor_ = group_size_val;
       group_size_tensor_ready_.Notify();
     }
+  } else {
+    // Nothing to wait for in the destructor.
+    group_size_tensor_ready_.Notify();
   }
   Finish(RunAsyncParts());
 }
@@ -263,7 +278,10 @@ RingReducer::SubContext::SubContext(OpKernelContext* ctx,
   sub_ctx_ = new OpKernelContext(&sub_params_, 1);
 }
 
-Status RingReducer::ComputeBinOp(Device* device, OpKernel* op, Tensor* output,
+/*static*/
+Status RingReducer::ComputeBinOp(OpKernelContext* ctx,
+                                 OpKernelContext::Params* op_params,
+                                 Device* device, OpKernel* op, Tensor* output,
                                  Tensor* input) {
   // Prepare an OpKernelContext that is identical to that of the original Op
   // (i.e. the collective), except for the input output sizes and identities and
@@ -271,7 +289,7 @@ Status RingReducer::ComputeBinOp(Device* device, OpKernel* op, Tensor* output,
   // TODO(tucker): Is it possible to cache and reuse these objects?  They're
   // mostly identical inside one device execution.
   std::unique_ptr<SubContext> sub_ctx(
-      new SubContext(ctx_, op_params_, op, output, input));
+      new SubContext(ctx, op_params, op, output, input));
   device->Compute(op, sub_ctx->sub_ctx_);
   return sub_ctx->sub_ctx_->status();
 }
@@ -364,10 +382,34 @@ void RingReducer::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_.instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  const Tensor* send_tensor = &rf->chunk;
+  const ChunkCodec* codec = codec_[rf->second_pass].get();
+  if (codec) {
+    rf->encoded = codec->AllocateEncoded(
+        device_->GetAllocator(ctx_->output_alloc_attr(0)),
+        rf->chunk.NumElements());
+    Tensor* residual = nullptr;
+    if (codec->compression() == TOP_K_COMPRESSION) {
+      residual = ChunkCodec::Residual(
+          strings::StrCat(col_params_.instance.instance_key, ":", device_name_,
+                          ":", rf->sc_idx),
+          rf->chunk.NumElements());
+    }
+    codec->Encode(rf->chunk, residual, &rf->encoded);
+    if (rf->second_pass && !rf->do_recv) {
+      // This device finalized the chunk: keep the value the others decode.
+      Status s = codec->Decode(rf->encoded, &rf->chunk);
+      if (!s.ok()) {
+        done(s);
+        return;
+      }
+    }
+    send_tensor = &rf->encoded;
+  }
   col_exec_->PostToPeer(col_params_.instance.device_names[send_to_dev_idx],
                         col_params_.instance.task_names[send_to_dev_idx],
                         send_buf_key, device_, ctx_->op_device_context(),
-                        ctx_->output_alloc_attr(0), &rf->chunk,
+                        ctx_->output_alloc_attr(0), send_tensor,
                         device_locality_, done);
 }
 
@@ -382,6 +424,14 @@ void RingReducer::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_.merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  const ChunkCodec* codec = codec_[rf->second_pass].get();
+  if (codec) {
+    // Decoded into dst_tensor by RunAsyncParts().
+    rf->encoded = codec->AllocateEncoded(
+        device_->GetAllocator(ctx_->output_alloc_attr(0)),
+        dst_tensor->NumElements());
+    dst_tensor = &rf->encoded;
+  }
   col_exec_->RecvFromPeer(col_params_.instance.device_names[rf->recv_dev_idx],
                           col_params_.instance.task_names[rf->recv_dev_idx],
                           col_params_.task.is_local[rf->recv_dev_idx],
@@ -461,24 +511,35 @@ bool RingReducer::RunAsyncParts() {
         case RF_RECV:
           CHECK_GT(recv_pending_count, 0);
           --recv_pending_count;
-          if (!rf->second_pass) {
-            rf->action = RF_REDUCE;
-            Status s = ComputeBinOp(device_, col_params_.merge_op.get(),
-                                    &rf->chunk, &rf->tmp_chunk);
+          {
+            Status s;
+            if (codec_[rf->second_pass]) {
+              s = codec_[rf->second_pass]->Decode(
+                  rf->encoded, rf->second_pass ? &rf->chunk : &rf->tmp_chunk);
+            }
+            if (!rf->second_pass) {
+              rf->action = RF_REDUCE;
+              if (s.ok()) {
+                s = ComputeBinOp(ctx_, op_params_, device_,
+                                 col_params_.merge_op.get(), &rf->chunk,
+                                 &rf->tmp_chunk);
+              }
+            } else {
+              rf->action = RF_SEND_READY;
+            }
             if (!s.ok()) {
               aborted = true;
               StartAbort(s);
             }
-          } else {
-            rf->action = RF_SEND_READY;
           }
           break;
         case RF_REDUCE:
           if (!rf->second_pass && col_params_.final_op.get() && rf->is_final) {
             rf->action = RF_FINALIZE;
             group_size_tensor_ready_.WaitForNotification();
-            Status s = ComputeBinOp(device_, col_params_.final_op.get(),
-                                    &rf->chunk, &group_size_tensor_);
+            Status s = ComputeBinOp(ctx_, op_params_, device_,
+                                    col_params_.final_op.get(), &rf->chunk,
+                                    &group_size_tensor_);
             if (!s.ok()) {
               aborted = true;
               StartAbort(s);
@@ -18,6 +18,7 @@ limitations under the License.
 #include <deque>
 
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_compression.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 
@@ -25,16 +26,30 @@ namespace tensorflow {
 class DeviceMgr;
 
 // Ring-algorithm implementation of collective all-reduce.
-class RingReducer {
+//
+// If CollInstanceParams::compression is set and ChunkCodec applies, chunks
+// are encoded before they are sent. With TOP_K_COMPRESSION only the first
+// (reducing) pass is sparsified, with the values left out fed back into
+// the next execution, and the second pass uses FP16_COMPRESSION so that
+// all devices end with the same values.
+class RingReducer : public CollectiveReducer {
  public:
   RingReducer(CollectiveExecutor* col_exec, const DeviceMgr* dev_mgr,
               OpKernelContext* ctx, OpKernelContext::Params* op_params,
               const CollectiveParams& col_params, const string& exec_key,
               int64 step_id, const Tensor* input, Tensor* output);
 
-  virtual ~RingReducer();
+  ~RingReducer() override;
 
-  void Run(StatusCallback done);
+  void Run(StatusCallback done) override;
+
+  // Runs 'op', a merge_op or final_op, on 'device' to update 'output' in
+  // place with 'input', in an OpKernelContext that is otherwise identical to
+  // 'ctx'.
+  static Status ComputeBinOp(OpKernelContext* ctx,
+                             OpKernelContext::Params* op_params,
+                             Device* device, OpKernel* op, Tensor* output,
+                             Tensor* input);
 
  private:
   // Called when a bad status is received that implies we should terminate
@@ -42,8 +57,6 @@ class RingReducer {
   void StartAbort(const Status& s);
   void ContinueAfterInputCopy();
   void Finish(bool ok);
-  Status ComputeBinOp(Device* device, OpKernel* op, Tensor* output,
-                      Tensor* input);
   bool RunAsyncParts();
 
   // Used for executing a sub-operation, e.g. a merge_op instance, with
@@ -90,6 +103,7 @@ class RingReducer {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor encoded;  // send or recv buffer, when compressing
     Status status;
     string DebugString() const;
   };
@@ -128,6 +142,8 @@ class RingReducer {
   const int64 step_id_;
   const int group_size_;
   const int num_subdivs_;
+  // Codec for the values sent in each pass, or null.
+  std::unique_ptr<ChunkCodec> codec_[2];
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
   std::unique_ptr<CollectiveAdapter> ca_;
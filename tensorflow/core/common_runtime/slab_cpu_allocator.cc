@@ -0,0 +1,308 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/slab_cpu_allocator.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include "tensorflow/core/framework/allocator_registry.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+constexpr size_t SlabCPUAllocator::kSlabBytes;
+constexpr size_t SlabCPUAllocator::kMaxSlabAllocationBytes;
+constexpr int SlabCPUAllocator::kNumCacheShards;
+constexpr int SlabCPUAllocator::kTransferBatch;
+constexpr int SlabCPUAllocator::kLeafBits;
+constexpr int SlabCPUAllocator::kRootBits;
+
+namespace {
+
+int64 MaxOf(std::atomic<int64>* max_value, int64 value) {
+  int64 current = max_value->load(std::memory_order_relaxed);
+  while (current < value &&
+         !max_value->compare_exchange_weak(current, value,
+                                           std::memory_order_relaxed)) {
+  }
+  return std::max(current, value);
+}
+
+}  // namespace
+
+SlabCPUAllocator::SlabCPUAllocator() {
+  // Size classes: 64, 128, then 2^k and 1.5 * 2^k up to the limit. Every
+  // class is a multiple of kAllocatorAlignment, so blocks carved from an
+  // aligned slab stay aligned.
+  block_bytes_.push_back(Allocator::kAllocatorAlignment);
+  for (size_t b = 2 * Allocator::kAllocatorAlignment;
+       b <= kMaxSlabAllocationBytes; b *= 2) {
+    block_bytes_.push_back(b);
+    if (b + b / 2 <= kMaxSlabAllocationBytes) block_bytes_.push_back(b + b / 2);
+  }
+  size_classes_.reset(new SizeClass[block_bytes_.size()]);
+  for (size_t c = 0; c < block_bytes_.size(); ++c) {
+    size_classes_[c].block_bytes = block_bytes_[c];
+  }
+  shards_.reset(new CacheShard[kNumCacheShards]);
+  for (int i = 0; i < kNumCacheShards; ++i) {
+    mutex_lock l(shards_[i].mu);
+    shards_[i].free_blocks.resize(block_bytes_.size());
+  }
+  for (auto& leaf : slab_map_) {
+    leaf.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+SlabCPUAllocator::~SlabCPUAllocator() {
+  {
+    mutex_lock l(chunks_mu_);
+    for (void* slab : slabs_) {
+      for (const auto& v : free_visitors_) v(slab, kSlabBytes);
+      port::AlignedFree(slab);
+    }
+  }
+  for (auto& leaf : slab_map_) {
+    delete[] leaf.load(std::memory_order_relaxed);
+  }
+}
+
+int SlabCPUAllocator::SizeClassFor(size_t num_bytes) const {
+  return std::lower_bound(block_bytes_.begin(), block_bytes_.end(),
+                          num_bytes) -
+         block_bytes_.begin();
+}
+
+int SlabCPUAllocator::SizeClassOf(const void* ptr) const {
+  const uint64 index = reinterpret_cast<std::uintptr_t>(ptr) / kSlabBytes;
+  if ((index >> (kRootBits + kLeafBits)) != 0) return -1;
+  const std::atomic<uint8>* leaf =
+      slab_map_[index >> kLeafBits].load(std::memory_order_acquire);
+  if (leaf == nullptr) return -1;
+  return static_cast<int>(
+             leaf[index & ((1 << kLeafBits) - 1)].load(
+                 std::memory_order_acquire)) -
+         1;
+}
+
+SlabCPUAllocator::CacheShard* SlabCPUAllocator::ShardForCurrentThread() {
+  const size_t h = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return &shards_[h % kNumCacheShards];
+}
+
+bool SlabCPUAllocator::AddSlab(int c, SizeClass* size_class) {
+  void* slab = port::AlignedMalloc(kSlabBytes, kSlabBytes);
+  if (slab == nullptr) return false;
+  const uint64 index = reinterpret_cast<std::uintptr_t>(slab) / kSlabBytes;
+  if ((index >> (kRootBits + kLeafBits)) != 0) {
+    // Outside of the range covered by slab_map_.
+    port::AlignedFree(slab);
+    return false;
+  }
+  {
+    mutex_lock l(slab_map_mu_);
+    std::atomic<std::atomic<uint8>*>& root = slab_map_[index >> kLeafBits];
+    std::atomic<uint8>* leaf = root.load(std::memory_order_relaxed);
+    if (leaf == nullptr) {
+      leaf = new std::atomic<uint8>[1 << kLeafBits];
+      for (int i = 0; i < (1 << kLeafBits); ++i) {
+        leaf[i].store(0, std::memory_order_relaxed);
+      }
+      root.store(leaf, std::memory_order_release);
+    }
+    leaf[index & ((1 << kLeafBits) - 1)].store(c + 1,
+                                               std::memory_order_release);
+  }
+  {
+    mutex_lock l(chunks_mu_);
+    slabs_.push_back(slab);
+    for (const auto& v : alloc_visitors_) v(slab, kSlabBytes);
+  }
+  slab_bytes_.fetch_add(kSlabBytes, std::memory_order_relaxed);
+  size_class->next_block = static_cast<char*>(slab);
+  size_class->slab_end = static_cast<char*>(slab) + kSlabBytes;
+  return true;
+}
+
+void SlabCPUAllocator::RefillFromCentral(int c, std::vector<void*>* blocks) {
+  SizeClass* size_class = &size_classes_[c];
+  mutex_lock l(size_class->mu);
+  std::vector<void*>& central = size_class->free_blocks;
+  const size_t num_moved = std::min<size_t>(kTransferBatch, central.size());
+  blocks->insert(blocks->end(), central.end() - num_moved, central.end());
+  central.resize(central.size() - num_moved);
+  // Carve fresh blocks for the rest of the batch, but never more than one
+  // new slab per refill.
+  bool added_slab = false;
+  while (blocks->size() < kTransferBatch) {
+    if (size_class->next_block + size_class->block_bytes >
+        size_class->slab_end) {
+      if (added_slab || !AddSlab(c, size_class)) break;
+      added_slab = true;
+    }
+    blocks->push_back(size_class->next_block);
+    size_class->next_block += size_class->block_bytes;
+  }
+}
+
+void SlabCPUAllocator::RecordAlloc(size_t bytes) {
+  num_allocs_.fetch_add(1, std::memory_order_relaxed);
+  const int64 in_use =
+      bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  MaxOf(&max_bytes_in_use_, in_use);
+  MaxOf(&max_alloc_size_, bytes);
+}
+
+void SlabCPUAllocator::RecordDealloc(size_t bytes) {
+  bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void* SlabCPUAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (num_bytes > kMaxSlabAllocationBytes ||
+      alignment > Allocator::kAllocatorAlignment) {
+    void* p = port::AlignedMalloc(num_bytes, alignment);
+    if (p == nullptr) return nullptr;
+    {
+      mutex_lock l(chunks_mu_);
+      large_allocations_[p] = num_bytes;
+      for (const auto& v : alloc_visitors_) v(p, num_bytes);
+    }
+    RecordAlloc(num_bytes);
+    return p;
+  }
+  const int c = SizeClassFor(std::max<size_t>(num_bytes, 1));
+  void* p = nullptr;
+  {
+    CacheShard* shard = ShardForCurrentThread();
+    mutex_lock l(shard->mu);
+    std::vector<void*>& blocks = shard->free_blocks[c];
+    if (blocks.empty()) {
+      RefillFromCentral(c, &blocks);
+      if (blocks.empty()) return nullptr;
+    }
+    p = blocks.back();
+    blocks.pop_back();
+  }
+  RecordAlloc(block_bytes_[c]);
+  return p;
+}
+
+void SlabCPUAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  const int c = SizeClassOf(ptr);
+  if (c < 0) {
+    size_t num_bytes;
+    {
+      mutex_lock l(chunks_mu_);
+      auto it = large_allocations_.find(ptr);
+      CHECK(it != large_allocations_.end())
+          << "Freeing a pointer not allocated by " << Name();
+      num_bytes = it->second;
+      large_allocations_.erase(it);
+      for (const auto& v : free_visitors_) v(ptr, num_bytes);
+    }
+    RecordDealloc(num_bytes);
+    port::AlignedFree(ptr);
+    return;
+  }
+  RecordDealloc(block_bytes_[c]);
+  std::vector<void*> overflow;
+  {
+    CacheShard* shard = ShardForCurrentThread();
+    mutex_lock l(shard->mu);
+    std::vector<void*>& blocks = shard->free_blocks[c];
+    blocks.push_back(ptr);
+    if (blocks.size() >= 2 * kTransferBatch) {
+      overflow.assign(blocks.begin(), blocks.begin() + kTransferBatch);
+      blocks.erase(blocks.begin(), blocks.begin() + kTransferBatch);
+    }
+  }
+  if (!overflow.empty()) {
+    SizeClass* size_class = &size_classes_[c];
+    mutex_lock l(size_class->mu);
+    size_class->free_blocks.insert(size_class->free_blocks.end(),
+                                   overflow.begin(), overflow.end());
+  }
+}
+
+size_t SlabCPUAllocator::AllocatedSizeSlow(const void* ptr) {
+  const int c = SizeClassOf(ptr);
+  if (c < 0) {
+    mutex_lock l(chunks_mu_);
+    auto it = large_allocations_.find(const_cast<void*>(ptr));
+    return it == large_allocations_.end() ? 0 : it->second;
+  }
+  return block_bytes_[c];
+}
+
+void SlabCPUAllocator::GetStats(AllocatorStats* stats) {
+  stats->Clear();
+  stats->num_allocs = num_allocs_.load(std::memory_order_relaxed);
+  stats->bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+  stats->max_bytes_in_use = max_bytes_in_use_.load(std::memory_order_relaxed);
+  stats->max_alloc_size = max_alloc_size_.load(std::memory_order_relaxed);
+}
+
+void SlabCPUAllocator::ClearStats() {
+  num_allocs_.store(0, std::memory_order_relaxed);
+  max_bytes_in_use_.store(bytes_in_use_.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+  max_alloc_size_.store(0, std::memory_order_relaxed);
+}
+
+void SlabCPUAllocator::AddAllocVisitor(Visitor visitor) {
+  mutex_lock l(chunks_mu_);
+  for (void* slab : slabs_) visitor(slab, kSlabBytes);
+  for (const auto& allocation : large_allocations_) {
+    visitor(allocation.first, allocation.second);
+  }
+  alloc_visitors_.push_back(std::move(visitor));
+}
+
+void SlabCPUAllocator::AddFreeVisitor(Visitor visitor) {
+  mutex_lock l(chunks_mu_);
+  free_visitors_.push_back(std::move(visitor));
+}
+
+namespace {
+
+// Takes precedence over the default CPU allocator (priority 100) when
+// TF_CPU_ALLOCATOR_USE_SLAB=true.
+class SlabCPUAllocatorRegistration {
+ public:
+  SlabCPUAllocatorRegistration() {
+    bool use_slab = false;
+    Status status =
+        ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_SLAB", false, &use_slab);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    if (use_slab) {
+      AllocatorRegistry::Global()->Register("SlabCPUAllocator", 110,
+                                            new SlabCPUAllocator);
+    }
+  }
+};
+
+static SlabCPUAllocatorRegistration slab_cpu_allocator_registration;
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,149 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_CPU_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_CPU_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/visitable_allocator.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A CPU allocator that serves small and medium requests from size-classed
+// slabs instead of calling malloc for every tensor buffer.
+//
+// Memory is carved out of kSlabBytes slabs, each dedicated to one size
+// class. Freed blocks go to a cache shard picked by the calling thread, so
+// the common allocate/free pair on an inter-op thread does not contend with
+// other threads; shards exchange blocks with a per-class central free list
+// in batches. Requests larger than kMaxSlabAllocationBytes, or with an
+// alignment above Allocator::kAllocatorAlignment, go straight to
+// port::AlignedMalloc.
+//
+// Slabs are never returned to the system: the footprint of the slab part
+// is the high-water mark of small allocations, and in exchange there is no
+// per-allocation fragmentation of the malloc heap.
+//
+// The chunks that alloc and free visitors see are the slabs and the
+// allocations that bypass them. Visitors added after some chunks exist are
+// called on those chunks when added, so that e.g. RDMA registration covers
+// all of the memory the allocator hands out.
+//
+// Registered in the AllocatorRegistry (and so used by cpu_allocator()) when
+// TF_CPU_ALLOCATOR_USE_SLAB=true.
+class SlabCPUAllocator : public VisitableAllocator {
+ public:
+  static constexpr size_t kSlabBytes = 2 << 20;
+  static constexpr size_t kMaxSlabAllocationBytes = 256 << 10;
+
+  SlabCPUAllocator();
+  ~SlabCPUAllocator() override;
+
+  string Name() override { return "slab_cpu"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  size_t AllocatedSizeSlow(const void* ptr) override;
+  void GetStats(AllocatorStats* stats) override;
+  void ClearStats() override;
+  void AddAllocVisitor(Visitor visitor) override;
+  void AddFreeVisitor(Visitor visitor) override;
+
+  // Returns the total bytes of slabs obtained from the system.
+  int64 SlabBytes() const {
+    return slab_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr int kNumCacheShards = 16;
+  // Number of blocks moved between a shard and the central list at once.
+  static constexpr int kTransferBatch = 32;
+
+  struct SizeClass {
+    mutex mu;
+    size_t block_bytes = 0;
+    std::vector<void*> free_blocks GUARDED_BY(mu);
+    // Uncarved tail of the newest slab of this class.
+    char* next_block GUARDED_BY(mu) = nullptr;
+    char* slab_end GUARDED_BY(mu) = nullptr;
+  };
+
+  struct CacheShard {
+    mutex mu;
+    // free_blocks[c] holds idle blocks of size class c.
+    std::vector<std::vector<void*>> free_blocks GUARDED_BY(mu);
+  };
+
+  // Returns the size class for 'num_bytes' (<= kMaxSlabAllocationBytes).
+  int SizeClassFor(size_t num_bytes) const;
+
+  // Returns the size class of 'ptr', or -1 if it was not allocated from a
+  // slab.
+  int SizeClassOf(const void* ptr) const;
+
+  CacheShard* ShardForCurrentThread();
+
+  // Moves up to kTransferBatch blocks of class 'c' into '*blocks'.
+  void RefillFromCentral(int c, std::vector<void*>* blocks);
+
+  // Carves a new slab for 'size_class'. Returns false if the system is out
+  // of memory.
+  bool AddSlab(int c, SizeClass* size_class)
+      EXCLUSIVE_LOCKS_REQUIRED(size_class->mu);
+
+  void RecordAlloc(size_t bytes);
+  void RecordDealloc(size_t bytes);
+
+  std::vector<size_t> block_bytes_;
+  std::unique_ptr<SizeClass[]> size_classes_;
+  std::unique_ptr<CacheShard[]> shards_;
+
+  // Maps slab index (address / kSlabBytes) to size class + 1, 0 meaning
+  // "not a slab". Two levels, so that lookups from DeallocateRaw() are
+  // lock-free; leaves are allocated once and never freed.
+  static constexpr int kLeafBits = 14;
+  static constexpr int kRootBits = 13;
+  std::atomic<std::atomic<uint8>*> slab_map_[1 << kRootBits];
+  mutex slab_map_mu_;
+
+  // The chunks of memory obtained from the system, and their visitors.
+  mutex chunks_mu_;
+  std::vector<void*> slabs_ GUARDED_BY(chunks_mu_);
+  // Sizes of the allocations that bypass the slabs, as requested.
+  std::unordered_map<void*, size_t> large_allocations_ GUARDED_BY(chunks_mu_);
+  std::vector<Visitor> alloc_visitors_ GUARDED_BY(chunks_mu_);
+  std::vector<Visitor> free_visitors_ GUARDED_BY(chunks_mu_);
+  std::atomic<int64> slab_bytes_{0};
+
+  std::atomic<int64> num_allocs_{0};
+  std::atomic<int64> bytes_in_use_{0};
+  std::atomic<int64> max_bytes_in_use_{0};
+  std::atomic<int64> max_alloc_size_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SlabCPUAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_CPU_ALLOCATOR_H_
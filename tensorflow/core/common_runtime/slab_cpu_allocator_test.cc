@@ -0,0 +1,162 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/slab_cpu_allocator.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(SlabCPUAllocatorTest, SmallAllocationsAreAlignedAndDistinct) {
+  SlabCPUAllocator a;
+  std::vector<void*> ptrs;
+  for (size_t s = 1; s < 5000; s += 7) {
+    void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, s);
+    ASSERT_NE(nullptr, p);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(p) %
+                      Allocator::kAllocatorAlignment);
+    EXPECT_GE(a.AllocatedSizeSlow(p), s);
+    // Touch every byte to catch overlapping blocks under ASAN.
+    memset(p, 0xab, s);
+    ptrs.push_back(p);
+  }
+  std::vector<void*> sorted = ptrs;
+  std::sort(sorted.begin(), sorted.end());
+  EXPECT_EQ(sorted.end(), std::adjacent_find(sorted.begin(), sorted.end()));
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(static_cast<int64>(ptrs.size()), stats.num_allocs);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_GT(stats.max_bytes_in_use, 0);
+}
+
+TEST(SlabCPUAllocatorTest, ReusesFreedBlocks) {
+  SlabCPUAllocator a;
+  void* p1 = a.AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  a.DeallocateRaw(p1);
+  void* p2 = a.AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  EXPECT_EQ(p1, p2);
+  a.DeallocateRaw(p2);
+  EXPECT_EQ(static_cast<int64>(SlabCPUAllocator::kSlabBytes), a.SlabBytes());
+}
+
+TEST(SlabCPUAllocatorTest, LargeAndOveralignedBypassSlabs) {
+  SlabCPUAllocator a;
+  void* big =
+      a.AllocateRaw(Allocator::kAllocatorAlignment,
+                    SlabCPUAllocator::kMaxSlabAllocationBytes + 1);
+  void* aligned = a.AllocateRaw(4096, 100);
+  ASSERT_NE(nullptr, big);
+  ASSERT_NE(nullptr, aligned);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(aligned) % 4096);
+  EXPECT_EQ(0, a.SlabBytes());
+  // Their sizes are tracked whether or not malloc reports them.
+  EXPECT_EQ(SlabCPUAllocator::kMaxSlabAllocationBytes + 1,
+            a.AllocatedSizeSlow(big));
+  EXPECT_EQ(size_t{100}, a.AllocatedSizeSlow(aligned));
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(
+      static_cast<int64>(SlabCPUAllocator::kMaxSlabAllocationBytes + 101),
+      stats.bytes_in_use);
+  a.DeallocateRaw(big);
+  a.DeallocateRaw(aligned);
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+TEST(SlabCPUAllocatorTest, VisitorsSeeSlabsAndLargeAllocations) {
+  std::vector<std::pair<void*, size_t>> allocated;
+  std::vector<std::pair<void*, size_t>> freed;
+  {
+    SlabCPUAllocator a;
+    void* small = a.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+    // A visitor added late is called on the chunks that already exist.
+    a.AddAllocVisitor([&allocated](void* ptr, size_t num_bytes) {
+      allocated.emplace_back(ptr, num_bytes);
+    });
+    a.AddFreeVisitor([&freed](void* ptr, size_t num_bytes) {
+      freed.emplace_back(ptr, num_bytes);
+    });
+    ASSERT_EQ(size_t{1}, allocated.size());
+    EXPECT_EQ(SlabCPUAllocator::kSlabBytes, allocated[0].second);
+    EXPECT_GE(small, allocated[0].first);
+    EXPECT_LT(small, static_cast<char*>(allocated[0].first) +
+                         SlabCPUAllocator::kSlabBytes);
+
+    const size_t big_bytes = SlabCPUAllocator::kMaxSlabAllocationBytes * 2;
+    void* big = a.AllocateRaw(Allocator::kAllocatorAlignment, big_bytes);
+    ASSERT_EQ(size_t{2}, allocated.size());
+    EXPECT_EQ(std::make_pair(big, big_bytes), allocated[1]);
+    a.DeallocateRaw(big);
+    ASSERT_EQ(size_t{1}, freed.size());
+    EXPECT_EQ(std::make_pair(big, big_bytes), freed[0]);
+
+    // Freed blocks stay in their slab.
+    a.DeallocateRaw(small);
+    EXPECT_EQ(size_t{1}, freed.size());
+  }
+  // The slabs are freed with the allocator.
+  ASSERT_EQ(size_t{2}, freed.size());
+  EXPECT_EQ(allocated[0], freed[1]);
+}
+
+TEST(SlabCPUAllocatorTest, ConcurrentAllocations) {
+  SlabCPUAllocator a;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 10000; ++i) {
+          ptrs.push_back(a.AllocateRaw(Allocator::kAllocatorAlignment,
+                                       64 + (i + t) % 4096));
+          if (ptrs.size() > 100) {
+            a.DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* p : ptrs) a.DeallocateRaw(p);
+      });
+    }
+  }
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(80000, stats.num_allocs);
+}
+
+static void BM_SlabAllocation(int iters, int num_bytes) {
+  SlabCPUAllocator a;
+  while (--iters > 0) {
+    void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+    a.DeallocateRaw(p);
+  }
+}
+BENCHMARK(BM_SlabAllocation)->Arg(64)->Arg(4096)->Arg(65536);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,352 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_arena.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Planning needs one bit per (node, planned producer) pair; larger graphs are
+// not planned.
+constexpr int64 kMaxReachabilityBits = int64{1} << 28;
+
+int64 RoundUp(int64 bytes) {
+  const int64 alignment = Allocator::kAllocatorAlignment;
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+int64 PlanStaticMemory(const Graph& graph,
+                       const std::vector<StaticMemoryBuffer>& buffers,
+                       std::vector<int64>* offsets) {
+  const int num_buffers = buffers.size();
+  offsets->assign(num_buffers, 0);
+  if (num_buffers == 0) return 0;
+
+  // Number the producers, and compute for every node the producers it is an
+  // ancestor of.
+  std::unordered_map<int, int> producer_index;
+  for (const StaticMemoryBuffer& buffer : buffers) {
+    producer_index.emplace(buffer.node_id, producer_index.size());
+  }
+  const int64 words = (producer_index.size() + 63) / 64;
+  std::vector<uint64> descendants(graph.num_node_ids() * words, 0);
+  auto bits = [&descendants, words](int node_id) {
+    return descendants.data() + node_id * words;
+  };
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    uint64* node_bits = bits((*it)->id());
+    for (const Edge* edge : (*it)->out_edges()) {
+      const int dst = edge->dst()->id();
+      const uint64* dst_bits = bits(dst);
+      for (int64 w = 0; w < words; ++w) node_bits[w] |= dst_bits[w];
+      auto producer = producer_index.find(dst);
+      if (producer != producer_index.end()) {
+        const int index = producer->second;
+        node_bits[index / 64] |= uint64{1} << (index % 64);
+      }
+    }
+  }
+  auto is_ancestor = [&](int node_id, int producer_id) {
+    const int index = producer_index[producer_id];
+    return (bits(node_id)[index / 64] >> (index % 64)) & 1;
+  };
+
+  // The nodes after which each buffer is dead: its consumers, or its
+  // producer if it has none.
+  std::vector<std::vector<int>> last_users(num_buffers);
+  for (int i = 0; i < num_buffers; ++i) {
+    const Node* node = graph.FindNodeId(buffers[i].node_id);
+    for (const Edge* edge : node->out_edges()) {
+      if (!edge->IsControlEdge() && edge->src_output() == buffers[i].output) {
+        last_users[i].push_back(edge->dst()->id());
+      }
+    }
+    if (last_users[i].empty()) last_users[i].push_back(node->id());
+  }
+  // Returns true if buffer 'a' is always dead before buffer 'b' is allocated.
+  auto precedes = [&](int a, int b) {
+    for (int user : last_users[a]) {
+      if (!is_ancestor(user, buffers[b].node_id)) return false;
+    }
+    return true;
+  };
+
+  std::vector<int> by_size(num_buffers);
+  for (int i = 0; i < num_buffers; ++i) by_size[i] = i;
+  std::stable_sort(by_size.begin(), by_size.end(), [&buffers](int a, int b) {
+    return buffers[a].bytes > buffers[b].bytes;
+  });
+  int64 arena_bytes = 0;
+  std::vector<int> placed;
+  std::vector<std::pair<int64, int64>> busy;
+  for (int i : by_size) {
+    const int64 bytes = RoundUp(buffers[i].bytes);
+    busy.clear();
+    for (int j : placed) {
+      if (!precedes(i, j) && !precedes(j, i)) {
+        const int64 begin = (*offsets)[j];
+        busy.emplace_back(begin, begin + RoundUp(buffers[j].bytes));
+      }
+    }
+    std::sort(busy.begin(), busy.end());
+    int64 offset = 0;
+    for (const auto& range : busy) {
+      if (offset + bytes <= range.first) break;
+      offset = std::max(offset, range.second);
+    }
+    (*offsets)[i] = offset;
+    arena_bytes = std::max(arena_bytes, offset + bytes);
+    placed.push_back(i);
+  }
+  return arena_bytes;
+}
+
+// The allocator of one output.
+class StaticMemoryArena::Slot : public Allocator {
+ public:
+  Slot(Slots* slots, int index) : slots_(slots), index_(index) {}
+
+  string Name() override { return "static_memory_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+ private:
+  Slots* const slots_;
+  const int index_;
+};
+
+// The allocators of every planned output, in one of two phases: recording
+// the size of the outputs, or serving them from the arena. Every allocation
+// holds a reference, so this outlives the tensors allocated from it.
+class StaticMemoryArena::Slots : public core::RefCounted {
+ public:
+  // Creates recording allocators.
+  Slots(Allocator* allocator, int num_outputs)
+      : allocator_(allocator),
+        recording_(true),
+        recorded_bytes_(num_outputs, 0),
+        num_allocations_(num_outputs, 0) {
+    Init(num_outputs);
+  }
+
+  // Creates allocators serving output i from 'bytes[i]' bytes at
+  // 'offsets[i]' in 'arena', or from 'allocator' if 'bytes[i]' is 0. Takes
+  // ownership of 'arena', which was allocated by 'allocator'.
+  Slots(Allocator* allocator, char* arena, int64 arena_bytes,
+        const std::vector<int64>& offsets, const std::vector<int64>& bytes)
+      : allocator_(allocator),
+        recording_(false),
+        arena_(arena),
+        arena_bytes_(arena_bytes),
+        offsets_(offsets),
+        bytes_(bytes),
+        overlaps_(offsets.size()),
+        live_(offsets.size(), false) {
+    Init(offsets.size());
+    for (int i = 0; i < offsets_.size(); ++i) {
+      if (bytes_[i] == 0) continue;
+      for (int j = i + 1; j < offsets_.size(); ++j) {
+        if (bytes_[j] > 0 && offsets_[i] < offsets_[j] + bytes_[j] &&
+            offsets_[j] < offsets_[i] + bytes_[i]) {
+          overlaps_[i].push_back(j);
+          overlaps_[j].push_back(i);
+        }
+      }
+    }
+  }
+
+  ~Slots() override {
+    if (arena_ != nullptr) allocator_->DeallocateRaw(arena_);
+  }
+
+  Allocator* const* allocators() const { return allocators_.data(); }
+  int64 arena_bytes() const { return arena_bytes_; }
+
+  // Returns the size of output i at the recording step, or 0 if it was not
+  // allocated exactly once.
+  int64 recorded_bytes(int i) {
+    mutex_lock l(mu_);
+    return num_allocations_[i] == 1 ? recorded_bytes_[i] : 0;
+  }
+
+  void* Allocate(int i, size_t alignment, size_t num_bytes) {
+    Ref();
+    void* ptr = nullptr;
+    if (recording_) {
+      mutex_lock l(mu_);
+      recorded_bytes_[i] =
+          std::max(recorded_bytes_[i], static_cast<int64>(num_bytes));
+      ++num_allocations_[i];
+    } else if (static_cast<int64>(num_bytes) <= bytes_[i] &&
+               alignment <= Allocator::kAllocatorAlignment) {
+      mutex_lock l(mu_);
+      bool free = !live_[i];
+      for (int j : overlaps_[i]) free &= !live_[j];
+      if (free) {
+        live_[i] = true;
+        ptr = arena_ + offsets_[i];
+      }
+    }
+    if (ptr == nullptr) ptr = allocator_->AllocateRaw(alignment, num_bytes);
+    if (ptr == nullptr) Unref();
+    return ptr;
+  }
+
+  void Deallocate(int i, void* ptr) {
+    char* p = static_cast<char*>(ptr);
+    if (arena_ != nullptr && p >= arena_ && p < arena_ + arena_bytes_) {
+      mutex_lock l(mu_);
+      live_[i] = false;
+    } else {
+      allocator_->DeallocateRaw(ptr);
+    }
+    Unref();
+  }
+
+ private:
+  void Init(int num_outputs) {
+    for (int i = 0; i < num_outputs; ++i) {
+      slots_.emplace_back(new Slot(this, i));
+      allocators_.push_back(slots_.back().get());
+    }
+  }
+
+  Allocator* const allocator_;
+  const bool recording_;
+  char* const arena_ = nullptr;
+  const int64 arena_bytes_ = 0;
+  const std::vector<int64> offsets_;
+  const std::vector<int64> bytes_;
+  // The outputs whose memory overlaps that of output i.
+  std::vector<std::vector<int>> overlaps_;
+  std::vector<std::unique_ptr<Slot>> slots_;
+  std::vector<Allocator*> allocators_;
+
+  mutex mu_;
+  std::vector<bool> live_ GUARDED_BY(mu_);
+  std::vector<int64> recorded_bytes_ GUARDED_BY(mu_);
+  std::vector<int> num_allocations_ GUARDED_BY(mu_);
+};
+
+void* StaticMemoryArena::Slot::AllocateRaw(size_t alignment,
+                                           size_t num_bytes) {
+  return slots_->Allocate(index_, alignment, num_bytes);
+}
+
+void StaticMemoryArena::Slot::DeallocateRaw(void* ptr) {
+  slots_->Deallocate(index_, ptr);
+}
+
+StaticMemoryArena::StaticMemoryArena(const Graph* graph, Allocator* allocator,
+                                     const std::vector<bool>& plannable)
+    : graph_(graph),
+      allocator_(allocator),
+      output_base_(graph->num_node_ids(), -1) {
+  for (const Node* node : graph->nodes()) {
+    if (!plannable[node->id()] || node->num_outputs() == 0) continue;
+    output_base_[node->id()] = outputs_.size();
+    for (int i = 0; i < node->num_outputs(); ++i) {
+      outputs_.emplace_back(node->id(), i);
+    }
+  }
+  if (!outputs_.empty()) {
+    slots_ = new Slots(allocator_, outputs_.size());
+  }
+}
+
+StaticMemoryArena::~StaticMemoryArena() {
+  if (slots_ != nullptr) slots_->Unref();
+}
+
+Allocator* const* StaticMemoryArena::BeginStep() {
+  mutex_lock l(mu_);
+  if (in_use_ || slots_ == nullptr) return nullptr;
+  in_use_ = true;
+  return slots_->allocators();
+}
+
+void StaticMemoryArena::EndStep() {
+  mutex_lock l(mu_);
+  in_use_ = false;
+  if (!planned_) {
+    planned_ = true;
+    Plan();
+  }
+}
+
+int64 StaticMemoryArena::arena_bytes() const {
+  mutex_lock l(mu_);
+  return planned_ && slots_ != nullptr ? slots_->arena_bytes() : 0;
+}
+
+void StaticMemoryArena::Plan() {
+  Slots* recorded = slots_;
+  slots_ = nullptr;
+  core::ScopedUnref unref(recorded);
+
+  std::vector<StaticMemoryBuffer> buffers;
+  std::vector<int> buffer_output;
+  for (int i = 0; i < outputs_.size(); ++i) {
+    const int64 bytes = recorded->recorded_bytes(i);
+    if (bytes > 0) {
+      buffers.push_back({outputs_[i].first, outputs_[i].second, bytes});
+      buffer_output.push_back(i);
+    }
+  }
+  if (buffers.empty()) return;
+  if (static_cast<int64>(graph_->num_node_ids()) * buffers.size() >
+      kMaxReachabilityBits) {
+    VLOG(1) << "Not planning the outputs of a graph with "
+            << graph_->num_node_ids() << " nodes";
+    return;
+  }
+
+  std::vector<int64> buffer_offsets;
+  const int64 arena_bytes = PlanStaticMemory(*graph_, buffers, &buffer_offsets);
+  char* arena = static_cast<char*>(
+      allocator_->AllocateRaw(Allocator::kAllocatorAlignment, arena_bytes));
+  if (arena == nullptr) {
+    LOG(WARNING) << "Could not allocate a static memory arena of "
+                 << arena_bytes << " bytes with " << allocator_->Name();
+    return;
+  }
+  std::vector<int64> offsets(outputs_.size(), 0);
+  std::vector<int64> bytes(outputs_.size(), 0);
+  int64 total_bytes = 0;
+  for (int i = 0; i < buffers.size(); ++i) {
+    offsets[buffer_output[i]] = buffer_offsets[i];
+    bytes[buffer_output[i]] = buffers[i].bytes;
+    total_bytes += buffers[i].bytes;
+  }
+  VLOG(1) << "Planned " << buffers.size() << " outputs of " << total_bytes
+          << " bytes into a static memory arena of " << arena_bytes
+          << " bytes";
+  slots_ = new Slots(allocator_, arena, arena_bytes, offsets, bytes);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_ARENA_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_ARENA_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An output of a node of a graph to place in a static memory plan.
+struct StaticMemoryBuffer {
+  int node_id;
+  int output;
+  int64 bytes;
+};
+
+// Assigns an offset in a single arena to each of 'buffers', and returns the
+// size of the arena.
+//
+// Two buffers may share memory only if every consumer of one of them is an
+// ancestor in 'graph' of the producer of the other, so that their lifetimes
+// cannot overlap whatever order the executor runs the nodes in. Buffers are
+// placed largest first, each at the lowest offset not used by a buffer it
+// may be live at the same time as.
+int64 PlanStaticMemory(const Graph& graph,
+                       const std::vector<StaticMemoryBuffer>& buffers,
+                       std::vector<int64>* offsets);
+
+// Serves the outputs of the nodes of an executor's graph from one arena
+// allocated once, rather than from the device allocator at every step.
+//
+// The first step runs with allocators that only record the size of every
+// output. At the end of that step the outputs are planned into an arena with
+// PlanStaticMemory, and later steps put each output at its planned offset.
+// An output falls back to the device allocator when it is larger than at the
+// first step, or when a tensor that overlaps its planned memory is still
+// alive. The latter happens when a kernel forwards an input buffer to an
+// output, or when a tensor outlives its step. The plan therefore never
+// aliases live tensors; it is just less effective on graphs whose shapes
+// change between steps.
+//
+// Only one step uses the arena at a time. Steps that run concurrently with
+// it allocate from the device.
+class StaticMemoryArena {
+ public:
+  // Outputs of the nodes for which 'plannable[node->id()]' is false are never
+  // planned. 'graph' must outlive this object.
+  StaticMemoryArena(const Graph* graph, Allocator* allocator,
+                    const std::vector<bool>& plannable);
+  ~StaticMemoryArena();
+
+  // Returns the allocators the outputs of a starting step should use, with
+  // output 'i' of node 'n' at index output_base(n->id()) + i. Returns nullptr
+  // if another step is using the arena. A non-null result must be followed
+  // by a call to EndStep() when the step is done.
+  Allocator* const* BeginStep();
+  void EndStep();
+
+  // Returns the index of the first output of node 'node_id' in the array
+  // returned by BeginStep(), or -1 if its outputs are not planned.
+  int output_base(int node_id) const { return output_base_[node_id]; }
+
+  // The size of the arena, or 0 while no plan has been made.
+  int64 arena_bytes() const;
+
+ private:
+  class Slots;
+  class Slot;
+
+  void Plan() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Graph* const graph_;
+  Allocator* const allocator_;
+  std::vector<int> output_base_;
+  // (node id, output) of each planned output.
+  std::vector<std::pair<int, int>> outputs_;
+
+  mutable mutex mu_;
+  bool in_use_ GUARDED_BY(mu_) = false;
+  bool planned_ GUARDED_BY(mu_) = false;
+  // The allocators of the current phase. Refcounted, since tensors that
+  // outlive a step keep using them.
+  Slots* slots_ GUARDED_BY(mu_) = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryArena);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_ARENA_H_
@@ -0,0 +1,137 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_arena.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class StaticMemoryArenaTest : public ::testing::Test {
+ protected:
+  StaticMemoryArenaTest() : graph_(OpRegistry::Global()) {
+    // x -> a -> b -> c, and x -> d.
+    Tensor value(DT_FLOAT, TensorShape({16}));
+    value.flat<float>().setZero();
+    x_ = test::graph::Constant(&graph_, value);
+    a_ = test::graph::Unary(&graph_, "Neg", x_);
+    b_ = test::graph::Unary(&graph_, "Neg", a_);
+    c_ = test::graph::Unary(&graph_, "Neg", b_);
+    d_ = test::graph::Unary(&graph_, "Neg", x_);
+  }
+
+  Graph graph_;
+  Node* x_;
+  Node* a_;
+  Node* b_;
+  Node* c_;
+  Node* d_;
+};
+
+TEST_F(StaticMemoryArenaTest, PlanReusesMemoryAlongChains) {
+  std::vector<int64> offsets;
+  const int64 arena_bytes = PlanStaticMemory(
+      graph_, {{a_->id(), 0, 256}, {b_->id(), 0, 256}, {c_->id(), 0, 256}},
+      &offsets);
+  // a is dead once b is computed, so c can reuse its memory.
+  EXPECT_EQ(512, arena_bytes);
+  EXPECT_EQ(offsets[0], offsets[2]);
+  EXPECT_NE(offsets[0], offsets[1]);
+}
+
+TEST_F(StaticMemoryArenaTest, PlanSeparatesUnorderedBuffers) {
+  std::vector<int64> offsets;
+  // d may run at any time relative to a, b and c.
+  const int64 arena_bytes = PlanStaticMemory(
+      graph_, {{a_->id(), 0, 256}, {c_->id(), 0, 256}, {d_->id(), 0, 1000}},
+      &offsets);
+  EXPECT_EQ(1024 + 256, arena_bytes);
+  EXPECT_EQ(0, offsets[2]);
+  EXPECT_EQ(1024, offsets[0]);
+  EXPECT_EQ(1024, offsets[1]);
+}
+
+TEST_F(StaticMemoryArenaTest, ServesPlannedOutputsFromArena) {
+  std::vector<bool> plannable(graph_.num_node_ids(), false);
+  plannable[a_->id()] = plannable[b_->id()] = plannable[c_->id()] = true;
+  StaticMemoryArena arena(&graph_, cpu_allocator(), plannable);
+  auto allocate = [&arena](Allocator* const* allocators, const Node* node) {
+    return Tensor(allocators[arena.output_base(node->id())], DT_FLOAT,
+                  TensorShape({64}));
+  };
+
+  // The first step records the sizes of the outputs.
+  Allocator* const* allocators = arena.BeginStep();
+  ASSERT_NE(nullptr, allocators);
+  EXPECT_EQ(nullptr, arena.BeginStep());
+  EXPECT_EQ(-1, arena.output_base(d_->id()));
+  allocate(allocators, a_);
+  allocate(allocators, b_);
+  allocate(allocators, c_);
+  arena.EndStep();
+  EXPECT_EQ(512, arena.arena_bytes());
+
+  // Later steps use the planned offsets.
+  allocators = arena.BeginStep();
+  ASSERT_NE(nullptr, allocators);
+  {
+    Tensor a = allocate(allocators, a_);
+    Tensor b = allocate(allocators, b_);
+    const char* a_data = a.tensor_data().data();
+    a = Tensor();
+    Tensor c = allocate(allocators, c_);
+    EXPECT_EQ(a_data, c.tensor_data().data());
+    EXPECT_NE(b.tensor_data().data(), c.tensor_data().data());
+  }
+  {
+    // c's memory is still in use by a, so c falls back to the device.
+    Tensor a = allocate(allocators, a_);
+    Tensor c = allocate(allocators, c_);
+    EXPECT_NE(a.tensor_data().data(), c.tensor_data().data());
+    // So do outputs larger than at the first step.
+    Tensor b(allocators[arena.output_base(b_->id())], DT_FLOAT,
+             TensorShape({128}));
+    EXPECT_TRUE(b.IsInitialized());
+  }
+  arena.EndStep();
+}
+
+TEST_F(StaticMemoryArenaTest, TensorsCanOutliveArena) {
+  std::vector<bool> plannable(graph_.num_node_ids(), true);
+  Tensor escaped;
+  {
+    StaticMemoryArena arena(&graph_, cpu_allocator(), plannable);
+    Allocator* const* allocators = arena.BeginStep();
+    Tensor(allocators[arena.output_base(a_->id())], DT_FLOAT,
+           TensorShape({64}));
+    arena.EndStep();
+    allocators = arena.BeginStep();
+    escaped = Tensor(allocators[arena.output_base(a_->id())], DT_FLOAT,
+                     TensorShape({64}));
+    arena.EndStep();
+  }
+  escaped.flat<float>().setConstant(1.0f);
+  EXPECT_EQ(1.0f, escaped.flat<float>()(63));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,26 +19,75 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Allocates host memory from one NUMA node.
+class NUMACPUAllocator : public Allocator {
+ public:
+  explicit NUMACPUAllocator(int numa_node)
+      : numa_node_(numa_node),
+        name_(strings::StrCat("numa_", numa_node, "_cpu")) {}
+
+  string Name() override { return name_; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return port::NUMAMalloc(numa_node_, num_bytes, alignment);
+  }
+
+  void DeallocateRaw(void* ptr) override { port::NUMAFree(ptr); }
+
+  // Returns the process-wide allocator of 'numa_node'.
+  static Allocator* ForNode(int numa_node) {
+    static mutex* mu = new mutex;
+    static std::vector<Allocator*>* allocators = new std::vector<Allocator*>;
+    mutex_lock l(*mu);
+    while (allocators->size() <= static_cast<size_t>(numa_node)) {
+      allocators->push_back(new NUMACPUAllocator(allocators->size()));
+    }
+    return (*allocators)[numa_node];
+  }
+
+ private:
+  const int numa_node_;
+  const string name_;
+};
+
+}  // namespace
+
 // TODO(zhifengc/tucker): Figure out the bytes of available RAM.
 class ThreadPoolDeviceFactory : public DeviceFactory {
  public:
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<Device*>* devices) override {
-    // TODO(zhifengc/tucker): Figure out the number of available CPUs
-    // and/or NUMA configuration.
-    int n = 1;
+    // TODO(zhifengc/tucker): Figure out the number of available CPUs.
+    const bool numa_enabled =
+        options.config.experimental().use_numa_affinity() &&
+        port::NUMAEnabled();
+    const int num_numa_nodes = numa_enabled ? port::NUMANumNodes() : 1;
+    // With NUMA affinity, default to one device per node.
+    int n = num_numa_nodes;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
       n = iter->second;
     }
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/device:CPU:", i);
-      devices->push_back(new ThreadPoolDevice(
-          options, name, Bytes(256 << 20), DeviceLocality(), cpu_allocator()));
+      DeviceLocality locality;
+      Allocator* allocator = cpu_allocator();
+      if (numa_enabled) {
+        const int numa_node = i % num_numa_nodes;
+        locality.set_numa_node(numa_node);
+        allocator = NUMACPUAllocator::ForNode(numa_node);
+      }
+      devices->push_back(new ThreadPoolDevice(options, name, Bytes(256 << 20),
+                                              locality, allocator));
     }
 
     return Status::OK();
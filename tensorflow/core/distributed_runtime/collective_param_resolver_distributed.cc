@@ -106,6 +106,9 @@ class CompleteInstanceCall : public CancellableCall {
     }
     req_.set_device(device_name);
     req_.set_is_source(is_source);
+    req_.set_compression(instance.compression);
+    req_.set_top_k_fraction(instance.top_k_fraction);
+    req_.set_implementation(instance.implementation);
   }
 
   ~CompleteInstanceCall() override {}
@@ -192,6 +195,10 @@ void CollectiveParamResolverDistributed::CompleteInstanceAsync(
   for (int32 offset : request->subdiv_offset()) {
     cp->instance.impl_details.subdiv_offsets.push_back(offset);
   }
+  cp->instance.compression = CollectiveCompression(request->compression());
+  cp->instance.top_k_fraction = request->top_k_fraction();
+  cp->instance.implementation =
+      CollectiveImplementation(request->implementation());
   VLOG(1) << "New cp " << cp << " for device " << request->device() << " : "
           << cp->ToString();
   StatusCallback done_and_cleanup = [this, cp, done](const Status& s) {
@@ -375,6 +382,11 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
   if (group_leader_.empty()) {
     // This is the group leader so resolution is local.
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
+  } else if (cp->instance.type != BROADCAST_COLLECTIVE) {
+    // The leader only contributes the source rank of broadcasts. The
+    // other instance params follow from the cached group, so resolution
+    // is local.
+    return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
   } else if (InstanceIsCached(cp->instance.instance_key)) {
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
   } else {
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <atomic>
+
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
@@ -71,14 +73,20 @@ class FakeWorker : public TestWorkerInterface {
                              const CompleteInstanceRequest* request,
                              CompleteInstanceResponse* response,
                              StatusCallback done) override {
+    ++num_complete_instance_calls_;
     param_resolver_->CompleteInstanceAsync(request, response, &cm_, done);
   }
 
+  int num_complete_instance_calls() const {
+    return num_complete_instance_calls_;
+  }
+
  private:
   string name_;
   DeviceMgr* device_mgr_;
   CancellationManager cm_;
   CollectiveParamResolverDistributed* param_resolver_;
+  std::atomic<int> num_complete_instance_calls_{0};
 };
 
 class FakeCache : public TestWorkerCache {
@@ -318,6 +326,10 @@ TEST_F(DeviceResDistTest, Workers4Devices3) {
   DefineCollectiveParams(num_workers, num_devices);
   IssueRequests(num_workers, num_devices);
   ValidateCollectiveParams(num_workers, num_devices);
+  // Reduction instances are resolved without asking the group leader.
+  for (FakeWorker* w : workers_) {
+    EXPECT_EQ(0, w->num_complete_instance_calls());
+  }
 }
 
 }  // namespace
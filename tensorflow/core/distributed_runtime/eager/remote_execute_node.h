@@ -48,6 +48,20 @@ class RemoteExecuteNode : public tensorflow::EagerNode {
     return status;
   }
 
+  // Remote ops and decrefs queued back to back for the same remote context
+  // are sent in one request, so that they cost one round trip.
+  bool TryMerge(tensorflow::EagerNode* node) override {
+    auto* other = dynamic_cast<RemoteExecuteNode*>(node);
+    if (other == nullptr || other->eager_client_ != eager_client_ ||
+        other->request_.context_id() != request_.context_id()) {
+      return false;
+    }
+    for (auto& item : *other->request_.mutable_queue()) {
+      request_.add_queue()->Swap(&item);
+    }
+    return true;
+  }
+
  private:
   EnqueueRequest request_;
   tensorflow::eager::EagerClient*
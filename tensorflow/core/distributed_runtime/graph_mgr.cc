@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -267,6 +268,9 @@ Status GraphMgr::InitItem(const string& session, const GraphDef& gdef,
         EnsureMemoryTypes(DeviceType(unit->device->device_type()),
                           unit->device->name(), subgraph.get()));
     unit->graph = subgraph.get();
+    for (const Node* n : unit->graph->op_nodes()) {
+      if (n->IsCollective()) item->has_collectives = true;
+    }
     unit->build_cost_model = graph_options.build_cost_model();
     if (unit->build_cost_model > 0) {
       skip_cost_models_ = false;
@@ -456,14 +460,23 @@ void GraphMgr::StartParallelExecutors(const string& handle, int64 step_id,
   ScopedStepContainer* step_container = new ScopedStepContainer(
       step_id,
       [this](const string& name) { device_mgr_->ClearContainers({name}); });
+  // Collective ops of different workers meet in the executors of the same
+  // master step_id.
+  CollectiveExecutor::Handle* ce_handle =
+      item->has_collectives && worker_env_->collective_executor_mgr
+          ? new CollectiveExecutor::Handle(
+                worker_env_->collective_executor_mgr->FindOrCreate(step_id),
+                true /*inherit_ref*/)
+          : nullptr;
   // NOTE: Transfer one ref of rendezvous and item.
   ExecutorBarrier* barrier =
       new ExecutorBarrier(num_units, rendezvous,
                           [this, item, collector, cost_graph, step_container,
-                           done](const Status& s) {
+                           ce_handle, done](const Status& s) {
                             BuildCostModel(item, collector, cost_graph);
                             done(s);
                             delete step_container;
+                            delete ce_handle;
                           });
   Executor::Args args;
   {
@@ -475,6 +488,7 @@ void GraphMgr::StartParallelExecutors(const string& handle, int64 step_id,
   args.stats_collector = collector;
   args.step_container = step_container;
   args.sync_on_finish = sync_on_finish_;
+  args.collective_executor = ce_handle ? ce_handle->get() : nullptr;
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(args.step_id, handle);
   }
@@ -135,6 +135,10 @@ class GraphMgr {
     // has a root executor which may call into the runtime library.
     std::vector<ExecutionUnit> units;
 
+    // True if any partition runs collective ops, which then need the
+    // CollectiveExecutor of the step.
+    bool has_collectives = false;
+
     // Used to deregister a cost model when cost model is required in graph
     // manager.
     GraphMgr* graph_mgr;
@@ -52,6 +52,8 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/chrome_trace.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -80,6 +82,12 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
 
     stats_publisher_ = stats_publisher_factory(handle, bopts, session_opts);
 
+    if (!is_partial_) {
+      Status s = ReadBoolFromEnvVar("TF_MASTER_DEFER_STEP_CLEANUP", false,
+                                    &defer_cleanup_);
+      if (!s.ok()) LOG(WARNING) << s;
+    }
+
     // Initialize a name to node map for processing device stats.
     for (Node* n : client_graph_->graph.nodes()) {
       name_to_node_.insert({n->name(), n});
@@ -201,6 +209,16 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // `done` when all cleanup RPCs have completed.
   void CleanupPartitionsAsync(int64 step_id, StatusCallback done);
 
+  // Defers the cleanup of the successful step "step_id" to the next step
+  // of this graph, whose RunGraph calls ask the workers to clean it up,
+  // which saves a round of CleanupGraph calls per step. Returns false if
+  // cleanups are not deferred for this graph.
+  bool DeferCleanup(int64 step_id);
+
+  // Calls workers to cleanup states for the steps whose cleanup was
+  // deferred, and waits for all cleanup RPCs to complete.
+  void FlushDeferredCleanups();
+
   // Post-processing of any runtime statistics gathered during execution.
   void ProcessStats(int64 step_id, PerStepState* pss, ProfileHandler* ph,
                     const RunOptions& options, RunMetadata* resp);
@@ -234,6 +252,8 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   std::unordered_map<StringPiece, Node*, StringPieceHasher> name_to_node_;
   const bool should_deregister_;
   std::atomic<int64> execution_count_ = {0};
+  // Set from TF_MASTER_DEFER_STEP_CLEANUP, for graphs of full runs.
+  bool defer_cleanup_ = false;
 
   // Graph partitioned into per-location subgraphs.
   struct Part {
@@ -272,6 +292,9 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // init_result_ remembers the initialization error if any.
   Status init_result_ GUARDED_BY(mu_);
 
+  // The steps whose cleanup is sent with the next step.
+  std::vector<int64> deferred_cleanup_step_ids_ GUARDED_BY(mu_);
+
   std::unique_ptr<StatsPublisherInterface> stats_publisher_;
 
   // Send/Recv nodes that are the result of client-added
@@ -584,6 +607,12 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     pss->step_stats.resize(partitions_.size());
   }
 
+  std::vector<int64> cleanup_step_ids;
+  if (defer_cleanup_) {
+    mutex_lock l(mu_);
+    cleanup_step_ids.swap(deferred_cleanup_step_ids_);
+  }
+
   const int num = partitions_.size();
   RunManyGraphs calls(num);
 
@@ -602,6 +631,9 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     c->req->set_step_id(step_id);
     *c->req->mutable_exec_opts() = exec_opts;
     c->req->set_store_errors_in_response_body(true);
+    for (int64 cleanup_step_id : cleanup_step_ids) {
+      c->req->add_cleanup_step_id(cleanup_step_id);
+    }
     // If any feeds are provided, send the feed values together
     // in the RunGraph request.
     // In the partial case, we only want to include feeds provided in the req.
@@ -849,6 +881,32 @@ void MasterSession::ReffedClientGraph::CleanupPartitionsAsync(
   }
 }
 
+bool MasterSession::ReffedClientGraph::DeferCleanup(int64 step_id) {
+  if (!defer_cleanup_) return false;
+  mutex_lock l(mu_);
+  deferred_cleanup_step_ids_.push_back(step_id);
+  return true;
+}
+
+void MasterSession::ReffedClientGraph::FlushDeferredCleanups() {
+  std::vector<int64> step_ids;
+  {
+    mutex_lock l(mu_);
+    step_ids.swap(deferred_cleanup_step_ids_);
+  }
+  if (step_ids.empty()) return;
+  BlockingCounter all_done(step_ids.size());
+  for (int64 step_id : step_ids) {
+    CleanupPartitionsAsync(step_id, [&all_done](const Status& s) {
+      if (!s.ok()) {
+        LOG(ERROR) << "Cleanup partition error: " << s;
+      }
+      all_done.DecrementCount();
+    });
+  }
+  all_done.Wait();
+}
+
 void MasterSession::ReffedClientGraph::ProcessStats(int64 step_id,
                                                     PerStepState* pss,
                                                     ProfileHandler* ph,
@@ -886,6 +944,8 @@ void MasterSession::ReffedClientGraph::ProcessStats(int64 step_id,
       pss->step_stats[i].Clear();
     }
     pss->step_stats.clear();
+    Status s = MaybeWriteChromeTrace(Env::Default(), step_stats_proto, step_id);
+    if (!s.ok()) LOG(WARNING) << "Failed to write chrome trace: " << s;
     // Copy the stats back, but only for on-demand profiling to avoid slowing
     // down calls that trigger the automatic profiling.
     if (options.trace_level() == RunOptions::FULL_TRACE) {
@@ -1760,6 +1820,10 @@ Status MasterSession::PostRunCleanup(MasterSession::ReffedClientGraph* rcg,
       }
     }
   }
+  if (s.ok() && rcg->DeferCleanup(step_id)) {
+    MarkRunCompletion();
+    return s;
+  }
   Ref();
   rcg->Ref();
   rcg->CleanupPartitionsAsync(step_id, [this, rcg](const Status& s) {
@@ -1926,6 +1990,7 @@ Status MasterSession::ReleaseCallable(const ReleaseCallableRequest& req,
     }
   }
   if (to_unref != nullptr) {
+    to_unref->FlushDeferredCleanups();
     to_unref->Unref();
   }
   return Status::OK();
@@ -1947,7 +2012,10 @@ Status MasterSession::Close() {
     ClearRunsTable(&to_unref, &partial_run_graphs_);
     ClearRunsTable(&to_unref, &callables_);
   }
-  for (ReffedClientGraph* rcg : to_unref) rcg->Unref();
+  for (ReffedClientGraph* rcg : to_unref) {
+    rcg->FlushDeferredCleanups();
+    rcg->Unref();
+  }
   if (should_delete_worker_sessions_) {
     Status s = DeleteWorkerSessions();
     if (!s.ok()) {
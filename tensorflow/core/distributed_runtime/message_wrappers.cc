@@ -382,6 +382,18 @@ void InMemoryRunGraphRequest::set_store_errors_in_response_body(
   store_errors_in_response_body_ = store_errors;
 }
 
+size_t InMemoryRunGraphRequest::num_cleanup_step_ids() const {
+  return cleanup_step_ids_.size();
+}
+
+int64 InMemoryRunGraphRequest::cleanup_step_id(size_t i) const {
+  return cleanup_step_ids_[i];
+}
+
+void InMemoryRunGraphRequest::add_cleanup_step_id(int64 step_id) {
+  cleanup_step_ids_.push_back(step_id);
+}
+
 const RunGraphRequest& InMemoryRunGraphRequest::ToProto() const {
   if (!proto_version_) {
     proto_version_.reset(new RunGraphRequest);
@@ -401,6 +413,9 @@ const RunGraphRequest& InMemoryRunGraphRequest::ToProto() const {
     }
     proto_version_->set_is_partial(is_partial());
     proto_version_->set_is_last_partial_run(is_last_partial_run());
+    for (size_t i = 0; i < num_cleanup_step_ids(); ++i) {
+      proto_version_->add_cleanup_step_id(cleanup_step_id(i));
+    }
   }
   return *proto_version_;
 }
@@ -522,6 +537,18 @@ void MutableProtoRunGraphRequest::set_store_errors_in_response_body(
   request_.set_store_errors_in_response_body(store_errors);
 }
 
+size_t MutableProtoRunGraphRequest::num_cleanup_step_ids() const {
+  return request_.cleanup_step_id_size();
+}
+
+int64 MutableProtoRunGraphRequest::cleanup_step_id(size_t i) const {
+  return request_.cleanup_step_id(i);
+}
+
+void MutableProtoRunGraphRequest::add_cleanup_step_id(int64 step_id) {
+  request_.add_cleanup_step_id(step_id);
+}
+
 const RunGraphRequest& MutableProtoRunGraphRequest::ToProto() const {
   return request_;
 }
@@ -579,6 +606,14 @@ bool ProtoRunGraphRequest::store_errors_in_response_body() const {
   return request_->store_errors_in_response_body();
 }
 
+size_t ProtoRunGraphRequest::num_cleanup_step_ids() const {
+  return request_->cleanup_step_id_size();
+}
+
+int64 ProtoRunGraphRequest::cleanup_step_id(size_t i) const {
+  return request_->cleanup_step_id(i);
+}
+
 const RunGraphRequest& ProtoRunGraphRequest::ToProto() const {
   return *request_;
 }
@@ -136,6 +136,7 @@ class InMemoryRunStepRequest : public MutableRunStepRequestWrapper {
   void add_target(const string& name) override;
   RunOptions* mutable_options() override;
   void set_store_errors_in_response_body(bool store_errors) override;
+  void add_cleanup_step_id(int64 step_id) override;
 
  private:
   string session_handle_;
@@ -286,6 +287,10 @@ class RunGraphRequestWrapper {
   // truncate long metadata messages.
   virtual bool store_errors_in_response_body() const = 0;
 
+  // Steps whose state the worker cleans up before running this step.
+  virtual size_t num_cleanup_step_ids() const = 0;
+  virtual int64 cleanup_step_id(size_t i) const = 0;
+
   // Returns the wrapped data as a protocol buffer message.
   virtual const RunGraphRequest& ToProto() const = 0;
 };
@@ -314,6 +319,7 @@ class MutableRunGraphRequestWrapper : public RunGraphRequestWrapper {
   virtual void set_is_partial(bool is_partial) = 0;
   virtual void set_is_last_partial_run(bool is_last_partial_run) = 0;
   virtual void set_store_errors_in_response_body(bool store_errors) = 0;
+  virtual void add_cleanup_step_id(int64 step_id) = 0;
 };
 
 class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
@@ -333,6 +339,8 @@ class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
   bool is_last_partial_run() const override;
   const RunGraphRequest& ToProto() const override;
   bool store_errors_in_response_body() const override;
+  size_t num_cleanup_step_ids() const override;
+  int64 cleanup_step_id(size_t i) const override;
 
   // MutableRunGraphRequestWrapper methods.
   void set_session_handle(const string& handle) override;
@@ -362,6 +370,7 @@ class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
   bool is_partial_ = false;
   bool is_last_partial_run_ = false;
   bool store_errors_in_response_body_ = false;
+  gtl::InlinedVector<int64, 4> cleanup_step_ids_;
 
   // Holds a cached and owned representation of the proto
   // representation of this request, if needed, so that `ToProto()`
@@ -389,6 +398,8 @@ class MutableProtoRunGraphRequest : public MutableRunGraphRequestWrapper {
   bool is_partial() const override;
   bool is_last_partial_run() const override;
   bool store_errors_in_response_body() const override;
+  size_t num_cleanup_step_ids() const override;
+  int64 cleanup_step_id(size_t i) const override;
   const RunGraphRequest& ToProto() const override;
 
   // MutableRunGraphRequestWrapper methods.
@@ -407,6 +418,7 @@ class MutableProtoRunGraphRequest : public MutableRunGraphRequestWrapper {
   void set_is_partial(bool is_partial) override;
   void set_is_last_partial_run(bool is_last_partial_run) override;
   void set_store_errors_in_response_body(bool store_errors) override;
+  void add_cleanup_step_id(int64 step_id) override;
 
  private:
   RunGraphRequest request_;
@@ -430,6 +442,8 @@ class ProtoRunGraphRequest : public RunGraphRequestWrapper {
   bool is_partial() const override;
   bool is_last_partial_run() const override;
   bool store_errors_in_response_body() const override;
+  size_t num_cleanup_step_ids() const override;
+  int64 cleanup_step_id(size_t i) const override;
   const RunGraphRequest& ToProto() const override;
 
  private:
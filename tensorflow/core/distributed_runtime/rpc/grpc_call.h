@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
 
+#include <deque>
+#include <vector>
+
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -70,6 +73,13 @@ namespace tensorflow {
 //
 // 4. When the response has been sent, the tag is returned from
 //    `cq_->Next()`, and the call object is deleted.
+//
+// * `ServerStreamingCall<Service, GrpcService, Req, Resp>` is the
+//   analogue of `Call` for methods that return a stream of messages.
+//   The handler queues messages with `Write()`, possibly from several
+//   threads, and ends the stream with `Finish()`; `SendResponses()`
+//   does both at once. Messages are written one at a time, each write
+//   being started by the completion of the previous one.
 
 // Represents a pending request with unknown message types.
 template <class Service>
@@ -95,13 +105,22 @@ class UntypedCall : public core::RefCounted {
   // the `grpc::ServerContext` associated with the request.
   virtual void RequestCancelled(Service* service, bool ok) = 0;
 
+  // Streaming calls only: called when one of several response messages has
+  // been written. `ok` is false if the stream is broken.
+  virtual void ResponseWritten(Service* service, bool ok) {}
+
   // Associates a tag in a `::grpc::CompletionQueue` with a callback
   // for an incoming RPC.  An active Tag owns a reference on the corresponding
   // Call object.
   class Tag {
    public:
     // One enum value per supported callback.
-    enum Callback { kRequestReceived, kResponseSent, kCancelled };
+    enum Callback {
+      kRequestReceived,
+      kResponseWritten,
+      kResponseSent,
+      kCancelled
+    };
 
     Tag(UntypedCall* call, Callback cb) : call_(call), callback_(cb) {}
 
@@ -113,6 +132,9 @@ class UntypedCall : public core::RefCounted {
         case kRequestReceived:
           call_->RequestReceived(service, ok);
           break;
+        case kResponseWritten:
+          call_->ResponseWritten(service, ok);
+          break;
         case kResponseSent:
           // No special handling needed apart from the Unref below.
           break;
@@ -263,6 +285,197 @@ class Call : public UntypedCall<Service> {
   std::function<void()> cancel_callback_ GUARDED_BY(mu_);
 };
 
+// Represents a pending server-streaming call with known request and
+// response message types, and a known request-handling method.
+template <class Service, class GrpcService, class RequestMessage,
+          class ResponseMessage>
+class ServerStreamingCall : public UntypedCall<Service> {
+ public:
+  // Represents the generic signature of a `Service::HandleFoo()`
+  // method, where `Foo` is the name of an RPC method.
+  using HandleRequestFunction = void (Service::*)(
+      ServerStreamingCall<Service, GrpcService, RequestMessage,
+                          ResponseMessage>*);
+
+  ServerStreamingCall(HandleRequestFunction handle_request_function)
+      : handle_request_function_(handle_request_function), writer_(&ctx_) {}
+
+  virtual ~ServerStreamingCall() {}
+
+  void RequestReceived(Service* service, bool ok) override {
+    if (ok) {
+      this->Ref();
+      (service->*handle_request_function_)(this);
+    }
+  }
+
+  // Queues `response` to be written to the client after the previously
+  // queued ones. Must not be called after Finish().
+  void Write(ResponseMessage response) {
+    mutex_lock l(write_mu_);
+    DCHECK(!finish_requested_);
+    if (finished_) return;  // The stream is broken.
+    pending_responses_.push_back(std::move(response));
+    MaybeStartWriteLocked();
+  }
+
+  // Finishes the call with `status` once the queued responses have been
+  // written. If `status` is not OK, the responses that were not written yet
+  // are dropped.
+  //
+  // Releases the reference that was transferred to the handler.
+  void Finish(::grpc::Status status) {
+    {
+      mutex_lock l(write_mu_);
+      finish_requested_ = true;
+      status_ = std::move(status);
+      if (!status_.ok()) {
+        pending_responses_.clear();
+      }
+      MaybeStartWriteLocked();
+    }
+    this->Unref();
+  }
+
+  // Writes `responses` to the client in order, and then finishes the call
+  // with `status`. If `status` is not OK, no responses are written.
+  //
+  // Releases the reference that was transferred to the handler.
+  void SendResponses(std::vector<ResponseMessage> responses,
+                     ::grpc::Status status) {
+    if (status.ok()) {
+      mutex_lock l(write_mu_);
+      for (ResponseMessage& response : responses) {
+        pending_responses_.push_back(std::move(response));
+      }
+    }
+    Finish(std::move(status));
+  }
+
+  void ResponseWritten(Service* service, bool ok) override {
+    mutex_lock l(write_mu_);
+    // Drop the written message, which may pin a large buffer.
+    written_response_ = ResponseMessage();
+    write_in_flight_ = false;
+    if (!ok) {
+      stream_broken_ = true;
+    }
+    MaybeStartWriteLocked();
+  }
+
+  void RequestCancelled(Service* service, bool ok) override {
+    if (ctx_.IsCancelled()) {
+      mutex_lock l(mu_);
+      if (cancel_callback_) {
+        cancel_callback_();
+      }
+    }
+  }
+
+  // Registers `callback` as the function that should be called if and when this
+  // call is canceled by the client.
+  void SetCancelCallback(std::function<void()> callback) {
+    mutex_lock l(mu_);
+    cancel_callback_ = std::move(callback);
+  }
+
+  // Clears any cancellation callback that has been registered for this call.
+  void ClearCancelCallback() {
+    mutex_lock l(mu_);
+    cancel_callback_ = nullptr;
+  }
+
+  // Enqueues a new request for the given service on the given
+  // completion queue, using the given `method_id`.
+  //
+  // The request will be handled with the given
+  // `handle_request_function`.
+  static void EnqueueRequestForMethod(
+      GrpcService* grpc_service, ::grpc::ServerCompletionQueue* cq,
+      int method_id, HandleRequestFunction handle_request_function,
+      bool supports_cancel) {
+    auto call = new ServerStreamingCall<Service, GrpcService, RequestMessage,
+                                        ResponseMessage>(
+        handle_request_function);
+    if (supports_cancel) {
+      call->RegisterCancellationHandler();
+    }
+
+    // Initial ref for call handed to grpc; released in Tag callback.
+    grpc_service->RequestAsyncServerStreaming(
+        method_id, &call->ctx_, &call->request, &call->writer_, cq, cq,
+        &call->request_received_tag_);
+  }
+
+  RequestMessage request;
+
+  const std::multimap<::grpc::string_ref, ::grpc::string_ref>& client_metadata()
+      const {
+    return ctx_.client_metadata();
+  }
+
+ private:
+  // Unless a write is in flight, starts writing the next queued response,
+  // or finishes the call if Finish() was called and nothing is left to
+  // write. A broken stream is finished right away.
+  void MaybeStartWriteLocked() EXCLUSIVE_LOCKS_REQUIRED(write_mu_) {
+    if (write_in_flight_ || finished_) return;
+    if (stream_broken_) {
+      pending_responses_.clear();
+      if (!finish_requested_ || status_.ok()) {
+        status_ = ::grpc::Status(::grpc::StatusCode::CANCELLED,
+                                 "Failed to write a streaming response");
+      }
+    } else if (!pending_responses_.empty()) {
+      written_response_ = std::move(pending_responses_.front());
+      pending_responses_.pop_front();
+      write_in_flight_ = true;
+      this->Ref();  // Ref for grpc; released in Tag callback.
+      writer_.Write(written_response_, &response_written_tag_);
+      return;
+    } else if (!finish_requested_) {
+      return;
+    }
+    finished_ = true;
+    this->Ref();  // Ref for grpc; released in Tag callback.
+    writer_.Finish(status_, &response_sent_tag_);
+  }
+
+  // Creates a completion queue tag for handling cancellation by the client.
+  // NOTE: This method must be called before this call is enqueued on a
+  // completion queue.
+  void RegisterCancellationHandler() {
+    this->Ref();  // Ref for grpc; released in Tag callback.
+    ctx_.AsyncNotifyWhenDone(&cancelled_tag_);
+  }
+
+  HandleRequestFunction handle_request_function_;
+  ::grpc::ServerContext ctx_;
+  ::grpc::ServerAsyncWriter<ResponseMessage> writer_;
+
+  mutex write_mu_;
+  std::deque<ResponseMessage> pending_responses_ GUARDED_BY(write_mu_);
+  // The message being written, which grpc requires to stay alive until the
+  // write completes.
+  ResponseMessage written_response_ GUARDED_BY(write_mu_);
+  bool write_in_flight_ GUARDED_BY(write_mu_) = false;
+  bool finish_requested_ GUARDED_BY(write_mu_) = false;
+  bool finished_ GUARDED_BY(write_mu_) = false;
+  bool stream_broken_ GUARDED_BY(write_mu_) = false;
+  ::grpc::Status status_ GUARDED_BY(write_mu_);
+
+  // Used as void* completion markers from grpc to indicate different
+  // events of interest for a ServerStreamingCall.
+  typedef typename UntypedCall<Service>::Tag Tag;
+  Tag request_received_tag_{this, Tag::kRequestReceived};
+  Tag response_written_tag_{this, Tag::kResponseWritten};
+  Tag response_sent_tag_{this, Tag::kResponseSent};
+  Tag cancelled_tag_{this, Tag::kCancelled};
+
+  mutex mu_;
+  std::function<void()> cancel_callback_ GUARDED_BY(mu_);
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CALL_H_
@@ -0,0 +1,315 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <deque>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_cache.h"
+#include "tensorflow/core/distributed_runtime/worker_cache.h"
+#include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/dataset.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The name of the server in the worker cache of each dataset.
+const char kRemoteJob[] = "remote_iterator";
+const char kRemoteTask[] = "/job:remote_iterator/replica:0/task:0";
+
+// See documentation in ../../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class RemoteIteratorDatasetOp : public DatasetOpKernel {
+ public:
+  explicit RemoteIteratorDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    string address;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "address", &address));
+
+    string device;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "device", &device));
+
+    string shared_name;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<string>(ctx, "shared_name", &shared_name));
+
+    int64 elements_per_request;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "elements_per_request",
+                                                   &elements_per_request));
+    OP_REQUIRES(
+        ctx, elements_per_request > 0,
+        errors::InvalidArgument("elements_per_request must be positive."));
+
+    int64 max_outstanding_requests;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "max_outstanding_requests",
+                                              &max_outstanding_requests));
+    OP_REQUIRES(
+        ctx, max_outstanding_requests > 0,
+        errors::InvalidArgument("max_outstanding_requests must be positive."));
+
+    GrpcChannelSpec channel_spec;
+    OP_REQUIRES_OK(ctx, channel_spec.AddHostPortsJob(
+                            kRemoteJob, std::vector<string>({address})));
+    std::shared_ptr<GrpcChannelCache> channel_cache(
+        NewGrpcChannelCache(channel_spec, ConvertToChannelCreationFunction(
+                                              NewHostPortGrpcChannel)));
+    std::unique_ptr<WorkerCacheInterface> worker_cache(
+        NewGrpcWorkerCache(channel_cache));
+    WorkerInterface* worker = worker_cache->CreateWorker(kRemoteTask);
+    OP_REQUIRES(ctx, worker != nullptr,
+                errors::InvalidArgument("Invalid server address: ", address));
+
+    *output = new Dataset(ctx, address, device, shared_name,
+                          elements_per_request, max_outstanding_requests,
+                          std::move(worker_cache), worker, output_types_,
+                          output_shapes_);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const string& address, const string& device,
+            const string& shared_name, int64 elements_per_request,
+            int64 max_outstanding_requests,
+            std::unique_ptr<WorkerCacheInterface> worker_cache,
+            WorkerInterface* worker, const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : GraphDatasetBase(ctx),
+          address_(address),
+          device_(device),
+          shared_name_(shared_name),
+          elements_per_request_(elements_per_request),
+          max_outstanding_requests_(max_outstanding_requests),
+          output_types_(output_types),
+          output_shapes_(output_shapes),
+          worker_cache_(std::move(worker_cache)),
+          worker_(worker) {}
+
+    ~Dataset() override {
+      // The iterators, which hold references to the dataset, have waited for
+      // their RPCs.
+      worker_cache_->ReleaseWorker(kRemoteTask, worker_);
+    }
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::RemoteIterator")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override {
+      return strings::StrCat("RemoteIteratorDatasetOp(", address_, ", ",
+                             shared_name_, ")::Dataset");
+    }
+
+   protected:
+    Status AsGraphDefInternal(DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* address = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(address_, &address));
+      Node* device = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(device_, &device));
+      Node* shared_name = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(shared_name_, &shared_name));
+      Node* elements_per_request = nullptr;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(elements_per_request_, &elements_per_request));
+      Node* max_outstanding_requests = nullptr;
+      TF_RETURN_IF_ERROR(
+          b->AddScalar(max_outstanding_requests_, &max_outstanding_requests));
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {address, device, shared_name, elements_per_request,
+           max_outstanding_requests},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    // Keeps up to `max_outstanding_requests` GetDatasetElements RPCs in
+    // flight, and no more than `elements_per_request *
+    // max_outstanding_requests` elements buffered or requested: a request is
+    // only sent when there is room in the buffer for all of its elements, so
+    // a slow consumer throttles the server.
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      ~Iterator() override {
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        for (const auto& call : calls_) {
+          call->opts.StartCancel();
+        }
+        while (!calls_.empty()) {
+          cond_var_.wait(l);
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        while (true) {
+          if (!buffer_.empty()) {
+            *out_tensors = std::move(buffer_.front());
+            buffer_.pop_front();
+            *end_of_sequence = false;
+            SendRequestsLocked();
+            return Status::OK();
+          }
+          // Errors are returned once, after the elements that preceded them,
+          // as for a local iterator.
+          if (!status_.ok()) {
+            Status s = status_;
+            status_ = Status::OK();
+            return s;
+          }
+          if (end_of_sequence_ && calls_.empty()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          SendRequestsLocked();
+          cond_var_.wait(l);
+        }
+      }
+
+     private:
+      struct Call {
+        CallOptions opts;
+        GetDatasetElementsRequest request;
+        GetDatasetElementsResponse response;
+      };
+
+      // The callbacks of the RPCs run on the polling threads of the worker
+      // cache, so requests can be sent with `mu_` held.
+      void SendRequestsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 elements_per_request = dataset()->elements_per_request_;
+        const int64 capacity =
+            elements_per_request * dataset()->max_outstanding_requests_;
+        while (!end_of_sequence_ && !cancelled_ &&
+               static_cast<int64>(buffer_.size() + calls_.size() *
+                                                       elements_per_request) +
+                       elements_per_request <=
+                   capacity) {
+          calls_.emplace_back(new Call);
+          Call* call = calls_.back().get();
+          call->request.set_device(dataset()->device_);
+          call->request.set_shared_name(dataset()->shared_name_);
+          call->request.set_max_elements(elements_per_request);
+          dataset()->worker_->GetDatasetElementsAsync(
+              &call->opts, &call->request, &call->response,
+              [this, call](const Status& s) { CallDone(call, s); });
+        }
+      }
+
+      void CallDone(Call* call, const Status& s) LOCKS_EXCLUDED(mu_) {
+        mutex_lock l(mu_);
+        if (s.ok()) {
+          AddElementsLocked(call->response);
+        } else if (!cancelled_) {
+          status_.Update(s);
+        }
+        calls_.remove_if([call](const std::unique_ptr<Call>& c) {
+          return c.get() == call;
+        });
+        SendRequestsLocked();
+        cond_var_.notify_all();
+      }
+
+      void AddElementsLocked(const GetDatasetElementsResponse& response)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 num_components = dataset()->output_dtypes().size();
+        if (response.component_size() !=
+            response.num_elements() * num_components) {
+          status_.Update(errors::Internal(
+              "Got ", response.component_size(), " components for ",
+              response.num_elements(), " elements of ", num_components,
+              " components from ", dataset()->address_));
+          return;
+        }
+        for (int64 i = 0; i < response.num_elements(); ++i) {
+          std::vector<Tensor> element(num_components);
+          for (int64 j = 0; j < num_components; ++j) {
+            if (!element[j].FromProto(
+                    response.component(i * num_components + j))) {
+              status_.Update(errors::Internal(
+                  "Could not parse an element from ", dataset()->address_));
+              return;
+            }
+          }
+          buffer_.push_back(std::move(element));
+        }
+        if (response.end_of_sequence()) {
+          end_of_sequence_ = true;
+        }
+        if (response.status_code() != error::OK) {
+          status_.Update(
+              Status(response.status_code(), response.status_error_message()));
+        }
+      }
+
+      mutex mu_;
+      condition_variable cond_var_;
+      std::deque<std::vector<Tensor>> buffer_ GUARDED_BY(mu_);
+      std::list<std::unique_ptr<Call>> calls_ GUARDED_BY(mu_);
+      Status status_ GUARDED_BY(mu_);
+      bool end_of_sequence_ GUARDED_BY(mu_) = false;
+      bool cancelled_ GUARDED_BY(mu_) = false;
+    };
+
+    const string address_;
+    const string device_;
+    const string shared_name_;
+    const int64 elements_per_request_;
+    const int64 max_outstanding_requests_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+    const std::unique_ptr<WorkerCacheInterface> worker_cache_;
+    WorkerInterface* const worker_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("RemoteIteratorDataset").Device(DEVICE_CPU),
+                        RemoteIteratorDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
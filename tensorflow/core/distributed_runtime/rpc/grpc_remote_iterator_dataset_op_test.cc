@@ -0,0 +1,139 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/dataset_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+using test::dataset::AddConst;
+using test::dataset::AddIterator;
+using test::dataset::AddRange;
+
+const int64 kNumElements = 100;
+const char kDevice[] = "/job:localhost/replica:0/task:0/cpu:0";
+
+// A shared iterator over Range(kNumElements) on the server.
+GraphDef SharedRange(const string& shared_name) {
+  GraphDef graph;
+  AddRange("range", 0, kNumElements, &graph);
+  AddIterator("range", {DT_INT64}, {PartialTensorShape({})}, shared_name,
+              &graph);
+  for (NodeDef& node : *graph.mutable_node()) {
+    node.set_device(kDevice);
+  }
+  return graph;
+}
+
+// A local iterator over the shared iterator of the server at "address".
+GraphDef RemoteRange(const string& address, const string& shared_name) {
+  GraphDef graph;
+  AddConst("address", test::AsScalar<string>(address), &graph);
+  AddConst("device", test::AsScalar<string>(kDevice), &graph);
+  AddConst("shared_name", test::AsScalar<string>(shared_name), &graph);
+  AddConst("elements_per_request", test::AsScalar<int64>(3), &graph);
+  AddConst("max_outstanding_requests", test::AsScalar<int64>(2), &graph);
+  TF_CHECK_OK(NodeDefBuilder("remote", "RemoteIteratorDataset")
+                  .Input("address", 0, DT_STRING)
+                  .Input("device", 0, DT_STRING)
+                  .Input("shared_name", 0, DT_STRING)
+                  .Input("elements_per_request", 0, DT_INT64)
+                  .Input("max_outstanding_requests", 0, DT_INT64)
+                  .Attr("output_types", DataTypeVector({DT_INT64}))
+                  .Attr("output_shapes", {PartialTensorShape({})})
+                  .Finalize(graph.add_node()));
+  AddIterator("remote", {DT_INT64}, {PartialTensorShape({})}, "", &graph);
+  return graph;
+}
+
+TEST(RemoteIteratorDatasetOpTest, ConsumersShareTheElements) {
+  std::unique_ptr<test::TestCluster> cluster;
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 1;
+  TF_ASSERT_OK(test::TestCluster::MakeTestCluster(options, 1, &cluster));
+  const string address = cluster->targets()[0];
+
+  SessionOptions server_options;
+  server_options.target = strings::StrCat("grpc://", address);
+  std::unique_ptr<Session> server_session(NewSession(server_options));
+  TF_ASSERT_OK(server_session->Create(SharedRange("shared_range")));
+  TF_ASSERT_OK(server_session->Run({}, {}, {"make_iterator"}, nullptr));
+
+  // Two consumers get the elements of the shared iterator in turn.
+  std::vector<std::unique_ptr<Session>> consumers;
+  for (int i = 0; i < 2; ++i) {
+    consumers.emplace_back(NewSession(SessionOptions()));
+    TF_ASSERT_OK(consumers[i]->Create(RemoteRange(address, "shared_range")));
+    TF_ASSERT_OK(consumers[i]->Run({}, {}, {"make_iterator"}, nullptr));
+  }
+  std::vector<int64> elements;
+  std::vector<bool> done(consumers.size(), false);
+  while (std::count(done.begin(), done.end(), false) > 0) {
+    for (size_t i = 0; i < consumers.size(); ++i) {
+      if (done[i]) continue;
+      std::vector<Tensor> outputs;
+      Status s = consumers[i]->Run({}, {"get_next:0"}, {}, &outputs);
+      if (errors::IsOutOfRange(s)) {
+        done[i] = true;
+        continue;
+      }
+      TF_ASSERT_OK(s);
+      elements.push_back(outputs[0].scalar<int64>()());
+    }
+  }
+  for (auto& consumer : consumers) {
+    TF_ASSERT_OK(consumer->Close());
+  }
+  TF_ASSERT_OK(server_session->Close());
+
+  // Each element went to a single consumer.
+  std::sort(elements.begin(), elements.end());
+  ASSERT_EQ(kNumElements, static_cast<int64>(elements.size()));
+  for (int64 i = 0; i < kNumElements; ++i) {
+    EXPECT_EQ(i, elements[i]);
+  }
+}
+
+TEST(RemoteIteratorDatasetOpTest, MissingIterator) {
+  std::unique_ptr<test::TestCluster> cluster;
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 1;
+  TF_ASSERT_OK(test::TestCluster::MakeTestCluster(options, 1, &cluster));
+
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_ASSERT_OK(
+      session->Create(RemoteRange(cluster->targets()[0], "no_such_iterator")));
+  TF_ASSERT_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  std::vector<Tensor> outputs;
+  EXPECT_TRUE(
+      errors::IsNotFound(session->Run({}, {"get_next:0"}, {}, &outputs)));
+}
+
+}  // namespace
+}  // namespace tensorflow
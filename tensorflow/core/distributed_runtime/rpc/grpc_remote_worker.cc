@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -54,12 +55,15 @@ class GrpcRemoteWorker : public WorkerInterface {
         cleanupgraph_(Method(GrpcWorkerMethod::kCleanupGraph)),
         cleanupall_(Method(GrpcWorkerMethod::kCleanupAll)),
         recvtensor_(Method(GrpcWorkerMethod::kRecvTensor)),
+        recvtensorstream_(Method(GrpcWorkerMethod::kRecvTensorStream)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
         recvbuf_(Method(GrpcWorkerMethod::kRecvBuf)),
         logging_(Method(GrpcWorkerMethod::kLogging)),
         tracing_(Method(GrpcWorkerMethod::kTracing)),
         completegroup_(Method(GrpcWorkerMethod::kCompleteGroup)),
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
+        getdatasetelements_(Method(GrpcWorkerMethod::kGetDatasetElements)),
         logger_(logger) {}
 
   ~GrpcRemoteWorker() override {}
@@ -145,6 +149,14 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, getstepsequence_, std::move(done));
   }
 
+  void GetDatasetElementsAsync(CallOptions* call_opts,
+                               const GetDatasetElementsRequest* request,
+                               GetDatasetElementsResponse* response,
+                               StatusCallback done) override {
+    IssueRequest(request, response, getdatasetelements_, std::move(done),
+                 call_opts);
+  }
+
   void RecvTensorAsync(CallOptions* call_opts, const RecvTensorRequest* request,
                        TensorResponse* response, StatusCallback done) override {
     VLOG(1) << "RecvTensorAsync req: " << request->DebugString();
@@ -200,7 +212,23 @@ class GrpcRemoteWorker : public WorkerInterface {
       cb_to_use = &wrapper_done;
     }
 
-    IssueRequest(request, response, recvtensor_, *cb_to_use, call_opts);
+    if (UseRecvTensorStream() && response->on_host()) {
+      new RecvTensorStreamState(&stub_, cq_, recvtensorstream_, *request,
+                                response, *cb_to_use, call_opts);
+    } else {
+      IssueRequest(request, response, recvtensor_, *cb_to_use, call_opts);
+    }
+  }
+
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            std::vector<TensorResponse*>* responses,
+                            std::function<void(int, const Status&)> received,
+                            StatusCallback done) override {
+    VLOG(1) << "RecvTensorBatchAsync req: " << request->DebugString();
+    new RecvTensorBatchState(&stub_, cq_, recvtensorbatch_, *request,
+                             responses, std::move(received), std::move(done),
+                             call_opts);
   }
 
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
@@ -229,6 +257,22 @@ class GrpcRemoteWorker : public WorkerInterface {
                                  std::move(done), call_opts);
   }
 
+  // Returns true if RecvTensor should use the streaming RecvTensorStream
+  // method, which all workers of the cluster must support. Controlled by
+  // TF_GRPC_RECV_TENSOR_STREAM, off by default.
+  static bool UseRecvTensorStream() {
+    static const bool use_stream = []() {
+      bool value;
+      Status status =
+          ReadBoolFromEnvVar("TF_GRPC_RECV_TENSOR_STREAM", false, &value);
+      if (!status.ok()) {
+        LOG(ERROR) << status.error_message();
+      }
+      return value;
+    }();
+    return use_stream;
+  }
+
   // Helper function for initializing the RpcMethod objects below.
   const char* Method(GrpcWorkerMethod id) { return GrpcWorkerMethodName(id); }
 
@@ -245,12 +289,15 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string cleanupgraph_;
   const ::grpc::string cleanupall_;
   const ::grpc::string recvtensor_;
+  const ::grpc::string recvtensorstream_;
+  const ::grpc::string recvtensorbatch_;
   const ::grpc::string recvbuf_;
   const ::grpc::string logging_;
   const ::grpc::string tracing_;
   const ::grpc::string completegroup_;
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
+  const ::grpc::string getdatasetelements_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_STATE_H_
 
 #include <utility>
+#include <vector>
 
 #include "grpc++/generic/generic_stub.h"
 #include "grpc++/grpc++.h"
@@ -98,6 +99,246 @@ class RPCState : public GrpcClientCQTag {
   StatusCallback done_;
 };
 
+// Object allocated per active RecvTensorStream RPC. The messages of the
+// stream (see worker_service.proto) are parsed into `response` as they
+// arrive, so that no more than one chunk of a large tensor is buffered.
+class RecvTensorStreamState : public GrpcClientCQTag {
+ public:
+  RecvTensorStreamState(::grpc::GenericStub* stub, ::grpc::CompletionQueue* cq,
+                        const ::grpc::string& method,
+                        const protobuf::Message& request,
+                        TensorResponse* response, StatusCallback done,
+                        CallOptions* call_opts)
+      : call_opts_(call_opts), response_(response), done_(std::move(done)) {
+    DCHECK(response->on_host());
+    context_.set_fail_fast(false);
+
+    if (call_opts) {
+      call_opts->SetCancelCallback([this]() { context_.TryCancel(); });
+    }
+
+    ::grpc::Status s = GrpcMaybeUnparseProto(request, &request_buf_);
+    if (!s.ok()) {
+      LOG(ERROR) << "GrpcMaybeUnparseProto returned with non-ok status: "
+                 << s.error_message();
+    }
+    call_ = std::move(stub->PrepareCall(&context_, method, cq));
+    call_->StartCall(this);
+  }
+
+  // Called once per completed operation on call_, which are issued one at a
+  // time: StartCall, WriteLast(request), Read()... until the end of the
+  // stream, and Finish.
+  void OnCompleted(bool ok) override {
+    switch (state_) {
+      case State::kStarting:
+        if (!ok) return Finish();
+        state_ = State::kWriting;
+        call_->WriteLast(request_buf_, ::grpc::WriteOptions(), this);
+        return;
+      case State::kWriting:
+        if (!ok) return Finish();
+        state_ = State::kReading;
+        call_->Read(&response_buf_, this);
+        return;
+      case State::kReading:
+        // Not ok at the end of the stream; Finish() reports why.
+        if (!ok) return Finish();
+        ParseMessage();
+        if (!parse_status_.ok()) {
+          context_.TryCancel();
+          return Finish();
+        }
+        call_->Read(&response_buf_, this);
+        return;
+      case State::kFinishing:
+        Done();
+        return;
+    }
+  }
+
+ private:
+  enum class State { kStarting, kWriting, kReading, kFinishing };
+
+  void ParseMessage() {
+    if (num_messages_++ == 0) {
+      if (!GrpcMaybeParseProto(&response_buf_, response_)) {
+        parse_status_ = errors::Internal("could not parse rpc response");
+      }
+    } else {
+      GrpcByteSource source(&response_buf_);
+      parse_status_ = response_->ParseChunkFrom(&source, &content_bytes_);
+    }
+    response_buf_.Clear();
+  }
+
+  void Finish() {
+    state_ = State::kFinishing;
+    call_->Finish(&status_, this);
+  }
+
+  void Done() {
+    if (call_opts_) {
+      call_opts_->ClearCancelCallback();
+    }
+    Status s = FromGrpcStatus(status_);
+    if (s.ok()) s = parse_status_;
+    if (s.ok() && num_messages_ == 0) {
+      s = errors::Internal("RecvTensorStream returned no response");
+    }
+    if (s.ok() && num_messages_ > 1 &&
+        content_bytes_ != response_->tensor().TotalBytes()) {
+      s = errors::Internal("RecvTensorStream returned ", content_bytes_,
+                           " of ", response_->tensor().TotalBytes(),
+                           " bytes of tensor content");
+    }
+    if (!s.ok()) {
+      VLOG(2) << "Call returned with non-ok status: " << s;
+    }
+    done_(s);
+    delete this;
+  }
+
+  CallOptions* call_opts_;
+  ::grpc::ClientContext context_;
+  std::unique_ptr<::grpc::GenericClientAsyncReaderWriter> call_;
+  TensorResponse* response_;
+  ::grpc::ByteBuffer request_buf_;
+  ::grpc::ByteBuffer response_buf_;
+  ::grpc::Status status_;
+  StatusCallback done_;
+
+  State state_ = State::kStarting;
+  int64 num_messages_ = 0;
+  int64 content_bytes_ = 0;
+  Status parse_status_;
+};
+
+// Object allocated per active RecvTensorBatch RPC. Each message of the
+// stream holds the tensor of one request of the batch, which is handed to
+// `received` right away; see WorkerInterface::RecvTensorBatchAsync().
+class RecvTensorBatchState : public GrpcClientCQTag {
+ public:
+  RecvTensorBatchState(::grpc::GenericStub* stub, ::grpc::CompletionQueue* cq,
+                       const ::grpc::string& method,
+                       const RecvTensorBatchRequest& request,
+                       std::vector<TensorResponse*>* responses,
+                       std::function<void(int, const Status&)> received,
+                       StatusCallback done, CallOptions* call_opts)
+      : call_opts_(call_opts),
+        responses_(responses),
+        received_(std::move(received)),
+        done_(std::move(done)),
+        is_received_(request.request_size(), false) {
+    context_.set_fail_fast(false);
+
+    if (call_opts) {
+      call_opts->SetCancelCallback([this]() { context_.TryCancel(); });
+    }
+
+    ::grpc::Status s = GrpcMaybeUnparseProto(request, &request_buf_);
+    if (!s.ok()) {
+      LOG(ERROR) << "GrpcMaybeUnparseProto returned with non-ok status: "
+                 << s.error_message();
+    }
+    call_ = std::move(stub->PrepareCall(&context_, method, cq));
+    call_->StartCall(this);
+  }
+
+  // Called once per completed operation on call_, which are issued one at a
+  // time: StartCall, WriteLast(request), Read()... until the end of the
+  // stream, and Finish.
+  void OnCompleted(bool ok) override {
+    switch (state_) {
+      case State::kStarting:
+        if (!ok) return Finish();
+        state_ = State::kWriting;
+        call_->WriteLast(request_buf_, ::grpc::WriteOptions(), this);
+        return;
+      case State::kWriting:
+        if (!ok) return Finish();
+        state_ = State::kReading;
+        call_->Read(&response_buf_, this);
+        return;
+      case State::kReading:
+        // Not ok at the end of the stream; Finish() reports why.
+        if (!ok) return Finish();
+        ParseMessage();
+        if (!parse_status_.ok()) {
+          context_.TryCancel();
+          return Finish();
+        }
+        call_->Read(&response_buf_, this);
+        return;
+      case State::kFinishing:
+        Done();
+        return;
+    }
+  }
+
+ private:
+  enum class State { kStarting, kWriting, kReading, kFinishing };
+
+  void ParseMessage() {
+    RecvTensorBatchResponse response;
+    if (!GrpcMaybeParseProto(&response_buf_, &response)) {
+      parse_status_ = errors::Internal("could not parse rpc response");
+      return;
+    }
+    response_buf_.Clear();
+    const int index = response.index();
+    if (index < 0 || index >= static_cast<int>(is_received_.size()) ||
+        is_received_[index]) {
+      parse_status_ = errors::Internal(
+          "RecvTensorBatch returned an unexpected response index ", index);
+      return;
+    }
+    is_received_[index] = true;
+    TensorResponse* tensor_response = (*responses_)[index];
+    received_(index, tensor_response->InitFrom(response.mutable_response()));
+  }
+
+  void Finish() {
+    state_ = State::kFinishing;
+    call_->Finish(&status_, this);
+  }
+
+  void Done() {
+    if (call_opts_) {
+      call_opts_->ClearCancelCallback();
+    }
+    Status s = FromGrpcStatus(status_);
+    if (s.ok()) s = parse_status_;
+    for (int i = 0; i < static_cast<int>(is_received_.size()); ++i) {
+      if (is_received_[i]) continue;
+      if (s.ok()) {
+        s = errors::Internal("RecvTensorBatch returned no response for ",
+                             "request ", i);
+      }
+      received_(i, s);
+    }
+    if (!s.ok()) {
+      VLOG(2) << "Call returned with non-ok status: " << s;
+    }
+    done_(s);
+    delete this;
+  }
+
+  CallOptions* call_opts_;
+  ::grpc::ClientContext context_;
+  std::unique_ptr<::grpc::GenericClientAsyncReaderWriter> call_;
+  std::vector<TensorResponse*>* responses_;
+  ::grpc::ByteBuffer request_buf_;
+  ::grpc::ByteBuffer response_buf_;
+  ::grpc::Status status_;
+  std::function<void(int, const Status&)> received_;
+  StatusCallback done_;
+
+  State state_ = State::kStarting;
+  std::vector<bool> is_received_;
+  Status parse_status_;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_STATE_H_
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+
+#include <algorithm>
+
 #include "grpc++/support/byte_buffer.h"
 #include "grpc++/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -234,5 +237,77 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
   }
 }
 
+void EncodeTensorToByteBufferChunks(bool is_dead, const Tensor& val,
+                                    int64 chunk_bytes,
+                                    std::vector<::grpc::ByteBuffer>* result) {
+  result->clear();
+  StringPiece tdata = val.tensor_data();
+  if (!DataTypeCanUseMemcpy(val.dtype()) || chunk_bytes <= 0 ||
+      tdata.size() <= static_cast<size_t>(chunk_bytes)) {
+    result->emplace_back();
+    EncodeTensorToByteBuffer(is_dead, val, &result->back());
+    return;
+  }
+
+  // Header: everything but the tensor content.
+  RecvTensorResponse response;
+  if (is_dead) {
+    response.set_is_dead(is_dead);
+  }
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  response.mutable_tensor()->set_dtype(val.dtype());
+  val.shape().AsProto(response.mutable_tensor()->mutable_tensor_shape());
+  result->emplace_back();
+  EncodeRecvTensorResponseToByteBuffer(response, &result->back());
+
+  // Chunks: a RecvTensorResponse holding only R.tensor().tensor_content(),
+  // i.e. (B1), (B2), (D1), (D2) followed by a slice of the backing store.
+  const TensorBuffer* buf = DMAHelper::buffer(&val);
+  for (size_t offset = 0; offset < tdata.size(); offset += chunk_bytes) {
+    const size_t num_bytes =
+        std::min(tdata.size() - offset, static_cast<size_t>(chunk_bytes));
+    char prefix[32];
+    io::ProtoEncodeHelper e(prefix, sizeof(prefix));
+    e.WriteVarlengthBeginning(
+        RecvTensorResponse::kTensorFieldNumber,
+        VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
+                              num_bytes));
+    e.WriteVarlengthBeginning(TensorProto::kTensorContentFieldNumber,
+                              num_bytes);
+
+    ::grpc::Slice slices[2];
+    slices[0] = ::grpc::Slice(e.data(), e.size());
+    buf->Ref();
+    slices[1] = ::grpc::Slice(
+        const_cast<void*>(static_cast<const void*>(tdata.data() + offset)),
+        num_bytes,
+        [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+        const_cast<TensorBuffer*>(buf));
+    result->emplace_back(&slices[0], 2);
+  }
+}
+
+void EncodeTensorToBatchByteBuffer(int index, bool is_dead, const Tensor& val,
+                                   ::grpc::ByteBuffer* result) {
+  ::grpc::ByteBuffer response;
+  EncodeTensorToByteBuffer(is_dead, val, &response);
+
+  // The RecvTensorResponse encoding is wrapped as
+  // RecvTensorBatchResponse.response, after RecvTensorBatchResponse.index.
+  char prefix[32];
+  io::ProtoEncodeHelper e(prefix, sizeof(prefix));
+  e.WriteUint64(RecvTensorBatchResponse::kIndexFieldNumber, index);
+  e.WriteVarlengthBeginning(RecvTensorBatchResponse::kResponseFieldNumber,
+                            response.Length());
+
+  std::vector<::grpc::Slice> slices(1);
+  slices[0] = ::grpc::Slice(e.data(), e.size());
+  std::vector<::grpc::Slice> response_slices;
+  (void)response.Dump(&response_slices);
+  slices.insert(slices.end(), response_slices.begin(), response_slices.end());
+  ::grpc::ByteBuffer tmp(&slices[0], slices.size());
+  result->Swap(&tmp);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
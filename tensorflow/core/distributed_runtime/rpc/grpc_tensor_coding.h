@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
 namespace grpc {
 class ByteBuffer;
 }  // namespace grpc
@@ -51,6 +55,28 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result);
 
+// Encode a Tensor into the sequence of messages returned by the streaming
+// RecvTensorStream method (see RecvTensorResponse in worker.proto).
+//
+// If "val" can be memcpy'd and holds more than "chunk_bytes" bytes, the
+// first message is a RecvTensorResponse without tensor content, and each
+// following message holds the next (at most) "chunk_bytes" bytes of content.
+// The chunks share the backing store of "val" instead of copying it.
+// Otherwise there is a single message, as encoded by
+// EncodeTensorToByteBuffer.
+//
+// Discards original contents of *result.
+void EncodeTensorToByteBufferChunks(bool is_dead, const Tensor& val,
+                                    int64 chunk_bytes,
+                                    std::vector<::grpc::ByteBuffer>* result);
+
+// Encode a Tensor as a RecvTensorBatchResponse with the given "index",
+// holding the RecvTensorResponse encoded by EncodeTensorToByteBuffer.
+//
+// Discards original contents of *result.
+void EncodeTensorToBatchByteBuffer(int index, bool is_dead, const Tensor& val,
+                                   ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
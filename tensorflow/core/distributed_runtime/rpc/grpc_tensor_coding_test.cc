@@ -100,4 +100,75 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+static string ByteBufferToString(const ::grpc::ByteBuffer& buf) {
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  return tmp;
+}
+
+TEST_F(GrpcTensorCodingTest, Chunks) {
+  Tensor t(DT_FLOAT, TensorShape({10, 100}));
+  test::FillIota<float>(&t, 0.0f);
+
+  std::vector<::grpc::ByteBuffer> bufs;
+  grpc::EncodeTensorToByteBufferChunks(false, t, 1024, &bufs);
+  // Header, then ceil(4000 / 1024) chunks.
+  ASSERT_EQ(5, bufs.size());
+
+  RecvTensorResponse header;
+  ASSERT_TRUE(header.ParseFromString(ByteBufferToString(bufs[0])));
+  EXPECT_FALSE(header.is_dead());
+  EXPECT_EQ(DT_FLOAT, header.tensor().dtype());
+  EXPECT_EQ(0, header.tensor().tensor_content().size());
+
+  string content;
+  for (size_t i = 1; i < bufs.size(); ++i) {
+    RecvTensorResponse chunk;
+    ASSERT_TRUE(chunk.ParseFromString(ByteBufferToString(bufs[i])));
+    EXPECT_EQ(i + 1 < bufs.size() ? 1024 : 4000 - 3 * 1024,
+              chunk.tensor().tensor_content().size());
+    content.append(chunk.tensor().tensor_content());
+  }
+  header.mutable_tensor()->set_tensor_content(content);
+  Tensor result_tensor;
+  ASSERT_TRUE(result_tensor.FromProto(header.tensor()));
+  test::ExpectTensorEqual<float>(t, result_tensor);
+}
+
+TEST_F(GrpcTensorCodingTest, ChunksSingleMessage) {
+  std::vector<::grpc::ByteBuffer> bufs;
+  Tensor small(DT_FLOAT, TensorShape({10}));
+  test::FillIota<float>(&small, 0.0f);
+  grpc::EncodeTensorToByteBufferChunks(true, small, 1024, &bufs);
+  ASSERT_EQ(1, bufs.size());
+  RecvTensorResponse response;
+  ASSERT_TRUE(response.ParseFromString(ByteBufferToString(bufs[0])));
+  EXPECT_TRUE(response.is_dead());
+
+  Tensor strings(DT_STRING, TensorShape({1000}));
+  grpc::EncodeTensorToByteBufferChunks(false, strings, 16, &bufs);
+  EXPECT_EQ(1, bufs.size());
+}
+
+TEST_F(GrpcTensorCodingTest, BatchResponse) {
+  for (int64 num_elements : {10, 100000}) {
+    Tensor t(DT_FLOAT, TensorShape({num_elements}));
+    test::FillIota<float>(&t, 0.0f);
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeTensorToBatchByteBuffer(7, true, t, &buf);
+
+    RecvTensorBatchResponse response;
+    ASSERT_TRUE(response.ParseFromString(ByteBufferToString(buf)));
+    EXPECT_EQ(7, response.index());
+    EXPECT_TRUE(response.response().is_dead());
+    Tensor result_tensor;
+    ASSERT_TRUE(result_tensor.FromProto(response.response().tensor()));
+    test::ExpectTensorEqual<float>(t, result_tensor);
+  }
+}
+
 }  // namespace tensorflow
@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -162,6 +163,12 @@ class GrpcWorkerService : public AsyncServiceInterface {
       for (int i = 0; i < 1000; ++i) {
         EnqueueRecvTensorRequestRaw();
       }
+      for (int i = 0; i < 100; ++i) {
+        EnqueueRecvTensorStreamRequestRaw();
+      }
+      for (int i = 0; i < 100; ++i) {
+        EnqueueRecvTensorBatchRequestRaw();
+      }
       for (int i = 0; i < 500; ++i) {
         ENQUEUE_REQUEST(RecvBuf, true);
       }
@@ -180,6 +187,9 @@ class GrpcWorkerService : public AsyncServiceInterface {
         ENQUEUE_REQUEST(CompleteInstance, true);
         ENQUEUE_REQUEST(GetStepSequence, true);
       }
+      for (int i = 0; i < 100; ++i) {
+        ENQUEUE_REQUEST(GetDatasetElements, true);
+      }
 
       void* tag;
       bool ok;
@@ -303,6 +313,47 @@ class GrpcWorkerService : public AsyncServiceInterface {
       EnqueueRecvTensorRequestRaw();
     }
 
+    void RecvTensorStreamHandlerRaw(
+        ServerStreamingCall<GrpcWorkerServiceThread,
+                            grpc::WorkerService::AsyncService,
+                            RecvTensorRequest, ::grpc::ByteBuffer>* call) {
+      Schedule([this, call]() {
+        CallOptions* call_opts = new CallOptions;
+        auto* responses = new std::vector<::grpc::ByteBuffer>;
+        call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+        worker_->GrpcRecvTensorStreamAsync(
+            call_opts, &call->request, responses,
+            [call, call_opts, responses](const Status& s) {
+              call->ClearCancelCallback();
+              delete call_opts;
+              call->SendResponses(std::move(*responses), ToGrpcStatus(s));
+              delete responses;
+            });
+      });
+      EnqueueRecvTensorStreamRequestRaw();
+    }
+
+    void RecvTensorBatchHandlerRaw(
+        ServerStreamingCall<GrpcWorkerServiceThread,
+                            grpc::WorkerService::AsyncService,
+                            RecvTensorBatchRequest, ::grpc::ByteBuffer>* call) {
+      Schedule([this, call]() {
+        CallOptions* call_opts = new CallOptions;
+        call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+        worker_->GrpcRecvTensorBatchAsync(
+            call_opts, &call->request,
+            [call](::grpc::ByteBuffer* response) {
+              call->Write(std::move(*response));
+            },
+            [call, call_opts](const Status& s) {
+              call->ClearCancelCallback();
+              delete call_opts;
+              call->Finish(ToGrpcStatus(s));
+            });
+      });
+      EnqueueRecvTensorBatchRequestRaw();
+    }
+
     void CleanupGraphHandler(
         WorkerCall<CleanupGraphRequest, CleanupGraphResponse>* call) {
       Schedule([this, call]() {
@@ -382,6 +433,23 @@ class GrpcWorkerService : public AsyncServiceInterface {
       });
       ENQUEUE_REQUEST(GetStepSequence, true);
     }
+
+    void GetDatasetElementsHandler(
+        WorkerCall<GetDatasetElementsRequest, GetDatasetElementsResponse>*
+            call) {
+      Schedule([this, call]() {
+        CallOptions* call_opts = new CallOptions;
+        call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+        worker_->GetDatasetElementsAsync(call_opts, &call->request,
+                                         &call->response,
+                                         [call, call_opts](const Status& s) {
+                                           call->ClearCancelCallback();
+                                           delete call_opts;
+                                           call->SendResponse(ToGrpcStatus(s));
+                                         });
+      });
+      ENQUEUE_REQUEST(GetDatasetElements, true);
+    }
 #undef ENQUEUE_REQUEST
 
     void EnqueueRecvTensorRequestRaw() {
@@ -397,6 +465,34 @@ class GrpcWorkerService : public AsyncServiceInterface {
       }
     }
 
+    void EnqueueRecvTensorStreamRequestRaw() {
+      mutex_lock l(shutdown_mu_);
+      if (!is_shutdown_) {
+        ServerStreamingCall<GrpcWorkerServiceThread,
+                            grpc::WorkerService::AsyncService,
+                            RecvTensorRequest, ::grpc::ByteBuffer>::
+            EnqueueRequestForMethod(
+                worker_service_, cq_.get(),
+                static_cast<int>(GrpcWorkerMethod::kRecvTensorStream),
+                &GrpcWorkerServiceThread::RecvTensorStreamHandlerRaw,
+                true /* supports cancel*/);
+      }
+    }
+
+    void EnqueueRecvTensorBatchRequestRaw() {
+      mutex_lock l(shutdown_mu_);
+      if (!is_shutdown_) {
+        ServerStreamingCall<GrpcWorkerServiceThread,
+                            grpc::WorkerService::AsyncService,
+                            RecvTensorBatchRequest, ::grpc::ByteBuffer>::
+            EnqueueRequestForMethod(
+                worker_service_, cq_.get(),
+                static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch),
+                &GrpcWorkerServiceThread::RecvTensorBatchHandlerRaw,
+                true /* supports cancel*/);
+      }
+    }
+
     GrpcWorker* const worker_ = nullptr;  // Not owned.
     std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
     std::unique_ptr<Thread> thread_;
@@ -428,6 +524,99 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                                      const RecvTensorRequest* request,
                                      ::grpc::ByteBuffer* response,
                                      StatusCallback done) {
+  RecvTensorOnHostAsync(opts, request,
+                        [response](bool is_dead, const Tensor& val) {
+                          grpc::EncodeTensorToByteBuffer(is_dead, val,
+                                                         response);
+                        },
+                        std::move(done));
+}
+
+namespace {
+
+// Size of the tensor content chunks sent by RecvTensorStream.
+int64 RecvTensorChunkBytes() {
+  static const int64 chunk_bytes = []() {
+    int64 value;
+    Status status = ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_CHUNK_BYTES",
+                                        4 << 20, &value);
+    if (!status.ok() || value <= 0) {
+      LOG(ERROR) << "Invalid TF_GRPC_RECV_TENSOR_CHUNK_BYTES, using 4MB: "
+                 << status;
+      value = 4 << 20;
+    }
+    return value;
+  }();
+  return chunk_bytes;
+}
+
+}  // namespace
+
+void GrpcWorker::GrpcRecvTensorStreamAsync(
+    CallOptions* opts, const RecvTensorRequest* request,
+    std::vector<::grpc::ByteBuffer>* responses, StatusCallback done) {
+  RecvTensorOnHostAsync(opts, request,
+                        [responses](bool is_dead, const Tensor& val) {
+                          grpc::EncodeTensorToByteBufferChunks(
+                              is_dead, val, RecvTensorChunkBytes(), responses);
+                        },
+                        std::move(done));
+}
+
+void GrpcWorker::GrpcRecvTensorBatchAsync(
+    CallOptions* opts, const RecvTensorBatchRequest* request,
+    std::function<void(::grpc::ByteBuffer*)> write, StatusCallback done) {
+  const int num_requests = request->request_size();
+  if (num_requests == 0) {
+    done(Status::OK());
+    return;
+  }
+
+  // Each RecvTensorOnHostAsync() call needs its own CallOptions, because it
+  // clears the cancellation callback when its tensor arrives.
+  struct BatchState {
+    mutex mu;
+    int num_pending GUARDED_BY(mu);
+    Status status GUARDED_BY(mu);
+    std::vector<CallOptions> call_opts;
+  };
+  BatchState* state = new BatchState;
+  state->num_pending = num_requests;
+  state->call_opts = std::vector<CallOptions>(num_requests);
+  opts->SetCancelCallback([state]() {
+    for (CallOptions& call_opts : state->call_opts) {
+      call_opts.StartCancel();
+    }
+  });
+
+  for (int i = 0; i < num_requests; ++i) {
+    RecvTensorOnHostAsync(
+        &state->call_opts[i], &request->request(i),
+        [i, write](bool is_dead, const Tensor& val) {
+          ::grpc::ByteBuffer response;
+          grpc::EncodeTensorToBatchByteBuffer(i, is_dead, val, &response);
+          write(&response);
+        },
+        [opts, state, done](const Status& s) {
+          bool last;
+          Status status;
+          {
+            mutex_lock l(state->mu);
+            state->status.Update(s);
+            last = --state->num_pending == 0;
+            status = state->status;
+          }
+          if (!last) return;
+          opts->ClearCancelCallback();
+          delete state;
+          done(status);
+        });
+  }
+}
+
+void GrpcWorker::RecvTensorOnHostAsync(
+    CallOptions* opts, const RecvTensorRequest* request,
+    std::function<void(bool, const Tensor&)> encode, StatusCallback done) {
   Status s = recv_tensor_recent_request_ids_.TrackUnique(
       request->request_id(), "RecvTensor (GrpcWorker)", *request);
   if (!s.ok()) {
@@ -456,7 +645,7 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, response, done, src_dev, request](
+      [opts, encode, done, src_dev, request](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
@@ -483,10 +672,10 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                   << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
               // "val" is on an accelerator device. Uses the device_context to
               // fill the copy on host.
-              StatusCallback copy_ready = [response, done, copy,
+              StatusCallback copy_ready = [encode, done, copy,
                                            is_dead](const Status& s) {
                 // The value is now ready to be returned on the wire.
-                grpc::EncodeTensorToByteBuffer(is_dead, *copy, response);
+                encode(is_dead, *copy);
                 done(s);
                 delete copy;
               };
@@ -494,7 +683,7 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
               send_dev_context->CopyDeviceTensorToCPU(
                   &val, request->rendezvous_key(), src_dev, copy, copy_ready);
             } else {
-              grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+              encode(is_dead, val);
               done(Status::OK());
             }
           }
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 
+#include <functional>
+#include <vector>
+
 #include "tensorflow/core/distributed_runtime/recent_request_ids.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 
@@ -40,6 +43,20 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Streaming version of GrpcRecvTensorAsync, for the RecvTensorStream
+  // method: the content of a large tensor is split over several messages.
+  virtual void GrpcRecvTensorStreamAsync(
+      CallOptions* opts, const RecvTensorRequest* request,
+      std::vector<::grpc::ByteBuffer>* responses, StatusCallback done);
+
+  // Batched version of GrpcRecvTensorAsync, for the RecvTensorBatch method.
+  // Calls `write(response)` with the RecvTensorBatchResponse of each request
+  // as soon as its tensor is available, possibly concurrently, and `done`
+  // with the first error, if any, once all of the requests are complete.
+  virtual void GrpcRecvTensorBatchAsync(
+      CallOptions* opts, const RecvTensorBatchRequest* request,
+      std::function<void(::grpc::ByteBuffer*)> write, StatusCallback done);
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done);
 
@@ -48,6 +65,14 @@ class GrpcWorker : public Worker {
 
   WorkerEnv* env();
 
+ protected:
+  // Looks up the tensor for `request`, copies it to host memory if needed,
+  // and calls `encode(is_dead, tensor)` before `done`.
+  void RecvTensorOnHostAsync(CallOptions* opts,
+                             const RecvTensorRequest* request,
+                             std::function<void(bool, const Tensor&)> encode,
+                             StatusCallback done);
+
  private:
   RecentRequestIds recv_tensor_recent_request_ids_;
 };
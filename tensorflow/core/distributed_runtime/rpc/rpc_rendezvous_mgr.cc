@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -27,16 +28,63 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+auto* remote_recvs = monitoring::Counter<0>::New(
+    "/tensorflow/core/rpc_rendezvous_remote_recvs",
+    "The number of tensors received from other workers by "
+    "RpcRemoteRendezvous.");
+
+auto* remote_recv_rpcs = monitoring::Counter<0>::New(
+    "/tensorflow/core/rpc_rendezvous_remote_recv_rpcs",
+    "The number of RecvTensor and RecvTensorBatch RPCs issued by "
+    "RpcRemoteRendezvous. The ratio of remote_recvs to this counter is the "
+    "average number of tensors coalesced per RPC.");
+
+// Returns how long, in microseconds, remote recvs from the same worker are
+// collected before being sent as a single RecvTensorBatch RPC. Zero (the
+// default) sends one RecvTensor RPC per recv. Batching requires all workers
+// of the cluster to serve RecvTensorBatch.
+int64 RecvTensorBatchWindowMicros() {
+  static const int64 window_micros = []() {
+    int64 value;
+    Status status = ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_WINDOW_US",
+                                        0, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    return value;
+  }();
+  return window_micros;
+}
+
+// Returns the number of recvs at which a batch is sent before the end of its
+// window.
+int64 RecvTensorBatchMaxSize() {
+  static const int64 max_size = []() {
+    int64 value;
+    Status status =
+        ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_MAX_SIZE", 256, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+    }
+    return value;
+  }();
+  return max_size;
+}
+
+class RpcRecvTensorCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
@@ -50,6 +98,28 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Recvs from one worker waiting for the end of their batching window.
+  struct PendingBatch {
+    int64 id = 0;
+    std::vector<RpcRecvTensorCall*> calls;
+  };
+
+  // Adds "call" to the pending batch of its source worker, which is
+  // started by the end of its window or when it is full.
+  void EnqueueBatchedCall(RpcRecvTensorCall* call);
+
+  // Starts the pending batch of "src_worker" if its id is "batch_id".
+  void FlushBatch(const string& src_worker, int64 batch_id);
+
+  // Receives the tensors of "calls" with a RecvTensorBatch RPC.
+  void StartBatch(const string& src_worker,
+                  std::vector<RpcRecvTensorCall*> calls);
+
+  mutex batch_mu_;
+  int64 next_batch_id_ GUARDED_BY(batch_mu_) = 0;
+  std::unordered_map<string, PendingBatch> pending_batches_
+      GUARDED_BY(batch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -100,6 +170,25 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     StartRTCall(std::move(recv_done));
   }
 
+  // Prepares to receive the tensor with a RecvTensorBatch RPC instead of
+  // Start(). BatchedRecvDone() must then be called once the tensor is in
+  // response(), or on failure, and calls "recv_done".
+  void StartBatched(std::function<void()> recv_done) {
+    resp_.InitAlloc(dst_device_, alloc_attrs_);
+    batched_recv_done_ = std::move(recv_done);
+  }
+
+  void BatchedRecvDone(const Status& s) {
+    opts_.ClearCancelCallback();
+    if (!s.ok()) {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    std::function<void()> recv_done = std::move(batched_recv_done_);
+    batched_recv_done_ = nullptr;
+    recv_done();
+  }
+
   void StartAbort(const Status& s) override {
     {
       mutex_lock l(mu_);
@@ -115,6 +204,8 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   const Tensor& tensor() const { return resp_.tensor(); }
 
+  TensorResponse* response() { return &resp_; }
+
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
   Device* dst_device() const { return dst_device_; }
@@ -152,6 +243,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   TensorResponse resp_;
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
+  std::function<void()> batched_recv_done_;
 
   mutable mutex mu_;
   Status status_ GUARDED_BY(mu_);
@@ -243,10 +335,11 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Record "call" in active_ so that it can be aborted cleanly.
   RegisterCall(call);
+  remote_recvs->GetCell()->IncrementBy(1);
 
   // Start "call".
   Ref();
-  call->Start([this, call]() {
+  std::function<void()> recv_done = [this, call]() {
     // Removes "call" from active_. Prevent StartAbort().
     DeregisterCall(call);
     // If StartAbort was called prior to DeregisterCall, then the
@@ -257,7 +350,112 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     call->wi_ = nullptr;
     get_call_freelist()->Release(call, session()->worker_cache.get());
     Unref();
-  });
+  };
+  if (RecvTensorBatchWindowMicros() > 0) {
+    call->StartBatched(std::move(recv_done));
+    EnqueueBatchedCall(call);
+  } else {
+    remote_recv_rpcs->GetCell()->IncrementBy(1);
+    call->Start(std::move(recv_done));
+  }
+}
+
+void RpcRemoteRendezvous::EnqueueBatchedCall(RpcRecvTensorCall* call) {
+  const string& src_worker = call->src_worker_;
+  std::vector<RpcRecvTensorCall*> full_batch;
+  int64 new_batch_id = -1;
+  {
+    mutex_lock l(batch_mu_);
+    PendingBatch& batch = pending_batches_[src_worker];
+    if (batch.calls.empty()) {
+      batch.id = new_batch_id = next_batch_id_++;
+    }
+    batch.calls.push_back(call);
+    if (static_cast<int64>(batch.calls.size()) >= RecvTensorBatchMaxSize()) {
+      full_batch.swap(batch.calls);
+      pending_batches_.erase(src_worker);
+      new_batch_id = -1;
+    }
+  }
+  if (new_batch_id >= 0) {
+    // The timer holds a reference, since the batch may be started, and the
+    // rendezvous released, before it fires.
+    Ref();
+    env_->env->SchedClosureAfter(
+        RecvTensorBatchWindowMicros(), [this, src_worker, new_batch_id]() {
+          FlushBatch(src_worker, new_batch_id);
+          Unref();
+        });
+  }
+  if (!full_batch.empty()) {
+    StartBatch(src_worker, std::move(full_batch));
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker,
+                                     int64 batch_id) {
+  std::vector<RpcRecvTensorCall*> calls;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    if (it == pending_batches_.end() || it->second.id != batch_id) return;
+    calls.swap(it->second.calls);
+    pending_batches_.erase(it);
+  }
+  StartBatch(src_worker, std::move(calls));
+}
+
+void RpcRemoteRendezvous::StartBatch(const string& src_worker,
+                                     std::vector<RpcRecvTensorCall*> calls) {
+  struct Batch {
+    CallOptions opts;
+    RecvTensorBatchRequest req;
+    std::vector<TensorResponse*> responses;
+    std::vector<RpcRecvTensorCall*> calls;
+  };
+  Batch* batch = new Batch;
+  for (RpcRecvTensorCall* call : calls) {
+    // Calls aborted while waiting for the batch are not sent.
+    Status s = call->status();
+    if (!s.ok()) {
+      call->BatchedRecvDone(s);
+      continue;
+    }
+    *batch->req.add_request() = call->req_;
+    batch->responses.push_back(call->response());
+    batch->calls.push_back(call);
+  }
+  if (batch->calls.empty()) {
+    delete batch;
+    return;
+  }
+
+  // The batch has its own WorkerInterface, since the calls release theirs
+  // as they complete, before the RPC does.
+  WorkerSession* sess = session();
+  WorkerInterface* rwi = sess->worker_cache->CreateWorker(src_worker);
+  if (rwi == nullptr) {
+    for (RpcRecvTensorCall* call : batch->calls) {
+      call->BatchedRecvDone(
+          errors::Internal("No worker known as ", src_worker));
+    }
+    delete batch;
+    return;
+  }
+  for (RpcRecvTensorCall* call : batch->calls) {
+    call->opts_.SetCancelCallback([batch]() { batch->opts.StartCancel(); });
+  }
+
+  remote_recv_rpcs->GetCell()->IncrementBy(1);
+  Ref();
+  rwi->RecvTensorBatchAsync(
+      &batch->opts, &batch->req, &batch->responses,
+      [batch](int i, const Status& s) { batch->calls[i]->BatchedRecvDone(s); },
+      [this, batch, src_worker, rwi](const Status& s) {
+        session()->worker_cache->ReleaseWorker(src_worker, rwi);
+        delete batch;
+        Unref();
+      });
 }
 
 }  // namespace
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <cstdio>
 #include <functional>
 #include <string>
@@ -35,12 +36,23 @@ limitations under the License.
 #include "tensorflow/core/protobuf/cluster.pb.h"
 #include "tensorflow/core/protobuf/tensorflow_server.pb.h"
 #include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 static const int kWorkers = 60;
 static thread::ThreadPool* worker_threads;
 
+// The protocol of the servers, "grpc" unless TF_RPCBENCH_PROTOCOL names
+// another one, such as "grpc+verbs", "grpc+gdr" or "grpc+mpi". Those
+// transports are only available when their servers are linked into the
+// benchmark.
+static string Protocol() {
+  string protocol;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_RPCBENCH_PROTOCOL", "grpc", &protocol));
+  return protocol;
+}
+
 void MakeGRPCCluster(const SessionOptions& options, int n,
                      std::vector<string>* workers,
                      std::vector<DeviceAttributes>* devices) {
@@ -64,11 +76,13 @@ void MakeGRPCCluster(const SessionOptions& options, int n,
     num_gpus = iter->second;
   }
 
+  const string protocol = Protocol();
   worker_threads = new thread::ThreadPool(Env::Default(), "worker_threads", n);
   for (int worker_idx = 0; worker_idx < n; ++worker_idx) {
-    worker_threads->Schedule([worker_idx, n, num_cpus, num_gpus, &port] {
+    worker_threads->Schedule([worker_idx, n, num_cpus, num_gpus, protocol,
+                              &port] {
       ServerDef server;
-      server.set_protocol("grpc");
+      server.set_protocol(protocol);
       server.set_job_name("localhost");
       server.set_task_index(worker_idx);
 
@@ -248,4 +262,158 @@ BENCHMARK(BM_SingleDevice)
     ->ArgPair(4, 10000)
     ->ArgPair(1, 1000000);
 
+// Benchmarks of the step patterns of distributed training. Each step runs
+// the "step" target of a graph over variables, so that the tensors that
+// cross devices are never constant folded, and each benchmark reports the
+// bandwidth of the step and the 50th and 99th percentile step latency.
+
+// Returns a variable of "num_floats" floats on "device", and adds the
+// assignment of its initial value to "*init".
+Output NewVariable(const Scope& s, const string& device, int64 num_floats,
+                   std::vector<Operation>* init) {
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  const Scope scope = s.WithDevice(device);
+  Output var = Variable(scope, {num_floats}, DT_FLOAT);
+  init->push_back(
+      Assign(scope, var, Fill(scope, {num_floats}, 1.0f)).operation);
+  return var;
+}
+
+// Adds the "init" and "step" targets, which depend on "init_ops" and
+// "step_ops", and returns the graph of "s".
+GraphDef FinishStepGraph(const Scope& s, const std::vector<Operation>& init_ops,
+                         const std::vector<Operation>& step_ops) {
+  ops::NoOp(s.WithOpName("init").WithControlDependencies(init_ops));
+  ops::NoOp(s.WithOpName("step").WithControlDependencies(step_ops));
+  GraphDef def;
+  TF_CHECK_OK(s.ToGraphDef(&def));
+  return def;
+}
+
+// A parameter server step: every worker reads "num_tensors" variables of
+// "num_floats" floats from the parameter server, and the parameter server
+// sums the gradients of all the workers, which makes it the destination of
+// a fan-in from every worker.
+GraphDef ParameterServerStep(int num_workers, int num_tensors,
+                             int64 num_floats, const Cluster* cluster) {
+  CHECK_GT(cluster->devices.size(), num_workers);
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  Scope s = Scope::NewRootScope();
+  const string& ps = cluster->devices[0].name();
+  std::vector<Operation> init_ops;
+  std::vector<Operation> step_ops;
+  for (int i = 0; i < num_tensors; ++i) {
+    Output var = NewVariable(s, ps, num_floats, &init_ops);
+    std::vector<Output> grads;
+    for (int w = 1; w <= num_workers; ++w) {
+      grads.push_back(Neg(s.WithDevice(cluster->devices[w].name()), var));
+    }
+    step_ops.push_back(AddN(s.WithDevice(ps), grads).operation);
+  }
+  return FinishStepGraph(s, init_ops, step_ops);
+}
+
+// A ring all-reduce step of "num_floats" floats over "num_devices" devices:
+// every device holds a chunk of each tensor, each chunk is reduced along
+// the ring starting at a different device, and then passed along the ring
+// again so that every device gets the sum.
+GraphDef RingAllReduceStep(int num_devices, int64 num_floats,
+                           const Cluster* cluster) {
+  CHECK_GE(cluster->devices.size(), num_devices);
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  Scope s = Scope::NewRootScope();
+  const int64 chunk_floats = num_floats / num_devices;
+  std::vector<std::vector<Output>> chunks(num_devices);
+  std::vector<Operation> init_ops;
+  for (int d = 0; d < num_devices; ++d) {
+    for (int c = 0; c < num_devices; ++c) {
+      chunks[d].push_back(NewVariable(s, cluster->devices[d].name(),
+                                      chunk_floats, &init_ops));
+    }
+  }
+  std::vector<Operation> step_ops;
+  for (int c = 0; c < num_devices; ++c) {
+    Output sum = Identity(s.WithDevice(cluster->devices[c].name()),
+                          chunks[c][c]);
+    for (int k = 1; k < num_devices; ++k) {
+      const int d = (c + k) % num_devices;
+      sum = Add(s.WithDevice(cluster->devices[d].name()), sum, chunks[d][c]);
+    }
+    for (int k = 0; k < num_devices - 1; ++k) {
+      const int d = (c + k) % num_devices;
+      sum = Identity(s.WithDevice(cluster->devices[d].name()), sum);
+    }
+    step_ops.push_back(sum.op());
+  }
+  return FinishStepGraph(s, init_ops, step_ops);
+}
+
+// Runs "iters" steps of "def", and reports "bytes_per_step" bytes per step
+// and the step latency percentiles.
+static void RunSteps(int iters, const GraphDef& def, int64 bytes_per_step) {
+  const Cluster* cluster = GetCluster();
+  std::unique_ptr<Session> session(NewSession(cluster->options));
+  TF_CHECK_OK(session->Create(def));
+  TF_CHECK_OK(session->Run({}, {}, {"init"}, nullptr));
+  for (int i = 0; i < 3; i++) {
+    TF_CHECK_OK(session->Run({}, {}, {"step"}, nullptr));
+  }
+
+  Env* env = Env::Default();
+  std::vector<int64> latencies_us(iters);
+  testing::StartTiming();
+  for (int i = 0; i < iters; i++) {
+    const int64 start_us = env->NowMicros();
+    TF_CHECK_OK(session->Run({}, {}, {"step"}, nullptr));
+    latencies_us[i] = env->NowMicros() - start_us;
+  }
+  testing::StopTiming();
+  TF_CHECK_OK(session->Close());
+
+  std::sort(latencies_us.begin(), latencies_us.end());
+  testing::BytesProcessed(static_cast<int64>(iters) * bytes_per_step);
+  testing::SetLabel(strings::StrCat(
+      Protocol(), "; p50 step: ", latencies_us[(iters - 1) / 2],
+      "us; p99 step: ", latencies_us[(iters - 1) * 99 / 100], "us"));
+}
+
+static void BM_PSManySmallTensors(int iters, int num_workers,
+                                  int num_tensors) {
+  testing::StopTiming();
+  const int64 num_floats = 256;
+  RunSteps(iters,
+           ParameterServerStep(num_workers, num_tensors, num_floats,
+                               GetCluster()),
+           2 * num_workers * num_tensors * num_floats * sizeof(float));
+}
+BENCHMARK(BM_PSManySmallTensors)
+    ->ArgPair(4, 100)
+    ->ArgPair(16, 100)
+    ->ArgPair(16, 1000)
+    ->ArgPair(48, 100);
+
+static void BM_PSFewHugeTensors(int iters, int num_workers, int megabytes) {
+  testing::StopTiming();
+  const int num_tensors = 2;
+  const int64 num_floats = (megabytes << 20) / sizeof(float);
+  RunSteps(iters,
+           ParameterServerStep(num_workers, num_tensors, num_floats,
+                               GetCluster()),
+           2 * num_workers * num_tensors * num_floats * sizeof(float));
+}
+BENCHMARK(BM_PSFewHugeTensors)->ArgPair(2, 16)->ArgPair(4, 64)->ArgPair(8, 64);
+
+static void BM_RingAllReduce(int iters, int num_devices, int megabytes) {
+  testing::StopTiming();
+  const int64 num_floats = (megabytes << 20) / sizeof(float);
+  // Every chunk crosses 2 * (num_devices - 1) links.
+  RunSteps(iters, RingAllReduceStep(num_devices, num_floats, GetCluster()),
+           2 * (num_devices - 1) * num_floats * sizeof(float));
+}
+BENCHMARK(BM_RingAllReduce)
+    ->ArgPair(4, 1)
+    ->ArgPair(4, 64)
+    ->ArgPair(8, 64)
+    ->ArgPair(16, 64);
+
 }  // namespace tensorflow
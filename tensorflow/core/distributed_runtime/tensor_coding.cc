@@ -270,6 +270,48 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+Status TensorResponse::ParseChunkFrom(Source* source, int64* offset) {
+  if (!on_host_ || !DataTypeCanUseMemcpy(tensor_.dtype())) {
+    return errors::Internal("Tensor content of type ",
+                            DataTypeString(tensor_.dtype()),
+                            " can't be streamed to this device");
+  }
+  protobuf::io::CodedInputStream input(source->contents());
+  input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
+  // The chunk is a RecvTensorResponse with nothing but
+  // tensor().tensor_content() set.
+  int length;
+  if (!input.ExpectTag((RecvTensorResponse::kTensorFieldNumber << 3) |
+                       WIRETYPE_LENGTH_DELIMITED) ||
+      !ReadVarintSizeAsInt(&input, &length)) {
+    return errors::InvalidArgument("Cannot parse tensor chunk from response");
+  }
+  auto limit = input.PushLimit(length);
+  int num_bytes;
+  if (!input.ExpectTag((TensorProto::kTensorContentFieldNumber << 3) |
+                       WIRETYPE_LENGTH_DELIMITED) ||
+      !ReadVarintSizeAsInt(&input, &num_bytes)) {
+    return errors::InvalidArgument("Cannot parse tensor chunk from response");
+  }
+  StringPiece buf = tensor_.tensor_data();
+  if (*offset < 0 || *offset + num_bytes > static_cast<int64>(buf.size())) {
+    return errors::InvalidArgument("Tensor chunk [", *offset, ", ",
+                                   *offset + num_bytes,
+                                   ") is out of range for a tensor of ",
+                                   buf.size(), " bytes");
+  }
+  if (!input.ReadRaw(const_cast<char*>(buf.data()) + *offset, num_bytes) ||
+      !input.ExpectAtEnd()) {
+    return errors::InvalidArgument("Cannot parse tensor chunk from response");
+  }
+  input.PopLimit(limit);
+  if (input.ReadTag() != 0) {
+    return errors::InvalidArgument("Unexpected data after tensor chunk");
+  }
+  *offset += num_bytes;
+  return Status::OK();
+}
+
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
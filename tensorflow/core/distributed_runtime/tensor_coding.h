@@ -70,6 +70,19 @@ class TensorResponse {
   // source->contents() into *this.
   Status ParseFrom(Source* source);
 
+  // Parse one chunk of a streamed RecvTensorResponse (see RecvTensorStream
+  // in worker_service.proto) from source->contents(). The chunk holds the
+  // tensor content starting at byte '*offset'; it is copied into the tensor
+  // allocated by the preceding ParseFrom() of the stream's first message,
+  // and '*offset' is advanced past it.
+  //
+  // REQUIRES: the tensor is on the host and can be memcpy'd.
+  Status ParseChunkFrom(Source* source, int64* offset);
+
+  // Returns true if the tensor is parsed into host memory. Only then can its
+  // content be streamed with ParseChunkFrom().
+  bool on_host() const { return on_host_; }
+
   // Initialize tensor from *response.
   // Leaves *response with unspecified contents.
   Status InitFrom(RecvTensorResponse* response);
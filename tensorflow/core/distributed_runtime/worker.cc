@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
+#include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/platform/tracing.h"
 
 namespace tensorflow {
@@ -152,6 +153,9 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
                         StatusCallback done) {
   const int64 step_id = request->step_id();
   TRACEPRINTF("RunGraph: %lld", step_id);
+  for (size_t i = 0; i < request->num_cleanup_step_ids(); ++i) {
+    CleanupStep(request->cleanup_step_id(i));
+  }
   std::shared_ptr<WorkerSession> session;
   Status s;
   if (request->create_worker_session_called()) {
@@ -307,14 +311,17 @@ void Worker::DoPartialRunGraph(CallOptions* opts,
       });
 }
 
-void Worker::CleanupGraphAsync(const CleanupGraphRequest* request,
-                               CleanupGraphResponse* response,
-                               StatusCallback done) {
-  const int64 step_id = request->step_id();
+void Worker::CleanupStep(int64 step_id) {
   env_->rendezvous_mgr->Cleanup(step_id);
   if (env_->collective_executor_mgr) {
     env_->collective_executor_mgr->Cleanup(step_id);
   }
+}
+
+void Worker::CleanupGraphAsync(const CleanupGraphRequest* request,
+                               CleanupGraphResponse* response,
+                               StatusCallback done) {
+  CleanupStep(request->step_id());
   done(Status::OK());
 }
 
@@ -384,6 +391,50 @@ void Worker::GetStepSequenceAsync(const GetStepSequenceRequest* request,
   }
 }
 
+void Worker::GetDatasetElementsAsync(CallOptions* opts,
+                                     const GetDatasetElementsRequest* request,
+                                     GetDatasetElementsResponse* response,
+                                     StatusCallback done) {
+  Device* device = nullptr;
+  Status s = env_->device_mgr->LookupDevice(request->device(), &device);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  // Getting elements may block on the input pipeline, so it does not run on
+  // the RPC threads.
+  thread::ThreadPool* pool = env_->compute_pool;
+  pool->Schedule([device, pool, request, response, done]() {
+    auto runner = [pool](std::function<void()> fn) {
+      pool->Schedule(std::move(fn));
+    };
+    const int64 max_elements = std::max<int64>(request->max_elements(), 1);
+    Status s;
+    while (response->num_elements() < max_elements) {
+      std::vector<Tensor> components;
+      bool end_of_sequence = false;
+      s = SharedIteratorGetNext(device->resource_manager(), device, runner,
+                                request->container(), request->shared_name(),
+                                &components, &end_of_sequence);
+      if (!s.ok()) break;
+      if (end_of_sequence) {
+        response->set_end_of_sequence(true);
+        break;
+      }
+      for (const Tensor& component : components) {
+        component.AsProtoTensorContent(response->add_component());
+      }
+      response->set_num_elements(response->num_elements() + 1);
+    }
+    if (!s.ok() && response->num_elements() > 0) {
+      response->set_status_code(s.code());
+      response->set_status_error_message(s.error_message());
+      s = Status::OK();
+    }
+    done(s);
+  });
+}
+
 // Helper for RecvTensor. Validates "key" and returns the source
 // device in "*src_dev".
 Status Worker::PrepareRecvTensor(const Rendezvous::ParsedKey& parsed,
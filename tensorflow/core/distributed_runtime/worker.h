@@ -107,6 +107,11 @@ class Worker : public WorkerInterface {
                             GetStepSequenceResponse* response,
                             StatusCallback done) override;
 
+  void GetDatasetElementsAsync(CallOptions* opts,
+                               const GetDatasetElementsRequest* request,
+                               GetDatasetElementsResponse* response,
+                               StatusCallback done) override;
+
  protected:
   WorkerEnv* const env_;  // Not owned.
 
@@ -115,6 +120,9 @@ class Worker : public WorkerInterface {
 
   void AbortStep(int64);
 
+  // Releases the rendezvous and collective state of step "step_id".
+  void CleanupStep(int64 step_id);
+
  private:
   PartialRunMgr partial_run_mgr_;
 
@@ -17,11 +17,14 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_INTERFACE_H_
 
 #include <functional>
+#include <vector>
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -106,6 +109,54 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  // Receives the tensors of several RecvTensor requests to this worker,
+  // usually with a single RPC. `received(i, s)` is called once for each
+  // `request->request(i)`, as soon as `(*responses)[i]` holds its tensor or
+  // with the error that prevented it, and `done` is called after all of
+  // them with the first error, if any.
+  //
+  // The default implementation issues one RecvTensorAsync() per request.
+  virtual void RecvTensorBatchAsync(
+      CallOptions* opts, const RecvTensorBatchRequest* request,
+      std::vector<TensorResponse*>* responses,
+      std::function<void(int, const Status&)> received, StatusCallback done) {
+    struct BatchState {
+      explicit BatchState(int n) : num_pending(n), call_opts(n) {}
+      mutex mu;
+      int num_pending GUARDED_BY(mu);
+      Status status GUARDED_BY(mu);
+      std::vector<CallOptions> call_opts;
+    };
+    const int num_requests = request->request_size();
+    if (num_requests == 0) {
+      done(Status::OK());
+      return;
+    }
+    BatchState* state = new BatchState(num_requests);
+    opts->SetCancelCallback([state]() {
+      for (CallOptions& call_opts : state->call_opts) {
+        call_opts.StartCancel();
+      }
+    });
+    for (int i = 0; i < num_requests; ++i) {
+      RecvTensorAsync(&state->call_opts[i], &request->request(i),
+                      (*responses)[i],
+                      [opts, state, i, received, done](const Status& s) {
+                        received(i, s);
+                        Status status;
+                        {
+                          mutex_lock l(state->mu);
+                          state->status.Update(s);
+                          if (--state->num_pending > 0) return;
+                          status = state->status;
+                        }
+                        opts->ClearCancelCallback();
+                        delete state;
+                        done(status);
+                      });
+    }
+  }
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
@@ -129,6 +180,14 @@ class WorkerInterface {
                                     GetStepSequenceResponse* response,
                                     StatusCallback done) = 0;
 
+  // Gets the next elements of a shared iterator on the worker.
+  virtual void GetDatasetElementsAsync(CallOptions* opts,
+                                       const GetDatasetElementsRequest* request,
+                                       GetDatasetElementsResponse* response,
+                                       StatusCallback done) {
+    done(errors::Unimplemented("GetDatasetElements is not supported"));
+  }
+
   Status GetStatus(const GetStatusRequest* request,
                    GetStatusResponse* response) {
     return CallAndWait(&ME::GetStatusAsync, request, response);
@@ -39,6 +39,9 @@ CollInstanceParams& CollInstanceParams::operator=(
     device_names.assign(other.device_names.begin(), other.device_names.end());
     task_names.assign(other.task_names.begin(), other.task_names.end());
     same_num_devices_per_task = other.same_num_devices_per_task;
+    compression = other.compression;
+    top_k_fraction = other.top_k_fraction;
+    implementation = other.implementation;
     impl_details.subdiv_offsets.assign(
         other.impl_details.subdiv_offsets.begin(),
         other.impl_details.subdiv_offsets.end());
@@ -57,7 +60,9 @@ CollInstanceParams& CollInstanceParams::operator=(
 string CollInstanceParams::ToString() const {
   string v = strings::StrCat("CollInstanceParams { instance_key=", instance_key,
                              " type=", type, " data_type=", data_type,
-                             " shape=", shape.DebugString(), " devices {");
+                             " shape=", shape.DebugString(),
+                             " compression=", compression,
+                             " implementation=", implementation, " devices {");
   for (const auto& d : device_names) {
     strings::StrAppend(&v, d, ",");
   }
@@ -43,6 +43,26 @@ enum CollectiveType {
   UNDEFINED_COLLECTIVE,
 };
 
+// Lossy encodings of the values that peers exchange in a reduction.
+enum CollectiveCompression {
+  NO_COMPRESSION = 0,
+  // Values are sent as float16.
+  FP16_COMPRESSION,
+  // Only the largest magnitude values are sent, and what is left out is
+  // added back into the next execution of the same instance.
+  TOP_K_COMPRESSION,
+};
+
+// Algorithms that carry out a reduction.
+enum CollectiveImplementation {
+  // RingReducer (or HierarchicalReducer), moving data with
+  // CollectiveRemoteAccess.
+  RING_IMPLEMENTATION = 0,
+  // NCCL all-reduce, registered by contrib/nccl. All devices of the group
+  // must be GPUs of a single task.
+  NCCL_IMPLEMENTATION,
+};
+
 // Data common to all members of a device group.
 // All members share the same device set but its order is
 // particular to an instance so it is stored there.
@@ -83,6 +103,12 @@ struct CollInstanceParams {
   std::vector<string> task_names;
   // True if every task has the same number of devices.
   bool same_num_devices_per_task = false;
+  // Reduction only: encoding of the values sent between devices.
+  CollectiveCompression compression = NO_COMPRESSION;
+  // TOP_K_COMPRESSION only: fraction of the values of a chunk to send.
+  float top_k_fraction = 0.01;
+  // Reduction only: the algorithm to use.
+  CollectiveImplementation implementation = RING_IMPLEMENTATION;
   CollImplDetails impl_details;
   string ToString() const;
   CollInstanceParams& operator=(const struct CollInstanceParams& other);
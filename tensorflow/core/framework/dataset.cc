@@ -239,6 +239,34 @@ Status StoreDatasetInVariantTensor(DatasetBase* dataset, Tensor* tensor) {
   return Status::OK();
 }
 
+namespace {
+
+SharedIteratorGetNextFn* GetSharedIteratorGetNextFn() {
+  static SharedIteratorGetNextFn* fn = new SharedIteratorGetNextFn;
+  return fn;
+}
+
+}  // namespace
+
+Status SharedIteratorGetNext(
+    ResourceMgr* resource_mgr, DeviceBase* device,
+    std::function<void(std::function<void()>)> runner,
+    const string& container, const string& shared_name,
+    std::vector<Tensor>* out_tensors, bool* end_of_sequence) {
+  const SharedIteratorGetNextFn& fn = *GetSharedIteratorGetNextFn();
+  if (!fn) {
+    return errors::Unimplemented(
+        "Shared iterators can't be read: the iterator kernels are not linked "
+        "in.");
+  }
+  return fn(resource_mgr, device, std::move(runner), container, shared_name,
+            out_tensors, end_of_sequence);
+}
+
+void RegisterSharedIteratorGetNext(SharedIteratorGetNextFn fn) {
+  *GetSharedIteratorGetNextFn() = std::move(fn);
+}
+
 void DatasetOpKernel::Compute(OpKernelContext* ctx) {
   DatasetBase* dataset = nullptr;
   MakeDataset(ctx, &dataset);
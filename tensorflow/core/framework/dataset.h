@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset_stateful_op_whitelist.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/iterator_performance_model.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -275,6 +276,9 @@ class IteratorContext {
 
     // The Allocator to be used to allocate the output of an iterator.
     std::function<Allocator*(AllocatorAttributes)> allocator_getter = nullptr;
+
+    // If set, iterators record their performance into this model.
+    std::shared_ptr<IteratorPerformanceModel> performance_model = nullptr;
   };
 
   explicit IteratorContext(Params params) : params_(std::move(params)) {}
@@ -313,6 +317,15 @@ class IteratorContext {
     return params_.stats_aggregator_getter;
   }
 
+  IteratorPerformanceModel* performance_model() const {
+    return params_.performance_model.get();
+  }
+
+  void set_performance_model(
+      std::shared_ptr<IteratorPerformanceModel> performance_model) {
+    params_.performance_model = std::move(performance_model);
+  }
+
  private:
   Params params_;
 };
@@ -522,7 +535,9 @@ class DatasetIterator : public IteratorBase {
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) final {
     tracing::ScopedActivity activity(params_.prefix);
+    ScopedGetNextTimer timer(PerformanceNode(ctx));
     Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
+    if (s.ok() && !*end_of_sequence) timer.RecordElement();
     if (TF_PREDICT_FALSE(errors::IsOutOfRange(s) && !*end_of_sequence)) {
       s = errors::Internal(
           "Iterator \"", params_.prefix,
@@ -549,8 +564,38 @@ class DatasetIterator : public IteratorBase {
     return strings::StrCat(prefix(), ":", name);
   }
 
+  // For iterators that hand out elements their input produces on another
+  // thread: records that the current GetNextInternal() call blocked for
+  // "wait_micros" waiting for the producer. The performance model counts
+  // this as wait time rather than as self time of this iterator.
+  void RecordBufferWait(int64 wait_micros) {
+    ScopedGetNextTimer::RecordWait(wait_micros);
+  }
+
+  // Records that the current GetNextInternal() call found "size" elements
+  // buffered, out of "capacity".
+  void RecordBufferOccupancy(int64 size, int64 capacity) {
+    ScopedGetNextTimer::RecordBufferOccupancy(size, capacity);
+  }
+
  private:
+  // Returns the node of this iterator in the context's performance model, or
+  // nullptr if the context has none.
+  IteratorPerformanceModel::Node* PerformanceNode(IteratorContext* ctx) {
+    IteratorPerformanceModel* model = ctx->performance_model();
+    if (TF_PREDICT_TRUE(model == nullptr)) return nullptr;
+    IteratorPerformanceModel::Node* node =
+        performance_node_.load(std::memory_order_acquire);
+    if (node == nullptr) {
+      node = model->GetOrCreateNode(params_.prefix);
+      performance_node_.store(node, std::memory_order_release);
+    }
+    return node;
+  }
+
   Params params_;
+  // Cached result of PerformanceNode().
+  std::atomic<IteratorPerformanceModel::Node*> performance_node_{nullptr};
 };
 
 // Encapsulates the work required to plug a DatasetBase into the core TensorFlow
@@ -619,6 +664,25 @@ Status GetDatasetFromVariantTensor(const Tensor& tensor,
 // The ownership of `dataset` is transferred to `tensor`.
 Status StoreDatasetInVariantTensor(DatasetBase* dataset, Tensor* tensor);
 
+// Gets the next element of the iterator resource `container`/`shared_name`
+// of `resource_mgr`, the resource manager of `device`, for a consumer in
+// another process. `runner` runs the functions of the iterator. Returns
+// Unimplemented if the iterator kernels are not linked in.
+Status SharedIteratorGetNext(
+    ResourceMgr* resource_mgr, DeviceBase* device,
+    std::function<void(std::function<void()>)> runner,
+    const string& container, const string& shared_name,
+    std::vector<Tensor>* out_tensors, bool* end_of_sequence);
+
+// Registers the implementation of SharedIteratorGetNext(), which the iterator
+// kernels provide. Must be called during static initialization.
+typedef std::function<Status(ResourceMgr*, DeviceBase*,
+                             std::function<void(std::function<void()>)>,
+                             const string&, const string&, std::vector<Tensor>*,
+                             bool*)>
+    SharedIteratorGetNextFn;
+void RegisterSharedIteratorGetNext(SharedIteratorGetNextFn fn);
+
 namespace dataset {
 
 IteratorContext MakeIteratorContext(OpKernelContext* ctx);
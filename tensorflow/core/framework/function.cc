@@ -26,11 +26,13 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/util/equal_graph_def.h"
 
 namespace tensorflow {
@@ -815,6 +817,20 @@ string Canonicalize(const string& funcname, AttrSlice attrs,
     entries.push_back(
         strings::StrCat("_state_handle", "=", options.state_handle));
   }
+  for (const auto& p : options.const_args) {
+    // Keys the value by a fingerprint of its contents, which may be large.
+    TensorProto proto;
+    p.second.AsProtoTensorContent(&proto);
+    const Fprint128 fp = Fingerprint128(proto.SerializeAsString());
+    entries.push_back(
+        strings::StrCat("_const_arg_", p.first, "=",
+                        strings::Hex(fp.high64, strings::ZERO_PAD_16),
+                        strings::Hex(fp.low64, strings::ZERO_PAD_16)));
+  }
+  for (const auto& p : options.arg_shapes) {
+    entries.push_back(strings::StrCat("_arg_shape_", p.first, "=",
+                                      p.second.DebugString()));
+  }
   std::sort(entries.begin(), entries.end());
   return strings::StrCat(funcname, "[", str_util::Join(entries, ","), "]");
 }
@@ -874,6 +890,16 @@ Status FunctionCallFrame::ConsumeRetvals(std::vector<Tensor>* rets) {
   return Status::OK();
 }
 
+void FunctionCallFrame::Reset() {
+  for (Tensor& arg : args_) {
+    arg = Tensor();
+  }
+  for (Retval& ret : rets_) {
+    ret.has_val = false;
+    ret.val = Tensor();
+  }
+}
+
 Status FunctionCallFrame::GetArg(int index, Tensor* val) const {
   if (index < 0 || static_cast<size_t>(index) >= args_.size()) {
     return errors::InvalidArgument("GetArg ", index, " is not within [0, ",
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_FRAMEWORK_FUNCTION_H_
 #define TENSORFLOW_FRAMEWORK_FUNCTION_H_
 
+#include <map>
 #include <vector>
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/attr_value_util.h"
@@ -263,6 +264,10 @@ class FunctionCallFrame : public CallFrameInterface {
   Status GetRetvals(std::vector<Tensor>* rets) const;
   Status ConsumeRetvals(std::vector<Tensor>* rets);
 
+  // Releases the arguments and return values, so that the frame can be used
+  // for another call.
+  void Reset();
+
   size_t num_args() const override { return arg_types_.size(); }
   size_t num_retvals() const override { return ret_types_.size(); }
 
@@ -450,6 +455,23 @@ class FunctionLibraryRuntime {
     // state (in stateful kernels); and two functions with different
     // values for `state_handle` will have independent state.
     string state_handle;
+
+    // This interface is EXPERIMENTAL and subject to change.
+    //
+    // The values of arguments that are known at instantiation time, by
+    // argument index. The runtime specializes the function body on them:
+    // the arguments become constants, which constant folding propagates
+    // through the body. The values passed for these arguments when running
+    // the instantiated function are ignored.
+    std::map<int, Tensor> const_args;
+
+    // This interface is EXPERIMENTAL and subject to change.
+    //
+    // The shapes of arguments that are known at instantiation time, by
+    // argument index. The runtime uses them to fold shape computations in
+    // the function body, so the instantiated function must only be run with
+    // arguments of these shapes.
+    std::map<int, PartialTensorShape> arg_shapes;
   };
   typedef uint64 Handle;
   virtual Status Instantiate(const string& function_name, AttrSlice attrs,
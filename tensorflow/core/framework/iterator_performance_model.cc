@@ -0,0 +1,161 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/iterator_performance_model.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/stats_aggregator.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The innermost active timer of each thread.
+thread_local ScopedGetNextTimer* current_timer = nullptr;
+
+int Depth(const string& name) {
+  return str_util::Split(name, "::").size() - 1;
+}
+
+}  // namespace
+
+void IteratorPerformanceModel::Node::RecordGetNext(bool produced_element,
+                                                   int64 self_micros,
+                                                   int64 wait_micros) {
+  num_calls_.fetch_add(1, std::memory_order_relaxed);
+  if (produced_element) num_elements_.fetch_add(1, std::memory_order_relaxed);
+  self_micros_.fetch_add(self_micros, std::memory_order_relaxed);
+  if (wait_micros > 0) {
+    wait_micros_.fetch_add(wait_micros, std::memory_order_relaxed);
+  }
+}
+
+void IteratorPerformanceModel::Node::RecordBufferOccupancy(int64 size,
+                                                           int64 capacity) {
+  if (capacity <= 0) return;
+  num_occupancy_samples_.fetch_add(1, std::memory_order_relaxed);
+  occupancy_sum_.fetch_add(std::min(size, capacity) * 1000000 / capacity,
+                           std::memory_order_relaxed);
+}
+
+double IteratorPerformanceModel::Node::average_occupancy() const {
+  const int64 samples = num_occupancy_samples_.load();
+  if (samples == 0) return -1;
+  return occupancy_sum_.load() / 1e6 / samples;
+}
+
+IteratorPerformanceModel::Node* IteratorPerformanceModel::GetOrCreateNode(
+    const string& name) {
+  mutex_lock l(mu_);
+  std::unique_ptr<Node>& node = nodes_[name];
+  if (node == nullptr) node.reset(new Node(name));
+  return node.get();
+}
+
+string IteratorPerformanceModel::Bottleneck() {
+  mutex_lock l(mu_);
+  const Node* bottleneck = nullptr;
+  for (const auto& pair : nodes_) {
+    const Node* node = pair.second.get();
+    if (node->self_micros() > 0 &&
+        (bottleneck == nullptr ||
+         node->self_micros() > bottleneck->self_micros())) {
+      bottleneck = node;
+    }
+  }
+  return bottleneck == nullptr ? "" : bottleneck->name();
+}
+
+string IteratorPerformanceModel::Summary() {
+  const string bottleneck = Bottleneck();
+  string result = strings::Printf("%-50s %10s %12s %12s %10s\n", "iterator",
+                                  "elements", "self us/elem", "wait us/elem",
+                                  "occupancy");
+  mutex_lock l(mu_);
+  // Prefixes sort parents before their children.
+  for (const auto& pair : nodes_) {
+    const Node& node = *pair.second;
+    const int64 elements = std::max<int64>(1, node.num_elements());
+    const string indented =
+        strings::StrCat(string(2 * Depth(node.name()), ' '), node.name());
+    const double occupancy = node.average_occupancy();
+    strings::Appendf(
+        &result, "%-50s %10lld %12.1f %12.1f %10s%s\n", indented.c_str(),
+        static_cast<long long>(node.num_elements()),
+        static_cast<double>(node.self_micros()) / elements,
+        static_cast<double>(node.wait_micros()) / elements,
+        occupancy < 0 ? "-" : strings::Printf("%.2f", occupancy).c_str(),
+        node.name() == bottleneck ? "  <-- bottleneck" : "");
+  }
+  strings::StrAppend(&result, "Bottleneck: ",
+                     bottleneck.empty() ? "(none recorded)" : bottleneck,
+                     "\n");
+  return result;
+}
+
+void IteratorPerformanceModel::ExportTo(StatsAggregator* stats_aggregator) {
+  mutex_lock l(mu_);
+  for (const auto& pair : nodes_) {
+    const Node& node = *pair.second;
+    const int64 elements = std::max<int64>(1, node.num_elements());
+    stats_aggregator->AddScalar(
+        strings::StrCat(node.name(), "::self_time_per_element_usecs"),
+        static_cast<float>(node.self_micros()) / elements);
+    stats_aggregator->AddScalar(
+        strings::StrCat(node.name(), "::wait_time_per_element_usecs"),
+        static_cast<float>(node.wait_micros()) / elements);
+    const double occupancy = node.average_occupancy();
+    if (occupancy >= 0) {
+      stats_aggregator->AddScalar(
+          strings::StrCat(node.name(), "::buffer_occupancy"), occupancy);
+    }
+  }
+}
+
+ScopedGetNextTimer::ScopedGetNextTimer(IteratorPerformanceModel::Node* node)
+    : node_(node) {
+  if (node_ == nullptr) return;
+  parent_ = current_timer;
+  current_timer = this;
+  start_micros_ = Env::Default()->NowMicros();
+}
+
+ScopedGetNextTimer::~ScopedGetNextTimer() {
+  if (node_ == nullptr) return;
+  const int64 elapsed_micros = Env::Default()->NowMicros() - start_micros_;
+  node_->RecordGetNext(
+      produced_element_,
+      std::max<int64>(0, elapsed_micros - nested_micros_ - wait_micros_),
+      wait_micros_);
+  current_timer = parent_;
+  if (parent_ != nullptr) parent_->nested_micros_ += elapsed_micros;
+}
+
+void ScopedGetNextTimer::RecordWait(int64 wait_micros) {
+  if (current_timer != nullptr) current_timer->wait_micros_ += wait_micros;
+}
+
+void ScopedGetNextTimer::RecordBufferOccupancy(int64 size, int64 capacity) {
+  if (current_timer != nullptr) {
+    current_timer->node_->RecordBufferOccupancy(size, capacity);
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,137 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_ITERATOR_PERFORMANCE_MODEL_H_
+#define TENSORFLOW_CORE_FRAMEWORK_ITERATOR_PERFORMANCE_MODEL_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class StatsAggregator;
+
+// Accumulates where the iterators of one input pipeline spend their time.
+//
+// There is one node per iterator, named by the iterator's prefix (e.g.
+// "Iterator::Prefetch::ParallelMap"), so the prefixes also give the shape of
+// the tree. `DatasetIterator::GetNext()` fills in the nodes automatically
+// when the `IteratorContext` carries a model:
+//
+// * The self time of a node is the time spent in its GetNext() calls, less
+//   the time spent in nested GetNext() calls of other iterators on the same
+//   thread, and less any wait time.
+// * The wait time of a node is the time its GetNext() blocked waiting for
+//   elements that its input produces on another thread (see
+//   `DatasetIterator::RecordBufferWait()`). It is a symptom of a slow
+//   subtree, not a cost of the node itself.
+// * Buffering iterators also sample their buffer occupancy.
+//
+// The bottleneck is the node with the largest total self time: the stage
+// that keeps its thread busiest.
+//
+// IteratorPerformanceModel is thread safe.
+class IteratorPerformanceModel {
+ public:
+  // Statistics of one iterator. Updates are lock-free.
+  class Node {
+   public:
+    explicit Node(const string& name) : name_(name) {}
+
+    const string& name() const { return name_; }
+
+    void RecordGetNext(bool produced_element, int64 self_micros,
+                       int64 wait_micros);
+    void RecordBufferOccupancy(int64 size, int64 capacity);
+
+    int64 num_elements() const { return num_elements_.load(); }
+    int64 self_micros() const { return self_micros_.load(); }
+    int64 wait_micros() const { return wait_micros_.load(); }
+    // Average fraction of the buffer that was full, or -1 if not sampled.
+    double average_occupancy() const;
+
+   private:
+    const string name_;
+    std::atomic<int64> num_calls_{0};
+    std::atomic<int64> num_elements_{0};
+    std::atomic<int64> self_micros_{0};
+    std::atomic<int64> wait_micros_{0};
+    std::atomic<int64> num_occupancy_samples_{0};
+    // Sum of size / capacity, in millionths.
+    std::atomic<int64> occupancy_sum_{0};
+
+    TF_DISALLOW_COPY_AND_ASSIGN(Node);
+  };
+
+  IteratorPerformanceModel() {}
+
+  // Returns the node named "name", creating it if needed. The node lives as
+  // long as the model.
+  Node* GetOrCreateNode(const string& name);
+
+  // Returns the name of the bottleneck node, or "" if nothing was recorded.
+  string Bottleneck();
+
+  // Returns a human-readable table of every node, indented by depth in the
+  // tree, that ends with the bottleneck.
+  string Summary();
+
+  // Adds the statistics of every node to "stats_aggregator" as scalars named
+  // "<node name>::self_time_per_element_usecs" and so on.
+  void ExportTo(StatsAggregator* stats_aggregator);
+
+ private:
+  mutex mu_;
+  std::map<string, std::unique_ptr<Node>> nodes_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IteratorPerformanceModel);
+};
+
+// Times one GetNext() call of "node" on the calling thread. Time that
+// nested timers on the same thread measure is attributed to their nodes
+// instead. A null "node" makes the timer a no-op.
+class ScopedGetNextTimer {
+ public:
+  explicit ScopedGetNextTimer(IteratorPerformanceModel::Node* node);
+  ~ScopedGetNextTimer();
+
+  // Marks the call as having produced an element.
+  void RecordElement() { produced_element_ = true; }
+
+  // Record into the innermost active timer of the calling thread, if any.
+  static void RecordWait(int64 wait_micros);
+  static void RecordBufferOccupancy(int64 size, int64 capacity);
+
+ private:
+  IteratorPerformanceModel::Node* const node_;
+  ScopedGetNextTimer* parent_ = nullptr;
+  int64 start_micros_ = 0;
+  int64 nested_micros_ = 0;
+  int64 wait_micros_ = 0;
+  bool produced_element_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedGetNextTimer);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_ITERATOR_PERFORMANCE_MODEL_H_
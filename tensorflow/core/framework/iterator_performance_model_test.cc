@@ -0,0 +1,87 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/iterator_performance_model.h"
+
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(IteratorPerformanceModelTest, NestedTimersSplitSelfTime) {
+  IteratorPerformanceModel model;
+  IteratorPerformanceModel::Node* root = model.GetOrCreateNode("Iterator::Map");
+  IteratorPerformanceModel::Node* input =
+      model.GetOrCreateNode("Iterator::Map::Range");
+  EXPECT_EQ(root, model.GetOrCreateNode("Iterator::Map"));
+  for (int i = 0; i < 3; ++i) {
+    ScopedGetNextTimer outer(root);
+    Env::Default()->SleepForMicroseconds(1000);
+    {
+      ScopedGetNextTimer inner(input);
+      Env::Default()->SleepForMicroseconds(20000);
+      inner.RecordElement();
+    }
+    outer.RecordElement();
+  }
+  EXPECT_EQ(3, root->num_elements());
+  EXPECT_EQ(3, input->num_elements());
+  EXPECT_GE(input->self_micros(), 60000);
+  EXPECT_GT(input->self_micros(), root->self_micros());
+  EXPECT_EQ("Iterator::Map::Range", model.Bottleneck());
+}
+
+TEST(IteratorPerformanceModelTest, WaitIsNotSelfTime) {
+  IteratorPerformanceModel model;
+  IteratorPerformanceModel::Node* node =
+      model.GetOrCreateNode("Iterator::Prefetch");
+  {
+    ScopedGetNextTimer timer(node);
+    Env::Default()->SleepForMicroseconds(10000);
+    ScopedGetNextTimer::RecordWait(10000);
+    ScopedGetNextTimer::RecordBufferOccupancy(1, 4);
+    ScopedGetNextTimer::RecordBufferOccupancy(3, 4);
+    timer.RecordElement();
+  }
+  EXPECT_EQ(10000, node->wait_micros());
+  EXPECT_LT(node->self_micros(), 10000);
+  EXPECT_DOUBLE_EQ(0.5, node->average_occupancy());
+}
+
+TEST(IteratorPerformanceModelTest, NullNodeIsNoOp) {
+  ScopedGetNextTimer timer(nullptr);
+  ScopedGetNextTimer::RecordWait(10);
+  ScopedGetNextTimer::RecordBufferOccupancy(1, 2);
+  timer.RecordElement();
+}
+
+TEST(IteratorPerformanceModelTest, Summary) {
+  IteratorPerformanceModel model;
+  EXPECT_EQ("", model.Bottleneck());
+  model.GetOrCreateNode("Iterator::Batch")->RecordGetNext(true, 10, 0);
+  model.GetOrCreateNode("Iterator::Batch::TFRecord")
+      ->RecordGetNext(true, 500, 0);
+  const string summary = model.Summary();
+  EXPECT_TRUE(str_util::StrContains(summary, "  Iterator::Batch::TFRecord"))
+      << summary;
+  EXPECT_TRUE(
+      str_util::StrContains(summary, "Bottleneck: Iterator::Batch::TFRecord"))
+      << summary;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -103,6 +103,7 @@ void ResourceMgr::Clear() {
     delete p.second;
   }
   containers_.clear();
+  generation_.fetch_add(1, std::memory_order_release);
 }
 
 string ResourceMgr::DebugString() const {
@@ -187,6 +188,7 @@ Status ResourceMgr::DoDelete(const string& container, uint64 type_hash_code,
     }
     base = iter->second;
     b->erase(iter);
+    generation_.fetch_add(1, std::memory_order_release);
   }
   CHECK(base != nullptr);
   base->Unref();
@@ -214,6 +216,7 @@ Status ResourceMgr::Cleanup(const string& container) {
     }
     b = iter->second;
     containers_.erase(iter);
+    generation_.fetch_add(1, std::memory_order_release);
   }
   CHECK(b != nullptr);
   for (const auto& p : *b) {
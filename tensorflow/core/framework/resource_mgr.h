@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <atomic>
 #include <string>
 #include <typeindex>
 #include <typeinfo>
@@ -157,6 +158,12 @@ class ResourceMgr {
   // Deletes all resources in all containers.
   void Clear();
 
+  // Returns a number that changes whenever a resource is deleted from *this,
+  // so that the result of a lookup stays valid while it doesn't change.
+  uint64 generation() const {
+    return generation_.load(std::memory_order_acquire);
+  }
+
   // Returns a text description for all resources.
   string DebugString() const;
 
@@ -177,6 +184,7 @@ class ResourceMgr {
   const string default_container_;
   mutable mutex mu_;
   std::unordered_map<string, Container*> containers_ GUARDED_BY(mu_);
+  std::atomic<uint64> generation_{0};
 
   template <typename T>
   Status LookupInternal(const string& container, const string& name,
@@ -246,6 +254,35 @@ Status CreateResource(OpKernelContext* ctx, const ResourceHandle& p, T* value);
 template <typename T>
 Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p, T** value);
 
+// Remembers the resource looked up last through it, so that looking up the
+// same handle again skips the lock and the maps of the ResourceMgr. The cache
+// holds a reference to the resource, and is invalidated by any deletion from
+// the ResourceMgr, so a deleted resource is released by the next lookup or
+// when the cache is destroyed. Kernels that look up a resource on every
+// step, such as ReadVariableOp, keep one of these.
+//
+// This class is thread-safe.
+template <typename T>
+class ResourceLookupCache {
+ public:
+  ResourceLookupCache() {}
+  ~ResourceLookupCache() {
+    if (resource_ != nullptr) resource_->Unref();
+  }
+
+  // Same as LookupResource(ctx, p, value).
+  Status Lookup(OpKernelContext* ctx, const ResourceHandle& p, T** value);
+
+ private:
+  mutex mu_;
+  const ResourceMgr* resource_mgr_ GUARDED_BY(mu_) = nullptr;
+  uint64 generation_ GUARDED_BY(mu_) = 0;
+  ResourceHandle handle_ GUARDED_BY(mu_);
+  T* resource_ GUARDED_BY(mu_) = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ResourceLookupCache);
+};
+
 // Looks up or creates a resource.
 template <typename T>
 Status LookupOrCreateResource(OpKernelContext* ctx, const ResourceHandle& p,
@@ -496,6 +533,35 @@ Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
   return ctx->resource_manager()->Lookup(p.container(), p.name(), value);
 }
 
+template <typename T>
+Status ResourceLookupCache<T>::Lookup(OpKernelContext* ctx,
+                                      const ResourceHandle& p, T** value) {
+  ResourceMgr* resource_mgr = ctx->resource_manager();
+  // Read before the lookup, so that a deletion racing with it invalidates
+  // the cached resource.
+  const uint64 generation = resource_mgr->generation();
+  {
+    tf_shared_lock l(mu_);
+    if (resource_ != nullptr && resource_mgr_ == resource_mgr &&
+        generation_ == generation && handle_.hash_code() == p.hash_code() &&
+        handle_.name() == p.name() && handle_.container() == p.container() &&
+        handle_.device() == p.device()) {
+      resource_->Ref();
+      *value = resource_;
+      return Status::OK();
+    }
+  }
+  TF_RETURN_IF_ERROR(LookupResource(ctx, p, value));
+  mutex_lock l(mu_);
+  if (resource_ != nullptr) resource_->Unref();
+  resource_ = *value;
+  resource_->Ref();
+  resource_mgr_ = resource_mgr;
+  generation_ = generation;
+  handle_ = p;
+  return Status::OK();
+}
+
 template <typename T>
 Status LookupOrCreateResource(OpKernelContext* ctx, const ResourceHandle& p,
                               T** value, std::function<Status(T**)> creator) {
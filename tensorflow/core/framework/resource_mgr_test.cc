@@ -347,4 +347,43 @@ TEST(ResourceHandleTest, DeleteUsingResourceHandle) {
   r->Unref();
 }
 
+TEST(ResourceHandleTest, LookupCache) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p = MakeResourceHandle<StubResource>(&ctx, "container", "a");
+  ResourceHandle q = MakeResourceHandle<StubResource>(&ctx, "container", "b");
+  StubResource* a = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, p, a));
+  StubResource* b = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, q, b));
+
+  ResourceLookupCache<StubResource> cache;
+  StubResource* r = nullptr;
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &r));
+  EXPECT_EQ(a, r);
+  r->Unref();
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &r));
+  EXPECT_EQ(a, r);
+  r->Unref();
+  TF_ASSERT_OK(cache.Lookup(&ctx, q, &r));
+  EXPECT_EQ(b, r);
+  r->Unref();
+
+  // A deleted resource is no longer returned, even if it is still cached.
+  TF_ASSERT_OK(DeleteResource<StubResource>(&ctx, q));
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup(&ctx, q, &r)));
+  StubResource* c = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, q, c));
+  TF_ASSERT_OK(cache.Lookup(&ctx, q, &r));
+  EXPECT_EQ(c, r);
+  r->Unref();
+  TF_ASSERT_OK(resource_mgr.Cleanup("container"));
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup(&ctx, p, &r)));
+}
+
 }  // end namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <atomic>
+
 #include "tensorflow/core/framework/resource_mgr.h"
 
 namespace tensorflow {
@@ -33,6 +35,53 @@ class Var : public ResourceBase {
   mutex* mu() { return &mu_; }
   Tensor* tensor() { return &tensor_; }
 
+  // Non-blocking reads: while an update holds mu() exclusively, a reader can
+  // get the snapshot, the value left by the last completed update, instead
+  // of waiting. Once a reader calls EnableSnapshot(), every update calls
+  // PublishSnapshot() before it releases mu(). The snapshot holds a
+  // reference to the buffer of tensor(), so an update that modifies the
+  // buffer in place must copy it first while SnapshotSharesBuffer() (see
+  // PrepareToUpdateVariable()). Updates without the exclusive lock (e.g.
+  // use_locking=false) are not atomic, and neither is what they publish.
+
+  // Starts keeping a snapshot, initialized to the current value.
+  // REQUIRES: mu() is held, shared or exclusively.
+  void EnableSnapshot() {
+    mutex_lock l(snapshot_mu_);
+    if (snapshot_enabled()) return;
+    snapshot_ = tensor_;
+    snapshot_enabled_.store(true, std::memory_order_release);
+  }
+
+  bool snapshot_enabled() const {
+    return snapshot_enabled_.load(std::memory_order_acquire);
+  }
+
+  // Makes the current value the snapshot. Does nothing until
+  // EnableSnapshot() is called.
+  // REQUIRES: mu() is held exclusively, and the update is complete.
+  void PublishSnapshot() {
+    if (!snapshot_enabled()) return;
+    mutex_lock l(snapshot_mu_);
+    snapshot_ = tensor_;
+  }
+
+  // REQUIRES: mu() is held.
+  bool SnapshotSharesBuffer() {
+    if (!snapshot_enabled()) return false;
+    tf_shared_lock l(snapshot_mu_);
+    return snapshot_.IsInitialized() && snapshot_.SharesBufferWith(tensor_);
+  }
+
+  // Returns false if there is no snapshot.
+  bool ReadSnapshot(Tensor* value) {
+    if (!snapshot_enabled()) return false;
+    tf_shared_lock l(snapshot_mu_);
+    if (!snapshot_.IsInitialized()) return false;
+    *value = snapshot_;
+    return true;
+  }
+
   string DebugString() override {
     return strings::StrCat(DataTypeString(tensor_.dtype()), "/",
                            tensor_.shape().DebugString());
@@ -49,10 +98,26 @@ class Var : public ResourceBase {
  private:
   mutex mu_;
   Tensor tensor_;
+  mutex snapshot_mu_;
+  Tensor snapshot_ GUARDED_BY(snapshot_mu_);
+  std::atomic<bool> snapshot_enabled_{false};
 
   ~Var() override {}
 };
 
+// Calls var->PublishSnapshot() when it goes out of scope. Declare it after
+// the lock on var->mu(), so that it runs before the lock is released.
+class ScopedPublishSnapshot {
+ public:
+  explicit ScopedPublishSnapshot(Var* var) : var_(var) {}
+  ~ScopedPublishSnapshot() { var_->PublishSnapshot(); }
+
+ private:
+  Var* const var_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedPublishSnapshot);
+};
+
 }  //  end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
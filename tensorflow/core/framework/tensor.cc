@@ -23,6 +23,10 @@ limitations under the License.
 //   default constructors and destructors when T is not a simple type
 //   (e.g., string.), and skips them otherwise.
 //
+// * InlineBuffer<T>: a T[n] of at most kMaxInlineTensorBytes stored inside
+//   the TensorBuffer object itself, used for tiny tensors of simple types
+//   that would otherwise cost two allocations.
+//
 // * Helper<T>: provides various routines given type T.  The routines
 //   includes running the constructor and destructor of T[], encoding
 //   an decoding T[] into/from a Cord, etc.
@@ -48,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -114,6 +119,56 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Tensors created without an explicit allocator whose data fits in this many
+// bytes (e.g. scalars and small shape vectors) are stored in an InlineBuffer.
+constexpr int64 kMaxInlineTensorBytes = 16;
+
+// Typed ref-counted buffer T[n] whose data lives in the buffer object, so
+// that a tiny tensor needs a single allocation. Only used for simple types,
+// whose elements need no construction or destruction.
+template <typename T>
+class InlineBuffer : public TensorBuffer {
+ public:
+  explicit InlineBuffer(int64 n) : elem_(n) {
+    DCHECK_LE(static_cast<int64>(sizeof(T)) * n, kMaxInlineTensorBytes);
+  }
+
+  void* data() const override { return const_cast<char*>(data_); }
+  size_t size() const override { return sizeof(T) * elem_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name(cpu_allocator()->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+    if (RefCountIsOne()) {
+      proto->set_has_single_reference(true);
+    }
+  }
+
+  // The data must be as aligned as buffers from the allocators are.
+  static void* operator new(size_t size) {
+    return port::AlignedMalloc(size, EIGEN_MAX_ALIGN_BYTES);
+  }
+  static void operator delete(void* ptr) { port::AlignedFree(ptr); }
+
+ private:
+  ~InlineBuffer() override {}
+
+  const int64 elem_;
+  alignas(EIGEN_MAX_ALIGN_BYTES) char data_[kMaxInlineTensorBytes];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineBuffer);
+};
+
+// Returns true if a Tensor of n elements of 'type' created without an
+// explicit allocator should use an InlineBuffer. Allocations that must show
+// up in the memory logs still go through the allocator.
+bool UseInlineBuffer(DataType type, int64 n) {
+  const int64 type_size = DataTypeCanUseMemcpy(type) ? DataTypeSize(type) : 0;
+  return n > 0 && type_size > 0 && n <= kMaxInlineTensorBytes / type_size &&
+         !LogMemory::IsEnabled();
+}
+
 void LogUnexpectedSize(int64 actual, int64 expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -746,7 +801,14 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
 }
 
 Tensor::Tensor(DataType type, const TensorShape& shape)
-    : Tensor(cpu_allocator(), type, shape) {}
+    : shape_(shape), buf_(nullptr) {
+  set_dtype(type);
+  if (UseInlineBuffer(type, shape_.num_elements())) {
+    CASES(type, buf_ = new InlineBuffer<T>(shape_.num_elements()));
+  } else {
+    *this = Tensor(cpu_allocator(), type, shape);
+  }
+}
 
 template <typename T>
 class SubBuffer : public TensorBuffer {
@@ -43,6 +43,7 @@ class TensorDescription;
 class TensorProto;
 class VariantTensorData;
 namespace batch_util {
+class BatchBufferPool;
 Status CopyElementToSlice(Tensor element, Tensor* parent, int64 index);
 Status MaybeMoveSliceToElement(Tensor* parent, Tensor* element, int64 index);
 }  // namespace batch_util
@@ -74,7 +75,12 @@ class Tensor {
   /// OpKernelConstruction/OpKernelContext allocate_* methods to
   /// allocate a new tensor, which record the kernel and step.
   ///
-  /// The underlying buffer is allocated using a `CPUAllocator`.
+  /// The underlying buffer is allocated using a `CPUAllocator`, except
+  /// that the data of a simple type that fits in 16 bytes (e.g. a scalar)
+  /// is stored in the buffer object itself. Such tensors do not show up in
+  /// the `CPUAllocator`'s statistics. They are not created while
+  /// LogMemory::IsEnabled(), so every tensor that would be logged still goes
+  /// through the allocator.
   Tensor(DataType type, const TensorShape& shape);
 
   /// \brief Creates a tensor with the input `type` and `shape`, using
@@ -501,6 +507,12 @@ class Tensor {
 
   friend class NumpyTensorBuffer;  // For access to the private constructor
                                    // taking the buffer.
+  friend class batch_util::BatchBufferPool;  // For access to the private
+                                             // constructor taking the buffer.
+  friend class BundleReader;       // For access to the private constructor
+                                   // taking the buffer.
+  friend class TensorFrame;        // For access to the private constructor
+                                   // taking the buffer.
 
   // Creates a tensor with the input datatype, shape and buf.
   //
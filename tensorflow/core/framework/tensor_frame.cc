@@ -0,0 +1,186 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/tensor_frame.h"
+
+#include <string.h>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+
+namespace tensorflow {
+
+namespace {
+
+const uint32 kMagic = 0x4d524654;  // "TFRM" in little-endian.
+
+// The header of a frame without the dimension sizes.
+const size_t kFixedHeaderSize = 3 * sizeof(uint32) + sizeof(uint64);
+
+size_t HeaderSize(int num_dims) {
+  const size_t size = kFixedHeaderSize + num_dims * sizeof(uint64);
+  return (size + TensorFrame::kAlignment - 1) / TensorFrame::kAlignment *
+         TensorFrame::kAlignment;
+}
+
+// The payload of a frame that a tensor uses in place.
+class FrameTensorBuffer : public TensorBuffer {
+ public:
+  FrameTensorBuffer(core::RefCounted* owner, const char* data, size_t size)
+      : owner_(owner), data_(data), size_(size) {
+    owner_->Ref();
+  }
+  ~FrameTensorBuffer() override { owner_->Unref(); }
+
+  void* data() const override { return const_cast<char*>(data_); }
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("tensor_frame");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  core::RefCounted* const owner_;
+  const char* const data_;
+  const size_t size_;
+};
+
+}  // namespace
+
+constexpr size_t TensorFrame::kAlignment;
+
+Status TensorFrame::EncodeHeader(const Tensor& tensor, string* header) {
+  if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+    return errors::InvalidArgument("Tensors of type ",
+                                   DataTypeString(tensor.dtype()),
+                                   " can not be framed");
+  }
+  header->clear();
+  header->reserve(HeaderSize(tensor.dims()));
+  core::PutFixed32(header, kMagic);
+  core::PutFixed32(header, tensor.dtype());
+  core::PutFixed32(header, tensor.dims());
+  for (int i = 0; i < tensor.dims(); ++i) {
+    core::PutFixed64(header, tensor.dim_size(i));
+  }
+  core::PutFixed64(header, tensor.tensor_data().size());
+  header->resize(HeaderSize(tensor.dims()), '\0');
+  return Status::OK();
+}
+
+Status TensorFrame::Append(const Tensor& tensor, string* out) {
+  string header;
+  TF_RETURN_IF_ERROR(EncodeHeader(tensor, &header));
+  const StringPiece payload = tensor.tensor_data();
+  out->reserve(out->size() + header.size() + payload.size());
+  out->append(header);
+  out->append(payload.data(), payload.size());
+  return Status::OK();
+}
+
+Status TensorFrame::DecodeHeader(StringPiece frame, DataType* dtype,
+                                 TensorShape* shape, size_t* header_size,
+                                 size_t* payload_size) {
+  if (frame.size() < kFixedHeaderSize ||
+      core::DecodeFixed32(frame.data()) != kMagic) {
+    return errors::DataLoss("Not a tensor frame");
+  }
+  const uint32 type = core::DecodeFixed32(frame.data() + sizeof(uint32));
+  const uint32 num_dims =
+      core::DecodeFixed32(frame.data() + 2 * sizeof(uint32));
+  if (!DataType_IsValid(type) || !DataTypeCanUseMemcpy(DataType(type)) ||
+      num_dims > static_cast<uint32>(TensorShape::MaxDimensions())) {
+    return errors::DataLoss("Corrupted tensor frame header");
+  }
+  *dtype = DataType(type);
+  *header_size = HeaderSize(num_dims);
+  if (frame.size() < *header_size) {
+    return errors::DataLoss("Truncated tensor frame header");
+  }
+  const char* p = frame.data() + 3 * sizeof(uint32);
+  gtl::InlinedVector<int64, 4> dims(num_dims);
+  for (uint32 i = 0; i < num_dims; ++i, p += sizeof(uint64)) {
+    dims[i] = static_cast<int64>(core::DecodeFixed64(p));
+  }
+  TF_RETURN_IF_ERROR(TensorShapeUtils::MakeShape(dims, shape));
+  *payload_size = core::DecodeFixed64(p);
+  if (*payload_size != shape->num_elements() * DataTypeSize(*dtype)) {
+    return errors::DataLoss("Tensor frame of ", *payload_size,
+                            " bytes does not hold a ", DataTypeString(*dtype),
+                            " tensor of shape ", shape->DebugString());
+  }
+  return Status::OK();
+}
+
+Status TensorFrame::FrameSize(StringPiece data, size_t* size) {
+  DataType dtype;
+  TensorShape shape;
+  size_t header_size;
+  size_t payload_size;
+  TF_RETURN_IF_ERROR(
+      DecodeHeader(data, &dtype, &shape, &header_size, &payload_size));
+  *size = header_size + payload_size;
+  return Status::OK();
+}
+
+Status TensorFrame::Decode(StringPiece frame, Allocator* allocator,
+                           Tensor* tensor) {
+  DataType dtype;
+  TensorShape shape;
+  size_t header_size;
+  size_t payload_size;
+  TF_RETURN_IF_ERROR(
+      DecodeHeader(frame, &dtype, &shape, &header_size, &payload_size));
+  if (frame.size() < header_size + payload_size) {
+    return errors::DataLoss("Truncated tensor frame");
+  }
+  Tensor decoded(allocator, dtype, shape);
+  if (payload_size > 0) {
+    memcpy(const_cast<char*>(decoded.tensor_data().data()),
+           frame.data() + header_size, payload_size);
+  }
+  *tensor = std::move(decoded);
+  return Status::OK();
+}
+
+Status TensorFrame::DecodeAliased(StringPiece frame, core::RefCounted* owner,
+                                  Tensor* tensor) {
+  if (reinterpret_cast<uintptr_t>(frame.data()) % kAlignment != 0) {
+    return errors::InvalidArgument("Tensor frame is not aligned to ",
+                                   kAlignment, " bytes");
+  }
+  DataType dtype;
+  TensorShape shape;
+  size_t header_size;
+  size_t payload_size;
+  TF_RETURN_IF_ERROR(
+      DecodeHeader(frame, &dtype, &shape, &header_size, &payload_size));
+  if (frame.size() < header_size + payload_size) {
+    return errors::DataLoss("Truncated tensor frame");
+  }
+  FrameTensorBuffer* buf =
+      new FrameTensorBuffer(owner, frame.data() + header_size, payload_size);
+  *tensor = Tensor(dtype, shape, buf);
+  buf->Unref();
+  return Status::OK();
+}
+
+}  // namespace tensorflow
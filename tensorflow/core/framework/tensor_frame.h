@@ -0,0 +1,81 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_TENSOR_FRAME_H_
+#define TENSORFLOW_CORE_FRAMEWORK_TENSOR_FRAME_H_
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Encodes tensors as frames, which unlike TensorProtos hold the bytes of the
+// tensor as they are in memory:
+//
+//   fixed32 magic
+//   fixed32 dtype
+//   fixed32 number of dimensions, n
+//   fixed64 dimension sizes[n]
+//   fixed64 payload size
+//   zero padding, up to a multiple of kAlignment bytes
+//   payload: the bytes of the tensor buffer
+//
+// Senders write the header and the payload from the tensor buffer, without
+// copying it into a message. Receivers can use the payload in place when
+// the frame is aligned, instead of copying it out of a message.
+//
+// Only tensors of types that can be memcpy'd can be framed.
+class TensorFrame {
+ public:
+  // The alignment of the payload relative to the start of the frame.
+  static constexpr size_t kAlignment = 64;
+
+  // Returns the header of the frame of "tensor", which tensor.tensor_data()
+  // follows in the frame.
+  static Status EncodeHeader(const Tensor& tensor, string* header);
+
+  // Appends the frame of "tensor" to "*out". The frame starts at the end of
+  // "*out", so it is only aligned in memory if that is.
+  static Status Append(const Tensor& tensor, string* out);
+
+  // Sets "*size" to the size of the frame that starts "data", which may hold
+  // more frames after it.
+  static Status FrameSize(StringPiece data, size_t* size);
+
+  // Decodes the frame that starts "frame" into "*tensor", copying its payload
+  // into memory from "allocator".
+  static Status Decode(StringPiece frame, Allocator* allocator, Tensor* tensor);
+
+  // Decodes the frame that starts "frame" into "*tensor", which uses the
+  // payload in place and holds a reference to "owner", the owner of the
+  // memory of the frame, for as long as it does.
+  //
+  // REQUIRES: "frame" starts at a multiple of kAlignment bytes.
+  static Status DecodeAliased(StringPiece frame, core::RefCounted* owner,
+                              Tensor* tensor);
+
+ private:
+  static Status DecodeHeader(StringPiece frame, DataType* dtype,
+                             TensorShape* shape, size_t* header_size,
+                             size_t* payload_size);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_TENSOR_FRAME_H_
@@ -0,0 +1,112 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/tensor_frame.h"
+
+#include <string.h>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Aligned memory that holds frames, and that tensors reference.
+class AlignedFrames : public core::RefCounted {
+ public:
+  explicit AlignedFrames(const string& frames) : size_(frames.size()) {
+    data_ = static_cast<char*>(
+        cpu_allocator()->AllocateRaw(TensorFrame::kAlignment, size_));
+    memcpy(data_, frames.data(), size_);
+  }
+  ~AlignedFrames() override { cpu_allocator()->DeallocateRaw(data_); }
+
+  StringPiece frames() const { return StringPiece(data_, size_); }
+
+ private:
+  char* data_;
+  const size_t size_;
+};
+
+TEST(TensorFrameTest, RoundTrip) {
+  Tensor a = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, TensorShape({2, 3}));
+  Tensor b = test::AsScalar<int64>(42);
+  Tensor c(DT_INT32, TensorShape({0, 4}));
+  string frames;
+  TF_ASSERT_OK(TensorFrame::Append(a, &frames));
+  TF_ASSERT_OK(TensorFrame::Append(b, &frames));
+  TF_ASSERT_OK(TensorFrame::Append(c, &frames));
+
+  StringPiece rest(frames);
+  for (const Tensor& expected : {a, b, c}) {
+    size_t size;
+    TF_ASSERT_OK(TensorFrame::FrameSize(rest, &size));
+    EXPECT_EQ(0, (size - expected.TotalBytes()) % TensorFrame::kAlignment);
+    Tensor decoded;
+    TF_ASSERT_OK(TensorFrame::Decode(rest, cpu_allocator(), &decoded));
+    EXPECT_EQ(expected.dtype(), decoded.dtype());
+    EXPECT_EQ(expected.shape(), decoded.shape());
+    EXPECT_EQ(expected.tensor_data(), decoded.tensor_data());
+    rest.remove_prefix(size);
+  }
+  EXPECT_TRUE(rest.empty());
+}
+
+TEST(TensorFrameTest, Aliased) {
+  Tensor a = test::AsTensor<double>({1, 2, 3, 4}, TensorShape({4}));
+  string frames;
+  TF_ASSERT_OK(TensorFrame::Append(a, &frames));
+  AlignedFrames* aligned = new AlignedFrames(frames);
+
+  Tensor decoded;
+  TF_ASSERT_OK(
+      TensorFrame::DecodeAliased(aligned->frames(), aligned, &decoded));
+  // The tensor uses the payload in place, and keeps it alive.
+  EXPECT_EQ(aligned->frames().data() + frames.size() - a.TotalBytes(),
+            decoded.tensor_data().data());
+  aligned->Unref();
+  test::ExpectTensorEqual<double>(a, decoded);
+}
+
+TEST(TensorFrameTest, HeaderAndPayload) {
+  Tensor a = test::AsTensor<int32>({7, 8, 9}, TensorShape({3}));
+  string header;
+  TF_ASSERT_OK(TensorFrame::EncodeHeader(a, &header));
+  EXPECT_EQ(TensorFrame::kAlignment, header.size());
+  string frame;
+  TF_ASSERT_OK(TensorFrame::Append(a, &frame));
+  EXPECT_EQ(frame, header + a.tensor_data().ToString());
+}
+
+TEST(TensorFrameTest, Errors) {
+  Tensor s(DT_STRING, TensorShape({1}));
+  string frame;
+  EXPECT_TRUE(errors::IsInvalidArgument(TensorFrame::Append(s, &frame)));
+
+  Tensor decoded;
+  EXPECT_TRUE(errors::IsDataLoss(
+      TensorFrame::Decode("not a frame", cpu_allocator(), &decoded)));
+
+  Tensor a = test::AsTensor<float>({1, 2, 3, 4}, TensorShape({4}));
+  TF_ASSERT_OK(TensorFrame::Append(a, &frame));
+  frame.resize(frame.size() - 1);
+  EXPECT_TRUE(errors::IsDataLoss(
+      TensorFrame::Decode(frame, cpu_allocator(), &decoded)));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -829,6 +829,34 @@ TEST(Tensor_Scalar, Basics) {
   }
 }
 
+TEST(Tensor_Scalar, SmallTensors) {
+  // Tiny tensors are stored inline in their buffer; they must behave like any
+  // other tensor.
+  for (int64 n : {1, 2, 4, 5, 16}) {
+    Tensor t(DT_FLOAT, TensorShape({n}));
+    EXPECT_TRUE(t.IsAligned());
+    EXPECT_EQ(n * sizeof(float), t.TotalBytes());
+    test::FillIota<float>(&t, 1.0f);
+
+    Tensor copy = t;
+    EXPECT_TRUE(copy.SharesBufferWith(t));
+    Tensor slice = t.Slice(n - 1, n);
+    EXPECT_FLOAT_EQ(static_cast<float>(n), slice.flat<float>()(0));
+
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    Tensor parsed;
+    ASSERT_TRUE(parsed.FromProto(proto));
+    test::ExpectTensorEqual<float>(t, parsed);
+  }
+  {
+    Tensor t(DT_COMPLEX128, TensorShape({}));
+    EXPECT_TRUE(t.IsAligned());
+    t.scalar<complex128>()() = complex128(1.0, -2.0);
+    EXPECT_EQ(complex128(1.0, -2.0), t.scalar<complex128>()());
+  }
+}
+
 TEST(Tensor_Float, Reshape_And_Slice_Assignment) {
   // A test to experiment with a way to assign to a subset of a tensor
   Tensor t(DT_FLOAT, TensorShape({10, 4, 3, 2}));
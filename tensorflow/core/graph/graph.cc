@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph.h"
 
+#include <utility>
 #include <vector>
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -35,10 +36,10 @@ const int Graph::kControlSlot = -1;
 
 class NodeProperties {
  public:
-  NodeProperties(const OpDef* op_def, const NodeDef& node_def,
+  NodeProperties(const OpDef* op_def, NodeDef node_def,
                  const DataTypeSlice inputs, const DataTypeSlice outputs)
       : op_def(op_def),
-        node_def(node_def),
+        node_def(std::move(node_def)),
         input_types(inputs.begin(), inputs.end()),
         output_types(outputs.begin(), outputs.end()) {}
 
@@ -324,23 +325,30 @@ Graph::~Graph() {
 const VersionDef& Graph::versions() const { return *versions_; }
 void Graph::set_versions(const VersionDef& versions) { *versions_ = versions; }
 
-Node* Graph::AddNode(const NodeDef& node_def, Status* status) {
+Node* Graph::AddNode(NodeDef node_def, Status* status) {
   const OpDef* op_def;
   status->Update(ops_.LookUpOpDef(node_def.op(), &op_def));
   if (!status->ok()) return nullptr;
 
+  std::shared_ptr<NodeProperties> props;
+  status->Update(MakeNodeProperties(std::move(node_def), op_def, &props));
+  if (!status->ok()) return nullptr;
+  return AddNode(std::move(props));
+}
+
+Status Graph::MakeNodeProperties(NodeDef node_def, const OpDef* op_def,
+                                 std::shared_ptr<NodeProperties>* props) {
   DataTypeVector inputs;
   DataTypeVector outputs;
-  status->Update(InOutTypesForNode(node_def, *op_def, &inputs, &outputs));
-  if (!status->ok()) {
-    *status = AttachDef(*status, node_def);
-    return nullptr;
-  }
+  Status s = InOutTypesForNode(node_def, *op_def, &inputs, &outputs);
+  if (!s.ok()) return AttachDef(s, node_def);
+  *props = std::make_shared<NodeProperties>(op_def, std::move(node_def),
+                                            inputs, outputs);
+  return Status::OK();
+}
 
-  Node* node = AllocateNode(
-      std::make_shared<NodeProperties>(op_def, node_def, inputs, outputs),
-      nullptr);
-  return node;
+Node* Graph::AddNode(std::shared_ptr<NodeProperties> props) {
+  return AllocateNode(std::move(props), nullptr);
 }
 
 Node* Graph::CopyNode(const Node* node) {
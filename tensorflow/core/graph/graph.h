@@ -422,7 +422,21 @@ class Graph {
   // Adds a new node to this graph, and returns it. Infers the Op and
   // input/output types for the node. *this owns the returned instance.
   // Returns nullptr and sets *status on error.
-  Node* AddNode(const NodeDef& node_def, Status* status);
+  //
+  // The node keeps its own copy of 'node_def'; callers that no longer need
+  // theirs should std::move() it in to avoid holding the NodeDef twice.
+  Node* AddNode(NodeDef node_def, Status* status);
+
+  // Infers the input/output types of a node with 'node_def', whose Op is
+  // 'op_def', and sets '*props' to the properties AddNode() would give it.
+  // This does not touch any graph, so it may be used to prepare many nodes in
+  // parallel.
+  static Status MakeNodeProperties(NodeDef node_def, const OpDef* op_def,
+                                   std::shared_ptr<NodeProperties>* props);
+
+  // Adds a new node with 'props', made by MakeNodeProperties() with an
+  // OpDef from this graph's op_registry(), and returns it.
+  Node* AddNode(std::shared_ptr<NodeProperties> props);
 
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
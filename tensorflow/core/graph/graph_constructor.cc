@@ -35,9 +35,12 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/public/version.h"
 
@@ -186,7 +189,15 @@ class GraphConstructor {
 
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
-  Status MakeNode(const NodeDef& node_def, Node** node);
+  // Computes the properties of the nodes of node_defs_ in parallel, if
+  // there are enough of them, leaving '*node_props' empty otherwise. An
+  // element is null if its node should be added with Graph::AddNode(NodeDef),
+  // e.g. to report an error.
+  void PrepareNodePropertiesInParallel(
+      std::vector<std::shared_ptr<NodeProperties>>* node_props);
+  // 'props' may be null.
+  Status MakeNode(const NodeDef& node_def,
+                  std::shared_ptr<NodeProperties> props, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -545,11 +556,59 @@ Status GraphConstructor::ValidateColocationConstraints(
   return Status::OK();
 }
 
-Status GraphConstructor::MakeNode(const NodeDef& node_def, Node** node) {
+void GraphConstructor::PrepareNodePropertiesInParallel(
+    std::vector<std::shared_ptr<NodeProperties>>* node_props) {
+  // Imported NodeDefs are rewritten just before their nodes are added.
+  const int kMinNodesToParallelize = 10000;
+  const int num_nodes = node_defs_.size();
+  if (opts_.importing || num_nodes < kMinNodesToParallelize) return;
+
+  // Look up each op once up front, since the op registry is locked.
+  std::unordered_map<string, const OpDef*> op_defs;
+  std::vector<const OpDef*> node_op_defs(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    auto it = op_defs.find(node_defs_[i]->op());
+    if (it == op_defs.end()) {
+      const OpDef* op_def;
+      if (!g_->op_registry()->LookUpOpDef(node_defs_[i]->op(), &op_def).ok()) {
+        op_def = nullptr;
+      }
+      it = op_defs.emplace(node_defs_[i]->op(), op_def).first;
+    }
+    node_op_defs[i] = it->second;
+  }
+
+  node_props->resize(num_nodes);
+  thread::ThreadPool pool(Env::Default(), "graph_constructor",
+                          port::NumSchedulableCPUs());
+  // Inferring the types and copying the NodeDef of a node take a few
+  // microseconds.
+  const int64 kCostPerNode = 10000;
+  pool.ParallelFor(
+      num_nodes, kCostPerNode,
+      [this, &node_op_defs, node_props](int64 begin, int64 end) {
+        for (int64 i = begin; i < end; ++i) {
+          if (node_op_defs[i] == nullptr ||
+              !Graph::MakeNodeProperties(*node_defs_[i], node_op_defs[i],
+                                         &(*node_props)[i])
+                   .ok()) {
+            (*node_props)[i].reset();
+          }
+        }
+      });
+}
+
+Status GraphConstructor::MakeNode(const NodeDef& node_def,
+                                  std::shared_ptr<NodeProperties> props,
+                                  Node** node) {
   // Add the node to the graph.
-  Status status;
-  *node = g_->AddNode(node_def, &status);
-  if (!status.ok()) return status;
+  if (props != nullptr) {
+    *node = g_->AddNode(std::move(props));
+  } else {
+    Status status;
+    *node = g_->AddNode(node_def, &status);
+    if (!status.ok()) return status;
+  }
   if (opts_.expect_device_spec) {
     (*node)->set_assigned_device_name(node_def.device());
   }
@@ -903,6 +962,9 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(g_->AddFunctionLibrary(*library_));
   }
 
+  std::vector<std::shared_ptr<NodeProperties>> node_props;
+  PrepareNodePropertiesInParallel(&node_props);
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1010,7 +1072,9 @@ Status GraphConstructor::Convert() {
       }
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&imported_node_def));
     }
-    TF_RETURN_IF_ERROR(MakeNode(*node_def, &node));
+    TF_RETURN_IF_ERROR(MakeNode(
+        *node_def, node_props.empty() ? nullptr : std::move(node_props[o]),
+        &node));
     // Use original_node_def so name StringPiece remains valid
     gdef_nodes_[original_node_def.name()].node = node;
 
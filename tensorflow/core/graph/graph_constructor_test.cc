@@ -811,6 +811,36 @@ TEST_F(GraphConstructorTest, TypeMismatch) {
        "expected int32."});
 }
 
+// Graphs this large have their nodes prepared in parallel.
+TEST_F(GraphConstructorTest, LargeGraph) {
+  const int kNumNodes = 20000;
+  GraphDef def;
+  NodeDef* input = def.add_node();
+  input->set_name("input");
+  input->set_op("TestInput");
+  for (int i = 1; i < kNumNodes; ++i) {
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestOneInputOneOutput");
+    node->add_input(i == 1 ? "input" : strings::StrCat("n", i - 1));
+    AddNodeAttr("T", DT_FLOAT, node);
+  }
+  TF_ASSERT_OK(ConvertGraphDefToGraph(GraphConstructorOptions(), def, &graph_));
+  EXPECT_EQ(kNumNodes + 2, graph_.num_nodes());
+  EXPECT_TRUE(HasEdge("input", 0, "n1", 0));
+  EXPECT_TRUE(HasEdge(strings::StrCat("n", kNumNodes - 2), 0,
+                      strings::StrCat("n", kNumNodes - 1), 0));
+
+  // Errors in preparing a node are reported when it is added.
+  def.mutable_node(kNumNodes / 2)->mutable_attr()->erase("T");
+  Graph graph(OpRegistry::Global());
+  Status s = ConvertGraphDefToGraph(GraphConstructorOptions(), def, &graph);
+  EXPECT_FALSE(s.ok());
+  EXPECT_TRUE(str_util::StrContains(
+      s.error_message(), strings::StrCat("n", kNumNodes / 2)))
+      << s;
+}
+
 TEST_F(GraphConstructorTest, EmptyGraph) {
   ExpectOK("");
   ExpectVersions(0, 0);
@@ -90,6 +90,19 @@ struct RecvInfo {
 typedef std::unordered_map<DupRecvKey, RecvInfo, DupRecvKeyHash, DupRecvKeyEq>
     DupRecvTable;
 
+// struct used to store the first recv of a tensor on a task, from which the
+// other devices of the task can receive it.
+struct TaskRecvInfo {
+  GraphDef* graph;
+  const Edge* edge;
+  NodeDef* recv;
+  NodeDef* real_recv;
+};
+
+// Maps (src node id, src output slot, dst task, recv output on host) to
+// the first recv of the tensor on the task.
+typedef std::unordered_map<string, TaskRecvInfo> TaskRecvTable;
+
 struct PairIntHash {
  public:
   std::size_t operator()(const std::pair<int, int>& x) const {
@@ -153,6 +166,12 @@ bool IsDstInputOnHost(const Edge* edge, const GraphInfo& info) {
   return true;
 }
 
+// Return true iff 'node' is known to be outside of any while loop.
+bool IsInRootFrame(const Node* node, const GraphInfo& info) {
+  return static_cast<size_t>(node->id()) < info.cf_info.size() &&
+         info.cf_info[node->id()].frame_name.empty();
+}
+
 // Add an input to dst that comes from the "src_slot" output of the
 // node named by "src_name".
 void AddInput(NodeDef* dst, StringPiece src_name, int src_slot) {
@@ -176,17 +195,21 @@ void AddReadControl(const std::vector<NodeDef*>& recvs,
 }
 
 void SetSendRecvAttrs(const PartitionOptions& opts, const Edge* edge,
-                      NodeDefBuilder* builder) {
+                      const string& send_device, NodeDefBuilder* builder) {
   builder->Attr("tensor_name",
                 strings::StrCat("edge_", edge->id(), "_", edge->src()->name()));
-  builder->Attr("send_device", edge->src()->assigned_device_name());
+  builder->Attr("send_device", send_device);
   builder->Attr("send_device_incarnation",
-                static_cast<int64>(
-                    opts.get_incarnation(edge->src()->assigned_device_name())));
+                static_cast<int64>(opts.get_incarnation(send_device)));
   builder->Attr("recv_device", edge->dst()->assigned_device_name());
   builder->Attr("client_terminated", false);
 }
 
+void SetSendRecvAttrs(const PartitionOptions& opts, const Edge* edge,
+                      NodeDefBuilder* builder) {
+  SetSendRecvAttrs(opts, edge, edge->src()->assigned_device_name(), builder);
+}
+
 NodeDef* AddSend(const PartitionOptions& opts, const GraphInfo& g_info,
                  GraphDef* gdef, const Edge* edge,
                  NodeDefBuilder::NodeOut send_from, int64 start_time,
@@ -293,6 +316,39 @@ NodeDef* AddRecv(const PartitionOptions& opts, const GraphInfo& g_info,
   }
 }
 
+// Forwards the tensor of "edge" from "relay", the first recv of the tensor
+// on the task of edge->dst(), to the device of edge->dst(). Adds a send of
+// the output of "relay" to "relay_graph", and returns the matching recv
+// added to "dst_graph".
+NodeDef* AddRelay(const PartitionOptions& opts, const GraphInfo& g_info,
+                  const TaskRecvInfo& relay, GraphDef* dst_graph,
+                  const Edge* edge, Status* status) {
+  const DataType dtype = EdgeType(edge);
+  const Node* src = edge->src();
+  const Node* dst = edge->dst();
+  const string& relay_device = relay.edge->dst()->assigned_device_name();
+
+  const string send_op =
+      (relay.real_recv->op() == "_HostRecv") ? "_HostSend" : "_Send";
+  NodeDefBuilder send_builder(opts.new_name(src->name()), send_op);
+  SetSendRecvAttrs(opts, edge, relay_device, &send_builder);
+  send_builder.Device(relay_device).Input(relay.recv->name(), 0, dtype);
+  NodeDef* send = relay.graph->add_node();
+  *status = send_builder.Finalize(send);
+  if (!status->ok()) return nullptr;
+
+  auto dst_it = g_info.input_types.find({dst->id(), edge->dst_input()});
+  DCHECK(dst_it != g_info.input_types.end());
+  const string recv_op =
+      (dst_it->second == HOST_MEMORY) ? "_HostRecv" : "_Recv";
+  NodeDefBuilder recv_builder(opts.new_name(src->name()), recv_op);
+  SetSendRecvAttrs(opts, edge, relay_device, &recv_builder);
+  recv_builder.Device(dst->assigned_device_name()).Attr("tensor_type", dtype);
+  NodeDef* recv = dst_graph->add_node();
+  *status = recv_builder.Finalize(recv);
+  return recv;
+}
+
 NodeDef* AddDummyConst(const PartitionOptions& opts, GraphDef* gdef,
                        const Edge* edge, Status* status) {
   const Node* src = edge->src();
@@ -959,6 +1015,7 @@ Status Partition(const PartitionOptions& opts, Graph* g,
   string dstp;
   std::vector<const Edge*> inputs;
   DupRecvTable dup_recv(3);
+  TaskRecvTable task_recv;
   // For a node dst, 'ref_recvs' remembers the recvs introduced by a ref
   // edge to dst. 'ref_control_inputs' remembers the inputs by a non-ref
   // edge to dst. We will add a control edge for every pair in
@@ -968,6 +1025,7 @@ Status Partition(const PartitionOptions& opts, Graph* g,
 
   int32 num_data = 0;
   int32 num_control = 0;
+  int32 num_relayed = 0;
   for (const Node* dst : g->op_nodes()) {
     dstp = opts.node_to_loc(dst);
     GraphDef* dst_graph = &(*partitions)[dstp];
@@ -1079,6 +1137,39 @@ Status Partition(const PartitionOptions& opts, Graph* g,
         continue;
       }
 
+      // Check whether the tensor can be forwarded from another device of
+      // the task of dst that already receives it from the task of src.
+      string task_key;
+      if (opts.relay_recvs_within_task && src_graph != dst_graph &&
+          !edge->IsControlEdge() &&
+          !IsRefType(src->output_type(edge->src_output())) &&
+          control_flow_edge == nullptr && !opts.scheduling_for_recvs &&
+          IsInRootFrame(src, g_info) && IsInRootFrame(dst, g_info)) {
+        string src_task, dst_task, device;
+        if (DeviceNameUtils::SplitDeviceName(src->assigned_device_name(),
+                                             &src_task, &device) &&
+            DeviceNameUtils::SplitDeviceName(dst->assigned_device_name(),
+                                             &dst_task, &device) &&
+            src_task != dst_task) {
+          task_key = strings::StrCat(src->id(), ":", edge->src_output(), ":",
+                                     dst_task, ":", on_host);
+        }
+      }
+      if (!task_key.empty()) {
+        auto task_iter = task_recv.find(task_key);
+        if (task_iter != task_recv.end() &&
+            task_iter->second.graph != dst_graph) {
+          NodeDef* recv = AddRelay(opts, g_info, task_iter->second, dst_graph,
+                                   edge, &status);
+          if (!status.ok()) return status;
+          dup_recv[key] = {recv, recv, recv_start_time};
+          ref_control_inputs.push_back(recv->name());
+          ++num_relayed;
+          AddInput(dst_def, recv->name(), 0);
+          continue;
+        }
+      }
+
       NodeDefBuilder::NodeOut send_from;
       if (edge->IsControlEdge()) {
         // Insert a dummy const node that will generate a tiny
@@ -1139,6 +1230,9 @@ Status Partition(const PartitionOptions& opts, Graph* g,
         // for now we don't do it.
         dup_recv[key] = {recv, real_recv, recv_start_time};
         ref_control_inputs.push_back(recv->name());
+        if (!task_key.empty()) {
+          task_recv.insert({task_key, {dst_graph, edge, recv, real_recv}});
+        }
       }
 
       if (edge->IsControlEdge()) {
@@ -1196,7 +1290,7 @@ Status Partition(const PartitionOptions& opts, Graph* g,
   }
 
   VLOG(1) << "Added send/recv: controls=" << num_control
-          << ", data=" << num_data;
+          << ", data=" << num_data << ", relayed=" << num_relayed;
   return Status::OK();
 }
 
@@ -76,6 +76,13 @@ struct PartitionOptions {
   // in the graph as a node attribute.
   bool need_to_record_start_times = false;
   std::vector<Microseconds> start_times;
+
+  // If true, a tensor that is consumed on several devices of a task other
+  // than its producer's is transferred to that task only once, to the
+  // first of these devices, and forwarded from there to the others. Only
+  // has an effect when "node_to_loc" splits a task into several
+  // locations.
+  bool relay_recvs_within_task = false;
 };
 
 // Partition "input" graph into a set of graphs, one per location.
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <set>
 #include <unordered_map>
 #include <utility>
 
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/while_loop.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/graph.h"
@@ -74,7 +76,8 @@ string DeviceName(const Node* node) {
 }
 
 void Partition(const GraphDef& graph_def,
-               std::unordered_map<string, GraphDef>* partitions) {
+               std::unordered_map<string, GraphDef>* partitions,
+               bool relay_recvs_within_task = false) {
   Graph g(OpRegistry::Global());
   GraphConstructorOptions opts;
   TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &g));
@@ -94,6 +97,7 @@ void Partition(const GraphDef& graph_def,
   popts.get_incarnation = [](const string& name) {
     return (name[0] - 'A') + 100;
   };
+  popts.relay_recvs_within_task = relay_recvs_within_task;
   Status s = Partition(popts, &g, partitions);
   CHECK(s.ok()) << s;
 
@@ -316,6 +320,40 @@ TEST_F(GraphPartitionTest, CrossDeviceData_MultiUse) {
   ExpectMatchB();
 }
 
+TEST_F(GraphPartitionTest, CrossTaskData_RelayWithinTask) {
+  const string a = "/job:a/replica:0/task:0/cpu:0";
+  const string b0 = "/job:a/replica:0/task:1/cpu:0";
+  const string b1 = "/job:a/replica:0/task:1/cpu:1";
+  auto a1 = FloatInput(in_.WithOpName("A1").WithDevice(a));
+  Combine(in_.WithOpName("B1").WithDevice(b0), a1, a1);
+  Combine(in_.WithOpName("B2").WithDevice(b1), a1, a1);
+
+  auto ops_of = [](const GraphDef& graph_def) {
+    std::multiset<string> ops;
+    for (const NodeDef& node : graph_def.node()) ops.insert(node.op());
+    return ops;
+  };
+
+  // Without relaying, the tensor is sent to both devices of task 1.
+  Partition(ToGraphDef(), &partitions_);
+  EXPECT_EQ(3, partitions_.size());
+  EXPECT_EQ(2, ops_of(partitions_[a]).count("_Send"));
+
+  // With relaying, it is sent once and forwarded within task 1.
+  Partition(ToGraphDef(), &partitions_, true);
+  EXPECT_EQ(3, partitions_.size());
+  EXPECT_EQ(1, ops_of(partitions_[a]).count("_Send"));
+  EXPECT_EQ(1, ops_of(partitions_[b0]).count("_Recv"));
+  EXPECT_EQ(1, ops_of(partitions_[b0]).count("_Send"));
+  EXPECT_EQ(1, ops_of(partitions_[b1]).count("_Recv"));
+  for (const NodeDef& node : partitions_[b1].node()) {
+    if (node.op() != "_Recv") continue;
+    string send_device;
+    TF_EXPECT_OK(GetNodeAttr(node, "send_device", &send_device));
+    EXPECT_EQ(b0, send_device);
+  }
+}
+
 TEST_F(GraphPartitionTest, CrossDeviceControl_MultiUse) {
   auto a1 = FloatInput(in_.WithOpName("A1"));
   auto b1 = FloatInput(in_.WithOpName("B1"));
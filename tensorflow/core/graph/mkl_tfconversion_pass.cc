@@ -15,6 +15,7 @@ limitations under the License.
 
 #ifdef INTEL_MKL
 
+#include <map>
 #include <memory>
 #include <queue>
 #include <set>
@@ -112,9 +113,14 @@ class MklToTfConversionPass : public GraphOptimizationPass {
   // Any attempt to use the edge after this call
   // will lead to undefined behaviors.
   //
+  // If '*conversion_node' is not null, it must already convert the output
+  // of the edge's source, and it is reused instead of building a new node.
+  // Otherwise '*conversion_node' is set to the newly built node.
+  //
   // @return Success:OK() if insertion is successful, otherwise returns
   //         appropriate error status code.
-  Status InsertConversionNodeOnEdge(std::unique_ptr<Graph>* g, Edge*);
+  Status InsertConversionNodeOnEdge(std::unique_ptr<Graph>* g, Edge*,
+                                    Node** conversion_node);
 
   // For element-wise ops, we need to sanitize the inputs. For this, we add a
   // new node at the input of the replacement element-wise node that checks
@@ -137,8 +143,9 @@ const OptimizationPassRegistry::Grouping kMklTfConvPassGroup =
 REGISTER_OPTIMIZATION(kMklTfConvPassGroup, 2, MklToTfConversionPass);
 
 Status MklToTfConversionPass::InsertConversionNodeOnEdge(
-    std::unique_ptr<Graph>* g, Edge* e) {
+    std::unique_ptr<Graph>* g, Edge* e, Node** conversion_node_out) {
   CHECK_NOTNULL(e);
+  CHECK_NOTNULL(conversion_node_out);
 
   Node* src = e->src();
   Node* dst = e->dst();
@@ -162,6 +169,14 @@ Status MklToTfConversionPass::InsertConversionNodeOnEdge(
     return Status(error::Code::INVALID_ARGUMENT, err_msg.c_str());
   }
 
+  // The output of src is already converted for another consumer: just
+  // redirect this edge to the existing conversion node.
+  if (*conversion_node_out != nullptr) {
+    CHECK_NOTNULL((*g)->AddEdge(*conversion_node_out, 0, dst, e->dst_input()));
+    (*g)->RemoveEdge(e);
+    return Status::OK();
+  }
+
   // Build the conversion node and specify src as input.
   TF_CHECK_OK(
       NodeBuilder((*g)->NewName("Mkl2Tf"), "_MklToTf")
@@ -198,6 +213,7 @@ Status MklToTfConversionPass::InsertConversionNodeOnEdge(
 
   // Remove src->dst edge now.
   (*g)->RemoveEdge(e);
+  *conversion_node_out = conversion_node;
   return Status::OK();
 }
 
@@ -340,13 +356,18 @@ bool MklToTfConversionPass::RunPass(std::unique_ptr<Graph>* g) {
     }
   }
 
-  // Process all candidate edges and insert conversion nodes on them.
+  // Process all candidate edges and insert conversion nodes on them. All
+  // non-Mkl consumers of the same output share a single conversion node, so
+  // that a tensor is converted back to TensorFlow layout only once.
+  std::map<std::pair<int, int>, Node*> conversion_nodes;
   for (Edge* e : candidate_edges) {
     // Even if we insert conversion node on a single edge, we
     // need to return true.
     string src_name = e->src()->name();
     string dst_name = e->dst()->name();
-    if (InsertConversionNodeOnEdge(g, e) == Status::OK()) {
+    Node*& conversion_node =
+        conversion_nodes[std::make_pair(e->src()->id(), e->src_output())];
+    if (InsertConversionNodeOnEdge(g, e, &conversion_node) == Status::OK()) {
       VLOG(1) << "MklToTfConversionPass: Inserted conversion "
               << "node on edge between " << src_name << " and " << dst_name;
       result = true;
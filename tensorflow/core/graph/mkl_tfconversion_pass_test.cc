@@ -238,6 +238,67 @@ TEST_F(MklToTfConversionPass, Negative_DoubleInsert) {
   }
 }
 
+// MklConv2D followed by two Non-Mkl layers.
+// C=MklConv2D(A,M,B,N); E=Sub(C,D); F=Mul(C,D) (for interleaved ordering)
+// C=MklConv2D(A,B,M,N); E=Sub(C,D); F=Mul(C,D) (for contiguous ordering)
+// Both consumers should share a single MklToTf node.
+TEST_F(MklToTfConversionPass, Positive_SharedConversion) {
+  if (kTensorOrdering == MklTfTensorOrdering::TENSORS_INTERLEAVED) {
+    InitGraph(
+        "node { name: 'A' op: 'Input'}"
+        "node { name: 'M' op: '_MklInput'}"
+        "node { name: 'B' op: 'Input'}"
+        "node { name: 'N' op: '_MklInput'}"
+        "node { name: 'C' op: '_MklConv2D'"
+        " attr { key: 'T'                value { type: DT_FLOAT } }"
+        " attr { key: 'data_format'      value { s: 'NCHW' } }"
+        " attr { key: 'use_cudnn_on_gpu' value { b: false } }"
+        " attr { key: 'strides'          value { list: {i: 1, i:1, i:1, i:1} } "
+        "}"
+        " attr { key: 'padding'          value { s: 'SAME' } }"
+        " input: ['A', 'M', 'B', 'N']}"
+        "node { name: 'D' op: 'Input'}"
+        "node { name: 'E' op: 'Sub'"
+        " attr {key: 'T'                 value { type: DT_FLOAT } }"
+        " input: ['C', 'D']}"
+        "node { name: 'F' op: 'Mul'"
+        " attr {key: 'T'                 value { type: DT_FLOAT } }"
+        " input: ['C', 'D']}");
+    EXPECT_EQ(DoRunMklToTfConversionPass(),
+              "A(Input);B(Input);C(_MklConv2D);D(Input);E(Sub);F(Mul);"
+              "M(_MklInput);Mkl2Tf/_0(_MklToTf);N(_MklInput)|A->C;B->C:2;"
+              "C->Mkl2Tf/_0;C:1->Mkl2Tf/_0:1;D->E:1;D->F:1;M->C:1;"
+              "Mkl2Tf/_0->E;Mkl2Tf/_0->F;N->C:3");
+  } else {
+    CHECK_EQ(kTensorOrdering, MklTfTensorOrdering::TENSORS_CONTIGUOUS);
+    InitGraph(
+        "node { name: 'A' op: 'Input'}"
+        "node { name: 'B' op: 'Input'}"
+        "node { name: 'M' op: '_MklInput'}"
+        "node { name: 'N' op: '_MklInput'}"
+        "node { name: 'C' op: '_MklConv2D'"
+        " attr { key: 'T'                value { type: DT_FLOAT } }"
+        " attr { key: 'data_format'      value { s: 'NCHW' } }"
+        " attr { key: 'use_cudnn_on_gpu' value { b: false } }"
+        " attr { key: 'strides'          value { list: {i: 1, i:1, i:1, i:1} } "
+        "}"
+        " attr { key: 'padding'          value { s: 'SAME' } }"
+        " input: ['A', 'B', 'M', 'N']}"
+        "node { name: 'D' op: 'Input'}"
+        "node { name: 'E' op: 'Sub'"
+        " attr {key: 'T'                 value { type: DT_FLOAT } }"
+        " input: ['C', 'D']}"
+        "node { name: 'F' op: 'Mul'"
+        " attr {key: 'T'                 value { type: DT_FLOAT } }"
+        " input: ['C', 'D']}");
+    EXPECT_EQ(DoRunMklToTfConversionPass(),
+              "A(Input);B(Input);C(_MklConv2D);D(Input);E(Sub);F(Mul);"
+              "M(_MklInput);Mkl2Tf/_0(_MklToTf);N(_MklInput)|A->C;B->C:1;"
+              "C->Mkl2Tf/_0;C:2->Mkl2Tf/_0:1;D->E:1;D->F:1;M->C:2;"
+              "Mkl2Tf/_0->E;Mkl2Tf/_0->F;N->C:3");
+  }
+}
+
 // C=Conv2D(A,B); E=BiasAdd(C,D); Z=Sub(E,Y);
 // There is no Mkl layer so no conversion op should be inserted.
 TEST_F(MklToTfConversionPass, Negative_NoMklLayer) {
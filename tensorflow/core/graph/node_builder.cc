@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/node_builder.h"
 
+#include <utility>
 #include <vector>
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -112,7 +113,7 @@ Status NodeBuilder::Finalize(Graph* graph, Node** created_node) const {
   TF_RETURN_IF_ERROR(
       CheckOpDeprecation(def_builder_.op_def(), graph->versions().producer()));
   Status status;
-  Node* node = graph->AddNode(node_def, &status);
+  Node* node = graph->AddNode(std::move(node_def), &status);
   if (!status.ok()) return status;
 
   for (size_t i = 0; i < inputs_.size(); ++i) {
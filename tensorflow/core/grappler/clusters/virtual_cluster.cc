@@ -17,6 +17,7 @@ limitations under the License.
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/measured_costs.h"
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/virtual_scheduler.h"
 
@@ -26,7 +27,7 @@ namespace grappler {
 VirtualCluster::VirtualCluster(
     const std::unordered_map<string, DeviceProperties>& devices)
     : Cluster(0),
-      node_estimator_(new OpLevelCostEstimator()),
+      node_estimator_(NewOpLevelCostEstimator()),
       node_manager_(new FirstReadyManager()) {
   devices_ = devices;
 }
@@ -0,0 +1,192 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_costs.h"
+
+#include <map>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+string MeasuredCostsPath() {
+  string path;
+  Status s = ReadStringFromEnvVar("TF_GRAPPLER_MEASURED_COSTS", "", &path);
+  if (!s.ok()) {
+    LOG(ERROR) << s.error_message();
+    return "";
+  }
+  return path;
+}
+
+}  // namespace
+
+// static
+MeasuredCosts* MeasuredCosts::Global() {
+  static MeasuredCosts* costs = [] {
+    MeasuredCosts* costs = new MeasuredCosts;
+    const string path = MeasuredCostsPath();
+    if (!path.empty() && Env::Default()->FileExists(path).ok()) {
+      Status s = costs->Load(Env::Default(), path);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to load measured costs from " << path << ": "
+                     << s;
+      } else {
+        VLOG(1) << "Loaded " << costs->size() << " measured costs from "
+                << path;
+      }
+    }
+    return costs;
+  }();
+  return costs;
+}
+
+// static
+bool MeasuredCosts::RecordingEnabled() {
+  static const bool enabled = !MeasuredCostsPath().empty();
+  return enabled;
+}
+
+// static
+Status MeasuredCosts::Record(const OpPerformanceList& perfs) {
+  if (!RecordingEnabled()) return Status::OK();
+  MeasuredCosts* costs = Global();
+  costs->Add(perfs);
+  return costs->Save(Env::Default(), MeasuredCostsPath());
+}
+
+// static
+string MeasuredCosts::Key(const OpInfo& op_info) {
+  string key = strings::StrCat(op_info.device().type(), ":", op_info.op());
+  for (const auto& input : op_info.inputs()) {
+    strings::StrAppend(&key, ";", DataTypeString(input.dtype()),
+                       PartialTensorShape::DebugString(input.shape()));
+  }
+  // Attributes such as strides and data formats change the cost too. The
+  // attributes of the map are sorted, and internal ones are left out.
+  std::map<string, string> attrs;
+  for (const auto& attr : op_info.attr()) {
+    if (!str_util::StartsWith(attr.first, "_")) {
+      attrs[attr.first] = SummarizeAttrValue(attr.second);
+    }
+  }
+  for (const auto& attr : attrs) {
+    strings::StrAppend(&key, ";", attr.first, "=", attr.second);
+  }
+  return key;
+}
+
+void MeasuredCosts::Add(const OpPerformanceList& perfs) {
+  mutex_lock l(mu_);
+  for (const OpPerformance& perf : perfs.op_performance()) {
+    // Ops whose inputs have unknown shapes can't be told apart.
+    bool unknown_shape = false;
+    for (const auto& input : perf.op().inputs()) {
+      unknown_shape |= !PartialTensorShape(input.shape()).IsFullyDefined();
+    }
+    if (unknown_shape || perf.compute_cost() <= 0) continue;
+
+    Entry& entry = entries_[Key(perf.op())];
+    if (entry.count == 0) {
+      // Only the fields of the key are kept.
+      OpInfo* op_info = entry.perf.mutable_op();
+      op_info->set_op(perf.op().op());
+      *op_info->mutable_attr() = perf.op().attr();
+      *op_info->mutable_device() = perf.op().device();
+      for (const auto& input : perf.op().inputs()) {
+        OpInfo::TensorProperties* properties = op_info->add_inputs();
+        properties->set_dtype(input.dtype());
+        *properties->mutable_shape() = input.shape();
+      }
+    }
+    // Keeps a running average of the compute cost.
+    ++entry.count;
+    entry.perf.set_compute_cost(
+        entry.perf.compute_cost() +
+        (perf.compute_cost() - entry.perf.compute_cost()) / entry.count);
+  }
+}
+
+bool MeasuredCosts::Lookup(const OpInfo& op_info,
+                           Costs::NanoSeconds* time) const {
+  const string key = Key(op_info);
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  *time = Costs::NanoSeconds(it->second.perf.compute_cost());
+  return true;
+}
+
+int64 MeasuredCosts::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+Status MeasuredCosts::Load(Env* env, const string& path) {
+  OpPerformanceList perfs;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env, path, &perfs));
+  Add(perfs);
+  return Status::OK();
+}
+
+Status MeasuredCosts::Save(Env* env, const string& path) const {
+  OpPerformanceList perfs;
+  {
+    mutex_lock l(mu_);
+    for (const auto& it : entries_) {
+      *perfs.add_op_performance() = it.second.perf;
+    }
+  }
+  // Writes to a temporary file first, so that readers never see a partial
+  // file.
+  const string tmp_path = strings::StrCat(path, ".tmp");
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, tmp_path, perfs));
+  return env->RenameFile(tmp_path, path);
+}
+
+Costs MeasuredOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+  Costs::NanoSeconds measured;
+  if (costs_->Lookup(op_context.op_info, &measured)) {
+    VLOG(2) << "Measured cost of " << op_context.name << ": "
+            << measured.count() << " ns, estimated "
+            << costs.execution_time.count() << " ns";
+    costs.execution_time = measured;
+    costs.compute_time = measured;
+    costs.memory_time = Costs::Duration(0);
+    costs.inaccurate = false;
+  }
+  return costs;
+}
+
+OpLevelCostEstimator* NewOpLevelCostEstimator() {
+  if (MeasuredCosts::RecordingEnabled()) {
+    return new MeasuredOpLevelCostEstimator(MeasuredCosts::Global());
+  }
+  return new OpLevelCostEstimator();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
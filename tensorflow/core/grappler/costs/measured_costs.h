@@ -0,0 +1,101 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COSTS_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COSTS_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// The average measured execution times of ops, keyed by op type, device
+// type and input types and shapes. Sessions add the costs that they measure
+// when they build cost models, and MeasuredOpLevelCostEstimator predicts
+// them instead of the analytical estimates.
+//
+// This class is thread-safe.
+class MeasuredCosts {
+ public:
+  MeasuredCosts() {}
+
+  // The costs of the process. If TF_GRAPPLER_MEASURED_COSTS names a file,
+  // they are loaded from it on first use, and saved to it by Record().
+  static MeasuredCosts* Global();
+
+  // Adds the measured compute costs of "perfs" to the averages.
+  void Add(const OpPerformanceList& perfs);
+
+  // Adds "perfs" to the global costs, and saves them to the file of
+  // TF_GRAPPLER_MEASURED_COSTS. Does nothing if it is not set.
+  static Status Record(const OpPerformanceList& perfs);
+
+  // Returns true if TF_GRAPPLER_MEASURED_COSTS is set.
+  static bool RecordingEnabled();
+
+  // Sets "*time" to the average measured time of "op_info", if any.
+  bool Lookup(const OpInfo& op_info, Costs::NanoSeconds* time) const;
+
+  int64 size() const;
+
+  // Reads and writes the averages as an OpPerformanceList.
+  Status Load(Env* env, const string& path);
+  Status Save(Env* env, const string& path) const;
+
+ private:
+  struct Entry {
+    OpPerformance perf;
+    int64 count = 0;
+  };
+
+  static string Key(const OpInfo& op_info);
+
+  mutable mutex mu_;
+  std::unordered_map<string, Entry> entries_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MeasuredCosts);
+};
+
+// Predicts the measured execution time of ops that have one, and the
+// analytical estimates of OpLevelCostEstimator otherwise.
+class MeasuredOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  // Does not take ownership of "costs".
+  explicit MeasuredOpLevelCostEstimator(const MeasuredCosts* costs)
+      : costs_(costs) {}
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+ private:
+  const MeasuredCosts* const costs_;  // Not owned.
+};
+
+// Returns a MeasuredOpLevelCostEstimator over the global costs if
+// TF_GRAPPLER_MEASURED_COSTS is set, and an OpLevelCostEstimator otherwise.
+OpLevelCostEstimator* NewOpLevelCostEstimator();
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_COSTS_H_
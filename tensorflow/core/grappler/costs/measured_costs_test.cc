@@ -0,0 +1,111 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_costs.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpInfo MatMulInfo(int m, int k, int n) {
+  OpInfo op_info;
+  op_info.set_op("MatMul");
+  op_info.mutable_device()->set_type("CPU");
+  for (const auto& dims : {std::make_pair(m, k), std::make_pair(k, n)}) {
+    auto* input = op_info.add_inputs();
+    input->set_dtype(DT_FLOAT);
+    input->mutable_shape()->add_dim()->set_size(dims.first);
+    input->mutable_shape()->add_dim()->set_size(dims.second);
+  }
+  return op_info;
+}
+
+OpPerformanceList Perfs(const OpInfo& op_info, int64 compute_cost) {
+  OpPerformanceList perfs;
+  OpPerformance* perf = perfs.add_op_performance();
+  *perf->mutable_op() = op_info;
+  perf->set_compute_cost(compute_cost);
+  return perfs;
+}
+
+TEST(MeasuredCostsTest, AveragesMeasurements) {
+  MeasuredCosts costs;
+  costs.Add(Perfs(MatMulInfo(4, 8, 16), 1000));
+  costs.Add(Perfs(MatMulInfo(4, 8, 16), 3000));
+  costs.Add(Perfs(MatMulInfo(8, 8, 16), 5000));
+  EXPECT_EQ(2, costs.size());
+
+  Costs::NanoSeconds time;
+  ASSERT_TRUE(costs.Lookup(MatMulInfo(4, 8, 16), &time));
+  EXPECT_EQ(2000, time.count());
+  ASSERT_TRUE(costs.Lookup(MatMulInfo(8, 8, 16), &time));
+  EXPECT_EQ(5000, time.count());
+  EXPECT_FALSE(costs.Lookup(MatMulInfo(16, 8, 16), &time));
+
+  // The attributes are part of the key, except the internal ones.
+  OpInfo transposed = MatMulInfo(4, 8, 16);
+  (*transposed.mutable_attr())["transpose_a"].set_b(true);
+  EXPECT_FALSE(costs.Lookup(transposed, &time));
+  OpInfo annotated = MatMulInfo(4, 8, 16);
+  (*annotated.mutable_attr())["_class"].set_s("loc:@a");
+  EXPECT_TRUE(costs.Lookup(annotated, &time));
+}
+
+TEST(MeasuredCostsTest, SkipsUnknownShapes) {
+  MeasuredCosts costs;
+  OpInfo op_info = MatMulInfo(4, 8, 16);
+  op_info.mutable_inputs(0)->mutable_shape()->mutable_dim(0)->set_size(-1);
+  costs.Add(Perfs(op_info, 1000));
+  costs.Add(Perfs(MatMulInfo(4, 8, 16), 0));
+  EXPECT_EQ(0, costs.size());
+}
+
+TEST(MeasuredCostsTest, SaveAndLoad) {
+  const string path = io::JoinPath(testing::TmpDir(), "measured_costs");
+  MeasuredCosts costs;
+  costs.Add(Perfs(MatMulInfo(4, 8, 16), 1000));
+  TF_ASSERT_OK(costs.Save(Env::Default(), path));
+
+  MeasuredCosts loaded;
+  TF_ASSERT_OK(loaded.Load(Env::Default(), path));
+  EXPECT_EQ(1, loaded.size());
+  Costs::NanoSeconds time;
+  ASSERT_TRUE(loaded.Lookup(MatMulInfo(4, 8, 16), &time));
+  EXPECT_EQ(1000, time.count());
+}
+
+TEST(MeasuredCostsTest, EstimatorPrefersMeasuredCosts) {
+  MeasuredCosts costs;
+  costs.Add(Perfs(MatMulInfo(4, 8, 16), 123456));
+  MeasuredOpLevelCostEstimator estimator(&costs);
+
+  OpContext op_context;
+  op_context.op_info = MatMulInfo(4, 8, 16);
+  Costs predicted = estimator.PredictCosts(op_context);
+  EXPECT_EQ(123456, predicted.execution_time.count());
+  EXPECT_FALSE(predicted.inaccurate);
+
+  op_context.op_info = MatMulInfo(8, 8, 16);
+  EXPECT_EQ(OpLevelCostEstimator().PredictCosts(op_context).execution_time,
+            estimator.PredictCosts(op_context).execution_time);
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
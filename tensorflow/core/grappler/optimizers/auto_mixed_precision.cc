@@ -0,0 +1,292 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
+
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+typedef std::unordered_set<string> OpList;
+
+// Ops that are much faster in float16 on Tensor Cores.
+OpList DefaultWhitelist() {
+  return {"Conv2D", "Conv2DBackpropFilter", "Conv2DBackpropInput", "MatMul"};
+}
+
+// Ops that are safe in float16 but not worth a cast on their own.
+OpList DefaultGraylist() {
+  return {"Add", "AddN", "AddV2", "AvgPool", "AvgPoolGrad", "BiasAdd",
+          "BiasAddGrad", "BiasAddV1", "ConcatV2", "Elu", "EluGrad",
+          "ExpandDims", "Identity", "MaxPool", "MaxPoolGrad", "Mul", "Pack",
+          "Relu", "Relu6", "Relu6Grad", "ReluGrad", "Reshape", "Sigmoid",
+          "SigmoidGrad", "Squeeze", "Sub", "Tanh", "TanhGrad", "Transpose"};
+}
+
+// Ops whose results lose too much precision in float16, and whose outputs
+// should stay in float32 through the graylist ops that follow them.
+OpList DefaultBlacklist() {
+  return {"Exp",
+          "Expm1",
+          "L2Loss",
+          "Log",
+          "Log1p",
+          "LogSoftmax",
+          "Mean",
+          "Pow",
+          "Prod",
+          "Softmax",
+          "SoftmaxCrossEntropyWithLogits",
+          "SparseSoftmaxCrossEntropyWithLogits",
+          "Sum"};
+}
+
+// Adds and removes the comma-separated ops of the
+// TF_AUTO_MIXED_PRECISION_<name>_ADD and _REMOVE environment variables.
+Status UpdateList(const string& name, OpList* list) {
+  const string prefix = strings::StrCat("TF_AUTO_MIXED_PRECISION_", name);
+  string ops;
+  TF_RETURN_IF_ERROR(
+      ReadStringFromEnvVar(strings::StrCat(prefix, "_ADD"), "", &ops));
+  for (const string& op : str_util::Split(ops, ',', str_util::SkipEmpty())) {
+    list->insert(op);
+  }
+  TF_RETURN_IF_ERROR(
+      ReadStringFromEnvVar(strings::StrCat(prefix, "_REMOVE"), "", &ops));
+  for (const string& op : str_util::Split(ops, ',', str_util::SkipEmpty())) {
+    list->erase(op);
+  }
+  return Status::OK();
+}
+
+// Returns true if the device is a GPU with Tensor Cores.
+bool HasTensorCores(const DeviceProperties& device) {
+  if (device.type() != "GPU") return false;
+  auto it = device.environment().find("architecture");
+  if (it == device.environment().end()) return false;
+  const std::vector<string> version = str_util::Split(it->second, '.');
+  int32 major;
+  return !version.empty() && strings::safe_strto32(version[0], &major) &&
+         major >= 7;
+}
+
+// Which inputs and outputs of a node change from float32 to float16 when its
+// "T" attr is set to DT_HALF.
+struct HalfPorts {
+  std::vector<bool> inputs;
+  std::vector<bool> outputs;
+};
+
+Status GetHalfPorts(const NodeDef& node, HalfPorts* ports) {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(node.op(), &op_def));
+  DataTypeVector inputs, outputs, half_inputs, half_outputs;
+  TF_RETURN_IF_ERROR(InOutTypesForNode(node, *op_def, &inputs, &outputs));
+  NodeDef half_node = node;
+  (*half_node.mutable_attr())["T"].set_type(DT_HALF);
+  TF_RETURN_IF_ERROR(
+      InOutTypesForNode(half_node, *op_def, &half_inputs, &half_outputs));
+  ports->inputs.clear();
+  for (int i = 0; i < inputs.size(); ++i) {
+    ports->inputs.push_back(inputs[i] == DT_FLOAT && half_inputs[i] == DT_HALF);
+  }
+  ports->outputs.clear();
+  for (int i = 0; i < outputs.size(); ++i) {
+    ports->outputs.push_back(outputs[i] == DT_FLOAT &&
+                             half_outputs[i] == DT_HALF);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                    GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  if (cluster == nullptr) {
+    return Status::OK();
+  }
+  OpList whitelist = DefaultWhitelist();
+  OpList graylist = DefaultGraylist();
+  OpList blacklist = DefaultBlacklist();
+  TF_RETURN_IF_ERROR(UpdateList("WHITELIST", &whitelist));
+  TF_RETURN_IF_ERROR(UpdateList("GRAYLIST", &graylist));
+  TF_RETURN_IF_ERROR(UpdateList("BLACKLIST", &blacklist));
+
+  // Only float32 ops with float16 kernels on a Tensor Core GPU are candidates.
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  VirtualPlacer placer(cluster);
+  std::unordered_map<const NodeDef*, HalfPorts> candidates;
+  bool has_white = false;
+  for (const NodeDef& node : optimized_graph->node()) {
+    const bool white = whitelist.count(node.op()) > 0;
+    if ((!white && graylist.count(node.op()) == 0) ||
+        GetDataTypeFromAttr(node, "T") != DT_FLOAT ||
+        nodes_to_preserve.count(node.name()) > 0 ||
+        !HasTensorCores(placer.get_device(node))) {
+      continue;
+    }
+    HalfPorts ports;
+    if (!GetHalfPorts(node, &ports).ok()) continue;
+    candidates[&node] = std::move(ports);
+    has_white |= white;
+  }
+  if (!has_white) {
+    return Status::OK();
+  }
+
+  NodeMap node_map(optimized_graph);
+  std::unordered_map<const NodeDef*, std::vector<const NodeDef*>> fanins;
+  std::unordered_map<const NodeDef*, std::vector<const NodeDef*>> fanouts;
+  for (const NodeDef& node : optimized_graph->node()) {
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) continue;
+      const NodeDef* fanin = node_map.GetNode(input);
+      if (fanin == nullptr) continue;
+      fanins[&node].push_back(fanin);
+      fanouts[fanin].push_back(&node);
+    }
+  }
+  auto is_gray = [&](const NodeDef* node) {
+    return candidates.count(node) > 0 && whitelist.count(node->op()) == 0;
+  };
+
+  // Graylist ops fed by a blacklist op, directly or through other graylist
+  // ops, stay in float32.
+  std::unordered_set<const NodeDef*> black;
+  std::deque<const NodeDef*> queue;
+  for (const NodeDef& node : optimized_graph->node()) {
+    if (blacklist.count(node.op()) > 0) queue.push_back(&node);
+  }
+  while (!queue.empty()) {
+    const NodeDef* node = queue.front();
+    queue.pop_front();
+    if (!black.insert(node).second) continue;
+    for (const NodeDef* fanout : fanouts[node]) {
+      if (is_gray(fanout)) queue.push_back(fanout);
+    }
+  }
+
+  // Paint the whitelist ops, and the graylist ops connected to them.
+  std::unordered_set<const NodeDef*> painted;
+  for (const auto& candidate : candidates) {
+    if (!is_gray(candidate.first)) queue.push_back(candidate.first);
+  }
+  while (!queue.empty()) {
+    const NodeDef* node = queue.front();
+    queue.pop_front();
+    if (!painted.insert(node).second) continue;
+    for (const auto* neighbors : {&fanins[node], &fanouts[node]}) {
+      for (const NodeDef* neighbor : *neighbors) {
+        if (is_gray(neighbor) && black.count(neighbor) == 0) {
+          queue.push_back(neighbor);
+        }
+      }
+    }
+  }
+
+  // Cast the tensors that cross the boundary of the painted regions. A
+  // tensor is cast once in each direction, however many consumers it has.
+  std::unordered_map<string, string> casts;
+  std::vector<NodeDef> cast_nodes;
+  auto get_cast = [&](const NodeDef& src, const string& tensor, int port,
+                      bool to_half) {
+    const string key = strings::StrCat(src.name(), ":", port, ";", to_half);
+    auto it = casts.find(key);
+    if (it != casts.end()) return it->second;
+    string name = strings::StrCat(src.name(), "-", port, "-CastTo",
+                                  to_half ? "Fp16" : "Fp32",
+                                  "-AutoMixedPrecision");
+    for (int i = 1; node_map.NodeExists(name); ++i) {
+      name = strings::StrCat(src.name(), "-", port, "-CastTo",
+                             to_half ? "Fp16" : "Fp32",
+                             "-AutoMixedPrecision_", i);
+    }
+    NodeDef cast;
+    cast.set_name(name);
+    cast.set_op("Cast");
+    cast.set_device(src.device());
+    cast.add_input(tensor);
+    (*cast.mutable_attr())["SrcT"].set_type(to_half ? DT_FLOAT : DT_HALF);
+    (*cast.mutable_attr())["DstT"].set_type(to_half ? DT_HALF : DT_FLOAT);
+    cast_nodes.push_back(cast);
+    casts[key] = name;
+    return name;
+  };
+  auto is_half_output = [&](const NodeDef* node, int port) {
+    if (painted.count(node) == 0) return false;
+    const std::vector<bool>& outputs = candidates[node].outputs;
+    return port < static_cast<int>(outputs.size()) && outputs[port];
+  };
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    const bool is_painted = painted.count(&node) > 0;
+    for (int i = 0; i < node.input_size(); ++i) {
+      const string& input = node.input(i);
+      if (IsControlInput(input)) break;
+      int port;
+      ParseNodeName(input, &port);
+      const NodeDef* src = node_map.GetNode(input);
+      if (src == nullptr) continue;
+      const bool src_half = is_half_output(src, port);
+      const std::vector<bool>* dst_inputs =
+          is_painted ? &candidates[&node].inputs : nullptr;
+      const bool dst_half =
+          dst_inputs != nullptr && i < static_cast<int>(dst_inputs->size()) &&
+          (*dst_inputs)[i];
+      if (src_half != dst_half) {
+        node.set_input(i, get_cast(*src, input, port, dst_half));
+      }
+    }
+  }
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (painted.count(&node) > 0) {
+      (*node.mutable_attr())["T"].set_type(DT_HALF);
+    }
+  }
+  for (NodeDef& cast : cast_nodes) {
+    optimized_graph->add_node()->Swap(&cast);
+  }
+  VLOG(1) << "Converted " << painted.size() << " nodes to float16 with "
+          << cast_nodes.size() << " casts";
+  return Status::OK();
+}
+
+void AutoMixedPrecision::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                  const GraphDef& optimized_graph,
+                                  double result) {
+  // Nothing to do for AutoMixedPrecision.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
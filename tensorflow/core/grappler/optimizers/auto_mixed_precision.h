@@ -0,0 +1,57 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// AutoMixedPrecision converts the float32 ops placed on GPUs with Tensor Cores
+// (compute capability 7.0 or higher) to float16 where that is numerically
+// safe, and inserts the casts needed at the boundaries of the converted
+// regions.
+//
+// Ops are classified by three lists:
+//  - whitelist ops (e.g. MatMul, Conv2D) benefit from Tensor Cores and are
+//    always converted.
+//  - graylist ops (e.g. Add, Relu) are converted only when they are connected
+//    to a converted whitelist op, to save casts, and are not downstream of a
+//    blacklist op through other graylist ops.
+//  - blacklist ops (e.g. Exp, Softmax) are numerically sensitive and are
+//    never converted.
+// Other ops are never converted either. The lists can be edited with the
+// TF_AUTO_MIXED_PRECISION_{WHITE,GRAY,BLACK}LIST_{ADD,REMOVE} environment
+// variables, which take comma-separated op names.
+class AutoMixedPrecision : public GraphOptimizer {
+ public:
+  AutoMixedPrecision() {}
+  ~AutoMixedPrecision() override {}
+
+  string name() const override { return "auto_mixed_precision"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
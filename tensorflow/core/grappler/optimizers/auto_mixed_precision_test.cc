@@ -0,0 +1,117 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class AutoMixedPrecisionTest : public GrapplerTest {
+ protected:
+  // Returns a cluster with a single GPU of the given architecture.
+  std::unique_ptr<Cluster> GpuCluster(const string& architecture) {
+    DeviceProperties device_properties;
+    device_properties.set_type("GPU");
+    device_properties.mutable_environment()->insert(
+        {"architecture", architecture});
+    std::unique_ptr<Cluster> cluster(new VirtualCluster(
+        {{"/job:localhost/replica:0/task:0/device:GPU:0",
+          device_properties}}));
+    TF_CHECK_OK(cluster->Provision());
+    return cluster;
+  }
+
+  // x -> MatMul -> Relu -> Exp -> Add -> Identity
+  GrapplerItem MatMulExpItem() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output x = ops::Const(s.WithOpName("x"), 1.0f, {4, 4});
+    Output w = ops::Const(s.WithOpName("w"), 2.0f, {4, 4});
+    Output matmul = ops::MatMul(s.WithOpName("matmul"), x, w);
+    Output relu = ops::Relu(s.WithOpName("relu"), matmul);
+    Output exp = ops::Exp(s.WithOpName("exp"), relu);
+    Output add = ops::Add(s.WithOpName("add"), exp, x);
+    Output fetch = ops::Identity(s.WithOpName("fetch"), add);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+};
+
+TEST_F(AutoMixedPrecisionTest, ConvertsBetweenCasts) {
+  GrapplerItem item = MatMulExpItem();
+  std::unique_ptr<Cluster> cluster = GpuCluster("7.0");
+
+  AutoMixedPrecision optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* matmul = node_map.GetNode("matmul");
+  ASSERT_NE(nullptr, matmul);
+  EXPECT_EQ(DT_HALF, matmul->attr().at("T").type());
+  EXPECT_EQ("x-0-CastToFp16-AutoMixedPrecision", matmul->input(0));
+  EXPECT_EQ("w-0-CastToFp16-AutoMixedPrecision", matmul->input(1));
+
+  // The Relu runs in float16 next to the MatMul, so that only its output is
+  // cast back for the Exp.
+  const NodeDef* relu = node_map.GetNode("relu");
+  ASSERT_NE(nullptr, relu);
+  EXPECT_EQ(DT_HALF, relu->attr().at("T").type());
+  EXPECT_EQ("matmul", relu->input(0));
+  const NodeDef* exp = node_map.GetNode("exp");
+  ASSERT_NE(nullptr, exp);
+  EXPECT_EQ(DT_FLOAT, exp->attr().at("T").type());
+  EXPECT_EQ("relu-0-CastToFp32-AutoMixedPrecision", exp->input(0));
+
+  // The Add follows the Exp, so it stays in float32 and reads x directly.
+  const NodeDef* add = node_map.GetNode("add");
+  ASSERT_NE(nullptr, add);
+  EXPECT_EQ(DT_FLOAT, add->attr().at("T").type());
+  EXPECT_EQ("exp", add->input(0));
+  EXPECT_EQ("x", add->input(1));
+
+  EXPECT_EQ(3, CountOpNodes(output, "Cast"));
+  const NodeDef* cast =
+      node_map.GetNode("relu-0-CastToFp32-AutoMixedPrecision");
+  ASSERT_NE(nullptr, cast);
+  EXPECT_EQ(DT_HALF, cast->attr().at("SrcT").type());
+  EXPECT_EQ(DT_FLOAT, cast->attr().at("DstT").type());
+}
+
+TEST_F(AutoMixedPrecisionTest, NoTensorCores) {
+  GrapplerItem item = MatMulExpItem();
+  std::unique_ptr<Cluster> cluster = GpuCluster("6.0");
+
+  AutoMixedPrecision optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+  CompareGraphs(item.graph, output);
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -52,6 +53,11 @@ namespace grappler {
 using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 
 namespace {
+// Folded constants larger than this are only materialized if they are not
+// much larger than the constants they are computed from.
+constexpr size_t kMaxConstantExpansionSize = 1024 * 1024;
+constexpr size_t kMaxConstantExpansionRatio = 10;
+
 class EigenThreadPoolWrapper : public Eigen::ThreadPoolInterface {
  public:
   explicit EigenThreadPoolWrapper(thread::ThreadPool* pool) : pool_(pool) {}
@@ -1009,8 +1015,8 @@ Status ConstantFolding::EvaluateNode(const NodeDef& node,
   return op_context.status();
 }
 
-Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
-                                            std::vector<NodeDef>* outputs) {
+Status ConstantFolding::EvaluateOneFoldable(
+    const NodeDef& node, std::vector<NodeDef>* outputs) const {
   TensorVector inputs;
   TensorVector output_tensors;
   auto inputs_cleanup = gtl::MakeCleanup([&inputs, &output_tensors] {
@@ -1024,6 +1030,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     }
   });
 
+  size_t input_size = 0;
   for (const auto& input : node.input()) {
     int port = 0;
     ParseNodeNameAsStringPiece(input, &port);
@@ -1041,6 +1048,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     Tensor* value = new Tensor(raw_val.dtype(), raw_val.tensor_shape());
     CHECK(value->FromProto(raw_val));
     inputs.emplace_back(value);
+    input_size += raw_val.ByteSizeLong();
   }
 
   TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
@@ -1057,6 +1065,17 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     if (output_tensors[i].tensor) {
       TF_RETURN_IF_ERROR(
           CreateNodeDef(node_name, output_tensors[i], &outputs->at(i)));
+      // Ops such as Tile or Diag cheaply expand small inputs into large
+      // tensors. Materializing those as constants would bloat the graph by
+      // far more than the computation it saves.
+      const size_t output_size =
+          outputs->at(i).attr().at("value").tensor().ByteSizeLong();
+      if (output_size > kMaxConstantExpansionSize &&
+          output_size > kMaxConstantExpansionRatio * input_size) {
+        return errors::InvalidArgument(
+            "Can't fold ", node.name(), ", its output would be ", output_size,
+            " bytes from ", input_size, " bytes of inputs");
+      }
     } else {
       // Create an empty NodeDef to identify dead outputs (e.g. the output of a
       // switch that's not selected by the switch predicate).
@@ -1066,7 +1085,9 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
   return Status::OK();
 }
 
-Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
+Status ConstantFolding::FoldNode(NodeDef* node,
+                                 std::vector<NodeDef>* const_nodes,
+                                 GraphDef* output_graph) {
   if (IsMerge(*node)) {
     // Merge nodes are special, in the sense that they execute as soon as one of
     // their input is ready. We can therefore fold a merge node iff it has at
@@ -1158,11 +1179,9 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
     return Status::OK();
   }
 
-  std::vector<NodeDef> const_nodes;
-  TF_RETURN_IF_ERROR(EvaluateOneFoldable(*node, &const_nodes));
   NodeDef* constant_output = nullptr;
-  for (int i = 0; i < const_nodes.size(); i++) {
-    NodeDef* const_node = &const_nodes[i];
+  for (int i = 0; i < const_nodes->size(); i++) {
+    NodeDef* const_node = &const_nodes->at(i);
     if (const_node->name().empty()) {
       // Dead output: we can't create a constant to encode its value, so we'll
       // just skip it. We'll preserve the edges that originate from that
@@ -1191,7 +1210,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
 
     // We rewrite the existing node if it only has a single output, and
     // create new nodes otherwise.
-    if (const_nodes.size() == 1) {
+    if (const_nodes->size() == 1) {
       node->set_op("Const");
       // Note we need to clear the inputs in NodeMap before we clear the inputs
       // in the node, otherwise NodeMap would see empty inputs and effectively
@@ -1224,7 +1243,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
     }
   }
 
-  if (const_nodes.size() > 1) {
+  if (const_nodes->size() > 1) {
     auto outputs = node_map_->GetOutputs(node->name());
     for (NodeDef* output : outputs) {
       for (int i = 0; i < output->input_size(); i++) {
@@ -1239,12 +1258,12 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
                                      constant_output->name());
               *output->mutable_input(i) = AsControlDependency(*constant_output);
             }
-          } else if (port < const_nodes.size() &&
-                     !const_nodes[port].name().empty()) {
+          } else if (port < const_nodes->size() &&
+                     !(*const_nodes)[port].name().empty()) {
             // Replace alive outputs with the corresponding constant.
             node_map_->UpdateInput(output->name(), NodeName(output->input(i)),
-                                   const_nodes[port].name());
-            *output->mutable_input(i) = const_nodes[port].name();
+                                   (*const_nodes)[port].name());
+            *output->mutable_input(i) = (*const_nodes)[port].name();
           } else {
             // Leave this edge alone.
             VLOG(1) << "Preserving edge from " << node->name() << ":" << port
@@ -1272,30 +1291,66 @@ Status ConstantFolding::FoldGraph(GraphDef* output) {
       queue.push_back(graph_->mutable_node(i));
     }
   }
+  std::unique_ptr<thread::ThreadPool> eval_pool;
   while (!queue.empty()) {
-    NodeDef* node = queue.front();
-    queue.pop_front();
-    if (processed_nodes.count(node->name())) {
-      continue;
-    }
-    // We need to record a copy of output nodes before FoldNode() modifies it.
-    // We also need to ensure that the fanout is sorted deterministically.
-    const std::set<NodeDef*>& outputs = node_map_->GetOutputs(node->name());
-    std::vector<NodeDef*> fanout(outputs.begin(), outputs.end());
-    std::sort(fanout.begin(), fanout.end(),
-              [](const NodeDef* n1, const NodeDef* n2) {
-                return n1->name() < n2->name();
-              });
-
-    Status s = FoldNode(node, output);
-    processed_nodes.insert(node->name());
-    if (!s.ok()) {
-      VLOG(1) << "Failed to fold node " << node->DebugString()
-              << "\nError message: " << s;
+    // The nodes in the queue only read constants, so none of them depends on
+    // another: evaluate them all concurrently, then update the graph one node
+    // at a time.
+    std::vector<NodeDef*> nodes;
+    for (NodeDef* node : queue) {
+      if (processed_nodes.insert(node->name()).second) {
+        nodes.push_back(node);
+      }
+    }
+    queue.clear();
+
+    std::vector<std::vector<NodeDef>> const_nodes(nodes.size());
+    std::vector<Status> eval_status(nodes.size());
+    auto evaluate = [this, &nodes, &const_nodes, &eval_status](int64 start,
+                                                               int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        if (!IsMerge(*nodes[i])) {
+          eval_status[i] = EvaluateOneFoldable(*nodes[i], &const_nodes[i]);
+        }
+      }
+    };
+    if (nodes.size() > 1) {
+      if (eval_pool == nullptr) {
+        eval_pool.reset(new thread::ThreadPool(Env::Default(),
+                                               "constant_folding_eval",
+                                               port::NumSchedulableCPUs()));
+      }
+      // Evaluating a node is expensive compared to scheduling it.
+      const int64 kCostPerNode = 100000;
+      eval_pool->ParallelFor(nodes.size(), kCostPerNode, evaluate);
     } else {
-      for (auto& output : fanout) {
-        if (IsFoldable(*output)) {
-          queue.push_back(output);
+      evaluate(0, nodes.size());
+    }
+
+    for (int i = 0; i < nodes.size(); ++i) {
+      NodeDef* node = nodes[i];
+      // We need to record a copy of output nodes before FoldNode() modifies
+      // it. We also need to ensure that the fanout is sorted
+      // deterministically.
+      const std::set<NodeDef*>& outputs = node_map_->GetOutputs(node->name());
+      std::vector<NodeDef*> fanout(outputs.begin(), outputs.end());
+      std::sort(fanout.begin(), fanout.end(),
+                [](const NodeDef* n1, const NodeDef* n2) {
+                  return n1->name() < n2->name();
+                });
+
+      Status s = eval_status[i];
+      if (s.ok()) {
+        s = FoldNode(node, &const_nodes[i], output);
+      }
+      if (!s.ok()) {
+        VLOG(1) << "Failed to fold node " << node->DebugString()
+                << "\nError message: " << s;
+      } else {
+        for (auto& output : fanout) {
+          if (IsFoldable(*output)) {
+            queue.push_back(output);
+          }
         }
       }
     }
@@ -72,9 +72,13 @@ class ConstantFolding : public GraphOptimizer {
                       gtl::InlinedVector<TensorValue, 4>* output) const;
 
   Status EvaluateOneFoldable(const NodeDef& node,
-                             std::vector<NodeDef>* outputs);
+                             std::vector<NodeDef>* outputs) const;
 
-  Status FoldNode(NodeDef* node, GraphDef* output_graph);
+  // Folds 'node' into the constants in 'const_nodes', as computed by
+  // EvaluateOneFoldable. Merge nodes don't need to be evaluated and ignore
+  // 'const_nodes'.
+  Status FoldNode(NodeDef* node, std::vector<NodeDef>* const_nodes,
+                  GraphDef* output_graph);
 
   bool IsOnes(const NodeDef& node) const;
   bool IsZeros(const NodeDef& node) const;
@@ -2565,6 +2565,46 @@ TEST_F(ConstantFoldingTest, LargeConstant) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, LargeExpansion) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  // Tile 256 distinct values into a 2MB tensor that doesn't pack well.
+  Tensor values(DT_FLOAT, TensorShape({256}));
+  test::FillIota<float>(&values, 0.0f);
+  Output c = ops::Const(scope.WithOpName("c"), Input::Initializer(values));
+  Output multiples = ops::Const(scope.WithOpName("multiples"), {2048}, {1});
+  Output tile = ops::Tile(scope.WithOpName("tile"), c, multiples);
+  Output small = ops::Neg(scope.WithOpName("small"), c);
+  Output out = ops::Add(scope.WithOpName("out"), tile, tile);
+  Output out_small = ops::Identity(scope.WithOpName("out_small"), small);
+
+  GrapplerItem item;
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+  item.fetch = {"out", "out_small"};
+
+  ConstantFolding optimizer(nullptr /* cpu_device */);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The tile is much cheaper to recompute than to store in the graph, while
+  // the negation, whose output is as small as its input, is folded.
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "tile") {
+      EXPECT_EQ("Tile", node.op());
+    } else if (node.name() == "small") {
+      EXPECT_EQ("Const", node.op());
+    }
+  }
+  EXPECT_GT(1024 * 1024, output.ByteSizeLong());
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  EXPECT_EQ(2, tensors_expected.size());
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(2, tensors.size());
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
 TEST_F(ConstantFoldingTest, SwitchIdenticalInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output x = ops::Placeholder(s.WithOpName("x"), DT_BOOL,
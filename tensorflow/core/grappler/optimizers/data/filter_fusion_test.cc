@@ -0,0 +1,141 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/filter_fusion.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+typedef FunctionDefHelper FDH;
+
+// x: int64 -> x > 0
+FunctionDef IsPositive() {
+  return FDH::Define(
+      "IsPositive", {"x: int64"}, {"y: bool"}, {},
+      {{{"zero"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<int64>(0)}, {"dtype", DT_INT64}}},
+       {{"y"}, "Greater", {"x", "zero"}, {{"T", DT_INT64}}}});
+}
+
+// x: int64, limit: int64 -> x < limit
+FunctionDef IsLess() {
+  return FDH::Define("IsLess", {"x: int64", "limit: int64"}, {"y: bool"}, {},
+                     {{{"y"}, "Less", {"x", "limit"}, {{"T", DT_INT64}}}});
+}
+
+// Adds a FilterDataset of "input" with "predicate".
+NodeDef *AddFilter(const string &input, const string &predicate,
+                   const std::vector<string> &captured, GraphDef *graph) {
+  std::vector<string> inputs = {input};
+  inputs.insert(inputs.end(), captured.begin(), captured.end());
+  AttrValue predicate_attr;
+  predicate_attr.mutable_func()->set_name(predicate);
+  AttrValue arguments;
+  SetAttrValue(DataTypeVector(captured.size(), DT_INT64), &arguments);
+  NodeDef *filter_node;
+  TF_CHECK_OK(graph_utils::AddNode(
+      "", "FilterDataset", inputs,
+      {{"predicate", predicate_attr}, {"Targuments", arguments}}, graph,
+      &filter_node));
+  return filter_node;
+}
+
+TEST(FilterFusionTest, FusesFiltersIntoConjunction) {
+  GrapplerItem item;
+  GraphDef *graph = &item.graph;
+  *graph->mutable_library()->add_function() = IsPositive();
+  *graph->mutable_library()->add_function() = IsLess();
+  NodeDef *start_node;
+  TF_ASSERT_OK(graph_utils::AddScalarConstNode<int64>(-5, graph, &start_node));
+  NodeDef *stop_node;
+  TF_ASSERT_OK(graph_utils::AddScalarConstNode<int64>(10, graph, &stop_node));
+  NodeDef *step_node;
+  TF_ASSERT_OK(graph_utils::AddScalarConstNode<int64>(1, graph, &step_node));
+  NodeDef *range_node;
+  TF_ASSERT_OK(graph_utils::AddNode(
+      "", "RangeDataset",
+      {start_node->name(), stop_node->name(), step_node->name()}, {}, graph,
+      &range_node));
+  NodeDef *limit_node;
+  TF_ASSERT_OK(graph_utils::AddScalarConstNode<int64>(5, graph, &limit_node));
+  const string filter1 =
+      AddFilter(range_node->name(), "IsPositive", {}, graph)->name();
+  const string filter2 =
+      AddFilter(filter1, "IsLess", {limit_node->name()}, graph)->name();
+
+  FilterFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName(filter1, output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithName(filter2, output));
+  const NodeDef &filter_node =
+      output.node(graph_utils::FindNodeWithName(filter2, output));
+  ASSERT_EQ(2, filter_node.input_size());
+  EXPECT_EQ(range_node->name(), filter_node.input(0));
+  EXPECT_EQ(limit_node->name(), filter_node.input(1));
+  EXPECT_EQ(1, filter_node.attr().at("Targuments").list().type_size());
+
+  // The fused predicate takes the element and the limit, and returns the
+  // conjunction of the predicates.
+  const string &fused = filter_node.attr().at("predicate").func().name();
+  FunctionLibraryDefinition lib(OpRegistry::Global(), output.library());
+  const FunctionDef *fused_def = lib.Find(fused);
+  ASSERT_NE(nullptr, fused_def);
+  EXPECT_EQ(2, fused_def->signature().input_arg_size());
+  ASSERT_EQ(1, fused_def->signature().output_arg_size());
+  EXPECT_EQ(DT_BOOL, fused_def->signature().output_arg(0).type());
+  InstantiationResult result;
+  TF_EXPECT_OK(InstantiateFunction(
+      *fused_def, AttrSlice(),
+      [&lib](const string &op, const OpDef **sig) {
+        return lib.LookUpOpDef(op, sig);
+      },
+      &result));
+}
+
+TEST(FilterFusionTest, DoesNotFuseIncompatiblePredicates) {
+  GrapplerItem item;
+  GraphDef *graph = &item.graph;
+  *graph->mutable_library()->add_function() = IsPositive();
+  *graph->mutable_library()->add_function() = IsLess();
+  NodeDef *range_node;
+  TF_ASSERT_OK(
+      graph_utils::AddNode("", "RangeDataset", {}, {}, graph, &range_node));
+  // IsLess is given no captured input for its limit.
+  const string filter1 =
+      AddFilter(range_node->name(), "IsPositive", {}, graph)->name();
+  AddFilter(filter1, "IsLess", {}, graph);
+
+  FilterFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::Compare(item.graph, output));
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,321 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/fusion_utils.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/grappler/graph_view.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace fusion_utils {
+namespace {
+
+const FunctionDef* FindFunction(const string& name,
+                                const FunctionDefLibrary& library) {
+  for (const FunctionDef& function : library.function()) {
+    if (function.signature().name() == name) return &function;
+  }
+  return nullptr;
+}
+
+// Looks up the definitions of "first" and "second".
+Status FindFunctions(const NameAttrList& first, const NameAttrList& second,
+                     const FunctionDefLibrary& library,
+                     const FunctionDef** first_def,
+                     const FunctionDef** second_def) {
+  *first_def = FindFunction(first.name(), library);
+  *second_def = FindFunction(second.name(), library);
+  if (*first_def == nullptr || *second_def == nullptr) {
+    return errors::NotFound("Function ",
+                            *first_def == nullptr ? first.name()
+                                                  : second.name(),
+                            " is not in the library");
+  }
+  for (const FunctionDef* def : {*first_def, *second_def}) {
+    for (const auto* args :
+         {&def->signature().input_arg(), &def->signature().output_arg()}) {
+      for (const OpDef::ArgDef& arg : *args) {
+        if (!arg.number_attr().empty() || !arg.type_list_attr().empty()) {
+          return errors::Unimplemented("Function ", def->signature().name(),
+                                       " has list argument ", arg.name());
+        }
+      }
+    }
+  }
+  return Status::OK();
+}
+
+// Returns the type of "arg" of "function" when it is called with the attrs
+// of "func".
+Status ArgType(const NameAttrList& func, const OpDef::ArgDef& arg,
+               DataType* type) {
+  if (arg.type_attr().empty()) {
+    *type = arg.type();
+    return Status::OK();
+  }
+  auto it = func.attr().find(arg.type_attr());
+  if (it == func.attr().end()) {
+    return errors::InvalidArgument("Function ", func.name(),
+                                   " is missing attr ", arg.type_attr());
+  }
+  *type = it->second.type();
+  return Status::OK();
+}
+
+// Adds an argument to the signature of "fused" for "arg" of "func".
+Status AddInputArg(const NameAttrList& func, const OpDef::ArgDef& arg,
+                   const string& name, FunctionDef* fused) {
+  OpDef::ArgDef* fused_arg = fused->mutable_signature()->add_input_arg();
+  fused_arg->set_name(name);
+  DataType type;
+  TF_RETURN_IF_ERROR(ArgType(func, arg, &type));
+  fused_arg->set_type(type);
+  return Status::OK();
+}
+
+// Starts "*fused" as a function with a call to "first" and one to "second",
+// named after them and unlike the functions in "library".
+void StartFusedFunction(const NameAttrList& first,
+                        const FunctionDef& first_def,
+                        const NameAttrList& second,
+                        const FunctionDef& second_def,
+                        const FunctionDefLibrary& library, FunctionDef* fused) {
+  const string prefix =
+      strings::StrCat("fused_", first.name(), "_", second.name());
+  string name = prefix;
+  for (int i = 1; FindFunction(name, library) != nullptr; ++i) {
+    name = strings::StrCat(prefix, "_", i);
+  }
+  fused->mutable_signature()->set_name(name);
+  fused->mutable_signature()->set_is_stateful(
+      first_def.signature().is_stateful() ||
+      second_def.signature().is_stateful());
+  for (const auto& call : {std::make_pair("first", &first),
+                           std::make_pair("second", &second)}) {
+    NodeDef* node = fused->add_node_def();
+    node->set_name(call.first);
+    node->set_op(call.second->name());
+    *node->mutable_attr() = call.second->attr();
+  }
+}
+
+// Fuses the first pair of nodes found by FuseChains, if any.
+Status FuseNextPair(const string& op, const string& func_attr,
+                    int num_trailing_inputs,
+                    const FunctionFuser& fuse_functions, GraphDef* graph,
+                    bool* fused) {
+  *fused = false;
+  GraphView view(graph);
+  for (NodeDef& consumer : *graph->mutable_node()) {
+    if (consumer.op() != op) continue;
+    NodeDef* producer =
+        view.GetRegularFanin(view.GetInputPort(consumer.name(), 0)).node;
+    if (producer == nullptr || producer->op() != op ||
+        view.GetFanouts(*producer, true).size() != 1) {
+      continue;
+    }
+    bool same_attrs = true;
+    for (const auto& attr : consumer.attr()) {
+      if (attr.first == func_attr || attr.first == "Targuments" ||
+          attr.first == "output_types" || attr.first == "output_shapes") {
+        continue;
+      }
+      auto it = producer->attr().find(attr.first);
+      same_attrs &= it != producer->attr().end() &&
+                    AreAttrValuesEqual(it->second, attr.second);
+    }
+    if (!same_attrs) continue;
+
+    const int num_producer_captured =
+        NumNonControlInputs(*producer) - 1 - num_trailing_inputs;
+    const int num_consumer_captured =
+        NumNonControlInputs(consumer) - 1 - num_trailing_inputs;
+    string fused_function;
+    Status s = fuse_functions(producer->attr().at(func_attr).func(),
+                              num_producer_captured,
+                              consumer.attr().at(func_attr).func(),
+                              num_consumer_captured, graph->mutable_library(),
+                              &fused_function);
+    if (!s.ok()) {
+      VLOG(1) << "Not fusing " << producer->name() << " into "
+              << consumer.name() << ": " << s;
+      continue;
+    }
+
+    // The fused node takes the input dataset and captured inputs of the
+    // producer, then the other inputs of the consumer.
+    std::vector<string> inputs;
+    std::vector<string> control_inputs;
+    for (int i = 0; i <= num_producer_captured; ++i) {
+      inputs.push_back(producer->input(i));
+    }
+    for (const NodeDef* node : {producer, &consumer}) {
+      for (int i = 0; i < node->input_size(); ++i) {
+        if (IsControlInput(node->input(i))) {
+          control_inputs.push_back(node->input(i));
+        } else if (node == &consumer && i > 0) {
+          inputs.push_back(node->input(i));
+        }
+      }
+    }
+    consumer.clear_input();
+    for (const string& input : inputs) consumer.add_input(input);
+    for (const string& input : control_inputs) consumer.add_input(input);
+
+    NameAttrList* func = (*consumer.mutable_attr())[func_attr].mutable_func();
+    func->set_name(fused_function);
+    func->clear_attr();
+    AttrValue arguments = producer->attr().at("Targuments");
+    for (int type : consumer.attr().at("Targuments").list().type()) {
+      arguments.mutable_list()->add_type(static_cast<DataType>(type));
+    }
+    (*consumer.mutable_attr())["Targuments"] = arguments;
+
+    *fused = true;
+    return graph_utils::DeleteNodes({producer->name()}, graph);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ComposeFunctions(const NameAttrList& first, int num_first_captured,
+                        const NameAttrList& second, int num_second_captured,
+                        FunctionDefLibrary* library, string* fused_name) {
+  const FunctionDef* first_def;
+  const FunctionDef* second_def;
+  TF_RETURN_IF_ERROR(
+      FindFunctions(first, second, *library, &first_def, &second_def));
+  const OpDef& first_sig = first_def->signature();
+  const OpDef& second_sig = second_def->signature();
+  if (first_sig.input_arg_size() < num_first_captured ||
+      second_sig.input_arg_size() !=
+          first_sig.output_arg_size() + num_second_captured) {
+    return errors::InvalidArgument("The outputs of ", first.name(),
+                                   " are not the inputs of ", second.name());
+  }
+
+  // The new function is added last, as adding it may invalidate the
+  // definitions of "first" and "second".
+  FunctionDef fused_def;
+  FunctionDef* fused = &fused_def;
+  StartFusedFunction(first, *first_def, second, *second_def, *library, fused);
+  NodeDef* first_call = fused->mutable_node_def(0);
+  NodeDef* second_call = fused->mutable_node_def(1);
+  for (const OpDef::ArgDef& arg : first_sig.input_arg()) {
+    const string name = strings::StrCat("first_", arg.name());
+    TF_RETURN_IF_ERROR(AddInputArg(first, arg, name, fused));
+    first_call->add_input(name);
+  }
+  for (const OpDef::ArgDef& arg : first_sig.output_arg()) {
+    second_call->add_input(strings::StrCat("first:", arg.name(), ":0"));
+  }
+  for (int i = first_sig.output_arg_size(); i < second_sig.input_arg_size();
+       ++i) {
+    const OpDef::ArgDef& arg = second_sig.input_arg(i);
+    const string name = strings::StrCat("second_", arg.name());
+    TF_RETURN_IF_ERROR(AddInputArg(second, arg, name, fused));
+    second_call->add_input(name);
+  }
+  for (const OpDef::ArgDef& arg : second_sig.output_arg()) {
+    OpDef::ArgDef* output = fused->mutable_signature()->add_output_arg();
+    output->set_name(arg.name());
+    DataType type;
+    TF_RETURN_IF_ERROR(ArgType(second, arg, &type));
+    output->set_type(type);
+    (*fused->mutable_ret())[arg.name()] =
+        strings::StrCat("second:", arg.name(), ":0");
+  }
+
+  *fused_name = fused->signature().name();
+  *library->add_function() = *fused;
+  return Status::OK();
+}
+
+Status CombinePredicates(const NameAttrList& first, int num_first_captured,
+                         const NameAttrList& second, int num_second_captured,
+                         FunctionDefLibrary* library, string* fused_name) {
+  const FunctionDef* first_def;
+  const FunctionDef* second_def;
+  TF_RETURN_IF_ERROR(
+      FindFunctions(first, second, *library, &first_def, &second_def));
+  const OpDef& first_sig = first_def->signature();
+  const OpDef& second_sig = second_def->signature();
+  const int num_components = first_sig.input_arg_size() - num_first_captured;
+  if (num_components < 0 ||
+      second_sig.input_arg_size() != num_components + num_second_captured ||
+      first_sig.output_arg_size() != 1 || second_sig.output_arg_size() != 1) {
+    return errors::InvalidArgument("Predicates ", first.name(), " and ",
+                                   second.name(), " can't be combined");
+  }
+
+  FunctionDef fused_def;
+  FunctionDef* fused = &fused_def;
+  StartFusedFunction(first, *first_def, second, *second_def, *library, fused);
+  NodeDef* first_call = fused->mutable_node_def(0);
+  NodeDef* second_call = fused->mutable_node_def(1);
+  for (int i = 0; i < first_sig.input_arg_size(); ++i) {
+    const OpDef::ArgDef& arg = first_sig.input_arg(i);
+    const string name = strings::StrCat("first_", arg.name());
+    TF_RETURN_IF_ERROR(AddInputArg(first, arg, name, fused));
+    first_call->add_input(name);
+    if (i < num_components) second_call->add_input(name);
+  }
+  for (int i = num_components; i < second_sig.input_arg_size(); ++i) {
+    const OpDef::ArgDef& arg = second_sig.input_arg(i);
+    const string name = strings::StrCat("second_", arg.name());
+    TF_RETURN_IF_ERROR(AddInputArg(second, arg, name, fused));
+    second_call->add_input(name);
+  }
+
+  NodeDef* conjunction = fused->add_node_def();
+  conjunction->set_name("and");
+  conjunction->set_op("LogicalAnd");
+  conjunction->add_input(
+      strings::StrCat("first:", first_sig.output_arg(0).name(), ":0"));
+  conjunction->add_input(
+      strings::StrCat("second:", second_sig.output_arg(0).name(), ":0"));
+  OpDef::ArgDef* output = fused->mutable_signature()->add_output_arg();
+  output->set_name("output");
+  output->set_type(DT_BOOL);
+  (*fused->mutable_ret())["output"] = "and:z:0";
+
+  *fused_name = fused->signature().name();
+  *library->add_function() = *fused;
+  return Status::OK();
+}
+
+Status FuseChains(const string& op, const string& func_attr,
+                  int num_trailing_inputs, const FunctionFuser& fuse_functions,
+                  GraphDef* graph) {
+  bool fused = true;
+  while (fused) {
+    TF_RETURN_IF_ERROR(FuseNextPair(op, func_attr, num_trailing_inputs,
+                                    fuse_functions, graph, &fused));
+  }
+  return Status::OK();
+}
+
+}  // end namespace fusion_utils
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_FUSION_UTILS_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_FUSION_UTILS_H_
+
+#include <functional>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace fusion_utils {
+
+// Adds to "library" a function that computes `second(first(x, a), b)`, where
+// `x` are the components of an element and `a` and `b` are the
+// "num_first_captured" and "num_second_captured" captured inputs of the
+// functions. The arguments of the new function are `x`, `a` and `b`, in that
+// order. Sets "*fused_name" to the name of the new function.
+//
+// The new function calls the two functions with their instantiation attrs,
+// so both must stay in "library". Returns an error if the functions have
+// list arguments or if the outputs of "first" are not the inputs of
+// "second".
+Status ComposeFunctions(const NameAttrList& first, int num_first_captured,
+                        const NameAttrList& second, int num_second_captured,
+                        FunctionDefLibrary* library, string* fused_name);
+
+// Like ComposeFunctions, but adds a predicate that computes
+// `first(x, a) && second(x, b)` from two predicates over the same elements.
+Status CombinePredicates(const NameAttrList& first, int num_first_captured,
+                         const NameAttrList& second, int num_second_captured,
+                         FunctionDefLibrary* library, string* fused_name);
+
+// Fuses two functions into a new function of "library", like the ones above.
+typedef std::function<Status(const NameAttrList&, int, const NameAttrList&,
+                             int, FunctionDefLibrary*, string*)>
+    FunctionFuser;
+
+// Replaces the nodes with op "op" whose input dataset is produced by another
+// node with op "op" by a single node, until no such pair is left. The single
+// node applies the fusion of the functions of the two nodes in attr
+// "func_attr". "num_trailing_inputs" is the number of inputs of "op" after
+// its captured inputs, which are taken from the consumer.
+//
+// A pair is not fused if the producer has other consumers, if the nodes
+// differ in other attrs, or if "fuse_functions" fails.
+Status FuseChains(const string& op, const string& func_attr,
+                  int num_trailing_inputs, const FunctionFuser& fuse_functions,
+                  GraphDef* graph);
+
+}  // end namespace fusion_utils
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_FUSION_UTILS_H_
@@ -0,0 +1,160 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_fusion.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+typedef FunctionDefHelper FDH;
+
+// x: int64, y: int64 -> x + y
+FunctionDef AddY() {
+  return FDH::Define("AddY", {"x: int64", "y: int64"}, {"z: int64"}, {},
+                     {{{"z"}, "Add", {"x", "y"}, {{"T", DT_INT64}}}});
+}
+
+NodeDef *AddRange(GraphDef *graph) {
+  NodeDef *start_node;
+  TF_CHECK_OK(graph_utils::AddScalarConstNode<int64>(0, graph, &start_node));
+  NodeDef *stop_node;
+  TF_CHECK_OK(graph_utils::AddScalarConstNode<int64>(10, graph, &stop_node));
+  NodeDef *step_node;
+  TF_CHECK_OK(graph_utils::AddScalarConstNode<int64>(1, graph, &step_node));
+  NodeDef *range_node;
+  TF_CHECK_OK(graph_utils::AddNode(
+      "", "RangeDataset",
+      {start_node->name(), stop_node->name(), step_node->name()}, {}, graph,
+      &range_node));
+  return range_node;
+}
+
+// Adds a MapDataset of "input" that applies "function" with T=int64.
+NodeDef *AddMap(const string &input, const string &function,
+                const std::vector<string> &captured, GraphDef *graph) {
+  std::vector<string> inputs = {input};
+  inputs.insert(inputs.end(), captured.begin(), captured.end());
+  AttrValue f;
+  f.mutable_func()->set_name(function);
+  if (function != "AddY") {
+    (*f.mutable_func()->mutable_attr())["T"].set_type(DT_INT64);
+  }
+  AttrValue arguments;
+  SetAttrValue(DataTypeVector(captured.size(), DT_INT64), &arguments);
+  AttrValue types;
+  SetAttrValue(DataTypeVector({DT_INT64}), &types);
+  AttrValue shapes;
+  SetAttrValue(std::vector<PartialTensorShape>{PartialTensorShape({})},
+               &shapes);
+  NodeDef *map_node;
+  TF_CHECK_OK(graph_utils::AddNode("", "MapDataset", inputs,
+                                   {{"f", f},
+                                    {"Targuments", arguments},
+                                    {"output_types", types},
+                                    {"output_shapes", shapes}},
+                                   graph, &map_node));
+  return map_node;
+}
+
+// Checks that "function" of "library" can be instantiated.
+void ExpectValidFunction(const string &function,
+                         const FunctionDefLibrary &library) {
+  FunctionLibraryDefinition lib(OpRegistry::Global(), library);
+  InstantiationResult result;
+  TF_EXPECT_OK(InstantiateFunction(
+      *lib.Find(function), AttrSlice(),
+      [&lib](const string &op, const OpDef **sig) {
+        return lib.LookUpOpDef(op, sig);
+      },
+      &result));
+}
+
+TEST(MapFusionTest, FusesChainOfMaps) {
+  GrapplerItem item;
+  GraphDef *graph = &item.graph;
+  *graph->mutable_library()->add_function() = test::function::XTimesTwo();
+  *graph->mutable_library()->add_function() = test::function::XTimesFour();
+  *graph->mutable_library()->add_function() = AddY();
+  NodeDef *range_node = AddRange(graph);
+  NodeDef *captured_node;
+  TF_ASSERT_OK(
+      graph_utils::AddScalarConstNode<int64>(5, graph, &captured_node));
+  const string map1 =
+      AddMap(range_node->name(), "AddY", {captured_node->name()}, graph)
+          ->name();
+  const string map2 = AddMap(map1, "XTimesTwo", {}, graph)->name();
+  const string map3 = AddMap(map2, "XTimesFour", {}, graph)->name();
+  NodeDef *take_count;
+  TF_ASSERT_OK(graph_utils::AddScalarConstNode<int64>(3, graph, &take_count));
+  NodeDef *take_node;
+  TF_ASSERT_OK(graph_utils::AddNode("", "TakeDataset",
+                                    {map3, take_count->name()}, {}, graph,
+                                    &take_node));
+
+  MapFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The last map of the chain is kept and applies the fused function.
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName(map1, output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithName(map2, output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithName(map3, output));
+  const NodeDef &map_node =
+      output.node(graph_utils::FindNodeWithName(map3, output));
+  ASSERT_EQ(2, map_node.input_size());
+  EXPECT_EQ(range_node->name(), map_node.input(0));
+  EXPECT_EQ(captured_node->name(), map_node.input(1));
+  EXPECT_EQ(1, map_node.attr().at("Targuments").list().type_size());
+  const string &fused = map_node.attr().at("f").func().name();
+  EXPECT_EQ(5, output.library().function_size());
+  ExpectValidFunction(fused, output.library());
+
+  FunctionLibraryDefinition lib(OpRegistry::Global(), output.library());
+  const OpDef &signature = lib.Find(fused)->signature();
+  ASSERT_EQ(2, signature.input_arg_size());
+  EXPECT_EQ(DT_INT64, signature.input_arg(0).type());
+  EXPECT_EQ(DT_INT64, signature.input_arg(1).type());
+  ASSERT_EQ(1, signature.output_arg_size());
+  EXPECT_EQ(DT_INT64, signature.output_arg(0).type());
+}
+
+TEST(MapFusionTest, DoesNotFuseMapWithOtherConsumers) {
+  GrapplerItem item;
+  GraphDef *graph = &item.graph;
+  *graph->mutable_library()->add_function() = test::function::XTimesTwo();
+  NodeDef *range_node = AddRange(graph);
+  const string map1 =
+      AddMap(range_node->name(), "XTimesTwo", {}, graph)->name();
+  AddMap(map1, "XTimesTwo", {}, graph);
+  AddMap(map1, "XTimesTwo", {}, graph);
+
+  MapFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::Compare(item.graph, output));
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
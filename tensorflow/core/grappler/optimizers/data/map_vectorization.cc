@@ -0,0 +1,260 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/graph_view.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Ops that compute each element of their output from the same element of
+// their inputs, broadcasting scalars.
+const std::unordered_set<string>& ElementWiseOps() {
+  static const std::unordered_set<string>* ops =
+      new std::unordered_set<string>({
+          // Unary ops.
+          "Abs", "Cast", "Ceil", "Cos", "Exp", "Expm1", "Floor", "Identity",
+          "IsFinite", "IsInf", "IsNan", "Log", "Log1p", "LogicalNot", "Neg",
+          "Reciprocal", "Relu", "Relu6", "Rint", "Round", "Rsqrt", "Sigmoid",
+          "Sign", "Sin", "Softplus", "Sqrt", "Square", "Tanh",
+          // Binary ops.
+          "Add", "Div", "Equal", "FloorDiv", "FloorMod", "Greater",
+          "GreaterEqual", "Less", "LessEqual", "LogicalAnd", "LogicalOr",
+          "Maximum", "Minimum", "Mod", "Mul", "NotEqual", "Pow", "RealDiv",
+          "SquaredDifference", "Sub", "TruncateDiv", "TruncateMod",
+      });
+  return *ops;
+}
+
+const FunctionDef* FindFunction(const string& name,
+                                const FunctionDefLibrary& library) {
+  for (const FunctionDef& function : library.function()) {
+    if (function.signature().name() == name) return &function;
+  }
+  return nullptr;
+}
+
+bool IsScalarConst(const NodeDef& node) {
+  if (node.op() != "Const") return false;
+  auto it = node.attr().find("value");
+  return it != node.attr().end() &&
+         it->second.tensor().tensor_shape().dim_size() == 0;
+}
+
+// Returns whether "function" can be applied to a batch of elements as it
+// is, given whether all the components of the elements have the same
+// shape. A binary op on two batched tensors needs their elements to have
+// the same shape, while one on a batched tensor and a scalar broadcasts
+// the scalar to the whole batch. Every output must be batched.
+bool IsVectorizable(const FunctionDef& function, bool same_component_shapes) {
+  // Whether each argument and node output depends on the elements.
+  std::unordered_map<string, bool> batched;
+  for (const OpDef::ArgDef& arg : function.signature().input_arg()) {
+    batched[arg.name()] = true;
+  }
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : function.node_def()) {
+    nodes[node.name()] = &node;
+  }
+  // Visits the nodes in an order where the inputs come first.
+  std::vector<const NodeDef*> ready;
+  std::unordered_map<const NodeDef*, int> num_pending;
+  std::unordered_map<string, std::vector<const NodeDef*>> consumers;
+  for (const NodeDef& node : function.node_def()) {
+    if (node.op() != "Const" && ElementWiseOps().count(node.op()) == 0) {
+      VLOG(2) << "Op " << node.op() << " is not element-wise";
+      return false;
+    }
+    if (node.op() == "Const" && !IsScalarConst(node)) return false;
+    int pending = 0;
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) return false;
+      const string name = input.substr(0, input.find(':'));
+      if (nodes.count(name) > 0) {
+        consumers[name].push_back(&node);
+        ++pending;
+      } else if (batched.count(name) == 0) {
+        return false;
+      }
+    }
+    num_pending[&node] = pending;
+    if (pending == 0) ready.push_back(&node);
+  }
+  int num_visited = 0;
+  while (!ready.empty()) {
+    const NodeDef* node = ready.back();
+    ready.pop_back();
+    ++num_visited;
+    int num_batched_inputs = 0;
+    for (const string& input : node->input()) {
+      num_batched_inputs += batched[input.substr(0, input.find(':'))];
+    }
+    if (num_batched_inputs > 1 && !same_component_shapes) return false;
+    batched[node->name()] = num_batched_inputs > 0;
+    for (const NodeDef* consumer : consumers[node->name()]) {
+      if (--num_pending[consumer] == 0) ready.push_back(consumer);
+    }
+  }
+  if (num_visited != function.node_def_size()) return false;
+  for (const auto& ret : function.ret()) {
+    const string name = ret.second.substr(0, ret.second.find(':'));
+    if (!gtl::FindWithDefault(batched, name, false)) return false;
+  }
+  return true;
+}
+
+// Returns the types of the inputs of "function" when it is called as
+// "func".
+bool InputTypes(const FunctionDef& function, const NameAttrList& func,
+                DataTypeVector* types) {
+  for (const OpDef::ArgDef& arg : function.signature().input_arg()) {
+    if (!arg.number_attr().empty() || !arg.type_list_attr().empty()) {
+      return false;
+    }
+    if (arg.type_attr().empty()) {
+      types->push_back(arg.type());
+      continue;
+    }
+    auto it = func.attr().find(arg.type_attr());
+    if (it == func.attr().end()) return false;
+    types->push_back(it->second.type());
+  }
+  return true;
+}
+
+// Swaps the first vectorizable map found in "output" with its batch, if
+// any.
+Status VectorizeNextMap(GraphDef* output, bool* vectorized) {
+  *vectorized = false;
+  GraphView graph(output);
+  for (NodeDef& batch_node : *output->mutable_node()) {
+    if (batch_node.op() != "BatchDataset") continue;
+    NodeDef* map_node =
+        graph.GetRegularFanin(graph.GetInputPort(batch_node.name(), 0)).node;
+    if (map_node == nullptr ||
+        (map_node->op() != "MapDataset" &&
+         map_node->op() != "ParallelMapDataset") ||
+        graph.GetFanouts(*map_node, true).size() != 1) {
+      continue;
+    }
+    const int num_trailing_inputs =
+        map_node->op() == "ParallelMapDataset" ? 1 : 0;
+    if (NumNonControlInputs(*map_node) != 1 + num_trailing_inputs) {
+      // The captured inputs are not batched.
+      continue;
+    }
+    const NameAttrList& func = map_node->attr().at("f").func();
+    const FunctionDef* function = FindFunction(func.name(), output->library());
+    DataTypeVector input_types;
+    if (function == nullptr || function->signature().is_stateful() ||
+        !InputTypes(*function, func, &input_types) || input_types.empty()) {
+      continue;
+    }
+
+    // The shapes of the input elements, if the input dataset records them.
+    NodeDef* input_node = graph.GetNode(NodeName(map_node->input(0)));
+    std::vector<PartialTensorShape> input_shapes;
+    if (input_node != nullptr && input_node->attr().count("output_shapes")) {
+      for (const TensorShapeProto& shape :
+           input_node->attr().at("output_shapes").list().shape()) {
+        input_shapes.emplace_back(shape);
+      }
+    }
+    if (input_shapes.size() != input_types.size()) {
+      input_shapes.assign(input_types.size(), PartialTensorShape());
+    }
+    bool same_component_shapes = input_shapes[0].IsFullyDefined();
+    for (const PartialTensorShape& shape : input_shapes) {
+      same_component_shapes &= shape.IsIdenticalTo(input_shapes[0]);
+    }
+    if (!IsVectorizable(*function, same_component_shapes)) continue;
+
+    // Batch the input elements, then map the batches.
+    std::vector<PartialTensorShape> batched_shapes;
+    for (const PartialTensorShape& shape : input_shapes) {
+      batched_shapes.push_back(PartialTensorShape({-1}).Concatenate(shape));
+    }
+    AttrValue batched_types_attr;
+    SetAttrValue(input_types, &batched_types_attr);
+    AttrValue batched_shapes_attr;
+    SetAttrValue(batched_shapes, &batched_shapes_attr);
+    for (const char* key : {"output_types", "output_shapes"}) {
+      (*map_node->mutable_attr())[key] = batch_node.attr().at(key);
+    }
+    (*batch_node.mutable_attr())["output_types"] = batched_types_attr;
+    (*batch_node.mutable_attr())["output_shapes"] = batched_shapes_attr;
+
+    // The consumers of the batches now consume the mapped batches.
+    for (const GraphView::InputPort& port :
+         graph.GetFanouts(batch_node, true)) {
+      NodeDef* consumer = port.node;
+      for (int i = 0; i < consumer->input_size(); ++i) {
+        if (NodeName(consumer->input(i)) != batch_node.name()) continue;
+        if (IsControlInput(consumer->input(i))) {
+          consumer->set_input(i, AsControlDependency(map_node->name()));
+        } else {
+          consumer->set_input(i, map_node->name());
+        }
+      }
+    }
+    batch_node.set_input(0, map_node->input(0));
+    map_node->set_input(0, batch_node.name());
+    *vectorized = true;
+    return Status::OK();
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status MapVectorization::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* output) {
+  *output = item.graph;
+  // A map is moved after its batch at a time, so that chains of maps all
+  // move after the batch.
+  bool vectorized = true;
+  while (vectorized) {
+    TF_RETURN_IF_ERROR(VectorizeNextMap(output, &vectorized));
+  }
+  return Status::OK();
+}
+
+void MapVectorization::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                const GraphDef& optimize_output,
+                                double result) {
+  // no-op
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,132 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Adds `range(10).map(function).batch(5).take(3)` with T=int64, and returns
+// the names of the map, batch and take nodes.
+std::vector<string> AddPipeline(const string &function, GraphDef *graph) {
+  NodeDef *start_node;
+  TF_CHECK_OK(graph_utils::AddScalarConstNode<int64>(0, graph, &start_node));
+  NodeDef *stop_node;
+  TF_CHECK_OK(graph_utils::AddScalarConstNode<int64>(10, graph, &stop_node));
+  NodeDef *step_node;
+  TF_CHECK_OK(graph_utils::AddScalarConstNode<int64>(1, graph, &step_node));
+  AttrValue types;
+  SetAttrValue(DataTypeVector({DT_INT64}), &types);
+  AttrValue shapes;
+  SetAttrValue(std::vector<PartialTensorShape>{PartialTensorShape({})},
+               &shapes);
+  NodeDef *range_node;
+  TF_CHECK_OK(graph_utils::AddNode(
+      "", "RangeDataset",
+      {start_node->name(), stop_node->name(), step_node->name()},
+      {{"output_types", types}, {"output_shapes", shapes}}, graph,
+      &range_node));
+
+  AttrValue f;
+  f.mutable_func()->set_name(function);
+  (*f.mutable_func()->mutable_attr())["T"].set_type(DT_INT64);
+  AttrValue arguments;
+  SetAttrValue(DataTypeVector(), &arguments);
+  NodeDef *map_node;
+  TF_CHECK_OK(graph_utils::AddNode("", "MapDataset", {range_node->name()},
+                                   {{"f", f},
+                                    {"Targuments", arguments},
+                                    {"output_types", types},
+                                    {"output_shapes", shapes}},
+                                   graph, &map_node));
+
+  NodeDef *batch_size_node;
+  TF_CHECK_OK(
+      graph_utils::AddScalarConstNode<int64>(5, graph, &batch_size_node));
+  AttrValue batched_shapes;
+  SetAttrValue(std::vector<PartialTensorShape>{PartialTensorShape({-1})},
+               &batched_shapes);
+  NodeDef *batch_node;
+  TF_CHECK_OK(graph_utils::AddNode(
+      "", "BatchDataset", {map_node->name(), batch_size_node->name()},
+      {{"output_types", types}, {"output_shapes", batched_shapes}}, graph,
+      &batch_node));
+
+  NodeDef *count_node;
+  TF_CHECK_OK(graph_utils::AddScalarConstNode<int64>(3, graph, &count_node));
+  NodeDef *take_node;
+  TF_CHECK_OK(graph_utils::AddNode("", "TakeDataset",
+                                   {batch_node->name(), count_node->name()},
+                                   {}, graph, &take_node));
+  return {map_node->name(), batch_node->name(), take_node->name()};
+}
+
+TEST(MapVectorizationTest, MapsBatchesWithElementWiseFunction) {
+  GrapplerItem item;
+  GraphDef *graph = &item.graph;
+  *graph->mutable_library()->add_function() = test::function::XTimesTwo();
+  const std::vector<string> names = AddPipeline("XTimesTwo", graph);
+  const NodeDef range_node =
+      graph->node(graph_utils::FindNodeWithOp("RangeDataset", *graph));
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef &map_node =
+      output.node(graph_utils::FindNodeWithName(names[0], output));
+  const NodeDef &batch_node =
+      output.node(graph_utils::FindNodeWithName(names[1], output));
+  const NodeDef &take_node =
+      output.node(graph_utils::FindNodeWithName(names[2], output));
+  EXPECT_EQ(range_node.name(), batch_node.input(0));
+  EXPECT_EQ(batch_node.name(), map_node.input(0));
+  EXPECT_EQ(map_node.name(), take_node.input(0));
+
+  // The map produces the batches, and the batch the batched inputs.
+  EXPECT_EQ(1, map_node.attr().at("output_shapes").list().shape(0).dim_size());
+  ASSERT_EQ(1, batch_node.attr().at("output_shapes").list().shape_size());
+  const TensorShapeProto &batched_shape =
+      batch_node.attr().at("output_shapes").list().shape(0);
+  ASSERT_EQ(1, batched_shape.dim_size());
+  EXPECT_EQ(-1, batched_shape.dim(0).size());
+  EXPECT_EQ(DT_INT64, batch_node.attr().at("output_types").list().type(0));
+}
+
+TEST(MapVectorizationTest, KeepsMapWithOtherOps) {
+  GrapplerItem item;
+  GraphDef *graph = &item.graph;
+  // MatMul does not compute its outputs element-wise.
+  *graph->mutable_library()->add_function() = test::function::WXPlusB();
+  AddPipeline("WXPlusB", graph);
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::Compare(item.graph, output));
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -14,14 +14,32 @@ limitations under the License.
 ==============================================================================*/
 
 // Op kernels used to swap data in and out of GPU memory.
+//
+// The copies run on the dedicated device-to-host and host-to-device streams
+// of the GPU, into pinned host memory, so that they overlap the computations
+// on the compute stream. A swap out completes as soon as its copy has been
+// enqueued: the memory optimizer hangs a control dependency on it to get the
+// copy started early, and that dependency shouldn't wait for the transfer.
+// Swap ins order their copy after all pending swap outs, and complete when
+// the data has landed on the GPU so that their consumers can use it.
+
+#if GOOGLE_CUDA
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/stream_executor.h"
 
 namespace tensorflow {
 namespace {
 
+void* GetBase(const Tensor& tensor) {
+  return const_cast<char*>(tensor.tensor_data().data());
+}
+
 class CopyFromGpuToHostKernel : public AsyncOpKernel {
  public:
   explicit CopyFromGpuToHostKernel(OpKernelConstruction* context)
@@ -34,6 +52,7 @@ class CopyFromGpuToHostKernel : public AsyncOpKernel {
                          "must reside on the device."),
         done);
 
+    // Pinned host memory, so that the copy is a DMA.
     AllocatorAttributes alloc_attrs;
     alloc_attrs.set_gpu_compatible(true);
     alloc_attrs.set_on_host(true);
@@ -42,12 +61,34 @@ class CopyFromGpuToHostKernel : public AsyncOpKernel {
         ctx, ctx->allocate_output(0, input.shape(), &output, alloc_attrs),
         done);
 
-    ctx->op_device_context()->CopyDeviceTensorToCPU(
-        &input, "CopyFromGpuToHost", static_cast<Device*>(ctx->device()),
-        output, [ctx, done](const Status& s) {
-          ctx->SetStatus(s);
-          done();
+    auto* device_context =
+        static_cast<const GPUDeviceContext*>(ctx->op_device_context());
+    se::Stream* compute_stream = device_context->stream();
+    se::Stream* copy_stream = device_context->device_to_host_stream();
+    OP_REQUIRES_ASYNC(
+        ctx, compute_stream != nullptr && copy_stream != nullptr,
+        errors::Internal("No GPU streams available for _CopyFromGpuToHost."),
+        done);
+
+    // Wait for the input to be computed.
+    copy_stream->ThenWaitFor(compute_stream);
+    const int64 total_bytes = input.TotalBytes();
+    if (total_bytes > 0) {
+      se::DeviceMemoryBase src(GetBase(input), total_bytes);
+      copy_stream->ThenMemcpy(GetBase(*output), src, total_bytes);
+    }
+    // Both buffers must outlive the copy, even if the step ends first.
+    TensorReference input_ref(input);
+    TensorReference output_ref(*output);
+    ctx->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        copy_stream, [copy_stream, input_ref, output_ref]() {
+          if (!copy_stream->ok()) {
+            LOG(FATAL) << "GPU->CPU Memcpy failed";
+          }
+          input_ref.Unref();
+          output_ref.Unref();
         });
+    done();
   }
 };
 
@@ -71,10 +112,34 @@ class CopyFromHostToGpuKernel : public AsyncOpKernel {
     OP_REQUIRES_OK_ASYNC(ctx, ctx->allocate_output(0, input.shape(), &output),
                          done);
 
-    ctx->op_device_context()->CopyCPUTensorToDevice(
-        &input, static_cast<Device*>(ctx->device()), output,
-        [ctx, done](const Status& s) {
-          ctx->SetStatus(s);
+    auto* device_context =
+        static_cast<const GPUDeviceContext*>(ctx->op_device_context());
+    se::Stream* compute_stream = device_context->stream();
+    se::Stream* copy_stream = device_context->host_to_device_stream();
+    se::Stream* swap_out_stream = device_context->device_to_host_stream();
+    OP_REQUIRES_ASYNC(
+        ctx,
+        compute_stream != nullptr && copy_stream != nullptr &&
+            swap_out_stream != nullptr,
+        errors::Internal("No GPU streams available for _CopyFromHostToGpu."),
+        done);
+
+    // The output memory may still be used by the compute stream, and the
+    // input is only valid once the swap out that produced it is done.
+    copy_stream->ThenWaitFor(compute_stream);
+    copy_stream->ThenWaitFor(swap_out_stream);
+    const int64 total_bytes = input.TotalBytes();
+    if (total_bytes > 0) {
+      se::DeviceMemoryBase dst(GetBase(*output), total_bytes);
+      copy_stream->ThenMemcpy(&dst, GetBase(input), total_bytes);
+    }
+    TensorReference input_ref(input);
+    ctx->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        copy_stream, [ctx, copy_stream, input_ref, done]() {
+          input_ref.Unref();
+          if (!copy_stream->ok()) {
+            ctx->SetStatus(errors::Internal("CPU->GPU Memcpy failed"));
+          }
           done();
         });
   }
@@ -86,3 +151,5 @@ REGISTER_KERNEL_BUILDER(
 
 }  // namespace
 }  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
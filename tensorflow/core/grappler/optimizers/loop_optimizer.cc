@@ -60,6 +60,8 @@ class LoopInvariantNodeMotionOptimizer {
                              const int frame_id);
   Status HandleConst(NodeDef* node, const int num_outputs, const int frame_id);
   Status HandleInvariantEnter(NodeDef* node, const int num_outputs);
+  bool CanHoist(const NodeDef& node);
+  bool IsReadOnlyResource(const NodeDef& enter);
 
   GraphDef* optimized_graph_;  // Not owned.
   std::unique_ptr<NodeMap> node_map_;
@@ -70,9 +72,80 @@ class LoopInvariantNodeMotionOptimizer {
   std::map<int, int> frame_parent_;
   std::map<int, const NodeDef*> loop_cond_;
   std::map<int, std::vector<NodeDef*>> invariant_enters_;
+  // Whether the resource behind a given tensor is only ever read, keyed by the
+  // name of the tensor that feeds the (possibly nested) Enter nodes.
+  std::unordered_map<string, bool> read_only_resources_;
   int new_enter_id_;
 };
 
+// Stateless ops can be evaluated once outside of the loop. Reads of a resource
+// variable are hoisted as well, but only when nothing in the graph can write to
+// that variable: the loop body itself may update it, and writes outside of the
+// loop are not ordered with respect to the iterations.
+bool LoopInvariantNodeMotionOptimizer::CanHoist(const NodeDef& node) {
+  if (IsFreeOfSideEffect(node)) {
+    return true;
+  }
+  if (node.op() != "ReadVariableOp" || node.input_size() == 0 ||
+      IsControlInput(node.input(0))) {
+    return false;
+  }
+  const NodeDef* handle = node_map_->GetNode(node.input(0));
+  return handle != nullptr && IsEnter(*handle) && IsReadOnlyResource(*handle);
+}
+
+bool LoopInvariantNodeMotionOptimizer::IsReadOnlyResource(
+    const NodeDef& enter) {
+  // Walk back to the tensor that produces the resource handle.
+  const NodeDef* node = &enter;
+  string root;
+  while (true) {
+    root.clear();
+    for (const string& input : node->input()) {
+      if (!IsControlInput(input)) {
+        root = input;
+        break;
+      }
+    }
+    const NodeDef* producer = root.empty() ? nullptr : node_map_->GetNode(root);
+    if (producer == nullptr) {
+      return false;
+    }
+    if (!IsEnter(*producer) && !IsIdentity(*producer)) {
+      break;
+    }
+    node = producer;
+  }
+  auto it = read_only_resources_.find(root);
+  if (it != read_only_resources_.end()) {
+    return it->second;
+  }
+
+  // Every consumer of the handle, looking through Enter and Identity nodes,
+  // must be a ReadVariableOp.
+  bool read_only = true;
+  std::unordered_set<const NodeDef*> visited;
+  std::vector<const NodeDef*> stack = {node_map_->GetNode(root)};
+  while (read_only && !stack.empty()) {
+    const NodeDef* current = stack.back();
+    stack.pop_back();
+    for (const NodeDef* consumer : node_map_->GetOutputs(current->name())) {
+      if (!visited.insert(consumer).second ||
+          consumer->op() == "ReadVariableOp") {
+        continue;
+      }
+      if (IsEnter(*consumer) || IsIdentity(*consumer)) {
+        stack.push_back(consumer);
+      } else {
+        read_only = false;
+        break;
+      }
+    }
+  }
+  read_only_resources_[root] = read_only;
+  return read_only;
+}
+
 Status LoopInvariantNodeMotionOptimizer::HandleInvariantEnter(
     NodeDef* node, const int num_outputs) {
   auto consumers = node_map_->GetOutputs(node->name());
@@ -331,7 +404,8 @@ Status LoopInvariantNodeMotionOptimizer::FindInvariantNodes(
     auto consumers = node_map_->GetOutputs(node->name());
     invariant_nodes_.emplace(node, consumers.size());
     for (auto* consumer : consumers) {
-      if (invariant_nodes_.count(consumer) || ModifiesFrameInfo(*consumer)) {
+      if (invariant_nodes_.count(consumer) || ModifiesFrameInfo(*consumer) ||
+          !CanHoist(*consumer)) {
         continue;
       }
       bool is_invariant = true;
@@ -371,6 +445,7 @@ Status LoopInvariantNodeMotionOptimizer::FindInvariantNodes(
 
 Status LoopInvariantNodeMotionOptimizer::Optimize() {
   node_map_.reset(new NodeMap(optimized_graph_));
+  read_only_resources_.clear();
   FrameMap frame_map;
   int num_frames;
   TF_RETURN_IF_ERROR(IdentifyFramesWithNodeMap(*optimized_graph_, *node_map_,
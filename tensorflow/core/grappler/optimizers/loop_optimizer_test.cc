@@ -57,6 +57,41 @@ class LoopOptimizerTest : public GrapplerTest {
     AddNode(name, op, inputs, attributes, graph);
   }
 
+  // Builds a loop whose body reads the resource variable "Var" through an
+  // invariant Enter and, if requested, also increments it.
+  GraphDef ResourceLoopGraph(bool write_in_loop) const {
+    GraphDef graph;
+    AttrValue resource_type;
+    resource_type.set_type(DT_RESOURCE);
+    AttrValue float_type;
+    float_type.set_type(DT_FLOAT);
+    AddNode("Var", "VarHandleOp", {}, {{"dtype", float_type}}, &graph);
+    AddSimpleNode("In", "Identity", {}, &graph);
+    AddEnterNode("VarEnter", "while/while_context", true, 1, {"Var"}, &graph);
+    (*graph.mutable_node(graph.node_size() - 1)->mutable_attr())["T"] =
+        resource_type;
+    AddNode("Read", "ReadVariableOp", {"VarEnter"}, {{"dtype", float_type}},
+            &graph);
+    AddSimpleNode("InvariantAdd", "Add", {"Read", "Read"}, &graph);
+    AddSimpleNode("VariantAdd", "Add", {"InvariantAdd", "Identity"}, &graph);
+    if (write_in_loop) {
+      AddNode("Update", "AssignAddVariableOp", {"VarEnter", "Identity"},
+              {{"dtype", float_type}}, &graph);
+    }
+    AddEnterNode("VariantEnter", "while/while_context", false, 1, {"In"},
+                 &graph);
+    AddSimpleNode("Merge", "Merge", {"VariantEnter", "NextIteration"}, &graph);
+    AddSimpleNode("Less/y", "Const", {"^Identity"}, &graph);
+    AddSimpleNode("Less", "Less", {"VariantAdd", "Less/y"}, &graph);
+    AddSimpleNode("LoopCond", "LoopCond", {"Less"}, &graph);
+    AddSimpleNode("Switch", "Switch", {"Merge", "LoopCond"}, &graph);
+    AddSimpleNode("Identity", "Identity", {"Switch:1"}, &graph);
+    AddSimpleNode("NextIteration", "NextIteration", {"VariantAdd"}, &graph);
+    AddSimpleNode("Exit", "Exit", {"Switch"}, &graph);
+    AddSimpleNode("Out", "Identity", {"Exit"}, &graph);
+    return graph;
+  }
+
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
     options.enable_loop_invariant_node_motion = false;
@@ -216,6 +251,85 @@ TEST_F(LoopOptimizerTest, ControlOutput) {
   EXPECT_EQ(frames.at(node_map->GetNode("InvariantAdd")).back(), 0);
 }
 
+TEST_F(LoopOptimizerTest, StatefulNode) {
+  GraphDef graph;
+  AddSimpleNode("In", "Identity", {}, &graph);
+  AddEnterNode("InvariantEnter", "while/while_context", true, 1, {"In"},
+               &graph);
+  AttrValue int_type;
+  int_type.set_type(DT_INT32);
+  AttrValue float_type;
+  float_type.set_type(DT_FLOAT);
+  AddNode("Random", "RandomUniform", {"InvariantEnter"},
+          {{"T", int_type}, {"dtype", float_type}}, &graph);
+  AddSimpleNode("VariantAdd", "Add", {"Random", "Identity"}, &graph);
+  AddEnterNode("VariantEnter", "while/while_context", false, 1, {"In"}, &graph);
+  AddSimpleNode("Merge", "Merge", {"VariantEnter", "NextIteration"}, &graph);
+  AddSimpleNode("Less/y", "Const", {"^Identity"}, &graph);
+  AddSimpleNode("Less", "Less", {"VariantAdd", "Less/y"}, &graph);
+  AddSimpleNode("LoopCond", "LoopCond", {"Less"}, &graph);
+  AddSimpleNode("Switch", "Switch", {"Merge", "LoopCond"}, &graph);
+  AddSimpleNode("Identity", "Identity", {"Switch:1"}, &graph);
+  AddSimpleNode("NextIteration", "NextIteration", {"VariantAdd"}, &graph);
+  AddSimpleNode("Exit", "Exit", {"Switch"}, &graph);
+  AddSimpleNode("Out", "Identity", {"Exit"}, &graph);
+
+  GrapplerItem item;
+  item.graph = graph;
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // A fresh sample must be drawn in every iteration.
+  NodeMap node_map(&output);
+  std::unordered_map<const NodeDef*, std::vector<int>> frames;
+  int num_frames;
+  TF_EXPECT_OK(IdentifyFrames(output, &frames, &num_frames));
+  EXPECT_EQ(frames.at(node_map.GetNode("Random")).size(), 1);
+}
+
+TEST_F(LoopOptimizerTest, ReadOnlyResource) {
+  GrapplerItem item;
+  item.graph = ResourceLoopGraph(/*write_in_loop=*/false);
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  std::unordered_map<const NodeDef*, std::vector<int>> frames;
+  int num_frames;
+  TF_EXPECT_OK(IdentifyFrames(output, &frames, &num_frames));
+  EXPECT_EQ(num_frames, 1);
+  EXPECT_EQ(frames.at(node_map.GetNode("Read")).size(), 0);
+  EXPECT_EQ(node_map.GetNode("Read")->input(0), "Var");
+  EXPECT_EQ(frames.at(node_map.GetNode("InvariantAdd")).size(), 0);
+  EXPECT_EQ(frames.at(node_map.GetNode("VariantAdd")).size(), 1);
+}
+
+TEST_F(LoopOptimizerTest, ResourceWrittenInLoop) {
+  GrapplerItem item;
+  item.graph = ResourceLoopGraph(/*write_in_loop=*/true);
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopInvariantNodeMotion(&optimizer);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The variable changes from one iteration to the next, so neither the read
+  // nor anything computed from it may leave the loop.
+  NodeMap node_map(&output);
+  std::unordered_map<const NodeDef*, std::vector<int>> frames;
+  int num_frames;
+  TF_EXPECT_OK(IdentifyFrames(output, &frames, &num_frames));
+  EXPECT_EQ(frames.at(node_map.GetNode("Read")).size(), 1);
+  EXPECT_EQ(frames.at(node_map.GetNode("InvariantAdd")).size(), 1);
+  EXPECT_EQ(frames.at(node_map.GetNode("Update")).size(), 1);
+}
+
 TEST_F(LoopOptimizerTest, NestedLoop1) {
   GraphDef graph;
   AddSimpleNode("In", "Identity", {}, &graph);
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/graph_rewriter.h"
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/math/math_util.h"
@@ -941,6 +942,43 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Simulates the execution of 'item' on the devices of 'cluster', and returns
+// the time at which each node starts (if 'start_times' isn't null) and
+// completes.
+static bool EstimateOpTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* start_times,
+    std::unordered_map<string, Costs::NanoSeconds>* completion_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      completion_times->emplace(node_stats.node_name(), exec_time);
+      if (start_times != nullptr) {
+        start_times->emplace(
+            node_stats.node_name(),
+            Costs::MicroSeconds(node_stats.all_start_micros()));
+      }
+    }
+  }
+  return true;
+}
+
 static bool IdentifySwappingCandidates(
     Cluster* cluster, GrapplerItem* item, std::unordered_set<string>* skip_list,
     std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
@@ -972,29 +1010,8 @@ static bool IdentifySwappingCandidates(
     int64 required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateOpTimes(cluster, *item, nullptr, &op_completion_times)) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1109,7 +1126,8 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
-      optimization_level == RewriterConfig::HEURISTICS) {
+      optimization_level == RewriterConfig::HEURISTICS ||
+      optimization_level == RewriterConfig::MEMORY_PRESSURE_HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
     IdentifySwappingCandidates(cluster, item, skip_list, &nodes_to_swap);
   }
@@ -1152,15 +1170,28 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
     swap_info.time_to_swap = bytes_to_swap / 16;
   }
 
-  std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
-  if (!EstimateEarliestExecutionTimes(*item, cluster, &execution_times).ok()) {
-    return false;
-  }
-
   std::unordered_map<string, const NodeDef*> name_map;
   for (const auto& node : item->graph.node()) {
     name_map[node.name()] = &node;
   }
+
+  // The swap in must be started early enough for the transfer to overlap the
+  // computations that precede its consumer. Use the completion times of a
+  // simulated step, which account for the scheduling of the ops on each
+  // device, and fall back to the earliest execution times of the nodes.
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
+  std::unordered_map<string, Costs::NanoSeconds> completion_times;
+  if (EstimateOpTimes(cluster, *item, nullptr, &completion_times)) {
+    for (const auto& completion_time : completion_times) {
+      auto it = name_map.find(completion_time.first);
+      if (it != name_map.end()) {
+        execution_times[it->second] = completion_time.second;
+      }
+    }
+  } else if (!EstimateEarliestExecutionTimes(*item, cluster, &execution_times)
+                  .ok()) {
+    return false;
+  }
   GraphView view(&item->graph);
 
   bool updated_graph = false;
@@ -1222,6 +1253,246 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+struct RecomputeCandidate {
+  NodeDef* node;
+  // The consumers that run after the peak memory usage, which will read the
+  // recomputed tensor instead of the original one.
+  std::unordered_set<NodeDef*> late_consumers;
+  int64 memory_saved;
+  Costs::NanoSeconds recompute_time;
+};
+
+// Looks for the devices whose estimated peak memory usage exceeds their
+// memory size, and recomputes tensors that are live at the peak for their
+// consumers that run after it. Unlike RecomputationRewritingPass, candidates
+// aren't restricted to a list of cheap ops feeding a name scope: any side
+// effect free op outside of loops may be recomputed, and the candidates are
+// ranked by the time needed to recompute them per byte of memory saved. The
+// cheapest ones are picked until the peak fits. On GPUs, tensors that are
+// faster to swap to the host and back than to recompute are left to the
+// SwappingPass.
+bool MemoryPressureRecomputationPass(
+    Cluster* cluster, GrapplerItem* item,
+    std::unordered_set<string>* recomputed_nodes) {
+  GraphDef* graph = &item->graph;
+  // RecomputeSubgraph expects the nodes to be sorted topologically. This
+  // invalidates all NodeDef pointers, so it needs to be done first.
+  if (!TopologicalSort(graph).ok()) {
+    return false;
+  }
+
+  GraphMemory memory(*item);
+  const std::unordered_map<string, DeviceProperties>& devices =
+      cluster->GetDevices();
+  Status s = memory.InferStatically(devices);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return false;
+  }
+  std::vector<string> overloaded_devices;
+  for (const auto& device : devices) {
+    const int64 memory_size = device.second.memory_size();
+    if (memory_size > 0 &&
+        memory.GetPeakMemoryUsage(device.first).used_memory > memory_size) {
+      overloaded_devices.push_back(device.first);
+    }
+  }
+  if (overloaded_devices.empty()) {
+    return false;
+  }
+
+  std::unordered_map<string, Costs::NanoSeconds> start_times;
+  std::unordered_map<string, Costs::NanoSeconds> completion_times;
+  if (!EstimateOpTimes(cluster, *item, &start_times, &completion_times)) {
+    return false;
+  }
+  GraphProperties properties(*item);
+  if (!properties.InferStatically(false).ok()) {
+    return false;
+  }
+  FrameMap frames;
+  int num_frames;
+  if (!IdentifyFrames(*graph, &frames, &num_frames).ok()) {
+    return false;
+  }
+  // Fed nodes can't be recomputed, since the copy would not take on the fed
+  // value.
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  NodeMap node_map(graph);
+  GraphView view(graph);
+
+  // The recomputed nodes and their late consumers. A candidate that reads or
+  // feeds one of these is skipped, since RecomputeSubgraph only handles
+  // independent recomputations within a pass.
+  std::unordered_set<const NodeDef*> rewritten;
+  auto conflicts = [&node_map, &rewritten](const RecomputeCandidate& c) {
+    if (rewritten.count(c.node) != 0) {
+      return true;
+    }
+    for (const string& input : c.node->input()) {
+      if (rewritten.count(node_map.GetNode(input)) != 0) {
+        return true;
+      }
+    }
+    for (const NodeDef* consumer : c.late_consumers) {
+      if (rewritten.count(consumer) != 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  std::vector<RecomputeCandidate> recomputations;
+  for (const string& name : overloaded_devices) {
+    const DeviceProperties& prop = devices.at(name);
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    int64 required_savings = mem_usage.used_memory - prop.memory_size();
+
+    Costs::Duration peak_time = -1;
+    std::unordered_set<string> live_at_peak;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      live_at_peak.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
+    }
+
+    std::vector<RecomputeCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      NodeDef* node = node_map.GetNode(live_tensor.node);
+      if (node == nullptr || recomputed_nodes->count(node->name()) != 0 ||
+          feeds.count(node->name()) != 0) {
+        continue;
+      }
+      // Persistent tensors stay in memory anyway, and Identity or Reshape
+      // outputs usually share the buffer of their input.
+      if (IsPersistent(*node) || IsIdentity(*node) || IsReshape(*node) ||
+          !IsFreeOfSideEffect(*node) || ModifiesFrameInfo(*node) ||
+          IsSwitch(*node) || IsMerge(*node)) {
+        continue;
+      }
+      auto frame = frames.find(node);
+      if (frame != frames.end() && !frame->second.empty()) {
+        continue;
+      }
+      auto start = start_times.find(node->name());
+      auto end = completion_times.find(node->name());
+      if (start == start_times.end() || end == completion_times.end()) {
+        continue;
+      }
+
+      // The original tensor still feeds the consumers that run before the
+      // peak, and the consumers after the peak read the recomputed tensor.
+      RecomputeCandidate candidate;
+      candidate.node = node;
+      bool has_early_use = false;
+      bool valid = true;
+      GraphView::OutputPort port =
+          view.GetOutputPort(node->name(), live_tensor.output_id);
+      for (const GraphView::InputPort& input : view.GetFanout(port)) {
+        auto it = start_times.find(input.node->name());
+        if (it == start_times.end() || !IsSwappable(input)) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          has_early_use = true;
+        } else {
+          candidate.late_consumers.insert(input.node);
+        }
+      }
+      if (!valid || !has_early_use || candidate.late_consumers.empty()) {
+        continue;
+      }
+
+      // The recomputation keeps its inputs alive until after the peak, which
+      // costs memory unless they are live at the peak already.
+      const std::vector<OpInfo::TensorProperties>& input_props =
+          properties.GetInputProperties(node->name());
+      int64 extended_bytes = 0;
+      for (int i = 0; i < node->input_size(); ++i) {
+        if (IsControlInput(node->input(i))) {
+          break;
+        }
+        int input_port;
+        const string input_name = ParseNodeName(node->input(i), &input_port);
+        const NodeDef* input_node = node_map.GetNode(input_name);
+        if (input_node == nullptr) {
+          valid = false;
+          break;
+        }
+        if (IsPersistent(*input_node) ||
+            live_at_peak.count(strings::StrCat(input_name, ":", input_port)) !=
+                0) {
+          continue;
+        }
+        if (i < input_props.size()) {
+          extended_bytes += EstimateSize(input_props[i]);
+        }
+      }
+      candidate.memory_saved = live_tensor.memory_used - extended_bytes;
+      if (!valid || candidate.memory_saved <= 0) {
+        continue;
+      }
+
+      candidate.recompute_time = end->second - start->second;
+      if (prop.type() == "GPU") {
+        // Let's assume we're going to swap over PCIe running at 16 GBps.
+        const Costs::NanoSeconds swap_time(2 * live_tensor.memory_used / 16);
+        if (candidate.recompute_time >= swap_time) {
+          continue;
+        }
+      }
+      candidates.push_back(std::move(candidate));
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const RecomputeCandidate& a, const RecomputeCandidate& b) {
+                return a.recompute_time.count() * b.memory_saved <
+                       b.recompute_time.count() * a.memory_saved;
+              });
+    for (RecomputeCandidate& candidate : candidates) {
+      if (required_savings <= 0) {
+        break;
+      }
+      if (conflicts(candidate)) {
+        continue;
+      }
+      VLOG(1) << "Will recompute " << candidate.node->name() << " for "
+              << candidate.late_consumers.size() << " consumers to save "
+              << candidate.memory_saved << " bytes on " << name;
+      rewritten.insert(candidate.node);
+      rewritten.insert(candidate.late_consumers.begin(),
+                       candidate.late_consumers.end());
+      required_savings -= candidate.memory_saved;
+      recomputations.push_back(std::move(candidate));
+    }
+  }
+  if (recomputations.empty()) {
+    return false;
+  }
+
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < graph->node_size(); ++node_number) {
+    topological_numbering[graph->mutable_node(node_number)] =
+        graph->node_size() - node_number - 1;
+  }
+  for (const RecomputeCandidate& recomputation : recomputations) {
+    const string& name = recomputation.node->name();
+    recomputed_nodes->insert(name);
+    recomputed_nodes->insert(AddPrefixToNodeName(name, kRecomputedNodePrefix));
+    RecomputeSubgraph({recomputation.node}, recomputation.late_consumers,
+                      node_map, topological_numbering, graph);
+  }
+  return true;
+}
+
 // TODO(rmlarsen): Add distributed TF test.
 Status RelaxAllocatorConstraints(GraphDef* optimized_graph) {
   std::unordered_set<string> devices;
@@ -1306,6 +1577,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   GrapplerItem optimized_item(item, optimized_graph);
   std::unordered_set<string> skip_list;
+  std::unordered_set<string> recomputed_nodes;
   // Bound the number of rewrite passes to avoid long processing times on graphs
   // that simply won't fit in memory.
   bool updated_graph = true;
@@ -1313,14 +1585,22 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     updated_graph = false;
     if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
          optimization_level_ == RewriterConfig::SCHEDULING_HEURISTICS ||
-         optimization_level_ == RewriterConfig::HEURISTICS) &&
+         optimization_level_ == RewriterConfig::HEURISTICS ||
+         optimization_level_ == RewriterConfig::MEMORY_PRESSURE_HEURISTICS) &&
         cluster != nullptr) {
       updated_graph |= SchedulingPass(cluster, &optimized_item);
     }
 
+    if (optimization_level_ == RewriterConfig::MEMORY_PRESSURE_HEURISTICS &&
+        cluster != nullptr) {
+      updated_graph |= MemoryPressureRecomputationPass(
+          cluster, &optimized_item, &recomputed_nodes);
+    }
+
     if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
          optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
          optimization_level_ == RewriterConfig::HEURISTICS ||
+         optimization_level_ == RewriterConfig::MEMORY_PRESSURE_HEURISTICS ||
          optimization_level_ == RewriterConfig::MANUAL) &&
         cluster != nullptr) {
       updated_graph |= SwappingPass(optimization_level_, cluster,
@@ -385,6 +385,57 @@ TEST_F(MemoryOptimizerTest, UnswappableInputs) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, MemoryPressureRecomputation) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/cpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Sqrt(s.WithOpName("a").WithDevice("/cpu:0"), v);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/cpu:0"), a);
+  Output c = ops::Exp(s.WithOpName("c").WithDevice("/cpu:0"), b);
+  Output d = ops::Sum(s.WithOpName("d").WithDevice("/cpu:0"), c, {0, 1, 2});
+  // a is live while b and c are computed, but only needed again by e.
+  Output e = ops::Mul(s.WithOpName("e").WithDevice("/cpu:0"), a, d);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.5f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::MEMORY_PRESSURE_HEURISTICS);
+  GraphDef output;
+  Status status = optimizer.Optimize(cluster.get(), item, &output);
+  TF_EXPECT_OK(status);
+
+  NodeMap node_map(&output);
+  const NodeDef* recomputed_a = node_map.GetNode("Recomputed/a");
+  ASSERT_NE(nullptr, recomputed_a);
+  EXPECT_EQ("Sqrt", recomputed_a->op());
+  EXPECT_EQ("/cpu:0", recomputed_a->device());
+  EXPECT_EQ(2, recomputed_a->input_size());
+  EXPECT_EQ("v", recomputed_a->input(0));
+  EXPECT_EQ("^RecomputeTrigger/a", recomputed_a->input(1));
+  // The trigger delays the recomputation until after the peak.
+  const NodeDef* trigger = node_map.GetNode("RecomputeTrigger/a");
+  ASSERT_NE(nullptr, trigger);
+  EXPECT_EQ(1, trigger->input_size());
+  EXPECT_EQ("^d", trigger->input(0));
+
+  EXPECT_EQ("a", node_map.GetNode("b")->input(0));
+  const NodeDef* new_e = node_map.GetNode("e");
+  EXPECT_EQ("Recomputed/a", new_e->input(0));
+  EXPECT_EQ("d", new_e->input(1));
+
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized(item, std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
@@ -31,10 +32,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/shape_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/training_op_fusion.h"
 #include "tensorflow/core/grappler/utils/colocation.h"
 #include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -91,6 +96,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("debug_stripper", new DebugStripper());
   MK_OPT("scoped_allocator",
          new ScopedAllocatorOptimizer(cfg_.scoped_allocator_opts()));
+  MK_OPT("training_op_fusion", new TrainingOpFusion());
+  MK_OPT("auto_mixed_precision", new AutoMixedPrecision());
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -130,6 +137,12 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->emplace_back(
         new DependencyOptimizer(cfg_.dependency_optimization()));
   }
+  if (cfg_.training_op_fusion() == RewriterConfig::ON) {
+    optimizers->emplace_back(new TrainingOpFusion());
+  }
+  if (cfg_.auto_mixed_precision() == RewriterConfig::ON) {
+    optimizers->emplace_back(new AutoMixedPrecision());
+  }
   if (cfg_.layout_optimizer() != RewriterConfig::OFF) {
     optimizers->emplace_back(new LayoutOptimizer());
   }
@@ -273,7 +286,10 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, const GrapplerItem& item,
   }
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -288,7 +304,10 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, const GrapplerItem& item,
 
 Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
-  optimization_results_.clear();
+  {
+    mutex_lock l(results_mu_);
+    optimization_results_.clear();
+  }
 
   // 1. Optimize main graph
   TF_RETURN_IF_ERROR(OptimizeGraph(cluster, item, optimized_graph));
@@ -304,6 +323,7 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    std::vector<GrapplerFunctionItem> func_items;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       const string& func_name = func.signature().name();
 
@@ -322,13 +342,40 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       optimized_funcs.insert(func_name);
 
       // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(func, flib, &func_item));
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
+      func_items.emplace_back();
       TF_RETURN_IF_ERROR(
-          OptimizeGraph(cluster, func_item, &optimized_func_graph));
+          MakeGrapplerFunctionItem(func, flib, &func_items.back()));
+    }
+
+    // Optimize function body graphs. They don't depend on each other, so
+    // large libraries are optimized concurrently.
+    const int num_funcs = func_items.size();
+    std::vector<GraphDef> optimized_func_graphs(num_funcs);
+    std::vector<Status> statuses(num_funcs);
+    if (num_funcs > 1) {
+      thread::ThreadPool pool(Env::Default(), "meta_optimizer",
+                              std::min(num_funcs, port::NumSchedulableCPUs()));
+      BlockingCounter counter(num_funcs);
+      for (int i = 0; i < num_funcs; ++i) {
+        pool.Schedule([this, cluster, i, &func_items, &optimized_func_graphs,
+                       &statuses, &counter]() {
+          statuses[i] = OptimizeGraph(cluster, func_items[i],
+                                      &optimized_func_graphs[i]);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+    } else if (num_funcs == 1) {
+      statuses[0] =
+          OptimizeGraph(cluster, func_items[0], &optimized_func_graphs[0]);
+    }
+
+    // Update the library in the original function order, so the result does
+    // not depend on scheduling.
+    for (int i = 0; i < num_funcs; ++i) {
+      TF_RETURN_IF_ERROR(statuses[i]);
+      GrapplerFunctionItem& func_item = func_items[i];
+      GraphDef& optimized_func_graph = optimized_func_graphs[i];
 
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
@@ -345,7 +392,7 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
 
       // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.RemoveFunction(func_name));
+      TF_RETURN_IF_ERROR(flib.RemoveFunction(func_item.id));
       TF_RETURN_IF_ERROR(flib.AddFunctionDef(optimized_func));
     }
 
@@ -362,6 +409,7 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 }
 
 void MetaOptimizer::PrintResult() {
+  mutex_lock l(results_mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     LOG(INFO) << "Optimization results for grappler item: " << graph_result.id;
     for (const OptimizerResult& result : graph_result.results) {
@@ -389,6 +437,8 @@ bool MetaOptimizerEnabled(const RewriterConfig& cfg) {
          cfg.memory_optimization() != RewriterConfig::NO_MEM_OPT ||
          cfg.debug_stripper() == RewriterConfig::ON ||
          cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
+         cfg.training_op_fusion() == RewriterConfig::ON ||
+         cfg.auto_mixed_precision() == RewriterConfig::ON ||
          !cfg.optimizers().empty() || !cfg.custom_optimizers().empty();
 }
 
@@ -20,6 +20,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
 namespace tensorflow {
@@ -72,7 +74,11 @@ class MetaOptimizer : public GraphOptimizer {
     std::vector<OptimizerResult> results;
   };
 
-  std::vector<GraphOptimizationResult> optimization_results_;
+  // Function bodies are optimized concurrently, so results are recorded under
+  // a lock.
+  mutex results_mu_;
+  std::vector<GraphOptimizationResult> optimization_results_
+      GUARDED_BY(results_mu_);
 };
 
 bool MetaOptimizerEnabled(const RewriterConfig& cfg);
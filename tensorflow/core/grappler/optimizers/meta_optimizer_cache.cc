@@ -0,0 +1,151 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <map>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+void AppendProto(const protobuf::MessageLite& proto, string* out) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  strings::StrAppend(out, serialized.size(), ":", serialized);
+}
+
+string CacheFilePath(const string& cache_dir, const string& key) {
+  return io::JoinPath(cache_dir, strings::StrCat(key, ".pb"));
+}
+
+}  // namespace
+
+MetaOptimizerCache* MetaOptimizerCache::Global() {
+  static MetaOptimizerCache* global_cache = new MetaOptimizerCache;
+  return global_cache;
+}
+
+string MetaOptimizerCache::Key(
+    const GrapplerItem& item, const RewriterConfig& cfg,
+    const std::unordered_map<string, DeviceProperties>& devices) {
+  string material =
+      strings::StrCat(TF_VERSION_STRING, ";", TF_GRAPH_DEF_VERSION, ";");
+  AppendProto(item.graph, &material);
+  for (const string& fetch : item.fetch) {
+    strings::StrAppend(&material, "fetch:", fetch, ";");
+  }
+  for (const auto& feed : item.feed) {
+    strings::StrAppend(&material, "feed:", feed.first, ":",
+                       DataTypeString(feed.second.dtype()),
+                       feed.second.shape().DebugString(), ";");
+  }
+
+  // The cache settings don't affect the optimized graph, so sessions that only
+  // differ in them share entries.
+  RewriterConfig cfg_without_cache = cfg;
+  cfg_without_cache.clear_cache_optimized_graphs();
+  cfg_without_cache.clear_optimized_graph_cache_dir();
+  AppendProto(cfg_without_cache, &material);
+
+  const std::map<string, DeviceProperties> sorted_devices(devices.begin(),
+                                                          devices.end());
+  for (const auto& device : sorted_devices) {
+    strings::StrAppend(&material, "device:", device.first, ":");
+    AppendProto(device.second, &material);
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(material);
+  return strings::Printf("%016llx%016llx",
+                         static_cast<unsigned long long>(fingerprint.high64),
+                         static_cast<unsigned long long>(fingerprint.low64));
+}
+
+bool MetaOptimizerCache::Lookup(const string& key, const string& cache_dir,
+                                GraphDef* optimized_graph) {
+  std::shared_ptr<const GraphDef> cached;
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) cached = it->second;
+  }
+  if (cached) {
+    VLOG(1) << "Found optimized graph " << key << " in memory";
+    *optimized_graph = *cached;
+    return true;
+  }
+  if (cache_dir.empty()) return false;
+
+  const string path = CacheFilePath(cache_dir, key);
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) return false;
+  std::shared_ptr<GraphDef> loaded(new GraphDef);
+  Status s = ReadBinaryProto(env, path, loaded.get());
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring unreadable optimized graph cache entry " << path
+                 << ": " << s;
+    return false;
+  }
+  VLOG(1) << "Loaded optimized graph from " << path;
+  *optimized_graph = *loaded;
+  InsertInMemory(key, std::move(loaded));
+  return true;
+}
+
+void MetaOptimizerCache::Insert(const string& key, const string& cache_dir,
+                                const GraphDef& optimized_graph) {
+  InsertInMemory(key, std::make_shared<const GraphDef>(optimized_graph));
+  if (cache_dir.empty()) return;
+
+  // Write to a temporary file first, so that concurrent readers (possibly in
+  // other processes) never see a partially written entry.
+  Env* env = Env::Default();
+  const string path = CacheFilePath(cache_dir, key);
+  const string tmp_path = strings::StrCat(path, ".tmp", env->NowMicros());
+  Status s = env->RecursivelyCreateDir(cache_dir);
+  if (s.ok()) s = WriteBinaryProto(env, tmp_path, optimized_graph);
+  if (s.ok()) s = env->RenameFile(tmp_path, path);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write optimized graph cache entry " << path
+                 << ": " << s;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
+void MetaOptimizerCache::InsertInMemory(
+    const string& key, std::shared_ptr<const GraphDef> optimized_graph) {
+  mutex_lock l(mu_);
+  if (!entries_.emplace(key, std::move(optimized_graph)).second) return;
+  insertion_order_.push_back(key);
+  while (insertion_order_.size() > max_entries_) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,81 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Caches the output of the meta-optimizer, so that optimizing the same graph
+// for the same devices again (e.g. when a new session is created for a model
+// that is already loaded) is a lookup. Entries are kept in memory and, if a
+// cache directory is given, also as binary GraphDefs in that directory.
+//
+// This class is thread-safe.
+class MetaOptimizerCache {
+ public:
+  explicit MetaOptimizerCache(int max_entries = 64)
+      : max_entries_(max_entries) {}
+
+  // Returns the process-wide cache.
+  static MetaOptimizerCache* Global();
+
+  // Returns a key that identifies the result of optimizing <item> with <cfg>
+  // for <devices>. The key also covers the TensorFlow version, since the
+  // optimizers themselves change between releases.
+  static string Key(
+      const GrapplerItem& item, const RewriterConfig& cfg,
+      const std::unordered_map<string, DeviceProperties>& devices);
+
+  // Looks up <key> in memory and then in <cache_dir> (if non-empty). Returns
+  // true and fills in <optimized_graph> on a hit.
+  bool Lookup(const string& key, const string& cache_dir,
+              GraphDef* optimized_graph);
+
+  // Records <optimized_graph> for <key>. Failures to write to <cache_dir> are
+  // logged and otherwise ignored.
+  void Insert(const string& key, const string& cache_dir,
+              const GraphDef& optimized_graph);
+
+ private:
+  void InsertInMemory(const string& key,
+                      std::shared_ptr<const GraphDef> optimized_graph);
+
+  const int max_entries_;
+
+  mutex mu_;
+  std::unordered_map<string, std::shared_ptr<const GraphDef>> entries_
+      GUARDED_BY(mu_);
+  // Keys in insertion order, oldest first.
+  std::deque<string> insertion_order_ GUARDED_BY(mu_);
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
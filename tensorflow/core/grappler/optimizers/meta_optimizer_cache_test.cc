@@ -0,0 +1,102 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class MetaOptimizerCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+    CHECK(fake_input.NextItem(&item_));
+    devices_["/device:CPU:0"].set_type("CPU");
+  }
+
+  GrapplerItem item_;
+  RewriterConfig cfg_;
+  std::unordered_map<string, DeviceProperties> devices_;
+};
+
+TEST_F(MetaOptimizerCacheTest, KeyCoversInputs) {
+  const string key = MetaOptimizerCache::Key(item_, cfg_, devices_);
+  EXPECT_EQ(key, MetaOptimizerCache::Key(item_, cfg_, devices_));
+
+  // The cache settings themselves are not part of the key.
+  RewriterConfig cached_cfg = cfg_;
+  cached_cfg.set_cache_optimized_graphs(true);
+  cached_cfg.set_optimized_graph_cache_dir("/tmp/foo");
+  EXPECT_EQ(key, MetaOptimizerCache::Key(item_, cached_cfg, devices_));
+
+  RewriterConfig other_cfg = cfg_;
+  other_cfg.set_constant_folding(RewriterConfig::OFF);
+  EXPECT_NE(key, MetaOptimizerCache::Key(item_, other_cfg, devices_));
+
+  std::unordered_map<string, DeviceProperties> other_devices = devices_;
+  other_devices["/device:GPU:0"].set_type("GPU");
+  EXPECT_NE(key, MetaOptimizerCache::Key(item_, cfg_, other_devices));
+
+  GrapplerItem other_item = item_;
+  other_item.fetch.push_back("foo");
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_item, cfg_, devices_));
+}
+
+TEST_F(MetaOptimizerCacheTest, InMemory) {
+  MetaOptimizerCache cache(/*max_entries=*/1);
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup("a", "", &graph));
+
+  cache.Insert("a", "", item_.graph);
+  ASSERT_TRUE(cache.Lookup("a", "", &graph));
+  EXPECT_EQ(item_.graph.node_size(), graph.node_size());
+
+  // Inserting a second entry evicts the first one.
+  cache.Insert("b", "", GraphDef());
+  EXPECT_FALSE(cache.Lookup("a", "", &graph));
+  EXPECT_TRUE(cache.Lookup("b", "", &graph));
+}
+
+TEST_F(MetaOptimizerCacheTest, OnDisk) {
+  const string cache_dir = io::JoinPath(testing::TmpDir(), "graph_cache");
+  {
+    MetaOptimizerCache cache;
+    cache.Insert("a", cache_dir, item_.graph);
+  }
+
+  // A fresh cache, as in a new process, finds the entry on disk.
+  MetaOptimizerCache cache;
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup("a", cache_dir, &graph));
+  EXPECT_EQ(item_.graph.node_size(), graph.node_size());
+  EXPECT_FALSE(cache.Lookup("b", cache_dir, &graph));
+
+  // Corrupted entries are ignored.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 io::JoinPath(cache_dir, "c.pb"), "garbage"));
+  EXPECT_FALSE(cache.Lookup("c", cache_dir, &graph));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
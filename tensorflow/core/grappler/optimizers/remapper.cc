@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_view.h"
@@ -22,10 +27,375 @@ limitations under the License.
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 namespace grappler {
 
+namespace {
+
+// The elementwise ops implemented by the _FusedElementwise kernel, with
+// their number of inputs.
+const std::unordered_map<string, int>& FusibleElementwiseOps() {
+  static const auto* ops = new std::unordered_map<string, int>({
+      {"Abs", 1},
+      {"Exp", 1},
+      {"Log", 1},
+      {"Neg", 1},
+      {"Relu", 1},
+      {"Relu6", 1},
+      {"Rsqrt", 1},
+      {"Sigmoid", 1},
+      {"Sqrt", 1},
+      {"Square", 1},
+      {"Tanh", 1},
+      {"Add", 2},
+      {"Sub", 2},
+      {"Mul", 2},
+      {"Div", 2},
+      {"RealDiv", 2},
+      {"Maximum", 2},
+      {"Minimum", 2},
+      {"SquaredDifference", 2},
+  });
+  return *ops;
+}
+
+// Returns true and sets 'shape' if 'proto' is fully defined.
+bool FullyDefinedShape(const TensorShapeProto& proto, TensorShape* shape) {
+  if (!TensorShape::IsValid(proto)) return false;
+  *shape = TensorShape(proto);
+  return true;
+}
+
+// Fuses chains of elementwise ops placed on the CPU into _FusedElementwise
+// nodes, so that intermediate results are not written to memory.
+//
+// A chain is a tree of fusible ops whose root has the shape of all the
+// intermediate results; every node of the tree except the root has the next
+// node as its only consumer. The inputs of the tree may also be scalars or
+// vectors broadcast along the innermost dimension.
+class ElementwiseFuser {
+ public:
+  // Nodes in 'excluded' are never fused.
+  ElementwiseFuser(const GrapplerItem& item, const GraphProperties& properties,
+                   const GraphView& graph,
+                   const std::unordered_set<string>& excluded)
+      : properties_(properties),
+        graph_(graph),
+        nodes_to_preserve_(item.NodesToPreserve()),
+        excluded_(excluded) {}
+
+  // Returns the fused node to replace 'root' with, and adds the nodes fused
+  // into it to 'fused'. Returns false if 'root' is not the root of a chain of
+  // at least two ops.
+  bool Fuse(const NodeDef& root, NodeDef* fused_node,
+            std::unordered_set<string>* fused) {
+    if (!IsFusible(root) || IsFusedIntoConsumer(root)) return false;
+    inputs_.clear();
+    input_shapes_.clear();
+    input_index_.clear();
+    emitted_.clear();
+    ops_.clear();
+    operands_.clear();
+    control_inputs_.clear();
+    nodes_.clear();
+    Emit(root);
+    if (ops_.size() < 2) return false;
+
+    // inputs[0] determines the output shape of the fused node, so it must be
+    // a full-sized input.
+    TensorShape shape;
+    FullyDefinedShape(properties_.GetOutputProperties(root.name())[0].shape(),
+                      &shape);
+    int full_input = -1;
+    for (int i = 0; i < inputs_.size(); ++i) {
+      if (input_shapes_[i] == shape) {
+        full_input = i;
+        break;
+      }
+    }
+    if (full_input < 0) return false;
+    std::swap(inputs_[0], inputs_[full_input]);
+
+    fused_node->set_name(root.name());
+    fused_node->set_op("_FusedElementwise");
+    fused_node->set_device(root.device());
+    (*fused_node->mutable_attr())["T"] = root.attr().at("T");
+    (*fused_node->mutable_attr())["N"].set_i(inputs_.size());
+    for (const string& input : inputs_) {
+      fused_node->add_input(input);
+    }
+    for (const string& control_input : control_inputs_) {
+      fused_node->add_input(control_input);
+    }
+    auto* ops = (*fused_node->mutable_attr())["ops"].mutable_list();
+    for (const string& op : ops_) {
+      ops->add_s(op);
+    }
+    auto* operands = (*fused_node->mutable_attr())["operands"].mutable_list();
+    const int num_inputs = inputs_.size();
+    for (const Operand& operand : operands_) {
+      int index = operand.index;
+      if (operand.kind == Operand::kInput) {
+        // Undo the swap of inputs 0 and full_input.
+        if (index == 0) {
+          index = full_input;
+        } else if (index == full_input) {
+          index = 0;
+        }
+      } else if (operand.kind == Operand::kOp) {
+        index += num_inputs;
+      }
+      operands->add_i(index);
+    }
+    // The root is replaced by the fused node, the other nodes are removed.
+    fused->insert(nodes_.begin(), nodes_.end() - 1);
+    return true;
+  }
+
+ private:
+  struct Operand {
+    enum Kind { kNone, kInput, kOp };
+    Kind kind;
+    int index;
+  };
+
+  bool IsFusible(const NodeDef& node) const {
+    const int* num_inputs = gtl::FindOrNull(FusibleElementwiseOps(), node.op());
+    if (num_inputs == nullptr || node.attr().count("T") == 0 ||
+        excluded_.count(node.name()) > 0) {
+      return false;
+    }
+    const DataType dtype = node.attr().at("T").type();
+    if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+    DeviceNameUtils::ParsedName device;
+    if (!DeviceNameUtils::ParseFullName(node.device(), &device) ||
+        !device.has_type || device.type != DEVICE_CPU) {
+      return false;
+    }
+    if (!properties_.HasInputProperties(node.name()) ||
+        !properties_.HasOutputProperties(node.name())) {
+      return false;
+    }
+    const auto& inputs = properties_.GetInputProperties(node.name());
+    const auto& outputs = properties_.GetOutputProperties(node.name());
+    if (inputs.size() != *num_inputs || outputs.size() != 1) return false;
+    TensorShape shape;
+    if (!FullyDefinedShape(outputs[0].shape(), &shape)) return false;
+    for (const auto& input : inputs) {
+      if (!IsBroadcastableTo(input.shape(), shape)) return false;
+    }
+    return true;
+  }
+
+  // Returns true if a tensor of shape 'input' can be fed to the fused kernel
+  // computing a result of shape 'output'.
+  static bool IsBroadcastableTo(const TensorShapeProto& input,
+                                const TensorShape& output) {
+    TensorShape shape;
+    if (!FullyDefinedShape(input, &shape)) return false;
+    if (shape == output || shape.num_elements() == 1) return true;
+    return shape.dims() == 1 && output.dims() > 1 &&
+           shape.dim_size(0) == output.dim_size(output.dims() - 1);
+  }
+
+  // Returns true if 'node' is fused into its only consumer.
+  bool IsFusedIntoConsumer(const NodeDef& node) const {
+    if (nodes_to_preserve_.count(node.name()) > 0) return false;
+    NodeDef* mutable_node = const_cast<NodeDef*>(&node);
+    const auto& fanout =
+        graph_.GetFanout(GraphView::OutputPort(mutable_node, 0));
+    const auto& control_fanout =
+        graph_.GetFanout(GraphView::OutputPort(mutable_node, -1));
+    if (fanout.empty() || !control_fanout.empty()) return false;
+    const NodeDef* consumer = fanout.begin()->node;
+    for (const GraphView::InputPort& port : fanout) {
+      if (port.node != consumer || port.port_id < 0) return false;
+    }
+    if (!IsFusible(*consumer) || consumer->device() != node.device() ||
+        consumer->attr().at("T").type() != node.attr().at("T").type()) {
+      return false;
+    }
+    // Intermediate results must have the shape of the output.
+    TensorShape shape;
+    TensorShape consumer_shape;
+    return FullyDefinedShape(
+               properties_.GetOutputProperties(node.name())[0].shape(),
+               &shape) &&
+           FullyDefinedShape(
+               properties_.GetOutputProperties(consumer->name())[0].shape(),
+               &consumer_shape) &&
+           shape == consumer_shape;
+  }
+
+  // Appends the ops computing 'node' to the fused program, and returns the
+  // operand referring to its result.
+  Operand Emit(const NodeDef& node) {
+    const auto& input_properties = properties_.GetInputProperties(node.name());
+    Operand args[2] = {{Operand::kNone, -1}, {Operand::kNone, -1}};
+    int num_args = 0;
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) {
+        control_inputs_.push_back(input);
+        continue;
+      }
+      const NodeDef* producer = graph_.GetNode(NodeName(input));
+      int position;
+      ParseNodeName(input, &position);
+      Operand arg;
+      if (producer != nullptr && position == 0 && IsFusible(*producer) &&
+          IsFusedIntoConsumer(*producer)) {
+        auto it = emitted_.find(producer->name());
+        if (it != emitted_.end()) {
+          arg = it->second;
+        } else {
+          arg = Emit(*producer);
+          emitted_[producer->name()] = arg;
+        }
+      } else {
+        arg = {Operand::kInput, InputIndex(input, input_properties[num_args])};
+      }
+      args[num_args++] = arg;
+    }
+    ops_.push_back(node.op());
+    operands_.push_back(args[0]);
+    operands_.push_back(args[1]);
+    nodes_.push_back(node.name());
+    return {Operand::kOp, static_cast<int>(ops_.size()) - 1};
+  }
+
+  int InputIndex(const string& input,
+                 const OpInfo::TensorProperties& properties) {
+    auto it = input_index_.find(input);
+    if (it != input_index_.end()) return it->second;
+    TensorShape shape;
+    FullyDefinedShape(properties.shape(), &shape);
+    input_index_[input] = inputs_.size();
+    inputs_.push_back(input);
+    input_shapes_.push_back(shape);
+    return inputs_.size() - 1;
+  }
+
+  const GraphProperties& properties_;
+  const GraphView& graph_;
+  const std::unordered_set<string> nodes_to_preserve_;
+  const std::unordered_set<string>& excluded_;
+
+  // State of the chain being fused.
+  std::vector<string> inputs_;
+  std::vector<TensorShape> input_shapes_;
+  std::unordered_map<string, int> input_index_;
+  std::unordered_map<string, Operand> emitted_;
+  std::vector<string> ops_;
+  std::vector<Operand> operands_;
+  std::vector<string> control_inputs_;
+  std::vector<string> nodes_;
+};
+
+
+// Returns true if the only consumer of 'node' is input 'port' of 'consumer',
+// and the intermediate result can therefore be dropped.
+bool IsOnlyConsumedBy(const GraphView& graph, const NodeDef& node,
+                      const NodeDef& consumer, int port) {
+  NodeDef* mutable_node = const_cast<NodeDef*>(&node);
+  const auto& fanout = graph.GetFanout(GraphView::OutputPort(mutable_node, 0));
+  const auto& control_fanout =
+      graph.GetFanout(GraphView::OutputPort(mutable_node, -1));
+  if (fanout.size() != 1 || !control_fanout.empty()) return false;
+  return fanout.begin()->node == &consumer && fanout.begin()->port_id == port;
+}
+
+// Returns true if _FusedConv2D or _FusedMatMul supports 'producer', a Conv2D
+// or MatMul, and the BiasAdd 'bias_add' applied to its output.
+bool IsFusibleWithBias(const NodeDef& producer, const NodeDef& bias_add) {
+  if ((producer.op() != "Conv2D" && producer.op() != "MatMul") ||
+      producer.device() != bias_add.device() ||
+      producer.attr().count("T") == 0 || bias_add.attr().count("T") == 0) {
+    return false;
+  }
+  const DataType dtype = producer.attr().at("T").type();
+  if ((dtype != DT_HALF && dtype != DT_FLOAT && dtype != DT_DOUBLE) ||
+      bias_add.attr().at("T").type() != dtype) {
+    return false;
+  }
+  const string producer_format = producer.attr().count("data_format") > 0
+                                     ? producer.attr().at("data_format").s()
+                                     : "NHWC";
+  const string bias_format = bias_add.attr().count("data_format") > 0
+                                 ? bias_add.attr().at("data_format").s()
+                                 : "NHWC";
+  if (producer_format != bias_format) return false;
+  DeviceNameUtils::ParsedName device;
+  if (!DeviceNameUtils::ParseFullName(producer.device(), &device) ||
+      !device.has_type) {
+    return false;
+  }
+  // The CPU convolution only supports NHWC.
+  return device.type == DEVICE_GPU ||
+         (device.type == DEVICE_CPU && producer_format == "NHWC");
+}
+
+// Replaces Conv2D or MatMul + BiasAdd, optionally followed by Relu or Relu6,
+// ending at 'node' with a _FusedConv2D or _FusedMatMul node of the same name,
+// and adds the replaced nodes to 'fused'. Returns false if 'node' does not end
+// such a pattern.
+bool FuseBiasActivation(const GraphView& graph,
+                        const std::unordered_set<string>& preserve,
+                        const NodeDef& node, NodeDef* fused_node,
+                        std::unordered_set<string>* fused) {
+  const NodeDef* activation = nullptr;
+  const NodeDef* bias_add = &node;
+  if (node.op() == "Relu" || node.op() == "Relu6") {
+    activation = &node;
+    bias_add = graph.GetNode(NodeName(node.input(0)));
+    if (bias_add == nullptr || bias_add->op() != "BiasAdd" ||
+        preserve.count(bias_add->name()) > 0 ||
+        !IsOnlyConsumedBy(graph, *bias_add, node, 0)) {
+      return false;
+    }
+  } else if (node.op() != "BiasAdd") {
+    return false;
+  }
+  const NodeDef* producer = graph.GetNode(NodeName(bias_add->input(0)));
+  if (producer == nullptr || preserve.count(producer->name()) > 0 ||
+      !IsFusibleWithBias(*producer, *bias_add) ||
+      !IsOnlyConsumedBy(graph, *producer, *bias_add, 0)) {
+    return false;
+  }
+  if (activation != nullptr &&
+      (activation->device() != bias_add->device() ||
+       activation->attr().at("T").type() != bias_add->attr().at("T").type())) {
+    return false;
+  }
+
+  fused_node->set_name(node.name());
+  fused_node->set_op(producer->op() == "Conv2D" ? "_FusedConv2D"
+                                                : "_FusedMatMul");
+  fused_node->set_device(producer->device());
+  fused_node->add_input(producer->input(0));
+  fused_node->add_input(producer->input(1));
+  fused_node->add_input(bias_add->input(1));
+  for (const NodeDef* n : {producer, bias_add, activation}) {
+    if (n == nullptr) continue;
+    for (const string& input : n->input()) {
+      if (IsControlInput(input)) fused_node->add_input(input);
+    }
+  }
+  for (const auto& attr : producer->attr()) {
+    (*fused_node->mutable_attr())[attr.first] = attr.second;
+  }
+  (*fused_node->mutable_attr())["activation"].set_s(
+      activation != nullptr ? activation->op() : "Identity");
+
+  fused->insert(producer->name());
+  if (activation != nullptr) fused->insert(bias_add->name());
+  return true;
+}
+
+}  // namespace
+
 void AddBatchNormNodes(GraphDef* optimized_graph, const NodeDef& fused_node) {
   const string& x = fused_node.input(0);
   string scale = fused_node.input(1);
@@ -170,9 +540,51 @@ Status Remapper::Optimize(Cluster* /*cluster*/, const GrapplerItem& item,
   TF_RETURN_IF_ERROR(properties.InferStatically(false));
   GraphView graph(const_cast<GraphDef*>(&item.graph));
 
+  // Conv2D or MatMul + BiasAdd, and the Relu or Relu6 that may follow, are
+  // replaced by a single _FusedConv2D or _FusedMatMul node named after the
+  // last op of the pattern.
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  std::unordered_map<string, NodeDef> fused_roots;
+  std::unordered_set<string> fused_nodes;
+  for (const NodeDef& node : item.graph.node()) {
+    NodeDef fused_node;
+    if (fused_nodes.count(node.name()) == 0 &&
+        FuseBiasActivation(graph, nodes_to_preserve, node, &fused_node,
+                           &fused_nodes)) {
+      fused_roots[node.name()] = std::move(fused_node);
+    }
+  }
+  // A BiasAdd followed by a Relu is matched both on its own and as part of
+  // the longer pattern; keep the longer one.
+  for (const string& name : fused_nodes) {
+    fused_roots.erase(name);
+  }
+
+  // Chains of elementwise ops on the CPU are replaced by a single
+  // _FusedElementwise node named after the last op of the chain.
+  std::unordered_set<string> claimed = fused_nodes;
+  for (const auto& fused_root : fused_roots) {
+    claimed.insert(fused_root.first);
+  }
+  ElementwiseFuser fuser(item, properties, graph, claimed);
+  for (const NodeDef& node : item.graph.node()) {
+    NodeDef fused_node;
+    if (fuser.Fuse(node, &fused_node, &fused_nodes)) {
+      fused_roots[node.name()] = std::move(fused_node);
+    }
+  }
+
   // During inference, most of the inputs to FusedBatchNorm are constant, and we
   // can therefore replace the op with a much cheaper set of primitives.
   for (const NodeDef& node : item.graph.node()) {
+    if (fused_nodes.count(node.name()) > 0) {
+      continue;
+    }
+    auto fused_root = fused_roots.find(node.name());
+    if (fused_root != fused_roots.end()) {
+      *optimized_graph->add_node() = fused_root->second;
+      continue;
+    }
     if (node.op() == "FusedBatchNorm" || node.op() == "FusedBatchNormV2") {
       bool optimizable = (node.attr().count("T") == 0 ||
                           node.attr().at("T").type() == DT_FLOAT);
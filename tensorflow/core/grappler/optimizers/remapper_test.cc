@@ -91,5 +91,251 @@ TEST_F(RemapperTest, FusedBatchNormNCHW) {
   }
 }
 
+// Builds square(tanh((x + bias) * scale)) on the CPU.
+void BuildElementwiseChain(const tensorflow::Scope& scope) {
+  tensorflow::Scope s = scope.WithDevice("/device:CPU:0");
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({4, 3}));
+  Output bias = ops::Const(s.WithOpName("bias"), {0.1f, -0.2f, 0.3f}, {3});
+  Output scale = ops::Const(s.WithOpName("scale"), 2.0f);
+  Output add = ops::Add(s.WithOpName("add"), x, bias);
+  Output mul = ops::Mul(s.WithOpName("mul"), add, scale);
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), mul);
+  ops::Square(s.WithOpName("square"), tanh);
+}
+
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  BuildElementwiseChain(s);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"square"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // x, bias, scale and the fused square.
+  EXPECT_EQ(4, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "square") {
+      EXPECT_EQ("_FusedElementwise", node.op());
+      ASSERT_EQ(3, node.input_size());
+      EXPECT_EQ("x", node.input(0));
+      EXPECT_EQ(4, node.attr().at("ops").list().s_size());
+    }
+  }
+
+  Tensor x(DT_FLOAT, TensorShape({4, 3}));
+  x.flat<float>().setRandom();
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x}});
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseElementwiseChainKeepsFetchedNodes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  BuildElementwiseChain(s);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"mul", "square"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The chain is split into add -> mul and tanh -> square.
+  EXPECT_EQ(5, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("add", node.name());
+    EXPECT_NE("tanh", node.name());
+    if (node.name() == "mul" || node.name() == "square") {
+      EXPECT_EQ("_FusedElementwise", node.op());
+    }
+  }
+
+  Tensor x(DT_FLOAT, TensorShape({4, 3}));
+  x.flat<float>().setRandom();
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x}});
+  EXPECT_EQ(2, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+  test::ExpectTensorNear<float>(tensors_expected[1], tensors[1], 1e-6);
+}
+
+TEST_F(RemapperTest, DoNotFuseElementwiseChainOffCPU) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Const(s.WithOpName("x"), {1.0f, 2.0f}, {2});
+  Output y = ops::Exp(s.WithOpName("y"), x);
+  ops::Neg(s.WithOpName("z"), y);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"z"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(3, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("_FusedElementwise", node.op());
+  }
+}
+
+// Builds relu(bias_add(conv2d(x, filter), bias)) on the CPU.
+void BuildConv2DBiasRelu(const tensorflow::Scope& scope) {
+  tensorflow::Scope s = scope.WithDevice("/device:CPU:0");
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 5, 5, 3}));
+  Tensor filter_value(DT_FLOAT, TensorShape({3, 3, 3, 4}));
+  filter_value.flat<float>().setRandom();
+  Output filter = ops::Const(s.WithOpName("filter"), filter_value);
+  Output bias = ops::Const(s.WithOpName("bias"), {0.1f, -0.2f, 0.3f, -0.4f},
+                           {4});
+  Output conv = ops::Conv2D(s.WithOpName("conv"), x, filter, {1, 1, 1, 1},
+                            "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, bias);
+  ops::Relu(s.WithOpName("relu"), bias_add);
+}
+
+TEST_F(RemapperTest, FuseConv2DBiasRelu) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  BuildConv2DBiasRelu(s);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"relu"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // x, filter, bias and the fused relu.
+  EXPECT_EQ(4, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "relu") {
+      EXPECT_EQ("_FusedConv2D", node.op());
+      ASSERT_EQ(3, node.input_size());
+      EXPECT_EQ("x", node.input(0));
+      EXPECT_EQ("filter", node.input(1));
+      EXPECT_EQ("bias", node.input(2));
+      EXPECT_EQ("Relu", node.attr().at("activation").s());
+      EXPECT_EQ("SAME", node.attr().at("padding").s());
+    }
+  }
+
+  Tensor x(DT_FLOAT, TensorShape({2, 5, 5, 3}));
+  x.flat<float>().setRandom();
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x}});
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-5);
+}
+
+TEST_F(RemapperTest, FuseConv2DBiasKeepsFetchedNodes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  BuildConv2DBiasRelu(s);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"bias_add", "relu"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Only the convolution and the bias are fused.
+  EXPECT_EQ(5, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("conv", node.name());
+    if (node.name() == "bias_add") {
+      EXPECT_EQ("_FusedConv2D", node.op());
+      EXPECT_EQ("Identity", node.attr().at("activation").s());
+    } else if (node.name() == "relu") {
+      EXPECT_EQ("Relu", node.op());
+    }
+  }
+
+  Tensor x(DT_FLOAT, TensorShape({2, 5, 5, 3}));
+  x.flat<float>().setRandom();
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x}});
+  EXPECT_EQ(2, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-5);
+  test::ExpectTensorNear<float>(tensors_expected[1], tensors[1], 1e-5);
+}
+
+TEST_F(RemapperTest, DoNotFuseConv2DNCHWOnCPU) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/device:CPU:0");
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 3, 5, 5}));
+  Output filter = ops::Const(s.WithOpName("filter"), 1.0f, {3, 3, 3, 4});
+  Output bias = ops::Const(s.WithOpName("bias"), 1.0f, {4});
+  Output conv = ops::Conv2D(s.WithOpName("conv"), x, filter, {1, 1, 1, 1},
+                            "SAME", ops::Conv2D::DataFormat("NCHW"));
+  ops::BiasAdd(s.WithOpName("bias_add"), conv, bias,
+               ops::BiasAdd::DataFormat("NCHW"));
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"bias_add"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(5, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("_FusedConv2D", node.op());
+  }
+}
+
+TEST_F(RemapperTest, FuseMatMulBiasRelu6) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({4, 8}));
+  Tensor weights_value(DT_FLOAT, TensorShape({8, 3}));
+  weights_value.flat<float>().setRandom();
+  Output weights = ops::Const(s.WithOpName("weights"), weights_value);
+  Output bias = ops::Const(s.WithOpName("bias"), {0.5f, -0.5f, 5.5f}, {3});
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), x, weights);
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+  ops::Relu6(s.WithOpName("relu6"), bias_add);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"relu6"};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // x, weights, bias and the fused relu6.
+  EXPECT_EQ(4, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "relu6") {
+      EXPECT_EQ("_FusedMatMul", node.op());
+      ASSERT_EQ(3, node.input_size());
+      EXPECT_EQ("bias", node.input(2));
+      EXPECT_EQ("Relu6", node.attr().at("activation").s());
+      EXPECT_FALSE(node.attr().at("transpose_a").b());
+    }
+  }
+
+  Tensor x_value(DT_FLOAT, TensorShape({4, 8}));
+  x_value.flat<float>().setRandom();
+  auto tensors_expected =
+      EvaluateNodes(item.graph, item.fetch, {{"x", x_value}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x_value}});
+  EXPECT_EQ(1, tensors.size());
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-5);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
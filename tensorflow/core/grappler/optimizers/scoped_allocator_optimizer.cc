@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 
 // Like TF_RETURN_IF_ERROR, but also logs a WARNING.
@@ -650,7 +651,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 };
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
-    const ScopedAllocatorOptions& opts) {
+    const ScopedAllocatorOptions& opts)
+    : max_bucket_bytes_(opts.max_bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
@@ -824,6 +826,9 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
     int num_frames;
     LOG_WARNING_AND_RETURN_IF_ERROR(
         IdentifyFramesWithNodeMap(*graph, *node_map_, &frame_map, &num_frames));
+    if (max_bucket_bytes_ > 0) {
+      LOG_WARNING_AND_RETURN_IF_ERROR(ComputeNodeDepths(*graph));
+    }
     for (auto& dt : occ) {
       VLOG(2) << "Processing device " << dt.first;
       const DevOpOccurrences& dev_occ = dt.second;
@@ -841,19 +846,25 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(
-            root.get(), [this, rewriter, graph, &frame_map, &op_name](Tree* t) {
+            root.get(), [this, rewriter, graph, &graph_properties, &frame_map,
+                         &op_name](Tree* t) {
               VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                       << t->depth_ << " of size " << t->nodes_.size();
               if (t->nodes_.size() > 1) {
                 std::vector<std::vector<NodeDef*>> loop_groups;
                 PartitionByLoopStructure(frame_map, t->nodes_, &loop_groups);
                 for (auto& lg : loop_groups) {
-                  if (lg.size() > 1) {
+                  if (lg.size() <= 1) continue;
+                  std::vector<std::vector<NodeDef*>> buckets;
+                  PartitionIntoBuckets(graph_properties, lg, &buckets);
+                  for (auto& bucket : buckets) {
+                    if (bucket.size() <= 1) continue;
                     bool applied = false;
-                    Status s = OrderNodeSet(&lg);
+                    Status s = OrderNodeSet(&bucket);
                     TF_RETURN_IF_ERROR(s);
                     VLOG(1) << "Applying Rewriter for " << op_name;
-                    s = rewriter->Rewrite(this, graph, op_name, lg, &applied);
+                    s = rewriter->Rewrite(this, graph, op_name, bucket,
+                                          &applied);
                     LOG_WARNING_AND_RETURN_IF_ERROR(s);
                   }
                 }
@@ -923,6 +934,82 @@ Status ScopedAllocatorOptimizer::OrderNodeSet(
   return Status::OK();
 }
 
+Status ScopedAllocatorOptimizer::ComputeNodeDepths(const GraphDef& graph) {
+  std::unordered_map<const NodeDef*, int> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(graph, &topo_order, nullptr));
+  std::vector<const NodeDef*> ordered(topo_order.size());
+  for (const auto& it : topo_order) {
+    ordered[it.second] = it.first;
+  }
+  node_depth_.clear();
+  for (const NodeDef* n : ordered) {
+    int depth = 0;
+    for (const string& input : n->input()) {
+      // Loop back edges (from NextIteration) are not visited yet, and
+      // count as 0.
+      auto it = node_depth_.find(node_map_->GetNode(input));
+      if (it != node_depth_.end()) {
+        depth = std::max(depth, it->second + 1);
+      }
+    }
+    node_depth_[n] = depth;
+  }
+  return Status::OK();
+}
+
+void ScopedAllocatorOptimizer::PartitionIntoBuckets(
+    const GraphProperties& graph_properties, const std::vector<NodeDef*>& nodes,
+    std::vector<std::vector<NodeDef*>>* buckets) const {
+  if (max_bucket_bytes_ <= 0) {
+    buckets->push_back(nodes);
+    return;
+  }
+  std::vector<NodeDef*> ordered(nodes);
+  std::vector<NodeDef*> tie_order(nodes);
+  std::sort(tie_order.begin(), tie_order.end(), NameLess());
+  if (IsCollectiveNode(*nodes[0])) {
+    std::sort(tie_order.begin(), tie_order.end(), InstanceKeyLess());
+  }
+  std::unordered_map<const NodeDef*, int> tie_rank;
+  for (int i = 0; i < tie_order.size(); ++i) {
+    tie_rank[tie_order[i]] = i;
+  }
+  auto depth = [this](const NodeDef* n) {
+    auto it = node_depth_.find(n);
+    return it == node_depth_.end() ? 0 : it->second;
+  };
+  std::sort(ordered.begin(), ordered.end(),
+            [&depth, &tie_rank](const NodeDef* a, const NodeDef* b) {
+              const int da = depth(a);
+              const int db = depth(b);
+              if (da != db) return da < db;
+              return tie_rank[a] < tie_rank[b];
+            });
+  std::vector<NodeDef*> bucket;
+  int64 bucket_bytes = 0;
+  for (NodeDef* n : ordered) {
+    // Nodes of unknown size are left to the rewriter to reject.
+    int64 bytes = 0;
+    if (graph_properties.HasOutputProperties(n->name())) {
+      const auto& props = graph_properties.GetOutputProperties(n->name());
+      if (props.size() == 1 && TensorShape::IsValid(props[0].shape())) {
+        bytes = TensorShape(props[0].shape()).num_elements() *
+                DataTypeSize(props[0].dtype());
+      }
+    }
+    if (!bucket.empty() && bucket_bytes + bytes > max_bucket_bytes_) {
+      buckets->push_back(std::move(bucket));
+      bucket.clear();
+      bucket_bytes = 0;
+    }
+    bucket.push_back(n);
+    bucket_bytes += bytes;
+  }
+  if (!bucket.empty()) buckets->push_back(std::move(bucket));
+  VLOG(1) << "PartitionIntoBuckets split " << nodes.size() << " nodes into "
+          << buckets->size() << " buckets";
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
 
@@ -93,6 +93,18 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
 
   Status OrderNodeSet(std::vector<NodeDef*>* nodes) const;
 
+  // Sets node_depth_ to the length of the longest path from a graph input
+  // to each node of 'graph'.
+  Status ComputeNodeDepths(const GraphDef& graph);
+
+  // Splits 'nodes' into buckets of at most max_bucket_bytes_ of output, in
+  // order of increasing depth, i.e. in the order in which they can become
+  // ready.  Ties are broken by instance_key for collectives, so that every
+  // device of a collective forms the same buckets.
+  void PartitionIntoBuckets(const GraphProperties& graph_properties,
+                            const std::vector<NodeDef*>& nodes,
+                            std::vector<std::vector<NodeDef*>>* buckets) const;
+
   RewriterConfig::Toggle opt_level_;
   std::unordered_set<string> nodes_to_preserve_;
   OpNameSet op_name_set_;
@@ -100,6 +112,8 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
   std::vector<Rewriter*> to_delete_;
   int next_sa_id_ = 1;
   std::unique_ptr<NodeMap> node_map_;
+  int64 max_bucket_bytes_ = 0;
+  std::unordered_map<const NodeDef*, int> node_depth_;
 };
 
 }  // namespace grappler
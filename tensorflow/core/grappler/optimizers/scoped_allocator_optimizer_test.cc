@@ -93,6 +93,39 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(s.ToGraphDef(graph_def));
   }
 
+  // Like BuildAbsGraph, with a third Abs a3 that is one step deeper, and so
+  // becomes ready after a1 and a2.
+  /*
+        a    b    c
+         \  / \  /|
+          s1   s2 n
+          |    |  |
+          a1   a2 s3-b
+          |    |  |
+          r1   r2 a3
+  */
+  void BuildDeepAbsGraph(GraphDef* graph_def) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    Output a =
+        ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+    Output b =
+        ops::Const<float>(s.WithOpName("b"), {1.0, -2.0, 3.0, 4.0}, {2, 2});
+    Output c =
+        ops::Const<float>(s.WithOpName("c"), {-5.0, -2.0, 0.0, -2.0}, {2, 2});
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Add(s.WithOpName("s2"), b, c);
+    Output n = ops::Neg(s.WithOpName("n"), c);
+    Output s3 = ops::Add(s.WithOpName("s3"), b, n);
+    Output a1 = ops::Abs(s.WithOpName("a1"), s1);
+    Output a2 = ops::Abs(s.WithOpName("a2"), s2);
+    Output a3 = ops::Abs(s.WithOpName("a3"), s3);
+    Output r1 = ops::Reshape(s.WithOpName("r1"), a1, {1, 4});
+    Output r2 = ops::Reshape(s.WithOpName("r2"), a2, {4, 1});
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -162,6 +195,51 @@ TEST_F(ScopedAllocatorOptimizerTest, UnaryRewriteOnly) {
   }
 }
 
+TEST_F(ScopedAllocatorOptimizerTest, BucketsInReadyOrder) {
+  // With room for two 16 byte outputs per bucket, a1 and a2 are merged and
+  // the deeper a3 is left alone.
+  GrapplerItem item;
+  BuildDeepAbsGraph(&item.graph);
+  SetShapes(&item.graph);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  opts.set_max_bucket_bytes(32);
+  ScopedAllocatorOptimizer sao(opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  ASSERT_TRUE(node_map.GetNode("scoped_allocator_1"));
+  auto& nd_set = node_map.GetOutputs("scoped_allocator_1");
+  std::unordered_set<string> names;
+  for (auto it : nd_set) {
+    names.insert(it->name());
+  }
+  EXPECT_EQ(std::unordered_set<string>(
+                {"scoped_allocator_concat_1", "s1", "s2"}),
+            names);
+  ASSERT_TRUE(node_map.GetNode("a3"));
+  EXPECT_EQ("s3", node_map.GetNode("a3")->input(0));
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, BucketTooSmallForTwo) {
+  GrapplerItem item;
+  BuildAbsGraph(&item.graph);
+  SetShapes(&item.graph);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  opts.set_max_bucket_bytes(16);
+  ScopedAllocatorOptimizer sao(opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+  NodeMap node_map(&optimized_graph);
+  EXPECT_FALSE(node_map.GetNode("scoped_allocator_1"));
+}
+
 TEST_F(ScopedAllocatorOptimizerTest, UnaryExecute) {
   // Constructs the same graph as UnaryRewriteOnly, but actually executes it.
   GrapplerItem item;
@@ -0,0 +1,188 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/training_op_fusion.h"
+
+#include <deque>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// ResourceApplyAdam takes var, m, v, the six hyperparameters and grad.
+constexpr int kNumAdamInputs = 10;
+constexpr int kFirstHyperparameter = 3;
+constexpr int kNumHyperparameters = 6;
+
+bool IsFusibleAdam(const NodeDef& node) {
+  if (node.op() != "ResourceApplyAdam" ||
+      NumNonControlInputs(node) != kNumAdamInputs) {
+    return false;
+  }
+  // ResourceApplyAdamN only has CPU and GPU kernels.
+  DeviceNameUtils::ParsedName parsed;
+  if (!node.device().empty() &&
+      (!DeviceNameUtils::ParseFullName(node.device(), &parsed) ||
+       (parsed.has_type && parsed.type != "CPU" && parsed.type != "GPU"))) {
+    return false;
+  }
+  return true;
+}
+
+bool GetBoolAttr(const NodeDef& node, const string& name) {
+  auto it = node.attr().find(name);
+  return it != node.attr().end() && it->second.b();
+}
+
+// Returns a key that is the same for updates that can be fused together:
+// they must run on the same device with the same type, options and
+// hyperparameters.
+string FusionKey(const NodeDef& node) {
+  string key = strings::StrCat(
+      node.device(), ";", GetDataTypeFromAttr(node, "T"), ";",
+      GetBoolAttr(node, "use_locking"), ";",
+      GetBoolAttr(node, "use_nesterov"));
+  for (int i = kFirstHyperparameter;
+       i < kFirstHyperparameter + kNumHyperparameters; ++i) {
+    strings::StrAppend(&key, ";", node.input(i));
+  }
+  return key;
+}
+
+}  // namespace
+
+Status TrainingOpFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                  GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  FrameMap frames;
+  int num_frames;
+  TF_RETURN_IF_ERROR(IdentifyFrames(*optimized_graph, &frames, &num_frames));
+
+  std::vector<NodeDef*> candidates;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (!IsFusibleAdam(node) || nodes_to_preserve.count(node.name()) > 0) {
+      continue;
+    }
+    // Fusing updates across loop iterations would change their semantics.
+    auto it = frames.find(&node);
+    if (it != frames.end() && !it->second.empty()) continue;
+    candidates.push_back(&node);
+  }
+  if (candidates.size() < 2) {
+    return Status::OK();
+  }
+
+  // An update that depends on another update can't be fused with it without
+  // creating a cycle, so only the updates that don't depend on any other are
+  // fused.
+  NodeMap node_map(optimized_graph);
+  std::unordered_set<const NodeDef*> downstream;
+  std::deque<const NodeDef*> queue;
+  for (const NodeDef* node : candidates) {
+    for (const NodeDef* output : node_map.GetOutputs(node->name())) {
+      queue.push_back(output);
+    }
+  }
+  while (!queue.empty()) {
+    const NodeDef* node = queue.front();
+    queue.pop_front();
+    if (!downstream.insert(node).second) continue;
+    for (const NodeDef* output : node_map.GetOutputs(node->name())) {
+      queue.push_back(output);
+    }
+  }
+
+  // Updates of the same variable are left alone, as their relative order
+  // would be lost in a fused update.
+  std::map<string, std::vector<NodeDef*>> groups;
+  std::unordered_set<string> updated_vars;
+  for (NodeDef* node : candidates) {
+    if (downstream.count(node) == 0 &&
+        updated_vars.insert(node->input(0)).second) {
+      groups[FusionKey(*node)].push_back(node);
+    }
+  }
+
+  for (const auto& group : groups) {
+    const std::vector<NodeDef*>& updates = group.second;
+    if (updates.size() < 2) continue;
+    const NodeDef& first = *updates.front();
+
+    string fused_name = strings::StrCat(first.name(), "/AdamN");
+    for (int i = 1; node_map.NodeExists(fused_name); ++i) {
+      fused_name = strings::StrCat(first.name(), "/AdamN_", i);
+    }
+    NodeDef* fused = optimized_graph->add_node();
+    fused->set_name(fused_name);
+    fused->set_op("ResourceApplyAdamN");
+    fused->set_device(first.device());
+    for (int input : {0, 1, 2}) {
+      for (const NodeDef* update : updates) {
+        fused->add_input(update->input(input));
+      }
+    }
+    for (int i = kFirstHyperparameter;
+         i < kFirstHyperparameter + kNumHyperparameters; ++i) {
+      fused->add_input(first.input(i));
+    }
+    for (const NodeDef* update : updates) {
+      fused->add_input(update->input(kNumAdamInputs - 1));
+    }
+    for (const NodeDef* update : updates) {
+      for (int i = kNumAdamInputs; i < update->input_size(); ++i) {
+        fused->add_input(update->input(i));
+      }
+    }
+    DedupControlInputs(fused);
+    auto* attr = fused->mutable_attr();
+    (*attr)["N"].set_i(updates.size());
+    (*attr)["T"] = first.attr().at("T");
+    (*attr)["use_locking"].set_b(GetBoolAttr(first, "use_locking"));
+    (*attr)["use_nesterov"].set_b(GetBoolAttr(first, "use_nesterov"));
+    node_map.AddNode(fused_name, fused);
+
+    // Keep the original nodes as no-ops that wait for the fused update, so
+    // that anything that depended on them is unaffected.
+    for (NodeDef* update : updates) {
+      update->set_op("NoOp");
+      update->clear_input();
+      update->add_input(AsControlDependency(fused_name));
+      update->clear_attr();
+    }
+  }
+  return Status::OK();
+}
+
+void TrainingOpFusion::Feedback(Cluster* cluster, const GrapplerItem& item,
+                                const GraphDef& optimized_graph,
+                                double result) {
+  // Nothing to do for TrainingOpFusion.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
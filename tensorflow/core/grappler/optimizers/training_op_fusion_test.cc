@@ -0,0 +1,181 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/training_op_fusion.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class TrainingOpFusionTest : public GrapplerTest {
+ protected:
+  void AddHyperparameters(const Scope& s) {
+    beta1_power_ = ops::Const(s.WithOpName("beta1_power"), 0.9f);
+    beta2_power_ = ops::Const(s.WithOpName("beta2_power"), 0.999f);
+    lr_ = ops::Const(s.WithOpName("lr"), 0.001f);
+    beta1_ = ops::Const(s.WithOpName("beta1"), 0.9f);
+    beta2_ = ops::Const(s.WithOpName("beta2"), 0.999f);
+    epsilon_ = ops::Const(s.WithOpName("epsilon"), 1e-8f);
+  }
+
+  // Adds the Adam slots of the variable var named name and an update of it.
+  ops::ResourceApplyAdam AddAdamUpdate(const Scope& s, const string& name,
+                                       Output var, Output lr, Output grad) {
+    Output m = ops::VarHandleOp(s.WithOpName(name + "/m"), DT_FLOAT, {4});
+    Output v = ops::VarHandleOp(s.WithOpName(name + "/v"), DT_FLOAT, {4});
+    return ops::ResourceApplyAdam(s.WithOpName(name + "/update"), var, m, v,
+                                  beta1_power_, beta2_power_, lr, beta1_,
+                                  beta2_, epsilon_, grad);
+  }
+
+  ops::ResourceApplyAdam AddAdamUpdate(const Scope& s, const string& name,
+                                       Output lr, Output grad) {
+    Output var = ops::VarHandleOp(s.WithOpName(name), DT_FLOAT, {4});
+    return AddAdamUpdate(s, name, var, lr, grad);
+  }
+
+  Output beta1_power_;
+  Output beta2_power_;
+  Output lr_;
+  Output beta1_;
+  Output beta2_;
+  Output epsilon_;
+};
+
+TEST_F(TrainingOpFusionTest, FuseAdamUpdates) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  AddHyperparameters(s);
+  Output grad = ops::Const(s.WithOpName("grad"), 1.0f, {4});
+  auto a = AddAdamUpdate(s, "a", lr_, grad);
+  auto b = AddAdamUpdate(s, "b", lr_, grad);
+  auto c = AddAdamUpdate(s, "c", lr_, grad);
+  ops::NoOp train(s.WithOpName("train").WithControlDependencies(
+      {a.operation, b.operation, c.operation}));
+
+  GrapplerItem item;
+  item.fetch = {"train"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  TrainingOpFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(0, CountOpNodes(output, "ResourceApplyAdam"));
+  EXPECT_EQ(1, CountOpNodes(output, "ResourceApplyAdamN"));
+  NodeMap node_map(&output);
+  const NodeDef* fused = node_map.GetNode("a/update/AdamN");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ(3, fused->attr().at("N").i());
+  EXPECT_EQ(DT_FLOAT, fused->attr().at("T").type());
+  ASSERT_EQ(18, fused->input_size());
+  EXPECT_EQ("a", fused->input(0));
+  EXPECT_EQ("b", fused->input(1));
+  EXPECT_EQ("c", fused->input(2));
+  EXPECT_EQ("a/m", fused->input(3));
+  EXPECT_EQ("c/v", fused->input(8));
+  EXPECT_EQ("beta1_power", fused->input(9));
+  EXPECT_EQ("epsilon", fused->input(14));
+  EXPECT_EQ("grad", fused->input(15));
+  EXPECT_EQ("grad", fused->input(17));
+
+  for (const string& name : {"a/update", "b/update", "c/update"}) {
+    const NodeDef* node = node_map.GetNode(name);
+    ASSERT_NE(nullptr, node);
+    EXPECT_EQ("NoOp", node->op());
+    ASSERT_EQ(1, node->input_size());
+    EXPECT_EQ("^a/update/AdamN", node->input(0));
+  }
+}
+
+TEST_F(TrainingOpFusionTest, DifferentHyperparametersNotFused) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  AddHyperparameters(s);
+  Output other_lr = ops::Const(s.WithOpName("other_lr"), 0.01f);
+  Output grad = ops::Const(s.WithOpName("grad"), 1.0f, {4});
+  auto a = AddAdamUpdate(s, "a", lr_, grad);
+  auto b = AddAdamUpdate(s, "b", other_lr, grad);
+  ops::NoOp train(s.WithOpName("train").WithControlDependencies(
+      {a.operation, b.operation}));
+
+  GrapplerItem item;
+  item.fetch = {"train"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  TrainingOpFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(2, CountOpNodes(output, "ResourceApplyAdam"));
+  EXPECT_EQ(0, CountOpNodes(output, "ResourceApplyAdamN"));
+}
+
+TEST_F(TrainingOpFusionTest, DependentUpdatesNotFused) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  AddHyperparameters(s);
+  Output grad = ops::Const(s.WithOpName("grad"), 1.0f, {4});
+  Output a_var = ops::VarHandleOp(s.WithOpName("a"), DT_FLOAT, {4});
+  auto a = AddAdamUpdate(s, "a", a_var, lr_, grad);
+  auto b = AddAdamUpdate(s, "b", lr_, grad);
+  // c reads a after it is updated, so fusing the two would form a cycle.
+  Output a_read = ops::ReadVariableOp(
+      s.WithOpName("a/read").WithControlDependencies(a.operation), a_var,
+      DT_FLOAT);
+  auto c = AddAdamUpdate(s, "c", lr_, a_read);
+  ops::NoOp train(s.WithOpName("train").WithControlDependencies(
+      {a.operation, b.operation, c.operation}));
+
+  GrapplerItem item;
+  item.fetch = {"train"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  TrainingOpFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(1, CountOpNodes(output, "ResourceApplyAdamN"));
+  NodeMap node_map(&output);
+  EXPECT_EQ("ResourceApplyAdam", node_map.GetNode("c/update")->op());
+  const NodeDef* fused = node_map.GetNode("a/update/AdamN");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ(2, fused->attr().at("N").i());
+}
+
+TEST_F(TrainingOpFusionTest, PreservedUpdatesNotFused) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  AddHyperparameters(s);
+  Output grad = ops::Const(s.WithOpName("grad"), 1.0f, {4});
+  AddAdamUpdate(s, "a", lr_, grad);
+  AddAdamUpdate(s, "b", lr_, grad);
+
+  GrapplerItem item;
+  item.fetch = {"a/update", "b/update"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  TrainingOpFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(2, CountOpNodes(output, "ResourceApplyAdam"));
+  EXPECT_EQ(0, CountOpNodes(output, "ResourceApplyAdamN"));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
@@ -203,12 +204,40 @@ Status Split(OpKernelContext* context, const Tensor& input,
   return SplitCPU<T>(context, input, sizes, outputs);
 }
 
+// Copies 'input' into 'output', a new tensor whose dimension 1 has size
+// 'length' (>= that of 'input'), zero-filling the extra entries.
+template <typename T>
+Status PadSequenceDim(OpKernelContext* context, const Tensor& input,
+                      int64 length, Tensor* output) {
+  TensorShape output_shape = input.shape();
+  output_shape.set_dim(1, length);
+  TF_RETURN_IF_ERROR(
+      context->allocate_temp(input.dtype(), output_shape, output));
+  int64 suffix_dim_size = 1;
+  for (int i = 2; i < input.shape().dims(); ++i) {
+    suffix_dim_size *= input.shape().dim_size(i);
+  }
+  const int64 rows = input.shape().dim_size(0);
+  const int64 input_length = input.shape().dim_size(1);
+  auto output_shaped = output->shaped<T, 3>({rows, length, suffix_dim_size});
+  output_shaped.setConstant(T());
+  if (input.NumElements() > 0) {
+    Eigen::DSizes<Eigen::DenseIndex, 3> offsets{0, 0, 0};
+    Eigen::DSizes<Eigen::DenseIndex, 3> extents{rows, input_length,
+                                                suffix_dim_size};
+    output_shaped.slice(offsets, extents) =
+        input.shaped<T, 3>({rows, input_length, suffix_dim_size});
+  }
+  return Status::OK();
+}
+
 // A class encapsulating the state and logic for batching tensors.
 class BatchResource : public ResourceBase {
  public:
   static Status Create(int32 num_batch_threads, int32 max_batch_size,
                        int32 batch_timeout_micros, int32 max_enqueued_batches,
                        const std::vector<int32>& allowed_batch_sizes,
+                       const std::vector<int32>& bucket_boundaries,
                        std::unique_ptr<BatchResource>* resource) {
     std::unique_ptr<BatchResource> new_resource(new BatchResource);
 
@@ -224,6 +253,7 @@ class BatchResource : public ResourceBase {
         batch_timeout_micros;
 
     new_resource->allowed_batch_sizes_ = allowed_batch_sizes;
+    new_resource->bucket_boundaries_ = bucket_boundaries;
 
     *resource = std::move(new_resource);
     return Status::OK();
@@ -252,14 +282,36 @@ class BatchResource : public ResourceBase {
             "Batching input tensors supplied in a given op invocation must "
             "have equal 0th-dimension size");
       }
+      if (!bucket_boundaries_.empty()) {
+        if (tensor.shape().dims() < 2) {
+          return errors::InvalidArgument(
+              "Bucketed batching input tensors must have at least two "
+              "dimensions");
+        }
+        if (tensor.shape().dim_size(1) != tensors[0].shape().dim_size(1)) {
+          return errors::InvalidArgument(
+              "Bucketed batching input tensors supplied in a given op "
+              "invocation must have equal 1st-dimension size");
+        }
+      }
       batch_components->inputs.push_back(tensor);
     }
     batch_components->context = context;
     batch_components->done_callback = std::move(done_callback);
 
+    // Each bucket gets its own queue, so that only invocations of similar
+    // sequence lengths end up in the same batch.
+    string queue_name = batcher_queue_name;
+    if (!bucket_boundaries_.empty()) {
+      const int64 length = batch_components->inputs[0].shape().dim_size(1);
+      const int bucket =
+          std::lower_bound(bucket_boundaries_.begin(),
+                           bucket_boundaries_.end(), length) -
+          bucket_boundaries_.begin();
+      strings::StrAppend(&queue_name, "/bucket_", bucket);
+    }
     BatcherQueue* batcher_queue;
-    TF_RETURN_IF_ERROR(
-        LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+    TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(queue_name, &batcher_queue));
     return batcher_queue->Schedule(&batch_components);
   }
 
@@ -314,6 +366,23 @@ class BatchResource : public ResourceBase {
     return batch_size;
   }
 
+  // Returns the sequence length to which the inputs of 'batch' are padded:
+  // the boundary of their bucket, or for the last bucket the longest length
+  // in the batch. Returns -1 if bucketing is disabled.
+  int64 PaddedSequenceLength(const Batch& batch) const {
+    if (bucket_boundaries_.empty()) {
+      return -1;
+    }
+    int64 max_length = 0;
+    for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
+      max_length = std::max(max_length,
+                            batch.task(task_idx).inputs[0].shape().dim_size(1));
+    }
+    auto it = std::lower_bound(bucket_boundaries_.begin(),
+                               bucket_boundaries_.end(), max_length);
+    return it == bucket_boundaries_.end() ? max_length : *it;
+  }
+
   // Processes a batch of one or more BatchTask entries.
   void ProcessBatch(std::unique_ptr<Batch> batch) const {
     if (batch->empty()) {
@@ -332,6 +401,7 @@ class BatchResource : public ResourceBase {
 
     // All tasks should have the same number of input edges.
     const int num_input_edges = batch->task(0).inputs.size();
+    const int64 padded_sequence_length = PaddedSequenceLength(*batch);
 
     // Process each input edge one at a time (the typical case has just one).
     for (int i = 0; i < num_input_edges; ++i) {
@@ -340,6 +410,9 @@ class BatchResource : public ResourceBase {
         const BatchTask& task = batch->task(task_idx);
         TensorShape output_shape(task.inputs.at(i).shape());
         output_shape.set_dim(0, 0);
+        if (padded_sequence_length >= 0) {
+          output_shape.set_dim(1, padded_sequence_length);
+        }
         Tensor* output = nullptr;
         OP_REQUIRES_OK_ASYNC(
             task.context,
@@ -351,13 +424,36 @@ class BatchResource : public ResourceBase {
       std::vector<Tensor> to_concatenate;
       to_concatenate.reserve(batch->num_tasks());
       for (int task_idx = 0; task_idx < batch->num_tasks(); ++task_idx) {
-        to_concatenate.push_back(batch->task(task_idx).inputs.at(i));
+        const Tensor& input = batch->task(task_idx).inputs.at(i);
+        if (padded_sequence_length < 0 ||
+            input.shape().dim_size(1) == padded_sequence_length) {
+          to_concatenate.push_back(input);
+          continue;
+        }
+        Tensor padded;
+        Status pad_status;
+        switch (input.dtype()) {
+#define CASE(type)                                                     \
+  case DataTypeToEnum<type>::value:                                    \
+    pad_status = PadSequenceDim<type>(last_task_context, input,        \
+                                      padded_sequence_length, &padded); \
+    break;
+          TF_CALL_ALL_TYPES(CASE);
+#undef CASE
+          default:
+            pad_status = errors::InvalidArgument("Unsupported data type: ",
+                                                 input.dtype());
+            break;
+        }
+        OP_REQUIRES_OK_ASYNC(last_task_context, pad_status,
+                             last_task_callback);
+        to_concatenate.push_back(padded);
       }
 
       // Add padding as needed. Use the first row of the first task's tensor as
       // the data for padding.
       if (padding_amount > 0) {
-        const Tensor& padding_source = batch->task(0).inputs.at(i);
+        const Tensor& padding_source = to_concatenate[0];
         Tensor padding;
         if (padding_source.shape().dim_size(0) == 1) {
           padding = padding_source;
@@ -498,6 +594,8 @@ class BatchResource : public ResourceBase {
       GUARDED_BY(batcher_queues_mu_);
 
   std::vector<int32> allowed_batch_sizes_;
+  // Sequence length bucket boundaries; empty if bucketing is disabled.
+  std::vector<int32> bucket_boundaries_;
 };
 
 class BatchKernel : public AsyncOpKernel {
@@ -519,6 +617,8 @@ class BatchKernel : public AsyncOpKernel {
                    c->GetAttr("max_enqueued_batches", &max_enqueued_batches_));
     OP_REQUIRES_OK(c, c->GetAttr("allowed_batch_sizes", &allowed_batch_sizes_));
     OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
+    OP_REQUIRES_OK(c, c->GetAttr("bucket_boundaries", &bucket_boundaries_));
+    OP_REQUIRES_OK(c, ValidateBucketBoundaries());
   }
 
   void ComputeAsync(OpKernelContext* c, DoneCallback done) final {
@@ -528,7 +628,8 @@ class BatchKernel : public AsyncOpKernel {
           std::unique_ptr<BatchResource> new_resource;
           TF_RETURN_IF_ERROR(BatchResource::Create(
               num_batch_threads_, max_batch_size_, batch_timeout_micros_,
-              max_enqueued_batches_, allowed_batch_sizes_, &new_resource));
+              max_enqueued_batches_, allowed_batch_sizes_, bucket_boundaries_,
+              &new_resource));
           *r = new_resource.release();
           return Status::OK();
         };
@@ -567,6 +668,22 @@ class BatchKernel : public AsyncOpKernel {
     return Status::OK();
   }
 
+  // Validates 'bucket_boundaries_'. The entries must be positive and increase
+  // monotonically.
+  Status ValidateBucketBoundaries() const {
+    for (size_t i = 0; i < bucket_boundaries_.size(); ++i) {
+      if (bucket_boundaries_[i] <= 0) {
+        return errors::InvalidArgument(
+            "bucket_boundaries entries must be positive");
+      }
+      if (i > 0 && bucket_boundaries_[i] <= bucket_boundaries_[i - 1]) {
+        return errors::InvalidArgument(
+            "bucket_boundaries entries must be monotonically increasing");
+      }
+    }
+    return Status::OK();
+  }
+
  private:
   string container_;
   string shared_name_;
@@ -576,6 +693,7 @@ class BatchKernel : public AsyncOpKernel {
   int32 batch_timeout_micros_;
   int32 max_enqueued_batches_;
   std::vector<int32> allowed_batch_sizes_;
+  std::vector<int32> bucket_boundaries_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("Batch").Device(DEVICE_CPU), BatchKernel);
@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_ADAPTIVE_SHARED_BATCH_SCHEDULER_H_
 
 #include <algorithm>
+#include <atomic>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <random>
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
@@ -42,6 +45,103 @@ class ASBSBatch;
 
 template <typename TaskType>
 class ASBSQueue;
+
+// Estimates the 99th percentile processing latency of the batches of a queue
+// as a function of batch size, from the most recent batches of similar size,
+// and plans the batch size and timeout that fit a latency SLO.
+class ASBSLatencyModel {
+ public:
+  ASBSLatencyModel(int max_batch_size, int64 latency_slo_micros)
+      : max_batch_size_(max_batch_size),
+        latency_slo_micros_(latency_slo_micros),
+        samples_(SizeClass(max_batch_size) + 1) {}
+
+  // Records that a batch of 'batch_size' took 'latency_micros' to process.
+  void RecordLatency(int batch_size, int64 latency_micros) {
+    std::deque<int64>* samples = &samples_[SizeClass(batch_size)];
+    samples->push_back(latency_micros);
+    if (samples->size() > kMaxSamples) samples->pop_front();
+  }
+
+  // Picks the largest batch size whose latency estimate E leaves as much time
+  // again within the SLO, so that the batch may also wait for another one of
+  // its size to finish processing: the timeout is then SLO - 2 * E. Before
+  // any latency is known, full batches are tried with half of the SLO as the
+  // timeout.
+  void Plan(int* target_batch_size, int64* batch_timeout_micros) const {
+    int best_size = 0;
+    int64 best_estimate = 0;
+    bool any_estimate = false;
+    for (int c = 0; c < samples_.size(); ++c) {
+      const int64 estimate = Estimate(c);
+      if (estimate < 0) continue;
+      any_estimate = true;
+      if (2 * estimate <= latency_slo_micros_) {
+        best_size = ClassLimit(c);
+        best_estimate = estimate;
+      }
+    }
+    if (!any_estimate) {
+      *target_batch_size = max_batch_size_;
+      *batch_timeout_micros = latency_slo_micros_ / 2;
+    } else if (best_size == 0) {
+      // Even the smallest batches are too slow: don't wait at all.
+      *target_batch_size = 1;
+      *batch_timeout_micros = 0;
+    } else {
+      *target_batch_size = best_size;
+      *batch_timeout_micros = latency_slo_micros_ - 2 * best_estimate;
+    }
+  }
+
+ private:
+  // Number of latencies kept per size class.
+  static constexpr int kMaxSamples = 100;
+  // Number of latencies needed for a size class to have its own estimate.
+  static constexpr int kMinSamples = 10;
+
+  // Size class c holds batch sizes in (2^(c-1), 2^c].
+  static int SizeClass(int batch_size) {
+    int c = 0;
+    while ((1 << c) < batch_size) ++c;
+    return c;
+  }
+
+  int ClassLimit(int c) const { return std::min(1 << c, max_batch_size_); }
+
+  // Returns the 99th percentile latency of size class c, or -1 if it has too
+  // few samples.
+  int64 Percentile99(int c) const {
+    const std::deque<int64>& samples = samples_[c];
+    if (samples.size() < kMinSamples) return -1;
+    std::vector<int64> sorted(samples.begin(), samples.end());
+    const size_t index = (sorted.size() * 99 + 99) / 100 - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+  }
+
+  // Returns the latency estimate of size class c: its own if it has enough
+  // samples, else that of the nearest larger class (an upper bound), else a
+  // linear extrapolation from the nearest smaller class. Returns -1 if there
+  // are no estimates at all.
+  int64 Estimate(int c) const {
+    const int64 own = Percentile99(c);
+    if (own >= 0) return own;
+    for (int d = c + 1; d < samples_.size(); ++d) {
+      const int64 larger = Percentile99(d);
+      if (larger >= 0) return larger;
+    }
+    for (int b = c - 1; b >= 0; --b) {
+      const int64 smaller = Percentile99(b);
+      if (smaller >= 0) return smaller * ClassLimit(c) / ClassLimit(b);
+    }
+    return -1;
+  }
+
+  const int max_batch_size_;
+  const int64 latency_slo_micros_;
+  std::vector<std::deque<int64>> samples_;
+};
 }  // namespace internal
 
 // Shared batch scheduler designed to minimize latency. The scheduler keeps
@@ -69,6 +169,14 @@ class ASBSQueue;
 // CPU utilization - If the batch processing is cpu dominated, you can reap
 //   latency gains when underutilized by increasing the processing rate, but
 //   back the rate off when the load increases to avoid overload.
+//
+// A queue may instead declare a latency SLO (QueueOptions::latency_slo_micros)
+// when its batches should be as large as the latency target allows. The
+// scheduler then learns the queue's processing latency as a function of batch
+// size, and holds each of its batches back until it reaches the largest size
+// whose estimated 99th percentile latency fits the SLO, or until a timeout
+// after which the SLO could no longer be met. Among batches that are ready,
+// those of SLO queues are ordered by that deadline.
 
 template <typename TaskType>
 class AdaptiveSharedBatchScheduler
@@ -76,6 +184,7 @@ class AdaptiveSharedBatchScheduler
           AdaptiveSharedBatchScheduler<TaskType>> {
  public:
   ~AdaptiveSharedBatchScheduler() {
+    slo_check_thread_.reset();
     // Finish processing batches before destroying other class members.
     batch_thread_pool_.reset();
   }
@@ -112,6 +221,9 @@ class AdaptiveSharedBatchScheduler
     // numbers will give less noisy latency measurements, but will be less
     // responsive to changes in workload.
     int64 batches_to_average_over = 1000;
+    // How often batches held back by queues with a latency_slo_micros are
+    // rechecked for their timeout.
+    int64 slo_check_interval_micros = 1000;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -125,6 +237,12 @@ class AdaptiveSharedBatchScheduler
     int max_batch_size = 1000;
     // Maximum number of enqueued (i.e. non-scheduled) batches.
     int max_enqueued_batches = 10;
+    // If positive, the target 99th percentile latency, from the creation of a
+    // batch to the end of its processing. Instead of being eligible for
+    // processing as soon as it is created, a batch is then held back until
+    // it reaches the target batch size or the batch timeout, both picked
+    // from the latencies of the batches of this queue processed so far.
+    int64 latency_slo_micros = 0;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -149,8 +267,9 @@ class AdaptiveSharedBatchScheduler
   void CallbackWrapper(const internal::ASBSBatch<TaskType>* batch,
                        BatchProcessor callback);
 
-  // Schedules batch if in_flight_batches_limit_ is not met.
-  void MaybeScheduleNextBatch() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Schedules batch if in_flight_batches_limit_ is not met. Returns true if a
+  // batch was scheduled.
+  bool MaybeScheduleNextBatch() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Notifies scheduler of non-empty batch which is eligible for processing.
   void AddBatch(const internal::ASBSBatch<TaskType>* batch);
@@ -170,8 +289,17 @@ class AdaptiveSharedBatchScheduler
   std::unordered_map<const internal::ASBSQueue<TaskType>*, BatchProcessor>
       queues_and_callbacks_ GUARDED_BY(mu_);
 
+  // Processing latency models of the queues with a latency SLO.
+  std::unordered_map<const internal::ASBSQueue<TaskType>*,
+                     std::unique_ptr<internal::ASBSLatencyModel>>
+      latency_models_ GUARDED_BY(mu_);
+
   mutex mu_;
 
+  // Schedules batches of SLO queues that reach their timeout. Started with the
+  // first such queue.
+  std::unique_ptr<PeriodicFunction> slo_check_thread_;
+
   // Responsible for running the batch processing callbacks.
   std::unique_ptr<thread::ThreadPool> batch_thread_pool_;
 
@@ -242,9 +370,27 @@ class ASBSQueue : public BatchScheduler<TaskType> {
 
   size_t max_task_size() const override { return options_.max_batch_size; }
 
+  int64 latency_slo_micros() const { return options_.latency_slo_micros; }
+
+  // Latency SLO queues only: returns true if 'batch' should be processed by
+  // 'now_micros', i.e. if it is closed, has reached the target batch size or
+  // is at least as old as the batch timeout.
+  bool IsReady(const ASBSBatch<TaskType>& batch, int64 now_micros) const;
+
+  // Latency SLO queues only: returns the time by which 'batch' should start
+  // processing.
+  int64 StartDeadline(const ASBSBatch<TaskType>& batch) const;
+
+  // Latency SLO queues only: sets the targets that IsReady() checks.
+  void SetBatchTargets(int target_batch_size, int64 batch_timeout_micros);
+
  private:
   std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler_;
   const QueueOptions options_;
+  // Latency SLO queues only: batches are closed when they reach
+  // target_batch_size_, and ready after batch_timeout_micros_.
+  std::atomic<int> target_batch_size_;
+  std::atomic<int64> batch_timeout_micros_;
   // Owned by scheduler_.
   ASBSBatch<TaskType>* current_batch_ GUARDED_BY(mu_) = nullptr;
   int64 num_enqueued_batches_ GUARDED_BY(mu_) = 0;
@@ -324,6 +470,11 @@ Status AdaptiveSharedBatchScheduler<TaskType>::Create(
         "greater than or equal to 1; was ",
         options.batches_to_average_over);
   }
+  if (options.slo_check_interval_micros < 1) {
+    return errors::InvalidArgument(
+        "slo_check_interval_micros must be positive; was ",
+        options.slo_check_interval_micros);
+  }
   scheduler->reset(new AdaptiveSharedBatchScheduler<TaskType>(options));
   return Status::OK();
 }
@@ -353,11 +504,39 @@ Status AdaptiveSharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.latency_slo_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_slo_micros can't be negative; was ",
+        options.latency_slo_micros);
+  }
   internal::ASBSQueue<TaskType>* asbs_queue_raw;
   queue->reset(asbs_queue_raw = new internal::ASBSQueue<TaskType>(
                    this->shared_from_this(), options));
   mutex_lock l(mu_);
   queues_and_callbacks_[asbs_queue_raw] = process_batch_callback;
+  if (options.latency_slo_micros > 0) {
+    std::unique_ptr<internal::ASBSLatencyModel> model(
+        new internal::ASBSLatencyModel(options.max_batch_size,
+                                       options.latency_slo_micros));
+    int target_batch_size;
+    int64 batch_timeout_micros;
+    model->Plan(&target_batch_size, &batch_timeout_micros);
+    asbs_queue_raw->SetBatchTargets(target_batch_size, batch_timeout_micros);
+    latency_models_[asbs_queue_raw] = std::move(model);
+    if (slo_check_thread_ == nullptr) {
+      PeriodicFunction::Options periodic_fn_options;
+      periodic_fn_options.thread_name_prefix =
+          strings::StrCat(options_.thread_pool_name, "_slo_check");
+      periodic_fn_options.env = GetEnv();
+      slo_check_thread_.reset(new PeriodicFunction(
+          [this] {
+            mutex_lock l(mu_);
+            while (MaybeScheduleNextBatch()) {
+            }
+          },
+          options_.slo_check_interval_micros, periodic_fn_options));
+    }
+  }
   return Status::OK();
 }
 
@@ -374,33 +553,40 @@ void AdaptiveSharedBatchScheduler<TaskType>::RemoveQueue(
     const internal::ASBSQueue<TaskType>* queue) {
   mutex_lock l(mu_);
   queues_and_callbacks_.erase(queue);
+  latency_models_.erase(queue);
 }
 
 template <typename TaskType>
-void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
+bool AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
   if (batches_.empty() || in_flight_batches_ >= in_flight_batches_limit_)
-    return;
+    return false;
   // Non-integer limit handled probabilistially.
   if (in_flight_batches_limit_ - in_flight_batches_ < 1 &&
       rand_double_(rand_engine_) >
           in_flight_batches_limit_ - in_flight_batches_) {
-    return;
+    return false;
   }
-  auto best_it = batches_.begin();
-  double best_score =
-      (*best_it)->creation_time_micros() -
-      options_.full_batch_scheduling_boost_micros * (*best_it)->size() /
-          static_cast<double>((*best_it)->queue()->max_task_size());
-  for (auto it = batches_.begin() + 1; it != batches_.end(); it++) {
-    const double score =
-        (*it)->creation_time_micros() -
-        options_.full_batch_scheduling_boost_micros * (*it)->size() /
-            static_cast<double>((*it)->queue()->max_task_size());
-    if (score < best_score) {
+  const int64 now_micros =
+      latency_models_.empty() ? 0 : GetEnv()->NowMicros();
+  auto best_it = batches_.end();
+  double best_score = 0;
+  for (auto it = batches_.begin(); it != batches_.end(); it++) {
+    const internal::ASBSQueue<TaskType>* queue = (*it)->queue();
+    double score;
+    if (queue->latency_slo_micros() > 0) {
+      if (!queue->IsReady(**it, now_micros)) continue;
+      score = queue->StartDeadline(**it);
+    } else {
+      score = (*it)->creation_time_micros() -
+              options_.full_batch_scheduling_boost_micros * (*it)->size() /
+                  static_cast<double>(queue->max_task_size());
+    }
+    if (best_it == batches_.end() || score < best_score) {
       best_score = score;
       best_it = it;
     }
   }
+  if (best_it == batches_.end()) return false;
   const internal::ASBSBatch<TaskType>* batch = *best_it;
   batches_.erase(best_it);
   // Queue may destroy itself after ReleaseBatch is called.
@@ -409,6 +595,7 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
       std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper, this,
                 batch, queues_and_callbacks_[batch->queue()]));
   in_flight_batches_++;
+  return true;
 }
 
 template <typename TaskType>
@@ -416,11 +603,25 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
     const internal::ASBSBatch<TaskType>* batch,
     AdaptiveSharedBatchScheduler<TaskType>::BatchProcessor callback) {
   int64 start_time = batch->creation_time_micros();
+  // The batch is gone after the callback, and the queue may be too unless it
+  // is still registered.
+  internal::ASBSQueue<TaskType>* queue = batch->queue();
+  const int batch_size = batch->size();
+  const int64 processing_start_time = GetEnv()->NowMicros();
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64 end_time = GetEnv()->NowMicros();
   mutex_lock l(mu_);
   in_flight_batches_--;
+  auto model_it = latency_models_.find(queue);
+  if (model_it != latency_models_.end()) {
+    model_it->second->RecordLatency(batch_size,
+                                    end_time - processing_start_time);
+    int target_batch_size;
+    int64 batch_timeout_micros;
+    model_it->second->Plan(&target_batch_size, &batch_timeout_micros);
+    queue->SetBatchTargets(target_batch_size, batch_timeout_micros);
+  }
   batch_count_++;
   batch_latency_sum_ += end_time - start_time;
   // Occasionally adjust in_flight_batches_limit_ to minimize average latency.
@@ -469,7 +670,10 @@ template <typename TaskType>
 ASBSQueue<TaskType>::ASBSQueue(
     std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler,
     const QueueOptions& options)
-    : scheduler_(scheduler), options_(options) {}
+    : scheduler_(scheduler),
+      options_(options),
+      target_batch_size_(options.max_batch_size),
+      batch_timeout_micros_(0) {}
 
 template <typename TaskType>
 ASBSQueue<TaskType>::~ASBSQueue() {
@@ -496,11 +700,14 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
                                    " is larger than maximum batch size ",
                                    options_.max_batch_size);
   }
+  // Batches of latency SLO queues are closed at their target size.
+  const int batch_size_limit = options_.latency_slo_micros > 0
+                                   ? target_batch_size_.load()
+                                   : options_.max_batch_size;
   {
     mutex_lock l(mu_);
     // Current batch is full, create another if allowed.
-    if (current_batch_ &&
-        current_batch_->size() + size > options_.max_batch_size) {
+    if (current_batch_ && current_batch_->size() + size > batch_size_limit) {
       if (num_enqueued_batches_ >= options_.max_enqueued_batches) {
         return errors::Unavailable("The batch scheduling queue is full");
       }
@@ -531,6 +738,26 @@ void ASBSQueue<TaskType>::ReleaseBatch(const ASBSBatch<TaskType>* batch) {
   }
 }
 
+template <typename TaskType>
+bool ASBSQueue<TaskType>::IsReady(const ASBSBatch<TaskType>& batch,
+                                  int64 now_micros) const {
+  return batch.IsClosed() || batch.size() >= target_batch_size_.load() ||
+         now_micros >= batch.creation_time_micros() + batch_timeout_micros_;
+}
+
+template <typename TaskType>
+int64 ASBSQueue<TaskType>::StartDeadline(
+    const ASBSBatch<TaskType>& batch) const {
+  return batch.creation_time_micros() + batch_timeout_micros_;
+}
+
+template <typename TaskType>
+void ASBSQueue<TaskType>::SetBatchTargets(int target_batch_size,
+                                          int64 batch_timeout_micros) {
+  target_batch_size_ = target_batch_size;
+  batch_timeout_micros_ = batch_timeout_micros;
+}
+
 template <typename TaskType>
 size_t ASBSQueue<TaskType>::NumEnqueuedTasks() const {
   mutex_lock l(mu_);
@@ -92,6 +92,20 @@ TEST(AdaptiveSharedBatchSchedulerTest, BadOptions) {
   options.min_in_flight_batches_limit = 2;
   options.num_batch_threads = 3;
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.slo_check_interval_micros = 0;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.num_batch_threads = 3;
+  TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+  Scheduler::QueueOptions queue_options;
+  queue_options.latency_slo_micros = -1;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_FALSE(
+      scheduler
+          ->AddQueue(queue_options,
+                     [](std::unique_ptr<Batch<FakeTask>> batch) {}, &queue)
+          .ok());
 }
 
 TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimit) {
@@ -381,6 +395,101 @@ TEST(AdaptiveSharedBatchSchedulerTest, QueueCapacityInfo) {
   EXPECT_EQ(queue->SchedulingCapacity(), 8 * 1000 + 300);
   finish_processing.Notify();
 }
+
+TEST(AdaptiveSharedBatchSchedulerTest, LatencyModelPlan) {
+  internal::ASBSLatencyModel model(64, 10000);
+  int target_batch_size;
+  int64 batch_timeout_micros;
+  // No latencies yet: try full batches.
+  model.Plan(&target_batch_size, &batch_timeout_micros);
+  EXPECT_EQ(64, target_batch_size);
+  EXPECT_EQ(5000, batch_timeout_micros);
+  // Too few samples to estimate anything.
+  for (int i = 0; i < 9; i++) {
+    model.RecordLatency(16, 1600);
+  }
+  model.Plan(&target_batch_size, &batch_timeout_micros);
+  EXPECT_EQ(64, target_batch_size);
+  // Batches of 16 take 1600us, extrapolated to 3200us for batches of 32 and
+  // 6400us for batches of 64, which doesn't leave room for a second batch.
+  model.RecordLatency(16, 1600);
+  model.Plan(&target_batch_size, &batch_timeout_micros);
+  EXPECT_EQ(32, target_batch_size);
+  EXPECT_EQ(10000 - 2 * 3200, batch_timeout_micros);
+  // Measured latencies replace extrapolated ones.
+  for (int i = 0; i < 10; i++) {
+    model.RecordLatency(64, 4000);
+  }
+  model.Plan(&target_batch_size, &batch_timeout_micros);
+  EXPECT_EQ(64, target_batch_size);
+  EXPECT_EQ(10000 - 2 * 4000, batch_timeout_micros);
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, LatencyModelPlanTooSlow) {
+  internal::ASBSLatencyModel model(8, 1000);
+  for (int i = 0; i < 10; i++) {
+    model.RecordLatency(1, 600);
+  }
+  int target_batch_size;
+  int64 batch_timeout_micros;
+  model.Plan(&target_batch_size, &batch_timeout_micros);
+  EXPECT_EQ(1, target_batch_size);
+  EXPECT_EQ(0, batch_timeout_micros);
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, LatencySlo) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    AdaptiveSharedBatchScheduler<FakeTask>::Options options;
+    options.env = &env;
+    options.num_batch_threads = 2;
+    options.initial_in_flight_batches_limit = 2;
+    options.slo_check_interval_micros = 100;
+    mutex mu;
+    std::vector<int> batch_sizes;
+    auto queue_callback = [&mu,
+                           &batch_sizes](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      mutex_lock l(mu);
+      batch_sizes.push_back(batch->size());
+    };
+    auto num_processed = [&mu, &batch_sizes]() {
+      mutex_lock l(mu);
+      return batch_sizes.size();
+    };
+    std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(
+        AdaptiveSharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 100;
+    queue_options.latency_slo_micros = 10000;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+
+    // A batch at the target size is scheduled right away.
+    TF_ASSERT_OK(ScheduleTask(100, queue.get()));
+    while (num_processed() < 1) {
+    }
+    // A partial batch waits for more tasks until half of the SLO has passed.
+    TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(20, queue.get()));
+    Env::Default()->SleepForMicroseconds(10000);
+    EXPECT_EQ(1, num_processed());
+    env.AdvanceByMicroseconds(5000);
+    while (num_processed() < 2) {
+    }
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(100, batch_sizes[0]);
+      EXPECT_EQ(30, batch_sizes[1]);
+    }
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
@@ -87,6 +87,26 @@ class CollectiveReduceOpKernel : public CollectiveOpKernel {
                     "final_op must be one of {\"Id\", \"Div\"} but got ",
                     final_op_name));
     OP_REQUIRES_OK(c, c->GetAttr("T", &col_params_.instance.data_type));
+    string compression;
+    OP_REQUIRES_OK(c, c->GetAttr("compression", &compression));
+    if (compression == "fp16") {
+      col_params_.instance.compression = FP16_COMPRESSION;
+    } else if (compression == "top_k") {
+      col_params_.instance.compression = TOP_K_COMPRESSION;
+    }
+    OP_REQUIRES_OK(c, c->GetAttr("top_k_fraction",
+                                 &col_params_.instance.top_k_fraction));
+    OP_REQUIRES(c,
+                col_params_.instance.top_k_fraction > 0 &&
+                    col_params_.instance.top_k_fraction <= 1,
+                errors::InvalidArgument("top_k_fraction must be in (0, 1] "
+                                        "but got ",
+                                        col_params_.instance.top_k_fraction));
+    string implementation;
+    OP_REQUIRES_OK(c, c->GetAttr("implementation", &implementation));
+    if (implementation == "nccl") {
+      col_params_.instance.implementation = NCCL_IMPLEMENTATION;
+    }
 
     const NodeDef& real_node = c->def();
     col_params_.name = strings::StrCat(real_node.name(), ": Reduce(",
@@ -16,9 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_CONV_OPS_H_
 #define TENSORFLOW_KERNELS_CONV_OPS_H_
 
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 
 #if GOOGLE_CUDA
@@ -29,6 +34,7 @@ limitations under the License.
 namespace tensorflow {
 
 // Forward declaration.
+class OpKernelConstruction;
 class OpKernelContext;
 
 template <typename Device, typename T>
@@ -51,6 +57,49 @@ struct LaunchConv2DOp<Eigen::GpuDevice, T> {
 };
 #endif  // GOOGLE_CUDA
 
+// Convolution parameters specified by the attributes of a Conv2D op.
+struct Conv2DParameters {
+  std::vector<int32> dilations;
+  std::vector<int32> strides;
+  Padding padding;
+  TensorFormat data_format;
+};
+
+// Convolution dimensions inferred from the parameters, input and filter.
+struct Conv2DDimensions {
+  int batch;
+  int input_rows;
+  int input_cols;
+  int in_depth;
+
+  int filter_rows;
+  int filter_cols;
+  int patch_depth;
+  int out_depth;
+
+  int stride_rows;
+  int stride_cols;
+
+  int dilation_rows;
+  int dilation_cols;
+
+  int64 out_rows;
+  int64 out_cols;
+  int64 pad_rows;
+  int64 pad_cols;
+};
+
+// Reads and validates the "dilations", "strides", "padding" and
+// "data_format" attributes of a Conv2D-like op.
+Status InitConv2DParameters(const OpKernelConstruction* context,
+                            Conv2DParameters* params);
+
+// Computes the dimensions of the convolution of 'input' with 'filter', and
+// returns an error if they are not valid.
+Status ComputeConv2DDimension(const Conv2DParameters& params,
+                              const Tensor& input, const Tensor& filter,
+                              Conv2DDimensions* dimensions);
+
 // Used to keep track of persistent memory buffers used within the op.
 // It uses malloc and free to avoid the time cost of initializing the memory.
 template <class T, size_t size>
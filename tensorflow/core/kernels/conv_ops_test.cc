@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+
 #include "tensorflow/cc/ops/const_op.h"
 #include "tensorflow/cc/ops/image_ops.h"
 #include "tensorflow/cc/ops/nn_ops.h"
@@ -84,6 +86,23 @@ TEST(ConvParameters, WinogradNonfusedAlgoSize) {
       conv_params_large.ShouldIncludeWinogradNonfusedAlgoPreCudnn7<float>());
 }
 
+TEST(ConvParameters, AutotuneConfigRoundTrip) {
+  se::dnn::AlgorithmConfig config(se::dnn::AlgorithmDesc(7, true),
+                                  se::dnn::AlgorithmDesc(1, false));
+  const string serialized = AutotuneConfigToString(config);
+  se::dnn::AlgorithmConfig parsed;
+  ASSERT_TRUE(AutotuneConfigFromString(serialized, &parsed));
+  EXPECT_EQ(config, parsed);
+
+  // The default algorithm has a negative id.
+  ASSERT_TRUE(AutotuneConfigFromString(
+      AutotuneConfigToString(se::dnn::AlgorithmConfig()), &parsed));
+  EXPECT_EQ(se::dnn::AlgorithmConfig(), parsed);
+
+  EXPECT_FALSE(AutotuneConfigFromString("7:1", &parsed));
+  EXPECT_FALSE(AutotuneConfigFromString("7:x,1:0", &parsed));
+}
+
 #endif  // GOOGLE_CUDA
 
 class FusedResizePadConvOpTest : public OpsTestBase {
@@ -474,4 +493,85 @@ TEST_F(ConvOpTest, HandwrittenConv) { HandwrittenConv(); }
 
 TEST_F(ConvOpTest, AnisotropicStride) { AnisotropicStrides(); }
 
+class FusedConv2DOpTest : public OpsTestBase {
+ protected:
+  // Runs _FusedConv2D on an NHWC input and checks it against a direct
+  // evaluation of Conv2D + BiasAdd + 'activation' with unit strides.
+  void RunComparative(const string& activation, const string& padding) {
+    const int batch = 2, rows = 5, cols = 4, in_depth = 3;
+    const int filter_size = 3, out_depth = 2;
+    TF_ASSERT_OK(NodeDefBuilder("fused_conv", "_FusedConv2D")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("strides", {1, 1, 1, 1})
+                     .Attr("padding", padding)
+                     .Attr("activation", activation)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    AddInput<float>(TensorShape({batch, rows, cols, in_depth}),
+                    [](int i) { return (i % 11) - 5.0f; });
+    AddInput<float>(
+        TensorShape({filter_size, filter_size, in_depth, out_depth}),
+        [](int i) { return (i % 7) / 4.0f - 0.75f; });
+    AddInputFromArray<float>(TensorShape({out_depth}), {-2.0f, 3.0f});
+    TF_ASSERT_OK(RunOpKernel());
+
+    auto in = GetInput(0).tensor<float, 4>();
+    auto f = GetInput(1).tensor<float, 4>();
+    auto bias = GetInput(2).vec<float>();
+    const bool same = padding == "SAME";
+    const int pad = same ? filter_size / 2 : 0;
+    const int out_rows = same ? rows : rows - filter_size + 1;
+    const int out_cols = same ? cols : cols - filter_size + 1;
+    Tensor expected(DT_FLOAT, TensorShape({batch, out_rows, out_cols,
+                                           out_depth}));
+    auto out = expected.tensor<float, 4>();
+    for (int b = 0; b < batch; ++b) {
+      for (int r = 0; r < out_rows; ++r) {
+        for (int c = 0; c < out_cols; ++c) {
+          for (int o = 0; o < out_depth; ++o) {
+            float sum = bias(o);
+            for (int fr = 0; fr < filter_size; ++fr) {
+              for (int fc = 0; fc < filter_size; ++fc) {
+                const int ir = r + fr - pad, ic = c + fc - pad;
+                if (ir < 0 || ir >= rows || ic < 0 || ic >= cols) continue;
+                for (int i = 0; i < in_depth; ++i) {
+                  sum += in(b, ir, ic, i) * f(fr, fc, i, o);
+                }
+              }
+            }
+            if (activation != "Identity") sum = std::max(sum, 0.0f);
+            if (activation == "Relu6") sum = std::min(sum, 6.0f);
+            out(b, r, c, o) = sum;
+          }
+        }
+      }
+    }
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+  }
+};
+
+TEST_F(FusedConv2DOpTest, Identity) { RunComparative("Identity", "SAME"); }
+
+TEST_F(FusedConv2DOpTest, Relu) { RunComparative("Relu", "SAME"); }
+
+TEST_F(FusedConv2DOpTest, Relu6Valid) { RunComparative("Relu6", "VALID"); }
+
+TEST_F(FusedConv2DOpTest, BiasSizeMismatch) {
+  TF_ASSERT_OK(NodeDefBuilder("fused_conv", "_FusedConv2D")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("strides", {1, 1, 1, 1})
+                   .Attr("padding", "VALID")
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 1, 1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
 }  // namespace tensorflow
@@ -0,0 +1,193 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the kernels that dominate the step time of most models, over
+// the shapes and types that they commonly run with. They are meant to be run
+// together, to compare builds with different compilers or flags:
+//
+//   TEST_REPORT_FILE_PREFIX=/tmp/core_kernels_ \
+//     bazel run -c opt //tensorflow/core/kernels:core_kernels_benchmark_test \
+//     -- --benchmarks=all
+//
+// writes a BenchmarkEntries proto (see util/test_log.proto) per benchmark,
+// with the wall time per iteration and the bytes and items per second, which
+// can be compared against the entries of a baseline run.
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+// A name for Eigen::half that can be pasted into benchmark names.
+typedef Eigen::half half;
+
+template <typename T>
+Node* Random(Graph* g, const TensorShape& shape) {
+  Tensor data(DataTypeToEnum<T>::value, shape);
+  data.flat<T>().setRandom();
+  return test::graph::Constant(g, data);
+}
+
+// MatMul of [m, k] by [k, n] matrices.
+template <typename T>
+Graph* MatMul(int m, int k, int n) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(g, Random<T>(g, TensorShape({m, k})),
+                      Random<T>(g, TensorShape({k, n})), false, false);
+  return g;
+}
+
+#define BM_MATMUL(T, M, K, N)                                               \
+  void BM_MatMul_##T##_##M##_##K##_##N(int iters) {                         \
+    testing::ItemsProcessed(static_cast<int64>(iters) * M * K * N * 2);     \
+    test::Benchmark("cpu", MatMul<T>(M, K, N)).Run(iters);                  \
+  }                                                                         \
+  BENCHMARK(BM_MatMul_##T##_##M##_##K##_##N);
+
+BM_MATMUL(float, 1, 1024, 1024);
+BM_MATMUL(float, 32, 1024, 1024);
+BM_MATMUL(float, 256, 256, 256);
+BM_MATMUL(float, 1024, 1024, 1024);
+BM_MATMUL(double, 256, 256, 256);
+BM_MATMUL(half, 256, 256, 256);
+
+// Conv2D with "SAME" padding of an NHWC input by [f, f, c, out_c] filters.
+template <typename T>
+Graph* Conv2D(int batch, int size, int c, int f, int out_c) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* ret;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), "Conv2D")
+          .Input(Random<T>(g, TensorShape({batch, size, size, c})))
+          .Input(Random<T>(g, TensorShape({f, f, c, out_c})))
+          .Attr("T", DataTypeToEnum<T>::value)
+          .Attr("strides", {1, 1, 1, 1})
+          .Attr("padding", "SAME")
+          .Finalize(g, &ret));
+  return g;
+}
+
+#define BM_CONV2D(T, B, S, C, F, O)                                          \
+  void BM_Conv2D_##T##_##B##_##S##_##C##_##F##_##O(int iters) {              \
+    testing::ItemsProcessed(static_cast<int64>(iters) * B * S * S * C * F * \
+                            F * O * 2);                                      \
+    test::Benchmark("cpu", Conv2D<T>(B, S, C, F, O)).Run(iters);             \
+  }                                                                          \
+  BENCHMARK(BM_Conv2D_##T##_##B##_##S##_##C##_##F##_##O);
+
+BM_CONV2D(float, 32, 56, 64, 3, 64);
+BM_CONV2D(float, 32, 28, 128, 3, 128);
+BM_CONV2D(float, 32, 14, 256, 1, 1024);
+BM_CONV2D(float, 1, 224, 3, 7, 64);
+BM_CONV2D(half, 32, 28, 128, 3, 128);
+
+// Gathers "indices" rows of a [rows, dim] table.
+template <typename T, typename Index>
+Graph* Gather(int rows, int dim, int indices) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor index(DataTypeToEnum<Index>::value, TensorShape({indices}));
+  auto flat = index.flat<Index>();
+  for (int i = 0; i < indices; ++i) {
+    flat(i) = (i * 7919) % rows;
+  }
+  test::graph::Gather(g, Random<T>(g, TensorShape({rows, dim})),
+                      test::graph::Constant(g, index),
+                      test::graph::Constant(g, test::AsScalar<int32>(0)));
+  return g;
+}
+
+#define BM_GATHER(T, INDEX, R, D, I)                                        \
+  void BM_Gather_##T##_##INDEX##_##R##_##D##_##I(int iters) {               \
+    const int64 items = static_cast<int64>(iters) * I * D;                  \
+    testing::ItemsProcessed(items);                                         \
+    testing::BytesProcessed(items * sizeof(T));                             \
+    test::Benchmark("cpu", Gather<T, INDEX>(R, D, I)).Run(iters);           \
+  }                                                                         \
+  BENCHMARK(BM_Gather_##T##_##INDEX##_##R##_##D##_##I);
+
+BM_GATHER(float, int32, 100000, 64, 8192);
+BM_GATHER(float, int64, 100000, 64, 8192);
+BM_GATHER(float, int32, 1000000, 512, 1024);
+BM_GATHER(int32, int32, 100000, 1, 65536);
+
+// Reduces a [rows, cols] matrix along "axis".
+template <typename T>
+Graph* Reduce(const string& reduce, int rows, int cols, int axis) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Reduce(g, reduce, Random<T>(g, TensorShape({rows, cols})),
+                      test::graph::Constant(g, test::AsScalar<int32>(axis)),
+                      false);
+  return g;
+}
+
+#define BM_REDUCE(OP, T, R, C, AXIS)                                       \
+  void BM_##OP##_##T##_##R##_##C##_##AXIS(int iters) {                     \
+    const int64 items = static_cast<int64>(iters) * R * C;                 \
+    testing::ItemsProcessed(items);                                        \
+    testing::BytesProcessed(items * sizeof(T));                            \
+    test::Benchmark("cpu", Reduce<T>(#OP, R, C, AXIS)).Run(iters);         \
+  }                                                                        \
+  BENCHMARK(BM_##OP##_##T##_##R##_##C##_##AXIS);
+
+BM_REDUCE(Sum, float, 4096, 4096, 0);
+BM_REDUCE(Sum, float, 4096, 4096, 1);
+BM_REDUCE(Sum, float, 64, 262144, 1);
+BM_REDUCE(Sum, double, 4096, 4096, 1);
+BM_REDUCE(Sum, int32, 4096, 4096, 1);
+BM_REDUCE(Max, float, 4096, 4096, 1);
+BM_REDUCE(Mean, float, 4096, 4096, 0);
+
+// Applies a unary or binary coefficient-wise op to "num" elements.
+template <typename T>
+Graph* Cwise(const string& func, int num, bool binary) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* x = Random<T>(g, TensorShape({num}));
+  if (binary) {
+    test::graph::Binary(g, func, x, Random<T>(g, TensorShape({num})));
+  } else {
+    test::graph::Unary(g, func, x);
+  }
+  return g;
+}
+
+#define BM_CWISE(OP, T, BINARY)                                             \
+  void BM_##OP##_##T(int iters, int num) {                                  \
+    const int64 items = static_cast<int64>(iters) * num;                    \
+    testing::ItemsProcessed(items);                                         \
+    testing::BytesProcessed(items * sizeof(T) * (BINARY ? 3 : 2));          \
+    test::Benchmark("cpu", Cwise<T>(#OP, num, BINARY)).Run(iters);          \
+  }                                                                         \
+  BENCHMARK(BM_##OP##_##T)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 22);
+
+BM_CWISE(Add, float, true);
+BM_CWISE(Add, double, true);
+BM_CWISE(Add, int32, true);
+BM_CWISE(Add, half, true);
+BM_CWISE(Mul, float, true);
+BM_CWISE(Maximum, float, true);
+BM_CWISE(Tanh, float, false);
+BM_CWISE(Exp, float, false);
+BM_CWISE(Sigmoid, float, false);
+BM_CWISE(Relu, float, false);
+
+}  // namespace
+}  // namespace tensorflow
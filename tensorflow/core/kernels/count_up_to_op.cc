@@ -71,6 +71,7 @@ class ResourceCountUpToOp : public OpKernel {
         LookupResource<Var>(context, HandleFromInput(context, 0), &variable));
     core::ScopedUnref s(variable);
     mutex_lock l(*variable->mu());
+    ScopedPublishSnapshot publish(variable);
     Tensor before_increment = *variable->tensor();
     OP_REQUIRES(
         context, TensorShapeUtils::IsScalar(before_increment.shape()),
@@ -20,6 +20,7 @@ limitations under the License.
 #include <functional>
 #include <limits>
 #include <string>
+#include <type_traits>
 #include <unordered_set>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -105,6 +106,12 @@ class CudnnRNNForwardOpV2;
 template <typename Device, typename T>
 class CudnnRNNBackwardOpV2;
 
+template <typename Device, typename T>
+class CudnnRNNForwardOpV3;
+
+template <typename Device, typename T>
+class CudnnRNNBackwardOpV3;
+
 enum class TFRNNInputMode {
   kRNNLinearInput = 0,
   kRNNSkipInput = 1,
@@ -144,7 +151,8 @@ class CudnnRnnParameters {
   CudnnRnnParameters(int num_layers, int input_size, int num_units,
                      int seq_length, int batch_size, int dir_count,
                      bool has_dropout, bool is_training, RnnMode rnn_mode,
-                     TFRNNInputMode rnn_input_mode, DataType dtype)
+                     TFRNNInputMode rnn_input_mode, DataType dtype,
+                     bool var_seq_lengths)
       : num_layers_(num_layers),
         input_size_(input_size),
         num_units_(num_units),
@@ -155,11 +163,13 @@ class CudnnRnnParameters {
         is_training_(is_training),
         rnn_mode_(rnn_mode),
         rnn_input_mode_(rnn_input_mode),
-        dtype_(dtype) {
+        dtype_(dtype),
+        var_seq_lengths_(var_seq_lengths) {
     hash_code_ = HashList(
         {num_layers, input_size, num_units, seq_length, batch_size, dir_count,
          static_cast<int>(has_dropout), static_cast<int>(is_training),
-         static_cast<int>(rnn_mode), static_cast<int>(rnn_input_mode), dtype});
+         static_cast<int>(rnn_mode), static_cast<int>(rnn_input_mode), dtype,
+         static_cast<int>(var_seq_lengths)});
   }
 
   bool operator==(const CudnnRnnParameters& other) const {
@@ -183,18 +193,21 @@ class CudnnRnnParameters {
         std::to_string(is_training_),
         std::to_string(static_cast<int>(rnn_mode_)),
         std::to_string(static_cast<int>(rnn_input_mode_)),
-        std::to_string(static_cast<int>(dtype_))};
+        std::to_string(static_cast<int>(dtype_)),
+        std::to_string(var_seq_lengths_)};
     return str_util::Join(fields, ", ");
   }
 
  private:
-  using ParameterDataType = std::tuple<int, int, int, int, int, int, bool, bool,
-                                       RnnMode, TFRNNInputMode, DataType>;
+  using ParameterDataType =
+      std::tuple<int, int, int, int, int, int, bool, bool, RnnMode,
+                 TFRNNInputMode, DataType, bool>;
 
   ParameterDataType get_data_as_tuple() const {
     return std::make_tuple(num_layers_, input_size_, num_units_, seq_length_,
                            batch_size_, dir_count_, has_dropout_, is_training_,
-                           rnn_mode_, rnn_input_mode_, dtype_);
+                           rnn_mode_, rnn_input_mode_, dtype_,
+                           var_seq_lengths_);
   }
 
   const int num_layers_;
@@ -208,6 +221,7 @@ class CudnnRnnParameters {
   const RnnMode rnn_mode_;
   const TFRNNInputMode rnn_input_mode_;
   const DataType dtype_;
+  const bool var_seq_lengths_;
   uint64 hash_code_;
 };
 
@@ -546,10 +560,14 @@ struct RnnScratchSpace {
 
 // Extract and checks the forward input tensors, parameters, and shapes from the
 // OpKernelContext.
+// If var_seq_lengths is true, also extracts and checks the sequence_lengths
+// input.
 Status ExtractForwardInput(OpKernelContext* context,
                            const CudnnModelTypes& model_types,
-                           const Tensor** input, const Tensor** input_h,
-                           const Tensor** input_c, const Tensor** params,
+                           bool var_seq_lengths, const Tensor** input,
+                           const Tensor** input_h, const Tensor** input_c,
+                           const Tensor** params,
+                           const Tensor** sequence_lengths,
                            CudnnRnnModelShapes* model_shapes) {
   TF_RETURN_IF_ERROR(context->input("input", input));
   TF_RETURN_IF_ERROR(context->input("input_h", input_h));
@@ -570,6 +588,27 @@ Status ExtractForwardInput(OpKernelContext* context,
           ? 2
           : 1;
 
+  if (var_seq_lengths) {
+    TF_RETURN_IF_ERROR(context->input("sequence_lengths", sequence_lengths));
+    if (!TensorShapeUtils::IsVector((*sequence_lengths)->shape()) ||
+        (*sequence_lengths)->dim_size(0) != model_shapes->batch_size) {
+      return errors::InvalidArgument(
+          "sequence_lengths must be a vector of batch_size elements: ",
+          (*sequence_lengths)->shape().DebugString(), " ",
+          model_shapes->batch_size);
+    }
+    auto lengths = (*sequence_lengths)->vec<int32>();
+    for (int i = 0; i < model_shapes->batch_size; ++i) {
+      if (lengths(i) < 1 || lengths(i) > model_shapes->seq_length) {
+        return errors::InvalidArgument("sequence_lengths[", i, "] = ",
+                                       lengths(i), " is not in [1, ",
+                                       model_shapes->seq_length, "]");
+      }
+    }
+  } else {
+    *sequence_lengths = nullptr;
+  }
+
   if ((*input_h)->dims() != 3) {
     return errors::InvalidArgument("RNN input_h must be a 3-D vector.");
   }
@@ -601,6 +640,7 @@ Status ExtractForwardInput(OpKernelContext* context,
 template <typename T>
 Status CreateForwardAndBackwardIODescriptors(
     OpKernelContext* context, const CudnnRnnModelShapes& model_shapes,
+    const Tensor* sequence_lengths,
     std::unique_ptr<RnnSequenceTensorDescriptor>* input_desc,
     std::unique_ptr<RnnStateTensorDescriptor>* state_desc,
     std::unique_ptr<RnnSequenceTensorDescriptor>* output_desc) {
@@ -611,10 +651,22 @@ Status CreateForwardAndBackwardIODescriptors(
   const TensorShape& hidden_state_shape = model_shapes.hidden_state_shape;
   const TensorShape& output_shape = model_shapes.output_shape;
 
-  DCHECK_EQ(input_shape.dims(), 3);
-  auto input_desc_s = executor->createRnnSequenceTensorDescriptor(
-      input_shape.dim_size(0), input_shape.dim_size(1), input_shape.dim_size(2),
-      data_type);
+  // Sequences of variable lengths are padded to seq_length. The padded steps
+  // are skipped rather than computed.
+  auto create_sequence_desc = [&](const TensorShape& shape) {
+    DCHECK_EQ(shape.dims(), 3);
+    if (sequence_lengths != nullptr) {
+      return executor->createRnnSequenceTensorDescriptor(
+          shape.dim_size(0), shape.dim_size(1), shape.dim_size(2),
+          se::port::ArraySlice<int>(sequence_lengths->vec<int32>().data(),
+                                    sequence_lengths->NumElements()),
+          data_type);
+    }
+    return executor->createRnnSequenceTensorDescriptor(
+        shape.dim_size(0), shape.dim_size(1), shape.dim_size(2), data_type);
+  };
+
+  auto input_desc_s = create_sequence_desc(input_shape);
   TF_RETURN_IF_ERROR(input_desc_s.status());
   *input_desc = input_desc_s.ConsumeValueOrDie();
 
@@ -625,10 +677,7 @@ Status CreateForwardAndBackwardIODescriptors(
   TF_RETURN_IF_ERROR(hidden_state_desc_s.status());
   *state_desc = hidden_state_desc_s.ConsumeValueOrDie();
 
-  DCHECK_EQ(output_shape.dims(), 3);
-  auto output_desc_s = executor->createRnnSequenceTensorDescriptor(
-      output_shape.dim_size(0), output_shape.dim_size(1),
-      output_shape.dim_size(2), data_type);
+  auto output_desc_s = create_sequence_desc(output_shape);
   TF_RETURN_IF_ERROR(output_desc_s.status());
   *output_desc = output_desc_s.ConsumeValueOrDie();
   return Status::OK();
@@ -641,7 +690,7 @@ Status DoForward(OpKernelContext* context, const RnnDescriptor& rnn_desc,
                  /* forward inputs */
                  const Tensor* input, const Tensor* input_h,
                  const Tensor* input_c, const Tensor* params,
-                 const bool is_training,
+                 const Tensor* sequence_lengths, const bool is_training,
                  /* forward outputs, outputs of the function */
                  Tensor* output, Tensor* output_h, Tensor* output_c,
                  ScratchAllocator* reserve_space_allocator,
@@ -652,7 +701,8 @@ Status DoForward(OpKernelContext* context, const RnnDescriptor& rnn_desc,
   std::unique_ptr<RnnSequenceTensorDescriptor> output_desc;
 
   TF_RETURN_IF_ERROR(CreateForwardAndBackwardIODescriptors<T>(
-      context, model_shapes, &input_desc, &state_desc, &output_desc));
+      context, model_shapes, sequence_lengths, &input_desc, &state_desc,
+      &output_desc));
 
   auto input_data = AsDeviceMemory<T>(input);
   auto input_h_data = AsDeviceMemory<T>(input_h);
@@ -691,7 +741,7 @@ Status DoBackward(
     const CudnnModelTypes& model_types, const CudnnRnnModelShapes& model_shapes,
     /* forward inputs */
     const Tensor* input, const Tensor* input_h, const Tensor* input_c,
-    const Tensor* params,
+    const Tensor* params, const Tensor* sequence_lengths,
     /* forward outptus */
     const Tensor* output, const Tensor* output_h, const Tensor* output_c,
     /* backprop inputs */
@@ -706,7 +756,8 @@ Status DoBackward(
   std::unique_ptr<RnnSequenceTensorDescriptor> output_desc;
 
   TF_RETURN_IF_ERROR(CreateForwardAndBackwardIODescriptors<T>(
-      context, model_shapes, &input_desc, &state_desc, &output_desc));
+      context, model_shapes, sequence_lengths, &input_desc, &state_desc,
+      &output_desc));
 
   auto input_data = AsDeviceMemory<T>(input);
   auto input_h_data = AsDeviceMemory<T>(input_h);
@@ -780,6 +831,28 @@ void RestoreParams(const OpInputList params_input,
   }
 }
 
+// The value of CUDNN_RNN_ALGO_PERSIST_STATIC in cudnnRNNAlgo_t.
+constexpr int64 kPersistStaticRnnAlgorithm = 1;
+
+// Returns true if the persistent static algorithm should be used in place of
+// the standard one when the RNN is not autotuned. It keeps the recurrent
+// weights on chip for the whole sequence, which is much faster for small
+// hidden sizes, and needs a Pascal or newer GPU. Sequences of variable lengths
+// stay on the standard algorithm.
+template <typename T>
+bool UsePersistStaticRnnAlgorithm(OpKernelContext* context,
+                                  const CudnnRnnModelShapes& model_shapes,
+                                  const Tensor* sequence_lengths) {
+  if (std::is_same<T, double>::value || sequence_lengths != nullptr ||
+      model_shapes.num_units > CudnnRnnPersistStaticMaxUnits()) {
+    return false;
+  }
+  int cc_major = 0, cc_minor = 0;
+  const se::DeviceDescription& device =
+      context->op_device_context()->stream()->parent()->GetDeviceDescription();
+  return device.cuda_compute_capability(&cc_major, &cc_minor) && cc_major >= 6;
+}
+
 }  // namespace
 
 // Note: all following kernels depend on a RnnDescriptor instance, which
@@ -1171,10 +1244,13 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     const Tensor* input_h = nullptr;
     const Tensor* input_c = nullptr;
     const Tensor* params = nullptr;
+    const Tensor* sequence_lengths = nullptr;
     CudnnRnnModelShapes model_shapes;
     OP_REQUIRES_OK(context,
-                   ExtractForwardInput(context, model_types(), &input, &input_h,
-                                       &input_c, &params, &model_shapes));
+                   ExtractForwardInput(context, model_types(),
+                                       var_seq_lengths(), &input, &input_h,
+                                       &input_c, &params, &sequence_lengths,
+                                       &model_shapes));
     RnnInputMode input_mode;
     OP_REQUIRES_OK(context,
                    ToRNNInputMode(rnn_input_mode(), model_shapes.num_units,
@@ -1200,22 +1276,36 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     } else {
       OP_REQUIRES_OK(context,
                      MaybeAutoTune(context, model_shapes, input_mode, input,
-                                   input_h, input_c, params, output, output_h,
-                                   output_c, output_algo_config));
+                                   input_h, input_c, params, sequence_lengths,
+                                   output, output_h, output_c,
+                                   output_algo_config));
     }
 
     Status launch_status;
     {
       mutex_lock l(mu_);
       RnnDescriptor* rnn_desc_ptr = nullptr;
-      OP_REQUIRES_OK(
-          context, GetCachedRnnDescriptor<T>(context, model_shapes, input_mode,
-                                             *output_algo_config,
-                                             &rnn_state_cache_, &rnn_desc_ptr));
+      Status status = GetCachedRnnDescriptor<T>(
+          context, model_shapes, input_mode, *output_algo_config,
+          &rnn_state_cache_, &rnn_desc_ptr);
+      if (!status.ok() && !is_debug_mode_ &&
+          output_algo_config->algorithm().algo_id() ==
+              kPersistStaticRnnAlgorithm) {
+        // cuDNN rejects the persistent static algorithm for models that do
+        // not fit on chip. Fall back to the standard one.
+        VLOG(1) << "Falling back to the standard Cudnn RNN algorithm: "
+                << status;
+        persist_static_unsupported_ = true;
+        *output_algo_config = AlgorithmConfig();
+        status = GetCachedRnnDescriptor<T>(context, model_shapes, input_mode,
+                                           *output_algo_config,
+                                           &rnn_state_cache_, &rnn_desc_ptr);
+      }
+      OP_REQUIRES_OK(context, status);
       launch_status = DoForward<T>(
           context, *rnn_desc_ptr, model_types(), model_shapes, input, input_h,
-          input_c, params, is_training_, output, output_h, output_c,
-          &reserve_space_allocator, &workspace_allocator,
+          input_c, params, sequence_lengths, is_training_, output, output_h,
+          output_c, &reserve_space_allocator, &workspace_allocator,
           /*output_profile_result=*/nullptr);
     }
     OP_REQUIRES_OK(context, launch_status);
@@ -1227,18 +1317,24 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
                                const RnnInputMode& input_mode,
                                const Tensor* input, const Tensor* input_h,
                                const Tensor* input_c, const Tensor* params,
-                               Tensor* output, Tensor* output_h,
-                               Tensor* output_c,
+                               const Tensor* sequence_lengths, Tensor* output,
+                               Tensor* output_h, Tensor* output_c,
                                AlgorithmConfig* best_algo_config) {
     CHECK_NE(best_algo_config, nullptr);
     *best_algo_config = AlgorithmConfig();
     return Status::OK();
   }
 
+  // Whether the op takes a sequence_lengths input.
+  virtual bool var_seq_lengths() const { return false; }
+
   bool is_training() const { return is_training_; }
   bool is_debug_mode_;
   bool debug_use_tensor_ops_;
   int64 debug_cudnn_rnn_algo_;
+  // Set once cuDNN has rejected the persistent static algorithm for this
+  // model, so that it is not tried again.
+  std::atomic<bool> persist_static_unsupported_{false};
 
  private:
   Status AllocateOutputs(OpKernelContext* context,
@@ -1331,12 +1427,18 @@ class CudnnRNNForwardOpV2<GPUDevice, T>
                        const CudnnRnnModelShapes& model_shapes,
                        const RnnInputMode& input_mode, const Tensor* input,
                        const Tensor* input_h, const Tensor* input_c,
-                       const Tensor* params, Tensor* output, Tensor* output_h,
-                       Tensor* output_c,
+                       const Tensor* params, const Tensor* sequence_lengths,
+                       Tensor* output, Tensor* output_h, Tensor* output_c,
                        AlgorithmConfig* algo_config) override {
     CHECK_NE(algo_config, nullptr);
     if (!CudnnRnnUseAutotune() || this->is_debug_mode_) {
       *algo_config = AlgorithmConfig();
+      if (!this->is_debug_mode_ && !this->persist_static_unsupported_ &&
+          UsePersistStaticRnnAlgorithm<T>(context, model_shapes,
+                                          sequence_lengths)) {
+        algo_config->set_algorithm(
+            AlgorithmDesc(kPersistStaticRnnAlgorithm, false));
+      }
       return Status::OK();
     }
 
@@ -1354,7 +1456,8 @@ class CudnnRNNForwardOpV2<GPUDevice, T>
         model_shapes.num_units, model_shapes.seq_length,
         model_shapes.batch_size, model_shapes.dir_count,
         /*has_dropout=*/std::abs(dropout()) > 1e-8, is_training(),
-        modeltypes.rnn_mode, modeltypes.rnn_input_mode, input->dtype());
+        modeltypes.rnn_mode, modeltypes.rnn_input_mode, input->dtype(),
+        /*var_seq_lengths=*/sequence_lengths != nullptr);
 
     if (AutoTuneRnnConfigMap::GetInstance()->Find(rnn_params, algo_config)) {
       return Status::OK();
@@ -1412,8 +1515,9 @@ class CudnnRNNForwardOpV2<GPUDevice, T>
       CudnnRnnAllocatorInTemp<uint8> workspace_allocator(context);
       status = DoForward<T>(
           context, *rnn_desc, model_types(), model_shapes, input, input_h,
-          input_c, params, is_training(), output, output_h, output_c,
-          &reserve_space_allocator, &workspace_allocator, &fwd_profile_result);
+          input_c, params, sequence_lengths, is_training(), output, output_h,
+          output_c, &reserve_space_allocator, &workspace_allocator,
+          &fwd_profile_result);
       if (!status.ok()) {
         continue;
       }
@@ -1423,10 +1527,11 @@ class CudnnRNNForwardOpV2<GPUDevice, T>
         Tensor reserve_space = reserve_space_allocator.get_allocated_tensor(0);
         status = DoBackward<T>(
             context, *rnn_desc, model_types(), model_shapes, input, input_h,
-            input_c, params, output, output_h, output_c, &output_backprop,
-            &output_h_backprop, &output_c_backprop, &reserve_space,
-            &input_backprop, &input_h_backprop, &input_c_backprop,
-            &params_backprop, &workspace_allocator, &bak_profile_result);
+            input_c, params, sequence_lengths, output, output_h, output_c,
+            &output_backprop, &output_h_backprop, &output_c_backprop,
+            &reserve_space, &input_backprop, &input_h_backprop,
+            &input_c_backprop, &params_backprop, &workspace_allocator,
+            &bak_profile_result);
         if (!status.ok()) {
           continue;
         }
@@ -1479,10 +1584,13 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     const Tensor* input_h = nullptr;
     const Tensor* input_c = nullptr;
     const Tensor* params = nullptr;
+    const Tensor* sequence_lengths = nullptr;
     CudnnRnnModelShapes model_shapes;
     OP_REQUIRES_OK(context,
-                   ExtractForwardInput(context, model_types(), &input, &input_h,
-                                       &input_c, &params, &model_shapes));
+                   ExtractForwardInput(context, model_types(),
+                                       var_seq_lengths(), &input, &input_h,
+                                       &input_c, &params, &sequence_lengths,
+                                       &model_shapes));
     RnnInputMode input_mode;
     OP_REQUIRES_OK(context,
                    ToRNNInputMode(rnn_input_mode(), model_shapes.num_units,
@@ -1525,9 +1633,9 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
                                              &rnn_desc_ptr));
       launch_status = DoBackward<T>(
           context, *rnn_desc_ptr, model_types(), model_shapes, input, input_h,
-          input_c, params, output, output_h, output_c, output_backprop,
-          output_h_backprop, output_c_backprop, reserve_space, input_backprop,
-          input_h_backprop, input_c_backprop, params_backprop,
+          input_c, params, sequence_lengths, output, output_h, output_c,
+          output_backprop, output_h_backprop, output_c_backprop, reserve_space,
+          input_backprop, input_h_backprop, input_c_backprop, params_backprop,
           &workspace_allocator, /*output_profile_result=*/nullptr);
     }
     OP_REQUIRES_OK(context, launch_status);
@@ -1541,6 +1649,9 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     return Status::OK();
   }
 
+  // Whether the op takes a sequence_lengths input.
+  virtual bool var_seq_lengths() const { return false; }
+
  private:
   mutex mu_;
   RnnStateCache rnn_state_cache_ GUARDED_BY(mu_);
@@ -1672,6 +1783,56 @@ TF_CALL_float(REGISTER_GPU);
 TF_CALL_double(REGISTER_GPU);
 #undef REGISTER_GPU
 
+// Same as CudnnRNNForwardOpV2, for a batch of sequences of variable lengths
+// padded to seq_length. The padded steps are skipped.
+template <typename T>
+class CudnnRNNForwardOpV3<GPUDevice, T>
+    : public CudnnRNNForwardOpV2<GPUDevice, T> {
+ public:
+  explicit CudnnRNNForwardOpV3(OpKernelConstruction* context)
+      : CudnnRNNForwardOpV2<GPUDevice, T>(context) {}
+
+ protected:
+  bool var_seq_lengths() const override { return true; }
+};
+
+#define REGISTER_GPU(T)                                       \
+  REGISTER_KERNEL_BUILDER(Name("CudnnRNNV3")                  \
+                              .Device(DEVICE_GPU)             \
+                              .HostMemory("sequence_lengths") \
+                              .HostMemory("host_reserved")    \
+                              .TypeConstraint<T>("T"),        \
+                          CudnnRNNForwardOpV3<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+TF_CALL_double(REGISTER_GPU);
+#undef REGISTER_GPU
+
+template <typename T>
+class CudnnRNNBackwardOpV3<GPUDevice, T>
+    : public CudnnRNNBackwardOpV2<GPUDevice, T> {
+ public:
+  explicit CudnnRNNBackwardOpV3(OpKernelConstruction* context)
+      : CudnnRNNBackwardOpV2<GPUDevice, T>(context) {}
+
+ protected:
+  bool var_seq_lengths() const override { return true; }
+};
+
+#define REGISTER_GPU(T)                                       \
+  REGISTER_KERNEL_BUILDER(Name("CudnnRNNBackpropV3")          \
+                              .Device(DEVICE_GPU)             \
+                              .HostMemory("sequence_lengths") \
+                              .HostMemory("host_reserved")    \
+                              .TypeConstraint<T>("T"),        \
+                          CudnnRNNBackwardOpV3<GPUDevice, T>);
+
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+TF_CALL_double(REGISTER_GPU);
+#undef REGISTER_GPU
+
 // TODO(zhengxq): Add the conversion of Cudnn RNN Params from and to
 // its canonical form.
 
@@ -144,8 +144,8 @@ class BatchDatasetOp : public UnaryDatasetOpKernel {
           const Tensor& first_element = batch_elements[0][component_index];
           TensorShape batch_component_shape({num_batch_elements});
           batch_component_shape.AppendShape(first_element.shape());
-          Tensor batch_component(ctx->allocator({}), first_element.dtype(),
-                                 batch_component_shape);
+          Tensor batch_component = buffer_pool_.Get(
+              ctx->allocator({}), first_element.dtype(), batch_component_shape);
           // Build the output tuple component by copying one slice
           // from each input element in the batch.
           for (size_t i = 0; i < num_batch_elements; ++i) {
@@ -195,6 +195,8 @@ class BatchDatasetOp : public UnaryDatasetOpKernel {
      private:
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      batch_util::BatchBufferPool buffer_pool_{
+          batch_util::BatchBufferPool::DefaultCapacity()};
     };
 
     const int64 batch_size_;
@@ -12,9 +12,17 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <deque>
+
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -23,13 +31,219 @@ namespace tensorflow {
 
 namespace {
 
+int64 ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& t : element) {
+    bytes += t.TotalBytes();
+  }
+  return bytes;
+}
+
+// Writes the elements of one shard of a sharded cache to "path", as a
+// TFRecord file with one serialized TensorProto per component. Run() is
+// called on a thread of its own; the caller adds the elements and then
+// closes the shard. The file is written as "path".tmp and renamed when it
+// is complete, so that a shard file is never partially written.
+class CacheShardWriter {
+ public:
+  CacheShardWriter(Env* env, string path, string compression_type)
+      : env_(env),
+        path_(std::move(path)),
+        compression_type_(std::move(compression_type)) {}
+
+  // Queues "element" to be written, blocking while too many bytes are
+  // queued already.
+  void Add(const std::vector<Tensor>& element) {
+    const int64 bytes = ElementBytes(element);
+    mutex_lock l(mu_);
+    while (queued_bytes_ > kMaxQueuedBytes && !done_) {
+      cond_var_.wait(l);
+    }
+    // After an error, Wait() reports it and the element is dropped.
+    if (done_) return;
+    queue_.push_back(element);
+    queued_bytes_ += bytes;
+    ++num_elements_;
+    cond_var_.notify_all();
+  }
+
+  // No more elements are added.
+  void Close() {
+    mutex_lock l(mu_);
+    closed_ = true;
+    cond_var_.notify_all();
+  }
+
+  // Waits until Run() returns, and returns its status.
+  Status Wait() {
+    mutex_lock l(mu_);
+    while (!done_) {
+      cond_var_.wait(l);
+    }
+    return status_;
+  }
+
+  int64 num_elements() {
+    mutex_lock l(mu_);
+    return num_elements_;
+  }
+
+  void Run() {
+    Status s = WriteShard();
+    mutex_lock l(mu_);
+    status_ = s;
+    done_ = true;
+    cond_var_.notify_all();
+  }
+
+ private:
+  // The bytes of elements that Add() queues before blocking.
+  static constexpr int64 kMaxQueuedBytes = 32 << 20;
+
+  Status WriteShard() {
+    const string tmp_path = strings::StrCat(path_, ".tmp");
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(tmp_path, &file));
+    io::RecordWriter writer(
+        file.get(),
+        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type_));
+    string record;
+    while (true) {
+      std::vector<Tensor> element;
+      {
+        mutex_lock l(mu_);
+        while (queue_.empty() && !closed_) {
+          cond_var_.wait(l);
+        }
+        if (queue_.empty()) break;
+        element = std::move(queue_.front());
+        queue_.pop_front();
+        queued_bytes_ -= ElementBytes(element);
+        cond_var_.notify_all();
+      }
+      for (const Tensor& t : element) {
+        TensorProto proto;
+        t.AsProtoTensorContent(&proto);
+        record.clear();
+        proto.AppendToString(&record);
+        TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+      }
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Close());
+    return env_->RenameFile(tmp_path, path_);
+  }
+
+  Env* const env_;
+  const string path_;
+  const string compression_type_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  std::deque<std::vector<Tensor>> queue_ GUARDED_BY(mu_);
+  int64 queued_bytes_ GUARDED_BY(mu_) = 0;
+  int64 num_elements_ GUARDED_BY(mu_) = 0;
+  bool closed_ GUARDED_BY(mu_) = false;
+  bool done_ GUARDED_BY(mu_) = false;
+  Status status_ GUARDED_BY(mu_);
+};
+
+// Reads the "num_elements" elements of "num_tensors" components of one shard
+// written by CacheShardWriter. Run() is called on a thread of its own.
+class CacheShardReader {
+ public:
+  CacheShardReader(Env* env, string path, string compression_type,
+                   int64 num_elements, size_t num_tensors)
+      : env_(env),
+        path_(std::move(path)),
+        compression_type_(std::move(compression_type)),
+        num_elements_(num_elements),
+        num_tensors_(num_tensors) {}
+
+  // Waits until Run() returns, and returns its status.
+  Status Wait() {
+    mutex_lock l(mu_);
+    while (!done_) {
+      cond_var_.wait(l);
+    }
+    return status_;
+  }
+
+  // The elements read. REQUIRES: Wait() returned OK.
+  std::vector<std::vector<Tensor>>* elements() { return &elements_; }
+
+  void Run() {
+    Status s = ReadShard();
+    mutex_lock l(mu_);
+    status_ = s;
+    done_ = true;
+    cond_var_.notify_all();
+  }
+
+ private:
+  Status ReadShard() {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(path_, &file));
+    io::SequentialRecordReader reader(
+        file.get(),
+        io::RecordReaderOptions::CreateRecordReaderOptions(compression_type_));
+    elements_.reserve(num_elements_);
+    string record;
+    for (int64 i = 0; i < num_elements_; ++i) {
+      std::vector<Tensor> element(num_tensors_);
+      for (Tensor& t : element) {
+        Status s = reader.ReadRecord(&record);
+        if (errors::IsOutOfRange(s)) {
+          return errors::DataLoss("Cache shard ", path_, " has ", i,
+                                  " elements, expected ", num_elements_);
+        }
+        TF_RETURN_IF_ERROR(s);
+        TensorProto proto;
+        if (!proto.ParseFromString(record) ||
+            !t.FromProto(cpu_allocator(), proto)) {
+          return errors::DataLoss("Corrupt tensor in cache shard ", path_);
+        }
+      }
+      elements_.push_back(std::move(element));
+    }
+    return Status::OK();
+  }
+
+  Env* const env_;
+  const string path_;
+  const string compression_type_;
+  const int64 num_elements_;
+  const size_t num_tensors_;
+  // Only accessed by Run() until it is done.
+  std::vector<std::vector<Tensor>> elements_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  bool done_ GUARDED_BY(mu_) = false;
+  Status status_ GUARDED_BY(mu_);
+};
+
 // See documentation in ../ops/dataset_ops.cc for a high-level description of
 // the following op.
 
 class CacheDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit CacheDatasetOp(OpKernelConstruction* ctx)
-      : UnaryDatasetOpKernel(ctx) {}
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("compression_type", &compression_type_));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("num_parallel_shards", &num_parallel_shards_));
+    OP_REQUIRES(ctx,
+                compression_type_.empty() || compression_type_ == "ZLIB" ||
+                    compression_type_ == "GZIP" ||
+                    compression_type_ == "SNAPPY",
+                errors::InvalidArgument("Unsupported compression_type: ",
+                                        compression_type_));
+    OP_REQUIRES(ctx, num_parallel_shards_ >= 0,
+                errors::InvalidArgument(
+                    "num_parallel_shards must be non-negative, got ",
+                    num_parallel_shards_));
+  }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                    DatasetBase** output) override {
@@ -40,6 +254,10 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
 
     if (filename.empty()) {
       *output = new MemoryDataset(input);
+    } else if (num_parallel_shards_ > 0 || !compression_type_.empty()) {
+      *output = new ShardedFileDataset(input, filename, compression_type_,
+                                       std::max(num_parallel_shards_, 1),
+                                       ctx->env());
     } else {
       *output = new FileDataset(input, filename, ctx->env());
     }
@@ -260,6 +478,361 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
     const string tensor_format_string_;
   };  // FileDataset
 
+  // A cache in several shard files, each holding a run of consecutive
+  // elements as a (possibly compressed) TFRecord file, which up to
+  // "parallelism" threads write or read concurrently.
+  //
+  // An index file lists the number of elements of the completed shards in
+  // order, and marks the cache complete once the whole input is written. A
+  // writer that stops early, or fails, leaves the shards that it completed
+  // listed in the index, and the next writer resumes after them: it passes
+  // their elements through from the input without writing them again.
+  class ShardedFileDataset : public DatasetBase {
+   public:
+    ShardedFileDataset(const DatasetBase* input, string filename,
+                       string compression_type, int64 parallelism, Env* env)
+        : input_(input),
+          filename_(std::move(filename)),
+          compression_type_(std::move(compression_type)),
+          parallelism_(parallelism),
+          env_(env),
+          num_tensors_(input->output_dtypes().size()) {
+      input_->Ref();
+    }
+
+    ~ShardedFileDataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      Index index;
+      if (ReadIndex(&index).ok() && index.complete) {
+        return std::unique_ptr<IteratorBase>(new ReaderIterator(
+            {this, strings::StrCat(prefix, "::ShardedReader")}));
+      }
+      // Errors in reading the index are reported by the writer.
+      return std::unique_ptr<IteratorBase>(new WriterIterator(
+          {this, strings::StrCat(prefix, "::ShardedWriter")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() override {
+      return "CacheDatasetOp::ShardedFileDataset";
+    }
+
+   private:
+    // The target size of a shard, in bytes of tensor data.
+    static constexpr int64 kShardBytes = 64 << 20;
+
+    struct Index {
+      string compression_type;
+      // The number of elements of each completed shard.
+      std::vector<int64> shard_sizes;
+      bool complete = false;
+    };
+
+    string IndexName() const {
+      return strings::StrCat(filename_, ".cache-index");
+    }
+
+    string ShardName(size_t shard) const {
+      return strings::Printf("%s.cache-%05zu", filename_.c_str(), shard);
+    }
+
+    // The index is a text file: a "compression_type=" line, the number of
+    // elements of each completed shard, one per line, and then a "complete"
+    // line once the whole input is cached. A missing index is empty.
+    Status ReadIndex(Index* index) const {
+      *index = Index();
+      index->compression_type = compression_type_;
+      Status s = env_->FileExists(IndexName());
+      if (errors::IsNotFound(s)) return Status::OK();
+      TF_RETURN_IF_ERROR(s);
+      string contents;
+      TF_RETURN_IF_ERROR(ReadFileToString(env_, IndexName(), &contents));
+      for (const string& line :
+           str_util::Split(contents, '\n', str_util::SkipEmpty())) {
+        StringPiece value(line);
+        int64 shard_size;
+        if (str_util::ConsumePrefix(&value, "compression_type=")) {
+          index->compression_type = value.ToString();
+        } else if (line == "complete") {
+          index->complete = true;
+        } else if (strings::safe_strto64(line, &shard_size)) {
+          index->shard_sizes.push_back(shard_size);
+        } else {
+          return errors::DataLoss("Corrupt cache index ", IndexName(), ": ",
+                                  line);
+        }
+      }
+      return Status::OK();
+    }
+
+    // Replaces the index atomically.
+    Status WriteIndex(const Index& index) const {
+      string contents =
+          strings::StrCat("compression_type=", index.compression_type, "\n");
+      for (int64 shard_size : index.shard_sizes) {
+        strings::StrAppend(&contents, shard_size, "\n");
+      }
+      if (index.complete) contents += "complete\n";
+      const string tmp_name = strings::StrCat(IndexName(), ".tmp");
+      TF_RETURN_IF_ERROR(WriteStringToFile(env_, tmp_name, contents));
+      return env_->RenameFile(tmp_name, IndexName());
+    }
+
+    // WriterIterator passes through the elements of the input, and writes
+    // them into shards on "parallelism" threads.
+    class WriterIterator : public DatasetIterator<ShardedFileDataset> {
+     public:
+      explicit WriterIterator(const Params& params)
+          : DatasetIterator<ShardedFileDataset>(params),
+            input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
+            lockfile_(strings::StrCat(params.dataset->filename_, ".lockfile")),
+            pool_(new thread::ThreadPool(params.dataset->env_, "cache_writer",
+                                         params.dataset->parallelism_)) {}
+
+      ~WriterIterator() override {
+        mutex_lock l(mu_);
+        if (initialized_ && !finished_) {
+          // Keeps the completed shards for the next writer to resume from.
+          Status s = Finish(/*complete=*/false);
+          if (!s.ok()) {
+            LOG(ERROR) << "Failed to finish the cache shards: " << s;
+          }
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (finished_) {
+          return errors::OutOfRange(
+              "Attempting to call get_next after iteration should have "
+              "finished.");
+        }
+        TF_RETURN_IF_ERROR(Initialize());
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          return Finish(/*complete=*/true);
+        }
+        if (out_tensors->size() != dataset()->num_tensors_) {
+          return errors::Internal(
+              "Upstream iterator returned invalid number of tensors. Expected ",
+              dataset()->num_tensors_, " got: ", out_tensors->size());
+        }
+        if (num_to_skip_ > 0) {
+          // The element is in a shard completed by a previous writer.
+          --num_to_skip_;
+          return Status::OK();
+        }
+        if (writers_.empty() || writers_.back().closed) {
+          TF_RETURN_IF_ERROR(StartShard());
+        }
+        ShardState& shard = writers_.back();
+        shard.writer->Add(*out_tensors);
+        shard.bytes += ElementBytes(*out_tensors);
+        if (shard.bytes >= kShardBytes) {
+          shard.writer->Close();
+          shard.closed = true;
+        }
+        return Status::OK();
+      }
+
+     private:
+      struct ShardState {
+        std::unique_ptr<CacheShardWriter> writer;
+        int64 bytes = 0;
+        bool closed = false;
+      };
+
+      // Takes the lockfile and reads the shards of a previous writer.
+      Status Initialize() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (initialized_) return Status::OK();
+        Env* env = dataset()->env_;
+        if (env->FileExists(lockfile_).ok()) {
+          return errors::AlreadyExists(
+              "There appears to be a concurrent caching iterator running - "
+              "cache lockfile already exists ('",
+              lockfile_,
+              "'). If you are sure no other running TF computations are using "
+              "this cache prefix, delete the lockfile and re-initialize the "
+              "iterator.");
+        }
+        TF_RETURN_IF_ERROR(dataset()->ReadIndex(&index_));
+        if (index_.compression_type != dataset()->compression_type_) {
+          return errors::InvalidArgument(
+              "The partial cache ", dataset()->filename_,
+              " was written with compression_type \"",
+              index_.compression_type, "\" rather than \"",
+              dataset()->compression_type_, "\"");
+        }
+        std::unique_ptr<WritableFile> lockfile;
+        TF_RETURN_IF_ERROR(env->NewWritableFile(lockfile_, &lockfile));
+        TF_RETURN_IF_ERROR(lockfile->Append(
+            strings::StrCat("Created at: ", env->NowSeconds())));
+        TF_RETURN_IF_ERROR(lockfile->Close());
+        for (int64 shard_size : index_.shard_sizes) {
+          num_to_skip_ += shard_size;
+        }
+        if (num_to_skip_ > 0) {
+          LOG(INFO) << "Resuming the cache " << dataset()->filename_
+                    << " after its first " << index_.shard_sizes.size()
+                    << " shards";
+        }
+        initialized_ = true;
+        return Status::OK();
+      }
+
+      Status StartShard() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (static_cast<int64>(writers_.size()) >= dataset()->parallelism_) {
+          TF_RETURN_IF_ERROR(RetireOldestShard());
+        }
+        const size_t shard = index_.shard_sizes.size() + writers_.size();
+        ShardState state;
+        state.writer.reset(new CacheShardWriter(dataset()->env_,
+                                                dataset()->ShardName(shard),
+                                                dataset()->compression_type_));
+        CacheShardWriter* writer = state.writer.get();
+        writers_.push_back(std::move(state));
+        pool_->Schedule([writer]() { writer->Run(); });
+        return Status::OK();
+      }
+
+      // Waits for the oldest shard, which is closed, and adds it to the
+      // index.
+      Status RetireOldestShard() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::unique_ptr<CacheShardWriter> writer =
+            std::move(writers_.front().writer);
+        writers_.pop_front();
+        TF_RETURN_IF_ERROR(writer->Wait());
+        index_.shard_sizes.push_back(writer->num_elements());
+        return dataset()->WriteIndex(index_);
+      }
+
+      // Closes and waits for all the shards, records them in the index, and
+      // releases the lockfile. On error, the shards after the failed one are
+      // left out of the index.
+      Status Finish(bool complete) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        finished_ = true;
+        for (ShardState& shard : writers_) {
+          shard.writer->Close();
+        }
+        Status s;
+        while (!writers_.empty()) {
+          if (s.ok()) {
+            s = RetireOldestShard();
+          } else {
+            writers_.front().writer->Wait().IgnoreError();
+            writers_.pop_front();
+          }
+        }
+        if (s.ok() && complete) {
+          index_.complete = true;
+          s = dataset()->WriteIndex(index_);
+        }
+        s.Update(dataset()->env_->DeleteFile(lockfile_));
+        return s;
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      const string lockfile_;
+      bool initialized_ GUARDED_BY(mu_) = false;
+      bool finished_ GUARDED_BY(mu_) = false;
+      Index index_ GUARDED_BY(mu_);
+      // The number of input elements that are in completed shards already.
+      int64 num_to_skip_ GUARDED_BY(mu_) = 0;
+      // The shards being written, oldest first. Only the last one may be
+      // open.
+      std::deque<ShardState> writers_ GUARDED_BY(mu_);
+      // Destroyed first, once the writers are done.
+      std::unique_ptr<thread::ThreadPool> pool_;
+    };  // WriterIterator
+
+    // ReaderIterator reads the shards of a complete cache in order, reading
+    // ahead up to "parallelism" shards concurrently.
+    class ReaderIterator : public DatasetIterator<ShardedFileDataset> {
+     public:
+      explicit ReaderIterator(const Params& params)
+          : DatasetIterator<ShardedFileDataset>(params),
+            pool_(new thread::ThreadPool(params.dataset->env_, "cache_reader",
+                                         params.dataset->parallelism_)) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(status_);
+        if (!initialized_) {
+          status_ = dataset()->ReadIndex(&index_);
+          TF_RETURN_IF_ERROR(status_);
+          initialized_ = true;
+        }
+        while (current_ == nullptr ||
+               position_ == current_->elements()->size()) {
+          while (static_cast<int64>(readers_.size()) <
+                     dataset()->parallelism_ &&
+                 next_shard_ < index_.shard_sizes.size()) {
+            StartShard();
+          }
+          if (readers_.empty()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          current_ = std::move(readers_.front());
+          readers_.pop_front();
+          position_ = 0;
+          // A shard that can't be read fails the rest of the iteration.
+          status_ = current_->Wait();
+          TF_RETURN_IF_ERROR(status_);
+        }
+        *out_tensors = std::move((*current_->elements())[position_++]);
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     private:
+      void StartShard() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const size_t shard = next_shard_++;
+        readers_.emplace_back(new CacheShardReader(
+            dataset()->env_, dataset()->ShardName(shard),
+            index_.compression_type, index_.shard_sizes[shard],
+            dataset()->num_tensors_));
+        CacheShardReader* reader = readers_.back().get();
+        pool_->Schedule([reader]() { reader->Run(); });
+      }
+
+      mutex mu_;
+      Status status_ GUARDED_BY(mu_);
+      bool initialized_ GUARDED_BY(mu_) = false;
+      Index index_ GUARDED_BY(mu_);
+      size_t next_shard_ GUARDED_BY(mu_) = 0;
+      // The shard whose elements are returned, and the next one to return.
+      std::unique_ptr<CacheShardReader> current_ GUARDED_BY(mu_);
+      size_t position_ GUARDED_BY(mu_) = 0;
+      // The shards being read ahead, in order.
+      std::deque<std::unique_ptr<CacheShardReader>> readers_ GUARDED_BY(mu_);
+      // Destroyed first, once the readers are done.
+      std::unique_ptr<thread::ThreadPool> pool_;
+    };  // ReaderIterator
+
+    const DatasetBase* const input_;
+    const string filename_;
+    const string compression_type_;
+    const int64 parallelism_;
+    Env* const env_;
+    const size_t num_tensors_;
+  };  // ShardedFileDataset
+
   class MemoryDataset : public DatasetBase {
    public:
     explicit MemoryDataset(const DatasetBase* input) : input_(input) {
@@ -400,6 +973,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
         GUARDED_BY(mu_);
     mutable bool writer_iterator_created_ GUARDED_BY(mu_) = false;
   };  // MemoryDataset
+
+  string compression_type_;
+  int64 num_parallel_shards_;
 };    // CacheDatasetOp
 
 REGISTER_KERNEL_BUILDER(Name("CacheDataset").Device(DEVICE_CPU),
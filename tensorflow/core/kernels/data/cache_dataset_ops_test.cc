@@ -0,0 +1,126 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/dataset_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+using test::dataset::AddConst;
+using test::dataset::AddIterator;
+using test::dataset::AddRange;
+using test::dataset::GetInt64Elements;
+using test::dataset::Range;
+
+const int64 kNumElements = 100;
+
+// Range(kNumElements).cache(filename) with the given cache attrs.
+GraphDef CachedRange(const string& filename, const string& compression_type,
+                     int64 num_parallel_shards) {
+  GraphDef graph;
+  const DataTypeVector types = {DT_INT64};
+  const std::vector<PartialTensorShape> shapes = {PartialTensorShape({})};
+  AddRange("range", 0, kNumElements, &graph);
+  AddConst("filename", test::AsScalar<string>(filename), &graph);
+  TF_CHECK_OK(NodeDefBuilder("cache", "CacheDataset")
+                  .Input("range", 0, DT_VARIANT)
+                  .Input("filename", 0, DT_STRING)
+                  .Attr("output_types", types)
+                  .Attr("output_shapes", shapes)
+                  .Attr("compression_type", compression_type)
+                  .Attr("num_parallel_shards", num_parallel_shards)
+                  .Finalize(graph.add_node()));
+  AddIterator("cache", types, shapes, "", &graph);
+  return graph;
+}
+
+// Gets up to "max_elements" elements of a new iterator over the cache, and
+// then destroys the iterator.
+std::vector<int64> Iterate(const string& filename,
+                           const string& compression_type,
+                           int64 num_parallel_shards, int64 max_elements) {
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(
+      CachedRange(filename, compression_type, num_parallel_shards)));
+  TF_CHECK_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  std::vector<int64> elements = GetInt64Elements(session.get(), max_elements);
+  TF_CHECK_OK(session->Close());
+  return elements;
+}
+
+TEST(CacheDatasetOpTest, ShardedCacheIsWrittenAndRead) {
+  for (const string compression_type : {"", "ZLIB", "GZIP", "SNAPPY"}) {
+    const string filename = io::JoinPath(
+        testing::TmpDir(), strings::StrCat("sharded_cache_", compression_type));
+    EXPECT_EQ(Range(kNumElements),
+              Iterate(filename, compression_type, 4, kNumElements + 1));
+    Env* env = Env::Default();
+    TF_EXPECT_OK(env->FileExists(strings::StrCat(filename, ".cache-index")));
+    TF_EXPECT_OK(env->FileExists(strings::StrCat(filename, ".cache-00000")));
+    EXPECT_TRUE(errors::IsNotFound(
+        env->FileExists(strings::StrCat(filename, ".lockfile"))));
+
+    // A second iterator reads the complete cache.
+    EXPECT_EQ(Range(kNumElements),
+              Iterate(filename, compression_type, 4, kNumElements + 1));
+  }
+}
+
+TEST(CacheDatasetOpTest, ShardedCacheResumesAfterCompletedShards) {
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "resumed_sharded_cache");
+  // The first iterator stops early, keeping a shard of 30 elements.
+  EXPECT_EQ(Range(30), Iterate(filename, "ZLIB", 2, 30));
+  string index;
+  TF_ASSERT_OK(ReadFileToString(
+      Env::Default(), strings::StrCat(filename, ".cache-index"), &index));
+  EXPECT_EQ("compression_type=ZLIB\n30\n", index);
+
+  // The next one writes the rest of the elements in a new shard.
+  EXPECT_EQ(Range(kNumElements),
+            Iterate(filename, "ZLIB", 2, kNumElements + 1));
+  TF_ASSERT_OK(ReadFileToString(
+      Env::Default(), strings::StrCat(filename, ".cache-index"), &index));
+  EXPECT_EQ("compression_type=ZLIB\n30\n70\ncomplete\n", index);
+  EXPECT_EQ(Range(kNumElements),
+            Iterate(filename, "ZLIB", 2, kNumElements + 1));
+
+  // A cache can't be resumed with another compression.
+  const string other = io::JoinPath(testing::TmpDir(), "other_sharded_cache");
+  EXPECT_EQ(Range(10), Iterate(other, "ZLIB", 2, 10));
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_ASSERT_OK(session->Create(CachedRange(other, "GZIP", 2)));
+  TF_ASSERT_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  std::vector<Tensor> outputs;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->Run({}, {"get_next:0"}, {}, &outputs)));
+}
+
+}  // namespace
+}  // namespace tensorflow
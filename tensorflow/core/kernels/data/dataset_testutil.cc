@@ -0,0 +1,104 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/dataset_testutil.h"
+
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace test {
+namespace dataset {
+
+void AddConst(const string& name, const Tensor& value, GraphDef* graph) {
+  TF_CHECK_OK(NodeDefBuilder(name, "Const")
+                  .Attr("dtype", value.dtype())
+                  .Attr("value", value)
+                  .Finalize(graph->add_node()));
+}
+
+void AddRange(const string& name, int64 start, int64 stop, GraphDef* graph) {
+  const string start_name = strings::StrCat(name, "/start");
+  const string stop_name = strings::StrCat(name, "/stop");
+  const string step_name = strings::StrCat(name, "/step");
+  AddConst(start_name, test::AsScalar<int64>(start), graph);
+  AddConst(stop_name, test::AsScalar<int64>(stop), graph);
+  AddConst(step_name, test::AsScalar<int64>(1), graph);
+  TF_CHECK_OK(NodeDefBuilder(name, "RangeDataset")
+                  .Input(start_name, 0, DT_INT64)
+                  .Input(stop_name, 0, DT_INT64)
+                  .Input(step_name, 0, DT_INT64)
+                  .Attr("output_types", DataTypeVector({DT_INT64}))
+                  .Attr("output_shapes", {PartialTensorShape({})})
+                  .Finalize(graph->add_node()));
+}
+
+void AddIterator(const string& dataset, const DataTypeVector& types,
+                 const std::vector<PartialTensorShape>& shapes,
+                 const string& shared_name, GraphDef* graph) {
+  TF_CHECK_OK(NodeDefBuilder("iterator", "Iterator")
+                  .Attr("shared_name", shared_name)
+                  .Attr("container", "")
+                  .Attr("output_types", types)
+                  .Attr("output_shapes", shapes)
+                  .Finalize(graph->add_node()));
+  TF_CHECK_OK(NodeDefBuilder("make_iterator", "MakeIterator")
+                  .Input(dataset, 0, DT_VARIANT)
+                  .Input("iterator", 0, DT_RESOURCE)
+                  .Finalize(graph->add_node()));
+  TF_CHECK_OK(NodeDefBuilder("get_next", "IteratorGetNext")
+                  .Input("iterator", 0, DT_RESOURCE)
+                  .Attr("output_types", types)
+                  .Attr("output_shapes", shapes)
+                  .Finalize(graph->add_node()));
+}
+
+void AddIteratorSaveAndRestore(GraphDef* graph) {
+  TF_CHECK_OK(NodeDefBuilder("serialize", "SerializeIterator")
+                  .Input("iterator", 0, DT_RESOURCE)
+                  .Finalize(graph->add_node()));
+  TF_CHECK_OK(NodeDefBuilder("serialized", "Placeholder")
+                  .Attr("dtype", DT_VARIANT)
+                  .Finalize(graph->add_node()));
+  TF_CHECK_OK(NodeDefBuilder("deserialize", "DeserializeIterator")
+                  .Input("iterator", 0, DT_RESOURCE)
+                  .Input("serialized", 0, DT_VARIANT)
+                  .Finalize(graph->add_node()));
+}
+
+std::vector<int64> GetInt64Elements(Session* session, int64 max_elements) {
+  std::vector<int64> elements;
+  std::vector<Tensor> outputs;
+  while (static_cast<int64>(elements.size()) < max_elements) {
+    Status s = session->Run({}, {"get_next:0"}, {}, &outputs);
+    if (errors::IsOutOfRange(s)) break;
+    TF_CHECK_OK(s);
+    elements.push_back(outputs[0].scalar<int64>()());
+  }
+  return elements;
+}
+
+std::vector<int64> Range(int64 n) {
+  std::vector<int64> range;
+  for (int64 i = 0; i < n; ++i) range.push_back(i);
+  return range;
+}
+
+}  // namespace dataset
+}  // namespace test
+}  // namespace tensorflow
@@ -0,0 +1,64 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_DATASET_TESTUTIL_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_DATASET_TESTUTIL_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace test {
+namespace dataset {
+
+// Helpers to build GraphDefs of input pipelines, for tests that run dataset
+// ops through a session.
+
+// Adds a Const node named "name" with "value".
+void AddConst(const string& name, const Tensor& value, GraphDef* graph);
+
+// Adds a RangeDataset named "name" over [start, stop), whose elements are
+// int64 scalars.
+void AddRange(const string& name, int64 start, int64 stop, GraphDef* graph);
+
+// Adds an iterator over "dataset" named "iterator", with "make_iterator" to
+// initialize it and "get_next" to get its elements.
+void AddIterator(const string& dataset, const DataTypeVector& types,
+                 const std::vector<PartialTensorShape>& shapes,
+                 const string& shared_name, GraphDef* graph);
+
+// Adds "serialize", which outputs the state of the iterator added by
+// AddIterator(), and "deserialize", which restores it from the "serialized"
+// placeholder.
+void AddIteratorSaveAndRestore(GraphDef* graph);
+
+// Gets up to "max_elements" elements from "get_next" of "session", which
+// must be int64 scalars. Returns fewer if the iterator ends.
+std::vector<int64> GetInt64Elements(Session* session, int64 max_elements);
+
+// Returns {0, 1, ..., n - 1}.
+std::vector<int64> Range(int64 n);
+
+}  // namespace dataset
+}  // namespace test
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_DATASET_TESTUTIL_H_
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -80,6 +81,19 @@ Status VerifyShapesCompatible(const std::vector<PartialTensorShape>& expected,
   return Status::OK();
 }
 
+// Returns a performance model for a new iterator if
+// TF_DATA_PERFORMANCE_MODEL=true, and nullptr otherwise.
+std::shared_ptr<IteratorPerformanceModel> MaybeCreatePerformanceModel() {
+  static const bool enabled = [] {
+    bool b = false;
+    Status s = ReadBoolFromEnvVar("TF_DATA_PERFORMANCE_MODEL", false, &b);
+    if (!s.ok()) LOG(ERROR) << s.error_message();
+    return b;
+  }();
+  if (!enabled) return nullptr;
+  return std::make_shared<IteratorPerformanceModel>();
+}
+
 class IteratorResource : public ResourceBase {
  public:
   IteratorResource(const DataTypeVector& output_dtypes,
@@ -95,7 +109,15 @@ class IteratorResource : public ResourceBase {
         lib_(lib),
         iterator_(nullptr),
         output_dtypes_(output_dtypes),
-        output_shapes_(output_shapes) {}
+        output_shapes_(output_shapes),
+        performance_model_(MaybeCreatePerformanceModel()) {}
+
+  ~IteratorResource() override {
+    if (performance_model_ && num_get_next_calls_ > 0) {
+      LOG(INFO) << "Input pipeline performance:\n"
+                << performance_model_->Summary();
+    }
+  }
 
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) {
@@ -104,6 +126,10 @@ class IteratorResource : public ResourceBase {
       if (lib_ != nullptr) {
         ctx->set_lib(lib_);
       }
+      if (performance_model_) {
+        ctx->set_performance_model(performance_model_);
+        MaybeExportPerformanceModel();
+      }
       return captured_iterator->GetNext(ctx, out_tensors, end_of_sequence);
     } else {
       return errors::FailedPrecondition(
@@ -219,6 +245,18 @@ class IteratorResource : public ResourceBase {
   }
 
  private:
+  // Number of GetNext() calls between exports of the performance model to
+  // the stats aggregator.
+  static constexpr int64 kPerformanceExportInterval = 1000;
+
+  void MaybeExportPerformanceModel() {
+    if (num_get_next_calls_.fetch_add(1) % kPerformanceExportInterval != 0) {
+      return;
+    }
+    std::shared_ptr<StatsAggregator> aggregator = stats_aggregator();
+    if (aggregator) performance_model_->ExportTo(aggregator.get());
+  }
+
   // The following (device_mgr_, flib_def_, pflr_) are only used when the
   // IteratorResource is shared between sessions and in that case we create
   // a new FLR. Otherwise these are set to null.
@@ -232,8 +270,42 @@ class IteratorResource : public ResourceBase {
   std::shared_ptr<const FunctionLibraryDefinition> lib_def_ GUARDED_BY(mu_);
   const DataTypeVector output_dtypes_;
   const std::vector<PartialTensorShape> output_shapes_;
+  const std::shared_ptr<IteratorPerformanceModel> performance_model_;
+  std::atomic<int64> num_get_next_calls_{0};
 };
 
+// Gets the next element of a shared iterator for the GetDatasetElements
+// method of the worker service. As with IteratorGetNext, the consumers of an
+// iterator get disjoint elements.
+Status GetNextFromSharedIterator(
+    ResourceMgr* resource_mgr, DeviceBase* device,
+    std::function<void(std::function<void()>)> runner,
+    const string& container, const string& shared_name,
+    std::vector<Tensor>* out_tensors, bool* end_of_sequence) {
+  IteratorResource* iterator;
+  TF_RETURN_IF_ERROR(resource_mgr->Lookup<IteratorResource>(
+      container.empty() ? resource_mgr->default_container() : container,
+      shared_name, &iterator));
+  core::ScopedUnref unref(iterator);
+  IteratorContext::Params params;
+  params.env = Env::Default();
+  params.stats_aggregator_getter = [iterator]() {
+    return iterator->stats_aggregator();
+  };
+  params.runner = std::move(runner);
+  params.function_library = iterator->function_library();
+  params.allocator_getter = [device](AllocatorAttributes attrs) {
+    return device->GetAllocator(attrs);
+  };
+  IteratorContext iter_ctx(std::move(params));
+  return iterator->GetNext(&iter_ctx, out_tensors, end_of_sequence);
+}
+
+static bool shared_iterator_get_next_registered = [] {
+  RegisterSharedIteratorGetNext(GetNextFromSharedIterator);
+  return true;
+}();
+
 // Helper class for reading data from a VariantTensorData object.
 class VariantTensorDataReader : public IteratorStateReader {
  public:
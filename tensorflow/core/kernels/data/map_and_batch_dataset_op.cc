@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #define EIGEN_USE_THREADS
 
+#include <deque>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/function.h"
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/util/batch_util.h"
 
 namespace tensorflow {
 
@@ -44,6 +46,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &func_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("sloppy", &sloppy_));
   }
 
  protected:
@@ -96,15 +99,16 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
                             func_, std::move(other_arguments), &captured_func));
 
     *output = new Dataset(ctx, input, batch_size, num_parallel_calls,
-                          drop_remainder, output_types_, output_shapes_, func_,
-                          std::move(captured_func), &ctx->eigen_cpu_device());
+                          drop_remainder, sloppy_, output_types_,
+                          output_shapes_, func_, std::move(captured_func),
+                          &ctx->eigen_cpu_device());
   }
 
  private:
   class Dataset : public GraphDatasetBase {
    public:
     Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 batch_size,
-            int64 num_parallel_calls, bool drop_remainder,
+            int64 num_parallel_calls, bool drop_remainder, bool sloppy,
             const DataTypeVector& output_types,
             const std::vector<PartialTensorShape>& output_shapes,
             const NameAttrList& func,
@@ -115,6 +119,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
           batch_size_(batch_size),
           num_parallel_calls_(num_parallel_calls),
           drop_remainder_(drop_remainder),
+          sloppy_(sloppy),
           output_types_(output_types),
           output_shapes_(output_shapes),
           map_fn_(func),
@@ -169,6 +174,8 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       b->BuildAttrValue(map_fn_, &f);
       AttrValue other_arguments_types_attr;
       b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
+      AttrValue sloppy;
+      b->BuildAttrValue(sloppy_, &sloppy);
 
       TF_RETURN_IF_ERROR(b->AddDataset(
           this,
@@ -178,7 +185,8 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
            std::make_pair(4, drop_remainder_node)},  // Single tensor inputs.
           {std::make_pair(1, other_arguments)},      // Tensor list inputs.
           {std::make_pair("f", f),
-           std::make_pair("Targuments", other_arguments_types_attr)},  // Attrs
+           std::make_pair("Targuments", other_arguments_types_attr),
+           std::make_pair("sloppy", sloppy)},  // Attrs
           output));
       return Status::OK();
     }
@@ -358,6 +366,9 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
             CallCompleted(result);
             return;
           }
+          if (dataset()->sloppy_) {
+            sloppy_slots_.emplace_back(result, offset);
+          }
         }
 
         // Call `captured_func_(input_element)`, using `Callback` to store the
@@ -369,12 +380,32 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
               dataset()->captured_func_->RunAsync(
                   ctx.get(), std::move(input_element), return_values,
                   [this, ctx, result, return_values, offset](Status status) {
-                    Callback(ctx, result, return_values, offset, status);
+                    if (dataset()->sloppy_) {
+                      BatchResult* sloppy_result;
+                      int64 sloppy_offset;
+                      TakeSloppySlot(&sloppy_result, &sloppy_offset);
+                      Callback(ctx, sloppy_result, return_values,
+                               sloppy_offset, status);
+                    } else {
+                      Callback(ctx, result, return_values, offset, status);
+                    }
                   });
             },
             ctx, std::move(input_element)));
       }
 
+      // In sloppy mode, the n-th call to complete stores its result in the
+      // batch and at the offset of the n-th call to start, so that a slow
+      // call delays a later batch instead of its own. The batches receive
+      // the same number of elements as in order.
+      void TakeSloppySlot(BatchResult** result, int64* offset) {
+        mutex_lock l(mu_);
+        DCHECK(!sloppy_slots_.empty());
+        *result = sloppy_slots_.front().first;
+        *offset = sloppy_slots_.front().second;
+        sloppy_slots_.pop_front();
+      }
+
       int64 ComputeIndex(int64 n) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         return n % batch_results_.size();
       }
@@ -425,9 +456,9 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
           component_shape.AppendShape(return_values->at(i).shape());
           AllocatorAttributes attr;
           attr.set_gpu_compatible(true);
-          Tensor component(ctx->allocator(attr), return_values->at(i).dtype(),
-                           component_shape);
-          result->output.emplace_back(std::move(component));
+          result->output.emplace_back(
+              buffer_pool_.Get(ctx->allocator(attr),
+                               return_values->at(i).dtype(), component_shape));
         }
         result->output_allocated = true;
       }
@@ -658,6 +689,14 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       std::vector<BatchResult> batch_results_ GUARDED_BY(mu_);
       std::unique_ptr<Thread> runner_thread_ GUARDED_BY(mu_);
       bool cancelled_ GUARDED_BY(mu_) = false;
+      // The batches and offsets of the started calls that have not yet
+      // completed, in the order in which they started. Only used in sloppy
+      // mode.
+      std::deque<std::pair<BatchResult*, int64>> sloppy_slots_
+          GUARDED_BY(mu_);
+      // Output batches, reused once the consumer has released them.
+      batch_util::BatchBufferPool buffer_pool_{
+          batch_util::BatchBufferPool::DefaultCapacity()};
     };
 
     const DatasetBase* const input_;
@@ -665,6 +704,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
     const int64 batch_size_;
     const int64 num_parallel_calls_;
     const bool drop_remainder_;
+    const bool sloppy_;
     const DataTypeVector output_types_;
     const std::vector<PartialTensorShape> output_shapes_;
     const NameAttrList map_fn_;
@@ -677,6 +717,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   NameAttrList func_;
+  bool sloppy_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("MapAndBatchDataset").Device(DEVICE_CPU),
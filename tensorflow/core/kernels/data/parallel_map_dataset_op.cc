@@ -12,15 +12,19 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <deque>
+#include <memory>
 
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/kernels/data/parallelism_autotuner.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/cpu_info.h"
 
 namespace tensorflow {
 
@@ -37,6 +41,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &func_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("sloppy", &sloppy_));
   }
 
  protected:
@@ -53,23 +58,27 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
     int32 num_parallel_calls;
     OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
                                             &num_parallel_calls));
-    OP_REQUIRES(ctx, num_parallel_calls > 0,
+    OP_REQUIRES(ctx,
+                num_parallel_calls > 0 ||
+                    num_parallel_calls == ParallelismAutotuner::kAutoTune,
                 errors::InvalidArgument(
-                    "num_parallel_calls must be greater than zero."));
+                    "num_parallel_calls must be greater than zero, or ",
+                    ParallelismAutotuner::kAutoTune, " to autotune it."));
 
     std::unique_ptr<CapturedFunction> captured_func;
     OP_REQUIRES_OK(ctx, CapturedFunction::Create(
                             func_, std::move(other_arguments), &captured_func));
 
-    *output = new Dataset(ctx, input, func_, num_parallel_calls, output_types_,
-                          output_shapes_, std::move(captured_func));
+    *output = new Dataset(ctx, input, func_, num_parallel_calls, sloppy_,
+                          output_types_, output_shapes_,
+                          std::move(captured_func));
   }
 
  private:
   class Dataset : public GraphDatasetBase {
    public:
     Dataset(OpKernelContext* ctx, const DatasetBase* input,
-            const NameAttrList& func, int32 num_parallel_calls,
+            const NameAttrList& func, int32 num_parallel_calls, bool sloppy,
             const DataTypeVector& output_types,
             const std::vector<PartialTensorShape>& output_shapes,
             std::unique_ptr<CapturedFunction> captured_func)
@@ -77,6 +86,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
           input_(input),
           func_(func),
           num_parallel_calls_(num_parallel_calls),
+          sloppy_(sloppy),
           output_types_(output_types),
           output_shapes_(output_shapes),
           captured_func_(std::move(captured_func)) {
@@ -134,13 +144,18 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
       AttrValue other_arguments_types_attr;
       b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
 
+      // Attr: sloppy
+      AttrValue sloppy;
+      b->BuildAttrValue(sloppy_, &sloppy);
+
       TF_RETURN_IF_ERROR(b->AddDataset(
           this,
           {std::make_pair(0, input_graph_node),
            std::make_pair(2, num_parallel_calls)},  // Single tensor inputs.
           {std::make_pair(1, other_arguments)},     // Tensor list inputs.
           {std::make_pair("f", f),
-           std::make_pair("Targuments", other_arguments_types_attr)},  // Attrs
+           std::make_pair("Targuments", other_arguments_types_attr),
+           std::make_pair("sloppy", sloppy)},  // Attrs
           output));
       return Status::OK();
     }
@@ -151,7 +166,13 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params),
             input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
-            invocation_results_(params.dataset->num_parallel_calls_) {}
+            autotuner_(params.dataset->num_parallel_calls_,
+                       port::NumSchedulableCPUs()),
+            invocation_results_(autotuner_.max_parallelism()) {
+        for (auto& result : invocation_results_) {
+          result.reset(new InvocationResult);
+        }
+      }
 
       ~Iterator() override {
         // TODO(mrry): Replace this cancellation logic with a
@@ -161,12 +182,14 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         // potentially-blocking iterators, when we add these.
         {
           mutex_lock l(mu_);
-          for (size_t i = 0; i < dataset()->num_parallel_calls_; ++i) {
-            if (invocation_results_[i].notification) {
-              invocation_results_[i].notification->WaitForNotification();
+          for (size_t i = 0; i < invocation_results_.size(); ++i) {
+            if (invocation_results_[i]->notification) {
+              invocation_results_[i]->notification->WaitForNotification();
             }
           }
         }
+        // Wait for the callbacks to release `completion_mu_`.
+        mutex_lock l(completion_mu_);
       }
 
       Status GetNextInternal(IteratorContext* ctx,
@@ -174,10 +197,10 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
 
-        // Ensure that there are `dataset()->num_parallel_calls_`
-        // invocations of `func_` outstanding at once.
+        // Ensure that there are `autotuner_.parallelism()` invocations of
+        // `func_` outstanding at once.
         while (input_impl_ && (num_inputs_consumed_ - num_outputs_consumed_ <
-                               dataset()->num_parallel_calls_)) {
+                               autotuner_.parallelism())) {
           InvokeFunctionLocked(ctx);
         }
 
@@ -187,12 +210,20 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         }
 
         // Read the next result out of `invocation_results_`, which
-        // acts as a circular buffer.
+        // acts as a circular buffer. In sloppy mode, the first outstanding
+        // invocation to complete is moved to the head of the buffer.
         const size_t result_index =
-            num_outputs_consumed_ % dataset()->num_parallel_calls_;
-        InvocationResult* result = &invocation_results_[result_index];
+            num_outputs_consumed_ % invocation_results_.size();
+        if (dataset()->sloppy_) {
+          std::swap(invocation_results_[result_index],
+                    invocation_results_[WaitForAnyResultLocked(ctx)]);
+        }
+        InvocationResult* result = invocation_results_[result_index].get();
         *end_of_sequence = false;
         if (result->notification) {
+          if (autotuner_.enabled() && !dataset()->sloppy_) {
+            WaitAndRecordLocked(ctx, result->notification.get());
+          }
           result->notification->WaitForNotification();
           if (result->status.ok()) {
             std::swap(*out_tensors, result->return_values);
@@ -222,21 +253,25 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
                                                num_inputs_consumed_));
         TF_RETURN_IF_ERROR(writer->WriteScalar(
             full_name("num_outputs_consumed"), num_outputs_consumed_));
-
-        for (size_t i = 0; i < dataset()->num_parallel_calls_; i++) {
-          if (invocation_results_[i].notification) {
-            invocation_results_[i].notification->WaitForNotification();
-            TF_RETURN_IF_ERROR(
-                WriteStatusLocked(writer, i, invocation_results_[i].status));
+        // The size of the buffer depends on the number of CPUs when
+        // autotuning, so the checkpoint records it.
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name("invocation_results.size"),
+            static_cast<int64>(invocation_results_.size())));
+
+        for (size_t i = 0; i < invocation_results_.size(); i++) {
+          const InvocationResult& result = *invocation_results_[i];
+          if (result.notification) {
+            result.notification->WaitForNotification();
+            TF_RETURN_IF_ERROR(WriteStatusLocked(writer, i, result.status));
             TF_RETURN_IF_ERROR(writer->WriteScalar(
                 full_name(strings::StrCat("invocation_results[", i, "].size")),
-                invocation_results_[i].return_values.size()));
-            for (size_t j = 0; j < invocation_results_[i].return_values.size();
-                 j++) {
+                result.return_values.size()));
+            for (size_t j = 0; j < result.return_values.size(); j++) {
               TF_RETURN_IF_ERROR(writer->WriteTensor(
                   full_name(
                       strings::StrCat("invocation_results[", i, "][", j, "]")),
-                  invocation_results_[i].return_values[j]));
+                  result.return_values[j]));
             }
           } else {
             TF_RETURN_IF_ERROR(writer->WriteScalar(
@@ -260,9 +295,26 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
                                               &num_inputs_consumed_));
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("num_outputs_consumed"),
                                               &num_outputs_consumed_));
-        for (size_t i = 0; i < dataset()->num_parallel_calls_; i++) {
-          InvocationResult* result = &invocation_results_[i];
-          *result = InvocationResult();
+        // Checkpoints without the size were written with a buffer of the
+        // size of this one.
+        int64 saved_size = invocation_results_.size();
+        if (reader->Contains(full_name("invocation_results.size"))) {
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              full_name("invocation_results.size"), &saved_size));
+        }
+        if (saved_size <= 0 ||
+            num_inputs_consumed_ - num_outputs_consumed_ > saved_size) {
+          return errors::InvalidArgument(
+              full_name("invocation_results.size"), ": ", saved_size,
+              " does not hold the ",
+              num_inputs_consumed_ - num_outputs_consumed_,
+              " outstanding results.");
+        }
+        std::vector<std::shared_ptr<InvocationResult>> saved_results(
+            saved_size);
+        for (size_t i = 0; i < saved_results.size(); i++) {
+          saved_results[i].reset(new InvocationResult);
+          InvocationResult* result = saved_results[i].get();
           if (!reader->Contains(full_name(
                   strings::StrCat("invocation_results[", i, "]_empty")))) {
             result->notification.reset(new Notification);
@@ -293,6 +345,17 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
             }
           }
         }
+        // Moves the outstanding results to their slots in a buffer that is
+        // large enough for both the checkpoint and the autotuner.
+        invocation_results_.resize(std::max<int64>(
+            saved_size, autotuner_.max_parallelism()));
+        for (auto& result : invocation_results_) {
+          result.reset(new InvocationResult);
+        }
+        for (int64 i = num_outputs_consumed_; i < num_inputs_consumed_; ++i) {
+          invocation_results_[i % invocation_results_.size()] =
+              std::move(saved_results[i % saved_size]);
+        }
         return Status::OK();
       }
 
@@ -307,14 +370,14 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         DCHECK(input_impl_);
         DCHECK(num_inputs_consumed_ - num_outputs_consumed_ <
-               dataset()->num_parallel_calls_);
+               invocation_results_.size());
 
         // The result of invoking the function will be written into the next
         // slot in `invocation_results_`, which acts as a circular buffer.
         const size_t result_index =
-            num_inputs_consumed_ % dataset()->num_parallel_calls_;
-        InvocationResult* result = &invocation_results_[result_index];
-        *result = InvocationResult();
+            num_inputs_consumed_ % invocation_results_.size();
+        std::shared_ptr<InvocationResult> result(new InvocationResult);
+        invocation_results_[result_index] = result;
 
         // Get the next input element.
         std::vector<Tensor> input_element;
@@ -335,13 +398,54 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
           result->notification.reset(new Notification);
           dataset()->captured_func_->RunAsync(
               ctx, std::move(input_element), &result->return_values,
-              [result, result_index](Status ret_status) {
+              [this, result](Status ret_status) {
                 result->status.Update(ret_status);
+                mutex_lock l(completion_mu_);
                 result->notification->Notify();
+                completion_cond_var_.notify_all();
               });
         }
       }
 
+      // Waits for "notification", telling the autotuner how long the
+      // consumer was blocked.
+      void WaitAndRecordLocked(IteratorContext* ctx, Notification* notification)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        int64 wait_micros = 0;
+        if (!notification->HasBeenNotified()) {
+          const int64 wait_start = ctx->env()->NowMicros();
+          notification->WaitForNotification();
+          wait_micros = ctx->env()->NowMicros() - wait_start;
+        }
+        autotuner_.RecordConsumption(ctx->env()->NowMicros(), wait_micros);
+      }
+
+      // Waits until one of the outstanding invocations has completed, and
+      // returns its index in `invocation_results_`. Tells the autotuner how
+      // long the consumer was blocked.
+      size_t WaitForAnyResultLocked(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 wait_start = ctx->env()->NowMicros();
+        int64 wait_micros = 0;
+        mutex_lock l(completion_mu_);
+        while (true) {
+          for (int64 i = num_outputs_consumed_; i < num_inputs_consumed_; ++i) {
+            const size_t index = i % invocation_results_.size();
+            const Notification* notification =
+                invocation_results_[index]->notification.get();
+            if (notification == nullptr || notification->HasBeenNotified()) {
+              if (autotuner_.enabled()) {
+                autotuner_.RecordConsumption(ctx->env()->NowMicros(),
+                                             wait_micros);
+              }
+              return index;
+            }
+          }
+          completion_cond_var_.wait(l);
+          wait_micros = ctx->env()->NowMicros() - wait_start;
+        }
+      }
+
       Status WriteStatusLocked(IteratorStateWriter* writer, size_t index,
                                const Status& status)
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -383,7 +487,16 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
 
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
-      std::vector<InvocationResult> invocation_results_ GUARDED_BY(mu_);
+      // Sets how many invocations are outstanding. The circular buffer of
+      // results is sized for the largest parallelism it may choose.
+      ParallelismAutotuner autotuner_ GUARDED_BY(mu_);
+      // The results are shared with the callbacks of their invocations, so
+      // that sloppy mode can reorder the buffer while they are in flight.
+      std::vector<std::shared_ptr<InvocationResult>> invocation_results_
+          GUARDED_BY(mu_);
+      // Signalled when an invocation completes.
+      mutex completion_mu_ ACQUIRED_AFTER(mu_);
+      condition_variable completion_cond_var_;
       int64 num_inputs_consumed_ GUARDED_BY(mu_) = 0;
       int64 num_outputs_consumed_ GUARDED_BY(mu_) = 0;
     };
@@ -391,6 +504,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
     const DatasetBase* const input_;
     const NameAttrList func_;
     const int32 num_parallel_calls_;
+    const bool sloppy_;
     const DataTypeVector output_types_;
     const std::vector<PartialTensorShape> output_shapes_;
     const std::unique_ptr<CapturedFunction> captured_func_;
@@ -400,6 +514,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   NameAttrList func_;
+  bool sloppy_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParallelMapDataset").Device(DEVICE_CPU),
@@ -0,0 +1,162 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/iterator.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/framework/variant_tensor_data.h"
+#include "tensorflow/core/kernels/data/dataset_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+using test::dataset::AddConst;
+using test::dataset::AddIterator;
+using test::dataset::AddIteratorSaveAndRestore;
+using test::dataset::AddRange;
+using test::dataset::GetInt64Elements;
+
+const int64 kNumElements = 100;
+
+// Range(kNumElements).map(lambda x: x * 2, num_parallel_calls), and ops to
+// save and restore its iterator.
+GraphDef DoubledRange(int32 num_parallel_calls) {
+  GraphDef graph;
+  *graph.mutable_library()->add_function() = test::function::XTimesTwo();
+  const DataTypeVector types = {DT_INT64};
+  const std::vector<PartialTensorShape> shapes = {PartialTensorShape({})};
+  AddRange("range", 0, kNumElements, &graph);
+  AddConst("num_parallel_calls", test::AsScalar<int32>(num_parallel_calls),
+           &graph);
+  AttrValue f;
+  f.mutable_func()->set_name("XTimesTwo");
+  (*f.mutable_func()->mutable_attr())["T"].set_type(DT_INT64);
+  TF_CHECK_OK(NodeDefBuilder("map", "ParallelMapDataset")
+                  .Input("range", 0, DT_VARIANT)
+                  .Input(gtl::ArraySlice<NodeDefBuilder::NodeOut>{})
+                  .Input("num_parallel_calls", 0, DT_INT32)
+                  .Attr("f", f)
+                  .Attr("output_types", types)
+                  .Attr("output_shapes", shapes)
+                  .Finalize(graph.add_node()));
+  AddIterator("map", types, shapes, "", &graph);
+  AddIteratorSaveAndRestore(&graph);
+  return graph;
+}
+
+// Returns a copy of the iterator checkpoint "serialized" whose dataset has
+// "num_parallel_calls" parallel calls, as if the checkpoint had been
+// restored on a host where the buffer of the map has another size.
+Tensor WithNumParallelCalls(const Tensor& serialized,
+                            int32 num_parallel_calls) {
+  const Variant& state = serialized.scalar<Variant>()();
+  VariantTensorData data;
+  state.Encode(&data);
+  string metadata;
+  data.get_metadata(&metadata);
+  IteratorStateMetadata keys;
+  CHECK(keys.ParseFromString(metadata));
+
+  VariantTensorData rewritten;
+  rewritten.set_type_name(data.type_name());
+  rewritten.set_metadata(metadata);
+  for (int i = 0; i < data.tensors_size(); ++i) {
+    Tensor* tensor = rewritten.add_tensors();
+    *tensor = data.tensors(i);
+    if (keys.keys(i) != GraphDatasetBase::kDatasetGraphKey) continue;
+    GraphDef graph;
+    CHECK(graph.ParseFromString(tensor->scalar<string>()()));
+    string num_parallel_calls_node;
+    for (const NodeDef& node : graph.node()) {
+      if (node.op() == "ParallelMapDataset") {
+        const string& input = node.input(2);
+        num_parallel_calls_node = input.substr(0, input.find(':'));
+      }
+    }
+    bool found = false;
+    for (NodeDef& node : *graph.mutable_node()) {
+      if (node.name() == num_parallel_calls_node) {
+        test::AsScalar<int32>(num_parallel_calls)
+            .AsProtoTensorContent(
+                (*node.mutable_attr())["value"].mutable_tensor());
+        found = true;
+      }
+    }
+    CHECK(found);
+    *tensor = Tensor(DT_STRING, TensorShape({}));
+    CHECK(graph.SerializeToString(&tensor->scalar<string>()()));
+  }
+
+  Tensor result(DT_VARIANT, TensorShape({}));
+  result.scalar<Variant>()() = state;
+  CHECK(result.scalar<Variant>()().Decode(rewritten));
+  return result;
+}
+
+// Gets "num_saved" elements of a new iterator with "saved_parallel_calls",
+// saves it, and gets the rest of the elements from an iterator restored with
+// "restored_parallel_calls".
+std::vector<int64> IterateWithCheckpoint(int32 saved_parallel_calls,
+                                         int32 restored_parallel_calls,
+                                         int64 num_saved) {
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(DoubledRange(saved_parallel_calls)));
+  TF_CHECK_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  std::vector<int64> elements = GetInt64Elements(session.get(), num_saved);
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({}, {"serialize:0"}, {}, &outputs));
+  const Tensor serialized =
+      WithNumParallelCalls(outputs[0], restored_parallel_calls);
+  TF_CHECK_OK(session->Close());
+
+  session.reset(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(DoubledRange(restored_parallel_calls)));
+  TF_CHECK_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  TF_CHECK_OK(
+      session->Run({{"serialized", serialized}}, {}, {"deserialize"}, nullptr));
+  for (int64 element : GetInt64Elements(session.get(), kNumElements + 1)) {
+    elements.push_back(element);
+  }
+  TF_CHECK_OK(session->Close());
+  return elements;
+}
+
+TEST(ParallelMapDatasetOpTest, RestoresIntoBufferOfAnotherSize) {
+  std::vector<int64> expected;
+  for (int64 i = 0; i < kNumElements; ++i) expected.push_back(2 * i);
+  for (int64 num_saved : {int64{0}, int64{7}, kNumElements}) {
+    EXPECT_EQ(expected, IterateWithCheckpoint(2, 2, num_saved));
+    // The outstanding results move to a larger buffer.
+    EXPECT_EQ(expected, IterateWithCheckpoint(2, 5, num_saved));
+    // The restored buffer keeps the size of the checkpoint, which holds more
+    // outstanding results than the new parallelism.
+    EXPECT_EQ(expected, IterateWithCheckpoint(5, 2, num_saved));
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,133 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/parallelism_autotuner.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+const int64 ParallelismAutotuner::kAutoTune;
+const int64 ParallelismAutotuner::kWindowElements;
+const int ParallelismAutotuner::kBackoffWindows;
+
+namespace {
+
+// A window in which the consumer waited for less than this fraction of the
+// time does not count as bottlenecked on the stage.
+constexpr double kMinWaitFraction = 0.05;
+
+// An increase of parallelism must raise throughput by at least this factor
+// to be kept.
+constexpr double kMinSpeedup = 1.05;
+
+}  // namespace
+
+CpuBudget* CpuBudget::Global() {
+  static CpuBudget* global = [] {
+    int64 limit = port::NumSchedulableCPUs();
+    Status s =
+        ReadInt64FromEnvVar("TF_DATA_AUTOTUNE_CPU_BUDGET", limit, &limit);
+    if (!s.ok()) LOG(ERROR) << s.error_message();
+    return new CpuBudget(std::max<int64>(1, limit));
+  }();
+  return global;
+}
+
+bool CpuBudget::TryAcquire(int64 n) {
+  mutex_lock l(mu_);
+  if (in_use_ + n > limit_) return false;
+  in_use_ += n;
+  return true;
+}
+
+void CpuBudget::Acquire(int64 n) {
+  mutex_lock l(mu_);
+  in_use_ += n;
+}
+
+void CpuBudget::Release(int64 n) {
+  mutex_lock l(mu_);
+  in_use_ -= n;
+  DCHECK_GE(in_use_, 0);
+}
+
+ParallelismAutotuner::ParallelismAutotuner(int64 parallelism,
+                                           int64 max_parallelism,
+                                           CpuBudget* budget)
+    : enabled_(parallelism == kAutoTune),
+      budget_(budget != nullptr ? budget : CpuBudget::Global()),
+      parallelism_(enabled_ ? 1 : parallelism),
+      max_parallelism_(enabled_ ? std::max<int64>(1, max_parallelism)
+                                : parallelism) {
+  // The first call is always granted, so that every stage makes progress.
+  if (enabled_) budget_->Acquire(parallelism_);
+}
+
+ParallelismAutotuner::~ParallelismAutotuner() {
+  if (enabled_) budget_->Release(parallelism_);
+}
+
+void ParallelismAutotuner::RecordConsumption(int64 now_micros,
+                                             int64 wait_micros) {
+  if (!enabled_) return;
+  if (window_start_micros_ < 0) {
+    window_start_micros_ = now_micros;
+    return;
+  }
+  ++window_elements_;
+  window_wait_micros_ += wait_micros;
+  if (window_elements_ >= kWindowElements) EndWindow(now_micros);
+}
+
+void ParallelismAutotuner::EndWindow(int64 now_micros) {
+  const int64 elapsed_micros =
+      std::max<int64>(1, now_micros - window_start_micros_);
+  const double throughput = window_elements_ * 1e6 / elapsed_micros;
+  const double wait_fraction =
+      static_cast<double>(window_wait_micros_) / elapsed_micros;
+  window_start_micros_ = now_micros;
+  window_elements_ = 0;
+  window_wait_micros_ = 0;
+
+  if (throughput_before_increase_ >= 0) {
+    const bool helped =
+        throughput >= throughput_before_increase_ * kMinSpeedup;
+    throughput_before_increase_ = -1;
+    if (!helped) {
+      --parallelism_;
+      budget_->Release(1);
+      backoff_windows_ = kBackoffWindows;
+      VLOG(2) << "Parallelism autotuner backing off to " << parallelism_;
+      return;
+    }
+  }
+  if (backoff_windows_ > 0) {
+    --backoff_windows_;
+    return;
+  }
+  if (wait_fraction >= kMinWaitFraction && parallelism_ < max_parallelism_ &&
+      budget_->TryAcquire(1)) {
+    ++parallelism_;
+    throughput_before_increase_ = throughput;
+    VLOG(2) << "Parallelism autotuner increasing to " << parallelism_;
+  }
+}
+
+}  // namespace tensorflow
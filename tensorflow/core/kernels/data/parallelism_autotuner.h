@@ -0,0 +1,120 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_PARALLELISM_AUTOTUNER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_PARALLELISM_AUTOTUNER_H_
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A budget of concurrent calls shared by every autotuned stage of the input
+// pipelines in a process, so that stages do not grow their parallelism past
+// the number of cores they compete for.
+//
+// CpuBudget is thread safe.
+class CpuBudget {
+ public:
+  explicit CpuBudget(int64 limit) : limit_(limit) {}
+
+  // Returns the process-wide budget. Its limit is the number of schedulable
+  // CPUs, or TF_DATA_AUTOTUNE_CPU_BUDGET if set.
+  static CpuBudget* Global();
+
+  // Takes "n" units if that stays within the limit.
+  bool TryAcquire(int64 n);
+  // Takes "n" units regardless of the limit.
+  void Acquire(int64 n);
+  void Release(int64 n);
+
+  int64 limit() const { return limit_; }
+  int64 in_use() {
+    mutex_lock l(mu_);
+    return in_use_;
+  }
+
+ private:
+  const int64 limit_;
+  mutex mu_;
+  int64 in_use_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CpuBudget);
+};
+
+// ParallelismAutotuner dynamically adjusts the number of concurrent calls of
+// a parallel stage, such as ParallelMapDataset with num_parallel_calls set
+// to kAutoTune.
+//
+// The autotuner looks at windows of consumed elements. If the consumer of
+// the stage spent a noticeable fraction of a window blocked on it, the
+// stage is the bottleneck, and the autotuner takes one more unit from the
+// CpuBudget and raises parallelism(). If the throughput of the next window
+// did not improve, the extra call did not help (the stage is limited by its
+// input, or the machine is saturated), so the autotuner gives the unit back
+// and waits a while before probing again.
+//
+// ParallelismAutotuner is NOT thread safe.
+class ParallelismAutotuner {
+ public:
+  static const int64 kAutoTune = -1;
+
+  // Number of consumed elements per measurement window.
+  static const int64 kWindowElements = 64;
+
+  // If "parallelism" is kAutoTune, starts at 1 and tunes between 1 and
+  // "max_parallelism", drawing from "budget" (CpuBudget::Global() if null).
+  // Otherwise parallelism() is fixed at "parallelism".
+  ParallelismAutotuner(int64 parallelism, int64 max_parallelism,
+                       CpuBudget* budget = nullptr);
+  ~ParallelismAutotuner();
+
+  bool enabled() const { return enabled_; }
+  int64 parallelism() const { return parallelism_; }
+
+  // Upper bound of parallelism(), for sizing buffers.
+  int64 max_parallelism() const { return max_parallelism_; }
+
+  // Records that the consumer received one element at "now_micros", after
+  // blocking for "wait_micros" waiting for it.
+  void RecordConsumption(int64 now_micros, int64 wait_micros);
+
+ private:
+  // Windows to wait after an unhelpful increase before probing again.
+  static const int kBackoffWindows = 8;
+
+  void EndWindow(int64 now_micros);
+
+  const bool enabled_;
+  CpuBudget* const budget_;
+  int64 parallelism_;
+  const int64 max_parallelism_;
+
+  int64 window_start_micros_ = -1;
+  int64 window_elements_ = 0;
+  int64 window_wait_micros_ = 0;
+  // Throughput, in elements per second, of the window before the last
+  // increase of parallelism_; negative if the last window made no change.
+  double throughput_before_increase_ = -1;
+  int backoff_windows_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ParallelismAutotuner);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_PARALLELISM_AUTOTUNER_H_
@@ -0,0 +1,108 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/parallelism_autotuner.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Feeds one window of elements consumed "element_micros" apart, of which the
+// consumer spent "wait_micros" blocked.
+void RunWindow(ParallelismAutotuner* t, int64* now, int64 element_micros,
+               int64 wait_micros) {
+  for (int i = 0; i < ParallelismAutotuner::kWindowElements; ++i) {
+    *now += element_micros;
+    t->RecordConsumption(*now, wait_micros);
+  }
+}
+
+TEST(ParallelismAutotuner, Disabled) {
+  CpuBudget budget(4);
+  ParallelismAutotuner t(3, 16, &budget);
+  EXPECT_EQ(3, t.parallelism());
+  EXPECT_EQ(3, t.max_parallelism());
+  int64 now = 0;
+  t.RecordConsumption(now, 0);
+  for (int i = 0; i < 10; ++i) RunWindow(&t, &now, 100, 100);
+  EXPECT_EQ(3, t.parallelism());
+  EXPECT_EQ(0, budget.in_use());
+}
+
+TEST(ParallelismAutotuner, IncreasesWhileThroughputImproves) {
+  CpuBudget budget(16);
+  ParallelismAutotuner t(ParallelismAutotuner::kAutoTune, 4, &budget);
+  EXPECT_EQ(1, t.parallelism());
+  EXPECT_EQ(1, budget.in_use());
+  int64 now = 0;
+  t.RecordConsumption(now, 0);
+  // The consumer always waits, and each extra call halves the time per
+  // element.
+  int64 element_micros = 1000;
+  for (int p = 2; p <= 4; ++p) {
+    RunWindow(&t, &now, element_micros, element_micros / 2);
+    EXPECT_EQ(p, t.parallelism());
+    element_micros /= 2;
+  }
+  // Capped by max_parallelism.
+  RunWindow(&t, &now, element_micros, element_micros / 2);
+  RunWindow(&t, &now, element_micros, element_micros / 2);
+  EXPECT_EQ(4, t.parallelism());
+  EXPECT_EQ(4, budget.in_use());
+}
+
+TEST(ParallelismAutotuner, BacksOffWhenIncreaseDoesNotHelp) {
+  CpuBudget budget(16);
+  ParallelismAutotuner t(ParallelismAutotuner::kAutoTune, 8, &budget);
+  int64 now = 0;
+  t.RecordConsumption(now, 0);
+  RunWindow(&t, &now, 1000, 500);
+  EXPECT_EQ(2, t.parallelism());
+  // Same throughput with two calls: give the second one back.
+  RunWindow(&t, &now, 1000, 500);
+  EXPECT_EQ(1, t.parallelism());
+  EXPECT_EQ(1, budget.in_use());
+  // And do not probe again right away.
+  RunWindow(&t, &now, 1000, 500);
+  EXPECT_EQ(1, t.parallelism());
+}
+
+TEST(ParallelismAutotuner, HoldsWhenConsumerDoesNotWait) {
+  CpuBudget budget(16);
+  ParallelismAutotuner t(ParallelismAutotuner::kAutoTune, 8, &budget);
+  int64 now = 0;
+  t.RecordConsumption(now, 0);
+  for (int i = 0; i < 10; ++i) RunWindow(&t, &now, 1000, 0);
+  EXPECT_EQ(1, t.parallelism());
+}
+
+TEST(ParallelismAutotuner, SharesBudget) {
+  CpuBudget budget(3);
+  ParallelismAutotuner t1(ParallelismAutotuner::kAutoTune, 8, &budget);
+  ParallelismAutotuner t2(ParallelismAutotuner::kAutoTune, 8, &budget);
+  int64 now = 0;
+  t1.RecordConsumption(now, 0);
+  t2.RecordConsumption(now, 0);
+  RunWindow(&t1, &now, 1000, 500);
+  EXPECT_EQ(2, t1.parallelism());
+  // The budget is exhausted, so t2 cannot grow.
+  RunWindow(&t2, &now, 1000, 500);
+  EXPECT_EQ(1, t2.parallelism());
+  EXPECT_EQ(3, budget.in_use());
+}
+
+}  // namespace
+}  // namespace tensorflow
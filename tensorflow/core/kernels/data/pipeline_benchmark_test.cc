@@ -0,0 +1,237 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of complete input pipelines over synthetic TFRecord files:
+//
+//   TFRecordDataset -> RepeatDataset -> ShuffleDataset -> BatchDataset ->
+//   ParallelMapDataset(ParseExample) -> PrefetchDataset
+//
+// Each iteration gets one batch from an iterator through a session, as a
+// training loop would. Besides the time per batch and the elements per
+// second, the label of each benchmark reports the process CPU time per
+// element and the peak memory in use by the CPU allocator, so that dataset
+// changes and host configurations can be compared on all three. The
+// arguments of the benchmarks are the number of parallel calls of the map
+// and the batch size.
+
+#include <ctime>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/dataset_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+typedef FunctionDefHelper FDH;
+using test::dataset::AddConst;
+using test::dataset::AddIterator;
+
+// The number of floats in the "features" feature of each example.
+const int kNumFeatures = 256;
+const int kNumFiles = 4;
+const int kExamplesPerFile = 2048;
+
+// Writes the synthetic TFRecord files once, and returns their names.
+const std::vector<string>& InputFiles() {
+  static std::vector<string>* files = [] {
+    auto* files = new std::vector<string>;
+    Env* env = Env::Default();
+    for (int i = 0; i < kNumFiles; ++i) {
+      files->push_back(io::JoinPath(
+          testing::TmpDir(), strings::StrCat("pipeline_", i, ".tfrecord")));
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(files->back(), &file));
+      io::RecordWriter writer(file.get());
+      for (int j = 0; j < kExamplesPerFile; ++j) {
+        Example example;
+        auto* feature = example.mutable_features()->mutable_feature();
+        auto* values = (*feature)["features"].mutable_float_list();
+        for (int k = 0; k < kNumFeatures; ++k) {
+          values->add_value(j * 0.5f + k);
+        }
+        (*feature)["label"].mutable_int64_list()->add_value(j % 10);
+        string serialized;
+        example.SerializeToString(&serialized);
+        TF_CHECK_OK(writer.WriteRecord(serialized));
+      }
+      TF_CHECK_OK(writer.Close());
+      TF_CHECK_OK(file->Close());
+    }
+    return files;
+  }();
+  return *files;
+}
+
+// Parses a batch of serialized examples into "features" and "label".
+FunctionDef ParseBatch() {
+  return FDH::Create(
+      "ParseBatch", {"serialized: string"},
+      {"features: float", "label: int64"}, {},
+      {
+          FDH::Const<string>("names", gtl::ArraySlice<string>{}),
+          FDH::Const<string>("features_key", "features"),
+          FDH::Const<string>("label_key", "label"),
+          FDH::Const<float>("features_default", gtl::ArraySlice<float>{}),
+          FDH::Const<int64>("label_default", gtl::ArraySlice<int64>{}),
+          {{"parse"},
+           "ParseExample",
+           {"serialized", "names:output:0", "features_key:output:0",
+            "label_key:output:0", "features_default:output:0",
+            "label_default:output:0"},
+           {{"Nsparse", 0},
+            {"Ndense", 2},
+            {"sparse_types", DataTypeSlice{}},
+            {"Tdense", DataTypeSlice{DT_FLOAT, DT_INT64}},
+            {"dense_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                 PartialTensorShape({kNumFeatures}),
+                                 PartialTensorShape({})}}}},
+      },
+      {{"features", "parse:dense_values:0"},
+       {"label", "parse:dense_values:1"}});
+}
+
+// Adds a dataset op named "name" that takes "input" and the scalar "arg".
+void AddDataset(const string& name, const string& op, const string& input,
+                const Tensor& arg, const DataTypeVector& types,
+                const std::vector<PartialTensorShape>& shapes,
+                GraphDef* graph) {
+  AddConst(strings::StrCat(name, "/arg"), arg, graph);
+  TF_CHECK_OK(NodeDefBuilder(name, op)
+                  .Input(input, 0, DT_VARIANT)
+                  .Input(strings::StrCat(name, "/arg"), 0, arg.dtype())
+                  .Attr("output_types", types)
+                  .Attr("output_shapes", shapes)
+                  .Finalize(graph->add_node()));
+}
+
+GraphDef Pipeline(int num_parallel_calls, int batch_size) {
+  GraphDef graph;
+  *graph.mutable_library()->add_function() = ParseBatch();
+
+  Tensor filenames(DT_STRING, TensorShape({kNumFiles}));
+  for (int i = 0; i < kNumFiles; ++i) {
+    filenames.vec<string>()(i) = InputFiles()[i];
+  }
+  AddConst("filenames", filenames, &graph);
+  AddConst("compression_type", test::AsScalar<string>(""), &graph);
+  AddConst("read_buffer_size", test::AsScalar<int64>(256 << 10), &graph);
+  TF_CHECK_OK(NodeDefBuilder("read", "TFRecordDataset")
+                  .Input("filenames", 0, DT_STRING)
+                  .Input("compression_type", 0, DT_STRING)
+                  .Input("read_buffer_size", 0, DT_INT64)
+                  .Finalize(graph.add_node()));
+
+  const DataTypeVector records = {DT_STRING};
+  AddDataset("repeat", "RepeatDataset", "read", test::AsScalar<int64>(-1),
+             records, {PartialTensorShape({})}, &graph);
+
+  AddConst("shuffle/seed", test::AsScalar<int64>(1), &graph);
+  AddConst("shuffle/buffer_size", test::AsScalar<int64>(1024), &graph);
+  TF_CHECK_OK(NodeDefBuilder("shuffle", "ShuffleDataset")
+                  .Input("repeat", 0, DT_VARIANT)
+                  .Input("shuffle/buffer_size", 0, DT_INT64)
+                  .Input("shuffle/seed", 0, DT_INT64)
+                  .Input("shuffle/seed", 0, DT_INT64)
+                  .Attr("output_types", records)
+                  .Attr("output_shapes", {PartialTensorShape({})})
+                  .Finalize(graph.add_node()));
+
+  AddDataset("batch", "BatchDataset", "shuffle",
+             test::AsScalar<int64>(batch_size), records,
+             {PartialTensorShape({-1})}, &graph);
+
+  const DataTypeVector types = {DT_FLOAT, DT_INT64};
+  const std::vector<PartialTensorShape> shapes = {
+      PartialTensorShape({-1, kNumFeatures}), PartialTensorShape({-1})};
+  AddConst("parse/num_parallel_calls",
+           test::AsScalar<int32>(num_parallel_calls), &graph);
+  AttrValue parse;
+  parse.mutable_func()->set_name("ParseBatch");
+  TF_CHECK_OK(NodeDefBuilder("parse", "ParallelMapDataset")
+                  .Input("batch", 0, DT_VARIANT)
+                  .Input(gtl::ArraySlice<NodeDefBuilder::NodeOut>{})
+                  .Input("parse/num_parallel_calls", 0, DT_INT32)
+                  .Attr("f", parse)
+                  .Attr("output_types", types)
+                  .Attr("output_shapes", shapes)
+                  .Finalize(graph.add_node()));
+
+  AddDataset("prefetch", "PrefetchDataset", "parse", test::AsScalar<int64>(2),
+             types, shapes, &graph);
+
+  AddIterator("prefetch", types, shapes, "", &graph);
+  return graph;
+}
+
+void BM_TFRecordParsePipeline(int iters, int num_parallel_calls,
+                              int batch_size) {
+  testing::StopTiming();
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(Pipeline(num_parallel_calls, batch_size)));
+  TF_CHECK_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  std::vector<Tensor> outputs;
+  // Fills the shuffle and prefetch buffers before timing.
+  TF_CHECK_OK(session->Run({}, {"get_next:0", "get_next:1"}, {}, &outputs));
+  CHECK_EQ(batch_size, outputs[1].NumElements());
+
+  EnableCPUAllocatorStats(true);
+  cpu_allocator()->ClearStats();
+  const std::clock_t start_cpu = std::clock();
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(session->Run({}, {"get_next:0", "get_next:1"}, {}, &outputs));
+  }
+  testing::StopTiming();
+  const double cpu_seconds =
+      static_cast<double>(std::clock() - start_cpu) / CLOCKS_PER_SEC;
+  AllocatorStats stats;
+  cpu_allocator()->GetStats(&stats);
+  EnableCPUAllocatorStats(false);
+
+  const int64 elements = static_cast<int64>(iters) * batch_size;
+  testing::ItemsProcessed(elements);
+  testing::SetLabel(strings::Printf(
+      "cpu_us_per_element=%.2f peak_mb=%.1f", cpu_seconds * 1e6 / elements,
+      stats.max_bytes_in_use / (1024.0 * 1024.0)));
+  TF_CHECK_OK(session->Close());
+}
+BENCHMARK(BM_TFRecordParsePipeline)
+    ->ArgPair(1, 32)
+    ->ArgPair(4, 32)
+    ->ArgPair(1, 256)
+    ->ArgPair(4, 256)
+    ->ArgPair(16, 256);
+
+}  // namespace
+}  // namespace tensorflow
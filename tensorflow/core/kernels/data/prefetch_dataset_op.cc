@@ -111,14 +111,24 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(EnsurePrefetchThreadStarted(ctx));
+        const bool record_performance = ctx->performance_model() != nullptr;
+        if (record_performance) {
+          RecordBufferOccupancy(buffer_.size(), auto_tuner_.buffer_limit());
+        }
 
         while (true) {
           // Wait until the next element in the buffer has been
           // produced, or we are shutting down.
+          const uint64 wait_start =
+              record_performance && buffer_.empty() ? ctx->env()->NowMicros()
+                                                    : 0;
           while (!cancelled_ && !prefetch_thread_finished_ && buffer_.empty()) {
             auto_tuner_.RecordEmpty();
             cond_var_.wait(l);
           }
+          if (wait_start != 0) {
+            RecordBufferWait(ctx->env()->NowMicros() - wait_start);
+          }
 
           if (cancelled_) {
             return errors::Cancelled(
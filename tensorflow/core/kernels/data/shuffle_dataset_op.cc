@@ -13,15 +13,24 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <deque>
+#include <map>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
@@ -29,24 +38,181 @@ namespace {
 
 const int64 kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 
+// The elements of a shuffle buffer spilled to local files, of which only the
+// locations are kept in memory. Elements are appended to segment files of
+// about kSegmentBytes, and a segment is deleted once none of its elements
+// are left in the buffer. As the buffer returns its elements in random
+// order, the files on disk hold a few times the bytes of the buffer.
+class SpilledShuffleBuffer {
+ public:
+  // Holds up to "capacity" elements, in files under "directory".
+  SpilledShuffleBuffer(Env* env, const string& directory, int64 capacity)
+      : env_(env),
+        prefix_(io::JoinPath(directory,
+                             strings::StrCat("shuffle_buffer_",
+                                             strings::Hex(random::New64())))),
+        locations_(capacity) {}
+
+  ~SpilledShuffleBuffer() {
+    if (writer_ != nullptr) writer_->Close().IgnoreError();
+    for (auto& it : segments_) {
+      DeleteSegment(it.first, &it.second);
+    }
+  }
+
+  // Writes "element" into slot "index", which must be empty.
+  Status Put(int64 index, const std::vector<Tensor>& element) {
+    string bytes;
+    for (const Tensor& t : element) {
+      TensorProto proto;
+      t.AsProtoTensorContent(&proto);
+      string serialized;
+      proto.AppendToString(&serialized);
+      core::PutVarint64(&bytes, serialized.size());
+      bytes.append(serialized);
+    }
+    if (writer_ == nullptr || current_->size >= kSegmentBytes) {
+      TF_RETURN_IF_ERROR(StartSegment());
+    }
+    TF_RETURN_IF_ERROR(writer_->Append(bytes));
+    Location& location = locations_[index];
+    location.segment = current_segment_;
+    location.offset = current_->size;
+    location.size = bytes.size();
+    current_->size += bytes.size();
+    ++current_->num_live;
+    return Status::OK();
+  }
+
+  // Reads the element in slot "index" and empties the slot.
+  Status Take(int64 index, std::vector<Tensor>* element) {
+    TF_RETURN_IF_ERROR(Read(index, element));
+    Location& location = locations_[index];
+    auto it = segments_.find(location.segment);
+    if (--it->second.num_live == 0 && location.segment != current_segment_) {
+      DeleteSegment(it->first, &it->second);
+      segments_.erase(it);
+    }
+    location = Location();
+    return Status::OK();
+  }
+
+  // Reads the element in slot "index".
+  Status Read(int64 index, std::vector<Tensor>* element) {
+    const Location& location = locations_[index];
+    Segment& segment = segments_[location.segment];
+    if (location.segment == current_segment_ &&
+        segment.flushed_size < location.offset + location.size) {
+      TF_RETURN_IF_ERROR(writer_->Flush());
+      segment.flushed_size = segment.size;
+    }
+    if (segment.reader == nullptr) {
+      TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+          SegmentName(location.segment), &segment.reader));
+    }
+    string scratch(location.size, '\0');
+    StringPiece bytes;
+    TF_RETURN_IF_ERROR(segment.reader->Read(location.offset, location.size,
+                                            &bytes, &scratch[0]));
+    element->clear();
+    while (!bytes.empty()) {
+      uint64 size;
+      TensorProto proto;
+      element->emplace_back();
+      if (!core::GetVarint64(&bytes, &size) || size > bytes.size() ||
+          !proto.ParseFromArray(bytes.data(), size) ||
+          !element->back().FromProto(cpu_allocator(), proto)) {
+        return errors::DataLoss("Corrupt element in shuffle buffer file ",
+                                SegmentName(location.segment));
+      }
+      bytes.remove_prefix(size);
+    }
+    return Status::OK();
+  }
+
+  void Swap(int64 a, int64 b) { std::swap(locations_[a], locations_[b]); }
+
+ private:
+  static constexpr int64 kSegmentBytes = 64 << 20;
+
+  struct Location {
+    int64 segment = -1;
+    int64 offset = 0;
+    int64 size = 0;
+  };
+
+  struct Segment {
+    int64 size = 0;
+    int64 flushed_size = 0;
+    int64 num_live = 0;
+    std::unique_ptr<RandomAccessFile> reader;
+  };
+
+  string SegmentName(int64 segment) const {
+    return strings::StrCat(prefix_, "_", segment);
+  }
+
+  Status StartSegment() {
+    if (writer_ != nullptr) {
+      TF_RETURN_IF_ERROR(writer_->Close());
+      writer_.reset();
+      current_->flushed_size = current_->size;
+      if (current_->num_live == 0) {
+        DeleteSegment(current_segment_, current_);
+        segments_.erase(current_segment_);
+      }
+    }
+    ++current_segment_;
+    TF_RETURN_IF_ERROR(
+        env_->NewWritableFile(SegmentName(current_segment_), &writer_));
+    current_ = &segments_[current_segment_];
+    return Status::OK();
+  }
+
+  void DeleteSegment(int64 id, Segment* segment) {
+    segment->reader.reset();
+    Status s = env_->DeleteFile(SegmentName(id));
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete shuffle buffer file: " << s;
+    }
+  }
+
+  Env* const env_;
+  const string prefix_;
+  std::vector<Location> locations_;
+  // The segments that still hold elements, and the one being written.
+  std::unordered_map<int64, Segment> segments_;
+  int64 current_segment_ = -1;
+  Segment* current_ = nullptr;
+  std::unique_ptr<WritableFile> writer_;
+};
+
 // See documentation in ../ops/dataset_ops.cc for a high-level
 // description of the following op.
 
 class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
  public:
   explicit ShuffleDatasetOpBase(OpKernelConstruction* ctx)
-      : UnaryDatasetOpKernel(ctx) {}
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("spill_directory", &spill_directory_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("replay_buffer_on_restore",
+                                     &replay_buffer_on_restore_));
+  }
 
  protected:
   // Abstract base dataset that implements a shuffling iterator.
   class ShuffleDatasetBase : public GraphDatasetBase {
    public:
     ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                       int64 buffer_size, int64 count)
+                       int64 buffer_size, int64 count,
+                       const string& spill_directory,
+                       bool replay_buffer_on_restore)
         : GraphDatasetBase(ctx),
           input_(input),
           buffer_size_(buffer_size),
-          count_(count) {
+          count_(count),
+          spill_directory_(spill_directory),
+          replay_buffer_on_restore_(replay_buffer_on_restore) {
       input_->Ref();
     }
 
@@ -72,7 +238,7 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
             num_elements_(0),
             parent_generator_(seed, seed2),
             generator_(&parent_generator_) {
-        buffer_.reset(new std::vector<Tensor>[params.dataset->buffer_size_]);
+        ResetBuffer();
         slices_.emplace_back(new Slice{0, 0});
       }
 
@@ -112,13 +278,15 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
               return Status::OK();
             }
             epoch_++;
+            epoch_position_ = 0;
             int64 n = slices_.back()->end;
             slices_.emplace_back(new Slice{n, n});
             input_impl_ = dataset()->input_->MakeIterator(prefix());
           }
           if (!end_of_input_sequence) {
-            buffer_[slices_.back()->end % dataset()->buffer_size_] =
-                std::move(input_element);
+            const int64 index = slices_.back()->end % dataset()->buffer_size_;
+            TF_RETURN_IF_ERROR(PutElement(index, std::move(input_element)));
+            origins_[index] = {epoch_, epoch_position_++};
             num_elements_++;
             slices_.back()->end++;
           } else {
@@ -143,9 +311,9 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
               Random() % (slices_.front()->end - slices_.front()->start);
           int64 index =
               (slices_.front()->start + offset) % dataset()->buffer_size_;
-          *out_tensors = std::move(buffer_[index]);
-          std::swap(buffer_[index],
-                    buffer_[slices_.front()->start % dataset()->buffer_size_]);
+          TF_RETURN_IF_ERROR(TakeElement(index, out_tensors));
+          SwapElements(index,
+                       slices_.front()->start % dataset()->buffer_size_);
           slices_.front()->start++;
           num_elements_--;
         } else {
@@ -178,24 +346,32 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
             writer->WriteScalar(full_name("num_elements"), num_elements_));
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name("slices_size"), slices_.size()));
+        const bool replay =
+            dataset()->replay_buffer_on_restore_ && origins_known_;
         for (size_t i = 0; i < slices_.size(); ++i) {
           TF_RETURN_IF_ERROR(writer->WriteScalar(
               full_name(strings::StrCat("slices_start_", i)),
               slices_[i]->start));
           TF_RETURN_IF_ERROR(writer->WriteScalar(
               full_name(strings::StrCat("slices_end_", i)), slices_[i]->end));
+          if (replay) continue;
           for (size_t j = slices_[i]->start; j < slices_[i]->end; ++j) {
             size_t index = j % dataset()->buffer_size_;
+            std::vector<Tensor> element;
+            TF_RETURN_IF_ERROR(ReadElement(index, &element));
             TF_RETURN_IF_ERROR(writer->WriteScalar(
                 full_name(strings::StrCat("buffer_", index, "_size")),
-                buffer_[index].size()));
-            for (size_t k = 0; k < buffer_[index].size(); ++k) {
+                element.size()));
+            for (size_t k = 0; k < element.size(); ++k) {
               TF_RETURN_IF_ERROR(writer->WriteTensor(
                   full_name(strings::StrCat("buffer_", index, "_", k)),
-                  buffer_[index][k]));
+                  element[k]));
             }
           }
         }
+        if (replay) {
+          TF_RETURN_IF_ERROR(SaveOrigins(writer));
+        }
 
         return Status::OK();
       }
@@ -228,7 +404,11 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
               reader->ReadScalar(full_name("slices_size"), &temp));
           slices_size = static_cast<size_t>(temp);
         }
-        buffer_.reset(new std::vector<Tensor>[dataset()->buffer_size_]);
+        // Checkpoints saved with `replay_buffer_on_restore` hold the
+        // positions of the buffered elements in their input epochs instead
+        // of the elements.
+        const bool replay = reader->Contains(full_name("origins"));
+        ResetBuffer();
         for (size_t i = 0; i < slices_size; ++i) {
           int64 start;
           TF_RETURN_IF_ERROR(reader->ReadScalar(
@@ -237,20 +417,30 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
           TF_RETURN_IF_ERROR(reader->ReadScalar(
               full_name(strings::StrCat("slices_end_", i)), &end));
           slices_.emplace_back(new Slice{start, end});
+          if (replay) continue;
           for (size_t j = start; j < end; ++j) {
             size_t index = j % dataset()->buffer_size_;
             int64 list_size;
             TF_RETURN_IF_ERROR(reader->ReadScalar(
                 full_name(strings::StrCat("buffer_", index, "_size")),
                 &list_size));
-            buffer_[index] = std::vector<Tensor>(list_size);
+            std::vector<Tensor> element(list_size);
             for (int k = 0; k < list_size; ++k) {
               TF_RETURN_IF_ERROR(reader->ReadTensor(
                   full_name(strings::StrCat("buffer_", index, "_", k)),
-                  &buffer_[index][k]));
+                  &element[k]));
             }
+            TF_RETURN_IF_ERROR(PutElement(index, std::move(element)));
           }
         }
+        if (replay) {
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("epoch_position"),
+                                                &epoch_position_));
+          TF_RETURN_IF_ERROR(ReplayBuffer(ctx, reader));
+        }
+        // The origins of elements restored from the buffer are unknown, so
+        // they are saved again with the buffer.
+        origins_known_ = replay;
 
         return Status::OK();
       }
@@ -268,6 +458,122 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
         int64 end;
       };
 
+      // Writes the epoch and the position in the epoch of the input of each
+      // buffered element, from which ReplayBuffer() rebuilds the buffer.
+      Status SaveOrigins(IteratorStateWriter* writer)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Tensor origins(DT_INT64, TensorShape({num_elements_, 3}));
+        auto matrix = origins.matrix<int64>();
+        int64 row = 0;
+        for (const auto& slice : slices_) {
+          for (int64 j = slice->start; j < slice->end; ++j, ++row) {
+            const int64 index = j % dataset()->buffer_size_;
+            matrix(row, 0) = index;
+            matrix(row, 1) = origins_[index].first;
+            matrix(row, 2) = origins_[index].second;
+          }
+        }
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("epoch_position"), epoch_position_));
+        return writer->WriteTensor(full_name("origins"), origins);
+      }
+
+      // Rebuilds the buffer by reading each input epoch with buffered
+      // elements again from its start, up to the last buffered element.
+      // This requires the input to produce the same elements in every epoch.
+      Status ReplayBuffer(IteratorContext* ctx, IteratorStateReader* reader)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Tensor origins;
+        TF_RETURN_IF_ERROR(reader->ReadTensor(full_name("origins"), &origins));
+        if (origins.dims() != 2 || origins.dim_size(1) != 3 ||
+            origins.dim_size(0) != num_elements_) {
+          return errors::DataLoss("Invalid shuffle buffer origins: ",
+                                  origins.shape().DebugString());
+        }
+        // The buffer index of each position, by epoch.
+        std::map<int64, std::unordered_map<int64, int64>> indices;
+        auto matrix = origins.matrix<int64>();
+        for (int64 row = 0; row < num_elements_; ++row) {
+          const int64 index = matrix(row, 0);
+          if (index < 0 || index >= dataset()->buffer_size_) {
+            return errors::DataLoss("Invalid shuffle buffer index: ", index);
+          }
+          origins_[index] = {matrix(row, 1), matrix(row, 2)};
+          indices[matrix(row, 1)][matrix(row, 2)] = index;
+        }
+        for (auto& epoch : indices) {
+          int64 last_position = 0;
+          for (const auto& position : epoch.second) {
+            last_position = std::max(last_position, position.first);
+          }
+          std::unique_ptr<IteratorBase> input =
+              dataset()->input_->MakeIterator(prefix());
+          for (int64 position = 0; position <= last_position; ++position) {
+            std::vector<Tensor> element;
+            bool end_of_input_sequence = false;
+            TF_RETURN_IF_ERROR(
+                input->GetNext(ctx, &element, &end_of_input_sequence));
+            if (end_of_input_sequence) {
+              return errors::FailedPrecondition(
+                  "The input of the shuffle ended after ", position,
+                  " elements while its buffer was replayed, but element ",
+                  last_position, " of epoch ", epoch.first,
+                  " was buffered. replay_buffer_on_restore requires an input "
+                  "that produces the same elements in every epoch.");
+            }
+            auto it = epoch.second.find(position);
+            if (it != epoch.second.end()) {
+              TF_RETURN_IF_ERROR(PutElement(it->second, std::move(element)));
+            }
+          }
+        }
+        return Status::OK();
+      }
+
+      // Empties the buffer, which is kept in memory or spilled to files
+      // under the spill directory of the dataset.
+      void ResetBuffer() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        origins_.assign(dataset()->buffer_size_, {-1, -1});
+        if (dataset()->spill_directory_.empty()) {
+          buffer_.reset(new std::vector<Tensor>[dataset()->buffer_size_]);
+        } else {
+          spilled_.reset();
+          spilled_.reset(new SpilledShuffleBuffer(Env::Default(),
+                                                  dataset()->spill_directory_,
+                                                  dataset()->buffer_size_));
+        }
+      }
+
+      Status PutElement(int64 index, std::vector<Tensor>&& element)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spilled_) return spilled_->Put(index, element);
+        buffer_[index] = std::move(element);
+        return Status::OK();
+      }
+
+      Status TakeElement(int64 index, std::vector<Tensor>* element)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spilled_) return spilled_->Take(index, element);
+        *element = std::move(buffer_[index]);
+        return Status::OK();
+      }
+
+      Status ReadElement(int64 index, std::vector<Tensor>* element)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spilled_) return spilled_->Read(index, element);
+        *element = buffer_[index];
+        return Status::OK();
+      }
+
+      void SwapElements(int64 a, int64 b) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::swap(origins_[a], origins_[b]);
+        if (spilled_) {
+          spilled_->Swap(a, b);
+        } else {
+          std::swap(buffer_[a], buffer_[b]);
+        }
+      }
+
       random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         num_random_samples_++;
@@ -285,6 +591,7 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
 
       mutex mu_;
       std::unique_ptr<std::vector<Tensor>[]> buffer_ GUARDED_BY(mu_);
+      std::unique_ptr<SpilledShuffleBuffer> spilled_ GUARDED_BY(mu_);
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
       const int64 seed_ GUARDED_BY(mu_);
       const int64 seed2_ GUARDED_BY(mu_);
@@ -295,12 +602,24 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
       random::SingleSampleAdapter<random::PhiloxRandom> generator_
           GUARDED_BY(mu_);
       int64 num_random_samples_ GUARDED_BY(mu_) = 0;
+      // The number of elements read from the current input iterator.
+      int64 epoch_position_ GUARDED_BY(mu_) = 0;
+      // The input epoch and position in that epoch of the element at each
+      // index of the buffer.
+      std::vector<std::pair<int64, int64>> origins_ GUARDED_BY(mu_);
+      // False after restoring a checkpoint that holds the buffered elements.
+      bool origins_known_ GUARDED_BY(mu_) = true;
     };
 
     const DatasetBase* const input_;
     const int64 buffer_size_;
     const int64 count_;
+    const string spill_directory_;
+    const bool replay_buffer_on_restore_;
   };
+
+  string spill_directory_;
+  bool replay_buffer_on_restore_;
 };
 
 class ShuffleDatasetOp : public ShuffleDatasetOpBase {
@@ -335,11 +654,13 @@ class ShuffleDatasetOp : public ShuffleDatasetOpBase {
 
     int64 count = 1;
     if (reshuffle_each_iteration_) {
-      *output =
-          new ReshufflingDataset(ctx, input, buffer_size, seed, seed2, count);
+      *output = new ReshufflingDataset(ctx, input, buffer_size, seed, seed2,
+                                       count, spill_directory_,
+                                       replay_buffer_on_restore_);
     } else {
-      *output =
-          new FixedSeedDataset(ctx, input, buffer_size, seed, seed2, count);
+      *output = new FixedSeedDataset(ctx, input, buffer_size, seed, seed2,
+                                     count, spill_directory_,
+                                     replay_buffer_on_restore_);
     }
   }
 
@@ -349,8 +670,11 @@ class ShuffleDatasetOp : public ShuffleDatasetOpBase {
   class ReshufflingDataset : public ShuffleDatasetBase {
    public:
     ReshufflingDataset(OpKernelContext* ctx, const DatasetBase* input,
-                       int64 buffer_size, int64 seed, int64 seed2, int64 count)
-        : ShuffleDatasetBase(ctx, input, buffer_size, count),
+                       int64 buffer_size, int64 seed, int64 seed2, int64 count,
+                       const string& spill_directory,
+                       bool replay_buffer_on_restore)
+        : ShuffleDatasetBase(ctx, input, buffer_size, count, spill_directory,
+                             replay_buffer_on_restore),
           seed_(seed),
           seed2_(seed2),
           parent_generator_(seed, seed2),
@@ -389,8 +713,11 @@ class ShuffleDatasetOp : public ShuffleDatasetOpBase {
   class FixedSeedDataset : public ShuffleDatasetBase {
    public:
     FixedSeedDataset(OpKernelContext* ctx, const DatasetBase* input,
-                     int64 buffer_size, int64 seed, int64 seed2, int64 count)
-        : ShuffleDatasetBase(ctx, input, buffer_size, count),
+                     int64 buffer_size, int64 seed, int64 seed2, int64 count,
+                     const string& spill_directory,
+                     bool replay_buffer_on_restore)
+        : ShuffleDatasetBase(ctx, input, buffer_size, count, spill_directory,
+                             replay_buffer_on_restore),
           seed_(seed),
           seed2_(seed) {}
 
@@ -414,15 +741,21 @@ class ShuffleDatasetOp : public ShuffleDatasetOpBase {
       Node* seed = nullptr;
       Node* seed2 = nullptr;
       AttrValue reshuffle_each_iteration;
+      AttrValue spill_directory;
+      AttrValue replay_buffer_on_restore;
 
       TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
       TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
       TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
       b->BuildAttrValue(false, &reshuffle_each_iteration);
+      b->BuildAttrValue(spill_directory_, &spill_directory);
+      b->BuildAttrValue(replay_buffer_on_restore_, &replay_buffer_on_restore);
       TF_RETURN_IF_ERROR(b->AddDataset(
           this, {input_graph_node, buffer_size, seed, seed2},  // Inputs
-          {std::make_pair("reshuffle_each_iteration",
-                          reshuffle_each_iteration)},  // Attrs
+          {std::make_pair("reshuffle_each_iteration", reshuffle_each_iteration),
+           std::make_pair("spill_directory", spill_directory),
+           std::make_pair("replay_buffer_on_restore",
+                          replay_buffer_on_restore)},  // Attrs
           output));
       return Status::OK();
     }
@@ -465,15 +798,18 @@ class ShuffleAndRepeatDatasetOp : public ShuffleDatasetOpBase {
       seed2 = random::New64();
     }
 
-    *output = new Dataset(ctx, input, buffer_size, seed, seed2, count);
+    *output = new Dataset(ctx, input, buffer_size, seed, seed2, count,
+                          spill_directory_, replay_buffer_on_restore_);
   }
 
  private:
   class Dataset : public ShuffleDatasetBase {
    public:
     Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
-            int64 seed, int64 seed2, int64 count)
-        : ShuffleDatasetBase(ctx, input, buffer_size, count),
+            int64 seed, int64 seed2, int64 count, const string& spill_directory,
+            bool replay_buffer_on_restore)
+        : ShuffleDatasetBase(ctx, input, buffer_size, count, spill_directory,
+                             replay_buffer_on_restore),
           seed_(seed),
           seed2_(seed2) {}
 
@@ -498,14 +834,20 @@ class ShuffleAndRepeatDatasetOp : public ShuffleDatasetOpBase {
       Node* seed = nullptr;
       Node* seed2 = nullptr;
       Node* count = nullptr;
+      AttrValue spill_directory;
+      AttrValue replay_buffer_on_restore;
 
       TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
       TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
       TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
       TF_RETURN_IF_ERROR(b->AddScalar(count_, &count));
+      b->BuildAttrValue(spill_directory_, &spill_directory);
+      b->BuildAttrValue(replay_buffer_on_restore_, &replay_buffer_on_restore);
       TF_RETURN_IF_ERROR(b->AddDataset(
           this, {input_graph_node, buffer_size, seed, seed2, count},  // Inputs
-          {},                                                         // Attrs
+          {std::make_pair("spill_directory", spill_directory),
+           std::make_pair("replay_buffer_on_restore",
+                          replay_buffer_on_restore)},  // Attrs
           output));
       return Status::OK();
     }
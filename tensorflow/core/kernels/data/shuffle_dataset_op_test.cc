@@ -0,0 +1,153 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/dataset_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+using test::dataset::AddConst;
+using test::dataset::AddIterator;
+using test::dataset::AddIteratorSaveAndRestore;
+using test::dataset::AddRange;
+using test::dataset::GetInt64Elements;
+
+const int64 kNumElements = 1000;
+
+// Range(kNumElements).shuffle(buffer_size, seed=1) with the given spill
+// directory, and ops to save and restore its iterator.
+GraphDef ShuffledRange(int64 buffer_size, const string& spill_directory,
+                       bool replay_buffer_on_restore = false) {
+  GraphDef graph;
+  const DataTypeVector types = {DT_INT64};
+  const std::vector<PartialTensorShape> shapes = {PartialTensorShape({})};
+  AddRange("range", 0, kNumElements, &graph);
+  AddConst("buffer_size", test::AsScalar<int64>(buffer_size), &graph);
+  AddConst("seed", test::AsScalar<int64>(1), &graph);
+  TF_CHECK_OK(NodeDefBuilder("shuffle", "ShuffleDataset")
+                  .Input("range", 0, DT_VARIANT)
+                  .Input("buffer_size", 0, DT_INT64)
+                  .Input("seed", 0, DT_INT64)
+                  .Input("seed", 0, DT_INT64)
+                  .Attr("output_types", types)
+                  .Attr("output_shapes", shapes)
+                  .Attr("spill_directory", spill_directory)
+                  .Attr("replay_buffer_on_restore", replay_buffer_on_restore)
+                  .Finalize(graph.add_node()));
+  AddIterator("shuffle", types, shapes, "", &graph);
+  AddIteratorSaveAndRestore(&graph);
+  return graph;
+}
+
+// Gets all the elements of a new iterator over the shuffled range.
+std::vector<int64> Iterate(int64 buffer_size, const string& spill_directory) {
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(ShuffledRange(buffer_size, spill_directory)));
+  TF_CHECK_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  std::vector<int64> elements =
+      GetInt64Elements(session.get(), kNumElements + 1);
+  TF_CHECK_OK(session->Close());
+  return elements;
+}
+
+// Gets "num_saved" elements of a new iterator, saves it, and gets the rest
+// of the elements from an iterator restored in another session. Returns
+// the size of the checkpoint in "*checkpoint_bytes".
+std::vector<int64> IterateWithCheckpoint(int64 buffer_size,
+                                         bool replay_buffer_on_restore,
+                                         int64 num_saved,
+                                         size_t* checkpoint_bytes) {
+  const GraphDef graph =
+      ShuffledRange(buffer_size, "", replay_buffer_on_restore);
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(graph));
+  TF_CHECK_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  std::vector<int64> elements = GetInt64Elements(session.get(), num_saved);
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({}, {"serialize:0"}, {}, &outputs));
+  const Tensor serialized = outputs[0];
+  TensorProto proto;
+  serialized.AsProtoTensorContent(&proto);
+  *checkpoint_bytes = proto.ByteSizeLong();
+  TF_CHECK_OK(session->Close());
+
+  session.reset(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(graph));
+  TF_CHECK_OK(session->Run({}, {}, {"make_iterator"}, nullptr));
+  TF_CHECK_OK(
+      session->Run({{"serialized", serialized}}, {}, {"deserialize"}, nullptr));
+  for (int64 element : GetInt64Elements(session.get(), kNumElements + 1)) {
+    elements.push_back(element);
+  }
+  TF_CHECK_OK(session->Close());
+  return elements;
+}
+
+TEST(ShuffleDatasetOpTest, SpilledBufferShufflesLikeInMemoryBuffer) {
+  Env* env = Env::Default();
+  const string spill_directory =
+      io::JoinPath(testing::TmpDir(), "shuffle_spill");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(spill_directory));
+
+  for (int64 buffer_size : {int64{1}, int64{10}, 2 * kNumElements}) {
+    const std::vector<int64> shuffled = Iterate(buffer_size, spill_directory);
+    EXPECT_EQ(Iterate(buffer_size, ""), shuffled);
+    std::vector<int64> sorted = shuffled;
+    std::sort(sorted.begin(), sorted.end());
+    ASSERT_EQ(kNumElements, static_cast<int64>(sorted.size()));
+    for (int64 i = 0; i < kNumElements; ++i) EXPECT_EQ(i, sorted[i]);
+
+    // The files of the buffer are deleted with the iterator.
+    std::vector<string> children;
+    TF_ASSERT_OK(env->GetChildren(spill_directory, &children));
+    EXPECT_TRUE(children.empty());
+  }
+}
+
+TEST(ShuffleDatasetOpTest, ReplayedBufferIsRestored) {
+  const int64 buffer_size = 100;
+  const std::vector<int64> expected = Iterate(buffer_size, "");
+  size_t replay_bytes;
+  for (int64 num_saved : {int64{0}, int64{950}, kNumElements}) {
+    EXPECT_EQ(expected, IterateWithCheckpoint(buffer_size, true, num_saved,
+                                              &replay_bytes));
+  }
+
+  // The checkpoint only holds the positions of the buffered elements.
+  size_t buffer_bytes;
+  EXPECT_EQ(expected,
+            IterateWithCheckpoint(buffer_size, false, 150, &buffer_bytes));
+  EXPECT_EQ(expected,
+            IterateWithCheckpoint(buffer_size, true, 150, &replay_bytes));
+  EXPECT_LT(replay_bytes, buffer_bytes);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -47,8 +47,43 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
   }
 }
 
+void FIFOQueue::DequeueManyLocked(OpKernelContext* ctx, int64 num_elements,
+                                  int64 index, Tuple* batch, Status* status) {
+  DCHECK_GE(queues_[0].size(), static_cast<size_t>(num_elements));
+  for (int i = 0; i < num_components(); ++i) {
+    std::deque<PersistentTensor>& queue = queues_[i];
+    for (int64 j = 0; j < num_elements && status->ok(); ++j) {
+      status->Update(batch_util::CopyElementToSlice(
+          *queue[j].AccessTensor(ctx), &(*batch)[i], index + j));
+    }
+    queue.erase(queue.begin(), queue.begin() + num_elements);
+  }
+}
+
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
+  // When no enqueue is waiting and there is room, the element is enqueued
+  // without registering an attempt and a cancellation callback, which takes
+  // mu_ once instead of several times.
+  bool enqueued = false;
+  bool flush = false;
+  {
+    mutex_lock l(mu_);
+    if (enqueue_attempts_.empty() && !closed_ &&
+        queues_[0].size() < static_cast<size_t>(capacity_)) {
+      for (int i = 0; i < num_components(); ++i) {
+        queues_[i].push_back(PersistentTensor(tuple[i]));
+      }
+      enqueued = true;
+      flush = !dequeue_attempts_.empty();
+    }
+  }
+  if (enqueued) {
+    if (flush) FlushUnlocked();
+    callback();
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -153,6 +188,25 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 }
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
+  // As in TryEnqueue(), an element is dequeued right away when no dequeue
+  // is waiting.
+  bool dequeued = false;
+  bool flush = false;
+  Tuple tuple;
+  {
+    mutex_lock l(mu_);
+    if (dequeue_attempts_.empty() && !queues_[0].empty()) {
+      DequeueLocked(ctx, &tuple);
+      dequeued = true;
+      flush = !enqueue_attempts_.empty();
+    }
+  }
+  if (dequeued) {
+    if (flush) FlushUnlocked();
+    callback(tuple);
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -244,6 +298,42 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
     return;
   }
 
+  // When no dequeue is waiting and the queue holds enough elements, they are
+  // all copied to the batch at once.
+  {
+    Tuple tuple;
+    bool dequeued = false;
+    bool flush = false;
+    {
+      mutex_lock l(mu_);
+      if (dequeue_attempts_.empty() &&
+          queues_[0].size() >= static_cast<size_t>(num_elements)) {
+        Status status;
+        tuple.reserve(num_components());
+        for (int i = 0; i < num_components() && status.ok(); ++i) {
+          Tensor element;
+          status = ctx->allocate_temp(component_dtypes_[i],
+                                      ManyOutShape(i, num_elements), &element);
+          tuple.emplace_back(element);
+        }
+        if (status.ok()) {
+          DequeueManyLocked(ctx, num_elements, 0, &tuple, &status);
+        }
+        if (!status.ok()) {
+          ctx->SetStatus(status);
+          tuple.clear();
+        }
+        dequeued = true;
+        flush = !enqueue_attempts_.empty();
+      }
+    }
+    if (dequeued) {
+      if (flush) FlushUnlocked();
+      callback(tuple);
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -306,44 +396,43 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
               }
             }
 
-            RunResult result = kNoProgress;
-            for (; queue_size > 0; --queue_size) {
-              if (attempt->tuple.empty()) {
-                // Only allocate tuple when we have something to dequeue
-                // so we don't use excessive memory when there are many
-                // blocked dequeue attempts waiting.
-                attempt->tuple.reserve(num_components());
-                for (int i = 0; i < num_components(); ++i) {
-                  const TensorShape shape =
-                      ManyOutShape(i, attempt->elements_requested);
-                  Tensor element;
-                  attempt->context->SetStatus(attempt->context->allocate_temp(
-                      component_dtypes_[i], shape, &element));
-                  if (!attempt->context->status().ok()) return kComplete;
-                  attempt->tuple.emplace_back(element);
-                }
-              }
-              result = kProgress;
-              Tuple tuple;
-              DequeueLocked(attempt->context, &tuple);
-              const int64 index =
-                  attempt->tuple[0].dim_size(0) - attempt->elements_requested;
+            if (queue_size == 0) return kNoProgress;
+            if (attempt->tuple.empty()) {
+              // Only allocate tuple when we have something to dequeue
+              // so we don't use excessive memory when there are many
+              // blocked dequeue attempts waiting.
+              attempt->tuple.reserve(num_components());
               for (int i = 0; i < num_components(); ++i) {
-                attempt->context->SetStatus(batch_util::CopyElementToSlice(
-                    std::move(tuple[i]), &attempt->tuple[i], index));
+                const TensorShape shape =
+                    ManyOutShape(i, attempt->elements_requested);
+                Tensor element;
+                attempt->context->SetStatus(attempt->context->allocate_temp(
+                    component_dtypes_[i], shape, &element));
                 if (!attempt->context->status().ok()) return kComplete;
-              }
-              tuple.clear();
-              --attempt->elements_requested;
-              if (attempt->elements_requested == 0) {
-                tuple = attempt->tuple;
-                attempt->done_callback = [callback, tuple]() {
-                  callback(tuple);
-                };
-                return kComplete;
+                attempt->tuple.emplace_back(element);
               }
             }
-            return result;
+            // Copies all the available elements that were requested.
+            const int64 num_dequeued =
+                std::min<int64>(queue_size, attempt->elements_requested);
+            const int64 index =
+                attempt->tuple[0].dim_size(0) - attempt->elements_requested;
+            Status status;
+            DequeueManyLocked(attempt->context, num_dequeued, index,
+                              &attempt->tuple, &status);
+            if (!status.ok()) {
+              attempt->context->SetStatus(status);
+              return kComplete;
+            }
+            attempt->elements_requested -= num_dequeued;
+            if (attempt->elements_requested == 0) {
+              Tuple tuple = attempt->tuple;
+              attempt->done_callback = [callback, tuple]() {
+                callback(tuple);
+              };
+              return kComplete;
+            }
+            return kProgress;
           });
     }
   }
@@ -60,6 +60,13 @@ class FIFOQueue : public TypedQueue<std::deque<PersistentTensor> > {
   void DequeueLocked(OpKernelContext* ctx, Tuple* tuple)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Helper for dequeuing the first `num_elements` elements of queues_ into
+  // the slices of the tensors of `batch` that start at `index`. The elements
+  // are removed from queues_ even if a copy fails.
+  void DequeueManyLocked(OpKernelContext* ctx, int64 num_elements, int64 index,
+                         Tuple* batch, Status* status)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   static Status GetElementComponentFromBatch(const Tuple& tuple, int64 index,
                                              int component,
                                              OpKernelContext* ctx,
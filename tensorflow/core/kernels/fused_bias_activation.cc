@@ -0,0 +1,36 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/fused_bias_activation.h"
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+Status FusedActivationFromString(const string& name,
+                                 FusedActivation* activation) {
+  if (name == "Identity") {
+    *activation = FusedActivation::kIdentity;
+  } else if (name == "Relu") {
+    *activation = FusedActivation::kRelu;
+  } else if (name == "Relu6") {
+    *activation = FusedActivation::kRelu6;
+  } else {
+    return errors::InvalidArgument("Unsupported fused activation: ", name);
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
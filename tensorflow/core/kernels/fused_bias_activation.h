@@ -0,0 +1,88 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_BIAS_ACTIVATION_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_BIAS_ACTIVATION_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// The activation applied by the fused kernels (_FusedConv2D, _FusedMatMul)
+// after adding the bias.
+enum class FusedActivation {
+  kIdentity,
+  kRelu,
+  kRelu6,
+};
+
+// Parses the "activation" attribute of the fused kernels.
+Status FusedActivationFromString(const string& name,
+                                 FusedActivation* activation);
+
+namespace functor {
+
+// Adds 'bias' to the channels of 'output' and applies 'activation', in place
+// and in a single pass over 'output'. 'output' is viewed as
+// [outer, channels, inner], e.g. [N*H*W, C, 1] for NHWC, [N, C, H*W] for
+// NCHW and [M, N, 1] for a matrix product.
+template <typename Device, typename T>
+struct BiasActivation {
+  void operator()(const Device& d, FusedActivation activation,
+                  typename TTypes<T>::ConstVec bias,
+                  typename TTypes<T, 3>::Tensor output) {
+    const Eigen::Index outer = output.dimension(0);
+    const Eigen::Index channels = output.dimension(1);
+    const Eigen::Index inner = output.dimension(2);
+    if (inner == 1) {
+      Eigen::DSizes<Eigen::Index, 2> shape(outer, channels);
+      Eigen::DSizes<Eigen::Index, 2> bias_shape(1, channels);
+      Eigen::array<Eigen::Index, 2> broadcast = {{outer, 1}};
+      Apply(d, activation, output.reshape(shape),
+            bias.reshape(bias_shape).broadcast(broadcast));
+    } else {
+      Eigen::DSizes<Eigen::Index, 3> bias_shape(1, channels, 1);
+      Eigen::array<Eigen::Index, 3> broadcast = {{outer, 1, inner}};
+      Apply(d, activation, output,
+            bias.reshape(bias_shape).broadcast(broadcast));
+    }
+  }
+
+ private:
+  template <typename Output, typename Bias>
+  static void Apply(const Device& d, FusedActivation activation, Output output,
+                    const Bias& bias) {
+    switch (activation) {
+      case FusedActivation::kIdentity:
+        output.device(d) = output + bias;
+        break;
+      case FusedActivation::kRelu:
+        output.device(d) = (output + bias).cwiseMax(static_cast<T>(0));
+        break;
+      case FusedActivation::kRelu6:
+        output.device(d) = (output + bias)
+                               .cwiseMax(static_cast<T>(0))
+                               .cwiseMin(static_cast<T>(6));
+        break;
+    }
+  }
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_BIAS_ACTIVATION_H_
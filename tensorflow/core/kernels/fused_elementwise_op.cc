@@ -0,0 +1,325 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class Opcode {
+  // Unary.
+  kAbs,
+  kExp,
+  kLog,
+  kNeg,
+  kRelu,
+  kRelu6,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+  // Binary.
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMaximum,
+  kMinimum,
+  kSquaredDifference,
+};
+
+bool IsUnary(Opcode op) { return op < Opcode::kAdd; }
+
+const std::unordered_map<string, Opcode>& OpcodesByName() {
+  static const auto* opcodes = new std::unordered_map<string, Opcode>({
+      {"Abs", Opcode::kAbs},
+      {"Exp", Opcode::kExp},
+      {"Log", Opcode::kLog},
+      {"Neg", Opcode::kNeg},
+      {"Relu", Opcode::kRelu},
+      {"Relu6", Opcode::kRelu6},
+      {"Rsqrt", Opcode::kRsqrt},
+      {"Sigmoid", Opcode::kSigmoid},
+      {"Sqrt", Opcode::kSqrt},
+      {"Square", Opcode::kSquare},
+      {"Tanh", Opcode::kTanh},
+      {"Add", Opcode::kAdd},
+      {"Sub", Opcode::kSub},
+      {"Mul", Opcode::kMul},
+      {"Div", Opcode::kDiv},
+      {"RealDiv", Opcode::kDiv},
+      {"Maximum", Opcode::kMaximum},
+      {"Minimum", Opcode::kMinimum},
+      {"SquaredDifference", Opcode::kSquaredDifference},
+  });
+  return *opcodes;
+}
+
+// How an input is broadcast to the shape of the output.
+enum class Broadcast {
+  kNone,    // Same number of elements as the output.
+  kScalar,  // A single element.
+  kRow,     // A vector along the innermost dimension of the output.
+};
+
+}  // namespace
+
+// Evaluates a chain of elementwise ops fused by the grappler Remapper.
+//
+// Rather than materializing every intermediate result, the output is
+// computed one block of kBlockSize elements at a time: each op of the
+// program is evaluated as an Eigen expression into a per-block scratch
+// buffer that stays in cache, and only the result of the last op is written
+// to the output.
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  static constexpr int64 kBlockSize = 1024;
+
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> ops;
+    OP_REQUIRES_OK(context, context->GetAttr("ops", &ops));
+    OP_REQUIRES_OK(context, context->GetAttr("operands", &operands_));
+    OP_REQUIRES(context, !ops.empty(),
+                errors::InvalidArgument("ops must not be empty"));
+    OP_REQUIRES(context, operands_.size() == 2 * ops.size(),
+                errors::InvalidArgument(
+                    "operands must have two entries per op, got ",
+                    operands_.size(), " for ", ops.size(), " ops"));
+    const int num_inputs = context->num_inputs();
+    for (int i = 0; i < ops.size(); ++i) {
+      const Opcode* op = gtl::FindOrNull(OpcodesByName(), ops[i]);
+      OP_REQUIRES(context, op != nullptr,
+                  errors::InvalidArgument("Unsupported elementwise op: ",
+                                          ops[i]));
+      opcodes_.push_back(*op);
+      const int num_operands = IsUnary(*op) ? 1 : 2;
+      for (int j = 0; j < 2; ++j) {
+        const int operand = operands_[2 * i + j];
+        if (j < num_operands) {
+          OP_REQUIRES(context, operand >= 0 && operand < num_inputs + i,
+                      errors::InvalidArgument("Operand ", j, " of op ", i,
+                                              " (", ops[i],
+                                              ") is out of range: ", operand));
+        } else {
+          OP_REQUIRES(context, operand == -1,
+                      errors::InvalidArgument("Unary op ", i, " (", ops[i],
+                                              ") must have -1 as its second "
+                                              "operand, got ",
+                                              operand));
+        }
+      }
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const TensorShape& shape = context->input(0).shape();
+    const int64 num_elements = shape.num_elements();
+    const int64 row_size = shape.dims() > 0 ? shape.dim_size(shape.dims() - 1)
+                                            : 1;
+    const int num_inputs = context->num_inputs();
+    std::vector<Broadcast> broadcast(num_inputs);
+    for (int i = 0; i < num_inputs; ++i) {
+      const Tensor& input = context->input(i);
+      if (input.NumElements() == num_elements) {
+        broadcast[i] = Broadcast::kNone;
+      } else if (input.NumElements() == 1) {
+        broadcast[i] = Broadcast::kScalar;
+      } else if (input.dims() > 0 && input.NumElements() == row_size &&
+                 input.dim_size(input.dims() - 1) == row_size) {
+        broadcast[i] = Broadcast::kRow;
+      } else {
+        context->SetStatus(errors::InvalidArgument(
+            "Input ", i, " of shape ", input.shape().DebugString(),
+            " cannot be broadcast to ", shape.DebugString()));
+        return;
+      }
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, shape, &output));
+    if (num_elements == 0) return;
+    T* output_data = output->flat<T>().data();
+
+    // Input 0 may be forwarded to the output. Each block of it is read
+    // before the same block of the output is written, so this is safe.
+    auto work = [this, context, &broadcast, num_elements, row_size,
+                 output_data](int64 begin_block, int64 end_block) {
+      const int num_inputs = context->num_inputs();
+      const int num_ops = opcodes_.size();
+      // One scratch block per op, and one per broadcast input.
+      std::vector<T> scratch((num_ops + num_inputs) * kBlockSize);
+      auto register_data = [&scratch](int r) {
+        return scratch.data() + r * kBlockSize;
+      };
+      for (int i = 0; i < num_inputs; ++i) {
+        if (broadcast[i] == Broadcast::kScalar) {
+          std::fill_n(register_data(num_ops + i), kBlockSize,
+                      context->input(i).flat<T>()(0));
+        }
+      }
+      for (int64 block = begin_block; block < end_block; ++block) {
+        const int64 begin = block * kBlockSize;
+        const int64 size = std::min(kBlockSize, num_elements - begin);
+        for (int i = 0; i < num_inputs; ++i) {
+          if (broadcast[i] == Broadcast::kRow) {
+            const T* row = context->input(i).flat<T>().data();
+            T* data = register_data(num_ops + i);
+            for (int64 j = 0; j < size; ++j) {
+              data[j] = row[(begin + j) % row_size];
+            }
+          }
+        }
+        auto operand = [&](int index) {
+          const T* data;
+          if (index >= num_inputs) {
+            data = register_data(index - num_inputs);
+          } else if (broadcast[index] == Broadcast::kNone) {
+            data = context->input(index).flat<T>().data() + begin;
+          } else {
+            data = register_data(num_ops + index);
+          }
+          return typename TTypes<T>::UnalignedConstFlat(data, size);
+        };
+        for (int i = 0; i < num_ops; ++i) {
+          typename TTypes<T>::UnalignedFlat out(
+              i == num_ops - 1 ? output_data + begin : register_data(i), size);
+          auto x = operand(operands_[2 * i]);
+          if (IsUnary(opcodes_[i])) {
+            EvaluateUnary(opcodes_[i], x, out);
+          } else {
+            EvaluateBinary(opcodes_[i], x, operand(operands_[2 * i + 1]), out);
+          }
+        }
+      }
+    };
+    const int64 num_blocks = (num_elements + kBlockSize - 1) / kBlockSize;
+    const int64 cost_per_block = kBlockSize * opcodes_.size() * 10;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          cost_per_block, work);
+  }
+
+ private:
+  static void EvaluateUnary(Opcode op, typename TTypes<T>::UnalignedConstFlat x,
+                            typename TTypes<T>::UnalignedFlat out) {
+    switch (op) {
+      case Opcode::kAbs:
+        out = x.abs();
+        break;
+      case Opcode::kExp:
+        out = x.exp();
+        break;
+      case Opcode::kLog:
+        out = x.log();
+        break;
+      case Opcode::kNeg:
+        out = -x;
+        break;
+      case Opcode::kRelu:
+        out = x.cwiseMax(static_cast<T>(0));
+        break;
+      case Opcode::kRelu6:
+        out = x.cwiseMax(static_cast<T>(0)).cwiseMin(static_cast<T>(6));
+        break;
+      case Opcode::kRsqrt:
+        out = x.rsqrt();
+        break;
+      case Opcode::kSigmoid:
+        out = x.sigmoid();
+        break;
+      case Opcode::kSqrt:
+        out = x.sqrt();
+        break;
+      case Opcode::kSquare:
+        out = x.square();
+        break;
+      case Opcode::kTanh:
+        out = x.tanh();
+        break;
+      default:
+        LOG(FATAL) << "Not a unary op: " << static_cast<int>(op);
+    }
+  }
+
+  static void EvaluateBinary(Opcode op,
+                             typename TTypes<T>::UnalignedConstFlat x,
+                             typename TTypes<T>::UnalignedConstFlat y,
+                             typename TTypes<T>::UnalignedFlat out) {
+    switch (op) {
+      case Opcode::kAdd:
+        out = x + y;
+        break;
+      case Opcode::kSub:
+        out = x - y;
+        break;
+      case Opcode::kMul:
+        out = x * y;
+        break;
+      case Opcode::kDiv:
+        out = x / y;
+        break;
+      case Opcode::kMaximum:
+        out = x.cwiseMax(y);
+        break;
+      case Opcode::kMinimum:
+        out = x.cwiseMin(y);
+        break;
+      case Opcode::kSquaredDifference:
+        out = (x - y).square();
+        break;
+      default:
+        LOG(FATAL) << "Not a binary op: " << static_cast<int>(op);
+    }
+  }
+
+  std::vector<Opcode> opcodes_;
+  // Two per op; see the op's documentation.
+  std::vector<int32> operands_;
+};
+
+template <typename T>
+constexpr int64 FusedElementwiseOp<T>::kBlockSize;
+
+#define REGISTER_CPU(T)                                     \
+  REGISTER_KERNEL_BUILDER(Name("_FusedElementwise")         \
+                              .Device(DEVICE_CPU)           \
+                              .TypeConstraint<T>("T"),      \
+                          FusedElementwiseOp<T>);
+
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_double(REGISTER_CPU);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,95 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int num_inputs, const std::vector<string>& ops,
+                const std::vector<int>& operands) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedElementwise")
+                           .Input(FakeInput(num_inputs, DT_FLOAT))
+                           .Attr("ops", ops)
+                           .Attr("operands", operands)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, Broadcasts) {
+  // tanh(x * s + b) with a scalar s and a row vector b.
+  TF_ASSERT_OK(MakeOp(3, {"Mul", "Add", "Tanh"}, {0, 1, 3, 2, 4, -1}));
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({}), {0.5f});
+  AddInputFromArray<float>(TensorShape({3}), {-1, 0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(
+      &expected, {std::tanh(-0.5f), std::tanh(1.0f), std::tanh(2.5f),
+                  std::tanh(1.0f), std::tanh(2.5f), std::tanh(4.0f)});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(FusedElementwiseOpTest, SpansBlocks) {
+  // relu(x - y)^2 over several blocks, with a partial last block.
+  TF_ASSERT_OK(MakeOp(2, {"Sub", "Relu", "Square"}, {0, 1, 2, -1, 3, -1}));
+  const int n = 3000;
+  std::vector<float> x(n), y(n), z(n);
+  for (int i = 0; i < n; ++i) {
+    x[i] = i % 7;
+    y[i] = i % 5;
+    z[i] = std::max(0.0f, x[i] - y[i]) * std::max(0.0f, x[i] - y[i]);
+  }
+  AddInputFromArray<float>(TensorShape({n}), x);
+  AddInputFromArray<float>(TensorShape({n}), y);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({n}));
+  test::FillValues<float>(&expected, z);
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, InvalidPrograms) {
+  // Op 0 cannot refer to its own result.
+  EXPECT_FALSE(MakeOp(1, {"Neg", "Exp"}, {1, -1, 1, -1}).ok());
+  // Unary ops have no second operand.
+  EXPECT_FALSE(MakeOp(2, {"Exp", "Neg"}, {0, 1, 2, -1}).ok());
+  EXPECT_FALSE(MakeOp(1, {"Cos"}, {0, -1}).ok());
+  EXPECT_FALSE(MakeOp(1, {"Neg"}, {0}).ok());
+}
+
+TEST_F(FusedElementwiseOpTest, IncompatibleShapes) {
+  TF_ASSERT_OK(MakeOp(2, {"Add", "Exp"}, {0, 1, 2, -1}));
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
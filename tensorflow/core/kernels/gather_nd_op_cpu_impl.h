@@ -21,14 +21,17 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <atomic>
+#include <cstring>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/gather_nd_op.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
 
@@ -36,61 +39,6 @@ namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
-namespace generator {
-
-template <typename T, typename Index, int IXDIM>
-class GatherNdSliceGenerator {
- public:
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE GatherNdSliceGenerator(
-      const Index slice_size, typename TTypes<Index>::ConstMatrix Tindices,
-      typename TTypes<T, IXDIM + 1>::ConstTensor Tparams,
-      typename TTypes<T>::Matrix Tout, std::atomic<Index>* error_loc)
-      : slice_size_(slice_size),
-        Tindices_(Tindices),
-        Tparams_(Tparams),
-        Tout_(Tout),
-        error_loc_(error_loc) {}
-
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE bool GenerateIndices(
-      const Index loc, Eigen::array<Eigen::DenseIndex, IXDIM + 1>* ix) const {
-    (*ix)[IXDIM] = 0;
-    bool out_of_bounds = false;
-    for (int i = 0; i < IXDIM; ++i) {
-      const Index ix_i = internal::SubtleMustCopy(Tindices_(loc, i));
-      (*ix)[i] = ix_i;
-      out_of_bounds |= !FastBoundsCheck(ix_i, Tparams_.dimension(i));
-    }
-    return out_of_bounds;
-  }
-
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE int32
-  operator()(const Eigen::array<Eigen::DenseIndex, 1>& loc_array) const {
-    const Index loc = loc_array[0];
-    Eigen::array<Eigen::DenseIndex, IXDIM + 1> ix;
-    Eigen::array<Eigen::DenseIndex, 2> ix_out;
-    ix_out[0] = loc;
-    ix_out[1] = 0;
-    const bool out_of_bounds = GenerateIndices(loc, &ix);
-    if (TF_PREDICT_FALSE(out_of_bounds)) {
-      error_loc_->store(loc);
-      std::fill_n(&Tout_(ix_out), slice_size_, T());
-    } else {
-      std::copy_n(&Tparams_(ix), slice_size_, &Tout_(ix_out));
-    }
-
-    return static_cast<int32>(0);  // Return something...
-  }
-
- private:
-  const Index slice_size_;
-  const typename TTypes<Index>::ConstMatrix Tindices_;
-  const typename TTypes<T, IXDIM + 1>::ConstTensor Tparams_;
-  mutable typename TTypes<T>::Matrix Tout_;
-  std::atomic<Index>* error_loc_;
-};
-
-}  // namespace generator
-
 namespace functor {
 
 template <typename T, typename Index, int IXDIM>
@@ -103,20 +51,52 @@ struct GatherNdSlice<CPUDevice, T, Index, IXDIM> {
     std::atomic<Index> error_loc(-1);
 
     const Eigen::DenseIndex batch_size = Tindices.dimension(0);
-#if !defined(EIGEN_HAS_INDEX_LIST)
-    Eigen::Tensor<Eigen::DenseIndex, 1>::Dimensions reshape_dims{{ 1 }};
-    Eigen::array<Eigen::DenseIndex, 1> broadcast_dims{{ batch_size }};
-#else
-    Eigen::IndexList<Eigen::type2index<1> > reshape_dims;
-    Eigen::IndexList<Eigen::DenseIndex> broadcast_dims;
-    broadcast_dims.set(0, batch_size);
-#endif
-    generator::GatherNdSliceGenerator<T, Index, IXDIM> gather_nd_generator(
-        slice_size, Tindices, Tparams, Tout, &error_loc);
-    Tscratch.device(d) = Tscratch.reshape(reshape_dims)
-                             .broadcast(broadcast_dims)
-                             .generate(gather_nd_generator)
-                             .sum();
+    const T* params_base = Tparams.data();
+    T* out_base = Tout.data();
+
+    // Sets *offset to the offset in Tparams of the slice that index loc
+    // refers to, and returns false if the index is out of bounds.
+    auto slice_offset = [&](Eigen::DenseIndex loc, Index* offset) {
+      bool in_bounds = true;
+      Index o = 0;
+      for (int i = 0; i < IXDIM; ++i) {
+        const Index ix_i = internal::SubtleMustCopy(Tindices(loc, i));
+        in_bounds &= FastBoundsCheck(ix_i, Tparams.dimension(i));
+        o = o * Tparams.dimension(i) + ix_i;
+      }
+      *offset = o * slice_size;
+      return in_bounds;
+    };
+
+    auto work = [&](int64 begin, int64 end) {
+      if (begin >= end) return;
+      Index next_offset;
+      bool next_in_bounds = slice_offset(begin, &next_offset);
+      for (int64 loc = begin; loc < end; ++loc) {
+        const Index offset = next_offset;
+        const bool in_bounds = next_in_bounds;
+        if (loc + 1 < end) {
+          next_in_bounds = slice_offset(loc + 1, &next_offset);
+          if (next_in_bounds) {
+            port::prefetch<port::PREFETCH_HINT_T0>(params_base + next_offset);
+          }
+        }
+        T* out = out_base + loc * slice_size;
+        if (TF_PREDICT_FALSE(!in_bounds)) {
+          error_loc.store(loc);
+          std::fill_n(out, slice_size, T());
+        } else if (is_simple_type<T>::value) {
+          memcpy(out, params_base + offset, slice_size * sizeof(T));
+        } else {
+          std::copy_n(params_base + offset, slice_size, out);
+        }
+      }
+    };
+    const double slice_bytes = static_cast<double>(slice_size * sizeof(T));
+    d.parallelFor(batch_size,
+                  Eigen::TensorOpCost(slice_bytes + IXDIM * sizeof(Index),
+                                      slice_bytes, 2 * IXDIM),
+                  work);
 
     // error_loc() returns -1 if there's no out-of-bounds index,
     // otherwise it returns the location of an OOB index in Tindices.
@@ -0,0 +1,156 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/kernels/gpu_utils.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Describes the GPUs of this process and the cuDNN version, on which cached
+// autotune results are only valid.
+string AutotuneCacheFingerprint() {
+  auto platform = se::MultiPlatformManager::PlatformWithName("CUDA");
+  if (!platform.ok()) return "";
+  string fingerprint;
+  for (int i = 0; i < platform.ValueOrDie()->VisibleDeviceCount(); ++i) {
+    auto exec = platform.ValueOrDie()->ExecutorForDevice(i);
+    if (!exec.ok()) return "";
+    const se::DeviceDescription& desc =
+        exec.ValueOrDie()->GetDeviceDescription();
+    strings::StrAppend(&fingerprint, "gpu ", i, ": ", desc.name(),
+                       ", driver ", desc.driver_version(), "; ");
+    if (i == 0 && exec.ValueOrDie()->AsDnn() != nullptr) {
+      auto version = exec.ValueOrDie()->AsDnn()->GetVersion();
+      if (version.ok()) {
+        se::dnn::VersionInfo info = version.ValueOrDie();
+        strings::StrAppend(&fingerprint, "cudnn ", info.major_version(), ".",
+                           info.minor_version(), ".", info.patch(), "; ");
+      }
+    }
+  }
+  return fingerprint;
+}
+
+string AutotuneCachePath(const string& name) {
+  return io::JoinPath(getenv("TF_AUTOTUNE_CACHE_DIR"), name);
+}
+
+bool AlgorithmDescFromString(StringPiece s, se::dnn::AlgorithmDesc* desc) {
+  std::vector<string> parts = str_util::Split(s, ':');
+  int64 algo_id;
+  int32 tensor_ops_enabled;
+  if (parts.size() != 2 || !strings::safe_strto64(parts[0], &algo_id) ||
+      !strings::safe_strto32(parts[1], &tensor_ops_enabled)) {
+    return false;
+  }
+  *desc = se::dnn::AlgorithmDesc(algo_id, tensor_ops_enabled != 0);
+  return true;
+}
+
+}  // namespace
+
+bool AutotuneCacheEnabled() {
+  static const bool enabled = [] {
+    const char* dir = getenv("TF_AUTOTUNE_CACHE_DIR");
+    return dir != nullptr && dir[0] != '\0';
+  }();
+  return enabled;
+}
+
+std::unordered_map<string, string> ReadAutotuneCache(const string& name) {
+  std::unordered_map<string, string> entries;
+  const string path = AutotuneCachePath(name);
+  string contents;
+  if (!Env::Default()->FileExists(path).ok() ||
+      !ReadFileToString(Env::Default(), path, &contents).ok()) {
+    return entries;
+  }
+  std::vector<string> lines = str_util::Split(contents, '\n');
+  if (lines.empty() || lines[0] != AutotuneCacheFingerprint()) {
+    LOG(INFO) << "Ignoring autotune cache " << path
+              << " written for different devices";
+    return entries;
+  }
+  for (int i = 1; i < lines.size(); ++i) {
+    std::vector<string> fields = str_util::Split(lines[i], '\t');
+    if (fields.size() == 2) entries[fields[0]] = fields[1];
+  }
+  VLOG(1) << "Read " << entries.size() << " entries from autotune cache "
+          << path;
+  return entries;
+}
+
+void WriteAutotuneCache(const string& name,
+                        const std::unordered_map<string, string>& entries) {
+  string contents = AutotuneCacheFingerprint();
+  for (const auto& entry : entries) {
+    strings::StrAppend(&contents, "\n", entry.first, "\t", entry.second);
+  }
+  // Write to a temporary file first, so that other processes never read a
+  // partially written cache.
+  const string path = AutotuneCachePath(name);
+  const string tmp_path =
+      strings::StrCat(path, ".tmp.", Env::Default()->NowMicros());
+  Status s = WriteStringToFile(Env::Default(), tmp_path, contents);
+  if (s.ok()) s = Env::Default()->RenameFile(tmp_path, path);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write autotune cache " << path << ": " << s;
+  }
+}
+
+string AutotuneConfigToString(const se::dnn::AlgorithmConfig& config) {
+  return strings::StrCat(config.algorithm().algo_id(), ":",
+                         config.algorithm().tensor_ops_enabled(), ",",
+                         config.algorithm_no_scratch().algo_id(), ":",
+                         config.algorithm_no_scratch().tensor_ops_enabled());
+}
+
+bool AutotuneConfigFromString(StringPiece s,
+                              se::dnn::AlgorithmConfig* config) {
+  std::vector<string> parts = str_util::Split(s, ',');
+  se::dnn::AlgorithmDesc algorithm;
+  se::dnn::AlgorithmDesc algorithm_no_scratch;
+  if (parts.size() != 2 || !AlgorithmDescFromString(parts[0], &algorithm) ||
+      !AlgorithmDescFromString(parts[1], &algorithm_no_scratch)) {
+    return false;
+  }
+  *config = se::dnn::AlgorithmConfig(algorithm, algorithm_no_scratch);
+  return true;
+}
+
+string AutotuneConfigToString(const se::blas::AlgorithmConfig& config) {
+  return strings::StrCat(config.algorithm());
+}
+
+bool AutotuneConfigFromString(StringPiece s,
+                              se::blas::AlgorithmConfig* config) {
+  int64 algorithm;
+  if (!strings::safe_strto64(s, &algorithm)) return false;
+  *config = se::blas::AlgorithmConfig(algorithm);
+  return true;
+}
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
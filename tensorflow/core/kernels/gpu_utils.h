@@ -35,6 +35,29 @@ inline se::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
   return typed;
 }
 
+// Autotune results can be kept across processes by setting the
+// TF_AUTOTUNE_CACHE_DIR environment variable to a directory. Every AutoTuneMap
+// then writes the configs it accepts to a file named after it in that
+// directory, along with a fingerprint of the GPUs, their driver and the cuDNN
+// version, and starts from the configs in that file if the fingerprint
+// matches the current process.
+bool AutotuneCacheEnabled();
+
+// Returns the entries of the cache file for the AutoTuneMap 'name', mapping
+// the ToString() of each parameters to a config serialized with
+// AutotuneConfigToString(). Returns no entries if the file is missing or
+// was written for other devices.
+std::unordered_map<string, string> ReadAutotuneCache(const string& name);
+
+// Replaces the cache file for the AutoTuneMap 'name' with 'entries'.
+void WriteAutotuneCache(const string& name,
+                        const std::unordered_map<string, string>& entries);
+
+string AutotuneConfigToString(const se::dnn::AlgorithmConfig& config);
+bool AutotuneConfigFromString(StringPiece s, se::dnn::AlgorithmConfig* config);
+string AutotuneConfigToString(const se::blas::AlgorithmConfig& config);
+bool AutotuneConfigFromString(StringPiece s, se::blas::AlgorithmConfig* config);
+
 // A helper class that looks up the best autotuned config from parameters.
 // Due to the noisy nature of autotune, especially with multiple devices, it
 // only accepts a config if its margin exceeds a threshold.
@@ -48,9 +71,21 @@ inline se::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
 template <typename Parameters, typename Config>
 class AutoTuneMap {
  public:
-  bool Find(const Parameters& params, Config* config) const {
+  bool Find(const Parameters& params, Config* config) {
     mutex_lock lock(mu_);
     auto iter = params_config_map_.find(params);
+    if (iter == params_config_map_.end() && !cached_configs_.empty()) {
+      // Accept the config of an earlier process right away.
+      auto cached = cached_configs_.find(params.ToString());
+      if (cached != cached_configs_.end()) {
+        VLOG(1) << GetActionSummary("loads", params, cached->second);
+        iter = params_config_map_
+                   .insert(std::make_pair(
+                       params, ValueType{cached->second, min_score_threshold_,
+                                         1}))
+                   .first;
+      }
+    }
     if (iter == params_config_map_.end() ||
         (iter->second.score < min_score_threshold_ &&
          iter->second.count <= max_autotune_count_)) {
@@ -90,6 +125,14 @@ class AutoTuneMap {
     }
     if (new_score >= min_score_threshold_) {
       VLOG(1) << GetActionSummary("accepts", params, config);
+      if (AutotuneCacheEnabled()) {
+        cached_configs_[params.ToString()] = config;
+        std::unordered_map<string, string> entries;
+        for (const auto& cached : cached_configs_) {
+          entries[cached.first] = AutotuneConfigToString(cached.second);
+        }
+        WriteAutotuneCache(name_, entries);
+      }
     }
   }
 
@@ -109,6 +152,14 @@ class AutoTuneMap {
     min_score_threshold_ = std::max(min_score_threshold_, 1);
     max_autotune_count_ = std::max(
         5 * min_score_threshold_ * min_score_threshold_, min_warmup_iterations);
+    if (AutotuneCacheEnabled()) {
+      for (const auto& entry : ReadAutotuneCache(name_)) {
+        Config config;
+        if (AutotuneConfigFromString(entry.second, &config)) {
+          cached_configs_[entry.first] = config;
+        }
+      }
+    }
   }
 
   template <class Group, class Params, class Cfg>
@@ -136,6 +187,9 @@ class AutoTuneMap {
   };
   std::unordered_map<Parameters, ValueType, Hasher> params_config_map_
       GUARDED_BY(mu_);
+  // The accepted configs of the cache file, keyed by the ToString() of their
+  // parameters. Only used if AutotuneCacheEnabled().
+  std::unordered_map<string, Config> cached_configs_ GUARDED_BY(mu_);
   string name_;
   int32 min_score_threshold_;
   int32 max_autotune_count_;
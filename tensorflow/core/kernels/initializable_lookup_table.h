@@ -147,6 +147,10 @@ class InitializableLookupTable : public LookupInterface {
   // underlying data structure.
   virtual Status DoInsert(const Tensor& keys, const Tensor& values) = 0;
 
+  // Called once all the elements are inserted, before the table is marked as
+  // initialized, e.g. to build a structure faster to look up.
+  virtual Status DoFinalize() { return Status::OK(); }
+
   // Performs the batch find operation on the underlying data structure.
   virtual Status DoFind(const Tensor& keys, Tensor* values,
                         const Tensor& default_value) = 0;
@@ -142,7 +142,9 @@ class InitializeTableFromTextFileOp : public OpKernel {
     }
     OP_REQUIRES_OK(ctx, lookup::InitializeTableFromTextFile(
                             vocab_filename, vocab_size_, delimiter_, key_index_,
-                            value_index_, ctx->env(), table));
+                            value_index_, ctx->env(),
+                            ctx->device()->tensorflow_cpu_worker_threads(),
+                            table));
     if (ctx->track_allocations()) {
       ctx->record_persistent_memory_allocation(table->MemoryUsed() -
                                                memory_used_before);
@@ -30,11 +30,14 @@ limitations under the License.
 namespace tensorflow {
 namespace lookup {
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// Lookup table that wraps unordered_maps, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The keys are split by hash into shards that each have their own map and
+// lock, and lookups only take shared locks, so that concurrent lookups and
+// inserts rarely wait on each other.
 //
 // Sample use case:
 //
@@ -50,8 +53,12 @@ class MutableHashTableOfScalars final : public LookupInterface {
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
   size_t size() const override {
-    mutex_lock l(mu_);
-    return table_.size();
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.table.size();
+    }
+    return size;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -60,10 +67,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+    std::vector<int64> order;
+    int64 shard_starts[kNumShards + 1];
+    SortByShard(key_values, &order, shard_starts);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (shard_starts[s] == shard_starts[s + 1]) continue;
+      const Shard& shard = shards_[s];
+      tf_shared_lock l(shard.mu);
+      for (int64 j = shard_starts[s]; j < shard_starts[s + 1]; ++j) {
+        const int64 i = order[j];
+        value_values(i) = gtl::FindWithDefault(
+            shard.table, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+      }
     }
 
     return Status::OK();
@@ -73,13 +88,35 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
     if (clear) {
-      table_.clear();
+      // Readers must not see a partially replaced table.
+      std::vector<mutex_lock> locks = LockAllShards();
+      for (Shard& shard : shards_) {
+        shard.table.clear();
+      }
+      for (int64 i = 0; i < key_values.size(); ++i) {
+        const K key = SubtleMustCopyIfIntegral(key_values(i));
+        gtl::InsertOrUpdate(&shards_[ShardIndex(key)].table, key,
+                            SubtleMustCopyIfIntegral(value_values(i)));
+      }
+      return Status::OK();
     }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+
+    // The order of the keys within each shard is kept, so the last value
+    // given for a key still wins.
+    std::vector<int64> order;
+    int64 shard_starts[kNumShards + 1];
+    SortByShard(key_values, &order, shard_starts);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (shard_starts[s] == shard_starts[s + 1]) continue;
+      Shard& shard = shards_[s];
+      mutex_lock l(shard.mu);
+      for (int64 j = shard_starts[s]; j < shard_starts[s + 1]; ++j) {
+        const int64 i = order[j];
+        gtl::InsertOrUpdate(&shard.table,
+                            SubtleMustCopyIfIntegral(key_values(i)),
+                            SubtleMustCopyIfIntegral(value_values(i)));
+      }
     }
     return Status::OK();
   }
@@ -95,8 +132,11 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
-    int64 size = table_.size();
+    std::vector<mutex_lock> locks = LockAllShards();
+    int64 size = 0;
+    for (const Shard& shard : shards_) {
+      size += shard.table.size();
+    }
 
     Tensor* keys;
     Tensor* values;
@@ -108,9 +148,11 @@ class MutableHashTableOfScalars final : public LookupInterface {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Shard& shard : shards_) {
+      for (auto it = shard.table.begin(); it != shard.table.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
     return Status::OK();
   }
@@ -125,22 +167,69 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   int64 MemoryUsed() const override {
     int64 ret = 0;
-    mutex_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      for (unsigned i = 0; i < shard.table.bucket_count(); ++i) {
+        size_t bucket_size = shard.table.bucket_size(i);
+        if (bucket_size == 0) {
+          ret++;
+        } else {
+          ret += bucket_size;
+        }
       }
     }
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
  private:
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ GUARDED_BY(mu_);
+  static constexpr int kLog2NumShards = 4;
+  static constexpr int kNumShards = 1 << kLog2NumShards;
+
+  struct Shard {
+    mutable mutex mu;
+    // Guarded by 'mu'.
+    std::unordered_map<K, V> table;
+  };
+
+  static int ShardIndex(const K& key) {
+    // HashScalar() is the identity for integers, so scramble it and keep the
+    // top bits.
+    return (HashScalar(key) * 0x9E3779B97F4A7C15ull) >> (64 - kLog2NumShards);
+  }
+
+  // Sorts the indices of 'keys' by shard into 'order', keeping the order of
+  // the keys within each shard. The keys of shard s are then found at
+  // indices [shard_starts[s], shard_starts[s + 1]) of 'order'.
+  static void SortByShard(typename TTypes<K>::ConstFlat keys,
+                          std::vector<int64>* order, int64* shard_starts) {
+    std::vector<uint8> shard_of_key(keys.size());
+    std::fill(shard_starts, shard_starts + kNumShards + 1, 0);
+    for (int64 i = 0; i < keys.size(); ++i) {
+      shard_of_key[i] = ShardIndex(SubtleMustCopyIfIntegral(keys(i)));
+      ++shard_starts[shard_of_key[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) {
+      shard_starts[s + 1] += shard_starts[s];
+    }
+    int64 next[kNumShards];
+    std::copy(shard_starts, shard_starts + kNumShards, next);
+    order->resize(keys.size());
+    for (int64 i = 0; i < keys.size(); ++i) {
+      (*order)[next[shard_of_key[i]]++] = i;
+    }
+  }
+
+  // Locks all the shards, in order, until the returned locks are destroyed.
+  std::vector<mutex_lock> LockAllShards() const {
+    std::vector<mutex_lock> locks;
+    locks.reserve(kNumShards);
+    for (const Shard& shard : shards_) {
+      locks.emplace_back(shard.mu);
+    }
+    return locks;
+  }
+
+  Shard shards_[kNumShards];
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -276,13 +365,6 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
 namespace {
 
-template <typename T>
-inline uint64 HashScalar(const T& key) {
-  return static_cast<uint64>(key);
-}
-
-inline uint64 HashScalar(const string& key) { return Hash64(key); }
-
 // If the given shape is a scalar return {1} instead. Otherwise leave it alone.
 TensorShape MaybeVectorizeShape(const TensorShape& shape) {
   if (shape.dims() == 0) {
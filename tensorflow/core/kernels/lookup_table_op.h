@@ -26,7 +26,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -143,13 +145,24 @@ inline const Variant& SubtleMustCopyIfIntegral(const Variant& value) {
   return value;
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
-// is specified.
+template <typename T>
+inline uint64 HashScalar(const T& key) {
+  return static_cast<uint64>(key);
+}
+
+inline uint64 HashScalar(const string& key) { return Hash64(key); }
+
+// Lookup table where the key and value data type is specified.
 //
 // This table is recommended for any variations to key values.
 //
 // For look up, the table is required to be initialized (allocated
 // and populated). Once the table is marked as initialized it becomes read-only.
+// The elements are then moved from the unordered_map used while populating the
+// table into an open addressing table with linear probing, whose keys and
+// values are stored in separate arrays. Finding a key then usually reads a
+// single cache line of keys, and the buckets of a batch of keys are prefetched
+// before they are probed.
 //
 // Sample use case:
 //
@@ -174,7 +187,7 @@ class HashTable : public InitializableLookupTable {
       return 0;
     }
     std::atomic_thread_fence(std::memory_order_acquire);
-    return table_ ? table_->size() : 0;
+    return num_entries_;
   }
 
   Status ExportValues(OpKernelContext* context) override {
@@ -182,7 +195,7 @@ class HashTable : public InitializableLookupTable {
       return errors::Aborted("HashTable is not initialized.");
     }
 
-    const int64 size = table_->size();
+    const int64 size = num_entries_;
 
     Tensor* keys;
     Tensor* values;
@@ -194,9 +207,12 @@ class HashTable : public InitializableLookupTable {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64 i = 0;
-    for (auto it = table_->begin(); it != table_->end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (size_t bucket = 0; bucket < occupied_.size(); ++bucket) {
+      if (occupied_[bucket]) {
+        keys_data(i) = keys_[bucket];
+        values_data(i) = values_[bucket];
+        ++i;
+      }
     }
     return Status::OK();
   }
@@ -242,15 +258,65 @@ class HashTable : public InitializableLookupTable {
     return Status::OK();
   }
 
+  Status DoFinalize() override {
+    if (!table_) {
+      return errors::FailedPrecondition("HashTable is not prepared.");
+    }
+    num_entries_ = table_->size();
+    // Keep the load factor at most 1/2, so that probe sequences stay short.
+    int log2_buckets = 1;
+    while ((size_t{1} << log2_buckets) < 2 * num_entries_) {
+      ++log2_buckets;
+    }
+    const size_t num_buckets = size_t{1} << log2_buckets;
+    hash_shift_ = 64 - log2_buckets;
+    keys_.assign(num_buckets, K());
+    values_.assign(num_buckets, V());
+    occupied_.assign(num_buckets, 0);
+    for (const auto& entry : *table_) {
+      size_t bucket = Bucket(entry.first);
+      while (occupied_[bucket]) {
+        bucket = (bucket + 1) & (num_buckets - 1);
+      }
+      keys_[bucket] = entry.first;
+      values_[bucket] = entry.second;
+      occupied_[bucket] = 1;
+    }
+    table_.reset();
+    return Status::OK();
+  }
+
   Status DoFind(const Tensor& key, Tensor* value,
                 const Tensor& default_value) override {
     const V default_val = default_value.flat<V>()(0);
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
-
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          *table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+    const size_t mask = occupied_.size() - 1;
+
+    // Look up the keys in blocks, fetching the first bucket of every key of a
+    // block before probing any of them so that the cache misses overlap.
+    constexpr int64 kBlockSize = 16;
+    size_t buckets[kBlockSize];
+    for (int64 start = 0; start < key_values.size(); start += kBlockSize) {
+      const int64 end = std::min(start + kBlockSize, key_values.size());
+      for (int64 i = start; i < end; ++i) {
+        const size_t bucket = Bucket(SubtleMustCopyIfIntegral(key_values(i)));
+        port::prefetch<port::PREFETCH_HINT_T0>(&occupied_[bucket]);
+        port::prefetch<port::PREFETCH_HINT_T0>(&keys_[bucket]);
+        buckets[i - start] = bucket;
+      }
+      for (int64 i = start; i < end; ++i) {
+        const K& lookup_key = SubtleMustCopyIfIntegral(key_values(i));
+        size_t bucket = buckets[i - start];
+        value_values(i) = default_val;
+        while (occupied_[bucket]) {
+          if (keys_[bucket] == lookup_key) {
+            value_values(i) = values_[bucket];
+            break;
+          }
+          bucket = (bucket + 1) & mask;
+        }
+      }
     }
     return Status::OK();
   }
@@ -260,12 +326,27 @@ class HashTable : public InitializableLookupTable {
       const int64 num_elements = table_->size();
       return num_elements * (sizeof(K) + sizeof(V));
     } else {
-      return 0;
+      return occupied_.size() * (sizeof(K) + sizeof(V) + sizeof(uint8));
     }
   }
 
  private:
+  // Returns the first bucket to probe for 'key'. The hash is scrambled by a
+  // multiplication, keeping the top bits, as HashScalar() is the identity for
+  // integers.
+  size_t Bucket(const K& key) const {
+    return (HashScalar(key) * 0x9E3779B97F4A7C15ull) >> hash_shift_;
+  }
+
+  // Holds the elements while the table is populated.
   std::unique_ptr<std::unordered_map<K, V>> table_;
+
+  // The buckets once the table is initialized.
+  std::vector<K> keys_;
+  std::vector<V> values_;
+  std::vector<uint8> occupied_;
+  size_t num_entries_ = 0;
+  int hash_shift_ = 63;
 };
 
 }  // namespace lookup
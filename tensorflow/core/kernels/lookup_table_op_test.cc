@@ -0,0 +1,290 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/lookup_table_op.h"
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+using Int64HashTable = HashTable<int64, int64>;
+
+// Returns the bucket of 'key' in a HashTable of 2^log2_buckets buckets, i.e.
+// the first bucket probed for it.
+size_t HomeBucket(int64 key, int log2_buckets) {
+  return (static_cast<uint64>(key) * 0x9E3779B97F4A7C15ull) >>
+         (64 - log2_buckets);
+}
+
+// Returns the first 'n' keys from 'start' on whose home bucket is 'bucket'.
+std::vector<int64> KeysWithHomeBucket(size_t bucket, int log2_buckets, int n,
+                                      int64 start) {
+  std::vector<int64> keys;
+  for (int64 key = start; keys.size() < static_cast<size_t>(n); ++key) {
+    if (HomeBucket(key, log2_buckets) == bucket) keys.push_back(key);
+  }
+  return keys;
+}
+
+// Initializes a table with 'keys' and 'values' in a single batch. Unlike
+// KeyValueTensorIterator, it accepts empty tensors.
+class SingleBatchIterator
+    : public InitializableLookupTable::InitTableIterator {
+ public:
+  SingleBatchIterator(const std::vector<int64>& keys,
+                      const std::vector<int64>& values)
+      : keys_(test::AsTensor<int64>(keys)),
+        values_(test::AsTensor<int64>(values)) {}
+
+  void Next() override {
+    valid_ = false;
+    status_ = errors::OutOfRange("No more data.");
+  }
+  bool Valid() const override { return valid_; }
+  const Tensor& keys() const override { return keys_; }
+  const Tensor& values() const override { return values_; }
+  Status status() const override { return status_; }
+  int64 total_size() const override { return keys_.NumElements(); }
+
+ private:
+  const Tensor keys_;
+  const Tensor values_;
+  bool valid_ = true;
+  Status status_;
+};
+
+Status Initialize(const std::vector<int64>& keys,
+                  const std::vector<int64>& values, Int64HashTable* table) {
+  SingleBatchIterator iter(keys, values);
+  return table->Initialize(iter);
+}
+
+std::vector<int64> Find(Int64HashTable* table, const std::vector<int64>& keys,
+                        int64 default_value) {
+  const Tensor key_tensor = test::AsTensor<int64>(keys);
+  Tensor values(DT_INT64, key_tensor.shape());
+  TF_CHECK_OK(table->Find(nullptr, key_tensor, &values,
+                          test::AsScalar<int64>(default_value)));
+  const auto flat = values.flat<int64>();
+  return std::vector<int64>(flat.data(), flat.data() + flat.size());
+}
+
+TEST(HashTableTest, EmptyTable) {
+  Int64HashTable* table = new Int64HashTable(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(Initialize({}, {}, table));
+  EXPECT_EQ(size_t{0}, table->size());
+  EXPECT_EQ(std::vector<int64>({-1, -1, -1}), Find(table, {0, 1, -7}, -1));
+}
+
+TEST(HashTableTest, SingleEntry) {
+  Int64HashTable* table = new Int64HashTable(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(Initialize({42}, {7}, table));
+  EXPECT_EQ(size_t{1}, table->size());
+  // Empty buckets hold the key 0, which must not be found.
+  EXPECT_EQ(std::vector<int64>({7, -1, -1, 7}),
+            Find(table, {42, 0, 43, 42}, -1));
+}
+
+TEST(HashTableTest, ZeroKey) {
+  Int64HashTable* table = new Int64HashTable(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(Initialize({0, 1}, {10, 11}, table));
+  EXPECT_EQ(std::vector<int64>({10, 11, 5}), Find(table, {0, 1, 2}, 5));
+}
+
+TEST(HashTableTest, CollisionsWrapAround) {
+  // Four entries make a table of 8 buckets. Three keys start probing at the
+  // last bucket, so two of them wrap around to the first buckets, where the
+  // fourth key starts probing.
+  constexpr int kLog2Buckets = 3;
+  const std::vector<int64> last = KeysWithHomeBucket(7, kLog2Buckets, 4, 1);
+  const std::vector<int64> first = KeysWithHomeBucket(0, kLog2Buckets, 2, 1);
+  const std::vector<int64> keys = {last[0], last[1], last[2], first[0]};
+  Int64HashTable* table = new Int64HashTable(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(Initialize(keys, {1, 2, 3, 4}, table));
+  EXPECT_EQ(size_t{4}, table->size());
+  EXPECT_EQ(std::vector<int64>({1, 2, 3, 4}), Find(table, keys, -1));
+  // Missing keys with the same home buckets probe past the wrapped entries
+  // to the first empty bucket.
+  EXPECT_EQ(std::vector<int64>({-1, -1}),
+            Find(table, {last[3], first[1]}, -1));
+}
+
+TEST(HashTableTest, ManyKeys) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::unordered_set<int64> key_set;
+  std::vector<int64> keys;
+  std::vector<int64> values;
+  while (keys.size() < 1000) {
+    const int64 key = static_cast<int64>(rnd.Rand64());
+    if (!key_set.insert(key).second) continue;
+    values.push_back(keys.size());
+    keys.push_back(key);
+  }
+  Int64HashTable* table = new Int64HashTable(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(Initialize(keys, values, table));
+  EXPECT_EQ(keys.size(), table->size());
+  EXPECT_EQ(values, Find(table, keys, -1));
+  std::vector<int64> missing;
+  while (missing.size() < 1000) {
+    const int64 key = static_cast<int64>(rnd.Rand64());
+    if (!key_set.count(key)) missing.push_back(key);
+  }
+  EXPECT_EQ(std::vector<int64>(missing.size(), -1),
+            Find(table, missing, -1));
+}
+
+TEST(HashTableTest, DuplicateKeys) {
+  Int64HashTable* table = new Int64HashTable(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  // The same key may be given twice with the same value.
+  TF_ASSERT_OK(Initialize({3, 5, 3}, {30, 50, 30}, table));
+  EXPECT_EQ(size_t{2}, table->size());
+  EXPECT_EQ(std::vector<int64>({30, 50}), Find(table, {3, 5}, -1));
+
+  Int64HashTable* conflicting = new Int64HashTable(nullptr, nullptr);
+  core::ScopedUnref unref_conflicting(conflicting);
+  const Status s = Initialize({3, 5, 3}, {30, 50, 31}, conflicting);
+  EXPECT_TRUE(errors::IsFailedPrecondition(s)) << s;
+  EXPECT_EQ(size_t{0}, conflicting->size());
+  const Tensor keys = test::AsTensor<int64>({3});
+  Tensor values(DT_INT64, keys.shape());
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      conflicting->Find(nullptr, keys, &values, test::AsScalar<int64>(-1))));
+}
+
+// MutableHashTableOfScalars is defined in lookup_table_op.cc, so it is tested
+// through its ops: a MutableHashTableV2 from int64 to int64, with ops to
+// insert the "keys" and "values" placeholders, find the "keys" with default
+// -1, and get its size.
+GraphDef MutableHashTableGraph() {
+  GraphDef graph;
+  TF_CHECK_OK(NodeDefBuilder("table", "MutableHashTableV2")
+                  .Attr("key_dtype", DT_INT64)
+                  .Attr("value_dtype", DT_INT64)
+                  .Finalize(graph.add_node()));
+  for (const char* name : {"keys", "values"}) {
+    TF_CHECK_OK(NodeDefBuilder(name, "Placeholder")
+                    .Attr("dtype", DT_INT64)
+                    .Finalize(graph.add_node()));
+  }
+  TF_CHECK_OK(NodeDefBuilder("default", "Const")
+                  .Attr("dtype", DT_INT64)
+                  .Attr("value", test::AsScalar<int64>(-1))
+                  .Finalize(graph.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("insert", "LookupTableInsertV2")
+                  .Input("table", 0, DT_RESOURCE)
+                  .Input("keys", 0, DT_INT64)
+                  .Input("values", 0, DT_INT64)
+                  .Finalize(graph.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("find", "LookupTableFindV2")
+                  .Input("table", 0, DT_RESOURCE)
+                  .Input("keys", 0, DT_INT64)
+                  .Input("default", 0, DT_INT64)
+                  .Finalize(graph.add_node()));
+  TF_CHECK_OK(NodeDefBuilder("size", "LookupTableSizeV2")
+                  .Input("table", 0, DT_RESOURCE)
+                  .Finalize(graph.add_node()));
+  return graph;
+}
+
+void Insert(Session* session, const std::vector<int64>& keys,
+            const std::vector<int64>& values) {
+  TF_CHECK_OK(session->Run({{"keys", test::AsTensor<int64>(keys)},
+                            {"values", test::AsTensor<int64>(values)}},
+                           {}, {"insert"}, nullptr));
+}
+
+std::vector<int64> Find(Session* session, const std::vector<int64>& keys) {
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({{"keys", test::AsTensor<int64>(keys)}},
+                           {"find:0"}, {}, &outputs));
+  const auto flat = outputs[0].flat<int64>();
+  return std::vector<int64>(flat.data(), flat.data() + flat.size());
+}
+
+TEST(MutableHashTableOfScalarsTest, ConcurrentInsertAndFind) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumBatches = 20;
+  constexpr int kBatchSize = 100;
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_ASSERT_OK(session->Create(MutableHashTableGraph()));
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&session, t]() {
+        // Every batch spans all of the shards. The key k has value 2k.
+        for (int b = 0; b < kNumBatches; ++b) {
+          std::vector<int64> keys;
+          std::vector<int64> values;
+          std::vector<int64> other_keys;
+          for (int i = b * kBatchSize; i < (b + 1) * kBatchSize; ++i) {
+            keys.push_back(i * kNumThreads + t);
+            values.push_back(2 * keys.back());
+            other_keys.push_back(i * kNumThreads + (t + 1) % kNumThreads);
+          }
+          Insert(session.get(), keys, values);
+          EXPECT_EQ(values, Find(session.get(), keys));
+          // The keys of another thread are either missing or complete.
+          const std::vector<int64> others = Find(session.get(), other_keys);
+          for (size_t i = 0; i < others.size(); ++i) {
+            EXPECT_TRUE(others[i] == -1 || others[i] == 2 * other_keys[i])
+                << other_keys[i] << " has " << others[i];
+          }
+        }
+      });
+    }
+  }
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {"size:0"}, {}, &outputs));
+  EXPECT_EQ(kNumThreads * kNumBatches * kBatchSize,
+            outputs[0].scalar<int64>()());
+  std::vector<int64> keys;
+  std::vector<int64> expected;
+  for (int64 k = 0; k < kNumThreads * kNumBatches * kBatchSize + 10; ++k) {
+    keys.push_back(k);
+    expected.push_back(k < kNumThreads * kNumBatches * kBatchSize ? 2 * k
+                                                                  : -1);
+  }
+  EXPECT_EQ(expected, Find(session.get(), keys));
+  TF_ASSERT_OK(session->Close());
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
@@ -46,6 +46,14 @@ Status InitializeTableFromTextFile(const string& filename, int64 vocab_size,
                                    int32 value_index, Env* env,
                                    InitializableLookupTable* table);
 
+// Like above, but reads the whole file and parses its lines in parallel on
+// 'worker_threads', if not null.
+Status InitializeTableFromTextFile(
+    const string& filename, int64 vocab_size, char delimiter, int32 key_index,
+    int32 value_index, Env* env,
+    const DeviceBase::CpuWorkerThreads* worker_threads,
+    InitializableLookupTable* table);
+
 // Iterator to initialize tables given 'keys' and 'values' tensors.
 //
 // The two tensors are returned in the first iteration. It doesn't loop
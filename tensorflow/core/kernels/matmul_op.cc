@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/fused_bias_activation.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #if GOOGLE_CUDA
 #include "cuda/include/cuda.h"
@@ -108,6 +109,14 @@ bool ExplicitVectorMatrixOptimization<Eigen::half>(
     Tensor* out) {
   return false;
 }
+// Neither is bfloat16, which is multiplied in float instead.
+template <>
+bool ExplicitVectorMatrixOptimization<bfloat16>(
+    const Tensor& a, const Tensor& b,
+    const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+    Tensor* out) {
+  return false;
+}
 
 template <typename Device, typename T>
 struct LaunchMatMulBase {
@@ -143,6 +152,34 @@ struct LaunchMatMulBase {
 template <typename T>
 struct LaunchMatMulCPU : LaunchMatMulBase<CPUDevice, T> {};
 
+// bfloat16 has no native arithmetic on CPUs. The operands are widened to
+// float once, multiplied and accumulated by the float kernel, and the
+// product is rounded to bfloat16 at the end, instead of after every
+// multiply-add.
+template <>
+struct LaunchMatMulCPU<bfloat16> : LaunchMatMulBase<CPUDevice, bfloat16> {
+  static void launch(
+      OpKernelContext* ctx, const Tensor& a, const Tensor& b,
+      const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1>& dim_pair,
+      std::vector<AlgorithmType>* algorithms, bool use_autotune, Tensor* out) {
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    Tensor a_float, b_float, out_float;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, a.shape(), &a_float));
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, b.shape(), &b_float));
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_temp(DT_FLOAT, out->shape(), &out_float));
+    a_float.flat<float>().device(d) = a.flat<bfloat16>().cast<float>();
+    b_float.flat<float>().device(d) = b.flat<bfloat16>().cast<float>();
+    std::vector<LaunchMatMulBase<CPUDevice, float>::AlgorithmType>
+        float_algorithms;
+    LaunchMatMulBase<CPUDevice, float>::launch(ctx, a_float, b_float, dim_pair,
+                                               &float_algorithms, use_autotune,
+                                               &out_float);
+    out->flat<bfloat16>().device(d) = out_float.flat<float>().unaryExpr(
+        [](float v) { return bfloat16::round_to_bfloat16(v); });
+  }
+};
+
 template <typename T, bool USE_CUBLAS>
 struct LaunchMatMul<CPUDevice, T, USE_CUBLAS> : public LaunchMatMulCPU<T> {};
 
@@ -500,6 +537,44 @@ class MatMulOp : public OpKernel {
   bool transpose_b_;
 };
 
+// Computes activation(matmul(a, b) + bias) for _FusedMatMul. The bias and
+// activation are applied to the product in place, in a single pass, instead
+// of by separate BiasAdd and activation kernels each reading and writing the
+// whole output.
+template <typename Device, typename T, bool USE_CUBLAS>
+class FusedMatMulOp : public MatMulOp<Device, T, USE_CUBLAS> {
+ public:
+  explicit FusedMatMulOp(OpKernelConstruction* ctx)
+      : MatMulOp<Device, T, USE_CUBLAS>(ctx) {
+    string activation;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("activation", &activation));
+    OP_REQUIRES_OK(ctx, FusedActivationFromString(activation, &activation_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& bias = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(bias.shape()),
+                errors::InvalidArgument("bias must be a vector, got shape ",
+                                        bias.shape().DebugString()));
+    MatMulOp<Device, T, USE_CUBLAS>::Compute(ctx);
+    if (!ctx->status().ok()) return;
+
+    Tensor* out = ctx->mutable_output(0);
+    OP_REQUIRES(ctx, bias.dim_size(0) == out->dim_size(1),
+                errors::InvalidArgument(
+                    "bias must have one element per column of the product: ",
+                    bias.shape().DebugString(), " vs. ",
+                    out->shape().DebugString()));
+    if (out->NumElements() == 0) return;
+    functor::BiasActivation<Device, T>()(
+        ctx->eigen_device<Device>(), activation_, bias.vec<T>(),
+        out->shaped<T, 3>({out->dim_size(0), out->dim_size(1), 1}));
+  }
+
+ private:
+  FusedActivation activation_;
+};
+
 namespace functor {
 
 // Partial specialization MatMulFunctor<Device=CPUDevice, T>.
@@ -558,6 +633,7 @@ struct MatMulFunctor<SYCLDevice, T> {
 TF_CALL_float(REGISTER_CPU_EIGEN);
 TF_CALL_double(REGISTER_CPU_EIGEN);
 TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
 
 TF_CALL_int32(REGISTER_CPU);
 TF_CALL_complex64(REGISTER_CPU_EIGEN);
@@ -566,6 +642,7 @@ TF_CALL_complex128(REGISTER_CPU_EIGEN);
 TF_CALL_float(REGISTER_CPU);
 TF_CALL_double(REGISTER_CPU);
 TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
 
 TF_CALL_int32(REGISTER_CPU);
 TF_CALL_complex64(REGISTER_CPU);
@@ -580,6 +657,36 @@ TF_CALL_complex128(REGISTER_GPU);
 TF_CALL_half(REGISTER_GPU);
 #endif  // GOOGLE_CUDA
 
+#define REGISTER_FUSED_CPU(T)                                            \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("_FusedMatMul").Device(DEVICE_CPU).TypeConstraint<T>("T"),    \
+      FusedMatMulOp<CPUDevice, T, false /* cublas, ignored for CPU */>);
+
+TF_CALL_half(REGISTER_FUSED_CPU);
+TF_CALL_float(REGISTER_FUSED_CPU);
+TF_CALL_double(REGISTER_FUSED_CPU);
+
+#undef REGISTER_FUSED_CPU
+
+#if GOOGLE_CUDA
+namespace functor {
+extern template struct BiasActivation<GPUDevice, Eigen::half>;
+extern template struct BiasActivation<GPUDevice, float>;
+extern template struct BiasActivation<GPUDevice, double>;
+}  // namespace functor
+
+#define REGISTER_FUSED_GPU(T)                                         \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("_FusedMatMul").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      FusedMatMulOp<GPUDevice, T, true /* cublas */>);
+
+TF_CALL_half(REGISTER_FUSED_GPU);
+TF_CALL_float(REGISTER_FUSED_GPU);
+TF_CALL_double(REGISTER_FUSED_GPU);
+
+#undef REGISTER_FUSED_GPU
+#endif  // GOOGLE_CUDA
+
 #ifdef TENSORFLOW_USE_SYCL
 #define REGISTER_SYCL(T)                                         \
   REGISTER_KERNEL_BUILDER(                                       \
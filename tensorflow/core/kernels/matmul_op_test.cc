@@ -14,7 +14,12 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -127,4 +132,83 @@ BM_Matmul(2000, 1, 2000, true, false);
 BM_Matmul(2000, 1, 2000, false, true);
 BM_Matmul(2000, 1, 2000, true, true);
 
+class FusedMatMulOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& activation, bool transpose_b) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_matmul", "_FusedMatMul")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("transpose_b", transpose_b)
+                     .Attr("activation", activation)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedMatMulOpTest, Identity) {
+  MakeOp("Identity", false);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 0, -1, 0, 1, -1});
+  AddInputFromArray<float>(TensorShape({3}), {10, 20, 30});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {11, 22, 27, 13, 24, 23});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedMatMulOpTest, ReluTransposed) {
+  MakeOp("Relu", true);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 0, 0, 1, -1, -1});
+  AddInputFromArray<float>(TensorShape({3}), {0, -3, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {1, 0, 0, 3, 1, 0});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedMatMulOpTest, Relu6EmptyInner) {
+  // matmul([2, 0], [0, 2]) is zero, so the output is relu6(bias).
+  MakeOp("Relu6", false);
+  AddInputFromArray<float>(TensorShape({2, 0}), {});
+  AddInputFromArray<float>(TensorShape({0, 2}), {});
+  AddInputFromArray<float>(TensorShape({2}), {-1, 7});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {0, 6, 0, 6});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedMatMulOpTest, BiasSizeMismatch) {
+  MakeOp("Identity", false);
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+class MatMulBfloat16OpTest : public OpsTestBase {};
+
+TEST_F(MatMulBfloat16OpTest, AccumulatesInFloat) {
+  TF_ASSERT_OK(NodeDefBuilder("matmul", "MatMul")
+                   .Input(FakeInput(DT_BFLOAT16))
+                   .Input(FakeInput(DT_BFLOAT16))
+                   .Attr("transpose_b", true)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  // A bfloat16 sum of ones stops growing at 256.
+  const int k = 300;
+  AddInput<bfloat16>(TensorShape({2, k}), [](int) { return bfloat16(1.0f); });
+  AddInput<bfloat16>(TensorShape({1, k}), [](int) { return bfloat16(1.0f); });
+  TF_ASSERT_OK(RunOpKernel());
+  const Tensor& product = *GetOutput(0);
+  ASSERT_EQ(TensorShape({2, 1}), product.shape());
+  EXPECT_EQ(300.0f, static_cast<float>(product.flat<bfloat16>()(0)));
+  EXPECT_EQ(300.0f, static_cast<float>(product.flat<bfloat16>()(1)));
+}
+
 }  // end namespace tensorflow
@@ -129,6 +129,9 @@ class PartitionedCallOp : public AsyncOpKernel {
           }
         };
         partition_options.control_flow_added = false;
+        // The devices of the function may belong to several tasks, in which
+        // case a tensor is only sent once to each remote task.
+        partition_options.relay_recvs_within_task = true;
         std::unordered_map<string, GraphDef> partitions;
         OP_REQUIRES_OK_ASYNC(
             ctx, Partition(partition_options, graph, &partitions), done);
@@ -17,6 +17,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <cmath>
+
 #define GEMMLOWP_ALLOW_SLOW_SCALAR_FALLBACK
 #include "public/gemmlowp.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/quantization_utils.h"
 #include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -191,6 +194,235 @@ class QuantizedMatMulOp : public OpKernel {
   bool transpose_b_;
 };
 
+// Splits a real multiplier in (0, 1) into a 32-bit fixed point multiplier
+// and a right shift, the form gemmlowp's quantize down stage expects. Returns
+// false if the multiplier can't be represented that way.
+static bool QuantizeMultiplierSmallerThanOne(double multiplier,
+                                             int32* quantized_multiplier,
+                                             int* right_shift) {
+  if (!(multiplier > 0.0 && multiplier < 1.0)) {
+    return false;
+  }
+  int exponent;
+  const double fraction = std::frexp(multiplier, &exponent);
+  int64 fixed_point = static_cast<int64>(std::round(fraction * (1ll << 31)));
+  if (fixed_point == (1ll << 31)) {
+    fixed_point /= 2;
+    ++exponent;
+  }
+  if (exponent > 0 || exponent < -31) {
+    return false;
+  }
+  *quantized_multiplier = static_cast<int32>(fixed_point);
+  *right_shift = -exponent;
+  return true;
+}
+
+// Multiplies two quint8 matrices and requantizes the int32 products straight
+// into quint8 with gemmlowp's output pipeline, so the 32-bit result is never
+// written to memory. The clamp stage applies the fused activation.
+template <bool TransposeA, bool TransposeB>
+void GemmlowpMultiplyAndRequantize(OpKernelContext* op_context,
+                                   const quint8* a_data, const quint8* b_data,
+                                   quint8* c_data, int m, int n, int k,
+                                   int offset_a, int offset_b, int lda,
+                                   int ldb, int ldc, int32 output_offset,
+                                   int32 output_multiplier, int output_shift,
+                                   int32 clamp_min, int32 clamp_max) {
+  const uint8* a_data_as_uint8 = &(a_data->value);
+  const uint8* b_data_as_uint8 = &(b_data->value);
+  uint8* c_data_as_uint8 = &(c_data->value);
+  static const gemmlowp::MapOrder LhsOrder =
+      !TransposeA ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  static const gemmlowp::MapOrder RhsOrder =
+      !TransposeB ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  gemmlowp::MatrixMap<const std::uint8_t, LhsOrder> lhs(a_data_as_uint8, m, k,
+                                                        lda);
+  gemmlowp::MatrixMap<const std::uint8_t, RhsOrder> rhs(b_data_as_uint8, k, n,
+                                                        ldb);
+  gemmlowp::MatrixMap<std::uint8_t, gemmlowp::MapOrder::RowMajor> result(
+      c_data_as_uint8, m, n, ldc);
+
+  gemmlowp::OutputStageQuantizeDownInt32ToUint8ScaleByFixedPoint
+      quantize_down_stage;
+  quantize_down_stage.result_offset_after_shift = output_offset;
+  quantize_down_stage.result_fixedpoint_multiplier = output_multiplier;
+  quantize_down_stage.result_shift = output_shift;
+  gemmlowp::OutputStageClamp clamp_stage;
+  clamp_stage.min = clamp_min;
+  clamp_stage.max = clamp_max;
+  gemmlowp::OutputStageSaturatingCastToUint8 saturating_cast_stage;
+  const auto output_pipeline =
+      std::make_tuple(quantize_down_stage, clamp_stage, saturating_cast_stage);
+
+  auto& worker_threads =
+      *(op_context->device()->tensorflow_cpu_worker_threads());
+  TensorflowGemmContext context(worker_threads.num_threads,
+                                worker_threads.workers);
+  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::uint8_t,
+                                   gemmlowp::DefaultL8R8BitDepthParams>(
+      &context, lhs, rhs, &result, -offset_a, -offset_b, output_pipeline);
+  TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data_as_uint8, m * n * sizeof(uint8));
+}
+
+// Computes QuantizedMatMul followed by Requantize to a fixed output range and
+// an optional Relu or Relu6, as produced for inference graphs whose
+// requantization ranges have been frozen. The whole chain runs inside one
+// gemmlowp call instead of three kernels with a qint32 tensor in between.
+template <class T1, class T2, class Toutput>
+class QuantizedMatMulWithRequantizeOp : public OpKernel {
+ public:
+  explicit QuantizedMatMulWithRequantizeOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+    OP_REQUIRES_OK(context, context->GetAttr("activation", &activation_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const float min_a = context->input(2).flat<float>()(0);
+    const float max_a = context->input(3).flat<float>()(0);
+    const float min_b = context->input(4).flat<float>()(0);
+    const float max_b = context->input(5).flat<float>()(0);
+    const float min_out = context->input(6).flat<float>()(0);
+    const float max_out = context->input(7).flat<float>()(0);
+
+    OP_REQUIRES(context, (max_a > min_a),
+                errors::InvalidArgument("max_a must be larger than min_a."));
+    OP_REQUIRES(context, (max_b > min_b),
+                errors::InvalidArgument("max_b must be larger than min_b."));
+    OP_REQUIRES(context, min_out <= 0.0f,
+                errors::InvalidArgument(
+                    "requested_output_min must be <= 0, but got ", min_out));
+    OP_REQUIRES(context, max_out > min_out,
+                errors::InvalidArgument(
+                    "requested_output_max must be > requested_output_min, "
+                    "but got ",
+                    max_out, " and ", min_out));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("In[0] is not a matrix"));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("In[1] is not a matrix"));
+    const int a_inner_dim = transpose_a_ ? 0 : 1;
+    const int b_inner_dim = transpose_b_ ? 1 : 0;
+    OP_REQUIRES(context,
+                a.dim_size(a_inner_dim) == b.dim_size(b_inner_dim),
+                errors::InvalidArgument(
+                    "Matrix size-compatible: In[0]: ", a.shape().DebugString(),
+                    ", In[1]: ", b.shape().DebugString()));
+
+    const int64 m = a.dim_size(1 - a_inner_dim);
+    const int64 n = b.dim_size(1 - b_inner_dim);
+    const int64 k = a.dim_size(a_inner_dim);
+    Tensor* c = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, {m, n}, &c));
+    Tensor* c_min = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(1, {}, &c_min));
+    c_min->flat<float>()(0) = min_out;
+    Tensor* c_max = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(2, {}, &c_max));
+    c_max->flat<float>()(0) = max_out;
+    if (c->NumElements() == 0) {
+      return;
+    }
+
+    const int32 offset_a = FloatToQuantizedUnclamped<T1>(0.0f, min_a, max_a);
+    const int32 offset_b = FloatToQuantizedUnclamped<T2>(0.0f, min_b, max_b);
+    // Each unit of the int32 product is worth product_scale in float, and
+    // each output level is worth output_scale.
+    const double product_scale =
+        static_cast<double>(FloatForOneQuantizedLevel<T1>(min_a, max_a)) *
+        FloatForOneQuantizedLevel<T2>(min_b, max_b);
+    const double output_scale =
+        FloatForOneQuantizedLevel<Toutput>(min_out, max_out);
+    const double multiplier = product_scale / output_scale;
+    const int64 output_offset =
+        FloatToQuantizedUnclamped<Toutput>(0.0f, min_out, max_out);
+    int64 clamp_min = static_cast<int64>(Eigen::NumTraits<Toutput>::lowest());
+    int64 clamp_max = static_cast<int64>(Eigen::NumTraits<Toutput>::highest());
+    if (activation_ == "Relu" || activation_ == "Relu6") {
+      clamp_min = std::max(clamp_min, output_offset);
+    }
+    if (activation_ == "Relu6") {
+      const int64 six =
+          FloatToQuantizedUnclamped<Toutput>(6.0f, min_out, max_out);
+      clamp_max = std::min(clamp_max, six);
+      clamp_max = std::max(clamp_max, clamp_min);
+    }
+
+    const T1* a_data = a.flat<T1>().data();
+    const T2* b_data = b.flat<T2>().data();
+    Toutput* c_data = c->flat<Toutput>().data();
+    const int lda = a.dim_size(1);
+    const int ldb = b.dim_size(1);
+    const int ldc = n;
+
+    int32 output_multiplier;
+    int output_shift;
+    if (QuantizeMultiplierSmallerThanOne(multiplier, &output_multiplier,
+                                         &output_shift)) {
+      if (transpose_a_) {
+        if (transpose_b_) {
+          GemmlowpMultiplyAndRequantize<true, true>(
+              context, a_data, b_data, c_data, m, n, k, offset_a, offset_b,
+              lda, ldb, ldc, output_offset, output_multiplier, output_shift,
+              clamp_min, clamp_max);
+        } else {
+          GemmlowpMultiplyAndRequantize<true, false>(
+              context, a_data, b_data, c_data, m, n, k, offset_a, offset_b,
+              lda, ldb, ldc, output_offset, output_multiplier, output_shift,
+              clamp_min, clamp_max);
+        }
+      } else {
+        if (transpose_b_) {
+          GemmlowpMultiplyAndRequantize<false, true>(
+              context, a_data, b_data, c_data, m, n, k, offset_a, offset_b,
+              lda, ldb, ldc, output_offset, output_multiplier, output_shift,
+              clamp_min, clamp_max);
+        } else {
+          GemmlowpMultiplyAndRequantize<false, false>(
+              context, a_data, b_data, c_data, m, n, k, offset_a, offset_b,
+              lda, ldb, ldc, output_offset, output_multiplier, output_shift,
+              clamp_min, clamp_max);
+        }
+      }
+      return;
+    }
+
+    // The output range is narrower than one level of the product, which the
+    // fixed point stage can't express, so requantize the int32 products in
+    // float instead.
+    Tensor products;
+    OP_REQUIRES_OK(context, context->allocate_temp(DT_QINT32, {m, n},
+                                                   &products));
+    qint32* products_data = products.flat<qint32>().data();
+    ReferenceGemm<T1, T2, qint32>(transpose_a_, transpose_b_, false, m, n, k,
+                                  a_data, offset_a, lda, b_data, offset_b, ldb,
+                                  products_data, 0, 0, 1, ldc);
+    auto requantize = [products_data, c_data, multiplier, output_offset,
+                       clamp_min, clamp_max](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        const int64 value = static_cast<int64>(std::round(
+                                products_data[i].value * multiplier)) +
+                            output_offset;
+        c_data[i] = static_cast<Toutput>(
+            std::min(std::max(value, clamp_min), clamp_max));
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, m * n, 1,
+          requantize);
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+  string activation_;
+};
+
 REGISTER_KERNEL_BUILDER(Name("QuantizedMatMul")
                             .Device(DEVICE_CPU)
                             .TypeConstraint<quint8>("T1")
@@ -198,4 +430,12 @@ REGISTER_KERNEL_BUILDER(Name("QuantizedMatMul")
                             .TypeConstraint<qint32>("Toutput"),
                         QuantizedMatMulOp<quint8, quint8, qint32>);
 
+REGISTER_KERNEL_BUILDER(Name("QuantizedMatMulWithRequantize")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<quint8>("T1")
+                            .TypeConstraint<quint8>("T2")
+                            .TypeConstraint<quint8>("out_type"),
+                        QuantizedMatMulWithRequantizeOp<quint8, quint8,
+                                                        quint8>);
+
 }  // namespace tensorflow
@@ -355,4 +355,56 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+// Multiplies two small matrices with the fused requantization and Relu6, and
+// compares the results with the float computation.
+TEST_F(QuantizedMatMulTest, WithRequantize_Relu6) {
+  TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op",
+                              "QuantizedMatMulWithRequantize")
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("activation", "Relu6")
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  const float a_min = 0.0f;
+  const float a_max = 25.5f;
+  const float b_min = -12.8f;
+  const float b_max = 12.7f;
+  Tensor a_float(DT_FLOAT, {2, 3});
+  test::FillValues<float>(&a_float, {0.5f, 1.0f, 1.5f, 4.0f, 0.2f, 0.1f});
+  Tensor b_float(DT_FLOAT, {3, 2});
+  test::FillValues<float>(&b_float, {2.0f, -2.0f, 0.3f, 0.5f, 2.0f, -0.4f});
+  Tensor a_quantized = FloatTensorToQuantized<quint8>(a_float, a_min, a_max);
+  Tensor b_quantized = FloatTensorToQuantized<quint8>(b_float, b_min, b_max);
+  AddInputFromArray<quint8>(a_quantized.shape(), a_quantized.flat<quint8>());
+  AddInputFromArray<quint8>(b_quantized.shape(), b_quantized.flat<quint8>());
+  AddInputFromArray<float>(TensorShape({1}), {a_min});
+  AddInputFromArray<float>(TensorShape({1}), {a_max});
+  AddInputFromArray<float>(TensorShape({1}), {b_min});
+  AddInputFromArray<float>(TensorShape({1}), {b_max});
+  AddInputFromArray<float>(TensorShape({1}), {-8.0f});
+  AddInputFromArray<float>(TensorShape({1}), {8.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The products are:
+  // (0.5 * 2.0) + (1.0 * 0.3) + (1.5 * 2.0) = 4.3
+  // (0.5 * -2.0) + (1.0 * 0.5) + (1.5 * -0.4) = -1.1
+  // (4.0 * 2.0) + (0.2 * 0.3) + (0.1 * 2.0) = 8.26
+  // (4.0 * -2.0) + (0.2 * 0.5) + (0.1 * -0.4) = -7.94
+  // and Relu6 clamps them to [0, 6].
+  Tensor expected_float(DT_FLOAT, {2, 2});
+  test::FillValues<float>(&expected_float, {4.3f, 0.0f, 6.0f, 0.0f});
+  EXPECT_EQ(-8.0f, GetOutput(1)->flat<float>()(0));
+  EXPECT_EQ(8.0f, GetOutput(2)->flat<float>()(0));
+  Tensor output_float =
+      QuantizedTensorToFloat<quint8>(*GetOutput(0), -8.0f, 8.0f);
+  // Allow one level of the output range.
+  test::ExpectTensorNear<float>(expected_float, output_float, 16.0f / 255.0f);
+}
+
 }  // namespace tensorflow
@@ -148,6 +148,84 @@ struct FillPhiloxRandomTask<Distribution, true> {
   }
 };
 
+// Fills a range of random groups for distributions that map each output
+// group to one Philox group with a pointwise transform. The Philox samples are
+// generated a chunk at a time with PhiloxRandom::FillBatch, which vectorizes
+// across counters, and then transformed in a tight loop. The results are the
+// same as calling the distribution once per group.
+template <class Transform>
+struct FillPhiloxRandomBatchedTask {
+  typedef typename Transform::T T;
+  static const int kGroupSize = PhiloxRandom::kResultElementCount;
+  static const int kChunkGroups = 256;
+
+  static void Run(random::PhiloxRandom gen, T* data, int64 size,
+                  int64 start_group, int64 limit_group) {
+    uint32 samples[kChunkGroups * kGroupSize];
+    T values[kChunkGroups * kGroupSize];
+
+    gen.Skip(start_group);
+    int64 offset = start_group * kGroupSize;
+    for (int64 group = start_group; group < limit_group;
+         group += kChunkGroups) {
+      const int64 num_groups =
+          std::min<int64>(kChunkGroups, limit_group - group);
+      const int64 num_samples = num_groups * kGroupSize;
+      gen.FillBatch(samples, num_groups);
+      // Only the last group of the output may be partial.
+      const int64 count = std::min(num_samples, size - offset);
+      if (count == num_samples) {
+        Transform::Apply(samples, num_samples, data + offset);
+      } else {
+        Transform::Apply(samples, num_samples, values);
+        std::copy(values, values + count, data + offset);
+      }
+      offset += count;
+    }
+  }
+};
+
+struct UniformFloatTransform {
+  typedef float T;
+  static void Apply(const uint32* samples, int64 count, float* output) {
+    for (int64 i = 0; i < count; ++i) {
+      output[i] = random::Uint32ToFloat(samples[i]);
+    }
+  }
+};
+
+struct NormalFloatTransform {
+  typedef float T;
+  static void Apply(const uint32* samples, int64 count, float* output) {
+    for (int64 i = 0; i < count; i += 2) {
+      random::BoxMullerFloat(samples[i], samples[i + 1], &output[i],
+                             &output[i + 1]);
+    }
+  }
+};
+
+template <>
+struct FillPhiloxRandomTask<
+    random::UniformDistribution<random::PhiloxRandom, float>, false> {
+  static void Run(random::PhiloxRandom gen, float* data, int64 size,
+                  int64 start_group, int64 limit_group,
+                  random::UniformDistribution<random::PhiloxRandom, float>) {
+    FillPhiloxRandomBatchedTask<UniformFloatTransform>::Run(
+        gen, data, size, start_group, limit_group);
+  }
+};
+
+template <>
+struct FillPhiloxRandomTask<
+    random::NormalDistribution<random::PhiloxRandom, float>, false> {
+  static void Run(random::PhiloxRandom gen, float* data, int64 size,
+                  int64 start_group, int64 limit_group,
+                  random::NormalDistribution<random::PhiloxRandom, float>) {
+    FillPhiloxRandomBatchedTask<NormalFloatTransform>::Run(
+        gen, data, size, start_group, limit_group);
+  }
+};
+
 // Partial specialization for CPU to fill the entire region with randoms
 // It splits the work into several tasks and run them in parallel
 template <class Distribution>
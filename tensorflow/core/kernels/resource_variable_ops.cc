@@ -67,6 +67,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
@@ -75,12 +76,14 @@ REGISTER_RESOURCE_HANDLE_KERNEL(Var);
 
 ReadVariableOp::ReadVariableOp(OpKernelConstruction* c) : OpKernel(c) {
   OP_REQUIRES_OK(c, c->GetAttr("dtype", &dtype_));
+  OP_REQUIRES_OK(c, ReadBoolFromEnvVar("TF_RESOURCE_VARIABLE_NONBLOCKING_READS",
+                                       false, &nonblocking_reads_));
 }
 
 void ReadVariableOp::Compute(OpKernelContext* ctx) {
   Var* variable = nullptr;
-  ResourceHandle handle = HandleFromInput(ctx, 0);
-  const auto status = LookupResource(ctx, handle, &variable);
+  const ResourceHandle& handle = ctx->input(0).flat<ResourceHandle>()(0);
+  const auto status = variable_cache_.Lookup(ctx, handle, &variable);
   OP_REQUIRES(ctx, status.ok(),
               errors::FailedPrecondition(
                   "Error while reading resource variable ", handle.name(),
@@ -92,8 +95,19 @@ void ReadVariableOp::Compute(OpKernelContext* ctx) {
   // We're acquiring a reference to the underlying buffer while
   // holding a shared lock to guarantee ordering of reads and
   // writes.
-  tf_shared_lock ml(*variable->mu());
-  const Tensor& t = *variable->tensor();
+  Tensor t;
+  if (!nonblocking_reads_) {
+    tf_shared_lock ml(*variable->mu());
+    t = *variable->tensor();
+  } else if (variable->mu()->try_lock_shared()) {
+    t = *variable->tensor();
+    if (!variable->snapshot_enabled()) variable->EnableSnapshot();
+    variable->mu()->unlock_shared();
+  } else if (!variable->ReadSnapshot(&t)) {
+    // An update holds the lock, and no snapshot has been published yet.
+    tf_shared_lock ml(*variable->mu());
+    t = *variable->tensor();
+  }
   OP_REQUIRES(ctx, dtype_ == t.dtype(),
               errors::InvalidArgument(
                   "Trying to read variable with wrong dtype. Expected ",
@@ -258,6 +272,7 @@ class AssignVariableOp : public OpKernel {
         value.shape(), DEVICE_MEMORY, attr);
     mutex_lock ml(*variable->mu());
     variable->is_initialized = true;
+    ScopedPublishSnapshot publish(variable);
     if (input_alias) {
       *variable->tensor() = *input_alias;
       return;
@@ -330,6 +345,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
 
     mutex_lock ml(*variable->mu());
     variable->is_initialized = true;
+    ScopedPublishSnapshot publish(variable);
     *variable->tensor() = Tensor(DT_VARIANT, value.shape());
 
     if (input_alias) {
@@ -402,6 +418,7 @@ class AssignUpdateVariableOp : public OpKernel {
     // ADD if value's refcount was 1.
     mutex_lock ml(*variable->mu());
     Tensor* var_tensor = variable->tensor();
+    ScopedPublishSnapshot publish(variable);
     OP_REQUIRES_OK(context,
                    PrepareToUpdateVariable<Device, T>(context, var_tensor));
     functor::DenseUpdate<Device, T, Op> update_functor;
@@ -601,6 +618,7 @@ class ResourceScatterUpdateOp : public OpKernel {
     core::ScopedUnref unref_v(v);
     mutex_lock ml(*v->mu());
     Tensor* params = v->tensor();
+    ScopedPublishSnapshot publish(v);
     OP_REQUIRES_OK(c, PrepareToUpdateVariable<Device, T>(c, params));
     const Tensor& indices = c->input(1);
     const Tensor& updates = c->input(2);
@@ -16,6 +16,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_RESOURCE_VARIABLE_OPS_H_
 
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
 
 namespace tensorflow {
 
@@ -26,6 +28,10 @@ class ReadVariableOp : public OpKernel {
 
  private:
   DataType dtype_;
+  ResourceLookupCache<Var> variable_cache_;
+  // If true, reads that find an update in progress return the value of the
+  // last completed update instead of waiting (see Var::ReadSnapshot()).
+  bool nonblocking_reads_;
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,131 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <stdlib.h>
+
+#include <memory>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumElements = 1024;
+
+class NonblockingReadVariableOpTest : public OpsTestBase {
+ protected:
+  void SetUp() override {
+    setenv("TF_RESOURCE_VARIABLE_NONBLOCKING_READS", "1", 1 /* overwrite */);
+    TF_ASSERT_OK(NodeDefBuilder("read", "ReadVariableOp")
+                     .Input(FakeInput(DT_RESOURCE))
+                     .Attr("dtype", DT_FLOAT)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    var_ = new Var(DT_FLOAT);
+    *var_->tensor() = Tensor(DT_FLOAT, TensorShape({kNumElements}));
+    var_->tensor()->flat<float>().setConstant(1);
+    var_->is_initialized = true;
+    // Keeps var_ alive for the test; the resource manager owns the other
+    // reference.
+    var_->Ref();
+    AddResourceInput("", "var", var_);
+  }
+
+  void TearDown() override {
+    var_->Unref();
+    unsetenv("TF_RESOURCE_VARIABLE_NONBLOCKING_READS");
+  }
+
+  // Sets every element to `value` the way update kernels do: under the
+  // exclusive lock, copying the buffer first if it is shared.
+  void Update(float value) {
+    mutex_lock ml(*var_->mu());
+    ScopedPublishSnapshot publish(var_);
+    Tensor* t = var_->tensor();
+    if (!t->RefCountIsOne()) *t = tensor::DeepCopy(*t);
+    auto flat = t->flat<float>();
+    for (int i = 0; i < kNumElements; ++i) flat(i) = value;
+  }
+
+  // Returns the value read, after checking that all its elements are equal.
+  float Read() {
+    TF_CHECK_OK(RunOpKernel());
+    const auto flat = GetOutput(0)->flat<float>();
+    for (int i = 1; i < kNumElements; ++i) {
+      CHECK_EQ(flat(0), flat(i)) << "Read an incomplete update";
+    }
+    return flat(0);
+  }
+
+  Var* var_ = nullptr;
+};
+
+TEST_F(NonblockingReadVariableOpTest, ReadDuringUpdateSeesLastUpdate) {
+  // The first read makes the variable keep a snapshot.
+  EXPECT_EQ(1, Read());
+  Update(2);
+  Update(3);
+  // Holding the lock stands for an update in progress, so the read returns
+  // the snapshot instead of waiting. It must include the updates that
+  // completed before the read started.
+  mutex_lock ml(*var_->mu());
+  EXPECT_EQ(3, Read());
+}
+
+TEST_F(NonblockingReadVariableOpTest, InPlaceUpdateCopiesSnapshotBuffer) {
+  EXPECT_EQ(1, Read());
+  {
+    mutex_lock ml(*var_->mu());
+    EXPECT_TRUE(var_->SnapshotSharesBuffer());
+  }
+  Update(2);
+  mutex_lock ml(*var_->mu());
+  EXPECT_TRUE(var_->SnapshotSharesBuffer());
+  // An update that copies first leaves the snapshot alone.
+  *var_->tensor() = tensor::DeepCopy(*var_->tensor());
+  EXPECT_FALSE(var_->SnapshotSharesBuffer());
+  var_->tensor()->flat<float>().setConstant(5);
+  EXPECT_EQ(2, Read());
+}
+
+TEST_F(NonblockingReadVariableOpTest, ConcurrentUpdatesAndReads) {
+  constexpr int kNumUpdates = 1000;
+  EXPECT_EQ(1, Read());
+  std::unique_ptr<Thread> writer(
+      Env::Default()->StartThread(ThreadOptions(), "writer", [this]() {
+        for (int i = 2; i <= kNumUpdates; ++i) Update(i);
+      }));
+  // Reads see complete updates only, and never go back to an older value.
+  float last = 1;
+  while (last < kNumUpdates) {
+    const float value = Read();
+    EXPECT_GE(value, last);
+    last = value;
+  }
+  writer.reset();
+  EXPECT_EQ(kNumUpdates, Read());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -23,11 +23,14 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -226,6 +229,39 @@ void RestoreTensor(OpKernelContext* context,
 #undef READER_COPY
 }
 
+namespace {
+
+// Whether RestoreV2 returns full tensors that alias a memory mapping of the
+// checkpoint instead of copying them into freshly allocated outputs.
+bool RestoreFromMemoryMapping() {
+  static const bool use_mmap = [] {
+    bool b = false;
+    Status s = ReadBoolFromEnvVar("TF_RESTORE_MMAP", false, &b);
+    if (!s.ok()) LOG(ERROR) << s.error_message();
+    return b;
+  }();
+  return use_mmap;
+}
+
+// Number of threads RestoreV2 reads with, and the limit on bytes being read
+// at once when that is more than one.
+void RestoreParallelism(int* num_threads, int64* max_bytes_in_flight) {
+  static const std::pair<int64, int64> parallelism = [] {
+    int64 threads = 1;
+    int64 max_bytes = 256 << 20;
+    Status s = ReadInt64FromEnvVar("TF_RESTORE_NUM_THREADS", 1, &threads);
+    if (!s.ok()) LOG(ERROR) << s.error_message();
+    s = ReadInt64FromEnvVar("TF_RESTORE_MAX_BYTES_IN_FLIGHT", max_bytes,
+                            &max_bytes);
+    if (!s.ok()) LOG(ERROR) << s.error_message();
+    return std::make_pair(threads, max_bytes);
+  }();
+  *num_threads = static_cast<int>(parallelism.first);
+  *max_bytes_in_flight = parallelism.second;
+}
+
+}  // namespace
+
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
@@ -247,10 +283,13 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   TF_RETURN_IF_ERROR(reader.status());
 
   // TODO(zongheng): potential optimization: one Seek() in first lookup.
-  // TODO(zongheng): consider measuring speed and issuing concurrent lookups
-  // within a fixed memory budget.
   TensorShape restored_full_shape;
   Tensor* restored_tensor = nullptr;
+  const bool use_mmap = RestoreFromMemoryMapping();
+  // Outputs are allocated here and filled in by LookupParallel() below.
+  std::vector<BundleReader::LookupRequest> requests;
+  requests.reserve(sorted_name_idx.size());
+  std::vector<TensorSlice> parsed_slices(sorted_name_idx.size());
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
@@ -258,15 +297,24 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     TF_RETURN_IF_ERROR(
         reader.LookupTensorShape(tensor_name, &restored_full_shape));
 
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && use_mmap) {
+      // Lookup the full tensor without copying it. Consumers such as Assign
+      // copy the aliased buffer, because it is never forwarded.
+      Tensor aliased;
+      TF_RETURN_IF_ERROR(reader.LookupAliased(tensor_name, &aliased));
+      context->set_output(i, aliased);
+      restored_tensor = context->mutable_output(i);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(i, restored_full_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(reader.Lookup(tensor_name, restored_tensor));
+      requests.emplace_back();
+      requests.back().key = tensor_name;
+      requests.back().val = restored_tensor;
     } else {
       // Lookup the slice.
       TensorShape parsed_full_shape;
-      TensorSlice parsed_slice;
+      TensorSlice& parsed_slice = parsed_slices[i];
       TensorShape parsed_slice_shape;
 
       TF_RETURN_IF_ERROR(
@@ -282,8 +330,10 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
 
       TF_RETURN_IF_ERROR(
           context->allocate_output(i, parsed_slice_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(
-          reader.LookupSlice(tensor_name, parsed_slice, restored_tensor));
+      requests.emplace_back();
+      requests.back().key = tensor_name;
+      requests.back().slice = &parsed_slice;
+      requests.back().val = restored_tensor;
     }
     if (dtypes[i] != restored_tensor->dtype()) {
       return errors::InvalidArgument(
@@ -292,7 +342,72 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
           DataTypeString(restored_tensor->dtype()));
     }
   }
-  return Status::OK();
+  int num_threads;
+  int64 max_bytes_in_flight;
+  RestoreParallelism(&num_threads, &max_bytes_in_flight);
+  return reader.LookupParallel(requests, num_threads, max_bytes_in_flight);
+}
+
+namespace {
+
+// The checkpoints being written by StartAsyncSaveV2(), by prefix.
+class AsyncSavesV2 {
+ public:
+  static AsyncSavesV2* Global() {
+    static AsyncSavesV2* saves = new AsyncSavesV2;
+    return saves;
+  }
+
+  void Start(const string& prefix, std::function<Status()> write) {
+    {
+      mutex_lock l(mu_);
+      ++in_flight_[prefix];
+    }
+    pool_.Schedule([this, prefix, write]() {
+      const Status s = write();
+      if (!s.ok()) {
+        LOG(ERROR) << "Asynchronous save to " << prefix << " failed: " << s;
+      }
+      mutex_lock l(mu_);
+      if (!s.ok()) failed_[prefix].Update(s);
+      if (--in_flight_[prefix] == 0) in_flight_.erase(prefix);
+      done_.notify_all();
+    });
+  }
+
+  Status Wait(const string& prefix) {
+    mutex_lock l(mu_);
+    while (in_flight_.count(prefix) > 0) {
+      done_.wait(l);
+    }
+    auto it = failed_.find(prefix);
+    if (it == failed_.end()) return Status::OK();
+    const Status s = it->second;
+    failed_.erase(it);
+    return s;
+  }
+
+ private:
+  AsyncSavesV2() : pool_(Env::Default(), "async_save_v2", kNumThreads) {}
+
+  // The number of checkpoint shards written at once.
+  static constexpr int kNumThreads = 4;
+
+  thread::ThreadPool pool_;
+  mutex mu_;
+  condition_variable done_;
+  std::unordered_map<string, int> in_flight_ GUARDED_BY(mu_);
+  std::unordered_map<string, Status> failed_ GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+void StartAsyncSaveV2(const string& prefix, std::function<Status()> write) {
+  AsyncSavesV2::Global()->Start(prefix, std::move(write));
+}
+
+Status WaitForAsyncSavesV2(const string& prefix) {
+  return AsyncSavesV2::Global()->Wait(prefix);
 }
 
 }  // namespace tensorflow
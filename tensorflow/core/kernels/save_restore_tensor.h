@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_SAVE_RESTORE_TENSOR_H_
 #define TENSORFLOW_KERNELS_SAVE_RESTORE_TENSOR_H_
 
+#include <functional>
+
+#include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_writer.h"
 
@@ -68,6 +71,14 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& shape_and_slices,
                         gtl::ArraySlice<DataType> dtypes);
 
+// Runs "write", which writes the V2 checkpoint "prefix", on a background
+// thread, for SaveV2 ops with async_write set.
+void StartAsyncSaveV2(const string& prefix, std::function<Status()> write);
+
+// Waits for the writes StartAsyncSaveV2() started to "prefix" to finish, and
+// returns the first error of those that failed since the last call.
+Status WaitForAsyncSavesV2(const string& prefix);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_KERNELS_SAVE_RESTORE_TENSOR_H_
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/bounds_check.h"
@@ -85,12 +86,44 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// A tensor, or a slice of one, to be saved by SaveV2.
+struct SaveV2Entry {
+  string name;
+  bool is_slice = false;
+  TensorShape shape;
+  TensorSlice slice;
+  Tensor tensor;
+};
+
+Status WriteBundleV2(const string& prefix,
+                     const std::vector<SaveV2Entry>& entries) {
+  BundleWriter writer(Env::Default(), prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+  for (const SaveV2Entry& entry : entries) {
+    if (entry.is_slice) {
+      TF_RETURN_IF_ERROR(
+          writer.AddSlice(entry.name, entry.shape, entry.slice, entry.tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(entry.name, entry.tensor));
+    }
+  }
+  return writer.Finish();
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
+//
+// With async_write, the tensors are copied and the op returns, while the copies
+// are written by a background thread. A later SaveV2, RestoreV2 or
+// MergeV2Checkpoints of the same prefix waits for them to be written, and
+// fails if that did.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("async_write", &async_write_));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -105,37 +138,48 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<string>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<string>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
+    // Writing the same files twice at once would corrupt them.
+    OP_REQUIRES_OK(context, WaitForAsyncSavesV2(prefix_string));
 
+    std::vector<SaveV2Entry> entries(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
+      SaveV2Entry& entry = entries[i];
+      entry.name = tensor_names_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
 
       if (!shape_and_slices_flat(i).empty()) {
         const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
+        entry.is_slice = true;
+        entry.slice = TensorSlice(tensor.dims());
         TensorShape slice_shape;
 
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
+        OP_REQUIRES_OK(context,
+                       checkpoint::ParseShapeAndSlice(
+                           shape_spec, &entry.shape, &entry.slice,
+                           &slice_shape));
         OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
                     errors::InvalidArgument("Slice in shape_and_slice "
                                             "specification does not match the "
                                             "shape of the tensor to  save: ",
                                             shape_spec, ", tensor: ",
                                             tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
       }
+      // Variables keep changing after an asynchronous save returns.
+      entry.tensor = async_write_ ? tensor::DeepCopy(tensor) : tensor;
+    }
+
+    if (async_write_) {
+      StartAsyncSaveV2(prefix_string, [prefix_string, entries]() {
+        return WriteBundleV2(prefix_string, entries);
+      });
+    } else {
+      OP_REQUIRES_OK(context, WriteBundleV2(prefix_string, entries));
     }
-    OP_REQUIRES_OK(context, writer.Finish());
   }
+
+ private:
+  // Whether the tensors are written after the op returns.
+  bool async_write_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -158,6 +202,7 @@ class RestoreV2 : public OpKernel {
                    shape_and_slices);
 
     const string& prefix_string = prefix.scalar<string>()();
+    OP_REQUIRES_OK(context, WaitForAsyncSavesV2(prefix_string));
 
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
     // reader as we upgrade to the V2 format.  This allows transparent upgrade.
@@ -216,6 +261,9 @@ class MergeV2Checkpoints : public OpKernel {
         gtl::ArraySlice<string>(checkpoint_prefixes.flat<string>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<string>()();
+    for (const string& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context, WaitForAsyncSavesV2(input_prefix));
+    }
     OP_REQUIRES_OK(
         context, tensorflow::MergeBundles(env, input_prefixes, merged_prefix));
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
@@ -339,5 +340,38 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+TEST_F(SaveV2OpTest, AsyncWrite) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async");
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Input(FakeInput({DT_FLOAT}))  // tensors
+                   .Attr("async_write", true)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInput<string>(TensorShape({}),
+                   [&prefix](int x) -> string { return prefix; });
+  AddInput<string>(TensorShape({1}),
+                   [](int x) -> string { return "tensor_float"; });
+  AddInput<string>(TensorShape({1}), [](int x) -> string { return ""; });
+  AddInput<float>(TensorShape({4}),
+                  [](int x) -> float { return static_cast<float>(x); });
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The tensor was copied before the op returned, so changing it now does
+  // not change what is saved.
+  mutable_input(3).tensor->flat<float>().setZero();
+  TF_ASSERT_OK(WaitForAsyncSavesV2(prefix));
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_float", &val));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(static_cast<float>(i), val.flat<float>()(i));
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -147,9 +147,18 @@ class ScatterNdUpdateOp : public OpKernel {
         Var* v;
         OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
         mutex_lock m(*v->mu());
+        ScopedPublishSnapshot publish(v);
         DoCompute(c);
       } else {
         DoCompute(c);
+        // The update ran without the lock, which publishing needs.
+        Var* v;
+        OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+        core::ScopedUnref unref_v(v);
+        if (v->snapshot_enabled()) {
+          mutex_lock m(*v->mu());
+          v->PublishSnapshot();
+        }
       }
     } else if (use_exclusive_lock_) {
       // If we're here, it means the input type is a ref.
@@ -21,6 +21,7 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <atomic>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/scatter_nd_op.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
 
@@ -96,10 +98,6 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
       typename TTypes<Index, 2>::ConstTensor Tindices,
       typename TTypes<T, 2>::ConstTensor Tupdates,
       typename TTypes<T, 2>::Tensor Toutput) {
-    // error_loc is -1 if there's no out-of-bounds index,
-    // otherwise it is the location of an OOB index in Tindices.
-    Index error_loc = -1;
-
     const Eigen::DenseIndex batch_size = Tindices.dimension(0);
 
     Index batch_strides[IXDIM];
@@ -112,6 +110,8 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
       }
     }
 
+    // Check all the indices before updating anything.
+    std::vector<Index> offsets(batch_size);
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
@@ -121,19 +121,45 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
         i += ix_d * batch_strides[dim];
       }
       if (TF_PREDICT_FALSE(out_of_bounds)) {
-        error_loc = loc;
-        break;
-      } else {
-        auto input_chip = Toutput.template chip<0>(i);
-        auto output_chip = input_chip.device(d);
-        auto update_chip = Tupdates.template chip<0>(loc);
-        update_executor::UpdateExecutor<
-            decltype(input_chip), decltype(update_chip), decltype(output_chip),
-            OP>::Execute(input_chip, update_chip, output_chip);
+        // error_loc is the location of an OOB index in Tindices.
+        return loc;
       }
+      offsets[loc] = i * slice_size;
     }
 
-    return error_loc;
+    // Updates of the same slice are applied in order, so the slices are split
+    // into ranges of columns rather than the updates into ranges of indices.
+    // Ranges are rounded to cache lines so that no two threads write to one.
+    T* output_base = Toutput.data();
+    const T* updates_base = Tupdates.data();
+    auto work = [&](int64 begin, int64 end) {
+      const Eigen::DenseIndex size = end - begin;
+      for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+        T* output = output_base + offsets[loc] + begin;
+        if (loc + 1 < batch_size) {
+          port::prefetch<port::PREFETCH_HINT_T0>(output_base +
+                                                 offsets[loc + 1] + begin);
+        }
+        typename TTypes<T>::UnalignedFlat output_slice(output, size);
+        typename TTypes<T>::UnalignedConstFlat update_slice(
+            updates_base + loc * slice_size + begin, size);
+        update_executor::UpdateExecutor<
+            decltype(output_slice), decltype(update_slice),
+            decltype(output_slice), OP>::Execute(output_slice, update_slice,
+                                                 output_slice);
+      }
+    };
+    auto align = [](Eigen::Index size) {
+      const Eigen::Index kAlign = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+      return (size + kAlign - 1) / kAlign * kAlign;
+    };
+    const double column_bytes = static_cast<double>(batch_size * sizeof(T));
+    d.parallelFor(
+        slice_size,
+        Eigen::TensorOpCost(2 * column_bytes, column_bytes, batch_size), align,
+        work);
+
+    return -1;
   }
 };
 
@@ -33,7 +33,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -68,6 +70,39 @@ static bool SegmentReductionDoValidation(OpKernelContext* c,
   return c->status().ok();
 }
 
+// Splits the sorted 'segment_vec' into runs of equal segment ids, so that they
+// can be reduced in parallel. Segment k goes to output row segment_rows[k], and
+// reduces the input rows given by [segment_starts[k], segment_starts[k + 1]).
+template <typename Index>
+static Status FindSegments(typename TTypes<Index>::ConstVec segment_vec,
+                           Index output_rows, std::vector<Index>* segment_rows,
+                           std::vector<int64>* segment_starts) {
+  const int64 num_indices = segment_vec.size();
+  Index out_index = 0;
+  for (int64 i = 0; i < num_indices; ++i) {
+    const Index next_index = internal::SubtleMustCopy(segment_vec(i));
+    if (i > 0) {
+      if (out_index == next_index) {
+        continue;
+      }
+      // We have a new segment here.  Verify that the segment ids are growing.
+      if (out_index > next_index) {
+        return errors::InvalidArgument("segment ids are not increasing");
+      }
+    }
+    if (!FastBoundsCheck(next_index, output_rows)) {
+      return errors::InvalidArgument(
+          "Segment id ", next_index, " out of range [0, ", output_rows,
+          "), possibly because 'segment_ids' input is not sorted.");
+    }
+    segment_rows->push_back(next_index);
+    segment_starts->push_back(i);
+    out_index = next_index;
+  }
+  segment_starts->push_back(num_indices);
+  return Status::OK();
+}
+
 // This operator handles reducing segments along the first dimension.
 // See core/ops/math_ops.cc for more details.
 template <typename Device, class T, class Index, typename Reducer,
@@ -117,86 +152,74 @@ class SegmentReductionOp : public OpKernel {
 #else
     Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
 #endif
-    Index start = 0, end = 1;
+    std::vector<Index> segment_rows;
+    std::vector<int64> segment_starts;
+    OP_REQUIRES_OK(context,
+                   FindSegments<Index>(segment_vec, output_rows, &segment_rows,
+                                       &segment_starts));
+    const int64 num_segments = segment_rows.size();
 
-    Index uninitialized_index = 0;  // Index from which the output is not set.
-    Index out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    // TODO(agarwal): if this loop becomes a bottleneck, consider sharding it
-    // across threads.
     Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
-    while (end <= num_indices) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      Index next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
+    auto reduce_segments = [&](int64 begin, int64 end_segment) {
+      for (int64 k = begin; k < end_segment; ++k) {
+        const Index out_index = segment_rows[k];
+        const int64 start = segment_starts[k];
+        const int64 end = segment_starts[k + 1];
+
+        // If there is a gap between two indices, we need to set that gap to
+        // the default value.
+        const Index uninitialized_index = k == 0 ? 0 : segment_rows[k - 1] + 1;
+        if (out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(T(default_value));
         }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
 
-      // Process segment [start, end)
-      const T* in_slice_ptr = &input_flat(start, 0);
-      typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                               Eigen::Unaligned>
-          OutT;
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(T(default_value));
-      }
-
-      T* out_slice_ptr = &output_flat(out_index, 0);
-      OutT out_slice(out_slice_ptr, out_slice_shape);
-      // We don't use out_slice.device(context->eigen_device<Device>)
-      // because these pieces of work are likely to be very small and
-      // the context switching overhead dwarfs any benefit we get from
-      // using another thread to do this work.
-      if (start == end - 1) {
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
-                                 Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, out_slice_shape);
-        out_slice = in_slice;
-      } else {
-        Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start,
-                                                           num_col);
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
+        // Process segment [start, end)
+        const T* in_slice_ptr = &input_flat(start, 0);
+        typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
                                  Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, in_slice_shape);
-
-        out_slice = in_slice.reduce(dims_to_reduce, Reducer());
+            OutT;
+        T* out_slice_ptr = &output_flat(out_index, 0);
+        OutT out_slice(out_slice_ptr, out_slice_shape);
+        // We don't use out_slice.device(context->eigen_device<Device>)
+        // because these pieces of work are likely to be very small and
+        // the context switching overhead dwarfs any benefit we get from
+        // using another thread to do this work. The segments are instead
+        // sharded across the threads.
+        if (start == end - 1) {
+          typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
+                                   Eigen::Unaligned>
+              InT;
+          InT in_slice(in_slice_ptr, out_slice_shape);
+          out_slice = in_slice;
+        } else {
+          Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start,
+                                                             num_col);
+          typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
+                                   Eigen::Unaligned>
+              InT;
+          InT in_slice(in_slice_ptr, in_slice_shape);
+
+          out_slice = in_slice.reduce(dims_to_reduce, Reducer());
+        }
       }
-      if (end >= num_indices) break;
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-    }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_segment = (num_indices / num_segments + 1) * num_col;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          cost_per_segment, reduce_segments);
   }
 };
 
 #ifdef GOOGLE_CUDA
-//  SegmentSumGPUOp is a segment sum operator implemented for GPU only.
-//  TODO: This implementation of SegmentSumGPUOp is sometimes slower than
+//  SegmentReductionGPUOp is a segment sum or mean operator implemented for
+//  GPU only. SegmentFunctor is SegmentSumFunctor or SegmentMeanFunctor.
+//  TODO: This implementation of SegmentReductionGPUOp is sometimes slower than
 //  its unsorted counterpart (mostly when problem size is small).
 //  This is due to the following two main reasons and a cost-effective way
 //  to resolve these problems is desirable.
@@ -209,10 +232,10 @@ class SegmentReductionOp : public OpKernel {
 //     use the tiled version or the untiled version depends on many factors
 //     including data alignments, ratio of calculation to memory traffic and
 //     obviously, the problem sizes.
-template <class T, class Index>
-class SegmentSumGPUOp : public AsyncOpKernel {
+template <class T, class Index, class SegmentFunctor>
+class SegmentReductionGPUOp : public AsyncOpKernel {
  public:
-  explicit SegmentSumGPUOp(OpKernelConstruction* context)
+  explicit SegmentReductionGPUOp(OpKernelConstruction* context)
       : AsyncOpKernel(context) {}
 
   void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
@@ -255,10 +278,10 @@ class SegmentSumGPUOp : public AsyncOpKernel {
                          sizeof(Index))
             .ok(),
         errors::Internal(
-            "SegmentSumGPUOp: failed to copy output_rows from device"),
+            "SegmentReductionGPUOp: failed to copy output_rows from device"),
         done);
 
-    functor::SegmentSumFunctor<T, Index> functor_;
+    SegmentFunctor functor_;
     auto create_and_check_output = [context, output_rows_host, &input,
                                     &segment_ids, &functor_, done]() {
       // Ensure that within the callback, the proper GPU settings are
@@ -282,9 +305,12 @@ class SegmentSumGPUOp : public AsyncOpKernel {
       auto output_flat = output->flat_outer_dims<T>();
       auto data_ptr = input.template flat<T>().data();
       auto segment_flat = segment_ids.flat<Index>();
-      functor_(context, context->eigen_device<GPUDevice>(), output_rows,
-               segment_ids.shape(), segment_flat, input.NumElements(), data_ptr,
-               output_flat);
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          functor_(context, context->eigen_device<GPUDevice>(), output_rows,
+                   segment_ids.shape(), segment_flat, input.NumElements(),
+                   data_ptr, output_flat),
+          done);
 
       done();
     };
@@ -342,12 +368,21 @@ REGISTER_COMPLEX_CPU_KERNELS_ALL(complex128);
 #undef REGISTER_COMPLEX_CPU_KERNELS_ALL
 
 #if GOOGLE_CUDA
-#define REGISTER_GPU_SORTED_KERNELS(type, index_type)                  \
-  REGISTER_KERNEL_BUILDER(Name("SegmentSum")                           \
-                              .Device(DEVICE_GPU)                      \
-                              .TypeConstraint<type>("T")               \
-                              .TypeConstraint<index_type>("Tindices"), \
-                          SegmentSumGPUOp<type, index_type>)
+#define REGISTER_GPU_SORTED_KERNELS(type, index_type)                         \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("SegmentSum")                                                      \
+          .Device(DEVICE_GPU)                                                 \
+          .TypeConstraint<type>("T")                                          \
+          .TypeConstraint<index_type>("Tindices"),                            \
+      SegmentReductionGPUOp<type, index_type,                                 \
+                            functor::SegmentSumFunctor<type, index_type>>);   \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("SegmentMean")                                                     \
+          .Device(DEVICE_GPU)                                                 \
+          .TypeConstraint<type>("T")                                          \
+          .TypeConstraint<index_type>("Tindices"),                            \
+      SegmentReductionGPUOp<type, index_type,                                 \
+                            functor::SegmentMeanFunctor<type, index_type>>)
 
 #define REGISTER_GPU_SORTED_KERNELS_ALL(type) \
   REGISTER_GPU_SORTED_KERNELS(type, int32);   \
@@ -691,58 +726,52 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    int64 start = 0, end = 1;
-    // Index from which the output is not initialized.
-    OutputRow uninitialized_index = 0;
-    OutputRow out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      OutputRow next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
+    std::vector<OutputRow> segment_rows;
+    std::vector<int64> segment_starts;
+    OP_REQUIRES_OK(context, FindSegments<OutputRow>(segment_vec, output_rows,
+                                                    &segment_rows,
+                                                    &segment_starts));
+    const int64 num_segments = segment_rows.size();
+
+    // The position of the first out of range index found.
+    mutex mu;
+    int64 bad_position = num_indices;
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      for (int64 k = begin; k < end; ++k) {
+        // If there is a gap between two indices, we need to set that gap to
+        // the default value.
+        const OutputRow gap_start = k == 0 ? 0 : segment_rows[k - 1] + 1;
+        if (segment_rows[k] > gap_start) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              segment_rows[k] - gap_start, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(gap_start, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
         }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
-      }
 
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
+        auto out = output_flat.template chip<0>(segment_rows[k]);
+        const int64 start = segment_starts[k];
+        const int64 bad_offset = Reduce(input_flat, indices_vec, start,
+                                        segment_starts[k + 1] - start, out);
+        if (bad_offset >= 0) {
+          mutex_lock l(mu);
+          bad_position = std::min(bad_position, start + bad_offset);
+          return;
+        }
       }
-
-      auto out = output_flat.template chip<0>(out_index);
-      const int bad_offset =
-          Reduce(input_flat, indices_vec, start, end - start, out);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
-    }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_segment = (num_indices / num_segments + 1) * num_col;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          cost_per_segment, reduce_segments);
+    OP_REQUIRES(context, bad_position == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_position,
+                    "] == ", indices_vec(bad_position), " out of range [0, ",
+                    input_flat.dimension(0), ")"));
+    const OutputRow uninitialized_index = segment_rows.back() + 1;
 
     // Fill the gap at the end with the default value.
     if (uninitialized_index < output_rows) {
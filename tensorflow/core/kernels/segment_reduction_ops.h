@@ -44,22 +44,35 @@ namespace functor {
 
 #ifdef GOOGLE_CUDA
 typedef Eigen::GpuDevice GPUDevice;
-// Functor for SegmentSumGPUOp.
+// Functors for SegmentReductionGPUOp.
 // output_rows: the number of output segments (unique segment ids in
 //                'segment_ids').
 // segment_ids_shape: shape of 'segment_ids' tensor.
-// segment_ids: unsorted map from input to output segment ids at which to
+// segment_ids: sorted map from input to output segment ids at which to
 //                perform segment sum operation.
 // data_size: size of input data tensor.
 // data: input data tensor.
 // output: output reshaped to {output_rows, output.size/output_rows}
 template <typename T, typename Index>
 struct SegmentSumFunctor {
-  void operator()(OpKernelContext* ctx, const GPUDevice& d,
-                  const Index output_rows, const TensorShape& segment_ids_shape,
-                  typename TTypes<Index>::ConstFlat segment_ids,
-                  const Index data_size, const T* data,
-                  typename TTypes<T, 2>::Tensor output);
+  Status operator()(OpKernelContext* ctx, const GPUDevice& d,
+                    const Index output_rows,
+                    const TensorShape& segment_ids_shape,
+                    typename TTypes<Index>::ConstFlat segment_ids,
+                    const Index data_size, const T* data,
+                    typename TTypes<T, 2>::Tensor output);
+};
+
+// Like SegmentSumFunctor, but divides every output row by the number of rows
+// in its segment.
+template <typename T, typename Index>
+struct SegmentMeanFunctor {
+  Status operator()(OpKernelContext* ctx, const GPUDevice& d,
+                    const Index output_rows,
+                    const TensorShape& segment_ids_shape,
+                    typename TTypes<Index>::ConstFlat segment_ids,
+                    const Index data_size, const T* data,
+                    typename TTypes<T, 2>::Tensor output);
 };
 
 #endif
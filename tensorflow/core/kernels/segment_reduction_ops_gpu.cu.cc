@@ -17,15 +17,19 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <limits>
+#include <type_traits>
+
 // We need to include cuda_kernel_helper.h before segment_reduction_ops.h
 // See comment in segment_reduction_ops.h for more details.
 #include "tensorflow/core/util/cuda_kernel_helper.h"
 
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
+#include "external/cub_archive/cub/device/device_segmented_reduce.cuh"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/util/cuda_device_functions.h"
 
-
 namespace tensorflow {
 
 using GPUDevice = Eigen::GpuDevice;
@@ -101,6 +105,97 @@ __global__ void SortedSegmentSumCustomKernel(const Index input_outer_dim_size,
   }
 }
 
+// SegmentOffsetsKernel sets offsets[s] to the first row of segment s for the
+// sorted segment ids, and offsets[output_rows] to input_outer_dim_size. Empty
+// segments start where the next segment does.
+template <typename Index>
+__global__ void SegmentOffsetsKernel(const Index input_outer_dim_size,
+                                     const Index output_rows,
+                                     const Index* segment_ids,
+                                     Index* offsets) {
+  for (Index row : CudaGridRangeX(input_outer_dim_size + 1)) {
+    const Index previous_id =
+        row == 0 ? Index(-1) : ldg(segment_ids + row - 1);
+    const Index id =
+        row == input_outer_dim_size ? output_rows : ldg(segment_ids + row);
+    for (Index s = max(previous_id + 1, Index(0)); s <= min(id, output_rows);
+         ++s) {
+      offsets[s] = row;
+    }
+  }
+}
+
+// Sums of half are accumulated in float.
+template <typename T>
+struct SegmentAccumulatorType {
+  typedef T type;
+};
+
+template <>
+struct SegmentAccumulatorType<Eigen::half> {
+  typedef float type;
+};
+
+// SortedSegmentReduceKernel reduces every segment without atomics: a block
+// sums kColumnsPerBlock columns of a segment at a time, with threadIdx.y
+// striding over its rows and a final reduction through shared memory. Reads
+// of a row are coalesced across threadIdx.x.
+template <typename T, typename Index, int kColumnsPerBlock, int kRowsPerBlock>
+__global__ void SortedSegmentReduceKernel(const Index input_outer_dim_size,
+                                          const Index inner_dim_size,
+                                          const Index output_rows,
+                                          const Index* offsets, const T* input,
+                                          const bool mean, T* output) {
+  typedef typename SegmentAccumulatorType<T>::type Accumulator;
+  __shared__ Accumulator partial_sums[kRowsPerBlock][kColumnsPerBlock];
+  const Index num_column_blocks =
+      (inner_dim_size + kColumnsPerBlock - 1) / kColumnsPerBlock;
+  for (Index work = blockIdx.x; work < output_rows * num_column_blocks;
+       work += gridDim.x) {
+    const Index segment = work / num_column_blocks;
+    const Index column =
+        work % num_column_blocks * kColumnsPerBlock + threadIdx.x;
+    // Offsets are only guaranteed to be in range for sorted segment ids.
+    const Index begin =
+        min(max(ldg(offsets + segment), Index(0)), input_outer_dim_size);
+    const Index end =
+        max(begin, min(ldg(offsets + segment + 1), input_outer_dim_size));
+    Accumulator sum = Accumulator(0);
+    if (column < inner_dim_size) {
+      for (Index row = begin + threadIdx.y; row < end; row += kRowsPerBlock) {
+        sum += Accumulator(ldg(input + row * inner_dim_size + column));
+      }
+    }
+    partial_sums[threadIdx.y][threadIdx.x] = sum;
+    __syncthreads();
+    if (threadIdx.y == 0 && column < inner_dim_size) {
+      for (int i = 1; i < kRowsPerBlock; ++i) {
+        sum += partial_sums[i][threadIdx.x];
+      }
+      if (mean && end > begin) {
+        sum /= Accumulator(end - begin);
+      }
+      output[segment * inner_dim_size + column] = T(sum);
+    }
+    __syncthreads();
+  }
+}
+
+// SegmentMeanDivideKernel divides every row of output by the number of rows
+// in its segment.
+template <typename T, typename Index>
+__global__ void SegmentMeanDivideKernel(const Index output_rows,
+                                        const Index inner_dim_size,
+                                        const Index* offsets, T* output) {
+  for (Index i : CudaGridRangeX(output_rows * inner_dim_size)) {
+    const Index segment = i / inner_dim_size;
+    const Index count = ldg(offsets + segment + 1) - ldg(offsets + segment);
+    if (count > 0) {
+      output[i] = output[i] / T(count);
+    }
+  }
+}
+
 // UnsortedSegmentSumKernel processes 'input_total_size' elements.
 // Each element is mapped from input to output by a combination of its
 // 'segment_ids' mapping and 'inner_dim_size'.
@@ -127,24 +222,79 @@ __global__ void UnsortedSegmentCustomKernel(const Index input_outer_dim_size,
 
 namespace functor {
 
+namespace {
+
+// Segments that are this long on average are reduced with
+// SortedSegmentReduceKernel or cub::DeviceSegmentedReduce, one segment at a
+// time. Shorter ones are reduced with SortedSegmentSumCustomKernel, whose
+// threads each sum a few rows and mostly write without atomics; with longer
+// segments its atomics on the same outputs serialize.
+constexpr int kMinSegmentedAverageLength = 16;
+
+// Computes the start of every segment into offsets, which must have
+// output_rows + 1 entries.
+template <typename Index>
+void ComputeSegmentOffsets(const GPUDevice& d, const Index input_outer_dim_size,
+                           const Index output_rows, const Index* segment_ids,
+                           Index* offsets) {
+  // Unsorted segment ids leave some offsets unset.
+  d.memset(offsets, 0, (output_rows + 1) * sizeof(Index));
+  CudaLaunchConfig config = GetCudaLaunchConfig(input_outer_dim_size + 1, d);
+  SegmentOffsetsKernel<Index>
+      <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+          input_outer_dim_size, output_rows, segment_ids, offsets);
+}
+
 template <typename T, typename Index>
-void SegmentSumFunctor<T, Index>::operator()(
-    OpKernelContext* ctx, const GPUDevice& d, const Index output_rows,
-    const TensorShape& segment_ids_shape,
-    typename TTypes<Index>::ConstFlat segment_ids, const Index data_size,
-    const T* data, typename TTypes<T, 2>::Tensor output) {
+Status SortedSegmentSumWithCub(OpKernelContext* ctx, const GPUDevice& d,
+                               const Index output_rows, const Index* offsets,
+                               const T* data, T* output) {
+  size_t temp_storage_bytes = 0;
+  auto err = cub::DeviceSegmentedReduce::Sum(
+      /* d_temp_storage */ nullptr, temp_storage_bytes, data, output,
+      static_cast<int>(output_rows), offsets, offsets + 1, d.stream());
+  if (err != cudaSuccess) {
+    return errors::Internal(
+        "SegmentReductionGPUOp: Could not launch "
+        "cub::DeviceSegmentedReduce::Sum to calculate temp_storage_bytes, "
+        "status: ",
+        cudaGetErrorString(err));
+  }
+  Tensor temp_storage;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT8, TensorShape({static_cast<int64>(temp_storage_bytes)}),
+      &temp_storage));
+  err = cub::DeviceSegmentedReduce::Sum(
+      temp_storage.flat<int8>().data(), temp_storage_bytes, data, output,
+      static_cast<int>(output_rows), offsets, offsets + 1, d.stream());
+  if (err != cudaSuccess) {
+    return errors::Internal(
+        "SegmentReductionGPUOp: Could not launch "
+        "cub::DeviceSegmentedReduce::Sum, status: ",
+        cudaGetErrorString(err));
+  }
+  return Status::OK();
+}
+
+template <typename T, typename Index>
+Status SortedSegmentReduce(OpKernelContext* ctx, const GPUDevice& d,
+                           const Index output_rows,
+                           const TensorShape& segment_ids_shape,
+                           typename TTypes<Index>::ConstFlat segment_ids,
+                           const Index data_size, const T* data,
+                           const bool mean,
+                           typename TTypes<T, 2>::Tensor output) {
   if (output.size() == 0) {
-    return;
+    return Status::OK();
   }
   // Set 'output' to zeros.
   CudaLaunchConfig config = GetCudaLaunchConfig(output.size(), d);
   SetZero<<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
       output.size(), output.data());
   if (data_size == 0 || segment_ids_shape.num_elements() == 0) {
-    return;
+    return Status::OK();
   }
 
-  // Launch kernel to compute sorted segment sum.
   // Notes:
   // *) 'input_total_size' is the total number of elements to process.
   // *) 'segment_ids.shape' is a prefix of data's shape.
@@ -153,19 +303,89 @@ void SegmentSumFunctor<T, Index>::operator()(
   const Index input_outer_dim_size = segment_ids.dimension(0);
   const Index input_inner_dim_size = input_total_size / input_outer_dim_size;
 
-  const int OuterDimTileSize = 8;
+  const bool segmented =
+      input_outer_dim_size >= kMinSegmentedAverageLength * output_rows;
+  Tensor offsets;
+  const Index* offsets_ptr = nullptr;
+  if (segmented || mean) {
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<Index>::value,
+                                          TensorShape({output_rows + 1}),
+                                          &offsets));
+    offsets_ptr = offsets.flat<Index>().data();
+    ComputeSegmentOffsets(d, input_outer_dim_size, output_rows,
+                          segment_ids.data(), offsets.flat<Index>().data());
+  }
 
-  const Index input_outer_dim_num_stripe =
-      Eigen::divup(input_outer_dim_size, Index(OuterDimTileSize));
+  if (segmented && input_inner_dim_size == 1 &&
+      !std::is_same<T, Eigen::half>::value &&
+      output_rows <= std::numeric_limits<int>::max()) {
+    TF_RETURN_IF_ERROR(SortedSegmentSumWithCub(ctx, d, output_rows,
+                                               offsets_ptr, data,
+                                               output.data()));
+  } else if (segmented) {
+    constexpr int kColumnsPerBlock = 32;
+    constexpr int kRowsPerBlock = 8;
+    const Index num_work = output_rows * Eigen::divup(input_inner_dim_size,
+                                                      Index(kColumnsPerBlock));
+    const int num_blocks = static_cast<int>(std::min<Index>(
+        num_work, d.getNumCudaMultiProcessors() *
+                      d.maxCudaThreadsPerMultiProcessor() /
+                      (kColumnsPerBlock * kRowsPerBlock)));
+    SortedSegmentReduceKernel<T, Index, kColumnsPerBlock, kRowsPerBlock>
+        <<<num_blocks, dim3(kColumnsPerBlock, kRowsPerBlock), 0,
+           d.stream()>>>(
+            input_outer_dim_size, input_inner_dim_size, output_rows,
+            offsets_ptr, data, mean, output.data());
+    // SortedSegmentReduceKernel already divides by the segment sizes.
+    return Status::OK();
+  } else {
+    // Launch kernel to compute sorted segment sum.
+    const int OuterDimTileSize = 8;
+
+    const Index input_outer_dim_num_stripe =
+        Eigen::divup(input_outer_dim_size, Index(OuterDimTileSize));
+
+    const Index total_stripe_count =
+        input_inner_dim_size * input_outer_dim_num_stripe;
+
+    config = GetCudaLaunchConfig(total_stripe_count, d);
+    SortedSegmentSumCustomKernel<T, Index, OuterDimTileSize>
+        <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+            input_outer_dim_size, input_inner_dim_size, output_rows,
+            segment_ids.data(), data, output.data(), total_stripe_count);
+  }
 
-  const Index total_stripe_count =
-      input_inner_dim_size * input_outer_dim_num_stripe;
+  if (mean) {
+    config = GetCudaLaunchConfig(output.size(), d);
+    SegmentMeanDivideKernel<T, Index>
+        <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+            output_rows, input_inner_dim_size, offsets_ptr, output.data());
+  }
+  return Status::OK();
+}
 
-  config = GetCudaLaunchConfig(total_stripe_count, d);
-  SortedSegmentSumCustomKernel<T, Index, OuterDimTileSize>
-      <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
-          input_outer_dim_size, input_inner_dim_size, output_rows,
-          segment_ids.data(), data, output.data(), total_stripe_count);
+}  // namespace
+
+template <typename T, typename Index>
+Status SegmentSumFunctor<T, Index>::operator()(
+    OpKernelContext* ctx, const GPUDevice& d, const Index output_rows,
+    const TensorShape& segment_ids_shape,
+    typename TTypes<Index>::ConstFlat segment_ids, const Index data_size,
+    const T* data, typename TTypes<T, 2>::Tensor output) {
+  return SortedSegmentReduce<T, Index>(ctx, d, output_rows, segment_ids_shape,
+                                       segment_ids, data_size, data,
+                                       /*mean=*/false, output);
+}
+
+template <typename T, typename Index>
+Status SegmentMeanFunctor<T, Index>::operator()(
+    OpKernelContext* ctx, const GPUDevice& d, const Index output_rows,
+    const TensorShape& segment_ids_shape,
+    typename TTypes<Index>::ConstFlat segment_ids, const Index data_size,
+    const T* data, typename TTypes<T, 2>::Tensor output) {
+  return SortedSegmentReduce<T, Index>(ctx, d, output_rows, segment_ids_shape,
+                                       segment_ids, data_size, data,
+                                       /*mean=*/true, output);
 }
 
 template <typename T, typename Index, typename InitialValueF,
@@ -203,8 +423,9 @@ struct UnsortedSegmentFunctor<GPUDevice, T, Index, InitialValueF, ReductionF> {
   }
 };
 
-#define DEFINE_SORTED_GPU_SPECS_INDEX(T, Index) \
-  template struct SegmentSumFunctor<T, Index>
+#define DEFINE_SORTED_GPU_SPECS_INDEX(T, Index)  \
+  template struct SegmentSumFunctor<T, Index>; \
+  template struct SegmentMeanFunctor<T, Index>
 
 #define DEFINE_SORTED_GPU_SPECS(T)         \
   DEFINE_SORTED_GPU_SPECS_INDEX(T, int32); \
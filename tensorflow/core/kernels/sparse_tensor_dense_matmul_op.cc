@@ -19,6 +19,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <vector>
+
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/bounds_check.h"
@@ -253,62 +255,96 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
     const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
     const int lhs_index_a = ADJ_A ? 1 : 0;
     const int rhs_index_a = ADJ_A ? 0 : 1;
+    const int64 num_rows = out.dimension(0);
+
+    // Group the nonzeros by output row, as in the CSR format: the nonzeros of
+    // row m are order[row_start[m]] .. order[row_start[m + 1] - 1]. Rows of
+    // the output can then be computed in parallel without sharing any of
+    // them between threads.
+    std::vector<Tindices> a_rows(nnz);
+    std::vector<Tindices> a_cols(nnz);
+    std::vector<int64> row_start(num_rows + 1, 0);
+    for (std::size_t i = 0; i < nnz; ++i) {
+      const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+      const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+      if (!FastBoundsCheck(k, lhs_right)) {
+        return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+      }
+      if (!FastBoundsCheck(m, num_rows)) {
+        return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+      }
+      a_rows[i] = m;
+      a_cols[i] = k;
+      ++row_start[m + 1];
+    }
+    for (int64 m = 0; m < num_rows; ++m) {
+      row_start[m + 1] += row_start[m];
+    }
+    std::vector<int64> order(nnz);
+    {
+      std::vector<int64> next(row_start.begin(), row_start.end() - 1);
+      for (std::size_t i = 0; i < nnz; ++i) {
+        order[next[a_rows[i]]++] = i;
+      }
+    }
 
-    out.setZero();
-
-    // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-    // approach that achieves the performance of the single threaded
-    // one.  Perhaps Eigen threadpool implementation is just too slow?
+    // Each row costs about one multiply-add per nonzero and output column.
+    const double nnz_per_row = static_cast<double>(nnz) / num_rows;
+    const Eigen::TensorOpCost cost(
+        nnz_per_row * rhs_right * sizeof(T), rhs_right * sizeof(T),
+        nnz_per_row * rhs_right *
+            (Eigen::TensorOpCost::AddCost<T>() +
+             Eigen::TensorOpCost::MulCost<T>()));
 
     if (rhs_right < kNumVectorize) {
       // Disable vectorization if the RHS of output is too small
       auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
 
-      for (std::size_t i = 0; i < nnz; ++i) {
-        const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
-        const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
-        if (!FastBoundsCheck(k, lhs_right)) {
-          return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
-        }
-        if (!FastBoundsCheck(m, out.dimension(0))) {
-          return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));
-        }
-        const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
-        for (std::size_t n = 0; n < rhs_right; ++n) {
-          const T b_value = maybe_adjoint_b(k, n);
-          out(m, n) += a_value * b_value;
+      d.parallelFor(num_rows, cost, [&](int64 begin, int64 end) {
+        for (int64 m = begin; m < end; ++m) {
+          for (std::size_t n = 0; n < rhs_right; ++n) {
+            out(m, n) = T(0);
+          }
+          for (int64 j = row_start[m]; j < row_start[m + 1]; ++j) {
+            const int64 i = order[j];
+            const Tindices k = a_cols[i];
+            const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+            for (std::size_t n = 0; n < rhs_right; ++n) {
+              const T b_value = maybe_adjoint_b(k, n);
+              out(m, n) += a_value * b_value;
+            }
+          }
         }
-      }
+      });
     } else {
-      // Vectorization via Eigen.
+      // Vectorization via Eigen, over the columns of the output.
       const int b_chip_index = ADJ_B ? 1 : 0;
 
-#define LOOP_NNZ(b_passed)                                                  \
-  for (std::size_t i = 0; i < nnz; ++i) {                                   \
-    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a)); \
-    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a)); \
-    const T a_value = (ADJ_A) ? MaybeConj(a_values(i)) : a_values(i);       \
-    if (!FastBoundsCheck(k, lhs_right)) {                                   \
-      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);               \
-    }                                                                       \
-    if (!FastBoundsCheck(m, out.dimension(0))) {                            \
-      return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));        \
+#define LOOP_ROWS(b_passed)                                                 \
+  d.parallelFor(num_rows, cost, [&](int64 begin, int64 end) {               \
+    for (int64 m = begin; m < end; ++m) {                                   \
+      auto out_row = out.template chip<0>(m);                               \
+      out_row.setZero();                                                    \
+      for (int64 j = row_start[m]; j < row_start[m + 1]; ++j) {             \
+        const int64 i = order[j];                                           \
+        const T a_value = (ADJ_A) ? MaybeConj(a_values(i)) : a_values(i);   \
+        out_row +=                                                          \
+            b_passed.template chip<b_chip_index>(a_cols[i]) * a_value;      \
+      }                                                                     \
     }                                                                       \
-    out.template chip<0>(m) +=                                              \
-        b_passed.template chip<b_chip_index>(k) * a_value;                  \
-  }
+  });
 
       if (ADJ_B) {
         // Perform transpose and conjugation on B once, since we chip out B's
-        // columns in the nnz loop.
+        // columns in the row loop.
         Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
         Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
             b.swap_layout().shuffle(shuffle).conjugate();
-        LOOP_NNZ(col_major_conj_b);
+        LOOP_ROWS(col_major_conj_b);
       } else {
-        LOOP_NNZ(b);
+        LOOP_ROWS(b);
       }
-#undef LOOP_NNZ
+#undef LOOP_ROWS
     }
     return Status::OK();
   }
@@ -32,9 +32,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/strided_slice_op.h"
 
@@ -300,16 +302,32 @@ class StridedSliceAssignOp : public OpKernel {
     gtl::InlinedVector<int64, 4> strides;
 
     Tensor old_lhs;
+    Var* v = nullptr;
+    // The assignment runs without the variable's lock, so publishing its
+    // snapshot at the end takes the lock again.
+    auto publish = gtl::MakeCleanup([&v] {
+      if (v == nullptr) return;
+      if (v->snapshot_enabled()) {
+        mutex_lock ml(*v->mu());
+        v->PublishSnapshot();
+      }
+      v->Unref();
+    });
     if (context->input_dtype(0) == DT_RESOURCE) {
-      Var* v;
       OP_REQUIRES_OK(context,
                      LookupResource(context, HandleFromInput(context, 0), &v));
-      old_lhs = *v->tensor();
-      OP_REQUIRES(context, old_lhs.dtype() == DataTypeToEnum<T>::value,
+      mutex_lock ml(*v->mu());
+      OP_REQUIRES(context, v->tensor()->dtype() == DataTypeToEnum<T>::value,
                   errors::InvalidArgument(
-                      "l-value dtype ", DataTypeString(old_lhs.dtype()),
+                      "l-value dtype ", DataTypeString(v->tensor()->dtype()),
                       " does not match r-value dtype ",
                       DataTypeString(DataTypeToEnum<T>::value)));
+      // The snapshot must keep its value, so it cannot be assigned in place.
+      if (v->SnapshotSharesBuffer()) {
+        OP_REQUIRES_OK(context, PrepareToUpdateVariable<Device, T>(
+                                    context, v->tensor()));
+      }
+      old_lhs = *v->tensor();
     } else {
       context->forward_ref_input_to_ref_output(0, 0);
       old_lhs = context->mutable_input(0, true);
@@ -0,0 +1,60 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/string_ops.cc.
+
+#include <string>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+class StringLowerOp : public OpKernel {
+ public:
+  explicit StringLowerOp(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    // Forward the input when nothing else uses it, so that the strings are
+    // folded in place without copying them.
+    Tensor* output_tensor;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {0}, 0, ctx->input(0).shape(), &output_tensor));
+    const auto input = ctx->input(0).flat<string>();
+    auto output = output_tensor->flat<string>();
+    const bool forwarded = output.data() == input.data();
+
+    const int64 size = input.size();
+    if (size == 0) return;
+    const int64 cost_per_unit = ctx->input(0).TotalBytes() / size;
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, size,
+          cost_per_unit, [&](int64 start, int64 limit) {
+            for (int64 i = start; i < limit; ++i) {
+              if (!forwarded) output(i) = input(i);
+              for (char& c : output(i)) {
+                if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+              }
+            }
+          });
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("StringLower").Device(DEVICE_CPU), StringLowerOp);
+
+}  // namespace tensorflow
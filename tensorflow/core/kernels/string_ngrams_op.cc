@@ -0,0 +1,198 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/string_ops.cc.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+template <typename SPLITS_TYPE>
+class StringNGramsOp : public OpKernel {
+ public:
+  explicit StringNGramsOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("separator", &separator_));
+    OP_REQUIRES_OK(context, context->GetAttr("ngram_widths", &ngram_widths_));
+    for (int width : ngram_widths_) {
+      OP_REQUIRES(context, width >= 1,
+                  errors::InvalidArgument(
+                      "ngram_widths must be positive, got ", width));
+    }
+    OP_REQUIRES_OK(context, context->GetAttr("left_pad", &left_pad_));
+    OP_REQUIRES_OK(context, context->GetAttr("right_pad", &right_pad_));
+    OP_REQUIRES_OK(context, context->GetAttr("pad_width", &pad_width_));
+    OP_REQUIRES_OK(context, context->GetAttr("preserve_short_sequences",
+                                             &preserve_short_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& data_tensor = context->input(0);
+    const Tensor& splits_tensor = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(data_tensor.shape()),
+                errors::InvalidArgument("data must be a vector, got shape: ",
+                                        data_tensor.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(splits_tensor.shape()),
+                errors::InvalidArgument(
+                    "data_splits must be a vector, got shape: ",
+                    splits_tensor.shape().DebugString()));
+    const auto data = data_tensor.vec<string>();
+    const auto splits = splits_tensor.vec<SPLITS_TYPE>();
+    const int64 num_splits = splits.size();
+    OP_REQUIRES(context, num_splits >= 1,
+                errors::InvalidArgument("data_splits must not be empty."));
+    OP_REQUIRES(context, splits(0) == 0,
+                errors::InvalidArgument("data_splits must start with 0, got ",
+                                        splits(0)));
+    OP_REQUIRES(context, splits(num_splits - 1) == data.size(),
+                errors::InvalidArgument(
+                    "data_splits must end with the size of data ",
+                    data.size(), ", got ", splits(num_splits - 1)));
+    const int64 num_rows = num_splits - 1;
+
+    // Count the n-grams of every row to lay out the ragged output.
+    Tensor* ngrams_splits_tensor;
+    OP_REQUIRES_OK(context, context->allocate_output(1, splits_tensor.shape(),
+                                                     &ngrams_splits_tensor));
+    auto ngrams_splits = ngrams_splits_tensor->vec<SPLITS_TYPE>();
+    ngrams_splits(0) = 0;
+    for (int64 i = 0; i < num_rows; ++i) {
+      OP_REQUIRES(context, splits(i) <= splits(i + 1),
+                  errors::InvalidArgument(
+                      "data_splits must be non-decreasing, got ", splits(i),
+                      " followed by ", splits(i + 1)));
+      ngrams_splits(i + 1) =
+          ngrams_splits(i) + NumRowNGrams(splits(i + 1) - splits(i));
+    }
+
+    Tensor* ngrams_tensor;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({ngrams_splits(num_rows)}),
+                       &ngrams_tensor));
+    auto ngrams = ngrams_tensor->vec<string>();
+    if (num_rows == 0 || ngrams.size() == 0) return;
+
+    // Building an n-gram copies roughly the bytes of its widest tokens once.
+    int64 max_width = 1;
+    for (int width : ngram_widths_) {
+      max_width = std::max<int64>(max_width, width);
+    }
+    const int64 cost_per_row = max_width * data_tensor.TotalBytes() / num_rows;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          cost_per_row, [&](int64 start, int64 limit) {
+            for (int64 i = start; i < limit; ++i) {
+              const string* row = data.data() + splits(i);
+              const int length = splits(i + 1) - splits(i);
+              string* output = ngrams.data() + ngrams_splits(i);
+              int num_output = 0;
+              for (int width : ngram_widths_) {
+                const int num_ngrams = NumNGrams(length, width);
+                CreateNGrams(row, length, width, PadWidth(width), num_ngrams,
+                             output + num_output);
+                num_output += num_ngrams;
+              }
+              if (num_output == 0 && ngrams_splits(i + 1) > ngrams_splits(i)) {
+                // A preserved short sequence is a single n-gram of the whole
+                // row.
+                const int pad = std::max(pad_width_, 0);
+                CreateNGrams(row, length, length + 2 * pad, pad, 1, output);
+              }
+            }
+          });
+  }
+
+ private:
+  // Returns the padding on each side of a row for n-grams of width.
+  int PadWidth(int width) const {
+    return std::min(pad_width_ < 0 ? width - 1 : pad_width_, width - 1);
+  }
+
+  // Returns the number of n-grams of width for a row of length tokens. Empty
+  // rows have none, rather than n-grams made only of padding.
+  int NumNGrams(int length, int width) const {
+    if (length == 0) return 0;
+    return std::max(0, length + 2 * PadWidth(width) - width + 1);
+  }
+
+  // Returns the number of n-grams of all the widths for a row of length
+  // tokens.
+  int64 NumRowNGrams(int64 length) const {
+    int64 num_ngrams = 0;
+    for (int width : ngram_widths_) num_ngrams += NumNGrams(length, width);
+    if (preserve_short_ && length > 0 && num_ngrams == 0) num_ngrams = 1;
+    return num_ngrams;
+  }
+
+  // Writes the num_ngrams n-grams of width of the row of length tokens, padded
+  // by pad on each side, to output.
+  void CreateNGrams(const string* row, int length, int width, int pad,
+                    int num_ngrams, string* output) const {
+    for (int n = 0; n < num_ngrams; ++n) {
+      const int left_padding = std::max(0, pad - n);
+      const int right_padding = std::max(0, pad - (num_ngrams - (n + 1)));
+      const int num_tokens = width - (left_padding + right_padding);
+      const string* tokens = row + std::max(0, n - pad);
+      DCHECK_LE(num_tokens, length);
+
+      // Size the n-gram first so that it is built with a single allocation.
+      const int num_pieces = left_padding + num_tokens + right_padding;
+      size_t ngram_size = left_padding * left_pad_.size() +
+                          right_padding * right_pad_.size() +
+                          (num_pieces - 1) * separator_.size();
+      for (int t = 0; t < num_tokens; ++t) ngram_size += tokens[t].size();
+
+      string* ngram = output + n;
+      ngram->clear();
+      ngram->reserve(ngram_size);
+      int num_appended = 0;
+      auto append = [&](const string& piece) {
+        if (num_appended++ > 0) ngram->append(separator_);
+        ngram->append(piece);
+      };
+      for (int p = 0; p < left_padding; ++p) append(left_pad_);
+      for (int t = 0; t < num_tokens; ++t) append(tokens[t]);
+      for (int p = 0; p < right_padding; ++p) append(right_pad_);
+    }
+  }
+
+  string separator_;
+  string left_pad_;
+  string right_pad_;
+  bool preserve_short_;
+  std::vector<int32> ngram_widths_;
+  int pad_width_;
+};
+
+#define REGISTER_KERNELS(SPLITS_TYPE)                                 \
+  REGISTER_KERNEL_BUILDER(Name("StringNGrams")                        \
+                              .Device(DEVICE_CPU)                     \
+                              .TypeConstraint<SPLITS_TYPE>("Tsplits"), \
+                          StringNGramsOp<SPLITS_TYPE>);
+
+REGISTER_KERNELS(int32);
+REGISTER_KERNELS(int64);
+
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
@@ -15,33 +15,79 @@ limitations under the License.
 
 // See docs in ../ops/string_ops.cc.
 
+#include <string.h>
+
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
 
 namespace tensorflow {
 
 namespace {
 
-std::vector<string> Split(const string& str, const string& delimiter,
-                          const bool skipEmpty) {
-  if (!delimiter.empty()) {
-    if (skipEmpty) {
-      return str_util::Split(str, delimiter, str_util::SkipEmpty());
+// Splits strings into tokens at any of the characters of a delimiter, or into
+// single characters if the delimiter is empty. The tokens are pieces of the
+// input, so splitting allocates nothing per token; they are only copied into
+// the output tensor.
+class Splitter {
+ public:
+  Splitter(const string& delimiter, bool skip_empty)
+      : delimiter_(delimiter),
+        skip_empty_(skip_empty),
+        single_delimiter_(!delimiter.empty() &&
+                          delimiter.find_first_not_of(delimiter[0]) ==
+                              string::npos) {
+    std::fill(is_delimiter_, is_delimiter_ + 256, false);
+    for (char c : delimiter) is_delimiter_[static_cast<uint8>(c)] = true;
+  }
+
+  // Appends the tokens of str to tokens.
+  void Split(StringPiece str, std::vector<StringPiece>* tokens) const {
+    if (delimiter_.empty()) {
+      for (size_t i = 0; i < str.size(); ++i) {
+        tokens->emplace_back(str.data() + i, 1);
+      }
+      return;
+    }
+    if (str.empty()) return;
+    const char* pos = str.data();
+    const char* const end = pos + str.size();
+    while (true) {
+      const char* token_end = FindDelimiter(pos, end);
+      if (!skip_empty_ || token_end > pos) {
+        tokens->emplace_back(pos, token_end - pos);
+      }
+      if (token_end == end) return;
+      pos = token_end + 1;
     }
-    return str_util::Split(str, delimiter);
   }
-  std::vector<string> char_vector(str.size());
-  for (size_t i = 0; i < str.size(); ++i) {
-    char_vector[i] = str[i];
+
+ private:
+  // Returns the first delimiter in [begin, end), or end.
+  const char* FindDelimiter(const char* begin, const char* end) const {
+    // memchr scans many bytes at a time, so use it for the common case of a
+    // single delimiter character.
+    if (single_delimiter_) {
+      const void* found = memchr(begin, delimiter_[0], end - begin);
+      return found == nullptr ? end : static_cast<const char*>(found);
+    }
+    const char* pos = begin;
+    while (pos < end && !is_delimiter_[static_cast<uint8>(*pos)]) ++pos;
+    return pos;
   }
-  return char_vector;
-}
+
+  const string& delimiter_;
+  const bool skip_empty_;
+  const bool single_delimiter_;
+  bool is_delimiter_[256];
+};
 
 }  // namespace
 
@@ -76,22 +122,22 @@ class StringSplitOp : public OpKernel {
     const auto delimiter_vec = delimiter_tensor->flat<string>();
     const string& delimiter = delimiter_vec(0);
     // Empty delimiter means split the input character by character.
-    std::vector<string> tokens;
+    const Splitter splitter(delimiter, skip_empty_);
+    std::vector<StringPiece> tokens;
     // Guess that we'll be unpacking a handful of tokens per example.
     static constexpr int kReserveSize = 4;
     tokens.reserve(batch_size * kReserveSize);
 
-    int64 output_size = 0;
     int64 max_num_entries = 0;
     std::vector<int64> num_indices(batch_size);
     for (int64 i = 0; i < batch_size; ++i) {
-      std::vector<string> parts = Split(input_vec(i), delimiter, skip_empty_);
-      int64 n_entries = parts.size();
+      const size_t num_tokens = tokens.size();
+      splitter.Split(input_vec(i), &tokens);
+      const int64 n_entries = tokens.size() - num_tokens;
       num_indices[i] = n_entries;
-      output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
+    const int64 output_size = tokens.size();
 
     Tensor* sp_indices_t;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
@@ -112,7 +158,7 @@ class StringSplitOp : public OpKernel {
       for (size_t j = 0; j < num_indices[i]; ++j) {
         sp_indices(c, 0) = i;
         sp_indices(c, 1) = j;
-        sp_tokens(c) = tokens[c];
+        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
         ++c;
       }
     }
@@ -33,23 +33,23 @@ class LegacyStringToHashBucketOp : public OpKernel {
   void Compute(OpKernelContext* context) override {
     const Tensor* input_tensor;
     OP_REQUIRES_OK(context, context->input("string_tensor", &input_tensor));
-    const auto& input_flat = input_tensor->flat<string>();
 
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(context,
                    context->allocate_output("output", input_tensor->shape(),
                                             &output_tensor));
-    auto output_flat = output_tensor->flat<int64>();
-
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = Hash64(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    const uint64 num_buckets = num_buckets_;
+    ComputeHashBuckets(
+        context, *input_tensor,
+        [num_buckets](const string& input) {
+          const uint64 input_hash = Hash64(input);
+          const uint64 bucket_id = input_hash % num_buckets;
+          // The number of buckets is always in the positive range of int64 so
+          // is the resulting bucket_id. Casting the bucket_id from uint64 to
+          // int64 is safe.
+          return static_cast<int64>(bucket_id);
+        },
+        output_tensor);
   }
 
  private:
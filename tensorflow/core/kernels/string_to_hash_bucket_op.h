@@ -23,9 +23,31 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+// Sets every element of output to bucket_fn of the corresponding element of
+// input, sharding the strings over the CPU worker threads.
+template <typename BucketFn>
+void ComputeHashBuckets(OpKernelContext* context, const Tensor& input,
+                        BucketFn bucket_fn, Tensor* output) {
+  const auto& input_flat = input.flat<string>();
+  auto output_flat = output->flat<int64>();
+  const int64 size = input_flat.size();
+  if (size == 0) return;
+  // Hashing costs a few cycles per byte, TotalBytes including the string
+  // headers.
+  const int64 cost_per_unit = 4 * input.TotalBytes() / size;
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, size,
+        cost_per_unit, [&](int64 start, int64 limit) {
+          for (int64 i = start; i < limit; ++i) {
+            output_flat(i) = bucket_fn(input_flat(i));
+          }
+        });
+}
+
 template <uint64 hash(StringPiece)>
 class StringToHashBucketOp : public OpKernel {
  public:
@@ -36,23 +58,23 @@ class StringToHashBucketOp : public OpKernel {
   void Compute(OpKernelContext* context) override {
     const Tensor* input_tensor;
     OP_REQUIRES_OK(context, context->input("input", &input_tensor));
-    const auto& input_flat = input_tensor->flat<string>();
 
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(context,
                    context->allocate_output("output", input_tensor->shape(),
                                             &output_tensor));
-    auto output_flat = output_tensor->flat<int64>();
-
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    const uint64 num_buckets = num_buckets_;
+    ComputeHashBuckets(
+        context, *input_tensor,
+        [num_buckets](const string& input) {
+          const uint64 input_hash = hash(input);
+          const uint64 bucket_id = input_hash % num_buckets;
+          // The number of buckets is always in the positive range of int64 so
+          // is the resulting bucket_id. Casting the bucket_id from uint64 to
+          // int64 is safe.
+          return static_cast<int64>(bucket_id);
+        },
+        output_tensor);
   }
 
  private:
@@ -78,23 +100,23 @@ class StringToKeyedHashBucketOp : public OpKernel {
   void Compute(OpKernelContext* context) override {
     const Tensor* input_tensor;
     OP_REQUIRES_OK(context, context->input("input", &input_tensor));
-    const auto& input_flat = input_tensor->flat<string>();
 
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(context,
                    context->allocate_output("output", input_tensor->shape(),
                                             &output_tensor));
-    auto output_flat = output_tensor->flat<int64>();
-
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(key_, input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    const uint64 num_buckets = num_buckets_;
+    ComputeHashBuckets(
+        context, *input_tensor,
+        [this, num_buckets](const string& input) {
+          const uint64 input_hash = hash(key_, input);
+          const uint64 bucket_id = input_hash % num_buckets;
+          // The number of buckets is always in the positive range of int64 so
+          // is the resulting bucket_id. Casting the bucket_id from uint64 to
+          // int64 is safe.
+          return static_cast<int64>(bucket_id);
+        },
+        output_tensor);
   }
 
  private:
@@ -99,6 +99,12 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+// TopK selects the top elements of each row, rather than keeping them in a
+// heap, when there are at most this many columns per top element. On random
+// rows of 100K to 1M columns, selecting is already faster from around
+// k = num_cols / 64.
+constexpr int64 kMinColsPerKForHeap = 32;
+
 template <typename T>
 struct TopKFunctor<CPUDevice, T> {
   static EIGEN_ALWAYS_INLINE Status
@@ -135,6 +141,8 @@ struct TopKFunctor<CPUDevice, T> {
     }
 
     auto SortIndices = [&, context](int start_batch, int limit_batch) {
+      // The indices of a whole row, when selecting the top k in place.
+      std::vector<int32> row_indices;
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
         const auto stable_comp = [input_data](const int32 a, const int32 b) {
@@ -149,11 +157,6 @@ struct TopKFunctor<CPUDevice, T> {
         const auto comp = [input_data](const int32 a, const int32 b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -176,6 +179,20 @@ struct TopKFunctor<CPUDevice, T> {
             }
             run_begin = run_end;
           }
+        } else if (k >= num_cols / kMinColsPerKForHeap) {
+          // For large k, select the top k indices in linear time, and then
+          // only sort those. This is much faster than pushing every element
+          // through a heap of k elements.
+          row_indices.resize(num_cols);
+          std::iota(row_indices.begin(), row_indices.end(), 0);
+          std::nth_element(row_indices.begin(), row_indices.begin() + k - 1,
+                           row_indices.end(), stable_comp);
+          if (sorted) {
+            std::sort(row_indices.begin(), row_indices.begin() + k,
+                      stable_comp);
+          }
+          std::copy(row_indices.begin(), row_indices.begin() + k,
+                    &indices(b, 0));
         } else {
           // Use the TopN heap object to sort.
           gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
@@ -17,52 +17,64 @@ limitations under the License.
 
 namespace tensorflow {
 
-mutex* GetTrainingVariableMutex(OpKernelContext* ctx, int input) {
-  if (ctx->input_dtype(input) == DT_RESOURCE) {
-    Var* var;
-    if (LookupResource(ctx, HandleFromInput(ctx, input), &var).ok()) {
-      return var->mu();
-    } else {
-      ctx->CtxFailureWithWarning(
-          errors::Internal("Invalid variable reference."));
-      return nullptr;
+VariableInputLockHolder::~VariableInputLockHolder() {
+  for (Var* var : vars_) {
+    if (locked_) {
+      var->PublishSnapshot();
+    } else if (var->snapshot_enabled()) {
+      mutex_lock ml(*var->mu());
+      var->PublishSnapshot();
     }
   }
-  return ctx->input_ref_mutex(input);
+  // Releases the locks before the variables can be deleted.
+  locks_.clear();
+  for (Var* var : vars_) var->Unref();
 }
 
 // MaybeLockVariableInputMutexesInOrder is a helper function to acquire mutexes
-// in address order to mitigate deadlock.  Returns a vector of acquired mutexes.
-// Safe to pass duplicates - will only lock each distinct mutex once.  If
-// do_lock is false, returns immediately.  Note that this silently doesn't lock
+// in address order to mitigate deadlock.  Returns a holder of the acquired
+// mutexes.  Safe to pass duplicates - will only lock each distinct mutex once.
+// If do_lock is false, locks nothing.  Note that this silently doesn't lock
 // mutexes for invalid variable references; in all usages this is followed by
 // GetInputTensor which will signal a failure.
-std::vector<mutex_lock> MaybeLockVariableInputMutexesInOrder(
+VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
     OpKernelContext* ctx, bool do_lock, const std::vector<int>& input_ids) {
-  std::vector<mutex_lock> locks;
-  if (!do_lock) {
-    return locks;
-  }
+  std::vector<Var*> vars;
   std::vector<mutex*> mutexes;
-  std::vector<int> acquire_order;
+  mutexes.reserve(input_ids.size());
   for (auto input : input_ids) {
-    mutex* mutex = GetTrainingVariableMutex(ctx, input);
-    // Only lock each mutex once if duplicates exist (n^2 but n is 2 or 3).
-    if (std::find(mutexes.begin(), mutexes.end(), mutex) == mutexes.end()) {
-      acquire_order.push_back(mutexes.size());
-      mutexes.push_back(mutex);
+    if (ctx->input_dtype(input) == DT_RESOURCE) {
+      Var* var;
+      if (LookupResource(ctx, HandleFromInput(ctx, input), &var).ok()) {
+        vars.push_back(var);
+        mutexes.push_back(var->mu());
+      }
+    } else if (do_lock) {
+      mutexes.push_back(ctx->input_ref_mutex(input));
     }
   }
-  std::sort(acquire_order.begin(), acquire_order.end(),
-            [&mutexes](int a, int b) { return mutexes[a] < mutexes[b]; });
+  // Drop duplicate variables, which would publish their snapshot twice.
+  std::sort(vars.begin(), vars.end());
+  auto last_var = std::unique(vars.begin(), vars.end());
+  for (auto it = last_var; it != vars.end(); ++it) (*it)->Unref();
+  vars.erase(last_var, vars.end());
+
+  std::vector<mutex_lock> locks;
+  if (do_lock) {
+    // Sort by address and drop duplicates, so that each distinct mutex is
+    // locked exactly once and every caller locks them in the same order.
+    std::sort(mutexes.begin(), mutexes.end());
+    mutexes.erase(std::unique(mutexes.begin(), mutexes.end()),
+                  mutexes.end());
 
-  for (auto input : acquire_order) {
-    mutex* mu = GetTrainingVariableMutex(ctx, input);
-    if (mu != nullptr) {
-      locks.emplace_back(*mu);
+    locks.reserve(mutexes.size());
+    for (mutex* mu : mutexes) {
+      if (mu != nullptr) {
+        locks.emplace_back(*mu);
+      }
     }
   }
-  return locks;
+  return VariableInputLockHolder(std::move(vars), std::move(locks), do_lock);
 }
 
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
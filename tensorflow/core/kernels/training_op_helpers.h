@@ -23,9 +23,33 @@ limitations under the License.
 
 namespace tensorflow {
 
-mutex* GetTrainingVariableMutex(OpKernelContext* ctx, int input);
+// Returned by MaybeLockVariableInputMutexesInOrder(). Holds the acquired
+// locks until the end of the update and, before releasing them, publishes
+// the updated values of the resource variables among the inputs (see
+// Var::PublishSnapshot()). Without the locks, it takes each variable's lock
+// briefly to publish, if the variable keeps a snapshot.
+class VariableInputLockHolder {
+ public:
+  VariableInputLockHolder(std::vector<Var*> vars,
+                          std::vector<mutex_lock> locks, bool locked)
+      : vars_(std::move(vars)), locks_(std::move(locks)), locked_(locked) {}
+  VariableInputLockHolder(VariableInputLockHolder&& other)
+      : vars_(std::move(other.vars_)),
+        locks_(std::move(other.locks_)),
+        locked_(other.locked_) {
+    other.vars_.clear();
+  }
+  ~VariableInputLockHolder();
+
+ private:
+  std::vector<Var*> vars_;  // Owns one reference to each.
+  std::vector<mutex_lock> locks_;
+  bool locked_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(VariableInputLockHolder);
+};
 
-std::vector<mutex_lock> MaybeLockVariableInputMutexesInOrder(
+VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
     OpKernelContext* ctx, bool do_lock, const std::vector<int>& input_ids);
 
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
@@ -72,7 +96,8 @@ Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor) {
 // differences between reference and resource variables.  For resource
 // variables, we ensure `*out` has a reference count of 1 (using
 // PrepareToUpdateVariable() to copy if necessary) unless
-// sparse && !lock_held, in which case it never copies.
+// sparse && !lock_held, in which case it only copies if the buffer is
+// shared with the variable's snapshot.
 template <typename Device, typename T>
 Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
                                   bool lock_held, bool sparse, Tensor* out) {
@@ -86,7 +111,7 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
       *out = *var->tensor();
     } else {
       mutex_lock ml(*var->mu());
-      if (!sparse) {
+      if (!sparse || var->SnapshotSharesBuffer()) {
         TF_RETURN_IF_ERROR(
             PrepareToUpdateVariable<Device, T>(ctx, var->tensor()));
       }
@@ -18,6 +18,8 @@ limitations under the License.
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
 
 #include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_op_helpers.h"
 #include "tensorflow/core/kernels/training_ops.h"
 #include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #ifdef TENSORFLOW_USE_SYCL
 #include "tensorflow/core/common_runtime/sycl/sycl_util.h"
@@ -332,6 +335,55 @@ struct ApplyAdamSYCL {
 template <typename T>
 struct ApplyAdam<CPUDevice, T> : ApplyAdamNonCuda<CPUDevice, T> {};
 
+template <typename T>
+struct ApplyAdamN<CPUDevice, T> {
+  void operator()(const CPUDevice& d,
+                  const std::vector<typename TTypes<T>::Flat>& vars,
+                  const std::vector<typename TTypes<T>::Flat>& ms,
+                  const std::vector<typename TTypes<T>::Flat>& vs,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<typename TTypes<T>::ConstFlat>& grads,
+                  bool use_nesterov) {
+    // Large variables are split across the threads as ApplyAdam does. Small
+    // ones are not worth splitting, so instead each thread updates whole
+    // variables.
+    static constexpr int64 kMinParallelSize = 1 << 14;
+    std::vector<int> small;
+    int64 small_size = 0;
+    for (int i = 0; i < vars.size(); ++i) {
+      if (vars[i].size() >= kMinParallelSize) {
+        ApplyAdamNonCuda<CPUDevice, T>()(
+            d, vars[i], ms[i], vs[i], beta1_power, beta2_power, lr, beta1,
+            beta2, epsilon, grads[i], use_nesterov);
+      } else {
+        small.push_back(i);
+        small_size += vars[i].size();
+      }
+    }
+    if (small.empty()) return;
+
+    // Per element, the update loads var, m, v and grad, stores var, m and v,
+    // and takes a square root and a division.
+    const double avg_size = static_cast<double>(small_size) / small.size();
+    const Eigen::TensorOpCost cost(4 * sizeof(T) * avg_size,
+                                   3 * sizeof(T) * avg_size, 30 * avg_size);
+    d.parallelFor(small.size(), cost, [&](int64 start, int64 end) {
+      const Eigen::DefaultDevice device;
+      for (int64 j = start; j < end; ++j) {
+        const int i = small[j];
+        ApplyAdamNonCuda<Eigen::DefaultDevice, T>()(
+            device, vars[i], ms[i], vs[i], beta1_power, beta2_power, lr, beta1,
+            beta2, epsilon, grads[i], use_nesterov);
+      }
+    });
+  }
+};
+
 template <typename Device, typename T>
 struct ApplyAdaMaxNonCuda {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
@@ -562,21 +614,11 @@ class ApplyAdadeltaOp : public OpKernel {
   }
 
   void Compute(OpKernelContext* ctx) override {
-    mutex* mu = GetTrainingVariableMutex(ctx, 0);
-    if (use_exclusive_lock_ && mu != nullptr) {
-      mutex_lock l1(*mu);
-      // Don't try to acquire a lock on the second ref as they share the same
-      // mutex.
-      //
-      // mutex_lock l2(*ctx->input_ref_mutex(1));
-      DoValidate(ctx);
-      if (!ctx->status().ok()) return;
-      DoCompute(ctx);
-    } else {
-      DoValidate(ctx);
-      if (!ctx->status().ok()) return;
-      DoCompute(ctx);
-    }
+    auto locks = MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_,
+                                                      {0, 1, 2});
+    DoValidate(ctx);
+    if (!ctx->status().ok()) return;
+    DoCompute(ctx);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -711,17 +753,9 @@ class SparseApplyAdadeltaOp : public OpKernel {
   }
 
   void Compute(OpKernelContext* ctx) override {
-    mutex* mu = GetTrainingVariableMutex(ctx, 0);
-    // mu_accum is actually the same mutex as mu_var since currently we use a
-    // global mutex.
-    //
-    // mutex* mu_accum = ctx->input_ref_mutex(1);
-    if (use_exclusive_lock_ && mu != nullptr) {
-      mutex_lock ml(*mu);
-      DoCompute(ctx);
-    } else {
-      DoCompute(ctx);
-    }
+    auto locks = MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_,
+                                                      {0, 1, 2});
+    DoCompute(ctx);
   }
 
   void DoCompute(OpKernelContext* ctx) {
@@ -1263,6 +1297,80 @@ inline T FtrlCompute(const T& accum, const T& linear, const T& lr, const T& l1,
   auto l1_reg_adjust = std::max(std::min(linear, l1), -l1);
   return (l1_reg_adjust - linear) / quadratic;
 }
+
+// The rows of a sparse gradient with duplicate indices combined: each
+// distinct index appears once, with the sum of the gradient rows for it, so
+// that the rows of the variable can be updated independently of each other.
+template <typename T, typename Tindex>
+class UniqueSparseGradient {
+ public:
+  // Fails if an index is not in [0, first_dim_size). grad must not be empty.
+  Status Init(OpKernelContext* ctx, const Tensor& grad, const Tensor& indices,
+              Tindex first_dim_size) {
+    const auto indices_vec = indices.vec<Tindex>();
+    const int64 n = indices_vec.size();
+    std::unordered_map<Tindex, int64> positions;
+    positions.reserve(n);
+    std::vector<int64> segments(n);
+    indices_.clear();
+    indices_.reserve(n);
+    for (int64 i = 0; i < n; ++i) {
+      const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+      if (!FastBoundsCheck(index, first_dim_size)) {
+        return errors::InvalidArgument(strings::StrCat(
+            "Index ", index, " at offset ", i, " in indices is out of range"));
+      }
+      auto inserted = positions.emplace(index, indices_.size());
+      if (inserted.second) indices_.push_back(index);
+      segments[i] = inserted.first->second;
+    }
+    if (static_cast<int64>(indices_.size()) == n) {
+      grad_ = grad;
+      return Status::OK();
+    }
+
+    const int64 inner_dim = grad.NumElements() / n;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DataTypeToEnum<T>::value,
+        TensorShape({static_cast<int64>(indices_.size()), inner_dim}),
+        &grad_));
+    auto summed = grad_.matrix<T>();
+    summed.setZero();
+    const auto grad_flat = grad.flat_outer_dims<T>();
+    for (int64 i = 0; i < n; ++i) {
+      summed.template chip<0>(segments[i]) += grad_flat.template chip<0>(i);
+    }
+    return Status::OK();
+  }
+
+  // The number of distinct indices.
+  int64 size() const { return indices_.size(); }
+
+  // The i-th distinct index.
+  Tindex index(int64 i) const { return indices_[i]; }
+
+  // The gradient rows, where row i is for index(i).
+  typename TTypes<T>::ConstMatrix grad() const {
+    return grad_.flat_outer_dims<T>();
+  }
+
+ private:
+  std::vector<Tindex> indices_;
+  Tensor grad_;
+};
+
+// Runs update(i) for each row i of sparse_grad, spread across the CPU worker
+// threads. cost_per_row is the estimated cost of an update, in cycles.
+template <typename T, typename Tindex, typename Update>
+void ForEachSparseRow(OpKernelContext* ctx,
+                      const UniqueSparseGradient<T, Tindex>& sparse_grad,
+                      int64 cost_per_row, const Update& update) {
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        sparse_grad.size(), cost_per_row, [&](int64 start, int64 limit) {
+          for (int64 i = start; i < limit; ++i) update(i);
+        });
+}
 }  // namespace
 
 // Note, this op works on cpu only.
@@ -1326,51 +1434,38 @@ class SparseApplyAdagradOp : public OpKernel {
                     "Inner dimension should be greater than zero."));
 
     if (N > 0) {
-      if (inner_dim > 1) {
-        const Tindex first_dim_size = var.dim_size(0);
-        auto indices_vec = indices.vec<Tindex>();
-        auto var_flat = var.flat_outer_dims<T>();
-        auto accum_flat = accum.flat_outer_dims<T>();
-        auto grad_flat = grad.flat_outer_dims<T>();
-        T lr_scalar = lr.scalar<T>()();
+      // Duplicate indices are combined first, so that each row is updated
+      // once with its total gradient and the rows can be updated in parallel.
+      UniqueSparseGradient<T, Tindex> sparse_grad;
+      OP_REQUIRES_OK(ctx,
+                     sparse_grad.Init(ctx, grad, indices, var.dim_size(0)));
+      auto var_flat = var.flat_outer_dims<T>();
+      auto accum_flat = accum.flat_outer_dims<T>();
+      const auto grad_flat = sparse_grad.grad();
+      const T lr_scalar = lr.scalar<T>()();
+      const bool update_slots = update_slots_;
 
-        // Note(yonghui): It might be worth multi-threading square() and
-        // rsqrt().
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          OP_REQUIRES(ctx, FastBoundsCheck(index, first_dim_size),
-                      errors::InvalidArgument(
-                          strings::StrCat("Index ", index, " at offset ", i,
-                                          " in indices is out of range")));
+      if (inner_dim > 1) {
+        ForEachSparseRow(ctx, sparse_grad, 10 * inner_dim, [&](int64 i) {
+          const Tindex index = sparse_grad.index(i);
           auto a = accum_flat.template chip<0>(index);
           auto g = grad_flat.template chip<0>(i);
           auto v = var_flat.template chip<0>(index);
-          if (update_slots_) {
+          if (update_slots) {
             a += g.square();
           }
           v -= g.constant(lr_scalar) * g * a.rsqrt();
-        }
+        });
       } else {
-        auto indices_vec = indices.vec<Tindex>();
-        auto var_flat = var.flat<T>();
-        auto accum_flat = accum.flat<T>();
-        auto grad_flat = grad.flat<T>();
-        T lr_scalar = lr.scalar<T>()();
-        const Tindex first_dim_size = accum_flat.size();
-
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          OP_REQUIRES(ctx, FastBoundsCheck(index, first_dim_size),
-                      errors::InvalidArgument(
-                          strings::StrCat("Index ", index, " at offset ", i,
-                                          " in indices is out of range")));
-          T& a = accum_flat(index);
-          const T& g = grad_flat(i);
-          if (update_slots_) {
+        ForEachSparseRow(ctx, sparse_grad, 10, [&](int64 i) {
+          const Tindex index = sparse_grad.index(i);
+          T& a = accum_flat(index, 0);
+          const T& g = grad_flat(i, 0);
+          if (update_slots) {
             a += g * g;
           }
-          var_flat(index) -= lr_scalar * g / Eigen::numext::sqrt(a);
-        }
+          var_flat(index, 0) -= lr_scalar * g / Eigen::numext::sqrt(a);
+        });
       }
     }
 
@@ -2783,6 +2878,304 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+template <typename Device, typename T>
+class ApplyAdamNOp : public OpKernel {
+ public:
+  explicit ApplyAdamNOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    // Inputs are laid out as var[N], m[N], v[N], the six hyperparameters and
+    // grad[N].
+    const int n = num_vars_;
+    std::vector<int> var_inputs(3 * n);
+    for (int i = 0; i < 3 * n; ++i) var_inputs[i] = i;
+    auto locks = MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_,
+                                                      var_inputs);
+
+    std::vector<Tensor> vars(3 * n);
+    for (int i = 0; i < 3 * n; ++i) {
+      OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
+                              ctx, i, use_exclusive_lock_, false, &vars[i]));
+      OP_REQUIRES(ctx, vars[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+    }
+
+    const Tensor& beta1_power = ctx->input(3 * n);
+    const Tensor& beta2_power = ctx->input(3 * n + 1);
+    const Tensor& lr = ctx->input(3 * n + 2);
+    const Tensor& beta1 = ctx->input(3 * n + 3);
+    const Tensor& beta2 = ctx->input(3 * n + 4);
+    const Tensor& epsilon = ctx->input(3 * n + 5);
+
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1_power.shape()),
+                errors::InvalidArgument("beta1_power is not a scalar: ",
+                                        beta1_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2_power.shape()),
+                errors::InvalidArgument("beta2_power is not a scalar: ",
+                                        beta2_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar : ",
+                                        lr.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1.shape()),
+                errors::InvalidArgument("beta1 is not a scalar: ",
+                                        beta1.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2.shape()),
+                errors::InvalidArgument("beta2 is not a scalar: ",
+                                        beta2.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(epsilon.shape()),
+                errors::InvalidArgument("epsilon is not a scalar: ",
+                                        epsilon.shape().DebugString()));
+
+    std::vector<typename TTypes<T>::Flat> var_flats;
+    std::vector<typename TTypes<T>::Flat> m_flats;
+    std::vector<typename TTypes<T>::Flat> v_flats;
+    std::vector<typename TTypes<T>::ConstFlat> grad_flats;
+    var_flats.reserve(n);
+    m_flats.reserve(n);
+    v_flats.reserve(n);
+    grad_flats.reserve(n);
+    for (int i = 0; i < n; ++i) {
+      const Tensor& var = vars[i];
+      const Tensor& m = vars[n + i];
+      const Tensor& v = vars[2 * n + i];
+      const Tensor& grad = ctx->input(3 * n + 6 + i);
+      OP_REQUIRES(ctx, var.shape().IsSameSize(m.shape()),
+                  errors::InvalidArgument(
+                      "var and m do not have the same shape for variable ", i,
+                      ": ", var.shape().DebugString(), " ",
+                      m.shape().DebugString()));
+      OP_REQUIRES(ctx, var.shape().IsSameSize(v.shape()),
+                  errors::InvalidArgument(
+                      "var and v do not have the same shape for variable ", i,
+                      ": ", var.shape().DebugString(), " ",
+                      v.shape().DebugString()));
+      OP_REQUIRES(ctx, var.shape().IsSameSize(grad.shape()),
+                  errors::InvalidArgument(
+                      "var and grad do not have the same shape for variable ",
+                      i, ": ", var.shape().DebugString(), " ",
+                      grad.shape().DebugString()));
+      var_flats.push_back(vars[i].flat<T>());
+      m_flats.push_back(vars[n + i].flat<T>());
+      v_flats.push_back(vars[2 * n + i].flat<T>());
+      grad_flats.push_back(grad.flat<T>());
+    }
+
+    const Device& device = ctx->template eigen_device<Device>();
+    functor::ApplyAdamN<Device, T>()(
+        device, var_flats, m_flats, v_flats, beta1_power.scalar<T>(),
+        beta2_power.scalar<T>(), lr.scalar<T>(), beta1.scalar<T>(),
+        beta2.scalar<T>(), epsilon.scalar<T>(), grad_flats, use_nesterov_);
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                                     \
+  REGISTER_KERNEL_BUILDER(Name("ResourceApplyAdamN")               \
+                              .HostMemory("var")                   \
+                              .HostMemory("m")                     \
+                              .HostMemory("v")                     \
+                              .Device(DEVICE_##D)                  \
+                              .TypeConstraint<T>("T"),             \
+                          ApplyAdamNOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                    \
+  template <>                                                  \
+  void ApplyAdamN<GPUDevice, T>::operator()(                   \
+      const GPUDevice& d,                                      \
+      const std::vector<typename TTypes<T>::Flat>& vars,       \
+      const std::vector<typename TTypes<T>::Flat>& ms,         \
+      const std::vector<typename TTypes<T>::Flat>& vs,         \
+      typename TTypes<T>::ConstScalar beta1_power,             \
+      typename TTypes<T>::ConstScalar beta2_power,             \
+      typename TTypes<T>::ConstScalar lr,                      \
+      typename TTypes<T>::ConstScalar beta1,                   \
+      typename TTypes<T>::ConstScalar beta2,                   \
+      typename TTypes<T>::ConstScalar epsilon,                 \
+      const std::vector<typename TTypes<T>::ConstFlat>& grads, \
+      bool use_nesterov);                                      \
+  extern template struct ApplyAdamN<GPUDevice, T>;
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
+// Note, this op works on cpu only.
+template <typename T, typename Tindex>
+class SparseApplyAdamOp : public OpKernel {
+ public:
+  explicit SparseApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+  }
+
+  void Compute(OpKernelContext* ctx) override NO_THREAD_SAFETY_ANALYSIS {
+    auto locks = MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_,
+                                                      {0, 1, 2});
+    Tensor var;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 0, use_exclusive_lock_, true, &var));
+    Tensor m;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 1, use_exclusive_lock_, true, &m));
+    Tensor v;
+    OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
+                            ctx, 2, use_exclusive_lock_, true, &v));
+    OP_REQUIRES(
+        ctx, var.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(0)));
+    OP_REQUIRES(
+        ctx, m.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(1)));
+    OP_REQUIRES(
+        ctx, v.IsInitialized(),
+        errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ", requested_input(2)));
+    OP_REQUIRES(ctx, var.shape().IsSameSize(m.shape()),
+                errors::InvalidArgument("var and m do not have the same shape",
+                                        var.shape().DebugString(), " ",
+                                        m.shape().DebugString()));
+    OP_REQUIRES(ctx, var.shape().IsSameSize(v.shape()),
+                errors::InvalidArgument("var and v do not have the same shape",
+                                        var.shape().DebugString(), " ",
+                                        v.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVectorOrHigher(var.shape()),
+                errors::InvalidArgument("var must be at least 1 dimensional"));
+
+    const Tensor& beta1_power = ctx->input(3);
+    const Tensor& beta2_power = ctx->input(4);
+    const Tensor& lr = ctx->input(5);
+    const Tensor& beta1 = ctx->input(6);
+    const Tensor& beta2 = ctx->input(7);
+    const Tensor& epsilon = ctx->input(8);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1_power.shape()),
+                errors::InvalidArgument("beta1_power is not a scalar: ",
+                                        beta1_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2_power.shape()),
+                errors::InvalidArgument("beta2_power is not a scalar: ",
+                                        beta2_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar : ",
+                                        lr.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1.shape()),
+                errors::InvalidArgument("beta1 is not a scalar: ",
+                                        beta1.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2.shape()),
+                errors::InvalidArgument("beta2 is not a scalar: ",
+                                        beta2.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(epsilon.shape()),
+                errors::InvalidArgument("epsilon is not a scalar: ",
+                                        epsilon.shape().DebugString()));
+
+    const Tensor& grad = ctx->input(9);
+    const Tensor& indices = ctx->input(10);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices must be one-dimensional"));
+    OP_REQUIRES(
+        ctx, grad.dims() == var.dims(),
+        errors::InvalidArgument("var and grad must have the same rank"));
+    int64 inner_dim = 1;
+    for (int d = 1; d < var.dims(); d++) {
+      OP_REQUIRES(ctx, var.dim_size(d) == grad.dim_size(d),
+                  errors::InvalidArgument(strings::StrCat(
+                      "var and grad must match in dimension ", d)));
+      inner_dim *= grad.dim_size(d);
+    }
+    const Tindex N = indices.dim_size(0);
+    OP_REQUIRES(
+        ctx, grad.dim_size(0) == N,
+        errors::InvalidArgument(
+            "grad must be the same size as indices in the first dimension."));
+    if (N > 0 && inner_dim > 0) {
+      UniqueSparseGradient<T, Tindex> sparse_grad;
+      OP_REQUIRES_OK(ctx,
+                     sparse_grad.Init(ctx, grad, indices, var.dim_size(0)));
+      auto var_flat = var.flat_outer_dims<T>();
+      auto m_flat = m.flat_outer_dims<T>();
+      auto v_flat = v.flat_outer_dims<T>();
+      const auto grad_flat = sparse_grad.grad();
+
+      // Only the rows with a gradient are updated, but with the bias
+      // correction of the current step.
+      const T one(1);
+      const T b1 = beta1.scalar<T>()();
+      const T b2 = beta2.scalar<T>()();
+      const T eps = epsilon.scalar<T>()();
+      const T alpha = lr.scalar<T>()() *
+                      Eigen::numext::sqrt(one - beta2_power.scalar<T>()()) /
+                      (one - beta1_power.scalar<T>()());
+      ForEachSparseRow(ctx, sparse_grad, 20 * inner_dim, [&](int64 i) {
+        const Tindex index = sparse_grad.index(i);
+        const T* g = &grad_flat(i, 0);
+        T* m_row = &m_flat(index, 0);
+        T* v_row = &v_flat(index, 0);
+        T* var_row = &var_flat(index, 0);
+        for (int64 j = 0; j < inner_dim; ++j) {
+          m_row[j] += (g[j] - m_row[j]) * (one - b1);
+          v_row[j] += (g[j] * g[j] - v_row[j]) * (one - b2);
+          var_row[j] -=
+              alpha * m_row[j] / (Eigen::numext::sqrt(v_row[j]) + eps);
+        }
+      });
+    }
+
+    MaybeForwardRefInputToRefOutput(ctx, 0, 0);
+  }
+
+ private:
+  bool use_exclusive_lock_;
+};
+
+#define REGISTER_KERNELS(T, Tindices)                                \
+  REGISTER_KERNEL_BUILDER(Name("SparseApplyAdam")                    \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("T")                \
+                              .TypeConstraint<Tindices>("Tindices"), \
+                          SparseApplyAdamOp<T, Tindices>);           \
+  REGISTER_KERNEL_BUILDER(Name("ResourceSparseApplyAdam")            \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("T")                \
+                              .TypeConstraint<Tindices>("Tindices"), \
+                          SparseApplyAdamOp<T, Tindices>);
+#define REGISTER_CPU_KERNELS(T) \
+  REGISTER_KERNELS(T, int32);   \
+  REGISTER_KERNELS(T, int64);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdaMaxOp : public OpKernel {
  public:
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_TRAINING_OPS_H_
 #define TENSORFLOW_KERNELS_TRAINING_OPS_H_
 
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/platform/types.h"
@@ -139,6 +141,25 @@ struct ApplyAdam {
                   typename TTypes<T>::ConstFlat grad, bool use_nesterov);
 };
 
+// Applies ApplyAdam to every (vars[i], ms[i], vs[i], grads[i]) with the same
+// hyperparameters, so that many small variables are updated with a handful of
+// kernel launches rather than one launch per variable.
+template <typename Device, typename T>
+struct ApplyAdamN {
+  void operator()(const Device& d,
+                  const std::vector<typename TTypes<T>::Flat>& vars,
+                  const std::vector<typename TTypes<T>::Flat>& ms,
+                  const std::vector<typename TTypes<T>::Flat>& vs,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<typename TTypes<T>::ConstFlat>& grads,
+                  bool use_nesterov);
+};
+
 template <typename Device, typename T>
 struct ApplyAdaMax {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
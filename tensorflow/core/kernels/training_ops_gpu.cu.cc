@@ -17,8 +17,12 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <limits>
+#include <type_traits>
+
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/training_ops.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
 
 namespace tensorflow {
 
@@ -144,6 +148,126 @@ struct ApplyAdam<GPUDevice, T> {
   }
 };
 
+namespace {
+
+// The variables updated by one launch of ApplyAdamNKernel. It is passed by
+// value as a kernel parameter, so it is kept well under the 4KB limit.
+template <typename T>
+struct AdamNVariables {
+  static constexpr int kMaxVariables = 48;
+  int num_variables;
+  T* var[kMaxVariables];
+  T* m[kMaxVariables];
+  T* v[kMaxVariables];
+  const T* grad[kMaxVariables];
+  // offsets[i] is the index of the first element of variable i in the
+  // concatenation of all the variables; offsets[num_variables] is the total.
+  int offsets[kMaxVariables + 1];
+};
+
+template <typename T>
+__global__ void ApplyAdamNKernel(AdamNVariables<T> vars,
+                                 const T* __restrict__ beta1_power,
+                                 const T* __restrict__ beta2_power,
+                                 const T* __restrict__ lr,
+                                 const T* __restrict__ beta1,
+                                 const T* __restrict__ beta2,
+                                 const T* __restrict__ epsilon,
+                                 bool use_nesterov) {
+  // Half precision updates are computed in float.
+  typedef typename std::conditional<std::is_same<T, Eigen::half>::value, float,
+                                    T>::type U;
+  const U one(1);
+  const U b1 = static_cast<U>(*beta1);
+  const U b2 = static_cast<U>(*beta2);
+  const U eps = static_cast<U>(*epsilon);
+  const U alpha = static_cast<U>(*lr) *
+                  Eigen::numext::sqrt(one - static_cast<U>(*beta2_power)) /
+                  (one - static_cast<U>(*beta1_power));
+  CUDA_1D_KERNEL_LOOP(i, vars.offsets[vars.num_variables]) {
+    // Binary search for the variable that element i belongs to.
+    int lo = 0;
+    int hi = vars.num_variables - 1;
+    while (lo < hi) {
+      const int mid = (lo + hi + 1) / 2;
+      if (vars.offsets[mid] <= i) {
+        lo = mid;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    const int j = i - vars.offsets[lo];
+    const U g = static_cast<U>(vars.grad[lo][j]);
+    U m = static_cast<U>(vars.m[lo][j]);
+    U v = static_cast<U>(vars.v[lo][j]);
+    m += (g - m) * (one - b1);
+    v += (g * g - v) * (one - b2);
+    const U numerator = use_nesterov ? g * (one - b1) + b1 * m : m;
+    U var = static_cast<U>(vars.var[lo][j]);
+    var -= numerator * alpha / (Eigen::numext::sqrt(v) + eps);
+    vars.m[lo][j] = static_cast<T>(m);
+    vars.v[lo][j] = static_cast<T>(v);
+    vars.var[lo][j] = static_cast<T>(var);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+struct ApplyAdamN<GPUDevice, T> {
+  void operator()(const GPUDevice& d,
+                  const std::vector<typename TTypes<T>::Flat>& vars,
+                  const std::vector<typename TTypes<T>::Flat>& ms,
+                  const std::vector<typename TTypes<T>::Flat>& vs,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const std::vector<typename TTypes<T>::ConstFlat>& grads,
+                  bool use_nesterov) {
+    constexpr int64 kMaxLaunchSize = std::numeric_limits<int>::max();
+    AdamNVariables<T> batch;
+    batch.num_variables = 0;
+    batch.offsets[0] = 0;
+    auto launch = [&]() {
+      const int size = batch.offsets[batch.num_variables];
+      if (size > 0) {
+        CudaLaunchConfig config = GetCudaLaunchConfig(size, d);
+        ApplyAdamNKernel<T>
+            <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+                batch, beta1_power.data(), beta2_power.data(), lr.data(),
+                beta1.data(), beta2.data(), epsilon.data(), use_nesterov);
+      }
+      batch.num_variables = 0;
+    };
+
+    for (int i = 0; i < vars.size(); ++i) {
+      const int64 size = vars[i].size();
+      if (size == 0) continue;
+      if (size > kMaxLaunchSize) {
+        // Too large to be indexed by the batched kernel.
+        ApplyAdam<GPUDevice, T>()(d, vars[i], ms[i], vs[i], beta1_power,
+                                  beta2_power, lr, beta1, beta2, epsilon,
+                                  grads[i], use_nesterov);
+        continue;
+      }
+      if (batch.num_variables == AdamNVariables<T>::kMaxVariables ||
+          batch.offsets[batch.num_variables] > kMaxLaunchSize - size) {
+        launch();
+      }
+      const int k = batch.num_variables++;
+      batch.var[k] = vars[i].data();
+      batch.m[k] = ms[i].data();
+      batch.v[k] = vs[i].data();
+      batch.grad[k] = grads[i].data();
+      batch.offsets[k + 1] = batch.offsets[k] + static_cast<int>(size);
+    }
+    launch();
+  }
+};
+
 template <typename T>
 struct ApplyAdaMax<GPUDevice, T> {
   void operator()(const GPUDevice& d, typename TTypes<T>::Flat var,
@@ -306,6 +430,10 @@ template struct functor::ApplyAdam<GPUDevice, Eigen::half>;
 template struct functor::ApplyAdam<GPUDevice, float>;
 template struct functor::ApplyAdam<GPUDevice, double>;
 
+template struct functor::ApplyAdamN<GPUDevice, Eigen::half>;
+template struct functor::ApplyAdamN<GPUDevice, float>;
+template struct functor::ApplyAdamN<GPUDevice, double>;
+
 template struct functor::ApplyAdaMax<GPUDevice, Eigen::half>;
 template struct functor::ApplyAdaMax<GPUDevice, float>;
 template struct functor::ApplyAdaMax<GPUDevice, double>;
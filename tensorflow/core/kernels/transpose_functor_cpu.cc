@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,38 +32,200 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 namespace tensorflow {
 namespace {
 
+// Transposes of element types that have an Eigen packet of the same size use
+// in-register transposes of kSize x kSize blocks.
+template <typename T>
+struct BlockTranspose {
+  static constexpr int kSize = 1;
+  static void Run(const T* src, int64 src_stride, T* dst, int64 dst_stride) {}
+};
+
+template <typename T, typename Scalar>
+struct PacketBlockTranspose {
+  typedef typename Eigen::internal::packet_traits<Scalar>::type Packet;
+  static constexpr int kSize = Eigen::internal::packet_traits<Scalar>::size;
+
+  // Transposes the kSize x kSize block at src into dst.
+  static void Run(const T* src, int64 src_stride, T* dst, int64 dst_stride) {
+    Eigen::internal::PacketBlock<Packet, kSize> block;
+    for (int k = 0; k < kSize; ++k) {
+      block.packet[k] = Eigen::internal::ploadu<Packet>(
+          reinterpret_cast<const Scalar*>(src + k * src_stride));
+    }
+    Eigen::internal::ptranspose(block);
+    for (int k = 0; k < kSize; ++k) {
+      Eigen::internal::pstoreu<Scalar>(
+          reinterpret_cast<Scalar*>(dst + k * dst_stride), block.packet[k]);
+    }
+  }
+};
+
+template <>
+struct BlockTranspose<uint32> : PacketBlockTranspose<uint32, float> {};
+template <>
+struct BlockTranspose<uint64> : PacketBlockTranspose<uint64, double> {};
+
 template <typename T, bool conjugate>
-void TransposeSimple(const CPUDevice& device, const Tensor& in,
-                     const gtl::ArraySlice<int32> perm, Tensor* out) {
-  const int ndims = in.dims();
-  gtl::InlinedVector<int64, 8> in_strides = ComputeStride<int64>(in.shape());
-  gtl::InlinedVector<int64, 8> out_strides = ComputeStride<int64>(out->shape());
-  const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
-  T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
-  auto transpose_fn = [=, &in_strides, &out_strides, &perm](int64 begin,
-                                                            int64 end) {
-    for (int64 o_idx = begin; o_idx < end; ++o_idx) {
-      int64 i_idx = 0;
-      int64 t = o_idx;
-      for (int i = 0; i < ndims; ++i) {
-        const int64 ratio = t / out_strides[i];
-        t -= ratio * out_strides[i];
-        i_idx += ratio * in_strides[perm[i]];
+inline void CopyElement(const T& from, T* to) {
+  *to = conjugate ? Eigen::numext::conj(from) : from;
+}
+
+// Transposes the rows x cols matrix at src, whose rows are src_stride apart,
+// into the cols x rows matrix at dst, whose rows are dst_stride apart.
+template <typename T, bool conjugate>
+void TransposeMatrix(const T* src, int64 src_stride, T* dst, int64 dst_stride,
+                     int64 rows, int64 cols) {
+  // Tiles of kTile x kTile elements keep both the rows read and the rows
+  // written in L1.
+  constexpr int64 kTile = 32;
+  constexpr int kBlock = conjugate ? 1 : BlockTranspose<T>::kSize;
+  for (int64 i0 = 0; i0 < rows; i0 += kTile) {
+    const int64 i1 = std::min(rows, i0 + kTile);
+    for (int64 j0 = 0; j0 < cols; j0 += kTile) {
+      const int64 j1 = std::min(cols, j0 + kTile);
+      int64 i = i0;
+      if (kBlock > 1) {
+        for (; i + kBlock <= i1; i += kBlock) {
+          int64 j = j0;
+          for (; j + kBlock <= j1; j += kBlock) {
+            BlockTranspose<T>::Run(src + i * src_stride + j, src_stride,
+                                   dst + j * dst_stride + i, dst_stride);
+          }
+          for (; j < j1; ++j) {
+            for (int64 k = i; k < i + kBlock; ++k) {
+              CopyElement<T, conjugate>(src[k * src_stride + j],
+                                        &dst[j * dst_stride + k]);
+            }
+          }
+        }
       }
-      if (conjugate) {
-        q[o_idx] = Eigen::numext::conj(p[i_idx]);
-      } else {
-        q[o_idx] = p[i_idx];
+      for (; i < i1; ++i) {
+        for (int64 j = j0; j < j1; ++j) {
+          CopyElement<T, conjugate>(src[i * src_stride + j],
+                                    &dst[j * dst_stride + i]);
+        }
       }
     }
-  };
-  double cycles_per_element =
-      (conjugate ? 1 : 0) + ndims * (Eigen::TensorOpCost::DivCost<int64>() +
-                                     2 * Eigen::TensorOpCost::MulCost<int64>() +
-                                     2 * Eigen::TensorOpCost::AddCost<int64>());
-  Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T),
-                           /*bytes_stored=*/sizeof(T), cycles_per_element);
-  device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
+  }
+}
+
+// Transposes in by first dropping its size 1 dimensions and merging the
+// dimensions that stay adjacent, which turns most permutations into either a
+// copy of contiguous runs or a batch of matrix transposes.
+template <typename T, bool conjugate>
+void TransposeCpu(const CPUDevice& device, const Tensor& in,
+                  const gtl::ArraySlice<int32> perm, Tensor* out) {
+  const T* src = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* dst = reinterpret_cast<T*>(const_cast<char*>(out->tensor_data().data()));
+  const int64 num_elements = in.NumElements();
+  if (num_elements == 0) return;
+
+  // Drop the dimensions of size 1, renumbering the permutation.
+  internal::TransposePermsVec renumbered(in.dims(), -1);
+  TensorShape squeezed_shape;
+  for (int i = 0; i < in.dims(); ++i) {
+    if (in.dim_size(i) != 1) {
+      renumbered[i] = squeezed_shape.dims();
+      squeezed_shape.AddDim(in.dim_size(i));
+    }
+  }
+  internal::TransposePermsVec squeezed_perm;
+  for (int32 p : perm) {
+    if (renumbered[p] >= 0) squeezed_perm.push_back(renumbered[p]);
+  }
+  if (squeezed_shape.dims() == 0) squeezed_shape.AddDim(1);
+  if (squeezed_perm.empty()) squeezed_perm.push_back(0);
+
+  // ReduceTransposeDimensions returns the output position of every merged
+  // input dimension; new_perm holds the input dimension of every output one.
+  internal::TransposePermsVec output_positions;
+  internal::TransposeDimsVec dims(squeezed_shape.dims());
+  internal::ReduceTransposeDimensions(squeezed_shape, squeezed_perm,
+                                      &output_positions, &dims);
+  const int ndims = dims.size();
+  internal::TransposePermsVec new_perm(ndims);
+  for (int i = 0; i < ndims; ++i) new_perm[output_positions[i]] = i;
+
+  // Strides of the input dimensions, and sizes and strides of the output
+  // dimensions.
+  internal::TransposeDimsVec in_strides(ndims);
+  internal::TransposeDimsVec out_dims(ndims);
+  internal::TransposeDimsVec out_strides(ndims);
+  in_strides[ndims - 1] = 1;
+  for (int i = ndims - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * dims[i + 1];
+  }
+  for (int i = 0; i < ndims; ++i) out_dims[i] = dims[new_perm[i]];
+  out_strides[ndims - 1] = 1;
+  for (int i = ndims - 2; i >= 0; --i) {
+    out_strides[i] = out_strides[i + 1] * out_dims[i + 1];
+  }
+
+  if (new_perm[ndims - 1] == ndims - 1) {
+    // The innermost dimension stays innermost: copy runs of it.
+    const int64 run = dims[ndims - 1];
+    const Eigen::TensorOpCost cost(run * sizeof(T), run * sizeof(T),
+                                   conjugate ? run : 0);
+    device.parallelFor(
+        num_elements / run, cost, [&](int64 begin, int64 end) {
+          for (int64 r = begin; r < end; ++r) {
+            int64 in_offset = 0;
+            int64 t = r;
+            for (int i = ndims - 2; i >= 0; --i) {
+              in_offset += (t % out_dims[i]) * in_strides[new_perm[i]];
+              t /= out_dims[i];
+            }
+            const T* from = src + in_offset;
+            T* to = dst + r * run;
+            if (conjugate) {
+              for (int64 k = 0; k < run; ++k) {
+                CopyElement<T, conjugate>(from[k], to + k);
+              }
+            } else {
+              std::copy(from, from + run, to);
+            }
+          }
+        });
+    return;
+  }
+
+  // Otherwise every output matrix over the output innermost dimension (input
+  // dimension row_dim) and the input innermost dimension (output dimension
+  // col_dim) is the transpose of an input matrix. Each unit of work transposes
+  // a band of kBandRows rows of one of them.
+  const int row_dim = new_perm[ndims - 1];
+  int col_dim = 0;
+  while (new_perm[col_dim] != ndims - 1) ++col_dim;
+  const int64 rows = dims[row_dim];
+  const int64 cols = dims[ndims - 1];
+  constexpr int64 kBandRows = 32;
+  const int64 num_bands = (rows + kBandRows - 1) / kBandRows;
+  const int64 num_matrices = num_elements / (rows * cols);
+  const int64 band_size = std::min(rows, kBandRows) * cols;
+  const Eigen::TensorOpCost cost(band_size * sizeof(T), band_size * sizeof(T),
+                                 band_size * (conjugate ? 2 : 1));
+  device.parallelFor(
+      num_matrices * num_bands, cost, [&](int64 begin, int64 end) {
+        for (int64 unit = begin; unit < end; ++unit) {
+          const int64 band = unit % num_bands;
+          int64 t = unit / num_bands;
+          int64 in_offset = 0;
+          int64 out_offset = 0;
+          for (int i = ndims - 1; i >= 0; --i) {
+            if (i == col_dim || i == ndims - 1) continue;
+            const int64 index = t % out_dims[i];
+            t /= out_dims[i];
+            in_offset += index * in_strides[new_perm[i]];
+            out_offset += index * out_strides[i];
+          }
+          const int64 row_begin = band * kBandRows;
+          const int64 row_end = std::min(rows, row_begin + kBandRows);
+          TransposeMatrix<T, conjugate>(
+              src + in_offset + row_begin * in_strides[row_dim],
+              in_strides[row_dim], dst + out_offset + row_begin,
+              out_strides[col_dim], row_end - row_begin, cols);
+        }
+      });
 }
 
 }  // namespace
@@ -71,39 +234,7 @@ template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
-    switch (in.dims()) {
-      case 2:
-        internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 3:
-        internal::TransposeUsingEigen<CPUDevice, T, 3>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 4:
-        internal::TransposeUsingEigen<CPUDevice, T, 4>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 5:
-        internal::TransposeUsingEigen<CPUDevice, T, 5>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 6:
-        internal::TransposeUsingEigen<CPUDevice, T, 6>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 7:
-        internal::TransposeUsingEigen<CPUDevice, T, 7>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 8:
-        internal::TransposeUsingEigen<CPUDevice, T, 8>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      default:
-        TransposeSimple<T, conjugate>(d, in, perm, out);
-        break;
-    }
+    TransposeCpu<T, conjugate>(d, in, perm, out);
   }
 };
 
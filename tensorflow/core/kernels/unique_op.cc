@@ -16,6 +16,7 @@ limitations under the License.
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -24,11 +25,169 @@ limitations under the License.
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+namespace {
+
+// Unique over single elements runs on all the intra-op threads from this many
+// elements on.
+constexpr int64 kParallelUniqueMinElements = 1 << 16;
+
+// Spreads the bits of a hash, which is the identity for integers.
+inline uint64 MixHash(uint64 h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+// Computes unique over the elements of 'input' on all the given threads, with
+// the same result as a sequential pass. Sets 'idx' to the index of each
+// element in the output, and 'first' to the position of the first occurrence
+// of each output element in 'input'.
+//
+// The elements are split by hash into one partition per thread, keeping their
+// order. Each partition is deduplicated separately with an open addressing
+// table, then the output positions of the unique elements are their ranks
+// among the first occurrences of all partitions.
+template <typename T, typename TIndex>
+void ParallelUnique(const DeviceBase::CpuWorkerThreads& worker_threads,
+                    typename TTypes<T>::ConstFlat input,
+                    typename TTypes<TIndex>::Vec idx,
+                    std::vector<int64>* first) {
+  const int64 N = input.size();
+  const int num_partitions = worker_threads.num_threads;
+  // The input is processed in one contiguous chunk per thread.
+  const int num_chunks = worker_threads.num_threads;
+  const int64 chunk_size = (N + num_chunks - 1) / num_chunks;
+  auto for_each_chunk = [&worker_threads, chunk_size, N](
+                            int64 cost_per_element,
+                            const std::function<void(int, int64, int64)>& fn) {
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          worker_threads.num_threads, cost_per_element * chunk_size,
+          [chunk_size, N, &fn](int64 start_chunk, int64 end_chunk) {
+            for (int64 c = start_chunk; c < end_chunk; ++c) {
+              fn(c, c * chunk_size, std::min(N, (c + 1) * chunk_size));
+            }
+          });
+  };
+  auto partition_of = [num_partitions](uint64 h) {
+    return static_cast<int>((h >> 32) % num_partitions);
+  };
+
+  // Hash the elements, and count those of each partition in each chunk.
+  std::vector<uint64> hashes(N);
+  std::vector<int64> offsets(num_chunks * num_partitions, 0);
+  for_each_chunk(20, [&](int c, int64 start, int64 end) {
+    int64* chunk_counts = &offsets[c * num_partitions];
+    for (int64 i = start; i < end; ++i) {
+      hashes[i] = MixHash(hash<T>{}(input(i)));
+      ++chunk_counts[partition_of(hashes[i])];
+    }
+  });
+
+  // Lay out the partitions one after the other, each in input order.
+  std::vector<int64> partition_starts(num_partitions + 1);
+  int64 offset = 0;
+  for (int p = 0; p < num_partitions; ++p) {
+    partition_starts[p] = offset;
+    for (int c = 0; c < num_chunks; ++c) {
+      const int64 count = offsets[c * num_partitions + p];
+      offsets[c * num_partitions + p] = offset;
+      offset += count;
+    }
+  }
+  partition_starts[num_partitions] = offset;
+  std::vector<int64> members(N);
+  for_each_chunk(5, [&](int c, int64 start, int64 end) {
+    int64* chunk_offsets = &offsets[c * num_partitions];
+    for (int64 i = start; i < end; ++i) {
+      members[chunk_offsets[partition_of(hashes[i])]++] = i;
+    }
+  });
+
+  // Deduplicate each partition, setting 'idx' to the index of each element
+  // among the unique elements of its partition.
+  std::vector<std::vector<int64>> partition_firsts(num_partitions);
+  std::vector<uint8> is_first(N, 0);
+  Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+        50 * chunk_size, [&](int64 start_partition, int64 end_partition) {
+          for (int64 p = start_partition; p < end_partition; ++p) {
+            const int64 begin = partition_starts[p];
+            const int64 end = partition_starts[p + 1];
+            int64 num_buckets = 1;
+            while (num_buckets < 2 * (end - begin)) num_buckets *= 2;
+            const uint64 mask = num_buckets - 1;
+            // The first occurrence and the local index of the element in
+            // each bucket, -1 if empty.
+            std::vector<int64> bucket_elements(num_buckets, -1);
+            std::vector<TIndex> bucket_ids(num_buckets);
+            std::vector<int64>& firsts = partition_firsts[p];
+            for (int64 m = begin; m < end; ++m) {
+              const int64 i = members[m];
+              uint64 bucket = hashes[i] & mask;
+              while (bucket_elements[bucket] != -1) {
+                const int64 other = bucket_elements[bucket];
+                if (hashes[other] == hashes[i] && input(other) == input(i)) {
+                  break;
+                }
+                bucket = (bucket + 1) & mask;
+              }
+              if (bucket_elements[bucket] == -1) {
+                bucket_elements[bucket] = i;
+                bucket_ids[bucket] = firsts.size();
+                firsts.push_back(i);
+                is_first[i] = 1;
+              }
+              idx(i) = bucket_ids[bucket];
+            }
+          }
+        });
+
+  // Rank the first occurrences in input order.
+  int64 num_unique = 0;
+  for (const auto& firsts : partition_firsts) {
+    num_unique += firsts.size();
+  }
+  first->resize(num_unique);
+  std::vector<int64> chunk_ranks(num_chunks + 1, 0);
+  for_each_chunk(1, [&](int c, int64 start, int64 end) {
+    for (int64 i = start; i < end; ++i) {
+      chunk_ranks[c + 1] += is_first[i];
+    }
+  });
+  for (int c = 0; c < num_chunks; ++c) {
+    chunk_ranks[c + 1] += chunk_ranks[c];
+  }
+  // The rank of each first occurrence, stored at its position in the input.
+  std::vector<int64>& ranks = members;
+  for_each_chunk(2, [&](int c, int64 start, int64 end) {
+    int64 rank = chunk_ranks[c];
+    for (int64 i = start; i < end; ++i) {
+      if (is_first[i]) {
+        ranks[i] = rank;
+        (*first)[rank] = i;
+        ++rank;
+      }
+    }
+  });
+
+  // Turn the indices within partitions into output indices.
+  for_each_chunk(5, [&](int c, int64 start, int64 end) {
+    for (int64 i = start; i < end; ++i) {
+      idx(i) = ranks[partition_firsts[partition_of(hashes[i])][idx(i)]];
+    }
+  });
+}
+
+}  // namespace
+
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
@@ -106,26 +265,44 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64 N = static_cast<int64>(Tin.size());
 
-      std::unordered_map<T, TIndex> uniq;
-      uniq.reserve(2 * N);
-      for (int64 i = 0, j = 0; i < N; ++i) {
-        auto it = uniq.insert(std::make_pair(Tin(i), j));
-        idx_vec(i) = it.first->second;
-        if (it.second) {
-          ++j;
+      const DeviceBase::CpuWorkerThreads& worker_threads =
+          *context->device()->tensorflow_cpu_worker_threads();
+      if (N >= kParallelUniqueMinElements && worker_threads.num_threads > 1) {
+        std::vector<int64> first;
+        ParallelUnique<T, TIndex>(worker_threads, Tin, idx_vec, &first);
+
+        uniq_size = static_cast<int64>(first.size());
+        TensorShape output_shape(input.shape());
+        output_shape.set_dim(axis, uniq_size);
+        Tensor* output = nullptr;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(0, output_shape, &output));
+        auto Tout = output->flat<T>();
+        for (int64 i = 0; i < uniq_size; ++i) {
+          Tout(i) = Tin(first[i]);
+        }
+      } else {
+        std::unordered_map<T, TIndex> uniq;
+        uniq.reserve(2 * N);
+        for (int64 i = 0, j = 0; i < N; ++i) {
+          auto it = uniq.insert(std::make_pair(Tin(i), j));
+          idx_vec(i) = it.first->second;
+          if (it.second) {
+            ++j;
+          }
         }
-      }
 
-      uniq_size = static_cast<int64>(uniq.size());
-      TensorShape output_shape(input.shape());
-      output_shape.set_dim(axis, uniq_size);
-      Tensor* output = nullptr;
-      OP_REQUIRES_OK(context,
-                     context->allocate_output(0, output_shape, &output));
-      auto Tout = output->flat<T>();
+        uniq_size = static_cast<int64>(uniq.size());
+        TensorShape output_shape(input.shape());
+        output_shape.set_dim(axis, uniq_size);
+        Tensor* output = nullptr;
+        OP_REQUIRES_OK(context,
+                       context->allocate_output(0, output_shape, &output));
+        auto Tout = output->flat<T>();
 
-      for (auto it : uniq) {
-        Tout(it.second) = it.first;
+        for (auto it : uniq) {
+          Tout(it.second) = it.first;
+        }
       }
     } else {
       // General implementation when unique is run over multiple elements.
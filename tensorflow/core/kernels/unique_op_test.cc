@@ -15,10 +15,15 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/node_builder.h"
@@ -26,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -35,6 +41,56 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {
+ protected:
+  // Checks Unique against a sequential computation on an input large enough
+  // to be processed on several threads.
+  template <typename T>
+  void TestLargeInput(DataType dtype, const std::vector<T>& values) {
+    TF_ASSERT_OK(NodeDefBuilder("unique", "Unique")
+                     .Input(FakeInput(dtype))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<T>(TensorShape({static_cast<int64>(values.size())}),
+                         values);
+    TF_ASSERT_OK(RunOpKernel());
+
+    std::unordered_map<T, int32> first_index;
+    std::vector<T> unique_values;
+    std::vector<int32> indices;
+    for (const T& value : values) {
+      auto it = first_index.insert({value, unique_values.size()});
+      if (it.second) unique_values.push_back(value);
+      indices.push_back(it.first->second);
+    }
+    Tensor expected_y(allocator(), dtype,
+                      TensorShape({static_cast<int64>(unique_values.size())}));
+    test::FillValues<T>(&expected_y, unique_values);
+    test::ExpectTensorEqual<T>(expected_y, *GetOutput(0));
+    Tensor expected_idx(allocator(), DT_INT32,
+                        TensorShape({static_cast<int64>(indices.size())}));
+    test::FillValues<int32>(&expected_idx, indices);
+    test::ExpectTensorEqual<int32>(expected_idx, *GetOutput(1));
+  }
+};
+
+TEST_F(UniqueOpTest, LargeInt64Input) {
+  std::vector<int64> values(300000);
+  for (int64 i = 0; i < values.size(); ++i) {
+    // Few distinct values, spread over the whole input.
+    values[i] = (i * 7919) % 5003 * 1024;
+  }
+  TestLargeInput<int64>(DT_INT64, values);
+}
+
+TEST_F(UniqueOpTest, LargeStringInput) {
+  std::vector<string> values(100000);
+  for (int i = 0; i < values.size(); ++i) {
+    values[i] = strings::StrCat("id", std::rand() % 20000);
+  }
+  TestLargeInput<string>(DT_STRING, values);
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
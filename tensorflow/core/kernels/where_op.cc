@@ -23,8 +23,12 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/where_op.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <numeric>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -62,21 +66,19 @@ int64 CountAccumulator(const T* begin, const T* end) {
 
 template <>
 int64 CountAccumulator<bool>(const bool* begin, const bool* end) {
-  return std::accumulate(begin, end, 0LL);
+  // Every byte of a word of bools is 0 or 1, so multiplying the word by
+  // 0x0101010101010101 sums its bytes into the top one.
+  int64 count = 0;
+  for (; begin + sizeof(uint64) <= end; begin += sizeof(uint64)) {
+    uint64 word;
+    memcpy(&word, begin, sizeof(word));
+    count += (word * 0x0101010101010101ULL) >> 56;
+  }
+  return count + std::accumulate(begin, end, 0LL);
 }
 
 }  // namespace
 
-template <typename T>
-struct NumTrue<CPUDevice, T, int64> {
-  static Status Compute(OpKernelContext* ctx, const CPUDevice& d,
-                        typename TTypes<T>::ConstFlat input,
-                        TTypes<int64>::Scalar num_true) {
-    num_true() = CountAccumulator<T>(input.data(), input.data() + input.size());
-    return Status::OK();
-  }
-};
-
 template <int DIMS, typename T, typename TIndex>
 struct Where<CPUDevice, DIMS, T, TIndex> {
   EIGEN_ALWAYS_INLINE static void WriteIndexRowMajor(
@@ -89,32 +91,56 @@ struct Where<CPUDevice, DIMS, T, TIndex> {
     }
   }
 
-  EIGEN_ALWAYS_INLINE static Status Compute(
-      OpKernelContext* ctx, const CPUDevice& d,
+  // Writes the indices of the true elements of input[begin, end) to the rows
+  // of output starting at *found_true, ignoring those past output_end.
+  EIGEN_ALWAYS_INLINE static void WriteRange(
       typename TTypes<T, DIMS>::ConstTensor input,
-      typename TTypes<int64>::Matrix output, TIndex* found_true) {
-    Eigen::DSizes<Eigen::DenseIndex, DIMS> dims = input.dimensions();
-    Eigen::DSizes<TIndex, DIMS> strides;
-
-    EIGEN_STATIC_ASSERT((static_cast<int>(decltype(input)::Layout) ==
-                         static_cast<int>(Eigen::RowMajor)),
-                        INTERNAL_ERROR_INPUT_SHOULD_BE_ROWMAJOR);
-
-    strides[DIMS - 1] = 1;
-    for (int i = DIMS - 2; i >= 0; --i) {
-      strides[i] = strides[i + 1] * dims[i + 1];
-    }
-
-    Eigen::DenseIndex output_size = output.dimension(0);
-    for (Eigen::DenseIndex n = 0; n < input.size(); ++n) {
+      const typename Eigen::DSizes<TIndex, DIMS>& strides, TIndex begin,
+      TIndex end, TIndex output_end, typename TTypes<int64>::Matrix output,
+      TIndex* found_true) {
+    for (TIndex n = begin; n < end; ++n) {
       if (input.data()[n] != T(0)) {
-        if (FastBoundsCheck(*found_true, output_size)) {
+        if (*found_true < output_end) {
           WriteIndexRowMajor(output, strides, *found_true, n);
         }
         ++*found_true;
       }
     }
-    return Status::OK();
+  }
+
+  // Copies indices of true values in input into output, writing blocks of
+  // block_size elements in parallel. block_offsets[b] is the output row of
+  // the first true element of block b, and its last entry is the number of
+  // true elements. The number of true elements actually found is copied into
+  // found_true.
+  static void ComputeBlocked(const CPUDevice& d,
+                             typename TTypes<T, DIMS>::ConstTensor input,
+                             TIndex block_size,
+                             const std::vector<TIndex>& block_offsets,
+                             typename TTypes<int64>::Matrix output,
+                             TIndex* found_true) {
+    Eigen::DSizes<TIndex, DIMS> strides;
+    strides[DIMS - 1] = 1;
+    for (int i = DIMS - 2; i >= 0; --i) {
+      strides[i] = strides[i + 1] * input.dimension(i + 1);
+    }
+
+    const TIndex size = input.size();
+    const int64 num_blocks = block_offsets.size() - 1;
+    std::vector<TIndex> found(num_blocks);
+    const double block_bytes = static_cast<double>(block_size * sizeof(T));
+    d.parallelFor(num_blocks,
+                  Eigen::TensorOpCost(block_bytes, block_bytes / 2, block_size),
+                  [&](int64 first, int64 last) {
+                    for (int64 b = first; b < last; ++b) {
+                      TIndex block_found = block_offsets[b];
+                      WriteRange(input, strides, b * block_size,
+                                 std::min(size, (b + 1) * block_size),
+                                 block_offsets[b + 1], output, &block_found);
+                      found[b] = block_found - block_offsets[b];
+                    }
+                  });
+    *found_true = std::accumulate(found.begin(), found.end(), TIndex(0));
   }
 };
 
@@ -135,33 +161,42 @@ class WhereCPUOp : public OpKernel {
                               "creating costly copies from device."));
 
     const int input_dims = input.dims();
-
-    Tensor num_true;
-    OP_REQUIRES_OK(
-        context, context->allocate_temp(DT_INT64, TensorShape({}), &num_true));
-    auto num_true_t = num_true.scalar<int64>();
-
-    Status s = functor::NumTrue<CPUDevice, T, int64>::Compute(
-        context, context->eigen_device<CPUDevice>(), input.flat<T>(),
-        num_true_t);
-    OP_REQUIRES_OK(context, s);
-    TensorShape output_shape({num_true_t(), input_dims});
+    const CPUDevice& d = context->eigen_device<CPUDevice>();
+
+    // The input is split into blocks whose true elements are counted in
+    // parallel. A prefix sum of the counts then gives the first output row of
+    // every block, so that the blocks can be written in parallel too.
+    const int64 size = input.NumElements();
+    const int64 num_blocks = std::max<int64>(
+        1, (size + kBlockSize - 1) / kBlockSize);
+    std::vector<int64> block_offsets(num_blocks + 1, 0);
+    const T* input_data = input.flat<T>().data();
+    const double block_bytes = static_cast<double>(kBlockSize * sizeof(T));
+    d.parallelFor(num_blocks,
+                  Eigen::TensorOpCost(block_bytes, 0, kBlockSize),
+                  [&](int64 first, int64 last) {
+                    for (int64 b = first; b < last; ++b) {
+                      block_offsets[b + 1] = functor::CountAccumulator<T>(
+                          input_data + b * kBlockSize,
+                          input_data + std::min(size, (b + 1) * kBlockSize));
+                    }
+                  });
+    std::partial_sum(block_offsets.begin(), block_offsets.end(),
+                     block_offsets.begin());
+    const int64 num_true = block_offsets.back();
+
+    TensorShape output_shape({num_true, input_dims});
     Tensor* output = nullptr;
     OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
 
-    // TODO(ebrevdo): Replace single-threaded copy with a
-    // multithreaded block copy by getting block counts above instead
-    // of a global NumTrue, then having each block filled in in
-    // separate threads below.
     int64 found_true = 0;
 
-#define HANDLE_DIM(NDIM)                                                      \
-  case NDIM: {                                                                \
-    Status s = functor::Where<CPUDevice, NDIM, T, int64>::Compute(            \
-        context, context->eigen_device<CPUDevice>(), input.tensor<T, NDIM>(), \
-        output->matrix<int64>(), &found_true);                                \
-    OP_REQUIRES_OK(context, s);                                               \
-  } break;
+#define HANDLE_DIM(NDIM)                                       \
+  case NDIM:                                                   \
+    functor::Where<CPUDevice, NDIM, T, int64>::ComputeBlocked( \
+        d, input.tensor<T, NDIM>(), kBlockSize, block_offsets, \
+        output->matrix<int64>(), &found_true);                 \
+    break;
 
     switch (input_dims) {
       HANDLE_DIM(1);
@@ -178,18 +213,24 @@ class WhereCPUOp : public OpKernel {
 #undef HANDLE_DIM
 
     OP_REQUIRES(
-        context, found_true == num_true_t(),
+        context, found_true == num_true,
         errors::InvalidArgument(
             "WhereOp: Race condition between counting the number of true "
             "elements and writing them.  When counting, saw ",
-            num_true_t(), " elements; but when writing their indices, saw ",
+            num_true, " elements; but when writing their indices, saw ",
             found_true, " elements."));
   }
 
  private:
+  // Number of input elements counted and written by one unit of work.
+  static constexpr int64 kBlockSize = 1 << 14;
+
   TF_DISALLOW_COPY_AND_ASSIGN(WhereCPUOp);
 };
 
+template <typename T>
+constexpr int64 WhereCPUOp<T>::kBlockSize;
+
 #define REGISTER_WHERE_OP(T) \
   REGISTER_KERNEL_BUILDER(   \
       Name("Where").Device(DEVICE_CPU).TypeConstraint<T>("T"), WhereCPUOp<T>);
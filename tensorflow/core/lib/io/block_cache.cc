@@ -0,0 +1,68 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/block_cache.h"
+
+#include "tensorflow/core/lib/io/block.h"
+
+namespace tensorflow {
+namespace table {
+
+uint64 BlockCache::NewId() {
+  mutex_lock l(mu_);
+  return next_id_++;
+}
+
+std::shared_ptr<Block> BlockCache::Lookup(uint64 id, uint64 offset) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(std::make_pair(id, offset));
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_iterator);
+  return it->second.block;
+}
+
+void BlockCache::Insert(uint64 id, uint64 offset,
+                        std::shared_ptr<Block> block) {
+  if (block->size() > capacity_) {
+    return;
+  }
+  mutex_lock l(mu_);
+  const Key key = std::make_pair(id, offset);
+  if (entries_.find(key) != entries_.end()) {
+    // Another thread cached the same block.
+    return;
+  }
+  total_size_ += block->size();
+  lru_list_.push_front(key);
+  Entry& entry = entries_[key];
+  entry.block = std::move(block);
+  entry.lru_iterator = lru_list_.begin();
+  while (total_size_ > capacity_) {
+    auto evicted = entries_.find(lru_list_.back());
+    total_size_ -= evicted->second.block->size();
+    entries_.erase(evicted);
+    lru_list_.pop_back();
+  }
+}
+
+size_t BlockCache::TotalSize() const {
+  mutex_lock l(mu_);
+  return total_size_;
+}
+
+}  // namespace table
+}  // namespace tensorflow
@@ -0,0 +1,81 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_BLOCK_CACHE_H_
+#define TENSORFLOW_LIB_IO_BLOCK_CACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace table {
+
+class Block;
+
+// A cache of the uncompressed blocks of tables, evicting the least recently
+// used ones to stay within a capacity in bytes.
+//
+// A cache may be shared by the tables opened with it, and is safe for
+// concurrent use by multiple threads.
+class BlockCache {
+ public:
+  explicit BlockCache(size_t capacity) : capacity_(capacity) {}
+
+  // Returns an id that distinguishes the blocks of a table from the blocks of
+  // the other tables in the cache.
+  uint64 NewId() LOCKS_EXCLUDED(mu_);
+
+  // Returns the block at `offset` in the table with id `id`, or nullptr if it
+  // is not cached.
+  std::shared_ptr<Block> Lookup(uint64 id, uint64 offset) LOCKS_EXCLUDED(mu_);
+
+  // Caches `block` as the block at `offset` in the table with id `id`.
+  void Insert(uint64 id, uint64 offset, std::shared_ptr<Block> block)
+      LOCKS_EXCLUDED(mu_);
+
+  // The combined size in bytes of the cached blocks.
+  size_t TotalSize() const LOCKS_EXCLUDED(mu_);
+
+ private:
+  typedef std::pair<uint64, uint64> Key;
+
+  struct Entry {
+    std::shared_ptr<Block> block;
+    // The position of the key in lru_list_.
+    std::list<Key>::iterator lru_iterator;
+  };
+
+  const size_t capacity_;
+
+  mutable mutex mu_;
+  uint64 next_id_ GUARDED_BY(mu_) = 0;
+  std::map<Key, Entry> entries_ GUARDED_BY(mu_);
+  // The keys of the cached blocks, most recently used first.
+  std::list<Key> lru_list_ GUARDED_BY(mu_);
+  size_t total_size_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BlockCache);
+};
+
+}  // namespace table
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_BLOCK_CACHE_H_
@@ -0,0 +1,81 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/bloom_filter.h"
+
+#include <algorithm>
+#include "tensorflow/core/lib/hash/hash.h"
+
+namespace tensorflow {
+namespace table {
+
+uint32 BloomHash(const StringPiece& key) {
+  return Hash32(key.data(), key.size(), 0xbc9f1d34);
+}
+
+void CreateBloomFilter(const std::vector<uint32>& key_hashes, int bits_per_key,
+                       string* dst) {
+  // Round down to reduce probing cost a little bit.  ln(2) is the number of
+  // probes that minimizes the false positive rate.
+  const size_t num_probes = std::min(std::max(bits_per_key * 69 / 100, 1), 30);
+
+  // For small n, we can see a very high false positive rate.  Fix it
+  // by enforcing a minimum bloom filter length.
+  size_t bits = std::max<size_t>(key_hashes.size() * bits_per_key, 64);
+  const size_t bytes = (bits + 7) / 8;
+  bits = bytes * 8;
+
+  const size_t init_size = dst->size();
+  dst->resize(init_size + bytes, 0);
+  dst->push_back(static_cast<char>(num_probes));
+  char* array = &(*dst)[init_size];
+  for (uint32 h : key_hashes) {
+    // Use double-hashing to generate a sequence of hash values.
+    const uint32 delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+    for (size_t j = 0; j < num_probes; j++) {
+      const uint32 bitpos = h % bits;
+      array[bitpos / 8] |= (1 << (bitpos % 8));
+      h += delta;
+    }
+  }
+}
+
+bool BloomFilterMayMatch(uint32 key_hash, const StringPiece& filter) {
+  const size_t len = filter.size();
+  if (len < 2) return false;
+
+  const char* array = filter.data();
+  const size_t bits = (len - 1) * 8;
+
+  // Use the encoded number of probes so that we can read filters generated by
+  // bloom filters created using different parameters.
+  const size_t num_probes = static_cast<uint8>(array[len - 1]);
+  if (num_probes > 30) {
+    // Reserved for potentially new encodings.  Consider it a match.
+    return true;
+  }
+
+  uint32 h = key_hash;
+  const uint32 delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+  for (size_t j = 0; j < num_probes; j++) {
+    const uint32 bitpos = h % bits;
+    if ((array[bitpos / 8] & (1 << (bitpos % 8))) == 0) return false;
+    h += delta;
+  }
+  return true;
+}
+
+}  // namespace table
+}  // namespace tensorflow
@@ -0,0 +1,45 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Bloom filters over the keys of a table, as in LevelDB's bloom filter
+// policy.  A filter is a bit array followed by one byte holding the number
+// of probes per key.
+
+#ifndef TENSORFLOW_LIB_IO_BLOOM_FILTER_H_
+#define TENSORFLOW_LIB_IO_BLOOM_FILTER_H_
+
+#include <vector>
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace table {
+
+// Returns the hash of "key" that the filters are built from.
+uint32 BloomHash(const StringPiece& key);
+
+// Appends to "*dst" a filter of the keys with hashes "key_hashes", using
+// about "bits_per_key" bits per key.
+void CreateBloomFilter(const std::vector<uint32>& key_hashes, int bits_per_key,
+                       string* dst);
+
+// Returns false if the key with hash "key_hash" is definitely not one of the
+// keys of "filter".
+bool BloomFilterMayMatch(uint32 key_hash, const StringPiece& filter);
+
+}  // namespace table
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_BLOOM_FILTER_H_
@@ -88,6 +88,9 @@ static const uint64 kTableMagicNumber = 0xdb4775248b80fb57ull;
 // 1-byte type + 32-bit crc
 static const size_t kBlockTrailerSize = 5;
 
+// The key of the handle of the bloom filter block in the metaindex block.
+static const char kBloomFilterMetaKey[] = "filter.bloom";
+
 struct BlockContents {
   StringPiece data;     // Actual contents of data
   bool cachable;        // True iff data can be cached
@@ -20,26 +20,96 @@ limitations under the License.
 namespace tensorflow {
 namespace io {
 
-InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes)
+InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes,
+                         int max_reads_in_flight)
     : file_(file),
       file_pos_(0),
       size_(buffer_bytes),
       buf_(new char[size_]),
       pos_(buf_),
-      limit_(buf_) {}
+      limit_(buf_),
+      max_reads_in_flight_(max_reads_in_flight) {}
 
-InputBuffer::~InputBuffer() { delete[] buf_; }
+InputBuffer::~InputBuffer() {
+  ClearPendingReads();
+  for (char* buf : free_bufs_) {
+    delete[] buf;
+  }
+  delete[] buf_;
+}
 
 Status InputBuffer::FillBuffer() {
-  StringPiece data;
-  Status s = file_->Read(file_pos_, size_, &data, buf_);
-  if (data.data() != buf_) {
-    memmove(buf_, data.data(), data.size());
+  if (max_reads_in_flight_ <= 0) {
+    StringPiece data;
+    Status s = file_->Read(file_pos_, size_, &data, buf_);
+    if (data.data() != buf_) {
+      memmove(buf_, data.data(), data.size());
+    }
+    pos_ = buf_;
+    limit_ = pos_ + data.size();
+    file_pos_ += data.size();
+    return s;
+  }
+
+  // Reads started before a Seek() outside of the buffer are of no use.
+  if (!pending_reads_.empty() && pending_reads_.front()->offset != file_pos_) {
+    ClearPendingReads();
+  }
+  if (pending_reads_.empty()) {
+    StartRead(file_pos_);
+  }
+  std::unique_ptr<PendingRead> read = std::move(pending_reads_.front());
+  pending_reads_.pop_front();
+  read->done.WaitForNotification();
+  // The buffer read becomes the current one, and the current one is free.
+  std::swap(buf_, read->buf);
+  free_bufs_.push_back(read->buf);
+  if (read->data.data() != buf_) {
+    memmove(buf_, read->data.data(), read->data.size());
   }
   pos_ = buf_;
-  limit_ = pos_ + data.size();
-  file_pos_ += data.size();
-  return s;
+  limit_ = pos_ + read->data.size();
+  file_pos_ += read->data.size();
+  if (read->status.ok()) {
+    // The whole buffer was read, so the file may go on past it.
+    int64 offset = pending_reads_.empty() ? file_pos_
+                                          : pending_reads_.back()->offset +
+                                                static_cast<int64>(size_);
+    while (pending_reads_.size() < static_cast<size_t>(max_reads_in_flight_)) {
+      StartRead(offset);
+      offset += size_;
+    }
+  } else {
+    ClearPendingReads();
+  }
+  return read->status;
+}
+
+void InputBuffer::StartRead(int64 offset) {
+  std::unique_ptr<PendingRead> read(new PendingRead);
+  read->offset = offset;
+  if (free_bufs_.empty()) {
+    read->buf = new char[size_];
+  } else {
+    read->buf = free_bufs_.back();
+    free_bufs_.pop_back();
+  }
+  PendingRead* r = read.get();
+  pending_reads_.push_back(std::move(read));
+  file_->ReadAsync(offset, size_, r->buf,
+                   [r](const Status& status, StringPiece data) {
+                     r->status = status;
+                     r->data = data;
+                     r->done.Notify();
+                   });
+}
+
+void InputBuffer::ClearPendingReads() {
+  for (const auto& read : pending_reads_) {
+    read->done.WaitForNotification();
+    free_bufs_.push_back(read->buf);
+  }
+  pending_reads_.clear();
 }
 
 Status InputBuffer::ReadLine(string* result) {
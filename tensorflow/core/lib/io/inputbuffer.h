@@ -17,7 +17,11 @@ limitations under the License.
 #define TENSORFLOW_LIB_IO_INPUTBUFFER_H_
 
 #include <string>
+#include <deque>
+#include <memory>
+#include <vector>
 #include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
@@ -33,7 +37,12 @@ class InputBuffer {
  public:
   // Create an InputBuffer for "file" with a buffer size of
   // "buffer_bytes" bytes.  'file' must outlive *this.
-  InputBuffer(RandomAccessFile* file, size_t buffer_bytes);
+  //
+  // If "max_reads_in_flight" is positive, up to that many reads of the
+  // buffers that follow the current one are kept in flight with
+  // RandomAccessFile::ReadAsync() while the file is read sequentially.
+  InputBuffer(RandomAccessFile* file, size_t buffer_bytes,
+              int max_reads_in_flight = 0);
   ~InputBuffer();
 
   // Read one text line of data into "*result" until end-of-file or a
@@ -82,6 +91,22 @@ class InputBuffer {
  private:
   Status FillBuffer();
 
+  // A read of the "size_" bytes at "offset" into "buf", started ahead of its
+  // use.
+  struct PendingRead {
+    int64 offset;
+    char* buf;
+    Status status;
+    StringPiece data;
+    Notification done;
+  };
+
+  // Starts reading the buffer at "offset" asynchronously.
+  void StartRead(int64 offset);
+
+  // Waits for the pending reads, and drops their data.
+  void ClearPendingReads();
+
   // Internal slow-path routine used by ReadVarint32().
   Status ReadVarint32Fallback(uint32* result);
 
@@ -102,6 +127,12 @@ class InputBuffer {
   char* pos_;    // Current position in "buf"
   char* limit_;  // Just past end of valid data in "buf"
 
+  const int max_reads_in_flight_;
+  // The reads of the buffers that follow "file_pos_", in file order.
+  std::deque<std::unique_ptr<PendingRead>> pending_reads_;
+  // Buffers no longer used by reads, to be reused by later ones.
+  std::vector<char*> free_bufs_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(InputBuffer);
 };
 
@@ -292,6 +292,35 @@ TEST(InputBuffer, Seek) {
   }
 }
 
+TEST(InputBuffer, ReadsInFlight) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/inputbuffer_test";
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+
+  for (auto buf_size : BufferSizes()) {
+    for (int max_reads_in_flight : {1, 4}) {
+      std::unique_ptr<RandomAccessFile> file;
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+      string read;
+      io::InputBuffer in(file.get(), buf_size, max_reads_in_flight);
+
+      TF_CHECK_OK(in.ReadNBytes(3, &read));
+      EXPECT_EQ(read, "012");
+      TF_CHECK_OK(in.ReadNBytes(4, &read));
+      EXPECT_EQ(read, "3456");
+
+      // Reads in flight past a seek are dropped.
+      TF_CHECK_OK(in.Seek(1));
+      TF_CHECK_OK(in.ReadNBytes(5, &read));
+      EXPECT_EQ(read, "12345");
+      TF_CHECK_OK(in.SkipNBytes(1));
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+      EXPECT_EQ(read, "789");
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+    }
+  }
+}
+
 TEST(InputBuffer, ReadVarint32) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/inputbuffer_test";
@@ -22,12 +22,69 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/snappy/snappy_block_inputstream.h"
+#endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace io {
 
+namespace {
+
+// An input stream over an InputBuffer that keeps reads in flight.
+class PrefetchingInputStream : public InputStreamInterface {
+ public:
+  PrefetchingInputStream(RandomAccessFile* file, size_t buffer_bytes,
+                         int max_reads_in_flight)
+      : input_buffer_(file, buffer_bytes, max_reads_in_flight) {}
+
+  Status ReadNBytes(int64 bytes_to_read, string* result) override {
+    return input_buffer_.ReadNBytes(bytes_to_read, result);
+  }
+
+  Status SkipNBytes(int64 bytes_to_skip) override {
+    return input_buffer_.SkipNBytes(bytes_to_skip);
+  }
+
+  int64 Tell() const override { return input_buffer_.Tell(); }
+
+  Status Reset() override { return input_buffer_.Seek(0); }
+
+ private:
+  InputBuffer input_buffer_;
+};
+
+// A file that drops the data it reads from the OS cache.
+class CacheDroppingFile : public RandomAccessFile {
+ public:
+  explicit CacheDroppingFile(RandomAccessFile* file) : file_(file) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    Status s = file_->Read(offset, n, result, scratch);
+    file_->DropCachedData(offset, result->size());
+    return s;
+  }
+
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadCallback done) const override {
+    const RandomAccessFile* file = file_;
+    file_->ReadAsync(offset, n, scratch,
+                     [file, offset, done](const Status& s, StringPiece result) {
+                       file->DropCachedData(offset, result.size());
+                       done(s, result);
+                     });
+  }
+
+ private:
+  RandomAccessFile* const file_;  // Not owned
+};
+
+}  // namespace
+
 RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     const string& compression_type) {
   RecordReaderOptions options;
@@ -46,6 +103,12 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kSnappy) {
+    options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -56,10 +119,16 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
-    : options_(options),
-      input_stream_(new RandomAccessInputStream(file)),
-      last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+    : options_(options), last_read_failed_(false) {
+  if (options.drop_cached_data) {
+    cache_dropping_file_.reset(new CacheDroppingFile(file));
+    file = cache_dropping_file_.get();
+  }
+  input_stream_.reset(new RandomAccessInputStream(file));
+  if (options.buffer_size > 0 && options.max_reads_in_flight > 0) {
+    input_stream_.reset(new PrefetchingInputStream(
+        file, options.buffer_size, options.max_reads_in_flight));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -71,6 +140,14 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(new ZlibInputStream(
         input_stream_.release(), options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options, true));
+#endif  // IS_SLIM_BUILD
+  } else if (options.compression_type ==
+             RecordReaderOptions::SNAPPY_COMPRESSION) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Snappy compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    input_stream_.reset(new SnappyBlockInputStream(
+        input_stream_.release(), options.snappy_blocks_in_flight, true));
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
@@ -152,5 +229,20 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+Status ReadRecordIndex(Env* env, const string& index_fname,
+                       std::vector<uint64>* offsets) {
+  string index;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_fname, &index));
+  if (index.size() % sizeof(uint64) != 0) {
+    return errors::DataLoss("truncated record index ", index_fname);
+  }
+  offsets->clear();
+  offsets->reserve(index.size() / sizeof(uint64));
+  for (size_t pos = 0; pos < index.size(); pos += sizeof(uint64)) {
+    offsets->push_back(core::DecodeFixed64(index.data() + pos));
+  }
+  return Status::OK();
+}
+
 }  // namespace io
 }  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
@@ -28,20 +30,39 @@ limitations under the License.
 
 namespace tensorflow {
 
+class Env;
 class RandomAccessFile;
 
 namespace io {
 
 class RecordReaderOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    SNAPPY_COMPRESSION = 2
+  };
   CompressionType compression_type = NONE;
 
+  // The number of blocks of SNAPPY_COMPRESSION files that are uncompressed in
+  // parallel ahead of the records read.
+  int snappy_blocks_in_flight = 16;
+
   // If buffer_size is non-zero, then all reads must be sequential, and no
   // skipping around is permitted. (Note: this is the same behavior as reading
   // compressed files.) Consider using SequentialRecordReader.
   int64 buffer_size = 0;
 
+  // If both buffer_size and max_reads_in_flight are positive, up to
+  // max_reads_in_flight reads of buffer_size bytes past the current record
+  // are kept in flight, so that a single reader can keep a fast disk busy.
+  int max_reads_in_flight = 0;
+
+  // If true, the data read is dropped from the OS cache once it is read, so
+  // that a single pass over large files does not evict the cached data of
+  // other processes.
+  bool drop_cached_data = false;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -75,6 +96,8 @@ class RecordReader {
   Status ReadChecksummed(uint64 offset, size_t n, string* result);
 
   RecordReaderOptions options_;
+  // The file that drops the data read from the OS cache, if any.
+  std::unique_ptr<RandomAccessFile> cache_dropping_file_;
   std::unique_ptr<InputStreamInterface> input_stream_;
   bool last_read_failed_;
 
@@ -119,6 +142,12 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+// Reads the index that RecordWriter wrote alongside a record file to
+// "index_fname" into "*offsets", the offsets of the records of the file in
+// order. Any of them can then be read with RecordReader::ReadRecord().
+Status ReadRecordIndex(Env* env, const string& index_fname,
+                       std::vector<uint64>* offsets);
+
 }  // namespace io
 }  // namespace tensorflow
 
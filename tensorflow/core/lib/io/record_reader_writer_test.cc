@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -105,4 +106,146 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestSnappy) {
+  string out;
+  if (!port::Snappy_Compress("abc", 3, &out)) {
+    fprintf(stderr, "Snappy disabled. Skipping test\n");
+    return;
+  }
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions("SNAPPY");
+    // Small blocks, so that records span several of them.
+    options.snappy_block_size = 64;
+    io::RecordWriter writer(file.get(), options);
+    for (int i = 0; i < 100; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record", i)));
+    }
+    TF_CHECK_OK(writer.Close());
+  }
+
+  for (int blocks_in_flight : {1, 4}) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options =
+        io::RecordReaderOptions::CreateRecordReaderOptions("SNAPPY");
+    options.snappy_blocks_in_flight = blocks_in_flight;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    uint64 second_offset = 0;
+    string record;
+    for (int i = 0; i < 100; ++i) {
+      if (i == 1) second_offset = offset;
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(strings::StrCat("record", i), record);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+    // Reading an earlier record starts over from the first block.
+    TF_CHECK_OK(reader.ReadRecord(&second_offset, &record));
+    EXPECT_EQ("record1", record);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestReadsInFlight) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_reads_in_flight";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 100; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record", i)));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.buffer_size = buf_size;
+    options.max_reads_in_flight = 4;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    string record;
+    for (int i = 0; i < 100; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(strings::StrCat("record", i), record);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+}
+
+TEST(RecordReaderWriterTest, TestDropCachedData) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_drop_cached_data";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 100; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record", i)));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  for (int max_reads_in_flight : {0, 4}) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.buffer_size = 64;
+    options.max_reads_in_flight = max_reads_in_flight;
+    options.drop_cached_data = true;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    string record;
+    for (int i = 0; i < 100; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(strings::StrCat("record", i), record);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = fname + ".index";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+    io::RecordWriter writer(file.get(), index_file.get());
+    for (int i = 0; i < 10; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record", i)));
+    }
+    TF_CHECK_OK(writer.Flush());
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  std::vector<uint64> offsets;
+  TF_CHECK_OK(io::ReadRecordIndex(env, index_fname, &offsets));
+  ASSERT_EQ(10, offsets.size());
+
+  // Read the records in reverse order.
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  string record;
+  for (int i = 9; i >= 0; --i) {
+    uint64 offset = offsets[i];
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(strings::StrCat("record", i), record);
+  }
+}
+
 }  // namespace tensorflow
@@ -18,6 +18,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
+#if !defined(IS_SLIM_BUILD)
+#include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
+#endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -26,6 +29,30 @@ namespace {
 bool IsZlibCompressed(RecordWriterOptions options) {
   return options.compression_type == RecordWriterOptions::ZLIB_COMPRESSION;
 }
+
+bool IsSnappyCompressed(RecordWriterOptions options) {
+  return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
+}
+
+#if !defined(IS_SLIM_BUILD)
+// A file that compresses the data appended to it into independent snappy
+// blocks.
+class SnappyBlockWritableFile : public WritableFile {
+ public:
+  SnappyBlockWritableFile(WritableFile* file, int32 block_size)
+      : output_buffer_(file, block_size, block_size) {}
+
+  Status Append(const StringPiece& data) override {
+    return output_buffer_.Write(data);
+  }
+  Status Close() override { return output_buffer_.Flush(); }
+  Status Flush() override { return output_buffer_.Flush(); }
+  Status Sync() override { return output_buffer_.Flush(); }
+
+ private:
+  SnappyOutputBuffer output_buffer_;
+};
+#endif  // IS_SLIM_BUILD
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -46,6 +73,12 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
                << " No compression will be used.";
 #else
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
+#endif  // IS_SLIM_BUILD
+  } else if (compression_type == compression::kSnappy) {
+    options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+#if defined(IS_SLIM_BUILD)
+    LOG(ERROR) << "Compression is not supported but compression_type is set."
+               << " No compression will be used.";
 #endif  // IS_SLIM_BUILD
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
@@ -71,6 +104,12 @@ RecordWriter::RecordWriter(WritableFile* dest,
                  << s.ToString();
     }
     dest_ = zlib_output_buffer;
+#endif  // IS_SLIM_BUILD
+  } else if (IsSnappyCompressed(options)) {
+#if defined(IS_SLIM_BUILD)
+    LOG(FATAL) << "Snappy compression is unsupported on mobile platforms.";
+#else   // IS_SLIM_BUILD
+    dest_ = new SnappyBlockWritableFile(dest, options.snappy_block_size);
 #endif  // IS_SLIM_BUILD
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
@@ -79,6 +118,15 @@ RecordWriter::RecordWriter(WritableFile* dest,
   }
 }
 
+RecordWriter::RecordWriter(WritableFile* dest, WritableFile* index_dest,
+                           const RecordWriterOptions& options)
+    : RecordWriter(dest, options) {
+  if (options.compression_type != RecordWriterOptions::NONE) {
+    LOG(FATAL) << "Compressed record files cannot be indexed.";
+  }
+  index_dest_ = index_dest;
+}
+
 RecordWriter::~RecordWriter() {
   if (dest_ != nullptr) {
     Status s = Close();
@@ -105,6 +153,14 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[sizeof(uint32)];
   core::EncodeFixed32(footer, MaskedCrc(data.data(), data.size()));
 
+  if (index_dest_ != nullptr) {
+    char offset[sizeof(uint64)];
+    core::EncodeFixed64(offset, bytes_written_);
+    TF_RETURN_IF_ERROR(
+        index_dest_->Append(StringPiece(offset, sizeof(offset))));
+    bytes_written_ += sizeof(header) + data.size() + sizeof(footer);
+  }
+
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
@@ -112,7 +168,7 @@ Status RecordWriter::WriteRecord(StringPiece data) {
 
 Status RecordWriter::Close() {
 #if !defined(IS_SLIM_BUILD)
-  if (IsZlibCompressed(options_)) {
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -123,7 +179,7 @@ Status RecordWriter::Close() {
 }
 
 Status RecordWriter::Flush() {
-  if (IsZlibCompressed(options_)) {
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     return dest_->Flush();
   }
   return Status::OK();
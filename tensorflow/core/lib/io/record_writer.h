@@ -33,9 +33,18 @@ namespace io {
 
 class RecordWriterOptions {
  public:
-  enum CompressionType { NONE = 0, ZLIB_COMPRESSION = 1 };
+  // SNAPPY_COMPRESSION compresses blocks of records independently, so that
+  // they can be uncompressed in parallel.
+  enum CompressionType {
+    NONE = 0,
+    ZLIB_COMPRESSION = 1,
+    SNAPPY_COMPRESSION = 2
+  };
   CompressionType compression_type = NONE;
 
+  // The uncompressed size of the blocks of SNAPPY_COMPRESSION files.
+  int32 snappy_block_size = 256 << 10;
+
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
@@ -53,6 +62,14 @@ class RecordWriter {
   RecordWriter(WritableFile* dest,
                const RecordWriterOptions& options = RecordWriterOptions());
 
+  // Create a writer that also appends the offset of each record in "*dest" to
+  // "*index_dest", as a fixed64, so that the records can later be read in any
+  // order (see ReadRecordIndex()). "*index_dest" must be initially empty, and
+  // must remain live while this Writer is in use. Compressed files cannot be
+  // indexed.
+  RecordWriter(WritableFile* dest, WritableFile* index_dest,
+               const RecordWriterOptions& options = RecordWriterOptions());
+
   // Calls Close() and logs if an error occurs.
   //
   // TODO(jhseu): Require that callers explicitly call Close() and remove the
@@ -75,6 +92,9 @@ class RecordWriter {
  private:
   WritableFile* dest_;
   RecordWriterOptions options_;
+  WritableFile* index_dest_ = nullptr;
+  // The number of bytes written to "*dest_", if it is indexed.
+  uint64 bytes_written_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordWriter);
 };
@@ -0,0 +1,147 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/snappy/snappy_block_inputstream.h"
+#include <algorithm>
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace io {
+
+namespace {
+
+// The size of the header holding the compressed length of a block.
+constexpr size_t kBlockHeaderSize = 4;
+
+thread::ThreadPool* UncompressThreadPool() {
+  static thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "snappy_block_uncompress",
+                             std::max(port::NumSchedulableCPUs(), 1));
+  return pool;
+}
+
+}  // namespace
+
+SnappyBlockInputStream::SnappyBlockInputStream(
+    InputStreamInterface* input_stream, size_t max_blocks_in_flight,
+    bool owns_input_stream)
+    : input_stream_(input_stream),
+      max_blocks_in_flight_(std::max<size_t>(max_blocks_in_flight, 1)),
+      owns_input_stream_(owns_input_stream) {}
+
+SnappyBlockInputStream::~SnappyBlockInputStream() {
+  ClearBlocks();
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status SnappyBlockInputStream::ReadNBytes(int64 bytes_to_read,
+                                          string* result) {
+  result->clear();
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    TF_RETURN_IF_ERROR(ReadAhead());
+    if (blocks_.empty()) {
+      return errors::OutOfRange("EOF reached");
+    }
+    Block* block = blocks_.front().get();
+    block->done.WaitForNotification();
+    TF_RETURN_IF_ERROR(block->status);
+    const size_t bytes_to_copy =
+        std::min<size_t>(block->data.size() - block_pos_,
+                         bytes_to_read - result->size());
+    result->append(block->data.data() + block_pos_, bytes_to_copy);
+    block_pos_ += bytes_to_copy;
+    bytes_read_ += bytes_to_copy;
+    if (block_pos_ == block->data.size()) {
+      blocks_.pop_front();
+      block_pos_ = 0;
+    }
+  }
+  return Status::OK();
+}
+
+Status SnappyBlockInputStream::Reset() {
+  ClearBlocks();
+  end_of_input_ = false;
+  bytes_read_ = 0;
+  return input_stream_->Reset();
+}
+
+Status SnappyBlockInputStream::ReadAhead() {
+  while (!end_of_input_ && blocks_.size() < max_blocks_in_flight_) {
+    string header;
+    Status s = input_stream_->ReadNBytes(kBlockHeaderSize, &header);
+    if (errors::IsOutOfRange(s) && header.empty()) {
+      end_of_input_ = true;
+      break;
+    }
+    if (errors::IsOutOfRange(s)) {
+      return errors::DataLoss("Truncated snappy block header at ",
+                              input_stream_->Tell());
+    }
+    TF_RETURN_IF_ERROR(s);
+    uint32 compressed_length = 0;
+    for (char c : header) {
+      // Big endian, as written by SnappyOutputBuffer.
+      compressed_length =
+          (compressed_length << 8) | static_cast<unsigned char>(c);
+    }
+    std::unique_ptr<Block> block(new Block);
+    s = input_stream_->ReadNBytes(compressed_length, &block->compressed);
+    if (errors::IsOutOfRange(s)) {
+      return errors::DataLoss("Truncated snappy block at ",
+                              input_stream_->Tell());
+    }
+    TF_RETURN_IF_ERROR(s);
+    Block* b = block.get();
+    blocks_.push_back(std::move(block));
+    UncompressThreadPool()->Schedule([b]() {
+      size_t length;
+      if (!port::Snappy_GetUncompressedLength(b->compressed.data(),
+                                              b->compressed.size(), &length)) {
+        b->status = errors::DataLoss("Snappy_GetUncompressedLength failed");
+      } else {
+        b->data.resize(length);
+        if (!port::Snappy_Uncompress(b->compressed.data(),
+                                     b->compressed.size(), &b->data[0])) {
+          b->status = errors::DataLoss("Snappy_Uncompress failed");
+        }
+      }
+      string().swap(b->compressed);
+      b->done.Notify();
+    });
+  }
+  return Status::OK();
+}
+
+void SnappyBlockInputStream::ClearBlocks() {
+  for (const auto& block : blocks_) {
+    block->done.WaitForNotification();
+  }
+  blocks_.clear();
+  block_pos_ = 0;
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_SNAPPY_SNAPPY_BLOCK_INPUTSTREAM_H_
+#define TENSORFLOW_LIB_IO_SNAPPY_SNAPPY_BLOCK_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// An input stream that uncompresses the blocks written by SnappyOutputBuffer.
+//
+// The blocks are compressed independently, so up to `max_blocks_in_flight`
+// blocks past the one being read are uncompressed in parallel on a shared
+// thread pool. Reading compressed data is then no longer bound to one core.
+//
+// A given instance of an SnappyBlockInputStream is NOT safe for concurrent use
+// by multiple threads
+class SnappyBlockInputStream : public InputStreamInterface {
+ public:
+  // Create a SnappyBlockInputStream for `input_stream`. Does not take
+  // ownership of `input_stream` unless `owns_input_stream` is set to true.
+  // `input_stream` must outlive *this then.
+  SnappyBlockInputStream(InputStreamInterface* input_stream,
+                         size_t max_blocks_in_flight,
+                         bool owns_input_stream = false);
+
+  ~SnappyBlockInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:
+  //   If successful.
+  // OUT_OF_RANGE:
+  //   If there are not enough bytes to read before the end of the stream.
+  // DATA_LOSS:
+  //   If uncompression failed or if the stream is corrupted.
+  // others:
+  //   If reading from the input stream failed.
+  Status ReadNBytes(int64 bytes_to_read, string* result) override;
+
+  int64 Tell() const override { return bytes_read_; }
+
+  Status Reset() override;
+
+ private:
+  // A compressed block, and its data once it is uncompressed.
+  struct Block {
+    string compressed;
+    string data;
+    Status status;
+    Notification done;
+  };
+
+  // Reads compressed blocks from the input stream, and starts uncompressing
+  // them, until `max_blocks_in_flight_` blocks are pending or the input ends.
+  Status ReadAhead();
+
+  // Waits for the pending blocks, and drops them.
+  void ClearBlocks();
+
+  InputStreamInterface* input_stream_;
+  const size_t max_blocks_in_flight_;
+  const bool owns_input_stream_;
+  // The blocks past the bytes read, in stream order.
+  std::deque<std::unique_ptr<Block>> blocks_;
+  // The number of bytes of the first block that were read.
+  size_t block_pos_ = 0;
+  // Whether the last block of the input stream was read.
+  bool end_of_input_ = false;
+  // The number of uncompressed bytes read.
+  int64 bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SnappyBlockInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_SNAPPY_SNAPPY_BLOCK_INPUTSTREAM_H_
@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/table.h"
 
+#include <memory>
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/block.h"
+#include "tensorflow/core/lib/io/block_cache.h"
+#include "tensorflow/core/lib/io/bloom_filter.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/table_options.h"
 #include "tensorflow/core/lib/io/two_level_iterator.h"
@@ -27,17 +30,51 @@ namespace tensorflow {
 namespace table {
 
 struct Table::Rep {
-  ~Rep() { delete index_block; }
+  ~Rep() {
+    delete index_block;
+    delete[] filter_data;
+  }
 
   Options options;
   Status status;
   RandomAccessFile* file;
-  // XXX  uint64 cache_id;
+  uint64 cache_id;
 
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
   Block* index_block;
+
+  // The bloom filter of the keys, if any.
+  StringPiece filter;
+  const char* filter_data = nullptr;  // Owned filter data, if any.
+
+  // Reads the bloom filter listed in the metaindex block, if any.
+  void ReadFilter();
 };
 
+void Table::Rep::ReadFilter() {
+  // Errors are ignored: the table can be read without its filter.
+  BlockContents contents;
+  if (!ReadBlock(file, metaindex_handle, &contents).ok()) {
+    return;
+  }
+  Block metaindex_block(contents);
+  std::unique_ptr<Iterator> iter(metaindex_block.NewIterator());
+  iter->Seek(kBloomFilterMetaKey);
+  if (!iter->Valid() || iter->key() != kBloomFilterMetaKey) {
+    return;
+  }
+  BlockHandle handle;
+  StringPiece input = iter->value();
+  if (!handle.DecodeFrom(&input).ok() ||
+      !ReadBlock(file, handle, &contents).ok()) {
+    return;
+  }
+  filter = contents.data;
+  if (contents.heap_allocated) {
+    filter_data = contents.data.data();
+  }
+}
+
 Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
                    Table** table) {
   *table = nullptr;
@@ -73,8 +110,10 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
     rep->file = file;
     rep->metaindex_handle = footer.metaindex_handle();
     rep->index_block = index_block;
-    // XXX    rep->cache_id = (options.block_cache ?
-    // options.block_cache->NewId() : 0);
+    rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
+    if (options.filter_bits_per_key > 0) {
+      rep->ReadFilter();
+    }
     *table = new Table(rep);
   } else {
     if (index_block) delete index_block;
@@ -89,13 +128,17 @@ static void DeleteBlock(void* arg, void* ignored) {
   delete reinterpret_cast<Block*>(arg);
 }
 
+static void ReleaseCachedBlock(void* arg, void* ignored) {
+  delete reinterpret_cast<std::shared_ptr<Block>*>(arg);
+}
+
 // Convert an index iterator value (i.e., an encoded BlockHandle)
 // into an iterator over the contents of the corresponding block.
 Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
   Table* table = reinterpret_cast<Table*>(arg);
-  //  Cache* block_cache = table->rep_->options.block_cache;
+  BlockCache* block_cache = table->rep_->options.block_cache;
   Block* block = nullptr;
-  //  Cache::Handle* cache_handle = NULL;
+  std::shared_ptr<Block>* cached_block = nullptr;
 
   BlockHandle handle;
   StringPiece input = index_value;
@@ -104,17 +147,36 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
   // can add more features in the future.
 
   if (s.ok()) {
-    BlockContents contents;
-    s = ReadBlock(table->rep_->file, handle, &contents);
-    if (s.ok()) {
-      block = new Block(contents);
+    if (block_cache != nullptr) {
+      std::shared_ptr<Block> found =
+          block_cache->Lookup(table->rep_->cache_id, handle.offset());
+      if (found != nullptr) {
+        cached_block = new std::shared_ptr<Block>(std::move(found));
+        block = cached_block->get();
+      }
+    }
+    if (block == nullptr) {
+      BlockContents contents;
+      s = ReadBlock(table->rep_->file, handle, &contents);
+      if (s.ok()) {
+        block = new Block(contents);
+        if (block_cache != nullptr && contents.cachable) {
+          cached_block = new std::shared_ptr<Block>(block);
+          block_cache->Insert(table->rep_->cache_id, handle.offset(),
+                              *cached_block);
+        }
+      }
     }
   }
 
   Iterator* iter;
   if (block != nullptr) {
     iter = block->NewIterator();
-    iter->RegisterCleanup(&DeleteBlock, block, nullptr);
+    if (cached_block != nullptr) {
+      iter->RegisterCleanup(&ReleaseCachedBlock, cached_block, nullptr);
+    } else {
+      iter->RegisterCleanup(&DeleteBlock, block, nullptr);
+    }
   } else {
     iter = NewErrorIterator(s);
   }
@@ -130,6 +192,9 @@ Status Table::InternalGet(const StringPiece& k, void* arg,
                           void (*saver)(void*, const StringPiece&,
                                         const StringPiece&)) {
   Status s;
+  if (!KeyMayMatch(k)) {
+    return s;
+  }
   Iterator* iiter = rep_->index_block->NewIterator();
   iiter->Seek(k);
   if (iiter->Valid()) {
@@ -175,5 +240,10 @@ uint64 Table::ApproximateOffsetOf(const StringPiece& key) const {
   return result;
 }
 
+bool Table::KeyMayMatch(const StringPiece& key) const {
+  return rep_->filter.empty() ||
+         BloomFilterMayMatch(BloomHash(key), rep_->filter);
+}
+
 }  // namespace table
 }  // namespace tensorflow
@@ -62,6 +62,11 @@ class Table {
   // be close to the file length.
   uint64 ApproximateOffsetOf(const StringPiece& key) const;
 
+  // Returns false if "key" is definitely not in the table, which is known
+  // without reading any data block if the table has a bloom filter and was
+  // opened with Options::filter_bits_per_key > 0.  Otherwise returns true.
+  bool KeyMayMatch(const StringPiece& key) const;
+
  private:
   struct Rep;
   Rep* rep_;
@@ -21,6 +21,8 @@ limitations under the License.
 namespace tensorflow {
 namespace table {
 
+class BlockCache;
+
 // DB contents are stored in a set of blocks, each of which holds a
 // sequence of key,value pairs.  Each block may be compressed before
 // being stored in a file.  The following enum describes which
@@ -60,6 +62,16 @@ struct Options {
   // incompressible, the kSnappyCompression implementation will
   // efficiently detect that and will switch to uncompressed mode.
   CompressionType compression = kSnappyCompression;
+
+  // If positive, TableBuilder adds a bloom filter of about this many bits per
+  // key to the table, and Table::Open() reads it, so that lookups of missing
+  // keys rarely read any data block.  10 bits per key give a false positive
+  // rate of about 1%.
+  int filter_bits_per_key = 0;
+
+  // If non-null, the uncompressed data blocks read by Table are cached in
+  // "block_cache", which must outlive the table.
+  BlockCache* block_cache = nullptr;
 };
 
 }  // namespace table
@@ -22,11 +22,13 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/block.h"
 #include "tensorflow/core/lib/io/block_builder.h"
+#include "tensorflow/core/lib/io/block_cache.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/iterator.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
@@ -224,6 +226,8 @@ class TableConstructor : public Constructor {
     // Open the table
     source_ = new StringSource(sink.contents());
     Options table_options;
+    table_options.filter_bits_per_key = options.filter_bits_per_key;
+    table_options.block_cache = options.block_cache;
     return Table::Open(table_options, source_, sink.contents().size(), &table_);
   }
 
@@ -235,6 +239,8 @@ class TableConstructor : public Constructor {
 
   uint64 BytesRead() const { return source_->BytesRead(); }
 
+  const Table* table() const { return table_; }
+
  private:
   void Reset() {
     delete table_;
@@ -621,5 +627,66 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+TEST(TableTest, BloomFilter) {
+  TableConstructor c;
+  for (int i = 0; i < 1000; i++) {
+    c.Add(strings::StrCat("key", i), "value");
+  }
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.block_size = 1024;
+  options.compression = kNoCompression;
+  options.filter_bits_per_key = 10;
+  c.Finish(options, &keys, &kvmap);
+
+  for (const string& key : keys) {
+    EXPECT_TRUE(c.table()->KeyMayMatch(key)) << key;
+  }
+  int false_positives = 0;
+  for (int i = 0; i < 1000; i++) {
+    if (c.table()->KeyMayMatch(strings::StrCat("missing", i))) {
+      false_positives++;
+    }
+  }
+  // About 1% of the missing keys match with 10 bits per key.
+  EXPECT_LT(false_positives, 50);
+}
+
+TEST(TableTest, BlockCache) {
+  TableConstructor c;
+  for (int i = 0; i < 1000; i++) {
+    c.Add(strings::StrCat("key", i), "value");
+  }
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.block_size = 1024;
+  options.compression = kNoCompression;
+  BlockCache block_cache(1 << 20);
+  options.block_cache = &block_cache;
+  c.Finish(options, &keys, &kvmap);
+
+  int num_keys = 0;
+  Iterator* iter = c.NewIterator();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    num_keys++;
+  }
+  delete iter;
+  EXPECT_EQ(1000, num_keys);
+  EXPECT_GT(block_cache.TotalSize(), 0);
+
+  // The second pass reads all of the blocks from the cache.
+  const uint64 bytes_read = c.BytesRead();
+  iter = c.NewIterator();
+  for (const string& key : keys) {
+    iter->Seek(key);
+    ASSERT_TRUE(iter->Valid());
+    EXPECT_EQ(key, iter->key());
+  }
+  delete iter;
+  EXPECT_EQ(bytes_read, c.BytesRead());
+}
+
 }  // namespace table
 }  // namespace tensorflow
@@ -0,0 +1,156 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/monitoring/prometheus_exporter.h"
+
+#include <float.h>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+namespace {
+
+// Returns "name" with the characters outside [a-zA-Z0-9_:] replaced by
+// underscores, and without leading ones.
+string PrometheusName(const string& name) {
+  string out;
+  out.reserve(name.size());
+  for (char c : name) {
+    const bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                       (c >= '0' && c <= '9') || c == '_' || c == ':';
+    if (!valid && out.empty()) continue;
+    out.push_back(valid ? c : '_');
+  }
+  if (!out.empty() && out[0] >= '0' && out[0] <= '9') out.insert(0, "_");
+  return out;
+}
+
+// Escapes "s" for use in a HELP line, or in a label value if "quotes" is set.
+string Escape(const string& s, bool quotes) {
+  string out;
+  out.reserve(s.size());
+  for (char c : s) {
+    if (c == '\\') {
+      out.append("\\\\");
+    } else if (c == '\n') {
+      out.append("\\n");
+    } else if (c == '"' && quotes) {
+      out.append("\\\"");
+    } else {
+      out.push_back(c);
+    }
+  }
+  return out;
+}
+
+// Returns the labels of "point", followed by "extra" if it is not empty, in
+// braces, or the empty string if there are none.
+string Labels(const Point& point, const string& extra) {
+  string out;
+  for (const Point::Label& label : point.labels) {
+    strings::StrAppend(&out, out.empty() ? "{" : ",",
+                       PrometheusName(label.name), "=\"",
+                       Escape(label.value, /*quotes=*/true), "\"");
+  }
+  if (!extra.empty()) strings::StrAppend(&out, out.empty() ? "{" : ",", extra);
+  if (!out.empty()) out.push_back('}');
+  return out;
+}
+
+string Number(double value) {
+  if (value >= DBL_MAX) return "+Inf";
+  if (value <= -DBL_MAX) return "-Inf";
+  return strings::StrCat(value);
+}
+
+void ExportPoint(const string& name, const Point& point, string* out) {
+  switch (point.value_type) {
+    case ValueType::kInt64:
+      strings::StrAppend(out, name, Labels(point, ""), " ", point.int64_value,
+                         "\n");
+      break;
+    case ValueType::kBool:
+      strings::StrAppend(out, name, Labels(point, ""), " ",
+                         point.bool_value ? 1 : 0, "\n");
+      break;
+    case ValueType::kHistogram: {
+      // Prometheus buckets are cumulative, unlike those of histograms.
+      const HistogramProto& histogram = point.histogram_value;
+      double count = 0;
+      for (int i = 0; i < histogram.bucket_size(); ++i) {
+        count += histogram.bucket(i);
+        const double limit = i < histogram.bucket_limit_size()
+                                 ? histogram.bucket_limit(i)
+                                 : DBL_MAX;
+        strings::StrAppend(out, name, "_bucket",
+                           Labels(point, strings::StrCat("le=\"",
+                                                         Number(limit), "\"")),
+                           " ", Number(count), "\n");
+      }
+      strings::StrAppend(out, name, "_sum", Labels(point, ""), " ",
+                         Number(histogram.sum()), "\n");
+      strings::StrAppend(out, name, "_count", Labels(point, ""), " ",
+                         Number(histogram.num()), "\n");
+      break;
+    }
+    case ValueType::kString:
+      break;
+  }
+}
+
+const char* PrometheusType(const MetricDescriptor& descriptor) {
+  switch (descriptor.value_type) {
+    case ValueType::kHistogram:
+      return "histogram";
+    case ValueType::kInt64:
+      return descriptor.metric_kind == MetricKind::kCumulative ? "counter"
+                                                               : "gauge";
+    case ValueType::kBool:
+      return "gauge";
+    case ValueType::kString:
+      return nullptr;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+string ExportPrometheusText(const CollectedMetrics& metrics) {
+  string out;
+  for (const auto& it : metrics.metric_descriptor_map) {
+    const MetricDescriptor& descriptor = *it.second;
+    const char* type = PrometheusType(descriptor);
+    if (type == nullptr) continue;
+    const string name = PrometheusName(descriptor.name);
+    strings::StrAppend(&out, "# HELP ", name, " ",
+                       Escape(descriptor.description, /*quotes=*/false), "\n");
+    strings::StrAppend(&out, "# TYPE ", name, " ", type, "\n");
+    const auto point_set = metrics.point_set_map.find(it.first);
+    if (point_set == metrics.point_set_map.end()) continue;
+    for (const auto& point : point_set->second->points) {
+      ExportPoint(name, *point, &out);
+    }
+  }
+  return out;
+}
+
+string ExportPrometheusText(const CollectionRegistry* registry) {
+  return ExportPrometheusText(*registry->CollectMetrics({}));
+}
+
+}  // namespace monitoring
+}  // namespace tensorflow
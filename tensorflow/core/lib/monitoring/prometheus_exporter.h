@@ -0,0 +1,47 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_MONITORING_PROMETHEUS_EXPORTER_H_
+#define TENSORFLOW_CORE_LIB_MONITORING_PROMETHEUS_EXPORTER_H_
+
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+// Formats "metrics" in the Prometheus text exposition format, which
+// monitoring systems scrape over HTTP.
+//
+// Metric names become Prometheus names by replacing the characters that
+// Prometheus does not allow with underscores, e.g.
+// "/tensorflow/core/bfc_allocator/bytes_in_use" becomes
+// "tensorflow_core_bfc_allocator_bytes_in_use". Cumulative int64 metrics
+// are exported as counters, other int64 and bool metrics as gauges and
+// histograms as histograms. String metrics have no Prometheus equivalent and
+// are skipped.
+//
+// The descriptors of the metrics must have been collected.
+string ExportPrometheusText(const CollectedMetrics& metrics);
+
+// Collects the metrics of "registry" and formats them as above.
+string ExportPrometheusText(
+    const CollectionRegistry* registry = CollectionRegistry::Default());
+
+}  // namespace monitoring
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_MONITORING_PROMETHEUS_EXPORTER_H_
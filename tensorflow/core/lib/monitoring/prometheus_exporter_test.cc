@@ -0,0 +1,83 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/monitoring/prometheus_exporter.h"
+
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace monitoring {
+namespace {
+
+auto* counter = Counter<1>::New("/tensorflow/test/prometheus/counter",
+                                "A \\ counter.\nWith two lines.", "label");
+
+auto* gauge = Gauge<int64, 0>::New("/tensorflow/test/prometheus/gauge",
+                                   "A gauge.");
+
+auto* string_gauge = Gauge<string, 0>::New(
+    "/tensorflow/test/prometheus/string_gauge", "A string gauge.");
+
+auto* sampler =
+    Sampler<0>::New({"/tensorflow/test/prometheus/sampler", "A sampler."},
+                    Buckets::Explicit({10.0, 20.0}));
+
+void ExpectContains(const string& text, const string& line) {
+  EXPECT_TRUE(str_util::StrContains(text, line))
+      << "Expected \"" << line << "\" in:\n"
+      << text;
+}
+
+TEST(PrometheusExporterTest, Export) {
+  counter->GetCell("a\"b")->IncrementBy(3);
+  gauge->GetCell()->Set(-7);
+  string_gauge->GetCell()->Set("value");
+  sampler->GetCell()->Add(5.0);
+  sampler->GetCell()->Add(15.0);
+  sampler->GetCell()->Add(100.0);
+
+  const string text = ExportPrometheusText();
+  ExpectContains(text,
+                 "# HELP tensorflow_test_prometheus_counter A \\\\ counter."
+                 "\\nWith two lines.\n");
+  ExpectContains(text, "# TYPE tensorflow_test_prometheus_counter counter\n");
+  ExpectContains(text,
+                 "tensorflow_test_prometheus_counter{label=\"a\\\"b\"} 3\n");
+
+  ExpectContains(text, "# TYPE tensorflow_test_prometheus_gauge gauge\n");
+  ExpectContains(text, "tensorflow_test_prometheus_gauge -7\n");
+
+  EXPECT_FALSE(
+      str_util::StrContains(text, "tensorflow_test_prometheus_string_gauge"));
+
+  ExpectContains(text,
+                 "# TYPE tensorflow_test_prometheus_sampler histogram\n");
+  ExpectContains(text,
+                 "tensorflow_test_prometheus_sampler_bucket{le=\"10\"} 1\n");
+  ExpectContains(text,
+                 "tensorflow_test_prometheus_sampler_bucket{le=\"20\"} 2\n");
+  ExpectContains(text,
+                 "tensorflow_test_prometheus_sampler_bucket{le=\"+Inf\"} 3\n");
+  ExpectContains(text, "tensorflow_test_prometheus_sampler_sum 120\n");
+  ExpectContains(text, "tensorflow_test_prometheus_sampler_count 3\n");
+}
+
+}  // namespace
+}  // namespace monitoring
+}  // namespace tensorflow
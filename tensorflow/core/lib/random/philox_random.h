@@ -183,6 +183,53 @@ class PhiloxRandom {
     return counter;
   }
 
+  // Number of counters FillBatch processes at once.
+  static const int kBatchSize = 8;
+
+  // Writes the results of the next num_groups invocations of operator() to
+  // output, as 4 * num_groups consecutive values, and advances the generator
+  // past them. Counters are processed kBatchSize at a time in
+  // structure-of-arrays form, so that the rounds compile to SIMD code on CPU.
+  void FillBatch(uint32* output, int64 num_groups) {
+    for (; num_groups >= kBatchSize; num_groups -= kBatchSize) {
+      uint32 c0[kBatchSize], c1[kBatchSize], c2[kBatchSize], c3[kBatchSize];
+      for (int i = 0; i < kBatchSize; ++i) {
+        c0[i] = counter_[0];
+        c1[i] = counter_[1];
+        c2[i] = counter_[2];
+        c3[i] = counter_[3];
+        SkipOne();
+      }
+      Key key = key_;
+      for (int round = 0; round < 10; ++round) {
+        // Same as ComputeSingleRound, on all counters.
+        for (int i = 0; i < kBatchSize; ++i) {
+          const uint64 product0 = static_cast<uint64>(kPhiloxM4x32A) * c0[i];
+          const uint64 product1 = static_cast<uint64>(kPhiloxM4x32B) * c2[i];
+          c0[i] = static_cast<uint32>(product1 >> 32) ^ c1[i] ^ key[0];
+          c1[i] = static_cast<uint32>(product1);
+          c2[i] = static_cast<uint32>(product0 >> 32) ^ c3[i] ^ key[1];
+          c3[i] = static_cast<uint32>(product0);
+        }
+        RaiseKey(&key);
+      }
+      for (int i = 0; i < kBatchSize; ++i) {
+        output[4 * i] = c0[i];
+        output[4 * i + 1] = c1[i];
+        output[4 * i + 2] = c2[i];
+        output[4 * i + 3] = c3[i];
+      }
+      output += 4 * kBatchSize;
+    }
+    for (; num_groups > 0; --num_groups) {
+      const ResultType sample = (*this)();
+      for (int i = 0; i < kResultElementCount; ++i) {
+        output[i] = sample[i];
+      }
+      output += kResultElementCount;
+    }
+  }
+
  private:
   // We use the same constants as recommended by the original paper.
   static const uint32 kPhiloxW32A = 0x9E3779B9;
@@ -68,6 +68,32 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that FillBatch produces the same samples as calling the
+// generator once per group, including for counts that are not a multiple of
+// the batch size.
+TEST(PhiloxRandomTest, FillBatchMatchTest) {
+  constexpr int num_groups = 4 * PhiloxRandom::kBatchSize + 3;
+  constexpr int count = num_groups * PhiloxRandom::kResultElementCount;
+
+  uint64 test_seed = GetTestSeed();
+  std::vector<uint32> v1(count + 4);
+  {
+    PhiloxRandom gen(test_seed);
+    gen.FillBatch(&v1[0], num_groups);
+    FillRandoms<TrivialPhiloxDistribution>(gen, &v1[count], 4);
+  }
+
+  std::vector<uint32> v2(count + 4);
+  {
+    PhiloxRandom gen(test_seed);
+    FillRandoms<TrivialPhiloxDistribution>(gen, &v2[0], v2.size());
+  }
+
+  for (int i = 0; i < count + 4; ++i) {
+    ASSERT_EQ(v1[i], v2[i]);
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
@@ -29,6 +29,7 @@ REGISTER_OP("Batch")
     .Attr("max_enqueued_batches: int = 10")
     .Attr("batch_timeout_micros: int")
     .Attr("allowed_batch_sizes: list(int) = []")
+    .Attr("bucket_boundaries: list(int) = []")
     .Attr("grad_timeout_micros: int")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
@@ -37,10 +38,19 @@ REGISTER_OP("Batch")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       std::vector<shape_inference::ShapeHandle> in_shapes;
       TF_RETURN_IF_ERROR(c->input("in_tensors", &in_shapes));
+      std::vector<int32> bucket_boundaries;
+      TF_RETURN_IF_ERROR(c->GetAttr("bucket_boundaries", &bucket_boundaries));
       std::vector<shape_inference::ShapeHandle> out_shapes(in_shapes.size());
       for (int i = 0; i < in_shapes.size(); ++i) {
         TF_RETURN_IF_ERROR(
             c->ReplaceDim(in_shapes[i], 0, c->UnknownDim(), &out_shapes[i]));
+        if (!bucket_boundaries.empty()) {
+          // Inputs are padded along the sequence dimension.
+          TF_RETURN_IF_ERROR(c->WithRankAtLeast(out_shapes[i], 2,
+                                                &out_shapes[i]));
+          TF_RETURN_IF_ERROR(c->ReplaceDim(out_shapes[i], 1, c->UnknownDim(),
+                                           &out_shapes[i]));
+        }
       }
       TF_RETURN_IF_ERROR(c->set_output("batched_tensors", out_shapes));
       TF_RETURN_IF_ERROR(c->set_output("id", {c->Scalar()}));
@@ -441,6 +441,32 @@ REGISTER_OP("Minimum")
     .SetIsCommutative()
     .SetShapeFn(shape_inference::BroadcastBinaryOpShapeFn);
 
+REGISTER_OP("_FusedElementwise")
+    .Input("inputs: N * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("N: int >= 1")
+    .Attr("ops: list(string)")
+    .Attr("operands: list(int)")
+    .SetShapeFn([](InferenceContext* c) {
+      c->set_output(0, c->input(0));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Computes a chain of elementwise ops in a single pass over memory.
+
+Created by the grappler Remapper from chains of unary and binary
+elementwise ops, such as Add, Mul and Tanh. Op i of the chain is `ops[i]`,
+applied to the operands `operands[2 * i]` and `operands[2 * i + 1]` (-1 for
+the second operand of unary ops). An operand j < N refers to `inputs[j]`, and
+an operand N + k to the result of op k. The result of the last op is the
+output.
+
+inputs: The inputs of the chain. `inputs[0]` has the shape of the output, and
+  every other input has the same number of elements, a single element, or is
+  a vector broadcast along the innermost dimension.
+)doc");
+
 REGISTER_OP("Mod")
     .Input("x: T")
     .Input("y: T")
@@ -716,6 +742,33 @@ REGISTER_OP("MatMul")
     .Attr("T: {bfloat16, half, float, double, int32, complex64, complex128}")
     .SetShapeFn(shape_inference::MatMulShape);
 
+REGISTER_OP("_FusedMatMul")
+    .Input("a: T")
+    .Input("b: T")
+    .Input("bias: T")
+    .Output("product: T")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("T: {half, float, double}")
+    .Attr("activation: {'Identity', 'Relu', 'Relu6'} = 'Identity'")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::MatMulShape(c));
+      ShapeHandle bias;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &bias));
+      DimensionHandle unused;
+      return c->Merge(c->Dim(c->output(0), 1), c->Dim(bias, 0), &unused);
+    })
+    .Doc(R"doc(
+Computes `activation(matmul(a, b) + bias)`.
+
+Created by the grappler Remapper from MatMul followed by BiasAdd and an
+optional Relu or Relu6. The bias and activation are applied to the product
+in the same kernel, without materializing the intermediate results.
+
+bias: A vector with one element per column of the product.
+activation: The activation applied after adding the bias.
+)doc");
+
 REGISTER_OP("SparseMatMul")
     .Input("a: Ta")
     .Input("b: Tb")
@@ -1423,6 +1476,35 @@ REGISTER_OP("QuantizedMatMul")
       return Status::OK();
     });
 
+REGISTER_OP("QuantizedMatMulWithRequantize")
+    .Input("a: T1")
+    .Input("b: T2")
+    .Input("min_a: float")
+    .Input("max_a: float")
+    .Input("min_b: float")
+    .Input("max_b: float")
+    .Input("requested_output_min: float")
+    .Input("requested_output_max: float")
+    .Output("out: out_type")
+    .Output("min_out: float")
+    .Output("max_out: float")
+    .Attr("T1: quantizedtype")
+    .Attr("T2: quantizedtype")
+    .Attr("out_type: quantizedtype = DT_QUINT8")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("activation: {'None', 'Relu', 'Relu6'} = 'None'")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::MatMulShape(c));
+      ShapeHandle unused;
+      for (int i = 2; i < 8; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      c->set_output(1, c->Scalar());
+      c->set_output(2, c->Scalar());
+      return Status::OK();
+    });
+
 REGISTER_OP("QuantizedMul")
     .Input("x: T1")
     .Input("y: T2")
@@ -274,6 +274,34 @@ REGISTER_OP("Conv2D")
     .Attr("dilations: list(int) = [1, 1, 1, 1]")
     .SetShapeFn(shape_inference::Conv2DShape);
 
+REGISTER_OP("_FusedConv2D")
+    .Input("input: T")
+    .Input("filter: T")
+    .Input("bias: T")
+    .Output("output: T")
+    .Attr("T: {half, float, double}")
+    .Attr("strides: list(int)")
+    .Attr("use_cudnn_on_gpu: bool = true")
+    .Attr(GetPaddingAttrString())
+    .Attr(GetConvnetDataFormatAttrString())
+    .Attr("dilations: list(int) = [1, 1, 1, 1]")
+    .Attr("activation: {'Identity', 'Relu', 'Relu6'} = 'Identity'")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::Conv2DShape(c));
+      ShapeHandle bias;
+      return c->WithRank(c->input(2), 1, &bias);
+    })
+    .Doc(R"doc(
+Computes `activation(BiasAdd(Conv2D(input, filter), bias))`.
+
+Created by the grappler Remapper from a Conv2D followed by a BiasAdd and an
+optional Relu or Relu6. The bias and activation are applied in a single pass
+over the convolution's output.
+
+bias: 1-D with the size of the output depth.
+activation: The activation applied after adding the bias.
+)doc");
+
 REGISTER_OP("Conv2DBackpropInput")
     .Input("input_sizes: int32")
     .Input("filter: T")
@@ -139,6 +139,33 @@ REGISTER_OP("StringStrip")
     .Output("output: string")
     .SetShapeFn(shape_inference::UnchangedShape);
 
+REGISTER_OP("StringLower")
+    .Input("input: string")
+    .Output("output: string")
+    .SetShapeFn(shape_inference::UnchangedShape);
+
+REGISTER_OP("StringNGrams")
+    .Input("data: string")
+    .Input("data_splits: Tsplits")
+    .Output("ngrams: string")
+    .Output("ngrams_splits: Tsplits")
+    .Attr("ngram_widths: list(int) >= 1")
+    .Attr("separator: string = ' '")
+    .Attr("left_pad: string = ''")
+    .Attr("right_pad: string = ''")
+    .Attr("pad_width: int = 0")
+    .Attr("preserve_short_sequences: bool = false")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &unused));
+      ShapeHandle splits;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &splits));
+      c->set_output(0, c->Vector(InferenceContext::kUnknownDim));
+      c->set_output(1, splits);
+      return Status::OK();
+    });
+
 REGISTER_OP("EncodeBase64")
     .Input("input: string")
     .Output("output: string")
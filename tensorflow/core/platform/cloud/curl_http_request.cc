@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <vector>
 
 #include "tensorflow/core/platform/cloud/curl_http_request.h"
 
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/version.h"
 
@@ -34,6 +36,9 @@ namespace {
 // Set to 1 to enable verbose debug output from curl.
 constexpr uint64 kVerboseOutput = 0;
 
+// The maximum number of idle curl handles kept for reuse.
+constexpr size_t kMaxIdleCurlHandles = 16;
+
 // Proxy to the real libcurl implementation.
 class LibCurlProxy : public LibCurl {
  public:
@@ -45,7 +50,17 @@ class LibCurlProxy : public LibCurl {
     return libcurl;
   }
 
-  CURL* curl_easy_init() override { return ::curl_easy_init(); }
+  CURL* curl_easy_init() override {
+    {
+      mutex_lock l(mu_);
+      if (!idle_handles_.empty()) {
+        CURL* curl = idle_handles_.back();
+        idle_handles_.pop_back();
+        return curl;
+      }
+    }
+    return ::curl_easy_init();
+  }
 
   CURLcode curl_easy_setopt(CURL* curl, CURLoption option,
                             uint64 param) override {
@@ -95,8 +110,18 @@ class LibCurlProxy : public LibCurl {
     return ::curl_easy_getinfo(curl, info, value);
   }
 
+  // Handles are reset and kept rather than cleaned up, so that the next
+  // request reuses their open connections and DNS and TLS session caches.
   void curl_easy_cleanup(CURL* curl) override {
-    return ::curl_easy_cleanup(curl);
+    ::curl_easy_reset(curl);
+    {
+      mutex_lock l(mu_);
+      if (idle_handles_.size() < kMaxIdleCurlHandles) {
+        idle_handles_.push_back(curl);
+        return;
+      }
+    }
+    ::curl_easy_cleanup(curl);
   }
 
   char* curl_easy_escape(CURL* curl, const char* str, int length) override {
@@ -112,6 +137,10 @@ class LibCurlProxy : public LibCurl {
   }
 
   void curl_free(void* p) override { ::curl_free(p); }
+
+ private:
+  mutex mu_;
+  std::vector<CURL*> idle_handles_ GUARDED_BY(mu_);
 };
 }  // namespace
 
@@ -48,6 +48,14 @@ class FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// Counts of the block lookups made by reads, and of the blocks evicted to
+  /// stay within max_bytes().
+  struct Stats {
+    uint64 hits = 0;
+    uint64 misses = 0;
+    uint64 evictions = 0;
+  };
+
   virtual ~FileBlockCache() {}
 
   /// Read `n` bytes from `filename` starting at `offset` into `out`. This
@@ -88,6 +96,9 @@ class FileBlockCache {
   /// The current size (in bytes) of the cache.
   virtual size_t CacheSize() const = 0;
 
+  /// The counts of block lookups and evictions since the cache was created.
+  virtual Stats GetStats() const { return Stats(); }
+
   // Returns true if the cache is enabled. If false, the BlockFetcher callback
   // is always executed during Read.
   virtual bool IsCacheEnabled() const = 0;
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -38,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/google_auth_provider.h"
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 #include "tensorflow/core/platform/cloud/retrying_utils.h"
+#include "tensorflow/core/platform/cloud/shared_file_block_cache.h"
 #include "tensorflow/core/platform/cloud/time_util.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -77,6 +79,20 @@ constexpr size_t kDefaultMaxCacheSize = 2 * kDefaultBlockSize;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the number of blocks fetched in parallel
+// ahead of sequential reads, and so the number of block reads of a file kept
+// in flight. A value of 0 (the default) disables read-ahead.
+constexpr char kReadaheadBlocks[] = "GCS_READ_CACHE_READAHEAD_BLOCKS";
+// The environment variable that enables uploading files in parts while they
+// are written, and sets the size of the parts in MB. A value of 0 (the default)
+// means files are uploaded in one request when they are synced.
+constexpr char kCompositeUploadChunkSize[] =
+    "GCS_WRITE_COMPOSITE_UPLOAD_CHUNK_SIZE_MB";
+// The environment variable that overrides the number of parts of each file
+// uploaded in parallel, when uploading files in parts.
+constexpr char kCompositeUploadParallelism[] =
+    "GCS_WRITE_COMPOSITE_UPLOAD_PARALLELISM";
+constexpr int kDefaultCompositeUploadParallelism = 4;
 // The environment variable that overrides the maximum age of entries in the
 // Stat cache. A value of 0 (the default) means nothing is cached.
 constexpr char kStatCacheMaxAge[] = "GCS_STAT_CACHE_MAX_AGE";
@@ -585,6 +601,266 @@ class GcsWritableFile : public WritableFile {
   int64 initial_retry_delay_usec_;
 };
 
+/// \brief GCS-based implementation of a writable file that uploads its
+/// contents in parts while they are written.
+///
+/// Every `chunk_size` bytes appended are uploaded as a separate part object in
+/// the background, with at most `max_pending_parts` uploads of the file in
+/// flight, which bounds the bytes buffered in memory. Sync() uploads the rest
+/// of the contents as the last part and composes the parts, after the contents
+/// synced earlier, into the object, then deletes them. A file that is synced
+/// before a whole part is written is uploaded with a single request.
+class GcsCompositeWritableFile : public WritableFile {
+ public:
+  GcsCompositeWritableFile(const string& bucket, const string& object,
+                           GcsFileSystem* filesystem,
+                           GcsFileSystem::TimeoutConfig* timeouts,
+                           std::function<void()> file_cache_erase,
+                           int64 initial_retry_delay_usec, size_t chunk_size,
+                           int max_pending_parts, thread::ThreadPool* pool)
+      : bucket_(bucket),
+        object_(object),
+        filesystem_(filesystem),
+        timeouts_(timeouts),
+        file_cache_erase_(std::move(file_cache_erase)),
+        initial_retry_delay_usec_(initial_retry_delay_usec),
+        chunk_size_(chunk_size),
+        max_pending_parts_(max_pending_parts),
+        pool_(pool) {}
+
+  ~GcsCompositeWritableFile() override {
+    Close().IgnoreError();
+    // The uploads in flight refer to this file.
+    WaitForUploads().IgnoreError();
+  }
+
+  Status Append(const StringPiece& data) override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    sync_needed_ = true;
+    StringPiece remaining = data;
+    while (!remaining.empty()) {
+      const size_t n =
+          std::min(remaining.size(), chunk_size_ - buffer_.size());
+      buffer_.append(remaining.data(), n);
+      remaining.remove_prefix(n);
+      if (buffer_.size() == chunk_size_) {
+        TF_RETURN_IF_ERROR(StartPartUpload());
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    if (!closed_) {
+      TF_RETURN_IF_ERROR(Sync());
+      closed_ = true;
+    }
+    return Status::OK();
+  }
+
+  Status Flush() override { return Sync(); }
+
+  Status Sync() override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    if (!sync_needed_) {
+      return Status::OK();
+    }
+    if (parts_.empty() && !composed_) {
+      // Nothing was uploaded yet, so the contents are uploaded as the object.
+      TF_RETURN_IF_ERROR(UploadObject(object_, buffer_, &generation_));
+      buffer_.clear();
+      composed_ = true;
+    } else {
+      if (!buffer_.empty()) {
+        TF_RETURN_IF_ERROR(StartPartUpload());
+      }
+      TF_RETURN_IF_ERROR(WaitForUploads());
+      TF_RETURN_IF_ERROR(ComposeParts());
+    }
+    // Erase the file from the file cache on every successful write.
+    file_cache_erase_();
+    sync_needed_ = false;
+    return Status::OK();
+  }
+
+ private:
+  // The maximum number of source objects of a compose request.
+  static constexpr size_t kMaxComposeSources = 32;
+
+  Status CheckWritable() const {
+    if (closed_) {
+      return errors::FailedPrecondition("The file ", GetGcsPath(),
+                                        " is closed.");
+    }
+    return Status::OK();
+  }
+
+  /// Schedules the upload of the buffered contents as the next part, once
+  /// fewer than max_pending_parts_ part uploads are in flight.
+  Status StartPartUpload() {
+    {
+      mutex_lock l(mu_);
+      while (pending_uploads_ >= max_pending_parts_) {
+        cond_var_.wait(l);
+      }
+      // A part that failed to upload can't be recovered, as its contents are
+      // gone.
+      TF_RETURN_IF_ERROR(upload_status_);
+      ++pending_uploads_;
+    }
+    // The part name includes a checksum of its contents, so that a part of
+    // this file can only collide with an identical part of another upload.
+    const string part = strings::StrCat(
+        object_, ".part-", next_part_++, "-",
+        strings::Hex(crc32c::Value(buffer_.data(), buffer_.size())));
+    parts_.push_back(part);
+    auto data = std::make_shared<string>();
+    data->swap(buffer_);
+    pool_->Schedule([this, part, data]() {
+      int64 generation;
+      const Status status = UploadObject(part, *data, &generation);
+      mutex_lock l(mu_);
+      upload_status_.Update(status);
+      --pending_uploads_;
+      cond_var_.notify_all();
+    });
+    return Status::OK();
+  }
+
+  /// Waits for the part uploads in flight and returns the first error among
+  /// all part uploads of the file.
+  Status WaitForUploads() {
+    mutex_lock l(mu_);
+    while (pending_uploads_ > 0) {
+      cond_var_.wait(l);
+    }
+    return upload_status_;
+  }
+
+  /// Uploads `data` as the object `name` with a single request, and returns
+  /// its generation.
+  Status UploadObject(const string& name, const string& data,
+                      int64* generation) {
+    return RetryingUtils::CallWithRetries(
+        [this, &name, &data, generation]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket_,
+                                          "/o?uploadType=media&name=",
+                                          request->EscapeString(name)));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->write);
+          if (data.empty()) {
+            request->SetPostEmptyBody();
+          } else {
+            request->SetPostFromBuffer(data.data(), data.size());
+          }
+          std::vector<char> output_buffer;
+          request->SetResultBuffer(&output_buffer);
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading ",
+                                          "gs://", bucket_, "/", name);
+          Json::Value root;
+          TF_RETURN_IF_ERROR(ParseJson(output_buffer, &root));
+          return GetInt64Value(root, "generation", generation);
+        },
+        initial_retry_delay_usec_);
+  }
+
+  /// Composes the uploaded parts into the object, kMaxComposeSources sources
+  /// at a time, and deletes them.
+  Status ComposeParts() {
+    while (!parts_.empty()) {
+      Json::Value sources(Json::arrayValue);
+      Json::Value source;
+      if (composed_) {
+        source["name"] = object_;
+        sources.append(source);
+      }
+      const size_t num_parts =
+          std::min(parts_.size(), kMaxComposeSources - sources.size());
+      for (size_t i = 0; i < num_parts; ++i) {
+        source.clear();
+        source["name"] = parts_[i];
+        sources.append(source);
+      }
+      Json::Value body;
+      body["sourceObjects"] = sources;
+      const string body_string = Json::FastWriter().write(body);
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [this, &body_string]() {
+            std::unique_ptr<HttpRequest> request;
+            TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+            string uri = strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                         request->EscapeString(object_),
+                                         "/compose");
+            if (composed_) {
+              // A retried request must not append the parts twice.
+              strings::StrAppend(&uri, "?ifGenerationMatch=", generation_);
+            }
+            request->SetUri(uri);
+            request->AddHeader("Content-Type", "application/json");
+            request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                                 timeouts_->metadata);
+            request->SetPostFromBuffer(body_string.data(), body_string.size());
+            std::vector<char> output_buffer;
+            request->SetResultBuffer(&output_buffer);
+            TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when composing ",
+                                            GetGcsPath());
+            Json::Value root;
+            TF_RETURN_IF_ERROR(ParseJson(output_buffer, &root));
+            return GetInt64Value(root, "generation", &generation_);
+          },
+          initial_retry_delay_usec_));
+      composed_ = true;
+      for (size_t i = 0; i < num_parts; ++i) {
+        const string part_path =
+            strings::StrCat("gs://", bucket_, "/", parts_[i]);
+        const Status status = RetryingUtils::DeleteWithRetries(
+            [this, &part_path]() { return filesystem_->DeleteFile(part_path); },
+            initial_retry_delay_usec_);
+        if (!status.ok()) {
+          LOG(WARNING) << "Could not delete " << part_path
+                       << " composed into " << GetGcsPath() << ": " << status;
+        }
+      }
+      parts_.erase(parts_.begin(), parts_.begin() + num_parts);
+    }
+    return Status::OK();
+  }
+
+  string GetGcsPath() const {
+    return strings::StrCat("gs://", bucket_, "/", object_);
+  }
+
+  const string bucket_;
+  const string object_;
+  GcsFileSystem* const filesystem_;  // Not owned.
+  GcsFileSystem::TimeoutConfig* timeouts_;
+  std::function<void()> file_cache_erase_;
+  const int64 initial_retry_delay_usec_;
+  const size_t chunk_size_;
+  const int max_pending_parts_;
+  thread::ThreadPool* const pool_;  // Not owned.
+
+  // The contents appended since the last part was started.
+  string buffer_;
+  // The names of the parts not yet composed into the object, in order.
+  std::vector<string> parts_;
+  int64 next_part_ = 0;
+  // Whether the object holds the contents synced so far, and its generation.
+  bool composed_ = false;
+  int64 generation_ = 0;
+  bool sync_needed_ = true;
+  bool closed_ = false;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  int pending_uploads_ GUARDED_BY(mu_) = 0;
+  Status upload_status_ GUARDED_BY(mu_);
+};
+
+constexpr size_t GcsCompositeWritableFile::kMaxComposeSources;
+
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
  public:
   GcsReadOnlyMemoryRegion(std::unique_ptr<char[]> data, uint64 length)
@@ -638,7 +914,25 @@ GcsFileSystem::GcsFileSystem()
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+  if (GetEnvVar(kReadaheadBlocks, strings::safe_strtou64, &value)) {
+    readahead_blocks_ = value;
+  }
   file_block_cache_ = MakeFileBlockCache(block_size, max_bytes, max_staleness);
+  // Apply the overrides for composite uploads, if provided.
+  if (GetEnvVar(kCompositeUploadChunkSize, strings::safe_strtou64, &value)) {
+    composite_upload_chunk_size_ = value * 1024 * 1024;
+  }
+  composite_upload_parallelism_ = kDefaultCompositeUploadParallelism;
+  uint32 parallelism;
+  if (GetEnvVar(kCompositeUploadParallelism, strings::safe_strtou32,
+                &parallelism) &&
+      parallelism > 0) {
+    composite_upload_parallelism_ = parallelism;
+  }
+  if (composite_upload_chunk_size_ > 0) {
+    composite_upload_pool_.reset(new thread::ThreadPool(
+        Env::Default(), "gcs_composite_upload", composite_upload_parallelism_));
+  }
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
   size_t stat_cache_max_entries = kStatCacheDefaultMaxEntries;
@@ -754,7 +1048,8 @@ GcsFileSystem::GcsFileSystem(
     uint64 matching_paths_cache_max_age,
     size_t matching_paths_cache_max_entries, int64 initial_retry_delay_usec,
     TimeoutConfig timeouts,
-    std::pair<const string, const string>* additional_header)
+    std::pair<const string, const string>* additional_header,
+    size_t composite_upload_chunk_size, int composite_upload_parallelism)
     : auth_provider_(std::move(auth_provider)),
       http_request_factory_(std::move(http_request_factory)),
       file_block_cache_(
@@ -764,7 +1059,14 @@ GcsFileSystem::GcsFileSystem(
           matching_paths_cache_max_age, matching_paths_cache_max_entries)),
       timeouts_(timeouts),
       initial_retry_delay_usec_(initial_retry_delay_usec),
-      additional_header_(additional_header) {}
+      additional_header_(additional_header),
+      composite_upload_chunk_size_(composite_upload_chunk_size),
+      composite_upload_parallelism_(composite_upload_parallelism) {
+  if (composite_upload_chunk_size_ > 0) {
+    composite_upload_pool_.reset(new thread::ThreadPool(
+        Env::Default(), "gcs_composite_upload", composite_upload_parallelism_));
+  }
+}
 
 Status GcsFileSystem::NewRandomAccessFile(
     const string& fname, std::unique_ptr<RandomAccessFile>* result) {
@@ -817,13 +1119,23 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
+  if (SharedFileBlockCache::IsEnabled()) {
+    // The process-wide cache takes the place of the cache of this filesystem.
+    return std::unique_ptr<FileBlockCache>(new SharedFileBlockCache(
+        [this](const string& filename, size_t offset, size_t n, char* buffer,
+               size_t* bytes_transferred) {
+          return LoadBufferFromGCS(filename, offset, n, buffer,
+                                   bytes_transferred);
+        }));
+  }
   std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
       block_size, max_bytes, max_staleness,
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), readahead_blocks_));
   return file_block_cache;
 }
 
@@ -893,6 +1205,14 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
                                       std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
+  if (composite_upload_chunk_size_ > 0) {
+    result->reset(new GcsCompositeWritableFile(
+        bucket, object, this, &timeouts_,
+        [this, fname]() { ClearFileCaches(fname); }, initial_retry_delay_usec_,
+        composite_upload_chunk_size_, composite_upload_parallelism_,
+        composite_upload_pool_.get()));
+    return Status::OK();
+  }
   result->reset(new GcsWritableFile(bucket, object, this, &timeouts_,
                                     [this, fname]() { ClearFileCaches(fname); },
                                     initial_retry_delay_usec_));
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cloud/auth_provider.h"
 #include "tensorflow/core/platform/cloud/expiring_lru_cache.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
@@ -88,7 +89,9 @@ class GcsFileSystem : public FileSystem {
                 uint64 matching_paths_cache_max_age,
                 size_t matching_paths_cache_max_entries,
                 int64 initial_retry_delay_usec, TimeoutConfig timeouts,
-                std::pair<const string, const string>* additional_header);
+                std::pair<const string, const string>* additional_header,
+                size_t composite_upload_chunk_size = 0,
+                int composite_upload_parallelism = 1);
 
   Status NewRandomAccessFile(
       const string& filename,
@@ -276,6 +279,8 @@ class GcsFileSystem : public FileSystem {
   mutex mu_;
   std::unique_ptr<AuthProvider> auth_provider_ GUARDED_BY(mu_);
   std::unique_ptr<HttpRequest::Factory> http_request_factory_;
+  // The number of blocks the block cache fetches ahead of sequential reads.
+  size_t readahead_blocks_ = 0;
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -300,6 +305,13 @@ class GcsFileSystem : public FileSystem {
   // Additional header material to be transmitted with all GCS requests
   std::unique_ptr<std::pair<const string, const string>> additional_header_;
 
+  // If positive, files opened with NewWritableFile are uploaded in parts of
+  // this size while they are written, `composite_upload_parallelism_` parts of
+  // each file at a time, on `composite_upload_pool_`.
+  size_t composite_upload_chunk_size_ = 0;
+  int composite_upload_parallelism_ = 1;
+  std::unique_ptr<thread::ThreadPool> composite_upload_pool_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GcsFileSystem);
 };
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/gcs_file_system.h"
 #include <fstream>
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/cloud/http_request_fake.h"
 #include "tensorflow/core/platform/test.h"
@@ -510,6 +511,118 @@ TEST(GcsFileSystemTest, NewWritableFile) {
   TF_EXPECT_OK(wfile->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_CompositeUpload) {
+  // The name of the part `index` of gs://bucket/path/writeable with the given
+  // contents, escaped.
+  auto part = [](int index, StringPiece contents) {
+    return strings::StrCat(
+        "path%2Fwriteable.part-", index, "-",
+        strings::Hex(crc32c::Value(contents.data(), contents.size())));
+  };
+  auto upload = [](const string& name, const string& contents) {
+    return new FakeHttpRequest(
+        strings::StrCat("Uri: https://www.googleapis.com/upload/storage/v1/b/"
+                        "bucket/o?uploadType=media&name=",
+                        name,
+                        "\n"
+                        "Auth Token: fake_token\n"
+                        "Timeouts: 5 1 30\n"
+                        "Post body: ",
+                        contents, "\n"),
+        "{\"generation\": \"1\"}");
+  };
+  auto remove = [](const string& name) {
+    return new FakeHttpRequest(
+        strings::StrCat("Uri: https://www.googleapis.com/storage/v1/b/bucket/"
+                        "o/",
+                        name,
+                        "\n"
+                        "Auth Token: fake_token\n"
+                        "Timeouts: 5 1 10\n"
+                        "Delete: yes\n"),
+        "");
+  };
+  auto source = [](const string& name) {
+    return strings::StrCat(
+        "{\"name\":\"", str_util::StringReplace(name, "%2F", "/", true),
+        "\"}");
+  };
+  std::vector<HttpRequest*> requests(
+      {upload(part(0, "content1"), "content1"),
+       upload(part(1, ",content"), ",content"), upload(part(2, "2"), "2"),
+       new FakeHttpRequest(
+           strings::StrCat(
+               "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+               "path%2Fwriteable/compose\n"
+               "Auth Token: fake_token\n"
+               "Header Content-Type: application/json\n"
+               "Timeouts: 5 1 10\n"
+               "Post body: {\"sourceObjects\":[",
+               source(part(0, "content1")), ",", source(part(1, ",content")),
+               ",", source(part(2, "2")), "]}\n\n"),
+           "{\"generation\": \"2\"}"),
+       remove(part(0, "content1")), remove(part(1, ",content")),
+       remove(part(2, "2")), upload(part(3, "3"), "3"),
+       new FakeHttpRequest(
+           strings::StrCat(
+               "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+               "path%2Fwriteable/compose?ifGenerationMatch=2\n"
+               "Auth Token: fake_token\n"
+               "Header Content-Type: application/json\n"
+               "Timeouts: 5 1 10\n"
+               "Post body: {\"sourceObjects\":[",
+               source("path/writeable"), ",", source(part(3, "3")), "]}\n\n"),
+           "{\"generation\": \"3\"}"),
+       remove(part(3, "3"))});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      0 /* block size */, 0 /* max bytes */, 0 /* max staleness */,
+      0 /* stat cache max age */, 0 /* stat cache max entries */,
+      0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, 0 /* initial retry delay */,
+      kTestTimeoutConfig, nullptr /* gcs additional header */,
+      8 /* composite upload chunk size */,
+      1 /* composite upload parallelism */);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/path/writeable", &wfile));
+  TF_EXPECT_OK(wfile->Append("content1,"));
+  TF_EXPECT_OK(wfile->Append("content2"));
+  TF_EXPECT_OK(wfile->Sync());
+  // Contents appended after a sync are composed after the synced contents.
+  TF_EXPECT_OK(wfile->Append("3"));
+  TF_EXPECT_OK(wfile->Close());
+}
+
+TEST(GcsFileSystemTest, NewWritableFile_CompositeUploadOfSmallFile) {
+  // A file smaller than a part is uploaded with a single request.
+  std::vector<HttpRequest*> requests({new FakeHttpRequest(
+      "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+      "uploadType=media&name=path%2Fwriteable\n"
+      "Auth Token: fake_token\n"
+      "Timeouts: 5 1 30\n"
+      "Post body: content\n",
+      "{\"generation\": \"1\"}")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      0 /* block size */, 0 /* max bytes */, 0 /* max staleness */,
+      0 /* stat cache max age */, 0 /* stat cache max entries */,
+      0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, 0 /* initial retry delay */,
+      kTestTimeoutConfig, nullptr /* gcs additional header */,
+      8 /* composite upload chunk size */,
+      1 /* composite upload parallelism */);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/path/writeable", &wfile));
+  TF_EXPECT_OK(wfile->Append("content"));
+  TF_EXPECT_OK(wfile->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
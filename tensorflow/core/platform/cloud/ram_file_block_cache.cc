@@ -14,13 +14,36 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
+namespace {
+
+auto* block_cache_lookups = monitoring::Counter<1>::New(
+    "/tensorflow/core/platform/cloud/file_block_cache_lookups",
+    "The number of block lookups made by reads of file block caches.",
+    "result");
+
+// The cells of block_cache_lookups, which are looked up once since every
+// read updates them.
+monitoring::CounterCell* const block_cache_hits =
+    block_cache_lookups->GetCell("hit");
+monitoring::CounterCell* const block_cache_misses =
+    block_cache_lookups->GetCell("miss");
+
+// The largest share of a full scan resistant cache that blocks on probation
+// may take up.
+constexpr size_t kMaxProbationFraction = 4;
+
+}  // namespace
+
 bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
   mutex_lock l(block->mu);
   if (block->state != FetchState::FINISHED) {
@@ -31,34 +54,76 @@ bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
 }
 
 std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
-    const Key& key) {
+    const Key& key, bool count_lookup) {
   mutex_lock lock(mu_);
   auto entry = block_map_.find(key);
   if (entry != block_map_.end()) {
     if (BlockNotStale(entry->second)) {
+      if (count_lookup) {
+        ++stats_.hits;
+        block_cache_hits->IncrementBy(1);
+      }
       return entry->second;
     } else {
       // Remove the stale block and continue.
       RemoveFile_Locked(key.first);
     }
   }
+  if (count_lookup) {
+    ++stats_.misses;
+    block_cache_misses->IncrementBy(1);
+  }
 
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
-  lru_list_.push_front(key);
+  auto ghost = ghost_map_.find(key);
+  if (ghost != ghost_map_.end()) {
+    // The block is needed again soon after it was evicted from probation, so
+    // it is protected this time.
+    ghost_list_.erase(ghost->second);
+    ghost_map_.erase(ghost);
+  } else if (scan_resistant_) {
+    new_entry->on_probation = true;
+  }
+  std::list<Key>& list = new_entry->on_probation ? probation_list_ : lru_list_;
+  list.push_front(key);
   lra_list_.push_front(key);
-  new_entry->lru_iterator = lru_list_.begin();
+  new_entry->lru_iterator = list.begin();
   new_entry->lra_iterator = lra_list_.begin();
   new_entry->timestamp = env_->NowSeconds();
   block_map_.emplace(std::make_pair(key, new_entry));
   return new_entry;
 }
 
-// Remove blocks from the cache until we do not exceed our maximum size.
+// Remove blocks from the cache until we do not exceed our maximum size. The
+// blocks on probation are evicted first as long as they take up more than
+// their share of the cache.
 void RamFileBlockCache::Trim() {
-  while (!lru_list_.empty() && cache_size_ > max_bytes_) {
-    RemoveBlock(block_map_.find(lru_list_.back()));
+  while ((!lru_list_.empty() || !probation_list_.empty()) &&
+         cache_size_ > max_bytes_) {
+    if (!probation_list_.empty() &&
+        (lru_list_.empty() ||
+         probation_size_ > max_bytes_ / kMaxProbationFraction)) {
+      // Copy the key, as it is destroyed along with the block's list entry.
+      const Key key = probation_list_.back();
+      RemoveBlock(block_map_.find(key));
+      AddGhost(key);
+    } else {
+      RemoveBlock(block_map_.find(lru_list_.back()));
+    }
+    ++stats_.evictions;
+  }
+}
+
+void RamFileBlockCache::AddGhost(const Key& key) {
+  ghost_list_.push_front(key);
+  ghost_map_[key] = ghost_list_.begin();
+  // Remember as many blocks as the cache can hold.
+  const size_t max_ghosts = std::max<size_t>(max_bytes_ / block_size_, 1);
+  while (ghost_list_.size() > max_ghosts) {
+    ghost_map_.erase(ghost_list_.back());
+    ghost_list_.pop_back();
   }
 }
 
@@ -70,21 +135,27 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
     // The block was evicted from another thread. Allow it to remain evicted.
     return Status::OK();
   }
-  if (block->lru_iterator != lru_list_.begin()) {
-    lru_list_.erase(block->lru_iterator);
-    lru_list_.push_front(key);
-    block->lru_iterator = lru_list_.begin();
+  std::list<Key>& list = block->on_probation ? probation_list_ : lru_list_;
+  if (block->lru_iterator != list.begin()) {
+    list.erase(block->lru_iterator);
+    list.push_front(key);
+    block->lru_iterator = list.begin();
   }
 
   // Check for inconsistent state. If there is a block later in the same file
   // in the cache, and our current block is not block size, this likely means
-  // we have inconsistent state within the cache. Note: it's possible some
-  // incomplete reads may still go undetected.
+  // we have inconsistent state within the cache. Blocks read ahead past the
+  // end of the file are empty or still being fetched, so they are skipped.
+  // Note: it's possible some incomplete reads may still go undetected.
   if (block->data.size() < block_size_) {
     Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
     auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
+    while (fcmp != block_map_.begin() && key < (--fcmp)->first) {
+      mutex_lock l(fcmp->second->mu);
+      if (fcmp->second->state == FetchState::FINISHED &&
+          !fcmp->second->data.empty()) {
+        return errors::Internal("Block cache contents are inconsistent.");
+      }
     }
   }
 
@@ -105,6 +176,9 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
           // Do not update state if the block is already to be evicted.
           if (block->timestamp != 0) {
             cache_size_ += block->data.size();
+            if (block->on_probation) {
+              probation_size_ += block->data.size();
+            }
             // Put to beginning of LRA list.
             lra_list_.erase(block->lra_iterator);
             lra_list_.push_front(key);
@@ -155,6 +229,51 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
       "Control flow should never reach the end of RamFileBlockCache::Fetch.");
 }
 
+void RamFileBlockCache::ReadAhead(const string& filename, size_t offset,
+                                  size_t n, size_t start, size_t finish) {
+  // Never read ahead so far that the blocks being read could be evicted.
+  const size_t max_blocks = max_bytes_ / block_size_;
+  const size_t readahead_blocks =
+      std::min(readahead_blocks_, max_blocks > 0 ? max_blocks - 1 : 0);
+  std::vector<Key> keys;
+  {
+    mutex_lock lock(mu_);
+    auto it = next_read_offset_.find(filename);
+    if (it != next_read_offset_.end() && it->second == offset) {
+      finish += readahead_blocks * block_size_;
+    }
+    next_read_offset_[filename] = offset + n;
+    for (size_t pos = start + block_size_; pos < finish; pos += block_size_) {
+      Key key = std::make_pair(filename, pos);
+      auto entry = block_map_.find(key);
+      if (entry == block_map_.end()) {
+        keys.push_back(key);
+        continue;
+      }
+      // Stop at a block known to hold the end of the file.
+      mutex_lock l(entry->second->mu);
+      if (entry->second->state == FetchState::FINISHED &&
+          entry->second->data.size() < block_size_) {
+        break;
+      }
+    }
+  }
+  for (const Key& key : keys) {
+    std::shared_ptr<Block> block = Lookup(key, false);
+    readahead_pool_->Schedule([this, key, block]() {
+      {
+        mutex_lock lock(mu_);
+        if (stop_readahead_) return;
+      }
+      // Errors are left for the read of the block to report, which refetches
+      // it.
+      if (MaybeFetch(key, block).ok()) {
+        UpdateLRU(key, block).IgnoreError();
+      }
+    });
+  }
+}
+
 Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
                                char* buffer, size_t* bytes_transferred) {
   *bytes_transferred = 0;
@@ -172,13 +291,16 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  if (readahead_pool_) {
+    ReadAhead(filename, offset, n, start, finish);
+  }
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
     // Look up the block, fetching and inserting it if necessary, and update the
     // LRU iterator for the key and block.
-    std::shared_ptr<Block> block = Lookup(key);
+    std::shared_ptr<Block> block = Lookup(key, true);
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
     TF_RETURN_IF_ERROR(MaybeFetch(key, block));
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
@@ -239,6 +361,11 @@ size_t RamFileBlockCache::CacheSize() const {
   return cache_size_;
 }
 
+FileBlockCache::Stats RamFileBlockCache::GetStats() const {
+  mutex_lock lock(mu_);
+  return stats_;
+}
+
 void RamFileBlockCache::Prune() {
   while (!WaitForNotificationWithTimeout(&stop_pruning_thread_, 1000000)) {
     mutex_lock lock(mu_);
@@ -260,8 +387,36 @@ void RamFileBlockCache::Flush() {
   mutex_lock lock(mu_);
   block_map_.clear();
   lru_list_.clear();
+  probation_list_.clear();
   lra_list_.clear();
+  ghost_list_.clear();
+  ghost_map_.clear();
   cache_size_ = 0;
+  probation_size_ = 0;
+  next_read_offset_.clear();
+}
+
+void RamFileBlockCache::RemoveFilesWithPrefix(const string& prefix) {
+  mutex_lock lock(mu_);
+  const auto has_prefix = [&prefix](const string& filename) {
+    return str_util::StartsWith(filename, prefix);
+  };
+  auto it = block_map_.lower_bound(std::make_pair(prefix, 0));
+  while (it != block_map_.end() && has_prefix(it->first.first)) {
+    auto next = std::next(it);
+    RemoveBlock(it);
+    it = next;
+  }
+  auto signature = file_signature_map_.lower_bound(prefix);
+  while (signature != file_signature_map_.end() &&
+         has_prefix(signature->first)) {
+    signature = file_signature_map_.erase(signature);
+  }
+  auto read_offset = next_read_offset_.lower_bound(prefix);
+  while (read_offset != next_read_offset_.end() &&
+         has_prefix(read_offset->first)) {
+    read_offset = next_read_offset_.erase(read_offset);
+  }
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
@@ -283,7 +438,12 @@ void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
   // This signals that the block is removed, and should not be inadvertently
   // reinserted into the cache in UpdateLRU.
   entry->second->timestamp = 0;
-  lru_list_.erase(entry->second->lru_iterator);
+  if (entry->second->on_probation) {
+    probation_list_.erase(entry->second->lru_iterator);
+    probation_size_ -= entry->second->data.size();
+  } else {
+    lru_list_.erase(entry->second->lru_iterator);
+  }
   lra_list_.erase(entry->second->lra_iterator);
   cache_size_ -= entry->second->data.size();
   block_map_.erase(entry);
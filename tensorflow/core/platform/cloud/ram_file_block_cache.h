@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -37,6 +38,13 @@ namespace tensorflow {
 ///
 /// This class should be shared by read-only random access files on a remote
 /// filesystem (e.g. GCS).
+///
+/// If the cache is scan resistant, it is split into two LRU segments as in the
+/// 2Q algorithm: blocks are first cached in a probationary segment, and only
+/// blocks fetched again soon after being evicted from it move to the protected
+/// segment. A single scan through more data than the cache holds then only
+/// evicts blocks on probation, while the blocks of files read repeatedly (e.g.
+/// once per training epoch) stay cached.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -49,20 +57,38 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// If `readahead_blocks` is positive, the blocks of a read past the first
+  /// one are fetched in parallel, and sequential reads of a file fetch up to
+  /// `readahead_blocks` blocks past the end of the read in the background.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t readahead_blocks = 0, bool scan_resistant = false)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        readahead_blocks_(readahead_blocks),
+        scan_resistant_(scan_resistant) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (readahead_blocks_ > 0 && IsCacheEnabled()) {
+      readahead_pool_.reset(new thread::ThreadPool(
+          env_, "TF_readahead_FBC", static_cast<int>(readahead_blocks_)));
+    }
   }
 
   ~RamFileBlockCache() override {
+    if (readahead_pool_) {
+      {
+        mutex_lock lock(mu_);
+        stop_readahead_ = true;
+      }
+      // Destroying readahead_pool_ waits for the fetches in flight to finish.
+      readahead_pool_.reset();
+    }
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -102,6 +128,10 @@ class RamFileBlockCache : public FileBlockCache {
   /// Remove all cached data.
   void Flush() override LOCKS_EXCLUDED(mu_);
 
+  /// Remove all cached blocks and signatures of the files whose names start
+  /// with `prefix`.
+  void RemoveFilesWithPrefix(const string& prefix) LOCKS_EXCLUDED(mu_);
+
   /// Accessors for cache parameters.
   size_t block_size() const override { return block_size_; }
   size_t max_bytes() const override { return max_bytes_; }
@@ -110,6 +140,9 @@ class RamFileBlockCache : public FileBlockCache {
   /// The current size (in bytes) of the cache.
   size_t CacheSize() const override LOCKS_EXCLUDED(mu_);
 
+  /// The counts of block lookups and evictions since the cache was created.
+  Stats GetStats() const override LOCKS_EXCLUDED(mu_);
+
   // Returns true if the cache is enabled. If false, the BlockFetcher callback
   // is always executed during Read.
   bool IsCacheEnabled() const override {
@@ -128,6 +161,10 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks fetched ahead of a sequential read.
+  const size_t readahead_blocks_;
+  /// Whether new blocks are cached on probation.
+  const bool scan_resistant_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -166,12 +203,15 @@ class RamFileBlockCache : public FileBlockCache {
   struct Block {
     /// The block data.
     std::vector<char> data;
-    /// A list iterator pointing to the block's position in the LRU list.
+    /// A list iterator pointing to the block's position in the LRU list, or
+    /// in the probation list if the block is on probation.
     std::list<Key>::iterator lru_iterator;
     /// A list iterator pointing to the block's position in the LRA list.
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
     uint64 timestamp;
+    /// Whether the block is in the probation list rather than the LRU list.
+    bool on_probation = false;
     /// Mutex to guard state variable
     mutex mu;
     /// The state of the block.
@@ -191,12 +231,21 @@ class RamFileBlockCache : public FileBlockCache {
   bool BlockNotStale(const std::shared_ptr<Block>& block)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
-  /// Look up a Key in the block cache.
-  std::shared_ptr<Block> Lookup(const Key& key) LOCKS_EXCLUDED(mu_);
+  /// Look up a Key in the block cache. The lookup is counted in the cache
+  /// statistics if `count_lookup` is true.
+  std::shared_ptr<Block> Lookup(const Key& key, bool count_lookup)
+      LOCKS_EXCLUDED(mu_);
 
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       LOCKS_EXCLUDED(mu_);
 
+  /// Schedule background fetches of the blocks of a read at `offset` of size
+  /// `n` past the first one, and of the blocks following it if the read
+  /// continues the previous read of the file. `start` and `finish` are the
+  /// block-aligned bounds of the read.
+  void ReadAhead(const string& filename, size_t offset, size_t n, size_t start,
+                 size_t finish) LOCKS_EXCLUDED(mu_);
+
   /// Trim the block cache to make room for another entry.
   void Trim() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -211,12 +260,19 @@ class RamFileBlockCache : public FileBlockCache {
   /// cache size accordingly.
   void RemoveBlock(BlockMap::iterator entry) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Remember the key of a block evicted from probation, so that the block is
+  /// protected if it is fetched again.
+  void AddGhost(const Key& key) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// The cache pruning thread that removes files with expired blocks.
   std::unique_ptr<Thread> pruning_thread_;
 
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads fetching blocks ahead of reads, if read-ahead is enabled.
+  std::unique_ptr<thread::ThreadPool> readahead_pool_;
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
@@ -227,6 +283,15 @@ class RamFileBlockCache : public FileBlockCache {
   /// recently accessed block.
   std::list<Key> lru_list_ GUARDED_BY(mu_);
 
+  /// The LRU list of the keys of the blocks on probation, if the cache is scan
+  /// resistant.
+  std::list<Key> probation_list_ GUARDED_BY(mu_);
+
+  /// The keys of the blocks most recently evicted from probation_list_, most
+  /// recent first, and an index of them.
+  std::list<Key> ghost_list_ GUARDED_BY(mu_);
+  std::map<Key, std::list<Key>::iterator> ghost_map_ GUARDED_BY(mu_);
+
   /// The LRA (least recently added) list of block keys. The front of the list
   /// identifies the most recently added block.
   ///
@@ -237,8 +302,21 @@ class RamFileBlockCache : public FileBlockCache {
   /// The combined number of bytes in all of the cached blocks.
   size_t cache_size_ GUARDED_BY(mu_) = 0;
 
+  /// The combined number of bytes in the blocks on probation.
+  size_t probation_size_ GUARDED_BY(mu_) = 0;
+
+  /// The counts of block lookups and evictions.
+  Stats stats_ GUARDED_BY(mu_);
+
   // A filename->file_signature map.
   std::map<string, int64> file_signature_map_ GUARDED_BY(mu_);
+
+  /// A filename->offset map of the end of the last read of each file, used to
+  /// detect sequential reads.
+  std::map<string, size_t> next_read_offset_ GUARDED_BY(mu_);
+
+  /// Set when the cache is being destroyed, to skip pending fetches.
+  bool stop_readahead_ GUARDED_BY(mu_) = false;
 };
 
 }  // namespace tensorflow
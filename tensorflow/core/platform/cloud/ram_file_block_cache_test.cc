@@ -507,6 +507,73 @@ TEST(RamFileBlockCacheTest, ParallelReads) {
   // executed, or 10 seconds have passed).
 }
 
+TEST(RamFileBlockCacheTest, ParallelBlockFetches) {
+  // A single read of `blocks` blocks only succeeds if all of its blocks are
+  // fetched concurrently.
+  const int blocks = 4;
+  BlockingCounter counter(blocks);
+  auto fetcher = [&counter](const string& filename, size_t offset, size_t n,
+                            char* buffer, size_t* bytes_transferred) {
+    counter.DecrementCount();
+    if (!counter.WaitFor(std::chrono::seconds(10))) {
+      return errors::FailedPrecondition("desired concurrency not reached");
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  const int block_size = 8;
+  RamFileBlockCache cache(block_size, 2 * blocks * block_size, 0, fetcher,
+                          Env::Default(), blocks - 1);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, blocks * block_size, &out));
+  EXPECT_EQ(out, std::vector<char>(blocks * block_size, 'x'));
+}
+
+TEST(RamFileBlockCacheTest, SequentialReadAhead) {
+  // The file is 36 bytes long, and its i-th byte is '0' + i.
+  const size_t file_size = 36;
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&mu, &fetches, file_size](
+                     const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      fetches[offset]++;
+    }
+    size_t bytes = offset < file_size ? std::min(n, file_size - offset) : 0;
+    for (size_t i = 0; i < bytes; ++i) {
+      buffer[i] = '0' + offset + i;
+    }
+    *bytes_transferred = bytes;
+    return Status::OK();
+  };
+  const size_t block_size = 8;
+  RamFileBlockCache cache(block_size, 8 * block_size, 0, fetcher,
+                          Env::Default(), 2);
+  std::vector<char> out;
+  string data;
+  for (size_t offset = 0; offset < file_size; offset += block_size) {
+    TF_EXPECT_OK(ReadCache(&cache, "a", offset, block_size, &out));
+    data.append(out.begin(), out.end());
+  }
+  std::vector<char> out_of_range;
+  EXPECT_EQ(ReadCache(&cache, "a", 40, block_size, &out_of_range).code(),
+            error::OUT_OF_RANGE);
+  EXPECT_EQ(data.size(), file_size);
+  for (size_t i = 0; i < data.size(); ++i) {
+    EXPECT_EQ(data[i], static_cast<char>('0' + i));
+  }
+  // Every block was fetched once, whether by a read or ahead of one.
+  mutex_lock l(mu);
+  for (const auto& fetch : fetches) {
+    EXPECT_EQ(fetch.second, 1) << "block at " << fetch.first;
+  }
+  EXPECT_EQ(fetches.count(0), 1);
+  EXPECT_EQ(fetches.count(32), 1);
+}
+
 TEST(RamFileBlockCacheTest, CoalesceConcurrentReads) {
   // Concurrent reads to the same file blocks should be de-duplicated.
   const size_t block_size = 16;
@@ -560,5 +627,41 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, ScanResistant) {
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  RamFileBlockCache cache(16, 64, 0, fetcher, Env::Default(), 0,
+                          /*scan_resistant=*/true);
+  std::vector<char> out;
+  // The first block of "a" is cached on probation, and evicted by a scan.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  for (int i = 0; i < 4; ++i) {
+    TF_EXPECT_OK(ReadCache(&cache, "b", 16 * i, 16, &out));
+  }
+  EXPECT_EQ(calls, 5);
+  // Fetched again soon after its eviction, it is now protected, so a longer
+  // scan does not evict it.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 6);
+  for (int i = 0; i < 8; ++i) {
+    TF_EXPECT_OK(ReadCache(&cache, "c", 16 * i, 16, &out));
+  }
+  EXPECT_EQ(calls, 14);
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 16, &out));
+  EXPECT_EQ(calls, 14);
+  EXPECT_EQ(cache.CacheSize(), 64);
+
+  FileBlockCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 14);
+  EXPECT_EQ(stats.evictions, 10);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,199 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/shared_file_block_cache.h"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kMaxCacheSize[] = "TF_SHARED_FILE_BLOCK_CACHE_MAX_SIZE_MB";
+constexpr char kBlockSize[] = "TF_SHARED_FILE_BLOCK_CACHE_BLOCK_SIZE_MB";
+constexpr size_t kDefaultBlockSize = 16 * 1024 * 1024;
+constexpr char kMaxStaleness[] = "TF_SHARED_FILE_BLOCK_CACHE_MAX_STALENESS";
+constexpr char kReadaheadBlocks[] =
+    "TF_SHARED_FILE_BLOCK_CACHE_READAHEAD_BLOCKS";
+
+// Separates the prefix of an instance from the filename in the keys of the
+// shared cache.
+constexpr char kPrefixSeparator = '|';
+
+uint64 GetEnvUint64(const char* varname, uint64 default_value) {
+  const char* env_value = std::getenv(varname);
+  uint64 value;
+  if (env_value == nullptr || !strings::safe_strtou64(env_value, &value)) {
+    return default_value;
+  }
+  return value;
+}
+
+}  // namespace
+
+// Owns the shared cache, and dispatches the blocks it fetches to the fetcher
+// of the instance that read them.
+class SharedFileBlockCache::Registry {
+ public:
+  static Registry* Get() {
+    static Registry* registry = new Registry;
+    return registry;
+  }
+
+  RamFileBlockCache* cache() { return cache_.get(); }
+
+  // Returns the prefix of the keys of a new instance.
+  string Register(BlockFetcher block_fetcher) LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    string prefix = strings::StrCat(next_id_++, string(1, kPrefixSeparator));
+    fetchers_[prefix].fetcher = std::move(block_fetcher);
+    return prefix;
+  }
+
+  // Removes the fetcher of an instance, once the fetches it is running are
+  // done.
+  void Unregister(const string& prefix) LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    auto it = fetchers_.find(prefix);
+    it->second.removed = true;
+    while (it->second.fetches_in_flight > 0) {
+      fetch_done_.wait(l);
+    }
+    fetchers_.erase(it);
+  }
+
+ private:
+  struct Fetcher {
+    BlockFetcher fetcher;
+    int fetches_in_flight = 0;
+    bool removed = false;
+  };
+
+  Registry() {
+    size_t max_bytes = GetEnvUint64(kMaxCacheSize, 0) * 1024 * 1024;
+    const int64 available_ram = port::AvailableRam();
+    if (available_ram > 0) {
+      max_bytes = std::min<uint64>(max_bytes, available_ram / 2);
+    }
+    const size_t block_size =
+        GetEnvUint64(kBlockSize, kDefaultBlockSize / (1024 * 1024)) * 1024 *
+        1024;
+    cache_.reset(new RamFileBlockCache(
+        block_size, max_bytes, GetEnvUint64(kMaxStaleness, 0),
+        [this](const string& filename, size_t offset, size_t n, char* buffer,
+               size_t* bytes_transferred) {
+          return Fetch(filename, offset, n, buffer, bytes_transferred);
+        },
+        Env::Default(), GetEnvUint64(kReadaheadBlocks, 0),
+        /*scan_resistant=*/true));
+  }
+
+  Status Fetch(const string& filename, size_t offset, size_t n, char* buffer,
+               size_t* bytes_transferred) LOCKS_EXCLUDED(mu_) {
+    const string prefix =
+        filename.substr(0, filename.find(kPrefixSeparator) + 1);
+    Fetcher* fetcher;
+    {
+      mutex_lock l(mu_);
+      auto it = fetchers_.find(prefix);
+      if (it == fetchers_.end() || it->second.removed) {
+        return errors::Cancelled("The block cache of ", filename,
+                                 " was destroyed.");
+      }
+      fetcher = &it->second;
+      ++fetcher->fetches_in_flight;
+    }
+    Status status = fetcher->fetcher(filename.substr(prefix.size()), offset, n,
+                                     buffer, bytes_transferred);
+    mutex_lock l(mu_);
+    if (--fetcher->fetches_in_flight == 0) {
+      fetch_done_.notify_all();
+    }
+    return status;
+  }
+
+  mutex mu_;
+  condition_variable fetch_done_;
+  int64 next_id_ GUARDED_BY(mu_) = 0;
+  // The fetchers of the instances, by key prefix. std::map keeps the pointers
+  // to its values valid while other instances are added and removed.
+  std::map<string, Fetcher> fetchers_ GUARDED_BY(mu_);
+  std::unique_ptr<RamFileBlockCache> cache_;
+};
+
+SharedFileBlockCache::SharedFileBlockCache(BlockFetcher block_fetcher)
+    : prefix_(Registry::Get()->Register(std::move(block_fetcher))) {}
+
+SharedFileBlockCache::~SharedFileBlockCache() {
+  Registry::Get()->Unregister(prefix_);
+  Registry::Get()->cache()->RemoveFilesWithPrefix(prefix_);
+}
+
+bool SharedFileBlockCache::IsEnabled() {
+  return Registry::Get()->cache()->IsCacheEnabled();
+}
+
+Status SharedFileBlockCache::Read(const string& filename, size_t offset,
+                                  size_t n, char* buffer,
+                                  size_t* bytes_transferred) {
+  return Registry::Get()->cache()->Read(strings::StrCat(prefix_, filename),
+                                        offset, n, buffer, bytes_transferred);
+}
+
+bool SharedFileBlockCache::ValidateAndUpdateFileSignature(
+    const string& filename, int64 file_signature) {
+  return Registry::Get()->cache()->ValidateAndUpdateFileSignature(
+      strings::StrCat(prefix_, filename), file_signature);
+}
+
+void SharedFileBlockCache::RemoveFile(const string& filename) {
+  Registry::Get()->cache()->RemoveFile(strings::StrCat(prefix_, filename));
+}
+
+void SharedFileBlockCache::Flush() {
+  Registry::Get()->cache()->RemoveFilesWithPrefix(prefix_);
+}
+
+size_t SharedFileBlockCache::block_size() const {
+  return Registry::Get()->cache()->block_size();
+}
+
+size_t SharedFileBlockCache::max_bytes() const {
+  return Registry::Get()->cache()->max_bytes();
+}
+
+uint64 SharedFileBlockCache::max_staleness() const {
+  return Registry::Get()->cache()->max_staleness();
+}
+
+size_t SharedFileBlockCache::CacheSize() const {
+  return Registry::Get()->cache()->CacheSize();
+}
+
+FileBlockCache::Stats SharedFileBlockCache::GetStats() const {
+  return Registry::Get()->cache()->GetStats();
+}
+
+bool SharedFileBlockCache::IsCacheEnabled() const {
+  return Registry::Get()->cache()->IsCacheEnabled();
+}
+
+}  // namespace tensorflow
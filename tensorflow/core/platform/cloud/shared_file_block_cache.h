@@ -0,0 +1,88 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_SHARED_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_SHARED_FILE_BLOCK_CACHE_H_
+
+#include <memory>
+#include <string>
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief The block cache of one filesystem in a cache shared by all of them.
+///
+/// All instances of this class store their blocks in one RamFileBlockCache,
+/// so the filesystems of a process share a single memory budget, and the
+/// blocks of the files read most recently by any of them are the ones that
+/// stay cached. The shared cache is scan resistant, and is configured with the
+/// following environment variables:
+///
+///   TF_SHARED_FILE_BLOCK_CACHE_MAX_SIZE_MB: The size of the cache, capped at
+///     half of the RAM available when it is created. 0 (the default) disables
+///     the shared cache, leaving filesystems to use their own caches.
+///   TF_SHARED_FILE_BLOCK_CACHE_BLOCK_SIZE_MB: The size of the blocks (16MB by
+///     default).
+///   TF_SHARED_FILE_BLOCK_CACHE_MAX_STALENESS: The maximum staleness of the
+///     blocks, in seconds (no maximum by default).
+///   TF_SHARED_FILE_BLOCK_CACHE_READAHEAD_BLOCKS: The number of blocks read
+///     ahead of sequential reads (none by default).
+class SharedFileBlockCache : public FileBlockCache {
+ public:
+  /// Creates the cache of a filesystem whose blocks are read by
+  /// `block_fetcher`. Blocks read by this instance are removed from the shared
+  /// cache when it is destroyed.
+  explicit SharedFileBlockCache(BlockFetcher block_fetcher);
+  ~SharedFileBlockCache() override;
+
+  /// Returns true if the shared cache is configured to hold any data.
+  static bool IsEnabled();
+
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred) override;
+
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64 file_signature) override;
+
+  void RemoveFile(const string& filename) override;
+
+  /// Removes the blocks of this instance from the shared cache.
+  void Flush() override;
+
+  /// The parameters, size and statistics of the shared cache.
+  size_t block_size() const override;
+  size_t max_bytes() const override;
+  uint64 max_staleness() const override;
+  size_t CacheSize() const override;
+  Stats GetStats() const override;
+  bool IsCacheEnabled() const override;
+
+ private:
+  class Registry;
+
+  /// The key prefix of the files of this instance in the shared cache.
+  const string prefix_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedFileBlockCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_SHARED_FILE_BLOCK_CACHE_H_
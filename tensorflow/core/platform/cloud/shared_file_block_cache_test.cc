@@ -0,0 +1,77 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/shared_file_block_cache.h"
+#include <cstdlib>
+#include <cstring>
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kBlockSize = 1024 * 1024;
+
+FileBlockCache::BlockFetcher MakeFetcher(char c, int* calls) {
+  return [c, calls](const string& filename, size_t offset, size_t n,
+                    char* buffer, size_t* bytes_transferred) {
+    (*calls)++;
+    memset(buffer, c, n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+}
+
+TEST(SharedFileBlockCacheTest, InstancesShareBudgetButNotFiles) {
+  // The shared cache reads its configuration when it is first used.
+  setenv("TF_SHARED_FILE_BLOCK_CACHE_MAX_SIZE_MB", "4", 1);
+  setenv("TF_SHARED_FILE_BLOCK_CACHE_BLOCK_SIZE_MB", "1", 1);
+  ASSERT_TRUE(SharedFileBlockCache::IsEnabled());
+
+  int calls_a = 0;
+  int calls_b = 0;
+  SharedFileBlockCache cache_a(MakeFetcher('a', &calls_a));
+  std::unique_ptr<SharedFileBlockCache> cache_b(
+      new SharedFileBlockCache(MakeFetcher('b', &calls_b)));
+  EXPECT_EQ(cache_a.block_size(), kBlockSize);
+  EXPECT_EQ(cache_a.max_bytes(), cache_b->max_bytes());
+
+  // The same filename read by two instances refers to two different files.
+  char buffer[8];
+  size_t bytes_transferred;
+  TF_EXPECT_OK(cache_a.Read("f", 0, 8, buffer, &bytes_transferred));
+  EXPECT_EQ(bytes_transferred, 8);
+  EXPECT_EQ(buffer[0], 'a');
+  TF_EXPECT_OK(cache_b->Read("f", 0, 8, buffer, &bytes_transferred));
+  EXPECT_EQ(buffer[0], 'b');
+  TF_EXPECT_OK(cache_a.Read("f", 0, 8, buffer, &bytes_transferred));
+  EXPECT_EQ(buffer[0], 'a');
+  EXPECT_EQ(calls_a, 1);
+  EXPECT_EQ(calls_b, 1);
+  EXPECT_EQ(cache_a.CacheSize(), 2 * kBlockSize);
+  EXPECT_EQ(cache_a.GetStats().hits, 1);
+
+  // Destroying an instance removes its blocks only.
+  cache_b.reset();
+  EXPECT_EQ(cache_a.CacheSize(), kBlockSize);
+  TF_EXPECT_OK(cache_a.Read("f", 0, 8, buffer, &bytes_transferred));
+  EXPECT_EQ(calls_a, 1);
+
+  cache_a.Flush();
+  EXPECT_EQ(cache_a.CacheSize(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
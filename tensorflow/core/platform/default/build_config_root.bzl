@@ -53,6 +53,15 @@ def tf_additional_gdr_deps():
       "//conditions:default": [],
   })
 
+def tf_additional_shm_deps():
+  return select({
+      str(Label("//tensorflow:windows")): [],
+      str(Label("//tensorflow:android")): [],
+      "//conditions:default": [
+          str(Label("//tensorflow/contrib/shm:shm_server_lib")),
+      ],
+  })
+
 def if_static(extra_deps, otherwise=[]):
   return select({
       str(Label("//tensorflow:framework_shared_object")): otherwise,
@@ -315,10 +315,27 @@ class DeviceTracerImpl : public DeviceTracer,
         new Impl{ConcatenateNames(name_part1, name_part2)});
   }
 
-  virtual std::unique_ptr<Handle> CreateActivityHandle(StringPiece, StringPiece,
+  virtual std::unique_ptr<Handle> CreateActivityHandle(StringPiece name_part1,
+                                                       StringPiece name_part2,
                                                        bool) const {
-    // We don't do anything with 'Activities' yet.
-    return nullptr;
+    // Activities named by an op name and type are op computations, which the
+    // executor already records. The others, such as iterator GetNext calls
+    // and remote function calls, are recorded as host events.
+    if (!name_part2.empty()) return nullptr;
+    struct Impl : public tracing::TraceCollector::Handle {
+      // Shared, since an activity may end after the tracer is gone.
+      std::shared_ptr<ActivityLog> log;
+      string name;
+      int64 start_us;
+      Impl(std::shared_ptr<ActivityLog> log, string &&name)
+          : log(std::move(log)),
+            name(std::move(name)),
+            start_us(Env::Default()->NowMicros()) {}
+      ~Impl() override {
+        log->Add(std::move(name), start_us, Env::Default()->NowMicros());
+      }
+    };
+    return std::unique_ptr<Handle>(new Impl(activities_, string(name_part1)));
   }
 
  protected:
@@ -335,6 +352,21 @@ class DeviceTracerImpl : public DeviceTracer,
     uint32 stream_id;
     uint32 correlation_id;
   };
+  // Internal struct to record host activities.
+  struct ActivityRecord {
+    string name;
+    int64 start_us;
+    int64 end_us;
+  };
+  struct ActivityLog {
+    void Add(string &&name, int64 start_us, int64 end_us) {
+      mutex_lock l(mu);
+      if (records.size() >= kMaxRecords) return;
+      records.push_back({std::move(name), start_us, end_us});
+    }
+    mutex mu;
+    std::vector<ActivityRecord> records GUARDED_BY(mu);
+  };
   // Internal struct to record memcpy operations.
   struct MemcpyRecord {
     uint64_t start_timestamp;
@@ -368,6 +400,8 @@ class DeviceTracerImpl : public DeviceTracer,
   std::map<uint32, string> correlations_ GUARDED_BY(trace_mu_);
   std::vector<KernelRecord> kernel_records_ GUARDED_BY(trace_mu_);
   std::vector<MemcpyRecord> memcpy_records_ GUARDED_BY(trace_mu_);
+  const std::shared_ptr<ActivityLog> activities_ =
+      std::make_shared<ActivityLog>();
 
   mutex mu_;
   bool enabled_ GUARDED_BY(mu_);
@@ -584,6 +618,8 @@ Status DeviceTracerImpl::Collect(StepStatsCollector *collector) {
       strings::StrCat(prefix, "/device:GPU:", id, "/stream:");
   const string memcpy_device =
       strings::StrCat(prefix, "/device:GPU:", id, "/memcpy");
+  const string activity_device =
+      strings::StrCat(prefix, "/host:CPU/activities");
 
   mutex_lock l2(trace_mu_);
   for (const auto &rec : kernel_records_) {
@@ -630,6 +666,17 @@ Status DeviceTracerImpl::Collect(StepStatsCollector *collector) {
     collector->Save(memcpy_device, ns);
     collector->Save(strings::StrCat(stream_device, rec.stream_id), nscopy);
   }
+  mutex_lock l3(activities_->mu);
+  for (const auto &rec : activities_->records) {
+    NodeExecStats *ns = new NodeExecStats;
+    ns->set_all_start_micros(rec.start_us);
+    ns->set_op_start_rel_micros(0);
+    auto elapsed_us = std::max<int64>(rec.end_us - rec.start_us, 1);
+    ns->set_op_end_rel_micros(elapsed_us);
+    ns->set_all_end_rel_micros(elapsed_us);
+    ns->set_node_name(rec.name);
+    collector->Save(activity_device, ns);
+  }
   return Status::OK();
 }
 
@@ -184,8 +184,20 @@ void Benchmark::Run(const char* pattern) {
         LOG(ERROR) << s.ToString();
         exit(EXIT_FAILURE);
       }
-      s = reporter.Benchmark(iters, 0.0, seconds,
-                             items_processed * 1e-6 / seconds);
+      s = reporter.Benchmark(
+          iters, 0.0, seconds,
+          items_processed > 0 ? items_processed * 1e-6 / seconds : 0.0);
+      if (s.ok() && bytes_processed > 0) {
+        s = reporter.SetProperty("bytes_per_second",
+                                 bytes_processed / seconds);
+      }
+      if (s.ok() && items_processed > 0) {
+        s = reporter.SetProperty("items_per_second",
+                                 items_processed / seconds);
+      }
+      if (s.ok() && !label.empty()) {
+        s = reporter.SetProperty("label", label);
+      }
       if (!s.ok()) {
         LOG(ERROR) << s.ToString();
         exit(EXIT_FAILURE);
@@ -238,6 +238,30 @@ class RandomAccessFile {
   virtual Status Read(uint64 offset, size_t n, StringPiece* result,
                       char* scratch) const = 0;
 
+  /// The callback run when an asynchronous read is done, with the status and
+  /// result that Read() would have returned.
+  typedef std::function<void(const Status& status, StringPiece result)>
+      ReadCallback;
+
+  /// \brief Reads up to `n` bytes from the file starting at `offset`, and
+  /// runs `done` once they are read.
+  ///
+  /// `scratch[0..n-1]` and the file must be live until `done` runs. `done`
+  /// may run on another thread, or before ReadAsync returns. The default
+  /// implementation reads synchronously with Read().
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(uint64 offset, size_t n, char* scratch,
+                         ReadCallback done) const;
+
+  /// \brief Hints that the `n` bytes at `offset` will not be read again soon,
+  /// so that the OS may drop them from its cache.
+  ///
+  /// Readers that make a single pass over large files call this so that they
+  /// do not evict the cached data of other processes. The default
+  /// implementation does nothing.
+  virtual void DropCachedData(uint64 offset, size_t n) const {}
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessFile);
 };
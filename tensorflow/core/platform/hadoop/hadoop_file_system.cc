@@ -17,8 +17,12 @@ limitations under the License.
 
 #include <errno.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/error.h"
@@ -30,6 +34,39 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// Reads smaller than this many bytes fetch this many bytes, so that readers of
+// small records do not make a round trip to a datanode for each of them.
+// Overridden by TF_HDFS_READ_AHEAD_BYTES, where 0 disables read-ahead.
+constexpr int64 kDefaultReadAheadBytes = 1 << 20;
+
+// The number of threads that run ReadAsync(). Prefetching readers keep several
+// reads in flight to hide the latency of the datanodes.
+constexpr int kNumAsyncReadThreads = 16;
+
+int64 ReadAheadBytes() {
+  static const int64 read_ahead_bytes = []() {
+    const char* value = getenv("TF_HDFS_READ_AHEAD_BYTES");
+    int64 bytes = kDefaultReadAheadBytes;
+    if (value != nullptr && (!strings::safe_strto64(value, &bytes) ||
+                             bytes < 0)) {
+      LOG(WARNING) << "Invalid TF_HDFS_READ_AHEAD_BYTES: " << value;
+      bytes = kDefaultReadAheadBytes;
+    }
+    return bytes;
+  }();
+  return read_ahead_bytes;
+}
+
+thread::ThreadPool* AsyncReadThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "hdfs_async_read", kNumAsyncReadThreads);
+  return pool;
+}
+
+}  // namespace
+
 template <typename R, typename... Args>
 Status BindFunc(void* handle, const char* name,
                 std::function<R(Args...)>* func) {
@@ -58,6 +95,8 @@ class LibHDFS {
   std::function<hdfsFS(hdfsBuilder*)> hdfsBuilderConnect;
   std::function<hdfsBuilder*()> hdfsNewBuilder;
   std::function<void(hdfsBuilder*, const char*)> hdfsBuilderSetNameNode;
+  std::function<int(hdfsBuilder*, const char*, const char*)>
+      hdfsBuilderConfSetStr;
   std::function<int(const char*, char**)> hdfsConfGetStr;
   std::function<void(hdfsBuilder*, const char* kerbTicketCachePath)>
       hdfsBuilderSetKerbTicketCachePath;
@@ -86,6 +125,7 @@ class LibHDFS {
       BIND_HDFS_FUNC(hdfsBuilderConnect);
       BIND_HDFS_FUNC(hdfsNewBuilder);
       BIND_HDFS_FUNC(hdfsBuilderSetNameNode);
+      BIND_HDFS_FUNC(hdfsBuilderConfSetStr);
       BIND_HDFS_FUNC(hdfsConfGetStr);
       BIND_HDFS_FUNC(hdfsBuilderSetKerbTicketCachePath);
       BIND_HDFS_FUNC(hdfsCloseFile);
@@ -174,6 +214,16 @@ Status HadoopFileSystem::Connect(StringPiece fname, hdfsFS* fs) {
   if (ticket_cache_path != nullptr) {
     hdfs_->hdfsBuilderSetKerbTicketCachePath(builder, ticket_cache_path);
   }
+  // Blocks of datanodes on this host are read straight from their local files,
+  // passing the file descriptors over this domain socket, instead of being
+  // streamed through the datanode.
+  char* domain_socket_path = getenv("TF_HDFS_DOMAIN_SOCKET_PATH");
+  if (domain_socket_path != nullptr) {
+    hdfs_->hdfsBuilderConfSetStr(builder, "dfs.client.read.shortcircuit",
+                                 "true");
+    hdfs_->hdfsBuilderConfSetStr(builder, "dfs.domain.socket.path",
+                                 domain_socket_path);
+  }
   *fs = hdfs_->hdfsBuilderConnect(builder);
   if (*fs == nullptr) {
     return errors::NotFound(strerror(errno));
@@ -190,11 +240,13 @@ string HadoopFileSystem::TranslateName(const string& name) const {
 class HDFSRandomAccessFile : public RandomAccessFile {
  public:
   HDFSRandomAccessFile(const string& filename, const string& hdfs_filename,
-                       LibHDFS* hdfs, hdfsFS fs, hdfsFile file)
+                       LibHDFS* hdfs, hdfsFS fs, hdfsFile file,
+                       int64 read_ahead_bytes)
       : filename_(filename),
         hdfs_filename_(hdfs_filename),
         hdfs_(hdfs),
         fs_(fs),
+        read_ahead_bytes_(read_ahead_bytes),
         file_(file) {}
 
   ~HDFSRandomAccessFile() override {
@@ -206,15 +258,62 @@ class HDFSRandomAccessFile : public RandomAccessFile {
 
   Status Read(uint64 offset, size_t n, StringPiece* result,
               char* scratch) const override {
+    if (n >= read_ahead_bytes_) {
+      return ReadFromFile(offset, n, result, scratch);
+    }
+    mutex_lock lock(buffer_mu_);
+    if (offset < buffer_offset_ ||
+        offset + n > buffer_offset_ + buffer_.size()) {
+      buffer_.resize(read_ahead_bytes_);
+      StringPiece data;
+      Status s = ReadFromFile(offset, buffer_.size(), &data, &buffer_[0]);
+      if (!s.ok() && !errors::IsOutOfRange(s)) {
+        buffer_.clear();
+        return s;
+      }
+      buffer_.resize(data.size());
+      buffer_offset_ = offset;
+    }
+    const size_t available =
+        offset < buffer_offset_ + buffer_.size()
+            ? buffer_offset_ + buffer_.size() - offset
+            : 0;
+    const size_t copied = std::min(n, available);
+    if (copied > 0) {
+      memcpy(scratch, buffer_.data() + (offset - buffer_offset_), copied);
+    }
+    *result = StringPiece(scratch, copied);
+    if (copied < n) {
+      return Status(error::OUT_OF_RANGE, "Read less bytes than requested");
+    }
+    return Status::OK();
+  }
+
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadCallback done) const override {
+    AsyncReadThreadPool()->Schedule([this, offset, n, scratch, done]() {
+      StringPiece result;
+      Status s = Read(offset, n, &result, scratch);
+      done(s, result);
+    });
+  }
+
+ private:
+  // Reads straight from the file, without the read-ahead buffer.
+  Status ReadFromFile(uint64 offset, size_t n, StringPiece* result,
+                      char* scratch) const {
     Status s;
     char* dst = scratch;
     bool eof_retried = false;
     while (n > 0 && s.ok()) {
       // We lock inside the loop rather than outside so we don't block other
-      // concurrent readers.
-      mutex_lock lock(mu_);
-      tSize r = hdfs_->hdfsPread(fs_, file_, static_cast<tOffset>(offset), dst,
-                                 static_cast<tSize>(n));
+      // concurrent readers, which only share the lock for positional reads.
+      tSize r;
+      {
+        tf_shared_lock lock(mu_);
+        r = hdfs_->hdfsPread(fs_, file_, static_cast<tOffset>(offset), dst,
+                             static_cast<tSize>(n));
+      }
       if (r > 0) {
         dst += r;
         n -= r;
@@ -226,6 +325,7 @@ class HDFSRandomAccessFile : public RandomAccessFile {
         // contents.
         //
         // Fixes #5438
+        mutex_lock lock(mu_);
         if (file_ != nullptr && hdfs_->hdfsCloseFile(fs_, file_) != 0) {
           return IOError(filename_, errno);
         }
@@ -247,14 +347,19 @@ class HDFSRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
- private:
   string filename_;
   string hdfs_filename_;
   LibHDFS* hdfs_;
   hdfsFS fs_;
+  const size_t read_ahead_bytes_;
 
   mutable mutex mu_;
   mutable hdfsFile file_ GUARDED_BY(mu_);
+
+  // The data read ahead of small reads, which starts at buffer_offset_.
+  mutable mutex buffer_mu_;
+  mutable string buffer_ GUARDED_BY(buffer_mu_);
+  mutable uint64 buffer_offset_ GUARDED_BY(buffer_mu_) = 0;
 };
 
 Status HadoopFileSystem::NewRandomAccessFile(
@@ -267,8 +372,8 @@ Status HadoopFileSystem::NewRandomAccessFile(
   if (file == nullptr) {
     return IOError(fname, errno);
   }
-  result->reset(
-      new HDFSRandomAccessFile(fname, TranslateName(fname), hdfs_, fs, file));
+  result->reset(new HDFSRandomAccessFile(fname, TranslateName(fname), hdfs_,
+                                         fs, file, ReadAheadBytes()));
   return Status::OK();
 }
 
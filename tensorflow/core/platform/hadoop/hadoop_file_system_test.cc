@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/platform/hadoop/hadoop_file_system.h"
 
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -90,6 +91,36 @@ TEST_F(HadoopFileSystemTest, RandomAccessFile) {
   EXPECT_EQ(content.substr(2, 4), result);
 }
 
+TEST_F(HadoopFileSystemTest, SmallReads) {
+  // Small reads are served from the data read ahead of them.
+  const string fname = TmpDir("SmallReads");
+  const string content = "abcdefghijklmn";
+  TF_ASSERT_OK(WriteString(fname, content));
+
+  std::unique_ptr<RandomAccessFile> reader;
+  TF_EXPECT_OK(hdfs.NewRandomAccessFile(fname, &reader));
+
+  char scratch[4];
+  StringPiece result;
+  for (size_t offset = 0; offset + 4 <= content.size(); offset += 4) {
+    TF_EXPECT_OK(reader->Read(offset, 4, &result, scratch));
+    EXPECT_EQ(content.substr(offset, 4), result);
+  }
+  // Backwards, and past the end of the file.
+  TF_EXPECT_OK(reader->Read(1, 4, &result, scratch));
+  EXPECT_EQ(content.substr(1, 4), result);
+  EXPECT_EQ(error::OUT_OF_RANGE, reader->Read(12, 4, &result, scratch).code());
+  EXPECT_EQ(content.substr(12), result);
+
+  Notification done;
+  reader->ReadAsync(2, 4, scratch, [&](const Status& s, StringPiece data) {
+    TF_EXPECT_OK(s);
+    EXPECT_EQ(content.substr(2, 4), data);
+    done.Notify();
+  });
+  done.WaitForNotification();
+}
+
 TEST_F(HadoopFileSystemTest, WritableFile) {
   std::unique_ptr<WritableFile> writer;
   const string fname = TmpDir("WritableFile");
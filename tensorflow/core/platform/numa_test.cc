@@ -0,0 +1,68 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/numa.h"
+
+#include <string.h>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace internal {
+
+TEST(Numa, NumNodes) {
+  EXPECT_GE(port::NUMANumNodes(), 1);
+  EXPECT_EQ(port::NUMAEnabled(), port::NUMANumNodes() > 1);
+}
+
+TEST(Numa, Malloc) {
+  for (int node = 0; node < port::NUMANumNodes(); ++node) {
+    const size_t size = 1 << 20;
+    void* ptr = port::NUMAMalloc(node, size, 64);
+    ASSERT_NE(nullptr, ptr);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % 64);
+    memset(ptr, 0, size);
+    port::NUMAFree(ptr);
+  }
+}
+
+TEST(Numa, SetNodeAffinity) {
+  EXPECT_EQ(port::kNUMANoAffinity, port::NUMAGetThreadNodeAffinity());
+  if (port::NUMAEnabled()) {
+    int last_node = port::NUMANumNodes() - 1;
+    port::NUMASetThreadNodeAffinity(last_node);
+    EXPECT_EQ(last_node, port::NUMAGetThreadNodeAffinity());
+    port::NUMASetThreadNodeAffinity(port::kNUMANoAffinity);
+  }
+  EXPECT_EQ(port::kNUMANoAffinity, port::NUMAGetThreadNodeAffinity());
+}
+
+TEST(Numa, ThreadOptionsNodeAffinity) {
+  const int node = port::NUMAEnabled() ? port::NUMANumNodes() - 1
+                                       : port::kNUMANoAffinity;
+  ThreadOptions thread_options;
+  thread_options.numa_node = node;
+  int thread_node = -2;
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      thread_options, "numa_test",
+      [&thread_node] { thread_node = port::NUMAGetThreadNodeAffinity(); }));
+  thread.reset();
+  EXPECT_EQ(node, thread_node);
+}
+
+}  // namespace internal
+}  // namespace tensorflow
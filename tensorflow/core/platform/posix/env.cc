@@ -40,10 +40,16 @@ namespace {
 
 class StdThread : public Thread {
  public:
-  // name and thread_options are both ignored.
+  // name and thread_options (except numa_node) are ignored.
   StdThread(const ThreadOptions& thread_options, const string& name,
             std::function<void()> fn)
-      : thread_(fn) {}
+      : thread_(thread_options.numa_node == port::kNUMANoAffinity
+                    ? std::thread(fn)
+                    : std::thread([thread_options, fn] {
+                        port::NUMASetThreadNodeAffinity(
+                            thread_options.numa_node);
+                        fn();
+                      })) {}
   ~StdThread() override { thread_.join(); }
 
  private:
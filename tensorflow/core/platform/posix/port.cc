@@ -24,12 +24,16 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/types.h"
 
 #if defined(__linux__) && !defined(__ANDROID__)
+#include <errno.h>
 #include <sched.h>
+#include <sys/syscall.h>
 #include <sys/sysinfo.h>
+#include <vector>
 #endif
 #include <stdio.h>
 #include <stdlib.h>
@@ -177,6 +181,149 @@ double NominalCPUFrequency() {
 #endif
 }
 
+#if defined(__linux__) && !defined(__ANDROID__)
+namespace {
+
+struct NUMATopology {
+  // System node ids and CPUs of the nodes that have CPUs, in id order.
+  std::vector<int> node_ids;
+  std::vector<cpu_set_t> node_cpus;
+  // CPUs the process could run on at startup.
+  cpu_set_t all_cpus;
+};
+
+// Parses a sysfs CPU list such as "0-11,24-35" into 'cpus'.
+bool ParseCPUList(const char* list, cpu_set_t* cpus) {
+  CPU_ZERO(cpus);
+  const char* p = list;
+  while (*p != '\0' && *p != '\n') {
+    char* end;
+    const long first = strtol(p, &end, 10);
+    if (end == p) return false;
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      last = strtol(p + 1, &end, 10);
+      if (end == p + 1) return false;
+      p = end;
+    }
+    for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+      CPU_SET(cpu, cpus);
+    }
+    if (*p == ',') ++p;
+  }
+  return CPU_COUNT(cpus) > 0;
+}
+
+const NUMATopology& GetNUMATopology() {
+  static const NUMATopology* topology = [] {
+    NUMATopology* t = new NUMATopology;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &t->all_cpus) != 0) {
+      CPU_ZERO(&t->all_cpus);
+    }
+    // Node ids may be sparse; all of them are below the kernel's MAX_NUMNODES.
+    const int kMaxNodes = 1024;
+    for (int id = 0; id < kMaxNodes; ++id) {
+      char path[64];
+      snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+               id);
+      FILE* f = fopen(path, "r");
+      if (f == nullptr) continue;
+      char list[4096];
+      cpu_set_t cpus;
+      if (fgets(list, sizeof(list), f) != nullptr &&
+          ParseCPUList(list, &cpus)) {
+        t->node_ids.push_back(id);
+        t->node_cpus.push_back(cpus);
+      }
+      fclose(f);
+    }
+    return t;
+  }();
+  return *topology;
+}
+
+thread_local int thread_numa_node = kNUMANoAffinity;
+
+}  // namespace
+
+bool NUMAEnabled() { return NUMANumNodes() > 1; }
+
+int NUMANumNodes() {
+  const int num_nodes = GetNUMATopology().node_ids.size();
+  return num_nodes > 0 ? num_nodes : 1;
+}
+
+void NUMASetThreadNodeAffinity(int node) {
+  const NUMATopology& topology = GetNUMATopology();
+  if (!NUMAEnabled()) return;
+  cpu_set_t cpus = topology.all_cpus;
+  if (node != kNUMANoAffinity) {
+    if (node < 0 || node >= static_cast<int>(topology.node_cpus.size())) {
+      LOG(ERROR) << "NUMASetThreadNodeAffinity: invalid node " << node;
+      return;
+    }
+    CPU_AND(&cpus, &cpus, &topology.node_cpus[node]);
+    // Fall back to all of the node's CPUs if the process mask excludes them.
+    if (CPU_COUNT(&cpus) == 0) cpus = topology.node_cpus[node];
+  }
+  if (sched_setaffinity(0, sizeof(cpu_set_t), &cpus) != 0) {
+    LOG(ERROR) << "NUMASetThreadNodeAffinity: sched_setaffinity failed: "
+               << strerror(errno);
+    return;
+  }
+  thread_numa_node = node;
+}
+
+int NUMAGetThreadNodeAffinity() { return thread_numa_node; }
+
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+  void* ptr = AlignedMalloc(size, minimum_alignment);
+#ifdef __NR_mbind
+  const NUMATopology& topology = GetNUMATopology();
+  if (ptr == nullptr || !NUMAEnabled() || node < 0 ||
+      node >= static_cast<int>(topology.node_ids.size())) {
+    return ptr;
+  }
+  // Prefer the node for the whole pages of the block. Partial pages at the
+  // edges are shared with neighbouring allocations and keep first-touch
+  // placement.
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  const uintptr_t begin =
+      (reinterpret_cast<uintptr_t>(ptr) + page_size - 1) & ~(page_size - 1);
+  const uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + size) &
+                        ~(page_size - 1);
+  if (begin < end) {
+    const int kMPolPreferred = 1;
+    const size_t kBitsPerLong = 8 * sizeof(unsigned long);
+    const int node_id = topology.node_ids[node];
+    std::vector<unsigned long> node_mask(node_id / kBitsPerLong + 1, 0);
+    node_mask.back() |= 1UL << (node_id % kBitsPerLong);
+    // Best effort: on failure the pages are placed by first touch.
+    syscall(__NR_mbind, begin, end - begin, kMPolPreferred, node_mask.data(),
+            node_mask.size() * kBitsPerLong + 1, 0);
+  }
+#endif
+  return ptr;
+}
+
+void NUMAFree(void* ptr) { AlignedFree(ptr); }
+#else
+bool NUMAEnabled() { return false; }
+
+int NUMANumNodes() { return 1; }
+
+void NUMASetThreadNodeAffinity(int node) {}
+
+int NUMAGetThreadNodeAffinity() { return kNUMANoAffinity; }
+
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+  return AlignedMalloc(size, minimum_alignment);
+}
+
+void NUMAFree(void* ptr) { AlignedFree(ptr); }
+#endif  // defined(__linux__) && !defined(__ANDROID__)
+
 int64 AvailableRam() {
 #if defined(__linux__) && !defined(__ANDROID__)
   struct sysinfo info;
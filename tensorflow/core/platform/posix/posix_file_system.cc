@@ -29,6 +29,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system_helper.h"
@@ -41,6 +42,16 @@ namespace tensorflow {
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+// The number of threads that run asynchronous reads. They spend their time
+// blocked on I/O, so there are enough of them to keep a fast local disk busy.
+constexpr int kNumAsyncReadThreads = 16;
+
+thread::ThreadPool* AsyncReadThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "posix_async_read", kNumAsyncReadThreads);
+  return pool;
+}
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -73,6 +84,28 @@ class PosixRandomAccessFile : public RandomAccessFile {
     *result = StringPiece(scratch, dst - scratch);
     return s;
   }
+
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadCallback done) const override {
+    AsyncReadThreadPool()->Schedule([this, offset, n, scratch, done]() {
+      StringPiece result;
+      Status s = Read(offset, n, &result, scratch);
+      done(s, result);
+    });
+  }
+
+  void DropCachedData(uint64 offset, size_t n) const override {
+#ifdef POSIX_FADV_DONTNEED
+    // A length of 0 would drop the data up to the end of the file.
+    if (n == 0) return;
+    // Only whole pages are dropped, so the range starts at the page that
+    // holds `offset`, which sequential reads are done with.
+    const uint64 page_size = getpagesize();
+    const uint64 start = offset - offset % page_size;
+    posix_fadvise(fd_, static_cast<off_t>(start),
+                  static_cast<off_t>(offset + n - start), POSIX_FADV_DONTNEED);
+#endif
+  }
 };
 
 class PosixWritableFile : public WritableFile {
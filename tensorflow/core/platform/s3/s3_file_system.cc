@@ -13,8 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/platform/s3/s3_file_system.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/s3/aws_logging.h"
@@ -29,15 +31,23 @@ limitations under the License.
 #include <aws/core/utils/StringUtils.h>
 #include <aws/s3/S3Client.h>
 #include <aws/s3/S3Errors.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/CompletedMultipartUpload.h>
+#include <aws/s3/model/CompletedPart.h>
 #include <aws/s3/model/CopyObjectRequest.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
 #include <aws/s3/model/DeleteObjectRequest.h>
 #include <aws/s3/model/GetObjectRequest.h>
 #include <aws/s3/model/HeadBucketRequest.h>
 #include <aws/s3/model/HeadObjectRequest.h>
 #include <aws/s3/model/ListObjectsRequest.h>
 #include <aws/s3/model/PutObjectRequest.h>
+#include <aws/s3/model/UploadPartRequest.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <fstream>
 
 namespace tensorflow {
 
@@ -45,6 +55,45 @@ namespace {
 static const char* kS3FileSystemAllocationTag = "S3FileSystemAllocation";
 static const size_t kS3ReadAppendableFileBufferSize = 1024 * 1024;
 static const int kS3GetChildrenMaxKeys = 100;
+// The size of the parts of multipart uploads, and of the ranges of large reads
+// that are downloaded in parallel. Multipart uploads require parts of at least
+// 5MB.
+static const char* kS3MultipartChunkSize = "S3_MULTIPART_CHUNK_SIZE_MB";
+static const int64 kS3DefaultMultipartChunkSize = 16 * 1024 * 1024;
+static const int64 kS3MinMultipartChunkSize = 5 * 1024 * 1024;
+// The number of parts or ranges transferred in parallel.
+static const char* kS3TransferParallelism = "S3_TRANSFER_PARALLELISM";
+static const int64 kS3DefaultTransferParallelism = 8;
+// The block cache of random access files, which is disabled by default (a
+// maximum size of 0), as S3 objects have no generation to validate the cached
+// blocks against. The block size and maximum size are specified in MB, and the
+// maximum staleness in seconds.
+static const char* kS3BlockSize = "S3_READ_CACHE_BLOCK_SIZE_MB";
+static const int64 kS3DefaultBlockSize = 16 * 1024 * 1024;
+static const char* kS3MaxCacheSize = "S3_READ_CACHE_MAX_SIZE_MB";
+static const char* kS3MaxStaleness = "S3_READ_CACHE_MAX_STALENESS";
+// The number of blocks the block cache fetches ahead of sequential reads.
+static const char* kS3ReadaheadBlocks = "S3_READ_CACHE_READAHEAD_BLOCKS";
+
+// Returns the value of the integer environment variable `name`, or
+// `default_value` if it is not set or not an integer.
+int64 GetEnvInt64(const char* name, int64 default_value) {
+  const char* env_value = getenv(name);
+  int64 value;
+  if (env_value && strings::safe_strto64(env_value, &value)) {
+    return value;
+  }
+  return default_value;
+}
+
+template <typename Outcome>
+Status OutcomeToStatus(const Outcome& outcome) {
+  if (outcome.IsSuccess()) {
+    return Status::OK();
+  }
+  return errors::Internal(outcome.GetError().GetExceptionName().c_str(), ": ",
+                          outcome.GetError().GetMessage().c_str());
+}
 
 Aws::Client::ClientConfiguration& GetDefaultClientConfig() {
   static mutex cfg_lock(LINKER_INITIALIZED);
@@ -165,49 +214,77 @@ Status ParseS3Path(const string& fname, bool empty_object_ok, string* bucket,
   return Status::OK();
 }
 
+// Reads the `n` bytes of the object at `offset` into `buffer`, with a single
+// request. Reading past the end of the object is not an error.
+Status ReadRange(Aws::S3::S3Client* s3_client, const string& bucket,
+                 const string& object, uint64 offset, size_t n, char* buffer,
+                 size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  Aws::S3::Model::GetObjectRequest getObjectRequest;
+  getObjectRequest.WithBucket(bucket.c_str()).WithKey(object.c_str());
+  string bytes = strings::StrCat("bytes=", offset, "-", offset + n - 1);
+  getObjectRequest.SetRange(bytes.c_str());
+  getObjectRequest.SetResponseStreamFactory([]() {
+    return Aws::New<Aws::StringStream>(kS3FileSystemAllocationTag);
+  });
+  auto getObjectOutcome = s3_client->GetObject(getObjectRequest);
+  if (!getObjectOutcome.IsSuccess()) {
+    if (getObjectOutcome.GetError().GetResponseCode() ==
+        Aws::Http::HttpResponseCode::REQUESTED_RANGE_NOT_SATISFIABLE) {
+      return Status::OK();
+    }
+    return OutcomeToStatus(getObjectOutcome);
+  }
+  *bytes_transferred = std::min<size_t>(
+      n, getObjectOutcome.GetResult().GetContentLength());
+  getObjectOutcome.GetResult().GetBody().read(buffer, *bytes_transferred);
+  return Status::OK();
+}
+
 class S3RandomAccessFile : public RandomAccessFile {
  public:
-  S3RandomAccessFile(const string& bucket, const string& object,
-                     std::shared_ptr<Aws::S3::S3Client> s3_client)
-      : bucket_(bucket), object_(object), s3_client_(s3_client) {}
+  typedef std::function<Status(const string& filename, uint64 offset, size_t n,
+                               char* buffer, size_t* bytes_transferred)>
+      ReadFn;
+
+  S3RandomAccessFile(const string& filename, ReadFn read_fn)
+      : filename_(filename), read_fn_(std::move(read_fn)) {}
 
   Status Read(uint64 offset, size_t n, StringPiece* result,
               char* scratch) const override {
-    Aws::S3::Model::GetObjectRequest getObjectRequest;
-    getObjectRequest.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
-    string bytes = strings::StrCat("bytes=", offset, "-", offset + n - 1);
-    getObjectRequest.SetRange(bytes.c_str());
-    getObjectRequest.SetResponseStreamFactory([]() {
-      return Aws::New<Aws::StringStream>(kS3FileSystemAllocationTag);
-    });
-    auto getObjectOutcome = this->s3_client_->GetObject(getObjectRequest);
-    if (!getObjectOutcome.IsSuccess()) {
-      n = 0;
-      *result = StringPiece(scratch, n);
-      return Status(error::OUT_OF_RANGE, "Read less bytes than requested");
-    }
-    n = getObjectOutcome.GetResult().GetContentLength();
-    std::stringstream ss;
-    ss << getObjectOutcome.GetResult().GetBody().rdbuf();
-    ss.read(scratch, n);
-
-    *result = StringPiece(scratch, n);
+    *result = StringPiece();
+    size_t bytes_transferred;
+    TF_RETURN_IF_ERROR(
+        read_fn_(filename_, offset, n, scratch, &bytes_transferred));
+    *result = StringPiece(scratch, bytes_transferred);
+    if (bytes_transferred < n) {
+      return errors::OutOfRange("EOF reached, ", bytes_transferred,
+                                " bytes were read out of ", n,
+                                " bytes requested.");
+    }
     return Status::OK();
   }
 
  private:
-  string bucket_;
-  string object_;
-  std::shared_ptr<Aws::S3::S3Client> s3_client_;
+  const string filename_;
+  const ReadFn read_fn_;
 };
 
+// Writable files are buffered in a temporary file, and uploaded in parts of
+// `multipart_chunk_size` bytes in parallel on `executor` if they are larger
+// than that.
 class S3WritableFile : public WritableFile {
  public:
   S3WritableFile(const string& bucket, const string& object,
-                 std::shared_ptr<Aws::S3::S3Client> s3_client)
+                 std::shared_ptr<Aws::S3::S3Client> s3_client,
+                 thread::ThreadPool* executor, int64 multipart_chunk_size,
+                 std::function<void()> file_cache_erase)
       : bucket_(bucket),
         object_(object),
         s3_client_(s3_client),
+        executor_(executor),
+        multipart_chunk_size_(multipart_chunk_size),
+        file_cache_erase_(std::move(file_cache_erase)),
         sync_needed_(true),
         outfile_(Aws::MakeShared<Aws::Utils::TempFile>(
             kS3FileSystemAllocationTag, "/tmp/s3_filesystem_XXXXXX",
@@ -246,28 +323,124 @@ class S3WritableFile : public WritableFile {
     if (!sync_needed_) {
       return Status::OK();
     }
-    Aws::S3::Model::PutObjectRequest putObjectRequest;
-    putObjectRequest.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
     long offset = outfile_->tellp();
-    outfile_->seekg(0);
-    putObjectRequest.SetBody(outfile_);
-    putObjectRequest.SetContentLength(offset);
-    auto putObjectOutcome = this->s3_client_->PutObject(putObjectRequest);
-    outfile_->clear();
-    outfile_->seekp(offset);
-    if (!putObjectOutcome.IsSuccess()) {
-      string error = strings::StrCat(
-          putObjectOutcome.GetError().GetExceptionName().c_str(), ": ",
-          putObjectOutcome.GetError().GetMessage().c_str());
-      return errors::Internal(error);
+    Status status;
+    if (offset > multipart_chunk_size_) {
+      outfile_->flush();
+      if (!outfile_->good()) {
+        return errors::Internal(
+            "Could not write to the internal temporary file.");
+      }
+      status = MultipartUpload(offset);
+    } else {
+      Aws::S3::Model::PutObjectRequest putObjectRequest;
+      putObjectRequest.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
+      outfile_->seekg(0);
+      putObjectRequest.SetBody(outfile_);
+      putObjectRequest.SetContentLength(offset);
+      status = OutcomeToStatus(this->s3_client_->PutObject(putObjectRequest));
+      outfile_->clear();
+      outfile_->seekp(offset);
     }
+    TF_RETURN_IF_ERROR(status);
+    file_cache_erase_();
+    sync_needed_ = false;
     return Status::OK();
   }
 
  private:
+  // Uploads the first `size` bytes of the temporary file as the parts of a
+  // multipart upload, in parallel.
+  Status MultipartUpload(int64 size) {
+    Aws::S3::Model::CreateMultipartUploadRequest createRequest;
+    createRequest.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
+    auto createOutcome = this->s3_client_->CreateMultipartUpload(createRequest);
+    TF_RETURN_IF_ERROR(OutcomeToStatus(createOutcome));
+    const Aws::String upload_id = createOutcome.GetResult().GetUploadId();
+
+    const int num_parts =
+        (size + multipart_chunk_size_ - 1) / multipart_chunk_size_;
+    std::vector<Aws::String> etags(num_parts);
+    std::vector<Status> statuses(num_parts);
+    BlockingCounter counter(num_parts);
+    for (int i = 0; i < num_parts; ++i) {
+      executor_->Schedule([this, i, size, &upload_id, &etags, &statuses,
+                           &counter]() {
+        const int64 offset = i * multipart_chunk_size_;
+        statuses[i] =
+            UploadPart(upload_id, i + 1, offset,
+                       std::min(multipart_chunk_size_, size - offset),
+                       &etags[i]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    Status status;
+    for (const Status& part_status : statuses) {
+      status.Update(part_status);
+    }
+
+    if (status.ok()) {
+      Aws::S3::Model::CompletedMultipartUpload completedUpload;
+      for (int i = 0; i < num_parts; ++i) {
+        completedUpload.AddParts(Aws::S3::Model::CompletedPart()
+                                     .WithETag(etags[i])
+                                     .WithPartNumber(i + 1));
+      }
+      Aws::S3::Model::CompleteMultipartUploadRequest completeRequest;
+      completeRequest.WithBucket(bucket_.c_str())
+          .WithKey(object_.c_str())
+          .WithUploadId(upload_id)
+          .WithMultipartUpload(completedUpload);
+      status = OutcomeToStatus(
+          this->s3_client_->CompleteMultipartUpload(completeRequest));
+    }
+    if (!status.ok()) {
+      // Abort the upload so that S3 does not keep the uploaded parts.
+      Aws::S3::Model::AbortMultipartUploadRequest abortRequest;
+      abortRequest.WithBucket(bucket_.c_str())
+          .WithKey(object_.c_str())
+          .WithUploadId(upload_id);
+      this->s3_client_->AbortMultipartUpload(abortRequest);
+    }
+    return status;
+  }
+
+  // Uploads the `size` bytes of the temporary file at `offset` as the part
+  // `part_number` of the multipart upload `upload_id`.
+  Status UploadPart(const Aws::String& upload_id, int part_number,
+                    int64 offset, int64 size, Aws::String* etag) {
+    // Each part reads its own stream of the temporary file, so that parts can
+    // be read in parallel.
+    std::ifstream file(outfile_->GetFileName().c_str(), std::ios_base::binary);
+    file.seekg(offset);
+    std::vector<char> data(size);
+    if (!file.read(data.data(), size)) {
+      return errors::Internal(
+          "Could not read the internal temporary file.");
+    }
+    auto body = Aws::MakeShared<Aws::StringStream>(kS3FileSystemAllocationTag);
+    body->write(data.data(), size);
+
+    Aws::S3::Model::UploadPartRequest uploadPartRequest;
+    uploadPartRequest.WithBucket(bucket_.c_str())
+        .WithKey(object_.c_str())
+        .WithUploadId(upload_id)
+        .WithPartNumber(part_number);
+    uploadPartRequest.SetBody(body);
+    uploadPartRequest.SetContentLength(size);
+    auto uploadPartOutcome = this->s3_client_->UploadPart(uploadPartRequest);
+    TF_RETURN_IF_ERROR(OutcomeToStatus(uploadPartOutcome));
+    *etag = uploadPartOutcome.GetResult().GetETag();
+    return Status::OK();
+  }
+
   string bucket_;
   string object_;
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
+  thread::ThreadPool* executor_;  // Not owned.
+  const int64 multipart_chunk_size_;
+  std::function<void()> file_cache_erase_;
   bool sync_needed_;
   std::shared_ptr<Aws::Utils::TempFile> outfile_;
 };
@@ -287,7 +460,29 @@ class S3ReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
 }  // namespace
 
 S3FileSystem::S3FileSystem()
-    : s3_client_(nullptr, ShutdownClient), client_lock_() {}
+    : s3_client_(nullptr, ShutdownClient), client_lock_() {
+  multipart_chunk_size_ =
+      std::max(GetEnvInt64(kS3MultipartChunkSize,
+                           kS3DefaultMultipartChunkSize / (1024 * 1024)) *
+                   1024 * 1024,
+               kS3MinMultipartChunkSize);
+  transfer_parallelism_ = std::max<int64>(
+      GetEnvInt64(kS3TransferParallelism, kS3DefaultTransferParallelism), 1);
+  const int64 block_size =
+      GetEnvInt64(kS3BlockSize, kS3DefaultBlockSize / (1024 * 1024)) * 1024 *
+      1024;
+  const int64 max_bytes = GetEnvInt64(kS3MaxCacheSize, 0) * 1024 * 1024;
+  const int64 max_staleness = GetEnvInt64(kS3MaxStaleness, 0);
+  const int64 readahead_blocks = GetEnvInt64(kS3ReadaheadBlocks, 0);
+  file_block_cache_.reset(new RamFileBlockCache(
+      block_size, max_bytes, max_staleness,
+      [this](const string& filename, size_t offset, size_t n, char* buffer,
+             size_t* bytes_transferred) {
+        return LoadBufferFromS3(filename, offset, n, buffer,
+                                bytes_transferred);
+      },
+      Env::Default(), readahead_blocks));
+}
 
 S3FileSystem::~S3FileSystem() {}
 
@@ -321,11 +516,69 @@ std::shared_ptr<Aws::S3::S3Client> S3FileSystem::GetS3Client() {
   return this->s3_client_;
 }
 
+thread::ThreadPool* S3FileSystem::GetExecutor() {
+  mutex_lock lock(this->executor_lock_);
+  if (this->executor_ == nullptr) {
+    this->executor_.reset(
+        new thread::ThreadPool(Env::Default(), "s3_transfer",
+                               static_cast<int>(transfer_parallelism_)));
+  }
+  return this->executor_.get();
+}
+
+Status S3FileSystem::LoadBufferFromS3(const string& fname, uint64 offset,
+                                      size_t n, char* buffer,
+                                      size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
+  std::shared_ptr<Aws::S3::S3Client> s3_client = this->GetS3Client();
+  if (n <= static_cast<size_t>(multipart_chunk_size_)) {
+    return ReadRange(s3_client.get(), bucket, object, offset, n, buffer,
+                     bytes_transferred);
+  }
+
+  // Large reads are downloaded as ranges of multipart_chunk_size_ bytes, in
+  // parallel.
+  const size_t num_ranges =
+      (n + multipart_chunk_size_ - 1) / multipart_chunk_size_;
+  std::vector<size_t> range_bytes(num_ranges);
+  std::vector<Status> statuses(num_ranges);
+  BlockingCounter counter(num_ranges);
+  thread::ThreadPool* executor = GetExecutor();
+  for (size_t i = 0; i < num_ranges; ++i) {
+    executor->Schedule([this, i, n, offset, buffer, &s3_client, &bucket,
+                        &object, &range_bytes, &statuses, &counter]() {
+      const size_t range_offset = i * multipart_chunk_size_;
+      statuses[i] = ReadRange(
+          s3_client.get(), bucket, object, offset + range_offset,
+          std::min<size_t>(multipart_chunk_size_, n - range_offset),
+          buffer + range_offset, &range_bytes[i]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (size_t i = 0; i < num_ranges; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+  }
+  // The bytes read end at the first range cut short by the end of the object.
+  for (size_t i = 0; i < num_ranges; ++i) {
+    *bytes_transferred += range_bytes[i];
+    if (range_bytes[i] < static_cast<size_t>(multipart_chunk_size_)) break;
+  }
+  return Status::OK();
+}
+
 Status S3FileSystem::NewRandomAccessFile(
     const string& fname, std::unique_ptr<RandomAccessFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3RandomAccessFile(bucket, object, this->GetS3Client()));
+  result->reset(new S3RandomAccessFile(
+      fname, [this](const string& fname, uint64 offset, size_t n,
+                    char* buffer, size_t* bytes_transferred) {
+        return file_block_cache_->Read(fname, offset, n, buffer,
+                                       bytes_transferred);
+      }));
   return Status::OK();
 }
 
@@ -333,7 +586,10 @@ Status S3FileSystem::NewWritableFile(const string& fname,
                                      std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3WritableFile(bucket, object, this->GetS3Client()));
+  result->reset(new S3WritableFile(
+      bucket, object, this->GetS3Client(), GetExecutor(),
+      multipart_chunk_size_,
+      [this, fname]() { file_block_cache_->RemoveFile(fname); }));
   return Status::OK();
 }
 
@@ -348,7 +604,10 @@ Status S3FileSystem::NewAppendableFile(const string& fname,
 
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3WritableFile(bucket, object, this->GetS3Client()));
+  result->reset(new S3WritableFile(
+      bucket, object, this->GetS3Client(), GetExecutor(),
+      multipart_chunk_size_,
+      [this, fname]() { file_block_cache_->RemoveFile(fname); }));
 
   while (true) {
     status = reader->Read(offset, kS3ReadAppendableFileBufferSize, &read_chunk,
@@ -518,6 +777,7 @@ Status S3FileSystem::DeleteFile(const string& fname) {
         deleteObjectOutcome.GetError().GetMessage().c_str());
     return errors::Internal(error);
   }
+  file_block_cache_->RemoveFile(fname);
   return Status::OK();
 }
 
@@ -641,6 +901,9 @@ Status S3FileSystem::RenameFile(const string& src, const string& target) {
         return errors::Internal(error);
       }
 
+      file_block_cache_->RemoveFile(
+          strings::StrCat("s3://", target_bucket, "/", target_key.c_str()));
+
       deleteObjectRequest.SetBucket(src_bucket.c_str());
       deleteObjectRequest.SetKey(src_key.c_str());
 
@@ -652,6 +915,8 @@ Status S3FileSystem::RenameFile(const string& src, const string& target) {
             deleteObjectOutcome.GetError().GetMessage().c_str());
         return errors::Internal(error);
       }
+      file_block_cache_->RemoveFile(
+          strings::StrCat("s3://", src_bucket, "/", src_key.c_str()));
     }
     listObjectsRequest.SetMarker(listObjectsResult.GetNextMarker());
   } while (listObjectsResult.GetIsTruncated());
@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CONTRIB_S3_S3_FILE_SYSTEM_H_
 
 #include <aws/s3/S3Client.h>
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 
@@ -75,9 +77,30 @@ class S3FileSystem : public FileSystem {
   // for a bucket.
   std::shared_ptr<Aws::S3::S3Client> GetS3Client();
 
+  // Returns the pool running the parts of multipart uploads and the ranges of
+  // large reads, initializing it as-needed.
+  thread::ThreadPool* GetExecutor();
+
+  // Reads `n` bytes of `fname` at `offset`, downloading the ranges of large
+  // reads in parallel. This is the block fetcher of file_block_cache_.
+  Status LoadBufferFromS3(const string& fname, uint64 offset, size_t n,
+                          char* buffer, size_t* bytes_transferred);
+
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
   // Lock held when checking for s3_client_ initialization.
   mutex client_lock_;
+
+  std::unique_ptr<thread::ThreadPool> executor_;
+  // Lock held when checking for executor_ initialization.
+  mutex executor_lock_;
+
+  // The size of the parts of multipart uploads and of the ranges of large
+  // reads, and the number of them transferred in parallel.
+  int64 multipart_chunk_size_;
+  int64 transfer_parallelism_;
+
+  // The block cache of the contents of random access files.
+  std::unique_ptr<FileBlockCache> file_block_cache_;
 };
 
 }  // namespace tensorflow
@@ -15,9 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/util/batch_util.h"
 
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <utility>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/env_var.h"
 
 #define TF_CALL_DATASET_TYPES(m) TF_CALL_ALL_TYPES(m) TF_CALL_QUANTIZED_TYPES(m)
 
@@ -283,5 +294,144 @@ Status SetElementZero(Tensor* element, const Tensor& padding) {
                                element->dtype());
 }
 
+class BatchBufferPool::FreeList : public core::RefCounted {
+ public:
+  explicit FreeList(int64 capacity) : capacity_(capacity) {}
+
+  ~FreeList() override {
+    for (const Block& block : blocks_) {
+      block.allocator->DeallocateRaw(block.data);
+    }
+  }
+
+  // Removes and returns a free buffer matching the arguments, or nullptr.
+  void* Take(Allocator* allocator, DataType dtype, const TensorShape& shape) {
+    mutex_lock l(mu_);
+    // The most recently released buffer is the likeliest to be in cache.
+    for (auto it = blocks_.rbegin(); it != blocks_.rend(); ++it) {
+      if (it->allocator == allocator && it->dtype == dtype &&
+          it->shape == shape) {
+        void* data = it->data;
+        blocks_.erase(std::next(it).base());
+        return data;
+      }
+    }
+    return nullptr;
+  }
+
+  // Keeps a released buffer, freeing the oldest one if the list is full.
+  void Return(Allocator* allocator, DataType dtype, const TensorShape& shape,
+              void* data) {
+    Block evicted{nullptr, DT_INVALID, TensorShape(), nullptr};
+    {
+      mutex_lock l(mu_);
+      if (closed_) {
+        evicted = Block{allocator, dtype, shape, data};
+      } else {
+        if (blocks_.size() >= static_cast<size_t>(capacity_)) {
+          evicted = std::move(blocks_.front());
+          blocks_.pop_front();
+        }
+        blocks_.push_back(Block{allocator, dtype, shape, data});
+      }
+    }
+    if (evicted.data != nullptr) {
+      evicted.allocator->DeallocateRaw(evicted.data);
+    }
+  }
+
+  // Frees the buffers that are released from now on.
+  void Close() {
+    mutex_lock l(mu_);
+    closed_ = true;
+  }
+
+ private:
+  struct Block {
+    Allocator* allocator;
+    DataType dtype;
+    TensorShape shape;
+    void* data;
+  };
+
+  const int64 capacity_;
+  mutex mu_;
+  std::deque<Block> blocks_ GUARDED_BY(mu_);
+  bool closed_ GUARDED_BY(mu_) = false;
+};
+
+class BatchBufferPool::Buffer : public TensorBuffer {
+ public:
+  Buffer(FreeList* free_list, Allocator* allocator, DataType dtype,
+         const TensorShape& shape, void* data, size_t size)
+      : free_list_(free_list),
+        allocator_(allocator),
+        dtype_(dtype),
+        shape_(shape),
+        data_(data),
+        size_(size) {
+    free_list_->Ref();
+  }
+
+  ~Buffer() override {
+    free_list_->Return(allocator_, dtype_, shape_, data_);
+    free_list_->Unref();
+  }
+
+  void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(allocator_->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data_));
+  }
+
+ private:
+  FreeList* const free_list_;
+  Allocator* const allocator_;
+  const DataType dtype_;
+  const TensorShape shape_;
+  void* const data_;
+  const size_t size_;
+};
+
+BatchBufferPool::BatchBufferPool(int64 capacity)
+    : capacity_(capacity), free_list_(new FreeList(capacity)) {}
+
+BatchBufferPool::~BatchBufferPool() {
+  free_list_->Close();
+  free_list_->Unref();
+}
+
+int64 BatchBufferPool::DefaultCapacity() {
+  static const int64 capacity = [] {
+    int64 value = 0;
+    Status s =
+        ReadInt64FromEnvVar("TF_DATA_BATCH_BUFFER_POOL_SIZE", 0, &value);
+    if (!s.ok()) LOG(ERROR) << s.error_message();
+    return std::max<int64>(0, value);
+  }();
+  return capacity;
+}
+
+Tensor BatchBufferPool::Get(Allocator* allocator, DataType dtype,
+                            const TensorShape& shape) {
+  if (capacity_ == 0 || !DataTypeCanUseMemcpy(dtype) ||
+      shape.num_elements() == 0) {
+    return Tensor(allocator, dtype, shape);
+  }
+  const size_t size = shape.num_elements() * DataTypeSize(dtype);
+  void* data = free_list_->Take(allocator, dtype, shape);
+  if (data == nullptr) {
+    data = allocator->AllocateRaw(Allocator::kAllocatorAlignment, size);
+    if (data == nullptr) return Tensor(allocator, dtype, shape);
+  }
+  Buffer* buf = new Buffer(free_list_, allocator, dtype, shape, data, size);
+  Tensor t(dtype, shape, buf);
+  buf->Unref();
+  return t;
+}
+
 }  // namespace batch_util
 }  // namespace tensorflow
@@ -48,6 +48,46 @@ Status SetElementZero(Tensor* element, const Tensor& padding);
 Status CopyElementToLargerSlice(const Tensor& element, Tensor* parent,
                                 int index);
 
+// A small pool of batch tensors for batching iterators. The buffer of a
+// tensor returned by Get() goes back to the pool when its last reference is
+// dropped, so that a steady stream of same-shaped batches reuses a few warm
+// buffers instead of allocating a new one per batch. The pool holds no
+// reference to the buffers it hands out, so kernels may still forward them.
+//
+// Only types that can be memcpy-ed are pooled; others are always allocated.
+//
+// BatchBufferPool is thread safe.
+class BatchBufferPool {
+ public:
+  // Keeps at most "capacity" free buffers. With a capacity of 0, Get()
+  // always allocates.
+  explicit BatchBufferPool(int64 capacity);
+
+  // Buffers still in use are freed when released.
+  ~BatchBufferPool();
+
+  // The capacity for batching iterators: TF_DATA_BATCH_BUFFER_POOL_SIZE, or
+  // 0 if unset.
+  static int64 DefaultCapacity();
+
+  // Returns an uninitialized tensor of "dtype" and "shape", reusing a free
+  // buffer allocated by "allocator" for the same type and shape if there is
+  // one.
+  Tensor Get(Allocator* allocator, DataType dtype, const TensorShape& shape);
+
+ private:
+  // The free buffers, shared with the buffers in use.
+  class FreeList;
+  // The TensorBuffer of a pooled tensor, which returns its memory to the free
+  // list when released.
+  class Buffer;
+
+  const int64 capacity_;
+  FreeList* const free_list_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BatchBufferPool);
+};
+
 }  // namespace batch_util
 }  // namespace tensorflow
 
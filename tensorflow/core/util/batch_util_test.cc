@@ -0,0 +1,104 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/batch_util.h"
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace batch_util {
+namespace {
+
+TEST(BatchBufferPoolTest, ReusesReleasedBuffers) {
+  BatchBufferPool pool(2);
+  const TensorShape shape({4, 3});
+  const void* first;
+  {
+    Tensor t = pool.Get(cpu_allocator(), DT_FLOAT, shape);
+    first = t.tensor_data().data();
+    // Still referenced, so a second request gets a different buffer.
+    Tensor u = pool.Get(cpu_allocator(), DT_FLOAT, shape);
+    EXPECT_NE(first, u.tensor_data().data());
+  }
+  Tensor t = pool.Get(cpu_allocator(), DT_FLOAT, shape);
+  EXPECT_EQ(first, t.tensor_data().data());
+  // A slice keeps the buffer alive.
+  Tensor slice = t.Slice(0, 1);
+  t = Tensor();
+  Tensor v = pool.Get(cpu_allocator(), DT_FLOAT, shape);
+  EXPECT_NE(first, v.tensor_data().data());
+}
+
+TEST(BatchBufferPoolTest, DoesNotReferenceBuffersInUse) {
+  BatchBufferPool pool(2);
+  // Kernels can forward the buffer of the only reference to a tensor.
+  Tensor t = pool.Get(cpu_allocator(), DT_FLOAT, TensorShape({4, 3}));
+  EXPECT_TRUE(DMAHelper::buffer(&t)->RefCountIsOne());
+}
+
+TEST(BatchBufferPoolTest, KeepsCapacityFreeBuffers) {
+  BatchBufferPool pool(1);
+  const TensorShape shape({16});
+  Tensor t = pool.Get(cpu_allocator(), DT_INT64, shape);
+  Tensor u = pool.Get(cpu_allocator(), DT_INT64, shape);
+  const void* last = u.tensor_data().data();
+  t = Tensor();
+  // Releasing a buffer to a full pool frees the oldest free buffer.
+  u = Tensor();
+  EXPECT_EQ(last, pool.Get(cpu_allocator(), DT_INT64, shape)
+                      .tensor_data()
+                      .data());
+}
+
+TEST(BatchBufferPoolTest, BuffersOutliveThePool) {
+  Tensor t;
+  {
+    BatchBufferPool pool(2);
+    t = pool.Get(cpu_allocator(), DT_FLOAT, TensorShape({8}));
+  }
+  t.flat<float>().setConstant(1.0f);
+  EXPECT_EQ(1.0f, t.flat<float>()(7));
+}
+
+TEST(BatchBufferPoolTest, MatchesTypeAndShape) {
+  BatchBufferPool pool(4);
+  const void* floats = pool.Get(cpu_allocator(), DT_FLOAT, TensorShape({8}))
+                           .tensor_data()
+                           .data();
+  EXPECT_NE(floats, pool.Get(cpu_allocator(), DT_INT32, TensorShape({8}))
+                        .tensor_data()
+                        .data());
+  EXPECT_NE(floats, pool.Get(cpu_allocator(), DT_FLOAT, TensorShape({2, 4}))
+                        .tensor_data()
+                        .data());
+  EXPECT_EQ(floats, pool.Get(cpu_allocator(), DT_FLOAT, TensorShape({8}))
+                        .tensor_data()
+                        .data());
+}
+
+TEST(BatchBufferPoolTest, StringsAreNotPooled) {
+  BatchBufferPool pool(2);
+  Tensor s = pool.Get(cpu_allocator(), DT_STRING, TensorShape({2}));
+  s.flat<string>()(0) = "hello";
+  s = Tensor();
+  Tensor s2 = pool.Get(cpu_allocator(), DT_STRING, TensorShape({2}));
+  EXPECT_EQ("", s2.flat<string>()(0));
+}
+
+}  // namespace
+}  // namespace batch_util
+}  // namespace tensorflow
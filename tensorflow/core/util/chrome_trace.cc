@@ -0,0 +1,124 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/chrome_trace.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns "s" as a JSON string literal.
+string JsonString(const string& s) {
+  string out = "\"";
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        out.append("\\\"");
+        break;
+      case '\\':
+        out.append("\\\\");
+        break;
+      case '\n':
+        out.append("\\n");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          strings::Appendf(&out, "\\u%04x", c);
+        } else {
+          out.push_back(c);
+        }
+    }
+  }
+  out.push_back('"');
+  return out;
+}
+
+}  // namespace
+
+string StepStatsToChromeTrace(const StepStats& step_stats) {
+  int64 origin_us = std::numeric_limits<int64>::max();
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      origin_us = std::min(origin_us, node_stats.all_start_micros());
+    }
+  }
+
+  std::vector<string> events;
+  for (int pid = 0; pid < step_stats.dev_stats_size(); ++pid) {
+    const DeviceStepStats& dev_stats = step_stats.dev_stats(pid);
+    events.push_back(strings::StrCat(
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":", pid,
+        ",\"args\":{\"name\":", JsonString(dev_stats.device()), "}}"));
+
+    // Lays out the events of the device in start order, each on the first
+    // thread that is free when it starts.
+    std::vector<const NodeExecStats*> nodes;
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      nodes.push_back(&node_stats);
+    }
+    std::stable_sort(nodes.begin(), nodes.end(),
+                     [](const NodeExecStats* a, const NodeExecStats* b) {
+                       return a->all_start_micros() < b->all_start_micros();
+                     });
+    std::vector<int64> thread_end_us;
+    for (const NodeExecStats* node_stats : nodes) {
+      const int64 start_us = node_stats->all_start_micros() - origin_us;
+      const int64 duration_us =
+          std::max<int64>(node_stats->all_end_rel_micros(), 0);
+      size_t tid = 0;
+      while (tid < thread_end_us.size() && thread_end_us[tid] > start_us) {
+        ++tid;
+      }
+      if (tid == thread_end_us.size()) thread_end_us.push_back(0);
+      thread_end_us[tid] = start_us + duration_us;
+
+      string args = strings::StrCat("\"name\":",
+                                    JsonString(node_stats->node_name()));
+      if (!node_stats->timeline_label().empty()) {
+        strings::StrAppend(&args, ",\"label\":",
+                           JsonString(node_stats->timeline_label()));
+      }
+      events.push_back(strings::StrCat(
+          "{\"name\":", JsonString(node_stats->node_name()),
+          ",\"ph\":\"X\",\"pid\":", pid, ",\"tid\":", tid,
+          ",\"ts\":", start_us, ",\"dur\":", duration_us, ",\"args\":{", args,
+          "}}"));
+    }
+  }
+  return strings::StrCat("{\"traceEvents\":[\n",
+                         str_util::Join(events, ",\n"), "\n]}\n");
+}
+
+Status MaybeWriteChromeTrace(Env* env, const StepStats& step_stats,
+                             int64 step_id) {
+  string dir;
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar("TF_CHROME_TRACE_DIR", "", &dir));
+  if (dir.empty()) return Status::OK();
+  return WriteStringToFile(
+      env, io::JoinPath(dir, strings::StrCat("trace_", step_id, ".json")),
+      StepStatsToChromeTrace(step_stats));
+}
+
+}  // namespace tensorflow
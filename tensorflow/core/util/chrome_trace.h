@@ -0,0 +1,41 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_CHROME_TRACE_H_
+#define TENSORFLOW_CORE_UTIL_CHROME_TRACE_H_
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Returns the events of "step_stats" in the Chrome trace event format, which
+// chrome://tracing and Perfetto display. Each device of the step, e.g. the
+// devices of every worker, the GPU streams and the host activities, becomes
+// a process of the trace; overlapping events of a device are laid out on
+// separate threads. Timestamps are relative to the earliest event.
+string StepStatsToChromeTrace(const StepStats& step_stats);
+
+// If the environment variable TF_CHROME_TRACE_DIR names a directory, writes
+// the Chrome trace of "step_stats" to "<dir>/trace_<step_id>.json" in it.
+// Sessions call this with the stats of the steps that they trace.
+Status MaybeWriteChromeTrace(Env* env, const StepStats& step_stats,
+                             int64 step_id);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_CHROME_TRACE_H_
@@ -0,0 +1,93 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/chrome_trace.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+void AddNode(DeviceStepStats* dev_stats, const string& name, int64 start_us,
+             int64 duration_us) {
+  NodeExecStats* node_stats = dev_stats->add_node_stats();
+  node_stats->set_node_name(name);
+  node_stats->set_all_start_micros(start_us);
+  node_stats->set_all_end_rel_micros(duration_us);
+}
+
+StepStats TestStepStats() {
+  StepStats step_stats;
+  DeviceStepStats* cpu = step_stats.add_dev_stats();
+  cpu->set_device("/job:worker/replica:0/task:0/device:CPU:0");
+  AddNode(cpu, "a", 1000, 10);
+  AddNode(cpu, "b", 1005, 10);
+  AddNode(cpu, "c", 1020, 5);
+  DeviceStepStats* rpc = step_stats.add_dev_stats();
+  rpc->set_device("/rpc");
+  AddNode(rpc, "RecvTensor \"x\"", 1002, 3);
+  return step_stats;
+}
+
+TEST(ChromeTraceTest, Events) {
+  const string trace = StepStatsToChromeTrace(TestStepStats());
+  EXPECT_TRUE(str_util::StartsWith(trace, "{\"traceEvents\":["));
+  EXPECT_TRUE(str_util::StrContains(
+      trace,
+      "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+      "\"args\":{\"name\":\"/job:worker/replica:0/task:0/device:CPU:0\"}}"));
+  EXPECT_TRUE(str_util::StrContains(
+      trace,
+      "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+      "\"args\":{\"name\":\"/rpc\"}}"));
+  // "b" overlaps "a", so it goes on another thread; "c" starts after both.
+  EXPECT_TRUE(str_util::StrContains(
+      trace, "{\"name\":\"a\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":0,"
+             "\"dur\":10,"));
+  EXPECT_TRUE(str_util::StrContains(
+      trace, "{\"name\":\"b\",\"ph\":\"X\",\"pid\":0,\"tid\":1,\"ts\":5,"
+             "\"dur\":10,"));
+  EXPECT_TRUE(str_util::StrContains(
+      trace, "{\"name\":\"c\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":20,"
+             "\"dur\":5,"));
+  EXPECT_TRUE(str_util::StrContains(
+      trace, "{\"name\":\"RecvTensor \\\"x\\\"\",\"ph\":\"X\",\"pid\":1,"
+             "\"tid\":0,\"ts\":2,\"dur\":3,"));
+}
+
+TEST(ChromeTraceTest, MaybeWrite) {
+  Env* env = Env::Default();
+  const string dir = io::JoinPath(testing::TmpDir(), "chrome_trace");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(dir));
+
+  unsetenv("TF_CHROME_TRACE_DIR");
+  TF_ASSERT_OK(MaybeWriteChromeTrace(env, TestStepStats(), 7));
+  EXPECT_FALSE(env->FileExists(io::JoinPath(dir, "trace_7.json")).ok());
+
+  setenv("TF_CHROME_TRACE_DIR", dir.c_str(), 1);
+  TF_ASSERT_OK(MaybeWriteChromeTrace(env, TestStepStats(), 7));
+  unsetenv("TF_CHROME_TRACE_DIR");
+  string contents;
+  TF_ASSERT_OK(
+      ReadFileToString(env, io::JoinPath(dir, "trace_7.json"), &contents));
+  EXPECT_EQ(StepStatsToChromeTrace(TestStepStats()), contents);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,241 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/csv_parsing.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace csv {
+
+namespace {
+
+constexpr uint64 kLowBits = 0x0101010101010101ULL;
+constexpr uint64 kHighBits = 0x8080808080808080ULL;
+
+// Returns whether any of the bytes of word is zero.
+inline bool HasZeroByte(uint64 word) {
+  return ((word - kLowBits) & ~word & kHighBits) != 0;
+}
+
+string RecordSuffix(int64 record_index) {
+  return record_index >= 0 ? strings::StrCat(" ", record_index) : string();
+}
+
+bool ParseValue(StringPiece field, int32* value) {
+  return strings::safe_strto32(field, value);
+}
+
+bool ParseValue(StringPiece field, int64* value) {
+  return strings::safe_strto64(field, value);
+}
+
+// safe_strtof and safe_strtod need a NUL-terminated string of less than
+// kFastToBufferSize characters, so copy the field to the stack rather than
+// to a temporary string.
+bool ParseValue(StringPiece field, float* value) {
+  char buffer[strings::kFastToBufferSize];
+  if (field.size() >= sizeof(buffer)) return false;
+  memcpy(buffer, field.data(), field.size());
+  buffer[field.size()] = '\0';
+  return strings::safe_strtof(buffer, value);
+}
+
+bool ParseValue(StringPiece field, double* value) {
+  char buffer[strings::kFastToBufferSize];
+  if (field.size() >= sizeof(buffer)) return false;
+  memcpy(buffer, field.data(), field.size());
+  buffer[field.size()] = '\0';
+  return strings::safe_strtod(buffer, value);
+}
+
+bool ParseValue(StringPiece field, string* value) {
+  value->assign(field.data(), field.size());
+  return true;
+}
+
+template <typename T>
+Status ConvertFieldTo(StringPiece field, const string& na_value,
+                      const Tensor& record_default, int64 field_index,
+                      int64 record_index, int64 index, Tensor* output) {
+  T* value = &output->flat<T>()(index);
+  // If this field is empty or NA value, check if default is given:
+  // If yes, use default value; Otherwise report error.
+  if (field.empty() || field == na_value) {
+    if (record_default.NumElements() != 1) {
+      return errors::InvalidArgument("Field ", field_index,
+                                     " is required but missing in record",
+                                     RecordSuffix(record_index), "!");
+    }
+    *value = record_default.flat<T>()(0);
+    return Status::OK();
+  }
+  if (!ParseValue(field, value)) {
+    return errors::InvalidArgument(
+        "Field ", field_index, " in record", RecordSuffix(record_index),
+        " is not a valid ", DataTypeString(DataTypeToEnum<T>::v()), ": ",
+        field);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+RecordParser::RecordParser(const ParseOptions& options) : options_(options) {
+  std::fill(is_special_, is_special_ + 256, false);
+  std::vector<char> special_chars = {options.field_delim, '\n', '\r'};
+  if (options.use_quote_delim) special_chars.push_back('"');
+  for (char c : special_chars) {
+    if (is_special_[static_cast<uint8>(c)]) continue;
+    is_special_[static_cast<uint8>(c)] = true;
+    special_words_.push_back(kLowBits * static_cast<uint8>(c));
+  }
+}
+
+const char* RecordParser::FindSpecialChar(const char* begin,
+                                          const char* end) const {
+  // Skip a word at a time until a word contains a special character; a byte
+  // of word ^ special_word is zero where word holds that special character.
+  const char* pos = begin;
+  while (end - pos >= static_cast<ptrdiff_t>(sizeof(uint64))) {
+    uint64 word;
+    memcpy(&word, pos, sizeof(word));
+    bool found = false;
+    for (uint64 special_word : special_words_) {
+      found |= HasZeroByte(word ^ special_word);
+    }
+    if (found) break;
+    pos += sizeof(word);
+  }
+  while (pos < end && !is_special_[static_cast<uint8>(*pos)]) ++pos;
+  return pos;
+}
+
+Status RecordParser::Parse(StringPiece record) {
+  record_ = record;
+  fields_.clear();
+  unescaped_.clear();
+  ended_inside_quotes_ = false;
+  if (record.empty()) return Status::OK();
+
+  const char delim = options_.field_delim;
+  const std::vector<int64>& select_cols = options_.select_cols;
+  const bool select_all_cols = select_cols.empty();
+  const char* const begin = record.data();
+  const char* const end = begin + record.size();
+  const char* pos = begin;
+  int64 num_fields_parsed = 0;
+  size_t selector_idx = 0;  // Keep track of index into select_cols
+
+  while (pos < end) {
+    if (*pos == '\n' || *pos == '\r') {
+      ++pos;
+      continue;
+    }
+
+    const bool include =
+        select_all_cols || select_cols[selector_idx] == num_fields_parsed;
+    Field field = {static_cast<size_t>(pos - begin), 0, false};
+    if (!options_.use_quote_delim || *pos != '"') {
+      const char* field_end = FindSpecialChar(pos, end);
+      if (field_end < end && *field_end != delim) {
+        return errors::InvalidArgument(
+            "Unquoted fields cannot have quotes/CRLFs inside");
+      }
+      field.size = field_end - pos;
+      // Go to next field or the end
+      pos = field_end == end ? end : field_end + 1;
+    } else {
+      // Quoted field needs to be ended with '"' and delim or end. Escaped
+      // quotes are the only reason to copy a field, so find the quotes with
+      // memchr and copy the text between them in one go.
+      ++pos;
+      field.offset = pos - begin;
+      const size_t unescaped_start = unescaped_.size();
+      const char* chunk = pos;
+      while (true) {
+        const char* quote =
+            static_cast<const char*>(memchr(pos, '"', end - pos));
+        if (quote == nullptr) {
+          ended_inside_quotes_ = true;
+          return errors::InvalidArgument(
+              "Quoted field has to end with quote followed by delim or end");
+        }
+        if (quote == end - 1 || quote[1] == delim) {
+          if (field.unescaped) {
+            if (include) unescaped_.append(chunk, quote - chunk);
+            field.offset = unescaped_start;
+            field.size = unescaped_.size() - unescaped_start;
+          } else {
+            field.size = quote - chunk;
+          }
+          pos = quote == end - 1 ? end : quote + 2;
+          break;
+        }
+        if (quote[1] != '"') {
+          return errors::InvalidArgument(
+              "Quote inside a string has to be escaped by another quote");
+        }
+        // Keep the first of the two quotes.
+        if (include) unescaped_.append(chunk, quote + 1 - chunk);
+        field.unescaped = true;
+        pos = chunk = quote + 2;
+      }
+    }
+
+    num_fields_parsed++;
+    if (include) {
+      fields_.push_back(field);
+      selector_idx++;
+      if (selector_idx == select_cols.size()) return Status::OK();
+    }
+  }
+
+  // Check if the last field is missing
+  const bool include =
+      select_all_cols || select_cols[selector_idx] == num_fields_parsed;
+  if (include && end[-1] == delim) fields_.push_back({0, 0, false});
+  return Status::OK();
+}
+
+Status ConvertField(StringPiece field, const string& na_value,
+                    const Tensor& record_default, int64 field_index,
+                    int64 record_index, int64 index, Tensor* output) {
+  switch (output->dtype()) {
+#define CONVERT_FIELD(T)                                                       \
+  case DataTypeToEnum<T>::value:                                               \
+    return ConvertFieldTo<T>(field, na_value, record_default, field_index, \
+                             record_index, index, output);
+    CONVERT_FIELD(int32)
+    CONVERT_FIELD(int64)
+    CONVERT_FIELD(float)
+    CONVERT_FIELD(double)
+    CONVERT_FIELD(string)
+#undef CONVERT_FIELD
+    default:
+      return errors::InvalidArgument("csv: data type ", output->dtype(),
+                                     " not supported in field ", field_index);
+  }
+}
+
+}  // namespace csv
+}  // namespace tensorflow
@@ -0,0 +1,106 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_CSV_PARSING_H_
+#define TENSORFLOW_CORE_UTIL_CSV_PARSING_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace csv {
+
+// ParseOptions defines how the records of a CSV source are split into fields.
+// Documentation is available in: tensorflow/core/ops/parsing_ops.cc
+struct ParseOptions {
+  char field_delim = ',';
+  bool use_quote_delim = true;
+  // The strictly increasing indices of the fields to extract. If empty, all
+  // fields are extracted.
+  std::vector<int64> select_cols;
+  string na_value;
+};
+
+// Splits CSV records into their fields. The parser keeps its buffers between
+// records, so a single parser should be reused for many records; it is not
+// thread-safe.
+class RecordParser {
+ public:
+  // options must outlive the parser.
+  explicit RecordParser(const ParseOptions& options);
+
+  // Splits record into the fields selected by the options. On success the
+  // fields are available from num_fields() and field() until the next call.
+  Status Parse(StringPiece record);
+
+  // Returns whether the last Parse failed because a quoted field was not
+  // terminated before the end of the record. This is the case when a quoted
+  // field contains a line break and record only holds the first line.
+  bool ended_inside_quotes() const { return ended_inside_quotes_; }
+
+  int num_fields() const { return fields_.size(); }
+
+  // Returns field i of the last parsed record. Quoted fields are returned
+  // without their quotes and with escaped quotes unescaped.
+  StringPiece field(int i) const {
+    const Field& f = fields_[i];
+    return StringPiece(f.unescaped ? unescaped_.data() + f.offset
+                                   : record_.data() + f.offset,
+                       f.size);
+  }
+
+ private:
+  // Where a field is, either in the record or in unescaped_. Offsets rather
+  // than pointers keep the fields valid when unescaped_ grows.
+  struct Field {
+    size_t offset;
+    size_t size;
+    bool unescaped;
+  };
+
+  // Returns the first character in [begin, end) that cannot be part of an
+  // unquoted field, or end.
+  const char* FindSpecialChar(const char* begin, const char* end) const;
+
+  const ParseOptions& options_;
+  // The characters that end or invalidate an unquoted field, and the same
+  // bytes broadcast to all the bytes of a word.
+  bool is_special_[256];
+  std::vector<uint64> special_words_;
+
+  StringPiece record_;
+  std::vector<Field> fields_;
+  string unescaped_;
+  bool ended_inside_quotes_ = false;
+};
+
+// Converts field to the type of output and stores it at element index of
+// output. Empty fields and fields equal to na_value take the value of
+// record_default instead, which is an error if record_default is empty.
+// field_index and record_index identify the field in error messages;
+// record_index is omitted from them if negative.
+Status ConvertField(StringPiece field, const string& na_value,
+                    const Tensor& record_default, int64 field_index,
+                    int64 record_index, int64 index, Tensor* output);
+
+}  // namespace csv
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_CSV_PARSING_H_
@@ -0,0 +1,111 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/csv_parsing.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace csv {
+namespace {
+
+std::vector<string> Fields(const RecordParser& parser) {
+  std::vector<string> fields;
+  for (int i = 0; i < parser.num_fields(); ++i) {
+    fields.push_back(parser.field(i).ToString());
+  }
+  return fields;
+}
+
+TEST(RecordParserTest, SplitsUnquotedFields) {
+  ParseOptions options;
+  RecordParser parser(options);
+  TF_ASSERT_OK(parser.Parse("1,a long field that spans words,,3.5,"));
+  EXPECT_EQ(std::vector<string>(
+                {"1", "a long field that spans words", "", "3.5", ""}),
+            Fields(parser));
+
+  TF_ASSERT_OK(parser.Parse(""));
+  EXPECT_EQ(0, parser.num_fields());
+
+  options.field_delim = '|';
+  RecordParser pipe_parser(options);
+  TF_ASSERT_OK(pipe_parser.Parse("a,b|c"));
+  EXPECT_EQ(std::vector<string>({"a,b", "c"}), Fields(pipe_parser));
+}
+
+TEST(RecordParserTest, UnescapesQuotedFields) {
+  ParseOptions options;
+  RecordParser parser(options);
+  TF_ASSERT_OK(
+      parser.Parse("\"plain\",\"with, delim\",\"with \"\"quotes\"\"\",\"\""));
+  EXPECT_EQ(std::vector<string>(
+                {"plain", "with, delim", "with \"quotes\"", ""}),
+            Fields(parser));
+
+  options.use_quote_delim = false;
+  RecordParser unquoted_parser(options);
+  TF_ASSERT_OK(unquoted_parser.Parse("\"a\",b\""));
+  EXPECT_EQ(std::vector<string>({"\"a\"", "b\""}), Fields(unquoted_parser));
+}
+
+TEST(RecordParserTest, SelectsColumns) {
+  ParseOptions options;
+  options.select_cols = {1, 3};
+  RecordParser parser(options);
+  TF_ASSERT_OK(parser.Parse("0,\"1\",\"2\"\"\",3,4"));
+  EXPECT_EQ(std::vector<string>({"1", "3"}), Fields(parser));
+}
+
+TEST(RecordParserTest, ReportsMalformedRecords) {
+  ParseOptions options;
+  RecordParser parser(options);
+  EXPECT_TRUE(str_util::StrContains(parser.Parse("a\"b").error_message(),
+                                    "Unquoted fields cannot have quotes"));
+  EXPECT_FALSE(parser.ended_inside_quotes());
+  EXPECT_TRUE(str_util::StrContains(parser.Parse("\"a\"b").error_message(),
+                                    "has to be escaped by another quote"));
+  EXPECT_FALSE(parser.ended_inside_quotes());
+  EXPECT_TRUE(str_util::StrContains(parser.Parse("1,\"a").error_message(),
+                                    "Quoted field has to end with quote"));
+  EXPECT_TRUE(parser.ended_inside_quotes());
+  TF_EXPECT_OK(parser.Parse("1,\"a\nb\""));
+  EXPECT_FALSE(parser.ended_inside_quotes());
+}
+
+TEST(ConvertFieldTest, ConvertsAndUsesDefaults) {
+  Tensor output(DT_FLOAT, TensorShape({3}));
+  Tensor record_default = test::AsTensor<float>({-1.0});
+  Tensor no_default(DT_FLOAT, TensorShape({0}));
+  TF_ASSERT_OK(ConvertField("1.5", "NA", no_default, 0, 0, 0, &output));
+  TF_ASSERT_OK(ConvertField("", "NA", record_default, 0, 1, 1, &output));
+  TF_ASSERT_OK(ConvertField("NA", "NA", record_default, 0, 2, 2, &output));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({1.5, -1.0, -1.0}),
+                                 output);
+
+  Status s = ConvertField("", "", no_default, 2, 7, 0, &output);
+  EXPECT_EQ("Field 2 is required but missing in record 7!",
+            s.error_message());
+  Tensor int_output(DT_INT32, TensorShape({1}));
+  s = ConvertField("12a", "", no_default, 1, -1, 0, &int_output);
+  EXPECT_EQ("Field 1 in record is not a valid int32: 12a", s.error_message());
+}
+
+}  // namespace
+}  // namespace csv
+}  // namespace tensorflow
@@ -340,6 +340,77 @@ bool ParseExample(StringPiece serialized, parsed::Example* example) {
   return ParseExample(&stream, example);
 }
 
+namespace parsed {
+
+// A FeatureLists map entry. The FeatureList is kept serialized, so that only
+// the requested feature lists are ever parsed.
+using FeatureListMapEntry = std::pair<StringPiece, StringPiece>;
+using FeatureLists = std::vector<FeatureListMapEntry>;
+
+}  // namespace parsed
+
+bool ParseFeatureLists(protobuf::io::CodedInputStream* stream,
+                       parsed::FeatureLists* feature_lists) {
+  DCHECK(stream != nullptr);
+  DCHECK(feature_lists != nullptr);
+  uint32 length;
+  if (!stream->ReadVarint32(&length)) return false;
+  auto limit = stream->PushLimit(length);
+  while (!stream->ExpectAtEnd()) {
+    if (!stream->ExpectTag(kDelimitedTag(1))) return false;
+    uint32 entry_length;
+    if (!stream->ReadVarint32(&entry_length)) return false;
+    auto entry_limit = stream->PushLimit(entry_length);
+    parsed::FeatureListMapEntry feature_list_map_entry;
+    if (!stream->ExpectTag(kDelimitedTag(1))) return false;
+    if (!ParseString(stream, &feature_list_map_entry.first)) return false;
+    if (!stream->ExpectTag(kDelimitedTag(2))) return false;
+    if (!ParseString(stream, &feature_list_map_entry.second)) return false;
+    if (!stream->ExpectAtEnd()) return false;
+    stream->PopLimit(entry_limit);
+    feature_lists->push_back(feature_list_map_entry);
+  }
+  stream->PopLimit(limit);
+  return true;
+}
+
+// Splits a serialized SequenceExample into its context features and its
+// (still serialized) feature lists. Like ParseExample, accepts concatenated
+// SequenceExamples, in which case later entries win.
+bool ParseSequenceExample(StringPiece serialized, parsed::Example* context,
+                          parsed::FeatureLists* feature_lists) {
+  DCHECK(context != nullptr);
+  DCHECK(feature_lists != nullptr);
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  EnableAliasing(&stream);
+  while (!stream.ExpectAtEnd()) {
+    if (stream.ExpectTag(kDelimitedTag(1))) {
+      if (!ParseFeatures(&stream, context)) return false;
+    } else if (stream.ExpectTag(kDelimitedTag(2))) {
+      if (!ParseFeatureLists(&stream, feature_lists)) return false;
+    } else if (!SkipExtraneousTag(&stream)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ParseFeatureList(StringPiece serialized,
+                      std::vector<parsed::Feature>* features) {
+  DCHECK(features != nullptr);
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  EnableAliasing(&stream);
+  while (!stream.ExpectAtEnd()) {
+    if (!stream.ExpectTag(kDelimitedTag(1))) return false;
+    StringPiece feature;
+    if (!ParseString(&stream, &feature)) return false;
+    features->emplace_back(feature);
+  }
+  return true;
+}
+
 }  // namespace
 
 bool TestFastParse(const string& serialized, Example* example) {
@@ -793,6 +864,37 @@ Status CheckConfigDataType(DataType dtype) {
   }
 }
 
+// Fills 'config_index' (already sized for all features of 'config') with
+// the position and type of every feature, keyed by 'hasher' of its name. The
+// seed of 'hasher' is bumped until there are no collisions.
+Status BuildConfigIndex(
+    const Config& config, SeededHasher* hasher,
+    PresizedCuckooMap<std::pair<size_t, Type>>* config_index) {
+  const size_t config_size = config.dense.size() + config.sparse.size();
+  bool ok = false;
+  for (size_t i = 0; i < 1000; ++i) {
+    ok = true;
+    for (size_t d = 0; d < config.dense.size(); ++d) {
+      ok &= config_index->InsertUnique((*hasher)(config.dense[d].feature_name),
+                                       {d, Type::Dense});
+    }
+    for (size_t d = 0; d < config.sparse.size(); ++d) {
+      ok &= config_index->InsertUnique(
+          (*hasher)(config.sparse[d].feature_name), {d, Type::Sparse});
+    }
+    if (ok) break;
+    LOG(WARNING) << "Collision found. This should happen only if you have "
+                    "around 2^32 entries in your config.";
+    hasher->seed++;
+    config_index->Clear(config_size);
+  }
+  if (!ok) {
+    return errors::Internal(
+        "Could not avoid collision. This should not happen.");
+  }
+  return Status::OK();
+}
+
 template <typename T>
 const SmallVector<T>& GetListFromBuffer(const SparseBuffer& buffer);
 
@@ -877,30 +979,10 @@ Status FastParseExample(const Config& config,
     TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
   }
 
-  size_t config_size = config.dense.size() + config.sparse.size();
   SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
-  }
+  PresizedCuckooMap<std::pair<size_t, Type>> config_index(
+      config.dense.size() + config.sparse.size());
+  TF_RETURN_IF_ERROR(BuildConfigIndex(config, &hasher, &config_index));
 
   // Allocate dense output for fixed length dense values
   // (variable-length dense and sparse have to be buffered).
@@ -1139,30 +1221,10 @@ Status FastParseSingleExample(const Config& config, const string& serialized,
   }
 
   // TODO(mrry): Cache the construction of this map at Op construction time.
-  size_t config_size = config.dense.size() + config.sparse.size();
   SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
-  }
+  PresizedCuckooMap<std::pair<size_t, Type>> config_index(
+      config.dense.size() + config.sparse.size());
+  TF_RETURN_IF_ERROR(BuildConfigIndex(config, &hasher, &config_index));
 
   // Allocate dense output tensors.
   for (size_t d = 0; d < config.dense.size(); ++d) {
@@ -1455,5 +1517,395 @@ Status FastParseSingleExample(const Config& config, const string& serialized,
   return Status::OK();
 }
 
+namespace {
+
+// Returns the text form of a serialized Feature, for error messages only.
+string FeatureDebugString(StringPiece serialized) {
+  Feature feature;
+  if (!ParseProtoUnlimited(&feature, serialized.data(), serialized.size())) {
+    return "<unparseable>";
+  }
+  return ProtoDebugString(feature);
+}
+
+Status ParseFeatureDataType(const string& name, StringPiece key,
+                            parsed::Feature* feature, DataType* dtype) {
+  Status s = feature->ParseDataType(dtype);
+  if (!s.ok()) {
+    return errors::InvalidArgument("Name: ", name, ", Key: ", key, ".  ",
+                                   s.error_message());
+  }
+  return Status::OK();
+}
+
+Status SequenceParseError(const string& name, StringPiece key) {
+  return errors::InvalidArgument("Name: ", name, ", Key: ", key,
+                                 ".  Can't parse serialized SequenceExample.");
+}
+
+// Parses the values of 'feature', which must be of type 'dtype', into the
+// 'num_elements' elements of 'out' starting at 'offset'. Values beyond the
+// expected number are dropped but counted in '*num_values'.
+bool ParseDenseFeature(DataType dtype, size_t num_elements, size_t offset,
+                       parsed::Feature* feature, Tensor* out,
+                       int64* num_values) {
+  int64 end_distance = 0;
+  switch (dtype) {
+    case DT_INT64: {
+      LimitedArraySlice<int64> slice(out->flat<int64>().data() + offset,
+                                     num_elements);
+      if (!feature->ParseInt64List(&slice)) return false;
+      end_distance = slice.EndDistance();
+      break;
+    }
+    case DT_FLOAT: {
+      LimitedArraySlice<float> slice(out->flat<float>().data() + offset,
+                                     num_elements);
+      if (!feature->ParseFloatList(&slice)) return false;
+      end_distance = slice.EndDistance();
+      break;
+    }
+    case DT_STRING: {
+      LimitedArraySlice<string> slice(out->flat<string>().data() + offset,
+                                      num_elements);
+      if (!feature->ParseBytesList(&slice)) return false;
+      end_distance = slice.EndDistance();
+      break;
+    }
+    default:
+      LOG(FATAL) << "Should not happen.";
+  }
+  *num_values = static_cast<int64>(num_elements) - end_distance;
+  return true;
+}
+
+Status DenseSizeError(const string& name, StringPiece key, int64 index,
+                      DataType dtype, int64 num_values,
+                      const PartialTensorShape& shape) {
+  const char* type_name = dtype == DT_STRING ? "bytes" : dtype == DT_FLOAT
+                                                             ? "float"
+                                                             : "int64";
+  return errors::InvalidArgument(
+      "Name: ", name, ", Key: ", key, ", Index: ", index, ".  Number of ",
+      type_name, " values != expected.  values size: ", num_values,
+      " but output shape: ", shape.DebugString());
+}
+
+// Appends the values of 'feature', which must be of type 'dtype', to the
+// matching list of 'buffer'. Returns the number of values appended, or -1 if
+// the feature can't be parsed.
+int64 ParseSparseFeature(DataType dtype, parsed::Feature* feature,
+                         SparseBuffer* buffer) {
+  switch (dtype) {
+    case DT_INT64: {
+      const size_t size = buffer->int64_list.size();
+      if (!feature->ParseInt64List(&buffer->int64_list)) return -1;
+      return buffer->int64_list.size() - size;
+    }
+    case DT_FLOAT: {
+      const size_t size = buffer->float_list.size();
+      if (!feature->ParseFloatList(&buffer->float_list)) return -1;
+      return buffer->float_list.size() - size;
+    }
+    case DT_STRING: {
+      const size_t size = buffer->bytes_list.size();
+      if (!feature->ParseBytesList(&buffer->bytes_list)) return -1;
+      return buffer->bytes_list.size() - size;
+    }
+    default:
+      LOG(FATAL) << "Should not happen.";
+  }
+  return -1;
+}
+
+void CopySparseBufferToTensor(DataType dtype, const SparseBuffer& buffer,
+                              Tensor* values) {
+  switch (dtype) {
+    case DT_INT64:
+      CopyOrMoveBlock(buffer.int64_list.begin(), buffer.int64_list.end(),
+                      values->flat<int64>().data());
+      break;
+    case DT_FLOAT:
+      CopyOrMoveBlock(buffer.float_list.begin(), buffer.float_list.end(),
+                      values->flat<float>().data());
+      break;
+    case DT_STRING:
+      CopyOrMoveBlock(buffer.bytes_list.begin(), buffer.bytes_list.end(),
+                      values->flat<string>().data());
+      break;
+    default:
+      LOG(FATAL) << "Should not happen.";
+  }
+}
+
+// Points '(*dense)[d]' and '(*sparse)[d]' at the last entry of 'entries'
+// named like the corresponding feature of 'config', or at nullptr if there
+// is none. Later entries overwrite earlier ones, as in protobuf parsing.
+template <typename Entry>
+void MatchConfig(const Config& config,
+                 const PresizedCuckooMap<std::pair<size_t, Type>>& config_index,
+                 SeededHasher hasher, std::vector<Entry>* entries,
+                 std::vector<Entry*>* dense, std::vector<Entry*>* sparse) {
+  dense->assign(config.dense.size(), nullptr);
+  sparse->assign(config.sparse.size(), nullptr);
+  for (size_t i = entries->size(); i > 0; --i) {
+    Entry& entry = (*entries)[i - 1];
+    std::pair<size_t, Type> d_and_type;
+    if (!config_index.Find(hasher(entry.first), &d_and_type)) continue;
+    const size_t d = d_and_type.first;
+    if (d_and_type.second == Type::Dense) {
+      if (entry.first != config.dense[d].feature_name) continue;
+      if ((*dense)[d] == nullptr) (*dense)[d] = &entry;
+    } else {
+      if (entry.first != config.sparse[d].feature_name) continue;
+      if ((*sparse)[d] == nullptr) (*sparse)[d] = &entry;
+    }
+  }
+}
+
+Status CheckSequenceConfig(const Config& config) {
+  for (auto& c : config.sparse) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+  }
+  for (auto& c : config.dense) {
+    TF_RETURN_IF_ERROR(CheckConfigDataType(c.dtype));
+    if (c.variable_length || !c.shape.IsFullyDefined()) {
+      return errors::InvalidArgument(
+          "Dense features of a SequenceExample must have a fixed shape, got ",
+          c.shape.DebugString(), " for feature ", c.feature_name);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status FastParseSingleSequenceExample(
+    const FastParseExampleConfig& context_config,
+    const FastParseExampleConfig& feature_list_config,
+    const std::unordered_set<string>& dense_feature_lists_missing_assumed_empty,
+    const string& serialized, const string& debug_name,
+    Result* context_result, Result* feature_list_result) {
+  DCHECK(context_result != nullptr);
+  DCHECK(feature_list_result != nullptr);
+  TF_RETURN_IF_ERROR(CheckSequenceConfig(context_config));
+  TF_RETURN_IF_ERROR(CheckSequenceConfig(feature_list_config));
+
+  SeededHasher context_hasher;
+  PresizedCuckooMap<std::pair<size_t, Type>> context_index(
+      context_config.dense.size() + context_config.sparse.size());
+  TF_RETURN_IF_ERROR(
+      BuildConfigIndex(context_config, &context_hasher, &context_index));
+  SeededHasher feature_list_hasher;
+  PresizedCuckooMap<std::pair<size_t, Type>> feature_list_index(
+      feature_list_config.dense.size() + feature_list_config.sparse.size());
+  TF_RETURN_IF_ERROR(BuildConfigIndex(feature_list_config,
+                                      &feature_list_hasher,
+                                      &feature_list_index));
+
+  parsed::Example context;
+  parsed::FeatureLists feature_lists;
+  if (!ParseSequenceExample(serialized, &context, &feature_lists)) {
+    return errors::InvalidArgument("Could not parse example input, value: '",
+                                   serialized, "'");
+  }
+  std::vector<parsed::FeatureMapEntry*> context_dense;
+  std::vector<parsed::FeatureMapEntry*> context_sparse;
+  MatchConfig(context_config, context_index, context_hasher, &context,
+              &context_dense, &context_sparse);
+  std::vector<parsed::FeatureListMapEntry*> feature_list_dense;
+  std::vector<parsed::FeatureListMapEntry*> feature_list_sparse;
+  MatchConfig(feature_list_config, feature_list_index, feature_list_hasher,
+              &feature_lists, &feature_list_dense, &feature_list_sparse);
+
+  // Context dense features.
+  for (size_t d = 0; d < context_config.dense.size(); ++d) {
+    const Config::Dense& c = context_config.dense[d];
+    if (context_dense[d] == nullptr) {
+      if (c.default_value.NumElements() == 0) {
+        return errors::InvalidArgument(
+            "Name: ", debug_name, ", Context feature '", c.feature_name,
+            "' is required but could not be found.");
+      }
+      context_result->dense_values.push_back(c.default_value);
+      continue;
+    }
+    parsed::Feature& feature = context_dense[d]->second;
+    const StringPiece serialized_feature = feature.GetSerialized();
+    DataType dtype;
+    TF_RETURN_IF_ERROR(
+        ParseFeatureDataType(debug_name, c.feature_name, &feature, &dtype));
+    if (dtype != c.dtype) {
+      return errors::InvalidArgument(
+          "Name: ", debug_name, ", Context feature: ", c.feature_name,
+          ".  Data types don't match. Expected type: ",
+          DataTypeString(c.dtype),
+          "  Feature is: ", FeatureDebugString(serialized_feature));
+    }
+    TensorShape shape;
+    c.shape.AsTensorShape(&shape);
+    Tensor out(c.dtype, shape);
+    int64 num_values;
+    if (!ParseDenseFeature(dtype, c.elements_per_stride, 0, &feature, &out,
+                           &num_values)) {
+      return SequenceParseError(debug_name, c.feature_name);
+    }
+    if (num_values != static_cast<int64>(c.elements_per_stride)) {
+      return DenseSizeError(debug_name, c.feature_name, 0, dtype, num_values,
+                            c.shape);
+    }
+    context_result->dense_values.push_back(std::move(out));
+  }
+
+  // Context sparse features: 1-D SparseTensors.
+  for (size_t d = 0; d < context_config.sparse.size(); ++d) {
+    const Config::Sparse& c = context_config.sparse[d];
+    SparseBuffer buffer;
+    int64 num_values = 0;
+    if (context_sparse[d] != nullptr) {
+      parsed::Feature& feature = context_sparse[d]->second;
+      const StringPiece serialized_feature = feature.GetSerialized();
+      DataType dtype;
+      TF_RETURN_IF_ERROR(
+          ParseFeatureDataType(debug_name, c.feature_name, &feature, &dtype));
+      if (dtype != DT_INVALID && dtype != c.dtype) {
+        return errors::InvalidArgument(
+            "Name: ", debug_name, ", Context feature: ", c.feature_name,
+            ".  Data types don't match. Expected type: ",
+            DataTypeString(c.dtype),
+            "  Feature is: ", FeatureDebugString(serialized_feature));
+      }
+      if (dtype != DT_INVALID) {
+        num_values = ParseSparseFeature(dtype, &feature, &buffer);
+        if (num_values < 0) {
+          return SequenceParseError(debug_name, c.feature_name);
+        }
+      }
+    }
+    Tensor indices(DT_INT64, TensorShape({num_values, 1}));
+    auto indices_flat = indices.flat<int64>();
+    for (int64 i = 0; i < num_values; ++i) {
+      indices_flat(i) = i;
+    }
+    Tensor values(c.dtype, TensorShape({num_values}));
+    CopySparseBufferToTensor(c.dtype, buffer, &values);
+    Tensor dense_shape(DT_INT64, TensorShape({1}));
+    dense_shape.vec<int64>()(0) = num_values;
+    context_result->sparse_indices.push_back(std::move(indices));
+    context_result->sparse_values.push_back(std::move(values));
+    context_result->sparse_shapes.push_back(std::move(dense_shape));
+  }
+
+  std::vector<parsed::Feature> steps;
+
+  // Feature list dense features: one row of the output per step.
+  for (size_t d = 0; d < feature_list_config.dense.size(); ++d) {
+    const Config::Dense& c = feature_list_config.dense[d];
+    steps.clear();
+    if (feature_list_dense[d] == nullptr) {
+      if (dense_feature_lists_missing_assumed_empty.count(c.feature_name) ==
+          0) {
+        return errors::InvalidArgument(
+            "Name: ", debug_name, ", Feature list '", c.feature_name,
+            "' is required but could not be found.  "
+            "Did you mean to include it in "
+            "feature_list_dense_missing_assumed_empty or "
+            "feature_list_dense_defaults?");
+      }
+    } else if (!ParseFeatureList(feature_list_dense[d]->second, &steps)) {
+      return SequenceParseError(debug_name, c.feature_name);
+    }
+    TensorShape shape({static_cast<int64>(steps.size())});
+    for (int i = 0; i < c.shape.dims(); ++i) {
+      shape.AddDim(c.shape.dim_size(i));
+    }
+    Tensor out(c.dtype, shape);
+    for (size_t t = 0; t < steps.size(); ++t) {
+      parsed::Feature& feature = steps[t];
+      const StringPiece serialized_feature = feature.GetSerialized();
+      DataType dtype;
+      TF_RETURN_IF_ERROR(
+          ParseFeatureDataType(debug_name, c.feature_name, &feature, &dtype));
+      if (dtype != c.dtype) {
+        return errors::InvalidArgument(
+            "Name: ", debug_name, ", Feature list: ", c.feature_name,
+            ", Index: ", t, ".  Data types don't match. Expected type: ",
+            DataTypeString(c.dtype),
+            "  Feature is: ", FeatureDebugString(serialized_feature));
+      }
+      int64 num_values;
+      if (!ParseDenseFeature(dtype, c.elements_per_stride,
+                             t * c.elements_per_stride, &feature, &out,
+                             &num_values)) {
+        return SequenceParseError(debug_name, c.feature_name);
+      }
+      if (num_values != static_cast<int64>(c.elements_per_stride)) {
+        return DenseSizeError(debug_name, c.feature_name, t, dtype,
+                              num_values, c.shape);
+      }
+    }
+    feature_list_result->dense_values.push_back(std::move(out));
+  }
+
+  // Feature list sparse features: 2-D SparseTensors indexed by
+  // [step, position in step].
+  for (size_t d = 0; d < feature_list_config.sparse.size(); ++d) {
+    const Config::Sparse& c = feature_list_config.sparse[d];
+    steps.clear();
+    if (feature_list_sparse[d] != nullptr &&
+        !ParseFeatureList(feature_list_sparse[d]->second, &steps)) {
+      return SequenceParseError(debug_name, c.feature_name);
+    }
+    SparseBuffer buffer;
+    int64 num_values = 0;
+    int64 max_num_values = 0;
+    for (size_t t = 0; t < steps.size(); ++t) {
+      parsed::Feature& feature = steps[t];
+      const StringPiece serialized_feature = feature.GetSerialized();
+      DataType dtype;
+      TF_RETURN_IF_ERROR(
+          ParseFeatureDataType(debug_name, c.feature_name, &feature, &dtype));
+      if (dtype != DT_INVALID && dtype != c.dtype) {
+        return errors::InvalidArgument(
+            "Name: ", debug_name, ", Feature List: ", c.feature_name,
+            ", Index: ", t, ".  Data types don't match. Expected type: ",
+            DataTypeString(c.dtype),
+            "  Feature is: ", FeatureDebugString(serialized_feature));
+      }
+      if (dtype != DT_INVALID) {
+        const int64 num_step_values =
+            ParseSparseFeature(dtype, &feature, &buffer);
+        if (num_step_values < 0) {
+          return SequenceParseError(debug_name, c.feature_name);
+        }
+        num_values += num_step_values;
+        max_num_values = std::max(max_num_values, num_step_values);
+      }
+      buffer.example_end_indices.push_back(num_values);
+    }
+    Tensor indices(DT_INT64, TensorShape({num_values, 2}));
+    auto indices_t = indices.matrix<int64>();
+    int64 begin = 0;
+    for (size_t t = 0; t < steps.size(); ++t) {
+      const int64 end = buffer.example_end_indices[t];
+      for (int64 i = begin; i < end; ++i) {
+        indices_t(i, 0) = t;
+        indices_t(i, 1) = i - begin;
+      }
+      begin = end;
+    }
+    Tensor values(c.dtype, TensorShape({num_values}));
+    CopySparseBufferToTensor(c.dtype, buffer, &values);
+    Tensor dense_shape(DT_INT64, TensorShape({2}));
+    dense_shape.vec<int64>()(0) = steps.size();
+    dense_shape.vec<int64>()(1) = max_num_values;
+    feature_list_result->sparse_indices.push_back(std::move(indices));
+    feature_list_result->sparse_values.push_back(std::move(values));
+    feature_list_result->sparse_shapes.push_back(std::move(dense_shape));
+  }
+
+  return Status::OK();
+}
+
 }  // namespace example
 }  // namespace tensorflow
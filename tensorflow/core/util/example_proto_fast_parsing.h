@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
@@ -85,6 +86,24 @@ typedef FastParseExampleConfig FastParseSingleExampleConfig;
 Status FastParseSingleExample(const FastParseSingleExampleConfig& config,
                               const string& serialized, Result* result);
 
+// Parses a single serialized SequenceExample with the same parser as
+// FastParseSingleExample, producing exactly the outputs of TF's
+// ParseSingleSequenceExample Op (documentation in
+// tensorflow/core/ops/parsing_ops.cc).
+// In both configs dense features must have a fixed shape; for
+// feature_list_config it is the shape of a single step, and the result gets
+// an extra leading dimension for the steps. Sparse feature lists produce 2-D
+// SparseTensors indexed by [step, position in step]. A missing dense feature
+// list is an error unless it is named in
+// dense_feature_lists_missing_assumed_empty, in which case it has no steps.
+// debug_name is used only for error messages.
+Status FastParseSingleSequenceExample(
+    const FastParseExampleConfig& context_config,
+    const FastParseExampleConfig& feature_list_config,
+    const std::unordered_set<string>& dense_feature_lists_missing_assumed_empty,
+    const string& serialized, const string& debug_name,
+    Result* context_result, Result* feature_list_result);
+
 // This function parses serialized Example and populates given example.
 // It uses the same specialized parser as FastParseExample which is efficient.
 // But then constructs Example which is relatively slow.
@@ -17,6 +17,9 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -346,6 +349,119 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+string SerializedSequenceExample() {
+  SequenceExample example;
+  auto& context = *example.mutable_context()->mutable_feature();
+  context["label"].mutable_int64_list()->add_value(7);
+  context["tags"].mutable_bytes_list()->add_value("a");
+  context["tags"].mutable_bytes_list()->add_value("b");
+  auto& lists = *example.mutable_feature_lists()->mutable_feature_list();
+  for (int t = 0; t < 3; ++t) {
+    auto* values = lists["frames"].add_feature()->mutable_float_list();
+    values->add_value(t);
+    values->add_value(10 * t);
+    auto* ids = lists["ids"].add_feature()->mutable_int64_list();
+    for (int i = 0; i < t; ++i) ids->add_value(100 * t + i);
+  }
+  return Serialize(example);
+}
+
+FastParseExampleConfig::Dense DenseConfig(const string& name, DataType dtype,
+                                          gtl::ArraySlice<int64> shape) {
+  const PartialTensorShape partial_shape(shape);
+  return {name, dtype, partial_shape, Tensor(), false,
+          static_cast<std::size_t>(partial_shape.num_elements())};
+}
+
+TEST(FastParseSingleSequenceExample, ContextAndFeatureLists) {
+  FastParseExampleConfig context_config;
+  context_config.dense.push_back(DenseConfig("label", DT_INT64, {1}));
+  context_config.sparse.push_back({"tags", DT_STRING});
+  context_config.sparse.push_back({"missing", DT_FLOAT});
+  FastParseExampleConfig feature_list_config;
+  feature_list_config.dense.push_back(DenseConfig("frames", DT_FLOAT, {2}));
+  feature_list_config.dense.push_back(DenseConfig("empty", DT_INT64, {}));
+  feature_list_config.sparse.push_back({"ids", DT_INT64});
+
+  Result context;
+  Result feature_lists;
+  TF_EXPECT_OK(FastParseSingleSequenceExample(
+      context_config, feature_list_config, {"empty"},
+      SerializedSequenceExample(), "in1", &context, &feature_lists));
+
+  test::ExpectTensorEqual<int64>(context.dense_values[0],
+                                 test::AsTensor<int64>({7}, {1}));
+  test::ExpectTensorEqual<string>(context.sparse_values[0],
+                                  test::AsTensor<string>({"a", "b"}));
+  test::ExpectTensorEqual<int64>(context.sparse_indices[0],
+                                 test::AsTensor<int64>({0, 1}, {2, 1}));
+  test::ExpectTensorEqual<int64>(context.sparse_shapes[0],
+                                 test::AsTensor<int64>({2}));
+  EXPECT_EQ(0, context.sparse_values[1].NumElements());
+  test::ExpectTensorEqual<int64>(context.sparse_shapes[1],
+                                 test::AsTensor<int64>({0}));
+
+  test::ExpectTensorEqual<float>(
+      feature_lists.dense_values[0],
+      test::AsTensor<float>({0, 0, 1, 10, 2, 20}, {3, 2}));
+  EXPECT_EQ(TensorShape({0}), feature_lists.dense_values[1].shape());
+  test::ExpectTensorEqual<int64>(feature_lists.sparse_values[0],
+                                 test::AsTensor<int64>({100, 200, 201}));
+  test::ExpectTensorEqual<int64>(
+      feature_lists.sparse_indices[0],
+      test::AsTensor<int64>({1, 0, 2, 0, 2, 1}, {3, 2}));
+  test::ExpectTensorEqual<int64>(feature_lists.sparse_shapes[0],
+                                 test::AsTensor<int64>({3, 2}));
+}
+
+TEST(FastParseSingleSequenceExample, Errors) {
+  const string serialized = SerializedSequenceExample();
+  FastParseExampleConfig empty_config;
+  Result context;
+  Result feature_lists;
+
+  FastParseExampleConfig required_context;
+  required_context.dense.push_back(DenseConfig("absent", DT_INT64, {1}));
+  Status s = FastParseSingleSequenceExample(required_context, empty_config, {},
+                                            serialized, "in1", &context,
+                                            &feature_lists);
+  EXPECT_TRUE(str_util::StrContains(
+      s.error_message(),
+      "Name: in1, Context feature 'absent' is required but could not be "
+      "found."))
+      << s;
+
+  FastParseExampleConfig missing_list;
+  missing_list.dense.push_back(DenseConfig("absent", DT_FLOAT, {2}));
+  s = FastParseSingleSequenceExample(empty_config, missing_list, {},
+                                     serialized, "in1", &context,
+                                     &feature_lists);
+  EXPECT_TRUE(str_util::StrContains(
+      s.error_message(),
+      "Name: in1, Feature list 'absent' is required but could not be found."))
+      << s;
+
+  FastParseExampleConfig wrong_type;
+  wrong_type.dense.push_back(DenseConfig("frames", DT_INT64, {2}));
+  s = FastParseSingleSequenceExample(empty_config, wrong_type, {}, serialized,
+                                     "in1", &context, &feature_lists);
+  EXPECT_TRUE(str_util::StrContains(
+      s.error_message(),
+      "Name: in1, Feature list: frames, Index: 0.  Data types don't match. "
+      "Expected type: int64  Feature is: float_list"))
+      << s;
+
+  FastParseExampleConfig wrong_shape;
+  wrong_shape.dense.push_back(DenseConfig("frames", DT_FLOAT, {3}));
+  s = FastParseSingleSequenceExample(empty_config, wrong_shape, {}, serialized,
+                                     "in1", &context, &feature_lists);
+  EXPECT_TRUE(str_util::StrContains(
+      s.error_message(),
+      "Name: in1, Key: frames, Index: 0.  Number of float values != "
+      "expected.  values size: 2 but output shape: [3]"))
+      << s;
+}
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
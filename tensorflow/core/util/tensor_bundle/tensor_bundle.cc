@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb_text.h"
@@ -34,6 +35,8 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
@@ -41,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_slice_util.h"
 
@@ -339,6 +343,13 @@ Status CorruptFileError(const Status& in_status, const string& filename,
                       detail, "): ", in_status.error_message()));
 }
 
+// The bits per key of the bloom filters of metadata tables, which let lookups
+// of keys missing from a checkpoint skip reading its data blocks.
+constexpr int kMetadataFilterBitsPerKey = 10;
+
+// The size of the cache of the metadata blocks read by a BundleReader.
+constexpr size_t kMetadataBlockCacheBytes = 8 << 20;
+
 table::Options TableBuilderOptions() {
   table::Options o;
   // Compressed tables cannot be read by TensorFlow releases prior to 1.1.
@@ -346,6 +357,7 @@ table::Options TableBuilderOptions() {
   // (version 1.2) with the intention that they will be enabled again at
   // some point (perhaps the 1.3 release?).
   o.compression = table::kNoCompression;
+  o.filter_bits_per_key = kMetadataFilterBitsPerKey;
   return o;
 }
 
@@ -492,6 +504,7 @@ Status BundleWriter::Finish() {
     // platforms (e.g. Android).  The metadata file is small, so this is fine.
     table::Options options;
     options.compression = table::kNoCompression;
+    options.filter_bits_per_key = kMetadataFilterBitsPerKey;
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
@@ -693,6 +706,22 @@ Status MergeBundles(Env* env, gtl::ArraySlice<string> prefixes,
   return status;
 }
 
+// A memory-mapped data file, shared by the BundleReader and every tensor
+// aliasing it.
+class MappedBundleShard : public core::RefCounted {
+ public:
+  explicit MappedBundleShard(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  const char* data() const {
+    return static_cast<const char*>(region_->data());
+  }
+  uint64 length() const { return region_->length(); }
+
+ private:
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+};
+
 // Interface for reading a tensor bundle.
 
 BundleReader::BundleReader(Env* env, StringPiece prefix)
@@ -711,7 +740,11 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
   status_ = env_->NewRandomAccessFile(filename, &wrapper);
   if (!status_.ok()) return;
   metadata_ = wrapper.release();
-  status_ = table::Table::Open(table::Options(), metadata_, file_size, &table_);
+  block_cache_.reset(new table::BlockCache(kMetadataBlockCacheBytes));
+  table::Options options;
+  options.filter_bits_per_key = kMetadataFilterBitsPerKey;
+  options.block_cache = block_cache_.get();
+  status_ = table::Table::Open(options, metadata_, file_size, &table_);
   if (!status_.ok()) return;
   iter_ = table_->NewIterator();
 
@@ -752,12 +785,18 @@ BundleReader::~BundleReader() {
   }
   gtl::STLDeleteValues(&data_);
   gtl::STLDeleteValues(&tensor_slices_);
+  for (auto pair : mapped_data_) {
+    if (pair.second != nullptr) pair.second->Unref();
+  }
 }
 
 Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
+  if (!table_->KeyMayMatch(key)) {
+    return errors::NotFound("Key ", key, " not found in checkpoint");
+  }
   Seek(key);
   if (!iter_->Valid() || iter_->key() != key) {
     return errors::NotFound("Key ", key, " not found in checkpoint");
@@ -775,6 +814,195 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
+namespace {
+
+// A TensorBuffer over a range of a MappedBundleShard. It reports that it
+// does not own its memory, so that kernels never forward it to an output
+// they would write into.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(MappedBundleShard* shard, const char* data, size_t size)
+      : shard_(shard), data_(data), size_(size) {
+    shard_->Ref();
+  }
+  ~MappedTensorBuffer() override { shard_->Unref(); }
+
+  void* data() const override { return const_cast<char*>(data_); }
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("tensor_bundle_mmap");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  MappedBundleShard* const shard_;
+  const char* const data_;
+  const size_t size_;
+};
+
+}  // namespace
+
+Status BundleReader::GetMappedShard(int32 shard_id,
+                                    MappedBundleShard** mapped) {
+  auto it = mapped_data_.find(shard_id);
+  if (it != mapped_data_.end()) {
+    *mapped = it->second;
+    return Status::OK();
+  }
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  const Status s = env_->NewReadOnlyMemoryRegionFromFile(
+      DataFilename(prefix_, shard_id, num_shards_), &region);
+  if (errors::IsUnimplemented(s)) {
+    // Cache the negative result too.
+    VLOG(1) << "Cannot memory-map bundle data file: " << s;
+    *mapped = nullptr;
+  } else {
+    TF_RETURN_IF_ERROR(s);
+    *mapped = new MappedBundleShard(std::move(region));
+  }
+  mapped_data_[shard_id] = *mapped;
+  return Status::OK();
+}
+
+Status BundleReader::LookupAliased(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+
+  const TensorShape stored_shape(entry.shape());
+  if (!DataTypeCanUseMemcpy(entry.dtype()) || entry.slices().size() > 0) {
+    *val = Tensor(entry.dtype(), stored_shape);
+    return Lookup(key, val);
+  }
+
+  MappedBundleShard* mapped = nullptr;
+  TF_RETURN_IF_ERROR(GetMappedShard(entry.shard_id(), &mapped));
+  const size_t expected_size =
+      stored_shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(),
+                            "; expected size ", expected_size);
+  }
+  if (mapped == nullptr ||
+      reinterpret_cast<intptr_t>(mapped->data() + entry.offset()) %
+              EIGEN_MAX_ALIGN_BYTES !=
+          0) {
+    *val = Tensor(entry.dtype(), stored_shape);
+    return GetValue(entry, val);
+  }
+  if (entry.offset() + entry.size() > mapped->length()) {
+    return errors::DataLoss("Bundle entry for key ", key,
+                            " extends past the end of data file ",
+                            entry.shard_id());
+  }
+
+  const char* data = mapped->data() + entry.offset();
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+  MappedTensorBuffer* buf = new MappedTensorBuffer(mapped, data, entry.size());
+  *val = Tensor(entry.dtype(), stored_shape, buf);
+  buf->Unref();
+  return Status::OK();
+}
+
+Status BundleReader::LookupParallel(gtl::ArraySlice<LookupRequest> requests,
+                                    int num_threads,
+                                    int64 max_bytes_in_flight) {
+  auto lookup = [](BundleReader* reader, const LookupRequest& request) {
+    if (request.slice == nullptr) {
+      return reader->Lookup(request.key, request.val);
+    }
+    return reader->LookupSlice(request.key, *request.slice, request.val);
+  };
+  if (num_threads <= 1 || requests.size() <= 1) {
+    for (const LookupRequest& request : requests) {
+      TF_RETURN_IF_ERROR(lookup(this, request));
+    }
+    return Status::OK();
+  }
+
+  struct Work {
+    const LookupRequest* request;
+    int64 offset;
+    int64 bytes;
+  };
+  std::vector<std::vector<Work>> per_shard(num_shards_);
+  for (const LookupRequest& request : requests) {
+    BundleEntryProto entry;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(request.key, &entry));
+    if (entry.shard_id() < 0 || entry.shard_id() >= num_shards_) {
+      return errors::DataLoss("Invalid shard id ", entry.shard_id(),
+                              " for key ", request.key);
+    }
+    per_shard[entry.shard_id()].push_back(
+        {&request, entry.offset(), request.val->TotalBytes()});
+  }
+  std::vector<Work> work;
+  work.reserve(requests.size());
+  for (auto& shard : per_shard) {
+    std::sort(shard.begin(), shard.end(), [](const Work& a, const Work& b) {
+      return a.offset < b.offset;
+    });
+  }
+  for (size_t i = 0; work.size() < requests.size(); ++i) {
+    for (const auto& shard : per_shard) {
+      if (i < shard.size()) work.push_back(shard[i]);
+    }
+  }
+
+  mutex mu;
+  condition_variable cv;
+  size_t next = 0;
+  int64 bytes_in_flight = 0;
+  Status status;
+  {
+    thread::ThreadPool pool(env_, "restore_bundle",
+                            std::min<int>(num_threads, work.size()));
+    for (int t = 0; t < pool.NumThreads(); ++t) {
+      pool.Schedule([&]() {
+        BundleReader reader(env_, prefix_);
+        if (!reader.status().ok()) {
+          {
+            mutex_lock l(mu);
+            status.Update(reader.status());
+          }
+          cv.notify_all();
+          return;
+        }
+        while (true) {
+          const Work* w;
+          {
+            mutex_lock l(mu);
+            while (status.ok() && next < work.size() && bytes_in_flight > 0 &&
+                   bytes_in_flight + work[next].bytes > max_bytes_in_flight) {
+              cv.wait(l);
+            }
+            if (!status.ok() || next == work.size()) return;
+            w = &work[next++];
+            bytes_in_flight += w->bytes;
+          }
+          const Status s = lookup(&reader, *w->request);
+          {
+            mutex_lock l(mu);
+            bytes_in_flight -= w->bytes;
+            status.Update(s);
+          }
+          cv.notify_all();
+        }
+      });
+    }
+  }
+  return status;
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
@@ -1025,6 +1253,7 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 }
 
 bool BundleReader::Contains(StringPiece key) {
+  if (!table_->KeyMayMatch(key)) return false;
   Seek(key);
   return Valid() && (this->key() == key);
 }
@@ -64,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -72,6 +73,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_slice.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/io/block_cache.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/table.h"
 #include "tensorflow/core/platform/env.h"
@@ -179,6 +181,8 @@ Status MergeBundles(Env* env, gtl::ArraySlice<string> prefixes,
 // "prefix".  If caller intends to call any function afterwards, "status()"
 // must be checked.
 // All threads accessing the same BundleReader must synchronize.
+class MappedBundleShard;
+
 class BundleReader {
  public:
   BundleReader(Env* const env, StringPiece prefix);
@@ -218,6 +222,21 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like Lookup(), but "val" is replaced by a new tensor instead of being
+  // filled in. For dtypes that can be memcpy-ed, the new tensor aliases a
+  // read-only memory mapping of the data file, so no bytes are copied and
+  // processes restoring the same bundle share the page cache. Kernels never
+  // forward such a buffer to an output, so writers always get a copy.
+  //
+  // Falls back to a copying Lookup() for strings, variants and partitioned
+  // tensors, when the file system cannot map the data file, or when the
+  // stored bytes are not aligned for Eigen (see
+  // BundleWriter::Options::data_alignment).
+  //
+  // Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  Status LookupAliased(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -243,6 +262,30 @@ class BundleReader {
   Status LookupSlice(StringPiece full_tensor_key, const TensorSlice& slice_spec,
                      Tensor* val) TF_MUST_USE_RESULT;
 
+  // One tensor to restore with LookupParallel().
+  struct LookupRequest {
+    string key;
+    // If non-null, restores this slice of "key" as LookupSlice() does;
+    // otherwise restores the full tensor as Lookup() does.
+    const TensorSlice* slice = nullptr;
+    // Preallocated, as for Lookup().
+    Tensor* val = nullptr;
+  };
+
+  // Performs all of "requests" using up to "num_threads" threads, each
+  // reading through its own file handles. Requests are ordered so that
+  // consecutive ones come from different data files, and reads within a
+  // file go in offset order. At most "max_bytes_in_flight" bytes of
+  // tensors are being read at any time, except that a single larger tensor
+  // is always admitted when nothing else is in flight.
+  //
+  // With "num_threads" <= 1, simply performs the requests in order.
+  // On error, the "val"s may contain nonsense data.
+  // REQUIRES: status().ok()
+  Status LookupParallel(gtl::ArraySlice<LookupRequest> requests,
+                        int num_threads,
+                        int64 max_bytes_in_flight) TF_MUST_USE_RESULT;
+
   // Seeks to the first position in the bundle whose key is no less than "key".
   // REQUIRES: status().ok()
   void Seek(StringPiece key) { return iter_->Seek(key); }
@@ -274,6 +317,11 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns the memory mapping of data file "shard_id", creating it on first
+  // use. Sets "*mapped" to nullptr if the file system cannot map the file.
+  Status GetMappedShard(int32 shard_id,
+                        MappedBundleShard** mapped) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -287,10 +335,14 @@ class BundleReader {
 
   Status status_;
   RandomAccessFile* metadata_;  // Owned.
+  std::unique_ptr<table::BlockCache> block_cache_;
   table::Table* table_;
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // One ref on each memory-mapped data file, populated by LookupAliased().
+  // Tensors aliasing a mapping hold their own refs.
+  std::unordered_map<int32, MappedBundleShard*> mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -825,6 +825,76 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupAliased) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("floats", Constant_2x3<float>(1.5)));
+    TF_EXPECT_OK(writer.Add("ints", Constant_2x3<int32>(7)));
+    TF_EXPECT_OK(writer.Add("strings", Constant_2x3<string>("hi")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor floats;
+  {
+    BundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.LookupAliased("floats", &floats));
+    Tensor ints;
+    TF_ASSERT_OK(reader.LookupAliased("ints", &ints));
+    test::ExpectTensorEqual<int32>(ints, Constant_2x3<int32>(7));
+    // Strings are not mapped, but are still returned.
+    Tensor strings;
+    TF_ASSERT_OK(reader.LookupAliased("strings", &strings));
+    test::ExpectTensorEqual<string>(strings, Constant_2x3<string>("hi"));
+    EXPECT_TRUE(errors::IsNotFound(reader.LookupAliased("absent", &ints)));
+  }
+  // The mapping outlives the reader.
+  test::ExpectTensorEqual<float>(floats, Constant_2x3<float>(1.5));
+}
+
+TEST(TensorBundleTest, LookupParallel) {
+  for (const string& name : {"par_a", "par_b"}) {
+    BundleWriter writer(Env::Default(), Prefix(name));
+    for (int i = 0; i < 20; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::StrCat(name, "_", i),
+                              Constant(static_cast<float>(i),
+                                       TensorShape({i + 1, 5}))));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(Env::Default(), {Prefix("par_a"), Prefix("par_b")},
+                            Prefix("par_merged")));
+
+  BundleReader reader(Env::Default(), Prefix("par_merged"));
+  TF_ASSERT_OK(reader.status());
+  for (int num_threads : {1, 4}) {
+    std::vector<Tensor> vals;
+    std::vector<BundleReader::LookupRequest> requests;
+    for (const string& name : {"par_a", "par_b"}) {
+      for (int i = 0; i < 20; ++i) {
+        vals.emplace_back(DT_FLOAT, TensorShape({i + 1, 5}));
+        requests.emplace_back();
+        requests.back().key = strings::StrCat(name, "_", i);
+      }
+    }
+    for (size_t i = 0; i < requests.size(); ++i) {
+      requests[i].val = &vals[i];
+    }
+    // A budget smaller than some tensors still makes progress.
+    TF_ASSERT_OK(reader.LookupParallel(requests, num_threads, 64));
+    for (size_t i = 0; i < vals.size(); ++i) {
+      const int v = i % 20;
+      test::ExpectTensorEqual<float>(
+          vals[i], Constant(static_cast<float>(v), TensorShape({v + 1, 5})));
+    }
+
+    requests[3].key = "absent";
+    EXPECT_TRUE(errors::IsNotFound(
+        reader.LookupParallel(requests, num_threads, 1 << 20)));
+  }
+}
+
 static void BM_BundleAlignmentByteOff(int iters, int alignment,
                                       int tensor_size) {
   testing::StopTiming();
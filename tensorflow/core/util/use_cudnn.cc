@@ -69,6 +69,12 @@ ADD_BOOL_CUDNN_FLAG(DebugCudnnRnnUseTensorOps,
 // when TF_DEBUG_CUDNN_RNN is true. See Nvidia Cudnn manual for allowed
 // cudnnRNNAlgo_t.
 ADD_INT64_CUDNN_FLAG(DebugCudnnRnnAlgo, TF_DEBUG_CUDNN_RNN_ALGO, -1);
+// Largest num_units for which Cudnn RNN picks the persistent static algorithm
+// (CUDNN_RNN_ALGO_PERSIST_STATIC) when it is not autotuning. The persistent
+// kernels keep the recurrent weights on chip, which pays off for small hidden
+// sizes. Set it to 0 to always use the standard algorithm.
+ADD_INT64_CUDNN_FLAG(CudnnRnnPersistStaticMaxUnits,
+                     TF_CUDNN_RNN_PERSIST_STATIC_MAX_UNITS, 256);
 #undef ADD_INT64_CUDNN_FLAG
 
 FP16ConvMode CudnnConvComputeMode() {
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/util/work_sharder.h"
 
+#include <cmath>
+
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
@@ -74,4 +77,57 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
   counter.Wait();
 }
 
+ShardCostModel::ShardCostModel(int64 initial_cost_per_unit)
+    : cost_per_unit_(initial_cost_per_unit), measured_(false) {}
+
+int64 ShardCostModel::cost_per_unit() const {
+  return static_cast<int64>(std::llround(cost_per_unit_.load()));
+}
+
+void ShardCostModel::Update(int64 units, int64 nanos) {
+  if (units <= 0) return;
+  const double measured = static_cast<double>(nanos) / units;
+  if (!measured_.exchange(true)) {
+    cost_per_unit_.store(measured);
+    return;
+  }
+  // An exponential moving average, which follows the changes of the inputs
+  // of the kernel while smoothing the noise of the measurements.
+  static const double kWeight = 0.125;
+  const double old = cost_per_unit_.load();
+  cost_per_unit_.store(old + kWeight * (measured - old));
+}
+
+namespace {
+
+// The number of AdaptiveShard() calls in progress.
+std::atomic<int> num_adaptive_shard_calls(0);
+
+}  // namespace
+
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64 total, ShardCostModel* cost_model,
+                   std::function<void(int64, int64)> work) {
+  CHECK_GE(total, 0);
+  if (total == 0) {
+    return;
+  }
+  const int num_calls = ++num_adaptive_shard_calls;
+  max_parallelism = std::min(
+      max_parallelism, std::max(1, workers->NumThreads() / num_calls));
+
+  // The microsecond clock is coarse for small shards, but the sum of the
+  // durations of the shards is still an unbiased measure of the total.
+  Env* env = Env::Default();
+  std::atomic<int64> elapsed_us(0);
+  Shard(max_parallelism, workers, total, cost_model->cost_per_unit(),
+        [&work, &elapsed_us, env](int64 start, int64 limit) {
+          const uint64 start_us = env->NowMicros();
+          work(start, limit);
+          elapsed_us += env->NowMicros() - start_us;
+        });
+  --num_adaptive_shard_calls;
+  cost_model->Update(total, elapsed_us.load() * 1000);
+}
+
 }  // end namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_UTIL_WORK_SHARDER_H_
 #define TENSORFLOW_UTIL_WORK_SHARDER_H_
 
+#include <atomic>
 #include <functional>
 
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -48,6 +49,42 @@ namespace tensorflow {
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
            int64 cost_per_unit, std::function<void(int64, int64)> work);
 
+// Learns the cost per unit of work of a kernel from the measured durations
+// of its work, for kernels whose cost per unit is hard to estimate with a
+// constant. Typically a member of the kernel, passed to AdaptiveShard().
+//
+// This class is thread-safe. Concurrent updates may be lost, which only
+// slows down the learning.
+class ShardCostModel {
+ public:
+  // "initial_cost_per_unit" is used until the first measurement.
+  explicit ShardCostModel(int64 initial_cost_per_unit);
+
+  // The estimated cost of a unit of work, in nanoseconds.
+  int64 cost_per_unit() const;
+
+  // Adds the measurement that "units" units of work took "nanos"
+  // nanoseconds of thread time in total.
+  void Update(int64 units, int64 nanos);
+
+ private:
+  std::atomic<double> cost_per_unit_;
+  std::atomic<bool> measured_;
+};
+
+// Like Shard(), but shards with the cost per unit of "cost_model", and
+// updates it with the measured duration of the work.
+//
+// The parallelism is also capped to an even share of "workers" among the
+// AdaptiveShard() calls in progress, so that ops running concurrently
+// don't queue more shards than there are threads, which only adds to the
+// latency of all of them.
+//
+// REQUIRES: cost_model != nullptr
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64 total, ShardCostModel* cost_model,
+                   std::function<void(int64, int64)> work);
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_UTIL_WORK_SHARDER_H_
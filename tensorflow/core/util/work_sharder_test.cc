@@ -76,6 +76,52 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(AdaptiveShard, Basic) {
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  for (auto workers : {0, 1, 7, 16, 100}) {
+    for (auto total : {0, 1, 10, 1000, 9999}) {
+      ShardCostModel cost_model(1000);
+      std::vector<std::atomic<int>> done(total);
+      for (auto& d : done) d = 0;
+      AdaptiveShard(workers, &threads, total, &cost_model,
+                    [total, &done](int64 start, int64 limit) {
+                      EXPECT_GE(start, 0);
+                      EXPECT_LE(limit, total);
+                      for (; start < limit; ++start) ++done[start];
+                    });
+      for (const auto& d : done) EXPECT_EQ(1, d);
+    }
+  }
+}
+
+TEST(AdaptiveShard, LearnsCostPerUnit) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  // Starts with a gross underestimate of 2ms per unit of work.
+  ShardCostModel cost_model(1);
+  for (int i = 0; i < 3; ++i) {
+    AdaptiveShard(4, &threads, 8, &cost_model, [](int64 start, int64 limit) {
+      Env::Default()->SleepForMicroseconds((limit - start) * 2000);
+    });
+  }
+  EXPECT_GE(cost_model.cost_per_unit(), 2000000);
+  EXPECT_LT(cost_model.cost_per_unit(), 20000000);
+}
+
+TEST(ShardCostModel, Update) {
+  ShardCostModel cost_model(100);
+  EXPECT_EQ(100, cost_model.cost_per_unit());
+  cost_model.Update(0, 1000);
+  EXPECT_EQ(100, cost_model.cost_per_unit());
+  // The first measurement replaces the initial estimate.
+  cost_model.Update(10, 2000);
+  EXPECT_EQ(200, cost_model.cost_per_unit());
+  cost_model.Update(10, 20000);
+  EXPECT_EQ(200 + 1800 / 8, cost_model.cost_per_unit());
+  // The estimate converges to small costs too.
+  for (int i = 0; i < 200; ++i) cost_model.Update(1000, 3000);
+  EXPECT_EQ(3, cost_model.cost_per_unit());
+}
+
 void BM_Sharding(int iters, int arg) {
   thread::ThreadPool threads(Env::Default(), "test", 16);
   const int64 total = 1LL << 30;
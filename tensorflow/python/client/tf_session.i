@@ -483,6 +483,9 @@ TF_ImportGraphDefResultsMissingUnusedInputMappings_wrapper{
 // PyArray_Return, maybe others).
 %noexception TF_SessionRun_wrapper;
 
+// Python fetches don't write into caller buffers.
+%ignore TF_SessionRunWithPreallocatedOutputs;
+
 // We use TF_SessionPRunSetup_wrapper instead of TF_SessionPRunSetup
 %ignore TF_SessionPRunSetup;
 %unignore TF_SessionPRunSetup_wrapper;
@@ -199,6 +199,76 @@ class FilesystemCacheDatasetTest(test.TestCase):
       self.assertAllEqual(elements, elements_itr1)
       self.assertAllEqual(elements, elements_itr2)
 
+  def testShardedCache(self):
+    for compression_type in ["", "ZLIB", "GZIP", "SNAPPY"]:
+      cache_prefix = self.cache_prefix + compression_type
+      dataset = dataset_ops.Dataset.range(100).cache(
+          cache_prefix,
+          compression_type=compression_type,
+          num_parallel_shards=4)
+      get_next = dataset.make_one_shot_iterator().get_next()
+      with self.test_session() as sess:
+        self.assertEqual(list(range(100)),
+                         [sess.run(get_next) for _ in range(100)])
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+      self.assertTrue(path.exists(cache_prefix + ".cache-index"))
+      self.assertTrue(path.exists(cache_prefix + ".cache-00000"))
+
+      # A second iterator reads the cache, not its empty input.
+      dataset = dataset_ops.Dataset.range(0).cache(
+          cache_prefix,
+          compression_type=compression_type,
+          num_parallel_shards=4)
+      get_next = dataset.make_one_shot_iterator().get_next()
+      with self.test_session() as sess:
+        self.assertEqual(list(range(100)),
+                         [sess.run(get_next) for _ in range(100)])
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+  def testShardedCacheResumesAfterCompletedShards(self):
+    dataset = dataset_ops.Dataset.range(100).cache(
+        self.cache_prefix, compression_type="ZLIB", num_parallel_shards=2)
+    iterator = dataset.make_initializable_iterator()
+    get_next = iterator.get_next()
+    with self.test_session() as sess:
+      # The first iterator stops early, keeping a shard of 30 elements.
+      sess.run(iterator.initializer)
+      self.assertEqual(list(range(30)), [sess.run(get_next) for _ in range(30)])
+      # The next one writes the rest of the elements in a new shard.
+      sess.run(iterator.initializer)
+      self.assertEqual(list(range(100)),
+                       [sess.run(get_next) for _ in range(100)])
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+    with open(self.cache_prefix + ".cache-index") as f:
+      self.assertEqual("compression_type=ZLIB\n30\n70\ncomplete\n", f.read())
+
+  def testShardedCacheWithOtherCompressionFails(self):
+    dataset = dataset_ops.Dataset.range(100).cache(
+        self.cache_prefix, compression_type="ZLIB", num_parallel_shards=2)
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      sess.run(get_next)
+    dataset = dataset_ops.Dataset.range(100).cache(
+        self.cache_prefix, compression_type="GZIP", num_parallel_shards=2)
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(get_next)
+
+  def testInvalidCacheAttrs(self):
+    with self.test_session() as sess:
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(dataset_ops.Dataset.range(10).cache(
+            self.cache_prefix, compression_type="LZ4")
+                 .make_one_shot_iterator().get_next())
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(dataset_ops.Dataset.range(10).cache(
+            self.cache_prefix, num_parallel_shards=-1)
+                 .make_one_shot_iterator().get_next())
+
 
 class MemoryCacheDatasetTest(test.TestCase):
 
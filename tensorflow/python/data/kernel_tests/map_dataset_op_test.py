@@ -18,6 +18,7 @@ from __future__ import division
 from __future__ import print_function
 
 from collections import namedtuple
+import os
 import threading
 import time
 
@@ -33,8 +34,11 @@ from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import data_flow_ops
 from tensorflow.python.ops import functional_ops
+from tensorflow.python.ops import gen_dataset_ops
+from tensorflow.python.ops import io_ops
 from tensorflow.python.ops import lookup_ops
 from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import parsing_ops
 from tensorflow.python.ops import random_ops
 from tensorflow.python.ops import script_ops
 from tensorflow.python.ops import sparse_ops
@@ -624,6 +628,134 @@ class MapDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(get_next)
 
+  def _get_all(self, sess, get_next):
+    """Gets the remaining elements, and checks that the iterator stays ended."""
+    elements = []
+    while True:
+      try:
+        elements.append(sess.run(get_next))
+      except errors.OutOfRangeError:
+        break
+    with self.assertRaises(errors.OutOfRangeError):
+      sess.run(get_next)
+    return elements
+
+  def testSloppyParallelMapReturnsElementsAsTheyAreReady(self):
+    ready = threading.Event()
+
+    def _wait_for_first(i):
+      if i == 0:
+        ready.wait()
+      return i
+
+    iterator = (
+        dataset_ops.Dataset.range(10)
+        .map(lambda x: script_ops.py_func(_wait_for_first, [x], dtypes.int64),
+             num_parallel_calls=4, sloppy=True)
+        .make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      try:
+        # The first element is not ready, so the next ones come first instead
+        # of waiting for it.
+        elements = [sess.run(get_next) for _ in range(3)]
+        self.assertNotIn(0, elements)
+      finally:
+        ready.set()
+      elements.extend(self._get_all(sess, get_next))
+      self.assertEqual(list(range(10)), sorted(elements))
+
+  def testSloppyParallelMapError(self):
+    components = np.array([1., 2., 3., np.nan, 5.]).astype(np.float32)
+
+    iterator = (
+        dataset_ops.Dataset.from_tensor_slices(components)
+        .map(lambda x: array_ops.check_numerics(x, "message"),
+             num_parallel_calls=2, sloppy=True)
+        .make_initializable_iterator())
+    init_op = iterator.initializer
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      sess.run(init_op)
+      elements = []
+      num_errors = 0
+      while True:
+        try:
+          elements.append(sess.run(get_next))
+        except errors.InvalidArgumentError:
+          num_errors += 1
+        except errors.OutOfRangeError:
+          break
+      # The 4th element is NaN, and fails without losing the others.
+      self.assertEqual(1, num_errors)
+      self.assertEqual([1., 2., 3., 5.], sorted(elements))
+
+  def testSloppyParallelMapEndOfInput(self):
+    for num_elements, num_parallel_calls in [(0, 2), (3, 8), (20, 3)]:
+      iterator = (
+          dataset_ops.Dataset.range(num_elements)
+          .map(lambda x: x * 2, num_parallel_calls=num_parallel_calls,
+               sloppy=True)
+          .make_initializable_iterator())
+      init_op = iterator.initializer
+      get_next = iterator.get_next()
+
+      with self.test_session() as sess:
+        sess.run(init_op)
+        self.assertEqual([2 * i for i in range(num_elements)],
+                         sorted(self._get_all(sess, get_next)))
+
+  def testSloppyMapRequiresParallelCalls(self):
+    with self.assertRaises(ValueError):
+      dataset_ops.Dataset.range(10).map(lambda x: x, sloppy=True)
+
+  def _iterate_sloppy_with_checkpoint(self, num_saved):
+    """Gets `num_saved` elements, saves the iterator and restores it."""
+    checkpoint = os.path.join(self.get_temp_dir(), "iterator")
+
+    def _build_graph():
+      iterator = (
+          dataset_ops.Dataset.range(50)
+          .map(lambda x: x * 2, num_parallel_calls=4, sloppy=True)
+          .make_initializable_iterator())
+      resource = iterator._iterator_resource  # pylint: disable=protected-access
+      save_op = io_ops.write_file(
+          checkpoint,
+          parsing_ops.serialize_tensor(
+              gen_dataset_ops.serialize_iterator(resource)))
+      restore_op = gen_dataset_ops.deserialize_iterator(
+          resource,
+          parsing_ops.parse_tensor(io_ops.read_file(checkpoint),
+                                   dtypes.variant))
+      return iterator.initializer, iterator.get_next(), save_op, restore_op
+
+    elements = []
+    with ops.Graph().as_default() as g:
+      init_op, get_next, save_op, _ = _build_graph()
+      with self.test_session(graph=g) as sess:
+        sess.run(init_op)
+        for _ in range(num_saved):
+          elements.append(sess.run(get_next))
+        sess.run(save_op)
+    with ops.Graph().as_default() as g:
+      init_op, get_next, _, restore_op = _build_graph()
+      with self.test_session(graph=g) as sess:
+        sess.run(init_op)
+        sess.run(restore_op)
+        elements.extend(self._get_all(sess, get_next))
+    return elements
+
+  def testSloppyParallelMapCheckpoint(self):
+    # Every element is produced once across the checkpoint, whichever
+    # invocations were outstanding when it was saved.
+    for num_saved in [0, 1, 13, 50]:
+      self.assertEqual([2 * i for i in range(50)],
+                       sorted(self._iterate_sloppy_with_checkpoint(num_saved)))
+
   def testConstantOutput(self):
     iterator = (
         dataset_ops.Dataset.range(10).map(lambda x: [x, "hello", 10])
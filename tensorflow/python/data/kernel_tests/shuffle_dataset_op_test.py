@@ -18,6 +18,7 @@ from __future__ import division
 from __future__ import print_function
 
 import collections
+import os
 
 import numpy as np
 
@@ -26,7 +27,11 @@ from tensorflow.python.data.ops import iterator_ops
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_dataset_ops
+from tensorflow.python.ops import io_ops
+from tensorflow.python.ops import parsing_ops
 from tensorflow.python.platform import test
 
 
@@ -208,5 +213,91 @@ class ShuffleDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(next_element)
 
+  def _shuffled_range(self, spill_directory=None,
+                      replay_buffer_on_restore=None):
+    return dataset_ops.Dataset.range(1000).shuffle(
+        100,
+        seed=1,
+        spill_directory=spill_directory,
+        replay_buffer_on_restore=replay_buffer_on_restore)
+
+  def _get_all(self, dataset):
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      elements = []
+      while True:
+        try:
+          elements.append(sess.run(get_next))
+        except errors.OutOfRangeError:
+          return elements
+
+  def testSpillDirectory(self):
+    spill_directory = os.path.join(self.get_temp_dir(), "shuffle_spill")
+    os.makedirs(spill_directory)
+    with ops.Graph().as_default():
+      expected = self._get_all(self._shuffled_range())
+    with ops.Graph().as_default():
+      self.assertEqual(
+          expected,
+          self._get_all(self._shuffled_range(spill_directory=spill_directory)))
+    self.assertEqual(list(range(1000)), sorted(expected))
+    # The files of the buffer are deleted with the iterator.
+    self.assertEqual([], os.listdir(spill_directory))
+
+  def _iterate_with_checkpoint(self, replay_buffer_on_restore, num_saved):
+    """Gets `num_saved` elements, saves the iterator and restores it."""
+    checkpoint = os.path.join(
+        self.get_temp_dir(), "iterator_%s" % replay_buffer_on_restore)
+
+    def _build_graph():
+      iterator = self._shuffled_range(
+          replay_buffer_on_restore=replay_buffer_on_restore
+      ).make_initializable_iterator()
+      resource = iterator._iterator_resource  # pylint: disable=protected-access
+      save_op = io_ops.write_file(
+          checkpoint,
+          parsing_ops.serialize_tensor(
+              gen_dataset_ops.serialize_iterator(resource)))
+      restore_op = gen_dataset_ops.deserialize_iterator(
+          resource,
+          parsing_ops.parse_tensor(io_ops.read_file(checkpoint),
+                                   dtypes.variant))
+      return iterator.initializer, iterator.get_next(), save_op, restore_op
+
+    elements = []
+    with ops.Graph().as_default() as g:
+      init_op, get_next, save_op, _ = _build_graph()
+      with self.test_session(graph=g) as sess:
+        sess.run(init_op)
+        for _ in range(num_saved):
+          elements.append(sess.run(get_next))
+        sess.run(save_op)
+    with ops.Graph().as_default() as g:
+      init_op, get_next, _, restore_op = _build_graph()
+      with self.test_session(graph=g) as sess:
+        sess.run(init_op)
+        sess.run(restore_op)
+        while True:
+          try:
+            elements.append(sess.run(get_next))
+          except errors.OutOfRangeError:
+            break
+    return elements, os.path.getsize(checkpoint)
+
+  def testReplayBufferOnRestore(self):
+    with ops.Graph().as_default():
+      expected = self._get_all(self._shuffled_range())
+    for num_saved in [0, 150, 950, 1000]:
+      elements, _ = self._iterate_with_checkpoint(True, num_saved)
+      self.assertEqual(expected, elements)
+
+    # The checkpoint only holds the positions of the buffered elements.
+    elements, buffer_bytes = self._iterate_with_checkpoint(False, 150)
+    self.assertEqual(expected, elements)
+    elements, replay_bytes = self._iterate_with_checkpoint(True, 150)
+    self.assertEqual(expected, elements)
+    self.assertLess(replay_bytes, buffer_bytes)
+
+
 if __name__ == "__main__":
   test.main()
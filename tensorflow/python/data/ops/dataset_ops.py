@@ -648,7 +648,12 @@ class Dataset(object):
     max_value = np.iinfo(dtypes.int64.as_numpy_dtype).max
     return Dataset.zip((Dataset.range(start, max_value), self))
 
-  def shuffle(self, buffer_size, seed=None, reshuffle_each_iteration=None):
+  def shuffle(self,
+              buffer_size,
+              seed=None,
+              reshuffle_each_iteration=None,
+              spill_directory=None,
+              replay_buffer_on_restore=None):
     """Randomly shuffles the elements of this dataset.
 
     Args:
@@ -661,24 +666,43 @@ class Dataset(object):
       reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
         that the dataset should be pseudorandomly reshuffled each time it is
         iterated over. (Defaults to `True`.)
+      spill_directory: (Optional.) A directory on a local disk to which
+        iterators write the elements of their shuffle buffers, keeping only
+        their locations in memory. This bounds the memory of large buffers at
+        the cost of reading every element back from disk.
+      replay_buffer_on_restore: (Optional.) A boolean, which if true makes
+        iterator checkpoints hold the position of each buffered element in
+        the input instead of the element. Restoring such a checkpoint reads
+        the input again to rebuild the buffer, so the input must produce the
+        same elements in every epoch. (Defaults to `False`.)
 
     Returns:
       Dataset: A `Dataset`.
     """
-    return ShuffleDataset(self, buffer_size, seed, reshuffle_each_iteration)
+    return ShuffleDataset(self, buffer_size, seed, reshuffle_each_iteration,
+                          spill_directory, replay_buffer_on_restore)
 
-  def cache(self, filename=""):
+  def cache(self, filename="", compression_type=None, num_parallel_shards=None):
     """Caches the elements in this dataset.
 
     Args:
       filename: A `tf.string` scalar `tf.Tensor`, representing the name of a
         directory on the filesystem to use for caching tensors in this Dataset.
         If a filename is not provided, the dataset will be cached in memory.
+      compression_type: (Optional.) One of `""` (no compression), `"ZLIB"`,
+        `"GZIP"` or `"SNAPPY"`, used to compress the files of the cache. If
+        set, the cache is written in shards, as with `num_parallel_shards`.
+        Ignored when caching in memory.
+      num_parallel_shards: (Optional.) If positive, the cache is written as a
+        sequence of shard files of consecutive elements, up to this many of
+        which are written or read concurrently. A cache whose writing stops
+        early keeps its completed shards, and the next iterator resumes
+        writing after them. Ignored when caching in memory.
 
     Returns:
       Dataset: A `Dataset`.
     """
-    return CacheDataset(self, filename)
+    return CacheDataset(self, filename, compression_type, num_parallel_shards)
 
   def take(self, count):
     """Creates a `Dataset` with at most `count` elements from this dataset.
@@ -848,9 +872,12 @@ class Dataset(object):
     """
     return PaddedBatchDataset(self, batch_size, padded_shapes, padding_values)
 
-  def map(self, map_func, num_parallel_calls=None):
+  def map(self, map_func, num_parallel_calls=None, sloppy=False):
     """Maps `map_func` across this dataset.
 
+    WARNING: If `sloppy` is `True`, the order of produced elements is not
+    deterministic.
+
     Args:
       map_func: A function mapping a nested structure of tensors (having
         shapes and types defined by `self.output_shapes` and
@@ -858,14 +885,24 @@ class Dataset(object):
       num_parallel_calls: (Optional.) A `tf.int32` scalar `tf.Tensor`,
         representing the number elements to process in parallel. If not
         specified, elements will be processed sequentially.
+      sloppy: (Optional.) If false, elements are produced in deterministic
+        order. Otherwise, the elements processed in parallel are produced in
+        the order in which they are ready, so that a slow element does not
+        hold back the others. Requires `num_parallel_calls`.
 
     Returns:
       Dataset: A `Dataset`.
+
+    Raises:
+      ValueError: If `sloppy` is true and `num_parallel_calls` is not
+        specified.
     """
     if num_parallel_calls is None:
+      if sloppy:
+        raise ValueError("`sloppy` requires `num_parallel_calls`.")
       return MapDataset(self, map_func)
     else:
-      return ParallelMapDataset(self, map_func, num_parallel_calls)
+      return ParallelMapDataset(self, map_func, num_parallel_calls, sloppy)
 
   def flat_map(self, map_func):
     """Maps `map_func` across this dataset and flattens the result.
@@ -1487,17 +1524,25 @@ class RangeDataset(Dataset):
 class CacheDataset(Dataset):
   """A `Dataset` that caches elements of its input."""
 
-  def __init__(self, input_dataset, filename):
+  def __init__(self,
+               input_dataset,
+               filename,
+               compression_type=None,
+               num_parallel_shards=None):
     """See `Dataset.cache()` for details."""
     super(CacheDataset, self).__init__()
     self._input_dataset = input_dataset
     self._filename = ops.convert_to_tensor(
         filename, dtype=dtypes.string, name="filename")
+    self._compression_type = compression_type or ""
+    self._num_parallel_shards = num_parallel_shards or 0
 
   def _as_variant_tensor(self):
     return gen_dataset_ops.cache_dataset(
         self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
         filename=self._filename,
+        compression_type=self._compression_type,
+        num_parallel_shards=self._num_parallel_shards,
         output_shapes=nest.flatten(
             sparse.as_dense_shapes(self.output_shapes, self.output_classes)),
         output_types=nest.flatten(
@@ -1523,7 +1568,9 @@ class ShuffleDataset(Dataset):
                input_dataset,
                buffer_size,
                seed=None,
-               reshuffle_each_iteration=None):
+               reshuffle_each_iteration=None,
+               spill_directory=None,
+               replay_buffer_on_restore=None):
     """Randomly shuffles the elements of this dataset.
 
     Args:
@@ -1537,6 +1584,11 @@ class ShuffleDataset(Dataset):
       reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
         that the dataset should be pseudorandomly reshuffled each time it is
         iterated over. (Defaults to `True`.)
+      spill_directory: (Optional.) A directory on a local disk to which
+        iterators write the elements of their shuffle buffers.
+      replay_buffer_on_restore: (Optional.) A boolean, which if true makes
+        iterator checkpoints hold the positions of the buffered elements in
+        the input instead of the elements. (Defaults to `False`.)
 
     Returns:
       A `Dataset`.
@@ -1553,6 +1605,8 @@ class ShuffleDataset(Dataset):
       self._reshuffle_each_iteration = True
     else:
       self._reshuffle_each_iteration = reshuffle_each_iteration
+    self._spill_directory = spill_directory or ""
+    self._replay_buffer_on_restore = bool(replay_buffer_on_restore)
 
   def _as_variant_tensor(self):
     return gen_dataset_ops.shuffle_dataset(
@@ -1561,6 +1615,8 @@ class ShuffleDataset(Dataset):
         seed=self._seed,
         seed2=self._seed2,
         reshuffle_each_iteration=self._reshuffle_each_iteration,
+        spill_directory=self._spill_directory,
+        replay_buffer_on_restore=self._replay_buffer_on_restore,
         output_shapes=nest.flatten(
             sparse.as_dense_shapes(self.output_shapes, self.output_classes)),
         output_types=nest.flatten(
@@ -1880,12 +1936,14 @@ class MapDataset(Dataset):
 class ParallelMapDataset(MapDataset):
   """A `Dataset` that maps a function over elements in its input in parallel."""
 
-  def __init__(self, input_dataset, map_func, num_parallel_calls):
+  def __init__(self, input_dataset, map_func, num_parallel_calls,
+               sloppy=False):
     """See `Dataset.map()` for details."""
     super(ParallelMapDataset, self).__init__(input_dataset, map_func)
 
     self._num_parallel_calls = ops.convert_to_tensor(
         num_parallel_calls, dtype=dtypes.int32, name="num_parallel_calls")
+    self._sloppy = bool(sloppy)
 
   def _as_variant_tensor(self):
     input_t = self._input_dataset._as_variant_tensor()  # pylint: disable=protected-access
@@ -1895,6 +1953,7 @@ class ParallelMapDataset(MapDataset):
         self._map_func.captured_inputs,
         f=self._map_func,
         num_parallel_calls=self._num_parallel_calls,
+        sloppy=self._sloppy,
         output_types=nest.flatten(
             sparse.as_dense_types(self.output_types, self.output_classes)),
         output_shapes=nest.flatten(
@@ -186,6 +186,15 @@ class GatherNdTest(test.TestCase):
     self.assertAllEqual(expected.reshape([10, 10, 20]), gather_nd_val)
     self.assertEqual([10, 10, 20], gather_nd_t.get_shape())
 
+  def testLargeSlices(self):
+    with self.test_session(use_gpu=True):
+      params = np.random.rand(20, 7, 3000).astype(np.float32)
+      indices = np.vstack(
+          [np.random.randint(0, s, size=500) for s in (20, 7)]).T
+      gather_nd_val = array_ops.gather_nd(params, indices).eval()
+
+    self.assertAllEqual(params[tuple(indices.T)], gather_nd_val)
+
   def assertIndexedSlices(self, t):
     self.assertIsInstance(t, ops.IndexedSlices)
 
@@ -816,6 +816,42 @@ class InitializeTableFromFileOpTest(test.TestCase):
       result = output.eval()
       self.assertAllEqual([b"brain", b"salad", b"surgery", b"UNK"], result)
 
+  def testInitializeLargeTable(self):
+    # Large enough for the lines to be parsed on several threads.
+    vocab_size = 100000
+    vocabulary_file = self._createVocabFile(
+        "large_two_columns.txt",
+        values=["word%d,%d" % (i, i * 2) for i in range(vocab_size)])
+
+    with self.test_session():
+      default_value = -1
+      table = lookup_ops.HashTable(
+          lookup_ops.TextFileInitializer(
+              vocabulary_file, dtypes.string, 0, dtypes.int64, 1,
+              vocab_size=vocab_size, delimiter=","), default_value)
+      table.init.run()
+
+      output = table.lookup(
+          constant_op.constant(["word0", "word54321", "word99999", "word"]))
+
+      result = output.eval()
+      self.assertAllEqual([0, 108642, 199998, -1], result)
+
+  def testInitializeLargeTableWithBadLine(self):
+    values = ["word%d,%d" % (i, i) for i in range(100000)]
+    values[60000] = "word60000,x"
+    values[90000] = "word90000"
+    vocabulary_file = self._createVocabFile("large_bad_line.txt", values=values)
+
+    with self.test_session():
+      table = lookup_ops.HashTable(
+          lookup_ops.TextFileInitializer(
+              vocabulary_file, dtypes.string, 0, dtypes.int64, 1,
+              delimiter=","), -1)
+      # The first bad line is reported.
+      with self.assertRaisesOpError("Field x in line 60000"):
+        table.init.run()
+
   def testMultiColumn(self):
     vocabulary_file = os.path.join(self.get_temp_dir(), "three_columns.txt")
     with open(vocabulary_file, "w") as f:
@@ -18,6 +18,7 @@ from __future__ import division
 from __future__ import print_function
 
 import gc
+import os
 
 import numpy as np
 
@@ -38,6 +39,7 @@ from tensorflow.python.ops import variables
 from tensorflow.python.platform import test
 from tensorflow.python.training import momentum
 from tensorflow.python.training import saver
+from tensorflow.python.training import training_ops
 from tensorflow.python.training import training_util
 from tensorflow.python.util import compat
 
@@ -812,5 +814,73 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase):
       state_ops.scatter_update(v, [0, 1], [0, 1, 2])
 
 
+  def _enableNonblockingReads(self):
+    os.environ["TF_RESOURCE_VARIABLE_NONBLOCKING_READS"] = "1"
+    self.addCleanup(os.environ.pop, "TF_RESOURCE_VARIABLE_NONBLOCKING_READS")
+
+  def testNonblockingReadAfterUpdate(self):
+    self._enableNonblockingReads()
+    with self.test_session() as sess:
+      v = resource_variable_ops.ResourceVariable([1.0, 2.0])
+      read = v.read_value()
+      sess.run(v.initializer)
+      # The first read makes the variable keep a snapshot.
+      self.assertAllEqual([1.0, 2.0], sess.run(read))
+      sess.run(v.assign([3.0, 4.0]))
+      self.assertAllEqual([3.0, 4.0], sess.run(read))
+      sess.run(v.assign_add([1.0, 1.0]))
+      self.assertAllEqual([4.0, 5.0], sess.run(read))
+      sess.run(state_ops.scatter_add(v, [0], [1.0]))
+      self.assertAllEqual([5.0, 5.0], sess.run(read))
+      sess.run(v[1].assign(7.0))
+      self.assertAllEqual([5.0, 7.0], sess.run(read))
+      sess.run(
+          training_ops.resource_apply_gradient_descent(
+              v.handle, 1.0, [1.0, 1.0], use_locking=False))
+      self.assertAllEqual([4.0, 6.0], sess.run(read))
+      sess.run(
+          training_ops.resource_sparse_apply_proximal_gradient_descent(
+              v.handle, 1.0, 0.0, 0.0, [2.0], [1], use_locking=False))
+      self.assertAllEqual([4.0, 4.0], sess.run(read))
+
+  def testNonblockingReadsDuringConcurrentUpdates(self):
+    self._enableNonblockingReads()
+    num_updates = 100
+    with self.test_session() as sess:
+      v = resource_variable_ops.ResourceVariable(array_ops.zeros([10000]))
+      read = v.read_value()
+      assign_add = v.assign_add(array_ops.ones([10000]))
+      apply_gradient = training_ops.resource_apply_gradient_descent(
+          v.handle, 1.0, -array_ops.ones([10000]), use_locking=True)
+      sess.run(v.initializer)
+      sess.run(read)
+
+      def update(op):
+        for _ in range(num_updates):
+          sess.run(op)
+
+      def check_reads():
+        last = 0
+        for _ in range(2 * num_updates):
+          value = sess.run(read)
+          # Each read is the value of a completed update, and not older than
+          # the value of an earlier read.
+          self.assertAllEqual(np.full([10000], value[0]), value)
+          self.assertGreaterEqual(value[0], last)
+          last = value[0]
+
+      threads = [
+          self.checkedThread(target=update, args=(assign_add,)),
+          self.checkedThread(target=update, args=(apply_gradient,)),
+          self.checkedThread(target=check_reads),
+          self.checkedThread(target=check_reads)
+      ]
+      for t in threads:
+        t.start()
+      for t in threads:
+        t.join()
+      self.assertAllEqual(np.full([10000], 2 * num_updates), sess.run(read))
+
+
 if __name__ == "__main__":
   test.main()
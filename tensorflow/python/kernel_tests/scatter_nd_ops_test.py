@@ -597,6 +597,16 @@ class ScatterNdTest(test.TestCase):
       val = self.scatter_nd(indices, values, shape).eval()
     self.assertAllClose([np.sum(values)], val)
 
+  def testScatterNdRepeatedIndicesAddLargeSlices(self):
+    indices = np.random.randint(0, 3, size=[200, 1]).astype(np.int32)
+    values = np.random.randn(200, 5000)
+    shape = [3, 5000]
+    expected = np.zeros(shape)
+    np.add.at(expected, indices[:, 0], values)
+    with self.test_session():
+      val = self.scatter_nd(indices, values, shape).eval()
+    self.assertAllClose(expected, val)
+
   def testSmokeScatterNdBatch2DSliceDim2(self):
     with self.test_session():
       indices = array_ops.zeros([3, 5, 2], dtype=dtypes.int32)
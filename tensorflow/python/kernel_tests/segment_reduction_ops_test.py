@@ -126,6 +126,22 @@ class SegmentReductionOpTest(SegmentReductionHelper):
             # and may therefore vary dynamically.
             self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testLongSegments(self):
+    # Long and skewed segments, with scalar and vector rows.
+    ops_list = [(np.add, None, math_ops.segment_sum),
+                (self._mean_cum_op, self._mean_reduce_op,
+                 math_ops.segment_mean)]
+    indices = [0] * 3 + [2] * 500 + [3] * 40 + [5] * 7
+    for dtype in [dtypes_lib.float32, dtypes_lib.float64]:
+      for shape in [[len(indices)], [len(indices), 5], [len(indices), 70]]:
+        for use_gpu in [True, False]:
+          with self.test_session(use_gpu=use_gpu):
+            tf_x, np_x = self._input(shape, dtype=dtype)
+            for np_op1, np_op2, tf_op in ops_list:
+              np_ans = self._segmentReduce(indices, np_x, np_op1, np_op2)
+              s = tf_op(data=tf_x, segment_ids=indices)
+              self.assertAllClose(np_ans, s.eval(), rtol=1e-5)
+
   def testSegmentIdsShape(self):
     shape = [4, 4]
     tf_x, _ = self._input(shape)
@@ -0,0 +1,40 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for string_lower_op."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.ops import string_ops
+from tensorflow.python.platform import test
+
+
+class StringLowerOpTest(test.TestCase):
+  """Test cases for tf.strings.lower."""
+
+  def test_string_lower(self):
+    strings = [[b"Pigs On The WING", b"animals"],
+               [b"", b"\xc3\x84BC-xyz 09"]]
+
+    with self.test_session() as sess:
+      output = string_ops.string_lower(strings)
+      output = sess.run(output)
+      self.assertAllEqual(output, [[b"pigs on the wing", b"animals"],
+                                   [b"", b"\xc3\x84bc-xyz 09"]])
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,87 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for string_ngrams_op."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import string_ops
+from tensorflow.python.platform import test
+
+
+class StringNGramsOpTest(test.TestCase):
+
+  def _ngrams(self, data, data_splits, **kwargs):
+    with self.test_session():
+      ngrams, ngrams_splits = string_ops.string_n_grams(
+          data, data_splits, **kwargs)
+      return ngrams.eval().tolist(), ngrams_splits.eval().tolist()
+
+  def testBigrams(self):
+    ngrams, splits = self._ngrams(["a", "b", "c", "d", "e"], [0, 3, 3, 5],
+                                  ngram_widths=[2])
+    self.assertEqual([b"a b", b"b c", b"d e"], ngrams)
+    self.assertEqual([0, 2, 2, 3], splits)
+
+  def testMultipleWidthsAndSeparator(self):
+    ngrams, splits = self._ngrams(["a", "b", "c"], [0, 3],
+                                  ngram_widths=[1, 3], separator="|")
+    self.assertEqual([b"a", b"b", b"c", b"a|b|c"], ngrams)
+    self.assertEqual([0, 4], splits)
+
+  def testPadding(self):
+    ngrams, splits = self._ngrams(
+        ["a", "b"], [0, 2], ngram_widths=[3], left_pad="<", right_pad=">",
+        pad_width=-1)
+    self.assertEqual([b"< < a", b"< a b", b"a b >", b"b > >"], ngrams)
+    self.assertEqual([0, 4], splits)
+
+    ngrams, _ = self._ngrams(
+        ["a", "b"], [0, 2], ngram_widths=[3], left_pad="<", right_pad=">",
+        pad_width=1)
+    self.assertEqual([b"< a b", b"a b >"], ngrams)
+
+  def testShortSequences(self):
+    ngrams, splits = self._ngrams(["a", "b", "c"], [0, 1, 3],
+                                  ngram_widths=[3])
+    self.assertEqual([], ngrams)
+    self.assertEqual([0, 0, 0], splits)
+
+    ngrams, splits = self._ngrams(["a", "b", "c"], [0, 1, 1, 3],
+                                  ngram_widths=[3],
+                                  preserve_short_sequences=True)
+    self.assertEqual([b"a", b"b c"], ngrams)
+    self.assertEqual([0, 1, 1, 2], splits)
+
+  def testInt32Splits(self):
+    with self.test_session():
+      _, splits = string_ops.string_n_grams(
+          ["a", "b", "c"], constant_op.constant([0, 3], dtypes.int32),
+          ngram_widths=[2])
+      self.assertEqual(dtypes.int32, splits.dtype)
+      self.assertAllEqual([0, 2], splits.eval())
+
+  def testInvalidSplits(self):
+    for data_splits in [[1, 3], [0, 2], [0, 3, 2, 3]]:
+      with self.assertRaises(errors.InvalidArgumentError):
+        self._ngrams(["a", "b", "c"], data_splits, ngram_widths=[2])
+
+
+if __name__ == "__main__":
+  test.main()
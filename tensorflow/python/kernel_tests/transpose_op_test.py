@@ -396,6 +396,18 @@ class TransposeTest(test.TestCase):
     self._testBoth(
         np.arange(0, 1260).reshape([2, 3, 5, 7, 2, 3]).astype(np.int64))
 
+  def testLargeSizeCPU(self):
+    # Sizes that aren't multiples of the tile and packet sizes, plus a rank
+    # above 8.
+    for dtype in [np.int8, np.int16, np.int32, np.int64]:
+      for shape, perm in [([2, 37, 41, 3], [0, 3, 1, 2]),
+                          ([2, 41, 3, 37], [0, 2, 3, 1]),
+                          ([67, 35], [1, 0]), ([5, 33, 2, 19], [3, 1, 2, 0]),
+                          ([2, 3, 1, 2, 3, 2, 1, 3, 2, 3],
+                           [9, 0, 4, 2, 7, 1, 3, 8, 5, 6])]:
+        x = np.arange(np.prod(shape)).reshape(shape).astype(dtype)
+        self._compareCpu(x, np.array(perm, np.int32))
+
   def testTranspose2DAuto(self):
     x_np = [[1, 2, 3], [4, 5, 6]]
     for use_gpu in [False, True]:
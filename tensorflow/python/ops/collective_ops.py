@@ -22,7 +22,8 @@ from tensorflow.python.ops import gen_collective_ops
 
 
 def all_reduce(t, group_size, group_key, instance_key, merge_op, final_op,
-               subdiv_offsets=(0)):
+               subdiv_offsets=(0), compression='none', top_k_fraction=0.01,
+               implementation='ring'):
   """Reduces tensors collectively, across devices.
 
   Args:
@@ -38,6 +39,16 @@ def all_reduce(t, group_size, group_key, instance_key, merge_op, final_op,
     subdiv_offsets: a list of integer offsets into the tensor at which each
       independent subdivision should begin.  Use [0] if no subdivision should
       be done.
+    compression: 'none', 'fp16' to send float16 values between devices, or
+      'top_k' to send only the largest magnitude values in the reducing
+      phase, with the rest carried over to the next execution.  Only applies
+      to float32 tensors on CPU devices with merge_op 'Add'.
+    top_k_fraction: with compression 'top_k', the fraction of the values
+      of each chunk to send.
+    implementation: 'ring' to reduce with the default algorithms, or 'nccl'
+      to run an NCCL all-reduce.  'nccl' requires the group to consist of
+      GPUs of a single task, a CUDA build with the contrib/nccl kernels, and
+      merge_op 'Add' or 'Mul'; subdiv_offsets and compression are ignored.
 
   Returns:
     An Op implementing the distributed reduction.
@@ -55,7 +66,10 @@ def all_reduce(t, group_size, group_key, instance_key, merge_op, final_op,
                                               instance_key=instance_key,
                                               merge_op=merge_op,
                                               final_op=final_op,
-                                              subdiv_offsets=subdiv_offsets)
+                                              subdiv_offsets=subdiv_offsets,
+                                              compression=compression,
+                                              top_k_fraction=top_k_fraction,
+                                              implementation=implementation)
 
 
 def broadcast_send(t, shape, dtype, group_size, group_key, instance_key):
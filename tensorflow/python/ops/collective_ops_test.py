@@ -20,6 +20,7 @@ from __future__ import print_function
 
 from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import collective_ops
 from tensorflow.python.platform import test
@@ -53,6 +54,20 @@ class CollectiveOpTest(test.TestCase):
                                [0.3, 1.3, 2.3, 3.3, 4.3, 5.3, 6.3, 7.3],
                                [0.2, 1.2, 2.2, 3.2, 4.2, 5.2, 6.2, 7.2])
 
+  def testCollectiveReduceNcclRequiresGpu(self):
+    with self.test_session(
+        config=config_pb2.ConfigProto(device_count={'CPU': 2})) as sess:
+      colreds = []
+      for i in range(2):
+        with ops.device('/CPU:%d' % i):
+          colreds.append(collective_ops.all_reduce(
+              constant_op.constant([1.0, 2.0]), 2, 1, 1, 'Add', 'Id', [0],
+              implementation='nccl'))
+      run_options = config_pb2.RunOptions()
+      run_options.experimental.collective_graph_key = 1
+      with self.assertRaisesRegexp(errors.InternalError, 'NCCL implementation'):
+        sess.run(colreds, options=run_options)
+
   def _testCollectiveBroadcast(self, t0):
     group_key = 1
     instance_key = 1
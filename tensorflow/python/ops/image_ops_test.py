@@ -2847,6 +2847,46 @@ class JpegTest(test_util.TensorFlowTestCase):
             lambda e: "Invalid JPEG data or crop window" in str(e)):
           sess.run(result)
 
+  def testBatchDecodeAndCropAndResizeJpeg(self):
+    with self.test_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+      contents = array_ops.stack([jpeg0, jpeg0])
+
+      # Without resizing, the crops are exactly those of DecodeAndCropJpeg.
+      crop_windows = [[6, 5, 15, 10], [20, 30, 15, 10]]
+      images = image_ops.batch_decode_and_crop_and_resize_jpeg(
+          contents, crop_windows, [15, 10])
+      self.assertAllEqual([2, 15, 10, 3], images.get_shape().as_list())
+      expected = [
+          math_ops.to_float(image_ops.decode_and_crop_jpeg(jpeg0, window))
+          for window in crop_windows
+      ]
+      images, expected = sess.run([images, expected])
+      self.assertAllEqual(expected, images)
+
+      # Downscaling a whole image by 4 decodes it at a quarter of its size.
+      h, w = 256, 128
+      images = image_ops.batch_decode_and_crop_and_resize_jpeg(
+          contents, [[0, 0, h, w], [0, 0, h, w]], [h // 4, w // 4])
+      expected = math_ops.to_float(image_ops.decode_jpeg(jpeg0, ratio=4))
+      images, expected = sess.run([images, expected])
+      self.assertAllEqual([expected, expected], images)
+
+  def testBatchDecodeAndCropAndResizeJpegWithInvalidCropWindow(self):
+    with self.test_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+      contents = array_ops.stack([jpeg0, jpeg0])
+
+      h, w = 256, 128
+      images = image_ops.batch_decode_and_crop_and_resize_jpeg(
+          contents, [[0, 0, h, w], [0, 0, h + 1, w]], [8, 8])
+      with self.assertRaisesWithPredicateMatch(
+          errors.InvalidArgumentError,
+          lambda e: "Image 1: Invalid crop window" in str(e)):
+        sess.run(images)
+
   def testSynthetic(self):
     with self.test_session(use_gpu=True) as sess:
       # Encode it, then decode it, then encode it
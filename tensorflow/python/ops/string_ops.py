@@ -138,6 +138,8 @@ ops.NotDifferentiable("StringToHashBucketStrong")
 ops.NotDifferentiable("ReduceJoin")
 ops.NotDifferentiable("StringJoin")
 ops.NotDifferentiable("StringSplit")
+ops.NotDifferentiable("StringLower")
+ops.NotDifferentiable("StringNGrams")
 ops.NotDifferentiable("AsString")
 ops.NotDifferentiable("EncodeBase64")
 ops.NotDifferentiable("DecodeBase64")
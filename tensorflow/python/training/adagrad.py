@@ -99,6 +99,13 @@ class AdagradOptimizer(optimizer.Optimizer):
         grad,
         use_locking=self._use_locking)
 
+  def _apply_sparse_duplicate_indices(self, grad, var):
+    # The sparse Adagrad kernels sum the gradients of repeated indices.
+    return self._apply_sparse(grad, var)
+
+  def _resource_apply_sparse_duplicate_indices(self, grad, handle, indices):
+    return self._resource_apply_sparse(grad, handle, indices)
+
   def _apply_sparse(self, grad, var):
     acc = self.get_slot(var, "accumulator")
     return training_ops.sparse_apply_adagrad(
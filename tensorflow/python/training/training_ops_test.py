@@ -230,6 +230,69 @@ class TrainingOpsTest(TensorFlowTestCase):
       indices = np.array([0, 2]).astype(index_type)
       self._testTypesForSparseAdagrad(x, y, lr, grad, indices)
 
+  def testSparseApplyAdagradDuplicateIndices(self):
+    for (dtype, index_type) in itertools.product(
+        [np.float32, np.float64], [np.int32, np.int64]):
+      x = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]]).astype(dtype)
+      y = np.array([[1.0, 1.0], [2.0, 2.0], [3.0, 3.0]]).astype(dtype)
+      lr = np.array(2.0).astype(dtype)
+      grad = np.array([[0.5, 1.0], [1.5, 2.0], [0.25, 0.5]]).astype(dtype)
+      indices = np.array([2, 0, 2]).astype(index_type)
+      self.setUp()
+      with self.test_session(use_gpu=False):
+        var = variables.Variable(x)
+        accum = variables.Variable(y)
+        variables.global_variables_initializer().run()
+        training_ops.sparse_apply_adagrad(
+            var, accum, lr, grad,
+            constant_op.constant(indices, self._toType(indices.dtype))).eval()
+
+        # The gradients of duplicate indices are summed.
+        summed_grad = np.zeros_like(x)
+        np.add.at(summed_grad, indices, grad)
+        new_accum = y + summed_grad * summed_grad
+        new_var = x - lr * summed_grad * new_accum**(-0.5)
+        self.assertAllCloseAccordingToType(new_var, var.eval())
+        self.assertAllCloseAccordingToType(new_accum, accum.eval())
+
+  def testSparseApplyAdam(self):
+    for (dtype, index_type) in itertools.product(
+        [np.float16, np.float32, np.float64], [np.int32, np.int64]):
+      var = np.array([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]]).astype(dtype)
+      m = np.array([[0.1, 0.2], [0.3, 0.4], [0.5, 0.6]]).astype(dtype)
+      v = np.array([[1.0, 1.0], [2.0, 2.0], [3.0, 3.0]]).astype(dtype)
+      grad = np.array([[0.5, 1.0], [1.5, 2.0], [0.25, 0.5]]).astype(dtype)
+      indices = np.array([2, 0, 2]).astype(index_type)
+      t = 2
+      beta1 = np.array(0.9, dtype=dtype)
+      beta2 = np.array(0.999, dtype=dtype)
+      lr = np.array(0.1, dtype=dtype)
+      epsilon = np.array(1e-3, dtype=dtype)
+      self.setUp()
+      with self.test_session(use_gpu=False):
+        var_t = variables.Variable(var)
+        m_t = variables.Variable(m)
+        v_t = variables.Variable(v)
+        variables.global_variables_initializer().run()
+        training_ops.sparse_apply_adam(
+            var_t, m_t, v_t, beta1**t, beta2**t, lr, beta1, beta2, epsilon,
+            grad,
+            constant_op.constant(indices, self._toType(indices.dtype))).eval()
+
+        # Only the rows with a gradient are updated, with the gradients of
+        # duplicate indices summed.
+        summed_grad = np.zeros_like(var)
+        np.add.at(summed_grad, indices, grad)
+        new_var, new_m, new_v = self._adamUpdateNumpy(
+            var, summed_grad, t, m, v, lr, beta1, beta2, epsilon)
+        for i in [0, 2]:
+          self.assertAllCloseAccordingToType(new_var[i], var_t.eval()[i])
+          self.assertAllCloseAccordingToType(new_m[i], m_t.eval()[i])
+          self.assertAllCloseAccordingToType(new_v[i], v_t.eval()[i])
+        self.assertAllCloseAccordingToType(var[1], var_t.eval()[1])
+        self.assertAllCloseAccordingToType(m[1], m_t.eval()[1])
+        self.assertAllCloseAccordingToType(v[1], v_t.eval()[1])
+
   def testSparseApplyFtrlDim1(self):
     for (dtype, index_type) in itertools.product(
         [np.float16, np.float32, np.float64], [np.int32, np.int64]):
@@ -286,6 +349,39 @@ class TrainingOpsTest(TensorFlowTestCase):
       self.assertShapeEqual(out, apply_adam)
       self.assertAllCloseAccordingToType(new_var, out)
 
+  def testResourceApplyAdamN(self):
+    for dtype, use_gpu in itertools.product(
+        [np.float16, np.float32, np.float64], [False, True]):
+      self.setUp()
+      with self.test_session(use_gpu=use_gpu):
+        sizes = [1, 3, 100]
+        var = [np.arange(n).astype(dtype) for n in sizes]
+        m = [np.arange(1, n + 1).astype(dtype) for n in sizes]
+        v = [np.arange(101, n + 101).astype(dtype) for n in sizes]
+        grad = [np.arange(n).astype(dtype) * 0.5 for n in sizes]
+        var_t = [resource_variable_ops.ResourceVariable(x) for x in var]
+        m_t = [resource_variable_ops.ResourceVariable(x) for x in m]
+        v_t = [resource_variable_ops.ResourceVariable(x) for x in v]
+
+        t = 1
+        beta1 = np.array(0.9, dtype=dtype)
+        beta2 = np.array(0.999, dtype=dtype)
+        lr = np.array(0.001, dtype=dtype)
+        epsilon = np.array(1e-8, dtype=dtype)
+        variables.global_variables_initializer().run()
+
+        apply_adam = training_ops.resource_apply_adam_n(
+            [x.handle for x in var_t], [x.handle for x in m_t],
+            [x.handle for x in v_t], beta1**t, beta2**t, lr, beta1, beta2,
+            epsilon, grad)
+        apply_adam.run()
+        for i in range(len(sizes)):
+          new_var, new_m, new_v = self._adamUpdateNumpy(
+              var[i], grad[i], t, m[i], v[i], lr, beta1, beta2, epsilon)
+          self.assertAllCloseAccordingToType(new_var, var_t[i].eval())
+          self.assertAllCloseAccordingToType(new_m, m_t[i].eval())
+          self.assertAllCloseAccordingToType(new_v, v_t[i].eval())
+
   def _adamUpdateNumpy(self, param, g_t, t, m, v, alpha, beta1, beta2, epsilon):
     alpha_t = alpha * np.sqrt(1 - beta2**t) / (1 - beta1**t)
 
@@ -1288,7 +1288,60 @@ class CudnnRnnSequenceTensorDescriptor
     handles_.assign(seq_length, handle);
   }
 
+  // A descriptor for sequences of variable lengths, padded to seq_length.
+  // The per-step handles still describe the padded batch, which is what
+  // cuDNN expects when sizing the workspace and the reserve space.
+  CudnnRnnSequenceTensorDescriptor(CUDAExecutor* parent, int seq_length,
+                                   int batch_size, int data_size,
+                                   const port::ArraySlice<int>& seq_lengths,
+                                   cudnnDataType_t data_type)
+      : CudnnRnnSequenceTensorDescriptor(parent, seq_length, batch_size,
+                                         data_size, data_type) {
+    if (!ok()) return;
+    if (static_cast<int>(seq_lengths.size()) != batch_size) {
+      string error_msg =
+          port::StrCat("expected ", batch_size, " sequence lengths, got ",
+                       seq_lengths.size());
+      LOG(ERROR) << error_msg;
+      SetFailure(port::Status(port::error::INVALID_ARGUMENT, error_msg));
+      return;
+    }
+    for (int length : seq_lengths) {
+      if (length <= 0 || length > seq_length) {
+        string error_msg = port::StrCat("sequence length must be in [1, ",
+                                        seq_length, "]: ", length);
+        LOG(ERROR) << error_msg;
+        SetFailure(port::Status(port::error::INVALID_ARGUMENT, error_msg));
+        return;
+      }
+    }
+#if CUDNN_VERSION >= 7201
+    cudnnStatus_t status = cudnnCreateRNNDataDescriptor(&rnn_data_handle_);
+    CUDNN_RETURN_IF_FAIL(status, "Failed to create RNN data descriptor");
+    // The padded steps of the output are filled with zeros. An all-zero bit
+    // pattern is a zero in every floating point type.
+    static double kPaddingFill = 0.0;
+    status = cudnnSetRNNDataDescriptor(
+        /*RNNDataDesc=*/rnn_data_handle_, /*dataType=*/data_type,
+        /*layout=*/CUDNN_RNN_DATA_LAYOUT_SEQ_MAJOR_UNPACKED,
+        /*maxSeqLength=*/seq_length, /*batchSize=*/batch_size,
+        /*vectorSize=*/data_size, /*seqLengthArray=*/seq_lengths.data(),
+        /*paddingFill=*/&kPaddingFill);
+    CUDNN_RETURN_IF_FAIL(status, "Failed to update RNN data descriptor");
+#else
+    SetFailure(port::Status(
+        port::error::UNIMPLEMENTED,
+        "Variable sequence lengths require cuDNN 7.2.1 or higher"));
+#endif
+  }
+
   ~CudnnRnnSequenceTensorDescriptor() override {
+#if CUDNN_VERSION >= 7201
+    if (rnn_data_handle_ != nullptr) {
+      cudnnStatus_t status = cudnnDestroyRNNDataDescriptor(rnn_data_handle_);
+      CUDNN_RETURN_IF_FAIL(status, "Failed to destroy RNN data descriptor");
+    }
+#endif
     // Only the first one needs to be destroyed. All others are the same.
     cudnnStatus_t status = cudnnDestroyTensorDescriptor(handles_[0]);
     CUDNN_RETURN_IF_FAIL(status,
@@ -1301,6 +1354,23 @@ class CudnnRnnSequenceTensorDescriptor
     return handles_.data();
   }
 
+#if CUDNN_VERSION >= 7201
+  cudnnRNNDataDescriptor_t rnn_data_handle() const {
+    if (!ok()) return nullptr;
+    return rnn_data_handle_;
+  }
+#endif
+
+  // Whether the sequences have variable lengths. The padded steps of such
+  // sequences are skipped by the *Ex variants of the cuDNN RNN calls.
+  bool is_var_seq_lengths() const {
+#if CUDNN_VERSION >= 7201
+    return rnn_data_handle_ != nullptr;
+#else
+    return false;
+#endif
+  }
+
   int seq_length() const { return seq_length_; }
   int batch_size() const { return batch_size_; }
   int data_size() const { return data_size_; }
@@ -1312,6 +1382,9 @@ class CudnnRnnSequenceTensorDescriptor
   int data_size_;
   cudnnDataType_t data_type_;
   std::vector<cudnnTensorDescriptor_t> handles_;
+#if CUDNN_VERSION >= 7201
+  cudnnRNNDataDescriptor_t rnn_data_handle_ = nullptr;
+#endif
   SE_DISALLOW_COPY_AND_ASSIGN(CudnnRnnSequenceTensorDescriptor);
 };
 
@@ -1570,8 +1643,44 @@ bool CudnnSupport::DoRnnForwardImpl(
     }
   }
   // make the forward call
-  cudnnStatus_t status;
-  if (!is_training) {
+  cudnnStatus_t status = CUDNN_STATUS_NOT_SUPPORTED;
+  if (input_desc.is_var_seq_lengths()) {
+#if CUDNN_VERSION >= 7201
+    if (!is_training) {
+      status = cudnnRNNForwardInferenceEx(
+          /*handle=*/cudnn.handle(), /*rnnDesc=*/rnn_desc.handle(),
+          /*xDesc=*/input_desc.rnn_data_handle(), /*x=*/input_data.opaque(),
+          /*hxDesc=*/input_h_desc.handle(), /*hx=*/input_h_data.opaque(),
+          /*cxDesc=*/input_c_desc.handle(), /*cx=*/input_c_data.opaque(),
+          /*wDesc=*/rnn_desc.params_handle(), /*w=*/params.opaque(),
+          /*yDesc=*/output_desc.rnn_data_handle(),
+          /*y=*/output_data->opaque(), /*hyDesc=*/output_h_desc.handle(),
+          /*hy=*/output_h_data->opaque(), /*cyDesc=*/output_c_desc.handle(),
+          /*cy=*/output_c_data->opaque(), /*kDesc=*/nullptr, /*keys=*/nullptr,
+          /*cDesc=*/nullptr, /*cAttn=*/nullptr, /*iDesc=*/nullptr,
+          /*iAttn=*/nullptr, /*qDesc=*/nullptr, /*queries=*/nullptr,
+          /*workSpace=*/workspace.opaque(),
+          /*workSpaceSizeInBytes=*/workspace.size());
+    } else {
+      status = cudnnRNNForwardTrainingEx(
+          /*handle=*/cudnn.handle(), /*rnnDesc=*/rnn_desc.handle(),
+          /*xDesc=*/input_desc.rnn_data_handle(), /*x=*/input_data.opaque(),
+          /*hxDesc=*/input_h_desc.handle(), /*hx=*/input_h_data.opaque(),
+          /*cxDesc=*/input_c_desc.handle(), /*cx=*/input_c_data.opaque(),
+          /*wDesc=*/rnn_desc.params_handle(), /*w=*/params.opaque(),
+          /*yDesc=*/output_desc.rnn_data_handle(),
+          /*y=*/output_data->opaque(), /*hyDesc=*/output_h_desc.handle(),
+          /*hy=*/output_h_data->opaque(), /*cyDesc=*/output_c_desc.handle(),
+          /*cy=*/output_c_data->opaque(), /*kDesc=*/nullptr, /*keys=*/nullptr,
+          /*cDesc=*/nullptr, /*cAttn=*/nullptr, /*iDesc=*/nullptr,
+          /*iAttn=*/nullptr, /*qDesc=*/nullptr, /*queries=*/nullptr,
+          /*workSpace=*/workspace.opaque(),
+          /*workSpaceSizeInBytes=*/workspace.size(),
+          /*reserveSpace=*/reserve_space.opaque(),
+          /*reserveSpaceSizeInBytes=*/reserve_space.size());
+    }
+#endif
+  } else if (!is_training) {
     status = cudnnRNNForwardInference(
         /*handle=*/cudnn.handle(), /*rnnDesc=*/rnn_desc.handle(),
         /*seqLength=*/model_dims.seq_length, /*xDesc=*/input_desc.handles(),
@@ -1690,25 +1799,58 @@ bool CudnnSupport::DoRnnBackwardImpl(
     }
   }
   // make the backward data call
-  cudnnStatus_t status = cudnnRNNBackwardData(
-      /*handle=*/cudnn.handle(), /*rnnDesc=*/rnn_desc.handle(),
-      /*seqLength=*/model_dims.seq_length, /*yDesc=*/output_desc.handles(),
-      /*y=*/output_data.opaque(), /*dyDesc=*/output_desc.handles(),
-      /*dy=*/output_backprop_data.opaque(), /*dhyDesc=*/output_h_desc.handle(),
-      /*dhy=*/output_h_backprop_data.opaque(),
-      /*dcyDesc=*/output_c_desc.handle(),
-      /*dcy=*/output_c_backprop_data.opaque(),
-      /*wDesc=*/rnn_desc.params_handle(), /*w=*/params.opaque(),
-      /*hxDesc=*/input_h_desc.handle(), /*hx=*/input_h_data.opaque(),
-      /*cxDesc=*/input_c_desc.handle(), /*cx=*/input_c_data.opaque(),
-      /*dxDesc=*/input_desc.handles(), /*dx=*/input_backprop_data->opaque(),
-      /*dhxDesc=*/input_h_desc.handle(),
-      /*dhx=*/input_h_backprop_data->opaque(),
-      /*dcxDesc=*/input_c_desc.handle(),
-      /*dcx=*/input_c_backprop_data->opaque(), /*workspace=*/workspace.opaque(),
-      /*workSpaceSizeInBytes=*/workspace.size(),
-      /*reserveSpace=*/reserve_space_data->opaque(),
-      /*reserveSpaceSizeInBytes=*/reserve_space_data->size());
+  cudnnStatus_t status = CUDNN_STATUS_NOT_SUPPORTED;
+  if (input_desc.is_var_seq_lengths()) {
+#if CUDNN_VERSION >= 7201
+    // The padded steps of dx are not written by cuDNN.
+    stream->ThenMemZero(input_backprop_data, input_backprop_data->size());
+    status = cudnnRNNBackwardDataEx(
+        /*handle=*/cudnn.handle(), /*rnnDesc=*/rnn_desc.handle(),
+        /*yDesc=*/output_desc.rnn_data_handle(), /*y=*/output_data.opaque(),
+        /*dyDesc=*/output_desc.rnn_data_handle(),
+        /*dy=*/output_backprop_data.opaque(), /*dcDesc=*/nullptr,
+        /*dcAttn=*/nullptr, /*dhyDesc=*/output_h_desc.handle(),
+        /*dhy=*/output_h_backprop_data.opaque(),
+        /*dcyDesc=*/output_c_desc.handle(),
+        /*dcy=*/output_c_backprop_data.opaque(),
+        /*wDesc=*/rnn_desc.params_handle(), /*w=*/params.opaque(),
+        /*hxDesc=*/input_h_desc.handle(), /*hx=*/input_h_data.opaque(),
+        /*cxDesc=*/input_c_desc.handle(), /*cx=*/input_c_data.opaque(),
+        /*dxDesc=*/input_desc.rnn_data_handle(),
+        /*dx=*/input_backprop_data->opaque(),
+        /*dhxDesc=*/input_h_desc.handle(),
+        /*dhx=*/input_h_backprop_data->opaque(),
+        /*dcxDesc=*/input_c_desc.handle(),
+        /*dcx=*/input_c_backprop_data->opaque(), /*dkDesc=*/nullptr,
+        /*dkeys=*/nullptr, /*workSpace=*/workspace.opaque(),
+        /*workSpaceSizeInBytes=*/workspace.size(),
+        /*reserveSpace=*/reserve_space_data->opaque(),
+        /*reserveSpaceSizeInBytes=*/reserve_space_data->size());
+#endif
+  } else {
+    status = cudnnRNNBackwardData(
+        /*handle=*/cudnn.handle(), /*rnnDesc=*/rnn_desc.handle(),
+        /*seqLength=*/model_dims.seq_length, /*yDesc=*/output_desc.handles(),
+        /*y=*/output_data.opaque(), /*dyDesc=*/output_desc.handles(),
+        /*dy=*/output_backprop_data.opaque(),
+        /*dhyDesc=*/output_h_desc.handle(),
+        /*dhy=*/output_h_backprop_data.opaque(),
+        /*dcyDesc=*/output_c_desc.handle(),
+        /*dcy=*/output_c_backprop_data.opaque(),
+        /*wDesc=*/rnn_desc.params_handle(), /*w=*/params.opaque(),
+        /*hxDesc=*/input_h_desc.handle(), /*hx=*/input_h_data.opaque(),
+        /*cxDesc=*/input_c_desc.handle(), /*cx=*/input_c_data.opaque(),
+        /*dxDesc=*/input_desc.handles(),
+        /*dx=*/input_backprop_data->opaque(),
+        /*dhxDesc=*/input_h_desc.handle(),
+        /*dhx=*/input_h_backprop_data->opaque(),
+        /*dcxDesc=*/input_c_desc.handle(),
+        /*dcx=*/input_c_backprop_data->opaque(),
+        /*workspace=*/workspace.opaque(),
+        /*workSpaceSizeInBytes=*/workspace.size(),
+        /*reserveSpace=*/reserve_space_data->opaque(),
+        /*reserveSpaceSizeInBytes=*/reserve_space_data->size());
+  }
 
   if (status != CUDNN_STATUS_SUCCESS) {
     if (is_profiling) {
@@ -1722,17 +1864,33 @@ bool CudnnSupport::DoRnnBackwardImpl(
     // Clear the dw to zeros.
     stream->ThenMemZero(params_backprop_data, params_backprop_data->size());
     // make the backward weight call
-    status = cudnnRNNBackwardWeights(
-        /*handle=*/cudnn.handle(), /*rnnDesc=*/rnn_desc.handle(),
-        /*seqLength=*/model_dims.seq_length, /*xDesc=*/input_desc.handles(),
-        /*x=*/input_data.opaque(), /*hxDesc=*/input_h_desc.handle(),
-        /*hx=*/input_h_data.opaque(), /*yDesc=*/output_desc.handles(),
-        /*y=*/output_data.opaque(), /*workspace=*/workspace.opaque(),
-        /*workSpaceSizeInBytes=*/workspace.size(),
-        /*dwDesc=*/rnn_desc.params_handle(),
-        /*dw=*/params_backprop_data->opaque(),
-        /*reserveSpace=*/reserve_space_data->opaque(),
-        /*reserveSpaceSizeInBytes=*/reserve_space_data->size());
+    if (input_desc.is_var_seq_lengths()) {
+#if CUDNN_VERSION >= 7201
+      status = cudnnRNNBackwardWeightsEx(
+          /*handle=*/cudnn.handle(), /*rnnDesc=*/rnn_desc.handle(),
+          /*xDesc=*/input_desc.rnn_data_handle(), /*x=*/input_data.opaque(),
+          /*hxDesc=*/input_h_desc.handle(), /*hx=*/input_h_data.opaque(),
+          /*yDesc=*/output_desc.rnn_data_handle(), /*y=*/output_data.opaque(),
+          /*workSpace=*/workspace.opaque(),
+          /*workSpaceSizeInBytes=*/workspace.size(),
+          /*dwDesc=*/rnn_desc.params_handle(),
+          /*dw=*/params_backprop_data->opaque(),
+          /*reserveSpace=*/reserve_space_data->opaque(),
+          /*reserveSpaceSizeInBytes=*/reserve_space_data->size());
+#endif
+    } else {
+      status = cudnnRNNBackwardWeights(
+          /*handle=*/cudnn.handle(), /*rnnDesc=*/rnn_desc.handle(),
+          /*seqLength=*/model_dims.seq_length, /*xDesc=*/input_desc.handles(),
+          /*x=*/input_data.opaque(), /*hxDesc=*/input_h_desc.handle(),
+          /*hx=*/input_h_data.opaque(), /*yDesc=*/output_desc.handles(),
+          /*y=*/output_data.opaque(), /*workspace=*/workspace.opaque(),
+          /*workSpaceSizeInBytes=*/workspace.size(),
+          /*dwDesc=*/rnn_desc.params_handle(),
+          /*dw=*/params_backprop_data->opaque(),
+          /*reserveSpace=*/reserve_space_data->opaque(),
+          /*reserveSpaceSizeInBytes=*/reserve_space_data->size());
+    }
     if (status != CUDNN_STATUS_SUCCESS) {
       if (is_profiling) {
         timer->Stop(AsCUDAStream(stream));
@@ -1793,6 +1951,21 @@ CudnnSupport::createRnnSequenceTensorDescriptor(int seq_length, int batch_size,
       std::move(seq_desc));
 }
 
+port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+CudnnSupport::createRnnSequenceTensorDescriptor(
+    int max_seq_length, int batch_size, int data_size,
+    const port::ArraySlice<int>& seq_lengths, dnn::DataType data_type) {
+  std::unique_ptr<CudnnRnnSequenceTensorDescriptor> seq_desc(
+      new CudnnRnnSequenceTensorDescriptor(parent_, max_seq_length, batch_size,
+                                           data_size, seq_lengths,
+                                           ToCudnnDataType(data_type)));
+  if (!seq_desc->ok()) {
+    return seq_desc->Status();
+  }
+  return port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>(
+      std::move(seq_desc));
+}
+
 port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
 CudnnSupport::createRnnStateTensorDescriptor(int num_layer, int batch_size,
                                              int data_size,
@@ -276,20 +276,35 @@ bool CUDAExecutor::GetKernel(const MultiKernelLoaderSpec &spec,
     LOG(WARNING) << "no method of loading CUDA kernel provided";
     return false;
   }
-  VLOG(2) << "getting function " << *kernelname << " from module " << module;
-  if (!CUDADriver::GetModuleFunction(context_, module, kernelname->c_str(),
-                                     cuda_kernel->cuda_function_ptr())) {
-    return false;
+  KernelMetadata kernel_metadata;
+  bool found_function = false;
+  {
+    mutex_lock lock{in_memory_modules_mu_};
+    auto it = module_functions_.find({module, *kernelname});
+    if (it != module_functions_.end()) {
+      *cuda_kernel->cuda_function_ptr() = it->second.first;
+      kernel_metadata = it->second.second;
+      found_function = true;
+    }
+  }
+  if (!found_function) {
+    VLOG(2) << "getting function " << *kernelname << " from module " << module;
+    if (!CUDADriver::GetModuleFunction(context_, module, kernelname->c_str(),
+                                       cuda_kernel->cuda_function_ptr())) {
+      return false;
+    }
+    if (!GetKernelMetadata(cuda_kernel, &kernel_metadata)) {
+      LOG(WARNING) << "unable to get metadata for kernel " << *kernelname;
+    }
+    mutex_lock lock{in_memory_modules_mu_};
+    module_functions_[{module, *kernelname}] = {
+        cuda_kernel->AsCUDAFunctionValue(), kernel_metadata};
   }
 
   // We have to trust the kernel loader spec arity because there doesn't appear
   // to be a way to reflect on the number of expected arguments w/the CUDA API.
   cuda_kernel->set_arity(spec.arity());
 
-  KernelMetadata kernel_metadata;
-  if (!GetKernelMetadata(cuda_kernel, &kernel_metadata)) {
-    LOG(WARNING) << "unable to get metadata for kernel " << *kernelname;
-  }
   kernel->set_metadata(kernel_metadata);
   kernel->set_name(*kernelname);
   return true;
@@ -320,6 +335,11 @@ void CUDAExecutor::UnloadKernel(const KernelBase *kernel) {
           << " into CUDA module " << module << " with refcount " << refcount;
   if (--refcount == 0) {
     VLOG(3) << "Unloading CUDA module " << module;
+    auto function_it = module_functions_.lower_bound({module, ""});
+    while (function_it != module_functions_.end() &&
+           function_it->first.first == module) {
+      function_it = module_functions_.erase(function_it);
+    }
     CUDADriver::UnloadModule(context_, module);
     gpu_binary_to_module_.erase(module_it);
   }
@@ -369,7 +389,20 @@ bool CUDAExecutor::Launch(Stream *stream, const ThreadDim &thread_dims,
 
   if (cuda_kernel->GetPreferredCacheConfig() !=
       KernelCacheConfig::kNoPreference) {
-    CUDADriver::FuncSetCacheConfig(cufunc, cuda_kernel->GetCUDACacheConfig());
+    const CUfunc_cache cache_config = cuda_kernel->GetCUDACacheConfig();
+    bool apply_cache_config;
+    {
+      mutex_lock lock(launched_kernels_mu_);
+      auto it = applied_cache_configs_.find(cufunc);
+      apply_cache_config =
+          it == applied_cache_configs_.end() || it->second != cache_config;
+      if (apply_cache_config) {
+        applied_cache_configs_[cufunc] = cache_config;
+      }
+    }
+    if (apply_cache_config) {
+      CUDADriver::FuncSetCacheConfig(cufunc, cache_config);
+    }
   }
 
   void **kernel_params = const_cast<void **>(args.argument_addresses().data());
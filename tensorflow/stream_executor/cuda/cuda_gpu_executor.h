@@ -22,6 +22,7 @@ limitations under the License.
 #ifndef TENSORFLOW_STREAM_EXECUTOR_CUDA_CUDA_GPU_EXECUTOR_H_
 #define TENSORFLOW_STREAM_EXECUTOR_CUDA_CUDA_GPU_EXECUTOR_H_
 
+#include <map>
 #include <set>
 #include <unordered_map>
 
@@ -248,14 +249,24 @@ class CUDAExecutor : public internal::StreamExecutorInterface {
   // GPU binary (PTX or CUBIN) -> {CUDA module, reference count}.
   std::unordered_map<const void *, std::pair<CUmodule, uint64>>
       gpu_binary_to_module_ GUARDED_BY(in_memory_modules_mu_);
+  // {CUDA module, kernel name} -> {function handle, metadata}, so that loading
+  // a kernel again from a resident module doesn't query the driver. Entries
+  // are dropped when their module is unloaded.
+  std::map<std::pair<CUmodule, string>, std::pair<CUfunction, KernelMetadata>>
+      module_functions_ GUARDED_BY(in_memory_modules_mu_);
 
-  // Guards the launched kernel set.
+  // Guards the launched kernel set and the applied cache configurations.
   mutex launched_kernels_mu_;
 
   // Keeps track of the set of launched kernels. Currently used to suppress the
   // occupancy check on subsequent launches.
   std::set<CUfunction> launched_kernels_ GUARDED_BY(launched_kernels_mu_);
 
+  // Cache configuration last set on each function, so that launches only call
+  // into the driver when a kernel's preference actually changes.
+  std::unordered_map<CUfunction, CUfunc_cache> applied_cache_configs_
+      GUARDED_BY(launched_kernels_mu_);
+
   // Handle for the CUDA device being operated on. Immutable
   // post-initialization.
   CUdevice device_;
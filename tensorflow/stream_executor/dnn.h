@@ -2052,6 +2052,28 @@ class DnnSupport {
                         "createRnnSequenceTensorDescriptor is unimplemented");
   }
 
+  // Create a RNN sequence descriptor for a batch of sequences of variable
+  // lengths, padded to max_seq_length in time-major layout. The steps past
+  // the end of a sequence are neither read nor computed, and the output at
+  // those steps is zero. The caller retains the ownership of the returned
+  // descriptor.
+  //
+  // Arguments:
+  //  max_seq_length: the length of the longest sequence.
+  //  batch_size: the size of a minibatch.
+  //  data_size: the size of the state.
+  //  seq_lengths: the length of each sequence in the minibatch, of size
+  //    batch_size.
+  //  data_type: an enum to specify the type for the underlying data.
+  virtual port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+  createRnnSequenceTensorDescriptor(int max_seq_length, int batch_size,
+                                    int data_size,
+                                    const port::ArraySlice<int>& seq_lengths,
+                                    dnn::DataType data_type) {
+    return port::Status(port::error::UNIMPLEMENTED,
+                        "createRnnSequenceTensorDescriptor is unimplemented");
+  }
+
   // Create an RNN state descriptor that specifies the input or hidden state.
   // The caller retains the ownership of the returned descriptor.
   virtual port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
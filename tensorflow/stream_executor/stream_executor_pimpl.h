@@ -398,6 +398,15 @@ class StreamExecutor {
   createRnnSequenceTensorDescriptor(int seq_length, int batch_size,
                                     int data_size, dnn::DataType data_type);
 
+  // Create a RNN sequence descriptor for a batch of padded sequences of
+  // variable lengths. The caller retains the ownership of the returned
+  // descriptor.
+  port::StatusOr<std::unique_ptr<dnn::RnnSequenceTensorDescriptor>>
+  createRnnSequenceTensorDescriptor(int max_seq_length, int batch_size,
+                                    int data_size,
+                                    const port::ArraySlice<int> &seq_lengths,
+                                    dnn::DataType data_type);
+
   // Create an RNN state descriptor that specifies the input or hidden state.
   // The caller retains the ownership of the returned descriptor.
   port::StatusOr<std::unique_ptr<dnn::RnnStateTensorDescriptor>>
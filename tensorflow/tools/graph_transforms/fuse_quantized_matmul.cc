@@ -0,0 +1,153 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+namespace {
+
+// Returns true if the matched QuantizedMatMul and Requantize nodes only use
+// the eight-bit types the fused kernel supports.
+bool HasFusableTypes(const NodeDef& matmul_node,
+                     const NodeDef& requantize_node) {
+  DataType t1, t2, out_type;
+  if (!GetNodeAttr(matmul_node, "T1", &t1).ok() ||
+      !GetNodeAttr(matmul_node, "T2", &t2).ok() ||
+      !GetNodeAttr(requantize_node, "out_type", &out_type).ok()) {
+    return false;
+  }
+  return t1 == DT_QUINT8 && t2 == DT_QUINT8 && out_type == DT_QUINT8;
+}
+
+// Builds the QuantizedMatMulWithRequantize node that replaces a
+// QuantizedMatMul, a Requantize with constant ranges and an optional
+// activation. The fused node takes the name of the last node it replaces, so
+// that its consumers don't need to be rewired.
+NodeDef MakeFusedMatMul(const NodeDef& matmul_node,
+                        const NodeDef& requantize_node, const string& name,
+                        const string& activation) {
+  NodeDef fused_node;
+  fused_node.set_op("QuantizedMatMulWithRequantize");
+  fused_node.set_name(name);
+  for (int i = 0; i < 6; ++i) {
+    AddNodeInput(matmul_node.input(i), &fused_node);
+  }
+  AddNodeInput(requantize_node.input(3), &fused_node);
+  AddNodeInput(requantize_node.input(4), &fused_node);
+  CopyNodeAttr(matmul_node, "T1", "T1", &fused_node);
+  CopyNodeAttr(matmul_node, "T2", "T2", &fused_node);
+  CopyNodeAttr(requantize_node, "out_type", "out_type", &fused_node);
+  CopyNodeAttr(matmul_node, "transpose_a", "transpose_a", &fused_node);
+  CopyNodeAttr(matmul_node, "transpose_b", "transpose_b", &fused_node);
+  SetNodeAttr("activation", activation, &fused_node);
+  return fused_node;
+}
+
+}  // namespace
+
+// Once the requantization ranges of an eight-bit graph have been frozen, every
+// QuantizedMatMul is followed by a Requantize with constant ranges, and often
+// by a QuantizedRelu or QuantizedRelu6. This transform replaces each of those
+// chains with one QuantizedMatMulWithRequantize op, which requantizes and
+// applies the activation as it writes out the product, instead of passing a
+// 32-bit intermediate between three kernels.
+Status FuseQuantizedMatMul(const GraphDef& input_graph_def,
+                           const TransformFuncContext& context,
+                           GraphDef* output_graph_def) {
+  GraphDef activation_fused_graph_def;
+  TF_RETURN_IF_ERROR(ReplaceMatchingOpTypes(
+      input_graph_def,  // clang-format off
+      {"QuantizedRelu|QuantizedRelu6",
+        {
+          {"Requantize",
+            {
+              {"QuantizedMatMul"},
+              {"QuantizedMatMul"},
+              {"QuantizedMatMul"},
+              {"Const"},
+              {"Const"},
+            }
+          },
+          {"Requantize"},
+          {"Requantize"},
+        }
+      },  // clang-format on
+      [](const NodeMatch& match, const std::set<string>& input_nodes,
+         const std::set<string>& output_nodes,
+         std::vector<NodeDef>* new_nodes) {
+        const NodeDef& activation_node = match.node;
+        const NodeDef& requantize_node = match.inputs[0].node;
+        const NodeDef& matmul_node = match.inputs[0].inputs[0].node;
+        const NodeDef& min_node = match.inputs[0].inputs[3].node;
+        const NodeDef& max_node = match.inputs[0].inputs[4].node;
+        DataType activation_out_type;
+        if (!HasFusableTypes(matmul_node, requantize_node) ||
+            !GetNodeAttr(activation_node, "out_type", &activation_out_type)
+                 .ok() ||
+            activation_out_type != DT_QUINT8) {
+          CopyOriginalMatch(match, new_nodes);
+          return Status::OK();
+        }
+        new_nodes->push_back(min_node);
+        new_nodes->push_back(max_node);
+        const string activation =
+            activation_node.op() == "QuantizedRelu6" ? "Relu6" : "Relu";
+        new_nodes->push_back(MakeFusedMatMul(matmul_node, requantize_node,
+                                             activation_node.name(),
+                                             activation));
+        return Status::OK();
+      },
+      {}, &activation_fused_graph_def));
+
+  TF_RETURN_IF_ERROR(ReplaceMatchingOpTypes(
+      activation_fused_graph_def,  // clang-format off
+      {"Requantize",
+        {
+          {"QuantizedMatMul"},
+          {"QuantizedMatMul"},
+          {"QuantizedMatMul"},
+          {"Const"},
+          {"Const"},
+        }
+      },  // clang-format on
+      [](const NodeMatch& match, const std::set<string>& input_nodes,
+         const std::set<string>& output_nodes,
+         std::vector<NodeDef>* new_nodes) {
+        const NodeDef& requantize_node = match.node;
+        const NodeDef& matmul_node = match.inputs[0].node;
+        const NodeDef& min_node = match.inputs[3].node;
+        const NodeDef& max_node = match.inputs[4].node;
+        if (!HasFusableTypes(matmul_node, requantize_node)) {
+          CopyOriginalMatch(match, new_nodes);
+          return Status::OK();
+        }
+        new_nodes->push_back(min_node);
+        new_nodes->push_back(max_node);
+        new_nodes->push_back(MakeFusedMatMul(matmul_node, requantize_node,
+                                             requantize_node.name(), "None"));
+        return Status::OK();
+      },
+      {}, output_graph_def));
+
+  return Status::OK();
+}
+
+REGISTER_GRAPH_TRANSFORM("fuse_quantized_matmul", FuseQuantizedMatMul);
+
+}  // namespace graph_transforms
+}  // namespace tensorflow
@@ -0,0 +1,116 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/nn_ops.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/tools/graph_transforms/transform_utils.h"
+
+namespace tensorflow {
+namespace graph_transforms {
+
+// Declare here, so we don't need a public header.
+Status FuseQuantizedMatMul(const GraphDef& input_graph_def,
+                           const TransformFuncContext& context,
+                           GraphDef* output_graph_def);
+
+class FuseQuantizedMatMulTest : public ::testing::Test {
+ protected:
+  void TestFuseQuantizedMatMul(bool with_relu) {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor a_tensor(DT_QUINT8, TensorShape({2, 3}));
+    test::FillValues<quint8>(&a_tensor, {0, 40, 80, 120, 200, 255});
+    Output a_op = Const(root.WithOpName("a_op"), Input::Initializer(a_tensor));
+    Tensor b_tensor(DT_QUINT8, TensorShape({3, 4}));
+    test::FillValues<quint8>(&b_tensor,
+                             {7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 255});
+    Output b_op = Const(root.WithOpName("b_op"), Input::Initializer(b_tensor));
+
+    QuantizedMatMul matmul_op(root.WithOpName("matmul_op"), a_op, b_op,
+                              Const(root.WithOpName("min_a"), -1.0f),
+                              Const(root.WithOpName("max_a"), 1.0f),
+                              Const(root.WithOpName("min_b"), -2.0f),
+                              Const(root.WithOpName("max_b"), 0.5f));
+    Requantize requantize_op(
+        root.WithOpName("requantize_op"), matmul_op.out, matmul_op.min_out,
+        matmul_op.max_out, Const(root.WithOpName("requant_min"), -3.0f),
+        Const(root.WithOpName("requant_max"), 3.0f), DT_QUINT8);
+    Output output_op = requantize_op.output;
+    Output output_min_op = requantize_op.output_min;
+    Output output_max_op = requantize_op.output_max;
+    if (with_relu) {
+      QuantizedRelu relu_op(root.WithOpName("relu_op"), output_op,
+                            output_min_op, output_max_op);
+      output_op = relu_op.activations;
+      output_min_op = relu_op.min_activations;
+      output_max_op = relu_op.max_activations;
+    }
+    Output dequantize_op = Dequantize(root.WithOpName("dequantize_op"),
+                                      output_op, output_min_op, output_max_op);
+
+    GraphDef graph_def;
+    TF_ASSERT_OK(root.ToGraphDef(&graph_def));
+
+    TransformFuncContext context;
+    context.input_names = {};
+    context.output_names = {"dequantize_op"};
+    GraphDef fused_graph_def;
+    TF_ASSERT_OK(FuseQuantizedMatMul(graph_def, context, &fused_graph_def));
+
+    std::map<string, const NodeDef*> node_map;
+    MapNamesToNodes(fused_graph_def, &node_map);
+    const string fused_name = with_relu ? "relu_op" : "requantize_op";
+    ASSERT_EQ(1, node_map.count(fused_name));
+    EXPECT_EQ("QuantizedMatMulWithRequantize", node_map.at(fused_name)->op());
+    EXPECT_EQ(with_relu ? "Relu" : "None",
+              node_map.at(fused_name)->attr().at("activation").s());
+    EXPECT_EQ(0, node_map.count("matmul_op"));
+    EXPECT_EQ(0, node_map.count(with_relu ? "requantize_op" : "relu_op"));
+
+    std::unique_ptr<Session> original_session(NewSession(SessionOptions()));
+    TF_ASSERT_OK(original_session->Create(graph_def));
+    std::vector<Tensor> original_outputs;
+    TF_ASSERT_OK(
+        original_session->Run({}, {"dequantize_op"}, {}, &original_outputs));
+
+    std::unique_ptr<Session> fused_session(NewSession(SessionOptions()));
+    TF_ASSERT_OK(fused_session->Create(fused_graph_def));
+    std::vector<Tensor> fused_outputs;
+    TF_ASSERT_OK(fused_session->Run({}, {"dequantize_op"}, {}, &fused_outputs));
+
+    // Both versions round to the same eight-bit range, but may differ by one
+    // level of it.
+    const float output_level = 6.0f / 255.0f;
+    test::ExpectTensorNear<float>(original_outputs[0], fused_outputs[0],
+                                  output_level * 1.01f);
+  }
+};
+
+TEST_F(FuseQuantizedMatMulTest, TestFuseQuantizedMatMul) {
+  TestFuseQuantizedMatMul(false);
+}
+
+TEST_F(FuseQuantizedMatMulTest, TestFuseQuantizedMatMulAndRelu) {
+  TestFuseQuantizedMatMul(true);
+}
+
+}  // namespace graph_transforms
+}  // namespace tensorflow